@@ -1544,6 +1544,15 @@ class Cursor(Structure):
             for descendant in child.walk_preorder():
                 yield descendant
 
+    def get_descendants(self):
+        """Return this cursor and all of its descendants in a single call.
+
+        This visits the same cursors as walk_preorder(), but retrieves them
+        from libclang at once, without a callback per cursor. The result is a
+        CursorDescendants.
+        """
+        return CursorDescendants(self)
+
     def get_tokens(self):
         """Obtain Token instances formulating that compose this Cursor.
 
@@ -1552,6 +1561,14 @@ class Cursor(Structure):
         """
         return TokenGroup.get_tokens(self._tu, self.extent)
 
+    def get_token_array(self):
+        """Obtain the tokens of this Cursor as a TokenArray.
+
+        Unlike get_tokens(), this retrieves the kinds and positions of all
+        tokens in a single call.
+        """
+        return TokenArray(self._tu, self.extent)
+
     def get_field_offsetof(self):
         """Returns the offsetof the FIELD_DECL pointed by this Cursor."""
         return conf.lib.clang_Cursor_getOffsetOfField(self)
@@ -1609,6 +1626,61 @@ class Cursor(Structure):
         res._tu = args[0]._tu
         return res
 
+class CursorDescendants(object):
+    """A cursor and all of its descendants, in depth-first preorder.
+
+    The cursors stay in the memory that libclang returned them in. Indexing
+    creates a Cursor only for the element asked for. parent_indices is a
+    ctypes array, which supports the buffer protocol, giving the index of
+    the parent of each cursor. The first cursor is its own parent.
+
+    You should not instantiate this class outside of this module. Use
+    Cursor.get_descendants().
+    """
+    def __init__(self, cursor):
+        self._tu = cursor._tu
+        self._cursors_memory = POINTER(Cursor)()
+        self._parents_memory = POINTER(c_uint)()
+        count = c_uint()
+
+        conf.lib.clang_getCursorDescendants(cursor,
+                byref(self._cursors_memory), byref(self._parents_memory),
+                byref(count))
+
+        self._count = int(count.value)
+        if self._count < 1:
+            self._cursors = (Cursor * 0)()
+            self.parent_indices = (c_uint * 0)()
+            return
+        self._cursors = cast(self._cursors_memory,
+                POINTER(Cursor * self._count)).contents
+        self.parent_indices = cast(self._parents_memory,
+                POINTER(c_uint * self._count)).contents
+
+    def __del__(self):
+        conf.lib.clang_disposeCursorDescendants(self._cursors_memory,
+                self._parents_memory)
+
+    def __len__(self):
+        return self._count
+
+    def __getitem__(self, key):
+        if key < 0:
+            key += self._count
+        if key < 0 or key >= self._count:
+            raise IndexError(key)
+        cursor = Cursor.from_buffer_copy(self._cursors[key])
+        cursor._tu = self._tu
+        return cursor
+
+    def __iter__(self):
+        for i in xrange(self._count):
+            yield self[i]
+
+    def get_parent(self, key):
+        """Return the parent of the cursor at index key."""
+        return self[self.parent_indices[key]]
+
 class StorageClass(object):
     """
     Describes the storage class of a declaration
@@ -2663,6 +2735,17 @@ class TranslationUnit(ClangObject):
 
         return TokenGroup.get_tokens(self, extent)
 
+    def get_token_array(self, locations=None, extent=None):
+        """Obtain the tokens in this translation unit as a TokenArray.
+
+        The range is specified as for get_tokens(). Unlike get_tokens(), this
+        retrieves the kinds and positions of all tokens in a single call.
+        """
+        if locations is not None:
+            extent = SourceRange(start=locations[0], end=locations[1])
+
+        return TokenArray(self, extent)
+
 class File(ClangObject):
     """
     The File class represents a particular source file that is part of a
@@ -2891,6 +2974,76 @@ class Token(Structure):
 
         return cursor
 
+class TokenInfo(Structure):
+    """The kind and position of a token, as found in a TokenArray."""
+    _fields_ = [
+        ('_kind_id', c_int),
+        ('offset', c_uint),
+        ('length', c_uint),
+        ('line', c_uint),
+        ('column', c_uint)
+    ]
+
+    @property
+    def kind(self):
+        """Obtain the TokenKind of the token."""
+        return TokenKind.from_value(self._kind_id)
+
+    def __repr__(self):
+        return '<TokenInfo %r at %d:%d, offset %d, length %d>' % (
+            self.kind, self.line, self.column, self.offset, self.length)
+
+class TokenArray(object):
+    """The tokens of a range, with their kinds and positions.
+
+    The kinds and positions of all tokens are retrieved in a single call.
+    The tokens stay in the memory that libclang returned them in, and
+    indexing creates a Token only for the element asked for. infos is a
+    ctypes array of TokenInfo, which supports the buffer protocol.
+
+    You should not instantiate this class outside of this module. Use
+    TranslationUnit.get_token_array() or Cursor.get_token_array().
+    """
+    def __init__(self, tu, extent):
+        self._tu = tu
+        self._group = None
+        self._tokens = (Token * 0)()
+        self.infos = (TokenInfo * 0)()
+
+        tokens_memory = POINTER(Token)()
+        tokens_count = c_uint()
+        conf.lib.clang_tokenize(tu, extent, byref(tokens_memory),
+                byref(tokens_count))
+
+        count = int(tokens_count.value)
+        # If we get no tokens, no memory was allocated.
+        if count < 1:
+            return
+
+        self._group = TokenGroup(tu, tokens_memory, tokens_count)
+        self._tokens = cast(tokens_memory, POINTER(Token * count)).contents
+        self.infos = (TokenInfo * count)()
+        conf.lib.clang_getTokenInfos(tu, tokens_memory, count, self.infos)
+
+    def __len__(self):
+        return len(self.infos)
+
+    def __getitem__(self, key):
+        if key < 0:
+            key += len(self.infos)
+        if key < 0 or key >= len(self.infos):
+            raise IndexError(key)
+        token = Token()
+        token.int_data = self._tokens[key].int_data
+        token.ptr_data = self._tokens[key].ptr_data
+        token._tu = self._tu
+        token._group = self._group
+        return token
+
+    def __iter__(self):
+        for i in xrange(len(self.infos)):
+            yield self[i]
+
 # Now comes the plumbing to hook up the C library.
 
 # Register callback types in common container.
@@ -3019,6 +3172,9 @@ functionList = [
   ("clang_disposeCodeCompleteResults",
    [CodeCompletionResults]),
 
+  ("clang_disposeCursorDescendants",
+   [POINTER(Cursor), POINTER(c_uint)]),
+
 # ("clang_disposeCXTUResourceUsage",
 #  [CXTUResourceUsage]),
 
@@ -3122,6 +3278,10 @@ functionList = [
    Cursor,
    Cursor.from_result),
 
+  ("clang_getCursorDescendants",
+   [Cursor, POINTER(POINTER(Cursor)), POINTER(POINTER(c_uint)),
+    POINTER(c_uint)]),
+
   ("clang_getCursorDisplayName",
    [Cursor],
    _CXString,
@@ -3362,6 +3522,9 @@ functionList = [
    [TranslationUnit, Token],
    SourceRange),
 
+  ("clang_getTokenInfos",
+   [TranslationUnit, POINTER(Token), c_uint, POINTER(TokenInfo)]),
+
   ("clang_getTokenKind",
    [Token],
    c_uint),
@@ -3731,12 +3894,15 @@ __all__ = [
     'CompileCommand',
     'CursorKind',
     'Cursor',
+    'CursorDescendants',
     'Diagnostic',
     'File',
     'FixIt',
     'Index',
     'SourceLocation',
     'SourceRange',
+    'TokenArray',
+    'TokenInfo',
     'TokenKind',
     'Token',
     'TranslationUnitLoadError',
@@ -68,6 +68,30 @@ def test_get_children():
     assert tu_nodes[2].displayname == 'f0(int, int)'
     assert tu_nodes[2].is_definition() == True
 
+def test_get_descendants():
+    tu = get_tu(kInput)
+
+    descendants = tu.cursor.get_descendants()
+    preorder = list(tu.cursor.walk_preorder())
+    assert len(descendants) == len(preorder)
+    for cursor, expected in zip(descendants, preorder):
+        assert cursor == expected
+        assert cursor.translation_unit is not None
+
+    assert descendants[0] == tu.cursor
+    assert descendants.parent_indices[0] == 0
+    assert descendants[1].spelling == 's0'
+    assert descendants.get_parent(1) == tu.cursor
+    assert descendants[2].spelling == 'a'
+    assert descendants.get_parent(2).spelling == 's0'
+    assert descendants[-1] == preorder[-1]
+
+    # Every parent comes before its children.
+    for i in range(1, len(descendants)):
+        parent = descendants.parent_indices[i]
+        assert parent < i
+        assert descendants[i] in list(descendants[parent].get_children())
+
 def test_references():
     """Ensure that references to TranslationUnit are kept."""
     tu = get_tu('int x;')
@@ -50,3 +50,34 @@ def test_token_extent():
 
     eq_(extent.start.offset, 4)
     eq_(extent.end.offset, 7)
+
+def test_token_array():
+    """Ensure TokenArray matches the tokens of get_tokens()."""
+    tu = get_tu('int foo = 10;\nint bar;')
+    r = tu.get_extent('t.c', (0, 22))
+
+    tokens = list(tu.get_tokens(extent=r))
+    array = tu.get_token_array(extent=r)
+    eq_(len(array), len(tokens))
+    ok_(len(array) >= 7)
+
+    for i, token in enumerate(tokens):
+        info = array.infos[i]
+        eq_(array[i].spelling, token.spelling)
+        eq_(info.kind, token.kind)
+        eq_(info.offset, token.extent.start.offset)
+        eq_(info.length, token.extent.end.offset - token.extent.start.offset)
+        eq_(info.line, token.location.line)
+        eq_(info.column, token.location.column)
+
+    eq_(array[6].spelling, 'bar')
+    eq_(array.infos[6].line, 2)
+    eq_(array.infos[6].column, 5)
+    eq_(array[-1].spelling, tokens[-1].spelling)
+    eq_(len(memoryview(array.infos)), len(tokens))
+
+def test_token_array_empty():
+    """Ensure an empty range gives an empty TokenArray."""
+    tu = get_tu('int foo;')
+    r = tu.get_extent('t.c', (8, 8))
+    eq_(len(tu.get_token_array(extent=r)), 0)
@@ -21,8 +21,10 @@ import logging
 import multiprocessing
 import os
 import pprint
+import re
 import subprocess
 import sys
+import threading
 
 import version
 
@@ -137,7 +139,8 @@ def symlink(src, dst):
 
 def build(out_dir, prebuilts_path=None, prebuilts_version=None,
           build_all_clang_tools=None, build_all_llvm_tools=None,
-          debug_clang=None, max_jobs=multiprocessing.cpu_count()):
+          debug_clang=None, max_jobs=multiprocessing.cpu_count(),
+          extra_env=None):
     products = (
         'aosp_arm',
         'aosp_arm64',
@@ -149,12 +152,12 @@ def build(out_dir, prebuilts_path=None, prebuilts_version=None,
     for product in products:
         build_product(out_dir, product, prebuilts_path, prebuilts_version,
                       build_all_clang_tools, build_all_llvm_tools, debug_clang,
-                      max_jobs)
+                      max_jobs, extra_env)
 
 
 def build_product(out_dir, product, prebuilts_path, prebuilts_version,
                   build_all_clang_tools, build_all_llvm_tools, debug_clang,
-                  max_jobs):
+                  max_jobs, extra_env=None):
     env = dict(ORIG_ENV)
     env['DISABLE_LLVM_DEVICE_BUILDS'] = 'true'
     env['DISABLE_RELOCATION_PACKER'] = 'true'
@@ -170,6 +173,9 @@ def build_product(out_dir, product, prebuilts_path, prebuilts_version,
         env['FORCE_BUILD_LLVM_DEBUG'] = 'true'
         env['FORCE_BUILD_LLVM_DISABLE_NDEBUG'] = 'true'
 
+    if extra_env is not None:
+        env.update(extra_env)
+
     overrides = []
     if prebuilts_path is not None:
         overrides.append('LLVM_PREBUILTS_BASE={}'.format(prebuilts_path))
@@ -189,6 +195,104 @@ def build_product(out_dir, product, prebuilts_path, prebuilts_version,
                cwd=android_path(), env=env)
 
 
+class BuildThread(threading.Thread):
+    """A thread that re-raises the exception of its target from join()."""
+
+    def __init__(self, target, kwargs):
+        super(BuildThread, self).__init__()
+        self.build_target = target
+        self.build_kwargs = kwargs
+        self.error = None
+
+    def run(self):
+        try:
+            self.build_target(**self.build_kwargs)
+        except Exception as error:  # pylint: disable=broad-except
+            self.error = error
+
+    def join(self, timeout=None):
+        super(BuildThread, self).join(timeout)
+        if self.error is not None:
+            raise self.error
+
+
+def build_debug_toolchain(prebuilts_path, prebuilts_version, hosts,
+                          build_all_llvm_tools, max_jobs):
+    debug_clang_out_dir = build_path('debug')
+    build(out_dir=debug_clang_out_dir,
+          prebuilts_path=prebuilts_path,
+          prebuilts_version=prebuilts_version,
+          build_all_clang_tools=True,
+          build_all_llvm_tools=build_all_llvm_tools,
+          debug_clang=True,
+          max_jobs=max_jobs)
+    # Install the actual debug toolchain somewhere, so it is easier to use.
+    debug_package_name = 'clang-debug'
+    base_debug_install_dir = build_path('debug-install')
+    for host in hosts:
+        debug_install_host_dir = os.path.join(base_debug_install_dir, host)
+        debug_install_dir = os.path.join(
+            debug_install_host_dir, debug_package_name)
+        if os.path.exists(debug_install_host_dir):
+            rmtree(debug_install_host_dir)
+        install_toolchain(debug_clang_out_dir, debug_install_dir, host, False)
+
+
+def run_perf_training(out_dir, profile_dir):
+    """Compiles the perf-training corpus with the instrumented host clang.
+
+    Runs the RUN lines of the training files the way the perf-training lit
+    suite does, with the profiles written to profile_dir.
+    """
+    training_dir = android_path('external/clang/utils/perf-training')
+    profile_dir = os.path.abspath(profile_dir)
+    bin_dir = os.path.abspath(os.path.join(out_dir, 'host', 'linux-x86', 'bin'))
+    clang = os.path.join(bin_dir, 'clang')
+    cc1_wrapper = '{} {} cc1'.format(
+        sys.executable, os.path.join(training_dir, 'perf-helper.py'))
+    substitutions = (
+        ('%clang_cpp_skip_driver', '{} {}'.format(cc1_wrapper, clang)),
+        ('%clang_cpp', '{} --driver-mode=cpp'.format(clang)),
+        ('%clang_skip_driver', '{} {}'.format(cc1_wrapper, clang)),
+        ('%clang', clang),
+    )
+    suffixes = ('.c', '.cpp', '.m', '.mm')
+
+    if os.path.exists(profile_dir):
+        rmtree(profile_dir)
+    makedirs(profile_dir)
+    env = dict(ORIG_ENV)
+    env['LLVM_PROFILE_FILE'] = os.path.join(
+        profile_dir, 'perf-training-%p.profraw')
+
+    for root, _, files in os.walk(training_dir):
+        for file_name in sorted(files):
+            if not file_name.endswith(suffixes):
+                continue
+            path = os.path.join(root, file_name)
+            temp_path = os.path.join(profile_dir, file_name + '.tmp')
+            with open(path) as training_file:
+                run_lines = re.findall(r'RUN: (.*)$', training_file.read(),
+                                       re.MULTILINE)
+            for run_line in run_lines:
+                for pattern, replacement in substitutions:
+                    run_line = run_line.replace(pattern, replacement)
+                run_line = run_line.replace('%s', path)
+                run_line = run_line.replace('%S', root)
+                run_line = run_line.replace('%t', temp_path)
+                run_line = run_line.replace('%test_root', profile_dir)
+                check_call(['sh', '-c', run_line], cwd=profile_dir, env=env)
+
+
+def merge_profiles(out_dir, profile_dir, profile_path):
+    llvm_profdata = os.path.join(
+        out_dir, 'host', 'linux-x86', 'bin', 'llvm-profdata')
+    profiles = glob.glob(os.path.join(profile_dir, '*.profraw'))
+    if not profiles and not Config.dry_run:
+        raise RuntimeError('Training wrote no profiles to ' + profile_dir)
+    check_call([llvm_profdata, 'merge', '-o', profile_path] + profiles)
+
+
 def package_toolchain(build_dir, build_name, host, dist_dir):
     package_name = 'clang-' + build_name
     install_host_dir = build_path('install', host)
@@ -633,6 +737,12 @@ def parse_args():
         '-v', '--verbose', action='store_true', default=False,
         help='Print debug output.')
 
+    parser.add_argument(
+        '--pgo-lto', action='store_true', default=False,
+        help='Build an instrumented clang after the first stage, train it on '
+        'utils/perf-training, and build the final clang with the profile '
+        'and ThinLTO (requires --multi-stage).')
+
     multi_stage_group = parser.add_mutually_exclusive_group()
     multi_stage_group.add_argument(
         '--multi-stage', action='store_true', default=True,
@@ -674,6 +784,9 @@ def main():
 
     Config.dry_run = args.dry_run
 
+    if args.pgo_lto and not args.multi_stage:
+        raise RuntimeError('--pgo-lto requires a multi-stage build')
+
     if sys.platform.startswith('linux'):
         hosts = ['linux-x86', 'windows-x86']
     elif sys.platform == 'darwin':
@@ -705,36 +818,57 @@ def main():
 
             install_minimal_toolchain(stage_1_out_dir, install_dir, host, True)
 
-        stage_2_out_dir = build_path('stage2')
-        build(out_dir=stage_2_out_dir, prebuilts_path=stage_1_install_dir,
+        # The debug clang only needs the first stage, so build it alongside
+        # the later stages, which get the other half of the jobs.
+        debug_thread = None
+        stage_jobs = args.jobs
+        if args.debug_clang:
+            stage_jobs = max(1, args.jobs // 2)
+            debug_thread = BuildThread(build_debug_toolchain, {
+                'prebuilts_path': stage_1_install_dir,
+                'prebuilts_version': package_name,
+                'hosts': hosts,
+                'build_all_llvm_tools': args.build_all_llvm_tools,
+                'max_jobs': args.jobs - stage_jobs,
+            })
+            debug_thread.start()
+
+        # For a PGO build, build an instrumented clang, train it on the
+        # perf-training corpus, and build the final stage with the merged
+        # profile and ThinLTO.
+        final_env = None
+        final_out_dir = build_path('stage2')
+        if args.pgo_lto:
+            instrumented_out_dir = build_path('stage2-instrumented')
+            build(out_dir=instrumented_out_dir,
+                  prebuilts_path=stage_1_install_dir,
+                  prebuilts_version=package_name,
+                  build_all_clang_tools=False,
+                  build_all_llvm_tools=True,
+                  max_jobs=stage_jobs,
+                  extra_env={'FORCE_BUILD_LLVM_PGO_GENERATE': 'true'})
+
+            profile_dir = build_path('pgo-profiles')
+            profile_path = os.path.abspath(build_path('clang.profdata'))
+            run_perf_training(instrumented_out_dir, profile_dir)
+            merge_profiles(instrumented_out_dir, profile_dir, profile_path)
+
+            final_env = {
+                'LLVM_PGO_PROFILE': profile_path,
+                'FORCE_BUILD_LLVM_THINLTO': 'true',
+                'LLVM_THINLTO_JOBS': str(stage_jobs),
+            }
+            final_out_dir = build_path('stage3')
+
+        build(out_dir=final_out_dir, prebuilts_path=stage_1_install_dir,
               prebuilts_version=package_name,
               build_all_clang_tools=True,
               build_all_llvm_tools=args.build_all_llvm_tools,
-              max_jobs=args.jobs)
-        final_out_dir = stage_2_out_dir
+              max_jobs=stage_jobs,
+              extra_env=final_env)
 
-        if args.debug_clang:
-            debug_clang_out_dir = build_path('debug')
-            build(out_dir=debug_clang_out_dir,
-                  prebuilts_path=stage_1_install_dir,
-                  prebuilts_version=package_name,
-                  build_all_clang_tools=True,
-                  build_all_llvm_tools=args.build_all_llvm_tools,
-                  debug_clang=args.debug_clang,
-                  max_jobs=args.jobs)
-            # Install the actual debug toolchain somewhere, so it is easier to
-            # use.
-            debug_package_name = 'clang-debug'
-            base_debug_install_dir = build_path('debug-install')
-            for host in hosts:
-                debug_install_host_dir = os.path.join(
-                    base_debug_install_dir, host)
-                debug_install_dir = os.path.join(
-                    debug_install_host_dir, debug_package_name)
-                if os.path.exists(debug_install_host_dir):
-                    rmtree(debug_install_host_dir)
-                install_toolchain(
-                    debug_clang_out_dir, debug_install_dir, host, False)
+        if debug_thread is not None:
+            debug_thread.join()
 
     dist_dir = ORIG_ENV.get('DIST_DIR', final_out_dir)
     for host in hosts:
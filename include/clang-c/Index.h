@@ -32,7 +32,7 @@
  * compatible, thus CINDEX_VERSION_MAJOR is expected to remain stable.
  */
 #define CINDEX_VERSION_MAJOR 0
-#define CINDEX_VERSION_MINOR 35
+#define CINDEX_VERSION_MINOR 43
 
 #define CINDEX_VERSION_ENCODE(major, minor) ( \
       ((major) * 10000)                       \
@@ -205,6 +205,11 @@ typedef struct CXVersion {
  * This process of creating the 'pch', loading it separately, and using it (via
  * -include-pch) allows 'excludeDeclsFromPCH' to remove redundant callbacks
  * (which gives the indexer the same performance benefit as the compiler).
+ *
+ * An index may be used from several threads at once: translation units of
+ * the same index can be parsed concurrently, and they share the precompiled
+ * preambles they have in common. A given translation unit must only be used
+ * from one thread at a time.
  */
 CINDEX_LINKAGE CXIndex clang_createIndex(int excludeDeclarationsFromPCH,
                                          int displayDiagnostics);
@@ -247,7 +252,18 @@ typedef enum {
    */
   CXGlobalOpt_ThreadBackgroundPriorityForAll =
       CXGlobalOpt_ThreadBackgroundPriorityForIndexing |
-      CXGlobalOpt_ThreadBackgroundPriorityForEditing
+      CXGlobalOpt_ThreadBackgroundPriorityForEditing,
+
+  /**
+   * \brief Used to indicate that translation units parsed with this index
+   * should share the results of looking up the files of system headers and
+   * builtin headers, rather than each looking them up again.
+   *
+   * These files are assumed not to change while the index exists.
+   *
+   * Affects #clang_parseTranslationUnit and #clang_reparseTranslationUnit.
+   */
+  CXGlobalOpt_ShareSystemHeaderStats = 0x4
 
 } CXGlobalOptFlags;
 
@@ -1104,6 +1120,54 @@ CINDEX_LINKAGE enum CXErrorCode clang_createTranslationUnit2(
     const char *ast_filename,
     CXTranslationUnit *out_TU);
 
+/**
+ * \brief Flags that control how a translation unit is loaded from an AST
+ * file by \c clang_createTranslationUnitWithOptions().
+ *
+ * The enumerators in this enumeration type are meant to be bitwise
+ * ORed together to specify which options should be used when
+ * loading the translation unit.
+ */
+enum CXLoadTranslationUnit_Flags {
+  /**
+   * \brief Used to indicate that no special loading options are needed.
+   */
+  CXLoadTranslationUnit_None = 0x0,
+
+  /**
+   * \brief Do not check that the source files the AST file was built from
+   * are unchanged.
+   *
+   * Loading an AST file normally examines every file it was built from, so
+   * that an out-of-date AST file is rejected. A client that already knows the
+   * AST file to be up to date, for example because it keeps its own record of
+   * when the file was saved, can skip that work. The AST file is mapped into
+   * memory and its declarations are only deserialized when they are queried,
+   * so loading then costs little more than opening the file. Using a stale AST
+   * file this way produces wrong results.
+   */
+  CXLoadTranslationUnit_SkipInputValidation = 0x01
+};
+
+/**
+ * \brief Create a translation unit from an AST file (\c -emit-ast), as
+ * \c clang_createTranslationUnit2() does.
+ *
+ * \param options A bitmask of options that affects how the translation unit
+ * is loaded. This should be a bitwise OR of the CXLoadTranslationUnit_XXX
+ * flags.
+ *
+ * \param[out] out_TU A non-NULL pointer to store the created
+ * \c CXTranslationUnit.
+ *
+ * \returns Zero on success, otherwise returns an error code.
+ */
+CINDEX_LINKAGE enum CXErrorCode clang_createTranslationUnitWithOptions(
+    CXIndex CIdx,
+    const char *ast_filename,
+    unsigned options,
+    CXTranslationUnit *out_TU);
+
 /**
  * \brief Flags that control the creation of translation units.
  *
@@ -1219,7 +1283,19 @@ enum CXTranslationUnit_Flags {
    * purposes of an IDE, this is undesirable behavior and as much information
    * as possible should be reported. Use this flag to enable this behavior.
    */
-  CXTranslationUnit_KeepGoing = 0x200
+  CXTranslationUnit_KeepGoing = 0x200,
+
+  /**
+   * \brief Used to indicate that the precompiled preamble should be built as
+   * a chain of two precompiled headers, split before the last \#include of
+   * the preamble.
+   *
+   * When the preamble changes, only the part of it after the last \#include
+   * that is unchanged is precompiled again, so editing the last \#include of
+   * a file with a large preamble is much cheaper. This takes effect from the
+   * first time the precompiled preamble is rebuilt on a reparse.
+   */
+  CXTranslationUnit_ChainedPreamble = 0x400
 };
 
 /**
@@ -3690,6 +3766,71 @@ typedef enum CXChildVisitResult (*CXCursorVisitor)(CXCursor cursor,
 CINDEX_LINKAGE unsigned clang_visitChildren(CXCursor parent,
                                             CXCursorVisitor visitor,
                                             CXClientData client_data);
+
+/**
+ * \brief Visit the children of a particular cursor that overlap the given
+ * source range.
+ *
+ * This function behaves like clang_visitChildren(), except that it only
+ * visits the children (and, recursively, their children) whose extent
+ * overlaps \p range. When \p parent is the translation unit cursor, only
+ * the declarations of the file that \p range starts in are looked at, so
+ * declarations elsewhere, such as those of a precompiled preamble, are not
+ * deserialized. This keeps, for example, the outline of a visible region of
+ * a large file fast to compute.
+ *
+ * \param parent the cursor whose child may be visited.
+ *
+ * \param range the source range whose cursors should be visited. It should
+ * lie within a single file. A null range visits all children, as
+ * clang_visitChildren() does.
+ *
+ * \param visitor the visitor function that will be invoked for each
+ * child of \p parent that overlaps \p range.
+ *
+ * \param client_data pointer data supplied by the client, which will
+ * be passed to the visitor each time it is invoked.
+ *
+ * \returns a non-zero value if the traversal was terminated
+ * prematurely by the visitor returning \c CXChildVisit_Break.
+ */
+CINDEX_LINKAGE unsigned clang_visitChildrenInRange(CXCursor parent,
+                                                   CXSourceRange range,
+                                                   CXCursorVisitor visitor,
+                                                   CXClientData client_data);
+
+/**
+ * \brief Retrieve a cursor and all of its descendants in a single call.
+ *
+ * The cursors are those that clang_visitChildren() visits when its visitor
+ * always returns \c CXChildVisit_Recurse, in the same order, preceded by
+ * \p parent itself. Clients that bind to libclang through a foreign function
+ * interface can retrieve a whole tree this way, rather than paying for a
+ * callback per cursor.
+ *
+ * \param parent the cursor whose descendants are retrieved.
+ *
+ * \param cursors set to an array of \c *num_cursors cursors, in preorder.
+ * The first one is \p parent.
+ *
+ * \param parent_indices set to an array of \c *num_cursors indices into
+ * \c *cursors, giving the position of the parent of each cursor. The first
+ * cursor is its own parent, at index 0.
+ *
+ * \param num_cursors set to the number of cursors.
+ *
+ * Both arrays must be freed with clang_disposeCursorDescendants().
+ */
+CINDEX_LINKAGE void clang_getCursorDescendants(CXCursor parent,
+                                               CXCursor **cursors,
+                                               unsigned **parent_indices,
+                                               unsigned *num_cursors);
+
+/**
+ * \brief Free the arrays retrieved by clang_getCursorDescendants().
+ */
+CINDEX_LINKAGE void clang_disposeCursorDescendants(CXCursor *cursors,
+                                                   unsigned *parent_indices);
 #ifdef __has_feature
 #  if __has_feature(blocks)
 /**
@@ -4401,6 +4542,60 @@ CINDEX_LINKAGE void clang_annotateTokens(CXTranslationUnit TU,
 CINDEX_LINKAGE void clang_disposeTokens(CXTranslationUnit TU,
                                         CXToken *Tokens, unsigned NumTokens);
 
+/**
+ * \brief The kind and position of a token, as retrieved by
+ * clang_getTokenInfos().
+ */
+typedef struct {
+  /**
+   * \brief The kind of the token.
+   */
+  CXTokenKind kind;
+
+  /**
+   * \brief The offset of the start of the token in its file.
+   */
+  unsigned offset;
+
+  /**
+   * \brief The length of the token in its file.
+   */
+  unsigned length;
+
+  /**
+   * \brief The line of the start of the token, starting from 1.
+   */
+  unsigned line;
+
+  /**
+   * \brief The column of the start of the token, starting from 1.
+   */
+  unsigned column;
+} CXTokenInfo;
+
+/**
+ * \brief Retrieve the kinds and positions of a set of tokens in a single
+ * call.
+ *
+ * This computes what clang_getTokenKind() and clang_getTokenExtent() return
+ * for each token, without a call per token, which dominates the cost of
+ * walking the tokens of a file for clients that bind to libclang through a
+ * foreign function interface.
+ *
+ * \param TU the translation unit that owns the given tokens.
+ *
+ * \param Tokens the tokens, as returned by clang_tokenize().
+ *
+ * \param NumTokens the number of tokens in \p Tokens.
+ *
+ * \param Infos an array of \p NumTokens elements, filled in with the kind
+ * and position of each token.
+ */
+CINDEX_LINKAGE void clang_getTokenInfos(CXTranslationUnit TU,
+                                        const CXToken *Tokens,
+                                        unsigned NumTokens,
+                                        CXTokenInfo *Infos);
+
 /**
  * @}
  */
@@ -4836,7 +5031,15 @@ enum CXCodeComplete_Flags {
    * \brief Whether to include brief documentation within the set of code
    * completions returned.
    */
-  CXCodeComplete_IncludeBriefComments = 0x04
+  CXCodeComplete_IncludeBriefComments = 0x04,
+
+  /**
+   * \brief Whether to include only the code-completion results whose typed
+   * text starts with the identifier at the code-completion location, ignoring
+   * case. The other results are dropped before their completion strings are
+   * built, which is much cheaper than filtering them in the client.
+   */
+  CXCodeComplete_FilterByTypedText = 0x08
 };
 
 /**
@@ -5862,7 +6065,27 @@ typedef enum {
    * indexing session associated with a \c CXIndexAction object.
    * Bodies in system headers are always skipped.
    */
-  CXIndexOpt_SkipParsedBodiesInSession = 0x10
+  CXIndexOpt_SkipParsedBodiesInSession = 0x10,
+
+  /**
+   * \brief Skip the bodies of non-template functions and methods written
+   * outside the main file.
+   */
+  CXIndexOpt_SkipHeaderFunctionBodies = 0x20,
+
+  /**
+   * \brief Skip the declarations of a header that were already indexed by an
+   * earlier translation unit of the indexing session associated with a
+   * \c CXIndexAction object, so that neither their declarations nor the
+   * references within them are reported again.
+   *
+   * A header is only skipped when it was indexed with the same language,
+   * target, command-line macros and implicitly included headers. Headers
+   * without an include guard or #pragma once are only skipped within their
+   * conditionally compiled regions. Declarations of the main file are always
+   * indexed.
+   */
+  CXIndexOpt_SkipIndexedHeadersInSession = 0x40
 
 } CXIndexOptFlags;
 
@@ -15,6 +15,7 @@
 #include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/StringRef.h"
 #include <memory>
+#include <vector>
 
 namespace llvm {
   class MemoryBuffer;
@@ -38,6 +39,11 @@ class FileRemapper {
 
   llvm::DenseMap<const FileEntry *, const FileEntry *> ToFromMappings;
 
+  /// \brief The targets of the mappings last read from or written to disk.
+  /// flushToDisk() uses them to tell the files remapped here from the files
+  /// remapped by other migrations of the same directory in the meantime.
+  llvm::DenseMap<const FileEntry *, const FileEntry *> DiskMappings;
+
 public:
   FileRemapper();
   ~FileRemapper();
@@ -46,6 +52,13 @@ public:
                     bool ignoreIfFilesChanged);
   bool initFromFile(StringRef filePath, DiagnosticsEngine &Diag,
                     bool ignoreIfFilesChanged);
+
+  /// \brief Write the mappings to \p outputDir.
+  ///
+  /// Several migrations, such as the translation units of one build, may
+  /// write to the same directory at once.  Mappings that others wrote since
+  /// this remapper was initialized are merged in, and it is an error if this
+  /// remapper and another one both changed the same file.
   bool flushToDisk(StringRef outputDir, DiagnosticsEngine &Diag);
   bool flushToFile(StringRef outputPath, DiagnosticsEngine &Diag);
 
@@ -62,6 +75,12 @@ private:
   void remap(const FileEntry *file, std::unique_ptr<llvm::MemoryBuffer> memBuf);
   void remap(const FileEntry *file, const FileEntry *newfile);
 
+  typedef std::vector<std::pair<const FileEntry *, const FileEntry *>>
+      FilePairs;
+  bool readMappings(StringRef filePath, DiagnosticsEngine &Diag,
+                    bool ignoreIfFilesChanged, FilePairs &pairs);
+  bool mergeFromFile(StringRef filePath, DiagnosticsEngine &Diag);
+
   const FileEntry *getOriginalFile(StringRef filePath);
   void resetTarget(Target &targ);
 
@@ -93,6 +93,12 @@ class ASTContext : public RefCountedBase<ASTContext> {
   ASTContext &this_() { return *this; }
 
   mutable SmallVector<Type *, 0> Types;
+
+  // FIXME: Each kind of type is uniqued in its own folding set, whose bucket
+  // arrays are heap-allocated and which rehash through Profile. A single
+  // interning table with inline hashes would need changes to every get*Type
+  // function and to the ASTReader, so for now -print-stats only reports how
+  // much memory these sets use.
   mutable llvm::FoldingSet<ExtQuals> ExtQualNodes;
   mutable llvm::FoldingSet<ComplexType> ComplexTypes;
   mutable llvm::FoldingSet<PointerType> PointerTypes;
@@ -522,25 +528,22 @@ public:
 
   /// \brief Returns the parents of the given node.
   ///
-  /// Note that this will lazily compute the parents of all nodes
-  /// and store them for later retrieval. Thus, the first call is O(n)
-  /// in the number of AST nodes.
-  ///
-  /// Caveats and FIXMEs:
-  /// Calculating the parent map over all AST nodes will need to load the
-  /// full AST. This can be undesirable in the case where the full AST is
-  /// expensive to create (for example, when using precompiled header
-  /// preambles). Thus, there are good opportunities for optimization here.
-  /// One idea is to walk the given node downwards, looking for references
-  /// to declaration contexts - once a declaration context is found, compute
-  /// the parent map for the declaration context; if that can satisfy the
-  /// request, loading the whole AST can be avoided. Note that this is made
-  /// more complex by statements in templates having multiple parents - those
-  /// problems can be solved by building closure over the templated parts of
-  /// the AST, which also avoids touching large parts of the AST.
-  /// Additionally, we will want to add an interface to already give a hint
-  /// where to search for the parents, for example when looking at a statement
-  /// inside a certain function.
+  /// Note that this will lazily compute the parents of nodes and store them
+  /// for later retrieval. The parent map is built one top-level declaration
+  /// of the translation unit at a time: the first query for a node traverses
+  /// only the top-level declaration that contains it, found through its
+  /// lexical declaration contexts or its (expansion) source location, so
+  /// bodies that are never asked about are neither traversed nor, with a
+  /// precompiled preamble, deserialized. Template instantiations are
+  /// traversed below the first declaration of their template, and the nodes
+  /// of out-of-line template members can be shared with them; the subtrees
+  /// of those declarations are mapped together. A node found in none of
+  /// these, such as the translation unit itself, maps the rest of the
+  /// translation unit, so in the worst case the cost is that of a full
+  /// traversal, O(n) in the number of AST nodes.
+  ///
+  /// If a parent map scope is set, only the nodes in that scope are
+  /// considered; see \c setParentMapScope().
   ///
   /// 'NodeT' can be one of Decl, Stmt, Type, TypeLoc,
   /// NestedNameSpecifier or NestedNameSpecifierLoc.
@@ -550,6 +553,32 @@ public:
 
   DynTypedNodeList getParents(const ast_type_traits::DynTypedNode &Node);
 
+  /// \brief Restricts the parent map computed by \c getParents() to the
+  /// subtrees of the declarations in \p Scope, and drops the parent map
+  /// computed so far.
+  ///
+  /// This is meant for tools that only look at the ancestors of nodes in a
+  /// few functions or declaration contexts of a large translation unit:
+  /// only those subtrees are traversed, instead of the whole translation
+  /// unit. The enclosing declaration contexts of each declaration in
+  /// \p Scope, up to the translation unit, are still reported as its
+  /// ancestors. Nodes outside of the scope, such as the instantiations of a
+  /// template declared in it, have no parents.
+  ///
+  /// An empty \p Scope, the default, stands for the whole translation unit.
+  /// Setting a new scope, even the same one, is also the way to release the
+  /// memory of the parent map once it is no longer needed.
+  void setParentMapScope(ArrayRef<Decl *> Scope);
+
+  /// \brief Computes the parent map of the whole translation unit, or of the
+  /// parent map scope, instead of lazily as parents are requested.
+  ///
+  /// After this, \c getParents() no longer modifies the \c ASTContext, so
+  /// it can be called from several threads at once.
+  void computeParentMap();
+
+  ArrayRef<Decl *> getParentMapScope() const { return ParentMapScope; }
+
   const clang::PrintingPolicy &getPrintingPolicy() const {
     return PrintingPolicy;
   }
@@ -2573,6 +2602,15 @@ private:
   std::unique_ptr<ParentMapPointers> PointerParents;
   std::unique_ptr<ParentMapOtherNodes> OtherParents;
 
+  /// \brief The top-level declarations whose subtrees the lazily built
+  /// parent map already covers; null if a parent map scope is set.
+  class ParentMapProgress;
+  std::unique_ptr<ParentMapProgress> ParentMapState;
+
+  /// \brief The declarations whose subtrees the parent map covers, or empty
+  /// for the whole translation unit.
+  std::vector<Decl *> ParentMapScope;
+
   std::unique_ptr<VTableContextBase> VTContext;
 
 public:
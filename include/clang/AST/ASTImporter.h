@@ -76,6 +76,24 @@ namespace clang {
     /// \brief Declaration (from, to) pairs that are known not to be equivalent
     /// (which we have already complained about).
     NonEquivalentDeclSet NonEquivalentDecls;
+
+    /// \brief Canonical declaration (from, to) pairs, both complete, that
+    /// were found to be structurally equivalent.
+    NonEquivalentDeclSet EquivalentDecls;
+
+    /// \brief The named declarations of a declaration context in the "to"
+    /// context, indexed from the first declaration of the context up to a
+    /// later one.
+    struct LexicalLookupTable {
+      Decl *FirstIndexed = nullptr;
+      Decl *LastIndexed = nullptr;
+      llvm::DenseMap<DeclarationName, SmallVector<NamedDecl *, 1> > Decls;
+    };
+
+    /// \brief Lookup tables of the "to" declaration contexts with external
+    /// storage, which DeclContext::localUncachedLookup searches linearly.
+    /// Declarations are only ever added to these contexts while importing.
+    llvm::DenseMap<DeclContext *, LexicalLookupTable> LookupTables;
     
   public:
     /// \brief Create a new AST importer.
@@ -273,6 +291,18 @@ namespace clang {
     /// \brief Return the set of declarations that we know are not equivalent.
     NonEquivalentDeclSet &getNonEquivalentDecls() { return NonEquivalentDecls; }
 
+    /// \brief Return the set of declarations that we know are equivalent.
+    NonEquivalentDeclSet &getEquivalentDecls() { return EquivalentDecls; }
+
+    /// \brief Find the declarations named \p Name in the redeclaration context
+    /// of \p DC, a declaration context in the "to" context.
+    ///
+    /// This finds what DeclContext::localUncachedLookup would, but only walks
+    /// the declarations of a context with external storage once, rather than
+    /// on every lookup.
+    void findDeclsInToContext(DeclContext *DC, DeclarationName Name,
+                              SmallVectorImpl<NamedDecl *> &Results);
+
     /// \brief Called for ObjCInterfaceDecl, ObjCProtocolDecl, and TagDecl.
     /// Mark the Decl as complete, filling it in as much as possible.
     ///
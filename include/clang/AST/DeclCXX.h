@@ -371,6 +371,7 @@ class CXXRecordDecl : public RecordDecl {
     /// \brief These flags are \c true if a defaulted corresponding special
     /// member can't be fully analyzed without performing overload resolution.
     /// @{
+    unsigned NeedOverloadResolutionForCopyConstructor : 1;
     unsigned NeedOverloadResolutionForMoveConstructor : 1;
     unsigned NeedOverloadResolutionForMoveAssignment : 1;
     unsigned NeedOverloadResolutionForDestructor : 1;
@@ -379,6 +380,7 @@ class CXXRecordDecl : public RecordDecl {
     /// \brief These flags are \c true if an implicit defaulted corresponding
     /// special member would be defined as deleted.
     /// @{
+    unsigned DefaultedCopyConstructorIsDeleted : 1;
     unsigned DefaultedMoveConstructorIsDeleted : 1;
     unsigned DefaultedMoveAssignmentIsDeleted : 1;
     unsigned DefaultedDestructorIsDeleted : 1;
@@ -800,6 +802,12 @@ public:
     return data().FirstFriend.isValid();
   }
 
+  /// \brief \c true if we know for sure that this class has a single,
+  /// accessible, unambiguous copy constructor that is not deleted.
+  bool hasSimpleCopyConstructor() const {
+    return !hasUserDeclaredCopyConstructor() &&
+           !data().DefaultedCopyConstructorIsDeleted;
+  }
   /// \brief \c true if we know for sure that this class has a single,
   /// accessible, unambiguous move constructor that is not deleted.
   bool hasSimpleMoveConstructor() const {
@@ -864,12 +872,43 @@ public:
     return !(data().DeclaredSpecialMembers & SMF_CopyConstructor);
   }
 
+  /// \brief Set that we attempted to declare an implicit copy
+  /// constructor, but overload resolution failed so we deleted it.
+  void setImplicitCopyConstructorIsDeleted() {
+    assert((data().DefaultedCopyConstructorIsDeleted ||
+            defaultedCopyConstructorIsDeletedNeedsOverloadResolution()) &&
+           "copy constructor should not be deleted");
+    data().DefaultedCopyConstructorIsDeleted = true;
+  }
+
   /// \brief Determine whether we need to eagerly declare a defaulted copy
   /// constructor for this class.
   bool needsOverloadResolutionForCopyConstructor() const {
     return data().HasMutableFields;
   }
 
+  /// \brief Determine whether deciding if a defaulted copy constructor for
+  /// this class is deleted needs overload resolution. Unlike
+  /// needsOverloadResolutionForCopyConstructor(), this does not force the
+  /// copy constructor to be declared eagerly.
+  bool defaultedCopyConstructorIsDeletedNeedsOverloadResolution() const {
+    // C++11 [class.copy]p7:
+    //   If the class definition declares a move constructor or move
+    //   assignment operator, the implicitly declared copy constructor is
+    //   defined as deleted.
+    // In MSVC mode, a declared move assignment does not delete an implicit
+    // copy constructor, so leave this choice to Sema.
+    return data().HasMutableFields || hasUserDeclaredMoveOperation() ||
+           data().NeedOverloadResolutionForCopyConstructor;
+  }
+
+  /// \brief Determine whether a defaulted copy constructor for this class
+  /// would be deleted. This is only known without overload resolution if
+  /// defaultedCopyConstructorIsDeletedNeedsOverloadResolution() is false.
+  bool defaultedCopyConstructorIsDeleted() const {
+    return data().DefaultedCopyConstructorIsDeleted;
+  }
+
   /// \brief Determine whether an implicit copy constructor for this type
   /// would have a parameter with a const-qualified reference type.
   bool implicitCopyConstructorHasConstParam() const {
@@ -931,6 +970,13 @@ public:
     return data().NeedOverloadResolutionForMoveConstructor;
   }
 
+  /// \brief Determine whether a defaulted move constructor for this class
+  /// would be deleted. This is only known without overload resolution if
+  /// needsOverloadResolutionForMoveConstructor() is false.
+  bool defaultedMoveConstructorIsDeleted() const {
+    return data().DefaultedMoveConstructorIsDeleted;
+  }
+
   /// \brief Determine whether this class has a user-declared copy assignment
   /// operator.
   ///
@@ -1004,6 +1050,13 @@ public:
     return data().NeedOverloadResolutionForMoveAssignment;
   }
 
+  /// \brief Determine whether a defaulted move assignment operator for this
+  /// class would be deleted. This is only known without overload resolution
+  /// if needsOverloadResolutionForMoveAssignment() is false.
+  bool defaultedMoveAssignmentIsDeleted() const {
+    return data().DefaultedMoveAssignmentIsDeleted;
+  }
+
   /// \brief Determine whether this class has a user-declared destructor.
   ///
   /// When false, a destructor will be implicitly declared.
@@ -1017,12 +1070,25 @@ public:
     return !(data().DeclaredSpecialMembers & SMF_Destructor);
   }
 
+  /// \brief Set that we attempted to declare an implicit destructor, but
+  /// it was deleted.
+  void setImplicitDestructorIsDeleted() {
+    data().DefaultedDestructorIsDeleted = true;
+  }
+
   /// \brief Determine whether we need to eagerly declare a destructor for this
   /// class.
   bool needsOverloadResolutionForDestructor() const {
     return data().NeedOverloadResolutionForDestructor;
   }
 
+  /// \brief Determine whether a defaulted, non-virtual destructor for this
+  /// class would be deleted. This is only known without overload resolution
+  /// if needsOverloadResolutionForDestructor() is false.
+  bool defaultedDestructorIsDeleted() const {
+    return data().DefaultedDestructorIsDeleted;
+  }
+
   /// \brief Determine whether this class describes a lambda function object.
   bool isLambda() const {
     // An update record can't turn a non-lambda into a lambda.
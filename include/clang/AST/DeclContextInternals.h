@@ -236,6 +236,10 @@ public:
   }
 };
 
+/// FIXME: The ASTReader, the ASTWriter and DeclContext all rely on the
+/// DenseMap interface, so this stays a hash map of StoredDeclsLists. Only
+/// the table size is reserved up front in DeclContext::buildLookup, and an
+/// arena-allocated open-addressing table is left for later.
 class StoredDeclsMap
   : public llvm::SmallDenseMap<DeclarationName, StoredDeclsList, 4> {
 
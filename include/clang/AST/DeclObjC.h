@@ -477,6 +477,12 @@ public:
   bool isDesignatedInitializerForTheInterface(
       const ObjCMethodDecl **InitMethod = nullptr) const;
 
+  /// Returns true if this method is marked objc_direct. The attribute is not
+  /// inherited: Sema adds it implicitly to an implementation whose interface
+  /// declaration is direct. Such methods are called without going through
+  /// the runtime.
+  bool isDirectMethod() const;
+
   /// \brief Determine whether this method has a body.
   bool hasBody() const override { return Body.isValid(); }
 
@@ -3930,6 +3930,111 @@ public:
   friend class ASTStmtWriter;
 };
 
+/// \brief Describes the initialization of an array of integers by a list of
+/// integer literals, with the element values stored as packed data.
+///
+/// Embedding binary data produces initializers such as
+/// \code
+/// static const unsigned char data[] = { 0x12, 0x34, 0x56, /* ... */ };
+/// \endcode
+/// with millions of elements. When every initializer in a long list is an
+/// integer literal whose value the element type can represent, Sema forms a
+/// PackedArrayInitExpr in place of the semantic form of the InitListExpr, so
+/// that no conversion is created for each element and CodeGen can emit the
+/// values as a single block of data. Elements past the end of the list are
+/// zero-initialized.
+///
+/// The InitListExpr as written is kept as the syntactic form, and is the only
+/// child of this expression.
+class PackedArrayInitExpr : public Expr {
+  /// \brief The initializer list as written.
+  Stmt *SyntacticForm;
+
+  /// \brief The element values, each stored as an unsigned integer of
+  /// ElementSize bytes in host byte order.
+  const char *Data;
+
+  /// \brief The number of values in Data.
+  unsigned NumElements;
+
+  /// \brief The size of each value in Data, in bytes.
+  unsigned ElementSize;
+
+  PackedArrayInitExpr(QualType Ty, InitListExpr *SyntacticForm,
+                      const char *Data, unsigned NumElements,
+                      unsigned ElementSize)
+    : Expr(PackedArrayInitExprClass, Ty, VK_RValue, OK_Ordinary,
+           false, false, false, false),
+      SyntacticForm(SyntacticForm), Data(Data), NumElements(NumElements),
+      ElementSize(ElementSize) { }
+
+public:
+  /// \brief Create the initializer of an array of type \p Ty from the
+  /// integer literals of \p SyntacticForm.
+  static PackedArrayInitExpr *Create(const ASTContext &C, QualType Ty,
+                                     InitListExpr *SyntacticForm);
+
+  /// \brief Create an empty initializer with room for \p NumElements values
+  /// of \p ElementSize bytes.
+  static PackedArrayInitExpr *CreateEmpty(const ASTContext &C,
+                                          unsigned NumElements,
+                                          unsigned ElementSize);
+
+  /// \brief Determine whether \p ILE, the syntactic form of an initializer
+  /// of an array of type \p Ty, can be represented as a
+  /// PackedArrayInitExpr.
+  static bool isPackable(const ASTContext &C, QualType Ty,
+                         const InitListExpr *ILE);
+
+  InitListExpr *getSyntacticForm() const {
+    return cast_or_null<InitListExpr>(SyntacticForm);
+  }
+  void setSyntacticForm(InitListExpr *E) { SyntacticForm = E; }
+
+  /// \brief Set the element values from the integer literals of the
+  /// syntactic form, which must already be set along with the type.
+  void setElementsFromSyntacticForm();
+
+  /// \brief Retrieve the type of the array elements.
+  QualType getElementType() const {
+    return getType()->castAsArrayTypeUnsafe()->getElementType();
+  }
+
+  /// \brief Retrieve the number of explicitly initialized elements.
+  unsigned getNumElements() const { return NumElements; }
+
+  /// \brief Retrieve the size of each element, in bytes.
+  unsigned getElementSize() const { return ElementSize; }
+
+  /// \brief Retrieve the value of the element at \p I, zero-extended.
+  uint64_t getElement(unsigned I) const;
+
+  /// \brief Retrieve the packed element values.
+  StringRef getBytes() const {
+    return StringRef(Data, NumElements * ElementSize);
+  }
+
+  /// \brief Set the value of the element at \p I, truncated to the element
+  /// size.
+  void setElement(unsigned I, uint64_t Value);
+
+  SourceLocation getLocStart() const LLVM_READONLY {
+    return SyntacticForm ? SyntacticForm->getLocStart() : SourceLocation();
+  }
+  SourceLocation getLocEnd() const LLVM_READONLY {
+    return SyntacticForm ? SyntacticForm->getLocEnd() : SourceLocation();
+  }
+
+  static bool classof(const Stmt *T) {
+    return T->getStmtClass() == PackedArrayInitExprClass;
+  }
+
+  // Iterators
+  child_range children() {
+    return child_range(&SyntacticForm, &SyntacticForm + 1);
+  }
+};
+
 /// @brief Represents a C99 designated initializer expression.
 ///
 /// A designated initializer expression (C99 6.7.8) contains one or
@@ -1159,6 +1159,8 @@ public:
 };
 
 /// \brief Represents a call to a C++ constructor.
+///
+/// The arguments are allocated directly after the (most derived) object.
 class CXXConstructExpr : public Expr {
 public:
   enum ConstructionKind {
@@ -1180,10 +1182,14 @@ private:
   unsigned StdInitListInitialization : 1;
   unsigned ZeroInitialization : 1;
   unsigned ConstructKind : 2;
-  Stmt **Args;
 
   void setConstructor(CXXConstructorDecl *C) { Constructor = C; }
 
+  inline Stmt **getTrailingArgs();
+  const Stmt *const *getTrailingArgs() const {
+    return const_cast<CXXConstructExpr *>(this)->getTrailingArgs();
+  }
+
 protected:
   CXXConstructExpr(const ASTContext &C, StmtClass SC, QualType T,
                    SourceLocation Loc,
@@ -1198,17 +1204,9 @@ protected:
                    SourceRange ParenOrBraceRange);
 
   /// \brief Construct an empty C++ construction expression.
-  CXXConstructExpr(StmtClass SC, EmptyShell Empty)
-    : Expr(SC, Empty), Constructor(nullptr), NumArgs(0), Elidable(false),
-      HadMultipleCandidates(false), ListInitialization(false),
-      ZeroInitialization(false), ConstructKind(0), Args(nullptr)
-  { }
+  CXXConstructExpr(StmtClass SC, EmptyShell Empty, unsigned NumArgs);
 
 public:
-  /// \brief Construct an empty C++ construction expression.
-  explicit CXXConstructExpr(EmptyShell Empty)
-    : CXXConstructExpr(CXXConstructExprClass, Empty) {}
-
   static CXXConstructExpr *Create(const ASTContext &C, QualType T,
                                   SourceLocation Loc,
                                   CXXConstructorDecl *Ctor,
@@ -1221,6 +1219,10 @@ public:
                                   ConstructionKind ConstructKind,
                                   SourceRange ParenOrBraceRange);
 
+  /// \brief Create an empty C++ construction expression with room for
+  /// \p NumArgs arguments.
+  static CXXConstructExpr *CreateEmpty(const ASTContext &C, unsigned NumArgs);
+
   /// \brief Get the constructor that this expression will (ultimately) call.
   CXXConstructorDecl *getConstructor() const { return Constructor; }
 
@@ -1273,12 +1275,12 @@ public:
     return arg_const_range(arg_begin(), arg_end());
   }
 
-  arg_iterator arg_begin() { return Args; }
-  arg_iterator arg_end() { return Args + NumArgs; }
-  const_arg_iterator arg_begin() const { return Args; }
-  const_arg_iterator arg_end() const { return Args + NumArgs; }
+  arg_iterator arg_begin() { return getTrailingArgs(); }
+  arg_iterator arg_end() { return getTrailingArgs() + NumArgs; }
+  const_arg_iterator arg_begin() const { return getTrailingArgs(); }
+  const_arg_iterator arg_end() const { return getTrailingArgs() + NumArgs; }
 
-  Expr **getArgs() { return reinterpret_cast<Expr **>(Args); }
+  Expr **getArgs() { return reinterpret_cast<Expr **>(getTrailingArgs()); }
   const Expr *const *getArgs() const {
     return const_cast<CXXConstructExpr *>(this)->getArgs();
   }
@@ -1287,17 +1289,17 @@ public:
   /// \brief Return the specified argument.
   Expr *getArg(unsigned Arg) {
     assert(Arg < NumArgs && "Arg access out of range!");
-    return cast<Expr>(Args[Arg]);
+    return cast<Expr>(getTrailingArgs()[Arg]);
   }
   const Expr *getArg(unsigned Arg) const {
     assert(Arg < NumArgs && "Arg access out of range!");
-    return cast<Expr>(Args[Arg]);
+    return cast<Expr>(getTrailingArgs()[Arg]);
   }
 
   /// \brief Set the specified argument.
   void setArg(unsigned Arg, Expr *ArgExpr) {
     assert(Arg < NumArgs && "Arg access out of range!");
-    Args[Arg] = ArgExpr;
+    getTrailingArgs()[Arg] = ArgExpr;
   }
 
   SourceLocation getLocStart() const LLVM_READONLY;
@@ -1312,7 +1314,7 @@ public:
 
   // Iterators
   child_range children() {
-    return child_range(&Args[0], &Args[0]+NumArgs);
+    return child_range(getTrailingArgs(), getTrailingArgs() + NumArgs);
   }
 
   friend class ASTStmtReader;
@@ -1454,7 +1456,6 @@ public:
 class CXXTemporaryObjectExpr : public CXXConstructExpr {
   TypeSourceInfo *Type;
 
-public:
   CXXTemporaryObjectExpr(const ASTContext &C,
                          CXXConstructorDecl *Cons,
                          TypeSourceInfo *Type,
@@ -1464,8 +1465,22 @@ public:
                          bool ListInitialization,
                          bool StdInitListInitialization,
                          bool ZeroInitialization);
-  explicit CXXTemporaryObjectExpr(EmptyShell Empty)
-    : CXXConstructExpr(CXXTemporaryObjectExprClass, Empty), Type() { }
+  CXXTemporaryObjectExpr(EmptyShell Empty, unsigned NumArgs)
+    : CXXConstructExpr(CXXTemporaryObjectExprClass, Empty, NumArgs),
+      Type() { }
+
+public:
+  static CXXTemporaryObjectExpr *Create(const ASTContext &C,
+                                        CXXConstructorDecl *Cons,
+                                        TypeSourceInfo *Type,
+                                        ArrayRef<Expr *> Args,
+                                        SourceRange ParenOrBraceRange,
+                                        bool HadMultipleCandidates,
+                                        bool ListInitialization,
+                                        bool StdInitListInitialization,
+                                        bool ZeroInitialization);
+  static CXXTemporaryObjectExpr *CreateEmpty(const ASTContext &C,
+                                             unsigned NumArgs);
 
   TypeSourceInfo *getTypeSourceInfo() const { return Type; }
 
@@ -1479,6 +1494,12 @@ public:
   friend class ASTStmtReader;
 };
 
+inline Stmt **CXXConstructExpr::getTrailingArgs() {
+  if (auto *E = dyn_cast<CXXTemporaryObjectExpr>(this))
+    return reinterpret_cast<Stmt **>(E + 1);
+  return reinterpret_cast<Stmt **>(this + 1);
+}
+
 /// \brief A C++ lambda expression, which produces a function object
 /// (of unspecified type) that can be invoked later.
 ///
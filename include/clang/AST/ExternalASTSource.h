@@ -21,6 +21,7 @@
 namespace clang {
 
 class ASTConsumer;
+class ASTRecordLayout;
 class CXXBaseSpecifier;
 class CXXCtorInitializer;
 class DeclarationName;
@@ -169,6 +170,16 @@ public:
   /// Return a descriptor for the corresponding module, if one exists.
   virtual llvm::Optional<ASTSourceDescriptor> getSourceDescriptor(unsigned ID);
 
+  enum ExtKind { EK_Always, EK_Never, EK_ReplyHazy };
+
+  /// \brief Returns whether the definition of \p D is emitted in the object
+  /// file of the module that provides it, as with -fmodules-codegen.
+  ///
+  /// EK_Always means that another object file has the definition, EK_Never
+  /// that the current one must, and EK_ReplyHazy that this source does not
+  /// know.
+  virtual ExtKind hasExternalDefinitions(const Decl *D);
+
   /// \brief Finds all declarations lexically contained within the given
   /// DeclContext, after applying an optional filter predicate.
   ///
@@ -275,6 +286,17 @@ public:
       llvm::DenseMap<const CXXRecordDecl *, CharUnits> &BaseOffsets,
       llvm::DenseMap<const CXXRecordDecl *, CharUnits> &VirtualBaseOffsets);
 
+  /// \brief Retrieve the complete layout of the given record, as it was
+  /// computed when the external source was built.
+  ///
+  /// Unlike \c layoutRecordType, the returned layout is used as-is and the
+  /// record is not laid out again.
+  ///
+  /// \returns the layout, allocated in the AST context, or null if the
+  /// external source has no layout for the record.
+  virtual const ASTRecordLayout *
+  getExternalRecordLayout(const RecordDecl *Record);
+
   //===--------------------------------------------------------------------===//
   // Queries for performance analysis.
   //===--------------------------------------------------------------------===//
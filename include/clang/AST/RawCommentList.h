@@ -13,6 +13,7 @@
 #include "clang/Basic/CommentOptions.h"
 #include "clang/Basic/SourceManager.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace clang {
 
@@ -189,10 +190,31 @@ public:
     return Comments;
   }
 
+  /// \brief A comment and the offset it begins at in its file.
+  typedef std::pair<unsigned, RawComment *> CommentInFile;
+
+  /// \brief Returns the comments in \p File, sorted by offset.
+  ///
+  /// Looking for the comments next to a declaration in these only takes
+  /// comparisons of offsets, rather than of source locations across the
+  /// translation unit.  The index is updated with the comments added since the
+  /// last call.
+  ArrayRef<CommentInFile> getCommentsInFile(FileID File) const;
+
 private:
   SourceManager &SourceMgr;
   std::vector<RawComment *> Comments;
 
+  /// \brief The comments of each file, for the first NumIndexedComments
+  /// comments.
+  mutable llvm::DenseMap<FileID, std::vector<CommentInFile>> FileComments;
+  mutable unsigned NumIndexedComments = 0;
+
+  void invalidateFileComments() {
+    FileComments.clear();
+    NumIndexedComments = 0;
+  }
+
   void addDeserializedComments(ArrayRef<RawComment *> DeserializedComments);
 
   friend class ASTReader;
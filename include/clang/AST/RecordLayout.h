@@ -131,6 +131,8 @@ private:
   CXXRecordLayoutInfo *CXXInfo;
 
   friend class ASTContext;
+  friend class ASTReader;
+  friend class ASTWriter;
 
   ASTRecordLayout(const ASTContext &Ctx, CharUnits size, CharUnits alignment,
                   CharUnits requiredAlignment, CharUnits datasize,
@@ -2151,6 +2151,10 @@ DEF_TRAVERSE_STMT(InitListExpr, {
   ShouldVisitChildren = false;
 })
 
+// The packed values have no expressions of their own; the only child is the
+// list as written.
+DEF_TRAVERSE_STMT(PackedArrayInitExpr, {})
+
 // GenericSelectionExpr is a special case because the types and expressions
 // are interleaved.  We also need to watch out for null types (default
 // generic associations).
@@ -360,6 +360,9 @@ public:
 
   // global temp stats (until we have a per-module visitor)
   static void addStmtClass(const StmtClass s);
+  /// \brief Account for memory a node of class \p s owns beyond its own
+  /// size, such as trailing or separately allocated operands.
+  static void addStmtExtraBytes(const StmtClass s, size_t Bytes);
   static void EnableStatistics();
   static void PrintStats();
 
@@ -42,6 +42,7 @@
 #define LLVM_CLANG_ASTMATCHERS_ASTMATCHFINDER_H
 
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/Timer.h"
@@ -133,6 +134,27 @@ public:
     ///
     /// It prints a report after match.
     llvm::Optional<Profiling> CheckProfiling;
+
+    /// \brief The number of threads \c matchAST() may match on.
+    ///
+    /// With more than one, the top-level declarations of the translation
+    /// unit are split into partitions that are matched concurrently, each
+    /// with its own memoization tables. The callbacks are still run on the
+    /// calling thread, once everything is matched, in the order of a serial
+    /// traversal.
+    ///
+    /// The AST is not locked: all the matchers must be safe to run
+    /// concurrently on the same \c ASTContext, which only holds for matchers
+    /// that read the structure, names and types of nodes, such as
+    /// \c hasName(), \c hasType(), \c isDerivedFrom() or \c hasAncestor()
+    /// (the parent map is computed before matching starts). Many queries
+    /// fill caches without synchronization and must not be used, directly
+    /// or through a custom matcher: \c SourceManager lookups (for example
+    /// \c isExpansionInMainFile()), linkage (\c isExternC()), type sizes and
+    /// record layouts, constant evaluation, comments and name mangling.
+    /// Matching is serial for ASTs with an external source, and with
+    /// \c CheckProfiling.
+    unsigned NumThreads = 1;
   };
 
   MatchFinder(MatchFinderOptions Options = MatchFinderOptions());
@@ -210,6 +232,16 @@ public:
     std::vector<std::pair<TypeLocMatcher, MatchCallback *>> TypeLoc;
     /// \brief All the callbacks in one container to simplify iteration.
     llvm::SmallPtrSet<MatchCallback *, 16> AllCallbacks;
+
+    /// \brief Indices into \c DeclOrStmt of the matchers that can match nodes
+    /// of each kind, including kinds derived from the one they match.
+    ///
+    /// Computed for a kind the first time a node of that kind is matched, and
+    /// kept for the following traversals until another \c Decl or \c Stmt
+    /// matcher is added.
+    mutable llvm::DenseMap<ast_type_traits::ASTNodeKind,
+                           std::vector<unsigned short>>
+        DeclOrStmtFilters;
   };
 
 private:
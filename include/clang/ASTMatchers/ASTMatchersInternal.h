@@ -224,6 +224,9 @@ public:
     return Bindings < Other.Bindings;
   }
 
+  /// \brief Returns \c true if nothing was bound.
+  bool isEmpty() const { return Bindings.empty(); }
+
   /// \brief Returns \c true if this \c BoundNodesTreeBuilder can be compared,
   /// i.e. all stored node maps have memoization data.
   bool isComparable() const {
@@ -257,6 +260,14 @@ public:
   virtual bool dynMatches(const ast_type_traits::DynTypedNode &DynNode,
                           ASTMatchFinder *Finder,
                           BoundNodesTreeBuilder *Builder) const = 0;
+
+  /// \brief Appends the implementations of the matchers this matcher runs.
+  ///
+  /// The finder uses them to find the matchers that several registered
+  /// matchers have in common, and runs those only once for each node.
+  /// Matchers that do not override this are never shared.
+  virtual void
+  getInnerMatchers(SmallVectorImpl<const DynMatcherInterface *> &Inner) const {}
 };
 
 /// \brief Generic interface for matchers on an AST node of type T.
@@ -390,6 +401,12 @@ public:
                           reinterpret_cast<uint64_t>(Implementation.get()));
   }
 
+  /// \brief Returns the implementation, which is shared by the matchers that
+  /// \c dynCastTo() creates from this one.
+  const DynMatcherInterface *getImplementation() const {
+    return Implementation.get();
+  }
+
   /// \brief Returns the type this matcher works on.
   ///
   /// \c matches() will always return false unless the node passed is of this
@@ -453,6 +470,11 @@ protected:
   explicit WrapperMatcherInterface(DynTypedMatcher &&InnerMatcher)
       : InnerMatcher(std::move(InnerMatcher)) {}
 
+  void getInnerMatchers(
+      SmallVectorImpl<const DynMatcherInterface *> &Inner) const override {
+    Inner.push_back(InnerMatcher.getImplementation());
+  }
+
   const DynTypedMatcher InnerMatcher;
 };
 
@@ -935,6 +957,14 @@ public:
 
   virtual ASTContext &getASTContext() const = 0;
 
+  /// \brief Returns \c Matcher.dynMatches(Node, this, Builder).
+  ///
+  /// A matcher that several registered matchers share is only run once on
+  /// each node, as long as nothing is bound when it is run.
+  virtual bool dynMatchesShared(const DynMatcherInterface &Matcher,
+                                const ast_type_traits::DynTypedNode &Node,
+                                BoundNodesTreeBuilder *Builder) = 0;
+
 protected:
   virtual bool matchesChildOf(const ast_type_traits::DynTypedNode &Node,
                               const DynTypedMatcher &Matcher,
@@ -83,7 +83,8 @@
 
 /// \brief AST_MATCHER(Type, DefineMatcher) { ... }
 /// defines a zero parameter function named DefineMatcher() that returns a
-/// Matcher<Type> object.
+/// Matcher<Type> object. Every call returns the same matcher, so that the
+/// match finder runs it only once per node however many matchers use it.
 ///
 /// The code between the curly braces has access to the following variables:
 ///
@@ -105,8 +106,10 @@
   };                                                                           \
   }                                                                            \
   inline ::clang::ast_matchers::internal::Matcher<Type> DefineMatcher() {      \
-    return ::clang::ast_matchers::internal::makeMatcher(                       \
-        new internal::matcher_##DefineMatcher##Matcher());                     \
+    static const ::clang::ast_matchers::internal::Matcher<Type> Instance =     \
+        ::clang::ast_matchers::internal::makeMatcher(                          \
+            new internal::matcher_##DefineMatcher##Matcher());                 \
+    return Instance;                                                           \
   }                                                                            \
   inline bool internal::matcher_##DefineMatcher##Matcher::matches(             \
       const Type &Node,                                                        \
@@ -17,7 +17,7 @@
 #define LLVM_CLANG_ANALYSIS_ANALYSES_CFGREACHABILITYANALYSIS_H
 
 #include "llvm/ADT/BitVector.h"
-#include "llvm/ADT/DenseMap.h"
+#include <vector>
 
 namespace clang {
 
@@ -31,9 +31,9 @@ class CFGBlock;
 // duplication.
 class CFGReverseBlockReachabilityAnalysis {
   typedef llvm::BitVector ReachableSet;
-  typedef llvm::DenseMap<unsigned, ReachableSet> ReachableMap;
-  ReachableSet analyzed;
-  ReachableMap reachable;
+  /// The blocks that reach each destination block, by block ID; a row stays
+  /// empty until the first query for its destination.
+  std::vector<ReachableSet> reachable;
 public:
   CFGReverseBlockReachabilityAnalysis(const CFG &cfg);
 
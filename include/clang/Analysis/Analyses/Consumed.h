@@ -21,6 +21,7 @@
 #include "clang/Analysis/Analyses/PostOrderCFGView.h"
 #include "clang/Analysis/AnalysisContext.h"
 #include "clang/Basic/SourceLocation.h"
+#include <memory>
 
 namespace clang {
 namespace consumed {
@@ -138,11 +139,20 @@ namespace consumed {
     
     bool Reachable;
     const Stmt *From;
-    VarMapType VarMap;
+    /// The states of the variables. Copies of a map share it until one of
+    /// them changes the state of a variable, so that the maps of blocks that
+    /// don't touch any tracked variable are never copied.
+    std::shared_ptr<VarMapType> VarMap;
     TmpMapType TmpMap;
     
+    /// \brief Get the variable states for modification, unsharing them first
+    /// if another map refers to them.
+    VarMapType &getMutableVarMap();
+
   public:
-    ConsumedStateMap() : Reachable(true), From(nullptr) {}
+    ConsumedStateMap()
+      : Reachable(true), From(nullptr),
+        VarMap(std::make_shared<VarMapType>()) {}
     ConsumedStateMap(const ConsumedStateMap &Other)
       : Reachable(Other.Reachable), From(Other.From), VarMap(Other.VarMap),
         TmpMap() {}
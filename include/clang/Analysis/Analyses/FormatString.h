@@ -20,6 +20,8 @@
 #define LLVM_CLANG_ANALYSIS_ANALYSES_FORMATSTRING_H
 
 #include "clang/AST/CanonicalType.h"
+#include "llvm/ADT/StringMap.h"
+#include <vector>
 
 namespace clang {
 
@@ -665,6 +667,44 @@ bool ParsePrintfString(FormatStringHandler &H,
                        const char *beg, const char *end, const LangOptions &LO,
                        const TargetInfo &Target, bool isFreeBSDKPrintf);
 
+/// \brief Remembers the specifiers that ParsePrintfString found in format
+/// strings, by contents, so that a string that is checked many times, such as
+/// the one in a logging macro, is only parsed once.
+///
+/// A string is replayed from the cache only if its parse reported nothing but
+/// specifiers to the handler; any other string is parsed again each time.
+/// The cache must only be used with one set of language options and target.
+class PrintfStringCache {
+public:
+  /// \brief Returns a copy of \p Str owned by the cache, which is the string
+  /// that must be passed to parse().
+  ///
+  /// The handler is given pointers into this copy, so it must compute offsets
+  /// relative to its start.
+  StringRef intern(StringRef Str, bool isFreeBSDKPrintf);
+
+  /// \brief Equivalent to ParsePrintfString on \p Str, which must have been
+  /// returned by intern() for the same \p isFreeBSDKPrintf.
+  bool parse(FormatStringHandler &H, StringRef Str, const LangOptions &LO,
+             const TargetInfo &Target, bool isFreeBSDKPrintf);
+
+  /// \brief A specifier as it was passed to the handler.
+  struct Specifier {
+    analyze_printf::PrintfSpecifier FS;
+    const char *Start;
+    unsigned Length;
+  };
+
+private:
+  struct Entry {
+    enum { NotParsed, Replayable, NotReplayable } State = NotParsed;
+    std::vector<Specifier> Specifiers;
+  };
+
+  /// \brief The strings seen so far, for printf and for FreeBSD kprintf.
+  llvm::StringMap<Entry> Strings[2];
+};
+
 bool ParseFormatStringHasSArg(const char *beg, const char *end,
                               const LangOptions &LO, const TargetInfo &Target);
 
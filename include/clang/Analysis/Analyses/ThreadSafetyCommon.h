@@ -269,12 +269,16 @@ public:
     return CapabilityExpr(CapExpr, !Negated);
   }
 
+  // Facts and lookups often share the translation of one expression, which
+  // is trivially equal to itself.
   bool equals(const CapabilityExpr &other) const {
-    return (Negated == other.Negated) && sx::equals(CapExpr, other.CapExpr);
+    return (Negated == other.Negated) &&
+           (CapExpr == other.CapExpr || sx::equals(CapExpr, other.CapExpr));
   }
 
   bool matches(const CapabilityExpr &other) const {
-    return (Negated == other.Negated) && sx::matches(CapExpr, other.CapExpr);
+    return (Negated == other.Negated) &&
+           (CapExpr == other.CapExpr || sx::matches(CapExpr, other.CapExpr));
   }
 
   bool matchesUniv(const CapabilityExpr &CapE) const {
@@ -18,6 +18,7 @@
 #include "clang/AST/Decl.h"
 #include "clang/Analysis/CFG.h"
 #include "clang/Analysis/CodeInjector.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/FoldingSet.h"
 #include "llvm/Support/Allocator.h"
@@ -80,6 +81,7 @@ class AnalysisDeclContext {
   std::unique_ptr<ParentMap> PM;
   std::unique_ptr<PseudoConstantAnalysis> PCA;
   std::unique_ptr<CFGReverseBlockReachabilityAnalysis> CFA;
+  std::unique_ptr<llvm::BitVector> ReachableBlocks;
 
   llvm::BumpPtrAllocator A;
 
@@ -87,6 +89,12 @@ class AnalysisDeclContext {
 
   void *ManagedAnalyses;
 
+  /// When the manager last handed out this context, for releasing the least
+  /// recently used contexts first.
+  uint64_t LastUse = 0;
+
+  friend class AnalysisDeclContextManager;
+
 public:
   AnalysisDeclContext(AnalysisDeclContextManager *Mgr,
                   const Decl *D);
@@ -158,6 +166,15 @@ public:
 
   CFGReverseBlockReachabilityAnalysis *getCFGReachablityAnalysis();
 
+  /// \brief Returns the blocks of the CFG that are reachable from its entry
+  /// along the edges it keeps, by block ID, or null if there is no CFG.
+  ///
+  /// Without EH edges, the dispatch blocks of try statements that have no
+  /// predecessors count as reachable too, as their handlers would otherwise
+  /// all seem dead. The result is computed once and shared by the analyses
+  /// of this declaration.
+  const llvm::BitVector *getReachableBlocks();
+
   /// Return a version of the CFG without any edges pruned.
   CFG *getUnoptimizedCFG();
 
@@ -412,6 +429,9 @@ class AnalysisDeclContextManager {
   LocationContextManager LocContexts;
   CFG::BuildOptions cfgBuildOptions;
 
+  /// The number of times a context was handed out, for stamping LastUse.
+  uint64_t NumUses = 0;
+
   /// Pointer to an interface that can provide function bodies for
   /// declarations from external source.
   std::unique_ptr<CodeInjector> Injector;
@@ -472,6 +492,14 @@ public:
   /// Discard all previously created AnalysisDeclContexts.
   void clear();
 
+  /// Discard the LocationContexts created so far, with the analyses using them
+  /// complete, and the AnalysisDeclContexts of the declarations for which
+  /// \p IsFinished holds. Of the other AnalysisDeclContexts, keep only the
+  /// \p MaxRetained most recently used, for the functions likely to be
+  /// inlined again.
+  void releaseContexts(llvm::function_ref<bool(const Decl *)> IsFinished,
+                       unsigned MaxRetained);
+
 private:
   friend class AnalysisDeclContext;
 
@@ -739,6 +739,13 @@ public:
     bool AddCXXNewAllocator;
     bool AddCXXDefaultInitExprInCtors;
 
+    /// \brief If non-zero, building the CFG fails once it has more blocks.
+    unsigned MaxBlocks;
+
+    /// \brief If non-null, set to true when building the CFG fails because
+    /// of MaxBlocks.
+    bool *ExceededMaxBlocks;
+
     bool alwaysAdd(const Stmt *stmt) const {
       return alwaysAddMask[stmt->getStmtClass()];
     }
@@ -758,7 +765,8 @@ public:
         PruneTriviallyFalseEdges(true), AddEHEdges(false),
         AddInitializers(false), AddImplicitDtors(false),
         AddTemporaryDtors(false), AddStaticInitBranches(false),
-        AddCXXNewAllocator(false), AddCXXDefaultInitExprInCtors(false) {}
+        AddCXXNewAllocator(false), AddCXXDefaultInitExprInCtors(false),
+        MaxBlocks(0), ExceededMaxBlocks(nullptr) {}
   };
 
   /// \brief Provides a custom implementation of the iterator class to have the
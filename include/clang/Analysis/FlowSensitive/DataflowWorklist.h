@@ -0,0 +1,80 @@
+//===- DataflowWorklist.h - Worklist for dataflow analyses ------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines the worklists of CFG blocks shared by the dataflow
+// analyses over source-level CFGs.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_ANALYSIS_FLOWSENSITIVE_DATAFLOWWORKLIST_H
+#define LLVM_CLANG_ANALYSIS_FLOWSENSITIVE_DATAFLOWWORKLIST_H
+
+#include "clang/Analysis/Analyses/PostOrderCFGView.h"
+#include "clang/Analysis/CFG.h"
+#include "llvm/ADT/BitVector.h"
+#include <vector>
+
+namespace clang {
+
+/// \brief A worklist of CFG blocks which always hands out the enqueued block
+/// that comes first in the order of the analysis, so that a block is usually
+/// analyzed only after the blocks whose values flow into it.
+///
+/// A block is in the worklist at most once. The order is that of a
+/// PostOrderCFGView, looked up by block ID; blocks that are unreachable from
+/// the entry come last.
+class DataflowWorklistBase {
+  /// \brief The position of each block in the order of the analysis, by block
+  /// ID.
+  std::vector<unsigned> Position;
+
+  /// \brief The blocks that are in the worklist, by block ID.
+  llvm::BitVector EnqueuedBlocks;
+
+  /// \brief A min-heap of the enqueued blocks by position.
+  std::vector<const CFGBlock *> Heap;
+
+protected:
+  /// \param Backward Whether to order the blocks in post order instead of
+  /// reverse post order.
+  DataflowWorklistBase(const CFG &Cfg, const PostOrderCFGView &POV,
+                       bool Backward);
+
+public:
+  /// \brief Adds \p Block to the worklist unless it is null or already in it.
+  void enqueueBlock(const CFGBlock *Block);
+
+  /// \brief Removes and returns the first block of the worklist, or returns
+  /// null if the worklist is empty.
+  const CFGBlock *dequeue();
+
+  bool empty() const { return Heap.empty(); }
+};
+
+/// \brief A worklist for forward analyses, ordered in reverse post order.
+class ForwardDataflowWorklist : public DataflowWorklistBase {
+public:
+  ForwardDataflowWorklist(const CFG &Cfg, const PostOrderCFGView &POV)
+      : DataflowWorklistBase(Cfg, POV, /*Backward=*/false) {}
+
+  void enqueueSuccessors(const CFGBlock *Block);
+};
+
+/// \brief A worklist for backward analyses, ordered in post order.
+class BackwardDataflowWorklist : public DataflowWorklistBase {
+public:
+  BackwardDataflowWorklist(const CFG &Cfg, const PostOrderCFGView &POV)
+      : DataflowWorklistBase(Cfg, POV, /*Backward=*/true) {}
+
+  void enqueuePredecessors(const CFGBlock *Block);
+};
+
+} // end namespace clang
+
+#endif
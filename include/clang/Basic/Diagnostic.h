@@ -20,6 +20,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/Specifiers.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/iterator_range.h"
@@ -254,6 +255,29 @@ private:
   typedef std::vector<DiagStatePoint> DiagStatePointsTy;
   mutable DiagStatePointsTy DiagStatePoints;
 
+  /// \brief The index in DiagStatePoints of the point last returned by
+  /// GetDiagStatePointForLoc, which is checked before searching the points
+  /// since consecutive queries tend to be close together.
+  mutable unsigned LastDiagStatePointIdx;
+
+  /// \brief The builtin diagnostics that are ignored in every diagnostic
+  /// state, by diagnostic ID; only meaningful where IgnoredEverywhereKnown
+  /// is set.
+  mutable llvm::BitVector IgnoredEverywhere;
+
+  /// \brief The builtin diagnostics for which IgnoredEverywhere has been
+  /// computed since their mappings or the global severity flags last changed.
+  mutable llvm::BitVector IgnoredEverywhereKnown;
+
+  /// \brief Determine whether the builtin diagnostic \p DiagID is mapped to
+  /// be ignored in every diagnostic state, so that it is ignored wherever it
+  /// is reported.
+  bool isIgnoredEverywhere(unsigned DiagID) const;
+
+  /// \brief Forget which diagnostics are ignored everywhere, after the
+  /// mappings of many diagnostics or a global severity flag changed.
+  void forgetIgnoredEverywhere() { IgnoredEverywhereKnown.reset(); }
+
   /// \brief Keeps the DiagState that was active during each diagnostic 'push'
   /// so we can get back at it when we 'pop'.
   std::vector<DiagState *> DiagStateOnPushStack;
@@ -438,14 +462,20 @@ public:
   /// \brief When set to true, any unmapped warnings are ignored.
   ///
   /// If this and WarningsAsErrors are both set, then this one wins.
-  void setIgnoreAllWarnings(bool Val) { IgnoreAllWarnings = Val; }
+  void setIgnoreAllWarnings(bool Val) {
+    IgnoreAllWarnings = Val;
+    forgetIgnoredEverywhere();
+  }
   bool getIgnoreAllWarnings() const { return IgnoreAllWarnings; }
 
   /// \brief When set to true, any unmapped ignored warnings are no longer
   /// ignored.
   ///
   /// If this and IgnoreAllWarnings are both set, then that one wins.
-  void setEnableAllWarnings(bool Val) { EnableAllWarnings = Val; }
+  void setEnableAllWarnings(bool Val) {
+    EnableAllWarnings = Val;
+    forgetIgnoredEverywhere();
+  }
   bool getEnableAllWarnings() const { return EnableAllWarnings; }
 
   /// \brief When set to true, any warnings reported are issued as errors.
@@ -519,7 +549,10 @@ public:
   /// mapped onto ignore/warning/error. 
   ///
   /// This corresponds to the GCC -pedantic and -pedantic-errors option.
-  void setExtensionHandlingBehavior(diag::Severity H) { ExtBehavior = H; }
+  void setExtensionHandlingBehavior(diag::Severity H) {
+    ExtBehavior = H;
+    forgetIgnoredEverywhere();
+  }
   diag::Severity getExtensionHandlingBehavior() const { return ExtBehavior; }
 
   /// \brief Counter bumped when an __extension__  block is/ encountered.
@@ -265,6 +265,15 @@ private:
   getDiagnosticSeverity(unsigned DiagID, SourceLocation Loc,
                         const DiagnosticsEngine &Diag) const LLVM_READONLY;
 
+  /// \brief Compute the severity of \p DiagID under \p Mapping and the
+  /// global flags of \p Diag, before the adjustments that depend on where
+  /// the diagnostic is reported.
+  ///
+  /// These adjustments never turn an ignored diagnostic into a reported one.
+  diag::Severity getMappedSeverity(unsigned DiagID,
+                                   const DiagnosticMapping &Mapping,
+                                   const DiagnosticsEngine &Diag) const;
+
   /// \brief Used to report a diagnostic that is finally fully formed.
   ///
   /// \returns \c true if the diagnostic was emitted, \c false if it was
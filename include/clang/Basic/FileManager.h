@@ -24,8 +24,11 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Allocator.h"
+#include <atomic>
 #include <memory>
 #include <map>
+#include <mutex>
+#include <thread>
 
 namespace llvm {
 class MemoryBuffer;
@@ -107,6 +110,38 @@ public:
 
 struct FileData;
 
+/// \brief The contents of files read by the FileManagers of several
+/// compilations, which may run on different threads, by absolute path.
+///
+/// Files are assumed not to change while their contents are shared. The
+/// buffers are split into shards by path, each with its own lock, so that
+/// threads reading different files rarely wait for each other.
+class SharedFileBuffers {
+  enum { NumShards = 16 };
+  struct Shard {
+    std::mutex Mutex;
+    llvm::StringMap<std::unique_ptr<llvm::MemoryBuffer>> Buffers;
+  };
+  Shard Shards[NumShards];
+
+  Shard &getShard(StringRef Path);
+
+public:
+  SharedFileBuffers();
+  ~SharedFileBuffers();
+
+  /// \brief Look up the contents of the file at \p Path, which live as long
+  /// as this object. Returns null if they are not known.
+  const llvm::MemoryBuffer *lookup(StringRef Path);
+
+  /// \brief Record \p Buffer as the contents of the file at \p Path, unless
+  /// another thread did so first.
+  ///
+  /// \returns the recorded contents.
+  const llvm::MemoryBuffer *insert(StringRef Path,
+                                   std::unique_ptr<llvm::MemoryBuffer> Buffer);
+};
+
 /// \brief Implements support for file system lookup, file system caching,
 /// and directory search management.
 ///
@@ -165,6 +200,14 @@ class FileManager : public RefCountedBase<FileManager> {
   // Caching.
   std::unique_ptr<FileSystemStatCache> StatCache;
 
+  /// \brief The contents of files shared with other FileManagers, if any.
+  SharedFileBuffers *SharedBuffers;
+
+  /// \brief The thread started by \c prefetchFiles, if any, and whether it
+  /// should stop before reading the rest of its files.
+  std::thread PrefetchThread;
+  std::atomic<bool> StopPrefetch;
+
   bool getStatValue(const char *Path, FileData &Data, bool isFile,
                     std::unique_ptr<vfs::File> *F);
 
@@ -197,6 +240,13 @@ public:
   /// \brief Removes all FileSystemStatCache objects from the manager.
   void clearStatCaches();
 
+  /// \brief Shares the contents of the files with absolute paths that this
+  /// manager reads through \p Buffers, which must outlive it. Volatile files
+  /// are always read anew.
+  void setSharedFileBuffers(SharedFileBuffers *Buffers) {
+    SharedBuffers = Buffers;
+  }
+
   /// \brief Lookup, cache, and verify the specified directory (real or
   /// virtual).
   ///
@@ -236,11 +286,16 @@ public:
 
   /// \brief Open the specified file as a MemoryBuffer, returning a new
   /// MemoryBuffer if successful, otherwise returning null.
+  ///
+  /// Clients that don't need a null terminator should say so: a file whose
+  /// size is a multiple of the page size must otherwise be copied rather than
+  /// mapped.
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
   getBufferForFile(const FileEntry *Entry, bool isVolatile = false,
-                   bool ShouldCloseOpenFile = true);
+                   bool ShouldCloseOpenFile = true,
+                   bool RequiresNullTerminator = true);
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
-  getBufferForFile(StringRef Filename);
+  getBufferForFile(StringRef Filename, bool RequiresNullTerminator = true);
 
   /// \brief Get the 'stat' information for the given \p Path.
   ///
@@ -254,6 +309,19 @@ public:
   /// \brief Remove the real file \p Entry from the cache.
   void invalidateCache(const FileEntry *Entry);
 
+  /// \brief Starts reading the prerequisites of the Makefile-style dependency
+  /// file \p ListPath into the operating system's file cache on a background
+  /// thread, so that reading them later does not wait for the disk or the
+  /// network. A plain list of paths, one per line, is accepted as well.
+  ///
+  /// The files are read from the real file system, bypassing the virtual
+  /// one, and the FileManager's own caches are not affected.
+  void prefetchFiles(StringRef ListPath);
+
+  /// \brief Stops reading files ahead of time, and waits for the thread
+  /// started by \c prefetchFiles to finish.
+  void stopPrefetching();
+
   /// \brief If path is not absolute and FileSystemOptions set the working
   /// directory, the path is modified to be relative to the given
   /// working directory.
@@ -25,6 +25,15 @@ public:
   /// \brief If set, paths are resolved as if the working directory was
   /// set to the value of WorkingDir.
   std::string WorkingDir;
+
+  /// \brief If set, the path of a SharedStatCache file through which 'stat'
+  /// results are shared with other compiler processes.
+  std::string SharedStatCachePath;
+
+  /// \brief If set, a Makefile-style dependency file, such as one written by
+  /// an earlier build, whose prerequisites are read ahead of time into the
+  /// operating system's file cache.
+  std::string PrefetchFileList;
 };
 
 } // end namespace clang
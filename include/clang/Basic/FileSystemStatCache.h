@@ -16,9 +16,13 @@
 #define LLVM_CLANG_BASIC_FILESYSTEMSTATCACHE_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/FileSystem.h"
 #include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
 
 namespace clang {
 
@@ -126,6 +130,54 @@ public:
                        vfs::FileSystem &FS) override;
 };
 
+/// \brief The results of stat calls of absolute paths, shared by the
+/// FileManagers of several compilations, which may run on different threads.
+///
+/// The results are split into shards by path, each with its own lock, so that
+/// threads looking up different paths rarely wait for each other.
+class SharedStatResults {
+  enum { NumShards = 16 };
+  struct Shard {
+    std::mutex Mutex;
+    llvm::StringMap<llvm::Optional<FileData>> Results;
+  };
+  Shard Shards[NumShards];
+
+  Shard &getShard(StringRef Path);
+
+public:
+  /// \brief Look up the result of a stat of \p Path.
+  ///
+  /// \returns \c true if the result is known, in which case \p Result is set
+  /// to it, or to \c None if the path does not exist.
+  bool lookup(StringRef Path, llvm::Optional<FileData> &Result);
+
+  /// \brief Record the result of a stat of \p Path.
+  void insert(StringRef Path, const llvm::Optional<FileData> &Result);
+
+  /// \brief Forget all results.
+  void clear();
+};
+
+/// \brief A stat cache of one FileManager that shares its results with
+/// other FileManagers through a \c SharedStatResults.
+class SharedStatResultsCache : public FileSystemStatCache {
+  SharedStatResults &Shared;
+  std::vector<std::string> Directories;
+
+public:
+  /// \param Directories If not empty, only the stats of paths within these
+  /// directories are shared; others are passed on to the next cache.
+  explicit SharedStatResultsCache(
+      SharedStatResults &Shared,
+      std::vector<std::string> Directories = std::vector<std::string>())
+      : Shared(Shared), Directories(std::move(Directories)) {}
+
+  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+};
+
 } // end namespace clang
 
 #endif
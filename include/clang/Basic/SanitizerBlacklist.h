@@ -17,6 +17,8 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/SpecialCaseList.h"
 #include <memory>
@@ -27,6 +29,11 @@ class SanitizerBlacklist {
   std::unique_ptr<llvm::SpecialCaseList> SCL;
   SourceManager &SM;
 
+  /// \brief Whether each file is blacklisted, by category. CodeGen asks about
+  /// the location of every function and global, and they come from few
+  /// files, so this saves matching their names against the list each time.
+  mutable llvm::StringMap<llvm::DenseMap<FileID, bool>> BlacklistedFiles;
+
 public:
   SanitizerBlacklist(const std::vector<std::string> &BlacklistPaths,
                      SourceManager &SM);
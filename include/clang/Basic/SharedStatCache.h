@@ -0,0 +1,100 @@
+//===--- SharedStatCache.h - Process-shared 'stat' cache --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the SharedStatCache interface.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_SHAREDSTATCACHE_H
+#define LLVM_CLANG_BASIC_SHAREDSTATCACHE_H
+
+#include "clang/Basic/FileSystemStatCache.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include <memory>
+
+namespace clang {
+
+/// \brief A FileSystemStatCache whose entries live in a memory mapped file
+/// shared by every compiler process pointed at it.
+///
+/// The table is a fixed-size, open-addressed hash table keyed by an MD5 of
+/// the absolute path.  Each slot is guarded by a sequence counter, so any
+/// number of processes can read and write it concurrently without locks: a
+/// reader that races with a writer simply sees a miss.
+///
+/// Every entry records the modification time of its parent directory when
+/// it was written, and is only trusted while that time is unchanged.  Each
+/// process stats a given directory once, so the many probes header search
+/// makes into a directory turn into a single system call.  Directories
+/// modified within the last couple of seconds are not cached at all, since
+/// their modification times cannot be trusted to change again.
+///
+/// Because the contents of a file can change without touching its
+/// directory, only negative lookups and directories are cached; successful
+/// file lookups are always forwarded to the next cache in the chain.
+class SharedStatCache : public FileSystemStatCache {
+public:
+  struct Header;
+  struct Slot;
+
+private:
+  std::unique_ptr<llvm::sys::fs::mapped_file_region> Region;
+
+  /// \brief The working directory of this process, used to make relative
+  /// paths absolute before hashing them.
+  std::string WorkingDir;
+
+  /// \brief The time at which this cache was opened.
+  time_t OpenTime;
+
+  /// \brief The modification time of each parent directory we've looked at,
+  /// or -1 if the directory doesn't exist.  Directories that are too recently
+  /// modified to be trusted are recorded as -2.
+  llvm::StringMap<int64_t> ParentModTimes;
+
+  unsigned NumHits;
+  unsigned NumMisses;
+
+  SharedStatCache(std::unique_ptr<llvm::sys::fs::mapped_file_region> Region,
+                  StringRef WorkingDir);
+
+  Slot *getSlots();
+  unsigned getNumSlots();
+
+  /// \brief Compute the modification time of the directory containing
+  /// \p AbsPath, returning false if entries in it should not be cached.
+  bool getParentModTime(StringRef AbsPath, vfs::FileSystem &FS,
+                        int64_t &ModTime);
+
+  bool lookup(uint64_t KeyHi, uint64_t KeyLo, int64_t ParentModTime,
+              FileData &Data, bool &Exists);
+  void insert(uint64_t KeyHi, uint64_t KeyLo, int64_t ParentModTime,
+              const FileData &Data, bool Exists);
+
+public:
+  ~SharedStatCache() override;
+
+  /// \brief Open (creating it if necessary) the shared cache stored in
+  /// \p Path.  Returns null if the file can't be opened or mapped, or was
+  /// created by an incompatible version of the compiler.
+  static std::unique_ptr<SharedStatCache> create(StringRef Path);
+
+  unsigned getNumHits() const { return NumHits; }
+  unsigned getNumMisses() const { return NumMisses; }
+
+  LookupResult getStat(const char *Path, FileData &Data, bool isFile,
+                       std::unique_ptr<vfs::File> *F,
+                       vfs::FileSystem &FS) override;
+};
+
+} // end namespace clang
+
+#endif
@@ -575,6 +575,10 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// file created from this compilation). Defaults to false.
   bool FilesAreTransient;
 
+  /// \brief True if consecutive macro argument expansions of the same macro
+  /// invocation should share a single SLocEntry. Defaults to false.
+  bool CoalesceMacroArgExpansions;
+
   struct OverriddenFilesInfoTy {
     /// \brief Files that have been overridden with the contents from another
     /// file.
@@ -605,6 +609,36 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// expansion.
   SmallVector<SrcMgr::SLocEntry, 0> LocalSLocEntryTable;
 
+  /// \brief The offset of each entry in LocalSLocEntryTable.
+  ///
+  /// Kept apart from the much larger SLocEntry objects so that searching for
+  /// the entry containing an offset touches as few cache lines as possible.
+  SmallVector<unsigned, 0> LocalSLocEntryOffsets;
+
+public:
+  /// \brief A macro argument expansion that was folded into the argument
+  /// expansion entry preceding it.
+  struct CoalescedMacroArgExpansion {
+    /// \brief The first offset after the tokens of the previous argument.
+    unsigned Begin;
+    /// \brief The offset of the first token of this argument.
+    unsigned Offset;
+    /// \brief Where the argument was expanded in the macro body.
+    SourceLocation ExpansionLoc;
+  };
+
+private:
+  /// \brief Argument expansions merged into an existing local entry, sorted
+  /// by offset. Each covers the offsets from its Begin up to the next one.
+  ///
+  /// A coalesced entry records only the expansion location of its first
+  /// argument. The expansion location of any later argument is recovered from
+  /// here when it is asked for.
+  std::vector<CoalescedMacroArgExpansion> CoalescedMacroArgExpansions;
+
+  /// \brief Like CoalescedMacroArgExpansions, for the loaded entries.
+  std::vector<CoalescedMacroArgExpansion> LoadedCoalescedMacroArgExpansions;
+
   /// \brief The table of SLocEntries that are loaded from other modules.
   ///
   /// Negative FileIDs are indexes into this table. To get from ID to an index,
@@ -641,6 +675,24 @@ class SourceManager : public RefCountedBase<SourceManager> {
   /// is very common to look up many tokens from the same file.
   mutable FileID LastFileIDLookup;
 
+  /// \brief A local FileID found by getFileIDLocal, along with the range of
+  /// offsets [Begin, End) that it covers.
+  struct FileIDLookupCacheEntry {
+    unsigned Begin, End;
+    FileID FID;
+  };
+
+  enum { NumFileIDLookupCacheEntries = 8 };
+
+  /// \brief A small round-robin cache of recent getFileIDLocal results.
+  ///
+  /// Unlike LastFileIDLookup this also remembers macro expansions, which
+  /// dominate lookups in macro-heavy translation units, and checking it does
+  /// not touch the SLocEntry tables at all.
+  mutable FileIDLookupCacheEntry
+      FileIDLookupCache[NumFileIDLookupCacheEntries];
+  mutable unsigned NextFileIDLookupCacheEntry;
+
   /// \brief Holds information for \#line directives.
   ///
   /// This is referenced by indices from SLocEntryTable.
@@ -660,7 +712,8 @@ class SourceManager : public RefCountedBase<SourceManager> {
   FileID PreambleFileID;
 
   // Statistics for -print-stats.
-  mutable unsigned NumLinearScans, NumBinaryProbes;
+  mutable unsigned NumLinearScans, NumBinaryProbes, NumFileIDLookupCacheHits;
+  unsigned NumCoalescedMacroArgExpansions;
 
   /// \brief Associates a FileID with its "included/expanded in" decomposed
   /// location.
@@ -730,6 +783,33 @@ public:
   /// (likely to change while trying to use them).
   bool userFilesAreVolatile() const { return UserFilesAreVolatile; }
 
+  /// \brief Set true if consecutive argument expansions of the same macro
+  /// invocation should be merged into a single SLocEntry when their spellings
+  /// are close together.
+  ///
+  /// This saves memory in code that expands many function-like macros.
+  /// Argument tokens in a merged entry still have exact spelling and
+  /// expansion locations, but the entry as a whole only describes its first
+  /// argument.
+  void setCoalesceMacroArgExpansions(bool Coalesce) {
+    CoalesceMacroArgExpansions = Coalesce;
+  }
+  bool coalesceMacroArgExpansions() const {
+    return CoalesceMacroArgExpansions;
+  }
+
+  /// \brief Returns the argument expansions coalesced into local entries,
+  /// sorted by offset, so that they can be serialized with the entries.
+  ArrayRef<CoalescedMacroArgExpansion>
+  getLocalCoalescedMacroArgExpansions() const {
+    return CoalescedMacroArgExpansions;
+  }
+
+  /// \brief Adds argument expansions that were coalesced into loaded
+  /// entries, as read from an AST file.
+  void addLoadedCoalescedMacroArgExpansions(
+      ArrayRef<CoalescedMacroArgExpansion> Args);
+
   /// \brief Retrieve the module build stack.
   ModuleBuildStack getModuleBuildStack() const {
     return StoredModuleBuildStack;
@@ -1136,7 +1216,7 @@ public:
     if (Loc.isFileID())
       return std::make_pair(FID, Offset);
 
-    return getDecomposedExpansionLocSlowCase(E);
+    return getDecomposedExpansionLocSlowCase(E, Offset);
   }
 
   /// \brief Decompose the specified location into a raw FileID + Offset pair.
@@ -1159,7 +1239,11 @@ public:
 
   /// \brief Returns the "included/expanded in" decomposed location of the given
   /// FileID.
-  std::pair<FileID, unsigned> getDecomposedIncludedLoc(FileID FID) const;
+  ///
+  /// \p Offset only matters in an entry that macro arguments were coalesced
+  /// into, where each argument is expanded at a different place.
+  std::pair<FileID, unsigned>
+  getDecomposedIncludedLoc(FileID FID, unsigned Offset = 0) const;
 
   /// \brief Returns the offset from the start of the file that the
   /// specified SourceLocation represents.
@@ -1662,14 +1746,33 @@ private:
 
   FileID getFileIDSlow(unsigned SLocOffset) const;
   FileID getFileIDLocal(unsigned SLocOffset) const;
+  FileID cacheLocalFileIDLookup(unsigned Index) const;
+  void clearFileIDLookupCache() const;
   FileID getFileIDLoaded(unsigned SLocOffset) const;
 
+  SourceLocation coalesceMacroArgExpansion(SourceLocation SpellingLoc,
+                                           SourceLocation ExpansionLoc,
+                                           unsigned TokLength);
+  const std::vector<CoalescedMacroArgExpansion> &
+  getCoalescedMacroArgExpansionTable(unsigned SLocOffset) const {
+    return SLocOffset < NextLocalOffset ? CoalescedMacroArgExpansions
+                                        : LoadedCoalescedMacroArgExpansions;
+  }
+  ArrayRef<CoalescedMacroArgExpansion>
+  getCoalescedMacroArgExpansions(FileID FID) const;
+  const CoalescedMacroArgExpansion *
+  findCoalescedMacroArgExpansion(const SrcMgr::SLocEntry &Entry,
+                                 unsigned SLocOffset) const;
+  SourceLocation getExpansionLocStart(const SrcMgr::SLocEntry &Entry,
+                                      unsigned SLocOffset) const;
+
   SourceLocation getExpansionLocSlowCase(SourceLocation Loc) const;
   SourceLocation getSpellingLocSlowCase(SourceLocation Loc) const;
   SourceLocation getFileLocSlowCase(SourceLocation Loc) const;
 
   std::pair<FileID, unsigned>
-  getDecomposedExpansionLocSlowCase(const SrcMgr::SLocEntry *E) const;
+  getDecomposedExpansionLocSlowCase(const SrcMgr::SLocEntry *E,
+                                    unsigned Offset) const;
   std::pair<FileID, unsigned>
   getDecomposedSpellingLocSlowCase(const SrcMgr::SLocEntry *E,
                                    unsigned Offset) const;
@@ -0,0 +1,71 @@
+//===--- TimeTrace.h - Hierarchical compile time trace ----------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Defines the TimeTraceScope interface used by -ftime-trace.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_BASIC_TIMETRACE_H
+#define LLVM_CLANG_BASIC_TIMETRACE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include <chrono>
+#include <string>
+
+namespace clang {
+
+class TimeTraceProfiler;
+
+/// \brief The profiler of this process, or null if -ftime-trace is off.
+extern TimeTraceProfiler *TimeTraceProfilerInstance;
+
+/// \brief Start recording time trace events in this process.  Events that
+/// took less than \p GranularityUs microseconds are dropped.
+void initTimeTrace(unsigned GranularityUs);
+
+/// \brief Stop recording time trace events and discard them.
+void cleanupTimeTrace();
+
+/// \brief Write the events recorded so far as Chrome trace event JSON, which
+/// chrome://tracing and most trace viewers can load.
+void writeTimeTrace(raw_ostream &OS, StringRef ProcessName);
+
+/// \brief Whether time trace events are being recorded.
+inline bool isTimeTraceEnabled() { return TimeTraceProfilerInstance; }
+
+/// \brief Records the time between its construction and destruction as one
+/// event of the time trace, if one is being recorded.
+///
+/// Scopes may be used from any thread.  Events of the same thread nest by
+/// time in the trace, so nothing but the scope itself needs to track them.
+class TimeTraceScope {
+  TimeTraceProfiler *Profiler;
+  std::string Name;
+  std::string Detail;
+  std::chrono::steady_clock::time_point Start;
+
+  TimeTraceScope(const TimeTraceScope &) = delete;
+  void operator=(const TimeTraceScope &) = delete;
+
+public:
+  explicit TimeTraceScope(StringRef Name);
+
+  /// \param Detail Computes the detail of the event, such as the name of the
+  /// file or declaration it is about.  It is only called when recording.
+  TimeTraceScope(StringRef Name, llvm::function_ref<std::string()> Detail);
+
+  ~TimeTraceScope();
+};
+
+} // end namespace clang
+
+#endif
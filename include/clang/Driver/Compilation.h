@@ -237,6 +237,23 @@ public:
   /// \return The result code of the subprocess.
   int ExecuteCommand(const Command &C, const Command *&FailingCommand) const;
 
+  /// ExecutePipedCommands - Execute \p Producer and \p Consumer at once,
+  /// replacing the temporary file \p Pipe through which the first passes its
+  /// output to the second by a named pipe.
+  ///
+  /// \param FailingCommand - For non-zero results, this will be set to the
+  /// Command which failed, preferring \p Producer when both did.
+  /// \return The result code of the failing subprocess.
+  int ExecutePipedCommands(const Command &Producer, const Command &Consumer,
+                           const char *Pipe,
+                           const Command *&FailingCommand) const;
+
+  /// PrintCommand - Print the command about to be executed, if requested with
+  /// -v or CC_PRINT_OPTIONS.
+  ///
+  /// \return False if the command could not be printed.
+  bool PrintCommand(const Command &C) const;
+
   /// ExecuteJob - Execute a single job.
   ///
   /// \param FailingCommands - For non-zero results, this will be a vector of
@@ -245,6 +262,16 @@ public:
       const JobList &Jobs,
       SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
 
+  /// ExecuteJobsInParallel - Execute the jobs, running up to \p NumThreads of
+  /// those that do not depend on each other at once. The output of each job is
+  /// printed in the order of the jobs once it has finished.
+  ///
+  /// \param FailingCommands - For non-zero results, this will be a vector of
+  /// failing commands and their associated result code.
+  void ExecuteJobsInParallel(
+      const JobList &Jobs, unsigned NumThreads,
+      SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const;
+
   /// initCompilationForDiagnostics - Remove stale state and suppress output
   /// so compilation can be reexecuted to generate additional diagnostic
   /// information (e.g., preprocessed source(s)).
@@ -182,6 +182,19 @@ public:
   /// Whether the driver is generating diagnostics for debugging purposes.
   unsigned CCGenDiagnostics : 1;
 
+  /// The number of jobs that may run at once, set with -parallel-jobs.
+  unsigned NumParallelJobs;
+
+  /// Whether -pipe was given, to connect a compile job to the external
+  /// assembler job reading its output through a pipe.
+  unsigned UsePipes : 1;
+
+  /// The entry point of the -cc1 tool, given the arguments of a -cc1 job
+  /// including the executable. When set, CC1Command jobs run through it, in
+  /// this process or on a compile server, instead of in a new process.
+  typedef int (*CC1ToolFunc)(ArrayRef<const char *> Argv);
+  CC1ToolFunc CC1Main;
+
 private:
   /// Name to use when invoking gcc/g++.
   std::string CCCGenericGCCName;
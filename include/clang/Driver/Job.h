@@ -14,6 +14,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/Option/Option.h"
+#include "llvm/Support/Program.h"
 #include <memory>
 
 namespace llvm {
@@ -81,6 +82,14 @@ class Command {
   /// The results are the contents of a response file, written into a raw_ostream.
   void writeResponseFile(raw_ostream &OS) const;
 
+  /// Builds the null-terminated argument vector to launch the command with,
+  /// writing the response file if it needs one.
+  ///
+  /// \return False, with \p ErrMsg set, if the response file could not be
+  /// written.
+  bool buildArgv(llvm::SmallVectorImpl<const char *> &Argv,
+                 std::string *ErrMsg, bool *ExecutionFailed) const;
+
 public:
   Command(const Action &Source, const Tool &Creator, const char *Executable,
           const llvm::opt::ArgStringList &Arguments,
@@ -96,6 +105,13 @@ public:
   virtual int Execute(const StringRef **Redirects, std::string *ErrMsg,
                       bool *ExecutionFailed) const;
 
+  /// Launches the command in a new process without waiting for it, for the
+  /// driver to run it alongside another job.
+  ///
+  /// \return The process, whose Pid is 0 if it could not be launched.
+  llvm::sys::ProcessInfo Start(std::string *ErrMsg,
+                               bool *ExecutionFailed) const;
+
   /// getSource - Return the Action which caused the creation of this job.
   const Action &getSource() const { return Source; }
 
@@ -115,6 +131,10 @@ public:
 
   const llvm::opt::ArgStringList &getArguments() const { return Arguments; }
 
+  const llvm::opt::ArgStringList &getInputFilenames() const {
+    return InputFilenames;
+  }
+
   /// Print a command argument, and optionally quote it.
   static void printArg(llvm::raw_ostream &OS, const char *Arg, bool Quote);
 };
@@ -138,6 +158,18 @@ private:
   std::unique_ptr<Command> Fallback;
 };
 
+/// Like Command, but runs the -cc1 tool through the driver's CC1Main when it
+/// has one, instead of paying for a new process.
+class CC1Command : public Command {
+public:
+  CC1Command(const Action &Source_, const Tool &Creator_,
+             const char *Executable_, const ArgStringList &Arguments_,
+             ArrayRef<InputInfo> Inputs);
+
+  int Execute(const StringRef **Redirects, std::string *ErrMsg,
+              bool *ExecutionFailed) const override;
+};
+
 /// Like Command, but always pretends that the wrapped command succeeded.
 class ForceSuccessCommand : public Command {
 public:
@@ -484,6 +484,15 @@ struct FormatStyle {
   /// \brief The maximum number of consecutive empty lines to keep.
   unsigned MaxEmptyLinesToKeep;
 
+  /// \brief The maximum number of ways to break a line that are tried before
+  /// the rest of the line is broken greedily, only where it does not fit.
+  /// ``0`` means no limit.
+  ///
+  /// Finding the best way to break lines with many possible break points,
+  /// like long initializer lists or deeply nested calls, can otherwise take
+  /// seconds.
+  unsigned MaxLineFormattingStates;
+
   /// \brief Different ways to indent namespace contents.
   enum NamespaceIndentationKind {
     /// Don't indent in namespaces.
@@ -685,6 +694,7 @@ struct FormatStyle {
            MacroBlockBegin == R.MacroBlockBegin &&
            MacroBlockEnd == R.MacroBlockEnd &&
            MaxEmptyLinesToKeep == R.MaxEmptyLinesToKeep &&
+           MaxLineFormattingStates == R.MaxLineFormattingStates &&
            NamespaceIndentation == R.NamespaceIndentation &&
            ObjCBlockIndentWidth == R.ObjCBlockIndentWidth &&
            ObjCSpaceAfterProperty == R.ObjCSpaceAfterProperty &&
@@ -810,6 +820,70 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
                                StringRef FileName = "<stdin>",
                                bool *IncompleteFormat = nullptr);
 
+/// \brief What \c reformat() remembers about a file between calls, so that
+/// it can format it again after small edits without lexing and parsing all
+/// of it.
+///
+/// Callers only create one per file and pass it to each call; its contents
+/// are up to \c reformat().
+struct IncrementalFormatState {
+  IncrementalFormatState()
+      : Style(getLLVMStyle()), WindowBegin(0), WindowEnd(0),
+        DerivedPointerAlignment(Style.PointerAlignment),
+        DerivedStandard(Style.Standard), BinPackInconclusiveFunctions(true) {}
+
+  /// \brief The code of the last call, or empty if there was none.
+  std::string Code;
+
+  /// \brief The style of the last call, with its presets expanded.
+  FormatStyle Style;
+
+  /// \brief A point of \c Code where formatting can start or stop: a
+  /// declaration that follows an empty line, at the top level or, with
+  /// \c NI_None, directly inside namespaces.
+  struct SyncPoint {
+    /// \brief The offset of the whitespace before the declaration.
+    unsigned WhitespaceOffset;
+    /// \brief The offset of the first token of the declaration.
+    unsigned TokenOffset;
+    /// \brief The offset of the '{' of the namespace the declaration is in,
+    /// or UINT_MAX at the top level. Formatting starts and stops at points
+    /// in the same scope.
+    unsigned Scope;
+  };
+  std::vector<SyncPoint> SyncPoints;
+
+  /// \brief The part of \c Code the last call lexed and parsed.
+  unsigned WindowBegin, WindowEnd;
+
+  /// \brief What was derived from the whole file the last time all of it was
+  /// formatted; see \c FormatStyle::DerivePointerAlignment and
+  /// \c FormatStyle::LS_Auto.
+  FormatStyle::PointerAlignmentStyle DerivedPointerAlignment;
+  FormatStyle::LanguageStandard DerivedStandard;
+  bool BinPackInconclusiveFunctions;
+};
+
+/// \brief Reformats the given \p Ranges in \p Code, reusing what \p State
+/// remembers from the previous call for the same file.
+///
+/// When only a part of the file changed since the previous call, only the
+/// declarations from the one before the first change or range up to the one
+/// after the last, in the same namespace or at the top level, are lexed and
+/// parsed, which keeps formatting a few lines of a large file on every edit
+/// cheap. The whole file is formatted when it cannot be split there, for
+/// example when the style changed or for languages other than C++. Properties
+/// derived from the whole file, like the pointer alignment with
+/// \c DerivePointerAlignment, are only derived again when the whole file is
+/// formatted.
+///
+/// Otherwise identical to the reformat() function above.
+tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
+                               ArrayRef<tooling::Range> Ranges,
+                               IncrementalFormatState &State,
+                               StringRef FileName = "<stdin>",
+                               bool *IncompleteFormat = nullptr);
+
 /// \brief Clean up any erroneous/redundant code in the given \p Ranges in the
 /// file \p ID.
 ///
@@ -58,6 +58,7 @@ class HeaderSearch;
 class Preprocessor;
 class PCHContainerOperations;
 class PCHContainerReader;
+class SharedStatResults;
 class SourceManager;
 class TargetInfo;
 class FrontendAction;
@@ -184,6 +185,19 @@ private:
   /// some number of calls.
   unsigned PreambleRebuildCounter;
 
+  /// \brief Whether to build the precompiled preamble as a chain of
+  /// precompiled headers, split before its last #include, so that editing
+  /// that #include only precompiles the end of the preamble again.
+  bool ChainPreambles;
+
+  /// \brief The stat results of files in system header directories that
+  /// this ASTUnit shares with others, if any.
+  SharedStatResults *SharedSystemHeaderStats;
+
+  /// \brief Let \p FM share the stats of files in system header
+  /// directories through \c SharedSystemHeaderStats, if set.
+  void shareSystemHeaderStats(FileManager &FM);
+
 public:
   class PreambleData {
     const FileEntry *File;
@@ -383,7 +397,27 @@ private:
   std::unique_ptr<CodeCompletionTUInfo> CCTUInfo;
 
   /// \brief The set of cached code-completion results.
+  ///
+  /// The results for entities that come from the precompiled preamble (or
+  /// another AST file) come first, followed by those for entities of the main
+  /// file.
   std::vector<CachedCodeCompletionResult> CachedCompletionResults;
+
+  /// \brief The number of cached code-completion results at the start of
+  /// \c CachedCompletionResults that describe entities of the preamble.
+  ///
+  /// These results stay valid as long as the preamble does, so only the
+  /// results for the main file need to be recomputed when its top-level
+  /// declarations change.
+  unsigned NumPreambleCachedCompletionResults;
+
+  /// \brief The number of bytes of \c CachedCompletionAllocator that were in
+  /// use after the last time that all cached results were computed.
+  size_t PreambleCompletionCacheBytes;
+
+  /// \brief The value of \c PreambleTopLevelHashValue when the cached
+  /// code-completion results of the preamble were computed.
+  unsigned CompletionCachePreambleHashValue;
   
   /// \brief A mapping from the formatted type name to a unique number for that
   /// type, which is used for type equality comparisons.
@@ -448,6 +482,10 @@ private:
       std::shared_ptr<PCHContainerOperations> PCHContainerOps,
       const CompilerInvocation &PreambleInvocationIn, bool AllowRebuild = true,
       unsigned MaxLines = 0);
+  bool precompilePreamble(
+      std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+      const CompilerInvocation &PreambleInvocationIn, StringRef PreambleText,
+      StringRef BasePCHFile, unsigned BaseSize, std::string &PCHFile);
   void RealizeTopLevelDeclsFromPreamble();
 
   /// \brief Transfers ownership of the objects (like SourceManager) from
@@ -544,11 +582,18 @@ public:
   bool getOwnsRemappedFileBuffers() const { return OwnsRemappedFileBuffers; }
   void setOwnsRemappedFileBuffers(bool val) { OwnsRemappedFileBuffers = val; }
 
+  bool getChainPreambles() const { return ChainPreambles; }
+  void setChainPreambles(bool Chain) { ChainPreambles = Chain; }
+
   StringRef getMainFileName() const;
 
   /// \brief If this ASTUnit came from an AST file, returns the filename for it.
   StringRef getASTFileName() const;
 
+  /// \brief Returns the files holding the precompiled preamble in use, from
+  /// the base of its chain to its end, or none if there is none.
+  std::vector<std::string> getPreamblePCHFiles() const;
+
   typedef std::vector<Decl *>::iterator top_level_iterator;
 
   top_level_iterator top_level_begin() {
@@ -724,6 +769,9 @@ public:
   /// \param Diags - The diagnostics engine to use for reporting errors; its
   /// lifetime is expected to extend past that of the returned ASTUnit.
   ///
+  /// \param DisableValidation - Whether to trust that the files the AST was
+  /// built from are unchanged, rather than checking each of them on load.
+  ///
   /// \returns - The initialized ASTUnit or null if the AST failed to load.
   static std::unique_ptr<ASTUnit> LoadFromASTFile(
       const std::string &Filename, const PCHContainerReader &PCHContainerRdr,
@@ -731,7 +779,7 @@ public:
       const FileSystemOptions &FileSystemOpts, bool UseDebugInfo = false,
       bool OnlyLocalDecls = false, ArrayRef<RemappedFile> RemappedFiles = None,
       bool CaptureDiagnostics = false, bool AllowPCHWithCompilerErrors = false,
-      bool UserFilesAreVolatile = false);
+      bool UserFilesAreVolatile = false, bool DisableValidation = false);
 
 private:
   /// \brief Helper function for \c LoadFromCompilerInvocation() and
@@ -836,6 +884,11 @@ public:
   /// (e.g. because the PCH could not be loaded), this accepts the ASTUnit
   /// mainly to allow the caller to see the diagnostics.
   ///
+  /// \param SharedSystemHeaderStats - If non-null, the results of stat calls
+  /// of files in system header directories are shared through it with other
+  /// ASTUnits, which may be parsed on other threads. It must outlive the
+  /// returned ASTUnit.
+  ///
   // FIXME: Move OnlyLocalDecls, UseBumpAllocator to setters on the ASTUnit, we
   // shouldn't need to specify them at construction time.
   static ASTUnit *LoadFromCommandLine(
@@ -852,7 +905,8 @@ public:
       bool AllowPCHWithCompilerErrors = false, bool SkipFunctionBodies = false,
       bool UserFilesAreVolatile = false, bool ForSerialization = false,
       llvm::Optional<StringRef> ModuleFormat = llvm::None,
-      std::unique_ptr<ASTUnit> *ErrAST = nullptr);
+      std::unique_ptr<ASTUnit> *ErrAST = nullptr,
+      SharedStatResults *SharedSystemHeaderStats = nullptr);
 
   /// \brief Reparse the source files using the same command-line options that
   /// were originally used to produce this translation unit.
@@ -880,12 +934,15 @@ public:
   /// \param IncludeBriefComments Whether to include brief documentation within
   /// the set of code completions returned.
   ///
+  /// \param FilterByTypedText Whether to drop the results that do not start
+  /// with the identifier at the code-completion point.
+  ///
   /// FIXME: The Diag, LangOpts, SourceMgr, FileMgr, StoredDiagnostics, and
   /// OwnedBuffers parameters are all disgusting hacks. They will go away.
   void CodeComplete(StringRef File, unsigned Line, unsigned Column,
                     ArrayRef<RemappedFile> RemappedFiles, bool IncludeMacros,
                     bool IncludeCodePatterns, bool IncludeBriefComments,
-                    CodeCompleteConsumer &Consumer,
+                    bool FilterByTypedText, CodeCompleteConsumer &Consumer,
                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
                     DiagnosticsEngine &Diag, LangOptions &LangOpts,
                     SourceManager &SourceMgr, FileManager &FileMgr,
@@ -167,6 +167,25 @@ public:
   /// importing.
   std::string ThinLTOIndexFile;
 
+  /// The file mapping the mangled names of linkonce_odr functions to the
+  /// object that owns their definition, if non-empty.
+  std::string DefinitionOwnersFile;
+
+  /// The name of this object in DefinitionOwnersFile and DebugTypeOwnersFile.
+  std::string DefinitionOwner;
+
+  /// The file mapping the RTTI names of types to the object that emits their
+  /// debug info definition, if non-empty.
+  std::string DebugTypeOwnersFile;
+
+  /// The directory of the cache of the objects generated for each module, if
+  /// non-empty.
+  std::string BackendCachePath;
+
+  /// The linker that links the objects generated in parallel with
+  /// -fparallel-codegen into one relocatable object.
+  std::string ParallelCodeGenLinker;
+
   /// A list of file names passed with -fcuda-include-gpubinary options to
   /// forward to CUDA runtime back-end for incorporating them into host-side
   /// object file.
@@ -50,6 +50,10 @@ class Sema;
 class SourceManager;
 class TargetInfo;
 
+namespace serialization {
+class SharedModuleCache;
+}
+
 /// CompilerInstance - Helper class for managing a single instance of the Clang
 /// compiler.
 ///
@@ -117,6 +121,10 @@ class CompilerInstance : public ModuleLoader {
   /// \brief The module dependency collector for crashdumps
   std::shared_ptr<ModuleDependencyCollector> ModuleDepCollector;
 
+  /// \brief The contents of AST files shared with other compiles run by this
+  /// process, if any.
+  IntrusiveRefCntPtr<serialization::SharedModuleCache> SharedModuleCache;
+
   /// \brief The module provider.
   std::shared_ptr<PCHContainerOperations> ThePCHContainerOperations;
 
@@ -509,6 +517,11 @@ public:
   void setModuleDepCollector(
       std::shared_ptr<ModuleDependencyCollector> Collector);
 
+  IntrusiveRefCntPtr<serialization::SharedModuleCache>
+  getSharedModuleCache() const;
+  void setSharedModuleCache(
+      IntrusiveRefCntPtr<serialization::SharedModuleCache> Cache);
+
   std::shared_ptr<PCHContainerOperations> getPCHContainerOperations() const {
     return ThePCHContainerOperations;
   }
@@ -657,7 +670,8 @@ public:
       const PCHContainerReader &PCHContainerRdr,
       ArrayRef<IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
       void *DeserializationListener, bool OwnDeserializationListener,
-      bool Preamble, bool UseGlobalModuleIndex);
+      bool Preamble, bool UseGlobalModuleIndex,
+      serialization::SharedModuleCache *SharedModuleCache = nullptr);
 
   /// Create a code completion consumer using the invocation; note that this
   /// will cause the source manager to truncate the input source file at the
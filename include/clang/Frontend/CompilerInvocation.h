@@ -139,6 +139,15 @@ public:
                              const char* const *ArgEnd,
                              DiagnosticsEngine &Diags);
 
+  /// \brief Like CreateFromArgs, but reuses the options parsed by an earlier
+  /// call in this process whose arguments only differed in the input and
+  /// output files, so that processes running many compiles with the same
+  /// flags parse them once.
+  static bool CreateFromArgsCached(CompilerInvocation &Res,
+                                   const char* const *ArgBegin,
+                                   const char* const *ArgEnd,
+                                   DiagnosticsEngine &Diags);
+
   /// \brief Get the directory where the compiler headers
   /// reside, relative to the compiler binary (found by the passed in
   /// arguments).
@@ -53,6 +53,9 @@ public:
   /// In /showIncludes mode, pretend the main TU is a header with this name.
   std::string ShowIncludesPretendHeader;
 
+  /// \brief The file to write the cost of each included file to.
+  std::string HeaderCostReportFile;
+
   /// \brief The file to write GraphViz-formatted header dependencies to.
   std::string DOTOutputFile;
 
@@ -130,6 +130,8 @@ public:
                                            /// metrics and statistics.
   unsigned ShowTimers : 1;                 ///< Show timers for individual
                                            /// actions.
+  unsigned TimeTrace : 1;                  ///< Write a trace of the time
+                                           /// spent in each phase.
   unsigned ShowVersion : 1;                ///< Show the -version text.
   unsigned FixWhatYouCan : 1;              ///< Apply fixes even if there are
                                            /// unfixable errors.
@@ -142,6 +144,8 @@ public:
                                            /// speed up parsing in cases you do
                                            /// not need them (e.g. with code
                                            /// completion).
+  unsigned SkipHeaderFunctionBodies : 1;   ///< Skip over the function bodies
+                                           /// written outside the main file.
   unsigned UseGlobalModuleIndex : 1;       ///< Whether we can use the
                                            ///< global module index if available.
   unsigned GenerateGlobalModuleIndex : 1;  ///< Whether we can generate the
@@ -156,6 +160,12 @@ public:
                                            ///< files into the PCM file.
   unsigned IncludeTimestamps : 1;          ///< Whether timestamps should be
                                            ///< written to the produced PCH file.
+  unsigned CompressASTTables : 1;          ///< Whether to compress the large
+                                           ///< tables of the produced PCH file.
+
+  /// \brief The shortest time, in microseconds, that an event of the
+  /// -ftime-trace output takes.
+  unsigned TimeTraceGranularity;
 
   CodeCompleteOptions CodeCompleteOpts;
 
@@ -216,6 +226,10 @@ public:
   /// The output file, if any.
   std::string OutputFile;
 
+  /// \brief The output file of each input, when several inputs are compiled
+  /// in one batch.
+  std::vector<std::string> BatchOutputFiles;
+
   /// If given, the new suffix for fix-it rewritten files.
   std::string FixItSuffix;
 
@@ -253,6 +267,10 @@ public:
   /// \brief The list of files to embed into the compiled module file.
   std::vector<std::string> ModulesEmbedFiles;
 
+  /// \brief The directory in which the contents of embedded files are kept
+  /// and shared between module files, if any.
+  std::string ModulesEmbedStorePath;
+
   /// \brief The list of AST files to merge.
   std::vector<std::string> ASTMergeFiles;
 
@@ -264,9 +282,17 @@ public:
   /// (in the format produced by -fdump-record-layouts).
   std::string OverrideRecordLayoutsFile;
 
+  /// \brief File to which a JSON report of the memory used by the translation
+  /// unit is written (-fmemory-report=).
+  std::string MemoryReportPath;
+
   /// \brief Auxiliary triple for CUDA compilation.
   std::string AuxTriple;
 
+  /// \brief The directory of the index store that the index data of the
+  /// compilation is written to (-index-store-path), or empty.
+  std::string IndexStorePath;
+
   /// \brief If non-empty, search the pch input file as it was a header
   // included by this file.
   std::string FindPchSource;
@@ -274,13 +300,16 @@ public:
 public:
   FrontendOptions() :
     DisableFree(false), RelocatablePCH(false), ShowHelp(false),
-    ShowStats(false), ShowTimers(false), ShowVersion(false),
+    ShowStats(false), ShowTimers(false), TimeTrace(false), ShowVersion(false),
     FixWhatYouCan(false), FixOnlyWarnings(false), FixAndRecompile(false),
     FixToTemporaries(false), ARCMTMigrateEmitARCErrors(false),
-    SkipFunctionBodies(false), UseGlobalModuleIndex(true),
+    SkipFunctionBodies(false), SkipHeaderFunctionBodies(false),
+    UseGlobalModuleIndex(true),
     GenerateGlobalModuleIndex(true), ASTDumpDecls(false), ASTDumpLookups(false),
     BuildingImplicitModule(false), ModulesEmbedAllFiles(false),
-    IncludeTimestamps(true), ARCMTAction(ARCMT_None),
+    IncludeTimestamps(true), CompressASTTables(false),
+    TimeTraceGranularity(500),
+    ARCMTAction(ARCMT_None),
     ObjCMTAction(ObjCMT_None), ProgramAction(frontend::ParseSyntaxOnly)
   {}
 
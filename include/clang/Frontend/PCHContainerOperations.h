@@ -62,7 +62,9 @@ public:
   virtual StringRef getFormat() const = 0;
 
   /// Initialize an llvm::BitstreamReader with the serialized AST inside
-  /// the PCH container Buffer.
+  /// the PCH container Buffer. The reader must refer to the bytes of Buffer
+  /// in place rather than to a copy, since Buffer may be a mapping of a very
+  /// large file.
   virtual void ExtractPCH(llvm::MemoryBufferRef Buffer,
                           llvm::BitstreamReader &StreamFile) const = 0;
 };
@@ -23,6 +23,7 @@ public:
   unsigned ShowMacroComments : 1;  ///< Show comments, even in macros.
   unsigned ShowMacros : 1;         ///< Print macro definitions.
   unsigned RewriteIncludes : 1;    ///< Preprocess include directives only.
+  unsigned CompressOutput : 1;     ///< Compress the output with zlib.
 
 public:
   PreprocessorOutputOptions() {
@@ -33,6 +34,7 @@ public:
     ShowMacroComments = 0;
     ShowMacros = 0;
     RewriteIncludes = 0;
+    CompressOutput = 0;
   }
 };
 
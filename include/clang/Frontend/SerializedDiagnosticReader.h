@@ -14,6 +14,7 @@
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/Bitcode/BitstreamReader.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
 
 namespace clang {
 namespace serialized_diags {
@@ -64,6 +65,11 @@ public:
   /// \brief Read the diagnostics in \c File
   std::error_code readDiagnostics(StringRef File);
 
+  /// \brief Read the diagnostics in \c Buffer, which may hold several streams
+  /// of diagnostics one after the other, such as the logs of many compiles
+  /// concatenated into one file.
+  std::error_code readDiagnostics(llvm::MemoryBufferRef Buffer);
+
 private:
   enum class Cursor;
 
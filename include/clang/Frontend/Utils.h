@@ -71,6 +71,11 @@ void InitializePreprocessor(Preprocessor &PP, const PreprocessorOptions &PPOpts,
 void DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream* OS,
                               const PreprocessorOutputOptions &Opts);
 
+/// WriteCompressedPreprocessedOutput - Write preprocessed output to \p OS
+/// compressed with zlib, for -fcompress-preprocessed-output.
+void WriteCompressedPreprocessedOutput(DiagnosticsEngine &Diags,
+                                       StringRef Output, raw_ostream &OS);
+
 /// An interface for collecting the dependencies of a compilation. Users should
 /// use \c attachToPreprocessor and \c attachToASTReader to get all of the
 /// dependencies.
@@ -170,9 +175,23 @@ void AttachHeaderIncludeGen(Preprocessor &PP,
                             StringRef OutputPath = "",
                             bool ShowDepth = true, bool MSStyle = false);
 
+/// AttachHeaderCostReportGen - Create a generator of the report of the time
+/// and tokens spent in each file entered by the preprocessor, and attach it to
+/// the given preprocessor. The report is written to \p OutputPath at the end
+/// of the main file.
+void AttachHeaderCostReportGen(Preprocessor &PP, StringRef OutputPath);
+
 /// Cache tokens for use with PCH. Note that this requires a seekable stream.
 void CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS);
 
+/// Add entries to the Preprocessor's SharedTokenCache for each file entered
+/// during this compile that was not already cached.
+void UpdateTokenCache(Preprocessor &PP);
+
+/// Write a JSON report of the memory used by the translation unit of \p CI,
+/// broken down by AST node kind and by the file each node was written in.
+void WriteMemoryReport(CompilerInstance &CI, StringRef OutputPath);
+
 /// The ChainedIncludesSource class converts headers to chained PCHs in
 /// memory, mainly for testing.
 IntrusiveRefCntPtr<ExternalSemaSource>
@@ -52,6 +52,11 @@ public:
                                      SymbolRoleSet Roles,
                                      FileID FID, unsigned Offset);
 
+  /// \returns true if the occurrences within the namespace-scope declaration
+  /// \p D need not be reported, for example because the consumer already got
+  /// them from an earlier translation unit.
+  virtual bool shouldSkipDecl(const Decl *D) { return false; }
+
   virtual void finish() {}
 
 private:
@@ -16,6 +16,7 @@
 namespace clang {
   class ASTUnit;
   class FrontendAction;
+  class FrontendOptions;
 
 namespace index {
   class IndexDataConsumer;
@@ -42,6 +43,34 @@ void indexASTUnit(ASTUnit &Unit,
                   std::shared_ptr<IndexDataConsumer> DataConsumer,
                   IndexingOptions Opts);
 
+/// \brief Creates an action that runs \p WrappedAction and writes the index
+/// data of the compilation to the index store at
+/// \c FrontendOptions::IndexStorePath.
+///
+/// The store holds one record file for each file of the compilation that has
+/// symbol occurrences, named after the hash of its contents, so a header that
+/// is indexed the same way by many compilations is only written once. A unit
+/// file, named after the output file, lists the files of the compilation
+/// along with their records. Both are line-based text:
+///
+/// \code
+///   clang-index-record 1
+///   symbol <index> <kind>/<language> <USR> <name>
+///   occurrence <line>:<column> <roles> <symbol index>
+///   relation <roles> <symbol index>
+///
+///   clang-index-unit 1
+///   main-file <path>
+///   output-file <path>
+///   file <path> <record name, or '-' if the file has no occurrences>
+/// \endcode
+///
+/// Roles are \c SymbolRoleSet values in hexadecimal. A relation line belongs
+/// to the occurrence before it.
+std::unique_ptr<FrontendAction>
+createIndexDataRecordingAction(const FrontendOptions &FEOpts,
+                               std::unique_ptr<FrontendAction> WrappedAction);
+
 } // namespace index
 } // namespace clang
 
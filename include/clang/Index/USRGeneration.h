@@ -11,7 +11,9 @@
 #define LLVM_CLANG_INDEX_USRGENERATION_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
 
 namespace clang {
 class Decl;
@@ -28,6 +30,44 @@ static inline StringRef getUSRSpacePrefix() {
 /// \returns true if the results should be ignored, false otherwise.
 bool generateUSRForDecl(const Decl *D, SmallVectorImpl<char> &Buf);
 
+/// \brief Returns a 64-bit hash of \p USR for keying symbols in index data
+/// that is written out. It is the same in every process and on every host.
+uint64_t hashUSR(StringRef USR);
+
+/// \brief Caches the USRs of the declarations of one ASTContext.
+///
+/// Indexers ask for the USR of a declaration at each of its occurrences, and
+/// the USR of a declaration begins with the USR of its declaration context.
+/// The cache generates each USR once, and a USR nested in a cached context
+/// copies that context's USR rather than visiting it again.
+class USRCache {
+public:
+  struct Entry {
+    /// \brief The USR, null-terminated, or empty if it should be ignored.
+    StringRef USR;
+    uint64_t Hash = 0;
+    bool HasHash = false;
+    /// \brief Whether the USR can be copied into the USRs nested in it, which
+    /// is not the case if generating it emitted a location or a type.
+    bool IsReusablePrefix = false;
+  };
+
+  /// \brief Returns the USR of \p D including the USR prefix, or an empty
+  /// string where \c generateUSRForDecl would ask to ignore the results.
+  /// The string is null-terminated and lives as long as the cache.
+  StringRef getUSR(const Decl *D) { return getEntry(D).USR; }
+
+  /// \brief Returns \c hashUSR of the USR of \p D, or 0 if it has none.
+  uint64_t getUSRHash(const Decl *D);
+
+  /// \brief Returns the cached entry of \p D, generating it if needed.
+  Entry getEntry(const Decl *D);
+
+private:
+  llvm::BumpPtrAllocator Alloc;
+  llvm::DenseMap<const Decl *, Entry> Entries;
+};
+
 /// \brief Generate a USR fragment for an Objective-C class.
 void generateUSRForObjCClass(StringRef Cls, raw_ostream &OS);
 
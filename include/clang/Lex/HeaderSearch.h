@@ -17,6 +17,7 @@
 #include "clang/Lex/DirectoryLookup.h"
 #include "clang/Lex/ModuleMap.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
@@ -220,6 +221,16 @@ class HeaderSearch {
   /// \brief Describes whether a given directory has a module map in it.
   llvm::DenseMap<const DirectoryEntry *, bool> DirectoryHasModuleMap;
 
+  /// \brief The directories found to have no module map, when looked at as
+  /// plain directories (index 0) and as frameworks (index 1).
+  llvm::DenseSet<const DirectoryEntry *> DirectoriesWithoutModuleMap[2];
+
+  /// \brief The names of the entries of each search directory, listed on
+  /// first use when HeaderSearchOptions::AssumeStableSearchDirs is set.  A
+  /// null set means the directory couldn't be listed.
+  llvm::DenseMap<const DirectoryEntry *, std::unique_ptr<llvm::StringSet<>>>
+      DirectoryContents;
+
   /// \brief Set of module map files we've already loaded, and a flag indicating
   /// whether they were valid or not.
   llvm::DenseMap<const FileEntry *, bool> LoadedModuleMaps;
@@ -240,6 +251,7 @@ class HeaderSearch {
   unsigned NumIncluded;
   unsigned NumMultiIncludeFileOptzn;
   unsigned NumFrameworkLookups, NumSubFrameworkLookups;
+  unsigned NumDirectoryIndexSkips;
 
   // HeaderSearch doesn't support default or copy construction.
   HeaderSearch(const HeaderSearch&) = delete;
@@ -460,6 +472,14 @@ public:
   /// This routine does not consider the effect of \#import
   bool isFileMultipleIncludeGuarded(const FileEntry *File);
 
+  /// \brief Determine whether ShouldEnterIncludeFile would refuse to enter
+  /// this file outside of any module, because it was already \#import'ed or
+  /// is \#pragma once, or because its controlling macro is defined.
+  ///
+  /// Unlike ShouldEnterIncludeFile this does not record an inclusion.
+  bool isIncludeKnownToHaveNoEffect(Preprocessor &PP, const FileEntry *File,
+                                    bool isImport);
+
   /// CreateHeaderMap - This method returns a HeaderMap for the specified
   /// FileEntry, uniquing them through the 'HeaderMaps' datastructure.
   const HeaderMap *CreateHeaderMap(const FileEntry *FE);
@@ -577,6 +597,11 @@ private:
       const FileEntry *File, StringRef FrameworkDir, Module *RequestingModule,
       ModuleMap::KnownHeader *SuggestedModule, bool IsSystemFramework);
 
+  /// \brief Determine whether the search directory \p Dir might contain
+  /// \p Filename.  This only returns false when search directories are
+  /// assumed stable and the directory index shows there is no such entry.
+  bool directoryMayContain(const DirectoryEntry *Dir, StringRef Filename);
+
   /// \brief Look up the file with the specified name and determine its owning
   /// module.
   const FileEntry *
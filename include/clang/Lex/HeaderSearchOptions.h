@@ -139,6 +139,13 @@ public:
   /// loading.
   uint64_t BuildSessionTimestamp;
 
+  /// \brief The file recording the precompiled headers whose input files were
+  /// validated during the current build session.
+  ///
+  /// When set, a PCH listed there for \c BuildSessionTimestamp is loaded
+  /// without checking its input files again.
+  std::string PCHValidationCachePath;
+
   /// \brief The set of macro names that should be ignored for the purposes
   /// of computing the module hash.
   llvm::SmallSetVector<std::string, 16> ModulesIgnoreMacros;
@@ -172,6 +179,11 @@ public:
   /// Whether the module includes debug information (-gmodules).
   unsigned UseDebugInfo : 1;
 
+  /// Whether the contents of search directories may be assumed not to change
+  /// during the compilation, allowing each one to be listed once and
+  /// skipped for names it doesn't contain.
+  unsigned AssumeStableSearchDirs : 1;
+
   HeaderSearchOptions(StringRef _Sysroot = "/")
       : Sysroot(_Sysroot), ModuleFormat("raw"), DisableModuleHash(0),
         ImplicitModuleMaps(0), ModuleMapFileHomeIsCwd(0),
@@ -181,7 +193,7 @@ public:
         UseStandardCXXIncludes(true), UseLibcxx(false), Verbose(false),
         ModulesValidateOncePerBuildSession(false),
         ModulesValidateSystemHeaders(false),
-        UseDebugInfo(false) {}
+        UseDebugInfo(false), AssumeStableSearchDirs(false) {}
 
   /// AddPath - Add the \p Path path to the specified \p Group list.
   void AddPath(StringRef Path, frontend::IncludeDirGroup Group,
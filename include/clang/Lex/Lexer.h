@@ -207,6 +207,16 @@ public:
   /// uninterpreted string.  This switches the lexer out of directive mode.
   void ReadToEndOfLine(SmallVectorImpl<char> *Result = nullptr);
 
+  /// Move ahead to the next line that may begin with a preprocessing
+  /// directive, without forming the tokens in between. This is used to skip
+  /// the excluded blocks of conditionals in raw mode. Comments, string and
+  /// character literals and line splices are followed, so that a '#' inside
+  /// them is not taken for a directive. Where the text is harder to follow,
+  /// such as at raw string literals and trigraphs, the lexer is left at the
+  /// last line start known to be between tokens, and ordinary lexing
+  /// continues from there.
+  void skipToPossibleDirective();
+
 
   /// Diag - Forwarding function for diagnostics.  This translate a source
   /// position in the current buffer into a SourceLocation object for rendering.
@@ -449,6 +459,21 @@ public:
                                                    const LangOptions &LangOpts,
                                                    unsigned MaxLines = 0);
 
+  /// \brief Copies the preprocessor directives and the '\@import'
+  /// declarations of \p Buffer to \p Output, dropping every other token.
+  ///
+  /// Each directive is copied verbatim, including its line continuations and
+  /// the comments between its tokens, and is followed by a newline. The
+  /// result preprocesses to the same includes, imports and macro definitions
+  /// as the original buffer, which is all a dependency scan needs, but line
+  /// numbers and anything expanded outside of directives (such as _Pragma)
+  /// are lost.
+  ///
+  /// \returns The number of directives and declarations copied.
+  static unsigned minimizeSourceToDependencyDirectives(
+      StringRef Buffer, SmallVectorImpl<char> &Output,
+      const LangOptions &LangOpts);
+
   /// \brief Checks that the given token is the first token that occurs after
   /// the given location (this excludes comments and whitespace). Returns the
   /// location immediately after the specified token. If the token is not found
@@ -45,6 +45,17 @@ class MacroArgs {
   /// stream.
   std::vector<std::vector<Token> > PreExpArgTokens;
 
+  /// PreExpansionCheck - Whether an argument has been found to need
+  /// pre-expansion.
+  enum PreExpansionCheck : unsigned char {
+    PEC_Unknown, PEC_NotNeeded, PEC_Needed
+  };
+
+  /// ArgPreExpansionChecks - The PreExpansionCheck of each argument, so that
+  /// an argument used several times in the macro body is only scanned once.
+  /// Empty if no argument has been checked yet.
+  std::vector<PreExpansionCheck> ArgPreExpansionChecks;
+
   /// StringifiedArgs - This contains arguments in 'stringified' form.  If the
   /// stringified form of an argument has not yet been computed, this is empty.
   std::vector<Token> StringifiedArgs;
@@ -73,6 +84,11 @@ public:
   /// by pre-expansion, return false.  Otherwise, conservatively return true.
   bool ArgNeedsPreexpansion(const Token *ArgTok, Preprocessor &PP) const;
 
+  /// ArgNeedsPreexpansion - Compute, cache, and return whether the specified
+  /// argument needs pre-expansion.
+  bool ArgNeedsPreexpansion(unsigned Arg, const MacroInfo *MI,
+                            Preprocessor &PP);
+
   /// getUnexpArgument - Return a pointer to the first token of the unexpanded
   /// token list for the specified formal.
   ///
@@ -58,6 +58,12 @@ class MacroInfo {
   mutable unsigned DefinitionLength;
   mutable bool IsDefinitionLengthCached : 1;
 
+  /// \brief Whether HasConstantBody has been computed.
+  mutable bool IsConstantBodyComputed : 1;
+
+  /// \brief Cached result of hasConstantBody().
+  mutable bool HasConstantBody : 1;
+
   /// \brief True if this macro is function-like, false if it is object-like.
   bool IsFunctionLike : 1;
 
@@ -212,6 +218,17 @@ public:
   bool isBuiltinMacro() const { return IsBuiltinMacro; }
 
   bool hasCommaPasting() const { return HasCommaPasting; }
+
+  /// \brief Return true if this is an object-like macro whose replacement
+  /// tokens can be returned as they are, without token pasting, stringizing or
+  /// comments retained by -CC.
+  ///
+  /// Identifiers in the body may still name other macros.
+  bool hasConstantBody() const {
+    if (!IsConstantBodyComputed)
+      computeHasConstantBody();
+    return HasConstantBody;
+  }
   void setHasCommaPasting() { HasCommaPasting = true; }
 
   /// \brief Return false if this macro is defined in the main file and has
@@ -246,6 +263,8 @@ public:
     assert(
         !IsDefinitionLengthCached &&
         "Changing replacement tokens after definition length got calculated");
+    assert(!IsConstantBodyComputed &&
+           "Changing replacement tokens after the body was classified");
     ReplacementTokens.push_back(Tok);
   }
 
@@ -286,6 +305,7 @@ public:
 
 private:
   unsigned getDefinitionLengthSlow(SourceManager &SM) const;
+  void computeHasConstantBody() const;
 
   void setOwningModuleID(unsigned ID) {
     assert(isFromASTFile());
@@ -75,6 +75,11 @@ public:
   /// uninterpreted string.  This switches the lexer out of directive mode.
   void DiscardToEndOfLine();
 
+  /// isTokenCacheLexer - Return true if this lexer replays an entry of a
+  /// SharedTokenCache.  The contents of the file it lexes are then known to
+  /// match the cached tokens, so text can be read back from the file.
+  bool isTokenCacheLexer() const;
+
   /// isNextPPTokenLParen - Return 1 if the next unexpanded token will return a
   /// tok::l_paren token, 0 if it is something else and 2 if there are no more
   /// tokens controlled by this lexer.
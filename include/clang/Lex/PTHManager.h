@@ -83,6 +83,12 @@ class PTHManager : public IdentifierInfoLookup {
   ///  if the file (if any) that was to used to generate the PTH cache.
   const char* OriginalSourceFile;
 
+  /// ResolveIdentifiersThroughPP - True if this PTH file is an entry of a
+  ///  SharedTokenCache.  Such files are not the external lookup of the
+  ///  IdentifierTable, so their persistent IDs are resolved to the
+  ///  Preprocessor's own IdentifierInfo objects instead of private ones.
+  bool ResolveIdentifiersThroughPP;
+
   /// This constructor is intended to only be called by the static 'Create'
   /// method.
   PTHManager(std::unique_ptr<const llvm::MemoryBuffer> buf,
@@ -90,7 +96,15 @@ class PTHManager : public IdentifierInfoLookup {
              const unsigned char *idDataTable,
              std::unique_ptr<IdentifierInfo *[], llvm::FreeDeleter> perIDCache,
              std::unique_ptr<PTHStringIdLookup> stringIdLookup, unsigned numIds,
-             const unsigned char *spellingBase, const char *originalSourceFile);
+             const unsigned char *spellingBase, const char *originalSourceFile,
+             bool resolveIdentifiersThroughPP);
+
+  /// CreateFromBuffer - Shared implementation of Create and
+  ///  CreateForTokenCache.  If 'Diags' is null, malformed files are rejected
+  ///  silently.
+  static PTHManager *CreateFromBuffer(std::unique_ptr<llvm::MemoryBuffer> File,
+                                      StringRef file, DiagnosticsEngine *Diags,
+                                      bool ResolveIdentifiersThroughPP);
 
   PTHManager(const PTHManager &) = delete;
   void operator=(const PTHManager &) = delete;
@@ -131,13 +145,27 @@ public:
   ///  is the name of the PTH file.  This method returns NULL upon failure.
   static PTHManager *Create(StringRef file, DiagnosticsEngine &Diags);
 
+  /// CreateForTokenCache - Create a PTHManager for a single-file entry of a
+  ///  SharedTokenCache.  Unlike Create, a missing or malformed file is not an
+  ///  error: this simply returns NULL and the file is lexed normally.
+  static PTHManager *CreateForTokenCache(StringRef file);
+
   void setPreprocessor(Preprocessor *pp) { PP = pp; }
 
+  /// isTokenCacheEntry - Return true if this PTH file is an entry of a
+  ///  SharedTokenCache, and so stands in for a file with known contents.
+  bool isTokenCacheEntry() const { return ResolveIdentifiersThroughPP; }
+
   /// CreateLexer - Return a PTHLexer that "lexes" the cached tokens for the
   ///  specified file.  This method returns NULL if no cached tokens exist.
   ///  It is the responsibility of the caller to 'delete' the returned object.
   PTHLexer *CreateLexer(FileID FID);
 
+  /// CreateLexerForCachedFile - Return a PTHLexer for the single file stored
+  ///  in a SharedTokenCache entry.  The entry is keyed by file contents, so
+  ///  this ignores the name of the file that FID refers to.
+  PTHLexer *CreateLexerForCachedFile(FileID FID);
+
   /// createStatCache - Returns a FileSystemStatCache object for use with
   ///  FileManager objects.  These objects use the PTH data to speed up
   ///  calls to stat by memoizing their results from when the PTH file
@@ -19,6 +19,7 @@
 #include "clang/Lex/PPCallbacks.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/PointerUnion.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/iterator.h"
 #include "llvm/Support/Allocator.h"
@@ -293,9 +294,21 @@ namespace clang {
     /// \brief Allocator used to store preprocessing objects.
     llvm::BumpPtrAllocator BumpAlloc;
 
+    /// \brief A preprocessed entity of this translation unit.
+    ///
+    /// Most entities are macro expansions, so an expansion of a macro that
+    /// has a definition record is stored as just that record, and its
+    /// \c MacroExpansion object is only created when it is asked for.
+    typedef llvm::PointerUnion<PreprocessedEntity *, MacroDefinitionRecord *>
+        LocalEntity;
+
     /// \brief The set of preprocessed entities in this record, in order they
     /// were seen.
-    std::vector<PreprocessedEntity *> PreprocessedEntities;
+    std::vector<LocalEntity> PreprocessedEntities;
+
+    /// \brief The source ranges of \c PreprocessedEntities, stored apart so
+    /// that entities can be searched by location without visiting them.
+    std::vector<SourceRange> PreprocessedEntityRanges;
     
     /// \brief The set of preprocessed entities in this record that have been
     /// loaded from external sources.
@@ -339,6 +352,10 @@ namespace clang {
 
     /// \brief Retrieve the loaded preprocessed entity at the given index.
     PreprocessedEntity *getLoadedPreprocessedEntity(unsigned Index);
+
+    /// \brief Retrieve the local preprocessed entity at the given index,
+    /// creating its object if it only has a compact form so far.
+    PreprocessedEntity *getLocalPreprocessedEntity(unsigned Index);
     
     /// \brief Determine the number of preprocessed entities that were
     /// loaded (or can be loaded) from an external source.
@@ -362,6 +379,9 @@ namespace clang {
     /// \brief Register a new macro definition.
     void RegisterMacroDefinition(MacroInfo *Macro, MacroDefinitionRecord *Def);
 
+    /// \brief Add a local entity in the order of its source location.
+    PPEntityID addLocalEntity(LocalEntity Entity, SourceRange Range);
+
   public:
     /// \brief Construct a new preprocessing record.
     explicit PreprocessingRecord(SourceManager &SM);
@@ -468,6 +488,26 @@ namespace clang {
     /// \brief Add a new preprocessed entity to this record.
     PPEntityID addPreprocessedEntity(PreprocessedEntity *Entity);
 
+    /// \brief Determine the number of preprocessed entities of this
+    /// translation unit.
+    unsigned getNumLocalPreprocessedEntities() const {
+      return PreprocessedEntities.size();
+    }
+
+    /// \brief Retrieve the source range of the local preprocessed entity at
+    /// the given index, without creating its object.
+    SourceRange getLocalPreprocessedEntityRange(unsigned Index) const {
+      assert(Index < PreprocessedEntityRanges.size() &&
+             "Out-of bounds local preprocessed entity");
+      return PreprocessedEntityRanges[Index];
+    }
+
+    /// \brief If the local preprocessed entity at the given index is an
+    /// expansion of a macro that has a definition record, retrieve that
+    /// record without creating the expansion's object.
+    MacroDefinitionRecord *
+    getLocalMacroExpansionDefinition(unsigned Index) const;
+
     /// \brief Set the external source for preprocessed entities.
     void SetExternalSource(ExternalPreprocessingRecordSource &Source);
 
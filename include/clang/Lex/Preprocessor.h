@@ -30,6 +30,7 @@
 #include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Registry.h"
@@ -58,6 +59,7 @@ class DirectoryLookup;
 class PreprocessingRecord;
 class ModuleLoader;
 class PTHManager;
+class SharedTokenCache;
 class PreprocessorOptions;
 
 /// \brief Stores token information for comparing actual tokens with
@@ -114,6 +116,10 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// a token cache rather than lexing the original source file.
   std::unique_ptr<PTHManager> PTH;
 
+  /// An optional cache of per-file token streams shared between compiles
+  /// and consulted whenever a file is entered.
+  std::unique_ptr<SharedTokenCache> TokenCache;
+
   /// A BumpPtrAllocator object used to quickly allocate and release
   /// objects internal to the Preprocessor.
   llvm::BumpPtrAllocator BP;
@@ -230,6 +236,10 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   /// \brief The offset in file for the code-completion point.
   unsigned CodeCompletionOffset;
 
+  /// \brief The identifier that starts at the code-completion point, i.e.,
+  /// the part of the name being completed that the user has typed so far.
+  std::string CodeCompletionFilter;
+
   /// \brief The location for the code-completion point. This gets instantiated
   /// when the CodeCompletionFile gets \#include'ed for preprocessing.
   SourceLocation CodeCompletionLoc;
@@ -570,6 +580,23 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   MacroArgs *MacroArgCache;
   friend class MacroArgs;
 
+  /// \brief How an \#include directive was resolved.
+  struct IncludeLookupInfo {
+    const FileEntry *File;
+    const DirectoryLookup *CurDir;
+    ModuleMap::KnownHeader SuggestedModule;
+    std::string SearchPath;
+    std::string RelativePath;
+  };
+
+  /// \brief The resolved \#include directives, keyed by the spelled file name,
+  /// whether it was angled, and the directory of the including file.
+  ///
+  /// Used to skip header search for repeated \#includes of a header that is
+  /// known to have no further effect, because it is \#pragma once or its
+  /// controlling macro is defined.
+  llvm::StringMap<IncludeLookupInfo> IncludeLookups;
+
   /// For each IdentifierInfo used in a \#pragma push_macro directive,
   /// we keep a MacroInfo stack used to restore the previous macro value.
   llvm::DenseMap<IdentifierInfo*, std::vector<MacroInfo*> > PragmaPushMacroInfo;
@@ -578,10 +605,16 @@ class Preprocessor : public RefCountedBase<Preprocessor> {
   unsigned NumDirectives, NumDefined, NumUndefined, NumPragma;
   unsigned NumIf, NumElse, NumEndif;
   unsigned NumEnteredSourceFiles, MaxIncludeStackDepth;
+  unsigned NumIncludeLookupsSkipped;
+  unsigned NumMinimizedSourceFiles, NumMinimizedSourceBytesRemoved;
   unsigned NumMacroExpanded, NumFnMacroExpanded, NumBuiltinMacroExpanded;
-  unsigned NumFastMacroExpanded, NumTokenPaste, NumFastTokenPaste;
+  unsigned NumFastMacroExpanded, NumConstantMacroExpanded;
+  unsigned NumTokenPaste, NumFastTokenPaste;
   unsigned NumSkipped;
 
+  /// \brief The number of tokens returned by Lex so far.
+  unsigned TokenCount;
+
   /// \brief The predefined macros that preprocessor should use from the
   /// command line etc.
   std::string Predefines;
@@ -704,6 +737,10 @@ public:
 
   PTHManager *getPTHManager() { return PTH.get(); }
 
+  void setTokenCache(std::unique_ptr<SharedTokenCache> TC);
+
+  SharedTokenCache *getTokenCache() { return TokenCache.get(); }
+
   void setExternalSource(ExternalPreprocessorSource *Source) {
     ExternalSource = Source;
   }
@@ -1281,6 +1318,13 @@ public:
     return CodeCompletionFileLoc;
   }
 
+  /// \brief Returns the identifier that starts at the code-completion point,
+  /// which results can be filtered by.
+  ///
+  /// Returns an empty string if code-completion is not enabled or no
+  /// identifier follows the code-completion point.
+  StringRef getCodeCompletionFilter() const { return CodeCompletionFilter; }
+
   /// \brief Returns true if code-completion is enabled and we have hit the
   /// code-completion point.
   bool isCodeCompletionReached() const { return CodeCompletionReached; }
@@ -1513,6 +1557,10 @@ public:
 
   size_t getTotalMemory() const;
 
+  /// \brief Returns the number of tokens lexed so far, including those of
+  /// directives and macro expansions.
+  unsigned getTokenCount() const { return TokenCount; }
+
   /// When the macro expander pastes together a comment (/##/) in Microsoft
   /// mode, this method handles updating the current state, returning the
   /// token on the next source line.
@@ -1821,6 +1869,10 @@ private:
   /// start getting tokens from it using the PTH cache.
   void EnterSourceFileWithPTH(PTHLexer *PL, const DirectoryLookup *Dir);
 
+  /// \brief Replace the contents of the file \p FID refers to with just its
+  /// preprocessor directives, if that hasn't been done already.
+  void minimizeSourceFile(FileID FID);
+
   /// \brief Set the FileID for the preprocessor predefines.
   void setPredefinesFileID(FileID FID) {
     assert(PredefinesFileID.isInvalid() && "PredefinesFileID already set!");
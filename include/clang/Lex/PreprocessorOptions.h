@@ -55,6 +55,16 @@ public:
   /// definitions and expansions.
   unsigned DetailedRecord : 1;
 
+  /// \brief Whether consecutive argument expansions of the same macro
+  /// invocation should share a source location entry.
+  unsigned CoalesceMacroArgExpansions : 1;
+
+  /// \brief Whether source files should be stripped down to their
+  /// preprocessor directives before they are lexed. Only the includes and
+  /// macros of the result are meaningful, so this is only suitable when
+  /// computing dependencies.
+  unsigned MinimizeSourceToDependencyDirectives : 1;
+
   /// The implicit PCH included at the start of the translation unit, or empty.
   std::string ImplicitPCHInclude;
 
@@ -75,6 +85,10 @@ public:
   /// deserialized, and we emit an error if they are; for testing purposes.
   std::set<std::string> DeserializedPCHDeclsToErrorOn;
 
+  /// \brief The number of worker threads decoding the declarations of newly
+  /// loaded AST files ahead of use, or 0 to decode them only on demand.
+  unsigned DeclPrefetchThreads;
+
   /// \brief If non-zero, the implicit PCH include is actually a precompiled
   /// preamble that covers this number of bytes in the main source file.
   ///
@@ -89,6 +103,10 @@ public:
   /// If given, a PTH cache file to use for speeding up header parsing.
   std::string TokenCache;
 
+  /// If given, a directory holding per-file token streams that are shared
+  /// with other compiles and keyed by file contents.
+  std::string TokenCacheDir;
+
   /// \brief True if the SourceManager should report the original file name for
   /// contents of files that were remapped to other files. Defaults to true.
   bool RemappedFilesKeepOriginalName;
@@ -141,9 +159,12 @@ public:
 
 public:
   PreprocessorOptions() : UsePredefines(true), DetailedRecord(false),
+                          CoalesceMacroArgExpansions(false),
+                          MinimizeSourceToDependencyDirectives(false),
                           DisablePCHValidation(false),
                           AllowPCHWithCompilerErrors(false),
                           DumpDeserializedPCHDecls(false),
+                          DeclPrefetchThreads(0),
                           PrecompiledPreambleBytes(0, true),
                           RemappedFilesKeepOriginalName(true),
                           RetainRemappedFileBuffers(false),
@@ -174,6 +195,7 @@ public:
     ImplicitPCHInclude.clear();
     ImplicitPTHInclude.clear();
     TokenCache.clear();
+    TokenCacheDir.clear();
     RetainRemappedFileBuffers = true;
     PrecompiledPreambleBytes.first = 0;
     PrecompiledPreambleBytes.second = 0;
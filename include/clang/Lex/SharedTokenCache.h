@@ -0,0 +1,89 @@
+//===--- SharedTokenCache.h - Content-addressed PTH token cache -*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the SharedTokenCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_LEX_SHAREDTOKENCACHE_H
+#define LLVM_CLANG_LEX_SHAREDTOKENCACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+#include <string>
+
+namespace llvm {
+class MemoryBuffer;
+}
+
+namespace clang {
+
+class LangOptions;
+class PTHLexer;
+class PTHManager;
+class Preprocessor;
+
+/// \brief A directory of single-file PTH token streams that is shared by
+/// every compile pointed at it.
+///
+/// Entries are named after a hash of the file contents and of the language
+/// options that affect raw lexing, so a header is found in the cache no
+/// matter which path it was included through.  Entries are memory mapped
+/// and consulted whenever the Preprocessor enters a file; the raw token
+/// stream of a hit is replayed through a PTHLexer instead of relexing the
+/// file.  New entries are written by clang::UpdateTokenCache once a compile
+/// has finished, using a rename so that concurrent writers never expose a
+/// partially written entry.
+class SharedTokenCache {
+  std::string Directory;
+  Preprocessor &PP;
+
+  /// \brief Loaded entries, keyed by entry name.  A null manager records an
+  /// entry that is known to be absent or unusable.
+  llvm::StringMap<std::unique_ptr<PTHManager>> Entries;
+
+  /// \brief The hash of the compiler version and language options, shared
+  /// by the names of all entries this cache looks up.
+  std::string ConfigurationHash;
+
+  unsigned NumHits;
+  unsigned NumMisses;
+
+  SharedTokenCache(const SharedTokenCache &) = delete;
+  void operator=(const SharedTokenCache &) = delete;
+
+public:
+  SharedTokenCache(StringRef Directory, Preprocessor &PP);
+  ~SharedTokenCache();
+
+  /// \brief The directory holding the cache entries.
+  StringRef getDirectory() const { return Directory; }
+
+  /// \brief Compute the name of the entry caching the tokens of \p Buffer.
+  std::string getEntryName(const llvm::MemoryBuffer &Buffer) const;
+
+  /// \brief Compute the path of the entry caching the tokens of \p Buffer.
+  std::string getEntryPath(const llvm::MemoryBuffer &Buffer) const;
+
+  /// \brief Return true if an entry with the given name was found in the
+  /// cache during this compile.
+  bool hasEntry(StringRef EntryName) const;
+
+  /// \brief Return a PTHLexer replaying the cached tokens of the file \p FID,
+  /// or null if there is no usable entry for it.  The caller owns the lexer.
+  PTHLexer *CreateLexer(FileID FID);
+
+  void PrintStats() const;
+};
+
+}  // end namespace clang
+
+#endif
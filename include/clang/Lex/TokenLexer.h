@@ -99,6 +99,12 @@ class TokenLexer {
   /// should not be subject to further macro expansion.
   bool DisableMacroExpansion : 1;
 
+  /// IsConstantExpansion - This is true when expanding a macro whose body has
+  /// no pasting, stringizing or comments (see MacroInfo::hasConstantBody), so
+  /// every token comes straight from the definition and can be relocated
+  /// into the expansion without further checks.
+  bool IsConstantExpansion : 1;
+
   TokenLexer(const TokenLexer &) = delete;
   void operator=(const TokenLexer &) = delete;
 public:
@@ -174,6 +174,7 @@ class Parser : public CodeCompletionHandler {
   std::unique_ptr<PragmaHandler> LoopHintHandler;
   std::unique_ptr<PragmaHandler> UnrollHintHandler;
   std::unique_ptr<PragmaHandler> NoUnrollHintHandler;
+  std::unique_ptr<PragmaHandler> NeonLazyIntrinsicsHandler;
 
   std::unique_ptr<CommentHandler> CommentSemaHandler;
 
@@ -1195,6 +1196,9 @@ private:
   static void LateTemplateParserCallback(void *P, LateParsedTemplate &LPT);
   static void LateTemplateParserCleanupCallback(void *P);
 
+  void ParseLazyNeonIntrinsic(StringRef Definition);
+  static void LazyNeonIntrinsicParserCallback(void *P, StringRef Definition);
+
   Sema::ParsingClassState
   PushParsingClass(Decl *TagOrTemplate, bool TopLevelClass, bool IsInterface);
   void DeallocateParsedClasses(ParsingClass *Class);
@@ -2011,6 +2015,22 @@ private:
     True, False, Ambiguous, Error
   };
 
+  /// \brief A disambiguation by isCXXFunctionDeclarator, which only holds
+  /// while the same identifiers are tentatively declared, in the same scope
+  /// and context, and before any further declaration is made visible.
+  struct FunctionDeclaratorDisambiguation {
+    SmallVector<IdentifierInfo *, 2> TentativelyDeclared;
+    Scope *S;
+    DeclContext *DC;
+    unsigned NumScopeChainDecls;
+    TPResult Result;
+  };
+
+  /// \brief The disambiguations by isCXXFunctionDeclarator within the current
+  /// top-level declaration, by the location of the '('.
+  llvm::DenseMap<unsigned, FunctionDeclaratorDisambiguation>
+      FunctionDeclaratorResults;
+
   /// \brief Based only on the given token kind, determine whether we know that
   /// we're at the start of an expression or a type-specifier-seq (which may
   /// be an expression, in C++).
@@ -14,7 +14,11 @@
 #ifndef LLVM_CLANG_REWRITE_CORE_DELTATREE_H
 #define LLVM_CLANG_REWRITE_CORE_DELTATREE_H
 
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Compiler.h"
+#include <utility>
 
 namespace clang {
 
@@ -26,15 +30,28 @@ namespace clang {
   /// efficiently tell us the full accumulated delta for a specific file offset
   /// as well, without traversing the whole tree.
   class DeltaTree {
+    /// Allocator - The nodes of the tree.  Nodes are never removed, so they
+    /// are all freed with the tree.
+    llvm::BumpPtrAllocator Allocator;
     void *Root;    // "DeltaTreeNode *"
     void operator=(const DeltaTree &) = delete;
   public:
     DeltaTree();
 
+    /// Build a tree holding \p Deltas, which are pairs of a file index and a
+    /// delta, sorted by file index and without duplicate indices.  This is
+    /// faster than adding the deltas one at a time.
+    explicit DeltaTree(ArrayRef<std::pair<unsigned, int>> Deltas);
+
     // Note: Currently we only support copying when the RHS is empty.
     DeltaTree(const DeltaTree &RHS);
     ~DeltaTree();
 
+    /// empty - Return true if no delta has been added to this tree.
+    bool empty() const;
+
+    void swap(DeltaTree &RHS);
+
     /// getDeltaAt - Return the accumulated delta at the specified file offset.
     /// This includes all insertions or delections that occurred *before* the
     /// specified file index.
@@ -15,8 +15,11 @@
 #ifndef LLVM_CLANG_REWRITE_CORE_HTMLREWRITE_H
 #define LLVM_CLANG_REWRITE_CORE_HTMLREWRITE_H
 
+#include "clang/Basic/LLVM.h"
 #include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/ArrayRef.h"
 #include <string>
+#include <vector>
 
 namespace clang {
 
@@ -75,6 +78,30 @@ namespace html {
   /// reasonably close.
   void HighlightMacros(Rewriter &R, FileID FID, const Preprocessor &PP);
 
+  /// HighlightedRange - A range of a file, given as offsets, and the tags
+  /// to insert around it.
+  struct HighlightedRange {
+    unsigned B, E;
+    std::string StartTag, EndTag;
+  };
+
+  /// ComputeSyntaxHighlighting - Relex the specified FileID and append the
+  /// ranges that SyntaxHighlight would highlight to Ranges.  Relexing is
+  /// what makes highlighting expensive, so ranges computed once can be
+  /// applied to any number of rewrites of the same file.
+  void ComputeSyntaxHighlighting(FileID FID, const Preprocessor &PP,
+                                 std::vector<HighlightedRange> &Ranges);
+
+  /// ComputeMacroHighlighting - Reexpand the macros of the specified FileID
+  /// and append the ranges that HighlightMacros would highlight to Ranges.
+  void ComputeMacroHighlighting(FileID FID, const Preprocessor &PP,
+                                std::vector<HighlightedRange> &Ranges);
+
+  /// ApplyHighlighting - Highlight the given ranges of the specified FileID,
+  /// in order.
+  void ApplyHighlighting(Rewriter &R, FileID FID,
+                         ArrayRef<HighlightedRange> Ranges);
+
 } // end html namespace
 } // end clang namespace
 
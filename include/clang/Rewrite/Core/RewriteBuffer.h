@@ -13,6 +13,7 @@
 #include "clang/Basic/LLVM.h"
 #include "clang/Rewrite/Core/DeltaTree.h"
 #include "clang/Rewrite/Core/RewriteRope.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -87,6 +88,21 @@ public:
   void ReplaceText(unsigned OrigOffset, unsigned OrigLength,
                    StringRef NewStr);
 
+  /// Edit - A replacement of OrigLength characters at OrigOffset in the
+  /// original SourceBuffer by NewStr, as passed to ApplyEdits().
+  struct Edit {
+    unsigned OrigOffset;
+    unsigned OrigLength;
+    StringRef NewStr;
+  };
+
+  /// ApplyEdits - Apply a batch of replacements.  This is the same as calling
+  /// ReplaceText() for each of them in order, but if they are sorted by offset
+  /// and do not overlap, the buffer is rebuilt in a single linear pass rather
+  /// than edited once per replacement.  Replacements at the same offset are
+  /// always applied one at a time.
+  void ApplyEdits(ArrayRef<Edit> Edits);
+
 private:  // Methods only usable by Rewriter.
 
   /// getMappedOffset - Given an offset into the original SourceBuffer that this
@@ -15,6 +15,7 @@
 #define LLVM_CLANG_SEMA_ANALYSISBASEDWARNINGS_H
 
 #include "llvm/ADT/DenseMap.h"
+#include <chrono>
 
 namespace clang {
 
@@ -85,6 +86,23 @@ private:
   /// a single function.
   unsigned MaxUninitAnalysisBlockVisitsPerFunction;
 
+  /// \brief The steps of IssueWarnings that are timed separately.
+  enum AnalysisKind {
+    AK_CFG,
+    AK_UnreachableDiags,
+    AK_ReturnFallThrough,
+    AK_UnreachableCode,
+    AK_ThreadSafety,
+    AK_Consumed,
+    AK_Uninitialized,
+    AK_SwitchFallThrough,
+    AK_InfiniteRecursion,
+    NumAnalysisKinds
+  };
+
+  /// \brief Total time spent in each step, indexed by AnalysisKind.
+  std::chrono::steady_clock::duration AnalysisTimes[NumAnalysisKinds];
+
   /// @}
 
 public:
@@ -907,6 +907,19 @@ public:
     return CodeCompleteOpts.IncludeBriefComments;
   }
 
+  /// \brief Whether to drop the results whose typed text does not start with
+  /// the identifier at the code-completion point.
+  bool filterByTypedText() const {
+    return CodeCompleteOpts.FilterByTypedText;
+  }
+
+  /// \brief Determine whether the given result should be dropped because its
+  /// typed text does not start with \p Filter, ignoring case.
+  ///
+  /// This does not build the completion string of the result.
+  static bool isResultFilteredOut(StringRef Filter,
+                                  const CodeCompletionResult &Result);
+
   /// \brief Determine whether the output of this consumer is binary.
   bool isOutputBinary() const { return OutputIsBinary; }
 
@@ -27,11 +27,17 @@ public:
   /// Show brief documentation comments in code completion results.
   unsigned IncludeBriefComments : 1;
 
+  /// Show only the results whose typed text starts with the identifier at
+  /// the code-completion point, dropping the others before their completion
+  /// strings are built.
+  unsigned FilterByTypedText : 1;
+
   CodeCompleteOptions() :
       IncludeMacros(0),
       IncludeCodePatterns(0),
       IncludeGlobals(1),
-      IncludeBriefComments(0)
+      IncludeBriefComments(0),
+      FilterByTypedText(0)
   { }
 };
 
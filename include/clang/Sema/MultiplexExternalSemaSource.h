@@ -82,6 +82,9 @@ public:
   /// a statement.
   Stmt *GetExternalDeclStmt(uint64_t Offset) override;
 
+  /// \brief Returns the first answer other than EK_ReplyHazy.
+  ExtKind hasExternalDefinitions(const Decl *D) override;
+
   /// \brief Resolve the offset of a set of C++ base specifiers in the decl
   /// stream into an array of specifiers.
   CXXBaseSpecifier *GetExternalCXXBaseSpecifiers(uint64_t Offset) override;
@@ -183,6 +186,11 @@ public:
                  llvm::DenseMap<const CXXRecordDecl *,
                                 CharUnits> &VirtualBaseOffsets) override;
 
+  /// \brief Retrieve the complete layout of the given record from the first
+  /// source that has one.
+  const ASTRecordLayout *
+  getExternalRecordLayout(const RecordDecl *Record) override;
+
   /// Return the amount of memory used by memory buffers, breaking down
   /// by heap-backed versus mmap'ed memory.
   void getMemoryBufferSizes(MemoryBufferSizes &sizes) const override;
@@ -23,6 +23,7 @@
 #include "clang/AST/UnresolvedSet.h"
 #include "clang/Sema/SemaFixItUtils.h"
 #include "clang/Sema/TemplateDeduction.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/AlignOf.h"
@@ -725,6 +726,14 @@ namespace clang {
     llvm::AlignedCharArray<llvm::AlignOf<ImplicitConversionSequence>::Alignment,
                            16 * sizeof(ImplicitConversionSequence)> InlineSpace;
 
+    /// \brief The conversion sequences computed so far for the candidates,
+    /// keyed by argument, parameter type and conversion flags. Candidates
+    /// often share parameter types, e.g. the many overloads of operator<<
+    /// taking an ostream, so these are reused rather than recomputed.
+    typedef std::pair<std::pair<Expr *, QualType>, unsigned> ConversionKey;
+    llvm::SmallDenseMap<ConversionKey, const ImplicitConversionSequence *, 4>
+        ComputedConversions;
+
     OverloadCandidateSet(const OverloadCandidateSet &) = delete;
     void operator=(const OverloadCandidateSet &) = delete;
 
@@ -747,6 +756,25 @@ namespace clang {
     /// \brief Clear out all of the candidates.
     void clear();
 
+    /// \brief Find the conversion sequence computed for a previous candidate
+    /// converting \p From to \p ToType with the given flags, if any.
+    const ImplicitConversionSequence *
+    getComputedConversion(Expr *From, QualType ToType, unsigned Flags) const {
+      auto Known = ComputedConversions.find(
+          std::make_pair(std::make_pair(From, ToType), Flags));
+      if (Known == ComputedConversions.end())
+        return nullptr;
+      return Known->second;
+    }
+
+    /// \brief Remember the conversion sequence of a candidate, which must be
+    /// stored in one of its conversion slots.
+    void addComputedConversion(Expr *From, QualType ToType, unsigned Flags,
+                               const ImplicitConversionSequence &ICS) {
+      ComputedConversions[std::make_pair(std::make_pair(From, ToType), Flags)] =
+          &ICS;
+    }
+
     typedef SmallVectorImpl<OverloadCandidate>::iterator iterator;
     iterator begin() { return Candidates.begin(); }
     iterator end() { return Candidates.end(); }
@@ -49,6 +49,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/TinyPtrVector.h"
 #include <deque>
 #include <memory>
@@ -173,6 +174,7 @@ namespace clang {
   class TypedefDecl;
   class TypedefNameDecl;
   class TypeLoc;
+  class TypeLocBuilderBufferCache;
   class TypoCorrectionConsumer;
   class UnqualifiedId;
   class UnresolvedLookupExpr;
@@ -204,6 +206,10 @@ namespace sema {
   class TemplateDeductionInfo;
 }
 
+namespace analyze_format_string {
+  class PrintfStringCache;
+}
+
 namespace threadSafety {
   class BeforeSet;
   void threadSafetyCleanup(BeforeSet* Cache);
@@ -303,6 +309,11 @@ public:
   /// \brief Flag indicating whether or not to collect detailed statistics.
   bool CollectStats;
 
+  /// \brief Whether the parser, when it skips function bodies, may also skip
+  /// the ones written in the main file. When false, only the bodies of
+  /// non-template functions written outside the main file are skipped.
+  bool SkipMainFileFunctionBodies;
+
   /// \brief Code-completion consumer.
   CodeCompleteConsumer *CodeCompleter;
 
@@ -477,6 +488,10 @@ public:
   /// FieldCollector - Collects CXXFieldDecls during parsing of C++ classes.
   std::unique_ptr<CXXFieldCollector> FieldCollector;
 
+  /// \brief Heap buffers of the TypeLocBuilders used to transform types
+  /// during template instantiation, kept for reuse.
+  std::unique_ptr<TypeLocBuilderBufferCache> TypeLocBuilderBuffers;
+
   typedef llvm::SmallSetVector<const NamedDecl*, 16> NamedDeclSetType;
 
   /// \brief Set containing all declared private fields that are not used.
@@ -567,6 +582,21 @@ public:
     OpaqueParser = P;
   }
 
+  /// \brief Callback to the parser to parse the definition of a NEON
+  /// intrinsic when it is first used, under -flazy-neon-intrinsics.
+  typedef void LazyNeonIntrinsicParserCB(void *P, StringRef Definition);
+  LazyNeonIntrinsicParserCB *LazyNeonIntrinsicParser;
+  void *OpaqueNeonParser;
+
+  void SetLazyNeonIntrinsicParser(LazyNeonIntrinsicParserCB *LNP, void *P) {
+    LazyNeonIntrinsicParser = LNP;
+    OpaqueNeonParser = P;
+  }
+
+  /// \brief The NEON intrinsics that arm_neon.h enabled and that have not
+  /// been defined yet, mapped to their entries in the table of definitions.
+  llvm::StringMap<unsigned> PendingNeonIntrinsics;
+
   class DelayedDiagnostics;
 
   class DelayedDiagnosticsState {
@@ -958,6 +988,27 @@ public:
   /// \brief The number of SFINAE diagnostics that have been trapped.
   unsigned NumSFINAEErrors;
 
+  /// \brief The number of pending function and variable instantiations
+  /// performed by PerformPendingInstantiations.
+  unsigned NumPendingFunctionInstantiations;
+  unsigned NumPendingVariableInstantiations;
+
+  /// \brief The largest number of instantiations that were pending at once.
+  unsigned MaxPendingInstantiations;
+
+  /// \brief The function template specializations deduced successfully from
+  /// the arguments of a call, keyed by the function template, the context of
+  /// the call and the types and value kinds of the arguments.
+  llvm::StringMap<FunctionDecl *> DeducedCallSpecializations;
+
+  /// \brief The number of deductions from call arguments answered from
+  /// DeducedCallSpecializations.
+  unsigned NumDeducedCallSpecializationsReused;
+
+  /// \brief The number of declarations pushed onto the scope chains, which
+  /// lets the parser tell whether name lookup may have changed.
+  unsigned NumScopeChainDecls;
+
   typedef llvm::DenseMap<ParmVarDecl *, llvm::TinyPtrVector<ParmVarDecl *>>
     UnparsedDefaultArgInstantiationsMap;
 
@@ -998,6 +1049,11 @@ public:
   /// methods inside categories with a particular selector.
   GlobalMethodPool MethodPool;
 
+  /// Direct methods, keyed by selector. They are kept out of the method pool
+  /// so that messages to "id" never bind to them, and are only recorded to
+  /// diagnose such messages.
+  llvm::DenseMap<Selector, ObjCMethodDecl *> DirectMethods;
+
   /// Method selectors used in a \@selector expression. Used for implementation
   /// of -Wselector.
   llvm::MapVector<Selector, SourceLocation> ReferencedSelectors;
@@ -6499,6 +6555,14 @@ public:
                           sema::TemplateDeductionInfo &Info,
                           bool PartialOverloading = false);
 
+  TemplateDeductionResult
+  DeduceTemplateArgumentsFromCall(FunctionTemplateDecl *FunctionTemplate,
+                                  TemplateArgumentListInfo *ExplicitTemplateArgs,
+                                  ArrayRef<Expr *> Args,
+                                  FunctionDecl *&Specialization,
+                                  sema::TemplateDeductionInfo &Info,
+                                  bool PartialOverloading);
+
   TemplateDeductionResult
   DeduceTemplateArguments(FunctionTemplateDecl *FunctionTemplate,
                           TemplateArgumentListInfo *ExplicitTemplateArgs,
@@ -7018,6 +7082,10 @@ public:
   /// given location are ignored if typo correction already failed for it.
   IdentifierSourceLocations TypoCorrectionFailures;
 
+  /// \brief The identifiers that unqualified typos were compared against, and
+  /// the ones found close to each typo, created by the first typo correction.
+  std::unique_ptr<TypoCorrectionIdentifierIndex> TypoCorrectionIndex;
+
   /// \brief Worker object for performing CFG-based warnings.
   sema::AnalysisBasedWarnings AnalysisWarnings;
   threadSafety::BeforeSet *ThreadSafetyDeclCache;
@@ -7855,6 +7923,9 @@ public:
   /// \brief Called on well formed \#pragma clang optimize.
   void ActOnPragmaOptimize(bool On, SourceLocation PragmaLoc);
 
+  /// \brief Called on well formed \#pragma clang neon_lazy_intrinsics.
+  void ActOnPragmaNeonLazyIntrinsics(unsigned Group, SourceLocation PragmaLoc);
+
   /// \brief Get the location for the currently active "\#pragma clang optimize
   /// off". If this location is invalid, then the state of the pragma is "on".
   SourceLocation getOptimizeOffPragmaLocation() const {
@@ -9420,6 +9491,10 @@ public:
   static FormatStringType GetFormatStringType(const FormatAttr *Format);
 
   bool FormatStringHasSArg(const StringLiteral *FExpr);
+
+  /// \brief The printf format strings checked so far, so that each distinct
+  /// string is parsed once. Created on first use.
+  std::unique_ptr<analyze_format_string::PrintfStringCache> PrintfStrings;
   
   static bool GetFormatNSStringIdx(const FormatAttr *Format, unsigned &Idx);
 
@@ -44,13 +44,17 @@ class TemplateDeductionInfo {
   /// SFINAE while performing template argument deduction.
   SmallVector<PartialDiagnosticAt, 4> SuppressedDiagnostics;
 
+  /// \brief Was the last warning suppressed during deduction dropped because
+  /// it would be ignored anyway? If so, so are the notes that follow it.
+  bool DroppedSuppressedDiagnostic;
+
   TemplateDeductionInfo(const TemplateDeductionInfo &) = delete;
   void operator=(const TemplateDeductionInfo &) = delete;
 
 public:
   TemplateDeductionInfo(SourceLocation Loc)
     : Deduced(nullptr), Loc(Loc), HasSFINAEDiagnostic(false),
-      Expression(nullptr) {}
+      DroppedSuppressedDiagnostic(false), Expression(nullptr) {}
 
   /// \brief Returns the location at which template argument is
   /// occurring.
@@ -101,8 +105,22 @@ public:
     if (HasSFINAEDiagnostic)
       return;
     SuppressedDiagnostics.emplace_back(Loc, std::move(PD));
+    DroppedSuppressedDiagnostic = false;
   }
 
+  /// \brief Would a suppressed diagnostic be dropped by
+  /// addSuppressedDiagnostic, or is it a note to a dropped warning?
+  ///
+  /// Checking this first avoids copying the arguments of diagnostics that
+  /// will never be emitted.
+  bool isSuppressedDiagnosticDropped(bool IsNote) const {
+    return HasSFINAEDiagnostic || (IsNote && DroppedSuppressedDiagnostic);
+  }
+
+  /// \brief Drop a suppressed warning that would be ignored if it were
+  /// emitted, along with the notes that follow it.
+  void dropSuppressedDiagnostic() { DroppedSuppressedDiagnostic = true; }
+
   /// \brief Iterator over the set of suppressed diagnostics.
   typedef SmallVectorImpl<PartialDiagnosticAt>::const_iterator
     diag_iterator;
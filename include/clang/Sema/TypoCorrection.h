@@ -18,10 +18,16 @@
 #include "clang/AST/DeclCXX.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Ownership.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringSet.h"
+#include <vector>
 
 namespace clang {
 
+class IdentifierTable;
+
 /// @brief Simple class containing the result of Sema::CorrectTypo
 class TypoCorrection {
 public:
@@ -361,6 +367,54 @@ public:
   }
 };
 
+/// @brief The names of the identifiers known to a translation unit, in the
+/// order they were first seen, together with the names found to be close to
+/// each typo that was corrected.
+///
+/// Correcting the same typo again only compares it against the identifiers
+/// seen since it was last corrected.
+class TypoCorrectionIdentifierIndex {
+  struct TypoCandidates {
+    /// The number of names in the index the typo was compared against.
+    unsigned NumNamesCompared = 0;
+
+    /// The names close enough to the typo to be corrections for it.
+    SmallVector<StringRef, 4> Names;
+  };
+
+  llvm::StringSet<> KnownNames;
+  std::vector<StringRef> Names;
+  llvm::DenseMap<IdentifierInfo *, TypoCandidates> Typos;
+
+  /// The number of identifiers in the identifier table when it was last
+  /// walked.
+  unsigned NumTableIdentifiers = 0;
+
+  /// Whether the external identifiers were walked, and the generation of the
+  /// external AST source when they last were.
+  bool WalkedExternalIdentifiers = false;
+  uint32_t ExternalGeneration = 0;
+
+  uint64_t NumComparisons = 0;
+
+  void addName(StringRef Name);
+
+public:
+  /// @brief Calls \p Found with the name of each identifier in \p Idents or
+  /// its external identifier lookup that is close enough to \p Typo to be a
+  /// correction for it.
+  ///
+  /// \param Generation the generation of the external AST source, which
+  /// tells whether the external identifiers need to be walked again.
+  void findCandidates(IdentifierInfo *Typo, IdentifierTable &Idents,
+                      uint32_t Generation,
+                      llvm::function_ref<void(StringRef)> Found);
+
+  /// @brief The number of times a typo was compared against the name of an
+  /// identifier.
+  uint64_t getNumComparisons() const { return NumComparisons; }
+};
+
 }
 
 #endif
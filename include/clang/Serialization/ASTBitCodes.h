@@ -36,7 +36,7 @@ namespace clang {
     /// Version 4 of AST files also requires that the version control branch and
     /// revision match exactly, since there is no backward compatibility of
     /// AST files at this time.
-    const unsigned VERSION_MAJOR = 6;
+    const unsigned VERSION_MAJOR = 8;
 
     /// \brief AST file minor version number supported by this version of
     /// Clang.
@@ -293,6 +293,10 @@ namespace clang {
 
       /// \brief Record code for the module build directory.
       MODULE_DIRECTORY,
+
+      /// \brief Record code for a hash of the names, sizes and modification
+      /// times of all input files.
+      INPUT_FILES_HASH,
     };
 
     /// \brief Record types that occur within the options block inside
@@ -580,7 +584,19 @@ namespace clang {
       MSSTRUCT_PRAGMA_OPTIONS = 55,
 
       /// \brief Record code for \#pragma ms_struct options.
-      POINTERS_TO_MEMBERS_PRAGMA_OPTIONS = 56
+      POINTERS_TO_MEMBERS_PRAGMA_OPTIONS = 56,
+
+      /// \brief The list of functions whose definitions are emitted in the
+      /// object file of the module, with -fmodules-codegen.
+      MODULAR_CODEGEN_DECLS = 57,
+
+      /// \brief Record code for the layouts of the records that were laid out
+      /// while building the AST file.
+      RECORD_LAYOUTS = 58,
+
+      /// \brief Record code for the macro argument expansions that were
+      /// coalesced into the preceding source location entries.
+      COALESCED_MACRO_ARG_EXPANSIONS = 59
     };
 
     /// \brief Record types used within a source manager block.
@@ -601,7 +617,11 @@ namespace clang {
       SM_SLOC_BUFFER_BLOB_COMPRESSED = 4,
       /// \brief Describes a source location entry (SLocEntry) for a
       /// macro expansion.
-      SM_SLOC_EXPANSION_ENTRY = 5
+      SM_SLOC_EXPANSION_ENTRY = 5,
+      /// \brief Describes the data for a buffer entry that is kept in a
+      /// store shared between AST files, in a file named after a hash of
+      /// the data. The blob is the name of that file.
+      SM_SLOC_BUFFER_BLOB_SHARED = 6
     };
 
     /// \brief Record types used within a preprocessor block.
@@ -1485,7 +1505,9 @@ namespace clang {
       EXPR_OBJC_BRIDGED_CAST,     // ObjCBridgedCastExpr
       
       STMT_MS_DEPENDENT_EXISTS,   // MSDependentExistsStmt
-      EXPR_LAMBDA                 // LambdaExpr
+      EXPR_LAMBDA,                // LambdaExpr
+
+      EXPR_PACKED_ARRAY_INIT      // PackedArrayInitExpr
     };
 
     /// \brief The kinds of designators that can occur in a
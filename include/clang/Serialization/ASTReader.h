@@ -47,6 +47,7 @@
 #include "llvm/Support/DataTypes.h"
 #include "llvm/Support/Timer.h"
 #include <deque>
+#include <future>
 #include <map>
 #include <memory>
 #include <string>
@@ -55,6 +56,7 @@
 
 namespace llvm {
   class MemoryBuffer;
+  class ThreadPool;
 }
 
 namespace clang {
@@ -539,10 +541,22 @@ private:
   /// \brief Functions or methods that have bodies that will be attached.
   PendingBodiesMap PendingBodies;
 
+  /// \brief The functions whose definitions are emitted in the object file of
+  /// the module that provides them, mapped to whether that module is the main
+  /// file, whose object file is being built.
+  llvm::DenseMap<const Decl *, bool> DefinitionSource;
+
   /// \brief Definitions for which we have added merged definitions but not yet
   /// performed deduplication.
   llvm::SetVector<NamedDecl*> PendingMergedDefinitionsToDeduplicate;
 
+  /// \brief Replace \p Table, a blob of \p F holding a compressed table, by
+  /// its decompressed contents if \p UncompressedSize is nonzero.
+  ///
+  /// \returns true if an error occurred.
+  bool decompressTable(ModuleFile &F, StringRef &Table,
+                       uint64_t UncompressedSize);
+
   /// \brief Read the record that describes the lexical contents of a DC.
   bool ReadLexicalDeclContextStorage(ModuleFile &M,
                                      llvm::BitstreamCursor &Cursor,
@@ -901,6 +915,11 @@ private:
   /// pool within a specific module and found something.
   unsigned NumMethodPoolTableHits;
 
+  /// \brief The number of methods found in a module's method pool that were
+  /// already in Sema's global pool, typically because another module
+  /// re-exported them.
+  unsigned NumMethodPoolDuplicates;
+
   /// \brief The total number of method pool entries in the selector table.
   unsigned TotalNumMethodPoolEntries;
 
@@ -913,6 +932,53 @@ private:
   /// Total size of modules, in bits, currently loaded
   uint64_t TotalModulesSizeInBits;
 
+  /// \brief A declaration record decoded ahead of use by
+  /// prefetchDeclRecords().
+  struct PrefetchedDeclRecord {
+    ModuleFile *F;
+    uint64_t Offset;
+    unsigned Code;
+    /// \brief The bit offset just past the record, where the statements and
+    /// expressions of the declaration begin.
+    uint64_t EndBitOffset;
+    std::vector<uint64_t> Record;
+  };
+
+  /// \brief The records one worker thread decodes ahead of use.
+  ///
+  /// The worker only writes the records, through its own copies of the
+  /// cursors. The main thread creates and destroys everything else, and only
+  /// reads the records once Done is ready.
+  struct DeclPrefetchTask {
+    std::map<ModuleFile *, llvm::BitstreamCursor> Cursors;
+    std::vector<PrefetchedDeclRecord> Records;
+    std::shared_future<void> Done;
+  };
+
+  /// \brief The number of worker threads decoding declaration records of
+  /// newly loaded AST files ahead of use, or 0 to only decode on demand.
+  unsigned DeclPrefetchThreads;
+
+  /// \brief The tasks of the batch of declaration records being decoded.
+  std::vector<DeclPrefetchTask> DeclPrefetchTasks;
+
+  /// \brief The declaration records of the batch that were not read yet,
+  /// keyed by their module file and bit offset within it, with the index of
+  /// their task and their index in it.
+  llvm::DenseMap<std::pair<ModuleFile *, uint64_t>,
+                 std::pair<unsigned, unsigned>> PrefetchedDeclRecords;
+
+  /// \brief The worker threads. Destroyed first, which waits for the tasks.
+  std::unique_ptr<llvm::ThreadPool> DeclPrefetchPool;
+
+  /// \brief The number of declaration records decoded ahead of use, and how
+  /// many of those were then read.
+  unsigned NumDeclRecordsPrefetched, NumPrefetchedDeclRecordsUsed;
+
+  /// \brief The number of PCH files whose input files weren't checked because
+  /// that was done earlier in the build session.
+  unsigned NumPCHValidationsSkipped;
+
   /// \brief Number of Decl/types that are currently deserializing.
   unsigned NumCurrentElementsDeserializing;
 
@@ -1010,6 +1076,20 @@ private:
   /// when merging implicit instantiations of class templates across modules.
   llvm::DenseMap<DeclContext *, DeclContext *> MergedDeclContexts;
 
+  /// \brief The ODR hashes that the modules defining them stored for class
+  /// definitions, by definition.
+  llvm::DenseMap<const CXXRecordDecl *, uint64_t> DefinitionODRHashes;
+
+  /// \brief The merged definitions in MergedDeclContexts whose ODR hash
+  /// matches that of the definition they were merged into.
+  llvm::SmallPtrSet<const DeclContext *, 16> ODRHashMatchedDefinitions;
+
+  /// \brief The record layouts stored in the loaded AST files that have not
+  /// been read yet, as the module file and the position of the layout in its
+  /// RecordLayouts, by the global ID of the record.
+  llvm::DenseMap<serialization::DeclID, std::pair<ModuleFile *, unsigned>>
+      PendingRecordLayouts;
+
   /// \brief A mapping from canonical declarations of enums to their canonical
   /// definitions. Only populated when using modules in C++.
   llvm::DenseMap<EnumDecl *, EnumDecl *> EnumDefinitions;
@@ -1177,6 +1257,7 @@ private:
   RecordLocation TypeCursorForIndex(unsigned Index);
   void LoadedDecl(unsigned Index, Decl *D);
   Decl *ReadDeclRecord(serialization::DeclID ID);
+  void prefetchDeclRecords(ArrayRef<ImportedModule> Loaded);
   void markIncompleteDeclChain(Decl *Canon);
 
   /// \brief Returns the most recent declaration of a declaration (which must be
@@ -1757,6 +1838,11 @@ public:
   /// the ASTConsumer.
   void StartTranslationUnit(ASTConsumer *Consumer) override;
 
+  /// \brief Read the layout of the given record if it was laid out when
+  /// its AST file was built.
+  const ASTRecordLayout *
+  getExternalRecordLayout(const RecordDecl *Record) override;
+
   /// \brief Print some statistics about AST usage.
   void PrintStats() override;
 
@@ -1910,6 +1996,8 @@ public:
   /// \brief Return a descriptor for the corresponding module.
   llvm::Optional<ASTSourceDescriptor> getSourceDescriptor(unsigned ID) override;
 
+  ExtKind hasExternalDefinitions(const Decl *D) override;
+
   /// \brief Retrieve a selector from the given module with its local ID
   /// number.
   Selector getLocalSelector(ModuleFile &M, unsigned LocalID);
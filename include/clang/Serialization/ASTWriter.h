@@ -130,6 +130,14 @@ private:
   /// file is up to date, but not otherwise.
   bool IncludeTimestamps;
 
+  /// \brief Indicates whether the type and declaration offset tables and the
+  /// lexical contents of declaration contexts are compressed.
+  bool CompressTables;
+
+  /// \brief The directory in which the contents of embedded files are kept
+  /// and shared with other AST files, or empty to embed them in the AST file.
+  std::string EmbeddedContentsStore;
+
   /// \brief Indicates when the AST writing is actively performing
   /// serialization, rather than just queueing updates.
   bool WritingAST;
@@ -367,6 +375,11 @@ private:
   /// record.
   SmallVector<uint64_t, 16> EagerlyDeserializedDecls;
 
+  /// \brief The functions whose definitions are emitted in the object file of
+  /// the module being written, with -fmodules-codegen. They are stored in a
+  /// MODULAR_CODEGEN_DECLS record.
+  SmallVector<uint64_t, 16> ModularCodegenDecls;
+
   /// \brief DeclContexts that have received extensions since their serialized
   /// form.
   ///
@@ -462,6 +475,7 @@ private:
   void WriteFPPragmaOptions(const FPOptions &Opts);
   void WriteOpenCLExtensions(Sema &SemaRef);
   void WriteObjCCategories();
+  void WriteRecordLayouts(ASTContext &Context);
   void WriteLateParsedTemplates(Sema &SemaRef);
   void WriteOptimizePragmaOptions(Sema &SemaRef);
   void WriteMSStructPragmaOptions(Sema &SemaRef);
@@ -498,7 +512,8 @@ public:
   /// the given bitstream.
   ASTWriter(llvm::BitstreamWriter &Stream,
             ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
-            bool IncludeTimestamps = true);
+            bool IncludeTimestamps = true, bool CompressTables = false,
+            StringRef EmbeddedContentsStore = StringRef());
   ~ASTWriter() override;
 
   const LangOptions &getLangOpts() const;
@@ -603,6 +618,14 @@ public:
   void EmitRecordWithPath(unsigned Abbrev, RecordDataRef Record,
                           StringRef Path);
 
+  /// \brief Emit the current record with the given table as a blob,
+  /// compressed if table compression is enabled and that makes it smaller.
+  ///
+  /// When table compression is enabled, the size of the uncompressed table,
+  /// or zero if it was stored as is, is appended to the record.
+  void EmitRecordWithTable(unsigned Abbrev, RecordDataImpl &Record,
+                           StringRef Table);
+
   /// \brief Add a version tuple to the given record
   void AddVersionTuple(const VersionTuple &Version, RecordDataImpl &Record);
 
@@ -931,7 +954,9 @@ public:
     std::shared_ptr<PCHBuffer> Buffer,
     ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
     bool AllowASTWithErrors = false,
-    bool IncludeTimestamps = true);
+    bool IncludeTimestamps = true,
+    bool CompressTables = false,
+    StringRef EmbeddedContentsStore = StringRef());
   ~PCHGenerator() override;
   void InitializeSema(Sema &S) override { SemaPtr = &S; }
   void HandleTranslationUnit(ASTContext &Ctx) override;
@@ -169,6 +169,10 @@ public:
   /// \brief The size of this file, in bits.
   uint64_t SizeInBits;
 
+  /// \brief The tables of this AST file that were stored compressed, once
+  /// they have been decompressed.
+  std::vector<std::unique_ptr<llvm::MemoryBuffer>> DecompressedTables;
+
   /// \brief The global bit offset (or base) of this module
   uint64_t GlobalBitOffset;
 
@@ -215,6 +219,10 @@ public:
   /// The time is specified in seconds since the start of the Epoch.
   uint64_t InputFilesValidationTimestamp;
 
+  /// \brief A hash of the names, sizes and modification times of all input
+  /// files, or zero if the AST file doesn't record one.
+  uint64_t InputFilesHash;
+
   // === Source Locations ===
 
   /// \brief Cursor used to read source location entries.
@@ -236,6 +244,10 @@ public:
   /// \brief SLocEntries that we're going to preload.
   SmallVector<uint64_t, 4> PreloadSLocEntries;
 
+  /// \brief The macro argument expansions coalesced into the source location
+  /// entries, as (begin, offset, expansion location) triples.
+  SmallVector<uint64_t, 4> CoalescedMacroArgExpansions;
+
   /// \brief Remapping table for source locations in this module.
   ContinuousRangeMap<uint32_t, int, 2> SLocRemap;
 
@@ -414,6 +426,10 @@ public:
   /// module.
   SmallVector<uint64_t, 1> ObjCCategories;
 
+  /// \brief The layouts of the records that were laid out while building
+  /// this module file.
+  SmallVector<uint64_t, 1> RecordLayouts;
+
   // === Types ===
 
   /// \brief The number of types in this AST file.
@@ -17,6 +17,7 @@
 
 #include "clang/Basic/FileManager.h"
 #include "clang/Serialization/Module.h"
+#include "clang/Serialization/SharedModuleCache.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallPtrSet.h"
 
@@ -107,6 +108,17 @@ class ModuleManager {
   /// \brief The first visit() state in the chain.
   VisitState *FirstVisitState;
 
+  /// \brief The contents of AST files shared with other compiles, if any.
+  IntrusiveRefCntPtr<SharedModuleCache> SharedCache;
+
+  /// \brief The number of AST files whose contents are mapped from disk, of
+  /// those whose contents were read or copied into memory, and of those
+  /// whose contents came from the shared module cache.
+  unsigned NumMappedFiles, NumCopiedFiles, NumSharedCacheFiles;
+
+  /// \brief The total size of the AST files read or copied into memory.
+  uint64_t NumCopiedFileBytes;
+
   VisitState *allocateVisitState();
   void returnVisitState(VisitState *State);
 
@@ -163,6 +175,24 @@ public:
   /// \brief Number of modules loaded
   unsigned size() const { return Chain.size(); }
 
+  /// \brief Number of AST files loaded whose contents are mapped from disk.
+  unsigned getNumMappedFiles() const { return NumMappedFiles; }
+
+  /// \brief Number of AST files loaded whose contents had to be read or
+  /// copied into memory, and their total size in bytes.
+  unsigned getNumCopiedFiles() const { return NumCopiedFiles; }
+  uint64_t getNumCopiedFileBytes() const { return NumCopiedFileBytes; }
+
+  /// \brief Number of AST files loaded whose contents came from the shared
+  /// module cache.
+  unsigned getNumSharedCacheFiles() const { return NumSharedCacheFiles; }
+
+  /// \brief Share the contents of the AST files this manager loads with
+  /// other compiles through \p Cache.
+  void setSharedModuleCache(IntrusiveRefCntPtr<SharedModuleCache> Cache) {
+    SharedCache = std::move(Cache);
+  }
+
   /// \brief The result of attempting to add a new module.
   enum AddModuleResult {
     /// \brief The module file had already been loaded.
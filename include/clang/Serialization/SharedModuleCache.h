@@ -0,0 +1,92 @@
+//===--- SharedModuleCache.h - AST files shared by compiles -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file defines the SharedModuleCache class, which keeps the contents of
+//  AST files in memory across the compiles run by one process.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SERIALIZATION_SHAREDMODULECACHE_H
+#define LLVM_CLANG_SERIALIZATION_SHAREDMODULECACHE_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <mutex>
+
+namespace clang {
+
+class FileEntry;
+
+namespace serialization {
+
+/// \brief The contents of AST files, shared by every compile a long-lived
+/// process runs so that modules imported again and again are read once.
+///
+/// Entries are keyed by file name. Each time one is looked up, its contents
+/// are compared with those of the file on disk, which are mapped rather than
+/// read; a module file rewritten within the same second with the same size is
+/// not mistaken for the one cached. The module manager still validates the
+/// signature of every module it loads from them.
+///
+/// The cache holds at most MaxSize bytes, evicting the least recently used
+/// contents first. The views it hands out share ownership of the contents, so
+/// an evicted or replaced entry stays alive until the modules loaded from it
+/// are gone.
+///
+/// The cache may be used by several threads at once.
+class SharedModuleCache
+    : public llvm::ThreadSafeRefCountedBase<SharedModuleCache> {
+  struct Entry {
+    std::shared_ptr<llvm::MemoryBuffer> Buffer;
+    uint64_t LastUse;
+  };
+
+  std::mutex Mutex;
+  llvm::StringMap<Entry> Entries;
+  uint64_t MaxSize;
+  uint64_t Size = 0;
+  uint64_t UseCount = 0;
+
+  unsigned NumHits = 0;
+  unsigned NumMisses = 0;
+
+  /// \brief Evicts least recently used entries until the cache holds no more
+  /// than MaxSize bytes. The caller holds Mutex.
+  void evict();
+
+public:
+  /// \brief The default bound on the size of the cached contents.
+  static const uint64_t DefaultMaxSize = 1ULL << 30;
+
+  explicit SharedModuleCache(uint64_t MaxSize = DefaultMaxSize)
+      : MaxSize(MaxSize) {}
+
+  /// \brief Returns a view of the cached contents of \p File, or null if the
+  /// cache has no contents for it or they differ from those on disk.
+  std::unique_ptr<llvm::MemoryBuffer> lookup(const FileEntry *File);
+
+  /// \brief Takes \p Buffer as the contents of \p File and returns a view of
+  /// it to use in its place.
+  std::unique_ptr<llvm::MemoryBuffer>
+  insert(const FileEntry *File, std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  /// \brief The number of lookups that found up-to-date contents.
+  unsigned getNumHits();
+
+  /// \brief The number of lookups that didn't.
+  unsigned getNumMisses();
+};
+
+} // end namespace serialization
+} // end namespace clang
+
+#endif
@@ -121,6 +121,25 @@ enum IPAKind {
   IPAK_DynamicDispatchBifurcate = 5
 };
 
+/// \brief Describes the order in which the CoreEngine explores the nodes of
+/// the exploded graph.
+enum ExplorationStrategyKind {
+  ESK_NotSet = 0,
+
+  /// Explore the most recently reached node first.
+  ESK_DFS = 1,
+
+  /// Explore the least recently reached node first.
+  ESK_BFS = 2,
+
+  /// Explore the blocks breadth-first, and each block depth-first.
+  ESK_BFSBlockDFSContents = 3,
+
+  /// Explore first the nodes entering a block that no other path has reached
+  /// yet in the same stack frame, and the others depth-first.
+  ESK_UnexploredFirst = 4
+};
+
 class AnalyzerOptions : public RefCountedBase<AnalyzerOptions> {
 public:
   typedef llvm::StringMap<std::string> ConfigTable;
@@ -198,6 +217,9 @@ private:
   /// Controls the mode of inter-procedural analysis.
   IPAKind IPAMode;
 
+  /// \sa getExplorationStrategy
+  ExplorationStrategyKind ExplorationStrategy;
+
   /// Controls which C++ member functions will be considered for inlining.
   CXXInlineableMemberKind CXXMemberInliningMode;
   
@@ -250,9 +272,24 @@ private:
   /// \sa getGraphTrimInterval
   Optional<unsigned> GraphTrimInterval;
 
+  /// \sa shouldReclaimNodesAggressively
+  Optional<bool> AggressiveGraphReclamation;
+
+  /// \sa getPurgeInterval
+  Optional<unsigned> PurgeInterval;
+
+  /// \sa getMaxMemoryPerTopLevelFunction
+  Optional<unsigned> MaxMemoryPerTopLevelFunction;
+
+  /// \sa getMaxReportsPerBugClass
+  Optional<unsigned> MaxReportsPerBugClass;
+
   /// \sa getMaxTimesInlineLarge
   Optional<unsigned> MaxTimesInlineLarge;
 
+  /// \sa getMaxCachedDeclContexts
+  Optional<unsigned> MaxCachedDeclContexts;
+
   /// \sa getMinCFGSizeTreatFunctionsAsLarge
   Optional<unsigned> MinCFGSizeTreatFunctionsAsLarge;
 
@@ -265,6 +302,12 @@ private:
   /// \sa shouldWidenLoops
   Optional<bool> WidenLoops;
 
+  /// \sa getAnalysisShardCount
+  Optional<unsigned> AnalysisShardCount;
+
+  /// \sa getAnalysisShardIndex
+  Optional<unsigned> AnalysisShardIndex;
+
   /// A helper function that retrieves option for a given full-qualified
   /// checker name.
   /// Options for checkers can be specified via 'analyzer-config' command-line
@@ -370,6 +413,12 @@ public:
   /// \brief Returns the inter-procedural analysis mode.
   IPAKind getIPAMode();
 
+  /// \brief Returns the order in which the exploded graph is explored.
+  ///
+  /// This is controlled by the 'exploration_strategy' config option, one of
+  /// "dfs", "bfs", "bfs_block_dfs_contents" and "unexplored_first".
+  ExplorationStrategyKind getExplorationStrategy();
+
   /// Returns the option controlling which C++ member functions will be
   /// considered for inlining.
   ///
@@ -506,11 +555,52 @@ public:
   /// node reclamation, set the option to "0".
   unsigned getGraphTrimInterval();
 
+  /// Returns how many statements may be evaluated along a path within a basic
+  /// block before dead symbols and bindings must be purged again.
+  ///
+  /// Purging walks the whole store and environment, so doing it before every
+  /// statement dominates the analysis of long functions. Purges still happen
+  /// at block entrances and before calls, and before every statement while a
+  /// checker asks for exact dead symbols (check::ExactDeadSymbols).
+  ///
+  /// This is controlled by the 'purge-interval' config option. The default
+  /// of "1" purges before every statement whose value is not consumed.
+  unsigned getPurgeInterval();
+
+  /// Returns true if node reclamation should also collapse the paths that
+  /// can only end in a sink no bug report was emitted for. Such paths never
+  /// appear in a diagnostic, so any statement node on them can be recycled,
+  /// not only the ones that are never consulted by checkers.
+  ///
+  /// This is controlled by the 'aggressive-graph-reclamation' config option.
+  bool shouldReclaimNodesAggressively();
+
+  /// Returns the memory, in megabytes, that the analyzer may allocate for
+  /// the exploded graph of a top level function before it stops exploring
+  /// it, keeping the reports found so far. 0 means no limit.
+  ///
+  /// This is controlled by the 'max-memory-mb' config option.
+  unsigned getMaxMemoryPerTopLevelFunction();
+
+  /// Returns the maximum number of reports of a single equivalence class
+  /// that are examined when picking the one to emit. 0 means no limit.
+  ///
+  /// This is controlled by the 'max-reports-per-bug-class' config option.
+  unsigned getMaxReportsPerBugClass();
+
   /// Returns the maximum times a large function could be inlined.
   ///
   /// This is controlled by the 'max-times-inline-large' config option.
   unsigned getMaxTimesInlineLarge();
 
+  /// Returns the number of function contexts (CFGs and the analyses built on
+  /// them) kept between top-level functions for the functions that may be
+  /// inlined again. Contexts of functions no caller still to be analyzed can
+  /// inline are released regardless.
+  ///
+  /// This is controlled by the 'max-cached-decl-contexts' config option.
+  unsigned getMaxCachedDeclContexts();
+
   /// Returns the number of basic blocks a function needs to have to be
   /// considered large for the 'max-times-inline-large' config option.
   ///
@@ -533,6 +623,57 @@ public:
   /// This is controlled by the 'widen-loops' config option.
   bool shouldWidenLoops();
 
+  /// Returns the number of shards the top-level functions of the translation
+  /// unit are split into. Each analyzer invocation only analyzes the functions
+  /// of its own shard, so that one large translation unit can be analyzed by
+  /// several processes at once.
+  ///
+  /// This is controlled by the 'shard-count' config option.
+  unsigned getAnalysisShardCount();
+
+  /// Returns the shard analyzed by this invocation, between 0 and
+  /// 'shard-count' - 1. Only shard 0 runs the AST-based and translation-unit
+  /// checks, and, when inlining is disabled, all of the path-sensitive ones.
+  ///
+  /// This is controlled by the 'shard-index' config option.
+  unsigned getAnalysisShardIndex();
+
+  /// Returns the file from which the function summaries written by earlier
+  /// runs are read, or an empty string. Calls that are not inlined use the
+  /// summary of their callee, when there is one, instead of invalidating
+  /// everything the callee might have written.
+  ///
+  /// This is controlled by the 'function-summaries-input' config option.
+  StringRef getFunctionSummariesInput();
+
+  /// Returns the file to which the summaries of the functions defined in the
+  /// translation unit are written, together with the ones already read, or
+  /// an empty string.
+  ///
+  /// This is controlled by the 'function-summaries-output' config option.
+  StringRef getFunctionSummariesOutput();
+
+  /// Returns the file in which the reports of each top-level function are
+  /// kept between runs, or an empty string. The functions that did not change
+  /// since the run that wrote it, together with everything they call, are not
+  /// analyzed again; their reports are emitted from the file instead.
+  ///
+  /// This is controlled by the 'incremental-analysis-state' config option.
+  StringRef getIncrementalAnalysisState();
+
+  /// Returns the file to which the time spent analyzing each function and in
+  /// each checker callback, and the number of nodes of each function, are
+  /// written, or an empty string.
+  ///
+  /// This is controlled by the 'profile-output' config option.
+  StringRef getProfileOutput();
+
+  /// Returns the format of the profile: "json" for a summary, or
+  /// "chrome-trace" for the trace event format of chrome://tracing.
+  ///
+  /// This is controlled by the 'profile-format' config option.
+  StringRef getProfileFormat();
+
 public:
   AnalyzerOptions() :
     AnalysisStoreOpt(RegionStoreModel),
@@ -556,6 +697,7 @@ public:
     InliningMode(NoRedundancy),
     UserMode(UMK_NotSet),
     IPAMode(IPAK_NotSet),
+    ExplorationStrategy(ESK_NotSet),
     CXXMemberInliningMode() {}
 
 };
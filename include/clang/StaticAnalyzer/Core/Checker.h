@@ -313,6 +313,21 @@ public:
   }
 };
 
+class ExactDeadSymbols {
+  template <typename CHECKER>
+  static bool _wantsExactDeadSymbols(void *checker, ProgramStateRef state) {
+    return ((const CHECKER *)checker)->wantsExactDeadSymbols(state);
+  }
+
+public:
+  template <typename CHECKER>
+  static void _register(CHECKER *checker, CheckerManager &mgr) {
+    mgr._registerForExactDeadSymbols(
+        CheckerManager::WantsExactDeadSymbolsFunc(
+            checker, _wantsExactDeadSymbols<CHECKER>));
+  }
+};
+
 class RegionChanges {
   template <typename CHECKER>
   static ProgramStateRef 
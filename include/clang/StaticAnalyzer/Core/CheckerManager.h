@@ -105,6 +105,22 @@ class CheckerManager {
   AnalyzerOptionsRef AOptions;
   CheckName CurrentCheckName;
 
+public:
+  /// \brief The time spent in one kind of callback of a checker.
+  struct CallbackProfile {
+    double Seconds = 0;
+    uint64_t Calls = 0;
+  };
+
+  /// The profile of each callback, keyed by the checker and the name of
+  /// the callback, which is a string literal.
+  typedef llvm::DenseMap<std::pair<const CheckerBase *, const char *>,
+                         CallbackProfile> CallbackProfileMap;
+
+private:
+  bool Profiling = false;
+  CallbackProfileMap Profiles;
+
 public:
   CheckerManager(const LangOptions &langOpts, AnalyzerOptionsRef AOptions)
       : LangOpts(langOpts), AOptions(std::move(AOptions)) {}
@@ -118,6 +134,19 @@ public:
 
   void finishedCheckerRegistration();
 
+  /// \brief Starts measuring the time spent in each checker callback.
+  void enableProfiling() { Profiling = true; }
+  bool isProfiling() const { return Profiling; }
+
+  /// \brief Returns the profile of the callback \p Callback of \p Checker,
+  /// to which the callers of the callback add their measurements.
+  CallbackProfile &getCallbackProfile(const CheckerBase *Checker,
+                                      const char *Callback) {
+    return Profiles[std::make_pair(Checker, Callback)];
+  }
+
+  const CallbackProfileMap &getCallbackProfiles() const { return Profiles; }
+
   const LangOptions &getLangOpts() const { return LangOpts; }
   AnalyzerOptions &getAnalyzerOptions() { return *AOptions; }
 
@@ -322,6 +351,14 @@ public:
                                  ExprEngine &Eng,
                                  ProgramPoint::Kind K);
 
+  /// \brief True if at least one checker needs dead symbols of the given
+  /// state to be reported at the statement at which they die.
+  ///
+  /// This corresponds to the check::ExactDeadSymbols callback. When no
+  /// checker asks for it, the analyzer may batch dead symbol collection
+  /// (see the 'purge-interval' analyzer option).
+  bool wantsExactDeadSymbols(ProgramStateRef state);
+
   /// \brief True if at least one checker wants to check region changes.
   bool wantsRegionChangeUpdate(ProgramStateRef state);
 
@@ -444,6 +481,8 @@ public:
       CheckDeadSymbolsFunc;
   
   typedef CheckerFn<void (ProgramStateRef,SymbolReaper &)> CheckLiveSymbolsFunc;
+
+  typedef CheckerFn<bool (ProgramStateRef)> WantsExactDeadSymbolsFunc;
   
   typedef CheckerFn<ProgramStateRef (ProgramStateRef,
                                 const InvalidatedSymbols *symbols,
@@ -501,6 +540,8 @@ public:
 
   void _registerForDeadSymbols(CheckDeadSymbolsFunc checkfn);
 
+  void _registerForExactDeadSymbols(WantsExactDeadSymbolsFunc checkfn);
+
   void _registerForRegionChanges(CheckRegionChangesFunc checkfn,
                                  WantsRegionChangeUpdateFunc wantUpdateFn);
 
@@ -611,6 +652,8 @@ private:
 
   std::vector<CheckDeadSymbolsFunc> DeadSymbolsCheckers;
 
+  std::vector<WantsExactDeadSymbolsFunc> ExactDeadSymbolsCheckers;
+
   struct RegionChangesCheckerInfo {
     CheckRegionChangesFunc CheckFn;
     WantsRegionChangeUpdateFunc WantUpdateFn;
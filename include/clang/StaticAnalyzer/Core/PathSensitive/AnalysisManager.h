@@ -19,6 +19,7 @@
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/BugReporter.h"
 #include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/PersistentFunctionSummaries.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
 
 namespace clang {
@@ -43,6 +44,8 @@ class AnalysisManager : public BugReporterData {
 
   CheckerManager *CheckerMgr;
 
+  PersistentFunctionSummaries PersistentSummaries;
+
 public:
   AnalyzerOptions &options;
   
@@ -60,6 +63,13 @@ public:
   void ClearContexts() {
     AnaCtxMgr.clear();
   }
+
+  /// Release the contexts of the functions analyzed so far, but for those
+  /// that may still be inlined; see
+  /// AnalysisDeclContextManager::releaseContexts.
+  void releaseContexts(llvm::function_ref<bool(const Decl *)> IsFinished) {
+    AnaCtxMgr.releaseContexts(IsFinished, options.getMaxCachedDeclContexts());
+  }
   
   AnalysisDeclContextManager& getAnalysisDeclContextManager() {
     return AnaCtxMgr;
@@ -79,6 +89,10 @@ public:
 
   CheckerManager *getCheckerManager() const { return CheckerMgr; }
 
+  PersistentFunctionSummaries &getPersistentSummaries() {
+    return PersistentSummaries;
+  }
+
   ASTContext &getASTContext() override {
     return Ctx;
   }
@@ -89,8 +89,11 @@ public:
     Profile(ID, this);
   }
 
+  /// The factory canonicalizes the bindings, so two environments are equal
+  /// exactly when they share the same tree, and there is no need to walk it.
   bool operator==(const Environment& RHS) const {
-    return ExprBindings == RHS.ExprBindings;
+    return ExprBindings.getRootWithoutRetain() ==
+           RHS.ExprBindings.getRootWithoutRetain();
   }
   
   void print(raw_ostream &Out, const char *NL, const char *Sep) const;
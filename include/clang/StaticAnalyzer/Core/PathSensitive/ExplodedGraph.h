@@ -270,6 +270,9 @@ protected:
 
   /// NumNodes - The number of nodes in the graph.
   unsigned NumNodes;
+
+  /// The number of nodes created, including the ones reclaimed since.
+  unsigned NumCreatedNodes;
   
   /// A list of recently allocated nodes that can potentially be recycled.
   NodeVector ChangedNodes;
@@ -285,6 +288,13 @@ protected:
   /// Counter to determine when to reclaim nodes.
   unsigned ReclaimCounter;
 
+  /// Whether reclamation also collapses the paths leading only to sinks that
+  /// are not error nodes.
+  bool AggressiveReclamation;
+
+  /// The nodes bug reports were emitted for.
+  llvm::SmallPtrSet<const ExplodedNode *, 16> ErrorNodes;
+
 public:
 
   /// \brief Retrieve the node associated with a (Location,State) pair,
@@ -328,6 +338,7 @@ public:
 
   bool empty() const { return NumNodes == 0; }
   unsigned size() const { return NumNodes; }
+  unsigned getNumCreatedNodes() const { return NumCreatedNodes; }
 
   void reserve(unsigned NodeCount) { Nodes.reserve(NodeCount); }
 
@@ -387,14 +398,25 @@ public:
 
   /// Enable tracking of recently allocated nodes for potential reclamation
   /// when calling reclaimRecentlyAllocatedNodes().
-  void enableNodeReclamation(unsigned Interval) {
+  ///
+  /// If \p Aggressive is true, the paths that can only end in sinks that are
+  /// not error nodes are collapsed as well.
+  void enableNodeReclamation(unsigned Interval, bool Aggressive = false) {
     ReclaimCounter = ReclaimNodeInterval = Interval;
+    AggressiveReclamation = Aggressive;
   }
 
   /// Reclaim "uninteresting" nodes created since the last time this method
   /// was called.
   void reclaimRecentlyAllocatedNodes();
 
+  /// Records that a bug report was emitted for \p N, so that the path
+  /// leading to it is never collapsed.
+  void addErrorNode(const ExplodedNode *N) {
+    if (AggressiveReclamation)
+      ErrorNodes.insert(N);
+  }
+
   /// \brief Returns true if nodes for the given expression kind are always
   ///        kept around.
   static bool isInterestingLValueExpr(const Expr *Ex);
@@ -402,6 +424,7 @@ public:
 private:
   bool shouldCollect(const ExplodedNode *node);
   void collectNode(ExplodedNode *node);
+  void collapsePathToSink(ExplodedNode *Sink);
 };
 
 class ExplodedNodeSet {
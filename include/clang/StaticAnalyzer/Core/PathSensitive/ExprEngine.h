@@ -96,6 +96,10 @@ private:
   /// The flag, which specifies the mode of inlining for the engine.
   InliningModes HowToInline;
 
+  /// The number of statements that may be evaluated within a basic block
+  /// between two purges of dead symbols. \sa AnalyzerOptions::getPurgeInterval
+  unsigned PurgeInterval;
+
 public:
   ExprEngine(AnalysisManager &mgr, bool gcEnabled,
              SetOfConstDecls *VisitedCalleesIn,
@@ -384,6 +388,11 @@ public:
   void VisitInitListExpr(const InitListExpr *E, ExplodedNode *Pred,
                          ExplodedNodeSet &Dst);
 
+  /// VisitPackedArrayInitExpr - Transfer function logic for array
+  /// initializers whose element values are packed.
+  void VisitPackedArrayInitExpr(const PackedArrayInitExpr *E,
+                                ExplodedNode *Pred, ExplodedNodeSet &Dst);
+
   /// VisitLogicalExpr - Transfer function logic for '&&', '||'
   void VisitLogicalExpr(const BinaryOperator* B, ExplodedNode *Pred,
                         ExplodedNodeSet &Dst);
@@ -1344,6 +1344,9 @@ public:
   void setTrait(const MemRegion *MR, InvalidationKinds IK);
   bool hasTrait(SymbolRef Sym, InvalidationKinds IK) const;
   bool hasTrait(const MemRegion *MR, InvalidationKinds IK) const;
+
+  /// Returns true if any region has been given the trait \p IK.
+  bool hasRegionWithTrait(InvalidationKinds IK) const;
 };
   
 } // end GR namespace
@@ -0,0 +1,114 @@
+//== PersistentFunctionSummaries.h - Summaries shared across TUs -*- C++ -*--//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines PersistentFunctionSummaries, the summaries of the effects
+// of functions that one analyzer run writes to a file and later runs, on the
+// same or other translation units, read back.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PERSISTENTFUNCTIONSUMMARIES_H
+#define LLVM_CLANG_STATICANALYZER_CORE_PATHSENSITIVE_PERSISTENTFUNCTIONSUMMARIES_H
+
+#include "clang/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSet.h"
+#include <list>
+#include <string>
+
+namespace clang {
+
+class ASTContext;
+class DeclContext;
+class FunctionDecl;
+class Stmt;
+
+namespace ento {
+
+/// \brief The effects of a function that matter to its callers.
+struct PersistentFunctionSummary {
+  /// The MD5 digest of the pretty-printed definition the summary was computed
+  /// from.
+  std::string BodyHash;
+
+  /// Whether the function writes no memory that its callers can see, so that
+  /// a call to it does not invalidate anything.
+  bool HasNoSideEffects = false;
+
+  /// Whether every return statement returns a constant between ReturnMin and
+  /// ReturnMax.
+  bool HasReturnRange = false;
+  int64_t ReturnMin = 0;
+  int64_t ReturnMax = 0;
+};
+
+/// \brief Summaries of the functions with external linkage, keyed by a name
+/// that is the same in every translation unit.
+///
+/// The summary of a function defined in the current translation unit is
+/// computed from its definition, and replaces any summary that was read for
+/// it, so that a summary computed from an older body is never used. A
+/// function defined elsewhere whose summaries were read with different body
+/// hashes has no summary at all, as it is unknown which one is current.
+class PersistentFunctionSummaries {
+  ASTContext &Ctx;
+  llvm::StringMap<PersistentFunctionSummary> Summaries;
+
+  /// The keys of the functions defined in this translation unit, whose
+  /// summaries replace the stored ones when writing.
+  llvm::StringSet<> DefinedKeys;
+
+  /// The keys that were read with different body hashes.
+  llvm::StringSet<> ConflictingKeys;
+
+  /// The summaries of the functions without a summary key.
+  std::list<PersistentFunctionSummary> InternalSummaries;
+
+  /// The summaries of the definitions in this translation unit, computed
+  /// when first needed. Functions being summarized map to null.
+  llvm::DenseMap<const FunctionDecl *, const PersistentFunctionSummary *>
+      Computed;
+
+  const PersistentFunctionSummary *summarizeDefinition(const FunctionDecl *FD);
+  bool hasNoSideEffects(const FunctionDecl *Callee);
+  bool mayHaveSideEffects(const Stmt *S);
+
+public:
+  explicit PersistentFunctionSummaries(ASTContext &Ctx) : Ctx(Ctx) {}
+
+  /// \brief Returns the name under which the summary of \p FD is stored, or
+  /// an empty string if \p FD cannot be summarized.
+  static std::string getSummaryKey(const FunctionDecl *FD);
+
+  /// \brief Returns the summary of \p FD, or null if there is none.
+  const PersistentFunctionSummary *lookup(const FunctionDecl *FD);
+
+  /// \brief Computes the summaries of the definitions in \p DC and its
+  /// nested contexts.
+  void summarizeDefinitions(const DeclContext *DC);
+
+  /// \brief Adds the summaries stored in \p Path, without replacing the ones
+  /// already known. Returns false if the file could not be read.
+  bool readFromFile(StringRef Path);
+
+  /// \brief Merges the known summaries into the ones stored in \p Path,
+  /// replacing those of the functions defined in this translation unit.
+  ///
+  /// The file is locked while it is merged, so that analyzer runs writing to
+  /// the same file concurrently do not lose each other's summaries. Returns
+  /// false on failure.
+  bool mergeIntoFile(StringRef Path) const;
+};
+
+} // end ento namespace
+
+} // end clang namespace
+
+#endif
@@ -33,8 +33,12 @@ typedef std::vector<std::string> CommandLineArguments;
 ///
 /// Command line argument adjuster is responsible for command line arguments
 /// modification before the arguments are used to run a frontend action.
+///
+/// The arguments are passed by value, so that an adjuster can change them in
+/// place and return them; a chain of adjusters that is given its arguments
+/// with std::move does not copy them.
 typedef std::function<CommandLineArguments(
-    const CommandLineArguments &, StringRef Filename)> ArgumentsAdjuster;
+    CommandLineArguments, StringRef Filename)> ArgumentsAdjuster;
 
 /// \brief Gets an argument adjuster that converts input command line arguments
 /// to the "syntax check only" variant.
@@ -174,6 +174,24 @@ bool applyAllReplacements(const std::vector<Replacement> &Replaces,
 llvm::Expected<std::string> applyAllReplacements(StringRef Code,
                                                  const Replacements &Replaces);
 
+/// \brief Applies all replacements in \p Replaces to the files they refer to,
+/// and overwrites the files that change, on up to \p ThreadCount threads (one
+/// per core if it is 0).
+///
+/// Each file is read, rewritten and written on its own, without a
+/// SourceManager, and replacements that do not overlap are spliced in with a
+/// single copy of the file. Paths that name the same file are applied
+/// together. Files are overwritten atomically. Errors are written to
+/// \c llvm::errs().
+///
+/// Replacement applications happen independently of the success of
+/// other applications. \p AllApplied is set to whether all replacements
+/// apply.
+///
+/// \returns true if all changed files were written. false otherwise.
+bool applyAllReplacementsToFiles(const Replacements &Replaces,
+                                 bool &AllApplied, unsigned ThreadCount = 0);
+
 /// \brief Calculates how a code \p Position is shifted when \p Replaces are
 /// applied.
 unsigned shiftedCodePosition(const Replacements& Replaces, unsigned Position);
@@ -16,8 +16,11 @@
 #define LLVM_CLANG_TOOLING_FILEMATCHTRIE_H
 
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -54,6 +57,10 @@ class FileMatchTrieNode;
 /// 0  equivalent files: Continue with the next suffix length.
 /// 1  equivalent file:  Best match found, return it.
 /// >1 equivalent files: Match is ambiguous, return error.
+///
+/// A file that is in the trie is found without walking it, and the match of
+/// each file is remembered until the next insert, so that repeated queries
+/// for the same files, as IDEs make, do not compare paths again.
 class FileMatchTrie {
 public:
   FileMatchTrie();
@@ -80,6 +87,13 @@ public:
 private:
   FileMatchTrieNode *Root;
   std::unique_ptr<PathComparator> Comparator;
+
+  /// \brief The paths in the trie.
+  llvm::StringSet<> Paths;
+
+  /// \brief The match found for each file looked up since the last insert.
+  mutable llvm::StringMap<StringRef> Matches;
+  mutable std::mutex MatchesMutex;
 };
 
 
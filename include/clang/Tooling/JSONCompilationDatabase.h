@@ -21,8 +21,6 @@
 #include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/MemoryBuffer.h"
-#include "llvm/Support/SourceMgr.h"
-#include "llvm/Support/YAMLParser.h"
 #include <memory>
 #include <string>
 #include <vector>
@@ -55,14 +53,23 @@ namespace tooling {
 ///
 /// JSON compilation databases can for example be generated in CMake projects
 /// by setting the flag -DCMAKE_EXPORT_COMPILE_COMMANDS.
+///
+/// Loading a database only scans it for the file of each object, and the
+/// command lines are parsed when they are asked for, so that tools that look
+/// at a few files of a large database do not pay for all of them.
 class JSONCompilationDatabase : public CompilationDatabase {
 public:
   /// \brief Loads a JSON compilation database from the specified file.
   ///
+  /// If \p UseIndexCache is true, the index of the files of the database is
+  /// saved to, and later loaded from, \c <FilePath>.index, which is used for
+  /// as long as the size and modification time of the database are unchanged.
+  ///
   /// Returns NULL and sets ErrorMessage if the database could not be
   /// loaded from the given file.
   static std::unique_ptr<JSONCompilationDatabase>
-  loadFromFile(StringRef FilePath, std::string &ErrorMessage);
+  loadFromFile(StringRef FilePath, std::string &ErrorMessage,
+               bool UseIndexCache = false);
 
   /// \brief Loads a JSON compilation database from a data buffer.
   ///
@@ -90,8 +97,7 @@ public:
 private:
   /// \brief Constructs a JSON compilation database on a memory buffer.
   JSONCompilationDatabase(std::unique_ptr<llvm::MemoryBuffer> Database)
-      : Database(std::move(Database)),
-        YAMLStream(this->Database->getBuffer(), SM) {}
+      : Database(std::move(Database)) {}
 
   /// \brief Parses the database file and creates the index.
   ///
@@ -99,15 +105,20 @@ private:
   /// failed.
   bool parse(std::string &ErrorMessage);
 
-  // Tuple (directory, filename, commandline) where 'commandline' points to the
-  // corresponding scalar nodes in the YAML stream.
-  // If the command line contains a single argument, it is a shell-escaped
-  // command line.
-  // Otherwise, each entry in the command line vector is a literal
-  // argument to the compiler.
-  typedef std::tuple<llvm::yaml::ScalarNode *,
-                     llvm::yaml::ScalarNode *,
-                    std::vector<llvm::yaml::ScalarNode *>> CompileCommandRef;
+  /// \brief Creates the index from the index cache at \p IndexPath, if it
+  /// was written for a database of \p Size bytes modified at \p ModTime.
+  bool readIndexCache(StringRef IndexPath, uint64_t Size, uint64_t ModTime);
+
+  /// \brief Writes the index to the index cache at \p IndexPath.
+  void writeIndexCache(StringRef IndexPath, uint64_t Size,
+                       uint64_t ModTime) const;
+
+  /// \brief Adds the command at \p Offset for the file \p NativeFilePath to
+  /// the index.
+  void addCommand(StringRef NativeFilePath, uint64_t Offset);
+
+  // The offset of the JSON object of a compile command in the database.
+  typedef uint64_t CompileCommandRef;
 
   /// \brief Converts the given array of CompileCommandRefs to CompileCommands.
   void getCommands(ArrayRef<CompileCommandRef> CommandsRef,
@@ -123,8 +134,6 @@ private:
   FileMatchTrie MatchTrie;
 
   std::unique_ptr<llvm::MemoryBuffer> Database;
-  llvm::SourceMgr SM;
-  llvm::yaml::Stream YAMLStream;
 };
 
 } // end namespace tooling
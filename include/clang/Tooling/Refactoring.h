@@ -21,6 +21,7 @@
 
 #include "clang/Tooling/Core/Replacement.h"
 #include "clang/Tooling/Tooling.h"
+#include <mutex>
 #include <string>
 
 namespace clang {
@@ -33,7 +34,8 @@ namespace tooling {
 ///
 /// This is a refactoring specific version of \see ClangTool. FrontendActions
 /// passed to run() and runAndSave() should add replacements to
-/// getReplacements().
+/// getReplacements(), or through addReplacements() when the tool runs on
+/// several threads.
 class RefactoringTool : public ClangTool {
 public:
   /// \see ClangTool::ClangTool.
@@ -44,8 +46,18 @@ public:
 
   /// \brief Returns the set of replacements to which replacements should
   /// be added during the run of the tool.
+  ///
+  /// The set is not synchronized; actions of a run on several threads
+  /// (\see ClangTool::setThreadCount) must use addReplacements() instead.
   Replacements &getReplacements();
 
+  /// \brief Adds \p Replaces to the set returned by getReplacements().
+  ///
+  /// This can be called from several threads at once. Replacements is an
+  /// ordered set, so the result does not depend on which thread ran which
+  /// translation unit.
+  void addReplacements(const Replacements &Replaces);
+
   /// \brief Call run(), apply all generated replacements, and immediately save
   /// the results to disk.
   ///
@@ -60,12 +72,9 @@ public:
   /// \returns true if all replacements apply. false otherwise.
   bool applyAllReplacements(Rewriter &Rewrite);
 
-private:
-  /// \brief Write all refactored files to disk.
-  int saveRewrittenFiles(Rewriter &Rewrite);
-
 private:
   Replacements Replace;
+  std::mutex ReplaceMutex;
 };
 
 /// \brief Groups \p Replaces by the file path and applies each group of
@@ -318,6 +318,20 @@ class ClangTool {
   /// \brief Clear the command line arguments adjuster chain.
   void clearArgumentsAdjusters();
 
+  /// \brief Run the compile commands on \p ThreadCount threads rather than
+  /// one after the other.
+  ///
+  /// The process' working directory is left alone: each thread keeps a
+  /// FileManager per compile command directory that resolves relative paths
+  /// against it, and passes it to the driver with -working-directory.  The
+  /// threads share the results of stat calls of absolute paths.  The action
+  /// and the diagnostic consumer are used from all threads at once, so they
+  /// must be thread-safe; a FrontendActionFactory that only creates actions
+  /// is.  All compile commands are looked up before the first one runs.
+  void setThreadCount(unsigned ThreadCount) {
+    this->ThreadCount = ThreadCount;
+  }
+
   /// Runs an action over all files specified in the command line.
   ///
   /// \param Action Tool action.
@@ -325,14 +339,27 @@ class ClangTool {
 
   /// \brief Create an AST for each file specified in the command line and
   /// append them to ASTs.
+  ///
+  /// With several threads, the ASTs are appended in the order they finish.
   int buildASTs(std::vector<std::unique_ptr<ASTUnit>> &ASTs);
 
   /// \brief Returns the file manager used in the tool.
   ///
-  /// The file manager is shared between all translation units.
+  /// The file manager is shared between all translation units that run on
+  /// the calling thread.
   FileManager &getFiles() { return *Files; }
 
  private:
+  /// \brief Runs \p Action on one compile command of \p File, on the given
+  /// file system and file manager.
+  bool runCommand(ToolAction *Action, StringRef File, CompileCommand Command,
+                  vfs::OverlayFileSystem &OverlayFS,
+                  vfs::InMemoryFileSystem &InMemoryFS, FileManager &Files,
+                  llvm::StringSet<> &SeenWorkingDirectories,
+                  StringRef InitialDirectory);
+
+  int runInParallel(ToolAction *Action, StringRef InitialDirectory);
+
   const CompilationDatabase &Compilations;
   std::vector<std::string> SourcePaths;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
@@ -347,6 +374,8 @@ class ClangTool {
   ArgumentsAdjuster ArgsAdjuster;
 
   DiagnosticConsumer *DiagConsumer;
+
+  unsigned ThreadCount;
 };
 
 template <typename T>
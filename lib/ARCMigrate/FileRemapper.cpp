@@ -12,6 +12,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Lex/PreprocessorOptions.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -34,6 +35,7 @@ void FileRemapper::clear(StringRef outputDir) {
     resetTarget(I->second);
   FromToMappings.clear();
   assert(ToFromMappings.empty());
+  DiskMappings.clear();
   if (!outputDir.empty()) {
     std::string infoFile = getRemapInfoFile(outputDir);
     llvm::sys::fs::remove(infoFile);
@@ -57,12 +59,24 @@ bool FileRemapper::initFromFile(StringRef filePath, DiagnosticsEngine &Diag,
                                 bool ignoreIfFilesChanged) {
   assert(FromToMappings.empty() &&
          "initFromDisk should be called before any remap calls");
+  FilePairs pairs;
+  if (readMappings(filePath, Diag, ignoreIfFilesChanged, pairs))
+    return true;
+
+  for (unsigned i = 0, e = pairs.size(); i != e; ++i) {
+    remap(pairs[i].first, pairs[i].second);
+    DiskMappings[pairs[i].first] = pairs[i].second;
+  }
+
+  return false;
+}
+
+bool FileRemapper::readMappings(StringRef filePath, DiagnosticsEngine &Diag,
+                                bool ignoreIfFilesChanged, FilePairs &pairs) {
   std::string infoFile = filePath;
   if (!llvm::sys::fs::exists(infoFile))
     return false;
 
-  std::vector<std::pair<const FileEntry *, const FileEntry *> > pairs;
-
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> fileBuf =
       llvm::MemoryBuffer::getFile(infoFile.c_str());
   if (!fileBuf)
@@ -101,9 +115,36 @@ bool FileRemapper::initFromFile(StringRef filePath, DiagnosticsEngine &Diag,
     pairs.push_back(std::make_pair(origFE, newFE));
   }
 
-  for (unsigned i = 0, e = pairs.size(); i != e; ++i)
-    remap(pairs[i].first, pairs[i].second);
+  return false;
+}
+
+bool FileRemapper::mergeFromFile(StringRef filePath, DiagnosticsEngine &Diag) {
+  FilePairs pairs;
+  if (readMappings(filePath, Diag, /*ignoreIfFilesChanged=*/true, pairs))
+    return true;
+
+  for (unsigned i = 0, e = pairs.size(); i != e; ++i) {
+    const FileEntry *origFE = pairs[i].first;
+    const FileEntry *diskFE = pairs[i].second;
+    const FileEntry *lastDiskFE = DiskMappings.lookup(origFE);
+    if (diskFE == lastDiskFE)
+      continue; // Not changed by anyone else.
+
+    MappingsTy::iterator I = FromToMappings.find(origFE);
+    if (I == FromToMappings.end() ||
+        (lastDiskFE && I->second.dyn_cast<const FileEntry *>() == lastDiskFE)) {
+      // Changed only by someone else.
+      remap(origFE, diskFE);
+      continue;
+    }
+    if (I->second.dyn_cast<const FileEntry *>() == diskFE)
+      continue;
 
+    return report(StringRef("File was also migrated by another translation "
+                            "unit, migrate this one again: ") +
+                      origFE->getName(),
+                  Diag);
+  }
   return false;
 }
 
@@ -114,17 +155,40 @@ bool FileRemapper::flushToDisk(StringRef outputDir, DiagnosticsEngine &Diag) {
     return report("Could not create directory: " + outputDir, Diag);
 
   std::string infoFile = getRemapInfoFile(outputDir);
-  return flushToFile(infoFile, Diag);
+  while (true) {
+    llvm::LockFileManager Locked(infoFile);
+    switch (Locked) {
+    case llvm::LockFileManager::LFS_Error:
+      return report("Could not lock " + infoFile + ": " +
+                        Locked.getErrorMessage(),
+                    Diag);
+
+    case llvm::LockFileManager::LFS_Owned:
+      if (mergeFromFile(infoFile, Diag))
+        return true;
+      return flushToFile(infoFile, Diag);
+
+    case llvm::LockFileManager::LFS_Shared:
+      // Another migration is writing the directory; wait for it and merge
+      // what it wrote.
+      if (Locked.waitForUnlock() == llvm::LockFileManager::Res_Timeout)
+        Locked.unsafeRemoveLockFile();
+      continue;
+    }
+  }
 }
 
 bool FileRemapper::flushToFile(StringRef outputPath, DiagnosticsEngine &Diag) {
   using namespace llvm::sys;
 
-  std::error_code EC;
+  // Write to a temporary file and rename it, so that a concurrent
+  // initFromDisk() never sees a partial file.
   std::string infoFile = outputPath;
-  llvm::raw_fd_ostream infoOut(infoFile, EC, llvm::sys::fs::F_None);
-  if (EC)
-    return report(EC.message(), Diag);
+  SmallString<128> tempInfoFile;
+  int infoFD;
+  if (fs::createUniqueFile(infoFile + "-%%%%%%%%", infoFD, tempInfoFile))
+    return report("Could not create file: " + infoFile, Diag);
+  llvm::raw_fd_ostream infoOut(infoFD, /*shouldClose=*/true);
 
   for (MappingsTy::iterator
          I = FromToMappings.begin(), E = FromToMappings.end(); I != E; ++I) {
@@ -145,8 +209,10 @@ bool FileRemapper::flushToFile(StringRef outputPath, DiagnosticsEngine &Diag) {
       int fd;
       if (fs::createTemporaryFile(path::filename(origFE->getName()),
                                   path::extension(origFE->getName()).drop_front(), fd,
-                                  tempPath))
+                                  tempPath)) {
+        fs::remove(tempInfoFile);
         return report("Could not create file: " + tempPath.str(), Diag);
+      }
 
       llvm::raw_fd_ostream newOut(fd, /*shouldClose=*/true);
       llvm::MemoryBuffer *mem = I->second.get<llvm::MemoryBuffer *>();
@@ -160,6 +226,15 @@ bool FileRemapper::flushToFile(StringRef outputPath, DiagnosticsEngine &Diag) {
   }
 
   infoOut.close();
+  if (std::error_code EC = fs::rename(tempInfoFile, infoFile)) {
+    fs::remove(tempInfoFile);
+    return report(EC.message(), Diag);
+  }
+
+  DiskMappings.clear();
+  for (MappingsTy::iterator
+         I = FromToMappings.begin(), E = FromToMappings.end(); I != E; ++I)
+    DiskMappings[I->first] = I->second.get<const FileEntry *>();
   return false;
 }
 
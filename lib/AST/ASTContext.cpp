@@ -170,68 +170,50 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   if (DeclLoc.isInvalid() || !DeclLoc.isFileID())
     return nullptr;
 
-  // Find the comment that occurs just after this declaration.
-  ArrayRef<RawComment *>::iterator Comment;
-  {
-    // When searching for comments during parsing, the comment we are looking
-    // for is usually among the last two comments we parsed -- check them
-    // first.
-    RawComment CommentAtDeclLoc(
-        SourceMgr, SourceRange(DeclLoc), false,
-        LangOpts.CommentOpts.ParseAllComments);
-    BeforeThanCompare<RawComment> Compare(SourceMgr);
-    ArrayRef<RawComment *>::iterator MaybeBeforeDecl = RawComments.end() - 1;
-    bool Found = Compare(*MaybeBeforeDecl, &CommentAtDeclLoc);
-    if (!Found && RawComments.size() >= 2) {
-      MaybeBeforeDecl--;
-      Found = Compare(*MaybeBeforeDecl, &CommentAtDeclLoc);
-    }
-
-    if (Found) {
-      Comment = MaybeBeforeDecl + 1;
-      assert(Comment == std::lower_bound(RawComments.begin(), RawComments.end(),
-                                         &CommentAtDeclLoc, Compare));
-    } else {
-      // Slow path.
-      Comment = std::lower_bound(RawComments.begin(), RawComments.end(),
-                                 &CommentAtDeclLoc, Compare);
-    }
-  }
-
-  // Decompose the location for the declaration and find the beginning of the
-  // file buffer.
+  // Decompose the location for the declaration and find the comments in its
+  // file.  A comment in another file is never attached to it.
   std::pair<FileID, unsigned> DeclLocDecomp = SourceMgr.getDecomposedLoc(DeclLoc);
+  ArrayRef<RawCommentList::CommentInFile> FileComments =
+      Comments.getCommentsInFile(DeclLocDecomp.first);
+
+  // Find the comment that occurs just after this declaration.
+  ArrayRef<RawCommentList::CommentInFile>::iterator Comment =
+      std::lower_bound(FileComments.begin(), FileComments.end(),
+                       RawCommentList::CommentInFile(DeclLocDecomp.second,
+                                                     nullptr),
+                       [](const RawCommentList::CommentInFile &LHS,
+                          const RawCommentList::CommentInFile &RHS) {
+                         return LHS.first < RHS.first;
+                       });
 
   // First check whether we have a trailing comment.
-  if (Comment != RawComments.end() &&
-      (*Comment)->isDocumentation() && (*Comment)->isTrailingComment() &&
+  if (Comment != FileComments.end() &&
+      Comment->second->isDocumentation() &&
+      Comment->second->isTrailingComment() &&
       (isa<FieldDecl>(D) || isa<EnumConstantDecl>(D) || isa<VarDecl>(D) ||
        isa<ObjCMethodDecl>(D) || isa<ObjCPropertyDecl>(D))) {
-    std::pair<FileID, unsigned> CommentBeginDecomp
-      = SourceMgr.getDecomposedLoc((*Comment)->getSourceRange().getBegin());
-    // Check that Doxygen trailing comment comes after the declaration, starts
-    // on the same line and in the same file as the declaration.
-    if (DeclLocDecomp.first == CommentBeginDecomp.first &&
-        SourceMgr.getLineNumber(DeclLocDecomp.first, DeclLocDecomp.second)
-          == SourceMgr.getLineNumber(CommentBeginDecomp.first,
-                                     CommentBeginDecomp.second)) {
-      return *Comment;
+    // Check that Doxygen trailing comment comes after the declaration and
+    // starts on the same line as the declaration.
+    if (SourceMgr.getLineNumber(DeclLocDecomp.first, DeclLocDecomp.second) ==
+        SourceMgr.getLineNumber(DeclLocDecomp.first, Comment->first)) {
+      return Comment->second;
     }
   }
 
   // The comment just after the declaration was not a trailing comment.
   // Let's look at the previous comment.
-  if (Comment == RawComments.begin())
+  if (Comment == FileComments.begin())
     return nullptr;
   --Comment;
 
   // Check that we actually have a non-member Doxygen comment.
-  if (!(*Comment)->isDocumentation() || (*Comment)->isTrailingComment())
+  if (!Comment->second->isDocumentation() ||
+      Comment->second->isTrailingComment())
     return nullptr;
 
   // Decompose the end of the comment.
   std::pair<FileID, unsigned> CommentEndDecomp
-    = SourceMgr.getDecomposedLoc((*Comment)->getSourceRange().getEnd());
+    = SourceMgr.getDecomposedLoc(Comment->second->getSourceRange().getEnd());
 
   // If the comment and the declaration aren't in the same file, then they
   // aren't related.
@@ -254,7 +236,7 @@ RawComment *ASTContext::getRawCommentForDeclNoCache(const Decl *D) const {
   if (Text.find_first_of(";{}#@") != StringRef::npos)
     return nullptr;
 
-  return *Comment;
+  return Comment->second;
 }
 
 namespace {
@@ -726,6 +708,49 @@ static bool isAddrSpaceMapManglingEnabled(const TargetInfo &TI,
   llvm_unreachable("getAddressSpaceMapMangling() doesn't cover anything.");
 }
 
+/// \brief Tracks which top-level declarations of the translation unit the
+/// lazily built parent map covers, and finds the top-level declarations a
+/// node can be in.
+class ASTContext::ParentMapProgress {
+public:
+  explicit ParentMapProgress(ASTContext &Ctx);
+
+  /// \brief Maps the subtrees of the top-level declarations that \p Node can
+  /// be in, if they are not mapped yet.
+  void mapSubtreesOf(const ast_type_traits::DynTypedNode &Node);
+
+  /// \brief Maps the subtrees of all top-level declarations.
+  void mapAll();
+
+  bool isComplete() const { return NumUnmapped == 0; }
+
+private:
+  struct TopLevelDecl {
+    Decl *D;
+    bool Mapped;
+  };
+
+  /// \brief Top-level declarations whose expansion ranges overlap, such as
+  /// the declarations of one declaration group.
+  struct Cluster {
+    SourceLocation Begin, End;
+    SmallVector<unsigned, 1> Decls;
+  };
+
+  void mapSubtree(unsigned Index);
+  void mapSubtreeAt(SourceLocation Loc);
+  /// \brief Returns the index of the top-level declaration that \p D is
+  /// lexically in, or -1 if there is none.
+  int getTopLevelIndex(const Decl *D) const;
+
+  ASTContext &Ctx;
+  std::vector<TopLevelDecl> Decls;
+  llvm::DenseMap<const Decl *, unsigned> DeclIndices;
+  /// \brief Sorted by location, with no two overlapping.
+  std::vector<Cluster> Clusters;
+  unsigned NumUnmapped;
+};
+
 ASTContext::ASTContext(LangOptions &LOpts, SourceManager &SM,
                        IdentifierTable &idents, SelectorTable &sels,
                        Builtin::Context &builtins)
@@ -847,6 +872,33 @@ void ASTContext::PrintStats() const {
 
   llvm::errs() << "Total bytes = " << TotalBytes << "\n";
 
+  // Type uniquing tables. Each bucket array holds a pointer per bucket, and a
+  // folding set rebuckets once it holds twice as many nodes as buckets.
+  size_t UniquingBytes = 0;
+  auto PrintUniquingTable = [&](const char *Name,
+                                llvm::FoldingSetImpl &Table) {
+    if (Table.empty())
+      return;
+    size_t Bytes = (Table.capacity() / 2 + 1) * sizeof(void *);
+    UniquingBytes += Bytes;
+    llvm::errs() << "    " << Table.size() << " uniqued " << Name
+                 << " types, " << Bytes << " bytes of buckets\n";
+  };
+  PrintUniquingTable("extended qualifier", ExtQualNodes);
+  PrintUniquingTable("pointer", PointerTypes);
+  PrintUniquingTable("lvalue reference", LValueReferenceTypes);
+  PrintUniquingTable("rvalue reference", RValueReferenceTypes);
+  PrintUniquingTable("member pointer", MemberPointerTypes);
+  PrintUniquingTable("constant array", ConstantArrayTypes);
+  PrintUniquingTable("function prototype", FunctionProtoTypes);
+  PrintUniquingTable("template type parameter", TemplateTypeParmTypes);
+  PrintUniquingTable("substituted template type parameter",
+                     SubstTemplateTypeParmTypes);
+  PrintUniquingTable("template specialization", TemplateSpecializationTypes);
+  PrintUniquingTable("elaborated", ElaboratedTypes);
+  PrintUniquingTable("dependent name", DependentNameTypes);
+  llvm::errs() << "Type uniquing table bytes = " << UniquingBytes << "\n";
+
   // Implicit special member functions.
   llvm::errs() << NumImplicitDefaultConstructorsDeclared << "/"
                << NumImplicitDefaultConstructors
@@ -869,6 +921,32 @@ void ASTContext::PrintStats() const {
                << NumImplicitDestructors
                << " implicit destructors created\n";
 
+  // Declaration context lookup tables.
+  unsigned NumLookupTables = 0, NumLookupEntries = 0, NumMultiDeclEntries = 0;
+  unsigned NumMultiDecls = 0;
+  size_t LookupTableBytes = 0;
+  size_t InlineDecls = StoredDeclsList::DeclsTy().capacity();
+  for (StoredDeclsMap *Map = LastSDM.getPointer(); Map;
+       Map = Map->Previous.getPointer()) {
+    ++NumLookupTables;
+    NumLookupEntries += Map->size();
+    LookupTableBytes += Map->getMemorySize();
+    for (auto &Entry : *Map) {
+      if (StoredDeclsList::DeclsTy *Vec = Entry.second.getAsVector()) {
+        ++NumMultiDeclEntries;
+        NumMultiDecls += Vec->size();
+        LookupTableBytes += sizeof(*Vec);
+        if (Vec->capacity() > InlineDecls)
+          LookupTableBytes += Vec->capacity_in_bytes();
+      }
+    }
+  }
+  llvm::errs() << NumLookupTables << " declaration lookup tables with "
+               << NumLookupEntries << " names\n";
+  llvm::errs() << NumMultiDeclEntries << " names with multiple declarations ("
+               << NumMultiDecls << " declarations)\n";
+  llvm::errs() << LookupTableBytes << " bytes used by lookup tables\n";
+
   if (ExternalSource) {
     llvm::errs() << "\n";
     ExternalSource->PrintStats();
@@ -8472,9 +8550,36 @@ static GVALinkage adjustGVALinkageForAttributes(const ASTContext &Context,
   return L;
 }
 
+/// Adjust the GVALinkage for a declaration whose definition is emitted in the
+/// object file of the module that provides it, as with -fmodules-codegen.
+static GVALinkage
+adjustGVALinkageForExternalDefinitionKind(const ASTContext &Ctx,
+                                          const Decl *D, GVALinkage L) {
+  if (L == GVA_Internal)
+    return L;
+
+  if (ExternalASTSource *Ext = Ctx.getExternalSource()) {
+    switch (Ext->hasExternalDefinitions(D)) {
+    case ExternalASTSource::EK_Never:
+      // This is the object file of the module: keep the definition, so that
+      // its importers can use it.
+      if (L == GVA_DiscardableODR)
+        return GVA_StrongODR;
+      break;
+    case ExternalASTSource::EK_Always:
+      return GVA_AvailableExternally;
+    case ExternalASTSource::EK_ReplyHazy:
+      break;
+    }
+  }
+  return L;
+}
+
 GVALinkage ASTContext::GetGVALinkageForFunction(const FunctionDecl *FD) const {
-  return adjustGVALinkageForAttributes(
-      *this, basicGVALinkageForFunction(*this, FD), FD);
+  return adjustGVALinkageForExternalDefinitionKind(
+      *this, FD,
+      adjustGVALinkageForAttributes(*this, basicGVALinkageForFunction(*this, FD),
+                                    FD));
 }
 
 static GVALinkage basicGVALinkageForVariable(const ASTContext &Context,
@@ -8596,6 +8701,13 @@ bool ASTContext::DeclMustBeEmitted(const Decl *D) {
     if (!FD->doesThisDeclarationHaveABody())
       return FD->doesDeclarationForceExternallyVisibleDefinition();
 
+    // The object file of a module built with -fmodules-codegen has the
+    // definitions its importers do not emit.
+    if (ExternalSource &&
+        ExternalSource->hasExternalDefinitions(FD) ==
+            ExternalASTSource::EK_Never)
+      return true;
+
     // Constructors and destructors are required.
     if (FD->hasAttr<ConstructorAttr>() || FD->hasAttr<DestructorAttr>())
       return true;
@@ -8921,16 +9033,45 @@ createDynTypedNode(const NestedNameSpecifierLoc &Node) {
   /// FIXME: Currently only builds up the map using \c Stmt and \c Decl nodes.
   class ParentMapASTVisitor : public RecursiveASTVisitor<ParentMapASTVisitor> {
   public:
-    /// \brief Builds and returns the translation unit's parent map.
+    /// \brief Adds the parents of the nodes in the subtree of the top-level
+    /// declaration \p D of \p TU to \p Parents and \p OtherParents.
     ///
-    ///  The caller takes ownership of the returned \c ParentMap.
-    static std::pair<ASTContext::ParentMapPointers *,
-                     ASTContext::ParentMapOtherNodes *>
-    buildMap(TranslationUnitDecl &TU) {
-      ParentMapASTVisitor Visitor(new ASTContext::ParentMapPointers,
-                                  new ASTContext::ParentMapOtherNodes);
-      Visitor.TraverseDecl(&TU);
-      return std::make_pair(Visitor.Parents, Visitor.OtherParents);
+    /// The declarations whose subtrees can share nodes with this one, or hold
+    /// its template instantiations, are added to \p RelatedDecls.
+    static void mapTopLevelDecl(TranslationUnitDecl &TU, Decl *D,
+                                ASTContext::ParentMapPointers *Parents,
+                                ASTContext::ParentMapOtherNodes *OtherParents,
+                                SmallVectorImpl<const Decl *> &RelatedDecls) {
+      ParentMapASTVisitor Visitor(Parents, OtherParents);
+      Visitor.RelatedDecls = &RelatedDecls;
+      Visitor.ParentStack.push_back(ast_type_traits::DynTypedNode::create(TU));
+      Visitor.TraverseDecl(D);
+    }
+
+    /// \brief Adds the parents of the nodes in the subtrees of the
+    /// declarations in \p Scope to \p Parents and \p OtherParents.
+    static void mapScope(ArrayRef<Decl *> Scope,
+                         ASTContext::ParentMapPointers *Parents,
+                         ASTContext::ParentMapOtherNodes *OtherParents) {
+      ParentMapASTVisitor Visitor(Parents, OtherParents);
+      for (Decl *D : Scope) {
+        // Link the enclosing declaration contexts up to the translation unit,
+        // without traversing them.
+        const Decl *Child = nullptr;
+        for (DeclContext *DC = D->getLexicalDeclContext(); DC;
+             DC = DC->getLexicalParent()) {
+          const Decl *Parent = cast<Decl>(DC);
+          if (Child)
+            addParent(Child, ast_type_traits::DynTypedNode::create(*Parent),
+                      Visitor.Parents);
+          else
+            Visitor.ParentStack.push_back(
+                ast_type_traits::DynTypedNode::create(*Parent));
+          Child = Parent;
+        }
+        Visitor.TraverseDecl(D);
+        Visitor.ParentStack.clear();
+      }
     }
 
   private:
@@ -8938,7 +9079,8 @@ createDynTypedNode(const NestedNameSpecifierLoc &Node) {
 
     ParentMapASTVisitor(ASTContext::ParentMapPointers *Parents,
                         ASTContext::ParentMapOtherNodes *OtherParents)
-        : Parents(Parents), OtherParents(OtherParents) {}
+        : Parents(Parents), OtherParents(OtherParents),
+          RelatedDecls(nullptr) {}
 
     bool shouldVisitTemplateInstantiations() const {
       return true;
@@ -8947,56 +9089,61 @@ createDynTypedNode(const NestedNameSpecifierLoc &Node) {
       return true;
     }
 
+    /// \brief Records \p Parent as a parent of the node \p MapNode.
+    template <typename MapNodeTy, typename MapTy>
+    static void addParent(MapNodeTy MapNode,
+                          const ast_type_traits::DynTypedNode &Parent,
+                          MapTy *Parents) {
+      // FIXME: Currently we add the same parent multiple times, but only
+      // when no memoization data is available for the type.
+      // For example when we visit all subexpressions of template
+      // instantiations; this is suboptimal, but benign: the only way to
+      // visit those is with hasAncestor / hasParent, and those do not create
+      // new matches.
+      // The plan is to enable DynTypedNode to be storable in a map or hash
+      // map. The main problem there is to implement hash functions /
+      // comparison operators for all types that DynTypedNode supports that
+      // do not have pointer identity.
+      auto &NodeOrVector = (*Parents)[MapNode];
+      if (NodeOrVector.isNull()) {
+        if (const auto *D = Parent.get<Decl>())
+          NodeOrVector = D;
+        else if (const auto *S = Parent.get<Stmt>())
+          NodeOrVector = S;
+        else
+          NodeOrVector = new ast_type_traits::DynTypedNode(Parent);
+      } else {
+        if (!NodeOrVector.template is<ASTContext::ParentVector *>()) {
+          auto *Vector = new ASTContext::ParentVector(
+              1, getSingleDynTypedNodeFromParentMap(NodeOrVector));
+          if (auto *Node =
+                  NodeOrVector
+                      .template dyn_cast<ast_type_traits::DynTypedNode *>())
+            delete Node;
+          NodeOrVector = Vector;
+        }
+
+        auto *Vector = NodeOrVector.template get<ASTContext::ParentVector *>();
+        // Skip duplicates for types that have memoization data.
+        // We must check that the type has memoization data before calling
+        // std::find() because DynTypedNode::operator== can't compare all
+        // types.
+        bool Found = Parent.getMemoizationData() &&
+                     std::find(Vector->begin(), Vector->end(), Parent) !=
+                         Vector->end();
+        if (!Found)
+          Vector->push_back(Parent);
+      }
+    }
+
     template <typename T, typename MapNodeTy, typename BaseTraverseFn,
               typename MapTy>
     bool TraverseNode(T Node, MapNodeTy MapNode,
                       BaseTraverseFn BaseTraverse, MapTy *Parents) {
       if (!Node)
         return true;
-      if (ParentStack.size() > 0) {
-        // FIXME: Currently we add the same parent multiple times, but only
-        // when no memoization data is available for the type.
-        // For example when we visit all subexpressions of template
-        // instantiations; this is suboptimal, but benign: the only way to
-        // visit those is with hasAncestor / hasParent, and those do not create
-        // new matches.
-        // The plan is to enable DynTypedNode to be storable in a map or hash
-        // map. The main problem there is to implement hash functions /
-        // comparison operators for all types that DynTypedNode supports that
-        // do not have pointer identity.
-        auto &NodeOrVector = (*Parents)[MapNode];
-        if (NodeOrVector.isNull()) {
-          if (const auto *D = ParentStack.back().get<Decl>())
-            NodeOrVector = D;
-          else if (const auto *S = ParentStack.back().get<Stmt>())
-            NodeOrVector = S;
-          else
-            NodeOrVector =
-                new ast_type_traits::DynTypedNode(ParentStack.back());
-        } else {
-          if (!NodeOrVector.template is<ASTContext::ParentVector *>()) {
-            auto *Vector = new ASTContext::ParentVector(
-                1, getSingleDynTypedNodeFromParentMap(NodeOrVector));
-            if (auto *Node =
-                    NodeOrVector
-                        .template dyn_cast<ast_type_traits::DynTypedNode *>())
-              delete Node;
-            NodeOrVector = Vector;
-          }
-
-          auto *Vector =
-              NodeOrVector.template get<ASTContext::ParentVector *>();
-          // Skip duplicates for types that have memoization data.
-          // We must check that the type has memoization data before calling
-          // std::find() because DynTypedNode::operator== can't compare all
-          // types.
-          bool Found = ParentStack.back().getMemoizationData() &&
-                       std::find(Vector->begin(), Vector->end(),
-                                 ParentStack.back()) != Vector->end();
-          if (!Found)
-            Vector->push_back(ParentStack.back());
-        }
-      }
+      if (ParentStack.size() > 0)
+        addParent(MapNode, ParentStack.back(), Parents);
       ParentStack.push_back(createDynTypedNode(Node));
       bool Result = BaseTraverse();
       ParentStack.pop_back();
@@ -9004,6 +9151,18 @@ createDynTypedNode(const NestedNameSpecifierLoc &Node) {
     }
 
     bool TraverseDecl(Decl *DeclNode) {
+      // The implicit instantiations of a template are traversed below its
+      // first declaration, and share nodes with its definition; the
+      // instantiations of an out-of-line member of a class template are
+      // traversed below the class template.
+      if (RelatedDecls && DeclNode &&
+          (isa<TemplateDecl>(DeclNode) ||
+           DeclNode->getDeclContext()->isDependentContext()) &&
+          (DeclNode != DeclNode->getCanonicalDecl() ||
+           DeclNode->isOutOfLine())) {
+        RelatedDecls->push_back(DeclNode->getCanonicalDecl());
+        RelatedDecls->push_back(cast<Decl>(DeclNode->getDeclContext()));
+      }
       return TraverseNode(DeclNode, DeclNode,
                           [&] { return VisitorBase::TraverseDecl(DeclNode); },
                           Parents);
@@ -9033,6 +9192,7 @@ createDynTypedNode(const NestedNameSpecifierLoc &Node) {
 
     ASTContext::ParentMapPointers *Parents;
     ASTContext::ParentMapOtherNodes *OtherParents;
+    SmallVectorImpl<const Decl *> *RelatedDecls;
     llvm::SmallVector<ast_type_traits::DynTypedNode, 16> ParentStack;
 
     friend class RecursiveASTVisitor<ParentMapASTVisitor>;
@@ -9053,18 +9213,171 @@ static ASTContext::DynTypedNodeList getDynNodeFromMap(const NodeTy &Node,
   return getSingleDynTypedNodeFromParentMap(I->second);
 }
 
+ASTContext::ParentMapProgress::ParentMapProgress(ASTContext &Ctx)
+    : Ctx(Ctx) {
+  const SourceManager &SM = Ctx.getSourceManager();
+  for (Decl *D : Ctx.getTranslationUnitDecl()->decls()) {
+    // Like RecursiveASTVisitor, leave blocks and captured statements to the
+    // expressions that hold them.
+    if (isa<BlockDecl>(D) || isa<CapturedDecl>(D))
+      continue;
+    DeclIndices[D] = Decls.size();
+    Decls.push_back({D, false});
+
+    SourceRange Range = D->getSourceRange();
+    if (Range.isInvalid())
+      continue;
+    Range = SM.getExpansionRange(Range);
+    Clusters.push_back({Range.getBegin(), Range.getEnd(),
+                        SmallVector<unsigned, 1>(1, Decls.size() - 1)});
+  }
+  NumUnmapped = Decls.size();
+
+  std::sort(Clusters.begin(), Clusters.end(),
+            [&](const Cluster &LHS, const Cluster &RHS) {
+              return SM.isBeforeInTranslationUnit(LHS.Begin, RHS.Begin);
+            });
+  // Merge the overlapping ranges, so that a location is in at most one.
+  unsigned Last = 0;
+  for (unsigned I = 1, E = Clusters.size(); I < E; ++I) {
+    Cluster &Prev = Clusters[Last];
+    if (SM.isBeforeInTranslationUnit(Prev.End, Clusters[I].Begin)) {
+      if (++Last != I)
+        Clusters[Last] = std::move(Clusters[I]);
+      continue;
+    }
+    if (SM.isBeforeInTranslationUnit(Prev.End, Clusters[I].End))
+      Prev.End = Clusters[I].End;
+    Prev.Decls.append(Clusters[I].Decls.begin(), Clusters[I].Decls.end());
+  }
+  if (!Clusters.empty())
+    Clusters.resize(Last + 1);
+}
+
+int ASTContext::ParentMapProgress::getTopLevelIndex(const Decl *D) const {
+  while (const DeclContext *DC = D->getLexicalDeclContext()) {
+    if (isa<TranslationUnitDecl>(DC)) {
+      auto I = DeclIndices.find(D);
+      return I == DeclIndices.end() ? -1 : static_cast<int>(I->second);
+    }
+    D = cast<Decl>(DC);
+  }
+  return -1;
+}
+
+void ASTContext::ParentMapProgress::mapSubtree(unsigned Index) {
+  SmallVector<unsigned, 4> Worklist(1, Index);
+  SmallVector<const Decl *, 8> RelatedDecls;
+  while (!Worklist.empty()) {
+    TopLevelDecl &TLD = Decls[Worklist.pop_back_val()];
+    if (TLD.Mapped)
+      continue;
+    TLD.Mapped = true;
+    --NumUnmapped;
+
+    RelatedDecls.clear();
+    ParentMapASTVisitor::mapTopLevelDecl(*Ctx.getTranslationUnitDecl(), TLD.D,
+                                         Ctx.PointerParents.get(),
+                                         Ctx.OtherParents.get(), RelatedDecls);
+    for (const Decl *D : RelatedDecls) {
+      int Related = getTopLevelIndex(D);
+      if (Related >= 0 && !Decls[Related].Mapped)
+        Worklist.push_back(Related);
+    }
+  }
+}
+
+void ASTContext::ParentMapProgress::mapSubtreeAt(SourceLocation Loc) {
+  if (Loc.isInvalid())
+    return;
+  const SourceManager &SM = Ctx.getSourceManager();
+  Loc = SM.getExpansionLoc(Loc);
+  auto I = std::upper_bound(Clusters.begin(), Clusters.end(), Loc,
+                            [&](SourceLocation Loc, const Cluster &C) {
+                              return SM.isBeforeInTranslationUnit(Loc,
+                                                                  C.Begin);
+                            });
+  if (I == Clusters.begin())
+    return;
+  --I;
+  if (SM.isBeforeInTranslationUnit(I->End, Loc))
+    return;
+  for (unsigned Index : I->Decls)
+    mapSubtree(Index);
+}
+
+void ASTContext::ParentMapProgress::mapSubtreesOf(
+    const ast_type_traits::DynTypedNode &Node) {
+  if (const auto *D = Node.get<Decl>()) {
+    int Index = getTopLevelIndex(D);
+    if (Index >= 0)
+      mapSubtree(Index);
+    else
+      // Implicit instantiations are not in the declaration context they
+      // are lexically in, but are within the source range of their template.
+      mapSubtreeAt(D->getLocation());
+  } else if (const auto *S = Node.get<Stmt>()) {
+    mapSubtreeAt(S->getLocStart());
+  } else if (const auto *TL = Node.get<TypeLoc>()) {
+    mapSubtreeAt(TL->getBeginLoc());
+  } else if (const auto *NNSL = Node.get<NestedNameSpecifierLoc>()) {
+    mapSubtreeAt(NNSL->getBeginLoc());
+  }
+}
+
+void ASTContext::ParentMapProgress::mapAll() {
+  for (unsigned I = 0, E = Decls.size(); I != E && !isComplete(); ++I)
+    mapSubtree(I);
+}
+
+static ASTContext::DynTypedNodeList
+lookupParents(const ast_type_traits::DynTypedNode &Node,
+              const ASTContext::ParentMapPointers &PointerParents,
+              const ASTContext::ParentMapOtherNodes &OtherParents) {
+  if (Node.getNodeKind().hasPointerIdentity())
+    return getDynNodeFromMap(Node.getMemoizationData(), PointerParents);
+  return getDynNodeFromMap(Node, OtherParents);
+}
+
 ASTContext::DynTypedNodeList
 ASTContext::getParents(const ast_type_traits::DynTypedNode &Node) {
   if (!PointerParents) {
-    // We always need to run over the whole translation unit, as
-    // hasAncestor can escape any subtree.
-    auto Maps = ParentMapASTVisitor::buildMap(*getTranslationUnitDecl());
-    PointerParents.reset(Maps.first);
-    OtherParents.reset(Maps.second);
+    PointerParents.reset(new ParentMapPointers);
+    OtherParents.reset(new ParentMapOtherNodes);
+    if (ParentMapScope.empty())
+      ParentMapState.reset(new ParentMapProgress(*this));
+    else
+      ParentMapASTVisitor::mapScope(ParentMapScope, PointerParents.get(),
+                                    OtherParents.get());
   }
-  if (Node.getNodeKind().hasPointerIdentity())
-    return getDynNodeFromMap(Node.getMemoizationData(), *PointerParents);
-  return getDynNodeFromMap(Node, *OtherParents);
+
+  DynTypedNodeList Parents =
+      lookupParents(Node, *PointerParents, *OtherParents);
+  if (!Parents.empty() || !ParentMapState || ParentMapState->isComplete())
+    return Parents;
+
+  // hasAncestor can escape any subtree, so try the subtree the node is in
+  // first, and fall back to the rest of the translation unit.
+  ParentMapState->mapSubtreesOf(Node);
+  Parents = lookupParents(Node, *PointerParents, *OtherParents);
+  if (Parents.empty()) {
+    ParentMapState->mapAll();
+    Parents = lookupParents(Node, *PointerParents, *OtherParents);
+  }
+  return Parents;
+}
+
+void ASTContext::setParentMapScope(ArrayRef<Decl *> Scope) {
+  ReleaseParentMapEntries();
+  PointerParents.reset();
+  OtherParents.reset();
+  ParentMapState.reset();
+  ParentMapScope.assign(Scope.begin(), Scope.end());
+}
+
+void ASTContext::computeParentMap() {
+  // The translation unit has no parents, so this maps all subtrees.
+  getParents(*getTranslationUnitDecl());
 }
 
 bool
@@ -15,6 +15,7 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
 #include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclContextInternals.h"
 #include "clang/AST/DeclObjC.h"
 #include "clang/AST/DeclVisitor.h"
 #include "clang/AST/StmtVisitor.h"
@@ -252,6 +253,7 @@ namespace clang {
     Expr *VisitMemberExpr(MemberExpr *E);
     Expr *VisitCallExpr(CallExpr *E);
     Expr *VisitInitListExpr(InitListExpr *E);
+    Expr *VisitPackedArrayInitExpr(PackedArrayInitExpr *E);
     Expr *VisitCXXDefaultInitExpr(CXXDefaultInitExpr *E);
     Expr *VisitCXXNamedCastExpr(CXXNamedCastExpr *E);
 
@@ -305,6 +307,10 @@ namespace {
     /// \brief Declaration (from, to) pairs that are known not to be equivalent
     /// (which we have already complained about).
     llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls;
+
+    /// \brief Declaration (from, to) pairs that were found to be equivalent
+    /// by earlier checks.
+    llvm::DenseSet<std::pair<Decl *, Decl *> > &EquivalentDecls;
     
     /// \brief Whether we're being strict about the spelling of types when 
     /// unifying two types.
@@ -318,9 +324,11 @@ namespace {
 
     StructuralEquivalenceContext(ASTContext &C1, ASTContext &C2,
                llvm::DenseSet<std::pair<Decl *, Decl *> > &NonEquivalentDecls,
+               llvm::DenseSet<std::pair<Decl *, Decl *> > &EquivalentDecls,
                                  bool StrictTypeSpelling = false,
                                  bool Complain = true)
       : C1(C1), C2(C2), NonEquivalentDecls(NonEquivalentDecls),
+        EquivalentDecls(EquivalentDecls),
         StrictTypeSpelling(StrictTypeSpelling), Complain(Complain),
         LastDiagFromC2(false) {}
 
@@ -336,6 +344,11 @@ namespace {
     ///
     /// \returns true if an error occurred, false otherwise.
     bool Finish();
+
+    /// \brief Remember the tentative equivalences that were all verified by
+    /// Finish, unless some of them involve incomplete declarations, which
+    /// could later be completed differently.
+    void recordEquivalences();
     
   public:
     DiagnosticBuilder Diag1(SourceLocation Loc, unsigned DiagID) {
@@ -1400,6 +1413,11 @@ static bool IsStructurallyEquivalent(StructuralEquivalenceContext &Context,
   if (Context.NonEquivalentDecls.count(std::make_pair(D1->getCanonicalDecl(),
                                                       D2->getCanonicalDecl())))
     return false;
+
+  // Or that they are.
+  if (Context.EquivalentDecls.count(std::make_pair(D1->getCanonicalDecl(),
+                                                   D2->getCanonicalDecl())))
+    return true;
   
   // Determine whether we've already produced a tentative equivalence for D1.
   Decl *&EquivToD1 = Context.TentativeEquivalences[D1->getCanonicalDecl()];
@@ -1417,7 +1435,11 @@ bool StructuralEquivalenceContext::IsStructurallyEquivalent(Decl *D1,
   if (!::IsStructurallyEquivalent(*this, D1, D2))
     return false;
   
-  return !Finish();
+  if (Finish())
+    return false;
+
+  recordEquivalences();
+  return true;
 }
 
 bool StructuralEquivalenceContext::IsStructurallyEquivalent(QualType T1, 
@@ -1425,7 +1447,30 @@ bool StructuralEquivalenceContext::IsStructurallyEquivalent(QualType T1,
   if (!::IsStructurallyEquivalent(*this, T1, T2))
     return false;
   
-  return !Finish();
+  if (Finish())
+    return false;
+
+  recordEquivalences();
+  return true;
+}
+
+/// \brief Whether the definition of \p D, if it can have one, is known.
+static bool isCompleteForEquivalence(Decl *D) {
+  if (auto *Template = dyn_cast<ClassTemplateDecl>(D))
+    D = Template->getTemplatedDecl();
+  if (auto *Tag = dyn_cast<TagDecl>(D))
+    return Tag->getDefinition() != nullptr;
+  return true;
+}
+
+void StructuralEquivalenceContext::recordEquivalences() {
+  for (const auto &Equivalence : TentativeEquivalences)
+    if (!isCompleteForEquivalence(Equivalence.first) ||
+        !isCompleteForEquivalence(Equivalence.second))
+      return;
+
+  EquivalentDecls.insert(TentativeEquivalences.begin(),
+                         TentativeEquivalences.end());
 }
 
 bool StructuralEquivalenceContext::Finish() {
@@ -2134,12 +2179,16 @@ bool ASTNodeImporter::ImportDefinition(RecordDecl *From, RecordDecl *To,
     ToData.HasUninitializedFields = FromData.HasUninitializedFields;
     ToData.HasInheritedConstructor = FromData.HasInheritedConstructor;
     ToData.HasInheritedAssignment = FromData.HasInheritedAssignment;
+    ToData.NeedOverloadResolutionForCopyConstructor
+      = FromData.NeedOverloadResolutionForCopyConstructor;
     ToData.NeedOverloadResolutionForMoveConstructor
       = FromData.NeedOverloadResolutionForMoveConstructor;
     ToData.NeedOverloadResolutionForMoveAssignment
       = FromData.NeedOverloadResolutionForMoveAssignment;
     ToData.NeedOverloadResolutionForDestructor
       = FromData.NeedOverloadResolutionForDestructor;
+    ToData.DefaultedCopyConstructorIsDeleted
+      = FromData.DefaultedCopyConstructorIsDeleted;
     ToData.DefaultedMoveConstructorIsDeleted
       = FromData.DefaultedMoveConstructorIsDeleted;
     ToData.DefaultedMoveAssignmentIsDeleted
@@ -2368,6 +2417,7 @@ bool ASTNodeImporter::IsStructuralMatch(RecordDecl *FromRecord,
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    ToRecord->getASTContext(),
                                    Importer.getNonEquivalentDecls(),
+                                   Importer.getEquivalentDecls(),
                                    false, Complain);
   return Ctx.IsStructurallyEquivalent(FromRecord, ToRecord);
 }
@@ -2376,14 +2426,16 @@ bool ASTNodeImporter::IsStructuralMatch(VarDecl *FromVar, VarDecl *ToVar,
                                         bool Complain) {
   StructuralEquivalenceContext Ctx(
       Importer.getFromContext(), Importer.getToContext(),
-      Importer.getNonEquivalentDecls(), false, Complain);
+      Importer.getNonEquivalentDecls(), Importer.getEquivalentDecls(), false,
+      Complain);
   return Ctx.IsStructurallyEquivalent(FromVar, ToVar);
 }
 
 bool ASTNodeImporter::IsStructuralMatch(EnumDecl *FromEnum, EnumDecl *ToEnum) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(FromEnum, ToEnum);
 }
 
@@ -2402,7 +2454,8 @@ bool ASTNodeImporter::IsStructuralMatch(ClassTemplateDecl *From,
                                         ClassTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);  
 }
 
@@ -2410,7 +2463,8 @@ bool ASTNodeImporter::IsStructuralMatch(VarTemplateDecl *From,
                                         VarTemplateDecl *To) {
   StructuralEquivalenceContext Ctx(Importer.getFromContext(),
                                    Importer.getToContext(),
-                                   Importer.getNonEquivalentDecls());
+                                   Importer.getNonEquivalentDecls(),
+                                   Importer.getEquivalentDecls());
   return Ctx.IsStructurallyEquivalent(From, To);
 }
 
@@ -2477,7 +2531,7 @@ Decl *ASTNodeImporter::VisitNamespaceDecl(NamespaceDecl *D) {
   } else {
     SmallVector<NamedDecl *, 4> ConflictingDecls;
     SmallVector<NamedDecl *, 2> FoundDecls;
-    DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+    Importer.findDeclsInToContext(DC, Name, FoundDecls);
     for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
       if (!FoundDecls[I]->isInIdentifierNamespace(Decl::IDNS_Namespace))
         continue;
@@ -2543,7 +2597,7 @@ Decl *ASTNodeImporter::VisitTypedefNameDecl(TypedefNameDecl *D, bool IsAlias) {
     SmallVector<NamedDecl *, 4> ConflictingDecls;
     unsigned IDNS = Decl::IDNS_Ordinary;
     SmallVector<NamedDecl *, 2> FoundDecls;
-    DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+    Importer.findDeclsInToContext(DC, Name, FoundDecls);
     for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
       if (!FoundDecls[I]->isInIdentifierNamespace(IDNS))
         continue;
@@ -2659,7 +2713,7 @@ Decl *ASTNodeImporter::VisitEnumDecl(EnumDecl *D) {
   if (!DC->isFunctionOrMethod() && SearchName) {
     SmallVector<NamedDecl *, 4> ConflictingDecls;
     SmallVector<NamedDecl *, 2> FoundDecls;
-    DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+    Importer.findDeclsInToContext(DC, Name, FoundDecls);
     for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
       if (!FoundDecls[I]->isInIdentifierNamespace(IDNS))
         continue;
@@ -2748,7 +2802,7 @@ Decl *ASTNodeImporter::VisitRecordDecl(RecordDecl *D) {
   if (!DC->isFunctionOrMethod()) {
     SmallVector<NamedDecl *, 4> ConflictingDecls;
     SmallVector<NamedDecl *, 2> FoundDecls;
-    DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+    Importer.findDeclsInToContext(DC, Name, FoundDecls);
     for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
       if (!FoundDecls[I]->isInIdentifierNamespace(IDNS))
         continue;
@@ -2897,7 +2951,7 @@ Decl *ASTNodeImporter::VisitEnumConstantDecl(EnumConstantDecl *D) {
     SmallVector<NamedDecl *, 4> ConflictingDecls;
     unsigned IDNS = Decl::IDNS_Ordinary;
     SmallVector<NamedDecl *, 2> FoundDecls;
-    DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+    Importer.findDeclsInToContext(DC, Name, FoundDecls);
     for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
       if (!FoundDecls[I]->isInIdentifierNamespace(IDNS))
         continue;
@@ -2952,7 +3006,7 @@ Decl *ASTNodeImporter::VisitFunctionDecl(FunctionDecl *D) {
     SmallVector<NamedDecl *, 4> ConflictingDecls;
     unsigned IDNS = Decl::IDNS_Ordinary;
     SmallVector<NamedDecl *, 2> FoundDecls;
-    DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+    Importer.findDeclsInToContext(DC, Name, FoundDecls);
     for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
       if (!FoundDecls[I]->isInIdentifierNamespace(IDNS))
         continue;
@@ -3182,7 +3236,7 @@ Decl *ASTNodeImporter::VisitFieldDecl(FieldDecl *D) {
 
   // Determine whether we've already imported this field. 
   SmallVector<NamedDecl *, 2> FoundDecls;
-  DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+  Importer.findDeclsInToContext(DC, Name, FoundDecls);
   for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
     if (FieldDecl *FoundField = dyn_cast<FieldDecl>(FoundDecls[I])) {
       // For anonymous fields, match up by index.
@@ -3246,7 +3300,7 @@ Decl *ASTNodeImporter::VisitIndirectFieldDecl(IndirectFieldDecl *D) {
 
   // Determine whether we've already imported this field. 
   SmallVector<NamedDecl *, 2> FoundDecls;
-  DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+  Importer.findDeclsInToContext(DC, Name, FoundDecls);
   for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
     if (IndirectFieldDecl *FoundField 
                                 = dyn_cast<IndirectFieldDecl>(FoundDecls[I])) {
@@ -3316,7 +3370,7 @@ Decl *ASTNodeImporter::VisitObjCIvarDecl(ObjCIvarDecl *D) {
 
   // Determine whether we've already imported this ivar 
   SmallVector<NamedDecl *, 2> FoundDecls;
-  DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+  Importer.findDeclsInToContext(DC, Name, FoundDecls);
   for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
     if (ObjCIvarDecl *FoundIvar = dyn_cast<ObjCIvarDecl>(FoundDecls[I])) {
       if (Importer.IsStructurallyEquivalent(D->getType(), 
@@ -3374,7 +3428,7 @@ Decl *ASTNodeImporter::VisitVarDecl(VarDecl *D) {
     SmallVector<NamedDecl *, 4> ConflictingDecls;
     unsigned IDNS = Decl::IDNS_Ordinary;
     SmallVector<NamedDecl *, 2> FoundDecls;
-    DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+    Importer.findDeclsInToContext(DC, Name, FoundDecls);
     for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
       if (!FoundDecls[I]->isInIdentifierNamespace(IDNS))
         continue;
@@ -3555,7 +3609,7 @@ Decl *ASTNodeImporter::VisitObjCMethodDecl(ObjCMethodDecl *D) {
     return ToD;
 
   SmallVector<NamedDecl *, 2> FoundDecls;
-  DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+  Importer.findDeclsInToContext(DC, Name, FoundDecls);
   for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
     if (ObjCMethodDecl *FoundMethod = dyn_cast<ObjCMethodDecl>(FoundDecls[I])) {
       if (FoundMethod->isInstanceMethod() != D->isInstanceMethod())
@@ -3831,7 +3885,7 @@ Decl *ASTNodeImporter::VisitObjCProtocolDecl(ObjCProtocolDecl *D) {
 
   ObjCProtocolDecl *MergeWithProtocol = nullptr;
   SmallVector<NamedDecl *, 2> FoundDecls;
-  DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+  Importer.findDeclsInToContext(DC, Name, FoundDecls);
   for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
     if (!FoundDecls[I]->isInIdentifierNamespace(Decl::IDNS_ObjCProtocol))
       continue;
@@ -4029,7 +4083,7 @@ Decl *ASTNodeImporter::VisitObjCInterfaceDecl(ObjCInterfaceDecl *D) {
   // Look for an existing interface with the same name.
   ObjCInterfaceDecl *MergeWithIface = nullptr;
   SmallVector<NamedDecl *, 2> FoundDecls;
-  DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+  Importer.findDeclsInToContext(DC, Name, FoundDecls);
   for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
     if (!FoundDecls[I]->isInIdentifierNamespace(Decl::IDNS_Ordinary))
       continue;
@@ -4191,7 +4245,7 @@ Decl *ASTNodeImporter::VisitObjCPropertyDecl(ObjCPropertyDecl *D) {
 
   // Check whether we have already imported this property.
   SmallVector<NamedDecl *, 2> FoundDecls;
-  DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+  Importer.findDeclsInToContext(DC, Name, FoundDecls);
   for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
     if (ObjCPropertyDecl *FoundProp
                                 = dyn_cast<ObjCPropertyDecl>(FoundDecls[I])) {
@@ -4429,7 +4483,7 @@ Decl *ASTNodeImporter::VisitClassTemplateDecl(ClassTemplateDecl *D) {
   if (!DC->isFunctionOrMethod()) {
     SmallVector<NamedDecl *, 4> ConflictingDecls;
     SmallVector<NamedDecl *, 2> FoundDecls;
-    DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+    Importer.findDeclsInToContext(DC, Name, FoundDecls);
     for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
       if (!FoundDecls[I]->isInIdentifierNamespace(Decl::IDNS_Ordinary))
         continue;
@@ -4620,7 +4674,7 @@ Decl *ASTNodeImporter::VisitVarTemplateDecl(VarTemplateDecl *D) {
          "Variable templates cannot be declared at function scope");
   SmallVector<NamedDecl *, 4> ConflictingDecls;
   SmallVector<NamedDecl *, 2> FoundDecls;
-  DC->getRedeclContext()->localUncachedLookup(Name, FoundDecls);
+  Importer.findDeclsInToContext(DC, Name, FoundDecls);
   for (unsigned I = 0, N = FoundDecls.size(); I != N; ++I) {
     if (!FoundDecls[I]->isInIdentifierNamespace(Decl::IDNS_Ordinary))
       continue;
@@ -5988,6 +6042,25 @@ Expr *ASTNodeImporter::VisitInitListExpr(InitListExpr *ILE) {
   return To;
 }
 
+Expr *ASTNodeImporter::VisitPackedArrayInitExpr(PackedArrayInitExpr *E) {
+  QualType T = Importer.Import(E->getType());
+  if (T.isNull())
+    return nullptr;
+
+  InitListExpr *ToSyntForm =
+      cast_or_null<InitListExpr>(Importer.Import(E->getSyntacticForm()));
+  if (!ToSyntForm)
+    return nullptr;
+
+  PackedArrayInitExpr *To = PackedArrayInitExpr::CreateEmpty(
+      Importer.getToContext(), E->getNumElements(), E->getElementSize());
+  To->setType(T);
+  To->setSyntacticForm(ToSyntForm);
+  for (unsigned I = 0, N = E->getNumElements(); I != N; ++I)
+    To->setElement(I, E->getElement(I));
+  return To;
+}
+
 Expr *ASTNodeImporter::VisitCXXDefaultInitExpr(CXXDefaultInitExpr *DIE) {
   FieldDecl *ToField = llvm::dyn_cast_or_null<FieldDecl>(
       Importer.Import(DIE->getField()));
@@ -6045,6 +6118,63 @@ ASTImporter::ASTImporter(ASTContext &ToContext, FileManager &ToFileManager,
 
 ASTImporter::~ASTImporter() { }
 
+void ASTImporter::findDeclsInToContext(DeclContext *DC, DeclarationName Name,
+                                       SmallVectorImpl<NamedDecl *> &Results) {
+  DC = DC->getRedeclContext();
+  if (!DC->hasExternalVisibleStorage() && !DC->hasExternalLexicalStorage()) {
+    DC->localUncachedLookup(Name, Results);
+    return;
+  }
+
+  Results.clear();
+
+  // Declarations already in the lookup table, which may include ones that
+  // were only loaded from external storage.
+  if (StoredDeclsMap *Map = DC->getLookupPtr()) {
+    StoredDeclsMap::iterator Pos = Map->find(Name);
+    if (Pos != Map->end())
+      Results.append(Pos->second.getLookupResult().begin(),
+                     Pos->second.getLookupResult().end());
+  }
+
+  LexicalLookupTable &Table = LookupTables[DC];
+  auto AddToTable = [&Table](Decl *D) {
+    if (NamedDecl *ND = dyn_cast<NamedDecl>(D))
+      Table.Decls[ND->getDeclName()].push_back(ND);
+  };
+
+  // Declarations loaded from external lexical storage since the last lookup
+  // were spliced in front of the ones already indexed.
+  Decl *First = *DC->noload_decls_begin();
+  if (Table.FirstIndexed && First != Table.FirstIndexed) {
+    Decl *D = First;
+    for (; D && D != Table.FirstIndexed; D = D->getNextDeclInContext())
+      AddToTable(D);
+    if (!D) {
+      // The chain no longer starts with what was indexed; start over.
+      Table.Decls.clear();
+      Table.LastIndexed = nullptr;
+    }
+  }
+  Table.FirstIndexed = First;
+
+  // Index the declarations added to the end of the context since the last
+  // lookup.
+  Decl *Next = Table.LastIndexed ? Table.LastIndexed->getNextDeclInContext()
+                                 : First;
+  for (Decl *D = Next; D; D = D->getNextDeclInContext()) {
+    Table.LastIndexed = D;
+    AddToTable(D);
+  }
+
+  auto Found = Table.Decls.find(Name);
+  if (Found == Table.Decls.end())
+    return;
+  for (NamedDecl *ND : Found->second)
+    if (std::find(Results.begin(), Results.end(), ND) == Results.end())
+      Results.push_back(ND);
+}
+
 QualType ASTImporter::Import(QualType FromT) {
   if (FromT.isNull())
     return QualType();
@@ -6693,6 +6823,6 @@ bool ASTImporter::IsStructurallyEquivalent(QualType From, QualType To,
     return true;
       
   StructuralEquivalenceContext Ctx(FromContext, ToContext, NonEquivalentDecls,
-                                   false, Complain);
+                                   EquivalentDecls, false, Complain);
   return Ctx.IsStructurallyEquivalent(From, To);
 }
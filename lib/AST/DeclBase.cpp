@@ -1363,6 +1363,20 @@ StoredDeclsMap *DeclContext::buildLookup() {
       return LookupPtr;
   }
 
+  // Size the table for the local declarations up front, so that it is not
+  // rehashed repeatedly while they are inserted.
+  unsigned NumLocalDecls = 0;
+  for (auto *DC : Contexts)
+    for (Decl *D : DC->noload_decls())
+      if (isa<NamedDecl>(D) && !D->isFromASTFile())
+        ++NumLocalDecls;
+  if (NumLocalDecls) {
+    StoredDeclsMap *Map = LookupPtr;
+    if (!Map)
+      Map = CreateStoredDeclsMap(getParentASTContext());
+    Map->reserve(Map->size() + NumLocalDecls);
+  }
+
   for (auto *DC : Contexts)
     buildLookupImpl(DC, hasExternalVisibleStorage());
 
@@ -54,9 +54,11 @@ CXXRecordDecl::DefinitionData::DefinitionData(CXXRecordDecl *D)
       HasOnlyCMembers(true), HasInClassInitializer(false),
       HasUninitializedReferenceMember(false), HasUninitializedFields(false),
       HasInheritedConstructor(false), HasInheritedAssignment(false),
+      NeedOverloadResolutionForCopyConstructor(false),
       NeedOverloadResolutionForMoveConstructor(false),
       NeedOverloadResolutionForMoveAssignment(false),
       NeedOverloadResolutionForDestructor(false),
+      DefaultedCopyConstructorIsDeleted(false),
       DefaultedMoveConstructorIsDeleted(false),
       DefaultedMoveAssignmentIsDeleted(false),
       DefaultedDestructorIsDeleted(false), HasTrivialSpecialMembers(SMF_All),
@@ -378,6 +380,8 @@ void CXXRecordDecl::addedClassSubobject(CXXRecordDecl *Subobj) {
   //    -- a direct or virtual base class B that cannot be copied/moved [...]
   //    -- a non-static data member of class type M (or array thereof)
   //       that cannot be copied or moved [...]
+  if (!Subobj->hasSimpleCopyConstructor())
+    data().NeedOverloadResolutionForCopyConstructor = true;
   if (!Subobj->hasSimpleMoveConstructor())
     data().NeedOverloadResolutionForMoveConstructor = true;
 
@@ -398,6 +402,7 @@ void CXXRecordDecl::addedClassSubobject(CXXRecordDecl *Subobj) {
   //    -- any non-static data member has a type with a destructor
   //       that is deleted or inaccessible from the defaulted [ctor or dtor].
   if (!Subobj->hasSimpleDestructor()) {
+    data().NeedOverloadResolutionForCopyConstructor = true;
     data().NeedOverloadResolutionForMoveConstructor = true;
     data().NeedOverloadResolutionForDestructor = true;
   }
@@ -781,14 +786,38 @@ void CXXRecordDecl::addedMember(Decl *D) {
     if (T->isReferenceType())
       data().DefaultedMoveAssignmentIsDeleted = true;
 
+    // C++11 [class.copy]p11:
+    //   A defaulted copy/move constructor for a class X is defined as
+    //   deleted if X has:
+    //    -- for the copy constructor, a non-static data member of rvalue
+    //       reference type
+    if (T->isRValueReferenceType())
+      data().DefaultedCopyConstructorIsDeleted = true;
+
     if (const RecordType *RecordTy = T->getAs<RecordType>()) {
       CXXRecordDecl* FieldRec = cast<CXXRecordDecl>(RecordTy->getDecl());
       if (FieldRec->getDefinition()) {
         addedClassSubobject(FieldRec);
 
+        // The copy and move special members of an anonymous struct or union
+        // are never checked for deletion, so its members may need overload
+        // resolution in the context of this class instead.
+        if (FieldRec->isAnonymousStructOrUnion()) {
+          if (FieldRec->data().NeedOverloadResolutionForCopyConstructor)
+            data().NeedOverloadResolutionForCopyConstructor = true;
+          if (FieldRec->data().NeedOverloadResolutionForMoveConstructor)
+            data().NeedOverloadResolutionForMoveConstructor = true;
+          if (FieldRec->data().NeedOverloadResolutionForMoveAssignment)
+            data().NeedOverloadResolutionForMoveAssignment = true;
+          if (FieldRec->data().NeedOverloadResolutionForDestructor)
+            data().NeedOverloadResolutionForDestructor = true;
+        }
+
         // We may need to perform overload resolution to determine whether a
-        // field can be moved if it's const or volatile qualified.
+        // field can be copied or moved if it's const or volatile qualified;
+        // an implicit copy constructor might take a non-const parameter.
         if (T.getCVRQualifiers() & (Qualifiers::Const | Qualifiers::Volatile)) {
+          data().NeedOverloadResolutionForCopyConstructor = true;
           data().NeedOverloadResolutionForMoveConstructor = true;
           data().NeedOverloadResolutionForMoveAssignment = true;
         }
@@ -799,6 +828,8 @@ void CXXRecordDecl::addedMember(Decl *D) {
         //    -- X is a union-like class that has a variant member with a
         //       non-trivial [corresponding special member]
         if (isUnion()) {
+          if (FieldRec->hasNonTrivialCopyConstructor())
+            data().DefaultedCopyConstructorIsDeleted = true;
           if (FieldRec->hasNonTrivialMoveConstructor())
             data().DefaultedMoveConstructorIsDeleted = true;
           if (FieldRec->hasNonTrivialMoveAssignment())
@@ -404,6 +404,7 @@ DeclRefExpr *DeclRefExpr::Create(const ASTContext &Context,
           TemplateArgs ? TemplateArgs->size() : 0);
 
   void *Mem = Context.Allocate(Size, llvm::alignOf<DeclRefExpr>());
+  addStmtExtraBytes(DeclRefExprClass, Size - sizeof(DeclRefExpr));
   return new (Mem) DeclRefExpr(Context, QualifierLoc, TemplateKWLoc, D,
                                RefersToEnclosingVariableOrCapture,
                                NameInfo, FoundD, TemplateArgs, T, VK);
@@ -421,6 +422,7 @@ DeclRefExpr *DeclRefExpr::CreateEmpty(const ASTContext &Context,
           HasQualifier ? 1 : 0, HasFoundDecl ? 1 : 0, HasTemplateKWAndArgsInfo,
           NumTemplateArgs);
   void *Mem = Context.Allocate(Size, llvm::alignOf<DeclRefExpr>());
+  addStmtExtraBytes(DeclRefExprClass, Size - sizeof(DeclRefExpr));
   return new (Mem) DeclRefExpr(EmptyShell());
 }
 
@@ -1136,6 +1138,8 @@ CallExpr::CallExpr(const ASTContext &C, StmtClass SC, Expr *fn,
 
   unsigned NumPreArgs = preargs.size();
   SubExprs = new (C) Stmt *[args.size()+PREARGS_START+NumPreArgs];
+  addStmtExtraBytes(SC, (args.size() + PREARGS_START + NumPreArgs) *
+                            sizeof(Stmt *));
   SubExprs[FN] = fn;
   for (unsigned i = 0; i != NumPreArgs; ++i) {
     updateDependenciesFromArg(preargs[i]);
@@ -1166,8 +1170,8 @@ CallExpr::CallExpr(const ASTContext &C, StmtClass SC, EmptyShell Empty)
 CallExpr::CallExpr(const ASTContext &C, StmtClass SC, unsigned NumPreArgs,
                    EmptyShell Empty)
   : Expr(SC, Empty), SubExprs(nullptr), NumArgs(0) {
-  // FIXME: Why do we allocate this?
-  SubExprs = new (C) Stmt*[PREARGS_START+NumPreArgs]();
+  // The operands are allocated by the first setNumArgs(), once the number of
+  // arguments is known.
   CallExprBits.NumPreArgs = NumPreArgs;
 }
 
@@ -1214,24 +1218,24 @@ FunctionDecl *CallExpr::getDirectCallee() {
 /// Any orphaned expressions are deleted by this, and any new operands are set
 /// to null.
 void CallExpr::setNumArgs(const ASTContext& C, unsigned NumArgs) {
-  // No change, just return.
-  if (NumArgs == getNumArgs()) return;
-
   // If shrinking # arguments, just delete the extras and forgot them.
-  if (NumArgs < getNumArgs()) {
+  if (SubExprs && NumArgs <= getNumArgs()) {
     this->NumArgs = NumArgs;
     return;
   }
 
-  // Otherwise, we are growing the # arguments.  New an bigger argument array.
+  // Otherwise, we are growing the # arguments, or this is an empty call
+  // expression being filled in.  New an bigger argument array.
   unsigned NumPreArgs = getNumPreArgs();
   Stmt **NewSubExprs = new (C) Stmt*[NumArgs+PREARGS_START+NumPreArgs];
+  addStmtExtraBytes(getStmtClass(),
+                    (NumArgs + PREARGS_START + NumPreArgs) * sizeof(Stmt *));
   // Copy over args.
-  for (unsigned i = 0; i != getNumArgs()+PREARGS_START+NumPreArgs; ++i)
+  unsigned NumOld = SubExprs ? getNumArgs()+PREARGS_START+NumPreArgs : 0;
+  for (unsigned i = 0; i != NumOld; ++i)
     NewSubExprs[i] = SubExprs[i];
   // Null out new args.
-  for (unsigned i = getNumArgs()+PREARGS_START+NumPreArgs;
-       i != NumArgs+PREARGS_START+NumPreArgs; ++i)
+  for (unsigned i = NumOld; i != NumArgs+PREARGS_START+NumPreArgs; ++i)
     NewSubExprs[i] = nullptr;
 
   if (SubExprs) C.Deallocate(SubExprs);
@@ -1866,6 +1870,129 @@ SourceLocation InitListExpr::getLocEnd() const {
   return End;
 }
 
+/// Lists shorter than this are left as InitListExprs; they are cheap anyway,
+/// and clients that look at the semantic form of small tables still see it.
+static const unsigned MinPackedArrayInitElements = 64;
+
+/// Retrieve the value of a packable array element: an integer literal, or
+/// the negation of a signed integer literal when the element type is signed.
+/// The value must convert to the element type unchanged, so there is nothing
+/// to diagnose about the conversion.
+static bool getPackableElement(const Expr *E, bool IsSigned, unsigned Width,
+                               uint64_t &Value) {
+  E = E->IgnoreParens();
+  bool Negate = false;
+  if (const UnaryOperator *UO = dyn_cast<UnaryOperator>(E)) {
+    if (!IsSigned || UO->getOpcode() != UO_Minus)
+      return false;
+    E = UO->getSubExpr()->IgnoreParens();
+    Negate = true;
+  }
+
+  const IntegerLiteral *Lit = dyn_cast<IntegerLiteral>(E);
+  if (!Lit || Lit->getValue().getActiveBits() > Width - IsSigned)
+    return false;
+  if (Negate && !Lit->getType()->isSignedIntegerType())
+    return false;
+
+  Value = Lit->getValue().getZExtValue();
+  if (Negate)
+    Value = -Value;
+  return true;
+}
+
+bool PackedArrayInitExpr::isPackable(const ASTContext &C, QualType Ty,
+                                     const InitListExpr *ILE) {
+  unsigned NumInits = ILE->getNumInits();
+  if (NumInits < MinPackedArrayInitElements || ILE->isTypeDependent() ||
+      ILE->isValueDependent())
+    return false;
+
+  const ArrayType *AT = C.getAsArrayType(Ty);
+  if (!AT)
+    return false;
+  if (const ConstantArrayType *CAT = dyn_cast<ConstantArrayType>(AT)) {
+    if (CAT->getSize().ult(NumInits))
+      return false;
+  } else if (!isa<IncompleteArrayType>(AT)) {
+    return false;
+  }
+
+  QualType ElementTy = AT->getElementType();
+  if (!ElementTy->isIntegerType() || ElementTy->isBooleanType() ||
+      ElementTy->isEnumeralType())
+    return false;
+  uint64_t Width = C.getTypeSize(ElementTy);
+  if (Width != 8 && Width != 16 && Width != 32 && Width != 64)
+    return false;
+
+  bool IsSigned = ElementTy->isSignedIntegerType();
+  uint64_t Value;
+  for (unsigned I = 0; I != NumInits; ++I)
+    if (!getPackableElement(ILE->getInit(I), IsSigned, Width, Value))
+      return false;
+  return true;
+}
+
+PackedArrayInitExpr *PackedArrayInitExpr::Create(const ASTContext &C,
+                                                 QualType Ty,
+                                                 InitListExpr *SyntacticForm) {
+  assert(isPackable(C, Ty, SyntacticForm) && "initializer cannot be packed");
+  assert(C.getAsConstantArrayType(Ty) && "array bound must be known");
+  unsigned NumElements = SyntacticForm->getNumInits();
+  QualType ElementTy = C.getAsArrayType(Ty)->getElementType();
+  unsigned ElementSize = C.getTypeSize(ElementTy) / 8;
+
+  PackedArrayInitExpr *E = CreateEmpty(C, NumElements, ElementSize);
+  E->setType(Ty);
+  E->SyntacticForm = SyntacticForm;
+  E->setElementsFromSyntacticForm();
+  return E;
+}
+
+void PackedArrayInitExpr::setElementsFromSyntacticForm() {
+  const InitListExpr *ILE = getSyntacticForm();
+  assert(ILE && ILE->getNumInits() == NumElements &&
+         "syntactic form does not match the packed values");
+  bool IsSigned = getElementType()->isSignedIntegerType();
+  for (unsigned I = 0; I != NumElements; ++I) {
+    uint64_t Value = 0;
+    getPackableElement(ILE->getInit(I), IsSigned, ElementSize * 8, Value);
+    setElement(I, Value);
+  }
+}
+
+PackedArrayInitExpr *PackedArrayInitExpr::CreateEmpty(const ASTContext &C,
+                                                      unsigned NumElements,
+                                                      unsigned ElementSize) {
+  char *Data = static_cast<char *>(C.Allocate(NumElements * ElementSize, 8));
+  return new (C) PackedArrayInitExpr(QualType(), nullptr, Data, NumElements,
+                                     ElementSize);
+}
+
+uint64_t PackedArrayInitExpr::getElement(unsigned I) const {
+  assert(I < NumElements && "packed element out of range");
+  switch (ElementSize) {
+  case 1: { uint8_t V; memcpy(&V, Data + I, 1); return V; }
+  case 2: { uint16_t V; memcpy(&V, Data + 2 * I, 2); return V; }
+  case 4: { uint32_t V; memcpy(&V, Data + 4 * I, 4); return V; }
+  case 8: { uint64_t V; memcpy(&V, Data + 8 * I, 8); return V; }
+  }
+  llvm_unreachable("unexpected packed element size");
+}
+
+void PackedArrayInitExpr::setElement(unsigned I, uint64_t Value) {
+  assert(I < NumElements && "packed element out of range");
+  char *Storage = const_cast<char *>(Data);
+  switch (ElementSize) {
+  case 1: { uint8_t V = Value; memcpy(Storage + I, &V, 1); return; }
+  case 2: { uint16_t V = Value; memcpy(Storage + 2 * I, &V, 2); return; }
+  case 4: { uint32_t V = Value; memcpy(Storage + 4 * I, &V, 4); return; }
+  case 8: memcpy(Storage + 8 * I, &Value, 8); return;
+  }
+  llvm_unreachable("unexpected packed element size");
+}
+
 /// getFunctionType - Return the underlying function type for this block.
 ///
 const FunctionProtoType *BlockExpr::getFunctionType() const {
@@ -2711,6 +2838,7 @@ bool Expr::isConstantInitializer(ASTContext &Ctx, bool IsForRef,
   }
   case ImplicitValueInitExprClass:
   case NoInitExprClass:
+  case PackedArrayInitExprClass:
     return true;
   case ParenExprClass:
     return cast<ParenExpr>(this)->getSubExpr()
@@ -2844,6 +2972,7 @@ bool Expr::HasSideEffects(const ASTContext &Ctx,
   case AddrLabelExprClass:
   case GNUNullExprClass:
   case NoInitExprClass:
+  case PackedArrayInitExprClass:
   case CXXBoolLiteralExprClass:
   case CXXNullPtrLiteralExprClass:
   case CXXThisExprClass:
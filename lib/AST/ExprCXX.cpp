@@ -737,6 +737,33 @@ CXXTemporaryObjectExpr::CXXTemporaryObjectExpr(const ASTContext &C,
     Type(Type) {
 }
 
+CXXTemporaryObjectExpr *
+CXXTemporaryObjectExpr::Create(const ASTContext &C, CXXConstructorDecl *Cons,
+                               TypeSourceInfo *Type, ArrayRef<Expr *> Args,
+                               SourceRange ParenOrBraceRange,
+                               bool HadMultipleCandidates,
+                               bool ListInitialization,
+                               bool StdInitListInitialization,
+                               bool ZeroInitialization) {
+  void *Mem = C.Allocate(sizeof(CXXTemporaryObjectExpr) +
+                             Args.size() * sizeof(Stmt *),
+                         llvm::alignOf<CXXTemporaryObjectExpr>());
+  return new (Mem) CXXTemporaryObjectExpr(C, Cons, Type, Args,
+                                          ParenOrBraceRange,
+                                          HadMultipleCandidates,
+                                          ListInitialization,
+                                          StdInitListInitialization,
+                                          ZeroInitialization);
+}
+
+CXXTemporaryObjectExpr *
+CXXTemporaryObjectExpr::CreateEmpty(const ASTContext &C, unsigned NumArgs) {
+  void *Mem = C.Allocate(sizeof(CXXTemporaryObjectExpr) +
+                             NumArgs * sizeof(Stmt *),
+                         llvm::alignOf<CXXTemporaryObjectExpr>());
+  return new (Mem) CXXTemporaryObjectExpr(EmptyShell(), NumArgs);
+}
+
 SourceLocation CXXTemporaryObjectExpr::getLocStart() const {
   return Type->getTypeLoc().getBeginLoc();
 }
@@ -759,12 +786,23 @@ CXXConstructExpr *CXXConstructExpr::Create(const ASTContext &C, QualType T,
                                            bool ZeroInitialization,
                                            ConstructionKind ConstructKind,
                                            SourceRange ParenOrBraceRange) {
-  return new (C) CXXConstructExpr(C, CXXConstructExprClass, T, Loc,
-                                  Ctor, Elidable, Args,
-                                  HadMultipleCandidates, ListInitialization,
-                                  StdInitListInitialization,
-                                  ZeroInitialization, ConstructKind,
-                                  ParenOrBraceRange);
+  void *Mem = C.Allocate(sizeof(CXXConstructExpr) +
+                             Args.size() * sizeof(Stmt *),
+                         llvm::alignOf<CXXConstructExpr>());
+  return new (Mem) CXXConstructExpr(C, CXXConstructExprClass, T, Loc,
+                                    Ctor, Elidable, Args,
+                                    HadMultipleCandidates, ListInitialization,
+                                    StdInitListInitialization,
+                                    ZeroInitialization, ConstructKind,
+                                    ParenOrBraceRange);
+}
+
+CXXConstructExpr *CXXConstructExpr::CreateEmpty(const ASTContext &C,
+                                                unsigned NumArgs) {
+  void *Mem = C.Allocate(sizeof(CXXConstructExpr) + NumArgs * sizeof(Stmt *),
+                         llvm::alignOf<CXXConstructExpr>());
+  return new (Mem) CXXConstructExpr(CXXConstructExprClass, EmptyShell(),
+                                    NumArgs);
 }
 
 CXXConstructExpr::CXXConstructExpr(const ASTContext &C, StmtClass SC,
@@ -788,24 +826,34 @@ CXXConstructExpr::CXXConstructExpr(const ASTContext &C, StmtClass SC,
     ListInitialization(ListInitialization),
     StdInitListInitialization(StdInitListInitialization),
     ZeroInitialization(ZeroInitialization),
-    ConstructKind(ConstructKind), Args(nullptr)
+    ConstructKind(ConstructKind)
 {
-  if (NumArgs) {
-    this->Args = new (C) Stmt*[Args.size()];
-    
-    for (unsigned i = 0; i != Args.size(); ++i) {
-      assert(Args[i] && "NULL argument in CXXConstructExpr");
+  assert(NumArgs == Args.size() && "too many arguments for CXXConstructExpr");
+  Stmt **TrailingArgs = getTrailingArgs();
+  for (unsigned i = 0; i != Args.size(); ++i) {
+    assert(Args[i] && "NULL argument in CXXConstructExpr");
 
-      if (Args[i]->isValueDependent())
-        ExprBits.ValueDependent = true;
-      if (Args[i]->isInstantiationDependent())
-        ExprBits.InstantiationDependent = true;
-      if (Args[i]->containsUnexpandedParameterPack())
-        ExprBits.ContainsUnexpandedParameterPack = true;
-  
-      this->Args[i] = Args[i];
-    }
+    if (Args[i]->isValueDependent())
+      ExprBits.ValueDependent = true;
+    if (Args[i]->isInstantiationDependent())
+      ExprBits.InstantiationDependent = true;
+    if (Args[i]->containsUnexpandedParameterPack())
+      ExprBits.ContainsUnexpandedParameterPack = true;
+
+    TrailingArgs[i] = Args[i];
   }
+  addStmtExtraBytes(SC, NumArgs * sizeof(Stmt *));
+}
+
+CXXConstructExpr::CXXConstructExpr(StmtClass SC, EmptyShell Empty,
+                                   unsigned NumArgs)
+  : Expr(SC, Empty), Constructor(nullptr), NumArgs(NumArgs), Elidable(false),
+    HadMultipleCandidates(false), ListInitialization(false),
+    StdInitListInitialization(false), ZeroInitialization(false),
+    ConstructKind(0)
+{
+  assert(this->NumArgs == NumArgs && "too many arguments for CXXConstructExpr");
+  addStmtExtraBytes(SC, NumArgs * sizeof(Stmt *));
 }
 
 LambdaCapture::LambdaCapture(SourceLocation Loc, bool Implicit,
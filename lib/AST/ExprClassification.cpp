@@ -187,6 +187,7 @@ static Cl::Kinds ClassifyInternal(ASTContext &Ctx, const Expr *E) {
   case Expr::CXXFoldExprClass:
   case Expr::NoInitExprClass:
   case Expr::DesignatedInitUpdateExprClass:
+  case Expr::PackedArrayInitExprClass:
   case Expr::CoyieldExprClass:
     return Cl::CL_PRValue;
 
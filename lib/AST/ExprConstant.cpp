@@ -45,6 +45,7 @@
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/TargetInfo.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstring>
 #include <functional>
@@ -462,6 +463,10 @@ namespace {
     /// evaluation frame.
     llvm::SmallVector<Cleanup, 16> CleanupStack;
 
+    /// MemoizedCalls - The results of the calls evaluated so far whose value
+    /// only depends on their arguments, keyed by getMemoizedCallKey.
+    llvm::StringMap<APValue> MemoizedCalls;
+
     /// EvaluatingDecl - This is the declaration whose initializer is being
     /// evaluated, if any.
     APValue::LValueBase EvaluatingDecl;
@@ -3938,6 +3943,96 @@ static bool EvaluateArgs(ArrayRef<const Expr*> Args, ArgVector &ArgValues,
   return Success;
 }
 
+/// Append the value \p V to the memoized call key \p Key. Returns false if
+/// the value refers to an object, through a pointer, reference or member
+/// pointer, or is not fully initialized.
+static bool addMemoizedCallKey(const APValue &V, SmallVectorImpl<char> &Key) {
+  auto AddWord = [&](uint64_t Word) {
+    Key.append(reinterpret_cast<const char *>(&Word),
+               reinterpret_cast<const char *>(&Word + 1));
+  };
+  auto AddInt = [&](const APSInt &Int) {
+    AddWord(Int.isUnsigned());
+    AddWord(Int.getBitWidth());
+    for (unsigned I = 0, N = Int.getNumWords(); I != N; ++I)
+      AddWord(Int.getRawData()[I]);
+  };
+  auto AddFloat = [&](const APFloat &Float) {
+    llvm::APInt Bits = Float.bitcastToAPInt();
+    AddWord(reinterpret_cast<uintptr_t>(&Float.getSemantics()));
+    for (unsigned I = 0, N = Bits.getNumWords(); I != N; ++I)
+      AddWord(Bits.getRawData()[I]);
+  };
+
+  AddWord(V.getKind());
+  switch (V.getKind()) {
+  case APValue::Int:
+    AddInt(V.getInt());
+    return true;
+  case APValue::Float:
+    AddFloat(V.getFloat());
+    return true;
+  case APValue::ComplexInt:
+    AddInt(V.getComplexIntReal());
+    AddInt(V.getComplexIntImag());
+    return true;
+  case APValue::ComplexFloat:
+    AddFloat(V.getComplexFloatReal());
+    AddFloat(V.getComplexFloatImag());
+    return true;
+  case APValue::Vector:
+    AddWord(V.getVectorLength());
+    for (unsigned I = 0, N = V.getVectorLength(); I != N; ++I)
+      if (!addMemoizedCallKey(V.getVectorElt(I), Key))
+        return false;
+    return true;
+  case APValue::Array:
+    AddWord(V.getArraySize());
+    AddWord(V.getArrayInitializedElts());
+    for (unsigned I = 0, N = V.getArrayInitializedElts(); I != N; ++I)
+      if (!addMemoizedCallKey(V.getArrayInitializedElt(I), Key))
+        return false;
+    return !V.hasArrayFiller() || addMemoizedCallKey(V.getArrayFiller(), Key);
+  case APValue::Struct:
+    for (unsigned I = 0, N = V.getStructNumBases(); I != N; ++I)
+      if (!addMemoizedCallKey(V.getStructBase(I), Key))
+        return false;
+    for (unsigned I = 0, N = V.getStructNumFields(); I != N; ++I)
+      if (!addMemoizedCallKey(V.getStructField(I), Key))
+        return false;
+    return true;
+  case APValue::Union:
+    AddWord(reinterpret_cast<uintptr_t>(V.getUnionField()));
+    return !V.getUnionField() || addMemoizedCallKey(V.getUnionValue(), Key);
+  case APValue::Uninitialized:
+  case APValue::LValue:
+  case APValue::MemberPointer:
+  case APValue::AddrLabelDiff:
+    return false;
+  }
+  llvm_unreachable("unknown APValue kind");
+}
+
+/// Build the key under which the result of calling \p Callee with \p Args is
+/// memoized. Only calls of non-member functions whose arguments hold values,
+/// such as integers, floating-point numbers and aggregates of them, are
+/// memoized: such a call can neither observe nor modify any object created
+/// outside of it, so its result only depends on its arguments.
+static bool getMemoizedCallKey(const FunctionDecl *Callee,
+                               ArrayRef<APValue> Args,
+                               SmallVectorImpl<char> &Key) {
+  if (Callee->getReturnType()->isVoidType())
+    return false;
+
+  uint64_t CalleeWord = reinterpret_cast<uintptr_t>(Callee->getCanonicalDecl());
+  Key.append(reinterpret_cast<const char *>(&CalleeWord),
+             reinterpret_cast<const char *>(&CalleeWord + 1));
+  for (const APValue &Arg : Args)
+    if (!addMemoizedCallKey(Arg, Key))
+      return false;
+  return true;
+}
+
 /// Evaluate a function call.
 static bool HandleFunctionCall(SourceLocation CallLoc,
                                const FunctionDecl *Callee, const LValue *This,
@@ -3948,6 +4043,21 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
   if (!EvaluateArgs(Args, ArgValues, Info))
     return false;
 
+  // Reuse the result of an identical earlier call, so that recursive
+  // functions such as compile-time hashes don't redo the same work. The steps
+  // of the body are only counted against the step limit the first time.
+  SmallString<64> CallKey;
+  bool Memoize = Info.getLangOpts().ConstexprMemoizeCalls && !This &&
+                 !Info.checkingPotentialConstantExpression() &&
+                 getMemoizedCallKey(Callee, ArgValues, CallKey);
+  if (Memoize) {
+    auto Known = Info.MemoizedCalls.find(CallKey);
+    if (Known != Info.MemoizedCalls.end()) {
+      Result = Known->second;
+      return true;
+    }
+  }
+
   if (!Info.CheckCallLimit(CallLoc))
     return false;
 
@@ -3978,6 +4088,12 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
     return true;
   }
 
+  // Only memoize calls which didn't produce any note or side effect, as a
+  // later identical call must be just as much of a constant expression.
+  bool HadSideEffects = Info.EvalStatus.HasSideEffects;
+  bool HadUndefinedBehavior = Info.EvalStatus.HasUndefinedBehavior;
+  unsigned NumNotes = Info.EvalStatus.Diag ? Info.EvalStatus.Diag->size() : 0;
+
   StmtResult Ret = {Result, ResultSlot};
   EvalStmtResult ESR = EvaluateStmt(Ret, Info, Body);
   if (ESR == ESR_Succeeded) {
@@ -3985,7 +4101,17 @@ static bool HandleFunctionCall(SourceLocation CallLoc,
       return true;
     Info.FFDiag(Callee->getLocEnd(), diag::note_constexpr_no_return);
   }
-  return ESR == ESR_Returned;
+  if (ESR != ESR_Returned)
+    return false;
+
+  // A result that refers to an object cannot be reused either.
+  SmallString<64> ResultKey;
+  if (Memoize && addMemoizedCallKey(Result, ResultKey) &&
+      Info.EvalStatus.HasSideEffects == HadSideEffects &&
+      Info.EvalStatus.HasUndefinedBehavior == HadUndefinedBehavior &&
+      (!Info.EvalStatus.Diag || Info.EvalStatus.Diag->size() == NumNotes))
+    Info.MemoizedCalls[CallKey] = Result;
+  return true;
 }
 
 /// Evaluate a constructor call.
@@ -6046,6 +6172,7 @@ namespace {
       return handleCallExpr(E, Result, &This);
     }
     bool VisitInitListExpr(const InitListExpr *E);
+    bool VisitPackedArrayInitExpr(const PackedArrayInitExpr *E);
     bool VisitCXXConstructExpr(const CXXConstructExpr *E);
     bool VisitCXXConstructExpr(const CXXConstructExpr *E,
                                const LValue &Subobject,
@@ -6128,6 +6255,26 @@ bool ArrayExprEvaluator::VisitInitListExpr(const InitListExpr *E) {
                          FillerExpr) && Success;
 }
 
+bool ArrayExprEvaluator::VisitPackedArrayInitExpr(
+    const PackedArrayInitExpr *E) {
+  const ConstantArrayType *CAT = Info.Ctx.getAsConstantArrayType(E->getType());
+  if (!CAT)
+    return Error(E);
+
+  QualType ElementTy = E->getElementType();
+  unsigned BitWidth = Info.Ctx.getIntWidth(ElementTy);
+  bool IsUnsigned = ElementTy->isUnsignedIntegerType();
+  unsigned NumElts = E->getNumElements();
+  Result = APValue(APValue::UninitArray(), NumElts,
+                   CAT->getSize().getZExtValue());
+  for (unsigned I = 0; I != NumElts; ++I)
+    Result.getArrayInitializedElt(I) =
+        APValue(APSInt(APInt(BitWidth, E->getElement(I)), IsUnsigned));
+  if (Result.hasArrayFiller())
+    Result.getArrayFiller() = APValue(Info.Ctx.MakeIntValue(0, ElementTy));
+  return true;
+}
+
 bool ArrayExprEvaluator::VisitCXXConstructExpr(const CXXConstructExpr *E) {
   return VisitCXXConstructExpr(E, This, &Result, E->getType());
 }
@@ -9359,6 +9506,7 @@ static ICEDiag CheckICE(const Expr* E, const ASTContext &Ctx) {
   case Expr::DesignatedInitExprClass:
   case Expr::NoInitExprClass:
   case Expr::DesignatedInitUpdateExprClass:
+  case Expr::PackedArrayInitExprClass:
   case Expr::ImplicitValueInitExprClass:
   case Expr::ParenListExprClass:
   case Expr::VAArgExprClass:
@@ -29,6 +29,7 @@
 #include "clang/Basic/ABI.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
@@ -128,6 +129,18 @@ class ItaniumMangleContextImpl : public ItaniumMangleContext {
   llvm::DenseMap<DiscriminatorKeyTy, unsigned> Discriminator;
   llvm::DenseMap<const NamedDecl*, unsigned> Uniquifier;
 
+  /// The names of the declarations mangled so far, by declaration and
+  /// structor type (one more than the ctor or dtor type, zero for anything
+  /// else).
+  llvm::DenseMap<std::pair<const NamedDecl *, unsigned>, std::string>
+      MangledNames;
+
+  /// Writes the name of \p D to \p Out, mangling it with \p Mangle unless it
+  /// was mangled before.
+  void mangleCachedName(const NamedDecl *D, unsigned StructorType,
+                        raw_ostream &Out,
+                        llvm::function_ref<void(raw_ostream &)> Mangle);
+
 public:
   explicit ItaniumMangleContextImpl(ASTContext &Context,
                                     DiagnosticsEngine &Diags)
@@ -3210,6 +3223,7 @@ recurse:
   case Expr::DesignatedInitUpdateExprClass:
   case Expr::ImplicitValueInitExprClass:
   case Expr::NoInitExprClass:
+  case Expr::PackedArrayInitExprClass:
   case Expr::ParenListExprClass:
   case Expr::LambdaExprClass:
   case Expr::MSPropertyRefExprClass:
@@ -4468,22 +4482,52 @@ void ItaniumMangleContextImpl::mangleCXXName(const NamedDecl *D,
                                  getASTContext().getSourceManager(),
                                  "Mangling declaration");
 
-  CXXNameMangler Mangler(*this, Out, D);
-  Mangler.mangle(D);
+  mangleCachedName(D, 0, Out, [&](raw_ostream &NameOut) {
+    CXXNameMangler Mangler(*this, NameOut, D);
+    Mangler.mangle(D);
+  });
 }
 
 void ItaniumMangleContextImpl::mangleCXXCtor(const CXXConstructorDecl *D,
                                              CXXCtorType Type,
                                              raw_ostream &Out) {
-  CXXNameMangler Mangler(*this, Out, D, Type);
-  Mangler.mangle(D);
+  mangleCachedName(D, Type + 1, Out, [&](raw_ostream &NameOut) {
+    CXXNameMangler Mangler(*this, NameOut, D, Type);
+    Mangler.mangle(D);
+  });
 }
 
 void ItaniumMangleContextImpl::mangleCXXDtor(const CXXDestructorDecl *D,
                                              CXXDtorType Type,
                                              raw_ostream &Out) {
-  CXXNameMangler Mangler(*this, Out, D, Type);
-  Mangler.mangle(D);
+  mangleCachedName(D, Type + 1, Out, [&](raw_ostream &NameOut) {
+    CXXNameMangler Mangler(*this, NameOut, D, Type);
+    Mangler.mangle(D);
+  });
+}
+
+void ItaniumMangleContextImpl::mangleCachedName(
+    const NamedDecl *D, unsigned StructorType, raw_ostream &Out,
+    llvm::function_ref<void(raw_ostream &)> Mangle) {
+  // Entities local to a function are numbered as they are mangled and blocks
+  // as their functions are emitted, so don't remember their names.
+  if (D->getParentFunctionOrMethod()) {
+    Mangle(Out);
+    return;
+  }
+
+  auto Key = std::make_pair(D, StructorType);
+  auto Known = MangledNames.find(Key);
+  if (Known != MangledNames.end()) {
+    Out << Known->second;
+    return;
+  }
+
+  std::string Name;
+  llvm::raw_string_ostream NameOut(Name);
+  Mangle(NameOut);
+  Out << NameOut.str();
+  MangledNames[Key] = std::move(Name);
 }
 
 void ItaniumMangleContextImpl::mangleCXXCtorComdat(const CXXConstructorDecl *D,
@@ -281,6 +281,8 @@ void RawCommentList::addComment(const RawComment &RC,
     // If they are, just pop a few last comments that don't fit.
     // This happens if an \#include directive contains comments.
     Comments.pop_back();
+    if (Comments.size() < NumIndexedComments)
+      invalidateFileComments();
   }
 
   // Ordinary comments are not interesting for us.
@@ -333,5 +335,33 @@ void RawCommentList::addDeserializedComments(ArrayRef<RawComment *> Deserialized
              std::back_inserter(MergedComments),
              BeforeThanCompare<RawComment>(SourceMgr));
   std::swap(Comments, MergedComments);
+  invalidateFileComments();
+}
+
+ArrayRef<RawCommentList::CommentInFile>
+RawCommentList::getCommentsInFile(FileID File) const {
+  for (unsigned e = Comments.size(); NumIndexedComments != e;
+       ++NumIndexedComments) {
+    RawComment *C = Comments[NumIndexedComments];
+    std::pair<FileID, unsigned> Loc =
+        SourceMgr.getDecomposedLoc(C->getLocStart());
+    std::vector<CommentInFile> &InFile = FileComments[Loc.first];
+    // Comments of one file are added in order, but keep the index sorted
+    // anyway.
+    auto Pos = InFile.end();
+    if (!InFile.empty() && InFile.back().first >= Loc.second)
+      Pos = std::lower_bound(InFile.begin(), InFile.end(),
+                             CommentInFile(Loc.second, nullptr),
+                             [](const CommentInFile &LHS,
+                                const CommentInFile &RHS) {
+                               return LHS.first < RHS.first;
+                             });
+    InFile.insert(Pos, CommentInFile(Loc.second, C));
+  }
+
+  auto It = FileComments.find(File);
+  if (It == FileComments.end())
+    return None;
+  return It->second;
 }
 
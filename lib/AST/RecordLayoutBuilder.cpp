@@ -2942,7 +2942,13 @@ ASTContext::getASTRecordLayout(const RecordDecl *D) const {
 
   const ASTRecordLayout *NewEntry = nullptr;
 
-  if (isMsLayout(*this)) {
+  // A record from an AST file may have been laid out when the file was built.
+  if (D->isFromASTFile() && ExternalSource)
+    NewEntry = ExternalSource->getExternalRecordLayout(D);
+
+  if (NewEntry) {
+    // Reuse the layout from the AST file.
+  } else if (isMsLayout(*this)) {
     MicrosoftRecordLayoutBuilder Builder(*this);
     if (const auto *RD = dyn_cast<CXXRecordDecl>(D)) {
       Builder.cxxLayout(RD);
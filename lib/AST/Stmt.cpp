@@ -32,6 +32,7 @@ static struct StmtClassNameTable {
   const char *Name;
   unsigned Counter;
   unsigned Size;
+  size_t ExtraBytes;
 } StmtClassInfo[Stmt::lastStmtConstant+1];
 
 static StmtClassNameTable &getStmtInfoTableEntry(Stmt::StmtClass E) {
@@ -70,24 +71,33 @@ void Stmt::PrintStats() {
     sum += StmtClassInfo[i].Counter;
   }
   llvm::errs() << "  " << sum << " stmts/exprs total.\n";
-  sum = 0;
+  size_t bytes = 0;
   for (int i = 0; i != Stmt::lastStmtConstant+1; i++) {
     if (StmtClassInfo[i].Name == nullptr) continue;
     if (StmtClassInfo[i].Counter == 0) continue;
     llvm::errs() << "    " << StmtClassInfo[i].Counter << " "
                  << StmtClassInfo[i].Name << ", " << StmtClassInfo[i].Size
                  << " each (" << StmtClassInfo[i].Counter*StmtClassInfo[i].Size
-                 << " bytes)\n";
-    sum += StmtClassInfo[i].Counter*StmtClassInfo[i].Size;
+                 << " bytes";
+    if (StmtClassInfo[i].ExtraBytes)
+      llvm::errs() << " + " << StmtClassInfo[i].ExtraBytes << " extra bytes";
+    llvm::errs() << ")\n";
+    bytes += StmtClassInfo[i].Counter*StmtClassInfo[i].Size +
+             StmtClassInfo[i].ExtraBytes;
   }
 
-  llvm::errs() << "Total bytes = " << sum << "\n";
+  llvm::errs() << "Total bytes = " << bytes << "\n";
 }
 
 void Stmt::addStmtClass(StmtClass s) {
   ++getStmtInfoTableEntry(s).Counter;
 }
 
+void Stmt::addStmtExtraBytes(StmtClass s, size_t Bytes) {
+  if (StatisticsEnabled)
+    getStmtInfoTableEntry(s).ExtraBytes += Bytes;
+}
+
 bool Stmt::StatisticsEnabled = false;
 void Stmt::EnableStatistics() {
   StatisticsEnabled = true;
@@ -1724,6 +1724,10 @@ void StmtPrinter::VisitDesignatedInitUpdateExpr(
   OS << "}";
 }
 
+void StmtPrinter::VisitPackedArrayInitExpr(PackedArrayInitExpr *Node) {
+  Visit(Node->getSyntacticForm());
+}
+
 void StmtPrinter::VisitNoInitExpr(NoInitExpr *Node) {
   OS << "/*no init*/";
 }
@@ -923,6 +923,10 @@ void StmtProfiler::VisitInitListExpr(const InitListExpr *S) {
   VisitExpr(S);
 }
 
+void StmtProfiler::VisitPackedArrayInitExpr(const PackedArrayInitExpr *S) {
+  VisitInitListExpr(S->getSyntacticForm());
+}
+
 void StmtProfiler::VisitDesignatedInitExpr(const DesignatedInitExpr *S) {
   VisitExpr(S);
   ID.AddBoolean(S->usesGNUSyntax());
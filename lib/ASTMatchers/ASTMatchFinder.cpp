@@ -21,9 +21,13 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
 #include <deque>
+#include <list>
+#include <map>
 #include <memory>
 #include <set>
 
@@ -37,12 +41,15 @@ typedef MatchFinder::MatchCallback MatchCallback;
 // The maximum number of memoization entries to store.
 // 10k has been experimentally found to give a good trade-off
 // of performance vs. memory consumption by running matcher
-// that match on every statement over a very large codebase.
+// that match on every statement over a very large codebase, when the
+// whole cache was dropped once full. Now that only the least recently used
+// entry is dropped, a full cache still holds the results that nearby nodes
+// are likely to ask for again, and a somewhat larger one pays off.
 //
 // FIXME: Do some performance optimization in general and
 // revisit this number; also, put up micro-benchmarks that we can
 // optimize this on.
-static const unsigned MaxMemoizationEntries = 10000;
+static const unsigned MaxMemoizationEntries = 20000;
 
 // We use memoization to avoid running the same matcher on the same
 // AST node twice.  This struct is the key for looking up match
@@ -73,6 +80,50 @@ struct MemoizedMatchResult {
   BoundNodesTreeBuilder Nodes;
 };
 
+// Maps (matcher, node) -> the match result for memoization, keeping at most
+// MaxMemoizationEntries results. Once full, the least recently used result
+// is dropped.
+class MemoizationMap {
+  struct Entry {
+    MemoizedMatchResult Result;
+    std::list<const MatchKey *>::iterator Use;
+  };
+
+  std::map<MatchKey, Entry> Entries;
+  // The keys of Entries, most recently used first.
+  std::list<const MatchKey *> Uses;
+
+public:
+  // Returns the result stored for \p Key, or null.
+  const MemoizedMatchResult *find(const MatchKey &Key) {
+    auto I = Entries.find(Key);
+    if (I == Entries.end())
+      return nullptr;
+    Uses.splice(Uses.begin(), Uses, I->second.Use);
+    return &I->second.Result;
+  }
+
+  // Stores \p Result for \p Key and returns the stored result.
+  const MemoizedMatchResult &insert(const MatchKey &Key,
+                                    MemoizedMatchResult Result) {
+    auto Inserted = Entries.insert(std::make_pair(Key, Entry()));
+    Entry &E = Inserted.first->second;
+    E.Result = std::move(Result);
+    if (Inserted.second) {
+      Uses.push_front(&Inserted.first->first);
+      E.Use = Uses.begin();
+    } else {
+      Uses.splice(Uses.begin(), Uses, E.Use);
+    }
+
+    if (Entries.size() > MaxMemoizationEntries) {
+      Entries.erase(*Uses.back());
+      Uses.pop_back();
+    }
+    return E.Result;
+  }
+};
+
 // A RecursiveASTVisitor that traverses all children or all descendants of
 // a node.
 class MatchChildASTVisitor
@@ -295,7 +346,10 @@ class MatchASTVisitor : public RecursiveASTVisitor<MatchASTVisitor>,
 public:
   MatchASTVisitor(const MatchFinder::MatchersByType *Matchers,
                   const MatchFinder::MatchFinderOptions &Options)
-      : Matchers(Matchers), Options(Options), ActiveASTContext(nullptr) {}
+      : Matchers(Matchers), Options(Options), ActiveASTContext(nullptr),
+        DeferredMatches(nullptr) {
+    findSharedMatchers();
+  }
 
   ~MatchASTVisitor() override {
     if (Options.CheckProfiling) {
@@ -358,11 +412,15 @@ public:
     // E are aliases, even though neither is a typedef of the other.
     // Therefore, we cannot simply walk through one typedef chain to
     // find out whether the type name matches.
+    addTypeAlias(DeclNode);
+    return true;
+  }
+
+  void addTypeAlias(const TypedefNameDecl *DeclNode) {
     const Type *TypeNode = DeclNode->getUnderlyingType().getTypePtr();
     const Type *CanonicalType =  // root of the typedef tree
         ActiveASTContext->getCanonicalType(TypeNode);
     TypeAliases[CanonicalType].insert(DeclNode);
-    return true;
   }
 
   bool TraverseDecl(Decl *DeclNode);
@@ -388,10 +446,9 @@ public:
     // Note that we key on the bindings *before* the match.
     Key.BoundNodes = *Builder;
 
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    if (const MemoizedMatchResult *Cached = ResultCache.find(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -399,8 +456,8 @@ public:
     Result.ResultOfMatch = matchesRecursively(Node, Matcher, &Result.Nodes,
                                               MaxDepth, Traversal, Bind);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(Key, std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -426,8 +483,6 @@ public:
                       BoundNodesTreeBuilder *Builder,
                       TraversalKind Traversal,
                       BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesRecursively(Node, Matcher, Builder, 1, Traversal,
                                       Bind);
   }
@@ -436,8 +491,6 @@ public:
                            const DynTypedMatcher &Matcher,
                            BoundNodesTreeBuilder *Builder,
                            BindKind Bind) override {
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesRecursively(Node, Matcher, Builder, INT_MAX,
                                       TK_AsIs, Bind);
   }
@@ -446,10 +499,6 @@ public:
                          const DynTypedMatcher &Matcher,
                          BoundNodesTreeBuilder *Builder,
                          AncestorMatchMode MatchMode) override {
-    // Reset the cache outside of the recursive call to make sure we
-    // don't invalidate any iterators.
-    if (ResultCache.size() > MaxMemoizationEntries)
-      ResultCache.clear();
     return memoizedMatchesAncestorOfRecursively(Node, Matcher, Builder,
                                                 MatchMode);
   }
@@ -479,9 +528,48 @@ public:
     matchDispatch(&Node);
   }
 
+  /// \brief The matches found by a visitor that defers them, with the
+  /// callbacks to run on each, in the order they were found.
+  typedef std::vector<std::pair<BoundNodes, MatchCallback *>> MatchList;
+
+  /// \brief Makes the matches found from now on be appended to \p Matches
+  /// instead of being passed to their callbacks right away.
+  void deferMatches(MatchList *Matches) { DeferredMatches = Matches; }
+
+  /// \brief Matches the translation unit like \c TraverseDecl() would, but
+  /// matches its top-level declarations on \p NumThreads threads.
+  void traverseTranslationUnitInParallel(TranslationUnitDecl *TU,
+                                         unsigned NumThreads);
+
   // Implements ASTMatchFinder::getASTContext.
   ASTContext &getASTContext() const override { return *ActiveASTContext; }
 
+  // Implements ASTMatchFinder::dynMatchesShared.
+  bool dynMatchesShared(const DynMatcherInterface &Matcher,
+                        const ast_type_traits::DynTypedNode &Node,
+                        BoundNodesTreeBuilder *Builder) override {
+    // What a matcher binds depends on what was bound before it ran, so only
+    // results that started from no bindings are kept.
+    if (!Builder->isEmpty() || !Node.getMemoizationData() ||
+        !SharedMatchers.count(&Matcher))
+      return Matcher.dynMatches(Node, this, Builder);
+
+    auto Key = std::make_pair(&Matcher, Node.getMemoizationData());
+    auto I = SharedResults.find(Key);
+    if (I != SharedResults.end()) {
+      *Builder = I->second.Nodes;
+      return I->second.ResultOfMatch;
+    }
+
+    MemoizedMatchResult Result;
+    Result.ResultOfMatch = Matcher.dynMatches(Node, this, &Result.Nodes);
+    bool Matched = Result.ResultOfMatch;
+    *Builder = Result.Nodes;
+    // Running the matcher may have added entries and invalidated I.
+    SharedResults[Key] = std::move(Result);
+    return Matched;
+  }
+
   bool shouldVisitTemplateInstantiations() const { return true; }
   bool shouldVisitImplicitCode() const { return true; }
 
@@ -519,6 +607,7 @@ private:
   /// Used by \c matchDispatch() below.
   template <typename T, typename MC>
   void matchWithoutFilter(const T &Node, const MC &Matchers) {
+    SharedResults.clear();
     const bool EnableCheckProfiling = Options.CheckProfiling.hasValue();
     TimeBucketRegion Timer;
     for (const auto &MP : Matchers) {
@@ -526,7 +615,7 @@ private:
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
       BoundNodesTreeBuilder Builder;
       if (MP.first.matches(Node, this, &Builder)) {
-        MatchVisitor Visitor(ActiveASTContext, MP.second);
+        MatchVisitor Visitor(ActiveASTContext, MP.second, DeferredMatches);
         Builder.visitMatches(&Visitor);
       }
     }
@@ -534,13 +623,15 @@ private:
 
   void matchWithFilter(const ast_type_traits::DynTypedNode &DynNode) {
     auto Kind = DynNode.getNodeKind();
-    auto it = MatcherFiltersMap.find(Kind);
-    const auto &Filter =
-        it != MatcherFiltersMap.end() ? it->second : getFilterForKind(Kind);
+    auto it = Matchers->DeclOrStmtFilters.find(Kind);
+    const auto &Filter = it != Matchers->DeclOrStmtFilters.end()
+                             ? it->second
+                             : getFilterForKind(Kind);
 
     if (Filter.empty())
       return;
 
+    SharedResults.clear();
     const bool EnableCheckProfiling = Options.CheckProfiling.hasValue();
     TimeBucketRegion Timer;
     auto &Matchers = this->Matchers->DeclOrStmt;
@@ -550,15 +641,24 @@ private:
         Timer.setBucket(&TimeByBucket[MP.second->getID()]);
       BoundNodesTreeBuilder Builder;
       if (MP.first.matchesNoKindCheck(DynNode, this, &Builder)) {
-        MatchVisitor Visitor(ActiveASTContext, MP.second);
+        MatchVisitor Visitor(ActiveASTContext, MP.second, DeferredMatches);
         Builder.visitMatches(&Visitor);
       }
     }
   }
 
+  /// \brief Computes the indices of the matchers that can match nodes of
+  /// \p Kind.
+  ///
+  /// \c Decl and \c Stmt toplevel matchers usually apply to a specific node
+  /// kind (and derived kinds) so it is a waste to try every matcher on every
+  /// node. The list is kept with the matchers, so each kind is only
+  /// computed once for all the traversals of a \c MatchFinder. This also
+  /// allows us to skip the restrict check at matching time. See use
+  /// \c matchesNoKindCheck() above.
   const std::vector<unsigned short> &
   getFilterForKind(ast_type_traits::ASTNodeKind Kind) {
-    auto &Filter = MatcherFiltersMap[Kind];
+    auto &Filter = Matchers->DeclOrStmtFilters[Kind];
     auto &Matchers = this->Matchers->DeclOrStmt;
     assert((Matchers.size() < USHRT_MAX) && "Too many matchers.");
     for (unsigned I = 0, E = Matchers.size(); I != E; ++I) {
@@ -569,6 +669,50 @@ private:
     return Filter;
   }
 
+  /// \brief Computes the filters of all the \c Decl and \c Stmt kinds that
+  /// have not been computed yet, so that matching in parallel only reads
+  /// them.
+  void computeAllFilters() {
+    auto Compute = [this](ast_type_traits::ASTNodeKind Kind) {
+      if (!Matchers->DeclOrStmtFilters.count(Kind))
+        getFilterForKind(Kind);
+    };
+#define ABSTRACT_DECL(DECL)
+#define DECL(CLASS, BASE)                                                      \
+  Compute(ast_type_traits::ASTNodeKind::getFromNodeKind<CLASS##Decl>());
+#include "clang/AST/DeclNodes.inc"
+#define ABSTRACT_STMT(STMT)
+#define STMT(CLASS, PARENT)                                                    \
+  Compute(ast_type_traits::ASTNodeKind::getFromNodeKind<CLASS>());
+#include "clang/AST/StmtNodes.inc"
+  }
+
+  /// \brief Finds the matchers that are run by more than one registered
+  /// matcher, or from more than one place in the same one.
+  void findSharedMatchers() {
+    llvm::DenseSet<const DynMatcherInterface *> Seen;
+    SmallVector<const DynMatcherInterface *, 32> Worklist;
+    for (const auto &MP : Matchers->DeclOrStmt)
+      Worklist.push_back(MP.first.getImplementation());
+    for (const auto &MP : Matchers->Type)
+      Worklist.push_back(DynTypedMatcher(MP.first).getImplementation());
+    for (const auto &MP : Matchers->NestedNameSpecifier)
+      Worklist.push_back(DynTypedMatcher(MP.first).getImplementation());
+    for (const auto &MP : Matchers->NestedNameSpecifierLoc)
+      Worklist.push_back(DynTypedMatcher(MP.first).getImplementation());
+    for (const auto &MP : Matchers->TypeLoc)
+      Worklist.push_back(DynTypedMatcher(MP.first).getImplementation());
+
+    while (!Worklist.empty()) {
+      const DynMatcherInterface *Matcher = Worklist.pop_back_val();
+      if (!Seen.insert(Matcher).second) {
+        SharedMatchers.insert(Matcher);
+        continue;
+      }
+      Matcher->getInnerMatchers(Worklist);
+    }
+  }
+
   /// @{
   /// \brief Overloads to pair the different node types to their matchers.
   void matchDispatch(const Decl *Node) {
@@ -625,12 +769,11 @@ private:
     Key.Node = Node;
     Key.BoundNodes = *Builder;
 
-    // Note that we cannot use insert and reuse the iterator, as recursive
-    // calls to match might invalidate the result cache iterators.
-    MemoizationMap::iterator I = ResultCache.find(Key);
-    if (I != ResultCache.end()) {
-      *Builder = I->second.Nodes;
-      return I->second.ResultOfMatch;
+    // Note that we cannot insert an entry up front and fill it in later, as
+    // recursive calls to match might evict it from the result cache.
+    if (const MemoizedMatchResult *Cached = ResultCache.find(Key)) {
+      *Builder = Cached->Nodes;
+      return Cached->ResultOfMatch;
     }
 
     MemoizedMatchResult Result;
@@ -638,8 +781,8 @@ private:
     Result.ResultOfMatch =
         matchesAncestorOfRecursively(Node, Matcher, &Result.Nodes, MatchMode);
 
-    MemoizedMatchResult &CachedResult = ResultCache[Key];
-    CachedResult = std::move(Result);
+    const MemoizedMatchResult &CachedResult =
+        ResultCache.insert(Key, std::move(Result));
 
     *Builder = CachedResult.Nodes;
     return CachedResult.ResultOfMatch;
@@ -650,7 +793,12 @@ private:
                                     BoundNodesTreeBuilder *Builder,
                                     AncestorMatchMode MatchMode) {
     const auto &Parents = ActiveASTContext->getParents(Node);
-    assert(!Parents.empty() && "Found node that is not in the parent map.");
+    if (Parents.empty()) {
+      // Only nodes outside of a restricted parent map scope have no parents.
+      assert(!ActiveASTContext->getParentMapScope().empty() &&
+             "Found node that is not in the parent map.");
+      return false;
+    }
     if (Parents.size() == 1) {
       // Only one parent - do recursive memoization.
       const ast_type_traits::DynTypedNode Parent = Parents[0];
@@ -697,17 +845,23 @@ private:
   class MatchVisitor : public BoundNodesTreeBuilder::Visitor {
   public:
     MatchVisitor(ASTContext* Context,
-                 MatchFinder::MatchCallback* Callback)
+                 MatchFinder::MatchCallback* Callback,
+                 MatchList *DeferredMatches)
       : Context(Context),
-        Callback(Callback) {}
+        Callback(Callback),
+        DeferredMatches(DeferredMatches) {}
 
     void visitMatch(const BoundNodes& BoundNodesView) override {
-      Callback->run(MatchFinder::MatchResult(BoundNodesView, Context));
+      if (DeferredMatches)
+        DeferredMatches->emplace_back(BoundNodesView, Callback);
+      else
+        Callback->run(MatchFinder::MatchResult(BoundNodesView, Context));
     }
 
   private:
     ASTContext* Context;
     MatchFinder::MatchCallback* Callback;
+    MatchList *DeferredMatches;
   };
 
   // Returns true if 'TypeNode' has an alias that matches the given matcher.
@@ -733,26 +887,26 @@ private:
 
   const MatchFinder::MatchersByType *Matchers;
 
-  /// \brief Filtered list of matcher indices for each matcher kind.
-  ///
-  /// \c Decl and \c Stmt toplevel matchers usually apply to a specific node
-  /// kind (and derived kinds) so it is a waste to try every matcher on every
-  /// node.
-  /// We precalculate a list of matchers that pass the toplevel restrict check.
-  /// This also allows us to skip the restrict check at matching time. See
-  /// use \c matchesNoKindCheck() above.
-  llvm::DenseMap<ast_type_traits::ASTNodeKind, std::vector<unsigned short>>
-      MatcherFiltersMap;
-
   const MatchFinder::MatchFinderOptions &Options;
   ASTContext *ActiveASTContext;
 
   // Maps a canonical type to its TypedefDecls.
   llvm::DenseMap<const Type*, std::set<const TypedefNameDecl*> > TypeAliases;
 
-  // Maps (matcher, node) -> the match result for memoization.
-  typedef std::map<MatchKey, MemoizedMatchResult> MemoizationMap;
+  /// \brief Where to append the matches found, or null to run their
+  /// callbacks right away.
+  MatchList *DeferredMatches;
+
   MemoizationMap ResultCache;
+
+  /// \brief The matchers found by \c findSharedMatchers().
+  llvm::DenseSet<const DynMatcherInterface *> SharedMatchers;
+
+  /// \brief The results of shared matchers on each node, for the node that
+  /// the registered matchers currently run on.
+  llvm::DenseMap<std::pair<const DynMatcherInterface *, const void *>,
+                 MemoizedMatchResult>
+      SharedResults;
 };
 
 static CXXRecordDecl *
@@ -812,6 +966,81 @@ bool MatchASTVisitor::classIsDerivedFrom(const CXXRecordDecl *Declaration,
   return false;
 }
 
+// Collects the typedefs that a MatchASTVisitor would see while traversing
+// a declaration.
+class TypedefCollector : public RecursiveASTVisitor<TypedefCollector> {
+public:
+  explicit TypedefCollector(std::vector<const TypedefNameDecl *> &Typedefs)
+      : Typedefs(Typedefs) {}
+
+  bool VisitTypedefNameDecl(TypedefNameDecl *DeclNode) {
+    Typedefs.push_back(DeclNode);
+    return true;
+  }
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+  bool shouldVisitImplicitCode() const { return true; }
+
+private:
+  std::vector<const TypedefNameDecl *> &Typedefs;
+};
+
+void MatchASTVisitor::traverseTranslationUnitInParallel(
+    TranslationUnitDecl *TU, unsigned NumThreads) {
+  match(*TU);
+
+  // Split the declarations RecursiveASTVisitor traverses into contiguous
+  // partitions; a few per thread, to even out their sizes.
+  std::vector<Decl *> Decls;
+  for (Decl *D : TU->decls())
+    if (!isa<BlockDecl>(D) && !isa<CapturedDecl>(D))
+      Decls.push_back(D);
+  if (Decls.empty())
+    return;
+  unsigned NumPartitions =
+      std::min<size_t>(Decls.size(), NumThreads * 4);
+  auto PartitionBegin = [&](unsigned Partition) {
+    return Decls.begin() + Decls.size() * Partition / NumPartitions;
+  };
+
+  // Compute everything that is otherwise computed lazily while matching.
+  computeAllFilters();
+  ActiveASTContext->computeParentMap();
+
+  llvm::ThreadPool Pool(NumThreads);
+
+  // Serially, isDerivedFrom() sees the typedefs traversed before the class,
+  // so each partition needs the typedefs of the partitions before it.
+  std::vector<std::vector<const TypedefNameDecl *>> Typedefs(NumPartitions);
+  for (unsigned I = 0; I != NumPartitions; ++I) {
+    Pool.async([&, I] {
+      TypedefCollector Collector(Typedefs[I]);
+      for (auto D = PartitionBegin(I), E = PartitionBegin(I + 1); D != E; ++D)
+        Collector.TraverseDecl(*D);
+    });
+  }
+  Pool.wait();
+
+  std::vector<MatchList> Matches(NumPartitions);
+  for (unsigned I = 0; I != NumPartitions; ++I) {
+    Pool.async([&, I] {
+      MatchASTVisitor Visitor(Matchers, Options);
+      Visitor.set_active_ast_context(ActiveASTContext);
+      for (unsigned J = 0; J != I; ++J)
+        for (const TypedefNameDecl *Typedef : Typedefs[J])
+          Visitor.addTypeAlias(Typedef);
+      Visitor.deferMatches(&Matches[I]);
+      for (auto D = PartitionBegin(I), E = PartitionBegin(I + 1); D != E; ++D)
+        Visitor.TraverseDecl(*D);
+    });
+  }
+  Pool.wait();
+
+  for (const MatchList &PartitionMatches : Matches)
+    for (const auto &Match : PartitionMatches)
+      Match.second->run(MatchFinder::MatchResult(Match.first, ActiveASTContext));
+}
+
 bool MatchASTVisitor::TraverseDecl(Decl *DeclNode) {
   if (!DeclNode) {
     return true;
@@ -901,6 +1130,7 @@ MatchFinder::~MatchFinder() {}
 void MatchFinder::addMatcher(const DeclarationMatcher &NodeMatch,
                              MatchCallback *Action) {
   Matchers.DeclOrStmt.emplace_back(NodeMatch, Action);
+  Matchers.DeclOrStmtFilters.clear();
   Matchers.AllCallbacks.insert(Action);
 }
 
@@ -913,6 +1143,7 @@ void MatchFinder::addMatcher(const TypeMatcher &NodeMatch,
 void MatchFinder::addMatcher(const StatementMatcher &NodeMatch,
                              MatchCallback *Action) {
   Matchers.DeclOrStmt.emplace_back(NodeMatch, Action);
+  Matchers.DeclOrStmtFilters.clear();
   Matchers.AllCallbacks.insert(Action);
 }
 
@@ -973,7 +1204,14 @@ void MatchFinder::matchAST(ASTContext &Context) {
   internal::MatchASTVisitor Visitor(&Matchers, Options);
   Visitor.set_active_ast_context(&Context);
   Visitor.onStartOfTranslationUnit();
-  Visitor.TraverseDecl(Context.getTranslationUnitDecl());
+  // Deserializing declarations on several threads is not safe, and
+  // per-check timers cannot be shared between threads.
+  if (Options.NumThreads > 1 && !Context.getExternalSource() &&
+      !Options.CheckProfiling)
+    Visitor.traverseTranslationUnitInParallel(Context.getTranslationUnitDecl(),
+                                              Options.NumThreads);
+  else
+    Visitor.TraverseDecl(Context.getTranslationUnitDecl());
   Visitor.onEndOfTranslationUnit();
 }
 
@@ -67,6 +67,12 @@ public:
     return Func(DynNode, Finder, Builder, InnerMatchers);
   }
 
+  void getInnerMatchers(
+      SmallVectorImpl<const DynMatcherInterface *> &Inner) const override {
+    for (const DynTypedMatcher &InnerMatcher : InnerMatchers)
+      Inner.push_back(InnerMatcher.getImplementation());
+  }
+
 private:
   std::vector<DynTypedMatcher> InnerMatchers;
 };
@@ -80,11 +86,16 @@ class IdDynMatcher : public DynMatcherInterface {
   bool dynMatches(const ast_type_traits::DynTypedNode &DynNode,
                   ASTMatchFinder *Finder,
                   BoundNodesTreeBuilder *Builder) const override {
-    bool Result = InnerMatcher->dynMatches(DynNode, Finder, Builder);
+    bool Result = Finder->dynMatchesShared(*InnerMatcher, DynNode, Builder);
     if (Result) Builder->setBinding(ID, DynNode);
     return Result;
   }
 
+  void getInnerMatchers(
+      SmallVectorImpl<const DynMatcherInterface *> &Inner) const override {
+    Inner.push_back(InnerMatcher.get());
+  }
+
  private:
   const std::string ID;
   const IntrusiveRefCntPtr<DynMatcherInterface> InnerMatcher;
@@ -183,7 +194,7 @@ bool DynTypedMatcher::matches(const ast_type_traits::DynTypedNode &DynNode,
                               ASTMatchFinder *Finder,
                               BoundNodesTreeBuilder *Builder) const {
   if (RestrictKind.isBaseOf(DynNode.getNodeKind()) &&
-      Implementation->dynMatches(DynNode, Finder, Builder)) {
+      Finder->dynMatchesShared(*Implementation, DynNode, Builder)) {
     return true;
   }
   // Delete all bindings when a matcher does not match.
@@ -197,7 +208,7 @@ bool DynTypedMatcher::matchesNoKindCheck(
     const ast_type_traits::DynTypedNode &DynNode, ASTMatchFinder *Finder,
     BoundNodesTreeBuilder *Builder) const {
   assert(RestrictKind.isBaseOf(DynNode.getNodeKind()));
-  if (Implementation->dynMatches(DynNode, Finder, Builder)) {
+  if (Finder->dynMatchesShared(*Implementation, DynNode, Builder)) {
     return true;
   }
   // Delete all bindings when a matcher does not match.
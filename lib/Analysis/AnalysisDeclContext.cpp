@@ -23,6 +23,7 @@
 #include "clang/Analysis/Analyses/CFGReachabilityAnalysis.h"
 #include "clang/Analysis/Analyses/LiveVariables.h"
 #include "clang/Analysis/Analyses/PseudoConstantAnalysis.h"
+#include "clang/Analysis/Analyses/ReachableCode.h"
 #include "clang/Analysis/CFG.h"
 #include "clang/Analysis/CFGStmtMap.h"
 #include "clang/Analysis/Support/BumpVector.h"
@@ -82,9 +83,38 @@ AnalysisDeclContextManager::AnalysisDeclContextManager(bool useUnoptimizedCFG,
 }
 
 void AnalysisDeclContextManager::clear() {
+  // Every LocationContext points to the AnalysisDeclContext it was made for.
+  LocContexts.clear();
   llvm::DeleteContainerSeconds(Contexts);
 }
 
+void AnalysisDeclContextManager::releaseContexts(
+    llvm::function_ref<bool(const Decl *)> IsFinished, unsigned MaxRetained) {
+  LocContexts.clear();
+
+  SmallVector<const Decl *, 16> Released;
+  SmallVector<std::pair<uint64_t, const Decl *>, 64> Retained;
+  for (const auto &Entry : Contexts) {
+    if (IsFinished(Entry.first))
+      Released.push_back(Entry.first);
+    else
+      Retained.push_back(std::make_pair(Entry.second->LastUse, Entry.first));
+  }
+
+  if (Retained.size() > MaxRetained) {
+    auto Cutoff = Retained.begin() + (Retained.size() - MaxRetained);
+    std::nth_element(Retained.begin(), Cutoff, Retained.end());
+    for (auto I = Retained.begin(); I != Cutoff; ++I)
+      Released.push_back(I->second);
+  }
+
+  for (const Decl *D : Released) {
+    ContextMap::iterator I = Contexts.find(D);
+    delete I->second;
+    Contexts.erase(I);
+  }
+}
+
 static BodyFarm &getBodyFarm(ASTContext &C, CodeInjector *injector = nullptr) {
   static BodyFarm *BF = new BodyFarm(C, injector);
   return *BF;
@@ -273,6 +303,34 @@ CFGReverseBlockReachabilityAnalysis *AnalysisDeclContext::getCFGReachablityAnaly
   return nullptr;
 }
 
+const llvm::BitVector *AnalysisDeclContext::getReachableBlocks() {
+  if (ReachableBlocks)
+    return ReachableBlocks.get();
+
+  CFG *c = getCFG();
+  if (!c)
+    return nullptr;
+
+  ReachableBlocks.reset(new llvm::BitVector(c->getNumBlockIDs()));
+  unsigned count =
+      reachable_code::ScanReachableFromBlock(&c->getEntry(), *ReachableBlocks);
+
+  // When there are things remaining dead, and we didn't add EH edges from
+  // CallExprs to the catch clauses, we have to go back and mark them as live.
+  if (!getAddEHEdges() && count != c->getNumBlockIDs()) {
+    for (CFG::try_block_iterator I = c->try_blocks_begin(),
+                                 E = c->try_blocks_end();
+         I != E; ++I) {
+      const CFGBlock *B = *I;
+      if (!(*ReachableBlocks)[B->getBlockID()] &&
+          B->pred_begin() == B->pred_end())
+        reachable_code::ScanReachableFromBlock(B, *ReachableBlocks);
+    }
+  }
+
+  return ReachableBlocks.get();
+}
+
 void AnalysisDeclContext::dumpCFG(bool ShowColors) {
     getCFG()->dump(getASTContext().getLangOpts(), ShowColors);
 }
@@ -310,6 +368,7 @@ AnalysisDeclContext *AnalysisDeclContextManager::getContext(const Decl *D) {
   AnalysisDeclContext *&AC = Contexts[D];
   if (!AC)
     AC = new AnalysisDeclContext(this, D, cfgBuildOptions);
+  AC->LastUse = ++NumUses;
   return AC;
 }
 
@@ -1096,6 +1096,14 @@ std::unique_ptr<CFG> CFGBuilder::buildCFG(const Decl *D, Stmt *Statement) {
 /// createBlock - Used to lazily create blocks that are connected
 ///  to the current (global) succcessor.
 CFGBlock *CFGBuilder::createBlock(bool add_successor) {
+  // Give up on CFGs over the size budget. The block is still created, as
+  // callers may not check badCFG right away.
+  if (BuildOpts.MaxBlocks && cfg->getNumBlockIDs() >= BuildOpts.MaxBlocks &&
+      !badCFG) {
+    badCFG = true;
+    if (BuildOpts.ExceededMaxBlocks)
+      *BuildOpts.ExceededMaxBlocks = true;
+  }
   CFGBlock *B = cfg->createBlock();
   if (add_successor && Succ)
     addSuccessor(B, Succ);
@@ -1580,6 +1588,11 @@ CFGBlock *CFGBuilder::Visit(Stmt * S, AddStmtChoice asc) {
     case Stmt::OpaqueValueExprClass:
       return Block;
 
+    case Stmt::PackedArrayInitExprClass:
+      // The values are already known; the literals of the syntactic form are
+      // not evaluated again.
+      return VisitNoRecurse(cast<Expr>(S), asc);
+
     case Stmt::PseudoObjectExprClass:
       return VisitPseudoObjectExpr(cast<PseudoObjectExpr>(S));
 
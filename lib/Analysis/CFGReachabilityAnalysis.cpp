@@ -20,7 +20,7 @@
 using namespace clang;
 
 CFGReverseBlockReachabilityAnalysis::CFGReverseBlockReachabilityAnalysis(const CFG &cfg)
-  : analyzed(cfg.getNumBlockIDs(), false) {}
+  : reachable(cfg.getNumBlockIDs()) {}
 
 bool CFGReverseBlockReachabilityAnalysis::isReachable(const CFGBlock *Src,
                                           const CFGBlock *Dst) {
@@ -28,10 +28,8 @@ bool CFGReverseBlockReachabilityAnalysis::isReachable(const CFGBlock *Src,
   const unsigned DstBlockID = Dst->getBlockID();
   
   // If we haven't analyzed the destination node, run the analysis now
-  if (!analyzed[DstBlockID]) {
+  if (reachable[DstBlockID].empty())
     mapReachability(Dst);
-    analyzed[DstBlockID] = true;
-  }
   
   // Return the cached result
   return reachable[DstBlockID][Src->getBlockID()];
@@ -41,10 +39,10 @@ bool CFGReverseBlockReachabilityAnalysis::isReachable(const CFGBlock *Src,
 // destination node.
 void CFGReverseBlockReachabilityAnalysis::mapReachability(const CFGBlock *Dst) {
   SmallVector<const CFGBlock *, 11> worklist;
-  llvm::BitVector visited(analyzed.size());
+  llvm::BitVector visited(reachable.size());
   
   ReachableSet &DstReachability = reachable[Dst->getBlockID()];
-  DstReachability.resize(analyzed.size(), false);
+  DstReachability.resize(reachable.size(), false);
   
   // Start searching from the destination node, since we commonly will perform
   // multiple queries relating to a destination node.
@@ -1121,7 +1121,7 @@ bool ConsumedBlockInfo::isBackEdgeTarget(const CFGBlock *Block) {
 void ConsumedStateMap::checkParamsForReturnTypestate(SourceLocation BlameLoc,
   ConsumedWarningsHandlerBase &WarningsHandler) const {
   
-  for (const auto &DM : VarMap) {
+  for (const auto &DM : *VarMap) {
     if (isa<ParmVarDecl>(DM.first)) {
       const ParmVarDecl *Param = cast<ParmVarDecl>(DM.first);
       const ReturnTypestateAttr *RTA = Param->getAttr<ReturnTypestateAttr>();
@@ -1143,9 +1143,9 @@ void ConsumedStateMap::clearTemporaries() {
 }
 
 ConsumedState ConsumedStateMap::getState(const VarDecl *Var) const {
-  VarMapType::const_iterator Entry = VarMap.find(Var);
+  VarMapType::const_iterator Entry = VarMap->find(Var);
   
-  if (Entry != VarMap.end())
+  if (Entry != VarMap->end())
     return Entry->second;
     
   return CS_None;
@@ -1169,14 +1169,18 @@ void ConsumedStateMap::intersect(const ConsumedStateMap &Other) {
     return;
   }
 
-  for (const auto &DM : Other.VarMap) {
+  // Maps that still share their states agree on every variable.
+  if (VarMap == Other.VarMap)
+    return;
+
+  for (const auto &DM : *Other.VarMap) {
     LocalState = this->getState(DM.first);
     
     if (LocalState == CS_None)
       continue;
     
     if (LocalState != DM.second)
-     VarMap[DM.first] = CS_Unknown;
+     getMutableVarMap()[DM.first] = CS_Unknown;
   }
 }
 
@@ -1187,14 +1191,17 @@ void ConsumedStateMap::intersectAtLoopHead(const CFGBlock *LoopHead,
   ConsumedState LocalState;
   SourceLocation BlameLoc = getLastStmtLoc(LoopBack);
   
-  for (const auto &DM : LoopBackStates->VarMap) {    
+  if (VarMap == LoopBackStates->VarMap)
+    return;
+
+  for (const auto &DM : *LoopBackStates->VarMap) {    
     LocalState = this->getState(DM.first);
     
     if (LocalState == CS_None)
       continue;
     
     if (LocalState != DM.second) {
-      VarMap[DM.first] = CS_Unknown;
+      getMutableVarMap()[DM.first] = CS_Unknown;
       WarningsHandler.warnLoopStateMismatch(BlameLoc,
                                             DM.first->getNameAsString());
     }
@@ -1203,12 +1210,18 @@ void ConsumedStateMap::intersectAtLoopHead(const CFGBlock *LoopHead,
 
 void ConsumedStateMap::markUnreachable() {
   this->Reachable = false;
-  VarMap.clear();
+  VarMap = std::make_shared<VarMapType>();
   TmpMap.clear();
 }
 
 void ConsumedStateMap::setState(const VarDecl *Var, ConsumedState State) {
-  VarMap[Var] = State;
+  VarMapType::iterator Entry = VarMap->find(Var);
+
+  // Don't unshare the map to store the state a variable already has.
+  if (Entry != VarMap->end() && Entry->second == State)
+    return;
+
+  getMutableVarMap()[Var] = State;
 }
 
 void ConsumedStateMap::setState(const CXXBindTemporaryExpr *Tmp,
@@ -1220,8 +1233,17 @@ void ConsumedStateMap::remove(const CXXBindTemporaryExpr *Tmp) {
   TmpMap.erase(Tmp);
 }
 
+ConsumedStateMap::VarMapType &ConsumedStateMap::getMutableVarMap() {
+  if (!VarMap.unique())
+    VarMap = std::make_shared<VarMapType>(*VarMap);
+  return *VarMap;
+}
+
 bool ConsumedStateMap::operator!=(const ConsumedStateMap *Other) const {
-  for (const auto &DM : Other->VarMap)
+  if (VarMap == Other->VarMap)
+    return false;
+
+  for (const auto &DM : *Other->VarMap)
     if (this->getState(DM.first) != DM.second)
       return true;  
   return false;
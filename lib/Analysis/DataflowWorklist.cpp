@@ -0,0 +1,77 @@
+//===- DataflowWorklist.cpp - Worklist for dataflow analyses --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the worklists of CFG blocks shared by the dataflow
+// analyses over source-level CFGs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Analysis/FlowSensitive/DataflowWorklist.h"
+#include <algorithm>
+#include <climits>
+
+using namespace clang;
+
+namespace {
+/// Orders blocks so that the one with the lowest position is at the top of a
+/// heap.
+struct ComesAfter {
+  const std::vector<unsigned> &Position;
+
+  bool operator()(const CFGBlock *A, const CFGBlock *B) const {
+    return Position[A->getBlockID()] > Position[B->getBlockID()];
+  }
+};
+} // end anonymous namespace
+
+DataflowWorklistBase::DataflowWorklistBase(const CFG &Cfg,
+                                           const PostOrderCFGView &POV,
+                                           bool Backward)
+    : Position(Cfg.getNumBlockIDs(), UINT_MAX),
+      EnqueuedBlocks(Cfg.getNumBlockIDs()) {
+  // The view iterates in reverse post order.
+  unsigned NumBlocks = std::distance(POV.begin(), POV.end());
+  unsigned I = 0;
+  for (const CFGBlock *Block : POV) {
+    Position[Block->getBlockID()] = Backward ? NumBlocks - 1 - I : I;
+    ++I;
+  }
+}
+
+void DataflowWorklistBase::enqueueBlock(const CFGBlock *Block) {
+  if (!Block || EnqueuedBlocks[Block->getBlockID()])
+    return;
+  EnqueuedBlocks[Block->getBlockID()] = true;
+  Heap.push_back(Block);
+  std::push_heap(Heap.begin(), Heap.end(), ComesAfter{Position});
+}
+
+const CFGBlock *DataflowWorklistBase::dequeue() {
+  if (Heap.empty())
+    return nullptr;
+  std::pop_heap(Heap.begin(), Heap.end(), ComesAfter{Position});
+  const CFGBlock *Block = Heap.back();
+  Heap.pop_back();
+  EnqueuedBlocks[Block->getBlockID()] = false;
+  return Block;
+}
+
+void ForwardDataflowWorklist::enqueueSuccessors(const CFGBlock *Block) {
+  for (CFGBlock::const_succ_iterator I = Block->succ_begin(),
+                                     E = Block->succ_end();
+       I != E; ++I)
+    enqueueBlock(*I);
+}
+
+void BackwardDataflowWorklist::enqueuePredecessors(const CFGBlock *Block) {
+  for (CFGBlock::const_pred_iterator I = Block->pred_begin(),
+                                     E = Block->pred_end();
+       I != E; ++I)
+    enqueueBlock(*I);
+}
@@ -20,6 +20,7 @@ using clang::analyze_format_string::ArgType;
 using clang::analyze_format_string::FormatStringHandler;
 using clang::analyze_format_string::LengthModifier;
 using clang::analyze_format_string::OptionalAmount;
+using clang::analyze_format_string::PrintfStringCache;
 using clang::analyze_format_string::ConversionSpecifier;
 using clang::analyze_printf::PrintfSpecifier;
 
@@ -354,6 +355,129 @@ bool clang::analyze_format_string::ParsePrintfString(FormatStringHandler &H,
   return false;
 }
 
+namespace {
+/// Forwards the callbacks of the parser to another handler, and records the
+/// specifiers as long as nothing else is reported.
+class RecordingPrintfHandler : public FormatStringHandler {
+  FormatStringHandler &H;
+
+public:
+  std::vector<PrintfStringCache::Specifier> Specifiers;
+  bool SawOnlySpecifiers;
+  bool Stopped;
+
+  RecordingPrintfHandler(FormatStringHandler &H)
+      : H(H), SawOnlySpecifiers(true), Stopped(false) {}
+
+  void HandleNullChar(const char *nullCharacter) override {
+    SawOnlySpecifiers = false;
+    H.HandleNullChar(nullCharacter);
+  }
+
+  void HandlePosition(const char *startPos, unsigned posLen) override {
+    SawOnlySpecifiers = false;
+    H.HandlePosition(startPos, posLen);
+  }
+
+  void HandleInvalidPosition(const char *startPos, unsigned posLen,
+                             analyze_format_string::PositionContext p)
+      override {
+    SawOnlySpecifiers = false;
+    H.HandleInvalidPosition(startPos, posLen, p);
+  }
+
+  void HandleZeroPosition(const char *startPos, unsigned posLen) override {
+    SawOnlySpecifiers = false;
+    H.HandleZeroPosition(startPos, posLen);
+  }
+
+  void HandleIncompleteSpecifier(const char *startSpecifier,
+                                 unsigned specifierLen) override {
+    SawOnlySpecifiers = false;
+    H.HandleIncompleteSpecifier(startSpecifier, specifierLen);
+  }
+
+  void HandleEmptyObjCModifierFlag(const char *startFlags,
+                                   unsigned flagsLen) override {
+    SawOnlySpecifiers = false;
+    H.HandleEmptyObjCModifierFlag(startFlags, flagsLen);
+  }
+
+  void HandleInvalidObjCModifierFlag(const char *startFlag,
+                                     unsigned flagLen) override {
+    SawOnlySpecifiers = false;
+    H.HandleInvalidObjCModifierFlag(startFlag, flagLen);
+  }
+
+  void HandleObjCFlagsWithNonObjCConversion(
+      const char *flagsStart, const char *flagsEnd,
+      const char *conversionPosition) override {
+    SawOnlySpecifiers = false;
+    H.HandleObjCFlagsWithNonObjCConversion(flagsStart, flagsEnd,
+                                           conversionPosition);
+  }
+
+  bool HandleInvalidPrintfConversionSpecifier(
+      const analyze_printf::PrintfSpecifier &FS, const char *startSpecifier,
+      unsigned specifierLen) override {
+    SawOnlySpecifiers = false;
+    return H.HandleInvalidPrintfConversionSpecifier(FS, startSpecifier,
+                                                    specifierLen);
+  }
+
+  bool HandlePrintfSpecifier(const analyze_printf::PrintfSpecifier &FS,
+                             const char *startSpecifier,
+                             unsigned specifierLen) override {
+    Specifiers.push_back({FS, startSpecifier, specifierLen});
+    if (H.HandlePrintfSpecifier(FS, startSpecifier, specifierLen))
+      return true;
+    Stopped = true;
+    return false;
+  }
+};
+} // end anonymous namespace
+
+StringRef
+clang::analyze_format_string::PrintfStringCache::intern(StringRef Str,
+                                                       bool isFreeBSDKPrintf) {
+  return Strings[isFreeBSDKPrintf].insert(std::make_pair(Str, Entry()))
+      .first->first();
+}
+
+bool clang::analyze_format_string::PrintfStringCache::parse(
+    FormatStringHandler &H, StringRef Str, const LangOptions &LO,
+    const TargetInfo &Target, bool isFreeBSDKPrintf) {
+  auto It = Strings[isFreeBSDKPrintf].find(Str);
+  assert(It != Strings[isFreeBSDKPrintf].end() &&
+         It->first().data() == Str.data() && "string was not interned");
+  Entry &E = It->second;
+
+  if (E.State == Entry::Replayable) {
+    for (const Specifier &Spec : E.Specifiers)
+      if (!H.HandlePrintfSpecifier(Spec.FS, Spec.Start, Spec.Length))
+        return true;
+    return false;
+  }
+
+  if (E.State == Entry::NotReplayable)
+    return ParsePrintfString(H, Str.begin(), Str.end(), LO, Target,
+                             isFreeBSDKPrintf);
+
+  RecordingPrintfHandler Recorder(H);
+  bool Result = ParsePrintfString(Recorder, Str.begin(), Str.end(), LO, Target,
+                                  isFreeBSDKPrintf);
+
+  // If the handler stopped early, the specifiers after that point are
+  // unknown; record the string the next time it is checked.
+  if (!Recorder.SawOnlySpecifiers) {
+    E.State = Entry::NotReplayable;
+  } else if (!Recorder.Stopped) {
+    E.State = Entry::Replayable;
+    E.Specifiers = std::move(Recorder.Specifiers);
+  }
+  return Result;
+}
+
 bool clang::analyze_format_string::ParseFormatStringHasSArg(const char *I,
                                                             const char *E,
                                                             const LangOptions &LO,
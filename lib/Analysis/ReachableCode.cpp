@@ -641,6 +641,12 @@ void FindUnreachableCode(AnalysisDeclContext &AC, Preprocessor &PP,
   if (!cfg)
     return;
 
+  // Code that may be unreachable is a superset of the code that the edges of
+  // the CFG cannot reach, which most functions have none of and which the
+  // fall-through check computes anyway.
+  if (AC.getReachableBlocks()->all())
+    return;
+
   // Scan for reachable blocks from the entrance of the CFG.
   // If there are no unreachable blocks, we're done.
   llvm::BitVector reachable(cfg->getNumBlockIDs());
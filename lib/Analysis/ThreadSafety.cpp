@@ -176,6 +176,21 @@ public:
 
   bool isEmpty() const { return FactIDs.size() == 0; }
 
+  /// \brief Return true if both sets hold the same facts in the same order.
+  bool hasSameFacts(const FactSet &Other) const {
+    return FactIDs == Other.FactIDs;
+  }
+
+  // Return true if the set contains a universal fact, which matches any
+  // capability.
+  bool hasUniversal(FactManager &FactMan) const {
+    for (FactID FID : *this) {
+      if (FactMan[FID].isUniversal())
+        return true;
+    }
+    return false;
+  }
+
   // Return true if the set contains only negative facts
   bool isEmpty(FactManager &FactMan) const {
     for (FactID FID : *this) {
@@ -2021,6 +2036,12 @@ void ThreadSafetyAnalyzer::intersectAndWarn(FactSet &FSet1,
                                             LockErrorKind LEK1,
                                             LockErrorKind LEK2,
                                             bool Modify) {
+  // Joining a set with itself is common, e.g. at the end of an if without
+  // locking in either branch, and there is nothing to check. With a
+  // universal fact, the result depends on which fact each lookup finds first.
+  if (FSet1.hasSameFacts(FSet2) && !FSet1.hasUniversal(FactMan))
+    return;
+
   FactSet FSet1Orig = FSet1;
 
   // Find locks in FSet2 that conflict or are not in FSet1, and warn.
@@ -136,6 +136,10 @@ void DiagnosticsEngine::Reset() {
   // through command-line.
   DiagStates.emplace_back();
   DiagStatePoints.push_back(DiagStatePoint(&DiagStates.back(), FullSourceLoc()));
+  LastDiagStatePointIdx = 0;
+
+  IgnoredEverywhere.assign(diag::DIAG_UPPER_LIMIT, false);
+  IgnoredEverywhereKnown.assign(diag::DIAG_UPPER_LIMIT, false);
 }
 
 void DiagnosticsEngine::SetDelayedDiagnostic(unsigned DiagID, StringRef Arg1,
@@ -168,16 +172,52 @@ DiagnosticsEngine::GetDiagStatePointForLoc(SourceLocation L) const {
   if (Loc.isInvalid())
     return DiagStatePoints.end() - 1;
 
-  DiagStatePointsTy::iterator Pos = DiagStatePoints.end();
   FullSourceLoc LastStateChangePos = DiagStatePoints.back().Loc;
-  if (LastStateChangePos.isValid() &&
-      Loc.isBeforeInTranslationUnitThan(LastStateChangePos))
-    Pos = std::upper_bound(DiagStatePoints.begin(), DiagStatePoints.end(),
-                           DiagStatePoint(nullptr, Loc));
+  if (LastStateChangePos.isInvalid() ||
+      !Loc.isBeforeInTranslationUnitThan(LastStateChangePos))
+    return DiagStatePoints.end() - 1;
+
+  // Check whether Loc falls between the point found by the previous lookup
+  // and the next one. The points only ever grow between resets, so the index
+  // is in range, though an insertion may have moved it to another point.
+  if (LastDiagStatePointIdx + 1 < DiagStatePoints.size()) {
+    DiagStatePointsTy::iterator Pos =
+        DiagStatePoints.begin() + LastDiagStatePointIdx;
+    if ((Pos->Loc.isInvalid() ||
+         !Loc.isBeforeInTranslationUnitThan(Pos->Loc)) &&
+        Loc.isBeforeInTranslationUnitThan((Pos + 1)->Loc))
+      return Pos;
+  }
+
+  DiagStatePointsTy::iterator Pos =
+      std::upper_bound(DiagStatePoints.begin(), DiagStatePoints.end(),
+                       DiagStatePoint(nullptr, Loc));
   --Pos;
+  LastDiagStatePointIdx = Pos - DiagStatePoints.begin();
   return Pos;
 }
 
+bool DiagnosticsEngine::isIgnoredEverywhere(unsigned DiagID) const {
+  if (IgnoredEverywhereKnown.test(DiagID))
+    return IgnoredEverywhere.test(DiagID);
+
+  // Every state in use is the state of some point.
+  bool Ignored = true;
+  for (const DiagStatePoint &Point : DiagStatePoints) {
+    DiagnosticMapping &Mapping =
+        Point.State->getOrAddMapping((diag::kind)DiagID);
+    if (Diags->getMappedSeverity(DiagID, Mapping, *this) !=
+        diag::Severity::Ignored) {
+      Ignored = false;
+      break;
+    }
+  }
+
+  IgnoredEverywhereKnown.set(DiagID);
+  IgnoredEverywhere[DiagID] = Ignored;
+  return Ignored;
+}
+
 void DiagnosticsEngine::setSeverity(diag::kind Diag, diag::Severity Map,
                                     SourceLocation L) {
   assert(Diag < diag::DIAG_UPPER_LIMIT &&
@@ -188,6 +228,8 @@ void DiagnosticsEngine::setSeverity(diag::kind Diag, diag::Severity Map,
   assert(!DiagStatePoints.empty());
   assert((L.isInvalid() || SourceMgr) && "No SourceMgr for valid location");
 
+  IgnoredEverywhereKnown.reset(Diag);
+
   FullSourceLoc Loc = SourceMgr? FullSourceLoc(L, *SourceMgr) : FullSourceLoc();
   FullSourceLoc LastStateChangePos = DiagStatePoints.back().Loc;
   // Don't allow a mapping to a warning override an error/fatal mapping.
@@ -18,19 +18,27 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileSystemStatCache.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <functional>
 #include <map>
 #include <set>
 #include <string>
 #include <system_error>
 
+#ifdef LLVM_ON_UNIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace clang;
 
 /// NON_EXISTENT_DIR - A special value distinct from null that is used to
@@ -45,10 +53,37 @@ using namespace clang;
 // Common logic.
 //===----------------------------------------------------------------------===//
 
+SharedFileBuffers::SharedFileBuffers() = default;
+
+SharedFileBuffers::~SharedFileBuffers() = default;
+
+SharedFileBuffers::Shard &SharedFileBuffers::getShard(StringRef Path) {
+  return Shards[llvm::HashString(Path) % NumShards];
+}
+
+const llvm::MemoryBuffer *SharedFileBuffers::lookup(StringRef Path) {
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  auto Known = S.Buffers.find(Path);
+  return Known == S.Buffers.end() ? nullptr : Known->second.get();
+}
+
+const llvm::MemoryBuffer *
+SharedFileBuffers::insert(StringRef Path,
+                          std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  std::unique_ptr<llvm::MemoryBuffer> &Known = S.Buffers[Path];
+  if (!Known)
+    Known = std::move(Buffer);
+  return Known.get();
+}
+
 FileManager::FileManager(const FileSystemOptions &FSO,
                          IntrusiveRefCntPtr<vfs::FileSystem> FS)
   : FS(FS), FileSystemOpts(FSO),
-    SeenDirEntries(64), SeenFileEntries(64), NextFileUID(0) {
+    SeenDirEntries(64), SeenFileEntries(64), NextFileUID(0),
+    SharedBuffers(nullptr), StopPrefetch(false) {
   NumDirLookups = NumFileLookups = 0;
   NumDirCacheMisses = NumFileCacheMisses = 0;
 
@@ -58,7 +93,7 @@ FileManager::FileManager(const FileSystemOptions &FSO,
     this->FS = vfs::getRealFileSystem();
 }
 
-FileManager::~FileManager() = default;
+FileManager::~FileManager() { stopPrefetching(); }
 
 void FileManager::addStatCache(std::unique_ptr<FileSystemStatCache> statCache,
                                bool AtBeginning) {
@@ -413,7 +448,8 @@ bool FileManager::makeAbsolutePath(SmallVectorImpl<char> &Path) const {
 
 llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
 FileManager::getBufferForFile(const FileEntry *Entry, bool isVolatile,
-                              bool ShouldCloseOpenFile) {
+                              bool ShouldCloseOpenFile,
+                              bool RequiresNullTerminator) {
   uint64_t FileSize = Entry->getSize();
   // If there's a high enough chance that the file have changed since we
   // got its size, force a stat before opening it.
@@ -421,11 +457,45 @@ FileManager::getBufferForFile(const FileEntry *Entry, bool isVolatile,
     FileSize = -1;
 
   const char *Filename = Entry->getName();
+
+  if (SharedBuffers && !isVolatile) {
+    SmallString<128> FilePath(Filename);
+    FixupRelativePath(FilePath);
+    if (llvm::sys::path::is_absolute(FilePath)) {
+      const llvm::MemoryBuffer *Shared = SharedBuffers->lookup(FilePath);
+      if (!Shared) {
+        // Always read with a null terminator, so that the shared contents can
+        // serve every request.
+        auto Buffer =
+            Entry->File
+                ? Entry->File->getBuffer(Filename, FileSize,
+                                         /*RequiresNullTerminator=*/true,
+                                         /*IsVolatile=*/false)
+                : FS->getBufferForFile(FilePath, FileSize,
+                                       /*RequiresNullTerminator=*/true,
+                                       /*IsVolatile=*/false);
+        if (!Buffer) {
+          if (ShouldCloseOpenFile)
+            Entry->closeFile();
+          return Buffer.getError();
+        }
+        Shared = SharedBuffers->insert(FilePath, std::move(*Buffer));
+      }
+      if (ShouldCloseOpenFile)
+        Entry->closeFile();
+      // Another compilation may have seen different contents; read them
+      // again if so.
+      if (Shared->getBufferSize() == FileSize)
+        return llvm::MemoryBuffer::getMemBuffer(Shared->getBuffer(), Filename,
+                                                RequiresNullTerminator);
+    }
+  }
+
   // If the file is already open, use the open file descriptor.
   if (Entry->File) {
     auto Result =
         Entry->File->getBuffer(Filename, FileSize,
-                               /*RequiresNullTerminator=*/true, isVolatile);
+                               RequiresNullTerminator, isVolatile);
     // FIXME: we need a set of APIs that can make guarantees about whether a
     // FileEntry is open or not.
     if (ShouldCloseOpenFile)
@@ -437,22 +507,23 @@ FileManager::getBufferForFile(const FileEntry *Entry, bool isVolatile,
 
   if (FileSystemOpts.WorkingDir.empty())
     return FS->getBufferForFile(Filename, FileSize,
-                                /*RequiresNullTerminator=*/true, isVolatile);
+                                RequiresNullTerminator, isVolatile);
 
   SmallString<128> FilePath(Entry->getName());
   FixupRelativePath(FilePath);
   return FS->getBufferForFile(FilePath, FileSize,
-                              /*RequiresNullTerminator=*/true, isVolatile);
+                              RequiresNullTerminator, isVolatile);
 }
 
 llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>>
-FileManager::getBufferForFile(StringRef Filename) {
+FileManager::getBufferForFile(StringRef Filename,
+                              bool RequiresNullTerminator) {
   if (FileSystemOpts.WorkingDir.empty())
-    return FS->getBufferForFile(Filename);
+    return FS->getBufferForFile(Filename, -1, RequiresNullTerminator);
 
   SmallString<128> FilePath(Filename);
   FixupRelativePath(FilePath);
-  return FS->getBufferForFile(FilePath.c_str());
+  return FS->getBufferForFile(FilePath.c_str(), -1, RequiresNullTerminator);
 }
 
 /// getStatValue - Get the 'stat' information for the specified path,
@@ -497,6 +568,109 @@ void FileManager::invalidateCache(const FileEntry *Entry) {
   UniqueRealFiles.erase(Entry->getUniqueID());
 }
 
+/// \brief Collects the prerequisites of the rules of the Makefile-style
+/// dependency file \p Text, or its lines if it has no rules.
+static void parseDependencyList(StringRef Text,
+                                SmallVectorImpl<std::string> &Paths) {
+  std::string Path;
+  // Where the paths of the current rule start.
+  size_t RuleStart = Paths.size();
+  auto Flush = [&] {
+    if (!Path.empty())
+      Paths.push_back(Path);
+    Path.clear();
+  };
+  for (size_t I = 0, E = Text.size(); I != E; ++I) {
+    char C = Text[I];
+    char Next = I + 1 != E ? Text[I + 1] : '\n';
+    if (C == '\\' && (Next == ' ' || Next == '#')) {
+      Path += Next;
+      ++I;
+    } else if (C == '\\' && (Next == '\n' || Next == '\r')) {
+      // A line continuation.
+      Flush();
+      I += Next == '\r' && I + 2 != E && Text[I + 2] == '\n' ? 2 : 1;
+    } else if (C == '$' && Next == '$') {
+      Path += '$';
+      ++I;
+    } else if (C == ':' && isWhitespace(Next)) {
+      // The paths so far are the targets of the rule, not prerequisites.
+      Path.clear();
+      Paths.resize(RuleStart);
+    } else if (isWhitespace(C)) {
+      Flush();
+      if (C == '\n')
+        RuleStart = Paths.size();
+    } else {
+      Path += C;
+    }
+  }
+  Flush();
+}
+
+/// \brief Reads the file at \p Path ahead of time into the operating
+/// system's file cache.
+static void prefetchFile(StringRef Path) {
+#if defined(LLVM_ON_UNIX) && defined(POSIX_FADV_WILLNEED)
+  int FD;
+  if (llvm::sys::fs::openFileForRead(Path, FD))
+    return;
+  // The kernel reads the file in the background, and keeps reading after it
+  // is closed.
+  ::posix_fadvise(FD, 0, 0, POSIX_FADV_WILLNEED);
+  ::close(FD);
+#else
+  // Read the file rather than map it, so that its contents are fetched.
+  llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                              /*RequiresNullTerminator=*/false,
+                              /*IsVolatile=*/true);
+#endif
+}
+
+static void prefetchFileList(const std::vector<std::string> &Paths,
+                             const std::atomic<bool> &Stop) {
+  for (const std::string &Path : Paths) {
+    if (Stop)
+      return;
+    prefetchFile(Path);
+  }
+}
+
+void FileManager::prefetchFiles(StringRef ListPath) {
+  SmallString<128> ListFilePath(ListPath);
+  FixupRelativePath(ListFilePath);
+  auto List = llvm::MemoryBuffer::getFile(ListFilePath);
+  if (!List)
+    return;
+
+  SmallVector<std::string, 64> Deps;
+  parseDependencyList((*List)->getBuffer(), Deps);
+  std::vector<std::string> Paths;
+  for (const std::string &Dep : Deps) {
+    SmallString<128> FilePath(Dep);
+    FixupRelativePath(FilePath);
+    Paths.emplace_back(FilePath.begin(), FilePath.end());
+  }
+
+  stopPrefetching();
+  StopPrefetch = false;
+#if LLVM_ENABLE_THREADS
+  // Opening files is slow on network file systems even before any of their
+  // contents are read, so do it all on a thread that runs ahead of the
+  // preprocessor.
+  PrefetchThread = std::thread(prefetchFileList, std::move(Paths),
+                               std::cref(StopPrefetch));
+#else
+  prefetchFileList(Paths, StopPrefetch);
+#endif
+}
+
+void FileManager::stopPrefetching() {
+  StopPrefetch = true;
+  if (PrefetchThread.joinable())
+    PrefetchThread.join();
+}
+
 
 void FileManager::GetUniqueIDMapping(
                    SmallVectorImpl<const FileEntry *> &UIDToFiles) const {
@@ -13,7 +13,9 @@
 
 #include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
 
 using namespace clang;
 
@@ -124,3 +126,69 @@ MemorizeStatCalls::getStat(const char *Path, FileData &Data, bool isFile,
 
   return Result;
 }
+
+SharedStatResults::Shard &SharedStatResults::getShard(StringRef Path) {
+  return Shards[llvm::HashString(Path) % NumShards];
+}
+
+bool SharedStatResults::lookup(StringRef Path,
+                               llvm::Optional<FileData> &Result) {
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  auto Known = S.Results.find(Path);
+  if (Known == S.Results.end())
+    return false;
+  Result = Known->second;
+  return true;
+}
+
+void SharedStatResults::insert(StringRef Path,
+                               const llvm::Optional<FileData> &Result) {
+  Shard &S = getShard(Path);
+  std::lock_guard<std::mutex> Lock(S.Mutex);
+  S.Results[Path] = Result;
+}
+
+void SharedStatResults::clear() {
+  for (Shard &S : Shards) {
+    std::lock_guard<std::mutex> Lock(S.Mutex);
+    S.Results.clear();
+  }
+}
+
+static bool isInDirectory(StringRef Path, StringRef Directory) {
+  Directory = Directory.rtrim('/');
+  return Path.startswith(Directory) && Path.size() > Directory.size() &&
+         llvm::sys::path::is_separator(Path[Directory.size()]);
+}
+
+FileSystemStatCache::LookupResult
+SharedStatResultsCache::getStat(const char *Path, FileData &Data, bool isFile,
+                                std::unique_ptr<vfs::File> *F,
+                                vfs::FileSystem &FS) {
+  // Relative paths depend on the working directory of the compilation.
+  if (!llvm::sys::path::is_absolute(Path))
+    return statChained(Path, Data, isFile, F, FS);
+
+  if (!Directories.empty() &&
+      std::none_of(Directories.begin(), Directories.end(),
+                   [&](const std::string &Directory) {
+                     return isInDirectory(Path, Directory);
+                   }))
+    return statChained(Path, Data, isFile, F, FS);
+
+  llvm::Optional<FileData> Known;
+  if (Shared.lookup(Path, Known)) {
+    if (!Known)
+      return CacheMissing;
+    Data = *Known;
+    return CacheExists;
+  }
+
+  LookupResult Result = statChained(Path, Data, isFile, F, FS);
+  if (Result == CacheExists)
+    Shared.insert(Path, Data);
+  else
+    Shared.insert(Path, llvm::None);
+  return Result;
+}
@@ -40,7 +40,13 @@ bool SanitizerBlacklist::isBlacklistedFile(StringRef FileName,
 
 bool SanitizerBlacklist::isBlacklistedLocation(SourceLocation Loc,
                                                StringRef Category) const {
-  return Loc.isValid() &&
-         isBlacklistedFile(SM.getFilename(SM.getFileLoc(Loc)), Category);
+  if (Loc.isInvalid())
+    return false;
+  Loc = SM.getFileLoc(Loc);
+  FileID FID = SM.getFileID(Loc);
+  auto Known = BlacklistedFiles[Category].insert(std::make_pair(FID, false));
+  if (Known.second)
+    Known.first->second = isBlacklistedFile(SM.getFilename(Loc), Category);
+  return Known.first->second;
 }
 
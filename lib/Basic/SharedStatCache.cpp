@@ -0,0 +1,258 @@
+//===--- SharedStatCache.cpp - Process-shared 'stat' cache ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the SharedStatCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/SharedStatCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Atomic.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeValue.h"
+#include <cstring>
+
+using namespace clang;
+using llvm::sys::cas_flag;
+
+/// The layout of the file starts with this header...
+struct SharedStatCache::Header {
+  char Magic[8];
+  uint32_t Version;
+  uint32_t NumSlots;
+  char Padding[48];
+};
+
+/// ...followed by NumSlots of these.
+struct SharedStatCache::Slot {
+  /// Even when the slot is stable, odd while it is being written.  Zero means
+  /// the slot has never been used.
+  cas_flag Seq;
+  uint32_t Flags;
+  uint64_t KeyHi;
+  uint64_t KeyLo;
+  int64_t ParentModTime;
+  uint64_t Size;
+  int64_t ModTime;
+  uint64_t Device;
+  uint64_t File;
+};
+
+static_assert(sizeof(SharedStatCache::Header) == 64, "unexpected padding");
+static_assert(sizeof(SharedStatCache::Slot) == 64, "unexpected padding");
+
+static const char CacheMagic[8] = {'C', 'L', 'S', 'T', 'A', 'T', 'C', '\0'};
+enum { CacheVersion = 1 };
+enum { DefaultNumSlots = 1 << 16, MaxProbes = 8 };
+enum { SlotExists = 0x1, SlotIsDirectory = 0x2, SlotIsNamedPipe = 0x4 };
+
+/// Directories modified more recently than this many seconds ago may be
+/// modified again without their modification time changing.
+enum { RacyModTimeWindow = 2 };
+
+SharedStatCache::SharedStatCache(
+    std::unique_ptr<llvm::sys::fs::mapped_file_region> Region,
+    StringRef WorkingDir)
+    : Region(std::move(Region)), WorkingDir(WorkingDir),
+      OpenTime(llvm::sys::TimeValue::now().toEpochTime()), NumHits(0),
+      NumMisses(0) {}
+
+SharedStatCache::~SharedStatCache() {}
+
+std::unique_ptr<SharedStatCache> SharedStatCache::create(StringRef Path) {
+  using namespace llvm::sys::fs;
+  const uint64_t FileSize = sizeof(Header) + DefaultNumSlots * sizeof(Slot);
+
+  // Open without truncating; other processes may already be using the file.
+  int FD;
+  if (openFileForWrite(Path, FD, F_RW | F_Append))
+    return nullptr;
+
+  // Every process grows the file to the same size, and a freshly grown file
+  // reads as zeros, i.e. an empty table, so racing creators are harmless.
+  file_status Status;
+  if (status(FD, Status) ||
+      (Status.getSize() < FileSize && resize_file(FD, FileSize))) {
+    llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+    return nullptr;
+  }
+
+  std::error_code EC;
+  auto Region = llvm::make_unique<mapped_file_region>(
+      FD, mapped_file_region::readwrite, FileSize, 0, EC);
+  llvm::sys::Process::SafelyCloseFileDescriptor(FD);
+  if (EC)
+    return nullptr;
+
+  // Initialize the header, or check that it was written by a compatible
+  // version of the compiler.  Concurrent initializers write the same bytes.
+  Header *H = reinterpret_cast<Header *>(Region->data());
+  static const char Zeros[sizeof(CacheMagic)] = {};
+  if (memcmp(H->Magic, Zeros, sizeof(Zeros)) == 0) {
+    H->Version = CacheVersion;
+    H->NumSlots = DefaultNumSlots;
+    llvm::sys::MemoryFence();
+    memcpy(H->Magic, CacheMagic, sizeof(CacheMagic));
+  } else if (memcmp(H->Magic, CacheMagic, sizeof(CacheMagic)) != 0 ||
+             H->Version != CacheVersion || H->NumSlots != DefaultNumSlots) {
+    return nullptr;
+  }
+
+  SmallString<256> WorkingDir;
+  if (current_path(WorkingDir))
+    return nullptr;
+
+  return std::unique_ptr<SharedStatCache>(
+      new SharedStatCache(std::move(Region), WorkingDir));
+}
+
+SharedStatCache::Slot *SharedStatCache::getSlots() {
+  return reinterpret_cast<Slot *>(Region->data() + sizeof(Header));
+}
+
+unsigned SharedStatCache::getNumSlots() {
+  return reinterpret_cast<Header *>(Region->data())->NumSlots;
+}
+
+bool SharedStatCache::getParentModTime(StringRef AbsPath, vfs::FileSystem &FS,
+                                       int64_t &ModTime) {
+  StringRef Parent = llvm::sys::path::parent_path(AbsPath);
+  auto Known = ParentModTimes.insert(std::make_pair(Parent, int64_t(-1)));
+  if (Known.second) {
+    llvm::ErrorOr<vfs::Status> Status = FS.status(Parent);
+    if (Status) {
+      time_t MTime = Status->getLastModificationTime().toEpochTime();
+      Known.first->second =
+          OpenTime - MTime < RacyModTimeWindow ? -2 : int64_t(MTime);
+    }
+  }
+  ModTime = Known.first->second;
+  return ModTime != -2;
+}
+
+bool SharedStatCache::lookup(uint64_t KeyHi, uint64_t KeyLo,
+                             int64_t ParentModTime, FileData &Data,
+                             bool &Exists) {
+  Slot *Slots = getSlots();
+  unsigned Mask = getNumSlots() - 1;
+  for (unsigned Probe = 0; Probe != MaxProbes; ++Probe) {
+    Slot *S = &Slots[(KeyLo + Probe) & Mask];
+    cas_flag Before = *static_cast<volatile cas_flag *>(&S->Seq);
+    if (Before == 0)
+      return false; // End of the probe sequence.
+    if (Before & 1)
+      continue; // Being written right now.
+
+    llvm::sys::MemoryFence();
+    Slot Copy;
+    memcpy(&Copy, S, sizeof(Slot));
+    llvm::sys::MemoryFence();
+    if (*static_cast<volatile cas_flag *>(&S->Seq) != Before)
+      continue; // Torn read.
+
+    if (Copy.KeyHi != KeyHi || Copy.KeyLo != KeyLo)
+      continue;
+    if (Copy.ParentModTime != ParentModTime)
+      return false; // Stale; the caller will overwrite it.
+
+    Exists = Copy.Flags & SlotExists;
+    if (Exists) {
+      Data.Size = Copy.Size;
+      Data.ModTime = Copy.ModTime;
+      Data.UniqueID = llvm::sys::fs::UniqueID(Copy.Device, Copy.File);
+      Data.IsDirectory = Copy.Flags & SlotIsDirectory;
+      Data.IsNamedPipe = Copy.Flags & SlotIsNamedPipe;
+      Data.InPCH = false;
+      Data.IsVFSMapped = false;
+    }
+    return true;
+  }
+  return false;
+}
+
+void SharedStatCache::insert(uint64_t KeyHi, uint64_t KeyLo,
+                             int64_t ParentModTime, const FileData &Data,
+                             bool Exists) {
+  Slot *Slots = getSlots();
+  unsigned Mask = getNumSlots() - 1;
+  for (unsigned Probe = 0; Probe != MaxProbes; ++Probe) {
+    Slot *S = &Slots[(KeyLo + Probe) & Mask];
+    volatile cas_flag *Seq = &S->Seq;
+    cas_flag Old = *Seq;
+    if (Old & 1)
+      continue;
+    // Only claim an empty slot or the (stale) slot for this key.
+    if (Old != 0 && (S->KeyHi != KeyHi || S->KeyLo != KeyLo))
+      continue;
+    if (llvm::sys::CompareAndSwap(Seq, Old + 1, Old) != Old)
+      return; // Somebody else is writing this entry; let them.
+
+    llvm::sys::MemoryFence();
+    S->KeyHi = KeyHi;
+    S->KeyLo = KeyLo;
+    S->ParentModTime = ParentModTime;
+    S->Flags = 0;
+    S->Size = S->ModTime = S->Device = S->File = 0;
+    if (Exists) {
+      S->Flags = SlotExists | (Data.IsDirectory ? SlotIsDirectory : 0) |
+                 (Data.IsNamedPipe ? SlotIsNamedPipe : 0);
+      S->Size = Data.Size;
+      S->ModTime = Data.ModTime;
+      S->Device = Data.UniqueID.getDevice();
+      S->File = Data.UniqueID.getFile();
+    }
+    llvm::sys::MemoryFence();
+    *Seq = Old + 2;
+    return;
+  }
+}
+
+SharedStatCache::LookupResult
+SharedStatCache::getStat(const char *Path, FileData &Data, bool isFile,
+                         std::unique_ptr<vfs::File> *F, vfs::FileSystem &FS) {
+  SmallString<256> AbsPath;
+  if (llvm::sys::path::is_relative(Path)) {
+    AbsPath = WorkingDir;
+    llvm::sys::path::append(AbsPath, Path);
+  } else {
+    AbsPath = Path;
+  }
+
+  int64_t ParentModTime;
+  if (!getParentModTime(AbsPath, FS, ParentModTime))
+    return statChained(Path, Data, isFile, F, FS);
+
+  llvm::MD5 Hash;
+  Hash.update(AbsPath);
+  llvm::MD5::MD5Result Digest;
+  Hash.final(Digest);
+  uint64_t KeyHi, KeyLo;
+  memcpy(&KeyHi, &Digest[0], sizeof(KeyHi));
+  memcpy(&KeyLo, &Digest[8], sizeof(KeyLo));
+
+  bool Exists;
+  if (lookup(KeyHi, KeyLo, ParentModTime, Data, Exists)) {
+    ++NumHits;
+    if (!Exists)
+      return CacheMissing;
+    Data.Name = Path;
+    return CacheExists;
+  }
+
+  ++NumMisses;
+  LookupResult Result = statChained(Path, Data, isFile, F, FS);
+  if (Result == CacheMissing)
+    insert(KeyHi, KeyLo, ParentModTime, Data, /*Exists=*/false);
+  else if (Data.IsDirectory && !Data.IsVFSMapped)
+    insert(KeyHi, KeyLo, ParentModTime, Data, /*Exists=*/true);
+  return Result;
+}
@@ -20,6 +20,7 @@
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/Capacity.h"
 #include "llvm/Support/Compiler.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
@@ -362,8 +363,9 @@ SourceManager::SourceManager(DiagnosticsEngine &Diag, FileManager &FileMgr,
                              bool UserFilesAreVolatile)
   : Diag(Diag), FileMgr(FileMgr), OverridenFilesKeepOriginalName(true),
     UserFilesAreVolatile(UserFilesAreVolatile), FilesAreTransient(false),
-    ExternalSLocEntries(nullptr), LineTable(nullptr), NumLinearScans(0),
-    NumBinaryProbes(0) {
+    CoalesceMacroArgExpansions(false), ExternalSLocEntries(nullptr),
+    LineTable(nullptr), NumLinearScans(0), NumBinaryProbes(0),
+    NumFileIDLookupCacheHits(0), NumCoalescedMacroArgExpansions(0) {
   clearIDTables();
   Diag.setSourceManager(this);
 }
@@ -394,11 +396,15 @@ SourceManager::~SourceManager() {
 void SourceManager::clearIDTables() {
   MainFileID = FileID();
   LocalSLocEntryTable.clear();
+  LocalSLocEntryOffsets.clear();
+  CoalescedMacroArgExpansions.clear();
+  LoadedCoalescedMacroArgExpansions.clear();
   LoadedSLocEntryTable.clear();
   SLocEntryLoaded.clear();
   LastLineNoFileIDQuery = FileID();
   LastLineNoContentCache = nullptr;
   LastFileIDLookup = FileID();
+  clearFileIDLookupCache();
 
   if (LineTable)
     LineTable->clear();
@@ -573,6 +579,7 @@ FileID SourceManager::createFileID(const ContentCache *File,
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset,
                                                FileInfo::get(IncludePos, File,
                                                              FileCharacter)));
+  LocalSLocEntryOffsets.push_back(NextLocalOffset);
   unsigned FileSize = File->getSize();
   assert(NextLocalOffset + FileSize + 1 > NextLocalOffset &&
          NextLocalOffset + FileSize + 1 <= CurrentLoadedOffset &&
@@ -591,11 +598,151 @@ SourceLocation
 SourceManager::createMacroArgExpansionLoc(SourceLocation SpellingLoc,
                                           SourceLocation ExpansionLoc,
                                           unsigned TokLength) {
+  if (CoalesceMacroArgExpansions) {
+    SourceLocation Loc =
+        coalesceMacroArgExpansion(SpellingLoc, ExpansionLoc, TokLength);
+    if (Loc.isValid())
+      return Loc;
+  }
+
   ExpansionInfo Info = ExpansionInfo::createForMacroArg(SpellingLoc,
                                                         ExpansionLoc);
   return createExpansionLocImpl(Info, TokLength);
 }
 
+/// \brief Try to extend the last local SLocEntry so that it also covers a new
+/// macro argument expansion.
+///
+/// This is possible when the entry expands another argument of the same macro
+/// invocation and the new argument is spelled shortly after it, so that the
+/// spelling location of every offset in the extended entry is still exact.
+///
+/// The offsets of the gap between the arguments are skipped. A new entry would
+/// take the token length plus one offset, so the gap is limited to a comma and
+/// a space: coalescing then costs at most one more offset than a new entry.
+///
+/// \returns the location of the expanded argument, or an invalid location if
+/// a new entry is needed.
+SourceLocation
+SourceManager::coalesceMacroArgExpansion(SourceLocation SpellingLoc,
+                                         SourceLocation ExpansionLoc,
+                                         unsigned TokLength) {
+  const SLocEntry &Last = LocalSLocEntryTable.back();
+  if (!Last.isExpansion() || !Last.getExpansion().isMacroArgExpansion())
+    return SourceLocation();
+
+  // All arguments of an invocation are expanded into the same macro body.
+  SourceLocation LastExpansionLoc =
+      getExpansionLocStart(Last, NextLocalOffset - 1);
+  if (!ExpansionLoc.isMacroID() || !LastExpansionLoc.isMacroID() ||
+      !isInFileID(ExpansionLoc, getFileID(LastExpansionLoc)))
+    return SourceLocation();
+
+  // The new tokens must be spelled after the ones already covered, in the
+  // same file, and close enough that the gap does not waste address space.
+  SourceLocation LastSpellingLoc = Last.getExpansion().getSpellingLoc();
+  int RelOffs;
+  if (LastSpellingLoc.isFileID() != SpellingLoc.isFileID() ||
+      !isInSameSLocAddrSpace(LastSpellingLoc, SpellingLoc, &RelOffs) ||
+      RelOffs < 0)
+    return SourceLocation();
+  unsigned Length = NextLocalOffset - Last.getOffset() - 1;
+  if (unsigned(RelOffs) < Length || unsigned(RelOffs) - Length > 2 ||
+      !isWrittenInSameFile(LastSpellingLoc, SpellingLoc))
+    return SourceLocation();
+
+  unsigned Offset = Last.getOffset() + RelOffs;
+  assert(Offset + TokLength + 1 > Offset &&
+         Offset + TokLength + 1 <= CurrentLoadedOffset &&
+         "Ran out of source locations!");
+  // Arguments that are expanded at the same place need no record; this
+  // happens when the tokens of one argument are split into several runs.
+  if (ExpansionLoc != LastExpansionLoc) {
+    CoalescedMacroArgExpansion Arg = {NextLocalOffset - 1, Offset,
+                                      ExpansionLoc};
+    CoalescedMacroArgExpansions.push_back(Arg);
+  }
+  ++NumCoalescedMacroArgExpansions;
+  NextLocalOffset = Offset + TokLength + 1;
+  return SourceLocation::getMacroLoc(Offset);
+}
+
+void SourceManager::addLoadedCoalescedMacroArgExpansions(
+    ArrayRef<CoalescedMacroArgExpansion> Args) {
+  size_t Size = LoadedCoalescedMacroArgExpansions.size();
+  LoadedCoalescedMacroArgExpansions.insert(
+      LoadedCoalescedMacroArgExpansions.end(), Args.begin(), Args.end());
+  std::inplace_merge(LoadedCoalescedMacroArgExpansions.begin(),
+                     LoadedCoalescedMacroArgExpansions.begin() + Size,
+                     LoadedCoalescedMacroArgExpansions.end(),
+                     [](const CoalescedMacroArgExpansion &LHS,
+                        const CoalescedMacroArgExpansion &RHS) {
+                       return LHS.Begin < RHS.Begin;
+                     });
+}
+
+/// \brief Return the argument expansions that were coalesced into the macro
+/// argument expansion \p FID, in offset order.
+ArrayRef<SourceManager::CoalescedMacroArgExpansion>
+SourceManager::getCoalescedMacroArgExpansions(FileID FID) const {
+  if (CoalescedMacroArgExpansions.empty() &&
+      LoadedCoalescedMacroArgExpansions.empty())
+    return None;
+
+  bool Invalid = false;
+  const SLocEntry &Entry = getSLocEntry(FID, &Invalid);
+  if (Invalid || !Entry.isExpansion() ||
+      !Entry.getExpansion().isMacroArgExpansion())
+    return None;
+
+  const std::vector<CoalescedMacroArgExpansion> &Table =
+      getCoalescedMacroArgExpansionTable(Entry.getOffset());
+  auto ByBegin = [](const CoalescedMacroArgExpansion &Arg, unsigned Offset) {
+    return Arg.Begin < Offset;
+  };
+  unsigned Begin = Entry.getOffset();
+  unsigned End = Begin + getFileIDSize(FID);
+  auto I = std::lower_bound(Table.begin(), Table.end(), Begin, ByBegin);
+  auto E = std::lower_bound(I, Table.end(), End, ByBegin);
+  return makeArrayRef(Table.data() + (I - Table.begin()), E - I);
+}
+
+/// \brief Find the coalesced macro argument expansion that \p SLocOffset
+/// belongs to, if it is in a later argument of the entry \p Entry.
+const SourceManager::CoalescedMacroArgExpansion *
+SourceManager::findCoalescedMacroArgExpansion(const SrcMgr::SLocEntry &Entry,
+                                              unsigned SLocOffset) const {
+  const std::vector<CoalescedMacroArgExpansion> &Table =
+      getCoalescedMacroArgExpansionTable(SLocOffset);
+  if (Table.empty() || !Entry.getExpansion().isMacroArgExpansion())
+    return nullptr;
+
+  auto I = std::upper_bound(Table.begin(), Table.end(), SLocOffset,
+                            [](unsigned Offset,
+                               const CoalescedMacroArgExpansion &Arg) {
+                              return Offset < Arg.Begin;
+                            });
+  if (I == Table.begin())
+    return nullptr;
+  --I;
+  // The closest record may belong to an earlier entry.
+  if (I->Begin < Entry.getOffset())
+    return nullptr;
+  return &*I;
+}
+
+/// \brief Return the expansion location of the macro expansion \p Entry at
+/// \p SLocOffset. This differs from the entry's own expansion location in
+/// arguments that were coalesced into it.
+SourceLocation
+SourceManager::getExpansionLocStart(const SrcMgr::SLocEntry &Entry,
+                                    unsigned SLocOffset) const {
+  if (const CoalescedMacroArgExpansion *Arg =
+          findCoalescedMacroArgExpansion(Entry, SLocOffset))
+    return Arg->ExpansionLoc;
+  return Entry.getExpansion().getExpansionLocStart();
+}
+
 SourceLocation
 SourceManager::createExpansionLoc(SourceLocation SpellingLoc,
                                   SourceLocation ExpansionLocStart,
@@ -623,6 +770,7 @@ SourceManager::createExpansionLocImpl(const ExpansionInfo &Info,
     return SourceLocation::getMacroLoc(LoadedOffset);
   }
   LocalSLocEntryTable.push_back(SLocEntry::get(NextLocalOffset, Info));
+  LocalSLocEntryOffsets.push_back(NextLocalOffset);
   assert(NextLocalOffset + TokLength + 1 > NextLocalOffset &&
          NextLocalOffset + TokLength + 1 <= CurrentLoadedOffset &&
          "Ran out of source locations!");
@@ -714,11 +862,43 @@ FileID SourceManager::getFileIDSlow(unsigned SLocOffset) const {
 
   // Now it is time to search for the correct file. See where the SLocOffset
   // sits in the global view and consult local or loaded buffers for it.
-  if (SLocOffset < NextLocalOffset)
+  if (SLocOffset < NextLocalOffset) {
+    for (const FileIDLookupCacheEntry &Entry : FileIDLookupCache) {
+      // Empty entries have Begin == End, so this never matches them.
+      if (SLocOffset - Entry.Begin < Entry.End - Entry.Begin) {
+        ++NumFileIDLookupCacheHits;
+        return Entry.FID;
+      }
+    }
     return getFileIDLocal(SLocOffset);
+  }
   return getFileIDLoaded(SLocOffset);
 }
 
+/// \brief Remember that the local entry at \p Index was just looked up, and
+/// return its FileID.
+FileID SourceManager::cacheLocalFileIDLookup(unsigned Index) const {
+  FileIDLookupCacheEntry &Entry =
+      FileIDLookupCache[NextFileIDLookupCacheEntry++ %
+                        NumFileIDLookupCacheEntries];
+  Entry.Begin = LocalSLocEntryOffsets[Index];
+  // The last entry extends to NextLocalOffset.  Entries created later start
+  // at or after the current value, so this range stays correct.
+  Entry.End = Index + 1 < LocalSLocEntryOffsets.size()
+                  ? LocalSLocEntryOffsets[Index + 1]
+                  : NextLocalOffset;
+  Entry.FID = FileID::get(Index);
+  return Entry.FID;
+}
+
+void SourceManager::clearFileIDLookupCache() const {
+  for (FileIDLookupCacheEntry &Entry : FileIDLookupCache) {
+    Entry.Begin = Entry.End = 0;
+    Entry.FID = FileID();
+  }
+  NextFileIDLookupCacheEntry = 0;
+}
+
 /// \brief Return the FileID for a SourceLocation with a low offset.
 ///
 /// This function knows that the SourceLocation is in a local buffer, not a
@@ -733,81 +913,51 @@ FileID SourceManager::getFileIDLocal(unsigned SLocOffset) const {
   //
   // To handle this, we do a linear search for up to 8 steps to catch #1 quickly
   // then we fall back to a less cache efficient, but more scalable, binary
-  // search to find the location.
+  // search to find the location.  Both only look at the dense offset array.
+  const unsigned *Offsets = LocalSLocEntryOffsets.data();
 
   // See if this is near the file point - worst case we start scanning from the
   // most newly created FileID.
-  const SrcMgr::SLocEntry *I;
-
+  unsigned GreaterIndex;
   if (LastFileIDLookup.ID < 0 ||
-      LocalSLocEntryTable[LastFileIDLookup.ID].getOffset() < SLocOffset) {
+      Offsets[LastFileIDLookup.ID] < SLocOffset) {
     // Neither loc prunes our search.
-    I = LocalSLocEntryTable.end();
+    GreaterIndex = LocalSLocEntryOffsets.size();
   } else {
     // Perhaps it is near the file point.
-    I = LocalSLocEntryTable.begin()+LastFileIDLookup.ID;
+    GreaterIndex = LastFileIDLookup.ID;
   }
 
-  // Find the FileID that contains this.  "I" is an iterator that points to a
-  // FileID whose offset is known to be larger than SLocOffset.
+  // Find the FileID that contains this.  "GreaterIndex" is the index of an
+  // entry whose offset is known to be larger than SLocOffset.  Offsets are
+  // strictly increasing, so the last entry starting at or before SLocOffset
+  // is the one containing it.
   unsigned NumProbes = 0;
   while (1) {
-    --I;
-    if (I->getOffset() <= SLocOffset) {
-      FileID Res = FileID::get(int(I - LocalSLocEntryTable.begin()));
-
+    --GreaterIndex;
+    if (Offsets[GreaterIndex] <= SLocOffset) {
       // If this isn't an expansion, remember it.  We have good locality across
       // FileID lookups.
-      if (!I->isExpansion())
-        LastFileIDLookup = Res;
+      if (!LocalSLocEntryTable[GreaterIndex].isExpansion())
+        LastFileIDLookup = FileID::get(GreaterIndex);
       NumLinearScans += NumProbes+1;
-      return Res;
+      return cacheLocalFileIDLookup(GreaterIndex);
     }
     if (++NumProbes == 8)
       break;
   }
 
-  // Convert "I" back into an index.  We know that it is an entry whose index is
-  // larger than the offset we are looking for.
-  unsigned GreaterIndex = I - LocalSLocEntryTable.begin();
-  // LessIndex - This is the lower bound of the range that we're searching.
-  // We know that the offset corresponding to the FileID is is less than
-  // SLocOffset.
-  unsigned LessIndex = 0;
-  NumProbes = 0;
-  while (1) {
-    bool Invalid = false;
-    unsigned MiddleIndex = (GreaterIndex-LessIndex)/2+LessIndex;
-    unsigned MidOffset = getLocalSLocEntry(MiddleIndex, &Invalid).getOffset();
-    if (Invalid)
-      return FileID::get(0);
-    
-    ++NumProbes;
-
-    // If the offset of the midpoint is too large, chop the high side of the
-    // range to the midpoint.
-    if (MidOffset > SLocOffset) {
-      GreaterIndex = MiddleIndex;
-      continue;
-    }
-
-    // If the middle index contains the value, succeed and return.
-    // FIXME: This could be made faster by using a function that's aware of
-    // being in the local area.
-    if (isOffsetInFileID(FileID::get(MiddleIndex), SLocOffset)) {
-      FileID Res = FileID::get(MiddleIndex);
+  // Entry 0 starts at offset 0, so the upper bound is never the first entry.
+  const unsigned *I =
+      std::upper_bound(Offsets, Offsets + GreaterIndex, SLocOffset);
+  unsigned Index = I - Offsets - 1;
+  NumBinaryProbes += llvm::Log2_32_Ceil(GreaterIndex) + 1;
 
-      // If this isn't a macro expansion, remember it.  We have good locality
-      // across FileID lookups.
-      if (!LocalSLocEntryTable[MiddleIndex].isExpansion())
-        LastFileIDLookup = Res;
-      NumBinaryProbes += NumProbes;
-      return Res;
-    }
-
-    // Otherwise, move the low-side up to the middle index.
-    LessIndex = MiddleIndex;
-  }
+  // If this isn't a macro expansion, remember it.  We have good locality
+  // across FileID lookups.
+  if (!LocalSLocEntryTable[Index].isExpansion())
+    LastFileIDLookup = FileID::get(Index);
+  return cacheLocalFileIDLookup(Index);
 }
 
 /// \brief Return the FileID for a SourceLocation with a high offset.
@@ -897,7 +1047,7 @@ getExpansionLocSlowCase(SourceLocation Loc) const {
     // location is the macro invocation, which the offset has nothing to do
     // with.  This is unlike when we get the spelling loc, because the offset
     // directly correspond to the token whose spelling we're inspecting.
-    Loc = getSLocEntry(getFileID(Loc)).getExpansion().getExpansionLocStart();
+    Loc = getExpansionLocStart(getSLocEntry(getFileID(Loc)), Loc.getOffset());
   } while (!Loc.isFileID());
 
   return Loc;
@@ -924,14 +1074,13 @@ SourceLocation SourceManager::getFileLocSlowCase(SourceLocation Loc) const {
 
 
 std::pair<FileID, unsigned>
-SourceManager::getDecomposedExpansionLocSlowCase(
-                                             const SrcMgr::SLocEntry *E) const {
+SourceManager::getDecomposedExpansionLocSlowCase(const SrcMgr::SLocEntry *E,
+                                                 unsigned Offset) const {
   // If this is an expansion record, walk through all the expansion points.
   FileID FID;
   SourceLocation Loc;
-  unsigned Offset;
   do {
-    Loc = E->getExpansion().getExpansionLocStart();
+    Loc = getExpansionLocStart(*E, E->getOffset() + Offset);
 
     FID = getFileID(Loc);
     E = &getSLocEntry(FID);
@@ -976,7 +1125,13 @@ SourceLocation SourceManager::getImmediateSpellingLoc(SourceLocation Loc) const{
 std::pair<SourceLocation,SourceLocation>
 SourceManager::getImmediateExpansionRange(SourceLocation Loc) const {
   assert(Loc.isMacroID() && "Not a macro expansion loc!");
-  const ExpansionInfo &Expansion = getSLocEntry(getFileID(Loc)).getExpansion();
+  const SLocEntry &Entry = getSLocEntry(getFileID(Loc));
+  const ExpansionInfo &Expansion = Entry.getExpansion();
+  if (Expansion.isMacroArgExpansion()) {
+    // Argument expansions begin and end at the same place.
+    SourceLocation ArgLoc = getExpansionLocStart(Entry, Loc.getOffset());
+    return std::make_pair(ArgLoc, ArgLoc);
+  }
   return Expansion.getExpansionLocRange();
 }
 
@@ -1003,11 +1158,11 @@ bool SourceManager::isMacroArgExpansion(SourceLocation Loc,
   if (!Loc.isMacroID()) return false;
 
   FileID FID = getFileID(Loc);
-  const SrcMgr::ExpansionInfo &Expansion = getSLocEntry(FID).getExpansion();
-  if (!Expansion.isMacroArgExpansion()) return false;
+  const SrcMgr::SLocEntry &Entry = getSLocEntry(FID);
+  if (!Entry.getExpansion().isMacroArgExpansion()) return false;
 
   if (StartLoc)
-    *StartLoc = Expansion.getExpansionLocStart();
+    *StartLoc = getExpansionLocStart(Entry, Loc.getOffset());
   return true;
 }
 
@@ -1024,17 +1179,22 @@ bool SourceManager::isAtStartOfImmediateMacroExpansion(SourceLocation Loc,
   assert(Loc.isValid() && Loc.isMacroID() && "Expected a valid macro loc");
 
   std::pair<FileID, unsigned> DecompLoc = getDecomposedLoc(Loc);
-  if (DecompLoc.second > 0)
-    return false; // Does not point at the start of expansion range.
-
   bool Invalid = false;
-  const SrcMgr::ExpansionInfo &ExpInfo =
-      getSLocEntry(DecompLoc.first, &Invalid).getExpansion();
+  const SrcMgr::SLocEntry &Entry = getSLocEntry(DecompLoc.first, &Invalid);
   if (Invalid)
     return false;
+  const SrcMgr::ExpansionInfo &ExpInfo = Entry.getExpansion();
   SourceLocation ExpLoc = ExpInfo.getExpansionLocStart();
 
-  if (ExpInfo.isMacroArgExpansion()) {
+  if (DecompLoc.second > 0) {
+    // Does not point at the start of expansion range, unless this is where a
+    // coalesced macro argument begins.
+    const CoalescedMacroArgExpansion *Arg =
+        findCoalescedMacroArgExpansion(Entry, Loc.getOffset());
+    if (!Arg || Arg->Offset != Loc.getOffset())
+      return false;
+    ExpLoc = Arg->ExpansionLoc;
+  } else if (ExpInfo.isMacroArgExpansion()) {
     // For macro argument expansions, check if the previous FileID is part of
     // the same argument expansion, in which case this Loc is not at the
     // beginning of the expansion.
@@ -1044,7 +1204,7 @@ bool SourceManager::isAtStartOfImmediateMacroExpansion(SourceLocation Loc,
       if (Invalid)
         return false;
       if (PrevEntry.isExpansion() &&
-          PrevEntry.getExpansion().getExpansionLocStart() == ExpLoc)
+          getExpansionLocStart(PrevEntry, Entry.getOffset() - 1) == ExpLoc)
         return false;
     }
   }
@@ -1059,16 +1219,26 @@ bool SourceManager::isAtEndOfImmediateMacroExpansion(SourceLocation Loc,
   assert(Loc.isValid() && Loc.isMacroID() && "Expected a valid macro loc");
 
   FileID FID = getFileID(Loc);
-  SourceLocation NextLoc = Loc.getLocWithOffset(1);
-  if (isInFileID(NextLoc, FID))
-    return false; // Does not point at the end of expansion range.
-
   bool Invalid = false;
-  const SrcMgr::ExpansionInfo &ExpInfo =
-      getSLocEntry(FID, &Invalid).getExpansion();
+  const SrcMgr::SLocEntry &Entry = getSLocEntry(FID, &Invalid);
   if (Invalid)
     return false;
+  const SrcMgr::ExpansionInfo &ExpInfo = Entry.getExpansion();
 
+  SourceLocation NextLoc = Loc.getLocWithOffset(1);
+  if (isInFileID(NextLoc, FID)) {
+    // Does not point at the end of expansion range, unless this is where a
+    // coalesced macro argument ends.
+    const CoalescedMacroArgExpansion *Arg =
+        findCoalescedMacroArgExpansion(Entry, Loc.getOffset());
+    if (!Arg || Arg->Begin != Loc.getOffset())
+      return false;
+    if (MacroEnd)
+      *MacroEnd = getExpansionLocStart(Entry, Loc.getOffset() - 1);
+    return true;
+  }
+
+  SourceLocation ExpLoc = getExpansionLocStart(Entry, Loc.getOffset());
   if (ExpInfo.isMacroArgExpansion()) {
     // For macro argument expansions, check if the next FileID is part of the
     // same argument expansion, in which case this Loc is not at the end of the
@@ -1079,14 +1249,14 @@ bool SourceManager::isAtEndOfImmediateMacroExpansion(SourceLocation Loc,
       if (Invalid)
         return false;
       if (NextEntry.isExpansion() &&
-          NextEntry.getExpansion().getExpansionLocStart() ==
-              ExpInfo.getExpansionLocStart())
+          NextEntry.getExpansion().getExpansionLocStart() == ExpLoc)
         return false;
     }
   }
 
   if (MacroEnd)
-    *MacroEnd = ExpInfo.getExpansionLocEnd();
+    *MacroEnd = ExpInfo.isMacroArgExpansion() ? ExpLoc
+                                              : ExpInfo.getExpansionLocEnd();
   return true;
 }
 
@@ -1834,10 +2004,24 @@ void SourceManager::computeMacroArgsCache(MacroArgsMap *&CachePtr,
     if (!ExpInfo.isMacroArgExpansion())
       continue;
 
-    associateFileChunkWithMacroArgExp(MacroArgsCache, FID,
-                                 ExpInfo.getSpellingLoc(),
-                                 SourceLocation::getMacroLoc(Entry.getOffset()),
-                                 getFileIDSize(FileID::get(ID)));
+    // Arguments coalesced into the entry are associated separately, so that
+    // the gaps between them are not taken for expanded tokens.
+    unsigned ChunkBegin = Entry.getOffset();
+    unsigned EntryEnd = ChunkBegin + getFileIDSize(FileID::get(ID));
+    for (const CoalescedMacroArgExpansion &Arg :
+         getCoalescedMacroArgExpansions(FileID::get(ID))) {
+      associateFileChunkWithMacroArgExp(
+          MacroArgsCache, FID,
+          ExpInfo.getSpellingLoc().getLocWithOffset(ChunkBegin -
+                                                    Entry.getOffset()),
+          SourceLocation::getMacroLoc(ChunkBegin), Arg.Begin - ChunkBegin);
+      ChunkBegin = Arg.Offset;
+    }
+    associateFileChunkWithMacroArgExp(
+        MacroArgsCache, FID,
+        ExpInfo.getSpellingLoc().getLocWithOffset(ChunkBegin -
+                                                  Entry.getOffset()),
+        SourceLocation::getMacroLoc(ChunkBegin), EntryEnd - ChunkBegin);
   }
 }
 
@@ -1958,10 +2142,21 @@ SourceManager::getMacroArgExpandedLocation(SourceLocation Loc) const {
 }
 
 std::pair<FileID, unsigned>
-SourceManager::getDecomposedIncludedLoc(FileID FID) const {
+SourceManager::getDecomposedIncludedLoc(FileID FID, unsigned Offset) const {
   if (FID.isInvalid())
     return std::make_pair(FileID(), 0);
 
+  // A later argument coalesced into a macro argument expansion has its own
+  // expansion location, which is not cached.
+  bool Invalid = false;
+  const SrcMgr::SLocEntry &Entry = getSLocEntry(FID, &Invalid);
+  if (Invalid)
+    return std::make_pair(FileID(), 0);
+  if (Entry.isExpansion())
+    if (const CoalescedMacroArgExpansion *Arg =
+            findCoalescedMacroArgExpansion(Entry, Entry.getOffset() + Offset))
+      return getDecomposedLoc(Arg->ExpansionLoc);
+
   // Uses IncludedLocMap to retrieve/cache the decomposed loc.
 
   typedef std::pair<FileID, unsigned> DecompTy;
@@ -1973,14 +2168,10 @@ SourceManager::getDecomposedIncludedLoc(FileID FID) const {
     return DecompLoc; // already in map.
 
   SourceLocation UpperLoc;
-  bool Invalid = false;
-  const SrcMgr::SLocEntry &Entry = getSLocEntry(FID, &Invalid);
-  if (!Invalid) {
-    if (Entry.isExpansion())
-      UpperLoc = Entry.getExpansion().getExpansionLocStart();
-    else
-      UpperLoc = Entry.getFile().getIncludeLoc();
-  }
+  if (Entry.isExpansion())
+    UpperLoc = Entry.getExpansion().getExpansionLocStart();
+  else
+    UpperLoc = Entry.getFile().getIncludeLoc();
 
   if (UpperLoc.isValid())
     DecompLoc = getDecomposedLoc(UpperLoc);
@@ -1994,7 +2185,8 @@ SourceManager::getDecomposedIncludedLoc(FileID FID) const {
 /// entry, return true and don't modify it.
 static bool MoveUpIncludeHierarchy(std::pair<FileID, unsigned> &Loc,
                                    const SourceManager &SM) {
-  std::pair<FileID, unsigned> UpperLoc = SM.getDecomposedIncludedLoc(Loc.first);
+  std::pair<FileID, unsigned> UpperLoc =
+      SM.getDecomposedIncludedLoc(Loc.first, Loc.second);
   if (UpperLoc.first.isInvalid())
     return true; // We reached the top.
 
@@ -2051,9 +2243,15 @@ bool SourceManager::isBeforeInTranslationUnit(SourceLocation LHS,
     return LOffs.second < ROffs.second;
 
   // If we are comparing a source location with multiple locations in the same
-  // file, we get a big win by caching the result.
+  // file, we get a big win by caching the result. This does not work when
+  // either file is a macro argument expansion with coalesced arguments,
+  // whose parent location depends on the offset.
+  InBeforeInTUCacheEntry UncachedEntry;
   InBeforeInTUCacheEntry &IsBeforeInTUCache =
-    getInBeforeInTUCache(LOffs.first, ROffs.first);
+      getCoalescedMacroArgExpansions(LOffs.first).empty() &&
+              getCoalescedMacroArgExpansions(ROffs.first).empty()
+          ? getInBeforeInTUCache(LOffs.first, ROffs.first)
+          : UncachedEntry;
 
   // If we are comparing a source location with multiple locations in the same
   // file, we get a big win by caching the result.
@@ -2153,7 +2351,11 @@ void SourceManager::PrintStats() const {
                << NumLineNumsComputed << " files with line #'s computed, "
                << NumMacroArgsComputed << " files with macro args computed.\n";
   llvm::errs() << "FileID scans: " << NumLinearScans << " linear, "
-               << NumBinaryProbes << " binary.\n";
+               << NumBinaryProbes << " binary, " << NumFileIDLookupCacheHits
+               << " lookup cache hits.\n";
+  if (CoalesceMacroArgExpansions)
+    llvm::errs() << NumCoalescedMacroArgExpansions
+                 << " macro argument expansions coalesced.\n";
 }
 
 LLVM_DUMP_METHOD void SourceManager::dump() const {
@@ -2238,6 +2440,9 @@ SourceManager::MemoryBufferSizes SourceManager::getMemoryBufferSizes() const {
 size_t SourceManager::getDataStructureSizes() const {
   size_t size = llvm::capacity_in_bytes(MemBufferInfos)
     + llvm::capacity_in_bytes(LocalSLocEntryTable)
+    + llvm::capacity_in_bytes(LocalSLocEntryOffsets)
+    + llvm::capacity_in_bytes(CoalescedMacroArgExpansions)
+    + llvm::capacity_in_bytes(LoadedCoalescedMacroArgExpansions)
     + llvm::capacity_in_bytes(LoadedSLocEntryTable)
     + llvm::capacity_in_bytes(SLocEntryLoaded)
     + llvm::capacity_in_bytes(FileInfos);
@@ -0,0 +1,152 @@
+//===--- TimeTrace.cpp - Hierarchical compile time trace ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the time trace recorded by -ftime-trace.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/TimeTrace.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace clang;
+
+typedef std::chrono::steady_clock::time_point TimePoint;
+
+namespace clang {
+class TimeTraceProfiler {
+public:
+  struct Event {
+    std::string Name;
+    std::string Detail;
+    TimePoint Start;
+    TimePoint End;
+    unsigned ThreadID;
+  };
+
+  /// \brief The time the profiler was created, which timestamps count from.
+  TimePoint BeginningOfTime;
+
+  /// \brief The shortest duration that is recorded.
+  std::chrono::microseconds Granularity;
+
+  std::mutex Mutex;
+  std::vector<Event> Events;
+
+  /// \brief A small number for each thread that recorded an event, in the
+  /// order they appeared.
+  std::map<std::thread::id, unsigned> ThreadIDs;
+
+  TimeTraceProfiler(unsigned GranularityUs)
+      : BeginningOfTime(std::chrono::steady_clock::now()),
+        Granularity(GranularityUs) {}
+
+  void record(std::string &&Name, std::string &&Detail, TimePoint Start,
+              TimePoint End) {
+    if (End - Start < Granularity)
+      return;
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto ID = ThreadIDs.insert(
+        std::make_pair(std::this_thread::get_id(), unsigned(ThreadIDs.size())));
+    Event E = {std::move(Name), std::move(Detail), Start, End,
+               ID.first->second};
+    Events.push_back(std::move(E));
+  }
+};
+} // end namespace clang
+
+TimeTraceProfiler *clang::TimeTraceProfilerInstance = nullptr;
+
+void clang::initTimeTrace(unsigned GranularityUs) {
+  delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = new TimeTraceProfiler(GranularityUs);
+}
+
+void clang::cleanupTimeTrace() {
+  delete TimeTraceProfilerInstance;
+  TimeTraceProfilerInstance = nullptr;
+}
+
+/// Write \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    if (C == '"' || C == '\\')
+      OS << '\\' << C;
+    else if (C == '\n')
+      OS << "\\n";
+    else if (C == '\t')
+      OS << "\\t";
+    else if (C < 0x20)
+      OS << llvm::format("\\u%04x", C);
+    else
+      OS << C;
+  }
+  OS << '"';
+}
+
+void clang::writeTimeTrace(raw_ostream &OS, StringRef ProcessName) {
+  TimeTraceProfiler *Profiler = TimeTraceProfilerInstance;
+  if (!Profiler)
+    return;
+
+  std::lock_guard<std::mutex> Lock(Profiler->Mutex);
+  auto Microseconds = [&](TimePoint T) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               T - Profiler->BeginningOfTime)
+        .count();
+  };
+
+  OS << "{\"traceEvents\":[\n";
+  for (const TimeTraceProfiler::Event &E : Profiler->Events) {
+    OS << "{\"pid\":1,\"tid\":" << E.ThreadID << ",\"ph\":\"X\",\"ts\":"
+       << Microseconds(E.Start)
+       << ",\"dur\":" << Microseconds(E.End) - Microseconds(E.Start)
+       << ",\"name\":";
+    writeJSONString(OS, E.Name);
+    if (!E.Detail.empty()) {
+      OS << ",\"args\":{\"detail\":";
+      writeJSONString(OS, E.Detail);
+      OS << '}';
+    }
+    OS << "},\n";
+  }
+  OS << "{\"pid\":1,\"tid\":0,\"ph\":\"M\",\"name\":\"process_name\","
+        "\"args\":{\"name\":";
+  writeJSONString(OS, ProcessName);
+  OS << "}}\n]}\n";
+}
+
+TimeTraceScope::TimeTraceScope(StringRef Name)
+    : Profiler(TimeTraceProfilerInstance) {
+  if (!Profiler)
+    return;
+  this->Name = Name;
+  Start = std::chrono::steady_clock::now();
+}
+
+TimeTraceScope::TimeTraceScope(StringRef Name,
+                               llvm::function_ref<std::string()> Detail)
+    : Profiler(TimeTraceProfilerInstance) {
+  if (!Profiler)
+    return;
+  this->Name = Name;
+  this->Detail = Detail();
+  Start = std::chrono::steady_clock::now();
+}
+
+TimeTraceScope::~TimeTraceScope() {
+  if (Profiler)
+    Profiler->record(std::move(Name), std::move(Detail), Start,
+                     std::chrono::steady_clock::now());
+}
@@ -14,6 +14,7 @@
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/iterator_range.h"
 #include "llvm/Config/llvm-config.h"
@@ -721,6 +722,10 @@ public:
 class RedirectingDirectoryEntry : public Entry {
   std::vector<std::unique_ptr<Entry>> Contents;
   Status S;
+  /// \brief The contents by name, lowercased for case-insensitive lookups, in
+  /// the order of \c Contents. Only valid if \c HasContentIndex is set.
+  llvm::StringMap<SmallVector<Entry *, 1>> ContentIndex;
+  bool HasContentIndex = false;
 
 public:
   RedirectingDirectoryEntry(StringRef Name,
@@ -738,6 +743,36 @@ public:
   typedef decltype(Contents)::iterator iterator;
   iterator contents_begin() { return Contents.begin(); }
   iterator contents_end() { return Contents.end(); }
+
+  /// \brief Indexes the contents by name, so that looking up a path component
+  /// does not compare it with every entry of the directory.
+  ///
+  /// Entries with an empty name match whatever their contents match, so a
+  /// directory that has one is left unindexed.
+  void buildContentIndex(bool CaseSensitive) {
+    ContentIndex.clear();
+    HasContentIndex = false;
+    for (const std::unique_ptr<Entry> &Content : Contents)
+      if (Content->getName().empty())
+        return;
+    for (const std::unique_ptr<Entry> &Content : Contents)
+      ContentIndex[CaseSensitive ? Content->getName().str()
+                                 : Content->getName().lower()]
+          .push_back(Content.get());
+    HasContentIndex = true;
+  }
+  bool hasContentIndex() const { return HasContentIndex; }
+
+  /// \brief Returns the contents named \p Name, in order. Requires the index.
+  ArrayRef<Entry *> lookupContents(StringRef Name, bool CaseSensitive) const {
+    assert(HasContentIndex && "contents are not indexed");
+    auto I = CaseSensitive ? ContentIndex.find(Name)
+                           : ContentIndex.find(Name.lower());
+    if (I == ContentIndex.end())
+      return None;
+    return I->second;
+  }
+
   static bool classof(const Entry *E) { return E->getKind() == EK_Directory; }
 };
 
@@ -1039,39 +1074,42 @@ class RedirectingFileSystemParser {
     return true;
   }
 
+  /// \brief The directories created by \c uniqueOverlayTree, by parent (null
+  /// for the roots) and name.
+  DenseMap<std::pair<Entry *, StringRef>, Entry *> UniqueDirs;
+
   Entry *lookupOrCreateEntry(RedirectingFileSystem *FS, StringRef Name,
                              Entry *ParentEntry = nullptr) {
-    if (!ParentEntry) { // Look for a existent root
-      for (const std::unique_ptr<Entry> &Root : FS->Roots) {
-        if (Name.equals(Root->getName())) {
-          ParentEntry = Root.get();
-          return ParentEntry;
-        }
-      }
-    } else { // Advance to the next component
-      auto *DE = dyn_cast<RedirectingDirectoryEntry>(ParentEntry);
-      for (std::unique_ptr<Entry> &Content :
-           llvm::make_range(DE->contents_begin(), DE->contents_end())) {
-        auto *DirContent = dyn_cast<RedirectingDirectoryEntry>(Content.get());
-        if (DirContent && Name.equals(Content->getName()))
-          return DirContent;
-      }
-    }
+    // Look for an existing root or directory in the parent...
+    auto Known = UniqueDirs.find(std::make_pair(ParentEntry, Name));
+    if (Known != UniqueDirs.end())
+      return Known->second;
 
     // ... or create a new one
     std::unique_ptr<Entry> E = llvm::make_unique<RedirectingDirectoryEntry>(
         Name, Status("", getNextVirtualUniqueID(), sys::TimeValue::now(), 0, 0,
                      0, file_type::directory_file, sys::fs::all_all));
+    Entry *NewE = E.get();
+    UniqueDirs[std::make_pair(ParentEntry, NewE->getName())] = NewE;
 
     if (!ParentEntry) { // Add a new root to the overlay
       FS->Roots.push_back(std::move(E));
-      ParentEntry = FS->Roots.back().get();
-      return ParentEntry;
+      return NewE;
     }
 
     auto *DE = dyn_cast<RedirectingDirectoryEntry>(ParentEntry);
     DE->addContent(std::move(E));
-    return DE->getLastContent();
+    return NewE;
+  }
+
+  void buildContentIndexes(bool CaseSensitive, Entry *E) {
+    auto *DE = dyn_cast<RedirectingDirectoryEntry>(E);
+    if (!DE)
+      return;
+    DE->buildContentIndex(CaseSensitive);
+    for (std::unique_ptr<Entry> &SubEntry :
+         llvm::make_range(DE->contents_begin(), DE->contents_end()))
+      buildContentIndexes(CaseSensitive, SubEntry.get());
   }
 
   void uniqueOverlayTree(RedirectingFileSystem *FS, Entry *SrcE,
@@ -1376,6 +1414,13 @@ public:
     for (std::unique_ptr<Entry> &E : RootEntries)
       uniqueOverlayTree(FS, E.get());
 
+    // Index the directories so that a lookup does not walk every entry of the
+    // directories on its path. Lookups only skip "." components themselves
+    // when the paths are not canonicalized.
+    if (FS->UseCanonicalizedPaths)
+      for (std::unique_ptr<Entry> &Root : FS->Roots)
+        buildContentIndexes(FS->CaseSensitive, Root.get());
+
     return true;
   }
 };
@@ -1491,6 +1536,15 @@ RedirectingFileSystem::lookupPath(sys::path::const_iterator Start,
   if (!DE)
     return make_error_code(llvm::errc::not_a_directory);
 
+  if (DE->hasContentIndex()) {
+    for (Entry *DirEntry : DE->lookupContents(*Start, CaseSensitive)) {
+      ErrorOr<Entry *> Result = lookupPath(Start, End, DirEntry);
+      if (Result || Result.getError() != llvm::errc::no_such_file_or_directory)
+        return Result;
+    }
+    return make_error_code(llvm::errc::no_such_file_or_directory);
+  }
+
   for (const std::unique_ptr<Entry> &DirEntry :
        llvm::make_range(DE->contents_begin(), DE->contents_end())) {
     ErrorOr<Entry *> Result = lookupPath(Start, End, DirEntry.get());
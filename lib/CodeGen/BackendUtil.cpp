@@ -11,6 +11,8 @@
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/LangOptions.h"
 #include "clang/Basic/TargetOptions.h"
+#include "clang/Basic/TimeTrace.h"
+#include "clang/Basic/Version.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/Utils.h"
@@ -24,6 +26,8 @@
 #include "llvm/CodeGen/RegAllocRegistry.h"
 #include "llvm/CodeGen/SchedulerRegistry.h"
 #include "llvm/IR/DataLayout.h"
+#include "llvm/IR/DiagnosticInfo.h"
+#include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/ModuleSummaryIndex.h"
 #include "llvm/IR/IRPrintingPasses.h"
 #include "llvm/IR/LegacyPassManager.h"
@@ -32,8 +36,16 @@
 #include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Object/ModuleSummaryIndexObjectFile.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/PrettyStackTrace.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Target/TargetMachine.h"
@@ -45,6 +57,8 @@
 #include "llvm/Transforms/ObjCARC.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Scalar/GVN.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
 #include "llvm/Transforms/Utils/SymbolRewriter.h"
 #include <memory>
 using namespace clang;
@@ -120,6 +134,15 @@ private:
   /// \return True on success.
   bool AddEmitPasses(BackendAction Action, raw_pwrite_stream &OS);
 
+  /// Generates the code of the parts of the module on separate threads, and
+  /// links their objects into the relocatable object written to \p OS.
+  void EmitObjectInParallel(raw_pwrite_stream &OS);
+
+  /// Sets \p Path to the file of the -fbackend-cache-path cache that holds
+  /// the output of \p Action on the module. Returns false if that output is
+  /// not cached.
+  bool getBackendCacheFile(BackendAction Action, SmallVectorImpl<char> &Path);
+
 public:
   EmitAssemblyHelper(DiagnosticsEngine &_Diags, const CodeGenOptions &CGOpts,
                      const clang::TargetOptions &TOpts,
@@ -681,6 +704,360 @@ bool EmitAssemblyHelper::AddEmitPasses(BackendAction Action,
   return true;
 }
 
+/// Returns a copy of \p M to split with llvm::SplitModule.
+///
+/// The local symbols that a part uses from another are made hidden external
+/// symbols by the split. They are renamed after the module first, so as not to
+/// conflict with the ones of other translation units.
+static std::unique_ptr<Module> cloneForSplitting(const Module &M) {
+  std::unique_ptr<Module> Clone = CloneModule(&M);
+
+  MD5 Hash;
+  Hash.update(M.getModuleIdentifier());
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  MD5::stringifyResult(Result, Digest);
+  std::string Suffix = (".shard." + Digest.str().substr(0, 16)).str();
+  for (GlobalValue &GV : Clone->global_values())
+    if (GV.hasLocalLinkage() && GV.hasName())
+      GV.setName(GV.getName() + Suffix);
+  return Clone;
+}
+
+/// Returns the part \p Shard of \p M, split into \p NumShards parts.
+///
+/// Every compilation of the same module with a different shard gets the same
+/// parts, and their objects together define what the object of the whole
+/// module would.
+static std::unique_ptr<Module>
+getCodeGenShard(const Module &M, unsigned Shard, unsigned NumShards) {
+  std::unique_ptr<Module> Part;
+  unsigned I = 0;
+  SplitModule(cloneForSplitting(M), NumShards,
+              [&](std::unique_ptr<Module> MPart) {
+                if (I++ == Shard)
+                  Part = std::move(MPart);
+              });
+  return Part;
+}
+
+/// Generates the object of a part of a module, read from \p Bitcode into a
+/// context of its own, into a new temporary file \p Path. Returns an error
+/// message, or an empty string on success.
+static std::string emitPartObject(StringRef Bitcode, TargetMachine &TM,
+                                  const CodeGenOptions &CodeGenOpts,
+                                  SmallVectorImpl<char> &Path) {
+  LLVMContext Context;
+  ErrorOr<std::unique_ptr<Module>> MOrErr =
+      parseBitcodeFile(MemoryBufferRef(Bitcode, "<part>"), Context);
+  if (std::error_code EC = MOrErr.getError())
+    return EC.message();
+  Module &M = **MOrErr;
+
+  int FD;
+  if (std::error_code EC =
+          sys::fs::createTemporaryFile("parallel-codegen", "o", FD, Path))
+    return EC.message();
+  raw_fd_ostream OS(FD, /*shouldClose=*/true);
+
+  legacy::PassManager PM;
+  PM.add(createTargetTransformInfoWrapperPass(TM.getTargetIRAnalysis()));
+  Triple TargetTriple(M.getTargetTriple());
+  std::unique_ptr<TargetLibraryInfoImpl> TLII(
+      createTLII(TargetTriple, CodeGenOpts));
+  PM.add(new TargetLibraryInfoWrapperPass(*TLII));
+  if (CodeGenOpts.OptimizationLevel > 0)
+    PM.add(createObjCARCContractPass());
+  if (TM.addPassesToEmitFile(PM, OS, TargetMachine::CGFT_ObjectFile,
+                             /*DisableVerify=*/!CodeGenOpts.VerifyModule))
+    return "unable to interface with target machine";
+  PM.run(M);
+
+  OS.close();
+  if (OS.has_error()) {
+    OS.clear_error();
+    return "unable to write " + std::string(Path.begin(), Path.end());
+  }
+  return std::string();
+}
+
+void EmitAssemblyHelper::EmitObjectInParallel(raw_pwrite_stream &OS) {
+  std::string Linker = CodeGenOpts.ParallelCodeGenLinker;
+  if (Linker.empty()) {
+    ErrorOr<std::string> LinkerOrErr = sys::findProgramByName("ld");
+    if (!LinkerOrErr) {
+      Diags.Report(diag::err_fe_parallel_codegen_failed)
+          << "no linker to link the parts with";
+      return;
+    }
+    Linker = *LinkerOrErr;
+  }
+
+  // Each part is generated in a context of its own, since a context cannot
+  // be used from several threads. They get there through bitcode.
+  std::vector<SmallString<0>> Bitcode;
+  SplitModule(cloneForSplitting(*TheModule), CodeGenOpts.ParallelCodeGen,
+              [&](std::unique_ptr<Module> MPart) {
+                Bitcode.emplace_back();
+                raw_svector_ostream BCOS(Bitcode.back());
+                WriteBitcodeToFile(MPart.get(), BCOS);
+              });
+
+  std::vector<std::unique_ptr<TargetMachine>> TMs;
+  for (unsigned I = 0, N = Bitcode.size(); I != N; ++I) {
+    TMs.emplace_back(CreateTargetMachine(/*MustCreateTM=*/true));
+    if (!TMs.back())
+      return;
+  }
+
+  std::vector<SmallString<128>> Paths(Bitcode.size());
+  std::vector<std::string> Errors(Bitcode.size());
+  {
+    ThreadPool Pool(Bitcode.size());
+    for (unsigned I = 0, N = Bitcode.size(); I != N; ++I)
+      Pool.async([&, I] {
+        TimeTraceScope TimeScope("CodeGen Part",
+                                 [&] { return std::to_string(I); });
+        Errors[I] = emitPartObject(Bitcode[I], *TMs[I], CodeGenOpts, Paths[I]);
+      });
+    Pool.wait();
+  }
+
+  std::vector<std::unique_ptr<FileRemover>> Removers;
+  for (const SmallString<128> &Path : Paths)
+    if (!Path.empty())
+      Removers.emplace_back(new FileRemover(Path));
+  for (const std::string &Error : Errors) {
+    if (!Error.empty()) {
+      Diags.Report(diag::err_fe_parallel_codegen_failed) << Error;
+      return;
+    }
+  }
+
+  // Link the parts into one relocatable object.
+  SmallString<128> LinkedPath;
+  if (std::error_code EC =
+          sys::fs::createTemporaryFile("parallel-codegen", "o", LinkedPath)) {
+    Diags.Report(diag::err_fe_parallel_codegen_failed) << EC.message();
+    return;
+  }
+  FileRemover LinkedRemover(LinkedPath);
+
+  std::vector<const char *> Args;
+  Args.push_back(Linker.c_str());
+  Args.push_back("-r");
+  Args.push_back("-o");
+  Args.push_back(LinkedPath.c_str());
+  for (SmallString<128> &Path : Paths)
+    Args.push_back(Path.c_str());
+  Args.push_back(nullptr);
+  std::string ErrMsg;
+  if (sys::ExecuteAndWait(Linker, Args.data(), /*env=*/nullptr,
+                          /*redirects=*/nullptr, /*secondsToWait=*/0,
+                          /*memoryLimit=*/0, &ErrMsg) != 0) {
+    Diags.Report(diag::err_fe_parallel_codegen_failed)
+        << (ErrMsg.empty() ? Linker + " failed" : ErrMsg);
+    return;
+  }
+
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Linked =
+      MemoryBuffer::getFile(LinkedPath);
+  if (std::error_code EC = Linked.getError()) {
+    Diags.Report(diag::err_fe_parallel_codegen_failed) << EC.message();
+    return;
+  }
+  OS << (*Linked)->getBuffer();
+}
+
+static void addToHash(MD5 &Hash, uint64_t Value) {
+  uint8_t Bytes[sizeof(Value)];
+  for (unsigned I = 0; I != sizeof(Value); ++I)
+    Bytes[I] = uint8_t(Value >> (8 * I));
+  Hash.update(Bytes);
+}
+
+static void addToHash(MD5 &Hash, StringRef Value) {
+  addToHash(Hash, Value.size());
+  Hash.update(Value);
+}
+
+namespace {
+/// A stream that feeds what is written to it into an MD5 hash, instead of
+/// keeping it.
+class HashingOStream : public raw_ostream {
+  MD5 &Hash;
+  uint64_t Pos;
+
+  void write_impl(const char *Ptr, size_t Size) override {
+    Hash.update(
+        ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(Ptr), Size));
+    Pos += Size;
+  }
+  uint64_t current_pos() const override { return Pos; }
+
+public:
+  explicit HashingOStream(MD5 &Hash) : Hash(Hash), Pos(0) {
+    SetUnbuffered();
+  }
+};
+
+/// Forwards the diagnostics of the backend to the handlers installed before
+/// it, and notes whether any of them may be reported. The output of a
+/// compilation is only cached when there are none, so that reusing it never
+/// hides a diagnostic.
+class BackendDiagnosticTracker {
+  LLVMContext &Ctx;
+  LLVMContext::DiagnosticHandlerTy OldHandler;
+  void *OldContext;
+  LLVMContext::InlineAsmDiagHandlerTy OldAsmHandler;
+  void *OldAsmContext;
+
+  static void handleDiagnostic(const DiagnosticInfo &DI, void *Context) {
+    auto *Tracker = static_cast<BackendDiagnosticTracker *>(Context);
+    // Optimization remarks are only shown with -Rpass and the like, which
+    // bypass the cache.
+    if (DI.getSeverity() != DS_Remark)
+      Tracker->SawDiagnostic = true;
+    Tracker->OldHandler(DI, Tracker->OldContext);
+  }
+
+  static void handleAsmDiagnostic(const SMDiagnostic &D, void *Context,
+                                  unsigned LocCookie) {
+    auto *Tracker = static_cast<BackendDiagnosticTracker *>(Context);
+    Tracker->SawDiagnostic = true;
+    Tracker->OldAsmHandler(D, Tracker->OldAsmContext, LocCookie);
+  }
+
+public:
+  bool SawDiagnostic;
+
+  explicit BackendDiagnosticTracker(LLVMContext &Ctx)
+      : Ctx(Ctx), OldHandler(Ctx.getDiagnosticHandler()),
+        OldContext(Ctx.getDiagnosticContext()),
+        OldAsmHandler(Ctx.getInlineAsmDiagnosticHandler()),
+        OldAsmContext(Ctx.getInlineAsmDiagnosticContext()),
+        SawDiagnostic(false) {
+    Ctx.setDiagnosticHandler(handleDiagnostic, this);
+    Ctx.setInlineAsmDiagnosticHandler(handleAsmDiagnostic, this);
+  }
+
+  ~BackendDiagnosticTracker() {
+    Ctx.setDiagnosticHandler(OldHandler, OldContext);
+    Ctx.setInlineAsmDiagnosticHandler(OldAsmHandler, OldAsmContext);
+  }
+};
+} // end anonymous namespace
+
+bool EmitAssemblyHelper::getBackendCacheFile(BackendAction Action,
+                                             SmallVectorImpl<char> &Path) {
+  if (CodeGenOpts.BackendCachePath.empty() ||
+      (Action != Backend_EmitObj && Action != Backend_EmitAssembly))
+    return false;
+
+  // The backend reads these files itself, and their contents are not part of
+  // the key.
+  if (!CodeGenOpts.SampleProfileFile.empty() ||
+      !CodeGenOpts.ThinLTOIndexFile.empty() ||
+      !CodeGenOpts.RewriteMapFiles.empty())
+    return false;
+
+  // Optimization remarks are wanted from every compilation. The diagnostics
+  // of the backend must be seen to know whether its output can be stored.
+  if (CodeGenOpts.OptimizationRemarkPattern ||
+      CodeGenOpts.OptimizationRemarkMissedPattern ||
+      CodeGenOpts.OptimizationRemarkAnalysisPattern ||
+      !TheModule->getContext().getDiagnosticHandler() ||
+      !TheModule->getContext().getInlineAsmDiagnosticHandler())
+    return false;
+
+  MD5 Hash;
+  addToHash(Hash, getClangFullRepositoryVersion());
+  addToHash(Hash, Action);
+
+  // The module, without the locations that only diagnostics use. Its file
+  // name is kept, since the object names it. The locations are detached
+  // while the bitcode streams into the hash, and put back afterwards.
+  addToHash(Hash, sys::path::filename(TheModule->getModuleIdentifier()));
+  {
+    unsigned SrcLocKind = TheModule->getMDKindID("srcloc");
+    SmallVector<std::pair<Instruction *, MDNode *>, 16> SrcLocs;
+    for (Function &F : *TheModule)
+      for (BasicBlock &BB : F)
+        for (Instruction &I : BB)
+          if (MDNode *SrcLoc = I.getMetadata(SrcLocKind)) {
+            SrcLocs.push_back(std::make_pair(&I, SrcLoc));
+            I.setMetadata(SrcLocKind, nullptr);
+          }
+    HashingOStream BCOS(Hash);
+    WriteBitcodeToFile(TheModule, BCOS);
+    addToHash(Hash, BCOS.tell());
+    for (const auto &SrcLoc : SrcLocs)
+      SrcLoc.first->setMetadata(SrcLocKind, SrcLoc.second);
+  }
+
+  // Every option that the backend may use.
+#define CODEGENOPT(Name, Bits, Default) addToHash(Hash, CodeGenOpts.Name);
+#define ENUM_CODEGENOPT(Name, Type, Bits, Default)                             \
+  addToHash(Hash, uint64_t(CodeGenOpts.get##Name()));
+#include "clang/Frontend/CodeGenOptions.def"
+#define LANGOPT(Name, Bits, Default, Description) addToHash(Hash, LangOpts.Name);
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description)                   \
+  addToHash(Hash, uint64_t(LangOpts.get##Name()));
+#include "clang/Basic/LangOptions.def"
+  addToHash(Hash, LangOpts.Sanitize.Mask);
+  for (StringRef Value :
+       {StringRef(CodeGenOpts.CodeModel), StringRef(CodeGenOpts.DebugPass),
+        StringRef(CodeGenOpts.FloatABI),
+        StringRef(CodeGenOpts.LimitFloatPrecision),
+        StringRef(CodeGenOpts.RelocationModel),
+        StringRef(CodeGenOpts.ThreadModel), StringRef(CodeGenOpts.TrapFuncName),
+        StringRef(CodeGenOpts.SplitDwarfFile), StringRef(TargetOpts.CPU),
+        StringRef(TargetOpts.FPMath), StringRef(TargetOpts.ABI),
+        StringRef(TargetOpts.EABIVersion)})
+    addToHash(Hash, Value);
+  for (const std::string &Value : CodeGenOpts.BackendOptions)
+    addToHash(Hash, Value);
+  for (const std::string &Value : TargetOpts.Features)
+    addToHash(Hash, Value);
+  for (const std::string &Value : TargetOpts.Reciprocals)
+    addToHash(Hash, Value);
+
+  MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  MD5::stringifyResult(Result, Key);
+  Key += Action == Backend_EmitObj ? ".o" : ".s";
+
+  Path.clear();
+  sys::path::append(Path, CodeGenOpts.BackendCachePath, Key);
+  return true;
+}
+
+/// Stores \p Output in the cache file \p Path. A temporary file is renamed
+/// to it, so that concurrent compilations never see a partial file. Failures
+/// are ignored, since the cache is only an optimization.
+static void writeToBackendCache(StringRef Path, StringRef Output) {
+  if (sys::fs::create_directories(sys::path::parent_path(Path)))
+    return;
+  int TmpFD;
+  SmallString<128> TmpFile;
+  if (sys::fs::createUniqueFile(Twine(Path) + "-%%%%%%%%", TmpFD, TmpFile))
+    return;
+  {
+    raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Output;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      sys::fs::remove(TmpFile);
+      return;
+    }
+  }
+  if (sys::fs::rename(TmpFile, Path))
+    sys::fs::remove(TmpFile);
+}
+
 void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
                                       raw_pwrite_stream *OS) {
   TimeRegion Region(llvm::TimePassesIsEnabled ? &CodeGenerationTime : nullptr);
@@ -698,6 +1075,26 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
   if (TM)
     TheModule->setDataLayout(TM->createDataLayout());
 
+  // With -fbackend-cache-path, the output of an earlier compilation of the
+  // same module with the same options is reused. Otherwise, the output is
+  // collected to be stored in the cache.
+  SmallString<128> CacheFile;
+  SmallString<0> Output;
+  std::unique_ptr<raw_svector_ostream> OutputOS;
+  std::unique_ptr<BackendDiagnosticTracker> DiagTracker;
+  raw_pwrite_stream *FinalOS = OS;
+  if (getBackendCacheFile(Action, CacheFile)) {
+    ErrorOr<std::unique_ptr<MemoryBuffer>> Cached =
+        MemoryBuffer::getFile(CacheFile);
+    if (Cached) {
+      *OS << (*Cached)->getBuffer();
+      return;
+    }
+    OutputOS.reset(new raw_svector_ostream(Output));
+    OS = OutputOS.get();
+    DiagTracker.reset(new BackendDiagnosticTracker(TheModule->getContext()));
+  }
+
   // If we are performing a ThinLTO importing compile, load the function
   // index into memory and pass it into CreatePasses, which will add it
   // to the PassManagerBuilder and invoke LTO passes.
@@ -720,6 +1117,11 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   CreatePasses(ModuleSummary.get());
 
+  // With -fparallel-codegen, the code generator passes are set up for each
+  // part of the module instead.
+  bool EmitInParallel =
+      Action == Backend_EmitObj && CodeGenOpts.ParallelCodeGen > 1;
+
   switch (Action) {
   case Backend_EmitNothing:
     break;
@@ -736,7 +1138,7 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
     break;
 
   default:
-    if (!AddEmitPasses(Action, *OS))
+    if (!EmitInParallel && !AddEmitPasses(Action, *OS))
       return;
   }
 
@@ -748,22 +1150,49 @@ void EmitAssemblyHelper::EmitAssembly(BackendAction Action,
 
   if (PerFunctionPasses) {
     PrettyStackTraceString CrashInfo("Per-function optimization");
+    TimeTraceScope TimeScope("PerFunctionPasses");
 
     PerFunctionPasses->doInitialization();
-    for (Function &F : *TheModule)
-      if (!F.isDeclaration())
-        PerFunctionPasses->run(F);
+    for (Function &F : *TheModule) {
+      if (F.isDeclaration())
+        continue;
+      TimeTraceScope FunctionScope("OptFunction",
+                                   [&] { return F.getName().str(); });
+      PerFunctionPasses->run(F);
+    }
     PerFunctionPasses->doFinalization();
   }
 
   if (PerModulePasses) {
     PrettyStackTraceString CrashInfo("Per-module optimization passes");
+    TimeTraceScope TimeScope("PerModulePasses");
     PerModulePasses->run(*TheModule);
   }
 
-  if (CodeGenPasses) {
+  if (EmitInParallel) {
+    PrettyStackTraceString CrashInfo("Parallel code generation");
+    TimeTraceScope TimeScope("CodeGenPasses");
+    EmitObjectInParallel(*OS);
+  } else if (CodeGenPasses) {
+    // With -fcodegen-shards, only the part of the optimized module for this
+    // shard goes through code generation, which is where most of the work on
+    // large modules is.
+    std::unique_ptr<Module> Shard;
+    if (CodeGenOpts.CodeGenShards > 1) {
+      PrettyStackTraceString CrashInfo("Module splitting");
+      Shard = getCodeGenShard(*TheModule, CodeGenOpts.CodeGenShard,
+                              CodeGenOpts.CodeGenShards);
+    }
+
     PrettyStackTraceString CrashInfo("Code generation");
-    CodeGenPasses->run(*TheModule);
+    TimeTraceScope TimeScope("CodeGenPasses");
+    CodeGenPasses->run(Shard ? *Shard : *TheModule);
+  }
+
+  if (OutputOS) {
+    *FinalOS << Output;
+    if (!Diags.hasErrorOccurred() && !DiagTracker->SawDiagnostic)
+      writeToBackendCache(CacheFile, Output);
   }
 }
 
@@ -775,7 +1204,10 @@ void clang::EmitBackendOutput(DiagnosticsEngine &Diags,
                               raw_pwrite_stream *OS) {
   EmitAssemblyHelper AsmHelper(Diags, CGOpts, TOpts, LOpts, M);
 
-  AsmHelper.EmitAssembly(Action, OS);
+  {
+    TimeTraceScope TimeScope("Backend");
+    AsmHelper.EmitAssembly(Action, OS);
+  }
 
   // Verify clang's TargetInfo DataLayout against the LLVM TargetMachine's
   // DataLayout.
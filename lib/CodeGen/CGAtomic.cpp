@@ -663,19 +663,23 @@ RValue CodeGenFunction::EmitAtomicExpr(AtomicExpr *E) {
   QualType MemTy = AtomicTy;
   if (const AtomicType *AT = AtomicTy->getAs<AtomicType>())
     MemTy = AT->getValueType();
-  CharUnits sizeChars, alignChars;
-  std::tie(sizeChars, alignChars) = getContext().getTypeInfoInChars(AtomicTy);
+  CharUnits sizeChars = getContext().getTypeSizeInChars(AtomicTy);
   uint64_t Size = sizeChars.getQuantity();
-  unsigned MaxInlineWidthInBits = getTarget().getMaxAtomicInlineWidth();
-  bool UseLibcall = (sizeChars != alignChars ||
-                     getContext().toBits(sizeChars) > MaxInlineWidthInBits);
+
+  // Use the alignment known for the pointer rather than the alignment of the
+  // type: an over-aligned object can be accessed inline even if its type
+  // could not, and a member of a packed struct may be under-aligned.
+  Address Ptr = EmitPointerWithAlignment(E->getPtr());
+  bool UseLibcall = sizeChars.isZero() ||
+                    !getTarget().hasBuiltinAtomic(
+                        getContext().toBits(sizeChars),
+                        getContext().toBits(Ptr.getAlignment()));
 
   llvm::Value *IsWeak = nullptr, *OrderFail = nullptr;
 
   Address Val1 = Address::invalid();
   Address Val2 = Address::invalid();
   Address Dest = Address::invalid();
-  Address Ptr(EmitScalarExpr(E->getPtr()), alignChars);
 
   if (E->getOp() == AtomicExpr::AO__c11_atomic_init) {
     LValue lvalue = MakeAddrLValue(Ptr, AtomicTy);
@@ -12,12 +12,15 @@
 //===----------------------------------------------------------------------===//
 
 #include "CGBlocks.h"
+#include "CGCXXABI.h"
 #include "CGDebugInfo.h"
 #include "CGObjCRuntime.h"
 #include "CodeGenFunction.h"
 #include "CodeGenModule.h"
 #include "clang/AST/DeclObjC.h"
+#include "clang/AST/Mangle.h"
 #include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/DataLayout.h"
 #include "llvm/IR/Module.h"
@@ -1311,6 +1314,245 @@ CodeGenFunction::GenerateBlockFunction(GlobalDecl GD,
     }
  */
 
+namespace {
+
+/// How a block copy or dispose helper acts on a captured variable.
+enum class BlockCaptureEntityKind {
+  CXXRecord,   // Copy or destroy with a C++ constructor or destructor.
+  ARCWeak,     // An ARC __weak direct capture.
+  ARCStrong,   // An ARC __strong direct capture of a non-block object.
+  BlockObject, // Assign or dispose through the blocks runtime.
+};
+
+/// A captured variable that a block copy or dispose helper has to manage.
+struct BlockCaptureManagedEntity {
+  BlockCaptureEntityKind Kind;
+  BlockFieldFlags Flags;
+  const BlockDecl::Capture *CI;
+  const CGBlockInfo::Capture *Capture;
+};
+
+} // end anonymous namespace
+
+/// Decide how the copy helper copies a capture. Returns false if the
+/// runtime's memcpy of the block is enough.
+static bool computeCopyInfoForBlockCapture(const BlockDecl::Capture &CI,
+                                           const LangOptions &LangOpts,
+                                           BlockCaptureEntityKind &Kind,
+                                           BlockFieldFlags &Flags) {
+  QualType type = CI.getVariable()->getType();
+
+  if (CI.getCopyExpr()) {
+    assert(!CI.isByRef());
+    // don't bother computing flags
+    Kind = BlockCaptureEntityKind::CXXRecord;
+    return true;
+  }
+
+  if (CI.isByRef()) {
+    Flags = BLOCK_FIELD_IS_BYREF;
+    if (type.isObjCGCWeak())
+      Flags |= BLOCK_FIELD_IS_WEAK;
+    Kind = BlockCaptureEntityKind::BlockObject;
+    return true;
+  }
+
+  // For all other types, the memcpy is fine.
+  if (!type->isObjCRetainableType())
+    return false;
+
+  Flags = BLOCK_FIELD_IS_OBJECT;
+  bool isBlockPointer = type->isBlockPointerType();
+  if (isBlockPointer)
+    Flags = BLOCK_FIELD_IS_BLOCK;
+
+  // Special rules for ARC captures:
+  Qualifiers qs = type.getQualifiers();
+
+  // We need to register __weak direct captures with the runtime.
+  if (qs.getObjCLifetime() == Qualifiers::OCL_Weak) {
+    Kind = BlockCaptureEntityKind::ARCWeak;
+    return true;
+  }
+
+  // We need to retain the copied value for __strong direct captures.
+  if (qs.getObjCLifetime() == Qualifiers::OCL_Strong) {
+    // If it's a block pointer, we have to copy the block and
+    // assign that to the destination pointer, so we might as
+    // well use _Block_object_assign.  Otherwise we can avoid that.
+    Kind = isBlockPointer ? BlockCaptureEntityKind::BlockObject
+                          : BlockCaptureEntityKind::ARCStrong;
+    return true;
+  }
+
+  // Non-ARC captures of retainable pointers are strong and
+  // therefore require a call to _Block_object_assign.
+  if (!qs.getObjCLifetime() && !LangOpts.ObjCAutoRefCount) {
+    Kind = BlockCaptureEntityKind::BlockObject;
+    return true;
+  }
+
+  // Otherwise the memcpy is fine.
+  return false;
+}
+
+/// Decide how the dispose helper destroys a capture. Returns false if
+/// nothing needs to be done.
+static bool computeDestroyInfoForBlockCapture(const BlockDecl::Capture &CI,
+                                              const LangOptions &LangOpts,
+                                              BlockCaptureEntityKind &Kind,
+                                              BlockFieldFlags &Flags) {
+  QualType type = CI.getVariable()->getType();
+
+  if (CI.isByRef()) {
+    Flags = BLOCK_FIELD_IS_BYREF;
+    if (type.isObjCGCWeak())
+      Flags |= BLOCK_FIELD_IS_WEAK;
+    Kind = BlockCaptureEntityKind::BlockObject;
+    return true;
+  }
+
+  if (const CXXRecordDecl *record = type->getAsCXXRecordDecl()) {
+    if (record->hasTrivialDestructor())
+      return false;
+    Kind = BlockCaptureEntityKind::CXXRecord;
+    return true;
+  }
+
+  // Otherwise, we have nothing to do.
+  if (!type->isObjCRetainableType())
+    return false;
+
+  Flags = BLOCK_FIELD_IS_OBJECT;
+  if (type->isBlockPointerType())
+    Flags = BLOCK_FIELD_IS_BLOCK;
+
+  // Special rules for ARC captures.
+  Qualifiers qs = type.getQualifiers();
+
+  // Use objc_storeStrong for __strong direct captures; the
+  // dynamic tools really like it when we do this.
+  if (qs.getObjCLifetime() == Qualifiers::OCL_Strong) {
+    Kind = BlockCaptureEntityKind::ARCStrong;
+    return true;
+  }
+
+  // Support __weak direct captures.
+  if (qs.getObjCLifetime() == Qualifiers::OCL_Weak) {
+    Kind = BlockCaptureEntityKind::ARCWeak;
+    return true;
+  }
+
+  // Non-ARC captures are strong, and we need to use _Block_object_dispose.
+  if (!qs.hasObjCLifetime() && !LangOpts.ObjCAutoRefCount) {
+    Kind = BlockCaptureEntityKind::BlockObject;
+    return true;
+  }
+
+  // Otherwise, we have nothing to do.
+  return false;
+}
+
+/// Collect the captures that a block's copy or dispose helper has to
+/// manage, in capture order.
+static void findBlockCapturedManagedEntities(
+    const CGBlockInfo &BlockInfo, const LangOptions &LangOpts, bool ForCopy,
+    SmallVectorImpl<BlockCaptureManagedEntity> &ManagedCaptures) {
+  for (const auto &CI : BlockInfo.getBlockDecl()->captures()) {
+    const CGBlockInfo::Capture &Capture =
+        BlockInfo.getCapture(CI.getVariable());
+    if (Capture.isConstant())
+      continue;
+
+    BlockCaptureEntityKind Kind;
+    BlockFieldFlags Flags;
+    bool IsManaged =
+        ForCopy ? computeCopyInfoForBlockCapture(CI, LangOpts, Kind, Flags)
+                : computeDestroyInfoForBlockCapture(CI, LangOpts, Kind, Flags);
+    if (IsManaged)
+      ManagedCaptures.push_back({Kind, Flags, &CI, &Capture});
+  }
+}
+
+/// Name a block copy or dispose helper after the layout of the captures it
+/// manages, so that blocks with identical layouts share one helper: the
+/// block alignment, then the offset and kind of each managed capture. C++
+/// captures are identified by their mangled type. Sets \p IsLocal if a
+/// captured type cannot be named outside this translation unit.
+static std::string
+getBlockHelperName(CodeGenModule &CGM, StringRef Prefix,
+                   const CGBlockInfo &BlockInfo,
+                   ArrayRef<BlockCaptureManagedEntity> ManagedCaptures,
+                   bool &IsLocal) {
+  std::string Name = Prefix;
+  Name += llvm::utostr(BlockInfo.BlockAlign.getQuantity());
+
+  IsLocal = false;
+  bool MayThrow = false;
+  for (const BlockCaptureManagedEntity &E : ManagedCaptures) {
+    Name += "_";
+    Name += llvm::utostr(E.Capture->getOffset().getQuantity());
+
+    QualType Ty = E.CI->getVariable()->getType();
+    switch (E.Kind) {
+    case BlockCaptureEntityKind::CXXRecord: {
+      SmallString<256> TyName;
+      llvm::raw_svector_ostream Out(TyName);
+      CGM.getCXXABI().getMangleContext().mangleTypeName(Ty, Out);
+      Name += "c";
+      Name += llvm::utostr(TyName.size());
+      Name.append(TyName.begin(), TyName.end());
+      if (!isExternallyVisible(Ty->getLinkage()))
+        IsLocal = true;
+      MayThrow = true;
+      break;
+    }
+    case BlockCaptureEntityKind::ARCWeak:
+      Name += "w";
+      break;
+    case BlockCaptureEntityKind::ARCStrong:
+      Name += "s";
+      break;
+    case BlockCaptureEntityKind::BlockObject:
+      Name += "r";
+      Name += llvm::utostr(E.Flags.getBitMask());
+      // Copying a __block C++ object runs its copy constructor.
+      if (E.CI->isByRef() && Ty->getAsCXXRecordDecl())
+        MayThrow = true;
+      break;
+    }
+  }
+
+  // Helpers that may unwind differ between translation units that do and
+  // do not enable exceptions.
+  if (MayThrow && CGM.getLangOpts().Exceptions)
+    Name += "_e";
+  return Name;
+}
+
+/// Create the function for a block copy or dispose helper. Unless it
+/// refers to types local to this translation unit, it is mergeable with the
+/// identically named helpers of other translation units.
+static llvm::Function *createBlockHelperFunction(CodeGenModule &CGM,
+                                                 const CGFunctionInfo &FI,
+                                                 StringRef Name,
+                                                 bool IsLocal) {
+  llvm::FunctionType *LTy = CGM.getTypes().GetFunctionType(FI);
+  llvm::Function *Fn =
+    llvm::Function::Create(LTy, llvm::GlobalValue::InternalLinkage,
+                           Name, &CGM.getModule());
+  CGM.SetInternalFunctionAttributes(nullptr, Fn, FI);
+  if (IsLocal)
+    return Fn;
+
+  Fn->setLinkage(llvm::GlobalValue::LinkOnceODRLinkage);
+  Fn->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  Fn->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  if (CGM.supportsCOMDAT())
+    Fn->setComdat(CGM.getModule().getOrInsertComdat(Fn->getName()));
+  return Fn;
+}
+
 /// Generate the copy-helper function for a block closure object:
 ///   static void block_copy_helper(block_t *dst, block_t *src);
 /// The runtime will have previously initialized 'dst' by doing a
@@ -1323,6 +1565,18 @@ llvm::Constant *
 CodeGenFunction::GenerateCopyHelperFunction(const CGBlockInfo &blockInfo) {
   ASTContext &C = getContext();
 
+  SmallVector<BlockCaptureManagedEntity, 4> CopiedCaptures;
+  findBlockCapturedManagedEntities(blockInfo, getLangOpts(), /*ForCopy=*/true,
+                                   CopiedCaptures);
+
+  // Blocks whose captures are copied the same way share a helper.
+  bool IsLocal;
+  std::string FuncName = getBlockHelperName(CGM, "__copy_helper_block_",
+                                            blockInfo, CopiedCaptures,
+                                            IsLocal);
+  if (llvm::GlobalValue *Func = CGM.getModule().getNamedValue(FuncName))
+    return llvm::ConstantExpr::getBitCast(Func, VoidPtrTy);
+
   FunctionArgList args;
   ImplicitParamDecl dstDecl(getContext(), nullptr, SourceLocation(), nullptr,
                             C.VoidPtrTy);
@@ -1334,13 +1588,7 @@ CodeGenFunction::GenerateCopyHelperFunction(const CGBlockInfo &blockInfo) {
   const CGFunctionInfo &FI =
     CGM.getTypes().arrangeBuiltinFunctionDeclaration(C.VoidTy, args);
 
-  // FIXME: it would be nice if these were mergeable with things with
-  // identical semantics.
-  llvm::FunctionType *LTy = CGM.getTypes().GetFunctionType(FI);
-
-  llvm::Function *Fn =
-    llvm::Function::Create(LTy, llvm::GlobalValue::InternalLinkage,
-                           "__copy_helper_block_", &CGM.getModule());
+  llvm::Function *Fn = createBlockHelperFunction(CGM, FI, FuncName, IsLocal);
 
   IdentifierInfo *II
     = &CGM.getContext().Idents.get("__copy_helper_block_");
@@ -1353,8 +1601,6 @@ CodeGenFunction::GenerateCopyHelperFunction(const CGBlockInfo &blockInfo) {
                                           false,
                                           false);
 
-  CGM.SetInternalFunctionAttributes(nullptr, Fn, FI);
-
   auto NL = ApplyDebugLocation::CreateEmpty(*this);
   StartFunction(FD, C.VoidTy, Fn, FI, args);
   // Create a scope with an artificial location for the body of this function.
@@ -1369,78 +1615,24 @@ CodeGenFunction::GenerateCopyHelperFunction(const CGBlockInfo &blockInfo) {
   dst = Address(Builder.CreateLoad(dst), blockInfo.BlockAlign);
   dst = Builder.CreateBitCast(dst, structPtrTy, "block.dest");
 
-  const BlockDecl *blockDecl = blockInfo.getBlockDecl();
-
-  for (const auto &CI : blockDecl->captures()) {
+  for (const BlockCaptureManagedEntity &CopiedCapture : CopiedCaptures) {
+    const BlockDecl::Capture &CI = *CopiedCapture.CI;
+    const CGBlockInfo::Capture &capture = *CopiedCapture.Capture;
     const VarDecl *variable = CI.getVariable();
-    QualType type = variable->getType();
-
-    const CGBlockInfo::Capture &capture = blockInfo.getCapture(variable);
-    if (capture.isConstant()) continue;
-
-    const Expr *copyExpr = CI.getCopyExpr();
-    BlockFieldFlags flags;
-
-    bool useARCWeakCopy = false;
-    bool useARCStrongCopy = false;
-
-    if (copyExpr) {
-      assert(!CI.isByRef());
-      // don't bother computing flags
-
-    } else if (CI.isByRef()) {
-      flags = BLOCK_FIELD_IS_BYREF;
-      if (type.isObjCGCWeak())
-        flags |= BLOCK_FIELD_IS_WEAK;
-
-    } else if (type->isObjCRetainableType()) {
-      flags = BLOCK_FIELD_IS_OBJECT;
-      bool isBlockPointer = type->isBlockPointerType();
-      if (isBlockPointer)
-        flags = BLOCK_FIELD_IS_BLOCK;
-
-      // Special rules for ARC captures:
-      Qualifiers qs = type.getQualifiers();
-
-      // We need to register __weak direct captures with the runtime.
-      if (qs.getObjCLifetime() == Qualifiers::OCL_Weak) {
-        useARCWeakCopy = true;
-
-      // We need to retain the copied value for __strong direct captures.
-      } else if (qs.getObjCLifetime() == Qualifiers::OCL_Strong) {
-        // If it's a block pointer, we have to copy the block and
-        // assign that to the destination pointer, so we might as
-        // well use _Block_object_assign.  Otherwise we can avoid that.
-        if (!isBlockPointer)
-          useARCStrongCopy = true;
-
-      // Non-ARC captures of retainable pointers are strong and
-      // therefore require a call to _Block_object_assign.
-      } else if (!qs.getObjCLifetime() && !getLangOpts().ObjCAutoRefCount) {
-        // fall through
-
-      // Otherwise the memcpy is fine.
-      } else {
-        continue;
-      }
-
-    // For all other types, the memcpy is fine.
-    } else {
-      continue;
-    }
+    BlockFieldFlags flags = CopiedCapture.Flags;
 
     unsigned index = capture.getIndex();
     Address srcField = Builder.CreateStructGEP(src, index, capture.getOffset());
     Address dstField = Builder.CreateStructGEP(dst, index, capture.getOffset());
 
     // If there's an explicit copy expression, we do that.
-    if (copyExpr) {
-      EmitSynthesizedCXXCopyCtor(dstField, srcField, copyExpr);
-    } else if (useARCWeakCopy) {
+    if (CopiedCapture.Kind == BlockCaptureEntityKind::CXXRecord) {
+      EmitSynthesizedCXXCopyCtor(dstField, srcField, CI.getCopyExpr());
+    } else if (CopiedCapture.Kind == BlockCaptureEntityKind::ARCWeak) {
       EmitARCCopyWeak(dstField, srcField);
     } else {
       llvm::Value *srcValue = Builder.CreateLoad(srcField, "blockcopy.src");
-      if (useARCStrongCopy) {
+      if (CopiedCapture.Kind == BlockCaptureEntityKind::ARCStrong) {
         // At -O0, store null into the destination field (so that the
         // storeStrong doesn't over-release) and then call storeStrong.
         // This is a workaround to not having an initStrong call.
@@ -1502,6 +1694,18 @@ llvm::Constant *
 CodeGenFunction::GenerateDestroyHelperFunction(const CGBlockInfo &blockInfo) {
   ASTContext &C = getContext();
 
+  SmallVector<BlockCaptureManagedEntity, 4> DestroyedCaptures;
+  findBlockCapturedManagedEntities(blockInfo, getLangOpts(), /*ForCopy=*/false,
+                                   DestroyedCaptures);
+
+  // Blocks whose captures are destroyed the same way share a helper.
+  bool IsLocal;
+  std::string FuncName = getBlockHelperName(CGM, "__destroy_helper_block_",
+                                            blockInfo, DestroyedCaptures,
+                                            IsLocal);
+  if (llvm::GlobalValue *Func = CGM.getModule().getNamedValue(FuncName))
+    return llvm::ConstantExpr::getBitCast(Func, VoidPtrTy);
+
   FunctionArgList args;
   ImplicitParamDecl srcDecl(getContext(), nullptr, SourceLocation(), nullptr,
                             C.VoidPtrTy);
@@ -1510,13 +1714,7 @@ CodeGenFunction::GenerateDestroyHelperFunction(const CGBlockInfo &blockInfo) {
   const CGFunctionInfo &FI =
     CGM.getTypes().arrangeBuiltinFunctionDeclaration(C.VoidTy, args);
 
-  // FIXME: We'd like to put these into a mergable by content, with
-  // internal linkage.
-  llvm::FunctionType *LTy = CGM.getTypes().GetFunctionType(FI);
-
-  llvm::Function *Fn =
-    llvm::Function::Create(LTy, llvm::GlobalValue::InternalLinkage,
-                           "__destroy_helper_block_", &CGM.getModule());
+  llvm::Function *Fn = createBlockHelperFunction(CGM, FI, FuncName, IsLocal);
 
   IdentifierInfo *II
     = &CGM.getContext().Idents.get("__destroy_helper_block_");
@@ -1527,8 +1725,6 @@ CodeGenFunction::GenerateDestroyHelperFunction(const CGBlockInfo &blockInfo) {
                                           nullptr, SC_Static,
                                           false, false);
 
-  CGM.SetInternalFunctionAttributes(nullptr, Fn, FI);
-
   // Create a scope with an artificial location for the body of this function.
   auto NL = ApplyDebugLocation::CreateEmpty(*this);
   StartFunction(FD, C.VoidTy, Fn, FI, args);
@@ -1540,73 +1736,26 @@ CodeGenFunction::GenerateDestroyHelperFunction(const CGBlockInfo &blockInfo) {
   src = Address(Builder.CreateLoad(src), blockInfo.BlockAlign);
   src = Builder.CreateBitCast(src, structPtrTy, "block");
 
-  const BlockDecl *blockDecl = blockInfo.getBlockDecl();
-
   CodeGenFunction::RunCleanupsScope cleanups(*this);
 
-  for (const auto &CI : blockDecl->captures()) {
-    const VarDecl *variable = CI.getVariable();
-    QualType type = variable->getType();
-
-    const CGBlockInfo::Capture &capture = blockInfo.getCapture(variable);
-    if (capture.isConstant()) continue;
-
-    BlockFieldFlags flags;
-    const CXXDestructorDecl *dtor = nullptr;
-
-    bool useARCWeakDestroy = false;
-    bool useARCStrongDestroy = false;
-
-    if (CI.isByRef()) {
-      flags = BLOCK_FIELD_IS_BYREF;
-      if (type.isObjCGCWeak())
-        flags |= BLOCK_FIELD_IS_WEAK;
-    } else if (const CXXRecordDecl *record = type->getAsCXXRecordDecl()) {
-      if (record->hasTrivialDestructor())
-        continue;
-      dtor = record->getDestructor();
-    } else if (type->isObjCRetainableType()) {
-      flags = BLOCK_FIELD_IS_OBJECT;
-      if (type->isBlockPointerType())
-        flags = BLOCK_FIELD_IS_BLOCK;
-
-      // Special rules for ARC captures.
-      Qualifiers qs = type.getQualifiers();
-
-      // Use objc_storeStrong for __strong direct captures; the
-      // dynamic tools really like it when we do this.
-      if (qs.getObjCLifetime() == Qualifiers::OCL_Strong) {
-        useARCStrongDestroy = true;
-
-      // Support __weak direct captures.
-      } else if (qs.getObjCLifetime() == Qualifiers::OCL_Weak) {
-        useARCWeakDestroy = true;
-
-      // Non-ARC captures are strong, and we need to use _Block_object_dispose.
-      } else if (!qs.hasObjCLifetime() && !getLangOpts().ObjCAutoRefCount) {
-        // fall through
-
-      // Otherwise, we have nothing to do.
-      } else {
-        continue;
-      }
-    } else {
-      continue;
-    }
+  for (const BlockCaptureManagedEntity &DestroyedCapture : DestroyedCaptures) {
+    const CGBlockInfo::Capture &capture = *DestroyedCapture.Capture;
+    QualType type = DestroyedCapture.CI->getVariable()->getType();
 
     Address srcField =
       Builder.CreateStructGEP(src, capture.getIndex(), capture.getOffset());
 
-    // If there's an explicit copy expression, we do that.
-    if (dtor) {
-      PushDestructorCleanup(dtor, srcField);
+    // If there's a destructor, push a cleanup to run it.
+    if (DestroyedCapture.Kind == BlockCaptureEntityKind::CXXRecord) {
+      PushDestructorCleanup(type->getAsCXXRecordDecl()->getDestructor(),
+                            srcField);
 
     // If this is a __weak capture, emit the release directly.
-    } else if (useARCWeakDestroy) {
+    } else if (DestroyedCapture.Kind == BlockCaptureEntityKind::ARCWeak) {
       EmitARCDestroyWeak(srcField);
 
     // Destroy strong objects with a call if requested.
-    } else if (useARCStrongDestroy) {
+    } else if (DestroyedCapture.Kind == BlockCaptureEntityKind::ARCStrong) {
       EmitARCDestroyStrong(srcField, ARCImpreciseLifetime);
 
     // Otherwise we call _Block_object_dispose.  It wouldn't be too
@@ -1615,7 +1764,7 @@ CodeGenFunction::GenerateDestroyHelperFunction(const CGBlockInfo &blockInfo) {
     } else {
       llvm::Value *value = Builder.CreateLoad(srcField);
       value = Builder.CreateBitCast(value, VoidPtrTy);
-      BuildBlockRelease(value, flags);
+      BuildBlockRelease(value, DestroyedCapture.Flags);
     }
   }
 
@@ -25,6 +25,7 @@
 #include "clang/AST/StmtCXX.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/IR/Intrinsics.h"
 using namespace clang;
 using namespace CodeGen;
 
@@ -268,14 +269,31 @@ static llvm::Value *BuildAppleKextVirtualCall(CodeGenFunction &CGF,
          "No kext in Microsoft ABI");
   GD = GD.getCanonicalDecl();
   CodeGenModule &CGM = CGF.CGM;
-  llvm::Value *VTable = CGM.getCXXABI().getAddrOfVTable(RD, CharUnits());
-  Ty = Ty->getPointerTo()->getPointerTo();
-  VTable = CGF.Builder.CreateBitCast(VTable, Ty);
-  assert(VTable && "BuildVirtualCall = kext vtbl pointer is null");
+  llvm::GlobalVariable *VTableVar =
+      CGM.getCXXABI().getAddrOfVTable(RD, CharUnits());
+  assert(VTableVar && "BuildVirtualCall = kext vtbl pointer is null");
   uint64_t VTableIndex = CGM.getItaniumVTableContext().getMethodVTableIndex(GD);
   uint64_t AddressPoint =
     CGM.getItaniumVTableContext().getVTableLayout(RD)
        .getAddressPoint(BaseSubobject(RD, CharUnits::Zero()));
+
+  // A relative vtable slot holds a 32-bit offset from the address point.
+  CodeGenVTables &VTables = CGM.getVTables();
+  if (VTables.useRelativeLayout()) {
+    llvm::Value *AddressPointPtr = CGF.Builder.CreateConstInBoundsGEP2_32(
+        VTableVar->getValueType(), VTableVar, 0, AddressPoint);
+    AddressPointPtr = CGF.Builder.CreateBitCast(AddressPointPtr, CGF.Int8PtrTy);
+    uint64_t Offset =
+        VTableIndex * VTables.getVTableComponentSize().getQuantity();
+    llvm::Value *VFunc = CGF.Builder.CreateCall(
+        CGM.getIntrinsic(llvm::Intrinsic::load_relative, CGM.Int32Ty),
+        {AddressPointPtr, llvm::ConstantInt::get(CGM.Int32Ty, Offset)},
+        "vfnkxt");
+    return CGF.Builder.CreateBitCast(VFunc, Ty->getPointerTo());
+  }
+
+  Ty = Ty->getPointerTo()->getPointerTo();
+  llvm::Value *VTable = CGF.Builder.CreateBitCast(VTableVar, Ty);
   VTableIndex += AddressPoint;
   llvm::Value *VFuncPtr =
     CGF.Builder.CreateConstInBoundsGEP1_64(VTable, VTableIndex, "vfnkxt");
@@ -158,6 +158,11 @@ bool EHScopeStack::containsOnlyLifetimeMarkers(
 }
 
 bool EHScopeStack::requiresLandingPad() const {
+  return getInnermostLandingPadScope() != stable_end();
+}
+
+EHScopeStack::stable_iterator
+EHScopeStack::getInnermostLandingPadScope() const {
   for (stable_iterator si = getInnermostEHScope(); si != stable_end(); ) {
     // Skip lifetime markers.
     if (auto *cleanup = dyn_cast<EHCleanupScope>(&*find(si)))
@@ -165,10 +170,10 @@ bool EHScopeStack::requiresLandingPad() const {
         si = cleanup->getEnclosingEHScope();
         continue;
       }
-    return true;
+    return si;
   }
 
-  return false;
+  return stable_end();
 }
 
 EHScopeStack::stable_iterator
@@ -50,6 +50,9 @@ CGDebugInfo::CGDebugInfo(CodeGenModule &CGM)
       DBuilder(CGM.getModule()) {
   for (const auto &KV : CGM.getCodeGenOpts().DebugPrefixMap)
     DebugPrefixMap[KV.first] = KV.second;
+  if (!CGM.getCodeGenOpts().DebugTypeOwnersFile.empty())
+    CGM.readDefinitionOwners(CGM.getCodeGenOpts().DebugTypeOwnersFile,
+                             DebugTypeOwners);
   CreateCompileUnit();
 }
 
@@ -1362,9 +1365,12 @@ void CGDebugInfo::CollectCXXBases(const CXXRecordDecl *RD, llvm::DIFile *Unit,
     if (BI.isVirtual()) {
       if (CGM.getTarget().getCXXABI().isItaniumFamily()) {
         // virtual base offset offset is -ve. The code generator emits dwarf
-        // expression where it expects +ve number.
-        BaseOffset = 0 - CGM.getItaniumVTableContext()
-                             .getVirtualBaseOffsetOffset(RD, Base)
+        // expression where it expects +ve number. It is rescaled for the
+        // component size of relative vtables.
+        BaseOffset = 0 - CGM.getVTables()
+                             .getVTableComponentOffset(
+                                 CGM.getItaniumVTableContext()
+                                     .getVirtualBaseOffsetOffset(RD, Base))
                              .getQuantity();
       } else {
         // In the MS ABI, store the vbtable offset, which is analogous to the
@@ -1616,6 +1622,8 @@ void CGDebugInfo::completeRequiredType(const RecordDecl *RD) {
 void CGDebugInfo::completeClassData(const RecordDecl *RD) {
   if (DebugKind <= codegenoptions::DebugLineTablesOnly)
     return;
+  if (isDefinitionOwnedElsewhere(RD))
+    return;
   QualType Ty = CGM.getContext().getRecordType(RD);
   void *TyPtr = Ty.getAsOpaquePtr();
   auto I = TypeCache.find(TyPtr);
@@ -1693,7 +1701,8 @@ llvm::DIType *CGDebugInfo::CreateType(const RecordType *Ty) {
   RecordDecl *RD = Ty->getDecl();
   llvm::DIType *T = cast_or_null<llvm::DIType>(getTypeOrNull(QualType(Ty, 0)));
   if (T || shouldOmitDefinition(DebugKind, DebugTypeExtRefs, RD,
-                                CGM.getLangOpts())) {
+                                CGM.getLangOpts()) ||
+      isDefinitionOwnedElsewhere(RD)) {
     if (!T)
       T = getOrCreateRecordFwdDecl(Ty, getDeclContextDescriptor(RD));
     return T;
@@ -1702,6 +1711,18 @@ llvm::DIType *CGDebugInfo::CreateType(const RecordType *Ty) {
   return CreateTypeDefinition(Ty);
 }
 
+bool CGDebugInfo::isDefinitionOwnedElsewhere(const RecordDecl *RD) {
+  if (DebugTypeOwners.empty())
+    return false;
+  QualType Ty = CGM.getContext().getRecordType(RD);
+  SmallString<256> FullName =
+      getUniqueTagTypeName(Ty->castAs<RecordType>(), CGM, TheCU);
+  if (FullName.empty())
+    return false;
+  auto I = DebugTypeOwners.find(FullName);
+  return I != DebugTypeOwners.end() && !I->second;
+}
+
 llvm::DIType *CGDebugInfo::CreateTypeDefinition(const RecordType *Ty) {
   RecordDecl *RD = Ty->getDecl();
 
@@ -22,6 +22,7 @@
 #include "clang/Frontend/CodeGenOptions.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/IR/DIBuilder.h"
 #include "llvm/IR/DebugInfo.h"
 #include "llvm/IR/ValueHandle.h"
@@ -78,6 +79,10 @@ class CGDebugInfo {
 
   llvm::SmallDenseMap<llvm::StringRef, llvm::StringRef> DebugPrefixMap;
 
+  /// The types listed in the -fdebug-type-owners file, keyed by their RTTI
+  /// name and mapped to whether this object emits their definition.
+  llvm::StringMap<bool> DebugTypeOwners;
+
   struct ObjCInterfaceCacheEntry {
     const ObjCInterfaceType *Type;
     llvm::DIType *Decl;
@@ -146,6 +151,9 @@ class CGDebugInfo {
   /// Get structure or union type.
   llvm::DIType *CreateType(const RecordType *Tyg);
   llvm::DIType *CreateTypeDefinition(const RecordType *Ty);
+  /// Whether the -fdebug-type-owners file assigns the definition of \p RD
+  /// to another object.
+  bool isDefinitionOwnedElsewhere(const RecordDecl *RD);
   llvm::DICompositeType *CreateLimitedType(const RecordType *Ty);
   void CollectContainingType(const CXXRecordDecl *RD,
                              llvm::DICompositeType *CT);
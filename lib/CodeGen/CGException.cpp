@@ -708,21 +708,25 @@ llvm::BasicBlock *CodeGenFunction::getInvokeDestImpl() {
   if (!CurFn->hasPersonalityFn())
     CurFn->setPersonalityFn(getOpaquePersonalityFn(CGM, Personality));
 
+  EHScopeStack::stable_iterator LPScope;
   if (Personality.usesFuncletPads()) {
     // We don't need separate landing pads in the funclet model.
-    LP = getEHDispatchBlock(EHStack.getInnermostEHScope());
+    LPScope = EHStack.getInnermostEHScope();
+    LP = getEHDispatchBlock(LPScope);
   } else {
     // Build the landing pad for this scope.
+    LPScope = EHStack.getInnermostLandingPadScope();
     LP = EmitLandingPad();
   }
 
   assert(LP);
 
   // Cache the landing pad on the innermost scope.  If this is a
-  // non-EH scope, cache the landing pad on the enclosing scope, too.
+  // non-EH scope or a lifetime marker sharing the landing pad of its
+  // enclosing scope, cache the landing pad on the enclosing scope, too.
   for (EHScopeStack::iterator ir = EHStack.begin(); true; ++ir) {
     ir->setCachedLandingPad(LP);
-    if (!isNonEHScope(*ir)) break;
+    if (EHStack.stabilize(ir) == LPScope) break;
   }
 
   return LP;
@@ -731,7 +735,15 @@ llvm::BasicBlock *CodeGenFunction::getInvokeDestImpl() {
 llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
   assert(EHStack.requiresLandingPad());
 
-  EHScope &innermostEHScope = *EHStack.find(EHStack.getInnermostEHScope());
+  // Lifetime markers don't get landing pads of their own.  If an exception is
+  // thrown while the innermost cleanups are lifetime markers (i.e. while an
+  // object is being constructed or destroyed), the landing pad of the
+  // enclosing scope is used and those lifetime.ends are skipped, which only
+  // keeps the slots alive longer on the unwind path.  This saves a landing
+  // pad per local variable in functions with many of them.
+  EHScopeStack::stable_iterator innermostEHScopeIt =
+      EHStack.getInnermostLandingPadScope();
+  EHScope &innermostEHScope = *EHStack.find(innermostEHScopeIt);
   switch (innermostEHScope.getKind()) {
   case EHScope::Terminate:
     return getTerminateLandingPad();
@@ -773,8 +785,9 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
   bool hasFilter = false;
   SmallVector<llvm::Value*, 4> filterTypes;
   llvm::SmallPtrSet<llvm::Value*, 4> catchTypes;
-  for (EHScopeStack::iterator I = EHStack.begin(), E = EHStack.end(); I != E;
-       ++I) {
+  for (EHScopeStack::iterator I = EHStack.find(innermostEHScopeIt),
+                              E = EHStack.end();
+       I != E; ++I) {
 
     switch (I->getKind()) {
     case EHScope::Cleanup:
@@ -865,7 +878,7 @@ llvm::BasicBlock *CodeGenFunction::EmitLandingPad() {
          "landingpad instruction has no clauses!");
 
   // Tell the backend how to generate the landing pad.
-  Builder.CreateBr(getEHDispatchBlock(EHStack.getInnermostEHScope()));
+  Builder.CreateBr(getEHDispatchBlock(innermostEHScopeIt));
 
   // Restore the old IR generation state.
   Builder.restoreIP(savedIP);
@@ -2906,6 +2906,8 @@ LValue CodeGenFunction::EmitArraySubscriptExpr(const ArraySubscriptExpr *E,
 
   AlignmentSource AlignSource;
   Address Addr = Address::invalid();
+  QualType TBAABaseType;
+  uint64_t TBAAOffset = 0;
   if (const VariableArrayType *vla =
            getContext().getAsVariableArrayType(E->getType())) {
     // The base must be a pointer, which is not an aggregate.  Emit
@@ -2977,6 +2979,15 @@ LValue CodeGenFunction::EmitArraySubscriptExpr(const ArraySubscriptExpr *E,
                                  E->getType(),
                                  !getLangOpts().isSignedOverflowDefined());
     AlignSource = ArrayLV.getAlignmentSource();
+
+    // The type DAG describes an array member by its element type, so all the
+    // elements of an array member share the access path of the array. Arrays
+    // in the char alias class, such as arrays of structs, keep scalar tags.
+    if (CGM.getCodeGenOpts().StructPathTBAA && ArrayLV.getTBAAInfo() &&
+        ArrayLV.getTBAAInfo() != CGM.getTBAAInfo(getContext().CharTy)) {
+      TBAABaseType = ArrayLV.getTBAABaseType();
+      TBAAOffset = ArrayLV.getTBAAOffset();
+    }
   } else {
     // The base must be a pointer; emit it with an estimate of its alignment.
     Addr = EmitPointerWithAlignment(E->getBase(), &AlignSource);
@@ -2986,7 +2997,10 @@ LValue CodeGenFunction::EmitArraySubscriptExpr(const ArraySubscriptExpr *E,
 
   LValue LV = MakeAddrLValue(Addr, E->getType(), AlignSource);
 
-  // TODO: Preserve/extend path TBAA metadata?
+  if (!TBAABaseType.isNull()) {
+    LV.setTBAABaseType(TBAABaseType);
+    LV.setTBAAOffset(TBAAOffset);
+  }
 
   if (getLangOpts().ObjC1 &&
       getLangOpts().getGC() != LangOptions::NonGC) {
@@ -3344,8 +3358,11 @@ LValue CodeGenFunction::EmitLValueForField(LValue base,
   if (rec->isUnion()) {
     // For unions, there is no pointer adjustment.
     assert(!type->isReferenceType() && "union has reference member");
-    // TODO: handle path-aware TBAA for union.
-    TBAAPath = false;
+    // The access path can only go through unions whose members share a type
+    // node; the type DAG describes those unions by that node.
+    if (CGM.getTBAAInfo(getContext().getRecordType(rec)) ==
+        CGM.getTBAAInfo(getContext().CharTy))
+      TBAAPath = false;
   } else {
     // For structs, we GEP to the field that the record layout suggests.
     addr = emitAddrOfFieldStorage(*this, addr, field);
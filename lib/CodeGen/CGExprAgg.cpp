@@ -164,6 +164,7 @@ public:
   void VisitAbstractConditionalOperator(const AbstractConditionalOperator *CO);
   void VisitChooseExpr(const ChooseExpr *CE);
   void VisitInitListExpr(InitListExpr *E);
+  void VisitPackedArrayInitExpr(PackedArrayInitExpr *E);
   void VisitImplicitValueInitExpr(ImplicitValueInitExpr *E);
   void VisitNoInitExpr(NoInitExpr *E) { } // Do nothing.
   void VisitCXXDefaultArgExpr(CXXDefaultArgExpr *DAE) {
@@ -1126,6 +1127,28 @@ void AggExprEmitter::EmitNullInitializationToLValue(LValue lv) {
   }
 }
 
+void AggExprEmitter::VisitPackedArrayInitExpr(PackedArrayInitExpr *E) {
+  if (Dest.isIgnored())
+    return;
+
+  // The values are all constant, so copy them from a private global rather
+  // than storing each element. Emit them straight from the packed data;
+  // EmitConstantExpr would evaluate an APValue per element first.
+  llvm::Constant *C = CGF.CGM.EmitPackedArrayInit(E);
+  if (!C)
+    C = CGF.CGM.EmitConstantExpr(E, E->getType(), &CGF);
+  assert(C && "packed array initializer is not a constant");
+  auto *GV = new llvm::GlobalVariable(CGF.CGM.getModule(), C->getType(),
+                                      /*isConstant=*/true,
+                                      llvm::GlobalValue::PrivateLinkage, C,
+                                      "packedinit");
+  GV->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  CharUnits Align = CGF.getContext().getTypeAlignInChars(E->getType());
+  GV->setAlignment(Align.getQuantity());
+  EmitFinalDestCopy(E->getType(),
+                    CGF.MakeAddrLValue(Address(GV, Align), E->getType()));
+}
+
 void AggExprEmitter::VisitInitListExpr(InitListExpr *E) {
 #if 0
   // FIXME: Assess perf here?  Figure out what cases are worth optimizing here
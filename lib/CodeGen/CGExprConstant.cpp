@@ -593,6 +593,200 @@ llvm::Constant *ConstStructBuilder::BuildStruct(CodeGenModule &CGM,
   return Builder.Finalize(ValTy);
 }
 
+template <typename T>
+static llvm::Constant *EmitPackedArrayData(llvm::LLVMContext &Ctx,
+                                           const PackedArrayInitExpr *E,
+                                           uint64_t ArraySize) {
+  SmallVector<T, 256> Elements(ArraySize, 0);
+  for (unsigned I = 0, N = E->getNumElements(); I != N; ++I)
+    Elements[I] = static_cast<T>(E->getElement(I));
+  return llvm::ConstantDataArray::get(Ctx, Elements);
+}
+
+// Elements past the initializer list are zero.
+llvm::Constant *
+CodeGenModule::EmitPackedArrayInit(const PackedArrayInitExpr *E) {
+  auto *AType =
+      dyn_cast<llvm::ArrayType>(getTypes().ConvertTypeForMem(E->getType()));
+  if (!AType || !AType->getElementType()->isIntegerTy(E->getElementSize() * 8))
+    return nullptr;
+
+  uint64_t ArraySize = AType->getNumElements();
+  llvm::LLVMContext &Ctx = getLLVMContext();
+  switch (E->getElementSize()) {
+  case 1: return EmitPackedArrayData<uint8_t>(Ctx, E, ArraySize);
+  case 2: return EmitPackedArrayData<uint16_t>(Ctx, E, ArraySize);
+  case 4: return EmitPackedArrayData<uint32_t>(Ctx, E, ArraySize);
+  case 8: return EmitPackedArrayData<uint64_t>(Ctx, E, ArraySize);
+  }
+  llvm_unreachable("unexpected packed element size");
+}
+
+//===----------------------------------------------------------------------===//
+//                           ConstructorCallFolder
+//===----------------------------------------------------------------------===//
+
+/// Folds a call to a constructor that is not constexpr, but whose effect is
+/// only to store constants: its body is empty and every base and member
+/// initializer is either a constant expression or one of the constructor's
+/// parameters. [basic.start.static]p3 lets us initialize such a global
+/// statically instead of running its constructor. Used for
+/// -fexpanded-static-init.
+class ConstructorCallFolder {
+  ASTContext &Ctx;
+  llvm::DenseMap<const ParmVarDecl *, APValue> Params;
+  unsigned Depth = 0;
+
+  /// If E reads one of the parameters being substituted, its value.
+  const APValue *lookupParam(const Expr *E) const {
+    E = E->IgnoreParens();
+    if (const auto *ICE = dyn_cast<ImplicitCastExpr>(E))
+      if (ICE->getCastKind() == CK_LValueToRValue ||
+          ICE->getCastKind() == CK_NoOp)
+        return lookupParam(ICE->getSubExpr());
+    if (const auto *DRE = dyn_cast<DeclRefExpr>(E))
+      if (const auto *PVD = dyn_cast<ParmVarDecl>(DRE->getDecl())) {
+        auto It = Params.find(PVD);
+        if (It != Params.end())
+          return &It->second;
+      }
+    return nullptr;
+  }
+
+  bool foldInits(const CXXConstructorDecl *Ctor, APValue &Result);
+
+public:
+  explicit ConstructorCallFolder(ASTContext &Ctx) : Ctx(Ctx) {}
+
+  bool foldConstruct(const CXXConstructExpr *E, APValue &Result);
+  bool foldInit(const Expr *E, APValue &Result);
+};
+
+bool ConstructorCallFolder::foldInit(const Expr *E, APValue &Result) {
+  E = E->IgnoreParens();
+  if (const auto *DIE = dyn_cast<CXXDefaultInitExpr>(E))
+    return foldInit(DIE->getExpr(), Result);
+  if (const auto *DAE = dyn_cast<CXXDefaultArgExpr>(E))
+    return foldInit(DAE->getExpr(), Result);
+  // Parameters are only ever read through, so a temporary bound to a
+  // reference parameter can be folded as its value.
+  if (const auto *MTE = dyn_cast<MaterializeTemporaryExpr>(E))
+    return foldInit(MTE->GetTemporaryExpr(), Result);
+  if (const auto *CE = dyn_cast<CXXConstructExpr>(E))
+    return foldConstruct(CE, Result);
+
+  if (const APValue *Value = lookupParam(E)) {
+    Result = *Value;
+    return true;
+  }
+  if (const auto *ICE = dyn_cast<ImplicitCastExpr>(E))
+    if (ICE->getCastKind() == CK_IntegralCast)
+      if (const APValue *Value = lookupParam(ICE->getSubExpr()))
+        if (Value->isInt()) {
+          llvm::APSInt Int =
+              Value->getInt().extOrTrunc(Ctx.getIntWidth(ICE->getType()));
+          Int.setIsSigned(ICE->getType()->isSignedIntegerOrEnumerationType());
+          Result = APValue(Int);
+          return true;
+        }
+
+  // Anything else must be a constant on its own; references to parameters
+  // make the evaluation fail.
+  Expr::EvalResult Eval;
+  if (!E->EvaluateAsRValue(Eval, Ctx) || Eval.HasSideEffects)
+    return false;
+  Result = Eval.Val;
+  return true;
+}
+
+bool ConstructorCallFolder::foldConstruct(const CXXConstructExpr *E,
+                                          APValue &Result) {
+  const CXXConstructorDecl *Ctor = E->getConstructor();
+  const CXXRecordDecl *RD = Ctor->getParent();
+  if (Depth > 16 || E->getType()->isArrayType() || RD->isUnion() ||
+      RD->getNumVBases())
+    return false;
+
+  if (Ctor->isTrivial()) {
+    if (E->getNumArgs() == 1)
+      return foldInit(E->getArg(0), Result);
+    // A trivial default constructor leaves the object uninitialized, which
+    // we can only represent for an empty class.
+    if (!RD->isEmpty() || RD->getNumBases())
+      return false;
+    Result = APValue(APValue::UninitStruct(), 0, 0);
+    return true;
+  }
+
+  const FunctionDecl *Definition = nullptr;
+  const auto *Body = dyn_cast_or_null<CompoundStmt>(Ctor->getBody(Definition));
+  if (!Body || !Body->body_empty() || Ctor->isVariadic() ||
+      E->getNumArgs() != Ctor->getNumParams())
+    return false;
+  const auto *Def = cast<CXXConstructorDecl>(Definition);
+  if (Def->isDelegatingConstructor())
+    return false;
+
+  // Arguments are evaluated in the caller, then bound to the parameters of
+  // the definition, which are what its initializers refer to.
+  SmallVector<APValue, 4> Args(E->getNumArgs());
+  for (unsigned I = 0, N = E->getNumArgs(); I != N; ++I)
+    if (!foldInit(E->getArg(I), Args[I]))
+      return false;
+
+  llvm::DenseMap<const ParmVarDecl *, APValue> CallerParams;
+  CallerParams.swap(Params);
+  for (unsigned I = 0, N = Args.size(); I != N; ++I)
+    Params[Def->getParamDecl(I)] = std::move(Args[I]);
+  ++Depth;
+  bool Folded = foldInits(Def, Result);
+  --Depth;
+  Params.swap(CallerParams);
+  return Folded;
+}
+
+bool ConstructorCallFolder::foldInits(const CXXConstructorDecl *Ctor,
+                                      APValue &Result) {
+  const CXXRecordDecl *RD = Ctor->getParent();
+  Result = APValue(APValue::UninitStruct(), RD->getNumBases(),
+                   std::distance(RD->field_begin(), RD->field_end()));
+
+  for (const CXXCtorInitializer *Init : Ctor->inits()) {
+    if (Init->isBaseInitializer()) {
+      const CXXRecordDecl *Base = Init->getBaseClass()->getAsCXXRecordDecl();
+      unsigned Index = 0;
+      for (const CXXBaseSpecifier &B : RD->bases()) {
+        if (B.getType()->getAsCXXRecordDecl()->getCanonicalDecl() ==
+            Base->getCanonicalDecl())
+          break;
+        ++Index;
+      }
+      if (Index == RD->getNumBases() ||
+          !foldInit(Init->getInit(), Result.getStructBase(Index)))
+        return false;
+      continue;
+    }
+
+    // Members of anonymous structs and unions are not handled.
+    if (!Init->isMemberInitializer())
+      return false;
+    const FieldDecl *FD = Init->getMember();
+    if (FD->getType()->isReferenceType() ||
+        !foldInit(Init->getInit(), Result.getStructField(FD->getFieldIndex())))
+      return false;
+  }
+
+  // A member the constructor does not initialize keeps an indeterminate
+  // value; leave those to the dynamic initializer.
+  for (unsigned I = 0, N = RD->getNumBases(); I != N; ++I)
+    if (Result.getStructBase(I).isUninit())
+      return false;
+  for (const FieldDecl *FD : RD->fields())
+    if (!FD->isUnnamedBitfield() &&
+        Result.getStructField(FD->getFieldIndex()).isUninit())
+      return false;
+  return true;
+}
 
 //===----------------------------------------------------------------------===//
 //                             ConstExprEmitter
@@ -929,7 +1123,7 @@ public:
 
   llvm::Constant *VisitCXXConstructExpr(CXXConstructExpr *E) {
     if (!E->getConstructor()->isTrivial())
-      return nullptr;
+      return EmitFoldedConstructorCall(E);
 
     QualType Ty = E->getType();
 
@@ -961,10 +1155,27 @@ public:
     return CGM.EmitNullConstant(Ty);
   }
 
+  /// With -fexpanded-static-init, emit a call to a non-trivial constructor as
+  /// the constant it would store, if ConstructorCallFolder can fold it.
+  llvm::Constant *EmitFoldedConstructorCall(CXXConstructExpr *E) {
+    if (!CGM.getCodeGenOpts().ExpandedStaticInit ||
+        !E->getConstructor()->getParent()->hasTrivialDestructor())
+      return nullptr;
+
+    APValue Value;
+    if (!ConstructorCallFolder(CGM.getContext()).foldConstruct(E, Value))
+      return nullptr;
+    return CGM.EmitConstantValueForMemory(Value, E->getType(), CGF);
+  }
+
   llvm::Constant *VisitStringLiteral(StringLiteral *E) {
     return CGM.GetConstantArrayFromStringLiteral(E);
   }
 
+  llvm::Constant *VisitPackedArrayInitExpr(PackedArrayInitExpr *E) {
+    return CGM.EmitPackedArrayInit(E);
+  }
+
   llvm::Constant *VisitObjCEncodeExpr(ObjCEncodeExpr *E) {
     // This must be an @encode initializing an array in a static initializer.
     // Don't emit it as the address of the string, emit the string data itself
@@ -1210,6 +1421,12 @@ llvm::Constant *CodeGenModule::EmitConstantInit(const VarDecl &D,
           return EmitNullConstant(D.getType());
       }
   }
+
+  // Packed initializers are already constant; skip building an APValue per
+  // element.
+  if (const auto *PAIE = dyn_cast_or_null<PackedArrayInitExpr>(D.getInit()))
+    if (llvm::Constant *C = EmitPackedArrayInit(PAIE))
+      return C;
   
   if (const APValue *Value = D.evaluateValue())
     return EmitConstantValueForMemory(*Value, D.getType(), CGF);
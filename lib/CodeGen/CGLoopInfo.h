@@ -61,6 +61,22 @@ struct LoopAttributes {
 
   /// \brief Value for llvm.loop.distribute.enable metadata.
   LVEnableState DistributeEnable;
+
+  /// \brief Value for llvm.loop.unroll_and_jam.* metadata (enable, disable, or
+  /// full).
+  LVEnableState UnrollAndJamEnable;
+
+  /// \brief Value for llvm.loop.unroll_and_jam.count metadata.
+  unsigned UnrollAndJamCount;
+
+  /// \brief Value for llvm.loop.pipeline.disable metadata.
+  bool PipelineDisabled;
+
+  /// \brief Value for llvm.loop.pipeline.initiationinterval metadata.
+  unsigned PipelineInitiationInterval;
+
+  /// \brief Value for llvm.loop.vectorize.predicate.enable metadata.
+  LVEnableState VectorizePredicateEnable;
 };
 
 /// \brief Information used when generating a structured loop.
@@ -144,6 +160,17 @@ public:
     StagedAttrs.UnrollEnable = State;
   }
 
+  /// \brief Set the next pushed loop unroll_and_jam state.
+  void setUnrollAndJamState(const LoopAttributes::LVEnableState &State) {
+    StagedAttrs.UnrollAndJamEnable = State;
+  }
+
+  /// \brief Set the next pushed loop 'vectorize.predicate.enable'.
+  void setVectorizePredicateState(bool Enable = true) {
+    StagedAttrs.VectorizePredicateEnable =
+        Enable ? LoopAttributes::Enable : LoopAttributes::Disable;
+  }
+
   /// \brief Set the vectorize width for the next loop pushed.
   void setVectorizeWidth(unsigned W) { StagedAttrs.VectorizeWidth = W; }
 
@@ -153,6 +180,18 @@ public:
   /// \brief Set the unroll count for the next loop pushed.
   void setUnrollCount(unsigned C) { StagedAttrs.UnrollCount = C; }
 
+  /// \brief Set the unroll_and_jam count for the next loop pushed.
+  void setUnrollAndJamCount(unsigned C) { StagedAttrs.UnrollAndJamCount = C; }
+
+  /// \brief Set the next pushed loop as not to be software pipelined.
+  void setPipelineDisabled(bool S) { StagedAttrs.PipelineDisabled = S; }
+
+  /// \brief Set the software pipelining initiation interval for the next loop
+  /// pushed.
+  void setPipelineInitiationInterval(unsigned C) {
+    StagedAttrs.PipelineInitiationInterval = C;
+  }
+
 private:
   /// \brief Returns true if there is LoopInfo on the stack.
   bool hasInfo() const { return !Active.empty(); }
@@ -460,6 +460,21 @@ RValue CodeGenFunction::EmitObjCMessageExpr(const ObjCMessageExpr *E,
                                               Args,
                                               method);
   } else {
+    // A direct method is only bound at compile time when the static class of
+    // the receiver declares or inherits it. Sema rejects any other send, as
+    // the runtime could not find the method.
+    if (method && method->isDirectMethod()) {
+      const ObjCInterfaceDecl *ReceiverClass = OID;
+      if (!ReceiverClass)
+        if (const ObjCObjectPointerType *ReceiverPtr =
+                ReceiverType->getAsObjCInterfacePointerType())
+          ReceiverClass = ReceiverPtr->getInterfaceDecl();
+      const ObjCInterfaceDecl *Declaring = method->getClassInterface();
+      if (!ReceiverClass || !Declaring ||
+          !Declaring->isSuperClassOf(ReceiverClass))
+        CGM.ErrorUnsupported(E, "message to a direct method through a "
+                                "receiver of another class");
+    }
     result = Runtime.GenerateMessageSend(*this, Return, ResultType,
                                          E->getSelector(),
                                          Receiver, Args, OID,
@@ -539,6 +554,9 @@ void CodeGenFunction::StartObjCMethod(const ObjCMethodDecl *OMD,
   StartFunction(OMD, OMD->getReturnType(), Fn, FI, args,
                 OMD->getLocation(), StartLoc);
 
+  if (OMD->isDirectMethod())
+    CGM.getObjCRuntime().GenerateDirectMethodPrologue(*this, Fn, OMD);
+
   // In ARC, certain methods get an extra cleanup.
   if (CGM.getLangOpts().ObjCAutoRefCount &&
       OMD->isInstanceMethod() &&
@@ -913,6 +913,8 @@ protected:
 
   llvm::Function *GetMethodDefinition(const ObjCMethodDecl *MD);
 
+  llvm::Function *GetDirectMethodFunction(const ObjCMethodDecl *OMD);
+
   /// BuildIvarLayout - Builds ivar layout bitmap for the class
   /// implementation for the __strong or __weak case.
   ///
@@ -1048,6 +1050,10 @@ public:
   llvm::Function *GenerateMethod(const ObjCMethodDecl *OMD,
                                  const ObjCContainerDecl *CD=nullptr) override;
 
+  void GenerateDirectMethodPrologue(CodeGen::CodeGenFunction &CGF,
+                                    llvm::Function *Fn,
+                                    const ObjCMethodDecl *OMD) override;
+
   void GenerateProtocol(const ObjCProtocolDecl *PD) override;
 
   /// GetOrEmitProtocol - Get the protocol object for the given
@@ -1889,6 +1895,9 @@ CGObjCCommonMac::EmitMessageSend(CodeGen::CodeGenFunction &CGF,
                CGM.getContext().getCanonicalType(ResultType) &&
            "Result type mismatch!");
 
+  // Direct methods are called like C functions, bypassing the messenger.
+  bool IsDirect = !IsSuper && Method && Method->isDirectMethod();
+
   bool ReceiverCanBeNull = true;
 
   // Super dispatch assumes that self is non-null; even the messenger
@@ -1919,7 +1928,11 @@ CGObjCCommonMac::EmitMessageSend(CodeGen::CodeGenFunction &CGF,
   NullReturnState nullReturn;
 
   llvm::Constant *Fn = nullptr;
-  if (CGM.ReturnSlotInterferesWithArgs(MSI.CallInfo)) {
+  if (IsDirect) {
+    // The direct method checks for a nil receiver itself, so the result
+    // needs no fixing up here.
+    Fn = GetDirectMethodFunction(Method);
+  } else if (CGM.ReturnSlotInterferesWithArgs(MSI.CallInfo)) {
     if (ReceiverCanBeNull) nullReturn.init(CGF, Arg0);
     Fn = (ObjCABI == 2) ?  ObjCTypes.getSendStretFn2(IsSuper)
       : ObjCTypes.getSendStretFn(IsSuper);
@@ -1940,7 +1953,8 @@ CGObjCCommonMac::EmitMessageSend(CodeGen::CodeGenFunction &CGF,
 
   // Emit a null-check if there's a consumed argument other than the receiver.
   bool RequiresNullCheck = false;
-  if (ReceiverCanBeNull && CGM.getLangOpts().ObjCAutoRefCount && Method) {
+  if (!IsDirect && ReceiverCanBeNull && CGM.getLangOpts().ObjCAutoRefCount &&
+      Method) {
     for (const auto *ParamDecl : Method->parameters()) {
       if (ParamDecl->hasAttr<NSConsumedAttr>()) {
         if (!nullReturn.NullBB)
@@ -3099,13 +3113,21 @@ void CGObjCMac::GenerateCategory(const ObjCCategoryImplDecl *OCD) {
                                      << OCD->getName();
 
   SmallVector<llvm::Constant *, 16> InstanceMethods, ClassMethods;
-  for (const auto *I : OCD->instance_methods())
+  for (const auto *I : OCD->instance_methods()) {
+    // Direct methods are not registered with the runtime.
+    if (I->isDirectMethod())
+      continue;
     // Instance methods should always be defined.
     InstanceMethods.push_back(GetMethodConstant(I));
+  }
 
-  for (const auto *I : OCD->class_methods())
+  for (const auto *I : OCD->class_methods()) {
+    // Direct methods are not registered with the runtime.
+    if (I->isDirectMethod())
+      continue;
     // Class methods should always be defined.
     ClassMethods.push_back(GetMethodConstant(I));
+  }
 
   llvm::Constant *Values[8];
   Values[0] = GetClassName(OCD->getName());
@@ -3283,13 +3305,21 @@ void CGObjCMac::GenerateClass(const ObjCImplementationDecl *ID) {
     Flags |= FragileABI_Class_Hidden;
 
   SmallVector<llvm::Constant *, 16> InstanceMethods, ClassMethods;
-  for (const auto *I : ID->instance_methods())
+  for (const auto *I : ID->instance_methods()) {
+    // Direct methods are not registered with the runtime.
+    if (I->isDirectMethod())
+      continue;
     // Instance methods should always be defined.
     InstanceMethods.push_back(GetMethodConstant(I));
+  }
 
-  for (const auto *I : ID->class_methods())
+  for (const auto *I : ID->class_methods()) {
+    // Direct methods are not registered with the runtime.
+    if (I->isDirectMethod())
+      continue;
     // Class methods should always be defined.
     ClassMethods.push_back(GetMethodConstant(I));
+  }
 
   for (const auto *PID : ID->property_impls()) {
     if (PID->getPropertyImplementation() == ObjCPropertyImplDecl::Synthesize) {
@@ -3617,12 +3647,32 @@ llvm::Constant *CGObjCMac::EmitMethodList(Twine Name, StringRef Section,
 
 llvm::Function *CGObjCCommonMac::GenerateMethod(const ObjCMethodDecl *OMD,
                                                 const ObjCContainerDecl *CD) {
-  SmallString<256> Name;
-  GetNameForMethod(OMD, CD, Name);
-
   CodeGenTypes &Types = CGM.getTypes();
   llvm::FunctionType *MethodTy =
     Types.GetFunctionType(Types.arrangeObjCMethodDeclaration(OMD));
+
+  // Direct methods are left out of MethodDefinitions so that they never end
+  // up in a method list.
+  if (OMD->isDirectMethod()) {
+    llvm::Function *Fn = GetDirectMethodFunction(OMD);
+    if (Fn->getFunctionType() == MethodTy)
+      return Fn;
+
+    // A call emitted earlier declared the function with the signature of a
+    // declaration whose types differ from the definition's; replace it.
+    llvm::Function *NewFn =
+      llvm::Function::Create(MethodTy, llvm::GlobalValue::ExternalLinkage,
+                             "", &CGM.getModule());
+    NewFn->takeName(Fn);
+    NewFn->setVisibility(llvm::GlobalValue::HiddenVisibility);
+    Fn->replaceAllUsesWith(llvm::ConstantExpr::getBitCast(NewFn,
+                                                          Fn->getType()));
+    Fn->eraseFromParent();
+    return NewFn;
+  }
+
+  SmallString<256> Name;
+  GetNameForMethod(OMD, CD, Name);
   llvm::Function *Method =
     llvm::Function::Create(MethodTy,
                            llvm::GlobalValue::InternalLinkage,
@@ -3633,6 +3683,81 @@ llvm::Function *CGObjCCommonMac::GenerateMethod(const ObjCMethodDecl *OMD,
   return Method;
 }
 
+/// GetDirectMethodFunction - Return the function implementing the direct
+/// method \p OMD, declaring it if needed. Callers bind to it by name rather
+/// than through the runtime, so it is not internal, but it is hidden: direct
+/// methods are not part of a library's exported interface.
+llvm::Function *
+CGObjCCommonMac::GetDirectMethodFunction(const ObjCMethodDecl *OMD) {
+  // Name the function after the class alone, and look it up by name: the
+  // declaration a caller sees may live in a category or extension that the
+  // implementation is not tied to.
+  SmallString<256> Name;
+  llvm::raw_svector_ostream OS(Name);
+  OS << '\01' << (OMD->isInstanceMethod() ? '-' : '+') << '['
+     << OMD->getClassInterface()->getName() << ' '
+     << OMD->getSelector().getAsString() << ']';
+  if (llvm::Function *Fn = CGM.getModule().getFunction(Name))
+    return Fn;
+
+  CodeGenTypes &Types = CGM.getTypes();
+  llvm::FunctionType *MethodTy =
+    Types.GetFunctionType(Types.arrangeObjCMethodDeclaration(OMD));
+  llvm::Function *Fn =
+    llvm::Function::Create(MethodTy, llvm::GlobalValue::ExternalLinkage,
+                           Name.str(), &CGM.getModule());
+  Fn->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  return Fn;
+}
+
+void CGObjCCommonMac::GenerateDirectMethodPrologue(CodeGenFunction &CGF,
+                                                   llvm::Function *Fn,
+                                                   const ObjCMethodDecl *OMD) {
+  // Declaration attributes may have reset the visibility.
+  Fn->setVisibility(llvm::GlobalValue::HiddenVisibility);
+
+  CGBuilderTy &Builder = CGF.Builder;
+  Address SelfAddr = CGF.GetAddrOfLocalVar(OMD->getSelfDecl());
+  llvm::Value *SelfValue = Builder.CreateLoad(SelfAddr, "self");
+
+  // if (self == nil)
+  //   return (ReturnType){};
+  // The messenger would have done this for an ordinary method.
+  llvm::BasicBlock *SelfIsNilBlock =
+    CGF.createBasicBlock("objc_direct_method.self_is_nil");
+  llvm::BasicBlock *ContBlock =
+    CGF.createBasicBlock("objc_direct_method.cont");
+  llvm::Value *IsNil = Builder.CreateIsNull(SelfValue);
+  Builder.CreateCondBr(IsNil, SelfIsNilBlock, ContBlock);
+
+  CGF.EmitBlock(SelfIsNilBlock);
+  QualType ResultType = OMD->getReturnType();
+  if (!ResultType->isVoidType() && CGF.ReturnValue.isValid())
+    CGF.EmitNullInitialization(CGF.ReturnValue, ResultType);
+  CGF.EmitBranchThroughCleanup(CGF.ReturnBlock);
+
+  CGF.EmitBlock(ContBlock);
+
+  // A class method is reached without the runtime seeing the class, so send
+  // it a message first to make sure it is realized and +initialize has run:
+  // self = [self self];
+  if (OMD->isClassMethod()) {
+    ASTContext &Ctx = CGM.getContext();
+    Selector SelfSel = Ctx.Selectors.getNullarySelector(&Ctx.Idents.get("self"));
+    QualType SelfTy = OMD->getSelfDecl()->getType();
+    CallArgList Args;
+    RValue Result = GenerateMessageSend(CGF, ReturnValueSlot(),
+                                        Ctx.getObjCIdType(), SelfSel,
+                                        SelfValue, Args,
+                                        OMD->getClassInterface(),
+                                        /*Method=*/nullptr);
+    Builder.CreateStore(
+        Builder.CreateBitCast(Result.getScalarVal(),
+                              CGF.ConvertType(SelfTy)),
+        SelfAddr);
+  }
+}
+
 llvm::GlobalVariable *CGObjCCommonMac::CreateMetadataVar(Twine Name,
                                                          llvm::Constant *Init,
                                                          StringRef Section,
@@ -5856,15 +5981,23 @@ llvm::GlobalVariable * CGObjCNonFragileABIMac::BuildClassRoTInitializer(
   if (flags & NonFragileABI_Class_Meta) {
     MethodListName += "CLASS_METHODS_";
     MethodListName += ID->getObjCRuntimeNameAsString();
-    for (const auto *I : ID->class_methods())
+    for (const auto *I : ID->class_methods()) {
+      // Direct methods are not registered with the runtime.
+      if (I->isDirectMethod())
+        continue;
       // Class methods should always be defined.
       Methods.push_back(GetMethodConstant(I));
+    }
   } else {
     MethodListName += "INSTANCE_METHODS_";
     MethodListName += ID->getObjCRuntimeNameAsString();
-    for (const auto *I : ID->instance_methods())
+    for (const auto *I : ID->instance_methods()) {
+      // Direct methods are not registered with the runtime.
+      if (I->isDirectMethod())
+        continue;
       // Instance methods should always be defined.
       Methods.push_back(GetMethodConstant(I));
+    }
 
     for (const auto *PID : ID->property_impls()) {
       if (PID->getPropertyImplementation() == ObjCPropertyImplDecl::Synthesize){
@@ -6192,9 +6325,13 @@ void CGObjCNonFragileABIMac::GenerateCategory(const ObjCCategoryImplDecl *OCD) {
   MethodListName += "_$_";
   MethodListName += OCD->getName();
 
-  for (const auto *I : OCD->instance_methods())
+  for (const auto *I : OCD->instance_methods()) {
+    // Direct methods are not registered with the runtime.
+    if (I->isDirectMethod())
+      continue;
     // Instance methods should always be defined.
     Methods.push_back(GetMethodConstant(I));
+  }
 
   Values[2] = EmitMethodList(MethodListName.str(),
                              "__DATA, __objc_const",
@@ -6207,9 +6344,13 @@ void CGObjCNonFragileABIMac::GenerateCategory(const ObjCCategoryImplDecl *OCD) {
   MethodListName += OCD->getNameAsString();
     
   Methods.clear();
-  for (const auto *I : OCD->class_methods())
+  for (const auto *I : OCD->class_methods()) {
+    // Direct methods are not registered with the runtime.
+    if (I->isDirectMethod())
+      continue;
     // Class methods should always be defined.
     Methods.push_back(GetMethodConstant(I));
+  }
 
   Values[3] = EmitMethodList(MethodListName.str(),
                              "__DATA, __objc_const",
@@ -6850,7 +6991,8 @@ CGObjCNonFragileABIMac::GenerateMessageSend(CodeGen::CodeGenFunction &CGF,
                                             const CallArgList &CallArgs,
                                             const ObjCInterfaceDecl *Class,
                                             const ObjCMethodDecl *Method) {
-  return isVTableDispatchedSelector(Sel)
+  bool IsDirect = Method && Method->isDirectMethod();
+  return !IsDirect && isVTableDispatchedSelector(Sel)
     ? EmitVTableMessageSend(CGF, Return, ResultType, Sel,
                             Receiver, CGF.getContext().getObjCIdType(),
                             false, CallArgs, Method)
@@ -204,6 +204,13 @@ public:
   virtual llvm::Function *GenerateMethod(const ObjCMethodDecl *OMD,
                                          const ObjCContainerDecl *CD) = 0;
 
+  /// Emit the start of the body of a method marked objc_direct, which is
+  /// called without going through the runtime, once its parameters are set
+  /// up. Runtimes that dispatch such methods normally need do nothing.
+  virtual void GenerateDirectMethodPrologue(CodeGen::CodeGenFunction &CGF,
+                                            llvm::Function *Fn,
+                                            const ObjCMethodDecl *OMD) {}
+
   /// Return the runtime function for getting properties.
   virtual llvm::Constant *GetPropertyGetFunction() = 0;
 
@@ -665,6 +665,10 @@ enum OpenMPRTLFunction {
   // Call to void __tgt_target_data_update(int32_t device_id, int32_t arg_num,
   // void** args_base, void **args, size_t *arg_sizes, int32_t *arg_types);
   OMPRTL__tgt_target_data_update,
+  // Call to int omp_get_thread_num(void);
+  OMPRTL_omp_get_thread_num,
+  // Call to int omp_get_num_threads(void);
+  OMPRTL_omp_get_num_threads,
 };
 
 /// A basic class for pre|post-action for advanced codegen sequence for OpenMP
@@ -1628,6 +1632,20 @@ CGOpenMPRuntime::createRuntimeFunction(unsigned Function) {
     RTLFn = CGM.CreateRuntimeFunction(FnTy, "__tgt_target_data_update");
     break;
   }
+  case OMPRTL_omp_get_thread_num: {
+    // Build int omp_get_thread_num(void);
+    llvm::FunctionType *FnTy =
+        llvm::FunctionType::get(CGM.Int32Ty, /*isVarArg*/ false);
+    RTLFn = CGM.CreateRuntimeFunction(FnTy, "omp_get_thread_num");
+    break;
+  }
+  case OMPRTL_omp_get_num_threads: {
+    // Build int omp_get_num_threads(void);
+    llvm::FunctionType *FnTy =
+        llvm::FunctionType::get(CGM.Int32Ty, /*isVarArg*/ false);
+    RTLFn = CGM.CreateRuntimeFunction(FnTy, "omp_get_num_threads");
+    break;
+  }
   }
   assert(RTLFn && "Unable to find OpenMP runtime function");
   return RTLFn;
@@ -2394,6 +2412,14 @@ bool CGOpenMPRuntime::isStaticNonchunked(OpenMPScheduleClauseKind ScheduleKind,
   return Schedule == OMP_sch_static;
 }
 
+bool CGOpenMPRuntime::isInlineStaticNonchunked(
+    OpenMPScheduleClauseKind ScheduleKind, bool Chunked, bool Ordered) const {
+  if (!CGM.getLangOpts().OpenMPInlineStaticSchedule ||
+      CGM.getLangOpts().OpenMPIsDevice)
+    return false;
+  return getRuntimeSchedule(ScheduleKind, Chunked, Ordered) == OMP_sch_static;
+}
+
 bool CGOpenMPRuntime::isStaticNonchunked(
     OpenMPDistScheduleClauseKind ScheduleKind, bool Chunked) const {
   auto Schedule = getRuntimeSchedule(ScheduleKind, Chunked);
@@ -2533,6 +2559,11 @@ void CGOpenMPRuntime::emitForStaticInit(CodeGenFunction &CGF,
                                         bool Ordered, Address IL, Address LB,
                                         Address UB, Address ST,
                                         llvm::Value *Chunk) {
+  if (isInlineStaticNonchunked(ScheduleKind.Schedule, Chunk != nullptr,
+                               Ordered)) {
+    emitInlineStaticInit(CGF, Loc, IVSize, IL, LB, UB, ST);
+    return;
+  }
   OpenMPSchedType ScheduleNum =
       getRuntimeSchedule(ScheduleKind.Schedule, Chunk != nullptr, Ordered);
   auto *UpdatedLocation = emitUpdateLocation(CGF, Loc);
@@ -2543,6 +2574,64 @@ void CGOpenMPRuntime::emitForStaticInit(CodeGenFunction &CGF,
                         Ordered, IL, LB, UB, ST, Chunk);
 }
 
+void CGOpenMPRuntime::emitInlineStaticInit(CodeGenFunction &CGF,
+                                           SourceLocation Loc, unsigned IVSize,
+                                           Address IL, Address LB, Address UB,
+                                           Address ST) {
+  if (!CGF.HaveInsertPoint())
+    return;
+  // Split the iterations [LB..UB] the way libomp's default (greedy) static
+  // schedule does, in ceil(trip / nth) sized chunks:
+  //
+  // trip = UB - LB + 1;
+  // chunk = trip / nth + (trip % nth != 0);
+  // offset = tid * chunk;
+  // if (offset < trip) {
+  //   lower = LB + offset;
+  //   upper = lower + min(chunk, trip - offset) - 1;
+  //   last = trip - offset <= chunk;
+  // } else {
+  //   lower = UB + 1; upper = UB; last = 0;
+  // }
+  //
+  // The arithmetic is on offsets from LB and unsigned, which also covers
+  // signed iteration variables since UB >= LB here.
+  auto &Builder = CGF.Builder;
+  llvm::Type *IVTy = Builder.getIntNTy(IVSize);
+  llvm::Value *Tid = Builder.CreateIntCast(
+      CGF.EmitRuntimeCall(createRuntimeFunction(OMPRTL_omp_get_thread_num)),
+      IVTy, /*isSigned=*/false);
+  llvm::Value *NumThreads = Builder.CreateIntCast(
+      CGF.EmitRuntimeCall(createRuntimeFunction(OMPRTL_omp_get_num_threads)),
+      IVTy, /*isSigned=*/false);
+  llvm::Value *Lower = Builder.CreateLoad(LB);
+  llvm::Value *Upper = Builder.CreateLoad(UB);
+  llvm::Value *One = llvm::ConstantInt::get(IVTy, 1);
+  llvm::Value *Trip =
+      Builder.CreateAdd(Builder.CreateSub(Upper, Lower), One, "omp.trip");
+  llvm::Value *Small = Builder.CreateUDiv(Trip, NumThreads);
+  llvm::Value *Extras = Builder.CreateURem(Trip, NumThreads);
+  llvm::Value *Chunk = Builder.CreateAdd(
+      Small, Builder.CreateZExt(Builder.CreateIsNotNull(Extras), IVTy),
+      "omp.chunk");
+  llvm::Value *Offset = Builder.CreateMul(Tid, Chunk, "omp.offset");
+  llvm::Value *InRange = Builder.CreateICmpULT(Offset, Trip);
+  llvm::Value *Remaining = Builder.CreateSub(Trip, Offset);
+  llvm::Value *IsLast = Builder.CreateICmpULE(Remaining, Chunk);
+  llvm::Value *Size = Builder.CreateSelect(IsLast, Remaining, Chunk);
+  llvm::Value *ChunkLower = Builder.CreateAdd(Lower, Offset);
+  llvm::Value *NewLower = Builder.CreateSelect(
+      InRange, ChunkLower, Builder.CreateAdd(Upper, One));
+  llvm::Value *NewUpper = Builder.CreateSelect(
+      InRange, Builder.CreateSub(Builder.CreateAdd(ChunkLower, Size), One),
+      Upper);
+  Builder.CreateStore(NewLower, LB);
+  Builder.CreateStore(NewUpper, UB);
+  Builder.CreateStore(Trip, ST);
+  Builder.CreateStore(
+      Builder.CreateZExt(Builder.CreateAnd(InRange, IsLast), CGM.Int32Ty), IL);
+}
+
 void CGOpenMPRuntime::emitDistributeStaticInit(
     CodeGenFunction &CGF, SourceLocation Loc,
     OpenMPDistScheduleClauseKind SchedKind, unsigned IVSize, bool IVSigned,
@@ -3682,7 +3771,8 @@ CGOpenMPRuntime::TaskResultTy
 CGOpenMPRuntime::emitTaskInit(CodeGenFunction &CGF, SourceLocation Loc,
                               const OMPExecutableDirective &D,
                               llvm::Value *TaskFunction, QualType SharedsTy,
-                              Address Shareds, const OMPTaskDataTy &Data) {
+                              Address Shareds, const OMPTaskDataTy &Data,
+                              bool Undeferred) {
   auto &C = CGM.getContext();
   llvm::SmallVector<PrivateDataTy, 4> Privates;
   // Aggregate privates and sort them by the alignment.
@@ -3790,7 +3880,12 @@ CGOpenMPRuntime::emitTaskInit(CodeGenFunction &CGF, SourceLocation Loc,
                                      CGF.Builder.getInt32(/*C=*/0))
           : CGF.Builder.getInt32(Data.Final.getInt() ? FinalFlag : 0);
   TaskFlags = CGF.Builder.CreateOr(TaskFlags, CGF.Builder.getInt32(Flags));
-  auto *SharedsSize = CGM.getSize(C.getTypeSizeInChars(SharedsTy));
+  bool HasShareds = !SharedsTy->getAsStructureType()->getDecl()->field_empty();
+  // An undeferred task reads the shareds of the encountering task in place,
+  // so the runtime need not allocate room to copy them into.
+  auto *SharedsSize = CGM.getSize(HasShareds && Undeferred
+                                      ? CharUnits::Zero()
+                                      : C.getTypeSizeInChars(SharedsTy));
   llvm::Value *AllocArgs[] = {emitUpdateLocation(CGF, Loc),
                               getThreadID(CGF, Loc), TaskFlags,
                               KmpTaskTWithPrivatesTySize, SharedsSize,
@@ -3807,7 +3902,14 @@ CGOpenMPRuntime::emitTaskInit(CodeGenFunction &CGF, SourceLocation Loc,
   // Fill the data in the resulting kmp_task_t record.
   // Copy shareds if there are any.
   Address KmpTaskSharedsPtr = Address::invalid();
-  if (!SharedsTy->getAsStructureType()->getDecl()->field_empty()) {
+  if (HasShareds && Undeferred) {
+    LValue SharedsLVal = CGF.EmitLValueForField(
+        TDBase, *std::next(KmpTaskTQTyRD->field_begin(), KmpTaskTShareds));
+    CGF.EmitStoreOfScalar(CGF.Builder.CreatePointerBitCastOrAddrSpaceCast(
+                              Shareds.getPointer(), CGF.VoidPtrTy),
+                          SharedsLVal);
+    KmpTaskSharedsPtr = Shareds;
+  } else if (HasShareds) {
     KmpTaskSharedsPtr =
         Address(CGF.EmitLoadOfScalar(
                     CGF.EmitLValueForField(
@@ -3872,8 +3974,14 @@ void CGOpenMPRuntime::emitTaskCall(CodeGenFunction &CGF, SourceLocation Loc,
   if (!CGF.HaveInsertPoint())
     return;
 
-  TaskResultTy Result =
-      emitTaskInit(CGF, Loc, D, TaskFunction, SharedsTy, Shareds, Data);
+  // With an 'if' clause that folds to false only the undeferred path below is
+  // emitted.
+  bool CondConstant;
+  bool Undeferred = IfCond &&
+                    CGF.ConstantFoldsToSimpleInteger(IfCond, CondConstant) &&
+                    !CondConstant;
+  TaskResultTy Result = emitTaskInit(CGF, Loc, D, TaskFunction, SharedsTy,
+                                     Shareds, Data, Undeferred);
   llvm::Value *NewTask = Result.NewTask;
   llvm::Value *TaskEntry = Result.TaskEntry;
   llvm::Value *NewTaskNewTaskTTy = Result.NewTaskNewTaskTTy;
@@ -4325,6 +4433,22 @@ static void emitSingleReductionCombiner(CodeGenFunction &CGF,
     emitReductionCombiner(CGF, ReductionOp);
 }
 
+/// Check if every reduction in \p ReductionOps updates a scalar variable with
+/// an operation that has an atomic form.
+static bool isAtomicScalarReduction(ArrayRef<const Expr *> Privates,
+                                    ArrayRef<const Expr *> ReductionOps) {
+  auto IPriv = Privates.begin();
+  for (auto *E : ReductionOps) {
+    if (!(*IPriv)->getType()->isScalarType())
+      return false;
+    auto *BO = dyn_cast<BinaryOperator>(E);
+    if (!BO || BO->getOpcode() != BO_Assign)
+      return false;
+    ++IPriv;
+  }
+  return true;
+}
+
 void CGOpenMPRuntime::emitReduction(CodeGenFunction &CGF, SourceLocation Loc,
                                     ArrayRef<const Expr *> Privates,
                                     ArrayRef<const Expr *> LHSExprs,
@@ -4385,6 +4509,111 @@ void CGOpenMPRuntime::emitReduction(CodeGenFunction &CGF, SourceLocation Loc,
     return;
   }
 
+  auto &&AtomicCodeGen = [Loc, &Privates, &LHSExprs, &RHSExprs, &ReductionOps](
+      CodeGenFunction &CGF, PrePostActionTy &Action) {
+    auto ILHS = LHSExprs.begin();
+    auto IRHS = RHSExprs.begin();
+    auto IPriv = Privates.begin();
+    for (auto *E : ReductionOps) {
+      const Expr *XExpr = nullptr;
+      const Expr *EExpr = nullptr;
+      const Expr *UpExpr = nullptr;
+      BinaryOperatorKind BO = BO_Comma;
+      if (auto *BO = dyn_cast<BinaryOperator>(E)) {
+        if (BO->getOpcode() == BO_Assign) {
+          XExpr = BO->getLHS();
+          UpExpr = BO->getRHS();
+        }
+      }
+      // Try to emit update expression as a simple atomic.
+      auto *RHSExpr = UpExpr;
+      if (RHSExpr) {
+        // Analyze RHS part of the whole expression.
+        if (auto *ACO = dyn_cast<AbstractConditionalOperator>(
+                RHSExpr->IgnoreParenImpCasts())) {
+          // If this is a conditional operator, analyze its condition for
+          // min/max reduction operator.
+          RHSExpr = ACO->getCond();
+        }
+        if (auto *BORHS =
+                dyn_cast<BinaryOperator>(RHSExpr->IgnoreParenImpCasts())) {
+          EExpr = BORHS->getRHS();
+          BO = BORHS->getOpcode();
+        }
+      }
+      if (XExpr) {
+        auto *VD = cast<VarDecl>(cast<DeclRefExpr>(*ILHS)->getDecl());
+        auto &&AtomicRedGen = [BO, VD, IPriv,
+                               Loc](CodeGenFunction &CGF, const Expr *XExpr,
+                                    const Expr *EExpr, const Expr *UpExpr) {
+          LValue X = CGF.EmitLValue(XExpr);
+          RValue E;
+          if (EExpr)
+            E = CGF.EmitAnyExpr(EExpr);
+          CGF.EmitOMPAtomicSimpleUpdateExpr(
+              X, E, BO, /*IsXLHSInRHSPart=*/true,
+              llvm::AtomicOrdering::Monotonic, Loc,
+              [&CGF, UpExpr, VD, IPriv, Loc](RValue XRValue) {
+                CodeGenFunction::OMPPrivateScope PrivateScope(CGF);
+                PrivateScope.addPrivate(
+                    VD, [&CGF, VD, XRValue, Loc]() -> Address {
+                      Address LHSTemp = CGF.CreateMemTemp(VD->getType());
+                      CGF.emitOMPSimpleStore(
+                          CGF.MakeAddrLValue(LHSTemp, VD->getType()), XRValue,
+                          VD->getType().getNonReferenceType(), Loc);
+                      return LHSTemp;
+                    });
+                (void)PrivateScope.Privatize();
+                return CGF.EmitAnyExpr(UpExpr);
+              });
+        };
+        if ((*IPriv)->getType()->isArrayType()) {
+          // Emit atomic reduction for array section.
+          auto *RHSVar = cast<VarDecl>(cast<DeclRefExpr>(*IRHS)->getDecl());
+          EmitOMPAggregateReduction(CGF, (*IPriv)->getType(), VD, RHSVar,
+                                    AtomicRedGen, XExpr, EExpr, UpExpr);
+        } else
+          // Emit atomic reduction for array subscript or single variable.
+          AtomicRedGen(CGF, XExpr, EExpr, UpExpr);
+      } else {
+        // Emit as a critical region.
+        auto &&CritRedGen = [E, Loc](CodeGenFunction &CGF, const Expr *,
+                                     const Expr *, const Expr *) {
+          auto &RT = CGF.CGM.getOpenMPRuntime();
+          RT.emitCriticalRegion(
+              CGF, ".atomic_reduction",
+              [=](CodeGenFunction &CGF, PrePostActionTy &Action) {
+                Action.Enter(CGF);
+                emitReductionCombiner(CGF, E);
+              },
+              Loc);
+        };
+        if ((*IPriv)->getType()->isArrayType()) {
+          auto *LHSVar = cast<VarDecl>(cast<DeclRefExpr>(*ILHS)->getDecl());
+          auto *RHSVar = cast<VarDecl>(cast<DeclRefExpr>(*IRHS)->getDecl());
+          EmitOMPAggregateReduction(CGF, (*IPriv)->getType(), LHSVar, RHSVar,
+                                    CritRedGen);
+        } else
+          CritRedGen(CGF, nullptr, nullptr, nullptr);
+      }
+      ++ILHS;
+      ++IRHS;
+      ++IPriv;
+    }
+  };
+
+  // With -fopenmp-atomic-reductions, scalar reductions that all have an atomic
+  // form are combined directly, skipping __kmpc_reduce{_nowait}() and its
+  // reduce_func(); without nowait a barrier stands in for __kmpc_end_reduce().
+  if (C.getLangOpts().OpenMPAtomicReductions &&
+      isAtomicScalarReduction(Privates, ReductionOps)) {
+    RegionCodeGenTy AtomicRCG(AtomicCodeGen);
+    AtomicRCG(CGF);
+    if (!WithNowait)
+      emitBarrierCall(CGF, Loc, OMPD_unknown, /*EmitChecks=*/false);
+    return;
+  }
+
   // 1. Build a list of reduction variables.
   // void *RedList[<n>] = {<ReductionVars>[0], ..., <ReductionVars>[<n>-1]};
   auto Size = RHSExprs.size();
@@ -4506,98 +4735,6 @@ void CGOpenMPRuntime::emitReduction(CodeGenFunction &CGF, SourceLocation Loc,
   SwInst->addCase(CGF.Builder.getInt32(2), Case2BB);
   CGF.EmitBlock(Case2BB);
 
-  auto &&AtomicCodeGen = [Loc, &Privates, &LHSExprs, &RHSExprs, &ReductionOps](
-      CodeGenFunction &CGF, PrePostActionTy &Action) {
-    auto ILHS = LHSExprs.begin();
-    auto IRHS = RHSExprs.begin();
-    auto IPriv = Privates.begin();
-    for (auto *E : ReductionOps) {
-      const Expr *XExpr = nullptr;
-      const Expr *EExpr = nullptr;
-      const Expr *UpExpr = nullptr;
-      BinaryOperatorKind BO = BO_Comma;
-      if (auto *BO = dyn_cast<BinaryOperator>(E)) {
-        if (BO->getOpcode() == BO_Assign) {
-          XExpr = BO->getLHS();
-          UpExpr = BO->getRHS();
-        }
-      }
-      // Try to emit update expression as a simple atomic.
-      auto *RHSExpr = UpExpr;
-      if (RHSExpr) {
-        // Analyze RHS part of the whole expression.
-        if (auto *ACO = dyn_cast<AbstractConditionalOperator>(
-                RHSExpr->IgnoreParenImpCasts())) {
-          // If this is a conditional operator, analyze its condition for
-          // min/max reduction operator.
-          RHSExpr = ACO->getCond();
-        }
-        if (auto *BORHS =
-                dyn_cast<BinaryOperator>(RHSExpr->IgnoreParenImpCasts())) {
-          EExpr = BORHS->getRHS();
-          BO = BORHS->getOpcode();
-        }
-      }
-      if (XExpr) {
-        auto *VD = cast<VarDecl>(cast<DeclRefExpr>(*ILHS)->getDecl());
-        auto &&AtomicRedGen = [BO, VD, IPriv,
-                               Loc](CodeGenFunction &CGF, const Expr *XExpr,
-                                    const Expr *EExpr, const Expr *UpExpr) {
-          LValue X = CGF.EmitLValue(XExpr);
-          RValue E;
-          if (EExpr)
-            E = CGF.EmitAnyExpr(EExpr);
-          CGF.EmitOMPAtomicSimpleUpdateExpr(
-              X, E, BO, /*IsXLHSInRHSPart=*/true,
-              llvm::AtomicOrdering::Monotonic, Loc,
-              [&CGF, UpExpr, VD, IPriv, Loc](RValue XRValue) {
-                CodeGenFunction::OMPPrivateScope PrivateScope(CGF);
-                PrivateScope.addPrivate(
-                    VD, [&CGF, VD, XRValue, Loc]() -> Address {
-                      Address LHSTemp = CGF.CreateMemTemp(VD->getType());
-                      CGF.emitOMPSimpleStore(
-                          CGF.MakeAddrLValue(LHSTemp, VD->getType()), XRValue,
-                          VD->getType().getNonReferenceType(), Loc);
-                      return LHSTemp;
-                    });
-                (void)PrivateScope.Privatize();
-                return CGF.EmitAnyExpr(UpExpr);
-              });
-        };
-        if ((*IPriv)->getType()->isArrayType()) {
-          // Emit atomic reduction for array section.
-          auto *RHSVar = cast<VarDecl>(cast<DeclRefExpr>(*IRHS)->getDecl());
-          EmitOMPAggregateReduction(CGF, (*IPriv)->getType(), VD, RHSVar,
-                                    AtomicRedGen, XExpr, EExpr, UpExpr);
-        } else
-          // Emit atomic reduction for array subscript or single variable.
-          AtomicRedGen(CGF, XExpr, EExpr, UpExpr);
-      } else {
-        // Emit as a critical region.
-        auto &&CritRedGen = [E, Loc](CodeGenFunction &CGF, const Expr *,
-                                     const Expr *, const Expr *) {
-          auto &RT = CGF.CGM.getOpenMPRuntime();
-          RT.emitCriticalRegion(
-              CGF, ".atomic_reduction",
-              [=](CodeGenFunction &CGF, PrePostActionTy &Action) {
-                Action.Enter(CGF);
-                emitReductionCombiner(CGF, E);
-              },
-              Loc);
-        };
-        if ((*IPriv)->getType()->isArrayType()) {
-          auto *LHSVar = cast<VarDecl>(cast<DeclRefExpr>(*ILHS)->getDecl());
-          auto *RHSVar = cast<VarDecl>(cast<DeclRefExpr>(*IRHS)->getDecl());
-          EmitOMPAggregateReduction(CGF, (*IPriv)->getType(), LHSVar, RHSVar,
-                                    CritRedGen);
-        } else
-          CritRedGen(CGF, nullptr, nullptr, nullptr);
-      }
-      ++ILHS;
-      ++IRHS;
-      ++IPriv;
-    }
-  };
   RegionCodeGenTy AtomicRCG(AtomicCodeGen);
   if (!WithNowait) {
     // Add emission of __kmpc_end_reduce(<loc>, <gtid>, &<lock>);
@@ -401,6 +401,15 @@ private:
   /// size \a IVSize and sign \a IVSigned.
   llvm::Constant *createForStaticInitFunction(unsigned IVSize, bool IVSigned);
 
+  /// \brief Computes the chunk of a static non-chunked loop for the current
+  /// thread from omp_get_thread_num() and omp_get_num_threads(), storing the
+  /// same results into \a IL, \a LB, \a UB and \a ST that
+  /// __kmpc_for_static_init_* would with libomp's default greedy static
+  /// schedule.
+  void emitInlineStaticInit(CodeGenFunction &CGF, SourceLocation Loc,
+                            unsigned IVSize, Address IL, Address LB,
+                            Address UB, Address ST);
+
   /// \brief Returns __kmpc_dispatch_init_* runtime function for the specified
   /// size \a IVSize and sign \a IVSigned.
   llvm::Constant *createDispatchInitFunction(unsigned IVSize, bool IVSigned);
@@ -476,7 +485,8 @@ private:
   ///   return 0;
   /// }
   /// 2. Copy a list of shared variables to field shareds of the resulting
-  /// structure kmp_task_t returned by the previous call (if any).
+  /// structure kmp_task_t returned by the previous call (if any), or point
+  /// that field to \p Shareds if the task is undeferred.
   /// 3. Copy a pointer to destructions function to field destructions of the
   /// resulting structure kmp_task_t.
   /// \param D Current task directive.
@@ -487,10 +497,13 @@ private:
   /// TaskFunction.
   /// \param Data Additional data for task generation like tiednsee, final
   /// state, list of privates etc.
+  /// \param Undeferred true if the task is known to complete before the
+  /// encountering task resumes, so that \p Shareds outlives it.
   TaskResultTy emitTaskInit(CodeGenFunction &CGF, SourceLocation Loc,
                             const OMPExecutableDirective &D,
                             llvm::Value *TaskFunction, QualType SharedsTy,
-                            Address Shareds, const OMPTaskDataTy &Data);
+                            Address Shareds, const OMPTaskDataTy &Data,
+                            bool Undeferred = false);
 
 public:
   explicit CGOpenMPRuntime(CodeGenModule &CGM);
@@ -621,6 +634,17 @@ public:
   virtual bool isStaticNonchunked(OpenMPScheduleClauseKind ScheduleKind,
                                   bool Chunked) const;
 
+  /// \brief Check if the specified \a ScheduleKind is static non-chunked and
+  /// its chunk is computed inline rather than by __kmpc_for_static_init(), as
+  /// requested by -fopenmp-inline-static-schedule. Such loops must not be
+  /// finished by emitForStaticFinish().
+  /// \param ScheduleKind Schedule kind specified in the 'schedule' clause.
+  /// \param Chunked True if chunk is specified in the clause.
+  /// \param Ordered true if loop is ordered, false otherwise.
+  ///
+  bool isInlineStaticNonchunked(OpenMPScheduleClauseKind ScheduleKind,
+                                bool Chunked, bool Ordered) const;
+
   /// \brief Check if the specified \a ScheduleKind is static non-chunked.
   /// This kind of distribute directive is emitted without outer loop.
   /// \param ScheduleKind Schedule kind specified in the 'dist_schedule' clause.
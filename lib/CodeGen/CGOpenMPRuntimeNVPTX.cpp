@@ -261,6 +261,35 @@ void CGOpenMPRuntimeNVPTX::emitEntryFooter(CodeGenFunction &CGF,
   CGF.EmitBlock(EST.ExitBB);
 }
 
+void CGOpenMPRuntimeNVPTX::emitSequentialEntryHeader(CodeGenFunction &CGF,
+                                                     EntryFunctionState &EST) {
+  CGBuilderTy &Bld = CGF.Builder;
+
+  // Get the master thread id.
+  llvm::Value *MasterID = getMasterThreadID(CGF);
+  // Current thread's identifier.
+  llvm::Value *ThreadID = getNVPTXThreadID(CGF);
+
+  llvm::BasicBlock *MasterBB = CGF.createBasicBlock(".master");
+  EST.ExitBB = CGF.createBasicBlock(".exit");
+
+  // No parallel work will be handed out, so every thread but the master exits.
+  llvm::Value *IsMaster = Bld.CreateICmpEQ(ThreadID, MasterID, "is_master");
+  Bld.CreateCondBr(IsMaster, MasterBB, EST.ExitBB);
+
+  CGF.EmitBlock(MasterBB);
+  llvm::Value *Args[] = {Bld.getInt32(/*OmpHandle=*/0), getNVPTXThreadID(CGF)};
+  CGF.EmitRuntimeCall(createNVPTXRuntimeFunction(OMPRTL_NVPTX__kmpc_kernel_init),
+                      Args);
+}
+
+void CGOpenMPRuntimeNVPTX::emitSequentialEntryFooter(CodeGenFunction &CGF,
+                                                     EntryFunctionState &EST) {
+  // There are no workers to terminate.
+  CGF.EmitBranch(EST.ExitBB);
+  CGF.EmitBlock(EST.ExitBB);
+}
+
 /// \brief Returns specified OpenMP runtime function for the current OpenMP
 /// implementation.  Specialized for the NVPTX device.
 /// \param Function OpenMP runtime function.
@@ -304,6 +333,20 @@ void CGOpenMPRuntimeNVPTX::createOffloadEntry(llvm::Constant *ID,
   MD->addOperand(llvm::MDNode::get(Ctx, MDVals));
 }
 
+/// \brief Check if \p S contains a 'parallel' directive, which would need the
+/// worker threads of the target region.
+static bool hasNestedParallelDirective(const Stmt *S) {
+  if (!S)
+    return false;
+  if (auto *D = dyn_cast<OMPExecutableDirective>(S))
+    if (isOpenMPParallelDirective(D->getDirectiveKind()))
+      return true;
+  for (const Stmt *Child : S->children())
+    if (hasNestedParallelDirective(Child))
+      return true;
+  return false;
+}
+
 void CGOpenMPRuntimeNVPTX::emitTargetOutlinedFunction(
     const OMPExecutableDirective &D, StringRef ParentName,
     llvm::Function *&OutlinedFn, llvm::Constant *&OutlinedFnID,
@@ -314,6 +357,33 @@ void CGOpenMPRuntimeNVPTX::emitTargetOutlinedFunction(
   assert(!ParentName.empty() && "Invalid target region parent name!");
 
   EntryFunctionState EST;
+
+  // A region without parallel work runs on the master thread alone; skip the
+  // worker function and the handshake with it.
+  if (CGM.getLangOpts().OpenMPNVPTXSkipWorkerLoop &&
+      !hasNestedParallelDirective(D.getAssociatedStmt())) {
+    class NVPTXSequentialPrePostActionTy : public PrePostActionTy {
+      CGOpenMPRuntimeNVPTX &RT;
+      CGOpenMPRuntimeNVPTX::EntryFunctionState &EST;
+
+    public:
+      NVPTXSequentialPrePostActionTy(
+          CGOpenMPRuntimeNVPTX &RT,
+          CGOpenMPRuntimeNVPTX::EntryFunctionState &EST)
+          : RT(RT), EST(EST) {}
+      void Enter(CodeGenFunction &CGF) override {
+        RT.emitSequentialEntryHeader(CGF, EST);
+      }
+      void Exit(CodeGenFunction &CGF) override {
+        RT.emitSequentialEntryFooter(CGF, EST);
+      }
+    } Action(*this, EST);
+    CodeGen.setAction(Action);
+    emitTargetOutlinedFunctionHelper(D, ParentName, OutlinedFn, OutlinedFnID,
+                                     IsOffloadEntry, CodeGen);
+    return;
+  }
+
   WorkerFunctionState WST(CGM);
 
   // Emit target region as a standalone region.
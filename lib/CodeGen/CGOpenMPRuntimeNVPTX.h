@@ -51,6 +51,15 @@ public:
   /// \brief Signal termination of OMP execution.
   void emitEntryFooter(CodeGenFunction &CGF, EntryFunctionState &EST);
 
+  /// \brief Helper for target entry function without parallel regions. Only
+  /// the master thread runs the region; the other threads exit at once.
+  void emitSequentialEntryHeader(CodeGenFunction &CGF,
+                                 EntryFunctionState &EST);
+
+  /// \brief Finish a target entry function without parallel regions.
+  void emitSequentialEntryFooter(CodeGenFunction &CGF,
+                                 EntryFunctionState &EST);
+
 private:
   //
   // NVPTX calls.
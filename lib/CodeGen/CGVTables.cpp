@@ -520,9 +520,111 @@ void CodeGenVTables::EmitThunks(GlobalDecl GD)
     emitThunk(GD, Thunk, /*ForVTable=*/false);
 }
 
+bool CodeGenVTables::useRelativeLayout() const {
+  return CGM.getCodeGenOpts().RelativeCXXABIVTables &&
+         !CGM.getTarget().getCXXABI().isMicrosoft();
+}
+
+llvm::Type *CodeGenVTables::getVTableComponentType() const {
+  return useRelativeLayout() ? CGM.Int32Ty : CGM.Int8PtrTy;
+}
+
+CharUnits CodeGenVTables::getVTableComponentSize() const {
+  if (useRelativeLayout())
+    return CharUnits::fromQuantity(4);
+  return CGM.getContext().toCharUnitsFromBits(
+      CGM.getTarget().getPointerWidth(0));
+}
+
+CharUnits CodeGenVTables::getVTableComponentOffset(CharUnits Offset) const {
+  if (!useRelativeLayout())
+    return Offset;
+  CharUnits PointerWidth = CGM.getContext().toCharUnitsFromBits(
+      CGM.getTarget().getPointerWidth(0));
+  return getVTableComponentSize() * (Offset / PointerWidth);
+}
+
+llvm::Function *CodeGenVTables::getRelativeFunctionStub(llvm::Function *F) {
+  SmallString<256> Name(F->getName());
+  Name += ".stub";
+  if (llvm::Function *Stub = CGM.getModule().getFunction(Name))
+    return Stub;
+
+  // The stub is identical in every object that references F, so it can be
+  // merged across the link, but it must never be preempted itself.
+  llvm::Function *Stub = llvm::Function::Create(
+      F->getFunctionType(), llvm::GlobalValue::LinkOnceODRLinkage, Name,
+      &CGM.getModule());
+  Stub->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  Stub->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  Stub->setCallingConv(F->getCallingConv());
+  Stub->setAttributes(F->getAttributes());
+  if (CGM.supportsCOMDAT())
+    Stub->setComdat(CGM.getModule().getOrInsertComdat(Stub->getName()));
+
+  CGBuilderTy Builder(CGM, llvm::BasicBlock::Create(CGM.getLLVMContext(),
+                                                    "entry", Stub));
+  SmallVector<llvm::Value *, 8> Args;
+  for (llvm::Argument &A : Stub->args())
+    Args.push_back(&A);
+  llvm::CallInst *Call = Builder.CreateCall(F, Args);
+  Call->setTailCallKind(llvm::CallInst::TCK_MustTail);
+  Call->setCallingConv(F->getCallingConv());
+  Call->setAttributes(F->getAttributes());
+  if (Call->getType()->isVoidTy())
+    Builder.CreateRetVoid();
+  else
+    Builder.CreateRet(Call);
+  return Stub;
+}
+
+llvm::Constant *CodeGenVTables::getRelativeComponent(
+    llvm::GlobalVariable *VTable, unsigned AddressPoint,
+    llvm::Constant *Target, bool IsRTTI) {
+  auto *GV = cast<llvm::GlobalValue>(Target->stripPointerCasts());
+  llvm::Constant *Local = GV;
+  if (IsRTTI) {
+    // typeid always loads the type_info through a pointer, so the RTTI
+    // component refers to a hidden proxy holding its address. The proxy is
+    // the one relocation the type_info needs.
+    SmallString<256> Name(GV->getName());
+    Name += ".rtti_proxy";
+    llvm::GlobalVariable *Proxy = CGM.getModule().getNamedGlobal(Name);
+    if (!Proxy) {
+      Proxy = new llvm::GlobalVariable(
+          CGM.getModule(), CGM.Int8PtrTy, /*isConstant=*/true,
+          llvm::GlobalValue::LinkOnceODRLinkage,
+          llvm::ConstantExpr::getBitCast(GV, CGM.Int8PtrTy), Name);
+      Proxy->setVisibility(llvm::GlobalValue::HiddenVisibility);
+      Proxy->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+      Proxy->setAlignment(CGM.getPointerAlign().getQuantity());
+      if (CGM.supportsCOMDAT())
+        Proxy->setComdat(CGM.getModule().getOrInsertComdat(Proxy->getName()));
+    }
+    Local = Proxy;
+  } else if (!GV->hasLocalLinkage() && GV->hasDefaultVisibility()) {
+    // An offset can only be resolved at link time if the target cannot be
+    // preempted; otherwise go through a local stub.
+    if (auto *F = dyn_cast<llvm::Function>(GV))
+      Local = getRelativeFunctionStub(F);
+  }
+
+  llvm::Constant *Indices[] = {
+    llvm::ConstantInt::get(CGM.Int32Ty, 0),
+    llvm::ConstantInt::get(CGM.Int32Ty, AddressPoint)
+  };
+  llvm::Constant *Base = llvm::ConstantExpr::getInBoundsGetElementPtr(
+      VTable->getValueType(), VTable, Indices);
+  llvm::Constant *Offset = llvm::ConstantExpr::getSub(
+      llvm::ConstantExpr::getPtrToInt(Local, CGM.IntPtrTy),
+      llvm::ConstantExpr::getPtrToInt(Base, CGM.IntPtrTy));
+  return llvm::ConstantExpr::getTrunc(Offset, CGM.Int32Ty);
+}
+
 llvm::Constant *CodeGenVTables::CreateVTableInitializer(
-    const CXXRecordDecl *RD, const VTableComponent *Components,
-    unsigned NumComponents, const VTableLayout::VTableThunkTy *VTableThunks,
+    llvm::GlobalVariable *VTable, const CXXRecordDecl *RD,
+    const VTableComponent *Components, unsigned NumComponents,
+    const VTableLayout::VTableThunkTy *VTableThunks,
     unsigned NumVTableThunks, llvm::Constant *RTTI) {
   SmallVector<llvm::Constant *, 64> Inits;
 
@@ -531,6 +633,12 @@ llvm::Constant *CodeGenVTables::CreateVTableInitializer(
   llvm::Type *PtrDiffTy = 
     CGM.getTypes().ConvertType(CGM.getContext().getPointerDiffType());
 
+  // With the relative layout, offsets are stored as 32-bit integers and
+  // pointers as 32-bit offsets from the address point of their vtable, which
+  // immediately follows the RTTI component.
+  bool Relative = useRelativeLayout();
+  unsigned AddressPoint = 0;
+
   unsigned NextVTableThunkIndex = 0;
 
   llvm::Constant *PureVirtualFn = nullptr, *DeletedVirtualFn = nullptr;
@@ -558,6 +666,7 @@ llvm::Constant *CodeGenVTables::CreateVTableInitializer(
       break;
     case VTableComponent::CK_RTTI:
       Init = llvm::ConstantExpr::getBitCast(RTTI, Int8PtrTy);
+      AddressPoint = I + 1;
       break;
     case VTableComponent::CK_FunctionPointer:
     case VTableComponent::CK_CompleteDtorPointer:
@@ -648,11 +757,24 @@ llvm::Constant *CodeGenVTables::CreateVTableInitializer(
       Init = llvm::ConstantExpr::getNullValue(Int8PtrTy);
       break;
     };
+
+    if (Relative) {
+      if (Component.isRTTIKind() || Component.isFunctionPointerKind()) {
+        Init = Init->isNullValue()
+                   ? llvm::ConstantInt::get(CGM.Int32Ty, 0)
+                   : getRelativeComponent(VTable, AddressPoint, Init,
+                                          Component.isRTTIKind());
+      } else {
+        Init = llvm::ConstantExpr::getTrunc(
+            llvm::ConstantExpr::getPtrToInt(Init, PtrDiffTy), CGM.Int32Ty);
+      }
+    }
     
     Inits.push_back(Init);
   }
   
-  llvm::ArrayType *ArrayType = llvm::ArrayType::get(Int8PtrTy, NumComponents);
+  llvm::ArrayType *ArrayType =
+      llvm::ArrayType::get(getVTableComponentType(), NumComponents);
   return llvm::ConstantArray::get(ArrayType, Inits);
 }
 
@@ -680,8 +802,8 @@ CodeGenVTables::GenerateConstructionVTable(const CXXRecordDecl *RD,
                            Base.getBase(), Out);
   StringRef Name = OutName.str();
 
-  llvm::ArrayType *ArrayType = 
-    llvm::ArrayType::get(CGM.Int8PtrTy, VTLayout->getNumVTableComponents());
+  llvm::ArrayType *ArrayType = llvm::ArrayType::get(
+      getVTableComponentType(), VTLayout->getNumVTableComponents());
 
   // Construction vtable symbols are not part of the Itanium ABI, so we cannot
   // guarantee that they actually will be available externally. Instead, when
@@ -704,7 +826,7 @@ CodeGenVTables::GenerateConstructionVTable(const CXXRecordDecl *RD,
 
   // Create and set the initializer.
   llvm::Constant *Init = CreateVTableInitializer(
-      Base.getBase(), VTLayout->vtable_component_begin(),
+      VTable, Base.getBase(), VTLayout->vtable_component_begin(),
       VTLayout->getNumVTableComponents(), VTLayout->vtable_thunk_begin(),
       VTLayout->getNumVTableThunks(), RTTI);
   VTable->setInitializer(Init);
@@ -942,8 +1064,7 @@ void CodeGenModule::EmitVTableTypeMetadata(llvm::GlobalVariable *VTable,
   if (!getCodeGenOpts().PrepareForLTO)
     return;
 
-  CharUnits PointerWidth =
-      Context.toCharUnitsFromBits(Context.getTargetInfo().getPointerWidth(0));
+  CharUnits ComponentWidth = getVTables().getVTableComponentSize();
 
   typedef std::pair<const CXXRecordDecl *, unsigned> BSEntry;
   std::vector<BSEntry> BitsetEntries;
@@ -978,6 +1099,6 @@ void CodeGenModule::EmitVTableTypeMetadata(llvm::GlobalVariable *VTable,
   });
 
   for (auto BitsetEntry : BitsetEntries)
-    AddVTableTypeMetadata(VTable, PointerWidth * BitsetEntry.second,
+    AddVTableTypeMetadata(VTable, ComponentWidth * BitsetEntry.second,
                           BitsetEntry.first);
 }
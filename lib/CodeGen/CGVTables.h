@@ -56,16 +56,46 @@ class CodeGenVTables {
   /// the ABI.
   void maybeEmitThunkForVTable(GlobalDecl GD, const ThunkInfo &Thunk);
 
+  /// getRelativeComponent - Return the 32-bit offset from the given address
+  /// point of \p VTable to \p Target, going through a local stub or proxy
+  /// when the target may be preempted.
+  llvm::Constant *getRelativeComponent(llvm::GlobalVariable *VTable,
+                                       unsigned AddressPoint,
+                                       llvm::Constant *Target, bool IsRTTI);
+
+  /// getRelativeFunctionStub - Return a hidden function that tail calls
+  /// \p F, for use as a vtable slot that must not be preempted.
+  llvm::Function *getRelativeFunctionStub(llvm::Function *F);
+
 public:
   /// CreateVTableInitializer - Create a vtable initializer for the given record
   /// decl.
+  /// \param VTable - The vtable being initialized.
   /// \param Components - The vtable components; this is really an array of
   /// VTableComponents.
   llvm::Constant *CreateVTableInitializer(
-      const CXXRecordDecl *RD, const VTableComponent *Components,
-      unsigned NumComponents, const VTableLayout::VTableThunkTy *VTableThunks,
+      llvm::GlobalVariable *VTable, const CXXRecordDecl *RD,
+      const VTableComponent *Components, unsigned NumComponents,
+      const VTableLayout::VTableThunkTy *VTableThunks,
       unsigned NumVTableThunks, llvm::Constant *RTTI);
 
+  /// useRelativeLayout - Whether vtables hold 32-bit offsets relative to
+  /// their address point instead of pointers
+  /// (-fexperimental-relative-c++-abi-vtables). Only the Itanium ABI supports
+  /// this layout.
+  bool useRelativeLayout() const;
+
+  /// getVTableComponentType - Return the LLVM type of a vtable component.
+  llvm::Type *getVTableComponentType() const;
+
+  /// getVTableComponentSize - Return the size of a vtable component.
+  CharUnits getVTableComponentSize() const;
+
+  /// getVTableComponentOffset - Rescale an offset into a vtable, as computed
+  /// by the VTableContext for pointer-sized components, to the component size
+  /// actually in use.
+  CharUnits getVTableComponentOffset(CharUnits Offset) const;
+
   CodeGenVTables(CodeGenModule &CGM);
 
   ItaniumVTableContext &getItaniumVTableContext() {
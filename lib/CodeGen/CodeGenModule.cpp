@@ -40,11 +40,14 @@
 #include "clang/Basic/Module.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Basic/Version.h"
 #include "clang/Frontend/CodeGenOptions.h"
 #include "clang/Sema/SemaDiagnostic.h"
 #include "llvm/ADT/APSInt.h"
+#include "llvm/ADT/Statistic.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
 #include "llvm/IR/CallSite.h"
 #include "llvm/IR/CallingConv.h"
 #include "llvm/IR/DataLayout.h"
@@ -54,11 +57,21 @@
 #include "llvm/ProfileData/InstrProfReader.h"
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/MD5.h"
+#include "llvm/Transforms/IPO/PassManagerBuilder.h"
 
 using namespace clang;
 using namespace CodeGen;
 
+#define DEBUG_TYPE "codegenmodule"
+
+STATISTIC(NumDeferredDecls, "The # of definitions whose emission was deferred");
+STATISTIC(NumDeferredDeclsReplaced,
+          "The # of deferred definitions replaced by a later one");
+STATISTIC(NumDeferredDeclsUsed,
+          "The # of deferred definitions emitted because they were used");
+
 static const char AnnotationSection[] = "llvm.metadata";
 
 static CGCXXABI *createCXXABI(CodeGenModule &CGM) {
@@ -152,14 +165,69 @@ CodeGenModule::CodeGenModule(ASTContext &C, const HeaderSearchOptions &HSO,
       PGOReader = std::move(ReaderOrErr.get());
   }
 
+  if (!CodeGenOpts.DefinitionOwnersFile.empty())
+    readDefinitionOwners(CodeGenOpts.DefinitionOwnersFile, DefinitionOwners);
+
+  if (CodeGenOpts.StreamingCodeGen && CodeGenOpts.OptimizationLevel > 0 &&
+      !CodeGenOpts.DisableLLVMOpts && !CodeGenOpts.DisableLLVMPasses)
+    createFunctionPasses();
+
   // If coverage mapping generation is enabled, create the
   // CoverageMappingModuleGen object.
   if (CodeGenOpts.CoverageMapping)
     CoverageMapping.reset(new CoverageMappingModuleGen(*this, *CoverageInfo));
 }
 
+/// Reads a file like the -fdefinition-owners one. Each of its lines holds a
+/// mangled name and the name of the object that owns its definition,
+/// separated by whitespace. Empty lines and lines starting with '#' are
+/// ignored.
+void CodeGenModule::readDefinitionOwners(StringRef Path,
+                                         llvm::StringMap<bool> &Owners) {
+  auto BufferOrErr = llvm::MemoryBuffer::getFile(Path);
+  if (std::error_code EC = BufferOrErr.getError()) {
+    unsigned DiagID = getDiags().getCustomDiagID(
+        DiagnosticsEngine::Error, "Could not read definition owners %0: %1");
+    getDiags().Report(DiagID) << Path << EC.message();
+    return;
+  }
+
+  SmallVector<StringRef, 0> Lines;
+  (*BufferOrErr)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                    /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    Line = Line.trim();
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+    size_t Separator = Line.find_first_of(" \t");
+    if (Separator == StringRef::npos)
+      continue;
+    Owners[Line.substr(0, Separator)] =
+        Line.substr(Separator).trim() == CodeGenOpts.DefinitionOwner;
+  }
+}
+
 CodeGenModule::~CodeGenModule() {}
 
+/// Sets up the per-function optimizations that the backend would otherwise run
+/// on all the functions of the module at the end, so that they can run on each
+/// function as soon as it is generated instead. The simplified functions take
+/// less memory for the rest of the translation unit.
+void CodeGenModule::createFunctionPasses() {
+  llvm::PassManagerBuilder PMBuilder;
+  PMBuilder.OptLevel = CodeGenOpts.OptimizationLevel;
+  PMBuilder.SizeLevel = CodeGenOpts.OptimizeSize;
+  auto *TLII =
+      new llvm::TargetLibraryInfoImpl(llvm::Triple(TheModule.getTargetTriple()));
+  if (!CodeGenOpts.SimplifyLibCalls)
+    TLII->disableAllFunctions();
+  PMBuilder.LibraryInfo = TLII;
+
+  FunctionPasses.reset(new llvm::legacy::FunctionPassManager(&TheModule));
+  PMBuilder.populateFunctionPassManager(*FunctionPasses);
+  FunctionPasses->doInitialization();
+}
+
 void CodeGenModule::createObjCRuntime() {
   // This is just isGNUFamily(), but we want to force implementors of
   // new ABIs to decide how best to do this.
@@ -372,6 +440,8 @@ void InstrProfStats::reportDiagnostics(DiagnosticsEngine &Diags,
 
 void CodeGenModule::Release() {
   EmitDeferred();
+  if (FunctionPasses)
+    FunctionPasses->doFinalization();
   applyGlobalValReplacements();
   applyReplacements();
   checkAliases();
@@ -774,7 +844,20 @@ CodeGenModule::getFunctionLinkage(GlobalDecl GD) {
     return llvm::GlobalValue::InternalLinkage;
   }
 
-  return getLLVMLinkageForDeclarator(D, Linkage, /*isConstantVariable=*/false);
+  llvm::GlobalValue::LinkageTypes Result =
+      getLLVMLinkageForDeclarator(D, Linkage, /*isConstantVariable=*/false);
+
+  // A linkonce_odr function owned by another object is only made available
+  // for inlining, or not emitted at all at -O0. Its owner emits it as
+  // weak_odr, so that it is kept even if every call to it there is inlined.
+  if (Result == llvm::GlobalValue::LinkOnceODRLinkage &&
+      !DefinitionOwners.empty()) {
+    auto I = DefinitionOwners.find(getMangledName(GD));
+    if (I != DefinitionOwners.end())
+      return I->second ? llvm::GlobalValue::WeakODRLinkage
+                       : llvm::GlobalValue::AvailableExternallyLinkage;
+  }
+  return Result;
 }
 
 void CodeGenModule::setFunctionDLLStorageClass(GlobalDecl GD, llvm::Function *F) {
@@ -1398,9 +1481,9 @@ bool CodeGenModule::isInSanitizerBlacklist(llvm::Function *Fn,
   // If location is unknown, this may be a compiler-generated function. Assume
   // it's located in the main file.
   auto &SM = Context.getSourceManager();
-  if (const auto *MainFile = SM.getFileEntryForID(SM.getMainFileID())) {
-    return SanitizerBL.isBlacklistedFile(MainFile->getName());
-  }
+  if (SM.getFileEntryForID(SM.getMainFileID()))
+    return SanitizerBL.isBlacklistedLocation(
+        SM.getLocForStartOfFile(SM.getMainFileID()));
   return false;
 }
 
@@ -1640,10 +1723,20 @@ void CodeGenModule::EmitGlobal(GlobalDecl GD) {
     // Otherwise, remember that we saw a deferred decl with this name.  The
     // first use of the mangled name will cause it to move into
     // DeferredDeclsToEmit.
-    DeferredDecls[MangledName] = GD;
+    addDeferredDecl(MangledName, GD);
   }
 }
 
+void CodeGenModule::addDeferredDecl(StringRef MangledName, GlobalDecl GD) {
+  auto Result = DeferredDecls.insert(std::make_pair(MangledName, GD));
+  if (Result.second) {
+    ++NumDeferredDecls;
+    return;
+  }
+  Result.first->second = GD;
+  ++NumDeferredDeclsReplaced;
+}
+
 namespace {
   struct FunctionIsDirectlyRecursive :
     public RecursiveASTVisitor<FunctionIsDirectlyRecursive> {
@@ -1940,6 +2033,7 @@ CodeGenModule::GetOrCreateLLVMFunction(StringRef MangledName,
       // don't need it anymore).
       addDeferredDeclToEmit(F, DDI->second);
       DeferredDecls.erase(DDI);
+      ++NumDeferredDeclsUsed;
 
       // Otherwise, there are cases we have to worry about where we're
       // using a declaration for which we must emit a definition but where
@@ -2137,6 +2231,7 @@ CodeGenModule::GetOrCreateLLVMGlobal(StringRef MangledName,
     // list, and remove it from DeferredDecls (since we don't need it anymore).
     addDeferredDeclToEmit(GV, DDI->second);
     DeferredDecls.erase(DDI);
+    ++NumDeferredDeclsUsed;
   }
 
   // Handle things which are present even on external declarations.
@@ -2290,7 +2385,7 @@ void CodeGenModule::EmitTentativeDefinition(const VarDecl *D) {
   // If we have not seen a reference to this variable yet, place it into the
   // deferred declarations table to be emitted if needed later.
   if (!MustBeEmitted(D) && !GV) {
-      DeferredDecls[MangledName] = D;
+      addDeferredDecl(MangledName, D);
       return;
   }
 
@@ -2424,6 +2519,8 @@ void CodeGenModule::EmitGlobalVarDefinition(const VarDecl *D,
       if (getLangOpts().CPlusPlus) {
         Init = EmitNullConstant(T);
         NeedsGlobalCtor = true;
+        getDiags().Report(D->getLocation(), diag::remark_dynamic_global_init)
+            << D;
       } else {
         ErrorUnsupported(D, "static initializer");
         Init = llvm::UndefValue::get(getTypes().ConvertType(T));
@@ -2867,6 +2964,13 @@ void CodeGenModule::HandleCXXStaticMemberVarInstantiation(VarDecl *VD) {
 void CodeGenModule::EmitGlobalFunctionDefinition(GlobalDecl GD,
                                                  llvm::GlobalValue *GV) {
   const auto *D = cast<FunctionDecl>(GD.getDecl());
+  TimeTraceScope TimeScope("CodeGen Function", [&] {
+    std::string Name;
+    llvm::raw_string_ostream OS(Name);
+    D->getNameForDiagnostic(OS, getContext().getPrintingPolicy(),
+                            /*Qualified=*/true);
+    return OS.str();
+  });
 
   // Compute the function info and LLVM type.
   const CGFunctionInfo &FI = getTypes().arrangeGlobalDeclaration(GD);
@@ -2908,6 +3012,9 @@ void CodeGenModule::EmitGlobalFunctionDefinition(GlobalDecl GD,
     AddGlobalDtor(Fn, DA->getPriority());
   if (D->hasAttr<AnnotateAttr>())
     AddGlobalAnnotations(D, Fn);
+
+  if (FunctionPasses)
+    FunctionPasses->run(*Fn);
 }
 
 void CodeGenModule::EmitAliasDefinition(GlobalDecl GD) {
@@ -32,6 +32,7 @@
 #include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/ADT/StringMap.h"
+#include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/Transforms/Utils/SanitizerStats.h"
@@ -64,6 +65,7 @@ class Decl;
 class Expr;
 class Stmt;
 class InitListExpr;
+class PackedArrayInitExpr;
 class StringLiteral;
 class NamedDecl;
 class ValueDecl;
@@ -296,6 +298,10 @@ private:
   InstrProfStats PGOStats;
   std::unique_ptr<llvm::SanitizerStatReport> SanStats;
 
+  /// The per-function optimizations run on each function once its code is
+  /// generated, with -fstreaming-codegen.
+  std::unique_ptr<llvm::legacy::FunctionPassManager> FunctionPasses;
+
   // A set of references that have only been seen via a weakref so far. This is
   // used to remove the weak of the reference if we ever see a direct reference
   // or a definition.
@@ -304,8 +310,10 @@ private:
   /// This contains all the decls which have definitions but/ which are deferred
   /// for emission and therefore should only be output if they are actually
   /// used. If a decl is in this, then it is known to have not been referenced
-  /// yet.
-  std::map<StringRef, GlobalDecl> DeferredDecls;
+  /// yet. The keys are the mangled names returned by getMangledName(), whose
+  /// storage is owned by Manglings, so no string is copied here.
+  llvm::DenseMap<StringRef, GlobalDecl> DeferredDecls;
+  void addDeferredDecl(StringRef MangledName, GlobalDecl GD);
 
   /// This is a list of deferred decls which we have seen that *are* actually
   /// referenced. These get code generated when the module is done.
@@ -354,6 +362,10 @@ private:
   /// emitted when the translation unit is complete.
   CtorList GlobalDtors;
 
+  /// The linkonce_odr functions listed in the -fdefinition-owners file, mapped
+  /// to whether this object owns their definition.
+  llvm::StringMap<bool> DefinitionOwners;
+
   /// An ordered map of canonical GlobalDecls to their mangled names.
   llvm::MapVector<GlobalDecl, StringRef> MangledDeclNames;
   llvm::StringMap<GlobalDecl, llvm::BumpPtrAllocator> Manglings;
@@ -905,6 +917,11 @@ public:
   llvm::Constant *EmitConstantInit(const VarDecl &D,
                                    CodeGenFunction *CGF = nullptr);
 
+  /// Emit a packed array initializer directly from its values, without an
+  /// APValue or an llvm::Constant per element; returns 0 if the array type
+  /// does not lower to an array of integers of the element size.
+  llvm::Constant *EmitPackedArrayInit(const PackedArrayInitExpr *E);
+
   /// Try to emit the given expression as a constant; returns 0 if the
   /// expression cannot be emitted as a constant.
   llvm::Constant *EmitConstantExpr(const Expr *E, QualType DestType,
@@ -994,6 +1011,12 @@ public:
   StringRef getMangledName(GlobalDecl GD);
   StringRef getBlockMangledName(GlobalDecl GD, const BlockDecl *BD);
 
+  /// Reads a map of names to the object owning their definition from \p Path
+  /// into \p Owners, mapping each name to whether this object owns it.
+  void readDefinitionOwners(StringRef Path, llvm::StringMap<bool> &Owners);
+
+  void createFunctionPasses();
+
   void EmitTentativeDefinition(const VarDecl *D);
 
   void EmitVTable(CXXRecordDecl *Class);
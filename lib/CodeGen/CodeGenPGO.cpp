@@ -630,6 +630,8 @@ void CodeGenPGO::assignRegionCounters(GlobalDecl GD, llvm::Function *Fn) {
       return;
   }
   CGM.ClearUnusedCoverageMapping(D);
+  if (D->hasAttr<NoProfileInstrumentFunctionAttr>())
+    return;
   setFuncName(Fn);
 
   mapRegionCounters(D);
@@ -638,6 +640,13 @@ void CodeGenPGO::assignRegionCounters(GlobalDecl GD, llvm::Function *Fn) {
   if (PGOReader) {
     SourceManager &SM = CGM.getContext().getSourceManager();
     loadRegionCounts(PGOReader, SM.isInMainFile(D->getLocation()));
+    // Without a profile record every count would be zero, which is what
+    // getStmtCount reports for a missing map anyway, so skip the walk.
+    if (!haveRegionCounts()) {
+      if (!InstrumentRegions)
+        RegionCounterMap.reset();
+      return;
+    }
     computeRegionCounts(D);
     applyFunctionAttributes(PGOReader, Fn);
   }
@@ -666,7 +675,18 @@ bool CodeGenPGO::skipRegionMappingForDecl(const Decl *D) {
   // Don't map the functions in system headers.
   const auto &SM = CGM.getContext().getSourceManager();
   auto Loc = D->getBody()->getLocStart();
-  return SM.isInSystemHeader(Loc);
+  if (SM.isInSystemHeader(Loc))
+    return true;
+
+  // Externally visible functions defined in headers are mapped by the
+  // objects built without -fno-coverage-mapping-header-functions; their
+  // counters are merged by name and hash. Functions with internal linkage
+  // have a name that is unique to this object, so nothing else maps them.
+  if (!CGM.getCodeGenOpts().CoverageMappingSkipHeaderFunctions ||
+      SM.isInMainFile(Loc))
+    return false;
+  const auto *ND = dyn_cast<NamedDecl>(D);
+  return ND && ND->isExternallyVisible();
 }
 
 void CodeGenPGO::emitCounterRegionMapping(const Decl *D) {
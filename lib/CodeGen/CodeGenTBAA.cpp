@@ -99,6 +99,11 @@ CodeGenTBAA::getTBAAInfo(QualType QTy) {
   if (TypeHasMayAlias(QTy))
     return getChar();
 
+  // Accesses to arrays are accesses to objects of their element types. Look
+  // through the sugar so that a may_alias element type is honored.
+  if (const ArrayType *ATy = Context.getAsArrayType(QTy))
+    return getTBAAInfo(ATy->getElementType());
+
   const Type *Ty = Context.getCanonicalType(QTy).getTypePtr();
 
   if (llvm::MDNode *N = MetadataCache[Ty])
@@ -162,6 +167,27 @@ CodeGenTBAA::getTBAAInfo(QualType QTy) {
     return MetadataCache[Ty] = createTBAAScalarType(OutName, getChar());
   }
 
+  // A union whose members all have the same type node can only hold objects
+  // of that type, so it is described by that node. Other unions may hold
+  // objects of several types at the same offset, which a type node cannot
+  // express, so they stay in the char alias class.
+  if (const RecordType *RTy = dyn_cast<RecordType>(Ty)) {
+    const RecordDecl *RD = RTy->getDecl()->getDefinition();
+    if (RD && RD->isUnion() && !RD->field_empty()) {
+      llvm::MDNode *MemberNode = nullptr;
+      for (const FieldDecl *Field : RD->fields()) {
+        llvm::MDNode *FieldNode = getTBAAInfo(Field->getType());
+        if (MemberNode && FieldNode != MemberNode) {
+          MemberNode = nullptr;
+          break;
+        }
+        MemberNode = FieldNode;
+      }
+      if (MemberNode)
+        return MetadataCache[Ty] = MemberNode;
+    }
+  }
+
   // For now, handle any other kind of type conservatively.
   return MetadataCache[Ty] = getChar();
 }
@@ -381,16 +381,22 @@ llvm::Type *CodeGenTypes::ConvertType(QualType T) {
 
   const Type *Ty = T.getTypePtr();
 
-  // RecordTypes are cached and processed specially.
-  if (const RecordType *RT = dyn_cast<RecordType>(Ty))
-    return ConvertRecordDeclType(RT->getDecl());
-  
   // See if type is already cached.
   llvm::DenseMap<const Type *, llvm::Type *>::iterator TCI = TypeCache.find(Ty);
   // If type is found in map then use it. Otherwise, convert type T.
   if (TCI != TypeCache.end())
     return TCI->second;
 
+  // RecordTypes are processed specially.  Once laid out, the LLVM type of a
+  // record never changes, so it is cached with the other types to skip the
+  // lookup of its decl next time.
+  if (const RecordType *RT = dyn_cast<RecordType>(Ty)) {
+    llvm::StructType *ST = ConvertRecordDeclType(RT->getDecl());
+    if (!ST->isOpaque())
+      TypeCache[Ty] = ST;
+    return ST;
+  }
+
   // If we don't have it in the cache, convert it now.
   llvm::Type *ResultType = nullptr;
   switch (Ty->getTypeClass()) {
@@ -95,6 +95,15 @@ public:
                          const LangOptions &LangOpts)
       : CVM(CVM), SM(SM), LangOpts(LangOpts) {}
 
+  /// \brief Return the spelling line and column of \c Loc, looking up its
+  /// spelling location only once.
+  std::pair<unsigned, unsigned> getSpellingLineAndColumn(SourceLocation Loc) {
+    std::pair<FileID, unsigned> Decomposed = SM.getDecomposedSpellingLoc(Loc);
+    return std::make_pair(
+        SM.getLineNumber(Decomposed.first, Decomposed.second),
+        SM.getColumnNumber(Decomposed.first, Decomposed.second));
+  }
+
   /// \brief Return the precise end location for the given token.
   SourceLocation getPreciseTokenLocEnd(SourceLocation Loc) {
     // We avoid getLocForEndOfToken here, because it doesn't do what we want for
@@ -232,10 +241,9 @@ public:
       auto CovFileID = getCoverageFileID(LocStart);
       if (!CovFileID)
         continue;
-      unsigned LineStart = SM.getSpellingLineNumber(LocStart);
-      unsigned ColumnStart = SM.getSpellingColumnNumber(LocStart);
-      unsigned LineEnd = SM.getSpellingLineNumber(LocEnd);
-      unsigned ColumnEnd = SM.getSpellingColumnNumber(LocEnd);
+      unsigned LineStart, ColumnStart, LineEnd, ColumnEnd;
+      std::tie(LineStart, ColumnStart) = getSpellingLineAndColumn(LocStart);
+      std::tie(LineEnd, ColumnEnd) = getSpellingLineAndColumn(LocEnd);
       auto Region = CounterMappingRegion::makeSkipped(
           *CovFileID, LineStart, ColumnStart, LineEnd, ColumnEnd);
       // Make sure that we only collect the regions that are inside
@@ -269,10 +277,9 @@ public:
              "region spans multiple files");
 
       // Find the spilling locations for the mapping region.
-      unsigned LineStart = SM.getSpellingLineNumber(LocStart);
-      unsigned ColumnStart = SM.getSpellingColumnNumber(LocStart);
-      unsigned LineEnd = SM.getSpellingLineNumber(LocEnd);
-      unsigned ColumnEnd = SM.getSpellingColumnNumber(LocEnd);
+      unsigned LineStart, ColumnStart, LineEnd, ColumnEnd;
+      std::tie(LineStart, ColumnStart) = getSpellingLineAndColumn(LocStart);
+      std::tie(LineEnd, ColumnEnd) = getSpellingLineAndColumn(LocEnd);
 
       assert(LineStart <= LineEnd && "region start and end out of order");
       MappingRegions.push_back(CounterMappingRegion::makeRegion(
@@ -299,10 +306,9 @@ public:
       assert(SM.isWrittenInSameFile(ParentLoc, LocEnd) &&
              "region spans multiple files");
 
-      unsigned LineStart = SM.getSpellingLineNumber(ParentLoc);
-      unsigned ColumnStart = SM.getSpellingColumnNumber(ParentLoc);
-      unsigned LineEnd = SM.getSpellingLineNumber(LocEnd);
-      unsigned ColumnEnd = SM.getSpellingColumnNumber(LocEnd);
+      unsigned LineStart, ColumnStart, LineEnd, ColumnEnd;
+      std::tie(LineStart, ColumnStart) = getSpellingLineAndColumn(ParentLoc);
+      std::tie(LineEnd, ColumnEnd) = getSpellingLineAndColumn(LocEnd);
 
       MappingRegions.push_back(CounterMappingRegion::makeExpansion(
           *ParentFileID, *ExpandedFileID, LineStart, ColumnStart, LineEnd,
@@ -346,6 +346,11 @@ public:
 
   bool requiresLandingPad() const;
 
+  /// Returns the innermost EH scope that is not a lifetime marker, or
+  /// stable_end() if there is none.  Lifetime markers share the landing pad
+  /// of this scope instead of getting landing pads of their own.
+  stable_iterator getInnermostLandingPadScope() const;
+
   /// Determines whether there are any normal cleanups on the stack.
   bool hasNormalCleanups() const {
     return InnermostNormalCleanup != stable_end();
@@ -496,6 +496,33 @@ ItaniumCXXABI::ConvertMemberPointerType(const MemberPointerType *MPT) {
   return llvm::StructType::get(CGM.PtrDiffTy, CGM.PtrDiffTy, nullptr);
 }
 
+/// Load a pointer stored in a relative vtable as a 32-bit offset from the
+/// vtable address point. \p Offset is the byte offset of the component.
+static llvm::Value *emitLoadOfRelativePointer(CodeGenFunction &CGF,
+                                              llvm::Value *VTable,
+                                              llvm::Value *Offset,
+                                              const llvm::Twine &Name = "") {
+  VTable = CGF.Builder.CreateBitCast(VTable, CGF.Int8PtrTy);
+  Offset = CGF.Builder.CreateIntCast(Offset, CGF.Int32Ty, /*isSigned=*/true);
+  llvm::Value *LoadRelative =
+      CGF.CGM.getIntrinsic(llvm::Intrinsic::load_relative, CGF.Int32Ty);
+  return CGF.Builder.CreateCall(LoadRelative, {VTable, Offset}, Name);
+}
+
+/// Load one of the 32-bit offsets stored in a relative vtable and widen it to
+/// ptrdiff_t. \p Offset is the byte offset of the component.
+static llvm::Value *emitLoadOfRelativeOffset(CodeGenFunction &CGF,
+                                             llvm::Value *VTable,
+                                             CharUnits Offset,
+                                             const llvm::Twine &Name = "") {
+  llvm::Value *Ptr = CGF.Builder.CreateBitCast(VTable, CGF.Int8PtrTy);
+  Ptr = CGF.Builder.CreateConstInBoundsGEP1_64(Ptr, Offset.getQuantity());
+  Ptr = CGF.Builder.CreateBitCast(Ptr, CGF.Int32Ty->getPointerTo());
+  llvm::Value *Value =
+      CGF.Builder.CreateAlignedLoad(Ptr, CharUnits::fromQuantity(4));
+  return CGF.Builder.CreateSExt(Value, CGF.PtrDiffTy, Name);
+}
+
 /// In the Itanium and ARM ABIs, method pointers have the form:
 ///   struct { ptrdiff_t ptr; ptrdiff_t adj; } memptr;
 ///
@@ -582,13 +609,19 @@ llvm::Value *ItaniumCXXABI::EmitLoadOfMemberFunctionPointer(
   llvm::Value *VTableOffset = FnAsInt;
   if (!UseARMMethodPtrABI)
     VTableOffset = Builder.CreateSub(VTableOffset, ptrdiff_1);
-  VTable = Builder.CreateGEP(VTable, VTableOffset);
 
   // Load the virtual function to call.
-  VTable = Builder.CreateBitCast(VTable, FTy->getPointerTo()->getPointerTo());
-  llvm::Value *VirtualFn =
-    Builder.CreateAlignedLoad(VTable, CGF.getPointerAlign(),
-                              "memptr.virtualfn");
+  llvm::Value *VirtualFn;
+  if (CGM.getVTables().useRelativeLayout()) {
+    VirtualFn = emitLoadOfRelativePointer(CGF, VTable, VTableOffset);
+    VirtualFn = Builder.CreateBitCast(VirtualFn, FTy->getPointerTo(),
+                                      "memptr.virtualfn");
+  } else {
+    VTable = Builder.CreateGEP(VTable, VTableOffset);
+    VTable = Builder.CreateBitCast(VTable, FTy->getPointerTo()->getPointerTo());
+    VirtualFn = Builder.CreateAlignedLoad(VTable, CGF.getPointerAlign(),
+                                          "memptr.virtualfn");
+  }
   CGF.EmitBranch(FnEnd);
 
   // In the non-virtual path, the function pointer is actually a
@@ -793,10 +826,8 @@ llvm::Constant *ItaniumCXXABI::BuildMemberPointer(const CXXMethodDecl *MD,
   if (MD->isVirtual()) {
     uint64_t Index = CGM.getItaniumVTableContext().getMethodVTableIndex(MD);
 
-    const ASTContext &Context = getContext();
-    CharUnits PointerWidth =
-      Context.toCharUnitsFromBits(Context.getTargetInfo().getPointerWidth(0));
-    uint64_t VTableOffset = (Index * PointerWidth.getQuantity());
+    CharUnits ComponentWidth = CGM.getVTables().getVTableComponentSize();
+    uint64_t VTableOffset = (Index * ComponentWidth.getQuantity());
 
     if (UseARMMethodPtrABI) {
       // ARM C++ ABI 3.2.1:
@@ -1010,10 +1041,15 @@ void ItaniumCXXABI::emitVirtualObjectDelete(CodeGenFunction &CGF,
         CGF.GetVTablePtr(Ptr, CGF.IntPtrTy->getPointerTo(), ClassDecl);
 
     // Track back to entry -2 and pull out the offset there.
-    llvm::Value *OffsetPtr = CGF.Builder.CreateConstInBoundsGEP1_64(
-        VTable, -2, "complete-offset.ptr");
-    llvm::Value *Offset =
-      CGF.Builder.CreateAlignedLoad(OffsetPtr, CGF.getPointerAlign());
+    llvm::Value *Offset;
+    if (CGM.getVTables().useRelativeLayout()) {
+      Offset = emitLoadOfRelativeOffset(
+          CGF, VTable, -2 * CGM.getVTables().getVTableComponentSize());
+    } else {
+      llvm::Value *OffsetPtr = CGF.Builder.CreateConstInBoundsGEP1_64(
+          VTable, -2, "complete-offset.ptr");
+      Offset = CGF.Builder.CreateAlignedLoad(OffsetPtr, CGF.getPointerAlign());
+    }
 
     // Apply the offset.
     llvm::Value *CompletePtr =
@@ -1211,6 +1247,18 @@ llvm::Value *ItaniumCXXABI::EmitTypeid(CodeGenFunction &CGF,
   llvm::Value *Value =
       CGF.GetVTablePtr(ThisPtr, StdTypeInfoPtrTy->getPointerTo(), ClassDecl);
 
+  // With the relative layout, the vtable refers to a proxy holding the
+  // address of the type info.
+  if (CGM.getVTables().useRelativeLayout()) {
+    int64_t Offset = -CGM.getVTables().getVTableComponentSize().getQuantity();
+    Value = emitLoadOfRelativePointer(
+        CGF, Value,
+        llvm::ConstantInt::get(CGM.Int32Ty, Offset, /*isSigned=*/true));
+    Value =
+        CGF.Builder.CreateBitCast(Value, StdTypeInfoPtrTy->getPointerTo());
+    return CGF.Builder.CreateAlignedLoad(Value, CGF.getPointerAlign());
+  }
+
   // Load the type info.
   Value = CGF.Builder.CreateConstInBoundsGEP1_64(Value, -1ULL);
   return CGF.Builder.CreateAlignedLoad(Value, CGF.getPointerAlign());
@@ -1279,11 +1327,17 @@ llvm::Value *ItaniumCXXABI::EmitDynamicCastToVoid(CodeGenFunction &CGF,
       ClassDecl);
 
   // Get the offset-to-top from the vtable.
-  llvm::Value *OffsetToTop =
-      CGF.Builder.CreateConstInBoundsGEP1_64(VTable, -2ULL);
-  OffsetToTop =
-    CGF.Builder.CreateAlignedLoad(OffsetToTop, CGF.getPointerAlign(),
-                                  "offset.to.top");
+  llvm::Value *OffsetToTop;
+  if (CGM.getVTables().useRelativeLayout()) {
+    OffsetToTop = emitLoadOfRelativeOffset(
+        CGF, VTable, -2 * CGM.getVTables().getVTableComponentSize(),
+        "offset.to.top");
+  } else {
+    OffsetToTop = CGF.Builder.CreateConstInBoundsGEP1_64(VTable, -2ULL);
+    OffsetToTop =
+      CGF.Builder.CreateAlignedLoad(OffsetToTop, CGF.getPointerAlign(),
+                                    "offset.to.top");
+  }
 
   // Finally, add the offset to the pointer.
   llvm::Value *Value = ThisAddr.getPointer();
@@ -1310,6 +1364,12 @@ ItaniumCXXABI::GetVirtualBaseClassOffset(CodeGenFunction &CGF,
       CGM.getItaniumVTableContext().getVirtualBaseOffsetOffset(ClassDecl,
                                                                BaseClassDecl);
 
+  if (CGM.getVTables().useRelativeLayout())
+    return emitLoadOfRelativeOffset(
+        CGF, VTablePtr,
+        CGM.getVTables().getVTableComponentOffset(VBaseOffsetOffset),
+        "vbase.offset");
+
   llvm::Value *VBaseOffsetPtr =
     CGF.Builder.CreateConstGEP1_64(VTablePtr, VBaseOffsetOffset.getQuantity(),
                                    "vbase.offset.ptr");
@@ -1459,8 +1519,9 @@ void ItaniumCXXABI::emitVTableDefinitions(CodeGenVTables &CGVT,
 
   // Create and set the initializer.
   llvm::Constant *Init = CGVT.CreateVTableInitializer(
-      RD, VTLayout.vtable_component_begin(), VTLayout.getNumVTableComponents(),
-      VTLayout.vtable_thunk_begin(), VTLayout.getNumVTableThunks(), RTTI);
+      VTable, RD, VTLayout.vtable_component_begin(),
+      VTLayout.getNumVTableComponents(), VTLayout.vtable_thunk_begin(),
+      VTLayout.getNumVTableThunks(), RTTI);
   VTable->setInitializer(Init);
 
   // Set the correct linkage.
@@ -1571,7 +1632,8 @@ llvm::GlobalVariable *ItaniumCXXABI::getAddrOfVTable(const CXXRecordDecl *RD,
 
   ItaniumVTableContext &VTContext = CGM.getItaniumVTableContext();
   llvm::ArrayType *ArrayType = llvm::ArrayType::get(
-      CGM.Int8PtrTy, VTContext.getVTableLayout(RD).getNumVTableComponents());
+      CGM.getVTables().getVTableComponentType(),
+      VTContext.getVTableLayout(RD).getNumVTableComponents());
 
   VTable = CGM.CreateOrReplaceCXXRuntimeVariable(
       Name, ArrayType, llvm::GlobalValue::ExternalLinkage);
@@ -1596,7 +1658,18 @@ llvm::Value *ItaniumCXXABI::getVirtualFunctionPointer(CodeGenFunction &CGF,
   llvm::Value *VTable = CGF.GetVTablePtr(This, Ty, MethodDecl->getParent());
 
   uint64_t VTableIndex = CGM.getItaniumVTableContext().getMethodVTableIndex(GD);
-  if (CGF.ShouldEmitVTableTypeCheckedLoad(MethodDecl->getParent())) {
+  if (CGM.getVTables().useRelativeLayout()) {
+    // llvm.type.checked.load only understands pointer-sized slots, so a
+    // relative vtable is checked with a separate type test instead.
+    CGF.EmitTypeMetadataCodeForVCall(MethodDecl->getParent(), VTable, Loc);
+
+    uint64_t Offset =
+        VTableIndex * CGM.getVTables().getVTableComponentSize().getQuantity();
+    llvm::Value *VFunc = emitLoadOfRelativePointer(
+        CGF, VTable, llvm::ConstantInt::get(CGM.Int32Ty, Offset));
+    return CGF.Builder.CreateBitCast(VFunc, Ty->getPointerElementType(),
+                                     "vfn");
+  } else if (CGF.ShouldEmitVTableTypeCheckedLoad(MethodDecl->getParent())) {
     return CGF.EmitVTableTypeCheckedLoad(
         MethodDecl->getParent(), VTable,
         VTableIndex * CGM.getContext().getTargetInfo().getPointerWidth(0) / 8);
@@ -1605,7 +1678,19 @@ llvm::Value *ItaniumCXXABI::getVirtualFunctionPointer(CodeGenFunction &CGF,
 
     llvm::Value *VFuncPtr =
         CGF.Builder.CreateConstInBoundsGEP1_64(VTable, VTableIndex, "vfn");
-    return CGF.Builder.CreateAlignedLoad(VFuncPtr, CGF.getPointerAlign());
+    auto *VFuncLoad =
+        CGF.Builder.CreateAlignedLoad(VFuncPtr, CGF.getPointerAlign());
+
+    // The entries of a vtable never change.  This is true without
+    // -fstrict-vtable-pointers too, but only then can two calls share a vtable
+    // load, which is what makes a repeated function load worth removing.
+    if (CGM.getCodeGenOpts().OptimizationLevel > 0 &&
+        CGM.getCodeGenOpts().StrictVTablePointers)
+      VFuncLoad->setMetadata(
+          llvm::LLVMContext::MD_invariant_load,
+          llvm::MDNode::get(CGM.getLLVMContext(),
+                            llvm::ArrayRef<llvm::Metadata *>()));
+    return VFuncLoad;
   }
 }
 
@@ -1671,14 +1756,22 @@ static llvm::Value *performTypeAdjustment(CodeGenFunction &CGF,
     Address VTablePtrPtr = CGF.Builder.CreateElementBitCast(V, CGF.Int8PtrTy);
     llvm::Value *VTablePtr = CGF.Builder.CreateLoad(VTablePtrPtr);
 
-    llvm::Value *OffsetPtr =
-        CGF.Builder.CreateConstInBoundsGEP1_64(VTablePtr, VirtualAdjustment);
+    // Load the adjustment offset from the vtable.
+    llvm::Value *Offset;
+    CodeGenVTables &VTables = CGF.CGM.getVTables();
+    if (VTables.useRelativeLayout()) {
+      Offset = emitLoadOfRelativeOffset(
+          CGF, VTablePtr, VTables.getVTableComponentOffset(
+                              CharUnits::fromQuantity(VirtualAdjustment)));
+    } else {
+      llvm::Value *OffsetPtr =
+          CGF.Builder.CreateConstInBoundsGEP1_64(VTablePtr, VirtualAdjustment);
 
-    OffsetPtr = CGF.Builder.CreateBitCast(OffsetPtr, PtrDiffTy->getPointerTo());
+      OffsetPtr =
+          CGF.Builder.CreateBitCast(OffsetPtr, PtrDiffTy->getPointerTo());
 
-    // Load the adjustment offset from the vtable.
-    llvm::Value *Offset =
-      CGF.Builder.CreateAlignedLoad(OffsetPtr, CGF.getPointerAlign());
+      Offset = CGF.Builder.CreateAlignedLoad(OffsetPtr, CGF.getPointerAlign());
+    }
 
     // Adjust our pointer.
     ResultPtr = CGF.Builder.CreateInBoundsGEP(V.getPointer(), Offset);
@@ -3249,8 +3342,9 @@ void ItaniumRTTIBuilder::BuildVMIClassTypeInfo(const CXXRecordDecl *RD) {
     // the virtual base offset for the virtual base referenced (negative).
     CharUnits Offset;
     if (Base.isVirtual())
-      Offset =
-        CGM.getItaniumVTableContext().getVirtualBaseOffsetOffset(RD, BaseDecl);
+      Offset = CGM.getVTables().getVTableComponentOffset(
+          CGM.getItaniumVTableContext().getVirtualBaseOffsetOffset(RD,
+                                                                   BaseDecl));
     else {
       const ASTRecordLayout &Layout = CGM.getContext().getASTRecordLayout(RD);
       Offset = Layout.getBaseClassOffset(BaseDecl);
@@ -326,6 +326,9 @@ void ObjectFilePCHContainerReader::ExtractPCH(
           ( IsCOFF && Name ==   "clangast")) {
         StringRef Buf;
         Section.getContents(Buf);
+        assert(Buf.begin() >= Buffer.getBufferStart() &&
+               Buf.end() <= Buffer.getBufferEnd() &&
+               "AST section is not a slice of the container");
         StreamFile.init((const unsigned char *)Buf.begin(),
                         (const unsigned char *)Buf.end());
         return;
@@ -14,9 +14,20 @@
 #include "clang/Driver/Options.h"
 #include "clang/Driver/ToolChain.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <thread>
+
+#ifdef LLVM_ON_UNIX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 using namespace clang::driver;
 using namespace clang;
@@ -122,8 +133,7 @@ bool Compilation::CleanupFileMap(const ArgStringMap &Files,
   return Success;
 }
 
-int Compilation::ExecuteCommand(const Command &C,
-                                const Command *&FailingCommand) const {
+bool Compilation::PrintCommand(const Command &C) const {
   if ((getDriver().CCPrintOptions ||
        getArgs().hasArg(options::OPT_v)) && !getDriver().CCGenDiagnostics) {
     raw_ostream *OS = &llvm::errs();
@@ -138,9 +148,8 @@ int Compilation::ExecuteCommand(const Command &C,
       if (EC) {
         getDriver().Diag(clang::diag::err_drv_cc_print_options_failure)
             << EC.message();
-        FailingCommand = &C;
         delete OS;
-        return 1;
+        return false;
       }
     }
 
@@ -152,6 +161,15 @@ int Compilation::ExecuteCommand(const Command &C,
     if (OS != &llvm::errs())
       delete OS;
   }
+  return true;
+}
+
+int Compilation::ExecuteCommand(const Command &C,
+                                const Command *&FailingCommand) const {
+  if (!PrintCommand(C)) {
+    FailingCommand = &C;
+    return 1;
+  }
 
   std::string Error;
   bool ExecutionFailed;
@@ -167,12 +185,135 @@ int Compilation::ExecuteCommand(const Command &C,
   return ExecutionFailed ? 1 : Res;
 }
 
+/// Returns the temporary file through which \p Producer passes its output to
+/// \p Consumer, when -pipe asks to connect the two through a pipe instead: a
+/// job writing assembly and the external assembler job that only reads it.
+static const char *getPipedFile(const Compilation &C, const Command &Producer,
+                                const Command &Consumer) {
+#ifdef LLVM_ON_UNIX
+  const Action &Output = Producer.getSource();
+  const Action &Assemble = Consumer.getSource();
+  if (!C.getDriver().UsePipes || Output.getType() != types::TY_PP_Asm ||
+      !isa<AssembleJobAction>(Assemble) || Assemble.getInputs().size() != 1 ||
+      Assemble.getInputs()[0] != &Output ||
+      Consumer.getInputFilenames().size() != 1)
+    return nullptr;
+
+  // Files the user named, as with -save-temps, are kept.
+  const char *File = Consumer.getInputFilenames()[0];
+  if (llvm::none_of(C.getTempFiles(),
+                    [&](const char *Temp) { return StringRef(Temp) == File; }))
+    return nullptr;
+  return File;
+#else
+  return nullptr;
+#endif
+}
+
+int Compilation::ExecutePipedCommands(const Command &Producer,
+                                      const Command &Consumer,
+                                      const char *Pipe,
+                                      const Command *&FailingCommand) const {
+#ifdef LLVM_ON_UNIX
+  // If the pipe cannot be made, run the jobs one after the other through the
+  // temporary file.
+  llvm::sys::fs::remove(Pipe);
+  if (::mkfifo(Pipe, 0600) != 0) {
+    if (int Res = ExecuteCommand(Producer, FailingCommand))
+      return Res;
+    return ExecuteCommand(Consumer, FailingCommand);
+  }
+
+  const Command *Commands[2] = {&Producer, &Consumer};
+  for (const Command *C : Commands) {
+    if (!PrintCommand(*C)) {
+      FailingCommand = C;
+      llvm::sys::fs::remove(Pipe);
+      return 1;
+    }
+  }
+
+  // Start the assembler first, so that the compiler does not wait for a
+  // reader when it opens its output.
+  llvm::sys::ProcessInfo Processes[2];
+  std::string Errors[2];
+  int Results[2] = {0, 0};
+  bool Running[2] = {false, false};
+  for (unsigned I : {1u, 0u}) {
+    bool ExecutionFailed = false;
+    Processes[I] = Commands[I]->Start(&Errors[I], &ExecutionFailed);
+    Running[I] = Processes[I].Pid != 0;
+    if (!Running[I])
+      Results[I] = 1;
+  }
+
+  while (Running[0] || Running[1]) {
+    for (unsigned I = 0; I != 2; ++I) {
+      if (!Running[I])
+        continue;
+      llvm::sys::ProcessInfo Done =
+          llvm::sys::Wait(Processes[I], /*SecondsToWait=*/0,
+                          /*WaitUntilTerminates=*/false, &Errors[I]);
+      if (Done.Pid == 0)
+        continue;
+      Running[I] = false;
+      Results[I] = Done.ReturnCode;
+    }
+    if (!Running[0] && !Running[1])
+      break;
+
+    // A job whose peer is gone could wait forever to open the pipe, or to
+    // read from it. Open and close the other end for it, so that the
+    // assembler sees the end of its input and the compiler fails to write.
+    if (Running[0] != Running[1]) {
+      int FD = ::open(Pipe, (Running[1] ? O_WRONLY : O_RDONLY) | O_NONBLOCK);
+      if (FD >= 0)
+        ::close(FD);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  // The pipe is not a regular file, which the temporary file cleanup skips.
+  llvm::sys::fs::remove(Pipe);
+
+  for (const std::string &Error : Errors)
+    if (!Error.empty())
+      getDriver().Diag(clang::diag::err_drv_command_failure) << Error;
+  for (unsigned I = 0; I != 2; ++I) {
+    if (Results[I]) {
+      FailingCommand = Commands[I];
+      return Results[I];
+    }
+  }
+  return 0;
+#else
+  llvm_unreachable("pipes are only used on Unix hosts");
+#endif
+}
+
 void Compilation::ExecuteJobs(
     const JobList &Jobs,
     SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
-  for (const auto &Job : Jobs) {
+  // Output redirected to generate diagnostics is not captured per job.
+  if (getDriver().NumParallelJobs > 1 && Jobs.size() > 1 && !Redirects)
+    return ExecuteJobsInParallel(Jobs, getDriver().NumParallelJobs,
+                                 FailingCommands);
+
+  const JobList::list_type &List = Jobs.getJobs();
+  for (size_t I = 0, N = List.size(); I != N; ++I) {
     const Command *FailingCommand = nullptr;
-    if (int Res = ExecuteCommand(Job, FailingCommand)) {
+    int Res;
+    // A job writing assembly runs alongside the assembler when piped.
+    const char *Pipe = nullptr;
+    if (I + 1 != N && !Redirects)
+      Pipe = getPipedFile(*this, *List[I], *List[I + 1]);
+    if (Pipe) {
+      Res = ExecutePipedCommands(*List[I], *List[I + 1], Pipe, FailingCommand);
+      ++I;
+    } else {
+      Res = ExecuteCommand(*List[I], FailingCommand);
+    }
+    if (Res) {
       FailingCommands.push_back(std::make_pair(Res, FailingCommand));
       // Bail as soon as one command fails, so we don't output duplicate error
       // messages if we die on e.g. the same file.
@@ -181,6 +322,124 @@ void Compilation::ExecuteJobs(
   }
 }
 
+/// Adds to \p Inputs the actions that \p A takes as input, transitively.
+static void collectInputActions(const Action &A,
+                                llvm::SmallPtrSetImpl<const Action *> &Inputs) {
+  for (const Action *Input : A.inputs())
+    if (Inputs.insert(Input).second)
+      collectInputActions(*Input, Inputs);
+
+  // The host side of a CUDA compile embeds the fatbinary of the device side,
+  // which is not among its inputs.
+  if (const auto *CHA = dyn_cast<CudaHostAction>(&A))
+    for (const Action *DeviceAction : CHA->getDeviceActions())
+      if (Inputs.insert(DeviceAction).second)
+        collectInputActions(*DeviceAction, Inputs);
+}
+
+/// Prints the output captured in the file \p Path to \p OS, and removes it.
+static void printCapturedOutput(StringRef Path, raw_ostream &OS) {
+  if (Path.empty())
+    return;
+  if (auto Buffer = llvm::MemoryBuffer::getFile(Path))
+    OS << (*Buffer)->getBuffer();
+  OS.flush();
+  llvm::sys::fs::remove(Path);
+}
+
+namespace {
+/// The result of a job run by ExecuteJobsInParallel, and the files its output
+/// is captured in.
+struct JobResult {
+  int Res = 0;
+  std::string Error;
+  bool ExecutionFailed = false;
+  SmallString<128> OutputPath;
+  SmallString<128> ErrorPath;
+};
+}
+
+void Compilation::ExecuteJobsInParallel(
+    const JobList &Jobs, unsigned NumThreads,
+    SmallVectorImpl<std::pair<int, const Command *>> &FailingCommands) const {
+  const JobList::list_type &List = Jobs.getJobs();
+  size_t NumJobs = List.size();
+
+  // A job depends on the earlier jobs whose action it takes as input, such as
+  // the link job on the compile jobs.
+  std::vector<SmallVector<size_t, 4>> Deps(NumJobs);
+  for (size_t I = 0; I != NumJobs; ++I) {
+    llvm::SmallPtrSet<const Action *, 16> Inputs;
+    collectInputActions(List[I]->getSource(), Inputs);
+    for (size_t J = 0; J != I; ++J)
+      if (Inputs.count(&List[J]->getSource()))
+        Deps[I].push_back(J);
+  }
+
+  std::vector<bool> Done(NumJobs, false);
+  std::vector<JobResult> Results(NumJobs);
+  llvm::ThreadPool Pool(NumThreads);
+  size_t NumDone = 0;
+  while (NumDone != NumJobs) {
+    // Run all the jobs whose dependencies are done.
+    SmallVector<size_t, 8> Ready;
+    for (size_t I = 0; I != NumJobs; ++I)
+      if (!Done[I] &&
+          llvm::all_of(Deps[I], [&](size_t J) { return Done[J]; }))
+        Ready.push_back(I);
+    assert(!Ready.empty() && "cyclic dependency between jobs");
+
+    for (size_t I : Ready) {
+      if (!PrintCommand(*List[I])) {
+        FailingCommands.push_back(std::make_pair(1, List[I].get()));
+        return;
+      }
+    }
+
+    for (size_t I : Ready) {
+      const Command &C = *List[I];
+
+      // Capture the output of the job, so that it does not interleave with
+      // the output of the jobs running at the same time. If no file can be
+      // created, the job writes to the driver's output directly.
+      JobResult &R = Results[I];
+      if (llvm::sys::fs::createTemporaryFile("job", "out", R.OutputPath))
+        R.OutputPath.clear();
+      if (llvm::sys::fs::createTemporaryFile("job", "err", R.ErrorPath))
+        R.ErrorPath.clear();
+      Pool.async([&C, &R] {
+        StringRef OutputPath = R.OutputPath, ErrorPath = R.ErrorPath;
+        const StringRef *Redirects[] = {
+            nullptr, OutputPath.empty() ? nullptr : &OutputPath,
+            ErrorPath.empty() ? nullptr : &ErrorPath};
+        R.Res = C.Execute(Redirects, &R.Error, &R.ExecutionFailed);
+      });
+    }
+    Pool.wait();
+
+    // Print the output of the jobs in order, as if they had run one by one.
+    for (size_t I : Ready) {
+      JobResult &R = Results[I];
+      printCapturedOutput(R.OutputPath, llvm::outs());
+      printCapturedOutput(R.ErrorPath, llvm::errs());
+      if (!R.Error.empty()) {
+        assert(R.Res && "Error string set with 0 result code!");
+        getDriver().Diag(clang::diag::err_drv_command_failure) << R.Error;
+      }
+      if (R.Res)
+        FailingCommands.push_back(
+            std::make_pair(R.ExecutionFailed ? 1 : R.Res, List[I].get()));
+      Done[I] = true;
+      ++NumDone;
+    }
+
+    // Bail once a job fails, as ExecuteJobs does, so that the jobs depending
+    // on it do not report the same errors again.
+    if (!FailingCommands.empty())
+      return;
+  }
+}
+
 void Compilation::initCompilationForDiagnostics() {
   ForDiagnostics = true;
 
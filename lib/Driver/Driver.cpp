@@ -59,8 +59,10 @@ Driver::Driver(StringRef ClangExecutable, StringRef DefaultTargetTriple,
       DriverTitle("clang LLVM compiler"), CCPrintOptionsFilename(nullptr),
       CCPrintHeadersFilename(nullptr), CCLogDiagnosticsFilename(nullptr),
       CCCPrintBindings(false), CCPrintHeaders(false), CCLogDiagnostics(false),
-      CCGenDiagnostics(false), CCCGenericGCCName(""), CheckInputsExist(true),
-      CCCUsePCH(true), SuppressMissingInputWarning(false) {
+      CCGenDiagnostics(false), NumParallelJobs(1), UsePipes(false),
+      CC1Main(nullptr),
+      CCCGenericGCCName(""), CheckInputsExist(true), CCCUsePCH(true),
+      SuppressMissingInputWarning(false) {
 
   // Provide a sane fallback if no VFS is specified.
   if (!this->VFS)
@@ -481,8 +483,14 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
   // -no-canonical-prefixes is used very early in main.
   Args.ClaimAllArgs(options::OPT_no_canonical_prefixes);
 
-  // Ignore -pipe.
-  Args.ClaimAllArgs(options::OPT_pipe);
+  // -fintegrated-cc1 and -fcompile-server= are used by main once the
+  // compilation is built.
+  Args.ClaimAllArgs(options::OPT_fintegrated_cc1);
+  Args.ClaimAllArgs(options::OPT_fno_integrated_cc1);
+  Args.ClaimAllArgs(options::OPT_fcompile_server_EQ);
+
+  // -pipe only matters when the assembler is a job of its own.
+  UsePipes = Args.hasArg(options::OPT_pipe);
 
   // Extract -ccc args.
   //
@@ -555,6 +563,13 @@ Compilation *Driver::BuildCompilation(ArrayRef<const char *> ArgList) {
     Args.ClaimAllArgs(options::OPT_fembed_bitcode_EQ);
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_parallel_jobs_EQ)) {
+    StringRef Value = A->getValue();
+    if (Value.getAsInteger(10, NumParallelJobs) || NumParallelJobs == 0)
+      Diags.Report(diag::err_drv_invalid_int_value) << A->getAsString(Args)
+                                                    << Value;
+  }
+
   std::unique_ptr<llvm::opt::InputArgList> UArgs =
       llvm::make_unique<InputArgList>(std::move(Args));
 
@@ -18,6 +18,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Program.h"
 #include "llvm/Support/raw_ostream.h"
@@ -228,19 +229,13 @@ void Command::setResponseFile(const char *FileName) {
   ResponseFileFlag += FileName;
 }
 
-int Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
-                     bool *ExecutionFailed) const {
-  SmallVector<const char*, 128> Argv;
-
+bool Command::buildArgv(llvm::SmallVectorImpl<const char *> &Argv,
+                        std::string *ErrMsg, bool *ExecutionFailed) const {
   if (ResponseFile == nullptr) {
     Argv.push_back(Executable);
     Argv.append(Arguments.begin(), Arguments.end());
     Argv.push_back(nullptr);
-
-    return llvm::sys::ExecuteAndWait(Executable, Argv.data(), /*env*/ nullptr,
-                                     Redirects, /*secondsToWait*/ 0,
-                                     /*memoryLimit*/ 0, ErrMsg,
-                                     ExecutionFailed);
+    return true;
   }
 
   // We need to put arguments in a response file (command is too large)
@@ -261,14 +256,33 @@ int Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
       *ErrMsg = EC.message();
     if (ExecutionFailed)
       *ExecutionFailed = true;
-    return -1;
+    return false;
   }
+  return true;
+}
+
+int Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
+                     bool *ExecutionFailed) const {
+  SmallVector<const char*, 128> Argv;
+  if (!buildArgv(Argv, ErrMsg, ExecutionFailed))
+    return -1;
 
   return llvm::sys::ExecuteAndWait(Executable, Argv.data(), /*env*/ nullptr,
                                    Redirects, /*secondsToWait*/ 0,
                                    /*memoryLimit*/ 0, ErrMsg, ExecutionFailed);
 }
 
+llvm::sys::ProcessInfo Command::Start(std::string *ErrMsg,
+                                      bool *ExecutionFailed) const {
+  SmallVector<const char*, 128> Argv;
+  if (!buildArgv(Argv, ErrMsg, ExecutionFailed))
+    return llvm::sys::ProcessInfo();
+
+  return llvm::sys::ExecuteNoWait(Executable, Argv.data(), /*env*/ nullptr,
+                                  /*redirects*/ nullptr, /*memoryLimit*/ 0,
+                                  ErrMsg, ExecutionFailed);
+}
+
 FallbackCommand::FallbackCommand(const Action &Source_, const Tool &Creator_,
                                  const char *Executable_,
                                  const ArgStringList &Arguments_,
@@ -310,6 +324,38 @@ int FallbackCommand::Execute(const StringRef **Redirects, std::string *ErrMsg,
   return SecondaryStatus;
 }
 
+CC1Command::CC1Command(const Action &Source_, const Tool &Creator_,
+                       const char *Executable_,
+                       const ArgStringList &Arguments_,
+                       ArrayRef<InputInfo> Inputs)
+    : Command(Source_, Creator_, Executable_, Arguments_, Inputs) {}
+
+int CC1Command::Execute(const StringRef **Redirects, std::string *ErrMsg,
+                        bool *ExecutionFailed) const {
+  // Redirecting the output, as done to generate crash diagnostics, needs a
+  // process of its own.
+  Driver::CC1ToolFunc CC1Main =
+      getCreator().getToolChain().getDriver().CC1Main;
+  if (!CC1Main || Redirects)
+    return Command::Execute(Redirects, ErrMsg, ExecutionFailed);
+
+  // The arguments need no response file in this process.
+  SmallVector<const char *, 128> Argv;
+  Argv.push_back(getExecutable());
+  Argv.append(getArguments().begin(), getArguments().end());
+
+  if (ExecutionFailed)
+    *ExecutionFailed = false;
+
+  // Report a crash like a crashed process does, so that the driver still
+  // generates the crash reproducer, from a new -cc1 process.
+  int Res = -1;
+  llvm::CrashRecoveryContext CRC;
+  if (!CRC.RunSafely([&]() { Res = CC1Main(Argv); }))
+    return -1;
+  return Res;
+}
+
 ForceSuccessCommand::ForceSuccessCommand(const Action &Source_,
                                          const Tool &Creator_,
                                          const char *Executable_,
@@ -29,6 +29,7 @@
 #include "llvm/ProfileData/InstrProf.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Program.h"
@@ -1370,6 +1371,13 @@ static llvm::StringRef getGCCToolchainDir(const ArgList &Args) {
 void Generic_GCC::GCCInstallationDetector::init(
     const llvm::Triple &TargetTriple, const ArgList &Args,
     ArrayRef<std::string> ExtraTripleAliases) {
+  SmallString<128> CacheFile;
+  bool UseCache =
+      getCacheFile(TargetTriple, Args, ExtraTripleAliases, CacheFile);
+  if (UseCache && loadFromCache(CacheFile, TargetTriple, Args))
+    return;
+  RecordProbes = UseCache;
+
   llvm::Triple BiarchVariantTriple = TargetTriple.isArch32Bit()
                                          ? TargetTriple.get64BitArchVariant()
                                          : TargetTriple.get32BitArchVariant();
@@ -1419,11 +1427,11 @@ void Generic_GCC::GCCInstallationDetector::init(
   // installation available. GCC installs are ranked by version number.
   Version = GCCVersion::Parse("0.0.0");
   for (const std::string &Prefix : Prefixes) {
-    if (!D.getVFS().exists(Prefix))
+    if (!probeDir(Prefix))
       continue;
     for (StringRef Suffix : CandidateLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
-      if (!D.getVFS().exists(LibDir))
+      if (!probeDir(LibDir))
         continue;
       for (StringRef Candidate : ExtraTripleAliases) // Try these first.
         ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, Candidate);
@@ -1432,13 +1440,160 @@ void Generic_GCC::GCCInstallationDetector::init(
     }
     for (StringRef Suffix : CandidateBiarchLibDirs) {
       const std::string LibDir = Prefix + Suffix.str();
-      if (!D.getVFS().exists(LibDir))
+      if (!probeDir(LibDir))
         continue;
       for (StringRef Candidate : CandidateBiarchTripleAliases)
         ScanLibDirForGCCTriple(TargetTriple, Args, LibDir, Candidate,
                                /*NeedsBiarchSuffix=*/ true);
     }
   }
+
+  if (UseCache)
+    saveToCache(CacheFile);
+}
+
+/// Returns the modification time of the directory \p Path, or "-" if it does
+/// not exist.
+static std::string getDirStamp(vfs::FileSystem &VFS, StringRef Path) {
+  llvm::ErrorOr<vfs::Status> Status = VFS.status(Path);
+  if (!Status || !Status->exists())
+    return "-";
+  llvm::sys::TimeValue MTime = Status->getLastModificationTime();
+  return llvm::utostr(MTime.toEpochTime()) + "." +
+         llvm::utostr(MTime.nanoseconds());
+}
+
+bool Generic_GCC::GCCInstallationDetector::probeDir(StringRef Path) {
+  if (!RecordProbes)
+    return D.getVFS().exists(Path);
+  std::string Stamp = getDirStamp(D.getVFS(), Path);
+  ProbedDirs.emplace_back(Path, Stamp);
+  return Stamp != "-";
+}
+
+bool Generic_GCC::GCCInstallationDetector::getCacheFile(
+    const llvm::Triple &TargetTriple, const ArgList &Args,
+    ArrayRef<std::string> ExtraTripleAliases,
+    SmallVectorImpl<char> &Path) const {
+  const Arg *A = Args.getLastArg(options::OPT_toolchain_cache_path_EQ);
+  if (!A)
+    return false;
+
+  llvm::MD5 Hash;
+  auto AddToHash = [&](StringRef Value) {
+    Hash.update(Value);
+    Hash.update(StringRef("", 1));
+  };
+  AddToHash(getClangFullRepositoryVersion());
+  AddToHash(TargetTriple.str());
+  for (const std::string &Alias : ExtraTripleAliases)
+    AddToHash(Alias);
+  AddToHash(D.SysRoot);
+  AddToHash(getGCCToolchainDir(Args));
+  AddToHash(D.InstalledDir);
+  for (const std::string &Dir : D.PrefixDirs)
+    AddToHash(Dir);
+  // The multilibs that an installation must provide depend on the target
+  // flags, such as -m32, -mfloat-abi or -EL.
+  for (const Arg *Flag : Args) {
+    std::string Spelling = Flag->getAsString(Args);
+    if (StringRef(Spelling).startswith("-m") ||
+        StringRef(Spelling).startswith("-E"))
+      AddToHash(Spelling);
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Key;
+  llvm::MD5::stringifyResult(Result, Key);
+  Path.clear();
+  llvm::sys::path::append(Path, A->getValue(), Key);
+  return true;
+}
+
+/// A cache file holds one line per directory looked at ("dir <stamp> <path>"),
+/// one per candidate installation ("candidate <path>"), the detected
+/// installation if any ("gcc <biarch suffix> <triple> <lib dir>"), and "end".
+bool Generic_GCC::GCCInstallationDetector::loadFromCache(
+    StringRef Path, const llvm::Triple &TargetTriple, const ArgList &Args) {
+  auto BufferOrErr = llvm::MemoryBuffer::getFile(Path);
+  if (!BufferOrErr)
+    return false;
+
+  SmallVector<StringRef, 32> Lines;
+  (*BufferOrErr)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                                    /*KeepEmpty=*/false);
+  SmallVector<StringRef, 8> Candidates;
+  StringRef LibDir, CandidateTriple;
+  bool NeedsBiarchSuffix = false, Valid = false, Complete = false;
+  for (StringRef Line : Lines) {
+    std::pair<StringRef, StringRef> Field = Line.split(' ');
+    if (Field.first == "dir") {
+      std::pair<StringRef, StringRef> Dir = Field.second.split(' ');
+      if (getDirStamp(D.getVFS(), Dir.second) != Dir.first)
+        return false;
+    } else if (Field.first == "candidate") {
+      Candidates.push_back(Field.second);
+    } else if (Field.first == "gcc") {
+      std::pair<StringRef, StringRef> Biarch = Field.second.split(' ');
+      std::tie(CandidateTriple, LibDir) = Biarch.second.split(' ');
+      NeedsBiarchSuffix = Biarch.first == "1";
+      Valid = true;
+    } else if (Field.first == "end") {
+      Complete = true;
+    }
+  }
+  if (!Complete)
+    return false;
+
+  // Only the lib directory of the installation is scanned again, to set up
+  // its multilibs.
+  Version = GCCVersion::Parse("0.0.0");
+  if (Valid) {
+    ScanLibDirForGCCTriple(TargetTriple, Args, LibDir.str(), CandidateTriple,
+                           NeedsBiarchSuffix);
+    if (!IsValid) {
+      CandidateGCCInstallPaths.clear();
+      return false;
+    }
+  }
+  for (StringRef Candidate : Candidates)
+    CandidateGCCInstallPaths.insert(Candidate);
+  return true;
+}
+
+void Generic_GCC::GCCInstallationDetector::saveToCache(StringRef Path) const {
+  std::string Contents;
+  llvm::raw_string_ostream OS(Contents);
+  for (const auto &Dir : ProbedDirs)
+    OS << "dir " << Dir.second << ' ' << Dir.first << '\n';
+  for (const std::string &Candidate : CandidateGCCInstallPaths)
+    OS << "candidate " << Candidate << '\n';
+  if (IsValid)
+    OS << "gcc " << (GCCNeedsBiarchSuffix ? 1 : 0) << ' ' << GCCTriple.str()
+       << ' ' << GCCLibDir << '\n';
+  OS << "end\n";
+  OS.flush();
+
+  // Write a temporary file and rename it into place, so that invocations
+  // running at the same time never read a partial entry.
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path)) ||
+      llvm::sys::fs::createUniqueFile(Path + "-%%%%%%", FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream Out(FD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, Path))
+    llvm::sys::fs::remove(TempPath);
 }
 
 void Generic_GCC::GCCInstallationDetector::print(raw_ostream &OS) const {
@@ -2591,6 +2746,8 @@ void Generic_GCC::GCCInstallationDetector::scanLibDirForGCCTripleSolaris(
 
     GCCInstallPath += "/" + Version.Text;
     GCCParentLibPath = GCCInstallPath + "/../../../../";
+    GCCLibDir = LibDir;
+    GCCNeedsBiarchSuffix = NeedsBiarchSuffix;
 
     IsValid = true;
   }
@@ -2636,6 +2793,8 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
                                    (TargetArch != llvm::Triple::x86));
   for (unsigned i = 0; i < NumLibSuffixes; ++i) {
     StringRef LibSuffix = LibAndInstallSuffixes[i][0];
+    if (RecordProbes)
+      probeDir(LibDir + LibSuffix.str());
     std::error_code EC;
     for (vfs::directory_iterator
              LI = D.getVFS().dir_begin(LibDir + LibSuffix, EC),
@@ -2678,6 +2837,8 @@ void Generic_GCC::GCCInstallationDetector::ScanLibDirForGCCTriple(
       GCCInstallPath =
           LibDir + LibAndInstallSuffixes[i][0] + "/" + VersionText.str();
       GCCParentLibPath = GCCInstallPath + LibAndInstallSuffixes[i][1];
+      GCCLibDir = LibDir;
+      GCCNeedsBiarchSuffix = NeedsBiarchSuffix;
       IsValid = true;
     }
   }
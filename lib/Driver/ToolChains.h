@@ -101,8 +101,22 @@ public:
     /// The set of multilibs that the detected installation supports.
     MultilibSet Multilibs;
 
+    /// The lib directory that the detected installation was found in, and
+    /// whether it needed a biarch suffix.
+    std::string GCCLibDir;
+    bool GCCNeedsBiarchSuffix;
+
+    /// Whether to record the directories looked at, for the cache.
+    bool RecordProbes;
+
+    /// The directories looked at, and their modification times. A cached
+    /// result is valid as long as none of them changed.
+    std::vector<std::pair<std::string, std::string>> ProbedDirs;
+
   public:
-    explicit GCCInstallationDetector(const Driver &D) : IsValid(false), D(D) {}
+    explicit GCCInstallationDetector(const Driver &D)
+        : IsValid(false), D(D), GCCNeedsBiarchSuffix(false),
+          RecordProbes(false) {}
     void init(const llvm::Triple &TargetTriple, const llvm::opt::ArgList &Args,
               ArrayRef<std::string> ExtraTripleAliases = None);
 
@@ -154,6 +168,25 @@ public:
                                        const std::string &LibDir,
                                        StringRef CandidateTriple,
                                        bool NeedsBiarchSuffix = false);
+
+    /// Returns whether the directory \p Path exists, recording it for the
+    /// cache.
+    bool probeDir(StringRef Path);
+
+    /// Sets \p Path to the file of the --toolchain-cache-path cache for this
+    /// detection. Returns false if there is no cache.
+    bool getCacheFile(const llvm::Triple &TargetTriple,
+                      const llvm::opt::ArgList &Args,
+                      ArrayRef<std::string> ExtraTripleAliases,
+                      SmallVectorImpl<char> &Path) const;
+
+    /// Detects the installation from the cache file \p Path. Returns false if
+    /// the file has no valid entry.
+    bool loadFromCache(StringRef Path, const llvm::Triple &TargetTriple,
+                       const llvm::opt::ArgList &Args);
+
+    /// Stores the detected installation in the cache file \p Path.
+    void saveToCache(StringRef Path) const;
   };
 
 protected:
@@ -3571,8 +3571,13 @@ static void addPGOAndCoverageFlags(Compilation &C, const Driver &D,
         << "-fprofile-instr-generate";
 
   if (Args.hasFlag(options::OPT_fcoverage_mapping,
-                   options::OPT_fno_coverage_mapping, false))
+                   options::OPT_fno_coverage_mapping, false)) {
     CmdArgs.push_back("-fcoverage-mapping");
+    if (!Args.hasFlag(options::OPT_fcoverage_mapping_header_functions,
+                      options::OPT_fno_coverage_mapping_header_functions,
+                      true))
+      CmdArgs.push_back("-fno-coverage-mapping-header-functions");
+  }
 
   if (C.getArgs().hasArg(options::OPT_c) ||
       C.getArgs().hasArg(options::OPT_S)) {
@@ -3928,6 +3933,14 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     Args.AddLastArg(CmdArgs, options::OPT_fthinlto_index_EQ);
   }
 
+  Args.AddLastArg(CmdArgs, options::OPT_fbackend_cache_path_EQ);
+
+  if (Args.hasArg(options::OPT_fparallel_codegen_EQ)) {
+    Args.AddLastArg(CmdArgs, options::OPT_fparallel_codegen_EQ);
+    CmdArgs.push_back(Args.MakeArgString("-fparallel-codegen-linker=" +
+                                         getToolChain().GetLinkerPath()));
+  }
+
   // Embed-bitcode option.
   if (C.getDriver().embedBitcodeEnabled() &&
       (isa<BackendJobAction>(JA) || isa<AssembleJobAction>(JA))) {
@@ -4142,6 +4155,13 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_strict_vtable_pointers,
                    false))
     CmdArgs.push_back("-fstrict-vtable-pointers");
+  if (Args.hasFlag(options::OPT_fexperimental_relative_cxx_abi_vtables,
+                   options::OPT_fno_experimental_relative_cxx_abi_vtables,
+                   false))
+    CmdArgs.push_back("-fexperimental-relative-c++-abi-vtables");
+  if (Args.hasFlag(options::OPT_fexpanded_static_init,
+                   options::OPT_fno_expanded_static_init, false))
+    CmdArgs.push_back("-fexpanded-static-init");
   if (!Args.hasFlag(options::OPT_foptimize_sibling_calls,
                     options::OPT_fno_optimize_sibling_calls))
     CmdArgs.push_back("-mdisable-tail-calls");
@@ -4473,6 +4493,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
 
   Args.AddAllArgs(CmdArgs, options::OPT_v);
   Args.AddLastArg(CmdArgs, options::OPT_H);
+  Args.AddLastArg(CmdArgs, options::OPT_fheader_cost_report_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_index_store_path);
   if (D.CCPrintHeaders && !D.CCGenDiagnostics) {
     CmdArgs.push_back("-header-include-file");
     CmdArgs.push_back(D.CCPrintHeadersFilename ? D.CCPrintHeadersFilename
@@ -4877,6 +4899,15 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fanalysis_cfg_block_limit_EQ)) {
+    CmdArgs.push_back("-fanalysis-cfg-block-limit");
+    CmdArgs.push_back(A->getValue());
+  }
+
+  if (Args.hasFlag(options::OPT_fconstexpr_memoize_calls,
+                   options::OPT_fno_constexpr_memoize_calls, false))
+    CmdArgs.push_back("-fconstexpr-memoize-calls");
+
   if (Arg *A = Args.getLastArg(options::OPT_fbracket_depth_EQ)) {
     CmdArgs.push_back("-fbracket-depth");
     CmdArgs.push_back(A->getValue());
@@ -4930,6 +4961,11 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     CmdArgs.push_back(A->getValue());
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fspell_checking_budget_EQ)) {
+    CmdArgs.push_back("-fspell-checking-budget");
+    CmdArgs.push_back(A->getValue());
+  }
+
   // Pass -fmessage-length=.
   CmdArgs.push_back("-fmessage-length");
   if (Arg *A = Args.getLastArg(options::OPT_fmessage_length_EQ)) {
@@ -4980,6 +5016,7 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     Args.AddLastArg(CmdArgs, options::OPT_faltivec);
     Args.AddLastArg(CmdArgs, options::OPT_fzvector);
   }
+  Args.AddLastArg(CmdArgs, options::OPT_flazy_neon_intrinsics);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_show_template_tree);
   Args.AddLastArg(CmdArgs, options::OPT_fno_elide_type);
 
@@ -4998,6 +5035,12 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
       if (!Args.hasFlag(options::OPT_fopenmp_use_tls,
                         options::OPT_fnoopenmp_use_tls, /*Default=*/true))
         CmdArgs.push_back("-fnoopenmp-use-tls");
+      if (Args.hasFlag(options::OPT_fopenmp_atomic_reductions,
+                       options::OPT_fno_openmp_atomic_reductions, false))
+        CmdArgs.push_back("-fopenmp-atomic-reductions");
+      if (Args.hasFlag(options::OPT_fopenmp_inline_static_schedule,
+                       options::OPT_fno_openmp_inline_static_schedule, false))
+        CmdArgs.push_back("-fopenmp-inline-static-schedule");
       Args.AddAllArgs(CmdArgs, options::OPT_fopenmp_version_EQ);
       break;
     default:
@@ -5045,6 +5088,10 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_print_source_range_info);
   Args.AddLastArg(CmdArgs, options::OPT_fdiagnostics_parseable_fixits);
   Args.AddLastArg(CmdArgs, options::OPT_ftime_report);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace);
+  Args.AddLastArg(CmdArgs, options::OPT_ftime_trace_granularity_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fmemory_report_EQ);
+  Args.AddLastArg(CmdArgs, options::OPT_fprefetch_deps_EQ);
   Args.AddLastArg(CmdArgs, options::OPT_ftrapv);
 
   if (Arg *A = Args.getLastArg(options::OPT_ftrapv_handler_EQ)) {
@@ -5374,7 +5421,16 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                     options::OPT_fmodules_validate_once_per_build_session);
   }
 
+  if (Arg *A = Args.getLastArg(options::OPT_fpch_validation_cache_EQ)) {
+    if (!Args.getLastArg(options::OPT_fbuild_session_timestamp,
+                         options::OPT_fbuild_session_file))
+      D.Diag(diag::err_drv_pch_validation_cache_requires_timestamp);
+
+    A->render(Args, CmdArgs);
+  }
+
   Args.AddLastArg(CmdArgs, options::OPT_fmodules_validate_system_headers);
+  Args.AddLastArg(CmdArgs, options::OPT_fassume_stable_header_search_dirs);
 
   // -faccess-control is default.
   if (Args.hasFlag(options::OPT_fno_access_control,
@@ -5496,6 +5552,21 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_delayed_template_parsing, IsWindowsMSVC))
     CmdArgs.push_back("-fdelayed-template-parsing");
 
+  if (Args.hasFlag(options::OPT_fpch_instantiate_templates,
+                   options::OPT_fno_pch_instantiate_templates, false))
+    CmdArgs.push_back("-fpch-instantiate-templates");
+
+  // Skipping bodies drops inline and template definitions from headers, so
+  // it is only safe when no code is generated.
+  if (Args.hasFlag(options::OPT_fskip_function_bodies_in_headers,
+                   options::OPT_fno_skip_function_bodies_in_headers, false)) {
+    if (JA.getType() == types::TY_Nothing)
+      CmdArgs.push_back("-fskip-function-bodies-in-headers");
+    else
+      D.Diag(diag::err_drv_argument_only_allowed_with)
+          << "-fskip-function-bodies-in-headers" << "-fsyntax-only";
+  }
+
   // -fgnu-keywords default varies depending on language; only pass if
   // specified.
   if (Arg *A = Args.getLastArg(options::OPT_fgnu_keywords,
@@ -5881,6 +5952,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
                    options::OPT_fno_rewrite_includes, false) ||
       (C.isForDiagnostics() && !HaveModules))
     CmdArgs.push_back("-frewrite-includes");
+  if (!C.isForDiagnostics())
+    Args.AddLastArg(CmdArgs, options::OPT_fcompress_preprocessed_output);
 
   // Only allow -traditional or -traditional-cpp outside in preprocessing modes.
   if (Arg *A = Args.getLastArg(options::OPT_traditional,
@@ -6026,7 +6099,8 @@ void Clang::ConstructJob(Compilation &C, const JobAction &JA,
     C.addCommand(llvm::make_unique<ForceSuccessCommand>(JA, *this, Exec,
                                                         CmdArgs, Inputs));
   } else {
-    C.addCommand(llvm::make_unique<Command>(JA, *this, Exec, CmdArgs, Inputs));
+    C.addCommand(
+        llvm::make_unique<CC1Command>(JA, *this, Exec, CmdArgs, Inputs));
   }
 
   // Handle the debug info splitting at object creation time if we're
@@ -321,6 +321,7 @@ template <> struct MappingTraits<FormatStyle> {
     IO.mapOptional("MacroBlockBegin", Style.MacroBlockBegin);
     IO.mapOptional("MacroBlockEnd", Style.MacroBlockEnd);
     IO.mapOptional("MaxEmptyLinesToKeep", Style.MaxEmptyLinesToKeep);
+    IO.mapOptional("MaxLineFormattingStates", Style.MaxLineFormattingStates);
     IO.mapOptional("NamespaceIndentation", Style.NamespaceIndentation);
     IO.mapOptional("ObjCBlockIndentWidth", Style.ObjCBlockIndentWidth);
     IO.mapOptional("ObjCSpaceAfterProperty", Style.ObjCSpaceAfterProperty);
@@ -536,6 +537,7 @@ FormatStyle getLLVMStyle() {
   LLVMStyle.JavaScriptWrapImports = true;
   LLVMStyle.TabWidth = 8;
   LLVMStyle.MaxEmptyLinesToKeep = 1;
+  LLVMStyle.MaxLineFormattingStates = 200000;
   LLVMStyle.KeepEmptyLinesAtTheStartOfBlocks = true;
   LLVMStyle.NamespaceIndentation = FormatStyle::NI_None;
   LLVMStyle.ObjCBlockIndentWidth = 2;
@@ -791,17 +793,146 @@ std::string configurationAsText(const FormatStyle &Style) {
 
 namespace {
 
+// Finds the points of an incremental formatting window (or file) that
+// formatting can start or stop at later: declarations that follow an empty
+// line and a ';' or '}', outside of preprocessor conditionals and clang-format
+// off regions. They are at the top level of the window, or, if
+// \p InNamespaces, nested only in namespaces. \p Scope is the scope of the
+// top level of the window; see IncrementalFormatState::SyncPoint.
+//
+// Returns false, and stops looking, where the tokens leave the top level of
+// the window, and if they do not end there. Stops at Objective-C code too,
+// whose @interface ... @end blocks have no braces.
+bool collectSyncPoints(const SourceManager &SM, ArrayRef<FormatToken *> Tokens,
+                       unsigned Scope, bool InNamespaces,
+                       std::vector<IncrementalFormatState::SyncPoint> &Points) {
+  // The offsets of the open namespace '{'s, and 0 for other open braces.
+  SmallVector<unsigned, 8> Braces;
+  unsigned NonNamespaceBraces = 0;
+  bool InNamespaceHeader = false;
+  int PPDepth = 0;
+  const FormatToken *Previous = nullptr;
+  for (unsigned I = 0, E = Tokens.size(); I != E; ++I) {
+    const FormatToken *Tok = Tokens[I];
+    if (Tok->is(tok::eof))
+      break;
+    if (Tok->is(tok::at))
+      return false;
+
+    if (Tok->is(tok::hash) && (I == 0 || Tok->HasUnescapedNewline)) {
+      if (I + 1 != E && Tokens[I + 1]->Tok.getIdentifierInfo()) {
+        switch (Tokens[I + 1]->Tok.getIdentifierInfo()->getPPKeywordID()) {
+        case tok::pp_if:
+        case tok::pp_ifdef:
+        case tok::pp_ifndef:
+          ++PPDepth;
+          break;
+        case tok::pp_endif:
+          if (--PPDepth < 0)
+            return false;
+          break;
+        default:
+          break;
+        }
+      }
+      // Skip the directive.
+      while (I + 1 != E && !Tokens[I + 1]->HasUnescapedNewline &&
+             Tokens[I + 1]->isNot(tok::eof))
+        ++I;
+      Previous = nullptr;
+      continue;
+    }
+
+    if (NonNamespaceBraces == 0 && (Braces.empty() || InNamespaces) &&
+        PPDepth == 0 && Tok->NewlinesBefore >= 2 && !Tok->Finalized &&
+        !Tok->isOneOf(tok::r_brace, TT_MacroBlockEnd) && Previous &&
+        !Previous->Finalized && Previous->isOneOf(tok::semi, tok::r_brace)) {
+      IncrementalFormatState::SyncPoint Point;
+      Point.WhitespaceOffset =
+          SM.getFileOffset(Tok->WhitespaceRange.getBegin());
+      Point.TokenOffset = SM.getFileOffset(Tok->Tok.getLocation());
+      Point.Scope = Braces.empty() ? Scope : Braces.back();
+      Points.push_back(Point);
+    }
+
+    if (Tok->is(tok::kw_namespace)) {
+      InNamespaceHeader = true;
+    } else if (Tok->isOneOf(tok::l_brace, TT_MacroBlockBegin)) {
+      if (InNamespaceHeader && Tok->is(tok::l_brace)) {
+        Braces.push_back(SM.getFileOffset(Tok->Tok.getLocation()));
+      } else {
+        Braces.push_back(0);
+        ++NonNamespaceBraces;
+      }
+      InNamespaceHeader = false;
+    } else if (Tok->isOneOf(tok::r_brace, TT_MacroBlockEnd)) {
+      if (Braces.empty())
+        return false;
+      if (Braces.pop_back_val() == 0)
+        --NonNamespaceBraces;
+    } else if (Tok->is(tok::semi)) {
+      InNamespaceHeader = false;
+    }
+    Previous = Tok;
+  }
+  return Braces.empty() && PPDepth == 0;
+}
+
 class Formatter : public TokenAnalyzer {
 public:
   Formatter(const Environment &Env, const FormatStyle &Style,
-            bool *IncompleteFormat)
-      : TokenAnalyzer(Env, Style), IncompleteFormat(IncompleteFormat) {}
+            bool *IncompleteFormat,
+            IncrementalFormatState *State = nullptr)
+      : TokenAnalyzer(Env, Style), IncompleteFormat(IncompleteFormat),
+        State(State), CheckedTokens(false), ValidWindow(true) {}
+
+  /// \brief Only lexes, parses and formats the code from \p Begin to \p End,
+  /// which must be sync points (or the start and end of the file) in
+  /// \p Scope.
+  void setWindow(unsigned Begin, unsigned End, unsigned Scope) {
+    BeginOffset = Begin;
+    EndOffset = End;
+    WindowScope = Scope;
+  }
+
+  /// \brief Whether the window could be formatted on its own. If not, no
+  /// replacements were generated.
+  bool isValidWindow() const { return ValidWindow; }
+
+  /// \brief The sync points found in the window or file.
+  const std::vector<IncrementalFormatState::SyncPoint> &
+  getSyncPoints() const {
+    return SyncPoints;
+  }
 
   tooling::Replacements
   analyze(TokenAnnotator &Annotator,
           SmallVectorImpl<AnnotatedLine *> &AnnotatedLines,
           FormatTokenLexer &Tokens, tooling::Replacements &Result) override {
-    deriveLocalStyle(AnnotatedLines);
+    bool IsWindow = BeginOffset != 0 || EndOffset != UINT_MAX;
+    if (State && !CheckedTokens) {
+      CheckedTokens = true;
+      bool AtTopLevel = collectSyncPoints(
+          Env.getSourceManager(), Tokens.getTokens(), WindowScope,
+          Style.NamespaceIndentation == FormatStyle::NI_None, SyncPoints);
+      if (IsWindow)
+        ValidWindow = AtTopLevel && Tokens.stoppedAtEndOffset();
+    }
+    if (!ValidWindow)
+      return tooling::Replacements();
+
+    if (State && IsWindow) {
+      Style.PointerAlignment = State->DerivedPointerAlignment;
+      Style.Standard = State->DerivedStandard;
+      BinPackInconclusiveFunctions = State->BinPackInconclusiveFunctions;
+    } else {
+      deriveLocalStyle(AnnotatedLines);
+      if (State) {
+        State->DerivedPointerAlignment = Style.PointerAlignment;
+        State->DerivedStandard = Style.Standard;
+        State->BinPackInconclusiveFunctions = BinPackInconclusiveFunctions;
+      }
+    }
     AffectedRangeMgr.computeAffectedLines(AnnotatedLines.begin(),
                                           AnnotatedLines.end());
 
@@ -977,6 +1108,11 @@ private:
 
   bool BinPackInconclusiveFunctions;
   bool *IncompleteFormat;
+  IncrementalFormatState *State;
+  bool CheckedTokens;
+  bool ValidWindow;
+  unsigned WindowScope = UINT_MAX;
+  std::vector<IncrementalFormatState::SyncPoint> SyncPoints;
 };
 
 // This class clean up the erroneous/redundant code around the given ranges in
@@ -1636,6 +1772,136 @@ tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
   return Format.process();
 }
 
+// Finds the part of \p Code that needs to be lexed and parsed to format
+// \p Ranges, given the previous code and sync points in \p State, and the
+// scope it is in. Returns false if that is the whole file.
+static bool findFormattingWindow(const IncrementalFormatState &State,
+                                 StringRef Code,
+                                 ArrayRef<tooling::Range> Ranges,
+                                 unsigned &Begin, unsigned &End,
+                                 unsigned &Scope) {
+  StringRef OldCode = State.Code;
+  if (OldCode.empty() || Ranges.empty())
+    return false;
+
+  // The changed part of the code is [Prefix, Code.size() - Suffix).
+  size_t MaxCommon = std::min(OldCode.size(), Code.size());
+  size_t Prefix = 0;
+  while (Prefix != MaxCommon && OldCode[Prefix] == Code[Prefix])
+    ++Prefix;
+  size_t Suffix = 0;
+  while (Suffix != MaxCommon - Prefix &&
+         OldCode[OldCode.size() - Suffix - 1] == Code[Code.size() - Suffix - 1])
+    ++Suffix;
+
+  size_t Lo = Prefix, Hi = Code.size() - Suffix;
+  for (const tooling::Range &R : Ranges) {
+    Lo = std::min<size_t>(Lo, R.getOffset());
+    Hi = std::max<size_t>(Hi, R.getOffset() + R.getLength());
+  }
+
+  // Start at a sync point whose line is unchanged and before the ranges, and
+  // stop at the first one in the same scope after them whose line is
+  // unchanged; two points in the same namespace have only whole declarations
+  // between them. Ranges touching the whitespace before a sync point affect
+  // the line before it, so they must be strictly inside the window. Prefer
+  // the innermost window: the start closest to the changes that has an end.
+  auto FirstAfter = State.SyncPoints.end();
+  for (auto I = State.SyncPoints.begin(), E = State.SyncPoints.end(); I != E;
+       ++I) {
+    if (I->WhitespaceOffset >= OldCode.size() - Suffix &&
+        I->WhitespaceOffset + Code.size() - OldCode.size() > Hi) {
+      FirstAfter = I;
+      break;
+    }
+  }
+  auto findEnd = [&](unsigned InScope, unsigned &End) {
+    for (auto I = FirstAfter, E = State.SyncPoints.end(); I != E; ++I)
+      if (I->Scope == InScope) {
+        End = I->WhitespaceOffset + Code.size() - OldCode.size();
+        return true;
+      }
+    // The end of the file is at the top level.
+    End = UINT_MAX;
+    return InScope == UINT_MAX;
+  };
+  for (auto I = State.SyncPoints.rbegin(), E = State.SyncPoints.rend(); I != E;
+       ++I) {
+    if (I->WhitespaceOffset >= Lo || I->TokenOffset > Prefix)
+      continue;
+    if (findEnd(I->Scope, End)) {
+      Begin = I->WhitespaceOffset;
+      Scope = I->Scope;
+      return true;
+    }
+  }
+  Begin = 0;
+  Scope = UINT_MAX;
+  findEnd(UINT_MAX, End);
+  return End != UINT_MAX;
+}
+
+tooling::Replacements reformat(const FormatStyle &Style, StringRef Code,
+                               ArrayRef<tooling::Range> Ranges,
+                               IncrementalFormatState &State,
+                               StringRef FileName, bool *IncompleteFormat) {
+  FormatStyle Expanded = expandPresets(Style);
+  if (Expanded.DisableFormat || Expanded.Language != FormatStyle::LK_Cpp) {
+    State = IncrementalFormatState();
+    return reformat(Style, Code, Ranges, FileName, IncompleteFormat);
+  }
+
+  std::unique_ptr<Environment> Env =
+      Environment::CreateVirtualEnvironment(Code, FileName, Ranges);
+  unsigned Begin, End, Scope;
+  if (State.Style == Expanded &&
+      findFormattingWindow(State, Code, Ranges, Begin, End, Scope)) {
+    bool WindowIncomplete = false;
+    Formatter Format(*Env, Expanded, &WindowIncomplete, &State);
+    Format.setWindow(Begin, End, Scope);
+    tooling::Replacements Result = Format.process();
+    if (Format.isValidWindow()) {
+      if (IncompleteFormat)
+        *IncompleteFormat = WindowIncomplete;
+      // Keep the sync points outside of the window, shifting the ones after
+      // it by the size of the change. The namespaces they are in start
+      // outside of the window too.
+      unsigned Delta = Code.size() - State.Code.size();
+      unsigned OldEnd = End == UINT_MAX ? UINT_MAX : End - Delta;
+      std::vector<IncrementalFormatState::SyncPoint> SyncPoints;
+      for (const auto &Point : State.SyncPoints)
+        if (Point.WhitespaceOffset <= Begin)
+          SyncPoints.push_back(Point);
+      for (const auto &Point : Format.getSyncPoints())
+        if (Point.WhitespaceOffset > Begin)
+          SyncPoints.push_back(Point);
+      for (auto Point : State.SyncPoints) {
+        if (Point.WhitespaceOffset < OldEnd)
+          continue;
+        Point.WhitespaceOffset += Delta;
+        Point.TokenOffset += Delta;
+        if (Point.Scope != UINT_MAX && Point.Scope >= OldEnd)
+          Point.Scope += Delta;
+        SyncPoints.push_back(Point);
+      }
+      State.SyncPoints = std::move(SyncPoints);
+      State.Code = Code;
+      State.WindowBegin = Begin;
+      State.WindowEnd = End == UINT_MAX ? Code.size() : End;
+      return Result;
+    }
+  }
+
+  Formatter Format(*Env, Expanded, IncompleteFormat, &State);
+  tooling::Replacements Result = Format.process();
+  State.Code = Code;
+  State.Style = Expanded;
+  State.SyncPoints = Format.getSyncPoints();
+  State.WindowBegin = 0;
+  State.WindowEnd = Code.size();
+  return Result;
+}
+
 tooling::Replacements cleanup(const FormatStyle &Style, SourceManager &SM,
                               FileID ID, ArrayRef<CharSourceRange> Ranges) {
   Environment Env(SM, ID, Ranges);
@@ -25,17 +25,24 @@ namespace format {
 
 FormatTokenLexer::FormatTokenLexer(const SourceManager &SourceMgr, FileID ID,
                                    const FormatStyle &Style,
-                                   encoding::Encoding Encoding)
+                                   encoding::Encoding Encoding,
+                                   unsigned BeginOffset, unsigned EndOffset)
     : FormatTok(nullptr), IsFirstToken(true), GreaterStashed(false),
       LessStashed(false), Column(0), TrailingWhitespace(0),
       SourceMgr(SourceMgr), ID(ID), Style(Style),
       IdentTable(getFormattingLangOpts(Style)), Keywords(IdentTable),
       Encoding(Encoding), FirstInLineIndex(0), FormattingDisabled(false),
+      EndOffset(EndOffset), StoppedAtEndOffset(true),
       MacroBlockBeginRegex(Style.MacroBlockBegin),
       MacroBlockEndRegex(Style.MacroBlockEnd) {
-  Lex.reset(new Lexer(ID, SourceMgr.getBuffer(ID), SourceMgr,
-                      getFormattingLangOpts(Style)));
-  Lex->SetKeepWhitespaceMode(true);
+  if (BeginOffset == 0) {
+    Lex.reset(new Lexer(ID, SourceMgr.getBuffer(ID), SourceMgr,
+                        getFormattingLangOpts(Style)));
+    Lex->SetKeepWhitespaceMode(true);
+  } else {
+    resetLexer(BeginOffset);
+    IsFirstToken = false;
+  }
 
   for (const std::string &ForEachMacro : Style.ForEachMacros)
     ForEachMacros.push_back(&IdentTable.get(ForEachMacro));
@@ -47,6 +54,8 @@ ArrayRef<FormatToken *> FormatTokenLexer::lex() {
   assert(FirstInLineIndex == 0);
   do {
     Tokens.push_back(getNextToken());
+    if (EndOffset != UINT_MAX && Tokens.back()->isNot(tok::eof))
+      stopAtEndOffset(*Tokens.back());
     if (Style.Language == FormatStyle::LK_JavaScript) {
       tryParseJSRegexLiteral();
       tryParseTemplateString();
@@ -584,6 +593,28 @@ void FormatTokenLexer::readRawToken(FormatToken &Tok) {
   }
 }
 
+void FormatTokenLexer::stopAtEndOffset(FormatToken &Tok) {
+  SourceLocation WhitespaceStart = Tok.WhitespaceRange.getBegin();
+  unsigned Offset = SourceMgr.getFileOffset(WhitespaceStart);
+  if (Offset < EndOffset)
+    return;
+  StoppedAtEndOffset = Offset == EndOffset;
+
+  // Turn the token into an eof token without leading whitespace, so that
+  // nothing from EndOffset on is formatted.
+  Tok.Tok.startToken();
+  Tok.Tok.setKind(tok::eof);
+  Tok.Tok.setLocation(WhitespaceStart);
+  Tok.TokenText = StringRef();
+  Tok.WhitespaceRange = SourceRange(WhitespaceStart, WhitespaceStart);
+  Tok.NewlinesBefore = 0;
+  Tok.HasUnescapedNewline = false;
+  Tok.LastNewlineOffset = 0;
+  Tok.IsMultiline = false;
+  Tok.ColumnWidth = 0;
+  Tok.Type = TT_Unknown;
+}
+
 void FormatTokenLexer::resetLexer(unsigned Offset) {
   StringRef Buffer = SourceMgr.getBufferData(ID);
   Lex.reset(new Lexer(SourceMgr.getLocForStartOfFile(ID),
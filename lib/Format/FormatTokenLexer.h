@@ -22,19 +22,30 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Format/Format.h"
 #include "llvm/Support/Regex.h"
+#include <climits>
 
 namespace clang {
 namespace format {
 
 class FormatTokenLexer {
 public:
+  /// \brief Lexes the file \p ID, or only the part of it from \p BeginOffset
+  /// up to the first token whose preceding whitespace starts at or after
+  /// \p EndOffset, which is replaced by the \c eof token.
   FormatTokenLexer(const SourceManager &SourceMgr, FileID ID,
-                   const FormatStyle &Style, encoding::Encoding Encoding);
+                   const FormatStyle &Style, encoding::Encoding Encoding,
+                   unsigned BeginOffset = 0, unsigned EndOffset = UINT_MAX);
 
   ArrayRef<FormatToken *> lex();
 
   const AdditionalKeywords &getKeywords() { return Keywords; }
 
+  ArrayRef<FormatToken *> getTokens() const { return Tokens; }
+
+  /// \brief Whether lexing stopped exactly at \c EndOffset, rather than in
+  /// the middle of a token that spans it.
+  bool stoppedAtEndOffset() const { return StoppedAtEndOffset; }
+
 private:
   void tryMergePreviousTokens();
 
@@ -83,12 +94,17 @@ private:
 
   bool FormattingDisabled;
 
+  unsigned EndOffset;
+  bool StoppedAtEndOffset;
+
   llvm::Regex MacroBlockBeginRegex;
   llvm::Regex MacroBlockEndRegex;
 
   void readRawToken(FormatToken &Tok);
 
   void resetLexer(unsigned Offset);
+
+  void stopAtEndOffset(FormatToken &Tok);
 };
 
 } // namespace format
@@ -79,7 +79,8 @@ TokenAnalyzer::TokenAnalyzer(const Environment &Env, const FormatStyle &Style)
       AffectedRangeMgr(Env.getSourceManager(), Env.getCharRanges()),
       UnwrappedLines(1),
       Encoding(encoding::detectEncoding(
-          Env.getSourceManager().getBufferData(Env.getFileID()))) {
+          Env.getSourceManager().getBufferData(Env.getFileID()))),
+      BeginOffset(0), EndOffset(UINT_MAX) {
   DEBUG(
       llvm::dbgs() << "File encoding: "
                    << (Encoding == encoding::Encoding_UTF8 ? "UTF8" : "unknown")
@@ -91,7 +92,7 @@ TokenAnalyzer::TokenAnalyzer(const Environment &Env, const FormatStyle &Style)
 tooling::Replacements TokenAnalyzer::process() {
   tooling::Replacements Result;
   FormatTokenLexer Tokens(Env.getSourceManager(), Env.getFileID(), Style,
-                          Encoding);
+                          Encoding, BeginOffset, EndOffset);
 
   UnwrappedLineParser Parser(Style, Tokens.getKeywords(), Tokens.lex(), *this);
   Parser.parse();
@@ -100,6 +100,9 @@ protected:
   AffectedRangeManager AffectedRangeMgr;
   SmallVector<SmallVector<UnwrappedLine, 16>, 2> UnwrappedLines;
   encoding::Encoding Encoding;
+  // The part of the file to process; see the FormatTokenLexer constructor.
+  unsigned BeginOffset;
+  unsigned EndOffset;
 };
 
 } // end namespace format
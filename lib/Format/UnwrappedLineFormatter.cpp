@@ -712,6 +712,14 @@ private:
       if (Count > 50000)
         Node->State.IgnoreStackForComparison = true;
 
+      // Give up on finding the best solution if it still takes too long.
+      if (Style.MaxLineFormattingStates &&
+          Count > Style.MaxLineFormattingStates) {
+        DEBUG(llvm::dbgs() << "Analyzed " << Count
+                           << " states, finishing the line greedily.\n");
+        return finishGreedily(InitialState, Node, Penalty, DryRun);
+      }
+
       if (!Seen.insert(&Node->State).second)
         // State already examined with lower penalty.
         continue;
@@ -740,6 +748,43 @@ private:
     return Penalty;
   }
 
+  /// \brief Places the remaining tokens after \p Node, reached with
+  /// \p Penalty, breaking only before tokens that would not fit otherwise.
+  /// Returns the penalty of the line.
+  ///
+  /// If \p DryRun is \c false, directly applies the changes.
+  unsigned finishGreedily(LineState &InitialState, StateNode *Node,
+                          unsigned Penalty, bool DryRun) {
+    LineState DryRunState = Node->State;
+    LineState &State = DryRun ? DryRunState : InitialState;
+    if (!DryRun)
+      reconstructPath(InitialState, Node);
+
+    while (State.NextToken) {
+      bool NewLine;
+      FormatDecision Decision = State.NextToken->Decision;
+      if (Decision == FD_Break || Indenter->mustBreak(State)) {
+        NewLine = true;
+      } else if (Decision == FD_Continue || !Indenter->canBreak(State)) {
+        NewLine = false;
+      } else {
+        // Break if the tokens up to the next possible break do not fit.
+        LineState Next = State;
+        do {
+          Indenter->addTokenToState(Next, /*Newline=*/false, /*DryRun=*/true);
+        } while (Next.NextToken && !Indenter->canBreak(Next) &&
+                 !Indenter->mustBreak(Next));
+        NewLine = Style.ColumnLimit > 0 && Next.Column > Style.ColumnLimit;
+      }
+      if (!formatChildren(State, NewLine, DryRun, Penalty)) {
+        NewLine = true;
+        formatChildren(State, NewLine, DryRun, Penalty);
+      }
+      Penalty += Indenter->addTokenToState(State, NewLine, DryRun);
+    }
+    return Penalty;
+  }
+
   /// \brief Add the following state to the analysis queue \c Queue.
   ///
   /// Assume the current state is \p PreviousNode and has been reached with a
@@ -18,6 +18,7 @@
 #include "clang/AST/StmtVisitor.h"
 #include "clang/AST/TypeOrdering.h"
 #include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/TargetOptions.h"
 #include "clang/Basic/VirtualFileSystem.h"
@@ -34,6 +35,7 @@
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/ASTWriter.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/CrashRecoveryContext.h"
@@ -80,9 +82,39 @@ namespace {
     }
   };
   
-  struct OnDiskData {
+  /// \brief A precompiled preamble, along with what an ASTUnit needs to
+  /// know about it to use it.
+  ///
+  /// It is shared by all of the ASTUnits of the same main file whose
+  /// preambles and compiler options are identical, and its file is removed
+  /// when the last of them lets go of it.
+  struct SharedPreamble {
     /// \brief The file in which the precompiled preamble is stored.
-    std::string PreambleFile;
+    std::string PCHFile;
+
+    /// \brief The number of bytes of the main file it covers.
+    unsigned Size;
+
+    /// \brief The precompiled preamble of the beginning of this one that it
+    /// is chained to, if any.
+    std::shared_ptr<SharedPreamble> Base;
+
+    /// \brief The number of precompiled headers in the chain ending with
+    /// this one.
+    unsigned ChainLength;
+
+    llvm::StringMap<ASTUnit::PreambleFileHash> FilesInPreamble;
+    SmallVector<ASTUnit::StandaloneDiagnostic, 4> Diagnostics;
+    unsigned NumWarnings;
+    std::vector<serialization::DeclID> TopLevelDecls;
+    unsigned TopLevelHashValue;
+
+    ~SharedPreamble() { llvm::sys::fs::remove(PCHFile); }
+  };
+
+  struct OnDiskData {
+    /// \brief The precompiled preamble in use, if any.
+    std::shared_ptr<SharedPreamble> Preamble;
 
     /// \brief Temporary files that should be removed when the ASTUnit is
     /// destroyed.
@@ -91,7 +123,8 @@ namespace {
     /// \brief Erase temporary files.
     void CleanTemporaryFiles();
 
-    /// \brief Erase the preamble file.
+    /// \brief Let go of the preamble, erasing its file unless another
+    /// ASTUnit still uses it.
     void CleanPreambleFile();
 
     /// \brief Erase temporary files and the preamble file.
@@ -155,12 +188,105 @@ static void removeOnDiskEntry(const ASTUnit *AU) {
   }
 }
 
-static void setPreambleFile(const ASTUnit *AU, StringRef preambleFile) {
-  getOnDiskData(AU).PreambleFile = preambleFile;
+static void setPreamble(const ASTUnit *AU,
+                        std::shared_ptr<SharedPreamble> Preamble) {
+  getOnDiskData(AU).Preamble = std::move(Preamble);
 }
 
 static const std::string &getPreambleFile(const ASTUnit *AU) {
-  return getOnDiskData(AU).PreambleFile;  
+  static const std::string NoPreambleFile;
+  const std::shared_ptr<SharedPreamble> &Preamble = getOnDiskData(AU).Preamble;
+  return Preamble ? Preamble->PCHFile : NoPreambleFile;
+}
+
+/// \brief The precompiled preambles in use by any ASTUnit, by the key
+/// computed by \c getSharedPreambleKey().
+typedef llvm::StringMap<std::weak_ptr<SharedPreamble>> SharedPreambleMap;
+static SharedPreambleMap &getSharedPreambleMap() {
+  static SharedPreambleMap M;
+  return M;
+}
+
+static std::shared_ptr<SharedPreamble> findSharedPreamble(StringRef Key) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  SharedPreambleMap &M = getSharedPreambleMap();
+  SharedPreambleMap::iterator I = M.find(Key);
+  if (I == M.end())
+    return nullptr;
+  std::shared_ptr<SharedPreamble> Preamble = I->second.lock();
+  if (!Preamble)
+    M.erase(I);
+  return Preamble;
+}
+
+static void addSharedPreamble(StringRef Key,
+                              const std::shared_ptr<SharedPreamble> &Preamble) {
+  llvm::MutexGuard Guard(getOnDiskMutex());
+  SharedPreambleMap &M = getSharedPreambleMap();
+  // Forget the preambles that nobody uses any more.
+  for (SharedPreambleMap::iterator I = M.begin(), E = M.end(); I != E;) {
+    SharedPreambleMap::iterator Cur = I++;
+    if (Cur->second.expired())
+      M.erase(Cur);
+  }
+  M[Key] = Preamble;
+}
+
+/// \brief Compute the key under which ASTUnits share the precompiled
+/// preamble \p Preamble of the main file of \p Invocation.
+///
+/// The precompiled preamble refers to the main file, so only ASTUnits of the
+/// same main file can share it.  Besides the text of the preamble, the key
+/// covers the options that change what the preamble means, and whether it is
+/// a chain, whose main file declarations are in different FileIDs.  Whether
+/// the files it includes have changed is checked separately.
+static std::string getSharedPreambleKey(const CompilerInvocation &Invocation,
+                                        StringRef Preamble,
+                                        bool PreambleEndsAtStartOfLine,
+                                        bool Chained) {
+  using llvm::hash_combine;
+
+  llvm::hash_code Code = llvm::hash_value(Invocation.getModuleHash());
+  const PreprocessorOptions &PPOpts = Invocation.getPreprocessorOpts();
+  for (const auto &Macro : PPOpts.Macros)
+    Code = hash_combine(Code, Macro.first, Macro.second);
+  for (const std::string &Include : PPOpts.Includes)
+    Code = hash_combine(Code, Include);
+  for (const std::string &Include : PPOpts.MacroIncludes)
+    Code = hash_combine(Code, Include);
+  Code = hash_combine(Code, PPOpts.ImplicitPCHInclude,
+                      PPOpts.ImplicitPTHInclude);
+
+  const HeaderSearchOptions &HSOpts = Invocation.getHeaderSearchOpts();
+  for (const HeaderSearchOptions::Entry &Entry : HSOpts.UserEntries)
+    Code = hash_combine(Code, Entry.Path, unsigned(Entry.Group),
+                        bool(Entry.IsFramework), bool(Entry.IgnoreSysRoot));
+  for (const HeaderSearchOptions::SystemHeaderPrefix &Prefix :
+       HSOpts.SystemHeaderPrefixes)
+    Code = hash_combine(Code, Prefix.Prefix, Prefix.IsSystemHeader);
+
+  // The diagnostics of the preamble are kept along with it.
+  const DiagnosticOptions &DiagOpts = Invocation.getDiagnosticOpts();
+  for (const std::string &Warning : DiagOpts.Warnings)
+    Code = hash_combine(Code, Warning);
+  for (const std::string &Remark : DiagOpts.Remarks)
+    Code = hash_combine(Code, Remark);
+  Code = hash_combine(Code, bool(DiagOpts.IgnoreWarnings),
+                      bool(DiagOpts.Pedantic), bool(DiagOpts.PedanticErrors));
+
+  const FrontendOptions &FrontendOpts = Invocation.getFrontendOpts();
+  Code = hash_combine(Code, Invocation.getFileSystemOpts().WorkingDir,
+                      bool(FrontendOpts.SkipFunctionBodies),
+                      bool(FrontendOpts.RelocatablePCH),
+                      Invocation.getLangOpts()->CommentOpts.ParseAllComments);
+
+  std::string Key = FrontendOpts.Inputs[0].getFile();
+  Key += '\0';
+  Key += llvm::utohexstr(size_t(Code));
+  Key += PreambleEndsAtStartOfLine ? '1' : '0';
+  Key += Chained ? '1' : '0';
+  Key += Preamble;
+  return Key;
 }
 
 void OnDiskData::CleanTemporaryFiles() {
@@ -170,10 +296,7 @@ void OnDiskData::CleanTemporaryFiles() {
 }
 
 void OnDiskData::CleanPreambleFile() {
-  if (!PreambleFile.empty()) {
-    llvm::sys::fs::remove(PreambleFile);
-    PreambleFile.clear();
-  }
+  Preamble.reset();
 }
 
 void OnDiskData::Cleanup() {
@@ -207,6 +330,10 @@ void ASTUnit::addTemporaryFile(StringRef TempFile) {
 /// preamble.
 const unsigned DefaultPreambleRebuildInterval = 5;
 
+/// \brief The longest chain of precompiled headers a chained preamble is
+/// built as; past it, the beginning of the preamble is precompiled again.
+const unsigned MaxPreambleChainLength = 4;
+
 /// \brief Tracks the number of ASTUnit objects that are currently active.
 ///
 /// Used for debugging purposes only.
@@ -219,10 +346,14 @@ ASTUnit::ASTUnit(bool _MainFileIsAST)
     TUKind(TU_Complete), WantTiming(getenv("LIBCLANG_TIMING")),
     OwnsRemappedFileBuffers(true),
     NumStoredDiagnosticsFromDriver(0),
-    PreambleRebuildCounter(0),
+    PreambleRebuildCounter(0), ChainPreambles(false),
+    SharedSystemHeaderStats(nullptr),
     NumWarningsInPreamble(0),
     ShouldCacheCodeCompletionResults(false),
     IncludeBriefCommentsInCodeCompletion(false), UserFilesAreVolatile(false),
+    NumPreambleCachedCompletionResults(0),
+    PreambleCompletionCacheBytes(0),
+    CompletionCachePreambleHashValue(0),
     CompletionCacheTopLevelHashValue(0),
     PreambleTopLevelHashValue(0),
     CurrentTopLevelHashValue(0),
@@ -341,13 +472,27 @@ void ASTUnit::CacheCodeCompletionResults() {
   SimpleTimer Timer(WantTiming);
   Timer.setOutput("Cache global code completions for " + getMainFileName());
 
+  // The results for the entities of the preamble can be kept if the preamble
+  // has not changed since they were computed. The results for the main file
+  // are added to the same allocator, so start over once those have come to
+  // take up more memory than the preamble's.
+  bool KeepPreambleResults =
+      CachedCompletionAllocator && !getPreambleFile(this).empty() &&
+      CompletionCachePreambleHashValue == PreambleTopLevelHashValue &&
+      CachedCompletionAllocator->getBytesAllocated() <
+          2 * PreambleCompletionCacheBytes;
+
   // Clear out the previous results.
-  ClearCachedCompletionResults();
+  if (KeepPreambleResults) {
+    CachedCompletionResults.resize(NumPreambleCachedCompletionResults);
+  } else {
+    ClearCachedCompletionResults();
+    CachedCompletionAllocator = new GlobalCodeCompletionAllocator;
+  }
   
   // Gather the set of global code completions.
   typedef CodeCompletionResult Result;
   SmallVector<Result, 8> Results;
-  CachedCompletionAllocator = new GlobalCodeCompletionAllocator;
   CodeCompletionTUInfo CCTUInfo(CachedCompletionAllocator);
   TheSema->GatherGlobalCodeCompletions(*CachedCompletionAllocator,
                                        CCTUInfo, Results);
@@ -355,10 +500,20 @@ void ASTUnit::CacheCodeCompletionResults() {
   // Translate global code completions into cached completions.
   llvm::DenseMap<CanQualType, unsigned> CompletionTypes;
   CodeCompletionContext CCContext(CodeCompletionContext::CCC_TopLevel);
+  std::vector<CachedCodeCompletionResult> MainFileResults;
 
   for (Result &R : Results) {
     switch (R.Kind) {
     case Result::RK_Declaration: {
+      // An entity of the preamble that the main file redeclares still
+      // belongs to the preamble's results.
+      bool FromPreamble =
+          R.Declaration->getCanonicalDecl()->isFromASTFile();
+      if (FromPreamble && KeepPreambleResults)
+        continue;
+      std::vector<CachedCodeCompletionResult> &CachedResults =
+          FromPreamble ? CachedCompletionResults : MainFileResults;
+
       bool IsNestedNameSpecifier = false;
       CachedCodeCompletionResult CachedResult;
       CachedResult.Completion = R.CreateCodeCompletionString(
@@ -386,15 +541,18 @@ void ASTUnit::CacheCodeCompletionResults() {
         // temporary, CanQualType-based hash table to find the associated value.
         unsigned &TypeValue = CompletionTypes[CanUsageType];
         if (TypeValue == 0) {
-          TypeValue = CompletionTypes.size();
-          CachedCompletionTypes[QualType(CanUsageType).getAsString()]
-            = TypeValue;
+          unsigned NextTypeValue = CachedCompletionTypes.size() + 1;
+          TypeValue = CachedCompletionTypes
+                          .insert(std::make_pair(
+                              QualType(CanUsageType).getAsString(),
+                              NextTypeValue))
+                          .first->second;
         }
         
         CachedResult.Type = TypeValue;
       }
       
-      CachedCompletionResults.push_back(CachedResult);
+      CachedResults.push_back(CachedResult);
       
       /// Handle nested-name-specifiers in C++.
       if (TheSema->Context.getLangOpts().CPlusPlus && IsNestedNameSpecifier &&
@@ -431,7 +589,7 @@ void ASTUnit::CacheCodeCompletionResults() {
           CachedResult.Priority = CCP_NestedNameSpecifier;
           CachedResult.TypeClass = STC_Void;
           CachedResult.Type = 0;
-          CachedCompletionResults.push_back(CachedResult);
+          CachedResults.push_back(CachedResult);
         }
       }
       break;
@@ -444,6 +602,12 @@ void ASTUnit::CacheCodeCompletionResults() {
       break;
       
     case Result::RK_Macro: {
+      const MacroInfo *MI =
+          TheSema->getPreprocessor().getMacroInfo(R.Macro);
+      bool FromPreamble = MI && MI->isFromASTFile();
+      if (FromPreamble && KeepPreambleResults)
+        continue;
+
       CachedCodeCompletionResult CachedResult;
       CachedResult.Completion = R.CreateCodeCompletionString(
           *TheSema, CCContext, *CachedCompletionAllocator, CCTUInfo,
@@ -467,11 +631,22 @@ void ASTUnit::CacheCodeCompletionResults() {
       CachedResult.Availability = R.Availability;
       CachedResult.TypeClass = STC_Void;
       CachedResult.Type = 0;
-      CachedCompletionResults.push_back(CachedResult);
+      (FromPreamble ? CachedCompletionResults : MainFileResults)
+          .push_back(CachedResult);
       break;
     }
     }
   }
+
+  if (!KeepPreambleResults) {
+    NumPreambleCachedCompletionResults = CachedCompletionResults.size();
+    PreambleCompletionCacheBytes =
+        CachedCompletionAllocator->getBytesAllocated();
+    CompletionCachePreambleHashValue = PreambleTopLevelHashValue;
+  }
+  CachedCompletionResults.insert(CachedCompletionResults.end(),
+                                 MainFileResults.begin(),
+                                 MainFileResults.end());
   
   // Save the current top-level hash value.
   CompletionCacheTopLevelHashValue = CurrentTopLevelHashValue;
@@ -479,6 +654,8 @@ void ASTUnit::CacheCodeCompletionResults() {
 
 void ASTUnit::ClearCachedCompletionResults() {
   CachedCompletionResults.clear();
+  NumPreambleCachedCompletionResults = 0;
+  PreambleCompletionCacheBytes = 0;
   CachedCompletionTypes.clear();
   CachedCompletionAllocator = nullptr;
 }
@@ -655,7 +832,7 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromASTFile(
     const FileSystemOptions &FileSystemOpts, bool UseDebugInfo,
     bool OnlyLocalDecls, ArrayRef<RemappedFile> RemappedFiles,
     bool CaptureDiagnostics, bool AllowPCHWithCompilerErrors,
-    bool UserFilesAreVolatile) {
+    bool UserFilesAreVolatile, bool DisableValidation) {
   std::unique_ptr<ASTUnit> AST(new ASTUnit(true));
 
   // Recover resources if we crash before exiting this method.
@@ -706,12 +883,12 @@ std::unique_ptr<ASTUnit> ASTUnit::LoadFromASTFile(
                             PP.getBuiltinInfo());
   ASTContext &Context = *AST->Ctx;
 
-  bool disableValid = false;
+  // Without validation, loading stats none of the inputs the AST file was
+  // built from; declarations are still only deserialized as they are needed.
   if (::getenv("LIBCLANG_DISABLE_PCH_VALIDATION"))
-    disableValid = true;
+    DisableValidation = true;
   AST->Reader = new ASTReader(PP, Context, PCHContainerRdr, { },
-                              /*isysroot=*/"",
-                              /*DisableValidation=*/disableValid,
+                              /*isysroot=*/"", DisableValidation,
                               AllowPCHWithCompilerErrors);
 
   AST->Reader->setListener(llvm::make_unique<ASTInfoCollector>(
@@ -1081,6 +1258,7 @@ bool ASTUnit::Parse(std::shared_ptr<PCHContainerOperations> PCHContainerOps,
   if (!FileMgr) {
     Clang->createFileManager();
     FileMgr = &Clang->getFileManager();
+    shareSystemHeaderStats(*FileMgr);
   }
   SourceMgr = new SourceManager(getDiagnostics(), *FileMgr,
                                 UserFilesAreVolatile);
@@ -1166,6 +1344,43 @@ error:
   return true;
 }
 
+void ASTUnit::shareSystemHeaderStats(FileManager &FM) {
+  if (!SharedSystemHeaderStats)
+    return;
+
+  // Only share the stats of files that are not expected to change while
+  // editing: the builtin headers and the system headers.
+  const HeaderSearchOptions &HSOpts = Invocation->getHeaderSearchOpts();
+  std::vector<std::string> Directories;
+  if (!HSOpts.ResourceDir.empty())
+    Directories.push_back(HSOpts.ResourceDir);
+  for (const HeaderSearchOptions::Entry &Entry : HSOpts.UserEntries) {
+    switch (Entry.Group) {
+    case frontend::System:
+    case frontend::ExternCSystem:
+    case frontend::CSystem:
+    case frontend::CXXSystem:
+    case frontend::ObjCSystem:
+    case frontend::ObjCXXSystem:
+      if (!llvm::sys::path::is_absolute(Entry.Path))
+        break;
+      if (Entry.IgnoreSysRoot || HSOpts.Sysroot.empty() ||
+          HSOpts.Sysroot == "/")
+        Directories.push_back(Entry.Path);
+      else
+        Directories.push_back(HSOpts.Sysroot + Entry.Path);
+      break;
+    default:
+      break;
+    }
+  }
+  if (Directories.empty())
+    return;
+
+  FM.addStatCache(llvm::make_unique<SharedStatResultsCache>(
+      *SharedSystemHeaderStats, std::move(Directories)));
+}
+
 /// \brief Simple function to retrieve a path for a preamble precompiled header.
 static std::string GetPreamblePCHPath() {
   // FIXME: This is a hack so that we can override the preamble file during
@@ -1316,6 +1531,109 @@ makeStandaloneDiagnostic(const LangOptions &LangOpts,
   return OutDiag;
 }
 
+/// \brief Whether any of the files a precompiled preamble was built from has
+/// changed since, taking the files remapped by \p PreprocessorOpts into
+/// account.
+static bool anyPreambleFileChanged(
+    FileManager &FileMgr, const PreprocessorOptions &PreprocessorOpts,
+    const llvm::StringMap<ASTUnit::PreambleFileHash> &FilesInPreamble) {
+  typedef ASTUnit::PreambleFileHash PreambleFileHash;
+
+  // First, make a record of those files that have been overridden via
+  // remapping or unsaved_files.
+  std::map<llvm::sys::fs::UniqueID, PreambleFileHash> OverriddenFiles;
+  for (const auto &R : PreprocessorOpts.RemappedFiles) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(R.second, Status)) {
+      // If we can't stat the file we're remapping to, assume that something
+      // horrible happened.
+      return true;
+    }
+
+    OverriddenFiles[Status.getUniqueID()] = PreambleFileHash::createForFile(
+        Status.getSize(), Status.getLastModificationTime().toEpochTime());
+  }
+
+  for (const auto &RB : PreprocessorOpts.RemappedFileBuffers) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(RB.first, Status))
+      return true;
+
+    OverriddenFiles[Status.getUniqueID()] =
+        PreambleFileHash::createForMemoryBuffer(RB.second);
+  }
+
+  // Check whether anything has changed.
+  for (const auto &F : FilesInPreamble) {
+    vfs::Status Status;
+    if (FileMgr.getNoncachedStatValue(F.first(), Status)) {
+      // If we can't stat the file, assume that something horrible happened.
+      return true;
+    }
+
+    std::map<llvm::sys::fs::UniqueID, PreambleFileHash>::iterator Overridden
+      = OverriddenFiles.find(Status.getUniqueID());
+    if (Overridden != OverriddenFiles.end()) {
+      // This file was remapped; check whether the newly-mapped file
+      // matches up with the previous mapping.
+      if (Overridden->second != F.second)
+        return true;
+      continue;
+    }
+
+    // The file was not remapped; check whether it has changed on disk.
+    if (Status.getSize() != uint64_t(F.second.Size) ||
+        Status.getLastModificationTime().toEpochTime() !=
+            uint64_t(F.second.ModTime))
+      return true;
+  }
+  return false;
+}
+
+/// \brief Find where to split \p Preamble to build it as a chained
+/// preamble: the start of the line of its last #include or #import outside
+/// of any conditional.
+///
+/// \returns The number of bytes before that line, or 0 if there is no such
+/// line or nothing before it.
+static unsigned getPreambleChainBoundary(StringRef Preamble,
+                                         const LangOptions &LangOpts) {
+  // As in Lexer::ComputePreamble, use a "fake" file source location at
+  // offset 1 so that the lexer tracks our position within the buffer.
+  const unsigned StartOffset = 1;
+  Lexer TheLexer(SourceLocation::getFromRawEncoding(StartOffset), LangOpts,
+                 Preamble.begin(), Preamble.begin(), Preamble.end());
+
+  unsigned Boundary = 0;
+  unsigned IfDepth = 0;
+  Token TheTok;
+  TheLexer.LexFromRawLexer(TheTok);
+  while (TheTok.isNot(tok::eof)) {
+    if (!TheTok.isAtStartOfLine() || TheTok.isNot(tok::hash)) {
+      TheLexer.LexFromRawLexer(TheTok);
+      continue;
+    }
+
+    unsigned HashOffset = TheTok.getLocation().getRawEncoding() - StartOffset;
+    TheLexer.LexFromRawLexer(TheTok);
+    if (TheTok.isNot(tok::raw_identifier) || TheTok.needsCleaning())
+      continue;
+
+    StringRef Keyword = TheTok.getRawIdentifier();
+    if (Keyword == "if" || Keyword == "ifdef" || Keyword == "ifndef") {
+      ++IfDepth;
+    } else if (Keyword == "endif") {
+      if (IfDepth)
+        --IfDepth;
+    } else if (!IfDepth && (Keyword == "include" || Keyword == "import" ||
+                            Keyword == "include_next")) {
+      size_t LineStart = Preamble.rfind('\n', HashOffset);
+      Boundary = LineStart == StringRef::npos ? 0 : LineStart + 1;
+    }
+  }
+  return Boundary;
+}
+
 /// \brief Attempt to build or re-use a precompiled preamble when (re-)parsing
 /// the source file.
 ///
@@ -1361,6 +1679,11 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     return nullptr;
   }
   
+  // Keep the precompiled preamble used so far until the new one is built,
+  // since the new one may be chained to a part of it.
+  std::shared_ptr<SharedPreamble> PreviousPreamble =
+      getOnDiskData(this).Preamble;
+
   if (!Preamble.empty()) {
     // We've previously computed a preamble. Check whether we have the same
     // preamble now that we did before, and that there's enough space in
@@ -1374,71 +1697,8 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
       // preamble.
 
       // Check that none of the files used by the preamble have changed.
-      bool AnyFileChanged = false;
-          
-      // First, make a record of those files that have been overridden via
-      // remapping or unsaved_files.
-      std::map<llvm::sys::fs::UniqueID, PreambleFileHash> OverriddenFiles;
-      for (const auto &R : PreprocessorOpts.RemappedFiles) {
-        if (AnyFileChanged)
-          break;
-
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(R.second, Status)) {
-          // If we can't stat the file we're remapping to, assume that something
-          // horrible happened.
-          AnyFileChanged = true;
-          break;
-        }
-
-        OverriddenFiles[Status.getUniqueID()] = PreambleFileHash::createForFile(
-            Status.getSize(), Status.getLastModificationTime().toEpochTime());
-      }
-
-      for (const auto &RB : PreprocessorOpts.RemappedFileBuffers) {
-        if (AnyFileChanged)
-          break;
-
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(RB.first, Status)) {
-          AnyFileChanged = true;
-          break;
-        }
-
-        OverriddenFiles[Status.getUniqueID()] =
-            PreambleFileHash::createForMemoryBuffer(RB.second);
-      }
-       
-      // Check whether anything has changed.
-      for (llvm::StringMap<PreambleFileHash>::iterator
-             F = FilesInPreamble.begin(), FEnd = FilesInPreamble.end();
-           !AnyFileChanged && F != FEnd; 
-           ++F) {
-        vfs::Status Status;
-        if (FileMgr->getNoncachedStatValue(F->first(), Status)) {
-          // If we can't stat the file, assume that something horrible happened.
-          AnyFileChanged = true;
-          break;
-        }
-
-        std::map<llvm::sys::fs::UniqueID, PreambleFileHash>::iterator Overridden
-          = OverriddenFiles.find(Status.getUniqueID());
-        if (Overridden != OverriddenFiles.end()) {
-          // This file was remapped; check whether the newly-mapped file 
-          // matches up with the previous mapping.
-          if (Overridden->second != F->second)
-            AnyFileChanged = true;
-          continue;
-        }
-        
-        // The file was not remapped; check whether it has changed on disk.
-        if (Status.getSize() != uint64_t(F->second.Size) ||
-            Status.getLastModificationTime().toEpochTime() !=
-                uint64_t(F->second.ModTime))
-          AnyFileChanged = true;
-      }
-          
-      if (!AnyFileChanged) {
+      if (!anyPreambleFileChanged(*FileMgr, PreprocessorOpts,
+                                  FilesInPreamble)) {
         // Okay! We can re-use the precompiled preamble.
 
         // Set the state of the diagnostic object to mimic its state
@@ -1469,6 +1729,61 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     return nullptr;
   }
 
+  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
+  StringRef PreambleText =
+      NewPreamble.Buffer->getBuffer().slice(0, NewPreamble.Size);
+
+  // Start using the precompiled preamble \p Shared for the new preamble.
+  auto UsePreamble = [&](std::shared_ptr<SharedPreamble> Shared) {
+    // Save the preamble text for later; we'll need to compare against it for
+    // subsequent reparses.
+    Preamble.assign(FileMgr->getFile(MainFilename), PreambleText.begin(),
+                    PreambleText.end());
+    PreambleEndsAtStartOfLine = NewPreamble.PreambleEndsAtStartOfLine;
+    OriginalSourceFile = MainFilename;
+
+    FilesInPreamble = Shared->FilesInPreamble;
+    PreambleDiagnostics = Shared->Diagnostics;
+    NumWarningsInPreamble = Shared->NumWarnings;
+    TopLevelDeclsInPreamble = Shared->TopLevelDecls;
+    CurrentTopLevelHashValue = Shared->TopLevelHashValue;
+    setPreamble(this, std::move(Shared));
+    getDiagnostics().setNumWarnings(NumWarningsInPreamble);
+
+    PreambleRebuildCounter = 1;
+
+    // If the hash of top-level entities differs from the hash of the top-level
+    // entities the last time we rebuilt the preamble, clear out the completion
+    // cache.
+    if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
+      CompletionCacheTopLevelHashValue = 0;
+      PreambleTopLevelHashValue = CurrentTopLevelHashValue;
+    }
+
+    return llvm::MemoryBuffer::getMemBufferCopy(NewPreamble.Buffer->getBuffer(),
+                                                MainFilename);
+  };
+
+  // Another ASTUnit of this file may have precompiled the same preamble
+  // already, in which case we use it rather than building our own.
+  std::string SharedPreambleKey =
+      getSharedPreambleKey(*PreambleInvocation, PreambleText,
+                           NewPreamble.PreambleEndsAtStartOfLine,
+                           ChainPreambles);
+  std::shared_ptr<SharedPreamble> Shared =
+      findSharedPreamble(SharedPreambleKey);
+  if (Shared && !anyPreambleFileChanged(*FileMgr, PreprocessorOpts,
+                                        Shared->FilesInPreamble)) {
+    // Set the state of the diagnostic object to mimic its state
+    // after parsing the preamble.
+    checkAndRemoveNonDriverDiags(StoredDiagnostics);
+    TopLevelDecls.clear();
+    getDiagnostics().Reset();
+    ProcessWarningOptions(getDiagnostics(),
+                          PreambleInvocation->getDiagnosticOpts());
+    return UsePreamble(std::move(Shared));
+  }
+
   // If the preamble rebuild counter > 1, it's because we previously
   // failed to build a preamble and we're not yet ready to try
   // again. Decrement the counter and return a failure.
@@ -1477,40 +1792,121 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     return nullptr;
   }
 
+  // We did not previously compute a preamble, or it can't be reused anyway.
+  SimpleTimer PreambleTimer(WantTiming);
+  PreambleTimer.setOutput("Precompiling preamble");
+
+  // Precompile \p Text, the beginning of the new preamble, on top of the
+  // precompiled preamble \p Base of its own beginning, if any.
+  auto Precompile = [&](StringRef Text, std::shared_ptr<SharedPreamble> Base)
+      -> std::shared_ptr<SharedPreamble> {
+    std::string PCHFile;
+    if (!precompilePreamble(PCHContainerOps, *PreambleInvocation, Text,
+                            Base ? Base->PCHFile : std::string(),
+                            Base ? Base->Size : 0, PCHFile))
+      return nullptr;
+
+    // A chained preamble covers everything its base does as well.
+    auto Link = std::make_shared<SharedPreamble>();
+    Link->PCHFile = PCHFile;
+    Link->Size = Text.size();
+    if (Base) {
+      Link->ChainLength = Base->ChainLength + 1;
+      Link->FilesInPreamble = Base->FilesInPreamble;
+      Link->Diagnostics = Base->Diagnostics;
+      Link->NumWarnings = Base->NumWarnings;
+      Link->TopLevelDecls = Base->TopLevelDecls;
+      Link->TopLevelHashValue = unsigned(llvm::hash_combine(
+          Base->TopLevelHashValue, CurrentTopLevelHashValue));
+    } else {
+      Link->ChainLength = 1;
+      Link->NumWarnings = 0;
+      Link->TopLevelHashValue = CurrentTopLevelHashValue;
+    }
+    for (const auto &F : FilesInPreamble)
+      Link->FilesInPreamble[F.first()] = F.second;
+    Link->Diagnostics.append(PreambleDiagnostics.begin(),
+                             PreambleDiagnostics.end());
+    Link->NumWarnings += NumWarningsInPreamble;
+    Link->TopLevelDecls.insert(Link->TopLevelDecls.end(),
+                               TopLevelDeclsInPreamble.begin(),
+                               TopLevelDeclsInPreamble.end());
+    Link->Base = std::move(Base);
+    return Link;
+  };
+
+  // When chaining preambles, the preamble up to its last #include is
+  // precompiled on its own first, or reused if it has not changed, so that
+  // editing the last #include only precompiles that part again.
+  std::shared_ptr<SharedPreamble> Base;
+  if (ChainPreambles) {
+    if (unsigned BaseSize = getPreambleChainBoundary(
+            PreambleText, *PreambleInvocation->getLangOpts())) {
+      StringRef BaseText = PreambleText.slice(0, BaseSize);
+      std::string BaseKey = getSharedPreambleKey(
+          *PreambleInvocation, BaseText, /*PreambleEndsAtStartOfLine=*/true,
+          /*Chained=*/true);
+      Base = findSharedPreamble(BaseKey);
+      if (Base && (Base->ChainLength >= MaxPreambleChainLength ||
+                   anyPreambleFileChanged(*FileMgr, PreprocessorOpts,
+                                          Base->FilesInPreamble)))
+        Base.reset();
+      if (!Base && (Base = Precompile(BaseText, nullptr)))
+        addSharedPreamble(BaseKey, Base);
+    }
+  }
+
+  Shared = Precompile(PreambleText, std::move(Base));
+  if (!Shared)
+    return nullptr;
+
+  // Keep track of the preamble we precompiled, and let the other ASTUnits of
+  // this file use it too.
+  addSharedPreamble(SharedPreambleKey, Shared);
+  return UsePreamble(std::move(Shared));
+}
+
+bool ASTUnit::precompilePreamble(
+    std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+    const CompilerInvocation &PreambleInvocationIn, StringRef PreambleText,
+    StringRef BasePCHFile, unsigned BaseSize, std::string &PCHFile) {
   // Create a temporary file for the precompiled preamble. In rare 
   // circumstances, this can fail.
-  std::string PreamblePCHPath = GetPreamblePCHPath();
-  if (PreamblePCHPath.empty()) {
+  PCHFile = GetPreamblePCHPath();
+  if (PCHFile.empty()) {
     // Try again next time.
     PreambleRebuildCounter = 1;
-    return nullptr;
+    return false;
   }
-  
-  // We did not previously compute a preamble, or it can't be reused anyway.
-  SimpleTimer PreambleTimer(WantTiming);
-  PreambleTimer.setOutput("Precompiling preamble");
 
-  // Save the preamble text for later; we'll need to compare against it for
-  // subsequent reparses.
-  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
-  Preamble.assign(FileMgr->getFile(MainFilename),
-                  NewPreamble.Buffer->getBufferStart(),
-                  NewPreamble.Buffer->getBufferStart() + NewPreamble.Size);
-  PreambleEndsAtStartOfLine = NewPreamble.PreambleEndsAtStartOfLine;
+  IntrusiveRefCntPtr<CompilerInvocation>
+    PreambleInvocation(new CompilerInvocation(PreambleInvocationIn));
+  FrontendOptions &FrontendOpts = PreambleInvocation->getFrontendOpts();
+  PreprocessorOptions &PreprocessorOpts
+    = PreambleInvocation->getPreprocessorOpts();
 
-  PreambleBuffer = llvm::MemoryBuffer::getMemBufferCopy(
-      NewPreamble.Buffer->getBuffer().slice(0, Preamble.size()), MainFilename);
+  StringRef MainFilename = FrontendOpts.Inputs[0].getFile();
+  PreambleBuffer =
+      llvm::MemoryBuffer::getMemBufferCopy(PreambleText, MainFilename);
 
   // Remap the main source file to the preamble buffer.
-  StringRef MainFilePath = FrontendOpts.Inputs[0].getFile();
-  PreprocessorOpts.addRemappedFile(MainFilePath, PreambleBuffer.get());
+  PreprocessorOpts.addRemappedFile(MainFilename, PreambleBuffer.get());
 
   // Tell the compiler invocation to generate a temporary precompiled header.
   FrontendOpts.ProgramAction = frontend::GeneratePCH;
   // FIXME: Generate the precompiled header into memory?
-  FrontendOpts.OutputFile = PreamblePCHPath;
-  PreprocessorOpts.PrecompiledPreambleBytes.first = 0;
-  PreprocessorOpts.PrecompiledPreambleBytes.second = false;
+  FrontendOpts.OutputFile = PCHFile;
+  if (BasePCHFile.empty()) {
+    PreprocessorOpts.PrecompiledPreambleBytes.first = 0;
+    PreprocessorOpts.PrecompiledPreambleBytes.second = false;
+  } else {
+    // Chain the precompiled header to the one of the first BaseSize bytes,
+    // loading it the way a reparse loads the precompiled preamble.
+    PreprocessorOpts.PrecompiledPreambleBytes.first = BaseSize;
+    PreprocessorOpts.PrecompiledPreambleBytes.second = true;
+    PreprocessorOpts.ImplicitPCHInclude = BasePCHFile;
+    PreprocessorOpts.DisablePCHValidation = true;
+  }
   
   // Create the compiler instance to use for building the precompiled preamble.
   std::unique_ptr<CompilerInstance> Clang(
@@ -1531,10 +1927,9 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
       Clang->getDiagnostics(), Clang->getInvocation().TargetOpts));
   if (!Clang->hasTarget()) {
     llvm::sys::fs::remove(FrontendOpts.OutputFile);
-    Preamble.clear();
     PreambleRebuildCounter = DefaultPreambleRebuildInterval;
     PreprocessorOpts.RemappedFileBuffers.pop_back();
-    return nullptr;
+    return false;
   }
   
   // Inform the target of the language options.
@@ -1561,10 +1956,11 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   IntrusiveRefCntPtr<vfs::FileSystem> VFS =
       createVFSFromCompilerInvocation(Clang->getInvocation(), getDiagnostics());
   if (!VFS)
-    return nullptr;
+    return false;
 
   // Create a file manager object to provide access to and cache the filesystem.
   Clang->setFileManager(new FileManager(Clang->getFileSystemOpts(), VFS));
+  shareSystemHeaderStats(Clang->getFileManager());
   
   // Create the source manager.
   Clang->setSourceManager(new SourceManager(getDiagnostics(),
@@ -1577,10 +1973,9 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
   Act.reset(new PrecompilePreambleAction(*this));
   if (!Act->BeginSourceFile(*Clang.get(), Clang->getFrontendOpts().Inputs[0])) {
     llvm::sys::fs::remove(FrontendOpts.OutputFile);
-    Preamble.clear();
     PreambleRebuildCounter = DefaultPreambleRebuildInterval;
     PreprocessorOpts.RemappedFileBuffers.pop_back();
-    return nullptr;
+    return false;
   }
   
   Act->Execute();
@@ -1602,15 +1997,12 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     // so no precompiled header was generated. Forget that we even tried.
     // FIXME: Should we leave a note for ourselves to try again?
     llvm::sys::fs::remove(FrontendOpts.OutputFile);
-    Preamble.clear();
     TopLevelDeclsInPreamble.clear();
     PreambleRebuildCounter = DefaultPreambleRebuildInterval;
     PreprocessorOpts.RemappedFileBuffers.pop_back();
-    return nullptr;
+    return false;
   }
   
-  // Keep track of the preamble we precompiled.
-  setPreambleFile(this, FrontendOpts.OutputFile);
   NumWarningsInPreamble = getDiagnostics().getNumWarnings();
   
   // Keep track of all of the files that the source manager knows about,
@@ -1631,19 +2023,9 @@ ASTUnit::getMainBufferWithPrecompiledPreamble(
     }
   }
 
-  PreambleRebuildCounter = 1;
-  PreprocessorOpts.RemappedFileBuffers.pop_back();
-
-  // If the hash of top-level entities differs from the hash of the top-level
-  // entities the last time we rebuilt the preamble, clear out the completion
-  // cache.
-  if (CurrentTopLevelHashValue != PreambleTopLevelHashValue) {
-    CompletionCacheTopLevelHashValue = 0;
-    PreambleTopLevelHashValue = CurrentTopLevelHashValue;
-  }
 
-  return llvm::MemoryBuffer::getMemBufferCopy(NewPreamble.Buffer->getBuffer(),
-                                              MainFilename);
+  PreprocessorOpts.RemappedFileBuffers.pop_back();
+  return true;
 }
 
 void ASTUnit::RealizeTopLevelDeclsFromPreamble() {
@@ -1706,6 +2088,14 @@ StringRef ASTUnit::getASTFileName() const {
   return Mod.FileName;
 }
 
+std::vector<std::string> ASTUnit::getPreamblePCHFiles() const {
+  std::vector<std::string> Files;
+  for (const SharedPreamble *Link = getOnDiskData(this).Preamble.get(); Link;
+       Link = Link->Base.get())
+    Files.insert(Files.begin(), Link->PCHFile);
+  return Files;
+}
+
 ASTUnit *ASTUnit::create(CompilerInvocation *CI,
                          IntrusiveRefCntPtr<DiagnosticsEngine> Diags,
                          bool CaptureDiagnostics,
@@ -1945,7 +2335,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
     bool CacheCodeCompletionResults, bool IncludeBriefCommentsInCodeCompletion,
     bool AllowPCHWithCompilerErrors, bool SkipFunctionBodies,
     bool UserFilesAreVolatile, bool ForSerialization,
-    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST) {
+    llvm::Optional<StringRef> ModuleFormat, std::unique_ptr<ASTUnit> *ErrAST,
+    SharedStatResults *SharedSystemHeaderStats) {
   assert(Diags.get() && "no DiagnosticsEngine was provided");
 
   SmallVector<StoredDiagnostic, 4> StoredDiagnostics;
@@ -2002,6 +2393,8 @@ ASTUnit *ASTUnit::LoadFromCommandLine(
   AST->NumStoredDiagnosticsFromDriver = StoredDiagnostics.size();
   AST->StoredDiagnostics.swap(StoredDiagnostics);
   AST->Invocation = CI;
+  AST->SharedSystemHeaderStats = SharedSystemHeaderStats;
+  AST->shareSystemHeaderStats(*AST->FileMgr);
   if (ForSerialization)
     AST->WriterData.reset(new ASTWriterData());
   // Zero out now to ease cleanup during crash recovery.
@@ -2237,6 +2630,9 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
   llvm::StringSet<llvm::BumpPtrAllocator> HiddenNames;
   typedef CodeCompletionResult Result;
   SmallVector<Result, 8> AllResults;
+  StringRef Filter;
+  if (filterByTypedText())
+    Filter = S.getPreprocessor().getCodeCompletionFilter();
   for (ASTUnit::cached_completion_iterator 
             C = AST.cached_completion_begin(),
          CEnd = AST.cached_completion_end();
@@ -2245,6 +2641,11 @@ void AugmentedCodeCompleteConsumer::ProcessCodeCompleteResults(Sema &S,
     // interested in, we'll add this result.
     if ((C->ShowInContexts & InContexts) == 0)
       continue;
+
+    // Skip the results that do not match what the user has typed so far.
+    if (!Filter.empty() &&
+        !StringRef(C->Completion->getTypedText()).startswith_lower(Filter))
+      continue;
     
     // If we haven't added any results previously, do so now.
     if (!AddedResult) {
@@ -2318,7 +2719,7 @@ void ASTUnit::CodeComplete(
     StringRef File, unsigned Line, unsigned Column,
     ArrayRef<RemappedFile> RemappedFiles, bool IncludeMacros,
     bool IncludeCodePatterns, bool IncludeBriefComments,
-    CodeCompleteConsumer &Consumer,
+    bool FilterByTypedText, CodeCompleteConsumer &Consumer,
     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
     DiagnosticsEngine &Diag, LangOptions &LangOpts, SourceManager &SourceMgr,
     FileManager &FileMgr, SmallVectorImpl<StoredDiagnostic> &StoredDiagnostics,
@@ -2342,6 +2743,7 @@ void ASTUnit::CodeComplete(
   CodeCompleteOpts.IncludeCodePatterns = IncludeCodePatterns;
   CodeCompleteOpts.IncludeGlobals = CachedCompletionResults.empty();
   CodeCompleteOpts.IncludeBriefComments = IncludeBriefComments;
+  CodeCompleteOpts.FilterByTypedText = FilterByTypedText;
 
   assert(IncludeBriefComments == this->IncludeBriefCommentsInCodeCompletion);
 
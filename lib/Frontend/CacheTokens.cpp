@@ -21,6 +21,7 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/PTHManager.h"
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/SharedTokenCache.h"
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/EndianStream.h"
@@ -241,7 +242,10 @@ public:
       : Out(out), PP(pp), idcount(0), CurStrOffset(0) {}
 
   PTHMap &getPM() { return PM; }
-  void GeneratePTH(StringRef MainFile);
+
+  /// Generate a PTH file for every file in the SourceManager, or only for
+  /// 'OnlyFile' if it is non-null.
+  void GeneratePTH(StringRef MainFile, const FileEntry *OnlyFile = nullptr);
 };
 } // end anonymous namespace
 
@@ -479,7 +483,7 @@ static void pwrite32le(raw_pwrite_stream &OS, uint32_t Val, uint64_t &Off) {
   Off += 4;
 }
 
-void PTHWriter::GeneratePTH(StringRef MainFile) {
+void PTHWriter::GeneratePTH(StringRef MainFile, const FileEntry *OnlyFile) {
   // Generate the prologue.
   Out << "cfe-pth" << '\0';
   Emit32(PTHManager::Version);
@@ -508,9 +512,13 @@ void PTHWriter::GeneratePTH(StringRef MainFile) {
     const SrcMgr::ContentCache &C = *I->second;
     const FileEntry *FE = C.OrigEntry;
 
-    // FIXME: Handle files with non-absolute paths.
-    if (llvm::sys::path::is_relative(FE->getName()))
+    if (OnlyFile) {
+      if (FE != OnlyFile)
+        continue;
+    } else if (llvm::sys::path::is_relative(FE->getName())) {
+      // FIXME: Handle files with non-absolute paths.
       continue;
+    }
 
     const llvm::MemoryBuffer *B = C.getBuffer(PP.getDiagnostics(), SM);
     if (!B) continue;
@@ -598,6 +606,58 @@ void clang::CacheTokens(Preprocessor &PP, raw_pwrite_stream *OS) {
   PW.GeneratePTH(MainFilePath.str());
 }
 
+void clang::UpdateTokenCache(Preprocessor &PP) {
+  SharedTokenCache *TC = PP.getTokenCache();
+  // Don't cache the tokens of files that may be what made the compile fail.
+  if (!TC || PP.getDiagnostics().hasErrorOccurred())
+    return;
+
+  SourceManager &SM = PP.getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  bool CreatedDirectory = false;
+
+  // Collect the files first; generating PTH data creates new FileIDs.
+  std::vector<const FileEntry *> Files;
+  for (SourceManager::fileinfo_iterator I = SM.fileinfo_begin(),
+       E = SM.fileinfo_end(); I != E; ++I)
+    if (I->first != MainFile)
+      Files.push_back(I->first);
+
+  for (const FileEntry *FE : Files) {
+    const llvm::MemoryBuffer *B =
+        SM.getMemoryBufferForFile(FE, /*Invalid=*/nullptr);
+    if (!B || TC->hasEntry(TC->getEntryName(*B)))
+      continue;
+
+    if (!CreatedDirectory) {
+      if (llvm::sys::fs::create_directories(TC->getDirectory()))
+        return;
+      CreatedDirectory = true;
+    }
+
+    // Write the entry to a temporary file and rename it into place, so that
+    // concurrent compiles never see a partially written entry.
+    std::string EntryPath = TC->getEntryPath(*B);
+    SmallString<256> TempPath;
+    int FD;
+    if (llvm::sys::fs::createUniqueFile(EntryPath + "-%%%%%%%%", FD, TempPath))
+      continue;
+
+    bool Failed;
+    {
+      llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+      PTHWriter PW(OS, PP);
+      PW.GeneratePTH(FE->getName(), FE);
+      OS.close();
+      Failed = OS.has_error();
+      OS.clear_error();
+    }
+
+    if (Failed || llvm::sys::fs::rename(TempPath, EntryPath))
+      llvm::sys::fs::remove(TempPath);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 
 namespace {
@@ -77,13 +77,14 @@ static ASTReader *
 createASTReader(CompilerInstance &CI, StringRef pchFile,
                 SmallVectorImpl<std::unique_ptr<llvm::MemoryBuffer>> &MemBufs,
                 SmallVectorImpl<std::string> &bufNames,
-                ASTDeserializationListener *deserialListener = nullptr) {
+                ASTDeserializationListener *deserialListener = nullptr,
+                bool DisableValidation = true) {
   Preprocessor &PP = CI.getPreprocessor();
   std::unique_ptr<ASTReader> Reader;
   Reader.reset(new ASTReader(PP, CI.getASTContext(),
                              CI.getPCHContainerReader(),
                              /*Extensions=*/{ },
-                             /*isysroot=*/"", /*DisableValidation=*/true));
+                             /*isysroot=*/"", DisableValidation));
   for (unsigned ti = 0; ti < bufNames.size(); ++ti) {
     StringRef sr(bufNames[ti]);
     Reader->addInMemoryBuffer(sr, std::move(MemBufs[ti]));
@@ -124,6 +125,12 @@ IntrusiveRefCntPtr<ExternalSemaSource> clang::createChainedIncludesSource(
   SmallVector<std::unique_ptr<llvm::MemoryBuffer>, 4> SerialBufs;
   SmallVector<std::string, 4> serialBufNames;
 
+  // If a precompiled header was given with -include-pch, chain the headers
+  // onto it instead of rebuilding the prefix it already covers. It is only
+  // validated when it is first read; the later readers trust it.
+  const PreprocessorOptions &PPOpts = CI.getPreprocessorOpts();
+  const std::string &BasePCH = PPOpts.ImplicitPCHInclude;
+
   for (unsigned i = 0, e = includes.size(); i != e; ++i) {
     bool firstInclude = (i == 0);
     std::unique_ptr<CompilerInvocation> CInvok;
@@ -170,10 +177,22 @@ IntrusiveRefCntPtr<ExternalSemaSource> clang::createChainedIncludesSource(
     Clang->setASTConsumer(std::move(consumer));
     Clang->createSema(TU_Prefix, nullptr);
 
-    if (firstInclude) {
+    if (firstInclude && BasePCH.empty()) {
       Preprocessor &PP = Clang->getPreprocessor();
       PP.getBuiltinInfo().initializeBuiltins(PP.getIdentifierTable(),
                                              PP.getLangOpts());
+    } else if (firstInclude) {
+      SmallVector<std::unique_ptr<llvm::MemoryBuffer>, 4> NoBufs;
+      SmallVector<std::string, 4> NoBufNames;
+      IntrusiveRefCntPtr<ASTReader> Reader;
+      Reader = createASTReader(
+          *Clang, BasePCH, NoBufs, NoBufNames,
+          Clang->getASTConsumer().GetASTDeserializationListener(),
+          PPOpts.DisablePCHValidation);
+      if (!Reader)
+        return nullptr;
+      Clang->setModuleManager(Reader);
+      Clang->getASTContext().setExternalSource(Reader);
     } else {
       assert(!SerialBufs.empty());
       SmallVector<std::unique_ptr<llvm::MemoryBuffer>, 4> Bufs;
@@ -13,6 +13,7 @@
 #include "clang/AST/Decl.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/FileManager.h"
+#include "clang/Basic/SharedStatCache.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/TargetInfo.h"
 #include "clang/Basic/Version.h"
@@ -29,10 +30,12 @@
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/PTHManager.h"
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/SharedTokenCache.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
 #include "clang/Sema/Sema.h"
 #include "clang/Serialization/ASTReader.h"
 #include "clang/Serialization/GlobalModuleIndex.h"
+#include "clang/Serialization/SharedModuleCache.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/Errc.h"
@@ -140,6 +143,16 @@ void CompilerInstance::setModuleDepCollector(
   ModuleDepCollector = std::move(Collector);
 }
 
+IntrusiveRefCntPtr<serialization::SharedModuleCache>
+CompilerInstance::getSharedModuleCache() const {
+  return SharedModuleCache;
+}
+
+void CompilerInstance::setSharedModuleCache(
+    IntrusiveRefCntPtr<serialization::SharedModuleCache> Cache) {
+  SharedModuleCache = std::move(Cache);
+}
+
 // Diagnostics
 static void SetUpDiagnosticLog(DiagnosticOptions *DiagOpts,
                                const CodeGenOptions *CodeGenOpts,
@@ -235,6 +248,20 @@ void CompilerInstance::createFileManager() {
     setVirtualFileSystem(vfs::getRealFileSystem());
   }
   FileMgr = new FileManager(getFileSystemOpts(), VirtualFileSystem);
+
+  // Results from a virtual file system overlay are specific to this
+  // invocation, so only share the results of querying the real one.
+  const FileSystemOptions &FSOpts = getFileSystemOpts();
+  if (!FSOpts.SharedStatCachePath.empty() &&
+      VirtualFileSystem == vfs::getRealFileSystem()) {
+    if (auto StatCache = SharedStatCache::create(FSOpts.SharedStatCachePath))
+      FileMgr->addStatCache(std::move(StatCache));
+  }
+
+  // Read-ahead hints only make sense for files on disk.
+  if (!FSOpts.PrefetchFileList.empty() &&
+      VirtualFileSystem == vfs::getRealFileSystem())
+    FileMgr->prefetchFiles(FSOpts.PrefetchFileList);
 }
 
 // Source Manager
@@ -322,9 +349,16 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
     PP->setPTHManager(PTHMgr);
   }
 
+  if (!PPOpts.TokenCacheDir.empty())
+    PP->setTokenCache(
+        llvm::make_unique<SharedTokenCache>(PPOpts.TokenCacheDir, *PP));
+
   if (PPOpts.DetailedRecord)
     PP->createPreprocessingRecord();
 
+  if (PPOpts.CoalesceMacroArgExpansions)
+    PP->getSourceManager().setCoalesceMacroArgExpansions(true);
+
   // Apply remappings to the source manager.
   InitializeFileRemapping(PP->getDiagnostics(), PP->getSourceManager(),
                           PP->getFileManager(), PPOpts);
@@ -381,6 +415,9 @@ void CompilerInstance::createPreprocessor(TranslationUnitKind TUKind) {
                            /*ShowAllHeaders=*/true, /*OutputPath=*/"",
                            /*ShowDepth=*/true, /*MSStyle=*/true);
   }
+
+  if (!DepOpts.HeaderCostReportFile.empty())
+    AttachHeaderCostReportGen(*PP, DepOpts.HeaderCostReportFile);
 }
 
 std::string CompilerInstance::getSpecificModuleCachePath() {
@@ -417,7 +454,7 @@ void CompilerInstance::createPCHExternalASTSource(
       getFrontendOpts().ModuleFileExtensions,
       DeserializationListener,
       OwnDeserializationListener, Preamble,
-      getFrontendOpts().UseGlobalModuleIndex);
+      getFrontendOpts().UseGlobalModuleIndex, SharedModuleCache.get());
 }
 
 IntrusiveRefCntPtr<ASTReader> CompilerInstance::createPCHExternalASTSource(
@@ -426,7 +463,8 @@ IntrusiveRefCntPtr<ASTReader> CompilerInstance::createPCHExternalASTSource(
     const PCHContainerReader &PCHContainerRdr,
     ArrayRef<IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
     void *DeserializationListener, bool OwnDeserializationListener,
-    bool Preamble, bool UseGlobalModuleIndex) {
+    bool Preamble, bool UseGlobalModuleIndex,
+    serialization::SharedModuleCache *SharedModuleCache) {
   HeaderSearchOptions &HSOpts = PP.getHeaderSearchInfo().getHeaderSearchOpts();
 
   IntrusiveRefCntPtr<ASTReader> Reader(new ASTReader(
@@ -434,6 +472,8 @@ IntrusiveRefCntPtr<ASTReader> CompilerInstance::createPCHExternalASTSource(
       Sysroot.empty() ? "" : Sysroot.data(), DisablePCHValidation,
       AllowPCHWithCompilerErrors, /*AllowConfigurationMismatch*/ false,
       HSOpts.ModulesValidateSystemHeaders, UseGlobalModuleIndex));
+  if (SharedModuleCache)
+    Reader->getModuleManager().setSharedModuleCache(SharedModuleCache);
 
   // We need the external source to be set up before we read the AST, because
   // eagerly-deserialized declarations may use it.
@@ -866,12 +906,38 @@ bool CompilerInstance::ExecuteAction(FrontendAction &Act) {
   if (getFrontendOpts().ShowStats)
     llvm::EnableStatistics();
 
-  for (const FrontendInputFile &FIF : getFrontendOpts().Inputs) {
+  // The inputs of a batch are compiled one after the other, each into an
+  // output of its own. The file manager, with the results of every stat it
+  // made, and the contents of any PCH or module files carry over from one
+  // compile to the next.
+  const std::vector<std::string> &BatchOutputFiles =
+      getFrontendOpts().BatchOutputFiles;
+  if (!BatchOutputFiles.empty() && !SharedModuleCache)
+    SharedModuleCache = new serialization::SharedModuleCache();
+
+  for (unsigned I = 0, E = getFrontendOpts().Inputs.size(); I != E; ++I) {
+    const FrontendInputFile &FIF = getFrontendOpts().Inputs[I];
+
     // Reset the ID tables if we are reusing the SourceManager and parsing
     // regular files.
     if (hasSourceManager() && !Act.isModelParsingAction())
       getSourceManager().clearIDTables();
 
+    if (!BatchOutputFiles.empty()) {
+      getFrontendOpts().OutputFile = BatchOutputFiles[I];
+      if (FIF.isFile())
+        getCodeGenOpts().MainFileName =
+            llvm::sys::path::filename(FIF.getFile());
+
+      // Errors of one compile must not stop the next, and the #pragma
+      // diagnostic state refers to locations that no longer exist.
+      if (I) {
+        getDiagnostics().Reset();
+        ProcessWarningOptions(getDiagnostics(), getDiagnosticOpts(),
+                              /*ReportDiags=*/false);
+      }
+    }
+
     if (Act.BeginSourceFile(*this, FIF)) {
       Act.Execute();
       Act.EndSourceFile();
@@ -1005,6 +1071,7 @@ static bool compileModuleImpl(CompilerInstance &ImportingInstance,
   // between all of the module CompilerInstances. Other than that, we don't
   // want to produce any dependency output from the module build.
   Instance.setModuleDepCollector(ImportingInstance.getModuleDepCollector());
+  Instance.setSharedModuleCache(ImportingInstance.getSharedModuleCache());
   Invocation->getDependencyOutputOpts() = DependencyOutputOptions();
 
   // Get or create the module map that we'll use to build this module.
@@ -1312,6 +1379,8 @@ void CompilerInstance::createModuleManager() {
         HSOpts.ModulesValidateSystemHeaders,
         getFrontendOpts().UseGlobalModuleIndex,
         std::move(ReadTimer));
+    if (SharedModuleCache)
+      ModuleManager->getModuleManager().setSharedModuleCache(SharedModuleCache);
     if (hasASTConsumer()) {
       ModuleManager->setDeserializationListener(
         getASTConsumer().GetASTDeserializationListener());
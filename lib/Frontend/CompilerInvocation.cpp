@@ -38,12 +38,14 @@
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Support/ScopedPrinter.h"
 #include <atomic>
 #include <memory>
+#include <mutex>
 #include <sys/stat.h>
 #include <system_error>
 using namespace clang;
@@ -301,6 +303,29 @@ static bool ParseAnalyzerArgs(AnalyzerOptions &Opts, ArgList &Args,
     }
   }
 
+  // An out-of-range shard would silently analyze nothing.
+  unsigned ShardCount = 1, ShardIndex = 0;
+  auto Count = Opts.Config.find("shard-count");
+  if (Count != Opts.Config.end() &&
+      (StringRef(Count->second).getAsInteger(10, ShardCount) ||
+       ShardCount == 0)) {
+    Diags.Report(diag::err_analyzer_config_invalid_count)
+        << "shard-count" << 0 << Count->second;
+    return false;
+  }
+  auto Index = Opts.Config.find("shard-index");
+  if (Index != Opts.Config.end() &&
+      StringRef(Index->second).getAsInteger(10, ShardIndex)) {
+    Diags.Report(diag::err_analyzer_config_invalid_count)
+        << "shard-index" << 1 << Index->second;
+    return false;
+  }
+  if (ShardIndex >= ShardCount) {
+    Diags.Report(diag::err_analyzer_config_shard_index_out_of_range)
+        << ShardIndex << ShardCount;
+    return false;
+  }
+
   return Success;
 }
 
@@ -542,6 +567,8 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.CoverageMapping =
       Args.hasFlag(OPT_fcoverage_mapping, OPT_fno_coverage_mapping, false);
   Opts.DumpCoverageMapping = Args.hasArg(OPT_dump_coverage_mapping);
+  Opts.CoverageMappingSkipHeaderFunctions =
+      Args.hasArg(OPT_fno_coverage_mapping_header_functions);
   Opts.AsmVerbose = Args.hasArg(OPT_masm_verbose);
   Opts.AssumeSaneOperatorNew = !Args.hasArg(OPT_fno_assume_sane_operator_new);
   Opts.ObjCAutoRefCountExceptions = Args.hasArg(OPT_fobjc_arc_exceptions);
@@ -582,6 +609,9 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.SoftFloat = Args.hasArg(OPT_msoft_float);
   Opts.StrictEnums = Args.hasArg(OPT_fstrict_enums);
   Opts.StrictVTablePointers = Args.hasArg(OPT_fstrict_vtable_pointers);
+  Opts.RelativeCXXABIVTables =
+      Args.hasArg(OPT_fexperimental_relative_cxx_abi_vtables);
+  Opts.ExpandedStaticInit = Args.hasArg(OPT_fexpanded_static_init);
   Opts.UnsafeFPMath = Args.hasArg(OPT_menable_unsafe_fp_math) ||
                       Args.hasArg(OPT_cl_unsafe_math_optimizations) ||
                       Args.hasArg(OPT_cl_fast_relaxed_math);
@@ -623,6 +653,24 @@ static bool ParseCodeGenArgs(CodeGenOptions &Opts, ArgList &Args, InputKind IK,
   Opts.VectorizeSLP = Args.hasArg(OPT_vectorize_slp);
 
   Opts.MainFileName = Args.getLastArgValue(OPT_main_file_name);
+  Opts.DefinitionOwnersFile = Args.getLastArgValue(OPT_fdefinition_owners_EQ);
+  Opts.CodeGenShards =
+      getLastArgIntValue(Args, OPT_fcodegen_shards_EQ, 0, Diags);
+  Opts.CodeGenShard = getLastArgIntValue(Args, OPT_fcodegen_shard_EQ, 0, Diags);
+  Opts.BackendCachePath = Args.getLastArgValue(OPT_fbackend_cache_path_EQ);
+  Opts.ParallelCodeGen =
+      getLastArgIntValue(Args, OPT_fparallel_codegen_EQ, 0, Diags);
+  Opts.ParallelCodeGenLinker =
+      Args.getLastArgValue(OPT_fparallel_codegen_linker_EQ);
+  Opts.StreamingCodeGen = Args.hasArg(OPT_fstreaming_codegen);
+  if (Opts.CodeGenShards && Opts.CodeGenShard >= Opts.CodeGenShards) {
+    Diags.Report(diag::err_drv_invalid_value)
+        << Args.getLastArg(OPT_fcodegen_shard_EQ)->getAsString(Args)
+        << Opts.CodeGenShard;
+    Success = false;
+  }
+  Opts.DefinitionOwner = Args.getLastArgValue(OPT_fdefinition_owner_EQ);
+  Opts.DebugTypeOwnersFile = Args.getLastArgValue(OPT_fdebug_type_owners_EQ);
   Opts.VerifyModule = !Args.hasArg(OPT_disable_llvm_verifier);
 
   Opts.DisableGCov = Args.hasArg(OPT_test_coverage);
@@ -857,6 +905,7 @@ static void ParseDependencyOutputArgs(DependencyOutputOptions &Opts,
   Opts.UsePhonyTargets = Args.hasArg(OPT_MP);
   Opts.ShowHeaderIncludes = Args.hasArg(OPT_H);
   Opts.HeaderIncludeOutputFile = Args.getLastArgValue(OPT_header_include_file);
+  Opts.HeaderCostReportFile = Args.getLastArgValue(OPT_fheader_cost_report_EQ);
   Opts.AddMissingHeaderDeps = Args.hasArg(OPT_MG);
   Opts.PrintShowIncludes = Args.hasArg(OPT_show_includes);
   Opts.DOTOutputFile = Args.getLastArgValue(OPT_dependency_dot);
@@ -1022,6 +1071,8 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
   Opts.SpellCheckingLimit = getLastArgIntValue(
       Args, OPT_fspell_checking_limit,
       DiagnosticOptions::DefaultSpellCheckingLimit, Diags);
+  Opts.SpellCheckingBudget =
+      getLastArgIntValue(Args, OPT_fspell_checking_budget, 0, Diags);
   Opts.TabStop = getLastArgIntValue(Args, OPT_ftabstop,
                                     DiagnosticOptions::DefaultTabStop, Diags);
   if (Opts.TabStop == 0 || Opts.TabStop > DiagnosticOptions::MaxTabStop) {
@@ -1039,6 +1090,8 @@ bool clang::ParseDiagnosticArgs(DiagnosticOptions &Opts, ArgList &Args,
 
 static void ParseFileSystemArgs(FileSystemOptions &Opts, ArgList &Args) {
   Opts.WorkingDir = Args.getLastArgValue(OPT_working_directory);
+  Opts.SharedStatCachePath = Args.getLastArgValue(OPT_shared_stat_cache);
+  Opts.PrefetchFileList = Args.getLastArgValue(OPT_fprefetch_deps_EQ);
 }
 
 /// Parse the argument to the -ftest-module-file-extension
@@ -1183,7 +1236,12 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.RelocatablePCH = Args.hasArg(OPT_relocatable_pch);
   Opts.ShowHelp = Args.hasArg(OPT_help);
   Opts.ShowStats = Args.hasArg(OPT_print_stats);
+  Opts.SkipHeaderFunctionBodies =
+      Args.hasArg(OPT_fskip_function_bodies_in_headers);
   Opts.ShowTimers = Args.hasArg(OPT_ftime_report);
+  Opts.TimeTrace = Args.hasArg(OPT_ftime_trace);
+  Opts.TimeTraceGranularity = getLastArgIntValue(
+      Args, OPT_ftime_trace_granularity_EQ, Opts.TimeTraceGranularity, Diags);
   Opts.ShowVersion = Args.hasArg(OPT_version);
   Opts.ASTMergeFiles = Args.getAllArgValues(OPT_ast_merge);
   Opts.LLVMArgs = Args.getAllArgValues(OPT_mllvm);
@@ -1200,7 +1258,10 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
   Opts.ModuleFiles = Args.getAllArgValues(OPT_fmodule_file);
   Opts.ModulesEmbedFiles = Args.getAllArgValues(OPT_fmodules_embed_file_EQ);
   Opts.ModulesEmbedAllFiles = Args.hasArg(OPT_fmodules_embed_all_files);
+  Opts.ModulesEmbedStorePath =
+      Args.getLastArgValue(OPT_fmodules_embed_store_EQ);
   Opts.IncludeTimestamps = !Args.hasArg(OPT_fno_pch_timestamp);
+  Opts.CompressASTTables = Args.hasArg(OPT_fcompress_ast_tables);
 
   Opts.CodeCompleteOpts.IncludeMacros
     = Args.hasArg(OPT_code_completion_macros);
@@ -1210,12 +1271,16 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     = !Args.hasArg(OPT_no_code_completion_globals);
   Opts.CodeCompleteOpts.IncludeBriefComments
     = Args.hasArg(OPT_code_completion_brief_comments);
+  Opts.CodeCompleteOpts.FilterByTypedText
+    = Args.hasArg(OPT_code_completion_filter_typed_text);
 
   Opts.OverrideRecordLayoutsFile
     = Args.getLastArgValue(OPT_foverride_record_layout_EQ);
+  Opts.MemoryReportPath = Args.getLastArgValue(OPT_fmemory_report_EQ);
   Opts.AuxTriple =
       llvm::Triple::normalize(Args.getLastArgValue(OPT_aux_triple));
   Opts.FindPchSource = Args.getLastArgValue(OPT_find_pch_source_EQ);
+  Opts.IndexStorePath = Args.getLastArgValue(OPT_index_store_path);
 
   if (const Arg *A = Args.getLastArg(OPT_arcmt_check,
                                      OPT_arcmt_modify,
@@ -1327,6 +1392,16 @@ static InputKind ParseFrontendArgs(FrontendOptions &Opts, ArgList &Args,
     Opts.Inputs.emplace_back(std::move(Inputs[i]), IK);
   }
 
+  // Several inputs with an output each are compiled as a batch.
+  std::vector<std::string> OutputFiles = Args.getAllArgValues(OPT_o);
+  if (OutputFiles.size() > 1) {
+    if (OutputFiles.size() != Opts.Inputs.size())
+      Diags.Report(diag::err_fe_batch_output_count)
+          << unsigned(OutputFiles.size()) << unsigned(Opts.Inputs.size());
+    else
+      Opts.BatchOutputFiles = std::move(OutputFiles);
+  }
+
   return DashX;
 }
 
@@ -1371,8 +1446,12 @@ static void ParseHeaderSearchArgs(HeaderSearchOptions &Opts, ArgList &Args) {
       Args.hasArg(OPT_fmodules_validate_once_per_build_session);
   Opts.BuildSessionTimestamp =
       getLastArgUInt64Value(Args, OPT_fbuild_session_timestamp, 0);
+  Opts.PCHValidationCachePath =
+      Args.getLastArgValue(OPT_fpch_validation_cache_EQ);
   Opts.ModulesValidateSystemHeaders =
       Args.hasArg(OPT_fmodules_validate_system_headers);
+  Opts.AssumeStableSearchDirs =
+      Args.hasArg(OPT_fassume_stable_header_search_dirs);
   if (const Arg *A = Args.getLastArg(OPT_fmodule_format_EQ))
     Opts.ModuleFormat = A->getValue();
 
@@ -1555,9 +1634,15 @@ void CompilerInvocation::setLangDefaults(LangOptions &Opts, InputKind IK,
     Opts.DefaultFPContract = 1;
     Opts.NativeHalfType = 1;
     Opts.NativeHalfArgsAndReturns = 1;
-    // Include default header file for OpenCL.
+    // Include default header file for OpenCL. When the builtin functions are
+    // declared on demand, only its types and macros are needed. The table of
+    // builtins only describes OpenCL 1.x, so OpenCL 2.0 still gets them all
+    // from opencl-c.h.
     if (Opts.IncludeDefaultHeader) {
-      PPOpts.Includes.push_back("opencl-c.h");
+      if (Opts.DeclareOpenCLBuiltins && Opts.OpenCLVersion < 200)
+        PPOpts.Includes.push_back("opencl-c-base.h");
+      else
+        PPOpts.Includes.push_back("opencl-c.h");
     }
   }
 
@@ -1678,6 +1763,7 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
   }
 
   Opts.IncludeDefaultHeader = Args.hasArg(OPT_finclude_default_header);
+  Opts.DeclareOpenCLBuiltins = Args.hasArg(OPT_fdeclare_opencl_builtins);
 
   llvm::Triple T(TargetOpts.Triple);
   CompilerInvocation::setLangDefaults(Opts, IK, T, PPOpts, LangStd);
@@ -1878,6 +1964,11 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       Args.hasArg(OPT_fmodules_decluse) || Opts.ModulesStrictDeclUse;
   Opts.ModulesLocalVisibility =
       Args.hasArg(OPT_fmodules_local_submodule_visibility);
+  Opts.ModulesCodegen = Args.hasArg(OPT_fmodules_codegen);
+  // Which NEON intrinsics arm_neon.h enabled is not recorded in AST files,
+  // so define them all up front when building one.
+  Opts.LazyNeonIntrinsics = Args.hasArg(OPT_flazy_neon_intrinsics) &&
+                            !Opts.Modules && !Args.hasArg(OPT_emit_pch);
   Opts.ModulesSearchAll = Opts.Modules &&
     !Args.hasArg(OPT_fno_modules_search_all) &&
     Args.hasArg(OPT_fmodules_search_all);
@@ -1906,8 +1997,12 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       getLastArgIntValue(Args, OPT_fconstexpr_depth, 512, Diags);
   Opts.ConstexprStepLimit =
       getLastArgIntValue(Args, OPT_fconstexpr_steps, 1048576, Diags);
+  Opts.ConstexprMemoizeCalls = Args.hasArg(OPT_fconstexpr_memoize_calls);
+  Opts.AnalysisCFGBlockLimit =
+      getLastArgIntValue(Args, OPT_fanalysis_cfg_block_limit, 0, Diags);
   Opts.BracketDepth = getLastArgIntValue(Args, OPT_fbracket_depth, 256, Diags);
   Opts.DelayedTemplateParsing = Args.hasArg(OPT_fdelayed_template_parsing);
+  Opts.PCHInstantiateTemplates = Args.hasArg(OPT_fpch_instantiate_templates);
   Opts.NumLargeByValueCopy =
       getLastArgIntValue(Args, OPT_Wlarge_by_value_copy_EQ, 0, Diags);
   Opts.MSBitfields = Args.hasArg(OPT_mms_bitfields);
@@ -2057,6 +2152,13 @@ static void ParseLangArgs(LangOptions &Opts, ArgList &Args, InputKind IK,
       Opts.OpenMP && !Args.hasArg(options::OPT_fnoopenmp_use_tls);
   Opts.OpenMPIsDevice =
       Opts.OpenMP && Args.hasArg(options::OPT_fopenmp_is_device);
+  Opts.OpenMPAtomicReductions =
+      Opts.OpenMP && Args.hasArg(options::OPT_fopenmp_atomic_reductions);
+  Opts.OpenMPInlineStaticSchedule =
+      Opts.OpenMP && Args.hasArg(options::OPT_fopenmp_inline_static_schedule);
+  Opts.OpenMPNVPTXSkipWorkerLoop =
+      Opts.OpenMPIsDevice &&
+      Args.hasArg(options::OPT_fopenmp_nvptx_skip_worker_loop);
 
   if (Opts.OpenMP) {
     int Version =
@@ -2160,11 +2262,18 @@ static void ParsePreprocessorArgs(PreprocessorOptions &Opts, ArgList &Args,
       Opts.TokenCache = A->getValue();
   else
     Opts.TokenCache = Opts.ImplicitPTHInclude;
+  Opts.TokenCacheDir = Args.getLastArgValue(OPT_token_cache_dir);
   Opts.UsePredefines = !Args.hasArg(OPT_undef);
   Opts.DetailedRecord = Args.hasArg(OPT_detailed_preprocessing_record);
+  Opts.CoalesceMacroArgExpansions =
+      Args.hasArg(OPT_coalesce_macro_arg_expansions);
+  Opts.MinimizeSourceToDependencyDirectives =
+      Args.hasArg(OPT_minimize_source_to_dependency_directives);
   Opts.DisablePCHValidation = Args.hasArg(OPT_fno_validate_pch);
 
   Opts.DumpDeserializedPCHDecls = Args.hasArg(OPT_dump_deserialized_pch_decls);
+  Opts.DeclPrefetchThreads =
+      getLastArgIntValue(Args, OPT_decl_prefetch_threads, 0, Diags);
   for (const Arg *A : Args.filtered(OPT_error_on_deserialized_pch_decl))
     Opts.DeserializedPCHDeclsToErrorOn.insert(A->getValue());
 
@@ -2275,6 +2384,7 @@ static void ParsePreprocessorOutputArgs(PreprocessorOutputOptions &Opts,
   Opts.ShowMacroComments = Args.hasArg(OPT_CC);
   Opts.ShowMacros = Args.hasArg(OPT_dM) || Args.hasArg(OPT_dD);
   Opts.RewriteIncludes = Args.hasArg(OPT_frewrite_includes);
+  Opts.CompressOutput = Args.hasArg(OPT_fcompress_preprocessed_output);
   Opts.UseLineDirectives = Args.hasArg(OPT_fuse_line_directives);
 }
 
@@ -2348,6 +2458,13 @@ bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
   Success &= ParseCodeGenArgs(Res.getCodeGenOpts(), Args, DashX, Diags,
                               Res.getTargetOpts());
   ParseHeaderSearchArgs(Res.getHeaderSearchOpts(), Args);
+  // The dependency file is written per compile, so a batch cannot have one.
+  if (!Res.getFrontendOpts().BatchOutputFiles.empty() &&
+      !Res.getDependencyOutputOpts().OutputFile.empty()) {
+    Diags.Report(diag::err_drv_argument_not_allowed_with)
+        << "-dependency-file" << "several -o";
+    Success = false;
+  }
   if (DashX == IK_AST || DashX == IK_LLVM_IR) {
     // ObjCAAutoRefCount and Sanitize LangOpts are used to setup the
     // PassManager in BackendUtil.cpp. They need to be initializd no matter
@@ -2397,6 +2514,158 @@ bool CompilerInvocation::CreateFromArgs(CompilerInvocation &Res,
   return Success;
 }
 
+namespace {
+/// The arguments of a compile that name its own files.
+struct PerCompileArgs {
+  std::vector<std::string> Inputs;
+  std::string OutputFile;
+  std::string MainFileName;
+  std::string DependencyFile;
+  std::vector<std::string> DependencyTargets;
+  std::string CoverageFile;
+};
+
+/// The invocations parsed by CreateFromArgsCached, keyed by their arguments
+/// other than the PerCompileArgs.
+struct ParsedInvocationCache {
+  std::mutex Mutex;
+  llvm::StringMap<std::unique_ptr<CompilerInvocation>> Invocations;
+};
+}
+
+static llvm::ManagedStatic<ParsedInvocationCache> ParsedInvocations;
+
+/// The most invocations kept by CreateFromArgsCached.
+static const unsigned MaxParsedInvocations = 64;
+
+/// Renders \p Args other than the PerCompileArgs into \p Key, and collects
+/// the PerCompileArgs into \p Files. Returns false if the invocation they
+/// make must not be reused.
+static bool getParsedInvocationKey(const ArgList &Args, std::string &Key,
+                                   PerCompileArgs &Files) {
+  for (const Arg *A : Args) {
+    switch (A->getOption().getID()) {
+    case OPT_INPUT:
+      Files.Inputs.push_back(A->getValue());
+      // The kind of an input depends on its extension.
+      Key += "<input>.";
+      Key += StringRef(A->getValue()).rsplit('.').second;
+      break;
+    case OPT_o:
+      // Several outputs make a batch.
+      if (!Files.OutputFile.empty())
+        return false;
+      Files.OutputFile = A->getValue();
+      Key += "-o";
+      break;
+    case OPT_main_file_name:
+      Files.MainFileName = A->getValue();
+      Key += "-main-file-name";
+      break;
+    case OPT_dependency_file:
+      Files.DependencyFile = A->getValue();
+      Key += "-dependency-file";
+      break;
+    case OPT_MT:
+      Files.DependencyTargets.push_back(A->getValue());
+      Key += "-MT";
+      break;
+    case OPT_coverage_file:
+      Files.CoverageFile = A->getValue();
+      Key += "-coverage-file";
+      break;
+    // The kind of profile is read from the profile itself.
+    case OPT_fprofile_instrument_use_path_EQ:
+    // The rendered arguments are embedded as they are.
+    case OPT_fembed_bitcode_EQ:
+      return false;
+    default:
+      ArgStringList Rendered;
+      A->render(Args, Rendered);
+      for (const char *Part : Rendered) {
+        Key += Part;
+        Key += '\0';
+      }
+      continue;
+    }
+    Key += '\0';
+  }
+  return true;
+}
+
+bool CompilerInvocation::CreateFromArgsCached(CompilerInvocation &Res,
+                                              const char *const *ArgBegin,
+                                              const char *const *ArgEnd,
+                                              DiagnosticsEngine &Diags) {
+  std::unique_ptr<OptTable> Opts(createDriverOptTable());
+  unsigned MissingArgIndex, MissingArgCount;
+  InputArgList Args =
+      Opts->ParseArgs(llvm::makeArrayRef(ArgBegin, ArgEnd), MissingArgIndex,
+                      MissingArgCount, options::CC1Option);
+  std::string Key;
+  PerCompileArgs Files;
+  if (MissingArgCount || !getParsedInvocationKey(Args, Key, Files))
+    return CreateFromArgs(Res, ArgBegin, ArgEnd, Diags);
+
+  std::unique_lock<std::mutex> Lock(ParsedInvocations->Mutex);
+  auto Known = ParsedInvocations->Invocations.find(Key);
+  if (Known == ParsedInvocations->Invocations.end()) {
+    Lock.unlock();
+    // Reusing an invocation would drop the diagnostics its arguments produce,
+    // and some errors leave it half-parsed without failing. Parse against
+    // diagnostics of our own, and only keep the invocation if there are none;
+    // otherwise parse again to report them to the caller.
+    IntrusiveRefCntPtr<DiagnosticOptions> CleanDiagOpts =
+        new DiagnosticOptions();
+    DiagnosticsEngine CleanDiags(new DiagnosticIDs(), &*CleanDiagOpts,
+                                 new IgnoringDiagConsumer());
+    auto Parsed = llvm::make_unique<CompilerInvocation>();
+    if (!CreateFromArgs(*Parsed, ArgBegin, ArgEnd, CleanDiags) ||
+        CleanDiags.hasErrorOccurred() || CleanDiags.getNumWarnings())
+      return CreateFromArgs(Res, ArgBegin, ArgEnd, Diags);
+
+    Lock.lock();
+    if (ParsedInvocations->Invocations.size() >= MaxParsedInvocations)
+      ParsedInvocations->Invocations.clear();
+    ParsedInvocations->Invocations[Key] = std::move(Parsed);
+    Known = ParsedInvocations->Invocations.find(Key);
+  }
+
+  // Copy the options of the earlier invocation. The option objects that are
+  // reference counted are copied afresh, so that each compile has its own.
+  const CompilerInvocation &Parsed = *Known->second;
+  Res.LangOpts = std::make_shared<LangOptions>(*Parsed.getLangOpts());
+  Res.TargetOpts = std::make_shared<TargetOptions>(Parsed.getTargetOpts());
+  Res.DiagnosticOpts = new DiagnosticOptions(Parsed.getDiagnosticOpts());
+  Res.HeaderSearchOpts = new HeaderSearchOptions(Parsed.getHeaderSearchOpts());
+  Res.PreprocessorOpts = new PreprocessorOptions(Parsed.getPreprocessorOpts());
+  Res.AnalyzerOpts = new AnalyzerOptions(*Parsed.getAnalyzerOpts());
+  Res.MigratorOpts = Parsed.MigratorOpts;
+  Res.CodeGenOpts = Parsed.CodeGenOpts;
+  Res.DependencyOutputOpts = Parsed.DependencyOutputOpts;
+  Res.FileSystemOpts = Parsed.FileSystemOpts;
+  Res.FrontendOpts = Parsed.FrontendOpts;
+  Res.PreprocessorOutputOpts = Parsed.PreprocessorOutputOpts;
+  Lock.unlock();
+
+  // Then put in the files of this compile.
+  FrontendOptions &FrontendOpts = Res.getFrontendOpts();
+  for (unsigned I = 0, E = Files.Inputs.size(); I != E; ++I) {
+    const FrontendInputFile &Input = FrontendOpts.Inputs[I];
+    FrontendOpts.Inputs[I] =
+        FrontendInputFile(Files.Inputs[I], Input.getKind(), Input.isSystem());
+  }
+  FrontendOpts.OutputFile = Files.OutputFile;
+  CodeGenOptions &CodeGenOpts = Res.getCodeGenOpts();
+  CodeGenOpts.MainFileName = Files.MainFileName;
+  if (CodeGenOpts.EmitGcovArcs || CodeGenOpts.EmitGcovNotes)
+    CodeGenOpts.CoverageFile = Files.CoverageFile;
+  DependencyOutputOptions &DepOpts = Res.getDependencyOutputOpts();
+  DepOpts.OutputFile = Files.DependencyFile;
+  DepOpts.Targets = Files.DependencyTargets;
+  return true;
+}
+
 std::string CompilerInvocation::getModuleHash() const {
   // Note: For QoI reasons, the things we use as a hash here should all be
   // dumped via the -module-info flag.
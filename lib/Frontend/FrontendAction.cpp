@@ -29,6 +29,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 #include <system_error>
 using namespace clang;
 
@@ -186,6 +187,47 @@ FrontendAction::CreateWrappedASTConsumer(CompilerInstance &CI,
   return llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
 }
 
+/// \brief If the OpenCL default header is included implicitly, look for a PCH
+/// of it in the pch/opencl-c directory of the resource directory that was
+/// built for a compatible target, language and preprocessor configuration,
+/// and use it instead of parsing the header.
+static void useBuiltinOpenCLHeaderPCH(CompilerInstance &CI) {
+  const LangOptions &LangOpts = CI.getLangOpts();
+  const HeaderSearchOptions &HSOpts = CI.getHeaderSearchOpts();
+  PreprocessorOptions &PPOpts = CI.getPreprocessorOpts();
+  if (!LangOpts.OpenCL || !LangOpts.IncludeDefaultHeader || LangOpts.Modules ||
+      !HSOpts.UseBuiltinIncludes || HSOpts.ResourceDir.empty() ||
+      !PPOpts.ImplicitPCHInclude.empty() || !PPOpts.ImplicitPTHInclude.empty())
+    return;
+
+  auto Header =
+      std::find(PPOpts.Includes.begin(), PPOpts.Includes.end(), "opencl-c.h");
+  if (Header == PPOpts.Includes.end())
+    return;
+
+  SmallString<128> PCHDir(HSOpts.ResourceDir);
+  llvm::sys::path::append(PCHDir, "pch", "opencl-c");
+  llvm::sys::path::native(PCHDir);
+  if (!llvm::sys::fs::is_directory(PCHDir))
+    return;
+
+  FileManager &FileMgr = CI.getFileManager();
+  std::string SpecificModuleCachePath = CI.getSpecificModuleCachePath();
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator Dir(PCHDir, EC), DirEnd;
+       Dir != DirEnd && !EC; Dir.increment(EC)) {
+    if (llvm::sys::path::extension(Dir->path()) != ".pch")
+      continue;
+    if (ASTReader::isAcceptableASTFile(
+            Dir->path(), FileMgr, CI.getPCHContainerReader(), LangOpts,
+            CI.getTargetOpts(), PPOpts, SpecificModuleCachePath)) {
+      PPOpts.Includes.erase(Header);
+      PPOpts.ImplicitPCHInclude = Dir->path();
+      return;
+    }
+  }
+}
+
 bool FrontendAction::BeginSourceFile(CompilerInstance &CI,
                                      const FrontendInputFile &Input) {
   assert(!Instance && "Already processing a source file!");
@@ -275,6 +317,10 @@ bool FrontendAction::BeginSourceFile(CompilerInstance &CI,
     return true;
   }
 
+  // Parse the OpenCL default header from a prebuilt PCH when there is one.
+  if (getTranslationUnitKind() == TU_Complete && !usesPreprocessorOnly())
+    useBuiltinOpenCLHeaderPCH(CI);
+
   // If the implicit PCH include is actually a directory, rather than
   // a single file, search for a suitable PCH file in that directory.
   if (!CI.getPreprocessorOpts().ImplicitPCHInclude.empty()) {
@@ -477,12 +523,21 @@ void FrontendAction::EndSourceFile() {
   CI.getDiagnosticClient().EndSourceFile();
 
   // Inform the preprocessor we are done.
-  if (CI.hasPreprocessor())
+  if (CI.hasPreprocessor()) {
     CI.getPreprocessor().EndSourceFile();
 
+    // Share the tokens of any newly seen headers with later compiles.
+    if (CI.getPreprocessor().getTokenCache())
+      UpdateTokenCache(CI.getPreprocessor());
+  }
+
   // Finalize the action.
   EndSourceFileAction();
 
+  // Report memory use while the AST is still around.
+  if (!CI.getFrontendOpts().MemoryReportPath.empty())
+    WriteMemoryReport(CI, CI.getFrontendOpts().MemoryReportPath);
+
   // Sema references the ast consumer, so reset sema first.
   //
   // FIXME: There is more per-file stuff we could just drop here?
@@ -553,8 +608,12 @@ void ASTFrontendAction::ExecuteAction() {
   if (!CI.hasSema())
     CI.createSema(getTranslationUnitKind(), CompletionConsumer);
 
-  ParseAST(CI.getSema(), CI.getFrontendOpts().ShowStats,
-           CI.getFrontendOpts().SkipFunctionBodies);
+  const FrontendOptions &FEOpts = CI.getFrontendOpts();
+  if (FEOpts.SkipHeaderFunctionBodies && !FEOpts.SkipFunctionBodies)
+    CI.getSema().SkipMainFileFunctionBodies = false;
+
+  ParseAST(CI.getSema(), FEOpts.ShowStats,
+           FEOpts.SkipFunctionBodies || FEOpts.SkipHeaderFunctionBodies);
 }
 
 void PluginASTAction::anchor() { }
@@ -95,7 +95,9 @@ GeneratePCHAction::CreateASTConsumer(CompilerInstance &CI, StringRef InFile) {
                         Buffer, CI.getFrontendOpts().ModuleFileExtensions,
                         /*AllowASTWithErrors*/false,
                         /*IncludeTimestamps*/
-                          +CI.getFrontendOpts().IncludeTimestamps));
+                          +CI.getFrontendOpts().IncludeTimestamps,
+                        /*CompressTables=*/
+                          +CI.getFrontendOpts().CompressASTTables));
   Consumers.push_back(CI.getPCHContainerWriter().CreatePCHContainerGenerator(
       CI, InFile, OutputFile, OS, Buffer));
 
@@ -143,7 +145,10 @@ GenerateModuleAction::CreateASTConsumer(CompilerInstance &CI,
                         Buffer, CI.getFrontendOpts().ModuleFileExtensions,
                         /*AllowASTWithErrors=*/false,
                         /*IncludeTimestamps=*/
-                          +CI.getFrontendOpts().BuildingImplicitModule));
+                          +CI.getFrontendOpts().BuildingImplicitModule,
+                        /*CompressTables=*/
+                          +CI.getFrontendOpts().CompressASTTables,
+                        CI.getFrontendOpts().ModulesEmbedStorePath));
   Consumers.push_back(CI.getPCHContainerWriter().CreatePCHContainerGenerator(
       CI, InFile, OutputFile, OS, Buffer));
   return llvm::make_unique<MultiplexConsumer>(std::move(Consumers));
@@ -712,11 +717,22 @@ void PrintPreprocessedAction::ExecuteAction() {
     }
   }
 
+  const PreprocessorOutputOptions &Opts = CI.getPreprocessorOutputOpts();
+  if (Opts.CompressOutput)
+    BinaryMode = true;
+
   raw_ostream *OS = CI.createDefaultOutputFile(BinaryMode, getCurrentFile());
   if (!OS) return;
 
-  DoPrintPreprocessedInput(CI.getPreprocessor(), OS,
-                           CI.getPreprocessorOutputOpts());
+  if (!Opts.CompressOutput) {
+    DoPrintPreprocessedInput(CI.getPreprocessor(), OS, Opts);
+    return;
+  }
+
+  SmallString<0> Output;
+  llvm::raw_svector_ostream OutputOS(Output);
+  DoPrintPreprocessedInput(CI.getPreprocessor(), &OutputOS, Opts);
+  WriteCompressedPreprocessedOutput(CI.getDiagnostics(), Output, *OS);
 }
 
 void PrintPreambleAction::ExecuteAction() {
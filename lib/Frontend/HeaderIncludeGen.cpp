@@ -13,7 +13,10 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Lex/Preprocessor.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
 using namespace clang;
 
 namespace {
@@ -164,3 +167,141 @@ void HeaderIncludesCallback::FileChanged(SourceLocation Loc,
                     MSStyle);
   }
 }
+
+namespace {
+/// Measures the time spent in each file the preprocessor enters, and the
+/// number of tokens lexed there.
+///
+/// The parser pulls tokens from the preprocessor as it goes, so the time of
+/// a file is that of lexing, preprocessing, parsing and analyzing its
+/// contents. Only the time of lexing and preprocessing it is measured in
+/// -E mode.
+class HeaderCostReportCallback : public PPCallbacks {
+  typedef std::chrono::steady_clock Clock;
+
+  struct FileCost {
+    unsigned Includes = 0;
+    unsigned Skipped = 0;
+    unsigned SelfTokens = 0;
+    unsigned TotalTokens = 0;
+    Clock::duration SelfTime = Clock::duration::zero();
+    Clock::duration TotalTime = Clock::duration::zero();
+    /// How many times the file is on the include stack right now. A file
+    /// that includes itself only counts once towards its total.
+    unsigned Depth = 0;
+  };
+
+  struct OpenFile {
+    FileCost *Cost;
+    Clock::time_point Start;
+    unsigned StartTokens;
+  };
+
+  Preprocessor &PP;
+  std::string OutputPath;
+  llvm::StringMap<FileCost> Costs;
+  std::vector<OpenFile> IncludeStack;
+  Clock::time_point LastChange;
+  unsigned LastChangeTokens = 0;
+
+  /// Charge the time and tokens since the last change of file to the file on
+  /// top of the include stack.
+  void chargeCurrentFile(Clock::time_point Now) {
+    if (!IncludeStack.empty()) {
+      FileCost &Cost = *IncludeStack.back().Cost;
+      Cost.SelfTime += Now - LastChange;
+      Cost.SelfTokens += PP.getTokenCount() - LastChangeTokens;
+    }
+    LastChange = Now;
+    LastChangeTokens = PP.getTokenCount();
+  }
+
+  void exitFile(Clock::time_point Now) {
+    OpenFile &File = IncludeStack.back();
+    if (--File.Cost->Depth == 0) {
+      File.Cost->TotalTime += Now - File.Start;
+      File.Cost->TotalTokens += PP.getTokenCount() - File.StartTokens;
+    }
+    IncludeStack.pop_back();
+  }
+
+  void writeReport();
+
+public:
+  HeaderCostReportCallback(Preprocessor &PP, StringRef OutputPath)
+      : PP(PP), OutputPath(OutputPath) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    Clock::time_point Now = Clock::now();
+    if (Reason == EnterFile) {
+      chargeCurrentFile(Now);
+      FileCost &Cost = Costs[PP.getSourceManager().getBufferName(Loc)];
+      ++Cost.Includes;
+      ++Cost.Depth;
+      OpenFile File = {&Cost, Now, PP.getTokenCount()};
+      IncludeStack.push_back(File);
+    } else if (Reason == ExitFile && !IncludeStack.empty()) {
+      chargeCurrentFile(Now);
+      exitFile(Now);
+    }
+  }
+
+  void FileSkipped(const FileEntry &SkippedFile, const Token &FilenameTok,
+                   SrcMgr::CharacteristicKind FileType) override {
+    ++Costs[SkippedFile.getName()].Skipped;
+  }
+
+  void EndOfMainFile() override {
+    Clock::time_point Now = Clock::now();
+    chargeCurrentFile(Now);
+    while (!IncludeStack.empty())
+      exitFile(Now);
+    writeReport();
+  }
+};
+}
+
+/// Writes one line per file, most expensive first, with the time spent in
+/// the file itself and in everything it includes, in microseconds, the same
+/// for tokens, and how many times the file was entered and skipped because
+/// of include guards or #pragma once.
+void HeaderCostReportCallback::writeReport() {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(OutputPath, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    PP.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << OutputPath << EC.message();
+    return;
+  }
+
+  std::vector<llvm::StringMapEntry<FileCost> *> Files;
+  for (auto &Entry : Costs)
+    Files.push_back(&Entry);
+  std::sort(Files.begin(), Files.end(),
+            [](const llvm::StringMapEntry<FileCost> *LHS,
+               const llvm::StringMapEntry<FileCost> *RHS) {
+              if (LHS->second.SelfTime != RHS->second.SelfTime)
+                return LHS->second.SelfTime > RHS->second.SelfTime;
+              return LHS->first() < RHS->first();
+            });
+
+  auto Microseconds = [](Clock::duration D) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(D).count();
+  };
+  OS << "# self-us\ttotal-us\tself-tokens\ttotal-tokens\tincludes\tskipped"
+        "\tfile\n";
+  for (const llvm::StringMapEntry<FileCost> *File : Files) {
+    const FileCost &Cost = File->second;
+    OS << Microseconds(Cost.SelfTime) << '\t' << Microseconds(Cost.TotalTime)
+       << '\t' << Cost.SelfTokens << '\t' << Cost.TotalTokens << '\t'
+       << Cost.Includes << '\t' << Cost.Skipped << '\t' << File->first()
+       << '\n';
+  }
+}
+
+void clang::AttachHeaderCostReportGen(Preprocessor &PP, StringRef OutputPath) {
+  PP.addPPCallbacks(
+      llvm::make_unique<HeaderCostReportCallback>(PP, OutputPath));
+}
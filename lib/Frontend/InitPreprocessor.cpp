@@ -26,8 +26,10 @@
 #include "clang/Serialization/ASTReader.h"
 #include "llvm/ADT/APFloat.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
+#include <mutex>
 using namespace clang;
 
 static bool MacroBodyEndsInBackslash(StringRef MacroBody) {
@@ -968,18 +970,13 @@ static void InitializePredefinedMacros(const TargetInfo &TI,
   TI.getTargetDefines(LangOpts, Builder);
 }
 
-/// InitializePreprocessor - Initialize the preprocessor getting it and the
-/// environment ready to process a single file. This returns true on error.
-///
-void clang::InitializePreprocessor(
-    Preprocessor &PP, const PreprocessorOptions &InitOpts,
-    const PCHContainerReader &PCHContainerRdr,
-    const FrontendOptions &FEOpts) {
+/// Add the <built-in> predefines, which only depend on the target and the
+/// options, to \p Builder.
+static void InitializeBuiltinPredefines(const Preprocessor &PP,
+                                        const PreprocessorOptions &InitOpts,
+                                        const FrontendOptions &FEOpts,
+                                        MacroBuilder &Builder) {
   const LangOptions &LangOpts = PP.getLangOpts();
-  std::string PredefineBuffer;
-  PredefineBuffer.reserve(4080);
-  llvm::raw_string_ostream Predefines(PredefineBuffer);
-  MacroBuilder Builder(Predefines);
 
   // Emit line markers for various builtin sections of the file.  We don't do
   // this in asm preprocessor mode, because "# 4" is not a line marker directive
@@ -1016,6 +1013,81 @@ void clang::InitializePreprocessor(
   // current language configuration.
   InitializeStandardPredefinedMacros(PP.getTargetInfo(), PP.getLangOpts(),
                                      FEOpts, Builder);
+}
+
+/// Compute into \p Key everything that the <built-in> predefines depend on.
+/// Returns false if they cannot be cached.
+static bool getBuiltinPredefinesKey(const Preprocessor &PP,
+                                    const PreprocessorOptions &InitOpts,
+                                    const FrontendOptions &FEOpts,
+                                    std::string &Key) {
+  const LangOptions &LangOpts = PP.getLangOpts();
+  // The OpenCL extensions and the CUDA host target are not part of the key.
+  if (LangOpts.OpenCL || LangOpts.CUDA)
+    return false;
+
+  llvm::raw_string_ostream OS(Key);
+#define LANGOPT(Name, Bits, Default, Description) OS << LangOpts.Name << ' ';
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description)                   \
+  OS << unsigned(LangOpts.get##Name()) << ' ';
+#include "clang/Basic/LangOptions.def"
+  OS << LangOpts.Sanitize.Mask << ' ' << LangOpts.ObjCRuntime.getAsString()
+     << '\n';
+
+  const TargetOptions &TargetOpts = PP.getTargetInfo().getTargetOpts();
+  OS << TargetOpts.Triple << '\n' << TargetOpts.CPU << '\n'
+     << TargetOpts.FPMath << '\n' << TargetOpts.ABI << '\n'
+     << TargetOpts.EABIVersion << '\n' << TargetOpts.LinkerVersion << '\n';
+  for (const std::string &Feature : TargetOpts.Features)
+    OS << Feature << ' ';
+
+  OS << '\n' << unsigned(FEOpts.ProgramAction) << ' ' << InitOpts.UsePredefines
+     << ' ' << unsigned(InitOpts.ObjCXXARCStandardLibrary);
+  OS.flush();
+  return true;
+}
+
+namespace {
+/// The <built-in> predefines generated in this process, by key.
+struct BuiltinPredefinesCache {
+  std::mutex Mutex;
+  llvm::StringMap<std::string> Predefines;
+};
+}
+
+static llvm::ManagedStatic<BuiltinPredefinesCache> PredefinesCache;
+
+/// InitializePreprocessor - Initialize the preprocessor getting it and the
+/// environment ready to process a single file. This returns true on error.
+///
+void clang::InitializePreprocessor(
+    Preprocessor &PP, const PreprocessorOptions &InitOpts,
+    const PCHContainerReader &PCHContainerRdr,
+    const FrontendOptions &FEOpts) {
+  std::string PredefineBuffer;
+  PredefineBuffer.reserve(4080);
+  llvm::raw_string_ostream Predefines(PredefineBuffer);
+  MacroBuilder Builder(Predefines);
+
+  // A process running many compilations with the same options, such as a
+  // compile server or an IDE, generates the <built-in> predefines once.
+  std::string Key;
+  if (getBuiltinPredefinesKey(PP, InitOpts, FEOpts, Key)) {
+    std::lock_guard<std::mutex> Lock(PredefinesCache->Mutex);
+    auto Known = PredefinesCache->Predefines.find(Key);
+    if (Known == PredefinesCache->Predefines.end()) {
+      std::string Buffer;
+      llvm::raw_string_ostream OS(Buffer);
+      MacroBuilder BuiltinBuilder(OS);
+      InitializeBuiltinPredefines(PP, InitOpts, FEOpts, BuiltinBuilder);
+      OS.flush();
+      Known =
+          PredefinesCache->Predefines.insert(std::make_pair(Key, Buffer)).first;
+    }
+    Predefines << Known->second;
+  } else {
+    InitializeBuiltinPredefines(PP, InitOpts, FEOpts, Builder);
+  }
 
   // Add on the predefines from the driver.  Wrap in a #line directive to report
   // that they come from the command line.
@@ -0,0 +1,322 @@
+//===--- MemoryReport.cpp - Per-node-kind and per-file memory report ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the JSON memory report written by -fmemory-report=.
+//
+// The report gives the memory held by the main per-translation-unit
+// allocators, and attributes the AST nodes reachable from the translation
+// unit to their node kind and to the file in which they were written.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/Utils.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclFriend.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclOpenMP.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/ExprObjC.h"
+#include "clang/AST/ExprOpenMP.h"
+#include "clang/AST/StmtCXX.h"
+#include "clang/AST/StmtObjC.h"
+#include "clang/AST/StmtOpenMP.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+using namespace clang;
+
+namespace {
+
+/// \brief The number of nodes of one kind, or written in one file, and the
+/// bytes they occupy.
+struct NodeUsage {
+  uint64_t Count = 0;
+  uint64_t Bytes = 0;
+
+  void add(uint64_t NodeBytes) {
+    ++Count;
+    Bytes += NodeBytes;
+  }
+};
+
+/// \brief The AST nodes and source buffer attributed to one file.
+struct FileUsage {
+  NodeUsage Decls;
+  NodeUsage Stmts;
+  uint64_t BufferBytes = 0;
+};
+
+/// \brief Walks the declarations reachable from the translation unit,
+/// attributing each declaration and statement to its kind and to the file
+/// containing its expansion location.
+///
+/// Only nodes already in memory are visited; nothing is deserialized. The
+/// bytes of a node are the size of its class, and do not include trailing
+/// objects or the side tables of the ASTContext.
+class MemoryUsageCollector {
+  const SourceManager &SM;
+  llvm::SmallPtrSet<const Decl *, 256> VisitedDecls;
+
+public:
+  NodeUsage DeclKinds[Decl::lastDecl + 1];
+  NodeUsage StmtKinds[Stmt::lastStmtConstant + 1];
+  llvm::StringMap<FileUsage> Files;
+
+  explicit MemoryUsageCollector(const SourceManager &SM) : SM(SM) {}
+
+  void collectFileBuffers();
+  /// \brief Attributes \p D and everything reachable from it. The walk uses
+  /// explicit worklists, so deeply nested code cannot overflow the stack.
+  void visitDecl(const Decl *D);
+
+private:
+  SmallVector<const Decl *, 64> DeclWorklist;
+  SmallVector<const Stmt *, 64> StmtWorklist;
+
+  FileUsage &getFileUsage(SourceLocation Loc);
+  void visitStmts(const Stmt *S, FileUsage &File);
+  void visitOneDecl(const Decl *D);
+};
+
+} // end anonymous namespace
+
+static size_t getDeclClassSize(Decl::Kind K) {
+  switch (K) {
+#define DECL(DERIVED, BASE) case Decl::DERIVED: return sizeof(DERIVED##Decl);
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+  }
+  llvm_unreachable("unknown decl kind");
+}
+
+static size_t getStmtClassSize(Stmt::StmtClass SC) {
+  switch (SC) {
+  case Stmt::NoStmtClass:
+    break;
+#define STMT(CLASS, PARENT) case Stmt::CLASS##Class: return sizeof(CLASS);
+#define ABSTRACT_STMT(STMT)
+#include "clang/AST/StmtNodes.inc"
+  }
+  llvm_unreachable("unknown stmt class");
+}
+
+FileUsage &MemoryUsageCollector::getFileUsage(SourceLocation Loc) {
+  if (Loc.isInvalid())
+    return Files["<invalid>"];
+  FileID FID = SM.getFileID(SM.getExpansionLoc(Loc));
+  if (const FileEntry *FE = SM.getFileEntryForID(FID))
+    return Files[FE->getName()];
+  return Files[SM.getBufferName(SM.getLocForStartOfFile(FID))];
+}
+
+void MemoryUsageCollector::collectFileBuffers() {
+  for (SourceManager::fileinfo_iterator I = SM.fileinfo_begin(),
+                                        E = SM.fileinfo_end();
+       I != E; ++I)
+    if (unsigned Bytes = I->second->getSizeBytesMapped())
+      Files[I->first->getName()].BufferBytes += Bytes;
+}
+
+void MemoryUsageCollector::visitStmts(const Stmt *S, FileUsage &File) {
+  StmtWorklist.push_back(S);
+  while (!StmtWorklist.empty()) {
+    S = StmtWorklist.pop_back_val();
+    StmtKinds[S->getStmtClass()].add(getStmtClassSize(S->getStmtClass()));
+    File.Stmts.add(getStmtClassSize(S->getStmtClass()));
+    for (const Stmt *Child : S->children())
+      if (Child)
+        StmtWorklist.push_back(Child);
+  }
+}
+
+void MemoryUsageCollector::visitDecl(const Decl *D) {
+  DeclWorklist.push_back(D);
+  while (!DeclWorklist.empty()) {
+    D = DeclWorklist.pop_back_val();
+    if (VisitedDecls.insert(D).second)
+      visitOneDecl(D);
+  }
+}
+
+void MemoryUsageCollector::visitOneDecl(const Decl *D) {
+  FileUsage &File = getFileUsage(D->getLocation());
+  DeclKinds[D->getKind()].add(getDeclClassSize(D->getKind()));
+  File.Decls.add(getDeclClassSize(D->getKind()));
+
+  // Bodies and initializers of deserialized declarations may not have been
+  // loaded; leave them alone.
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+    if (!FD->isFromASTFile() && FD->doesThisDeclarationHaveABody())
+      if (const Stmt *Body = FD->getBody())
+        visitStmts(Body, File);
+  } else if (const VarDecl *VD = dyn_cast<VarDecl>(D)) {
+    if (!VD->isFromASTFile())
+      if (const Expr *Init = VD->getInit())
+        visitStmts(Init, File);
+  }
+
+  // Instantiations are not members of any DeclContext.
+  if (const TemplateDecl *TD = dyn_cast<TemplateDecl>(D))
+    if (const Decl *Templated = TD->getTemplatedDecl())
+      DeclWorklist.push_back(Templated);
+  if (const ClassTemplateDecl *CTD = dyn_cast<ClassTemplateDecl>(D))
+    for (const ClassTemplateSpecializationDecl *Spec : CTD->specializations())
+      DeclWorklist.push_back(Spec);
+  if (const FunctionTemplateDecl *FTD = dyn_cast<FunctionTemplateDecl>(D))
+    for (const FunctionDecl *Spec : FTD->specializations())
+      DeclWorklist.push_back(Spec);
+  if (const VarTemplateDecl *VTD = dyn_cast<VarTemplateDecl>(D))
+    for (const VarTemplateSpecializationDecl *Spec : VTD->specializations())
+      DeclWorklist.push_back(Spec);
+
+  if (const DeclContext *DC = dyn_cast<DeclContext>(D))
+    for (const Decl *Child : DC->noload_decls())
+      DeclWorklist.push_back(Child);
+}
+
+/// \brief Writes \p Str as a JSON string literal.
+static void writeJSONString(raw_ostream &OS, StringRef Str) {
+  OS << '"';
+  for (unsigned char C : Str) {
+    switch (C) {
+    case '"':  OS << "\\\""; break;
+    case '\\': OS << "\\\\"; break;
+    case '\n': OS << "\\n"; break;
+    case '\t': OS << "\\t"; break;
+    default:
+      if (C < 0x20)
+        OS << "\\u00" << llvm::hexdigit(C >> 4, true)
+           << llvm::hexdigit(C & 0xF, true);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+static void writeNodeUsage(raw_ostream &OS, const NodeUsage &Usage) {
+  OS << "{ \"count\": " << Usage.Count << ", \"bytes\": " << Usage.Bytes
+     << " }";
+}
+
+void clang::WriteMemoryReport(CompilerInstance &CI, StringRef OutputPath) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(OutputPath, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    CI.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << OutputPath << EC.message();
+    return;
+  }
+
+  const SourceManager *SM =
+      CI.hasSourceManager() ? &CI.getSourceManager() : nullptr;
+  OS << "{\n";
+  if (SM) {
+    OS << "  \"main_file\": ";
+    const FileEntry *Main = SM->getFileEntryForID(SM->getMainFileID());
+    writeJSONString(OS, Main ? Main->getName() : "");
+    OS << ",\n";
+  }
+
+  // The allocators of the translation unit as a whole.
+  OS << "  \"totals\": {\n";
+  bool First = true;
+  auto WriteTotal = [&](StringRef Name, uint64_t Bytes) {
+    if (!First)
+      OS << ",\n";
+    First = false;
+    OS << "    \"" << Name << "\": " << Bytes;
+  };
+  if (CI.hasASTContext()) {
+    ASTContext &Ctx = CI.getASTContext();
+    WriteTotal("ast_allocated_bytes", Ctx.getASTAllocatedMemory());
+    WriteTotal("ast_side_table_bytes", Ctx.getSideTableAllocatedMemory());
+  }
+  if (SM) {
+    SourceManager::MemoryBufferSizes Buffers = SM->getMemoryBufferSizes();
+    WriteTotal("source_buffer_malloc_bytes", Buffers.malloc_bytes);
+    WriteTotal("source_buffer_mmap_bytes", Buffers.mmap_bytes);
+    WriteTotal("source_manager_content_cache_bytes",
+               SM->getContentCacheSize());
+    WriteTotal("source_manager_data_structure_bytes",
+               SM->getDataStructureSizes());
+  }
+  if (CI.hasPreprocessor()) {
+    Preprocessor &PP = CI.getPreprocessor();
+    IdentifierTable &Idents = PP.getIdentifierTable();
+    WriteTotal("identifiers", Idents.size());
+    WriteTotal("identifier_table_bytes",
+               Idents.getAllocator().getTotalMemory());
+    WriteTotal("preprocessor_bytes", PP.getTotalMemory());
+    WriteTotal("header_search_bytes",
+               PP.getHeaderSearchInfo().getTotalMemory());
+  }
+  OS << "\n  }";
+
+  if (!SM || !CI.hasASTContext()) {
+    OS << "\n}\n";
+    return;
+  }
+
+  MemoryUsageCollector Collector(*SM);
+  Collector.collectFileBuffers();
+  Collector.visitDecl(CI.getASTContext().getTranslationUnitDecl());
+
+  OS << ",\n  \"decl_kinds\": {";
+  First = true;
+#define DECL(DERIVED, BASE)                                                    \
+  if (Collector.DeclKinds[Decl::DERIVED].Count) {                              \
+    OS << (First ? "\n" : ",\n") << "    \"" #DERIVED "\": ";                  \
+    writeNodeUsage(OS, Collector.DeclKinds[Decl::DERIVED]);                    \
+    First = false;                                                             \
+  }
+#define ABSTRACT_DECL(DECL)
+#include "clang/AST/DeclNodes.inc"
+  OS << "\n  },\n  \"stmt_kinds\": {";
+  First = true;
+#define STMT(CLASS, PARENT)                                                    \
+  if (Collector.StmtKinds[Stmt::CLASS##Class].Count) {                         \
+    OS << (First ? "\n" : ",\n") << "    \"" #CLASS "\": ";                    \
+    writeNodeUsage(OS, Collector.StmtKinds[Stmt::CLASS##Class]);               \
+    First = false;                                                             \
+  }
+#define ABSTRACT_STMT(STMT)
+#include "clang/AST/StmtNodes.inc"
+
+  // Sort the files so that the report is stable across runs.
+  std::vector<StringRef> FileNames;
+  for (const auto &File : Collector.Files)
+    FileNames.push_back(File.getKey());
+  std::sort(FileNames.begin(), FileNames.end());
+
+  OS << "\n  },\n  \"files\": [";
+  First = true;
+  for (StringRef Name : FileNames) {
+    const FileUsage &File = Collector.Files[Name];
+    OS << (First ? "\n" : ",\n") << "    { \"name\": ";
+    writeJSONString(OS, Name);
+    OS << ", \"buffer_bytes\": " << File.BufferBytes << ",\n      \"decls\": ";
+    writeNodeUsage(OS, File.Decls);
+    OS << ", \"stmts\": ";
+    writeNodeUsage(OS, File.Stmts);
+    OS << " }";
+    First = false;
+  }
+  OS << "\n  ]\n}\n";
+}
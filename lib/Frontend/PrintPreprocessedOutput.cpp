@@ -16,6 +16,7 @@
 #include "clang/Basic/CharInfo.h"
 #include "clang/Basic/Diagnostic.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/PreprocessorOutputOptions.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/PPCallbacks.h"
@@ -25,6 +26,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Compression.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
@@ -625,6 +627,23 @@ struct UnknownPragmaHandler : public PragmaHandler {
 } // end anonymous namespace
 
 
+/// \brief Returns true if \p Tok directly follows \p PrevTok in the same
+/// source buffer, so that printing them next to each other reproduces the
+/// source text and cannot form a different token.
+static bool isAdjacentInSource(const Token &PrevTok, const Token &Tok) {
+  SourceLocation PrevLoc = PrevTok.getLocation();
+  SourceLocation Loc = Tok.getLocation();
+  if (!PrevLoc.isFileID() || !Loc.isFileID() || PrevTok.needsCleaning() ||
+      Tok.needsCleaning())
+    return false;
+  // Comments dropped from between the tokens must still separate them.
+  if (PrevTok.is(tok::comment) || Tok.is(tok::comment))
+    return false;
+  // Files are laid out with a gap between them, so this also means the
+  // tokens come from the same file.
+  return PrevLoc.getLocWithOffset(PrevTok.getLength()) == Loc;
+}
+
 static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                                     PrintPPOutputPPCallbacks *Callbacks,
                                     raw_ostream &OS) {
@@ -648,6 +667,9 @@ static void PrintPreprocessedTokens(Preprocessor &PP, Token &Tok,
                // If we haven't emitted a token on this line yet, PrevTok isn't
                // useful to look at and no concatenation could happen anyway.
                (Callbacks->hasEmittedTokensOnThisLine() &&
+                // Tokens that were already adjacent in an untouched stretch
+                // of source can be printed as they were without checking.
+                !isAdjacentInSource(PrevTok, Tok) &&
                 // Don't print "-" next to "-", it would form "--".
                 Callbacks->AvoidConcat(PrevPrevTok, PrevTok, Tok))) {
       OS << ' ';
@@ -778,6 +800,11 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
 
   PP.addPPCallbacks(std::unique_ptr<PPCallbacks>(Callbacks));
 
+  // The output is produced a token at a time; hand it to the file in large
+  // blocks. Unbuffered streams, such as terminals, are left alone.
+  if (size_t BufferSize = OS->GetBufferSize())
+    OS->SetBufferSize(std::max<size_t>(BufferSize, 256 * 1024));
+
   // After we have configured the preprocessor, enter the main file.
   PP.EnterMainSourceFile();
 
@@ -803,3 +830,15 @@ void clang::DoPrintPreprocessedInput(Preprocessor &PP, raw_ostream *OS,
   PrintPreprocessedTokens(PP, Tok, Callbacks, *OS);
   *OS << '\n';
 }
+
+void clang::WriteCompressedPreprocessedOutput(DiagnosticsEngine &Diags,
+                                              StringRef Output,
+                                              raw_ostream &OS) {
+  SmallString<0> Compressed;
+  if (!llvm::zlib::isAvailable() ||
+      llvm::zlib::compress(Output, Compressed) != llvm::zlib::StatusOK) {
+    Diags.Report(diag::err_fe_compress_preprocessed_output);
+    return;
+  }
+  OS.write(Compressed.data(), Compressed.size());
+}
@@ -192,6 +192,14 @@ void RewriteIncludesAction::ExecuteAction() {
   raw_ostream *OS = CI.createDefaultOutputFile(true, getCurrentFile());
   if (!OS) return;
 
-  RewriteIncludesInInput(CI.getPreprocessor(), OS,
-                         CI.getPreprocessorOutputOpts());
+  const PreprocessorOutputOptions &Opts = CI.getPreprocessorOutputOpts();
+  if (!Opts.CompressOutput) {
+    RewriteIncludesInInput(CI.getPreprocessor(), OS, Opts);
+    return;
+  }
+
+  SmallString<0> Output;
+  llvm::raw_svector_ostream OutputOS(Output);
+  RewriteIncludesInInput(CI.getPreprocessor(), &OutputOS, Opts);
+  WriteCompressedPreprocessedOutput(CI.getDiagnostics(), Output, *OS);
 }
@@ -22,7 +22,9 @@
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 #include <utility>
 #include <vector>
@@ -155,9 +157,14 @@ public:
       : LangOpts(nullptr), OriginalInstance(true),
         MergeChildRecords(MergeChildRecords),
         State(new SharedState(File, Diags)) {
-    if (MergeChildRecords)
+    OpenLiveOutput();
+    if (MergeChildRecords && !State->LiveOS)
       RemoveOldDiagnostics();
     EmitPreamble();
+    // The driver writes its few diagnostics at the end, so that they do not
+    // interleave with those its child processes stream into the same pipe.
+    if (!MergeChildRecords)
+      FlushLiveOutput();
   }
 
   ~SDiagsWriter() override {}
@@ -180,6 +187,14 @@ private:
   /// merge into our own.
   void RemoveOldDiagnostics();
 
+  /// \brief If the output file is a pipe or a character device, such as one
+  /// a build system reads diagnostics from as they are produced, open it
+  /// now so that diagnostics can be written as soon as they are complete.
+  void OpenLiveOutput();
+
+  /// \brief Write the completed top-level blocks to the live output, if any.
+  void FlushLiveOutput();
+
   /// \brief Emit the preamble for the serialized diagnostics.
   void EmitPreamble();
   
@@ -283,8 +298,9 @@ private:
     /// \brief The collection of diagnostic categories used.
     llvm::DenseSet<unsigned> Categories;
 
-    /// \brief The collection of files used.
-    llvm::DenseMap<const char *, unsigned> Files;
+    /// \brief The collection of files used, by name, so that each file gets a
+    /// single record however many buffers or merged records refer to it.
+    llvm::StringMap<unsigned> Files;
 
     typedef llvm::DenseMap<const void *, std::pair<unsigned, StringRef> >
     DiagFlagsTy;
@@ -299,6 +315,10 @@ private:
 
     /// \brief Engine for emitting diagnostics about the diagnostics.
     std::unique_ptr<DiagnosticsEngine> MetaDiagnostics;
+
+    /// \brief The pipe that completed top-level blocks are written to as soon
+    /// as they are finished, or null if the output is written by finish().
+    std::unique_ptr<llvm::raw_fd_ostream> LiveOS;
   };
 
   /// \brief State shared among the various clones of this diagnostic consumer.
@@ -588,8 +608,11 @@ void SDiagsWriter::HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
   // for beginDiagnostic, in case associated notes are emitted before we get
   // there.
   if (DiagLevel != DiagnosticsEngine::Note) {
-    if (State->EmittedAnyDiagBlocks)
+    if (State->EmittedAnyDiagBlocks) {
       ExitDiagBlock();
+      if (!MergeChildRecords)
+        FlushLiveOutput();
+    }
 
     EnterDiagBlock();
     State->EmittedAnyDiagBlocks = true;
@@ -787,6 +810,34 @@ void SDiagsWriter::RemoveOldDiagnostics() {
   MergeChildRecords = false;
 }
 
+void SDiagsWriter::OpenLiveOutput() {
+  llvm::sys::fs::file_status Status;
+  if (llvm::sys::fs::status(State->OutputFile, Status) ||
+      (Status.type() != llvm::sys::fs::file_type::fifo_file &&
+       Status.type() != llvm::sys::fs::file_type::character_file))
+    return;
+
+  std::error_code EC;
+  State->LiveOS = llvm::make_unique<llvm::raw_fd_ostream>(
+      State->OutputFile, EC, llvm::sys::fs::F_None);
+  if (EC) {
+    getMetaDiags()->Report(diag::warn_fe_serialized_diag_failure)
+        << State->OutputFile << EC.message();
+    State->LiveOS.reset();
+  }
+}
+
+void SDiagsWriter::FlushLiveOutput() {
+  if (!State->LiveOS)
+    return;
+
+  // No block is open at this point, so the writer does not refer back into
+  // the buffer and it can start over.
+  State->LiveOS->write(State->Buffer.data(), State->Buffer.size());
+  State->LiveOS->flush();
+  State->Buffer.clear();
+}
+
 void SDiagsWriter::finish() {
   // The original instance is responsible for writing the file.
   if (!OriginalInstance)
@@ -796,6 +847,13 @@ void SDiagsWriter::finish() {
   if (State->EmittedAnyDiagBlocks)
     ExitDiagBlock();
 
+  // Child processes wrote their own diagnostics to the pipe; it cannot be
+  // read back to merge them.
+  if (State->LiveOS) {
+    FlushLiveOutput();
+    return;
+  }
+
   if (MergeChildRecords) {
     if (!State->EmittedAnyDiagBlocks)
       // We have no diagnostics of our own, so we can just leave the child
@@ -8,7 +8,6 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Frontend/SerializedDiagnosticReader.h"
-#include "clang/Basic/FileManager.h"
 #include "clang/Frontend/SerializedDiagnostics.h"
 #include "llvm/Support/ManagedStatic.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -17,31 +16,49 @@ using namespace clang;
 using namespace clang::serialized_diags;
 
 std::error_code SerializedDiagnosticReader::readDiagnostics(StringRef File) {
-  // Open the diagnostics file.
-  FileSystemOptions FO;
-  FileManager FileMgr(FO);
-
-  auto Buffer = FileMgr.getBufferForFile(File);
+  // Open the diagnostics file. It is only read, so map it without asking for
+  // a null terminator.
+  auto Buffer = llvm::MemoryBuffer::getFile(File, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
   if (!Buffer)
     return SDError::CouldNotLoad;
 
+  return readDiagnostics((*Buffer)->getMemBufferRef());
+}
+
+/// \brief Read the signature that starts each stream of diagnostics.
+static bool readSignature(llvm::BitstreamCursor &Stream) {
+  return Stream.Read(8) == 'D' &&
+         Stream.Read(8) == 'I' &&
+         Stream.Read(8) == 'A' &&
+         Stream.Read(8) == 'G';
+}
+
+std::error_code
+SerializedDiagnosticReader::readDiagnostics(llvm::MemoryBufferRef Buffer) {
   llvm::BitstreamReader StreamFile;
-  StreamFile.init((const unsigned char *)(*Buffer)->getBufferStart(),
-                  (const unsigned char *)(*Buffer)->getBufferEnd());
+  StreamFile.init((const unsigned char *)Buffer.getBufferStart(),
+                  (const unsigned char *)Buffer.getBufferEnd());
 
   llvm::BitstreamCursor Stream(StreamFile);
 
   // Sniff for the signature.
-  if (Stream.Read(8) != 'D' ||
-      Stream.Read(8) != 'I' ||
-      Stream.Read(8) != 'A' ||
-      Stream.Read(8) != 'G')
+  if (!Stream.canSkipToPos(4) || !readSignature(Stream))
     return SDError::InvalidSignature;
 
   // Read the top level blocks.
   while (!Stream.AtEndOfStream()) {
-    if (Stream.ReadCode() != llvm::bitc::ENTER_SUBBLOCK)
-      return SDError::InvalidDiagnostics;
+    uint64_t BlockStart = Stream.GetCurrentBitNo();
+    if (Stream.ReadCode() != llvm::bitc::ENTER_SUBBLOCK) {
+      // Streams written to the same pipe, or concatenated logs, follow one
+      // another. The numbering of files and flags starts over in each of them,
+      // but every stream names them before referring to them.
+      Stream.JumpToBit(BlockStart);
+      if (BlockStart % 32 || !Stream.canSkipToPos(BlockStart / 8 + 4) ||
+          !readSignature(Stream))
+        return SDError::InvalidDiagnostics;
+      continue;
+    }
 
     std::error_code EC;
     switch (Stream.ReadSubBlockID()) {
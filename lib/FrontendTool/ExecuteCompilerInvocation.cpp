@@ -22,6 +22,7 @@
 #include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Frontend/FrontendPluginRegistry.h"
 #include "clang/Frontend/Utils.h"
+#include "clang/Index/IndexingAction.h"
 #include "clang/Rewrite/Frontend/FrontendActions.h"
 #include "clang/StaticAnalyzer/Frontend/FrontendActions.h"
 #include "llvm/Option/OptTable.h"
@@ -165,6 +166,10 @@ CreateFrontendAction(CompilerInstance &CI) {
     Act = llvm::make_unique<ASTMergeAction>(std::move(Act),
                                             FEOpts.ASTMergeFiles);
 
+  // Record the index data of the compilation while it is built.
+  if (!FEOpts.IndexStorePath.empty())
+    Act = index::createIndexDataRecordingAction(FEOpts, std::move(Act));
+
   return Act;
 }
 
@@ -430,9 +430,12 @@ bool IndexingContext::indexDecl(const Decl *D) {
 }
 
 bool IndexingContext::indexDeclContext(const DeclContext *DC) {
-  for (const auto *I : DC->decls())
+  for (const auto *I : DC->decls()) {
+    if (shouldSkipDecl(I))
+      continue;
     if (!indexDecl(I))
       return false;
+  }
   return true;
 }
 
@@ -443,6 +446,9 @@ bool IndexingContext::indexTopLevelDecl(const Decl *D) {
   if (isa<ObjCMethodDecl>(D))
     return true; // Wait for the objc container.
 
+  if (shouldSkipDecl(D))
+    return true;
+
   return indexDecl(D);
 }
 
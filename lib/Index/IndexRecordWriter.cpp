@@ -0,0 +1,335 @@
+//===--- IndexRecordWriter.cpp - Index store of a compilation -------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the recording of index data to an index store while
+// compiling (-index-store-path).
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/IndexingAction.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
+#include "clang/Frontend/FrontendOptions.h"
+#include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+using namespace clang;
+using namespace clang::index;
+
+namespace {
+
+struct RecordSymbol {
+  SymbolInfo Info;
+  std::string USR;
+  std::string Name;
+};
+
+struct RecordOccurrence {
+  unsigned Line;
+  unsigned Column;
+  SymbolRoleSet Roles;
+  unsigned Symbol;
+  SmallVector<std::pair<SymbolRoleSet, unsigned>, 2> Relations;
+
+  bool operator<(const RecordOccurrence &Other) const {
+    return std::tie(Line, Column, Symbol, Roles, Relations) <
+           std::tie(Other.Line, Other.Column, Other.Symbol, Other.Roles,
+                    Other.Relations);
+  }
+  bool operator==(const RecordOccurrence &Other) const {
+    return std::tie(Line, Column, Symbol, Roles, Relations) ==
+           std::tie(Other.Line, Other.Column, Other.Symbol, Other.Roles,
+                    Other.Relations);
+  }
+};
+
+/// \brief Collects the occurrences of each file of the compilation, and
+/// writes them to the index store once the compilation is done.
+class IndexRecordingConsumer : public IndexDataConsumer {
+  std::string StorePath;
+  std::string OutputFile;
+  ASTContext *Ctx = nullptr;
+
+  static const unsigned NoSymbol = ~0U;
+
+  /// \brief The symbols of the compilation, and the index of each canonical
+  /// declaration in it, or \c NoSymbol if it has no USR.
+  std::vector<RecordSymbol> Symbols;
+  llvm::DenseMap<const Decl *, unsigned> SymbolIndices;
+  USRCache USRs;
+
+  /// \brief The occurrences in each file, with indices into \c Symbols.
+  llvm::DenseMap<const FileEntry *, std::vector<RecordOccurrence>> Occurrences;
+
+  unsigned getSymbol(const Decl *D);
+  std::string writeRecord(const FileEntry *FE,
+                          std::vector<RecordOccurrence> &FileOccurrences);
+  bool writeStoreFile(StringRef Path, StringRef Contents);
+
+public:
+  IndexRecordingConsumer(StringRef StorePath, StringRef OutputFile)
+      : StorePath(StorePath), OutputFile(OutputFile) {}
+
+  void initialize(ASTContext &Ctx) override { this->Ctx = &Ctx; }
+
+  bool handleDeclOccurence(const Decl *D, SymbolRoleSet Roles,
+                           ArrayRef<SymbolRelation> Relations,
+                           FileID FID, unsigned Offset,
+                           ASTNodeInfo ASTNode) override;
+
+  void finish() override;
+};
+
+} // anonymous namespace
+
+/// \returns the absolute form of \p Path.
+static std::string getAbsolutePath(StringRef Path) {
+  SmallString<256> Absolute(Path);
+  llvm::sys::fs::make_absolute(Absolute);
+  llvm::sys::path::remove_dots(Absolute, /*remove_dot_dot=*/true);
+  return Absolute.str();
+}
+
+static std::string getFilePath(const FileEntry *FE) {
+  StringRef RealPath = FE->tryGetRealPathName();
+  if (!RealPath.empty())
+    return RealPath;
+  return getAbsolutePath(FE->getName());
+}
+
+/// \returns a name in the store for the entry of \p Path whose contents hash
+/// to \p Hashed: the file name of \p Path and the hexadecimal hash.
+static std::string getStoreName(StringRef Path, StringRef Hashed) {
+  llvm::MD5 Hash;
+  Hash.update(Hashed);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+  return (llvm::sys::path::filename(Path) + "-" + Digest).str();
+}
+
+unsigned IndexRecordingConsumer::getSymbol(const Decl *D) {
+  D = D->getCanonicalDecl();
+  auto Known = SymbolIndices.find(D);
+  if (Known != SymbolIndices.end())
+    return Known->second;
+
+  StringRef USR = USRs.getUSR(D);
+  if (USR.empty()) {
+    SymbolIndices[D] = NoSymbol;
+    return NoSymbol;
+  }
+
+  RecordSymbol Symbol;
+  Symbol.Info = getSymbolInfo(D);
+  Symbol.USR = USR;
+  llvm::raw_string_ostream NameOS(Symbol.Name);
+  printSymbolName(D, Ctx->getLangOpts(), NameOS);
+  NameOS.flush();
+
+  unsigned Index = Symbols.size();
+  Symbols.push_back(std::move(Symbol));
+  SymbolIndices[D] = Index;
+  return Index;
+}
+
+bool IndexRecordingConsumer::handleDeclOccurence(
+    const Decl *D, SymbolRoleSet Roles, ArrayRef<SymbolRelation> Relations,
+    FileID FID, unsigned Offset, ASTNodeInfo ASTNode) {
+  SourceManager &SM = Ctx->getSourceManager();
+  const FileEntry *FE = SM.getFileEntryForID(FID);
+  if (!FE)
+    return true;
+
+  RecordOccurrence Occurrence;
+  Occurrence.Symbol = getSymbol(D);
+  if (Occurrence.Symbol == NoSymbol)
+    return true;
+  Occurrence.Line = SM.getLineNumber(FID, Offset);
+  Occurrence.Column = SM.getColumnNumber(FID, Offset);
+  Occurrence.Roles = Roles;
+  for (const SymbolRelation &Relation : Relations) {
+    unsigned Related = getSymbol(Relation.RelatedSymbol);
+    if (Related != NoSymbol)
+      Occurrence.Relations.push_back(std::make_pair(Relation.Roles, Related));
+  }
+  Occurrences[FE].push_back(std::move(Occurrence));
+  return true;
+}
+
+/// Writes \p Contents to the file \p Path of the store, unless it exists
+/// already. A temporary file is renamed to it, so that concurrent
+/// compilations never see a partial file.
+///
+/// \returns true if the file could not be written.
+bool IndexRecordingConsumer::writeStoreFile(StringRef Path,
+                                            StringRef Contents) {
+  if (llvm::sys::fs::exists(Path))
+    return false;
+
+  std::error_code EC =
+      llvm::sys::fs::create_directories(llvm::sys::path::parent_path(Path));
+  int TmpFD;
+  SmallString<128> TmpFile;
+  if (!EC)
+    EC = llvm::sys::fs::createUniqueFile(Twine(Path) + "-%%%%%%%%", TmpFD,
+                                         TmpFile);
+  if (!EC) {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      EC = std::make_error_code(std::errc::io_error);
+    }
+    if (!EC)
+      EC = llvm::sys::fs::rename(TmpFile, Path);
+    if (EC)
+      llvm::sys::fs::remove(TmpFile);
+  }
+
+  if (EC)
+    Ctx->getDiagnostics().Report(diag::warn_fe_index_store_write_failure)
+        << Path << EC.message();
+  return bool(EC);
+}
+
+/// \returns the name of the record of \p FE, which is written to the store
+/// if it is not there yet, or an empty string if it could not be written.
+std::string IndexRecordingConsumer::writeRecord(
+    const FileEntry *FE, std::vector<RecordOccurrence> &FileOccurrences) {
+  // Number the symbols of the record in the order of their USRs, so that the
+  // record of a header does not depend on the compilation that indexed it.
+  std::vector<unsigned> RecordSymbols;
+  for (const RecordOccurrence &Occurrence : FileOccurrences) {
+    RecordSymbols.push_back(Occurrence.Symbol);
+    for (const auto &Relation : Occurrence.Relations)
+      RecordSymbols.push_back(Relation.second);
+  }
+  std::sort(RecordSymbols.begin(), RecordSymbols.end(),
+            [&](unsigned X, unsigned Y) {
+              return std::tie(Symbols[X].USR, X) < std::tie(Symbols[Y].USR, Y);
+            });
+  RecordSymbols.erase(std::unique(RecordSymbols.begin(), RecordSymbols.end()),
+                      RecordSymbols.end());
+  llvm::DenseMap<unsigned, unsigned> LocalIndices;
+  for (unsigned I = 0, N = RecordSymbols.size(); I != N; ++I)
+    LocalIndices[RecordSymbols[I]] = I;
+
+  for (RecordOccurrence &Occurrence : FileOccurrences) {
+    Occurrence.Symbol = LocalIndices[Occurrence.Symbol];
+    for (auto &Relation : Occurrence.Relations)
+      Relation.second = LocalIndices[Relation.second];
+    std::sort(Occurrence.Relations.begin(), Occurrence.Relations.end());
+  }
+  // A header that is included several times reports its occurrences once for
+  // each inclusion.
+  std::sort(FileOccurrences.begin(), FileOccurrences.end());
+  FileOccurrences.erase(
+      std::unique(FileOccurrences.begin(), FileOccurrences.end()),
+      FileOccurrences.end());
+
+  std::string Record;
+  llvm::raw_string_ostream OS(Record);
+  OS << "clang-index-record 1\n";
+  for (unsigned I = 0, N = RecordSymbols.size(); I != N; ++I) {
+    const RecordSymbol &Symbol = Symbols[RecordSymbols[I]];
+    OS << "symbol " << I << ' ' << getSymbolKindString(Symbol.Info.Kind) << '/'
+       << getSymbolLanguageString(Symbol.Info.Lang) << ' ' << Symbol.USR
+       << ' ' << Symbol.Name << '\n';
+  }
+  for (const RecordOccurrence &Occurrence : FileOccurrences) {
+    OS << "occurrence " << Occurrence.Line << ':' << Occurrence.Column << ' '
+       << llvm::format_hex(Occurrence.Roles, 0) << ' ' << Occurrence.Symbol
+       << '\n';
+    for (const auto &Relation : Occurrence.Relations)
+      OS << "relation " << llvm::format_hex(Relation.first, 0) << ' '
+         << Relation.second << '\n';
+  }
+  OS.flush();
+
+  std::string FilePath = getFilePath(FE);
+  std::string Name = getStoreName(FilePath, Record);
+  SmallString<256> RecordPath(StorePath);
+  llvm::sys::path::append(RecordPath, "records", Name.substr(Name.size() - 2),
+                          Name);
+  if (writeStoreFile(RecordPath, Record))
+    return std::string();
+  return Name;
+}
+
+void IndexRecordingConsumer::finish() {
+  // Actions that only preprocess have no AST to index.
+  if (!Ctx)
+    return;
+  SourceManager &SM = Ctx->getSourceManager();
+
+  // The files of the compilation, in the order of their paths, along with the
+  // names of their records.
+  std::map<std::string, std::string> Files;
+  for (SourceManager::fileinfo_iterator I = SM.fileinfo_begin(),
+                                        E = SM.fileinfo_end();
+       I != E; ++I)
+    Files[getFilePath(I->first)];
+
+  for (auto &FileOccurrences : Occurrences)
+    Files[getFilePath(FileOccurrences.first)] =
+        writeRecord(FileOccurrences.first, FileOccurrences.second);
+
+  std::string MainFile;
+  if (const FileEntry *FE = SM.getFileEntryForID(SM.getMainFileID()))
+    MainFile = getFilePath(FE);
+  std::string Output =
+      OutputFile.empty() || OutputFile == "-" ? MainFile
+                                              : getAbsolutePath(OutputFile);
+  if (Output.empty())
+    return;
+
+  std::string Unit;
+  llvm::raw_string_ostream OS(Unit);
+  OS << "clang-index-unit 1\n"
+     << "main-file " << MainFile << '\n'
+     << "output-file " << Output << '\n';
+  for (const auto &File : Files)
+    OS << "file " << File.first << ' '
+       << (File.second.empty() ? StringRef("-") : StringRef(File.second))
+       << '\n';
+  OS.flush();
+
+  // A unit replaces the one of the previous compilation of the same output.
+  SmallString<256> UnitPath(StorePath);
+  llvm::sys::path::append(UnitPath, "units", getStoreName(Output, Output));
+  llvm::sys::fs::remove(UnitPath);
+  writeStoreFile(UnitPath, Unit);
+}
+
+std::unique_ptr<FrontendAction>
+index::createIndexDataRecordingAction(
+    const FrontendOptions &FEOpts,
+    std::unique_ptr<FrontendAction> WrappedAction) {
+  auto DataConsumer = std::make_shared<IndexRecordingConsumer>(
+      FEOpts.IndexStorePath, FEOpts.OutputFile);
+  return createIndexingAction(std::move(DataConsumer), IndexingOptions(),
+                              std::move(WrappedAction));
+}
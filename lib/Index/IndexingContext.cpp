@@ -160,6 +160,16 @@ bool IndexingContext::shouldIgnoreIfImplicit(const Decl *D) {
   return true;
 }
 
+bool IndexingContext::shouldSkipDecl(const Decl *D) {
+  // Namespaces may be reopened in any file; their members are asked about one
+  // by one instead.
+  if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D))
+    return false;
+  if (!D->getDeclContext()->getRedeclContext()->isFileContext())
+    return false;
+  return DataConsumer.shouldSkipDecl(D);
+}
+
 static const Decl *adjustTemplateImplicitInstantiation(const Decl *D) {
   if (const ClassTemplateSpecializationDecl *
       SD = dyn_cast<ClassTemplateSpecializationDecl>(D)) {
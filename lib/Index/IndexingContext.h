@@ -106,6 +106,8 @@ public:
 private:
   bool shouldIgnoreIfImplicit(const Decl *D);
 
+  bool shouldSkipDecl(const Decl *D);
+
   bool handleDeclOccurrence(const Decl *D, SourceLocation Loc,
                             bool IsRef, const Decl *Parent,
                             SymbolRoleSet Roles,
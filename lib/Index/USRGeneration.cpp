@@ -13,8 +13,10 @@
 #include "clang/AST/DeclVisitor.h"
 #include "clang/Lex/PreprocessingRecord.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
 
 using namespace clang;
 using namespace clang::index;
@@ -54,16 +56,19 @@ class USRGenerator : public ConstDeclVisitor<USRGenerator> {
   bool IgnoreResults;
   ASTContext *Context;
   bool generatedLoc;
+  USRCache *Cache;
   
   llvm::DenseMap<const Type *, unsigned> TypeSubstitutions;
   
 public:
-  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf)
+  explicit USRGenerator(ASTContext *Ctx, SmallVectorImpl<char> &Buf,
+                        USRCache *Cache = nullptr)
   : Buf(Buf),
     Out(Buf),
     IgnoreResults(false),
     Context(Ctx),
-    generatedLoc(false)
+    generatedLoc(false),
+    Cache(Cache)
   {
     // Add the USR space prefix.
     Out << getUSRSpacePrefix();
@@ -71,6 +76,12 @@ public:
 
   bool ignoreResults() const { return IgnoreResults; }
 
+  /// Whether the USR generated so far left no state behind that the rest of
+  /// a USR nested in it would depend on.
+  bool isReusablePrefix() const {
+    return !generatedLoc && TypeSubstitutions.empty();
+  }
+
   // Visitation methods from generating USRs from AST elements.
   void VisitDeclContext(const DeclContext *D);
   void VisitFieldDecl(const FieldDecl *D);
@@ -179,8 +190,22 @@ bool USRGenerator::ShouldGenerateLocation(const NamedDecl *D) {
 }
 
 void USRGenerator::VisitDeclContext(const DeclContext *DC) {
-  if (const NamedDecl *D = dyn_cast<NamedDecl>(DC))
-    Visit(D);
+  const NamedDecl *D = dyn_cast<NamedDecl>(DC);
+  if (!D)
+    return;
+
+  if (Cache) {
+    USRCache::Entry Known = Cache->getEntry(D);
+    if (Known.IsReusablePrefix) {
+      if (Known.USR.empty())
+        IgnoreResults = true;
+      else
+        Out << Known.USR.drop_front(getUSRSpacePrefix().size());
+      return;
+    }
+  }
+
+  Visit(D);
 }
 
 void USRGenerator::VisitFieldDecl(const FieldDecl *D) {
@@ -883,6 +908,53 @@ bool clang::index::generateUSRForDecl(const Decl *D,
   return UG.ignoreResults();
 }
 
+uint64_t clang::index::hashUSR(StringRef USR) {
+  llvm::MD5 Hash;
+  Hash.update(USR);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  uint64_t Value = 0;
+  for (unsigned I = 0; I != 8; ++I)
+    Value |= uint64_t(Result[I]) << (I * 8);
+  return Value;
+}
+
+USRCache::Entry USRCache::getEntry(const Decl *D) {
+  auto Known = Entries.find(D);
+  if (Known != Entries.end())
+    return Known->second;
+
+  Entry New;
+  // A declaration with an invalid location is only ignored at the outermost
+  // level, so its USR is not reusable as a prefix.
+  if (D && D->getLocStart().isValid()) {
+    SmallString<256> Buf;
+    USRGenerator UG(&D->getASTContext(), Buf, this);
+    UG.Visit(D);
+    New.IsReusablePrefix = UG.isReusablePrefix();
+    if (!UG.ignoreResults()) {
+      char *Str = Alloc.Allocate<char>(Buf.size() + 1);
+      std::copy(Buf.begin(), Buf.end(), Str);
+      Str[Buf.size()] = '\0';
+      New.USR = StringRef(Str, Buf.size());
+    }
+  }
+
+  // Generating the USR may have added the entries of its contexts.
+  Entries[D] = New;
+  return New;
+}
+
+uint64_t USRCache::getUSRHash(const Decl *D) {
+  Entry E = getEntry(D);
+  if (!E.HasHash) {
+    E.Hash = E.USR.empty() ? 0 : hashUSR(E.USR);
+    E.HasHash = true;
+    Entries[D] = E;
+  }
+  return E.Hash;
+}
+
 bool clang::index::generateUSRForMacro(const MacroDefinitionRecord *MD,
                                        const SourceManager &SM,
                                        SmallVectorImpl<char> &Buf) {
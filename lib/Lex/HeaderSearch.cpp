@@ -68,6 +68,7 @@ HeaderSearch::HeaderSearch(IntrusiveRefCntPtr<HeaderSearchOptions> HSOpts,
   NumIncluded = 0;
   NumMultiIncludeFileOptzn = 0;
   NumFrameworkLookups = NumSubFrameworkLookups = 0;
+  NumDirectoryIndexSkips = 0;
 }
 
 HeaderSearch::~HeaderSearch() {
@@ -96,6 +97,8 @@ void HeaderSearch::PrintStats() {
 
   fprintf(stderr, "%d framework lookups.\n", NumFrameworkLookups);
   fprintf(stderr, "%d subframework lookups.\n", NumSubFrameworkLookups);
+  fprintf(stderr, "%d directory probes skipped using the directory index.\n",
+          NumDirectoryIndexSkips);
 }
 
 /// CreateHeaderMap - This method returns a HeaderMap for the specified
@@ -249,6 +252,44 @@ const char *DirectoryLookup::getName() const {
   return getHeaderMap()->getFileName();
 }
 
+bool HeaderSearch::directoryMayContain(const DirectoryEntry *Dir,
+                                       StringRef Filename) {
+  if (!HSOpts->AssumeStableSearchDirs)
+    return true;
+
+  // Only the first component of the name has to be in the directory itself.
+  StringRef FirstComponent = *llvm::sys::path::begin(Filename);
+  if (FirstComponent == "." || FirstComponent == "..")
+    return true;
+
+  auto Known = DirectoryContents.insert(
+      std::make_pair(Dir, std::unique_ptr<llvm::StringSet<>>()));
+  if (Known.second) {
+    // List the directory the first time we search it.  Listing through the
+    // VFS would stat every entry, so only index directories that live on the
+    // real file system.
+    StringRef DirName = Dir->getName();
+    if (FileMgr.getVirtualFileSystem() == vfs::getRealFileSystem() &&
+        (llvm::sys::path::is_absolute(DirName) ||
+         FileMgr.getFileSystemOpts().WorkingDir.empty())) {
+      auto Names = llvm::make_unique<llvm::StringSet<>>();
+      std::error_code EC;
+      for (llvm::sys::fs::directory_iterator I(DirName, EC), E;
+           !EC && I != E; I.increment(EC))
+        Names->insert(llvm::sys::path::filename(I->path()));
+      if (!EC)
+        Known.first->second = std::move(Names);
+    }
+  }
+
+  const llvm::StringSet<> *Names = Known.first->second.get();
+  if (!Names || Names->count(FirstComponent))
+    return true;
+
+  ++NumDirectoryIndexSkips;
+  return false;
+}
+
 const FileEntry *HeaderSearch::getFileAndSuggestModule(
     StringRef FileName, SourceLocation IncludeLoc, const DirectoryEntry *Dir,
     bool IsSystemHeaderDir, Module *RequestingModule,
@@ -286,6 +327,10 @@ const FileEntry *DirectoryLookup::LookupFile(
 
   SmallString<1024> TmpDir;
   if (isNormalDir()) {
+    // Skip directories we know can't contain the file.
+    if (!HS.directoryMayContain(getDir(), Filename))
+      return nullptr;
+
     // Concatenate the requested file onto the directory.
     TmpDir = getDir()->getName();
     llvm::sys::path::append(TmpDir, Filename);
@@ -1079,6 +1124,19 @@ bool HeaderSearch::ShouldEnterIncludeFile(Preprocessor &PP,
   return true;
 }
 
+bool HeaderSearch::isIncludeKnownToHaveNoEffect(Preprocessor &PP,
+                                                const FileEntry *File,
+                                                bool isImport) {
+  HeaderFileInfo &FileInfo = getFileInfo(File);
+  if (isImport ? FileInfo.NumIncludes != 0 : FileInfo.isImport)
+    return true;
+
+  if (const IdentifierInfo *ControllingMacro =
+          FileInfo.getControllingMacro(ExternalLookup))
+    return PP.isMacroDefined(ControllingMacro);
+  return false;
+}
+
 size_t HeaderSearch::getTotalMemory() const {
   return SearchDirs.capacity()
     + llvm::capacity_in_bytes(FileInfo)
@@ -1263,13 +1321,17 @@ HeaderSearch::lookupModuleMapFile(const DirectoryEntry *Dir, bool IsFramework) {
   // For frameworks, the preferred spelling is Modules/module.modulemap, but
   // module.map at the framework root is also accepted.
   SmallString<128> ModuleMapFileName(Dir->getName());
-  if (IsFramework)
-    llvm::sys::path::append(ModuleMapFileName, "Modules");
-  llvm::sys::path::append(ModuleMapFileName, "module.modulemap");
-  if (const FileEntry *F = FileMgr.getFile(ModuleMapFileName))
-    return F;
+  if (directoryMayContain(Dir, IsFramework ? "Modules" : "module.modulemap")) {
+    if (IsFramework)
+      llvm::sys::path::append(ModuleMapFileName, "Modules");
+    llvm::sys::path::append(ModuleMapFileName, "module.modulemap");
+    if (const FileEntry *F = FileMgr.getFile(ModuleMapFileName))
+      return F;
+  }
 
   // Continue to allow module.map
+  if (!directoryMayContain(Dir, "module.map"))
+    return nullptr;
   ModuleMapFileName = Dir->getName();
   llvm::sys::path::append(ModuleMapFileName, "module.map");
   return FileMgr.getFile(ModuleMapFileName);
@@ -1316,6 +1378,8 @@ HeaderSearch::loadModuleMapFile(const DirectoryEntry *Dir, bool IsSystem,
   auto KnownDir = DirectoryHasModuleMap.find(Dir);
   if (KnownDir != DirectoryHasModuleMap.end())
     return KnownDir->second ? LMM_AlreadyLoaded : LMM_InvalidModuleMap;
+  if (DirectoriesWithoutModuleMap[IsFramework].count(Dir))
+    return LMM_InvalidModuleMap;
 
   if (const FileEntry *ModuleMapFile = lookupModuleMapFile(Dir, IsFramework)) {
     LoadModuleMapResult Result =
@@ -1329,6 +1393,10 @@ HeaderSearch::loadModuleMapFile(const DirectoryEntry *Dir, bool IsSystem,
       DirectoryHasModuleMap[Dir] = false;
     return Result;
   }
+
+  // Header lookups walk up through the same directories over and over, so do
+  // not probe them for module map files again.
+  DirectoriesWithoutModuleMap[IsFramework].insert(Dir);
   return LMM_InvalidModuleMap;
 }
 
@@ -26,6 +26,14 @@
 #include "llvm/Support/ConvertUTF.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#elif __ALTIVEC__
+#include <altivec.h>
+#undef bool
+#endif
+
 using namespace clang;
 
 //===----------------------------------------------------------------------===//
@@ -46,6 +54,114 @@ tok::ObjCKeywordKind Token::getObjCKeywordID() const {
 }
 
 
+//===----------------------------------------------------------------------===//
+// Vectorized Scanning Helpers
+//===----------------------------------------------------------------------===//
+
+// These helpers skip over runs of "boring" characters 16 bytes at a time.
+// They never read past BufferEnd, and they only ever stop early, so callers
+// always finish the scan with their existing scalar loops, which continue to
+// handle trigraphs, escaped newlines, UCNs and the code-completion point.
+
+#ifdef __SSE2__
+/// Return a mask with a bit set for every byte of \p V in ['Lo', 'Hi'].
+static inline __m128i getInRangeMask(__m128i V, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(V, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(V, _mm_set1_epi8(Hi + 1)));
+}
+
+/// Return the number of leading bytes of \p Mask (as produced by
+/// _mm_movemask_epi8) that are set.
+static inline unsigned countLeadingMatches(int Mask) {
+  return llvm::countTrailingZeros<unsigned>(~(unsigned)Mask);
+}
+#endif
+
+/// Skip over characters matching [_A-Za-z0-9] starting at \p CurPtr, stopping
+/// no later than \p BufferEnd.  Returns a pointer to the first character that
+/// was not skipped.
+static const char *fastSkipIdentifierBody(const char *CurPtr,
+                                          const char *BufferEnd) {
+#ifdef __SSE2__
+  const __m128i CaseBit = _mm_set1_epi8(0x20);
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i V = _mm_loadu_si128((const __m128i*)CurPtr);
+    // Setting bit 0x20 folds [A-Z] onto [a-z] without creating new matches.
+    __m128i IsIdent = _mm_or_si128(
+        getInRangeMask(_mm_or_si128(V, CaseBit), 'a', 'z'),
+        _mm_or_si128(getInRangeMask(V, '0', '9'),
+                     _mm_cmpeq_epi8(V, _mm_set1_epi8('_'))));
+    unsigned N = countLeadingMatches(_mm_movemask_epi8(IsIdent));
+    CurPtr += N;
+    if (N != 16)
+      break;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skip over horizontal whitespace (' ', '\t', '\f', '\v') starting at
+/// \p CurPtr, stopping no later than \p BufferEnd.
+static const char *fastSkipHorizontalWhitespace(const char *CurPtr,
+                                                const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i V = _mm_loadu_si128((const __m128i*)CurPtr);
+    __m128i IsSpace = _mm_or_si128(_mm_cmpeq_epi8(V, _mm_set1_epi8(' ')),
+                                   _mm_cmpeq_epi8(V, _mm_set1_epi8('\t')));
+    IsSpace = _mm_or_si128(IsSpace, _mm_cmpeq_epi8(V, _mm_set1_epi8('\f')));
+    IsSpace = _mm_or_si128(IsSpace, _mm_cmpeq_epi8(V, _mm_set1_epi8('\v')));
+    unsigned N = countLeadingMatches(_mm_movemask_epi8(IsSpace));
+    CurPtr += N;
+    if (N != 16)
+      break;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skip over the body of a line comment up to the next '\n', '\r' or '\0',
+/// stopping no later than \p BufferEnd.
+static const char *fastSkipLineCommentBody(const char *CurPtr,
+                                           const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i V = _mm_loadu_si128((const __m128i*)CurPtr);
+    __m128i IsStop = _mm_or_si128(_mm_cmpeq_epi8(V, _mm_set1_epi8('\n')),
+                                  _mm_cmpeq_epi8(V, _mm_set1_epi8('\r')));
+    IsStop = _mm_or_si128(IsStop, _mm_cmpeq_epi8(V, _mm_setzero_si128()));
+    if (int Mask = _mm_movemask_epi8(IsStop))
+      return CurPtr + llvm::countTrailingZeros<unsigned>(Mask);
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
+/// Skip over the text of an excluded conditional block up to the next
+/// character that skipToPossibleDirective has to look at: '\n', '\r', a
+/// quote, '/', '\\', '?' or '\0'. Stops no later than \p BufferEnd.
+static const char *fastSkipExcludedText(const char *CurPtr,
+                                        const char *BufferEnd) {
+#ifdef __SSE2__
+  while (CurPtr + 16 <= BufferEnd) {
+    __m128i V = _mm_loadu_si128((const __m128i*)CurPtr);
+    __m128i IsStop = _mm_or_si128(_mm_cmpeq_epi8(V, _mm_set1_epi8('\n')),
+                                  _mm_cmpeq_epi8(V, _mm_set1_epi8('\r')));
+    IsStop = _mm_or_si128(IsStop, _mm_cmpeq_epi8(V, _mm_set1_epi8('"')));
+    IsStop = _mm_or_si128(IsStop, _mm_cmpeq_epi8(V, _mm_set1_epi8('\'')));
+    IsStop = _mm_or_si128(IsStop, _mm_cmpeq_epi8(V, _mm_set1_epi8('/')));
+    IsStop = _mm_or_si128(IsStop, _mm_cmpeq_epi8(V, _mm_set1_epi8('\\')));
+    IsStop = _mm_or_si128(IsStop, _mm_cmpeq_epi8(V, _mm_set1_epi8('?')));
+    IsStop = _mm_or_si128(IsStop, _mm_cmpeq_epi8(V, _mm_setzero_si128()));
+    if (int Mask = _mm_movemask_epi8(IsStop))
+      return CurPtr + llvm::countTrailingZeros<unsigned>(Mask);
+    CurPtr += 16;
+  }
+#endif
+  return CurPtr;
+}
+
 //===----------------------------------------------------------------------===//
 // Lexer Class Implementation
 //===----------------------------------------------------------------------===//
@@ -694,6 +810,85 @@ std::pair<unsigned, bool> Lexer::ComputePreamble(StringRef Buffer,
                                : TheTok.isAtStartOfLine());
 }
 
+unsigned Lexer::minimizeSourceToDependencyDirectives(
+    StringRef Buffer, SmallVectorImpl<char> &Output,
+    const LangOptions &LangOpts) {
+  // As in ComputePreamble, the fake file location at offset 1 lets us map
+  // token locations back to offsets in the buffer.
+  const unsigned StartOffset = 1;
+  SourceLocation FileLoc = SourceLocation::getFromRawEncoding(StartOffset);
+  Lexer TheLexer(FileLoc, LangOpts, Buffer.begin(), Buffer.begin(),
+                 Buffer.end());
+
+  unsigned NumDirectives = 0;
+  Token TheTok;
+  TheLexer.LexFromRawLexer(TheTok);
+  while (TheTok.isNot(tok::eof)) {
+    if (TheTok.isAtStartOfLine() && TheTok.is(tok::at)) {
+      // Keep '@import' declarations, up to their semicolon.
+      unsigned DeclStart = TheTok.getLocation().getRawEncoding() - StartOffset;
+      TheLexer.LexFromRawLexer(TheTok);
+      if (TheTok.isAtStartOfLine() || TheTok.isNot(tok::raw_identifier) ||
+          TheTok.getRawIdentifier() != "import")
+        continue;
+      unsigned DeclEnd;
+      do {
+        DeclEnd = TheTok.getLocation().getRawEncoding() - StartOffset +
+                  TheTok.getLength();
+        TheLexer.LexFromRawLexer(TheTok);
+        // Without its semicolon, the declaration ends before the next
+        // directive.
+      } while (TheTok.isNot(tok::eof) &&
+               !(TheTok.isAtStartOfLine() && TheTok.is(tok::hash)) &&
+               !TheTok.is(tok::semi));
+      if (TheTok.is(tok::semi)) {
+        DeclEnd = TheTok.getLocation().getRawEncoding() - StartOffset + 1;
+        TheLexer.LexFromRawLexer(TheTok);
+      }
+      Output.append(Buffer.begin() + DeclStart, Buffer.begin() + DeclEnd);
+      Output.push_back('\n');
+      ++NumDirectives;
+      continue;
+    }
+
+    if (!TheTok.isAtStartOfLine() || TheTok.isNot(tok::hash)) {
+      TheLexer.LexFromRawLexer(TheTok);
+      continue;
+    }
+
+    // The directive runs up to the last token before the next line starts.
+    unsigned DirectiveStart =
+        TheTok.getLocation().getRawEncoding() - StartOffset;
+    unsigned DirectiveEnd = DirectiveStart + TheTok.getLength();
+    bool AtDirectiveName = true;
+    bool IsIncludeDirective = false;
+    do {
+      // Lex an <angled> header name as one token, since '//' is valid in it.
+      TheLexer.ParsingFilename = IsIncludeDirective;
+      TheLexer.LexFromRawLexer(TheTok);
+      TheLexer.ParsingFilename = false;
+      if (TheTok.is(tok::eof) || TheTok.isAtStartOfLine())
+        break;
+
+      unsigned TokOffset = TheTok.getLocation().getRawEncoding() - StartOffset;
+      IsIncludeDirective =
+          AtDirectiveName && TheTok.is(tok::raw_identifier) &&
+          llvm::StringSwitch<bool>(TheTok.getRawIdentifier())
+              .Cases("include", "include_next", "import", "__include_macros",
+                     true)
+              .Default(false);
+      AtDirectiveName = false;
+      DirectiveEnd = TokOffset + TheTok.getLength();
+    } while (true);
+
+    Output.append(Buffer.begin() + DirectiveStart,
+                  Buffer.begin() + DirectiveEnd);
+    Output.push_back('\n');
+    ++NumDirectives;
+  }
+  return NumDirectives;
+}
+
 
 /// AdvanceToTokenCharacter - Given a location that specifies the start of a
 /// token, return a new location that specifies a character within the token.
@@ -895,25 +1090,12 @@ CharSourceRange Lexer::makeFileCharRange(CharSourceRange Range,
     return makeRangeFromFileLocs(Range, SM, LangOpts);
   }
 
-  bool Invalid = false;
-  const SrcMgr::SLocEntry &BeginEntry = SM.getSLocEntry(SM.getFileID(Begin),
-                                                        &Invalid);
-  if (Invalid)
-    return CharSourceRange();
-
-  if (BeginEntry.getExpansion().isMacroArgExpansion()) {
-    const SrcMgr::SLocEntry &EndEntry = SM.getSLocEntry(SM.getFileID(End),
-                                                        &Invalid);
-    if (Invalid)
-      return CharSourceRange();
-
-    if (EndEntry.getExpansion().isMacroArgExpansion() &&
-        BeginEntry.getExpansion().getExpansionLocStart() ==
-            EndEntry.getExpansion().getExpansionLocStart()) {
-      Range.setBegin(SM.getImmediateSpellingLoc(Begin));
-      Range.setEnd(SM.getImmediateSpellingLoc(End));
-      return makeFileCharRange(Range, SM, LangOpts);
-    }
+  SourceLocation BeginArgLoc, EndArgLoc;
+  if (SM.isMacroArgExpansion(Begin, &BeginArgLoc) &&
+      SM.isMacroArgExpansion(End, &EndArgLoc) && BeginArgLoc == EndArgLoc) {
+    Range.setBegin(SM.getImmediateSpellingLoc(Begin));
+    Range.setEnd(SM.getImmediateSpellingLoc(End));
+    return makeFileCharRange(Range, SM, LangOpts);
   }
 
   return CharSourceRange();
@@ -965,7 +1147,7 @@ StringRef Lexer::getImmediateMacroName(SourceLocation Loc,
     FileID FID = SM.getFileID(Loc);
     const SrcMgr::SLocEntry *E = &SM.getSLocEntry(FID);
     const SrcMgr::ExpansionInfo &Expansion = E->getExpansion();
-    Loc = Expansion.getExpansionLocStart();
+    Loc = SM.getImmediateExpansionRange(Loc).first;
     if (!Expansion.isMacroArgExpansion())
       break;
 
@@ -1502,6 +1684,7 @@ bool Lexer::tryConsumeIdentifierUTF8Char(const char *&CurPtr) {
 bool Lexer::LexIdentifier(Token &Result, const char *CurPtr) {
   // Match [_A-Za-z0-9]*, we have already matched [_A-Za-z$]
   unsigned Size;
+  CurPtr = fastSkipIdentifierBody(CurPtr, BufferEnd);
   unsigned char C = *CurPtr++;
   while (isIdentifierBody(C))
     C = *CurPtr++;
@@ -1994,6 +2177,10 @@ bool Lexer::SkipWhitespace(Token &Result, const char *CurPtr,
   // Skip consecutive spaces efficiently.
   while (1) {
     // Skip horizontal whitespace very aggressively.
+    if (isHorizontalWhitespace(Char)) {
+      CurPtr = fastSkipHorizontalWhitespace(CurPtr, BufferEnd);
+      Char = *CurPtr;
+    }
     while (isHorizontalWhitespace(Char))
       Char = *++CurPtr;
 
@@ -2060,6 +2247,7 @@ bool Lexer::SkipLineComment(Token &Result, const char *CurPtr,
   // them.  As such, optimize for this case with the inner loop.
   char C;
   do {
+    CurPtr = fastSkipLineCommentBody(CurPtr, BufferEnd);
     C = *CurPtr;
     // Skip over characters in the fast loop.
     while (C != 0 &&                // Potentially EOF.
@@ -2265,13 +2453,6 @@ static bool isEndOfBlockCommentWithEscapedNewLine(const char *CurPtr,
   return true;
 }
 
-#ifdef __SSE2__
-#include <emmintrin.h>
-#elif __ALTIVEC__
-#include <altivec.h>
-#undef bool
-#endif
-
 /// We have just read from input the / and * characters that started a comment.
 /// Read until we find the * and / characters that terminate the comment.
 /// Note that we don't bother decoding trigraphs or escaped newlines in block
@@ -2499,6 +2680,213 @@ void Lexer::ReadToEndOfLine(SmallVectorImpl<char> *Result) {
   }
 }
 
+/// Returns the first character at or after \p CurPtr that can change the
+/// line structure of excluded text.
+static const char *findExcludedTextSpecial(const char *CurPtr,
+                                           const char *BufferEnd) {
+  CurPtr = fastSkipExcludedText(CurPtr, BufferEnd);
+  while (true) {
+    switch (*CurPtr) {
+    case '\n': case '\r': case '"': case '\'': case '/': case '\\': case '?':
+    case 0:
+      return CurPtr;
+    default:
+      ++CurPtr;
+    }
+  }
+}
+
+/// If the backslash at \p CurPtr starts a line splice, returns the start of
+/// the next line. Otherwise returns null.
+static const char *skipLineSplice(const char *CurPtr) {
+  assert(*CurPtr == '\\' && "Not at a backslash");
+  ++CurPtr;
+  while (isHorizontalWhitespace(*CurPtr))
+    ++CurPtr;
+  if (*CurPtr != '\n' && *CurPtr != '\r')
+    return nullptr;
+  // "\r\n" and "\n\r" are one line break.
+  if ((CurPtr[1] == '\n' || CurPtr[1] == '\r') && CurPtr[1] != CurPtr[0])
+    return CurPtr + 2;
+  return CurPtr + 1;
+}
+
+/// Skips the string or character literal of excluded text that starts at the
+/// quote \p CurPtr. Returns where to go on scanning, or null if the lexer
+/// has to take over.
+static const char *skipExcludedLiteral(const char *CurPtr,
+                                       const char *BufferStart,
+                                       const char *BufferEnd,
+                                       const LangOptions &LangOpts) {
+  // Encoding prefixes, raw string literals and digit separators are left to
+  // the lexer.
+  if (CurPtr != BufferStart && isIdentifierBody(CurPtr[-1]))
+    return nullptr;
+
+  char Quote = *CurPtr++;
+  while (true) {
+    CurPtr = findExcludedTextSpecial(CurPtr, BufferEnd);
+    switch (*CurPtr) {
+    case '\n':
+    case '\r':
+      // In raw mode, an unterminated literal ends at the end of the line.
+      return CurPtr;
+    case '\\':
+      if (const char *NextLine = skipLineSplice(CurPtr)) {
+        CurPtr = NextLine;
+        break;
+      }
+      // The escaped character could itself start a line splice or trigraph.
+      if (CurPtr[1] == 0 || (CurPtr[1] == '\\' && skipLineSplice(CurPtr + 1)) ||
+          (CurPtr[1] == '?' && LangOpts.Trigraphs))
+        return nullptr;
+      CurPtr += 2;
+      break;
+    case '?':
+      if (CurPtr[1] == '?' && LangOpts.Trigraphs)
+        return nullptr;
+      ++CurPtr;
+      break;
+    case 0:
+      return nullptr;
+    default:
+      if (*CurPtr++ == Quote)
+        return CurPtr;
+      break;
+    }
+  }
+}
+
+/// Skips the comment of excluded text that starts at the '/' \p CurPtr, or
+/// just the '/' if it does not start a comment. Returns where to go on
+/// scanning, or null if the lexer has to take over.
+static const char *skipExcludedComment(const char *CurPtr,
+                                       const char *BufferEnd,
+                                       const LangOptions &LangOpts) {
+  if (CurPtr[1] == '/') {
+    // Without line comments, the lexer decides what "//" means.
+    if (!LangOpts.LineComment)
+      return nullptr;
+    CurPtr += 2;
+    while (true) {
+      CurPtr = findExcludedTextSpecial(CurPtr, BufferEnd);
+      switch (*CurPtr) {
+      case '\n':
+      case '\r':
+        return CurPtr;
+      case '\\':
+        if (const char *NextLine = skipLineSplice(CurPtr))
+          CurPtr = NextLine;
+        else
+          ++CurPtr;
+        break;
+      case '?':
+        if (CurPtr[1] == '?' && LangOpts.Trigraphs)
+          return nullptr;
+        ++CurPtr;
+        break;
+      case 0:
+        return nullptr;
+      default:
+        ++CurPtr;
+        break;
+      }
+    }
+  }
+
+  if (CurPtr[1] == '*') {
+    CurPtr += 2;
+    // The '/' of "/*/" does not end the comment.
+    if (*CurPtr == '/')
+      ++CurPtr;
+    while (true) {
+      CurPtr = findExcludedTextSpecial(CurPtr, BufferEnd);
+      if (*CurPtr == 0)
+        return nullptr;
+      if (*CurPtr == '/') {
+        if (CurPtr[-1] == '*')
+          return CurPtr + 1;
+        // A '*' and '/' on either side of a line splice end the comment too.
+        if (CurPtr[-1] == '\n' || CurPtr[-1] == '\r')
+          return nullptr;
+      }
+      ++CurPtr;
+    }
+  }
+
+  // A line splice or trigraph could join the '/' to what follows.
+  if (CurPtr[1] == '\\' || (CurPtr[1] == '?' && LangOpts.Trigraphs))
+    return nullptr;
+  return CurPtr + 1;
+}
+
+void Lexer::skipToPossibleDirective() {
+  assert(LexingRawMode && !ParsingPreprocessorDirective &&
+         "Can only skip excluded text in raw mode");
+  const char *CurPtr = BufferPtr;
+  // The last line start that is known to be between tokens. The lexer takes
+  // over from here, since anywhere else could be inside a comment or literal.
+  const char *SafePtr = BufferPtr;
+  bool AtLineStart = IsAtStartOfLine;
+
+  while (true) {
+    if (AtLineStart) {
+      // A directive begins with a '#' that is first on its line, possibly
+      // after whitespace and comments. It could also be spelled "%:" or
+      // "??=", or follow a line splice.
+      const char *FirstPtr = fastSkipHorizontalWhitespace(CurPtr, BufferEnd);
+      while (isHorizontalWhitespace(*FirstPtr))
+        ++FirstPtr;
+      char First = *FirstPtr;
+      if (First == '#' || First == '%' || First == '?' || First == '\\' ||
+          First == 0 ||
+          (First == '/' && (FirstPtr[1] == '*' || FirstPtr[1] == '\\')))
+        break;
+      AtLineStart = false;
+      CurPtr = FirstPtr;
+    }
+
+    CurPtr = findExcludedTextSpecial(CurPtr, BufferEnd);
+    const char *NextPtr;
+    switch (*CurPtr) {
+    case '\n':
+    case '\r':
+      SafePtr = ++CurPtr;
+      AtLineStart = true;
+      continue;
+    case '"':
+    case '\'':
+      NextPtr = skipExcludedLiteral(CurPtr, BufferStart, BufferEnd, LangOpts);
+      break;
+    case '/':
+      NextPtr = skipExcludedComment(CurPtr, BufferEnd, LangOpts);
+      break;
+    case '\\':
+      NextPtr = skipLineSplice(CurPtr);
+      if (!NextPtr)
+        NextPtr = CurPtr + 1;
+      break;
+    case '?':
+      NextPtr = CurPtr[1] == '?' && LangOpts.Trigraphs ? nullptr : CurPtr + 1;
+      break;
+    default:
+      // The end of the buffer, the code completion point or a stray null are
+      // all left to the lexer.
+      NextPtr = nullptr;
+      break;
+    }
+    if (!NextPtr)
+      break;
+    CurPtr = NextPtr;
+  }
+
+  if (SafePtr != BufferPtr) {
+    BufferPtr = SafePtr;
+    IsAtStartOfLine = true;
+    IsAtPhysicalStartOfLine = true;
+  }
+}
+
 /// LexEndOfFile - CurPtr points to the end of this file.  Handle this
 /// condition, reporting diagnostics and handling other edge cases as required.
 /// This returns true if Result contains a token, false if PP.Lex should be
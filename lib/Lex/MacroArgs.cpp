@@ -72,6 +72,7 @@ MacroArgs *MacroArgs::create(const MacroInfo *MI,
 ///
 void MacroArgs::destroy(Preprocessor &PP) {
   StringifiedArgs.clear();
+  ArgPreExpansionChecks.clear();
 
   // Don't clear PreExpArgTokens, just clear the entries.  Clearing the entries
   // would deallocate the element vectors.
@@ -132,15 +133,50 @@ bool MacroArgs::ArgNeedsPreexpansion(const Token *ArgTok,
                                      Preprocessor &PP) const {
   // If there are no identifiers in the argument list, or if the identifiers are
   // known to not be macros, pre-expansion won't modify it.
-  for (; ArgTok->isNot(tok::eof); ++ArgTok)
-    if (IdentifierInfo *II = ArgTok->getIdentifierInfo())
-      if (II->hasMacroDefinition())
-        // Return true even though the macro could be a function-like macro
-        // without a following '(' token, or could be disabled, or not visible.
-        return true;
+  for (; ArgTok->isNot(tok::eof); ++ArgTok) {
+    IdentifierInfo *II = ArgTok->getIdentifierInfo();
+    if (!II || !II->hasMacroDefinition())
+      continue;
+
+    // A token that was found to name a disabled macro can never be expanded.
+    // This is the common case for an argument that is forwarded unchanged
+    // into an inner macro: it has already been pre-expanded, and what is left
+    // of it are such tokens and names of function-like macros.
+    if (ArgTok->isExpandDisabled())
+      continue;
+
+    // An enabled function-like macro is only expanded if the argument itself
+    // supplies the '('.  If the next token is a macro that could produce one,
+    // it is checked in turn.  Disabled macros still go through pre-expansion,
+    // which marks them with DisableExpand.
+    if (const MacroInfo *MI = PP.getMacroInfo(II))
+      if (MI->isFunctionLike() && MI->isEnabled() &&
+          ArgTok[1].isNot(tok::l_paren))
+        continue;
+
+    // Otherwise conservatively assume the token is expanded, even though the
+    // macro could be not visible.
+    return true;
+  }
   return false;
 }
 
+/// ArgNeedsPreexpansion - Compute, cache, and return whether the specified
+/// argument needs pre-expansion.
+bool MacroArgs::ArgNeedsPreexpansion(unsigned Arg, const MacroInfo *MI,
+                                     Preprocessor &PP) {
+  assert(Arg < MI->getNumArgs() && "Invalid argument number!");
+
+  if (ArgPreExpansionChecks.size() < MI->getNumArgs())
+    ArgPreExpansionChecks.resize(MI->getNumArgs(), PEC_Unknown);
+
+  PreExpansionCheck &Check = ArgPreExpansionChecks[Arg];
+  if (Check == PEC_Unknown)
+    Check = ArgNeedsPreexpansion(getUnexpArgument(Arg), PP) ? PEC_Needed
+                                                            : PEC_NotNeeded;
+  return Check == PEC_Needed;
+}
+
 /// getPreExpArgument - Return the pre-expanded form of the specified
 /// argument.
 const std::vector<Token> &
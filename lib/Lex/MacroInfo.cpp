@@ -20,6 +20,8 @@ MacroInfo::MacroInfo(SourceLocation DefLoc)
     ArgumentList(nullptr),
     NumArguments(0),
     IsDefinitionLengthCached(false),
+    IsConstantBodyComputed(false),
+    HasConstantBody(false),
     IsFunctionLike(false),
     IsC99Varargs(false),
     IsGNUVarargs(false),
@@ -62,6 +64,19 @@ unsigned MacroInfo::getDefinitionLengthSlow(SourceManager &SM) const {
   return DefinitionLength;
 }
 
+void MacroInfo::computeHasConstantBody() const {
+  assert(!IsConstantBodyComputed);
+  IsConstantBodyComputed = true;
+
+  HasConstantBody = false;
+  if (IsFunctionLike)
+    return;
+  for (const Token &Tok : ReplacementTokens)
+    if (Tok.isOneOf(tok::hash, tok::hashat, tok::hashhash, tok::comment))
+      return;
+  HasConstantBody = true;
+}
+
 /// \brief Return true if the specified macro definition is equal to
 /// this macro in spelling, arguments, and whitespace.
 ///
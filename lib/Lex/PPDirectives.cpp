@@ -383,6 +383,9 @@ void Preprocessor::SkipExcludedConditionalBlock(SourceLocation IfTokenLoc,
   CurPPLexer->LexingRawMode = true;
   Token Tok;
   while (1) {
+    // Only directives matter here, so move ahead to the next line that may
+    // hold one without forming the tokens in between.
+    CurLexer->skipToPossibleDirective();
     CurLexer->Lex(Tok);
 
     if (Tok.is(tok::code_completion)) {
@@ -1357,17 +1360,34 @@ void Preprocessor::HandleDigitDirective(Token &DigitTok) {
 ///
 void Preprocessor::HandleUserDiagnosticDirective(Token &Tok,
                                                  bool isWarning) {
-  // PTH doesn't emit #warning or #error directives.
-  if (CurPTHLexer)
-    return CurPTHLexer->DiscardToEndOfLine();
-
   // Read the rest of the line raw.  We do this because we don't want macros
   // to be expanded and we don't require that the tokens be valid preprocessing
   // tokens.  For example, this is allowed: "#warning `   'foo".  GCC does
   // collapse multiple consequtive white space between tokens, but this isn't
   // specified by the standard.
   SmallString<128> Message;
-  CurLexer->ReadToEndOfLine(&Message);
+  if (CurPTHLexer) {
+    // PTH doesn't emit #warning or #error directives.
+    if (!CurPTHLexer->isTokenCacheLexer())
+      return CurPTHLexer->DiscardToEndOfLine();
+
+    // A shared token cache entry replays a file whose contents are known, so
+    // read the message back from the file, starting after the directive name.
+    bool Invalid = false;
+    FileID FID = SourceMgr.getFileID(Tok.getLocation());
+    StringRef Buffer = SourceMgr.getBufferData(FID, &Invalid);
+    if (!Invalid) {
+      unsigned Offset = SourceMgr.getFileOffset(Tok.getLocation()) +
+                        Tok.getLength();
+      Lexer RawLex(SourceMgr.getLocForStartOfFile(FID), LangOpts,
+                   Buffer.begin(), Buffer.begin() + Offset, Buffer.end());
+      RawLex.setParsingPreprocessorDirective(true);
+      RawLex.ReadToEndOfLine(&Message);
+    }
+    CurPTHLexer->DiscardToEndOfLine();
+  } else {
+    CurLexer->ReadToEndOfLine(&Message);
+  }
 
   // Find the first non-whitespace character, so that we can make the
   // diagnostic more succinct.
@@ -1783,11 +1803,50 @@ void Preprocessor::HandleIncludeDirective(SourceLocation HashLoc,
     llvm::sys::path::native(NormalizedPath);
 #endif
   }
-  const FileEntry *File = LookupFile(
-      FilenameLoc, LangOpts.MSVCCompat ? NormalizedPath.c_str() : Filename,
-      isAngled, LookupFrom, LookupFromFile, CurDir,
-      Callbacks ? &SearchPath : nullptr, Callbacks ? &RelativePath : nullptr,
-      &SuggestedModule);
+
+  // Headers are often #included again long after their include guard was
+  // defined. Remember how each #include was resolved, so that doing it again
+  // for a file that will be skipped anyway needs no header search. This is
+  // only safe when the result depends on nothing but the including file's
+  // directory: not for #include_next, the MSVC include stack search, or
+  // module use declarations that are checked at each #include.
+  SmallString<256> LookupKey;
+  if (!LookupFrom && !LookupFromFile && !LangOpts.MSVCCompat &&
+      !LangOpts.Modules && !LangOpts.ModulesDeclUse) {
+    if (const FileEntry *Includer = getCurrentFileLexer()->getFileEntry()) {
+      LookupKey.push_back(isAngled ? '<' : '"');
+      LookupKey += Filename;
+      LookupKey.push_back('\0');
+      LookupKey += Includer->getDir()->getName();
+    }
+  }
+
+  const FileEntry *File = nullptr;
+  auto KnownLookup =
+      LookupKey.empty() ? IncludeLookups.end() : IncludeLookups.find(LookupKey);
+  if (KnownLookup != IncludeLookups.end() &&
+      HeaderInfo.isIncludeKnownToHaveNoEffect(*this, KnownLookup->second.File,
+                                              isImport)) {
+    const IncludeLookupInfo &Info = KnownLookup->second;
+    File = Info.File;
+    CurDir = Info.CurDir;
+    SuggestedModule = Info.SuggestedModule;
+    SearchPath = Info.SearchPath;
+    RelativePath = Info.RelativePath;
+    ++NumIncludeLookupsSkipped;
+  } else {
+    File = LookupFile(
+        FilenameLoc, LangOpts.MSVCCompat ? NormalizedPath.c_str() : Filename,
+        isAngled, LookupFrom, LookupFromFile, CurDir,
+        Callbacks ? &SearchPath : nullptr, Callbacks ? &RelativePath : nullptr,
+        &SuggestedModule);
+    if (File && !LookupKey.empty()) {
+      IncludeLookupInfo Info = {File, CurDir, SuggestedModule,
+                                Callbacks ? SearchPath.str() : StringRef(),
+                                Callbacks ? RelativePath.str() : StringRef()};
+      IncludeLookups[LookupKey] = std::move(Info);
+    }
+  }
 
   if (!File) {
     if (Callbacks) {
@@ -1798,6 +1857,7 @@ void Preprocessor::HandleIncludeDirective(SourceLocation HashLoc,
           // Add the recovery path to the list of search paths.
           DirectoryLookup DL(DE, SrcMgr::C_User, false);
           HeaderInfo.AddSearchPath(DL, isAngled);
+          IncludeLookups.clear();
 
           // Try the lookup again, skipping the cache.
           File = LookupFile(
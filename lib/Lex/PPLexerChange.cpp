@@ -19,6 +19,8 @@
 #include "clang/Lex/LexDiagnostic.h"
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/PTHManager.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "clang/Lex/SharedTokenCache.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -83,7 +85,22 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
       return false;
     }
   }
-  
+
+  // Minimize the file before consulting the token cache, which is keyed by
+  // the contents that are actually lexed: entries are written from the
+  // minimized buffer as well.
+  if (PPOpts->MinimizeSourceToDependencyDirectives)
+    minimizeSourceFile(FID);
+
+  // The code completion file must always be lexed from its source.
+  if (TokenCache && !(isCodeCompletionEnabled() &&
+                      SourceMgr.getFileEntryForID(FID) == CodeCompletionFile)) {
+    if (PTHLexer *PL = TokenCache->CreateLexer(FID)) {
+      EnterSourceFileWithPTH(PL, CurDir);
+      return false;
+    }
+  }
+
   // Get the MemoryBuffer for this FID, if it fails, we fail.
   bool Invalid = false;
   const llvm::MemoryBuffer *InputFile = 
@@ -106,6 +123,32 @@ bool Preprocessor::EnterSourceFile(FileID FID, const DirectoryLookup *CurDir,
   return false;
 }
 
+void Preprocessor::minimizeSourceFile(FileID FID) {
+  // Module imports aren't all directives, and the code completion file must
+  // be lexed in full.
+  const FileEntry *File = SourceMgr.getFileEntryForID(FID);
+  if (!File || LangOpts.Modules || SourceMgr.isFileOverridden(File) ||
+      (isCodeCompletionEnabled() && File == CodeCompletionFile))
+    return;
+
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer = SourceMgr.getBuffer(FID, &Invalid);
+  if (Invalid)
+    return;
+
+  // The minimized buffer overrides the file's contents, so this is done once
+  // per file and every later FileID for it shares the result.
+  SmallString<4096> Minimized;
+  Lexer::minimizeSourceToDependencyDirectives(Buffer->getBuffer(), Minimized,
+                                              LangOpts);
+  ++NumMinimizedSourceFiles;
+  NumMinimizedSourceBytesRemoved += Buffer->getBufferSize() - Minimized.size();
+  SourceMgr.overrideFileContents(
+      File, llvm::MemoryBuffer::getMemBufferCopy(Minimized,
+                                                 Buffer->getBufferIdentifier())
+                .release());
+}
+
 /// EnterSourceFileWithLexer - Add a source file to the top of the include stack
 ///  and start lexing tokens from it instead of the current buffer.
 void Preprocessor::EnterSourceFileWithLexer(Lexer *TheLexer,
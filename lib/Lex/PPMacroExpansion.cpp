@@ -566,7 +566,11 @@ bool Preprocessor::HandleMacroExpandedIdentifier(Token &Identifier,
     return true;
   }
 
-  // Start expanding the macro.
+  // Start expanding the macro.  Object-like macros whose bodies need no
+  // pasting are relocated token by token without further checks; see
+  // TokenLexer::Lex.
+  if (MI->hasConstantBody())
+    ++NumConstantMacroExpanded;
   EnterMacro(Identifier, ExpansionEnd, MI, Args);
   return false;
 }
@@ -1216,6 +1220,7 @@ static bool HasFeature(const Preprocessor &PP, StringRef Feature) {
       .Case("is_trivially_copyable", LangOpts.CPlusPlus)
       .Case("is_union", LangOpts.CPlusPlus)
       .Case("modules", LangOpts.Modules)
+      .Case("lazy_neon_intrinsics", LangOpts.LazyNeonIntrinsics)
       .Case("safe_stack", LangOpts.Sanitize.has(SanitizerKind::SafeStack))
       .Case("tls", PP.getTargetInfo().isTLSSupported())
       .Case("underlying_type", LangOpts.CPlusPlus)
@@ -156,6 +156,10 @@ void PTHLexer::getEOF(Token& Tok) {
   Tok = EofToken;
 }
 
+bool PTHLexer::isTokenCacheLexer() const {
+  return PTHMgr.isTokenCacheEntry();
+}
+
 void PTHLexer::DiscardToEndOfLine() {
   assert(ParsingPreprocessorDirective && ParsingFilename == false &&
          "Must be in a preprocessing directive!");
@@ -418,17 +422,26 @@ PTHManager::PTHManager(
     std::unique_ptr<PTHFileLookup> fileLookup, const unsigned char *idDataTable,
     std::unique_ptr<IdentifierInfo *[], llvm::FreeDeleter> perIDCache,
     std::unique_ptr<PTHStringIdLookup> stringIdLookup, unsigned numIds,
-    const unsigned char *spellingBase, const char *originalSourceFile)
+    const unsigned char *spellingBase, const char *originalSourceFile,
+    bool resolveIdentifiersThroughPP)
     : Buf(std::move(buf)), PerIDCache(std::move(perIDCache)),
       FileLookup(std::move(fileLookup)), IdDataTable(idDataTable),
       StringIdLookup(std::move(stringIdLookup)), NumIds(numIds), PP(nullptr),
-      SpellingBase(spellingBase), OriginalSourceFile(originalSourceFile) {}
+      SpellingBase(spellingBase), OriginalSourceFile(originalSourceFile),
+      ResolveIdentifiersThroughPP(resolveIdentifiersThroughPP) {}
 
 PTHManager::~PTHManager() {
 }
 
-static void InvalidPTH(DiagnosticsEngine &Diags, const char *Msg) {
-  Diags.Report(Diags.getCustomDiagID(DiagnosticsEngine::Error, "%0")) << Msg;
+static void InvalidPTH(DiagnosticsEngine *Diags, const char *Msg) {
+  if (Diags)
+    Diags->Report(Diags->getCustomDiagID(DiagnosticsEngine::Error, "%0"))
+        << Msg;
+}
+
+static void InvalidPTHFile(DiagnosticsEngine *Diags, StringRef file) {
+  if (Diags)
+    Diags->Report(diag::err_invalid_pth_file) << file;
 }
 
 PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
@@ -441,8 +454,36 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
     Diags.Report(diag::err_invalid_pth_file) << file;
     return nullptr;
   }
-  std::unique_ptr<llvm::MemoryBuffer> File = std::move(FileOrErr.get());
 
+  return CreateFromBuffer(std::move(FileOrErr.get()), file, &Diags,
+                          /*ResolveIdentifiersThroughPP=*/false);
+}
+
+PTHManager *PTHManager::CreateForTokenCache(StringRef file) {
+  // Token cache entries are written once and never modified in place, so
+  // there is no need to guard against the file changing while it is mapped.
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> FileOrErr =
+      llvm::MemoryBuffer::getFile(file, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!FileOrErr)
+    return nullptr;
+
+  PTHManager *PM = CreateFromBuffer(std::move(FileOrErr.get()), file,
+                                    /*Diags=*/nullptr,
+                                    /*ResolveIdentifiersThroughPP=*/true);
+  // A usable entry has exactly one file, whose name is recorded as the
+  // original source file.
+  if (PM && !PM->OriginalSourceFile) {
+    delete PM;
+    return nullptr;
+  }
+  return PM;
+}
+
+PTHManager *
+PTHManager::CreateFromBuffer(std::unique_ptr<llvm::MemoryBuffer> File,
+                             StringRef file, DiagnosticsEngine *Diags,
+                             bool ResolveIdentifiersThroughPP) {
   using namespace llvm::support;
 
   // Get the buffer ranges and check if there are at least three 32-bit
@@ -453,7 +494,7 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   // Check the prologue of the file.
   if ((BufEnd - BufBeg) < (signed)(sizeof("cfe-pth") + 4 + 4) ||
       memcmp(BufBeg, "cfe-pth", sizeof("cfe-pth")) != 0) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return nullptr;
   }
 
@@ -473,7 +514,7 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   const unsigned char *PrologueOffset = p;
 
   if (PrologueOffset >= BufEnd) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return nullptr;
   }
 
@@ -484,7 +525,7 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
       BufBeg + endian::readNext<uint32_t, little, aligned>(FileTableOffset);
 
   if (!(FileTable > BufBeg && FileTable < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return nullptr; // FIXME: Proper error diagnostic?
   }
 
@@ -492,8 +533,11 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
 
   // Warn if the PTH file is empty.  We still want to create a PTHManager
   // as the PTH could be used with -include-pth.
-  if (FL->isEmpty())
+  if (FL->isEmpty()) {
     InvalidPTH(Diags, "PTH file contains no cached source data");
+    if (!Diags)
+      return nullptr;
+  }
 
   // Get the location of the table mapping from persistent ids to the
   // data needed to reconstruct identifiers.
@@ -502,7 +546,7 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
       BufBeg + endian::readNext<uint32_t, little, aligned>(IDTableOffset);
 
   if (!(IData >= BufBeg && IData < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return nullptr;
   }
 
@@ -512,7 +556,7 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   const unsigned char *StringIdTable =
       BufBeg + endian::readNext<uint32_t, little, aligned>(StringIdTableOffset);
   if (!(StringIdTable >= BufBeg && StringIdTable < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return nullptr;
   }
 
@@ -524,7 +568,7 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   const unsigned char *spellingBase =
       BufBeg + endian::readNext<uint32_t, little, aligned>(spellingBaseOffset);
   if (!(spellingBase >= BufBeg && spellingBase < BufEnd)) {
-    Diags.Report(diag::err_invalid_pth_file) << file;
+    InvalidPTHFile(Diags, file);
     return nullptr;
   }
 
@@ -553,7 +597,8 @@ PTHManager *PTHManager::Create(StringRef file, DiagnosticsEngine &Diags) {
   // Create the new PTHManager.
   return new PTHManager(std::move(File), std::move(FL), IData,
                         std::move(PerIDCache), std::move(SL), NumIds,
-                        spellingBase, (const char *)originalSourceBase);
+                        spellingBase, (const char *)originalSourceBase,
+                        ResolveIdentifiersThroughPP);
 }
 
 IdentifierInfo* PTHManager::LazilyCreateIdentifierInfo(unsigned PersistentID) {
@@ -565,6 +610,14 @@ IdentifierInfo* PTHManager::LazilyCreateIdentifierInfo(unsigned PersistentID) {
       endian::readNext<uint32_t, little, aligned>(TableEntry);
   assert(IDData < (const unsigned char*)Buf->getBufferEnd());
 
+  // Token cache entries share the Preprocessor's identifiers.
+  if (ResolveIdentifiersThroughPP) {
+    assert(PP && "No preprocessor set yet!");
+    IdentifierInfo *II = PP->getIdentifierInfo((const char *)IDData);
+    PerIDCache[PersistentID] = II;
+    return II;
+  }
+
   // Allocate the object.
   std::pair<IdentifierInfo,const unsigned char*> *Mem =
     Alloc.Allocate<std::pair<IdentifierInfo,const unsigned char*> >();
@@ -622,6 +675,30 @@ PTHLexer *PTHManager::CreateLexer(FileID FID) {
   return new PTHLexer(*PP, FID, data, ppcond, *this);
 }
 
+PTHLexer *PTHManager::CreateLexerForCachedFile(FileID FID) {
+  assert(ResolveIdentifiersThroughPP && OriginalSourceFile &&
+         "Not a token cache entry!");
+  using namespace llvm::support;
+
+  PTHFileLookupTrait::internal_key_type Key((unsigned char)0x1,
+                                            OriginalSourceFile);
+  PTHFileLookup::iterator I =
+      FileLookup->find_hashed(Key, PTHFileLookupTrait::ComputeHash(Key));
+  if (I == FileLookup->end())
+    return nullptr;
+
+  const PTHFileData& FileData = *I;
+
+  const unsigned char *BufStart = (const unsigned char *)Buf->getBufferStart();
+  const unsigned char* data = BufStart + FileData.getTokenOffset();
+  const unsigned char* ppcond = BufStart + FileData.getPPCondOffset();
+  uint32_t Len = endian::readNext<uint32_t, little, aligned>(ppcond);
+  if (Len == 0) ppcond = nullptr;
+
+  assert(PP && "No preprocessor set yet!");
+  return new PTHLexer(*PP, FID, data, ppcond, *this);
+}
+
 //===----------------------------------------------------------------------===//
 // 'stat' caching.
 //===----------------------------------------------------------------------===//
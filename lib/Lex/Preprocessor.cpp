@@ -26,6 +26,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Lex/Preprocessor.h"
+#include "clang/Basic/CharInfo.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Basic/SourceManager.h"
@@ -39,6 +40,7 @@
 #include "clang/Lex/MacroInfo.h"
 #include "clang/Lex/ModuleLoader.h"
 #include "clang/Lex/PTHManager.h"
+#include "clang/Lex/SharedTokenCache.h"
 #include "clang/Lex/Pragma.h"
 #include "clang/Lex/PreprocessingRecord.h"
 #include "clang/Lex/PreprocessorOptions.h"
@@ -87,10 +89,14 @@ Preprocessor::Preprocessor(IntrusiveRefCntPtr<PreprocessorOptions> PPOpts,
   NumDirectives = NumDefined = NumUndefined = NumPragma = 0;
   NumIf = NumElse = NumEndif = 0;
   NumEnteredSourceFiles = 0;
+  NumIncludeLookupsSkipped = 0;
+  NumMinimizedSourceFiles = NumMinimizedSourceBytesRemoved = 0;
   NumMacroExpanded = NumFnMacroExpanded = NumBuiltinMacroExpanded = 0;
-  NumFastMacroExpanded = NumTokenPaste = NumFastTokenPaste = 0;
+  NumFastMacroExpanded = NumConstantMacroExpanded = 0;
+  NumTokenPaste = NumFastTokenPaste = 0;
   MaxIncludeStackDepth = 0;
   NumSkipped = 0;
+  TokenCount = 0;
   
   // Default to discarding comments.
   KeepComments = false;
@@ -211,6 +217,10 @@ void Preprocessor::setPTHManager(PTHManager* pm) {
   FileMgr.addStatCache(PTH->createStatCache());
 }
 
+void Preprocessor::setTokenCache(std::unique_ptr<SharedTokenCache> TC) {
+  TokenCache = std::move(TC);
+}
+
 void Preprocessor::DumpToken(const Token &Tok, bool DumpFlags) const {
   llvm::errs() << tok::getTokenName(Tok.getKind()) << " '"
                << getSpelling(Tok) << "'";
@@ -256,6 +266,11 @@ void Preprocessor::PrintStats() {
   llvm::errs() << "  #include/#include_next/#import:\n";
   llvm::errs() << "    " << NumEnteredSourceFiles << " source files entered.\n";
   llvm::errs() << "    " << MaxIncludeStackDepth << " max include stack depth\n";
+  llvm::errs() << "    " << NumIncludeLookupsSkipped
+               << " header searches skipped for files with no effect.\n";
+  llvm::errs() << "    " << NumMinimizedSourceFiles
+               << " source files minimized to their directives, "
+               << NumMinimizedSourceBytesRemoved << " bytes removed.\n";
   llvm::errs() << "  " << NumIf << " #if/#ifndef/#ifdef.\n";
   llvm::errs() << "  " << NumElse << " #else/#elif.\n";
   llvm::errs() << "  " << NumEndif << " #endif.\n";
@@ -264,11 +279,15 @@ void Preprocessor::PrintStats() {
 
   llvm::errs() << NumMacroExpanded << "/" << NumFnMacroExpanded << "/"
              << NumBuiltinMacroExpanded << " obj/fn/builtin macros expanded, "
-             << NumFastMacroExpanded << " on the fast path.\n";
+             << NumFastMacroExpanded << " on the fast path, "
+             << NumConstantMacroExpanded << " with constant bodies.\n";
   llvm::errs() << (NumFastTokenPaste+NumTokenPaste)
              << " token paste (##) operations performed, "
              << NumFastTokenPaste << " on the fast path.\n";
 
+  if (TokenCache)
+    TokenCache->PrintStats();
+
   llvm::errs() << "\nPreprocessor Memory: " << getTotalMemory() << "B total";
 
   llvm::errs() << "\n  BumpPtr: " << BP.getTotalMemory();
@@ -416,6 +435,12 @@ bool Preprocessor::SetCodeCompletionPoint(const FileEntry *File,
   CodeCompletionFile = File;
   CodeCompletionOffset = Position - Buffer->getBufferStart();
 
+  // Remember the partially typed identifier at the completion point.
+  const char *FilterEnd = Position;
+  while (FilterEnd != Buffer->getBufferEnd() && isIdentifierBody(*FilterEnd))
+    ++FilterEnd;
+  CodeCompletionFilter.assign(Position, FilterEnd);
+
   std::unique_ptr<MemoryBuffer> NewBuffer =
       MemoryBuffer::getNewUninitMemBuffer(Buffer->getBufferSize() + 1,
                                           Buffer->getBufferIdentifier());
@@ -744,6 +769,7 @@ void Preprocessor::Lex(Token &Result) {
     }
   } while (!ReturnedToken);
 
+  ++TokenCount;
   LastTokenWasAt = Result.is(tok::at);
 }
 
@@ -0,0 +1,125 @@
+//===--- SharedTokenCache.cpp - Content-addressed PTH token cache ---------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the SharedTokenCache interface.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/SharedTokenCache.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Lex/PTHLexer.h"
+#include "clang/Lex/PTHManager.h"
+#include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+using namespace clang;
+
+/// Hash everything besides the file contents that influences the token
+/// stream PTHWriter produces for a file.
+static std::string getConfigurationHash(const LangOptions &LangOpts) {
+  using llvm::hash_code;
+  using llvm::hash_value;
+  using llvm::hash_combine;
+
+  hash_code code = hash_value(getClangFullRepositoryVersion());
+  code = hash_combine(code, (unsigned)PTHManager::Version);
+
+#define LANGOPT(Name, Bits, Default, Description) \
+  code = hash_combine(code, LangOpts.Name);
+#define ENUM_LANGOPT(Name, Type, Bits, Default, Description) \
+  code = hash_combine(code, static_cast<unsigned>(LangOpts.get##Name()));
+#define BENIGN_LANGOPT(Name, Bits, Default, Description)
+#define BENIGN_ENUM_LANGOPT(Name, Type, Bits, Default, Description)
+#include "clang/Basic/LangOptions.def"
+
+  return llvm::utohexstr(uint64_t(size_t(code)));
+}
+
+SharedTokenCache::SharedTokenCache(StringRef Directory, Preprocessor &PP)
+    : Directory(Directory), PP(PP),
+      ConfigurationHash(getConfigurationHash(PP.getLangOpts())), NumHits(0),
+      NumMisses(0) {}
+
+SharedTokenCache::~SharedTokenCache() {}
+
+std::string
+SharedTokenCache::getEntryName(const llvm::MemoryBuffer &Buffer) const {
+  llvm::MD5 Hash;
+  Hash.update(Buffer.getBuffer());
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+
+  std::string Name;
+  llvm::raw_string_ostream OS(Name);
+  OS << Digest << '-' << ConfigurationHash << ".pth";
+  return OS.str();
+}
+
+std::string
+SharedTokenCache::getEntryPath(const llvm::MemoryBuffer &Buffer) const {
+  SmallString<256> Path(Directory);
+  llvm::sys::path::append(Path, getEntryName(Buffer));
+  return Path.str();
+}
+
+bool SharedTokenCache::hasEntry(StringRef EntryName) const {
+  auto I = Entries.find(EntryName);
+  return I != Entries.end() && I->second;
+}
+
+PTHLexer *SharedTokenCache::CreateLexer(FileID FID) {
+  SourceManager &SM = PP.getSourceManager();
+
+  // Only headers are worth caching; the main file is almost always unique
+  // to this compile.
+  if (!SM.getFileEntryForID(FID) || FID == SM.getMainFileID())
+    return nullptr;
+
+  bool Invalid = false;
+  const llvm::MemoryBuffer *Buffer = SM.getBuffer(FID, &Invalid);
+  if (Invalid)
+    return nullptr;
+
+  std::string Name = getEntryName(*Buffer);
+  auto Result = Entries.insert(
+      std::make_pair(Name, std::unique_ptr<PTHManager>()));
+  std::unique_ptr<PTHManager> &Entry = Result.first->second;
+
+  // Map the entry the first time we see these contents.  A failed lookup is
+  // remembered as a null entry so we don't probe the directory again.
+  if (Result.second) {
+    SmallString<256> Path(Directory);
+    llvm::sys::path::append(Path, Name);
+    Entry.reset(PTHManager::CreateForTokenCache(Path));
+    if (Entry)
+      Entry->setPreprocessor(&PP);
+  }
+
+  PTHLexer *PL = Entry ? Entry->CreateLexerForCachedFile(FID) : nullptr;
+  if (PL)
+    ++NumHits;
+  else
+    ++NumMisses;
+  return PL;
+}
+
+void SharedTokenCache::PrintStats() const {
+  llvm::errs() << "\n*** Shared Token Cache Stats:\n";
+  llvm::errs() << NumHits << " cache hits, " << NumMisses
+               << " cache misses.\n";
+}
@@ -43,6 +43,7 @@ void TokenLexer::Init(Token &Tok, SourceLocation ELEnd, MacroInfo *MI,
   DisableMacroExpansion = false;
   NumTokens = Macro->tokens_end()-Macro->tokens_begin();
   MacroExpansionStart = SourceLocation();
+  IsConstantExpansion = false;
 
   SourceManager &SM = PP.getSourceManager();
   MacroStartSLocOffset = SM.getNextLocalOffset();
@@ -63,6 +64,7 @@ void TokenLexer::Init(Token &Tok, SourceLocation ELEnd, MacroInfo *MI,
                                                 ExpandLocStart,
                                                 ExpandLocEnd,
                                                 MacroDefLength);
+    IsConstantExpansion = Macro->hasConstantBody();
   }
 
   // If this is a function-like macro, expand the arguments and change
@@ -91,6 +93,7 @@ void TokenLexer::Init(const Token *TokArray, unsigned NumToks,
   DisableMacroExpansion = disableMacroExpansion;
   NumTokens = NumToks;
   CurToken = 0;
+  IsConstantExpansion = false;
   ExpandLocStart = ExpandLocEnd = SourceLocation();
   AtStartOfLine = false;
   HasLeadingSpace = false;
@@ -267,11 +270,10 @@ void TokenLexer::ExpandFunctionArguments() {
 
       // Only preexpand the argument if it could possibly need it.  This
       // avoids some work in common cases.
-      const Token *ArgTok = ActualArgs->getUnexpArgument(ArgNo);
-      if (ActualArgs->ArgNeedsPreexpansion(ArgTok, PP))
+      if (ActualArgs->ArgNeedsPreexpansion(ArgNo, Macro, PP))
         ResultArgToks = &ActualArgs->getPreExpArgument(ArgNo, Macro, PP)[0];
       else
-        ResultArgToks = ArgTok;  // Use non-preexpanded tokens.
+        ResultArgToks = ActualArgs->getUnexpArgument(ArgNo);  // Unexpanded.
 
       // If the arg token expanded into anything, append it.
       if (ResultArgToks->isNot(tok::eof)) {
@@ -444,7 +446,7 @@ bool TokenLexer::Lex(Token &Tok) {
 
   // If this token is followed by a token paste (##) operator, paste the tokens!
   // Note that ## is a normal token when not expanding a macro.
-  if (!isAtEnd() && Macro &&
+  if (!IsConstantExpansion && !isAtEnd() && Macro &&
       (Tokens[CurToken].is(tok::hashhash) ||
        // Special processing of L#x macros in -fms-compatibility mode.
        // Microsoft compiler is able to form a wide string literal from
@@ -464,7 +466,12 @@ bool TokenLexer::Lex(Token &Tok) {
   // diagnostics for the expanded token should appear as if they came from
   // ExpansionLoc.  Pull this information together into a new SourceLocation
   // that captures all of this.
-  if (ExpandLocStart.isValid() &&   // Don't do this for token streams.
+  if (IsConstantExpansion) {
+    // Every token of a constant body comes straight from the definition, so
+    // it sits at the same offset in the expansion as in the definition.
+    Tok.setLocation(MacroExpansionStart.getLocWithOffset(
+        Tok.getLocation().getRawEncoding() - MacroDefStart.getRawEncoding()));
+  } else if (ExpandLocStart.isValid() &&   // Don't do this for token streams.
       // Check that the token's location was not already set properly.
       SM.isBeforeInSLocAddrSpace(Tok.getLocation(), MacroStartSLocOffset)) {
     SourceLocation instLoc;
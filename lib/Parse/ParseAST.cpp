@@ -16,6 +16,8 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ExternalASTSource.h"
 #include "clang/AST/Stmt.h"
+#include "clang/Basic/TimeTrace.h"
+#include "clang/Lex/PPCallbacks.h"
 #include "clang/Parse/ParseDiagnostic.h"
 #include "clang/Parse/Parser.h"
 #include "clang/Sema/CodeCompleteConsumer.h"
@@ -85,6 +87,32 @@ void PrettyStackTraceParserEntry::print(raw_ostream &OS) const {
   }
 }
 
+/// Records the time spent in each #included file in the time trace.
+class TimeTraceIncludeCallbacks : public PPCallbacks {
+  const SourceManager &SM;
+  bool EnteredMainFile = false;
+  std::vector<std::unique_ptr<TimeTraceScope>> OpenFiles;
+
+public:
+  TimeTraceIncludeCallbacks(const SourceManager &SM) : SM(SM) {}
+
+  void FileChanged(SourceLocation Loc, FileChangeReason Reason,
+                   SrcMgr::CharacteristicKind FileType,
+                   FileID PrevFID) override {
+    if (Reason == EnterFile) {
+      // The main file is never exited; the "Frontend" event covers it.
+      if (!EnteredMainFile) {
+        EnteredMainFile = true;
+        return;
+      }
+      OpenFiles.push_back(llvm::make_unique<TimeTraceScope>(
+          "Source", [&] { return std::string(SM.getBufferName(Loc)); }));
+    } else if (Reason == ExitFile && !OpenFiles.empty()) {
+      OpenFiles.pop_back();
+    }
+  }
+};
+
 }  // namespace
 
 //===----------------------------------------------------------------------===//
@@ -135,6 +163,13 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
   llvm::CrashRecoveryContextCleanupRegistrar<Parser>
     CleanupParser(ParseOP.get());
 
+  std::unique_ptr<TimeTraceScope> FrontendScope;
+  if (isTimeTraceEnabled()) {
+    FrontendScope = llvm::make_unique<TimeTraceScope>("Frontend");
+    S.getPreprocessor().addPPCallbacks(
+        llvm::make_unique<TimeTraceIncludeCallbacks>(S.getSourceManager()));
+  }
+
   S.getPreprocessor().EnterMainSourceFile();
   P.Initialize();
 
@@ -163,7 +198,8 @@ void clang::ParseAST(Sema &S, bool PrintStats, bool SkipFunctionBodies) {
   // Process any TopLevelDecls generated by #pragma weak.
   for (Decl *D : S.WeakTopLevelDecls())
     Consumer->HandleTopLevelDecl(DeclGroupRef(D));
-  
+  FrontendScope.reset();
+
   Consumer->HandleTranslationUnit(S.getASTContext());
 
   std::swap(OldCollectStats, S.CollectStats);
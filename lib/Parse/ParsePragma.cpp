@@ -145,6 +145,18 @@ private:
   Sema &Actions;
 };
 
+/// PragmaNeonLazyIntrinsicsHandler - "\#pragma clang neon_lazy_intrinsics N",
+/// which arm_neon.h uses to enable a group of intrinsics under
+/// -flazy-neon-intrinsics.
+struct PragmaNeonLazyIntrinsicsHandler : public PragmaHandler {
+  PragmaNeonLazyIntrinsicsHandler(Sema &S)
+    : PragmaHandler("neon_lazy_intrinsics"), Actions(S) {}
+  void HandlePragma(Preprocessor &PP, PragmaIntroducerKind Introducer,
+                    Token &FirstToken) override;
+private:
+  Sema &Actions;
+};
+
 struct PragmaLoopHintHandler : public PragmaHandler {
   PragmaLoopHintHandler() : PragmaHandler("loop") {}
   void HandlePragma(Preprocessor &PP, PragmaIntroducerKind Introducer,
@@ -234,6 +246,9 @@ void Parser::initializePragmaHandlers() {
   OptimizeHandler.reset(new PragmaOptimizeHandler(Actions));
   PP.AddPragmaHandler("clang", OptimizeHandler.get());
 
+  NeonLazyIntrinsicsHandler.reset(new PragmaNeonLazyIntrinsicsHandler(Actions));
+  PP.AddPragmaHandler("clang", NeonLazyIntrinsicsHandler.get());
+
   LoopHintHandler.reset(new PragmaLoopHintHandler());
   PP.AddPragmaHandler("clang", LoopHintHandler.get());
 
@@ -305,6 +320,9 @@ void Parser::resetPragmaHandlers() {
   PP.RemovePragmaHandler("clang", OptimizeHandler.get());
   OptimizeHandler.reset();
 
+  PP.RemovePragmaHandler("clang", NeonLazyIntrinsicsHandler.get());
+  NeonLazyIntrinsicsHandler.reset();
+
   PP.RemovePragmaHandler("clang", LoopHintHandler.get());
   LoopHintHandler.reset();
 
@@ -826,25 +844,31 @@ bool Parser::HandlePragmaLoopHint(LoopHint &Hint) {
 
   // If no option is specified the argument is assumed to be a constant expr.
   bool OptionUnroll = false;
-  bool OptionDistribute = false;
+  bool OptionPipeline = false;
   bool StateOption = false;
+  bool AssumeSafetyArg = false;
   if (OptionInfo) { // Pragma Unroll does not specify an option.
     OptionUnroll = OptionInfo->isStr("unroll");
-    OptionDistribute = OptionInfo->isStr("distribute");
+    OptionPipeline = OptionInfo->isStr("pipeline");
+    AssumeSafetyArg = OptionInfo->isStr("vectorize") ||
+                      OptionInfo->isStr("interleave");
     StateOption = llvm::StringSwitch<bool>(OptionInfo->getName())
-                      .Case("vectorize", true)
-                      .Case("interleave", true)
+                      .Case("distribute", true)
+                      .Case("unroll_and_jam", true)
+                      .Case("vectorize_predicate", true)
                       .Default(false) ||
-                  OptionUnroll || OptionDistribute;
+                  OptionUnroll || OptionPipeline || AssumeSafetyArg;
   }
 
-  bool AssumeSafetyArg = !OptionUnroll && !OptionDistribute;
   // Verify loop hint has an argument.
   if (Toks[0].is(tok::eof)) {
     ConsumeToken(); // The annotation token.
-    Diag(Toks[0].getLocation(), diag::err_pragma_loop_missing_argument)
-        << /*StateArgument=*/StateOption << /*FullKeyword=*/OptionUnroll
-        << /*AssumeSafetyKeyword=*/AssumeSafetyArg;
+    if (OptionPipeline)
+      Diag(Toks[0].getLocation(), diag::err_pragma_pipeline_invalid_keyword);
+    else
+      Diag(Toks[0].getLocation(), diag::err_pragma_loop_missing_argument)
+          << /*StateArgument=*/StateOption << /*FullKeyword=*/OptionUnroll
+          << /*AssumeSafetyKeyword=*/AssumeSafetyArg;
     return false;
   }
 
@@ -856,14 +880,18 @@ bool Parser::HandlePragmaLoopHint(LoopHint &Hint) {
 
     bool Valid = StateInfo &&
                  llvm::StringSwitch<bool>(StateInfo->getName())
-                     .Cases("enable", "disable", true)
+                     .Case("enable", !OptionPipeline)
+                     .Case("disable", true)
                      .Case("full", OptionUnroll)
                      .Case("assume_safety", AssumeSafetyArg)
                      .Default(false);
     if (!Valid) {
-      Diag(Toks[0].getLocation(), diag::err_pragma_invalid_keyword)
-          << /*FullKeyword=*/OptionUnroll
-          << /*AssumeSafetyKeyword=*/AssumeSafetyArg;
+      if (OptionPipeline)
+        Diag(Toks[0].getLocation(), diag::err_pragma_pipeline_invalid_keyword);
+      else
+        Diag(Toks[0].getLocation(), diag::err_pragma_invalid_keyword)
+            << /*FullKeyword=*/OptionUnroll
+            << /*AssumeSafetyKeyword=*/AssumeSafetyArg;
       return false;
     }
     if (Toks.size() > 2)
@@ -1901,6 +1929,27 @@ void PragmaOptimizeHandler::HandlePragma(Preprocessor &PP,
   Actions.ActOnPragmaOptimize(IsOn, FirstToken.getLocation());
 }
 
+void PragmaNeonLazyIntrinsicsHandler::HandlePragma(
+    Preprocessor &PP, PragmaIntroducerKind Introducer, Token &FirstToken) {
+  Token Tok;
+  PP.Lex(Tok);
+  uint64_t Group;
+  if (Tok.isNot(tok::numeric_constant) ||
+      !PP.parseSimpleIntegerLiteral(Tok, Group)) {
+    PP.Diag(Tok.getLocation(), diag::err_pragma_missing_argument)
+        << "clang neon_lazy_intrinsics" << /*Expected=*/true
+        << "a group number";
+    return;
+  }
+  if (Tok.isNot(tok::eod)) {
+    PP.Diag(Tok.getLocation(), diag::warn_pragma_extra_tokens_at_eol)
+        << "clang neon_lazy_intrinsics";
+    return;
+  }
+
+  Actions.ActOnPragmaNeonLazyIntrinsics(Group, FirstToken.getLocation());
+}
+
 /// \brief Parses loop or unroll pragma hint value and fills in Info.
 static bool ParseLoopHintValue(Preprocessor &PP, Token &Tok, Token PragmaName,
                                Token Option, bool ValueInParens,
@@ -1956,6 +2005,12 @@ static bool ParseLoopHintValue(Preprocessor &PP, Token &Tok, Token PragmaName,
 ///    'vectorize_width' '(' loop-hint-value ')'
 ///    'interleave_count' '(' loop-hint-value ')'
 ///    'unroll_count' '(' loop-hint-value ')'
+///    'distribute' '(' loop-hint-keyword ')'
+///    'unroll_and_jam' '(' loop-hint-keyword ')'
+///    'unroll_and_jam_count' '(' loop-hint-value ')'
+///    'pipeline' '(' 'disable' ')'
+///    'pipeline_initiation_interval' '(' loop-hint-value ')'
+///    'vectorize_predicate' '(' loop-hint-keyword ')'
 ///
 ///  loop-hint-keyword:
 ///    'enable'
@@ -1988,6 +2043,14 @@ static bool ParseLoopHintValue(Preprocessor &PP, Token &Tok, Token PragmaName,
 /// compile time.  Specifying unroll(disable) disables unrolling for the
 /// loop. Specifying unroll_count(_value_) instructs llvm to try to unroll the
 /// loop the number of times indicated by the value.
+///
+/// The unroll_and_jam and unroll_and_jam_count directives likewise control the
+/// unrolling of an outer loop with the fusion of the copies of its inner loop.
+/// Specifying pipeline(disable) keeps llvm from software pipelining the loop,
+/// and pipeline_initiation_interval(_value_) requests the initiation interval
+/// of the pipelined loop. Specifying vectorize_predicate(enable) asks for the
+/// vectorized loop to handle its remaining iterations with masked operations
+/// rather than a scalar epilogue.
 void PragmaLoopHintHandler::HandlePragma(Preprocessor &PP,
                                          PragmaIntroducerKind Introducer,
                                          Token &Tok) {
@@ -2015,6 +2078,11 @@ void PragmaLoopHintHandler::HandlePragma(Preprocessor &PP,
                            .Case("vectorize_width", true)
                            .Case("interleave_count", true)
                            .Case("unroll_count", true)
+                           .Case("unroll_and_jam", true)
+                           .Case("unroll_and_jam_count", true)
+                           .Case("pipeline", true)
+                           .Case("pipeline_initiation_interval", true)
+                           .Case("vectorize_predicate", true)
                            .Default(false);
     if (!OptionValid) {
       PP.Diag(Tok.getLocation(), diag::err_pragma_loop_invalid_option)
@@ -1665,30 +1665,62 @@ bool Parser::isCXXFunctionDeclarator(bool *IsAmbiguous) {
   // ambiguities mentioned in 6.8, the resolution is to consider any construct
   // that could possibly be a declaration a declaration.
 
-  RevertingTentativeParsingAction PA(*this);
+  // The same parentheses are usually disambiguated once while tentatively
+  // parsing a declaration statement and again while parsing the declarator,
+  // and nested declarators may ask about them many times. The answer only
+  // depends on the identifiers declared so far within the statement and on
+  // what name lookup finds, so it is only reused from the same scope and
+  // context while no declaration has been pushed onto the scope chains.
+  unsigned ParenLoc = Tok.getLocation().getRawEncoding();
+  auto Known = FunctionDeclaratorResults.find(ParenLoc);
+  if (Known != FunctionDeclaratorResults.end() &&
+      Known->second.S == getCurScope() &&
+      Known->second.DC == Actions.CurContext &&
+      Known->second.NumScopeChainDecls == Actions.NumScopeChainDecls &&
+      Known->second.TentativelyDeclared == TentativelyDeclaredIdentifiers) {
+    TPResult TPR = Known->second.Result;
+    if (IsAmbiguous && TPR == TPResult::Ambiguous)
+      *IsAmbiguous = true;
+    return TPR != TPResult::False;
+  }
 
-  ConsumeParen();
-  bool InvalidAsDeclaration = false;
-  TPResult TPR = TryParseParameterDeclarationClause(&InvalidAsDeclaration);
-  if (TPR == TPResult::Ambiguous) {
-    if (Tok.isNot(tok::r_paren))
-      TPR = TPResult::False;
-    else {
-      const Token &Next = NextToken();
-      if (Next.isOneOf(tok::amp, tok::ampamp, tok::kw_const, tok::kw_volatile,
-                       tok::kw_throw, tok::kw_noexcept, tok::l_square,
-                       tok::l_brace, tok::kw_try, tok::equal, tok::arrow) ||
-          isCXX11VirtSpecifier(Next))
-        // The next token cannot appear after a constructor-style initializer,
-        // and can appear next in a function definition. This must be a function
-        // declarator.
-        TPR = TPResult::True;
-      else if (InvalidAsDeclaration)
-        // Use the absence of 'typename' as a tie-breaker.
+  TPResult TPR;
+  {
+    RevertingTentativeParsingAction PA(*this);
+
+    ConsumeParen();
+    bool InvalidAsDeclaration = false;
+    TPR = TryParseParameterDeclarationClause(&InvalidAsDeclaration);
+    if (TPR == TPResult::Ambiguous) {
+      if (Tok.isNot(tok::r_paren))
         TPR = TPResult::False;
+      else {
+        const Token &Next = NextToken();
+        if (Next.isOneOf(tok::amp, tok::ampamp, tok::kw_const,
+                         tok::kw_volatile, tok::kw_throw, tok::kw_noexcept,
+                         tok::l_square, tok::l_brace, tok::kw_try, tok::equal,
+                         tok::arrow) ||
+            isCXX11VirtSpecifier(Next))
+          // The next token cannot appear after a constructor-style
+          // initializer, and can appear next in a function definition. This
+          // must be a function declarator.
+          TPR = TPResult::True;
+        else if (InvalidAsDeclaration)
+          // Use the absence of 'typename' as a tie-breaker.
+          TPR = TPResult::False;
+      }
     }
   }
 
+  FunctionDeclaratorDisambiguation &Result =
+      FunctionDeclaratorResults[ParenLoc];
+  Result.TentativelyDeclared.assign(TentativelyDeclaredIdentifiers.begin(),
+                                    TentativelyDeclaredIdentifiers.end());
+  Result.S = getCurScope();
+  Result.DC = Actions.CurContext;
+  Result.NumScopeChainDecls = Actions.NumScopeChainDecls;
+  Result.Result = TPR;
+
   if (IsAmbiguous && TPR == TPResult::Ambiguous)
     *IsAmbiguous = true;
 
@@ -431,6 +431,9 @@ Parser::~Parser() {
 
   resetPragmaHandlers();
 
+  if (getLangOpts().LazyNeonIntrinsics)
+    Actions.SetLazyNeonIntrinsicParser(nullptr, nullptr);
+
   PP.removeCommentHandler(CommentSemaHandler.get());
 
   PP.clearCodeCompletionHandler();
@@ -526,10 +529,66 @@ void Parser::Initialize() {
 
   Actions.Initialize();
 
+  if (getLangOpts().LazyNeonIntrinsics)
+    Actions.SetLazyNeonIntrinsicParser(LazyNeonIntrinsicParserCallback, this);
+
   // Prime the lexer look-ahead.
   ConsumeToken();
 }
 
+void Parser::LazyNeonIntrinsicParserCallback(void *P, StringRef Definition) {
+  ((Parser *)P)->ParseLazyNeonIntrinsic(Definition);
+}
+
+/// \brief Parse the definition of a NEON intrinsic from arm_neon.h that is
+/// being used for the first time. Sema asks for it during name lookup, so
+/// the parser can be anywhere; the definition is parsed at translation unit
+/// scope and parsing resumes at the current token.
+void Parser::ParseLazyNeonIntrinsic(StringRef Definition) {
+  SourceManager &SM = PP.getSourceManager();
+  FileID FID = SM.createFileID(
+      llvm::MemoryBuffer::getMemBuffer(Definition, "<arm_neon.h>"),
+      SrcMgr::C_System, /*LoadedID=*/0, /*LoadedOffset=*/0,
+      Tok.getLocation());
+
+  // The definitions use no macros, so they can be lexed raw.
+  Lexer RawLex(FID, SM.getBuffer(FID), SM, getLangOpts());
+  CachedTokens Toks;
+  Token RawTok;
+  for (RawLex.LexFromRawLexer(RawTok); RawTok.isNot(tok::eof);
+       RawLex.LexFromRawLexer(RawTok)) {
+    if (RawTok.is(tok::raw_identifier))
+      PP.LookUpIdentifierInfo(RawTok);
+    Toks.push_back(RawTok);
+  }
+  if (Toks.empty())
+    return;
+
+  // Append the current token so that parsing picks up where it left off.
+  auto Buffer = llvm::make_unique<Token[]>(Toks.size() + 1);
+  std::copy(Toks.begin(), Toks.end(), Buffer.get());
+  Buffer[Toks.size()] = Tok;
+  PP.EnterTokenStream(std::move(Buffer), Toks.size() + 1,
+                      /*DisableMacroExpansion=*/true);
+
+  SourceLocation SavedPrevTokLocation = PrevTokLocation;
+  ParenBraceBracketBalancer BalancerRAIIObj(*this);
+  GreaterThanIsOperatorScope G(GreaterThanIsOperator, true);
+  ColonProtectionRAIIObject ColonProtection(*this, false);
+  InMessageExpressionRAIIObject InMessage(*this, false);
+  Sema::ContextRAII SavedContext(Actions,
+                                 Actions.Context.getTranslationUnitDecl());
+  Scope *SavedScope = Actions.CurScope;
+  Actions.CurScope = Actions.TUScope;
+
+  ConsumeAnyToken(/*ConsumeCodeCompletionTok=*/true);
+  ParsedAttributesWithRange Attrs(AttrFactory);
+  ParseExternalDeclaration(Attrs);
+
+  Actions.CurScope = SavedScope;
+  PrevTokLocation = SavedPrevTokLocation;
+}
+
 void Parser::LateTemplateParserCleanupCallback(void *P) {
   // While this RAII helper doesn't bracket any actual work, the destructor will
   // clean up annotations that were created during ActOnEndOfTranslationUnit
@@ -541,6 +600,7 @@ void Parser::LateTemplateParserCleanupCallback(void *P) {
 /// action tells us to.  This returns true if the EOF was encountered.
 bool Parser::ParseTopLevelDecl(DeclGroupPtrTy &Result) {
   DestroyTemplateIdAnnotationsRAIIObj CleanupRAII(TemplateIds);
+  FunctionDeclaratorResults.clear();
 
   // Skip over the EOF token, flagging end of previous input for incremental
   // processing
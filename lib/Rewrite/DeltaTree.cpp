@@ -13,6 +13,7 @@
 
 #include "clang/Rewrite/Core/DeltaTree.h"
 #include "clang/Basic/LLVM.h"
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 using namespace clang;
@@ -31,6 +32,9 @@ using namespace clang;
 /// former and adds children pointers.  Each node knows the full delta of all
 /// entries (recursively) contained inside of it, which allows us to get the
 /// full delta implied by a whole subtree in constant time.
+///
+/// Entries are never removed, so the nodes are allocated from an arena owned
+/// by the tree and are never freed individually.
 
 namespace {
   /// SourceDelta - As code in the original input buffer is added and deleted,
@@ -63,8 +67,9 @@ namespace {
     /// WidthFactor - This controls the number of K/V slots held in the BTree:
     /// how wide it is.  Each level of the BTree is guaranteed to have at least
     /// WidthFactor-1 K/V pairs (except the root) and may have at most
-    /// 2*WidthFactor-1 K/V pairs.
-    enum { WidthFactor = 8 };
+    /// 2*WidthFactor-1 K/V pairs.  Wide nodes keep the tree shallow, so a
+    /// lookup touches few cache lines.
+    enum { WidthFactor = 16 };
 
     /// Values - This tracks the SourceDelta's currently in this node.
     ///
@@ -103,16 +108,30 @@ namespace {
     /// this node.  If insertion is easy, do it and return false.  Otherwise,
     /// split the node, populate InsertRes with info about the split, and return
     /// true.
-    bool DoInsertion(unsigned FileIndex, int Delta, InsertResult *InsertRes);
+    bool DoInsertion(unsigned FileIndex, int Delta, InsertResult *InsertRes,
+                     llvm::BumpPtrAllocator &Allocator);
 
-    void DoSplit(InsertResult &InsertRes);
+    void DoSplit(InsertResult &InsertRes, llvm::BumpPtrAllocator &Allocator);
 
 
     /// RecomputeFullDeltaLocally - Recompute the FullDelta field by doing a
     /// local walk over our contained deltas.
     void RecomputeFullDeltaLocally();
 
-    void Destroy();
+    /// Build - Build a subtree of the given height holding the Count deltas
+    /// starting at Deltas.  Count must be in the range allowed for a subtree
+    /// of that height, see DeltaTree::DeltaTree().
+    static DeltaTreeNode *Build(const std::pair<unsigned, int> *Deltas,
+                                size_t Count, unsigned Height, bool IsRoot,
+                                llvm::BumpPtrAllocator &Allocator);
+
+    /// getMaxValuesPlusOne - Return one more than the number of values a
+    /// subtree of the given height can hold.
+    static uint64_t getMaxValuesPlusOne(unsigned Height);
+
+    /// getMinValuesPlusOne - Return one more than the number of values that a
+    /// subtree of the given height, other than the root, must hold.
+    static uint64_t getMinValuesPlusOne(unsigned Height);
   };
 } // end anonymous namespace
 
@@ -121,10 +140,6 @@ namespace {
   /// This class tracks them.
   class DeltaTreeInteriorNode : public DeltaTreeNode {
     DeltaTreeNode *Children[2*WidthFactor];
-    ~DeltaTreeInteriorNode() {
-      for (unsigned i = 0, e = NumValuesUsed+1; i != e; ++i)
-        Children[i]->Destroy();
-    }
     friend class DeltaTreeNode;
   public:
     DeltaTreeInteriorNode() : DeltaTreeNode(false /*nonleaf*/) {}
@@ -152,14 +167,6 @@ namespace {
 }
 
 
-/// Destroy - A 'virtual' destructor.
-void DeltaTreeNode::Destroy() {
-  if (isLeaf())
-    delete this;
-  else
-    delete cast<DeltaTreeInteriorNode>(this);
-}
-
 /// RecomputeFullDeltaLocally - Recompute the FullDelta field by doing a
 /// local walk over our contained deltas.
 void DeltaTreeNode::RecomputeFullDeltaLocally() {
@@ -177,7 +184,8 @@ void DeltaTreeNode::RecomputeFullDeltaLocally() {
 /// split the node, populate InsertRes with info about the split, and return
 /// true.
 bool DeltaTreeNode::DoInsertion(unsigned FileIndex, int Delta,
-                                InsertResult *InsertRes) {
+                                InsertResult *InsertRes,
+                                llvm::BumpPtrAllocator &Allocator) {
   // Maintain full delta for this node.
   FullDelta += Delta;
 
@@ -213,18 +221,20 @@ bool DeltaTreeNode::DoInsertion(unsigned FileIndex, int Delta,
     // Otherwise, if this is leaf is full, split the node at its median, insert
     // the value into one of the children, and return the result.
     assert(InsertRes && "No result location specified");
-    DoSplit(*InsertRes);
+    DoSplit(*InsertRes, Allocator);
 
     if (InsertRes->Split.FileLoc > FileIndex)
-      InsertRes->LHS->DoInsertion(FileIndex, Delta, nullptr /*can't fail*/);
+      InsertRes->LHS->DoInsertion(FileIndex, Delta, nullptr /*can't fail*/,
+                                  Allocator);
     else
-      InsertRes->RHS->DoInsertion(FileIndex, Delta, nullptr /*can't fail*/);
+      InsertRes->RHS->DoInsertion(FileIndex, Delta, nullptr /*can't fail*/,
+                                  Allocator);
     return true;
   }
 
   // Otherwise, this is an interior node.  Send the request down the tree.
   DeltaTreeInteriorNode *IN = cast<DeltaTreeInteriorNode>(this);
-  if (!IN->Children[i]->DoInsertion(FileIndex, Delta, InsertRes))
+  if (!IN->Children[i]->DoInsertion(FileIndex, Delta, InsertRes, Allocator))
     return false; // If there was space in the child, just return.
 
   // Okay, this split the subtree, producing a new value and two children to
@@ -254,7 +264,7 @@ bool DeltaTreeNode::DoInsertion(unsigned FileIndex, int Delta,
   SourceDelta SubSplit = InsertRes->Split;
 
   // Do the split.
-  DoSplit(*InsertRes);
+  DoSplit(*InsertRes, Allocator);
 
   // Figure out where to insert SubRHS/NewSplit.
   DeltaTreeInteriorNode *InsertSide;
@@ -290,7 +300,8 @@ bool DeltaTreeNode::DoInsertion(unsigned FileIndex, int Delta,
 /// DoSplit - Split the currently full node (which has 2*WidthFactor-1 values)
 /// into two subtrees each with "WidthFactor-1" values and a pivot value.
 /// Return the pieces in InsertRes.
-void DeltaTreeNode::DoSplit(InsertResult &InsertRes) {
+void DeltaTreeNode::DoSplit(InsertResult &InsertRes,
+                            llvm::BumpPtrAllocator &Allocator) {
   assert(isFull() && "Why split a non-full node?");
 
   // Since this node is full, it contains 2*WidthFactor-1 values.  We move
@@ -303,13 +314,13 @@ void DeltaTreeNode::DoSplit(InsertResult &InsertRes) {
   if (DeltaTreeInteriorNode *IN = dyn_cast<DeltaTreeInteriorNode>(this)) {
     // If this is an interior node, also move over 'WidthFactor' children
     // into the new node.
-    DeltaTreeInteriorNode *New = new DeltaTreeInteriorNode();
+    DeltaTreeInteriorNode *New = new (Allocator) DeltaTreeInteriorNode();
     memcpy(&New->Children[0], &IN->Children[WidthFactor],
            WidthFactor*sizeof(IN->Children[0]));
     NewNode = New;
   } else {
     // Just create the new leaf node.
-    NewNode = new DeltaTreeNode();
+    NewNode = new (Allocator) DeltaTreeNode();
   }
 
   // Move over the last 'WidthFactor-1' values from here to NewNode.
@@ -328,6 +339,64 @@ void DeltaTreeNode::DoSplit(InsertResult &InsertRes) {
   InsertRes.Split = Values[WidthFactor-1];
 }
 
+uint64_t DeltaTreeNode::getMaxValuesPlusOne(unsigned Height) {
+  // A node holds up to 2*WidthFactor-1 values and 2*WidthFactor children.
+  uint64_t Result = 2*WidthFactor;
+  for (unsigned i = 0; i != Height; ++i)
+    Result *= 2*WidthFactor;
+  return Result;
+}
+
+uint64_t DeltaTreeNode::getMinValuesPlusOne(unsigned Height) {
+  // A node other than the root holds at least WidthFactor-1 values and
+  // WidthFactor children.
+  uint64_t Result = WidthFactor;
+  for (unsigned i = 0; i != Height; ++i)
+    Result *= WidthFactor;
+  return Result;
+}
+
+DeltaTreeNode *DeltaTreeNode::Build(const std::pair<unsigned, int> *Deltas,
+                                    size_t Count, unsigned Height, bool IsRoot,
+                                    llvm::BumpPtrAllocator &Allocator) {
+  if (Height == 0) {
+    DeltaTreeNode *Leaf = new (Allocator) DeltaTreeNode();
+    for (size_t i = 0; i != Count; ++i)
+      Leaf->Values[i] = SourceDelta::get(Deltas[i].first, Deltas[i].second);
+    Leaf->NumValuesUsed = Count;
+    Leaf->RecomputeFullDeltaLocally();
+    return Leaf;
+  }
+
+  // Use as few children as the child height allows, but at least as many as
+  // a node needs.  The values are then spread evenly over the children, with
+  // one value between each two of them, which keeps every child within the
+  // bounds of its height.
+  uint64_t MaxChildPlusOne = getMaxValuesPlusOne(Height-1);
+  unsigned NumChildren = (Count + MaxChildPlusOne) / MaxChildPlusOne;
+  NumChildren = std::max(NumChildren, IsRoot ? 2U : unsigned(WidthFactor));
+  assert(NumChildren <= 2*WidthFactor && "Too many values for height");
+  assert((Count+1) / NumChildren >= getMinValuesPlusOne(Height-1) &&
+         "Too few values for height");
+
+  DeltaTreeInteriorNode *IN = new (Allocator) DeltaTreeInteriorNode();
+  size_t ChildValues = Count - (NumChildren-1);
+  size_t Pos = 0;
+  for (unsigned i = 0; i != NumChildren; ++i) {
+    size_t Size = ChildValues / NumChildren + (i < ChildValues % NumChildren);
+    IN->Children[i] = Build(Deltas + Pos, Size, Height-1, false, Allocator);
+    Pos += Size;
+    if (i != NumChildren-1) {
+      IN->Values[i] = SourceDelta::get(Deltas[Pos].first, Deltas[Pos].second);
+      ++Pos;
+    }
+  }
+  assert(Pos == Count && "Not all values placed");
+  IN->NumValuesUsed = NumChildren-1;
+  IN->RecomputeFullDeltaLocally();
+  return IN;
+}
+
 
 
 //===----------------------------------------------------------------------===//
@@ -385,17 +454,39 @@ static DeltaTreeNode *getRoot(void *Root) {
 }
 
 DeltaTree::DeltaTree() {
-  Root = new DeltaTreeNode();
+  Root = new (Allocator) DeltaTreeNode();
 }
+
+DeltaTree::DeltaTree(ArrayRef<std::pair<unsigned, int>> Deltas) {
+  // Find the lowest tree that can hold all the deltas.
+  unsigned Height = 0;
+  while (Deltas.size() + 1 > DeltaTreeNode::getMaxValuesPlusOne(Height))
+    ++Height;
+  Root = DeltaTreeNode::Build(Deltas.data(), Deltas.size(), Height,
+                              /*IsRoot=*/true, Allocator);
+
+#ifdef VERIFY_TREE
+  VerifyTree(getRoot(Root));
+#endif
+}
+
 DeltaTree::DeltaTree(const DeltaTree &RHS) {
   // Currently we only support copying when the RHS is empty.
-  assert(getRoot(RHS.Root)->getNumValuesUsed() == 0 &&
-         "Can only copy empty tree");
-  Root = new DeltaTreeNode();
+  assert(RHS.empty() && "Can only copy empty tree");
+  Root = new (Allocator) DeltaTreeNode();
 }
 
 DeltaTree::~DeltaTree() {
-  getRoot(Root)->Destroy();
+  // The nodes are freed with the allocator.
+}
+
+bool DeltaTree::empty() const {
+  return getRoot(Root)->getNumValuesUsed() == 0;
+}
+
+void DeltaTree::swap(DeltaTree &RHS) {
+  std::swap(Allocator, RHS.Allocator);
+  std::swap(Root, RHS.Root);
 }
 
 /// getDeltaAt - Return the accumulated delta at the specified file offset.
@@ -453,8 +544,8 @@ void DeltaTree::AddDelta(unsigned FileIndex, int Delta) {
   DeltaTreeNode *MyRoot = getRoot(Root);
 
   DeltaTreeNode::InsertResult InsertRes;
-  if (MyRoot->DoInsertion(FileIndex, Delta, &InsertRes)) {
-    Root = MyRoot = new DeltaTreeInteriorNode(InsertRes);
+  if (MyRoot->DoInsertion(FileIndex, Delta, &InsertRes, Allocator)) {
+    Root = MyRoot = new (Allocator) DeltaTreeInteriorNode(InsertRes);
   }
 
 #ifdef VERIFY_TREE
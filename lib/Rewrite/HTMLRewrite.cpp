@@ -355,12 +355,27 @@ void html::AddHeaderFooterInternalBuiltinCSS(Rewriter& R, FileID FID,
 /// table state from the end of the file, so it won't be perfectly perfect,
 /// but it will be reasonably close.
 void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
-  RewriteBuffer &RB = R.getEditBuffer(FID);
+  std::vector<HighlightedRange> Ranges;
+  ComputeSyntaxHighlighting(FID, PP, Ranges);
+  ApplyHighlighting(R, FID, Ranges);
+}
+
+static void AddHighlightedRange(std::vector<html::HighlightedRange> &Ranges,
+                                unsigned B, unsigned E, StringRef StartTag,
+                                StringRef EndTag) {
+  html::HighlightedRange Range;
+  Range.B = B;
+  Range.E = E;
+  Range.StartTag = StartTag;
+  Range.EndTag = EndTag;
+  Ranges.push_back(std::move(Range));
+}
 
+void html::ComputeSyntaxHighlighting(FileID FID, const Preprocessor &PP,
+                                     std::vector<HighlightedRange> &Ranges) {
   const SourceManager &SM = PP.getSourceManager();
   const llvm::MemoryBuffer *FromFile = SM.getBuffer(FID);
   Lexer L(FID, FromFile, SM, PP.getLangOpts());
-  const char *BufferStart = L.getBuffer().data();
 
   // Inform the preprocessor that we want to retain comments as tokens, so we
   // can highlight them.
@@ -387,13 +402,13 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 
       // If this is a pp-identifier, for a keyword, highlight it as such.
       if (Tok.isNot(tok::identifier))
-        HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                       "<span class='keyword'>", "</span>");
+        AddHighlightedRange(Ranges, TokOffs, TokOffs+TokLen,
+                            "<span class='keyword'>", "</span>");
       break;
     }
     case tok::comment:
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='comment'>", "</span>");
+      AddHighlightedRange(Ranges, TokOffs, TokOffs+TokLen,
+                          "<span class='comment'>", "</span>");
       break;
     case tok::utf8_string_literal:
       // Chop off the u part of u8 prefix
@@ -409,8 +424,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       // FALL THROUGH.
     case tok::string_literal:
       // FIXME: Exclude the optional ud-suffix from the highlighted range.
-      HighlightRange(RB, TokOffs, TokOffs+TokLen, BufferStart,
-                     "<span class='string_literal'>", "</span>");
+      AddHighlightedRange(Ranges, TokOffs, TokOffs+TokLen,
+                          "<span class='string_literal'>", "</span>");
       break;
     case tok::hash: {
       // If this is a preprocessor directive, all tokens to end of line are too.
@@ -427,8 +442,8 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
       }
 
       // Find end of line.  This is a hack.
-      HighlightRange(RB, TokOffs, TokEnd, BufferStart,
-                     "<span class='directive'>", "</span>");
+      AddHighlightedRange(Ranges, TokOffs, TokEnd,
+                          "<span class='directive'>", "</span>");
 
       // Don't skip the next token.
       continue;
@@ -444,6 +459,13 @@ void html::SyntaxHighlight(Rewriter &R, FileID FID, const Preprocessor &PP) {
 /// macro expansions.  This won't be perfectly perfect, but it will be
 /// reasonably close.
 void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
+  std::vector<HighlightedRange> Ranges;
+  ComputeMacroHighlighting(FID, PP, Ranges);
+  ApplyHighlighting(R, FID, Ranges);
+}
+
+void html::ComputeMacroHighlighting(FileID FID, const Preprocessor &PP,
+                                    std::vector<HighlightedRange> &Ranges) {
   // Re-lex the raw token stream into a token buffer.
   const SourceManager &SM = PP.getSourceManager();
   std::vector<Token> TokenStream;
@@ -572,11 +594,28 @@ void html::HighlightMacros(Rewriter &R, FileID FID, const Preprocessor& PP) {
     // highlighted.
     Expansion = "<span class='expansion'>" + Expansion + "</span></span>";
 
-    HighlightRange(R, LLoc.first, LLoc.second,
-                   "<span class='macro'>", Expansion.c_str());
+    // Include the whole end token in the range.
+    unsigned EOffset = SM.getFileOffset(LLoc.second) +
+        Lexer::MeasureTokenLength(LLoc.second, SM, PP.getLangOpts());
+    AddHighlightedRange(Ranges, SM.getFileOffset(LLoc.first), EOffset,
+                        "<span class='macro'>", Expansion);
   }
 
   // Restore the preprocessor's old state.
   TmpPP.setDiagnostics(*OldDiags);
   TmpPP.setPragmasEnabled(PragmasPreviouslyEnabled);
 }
+
+void html::ApplyHighlighting(Rewriter &R, FileID FID,
+                             ArrayRef<HighlightedRange> Ranges) {
+  bool Invalid = false;
+  const char *BufferStart =
+      R.getSourceMgr().getBufferData(FID, &Invalid).data();
+  if (Invalid)
+    return;
+
+  RewriteBuffer &RB = R.getEditBuffer(FID);
+  for (const HighlightedRange &Range : Ranges)
+    HighlightRange(RB, Range.B, Range.E, BufferStart, Range.StartTag.c_str(),
+                   Range.EndTag.c_str());
+}
@@ -114,6 +114,70 @@ void RewriteBuffer::ReplaceText(unsigned OrigOffset, unsigned OrigLength,
     AddReplaceDelta(OrigOffset, NewStr.size() - OrigLength);
 }
 
+void RewriteBuffer::ApplyEdits(ArrayRef<Edit> Edits) {
+  // Map the edits into the current buffer.  A single pass applies them the
+  // same way as one ReplaceText() call after the other, as long as they are
+  // sorted both in the original buffer and in the current one, and don't
+  // overlap.  Edits at the same original offset don't see each other's deltas
+  // in ReplaceText(), so they are left to it.
+  SmallVector<unsigned, 64> RealOffsets;
+  RealOffsets.reserve(Edits.size());
+  unsigned PrevOrigOffset = 0, PrevRealEnd = 0;
+  size_t NewSize = size();
+  bool InOnePass = Edits.size() > 1;
+  for (unsigned I = 0, N = Edits.size(); InOnePass && I != N; ++I) {
+    const Edit &E = Edits[I];
+    unsigned RealOffset = getMappedOffset(E.OrigOffset, true);
+    if ((I != 0 && E.OrigOffset <= PrevOrigOffset) ||
+        RealOffset < PrevRealEnd || RealOffset + E.OrigLength > size())
+      InOnePass = false;
+    RealOffsets.push_back(RealOffset);
+    PrevOrigOffset = E.OrigOffset;
+    PrevRealEnd = RealOffset + E.OrigLength;
+    NewSize += E.NewStr.size();
+    NewSize -= E.OrigLength;
+  }
+
+  if (!InOnePass) {
+    for (const Edit &E : Edits)
+      ReplaceText(E.OrigOffset, E.OrigLength, E.NewStr);
+    return;
+  }
+
+  std::string Old;
+  Old.reserve(size());
+  llvm::raw_string_ostream OS(Old);
+  write(OS);
+  OS.flush();
+
+  std::string New;
+  New.reserve(NewSize);
+  unsigned Position = 0;
+  for (unsigned I = 0, N = Edits.size(); I != N; ++I) {
+    New.append(Old, Position, RealOffsets[I] - Position);
+    New.append(Edits[I].NewStr);
+    Position = RealOffsets[I] + Edits[I].OrigLength;
+  }
+  New.append(Old, Position, std::string::npos);
+  Buffer.assign(New.data(), New.data() + New.size());
+
+  // The replace deltas of the edits are sorted, so a tree without earlier
+  // deltas can be built in one go.
+  if (Deltas.empty()) {
+    SmallVector<std::pair<unsigned, int>, 64> NewDeltas;
+    for (const Edit &E : Edits)
+      if (E.OrigLength != E.NewStr.size())
+        NewDeltas.push_back(std::make_pair(
+            2 * E.OrigOffset + 1, int(E.NewStr.size() - E.OrigLength)));
+    DeltaTree(NewDeltas).swap(Deltas);
+    return;
+  }
+
+  for (const Edit &E : Edits)
+    if (E.OrigLength != E.NewStr.size())
+      AddReplaceDelta(E.OrigOffset, E.NewStr.size() - E.OrigLength);
+}
+
 
 //===----------------------------------------------------------------------===//
 // Rewriter class
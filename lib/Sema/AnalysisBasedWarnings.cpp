@@ -34,6 +34,7 @@
 #include "clang/Analysis/CFGStmtMap.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/ScopeInfo.h"
 #include "clang/Sema/SemaInternal.h"
@@ -47,6 +48,7 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Casting.h"
+#include "llvm/Support/Format.h"
 #include <algorithm>
 #include <deque>
 #include <iterator>
@@ -299,27 +301,8 @@ static ControlFlowKind CheckFallThrough(AnalysisDeclContext &AC) {
   if (!cfg) return UnknownFallThrough;
 
   // The CFG leaves in dead things, and we don't want the dead code paths to
-  // confuse us, so we mark all live things first.
-  llvm::BitVector live(cfg->getNumBlockIDs());
-  unsigned count = reachable_code::ScanReachableFromBlock(&cfg->getEntry(),
-                                                          live);
-
-  bool AddEHEdges = AC.getAddEHEdges();
-  if (!AddEHEdges && count != cfg->getNumBlockIDs())
-    // When there are things remaining dead, and we didn't add EH edges
-    // from CallExprs to the catch clauses, we have to go back and
-    // mark them as live.
-    for (const auto *B : *cfg) {
-      if (!live[B->getBlockID()]) {
-        if (B->pred_begin() == B->pred_end()) {
-          if (B->getTerminator() && isa<CXXTryStmt>(B->getTerminator()))
-            // When not adding EH edges from calls, catch clauses
-            // can otherwise seem dead.  Avoid noting them as dead.
-            count += reachable_code::ScanReachableFromBlock(B, live);
-          continue;
-        }
-      }
-    }
+  // confuse us, so we look at the live things only.
+  const llvm::BitVector &live = *AC.getReachableBlocks();
 
   // Now we know what is live, we check the live precessors of the exit block
   // and look for fall through paths, being careful to ignore normal returns,
@@ -1851,7 +1834,8 @@ clang::sema::AnalysisBasedWarnings::AnalysisBasedWarnings(Sema &s)
     NumUninitAnalysisVariables(0),
     MaxUninitAnalysisVariablesPerFunction(0),
     NumUninitAnalysisBlockVisits(0),
-    MaxUninitAnalysisBlockVisitsPerFunction(0) {
+    MaxUninitAnalysisBlockVisitsPerFunction(0),
+    AnalysisTimes() {
 
   using namespace diag;
   DiagnosticsEngine &D = S.getDiagnostics();
@@ -1869,6 +1853,40 @@ clang::sema::AnalysisBasedWarnings::AnalysisBasedWarnings(Sema &s)
     isEnabled(D, warn_use_in_invalid_state);
 }
 
+namespace {
+/// \brief Records the time spent in one step of IssueWarnings in the time
+/// trace and, with -print-stats, adds it to the total of that step.
+class AnalysisTimer {
+  TimeTraceScope TraceScope;
+  std::chrono::steady_clock::duration *Total;
+  std::chrono::steady_clock::time_point Start;
+
+public:
+  AnalysisTimer(StringRef Name, std::chrono::steady_clock::duration *Total)
+      : TraceScope(Name), Total(Total) {
+    if (Total)
+      Start = std::chrono::steady_clock::now();
+  }
+  ~AnalysisTimer() {
+    if (Total)
+      *Total += std::chrono::steady_clock::now() - Start;
+  }
+};
+} // end anonymous namespace
+
+/// \brief The names of the steps of IssueWarnings, indexed by AnalysisKind.
+static const char *const AnalysisNames[] = {
+    "CFG construction",
+    "Possibly unreachable diagnostics",
+    "Return fall-through",
+    "Unreachable code",
+    "Thread safety",
+    "Consumed",
+    "Uninitialized variables",
+    "Switch fall-through",
+    "Infinite recursion",
+};
+
 static void flushDiagnostics(Sema &S, const sema::FunctionScopeInfo *fscope) {
   for (const auto &D : fscope->PossiblyUnreachableDiags)
     S.Diag(D.Loc, D.PD);
@@ -1919,6 +1937,11 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
   AC.getCFGBuildOptions().AddCXXNewAllocator = false;
   AC.getCFGBuildOptions().AddCXXDefaultInitExprInCtors = true;
 
+  // Skip the analyses of functions whose CFG is over the size budget.
+  bool ExceededMaxBlocks = false;
+  AC.getCFGBuildOptions().MaxBlocks = S.getLangOpts().AnalysisCFGBlockLimit;
+  AC.getCFGBuildOptions().ExceededMaxBlocks = &ExceededMaxBlocks;
+
   // Force that certain expressions appear as CFGElements in the CFG.  This
   // is used to speed up various analyses.
   // FIXME: This isn't the right factoring.  This is here for initial
@@ -1950,16 +1973,37 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
     AC.getCFGBuildOptions().Observer = LEH.get();
   }
 
+  auto Timer = [&](AnalysisKind K) {
+    return S.CollectStats ? &AnalysisTimes[K] : nullptr;
+  };
+
+  // Register the expressions of the delayed diagnostics with the CFGBuilder.
+  for (const auto &D : fscope->PossiblyUnreachableDiags) {
+    if (D.stmt)
+      AC.registerForcedBlockExpression(D.stmt);
+  }
+
+  bool UninitEnabled =
+      !Diags.isIgnored(diag::warn_uninit_var, D->getLocStart()) ||
+      !Diags.isIgnored(diag::warn_sometimes_uninit_var, D->getLocStart()) ||
+      !Diags.isIgnored(diag::warn_maybe_uninit_var, D->getLocStart());
+
+  // All of the analyses share one CFG, built with the options above. Build it
+  // up front if one of them is certain to need it, so that its cost is not
+  // attributed to whichever analysis happens to run first.
+  if (!fscope->PossiblyUnreachableDiags.empty() || P.enableCheckUnreachable ||
+      P.enableThreadSafetyAnalysis || P.enableConsumedAnalysis ||
+      UninitEnabled || LEH) {
+    AnalysisTimer T(AnalysisNames[AK_CFG], Timer(AK_CFG));
+    AC.getCFG();
+  }
+
   // Emit delayed diagnostics.
   if (!fscope->PossiblyUnreachableDiags.empty()) {
+    AnalysisTimer T(AnalysisNames[AK_UnreachableDiags],
+                    Timer(AK_UnreachableDiags));
     bool analyzed = false;
 
-    // Register the expressions with the CFGBuilder.
-    for (const auto &D : fscope->PossiblyUnreachableDiags) {
-      if (D.stmt)
-        AC.registerForcedBlockExpression(D.stmt);
-    }
-
     if (AC.getCFG()) {
       analyzed = true;
       for (const auto &D : fscope->PossiblyUnreachableDiags) {
@@ -1991,6 +2035,8 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
   
   // Warning: check missing 'return'
   if (P.enableCheckFallThrough) {
+    AnalysisTimer T(AnalysisNames[AK_ReturnFallThrough],
+                    Timer(AK_ReturnFallThrough));
     const CheckFallThroughDiagnostics &CD =
       (isa<BlockDecl>(D) ? CheckFallThroughDiagnostics::MakeForBlock()
        : (isa<CXXMethodDecl>(D) &&
@@ -2010,12 +2056,16 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
     bool isTemplateInstantiation = false;
     if (const FunctionDecl *Function = dyn_cast<FunctionDecl>(D))
       isTemplateInstantiation = Function->isTemplateInstantiation();
-    if (!isTemplateInstantiation)
+    if (!isTemplateInstantiation) {
+      AnalysisTimer T(AnalysisNames[AK_UnreachableCode],
+                      Timer(AK_UnreachableCode));
       CheckUnreachable(S, AC);
+    }
   }
 
   // Check for thread safety violations
   if (P.enableThreadSafetyAnalysis) {
+    AnalysisTimer T(AnalysisNames[AK_ThreadSafety], Timer(AK_ThreadSafety));
     SourceLocation FL = AC.getDecl()->getLocation();
     SourceLocation FEL = AC.getDecl()->getLocEnd();
     threadSafety::ThreadSafetyReporter Reporter(S, FL, FEL);
@@ -2031,14 +2081,14 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
 
   // Check for violations of consumed properties.
   if (P.enableConsumedAnalysis) {
+    AnalysisTimer T(AnalysisNames[AK_Consumed], Timer(AK_Consumed));
     consumed::ConsumedWarningsHandler WarningHandler(S);
     consumed::ConsumedAnalyzer Analyzer(WarningHandler);
     Analyzer.run(AC);
   }
 
-  if (!Diags.isIgnored(diag::warn_uninit_var, D->getLocStart()) ||
-      !Diags.isIgnored(diag::warn_sometimes_uninit_var, D->getLocStart()) ||
-      !Diags.isIgnored(diag::warn_maybe_uninit_var, D->getLocStart())) {
+  if (UninitEnabled) {
+    AnalysisTimer T(AnalysisNames[AK_Uninitialized], Timer(AK_Uninitialized));
     if (CFG *cfg = AC.getCFG()) {
       UninitValsDiagReporter reporter(S);
       UninitVariablesAnalysisStats stats;
@@ -2066,6 +2116,8 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
       diag::warn_unannotated_fallthrough_per_function, D->getLocStart());
   if (FallThroughDiagFull || FallThroughDiagPerFunction ||
       fscope->HasFallthroughStmt) {
+    AnalysisTimer T(AnalysisNames[AK_SwitchFallThrough],
+                    Timer(AK_SwitchFallThrough));
     DiagnoseSwitchLabelsFallthrough(S, AC, !FallThroughDiagFull);
   }
 
@@ -2078,16 +2130,15 @@ AnalysisBasedWarnings::IssueWarnings(sema::AnalysisBasedWarnings::Policy P,
   if (!Diags.isIgnored(diag::warn_infinite_recursive_function,
                        D->getLocStart())) {
     if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+      AnalysisTimer T(AnalysisNames[AK_InfiniteRecursion],
+                      Timer(AK_InfiniteRecursion));
       checkRecursiveFunction(S, FD, Body, AC);
     }
   }
 
-  // If none of the previous checks caused a CFG build, trigger one here
-  // for -Wtautological-overlap-compare
-  if (!Diags.isIgnored(diag::warn_tautological_overlap_comparison,
-                               D->getLocStart())) {
-    AC.getCFG();
-  }
+  if (ExceededMaxBlocks)
+    S.Diag(D->getLocation(), diag::remark_analysis_cfg_block_limit)
+        << isa<BlockDecl>(D) << S.getLangOpts().AnalysisCFGBlockLimit;
 
   // Collect statistics about the CFG if it was built.
   if (S.CollectStats && AC.isCFGBuilt()) {
@@ -2134,4 +2185,14 @@ void clang::sema::AnalysisBasedWarnings::PrintStats() const {
                << " average block visits per function.\n"
                << "  " << MaxUninitAnalysisBlockVisitsPerFunction
                << " max block visits per function.\n";
+
+  static_assert(llvm::array_lengthof(AnalysisNames) == NumAnalysisKinds,
+                "AnalysisNames does not match AnalysisKind");
+  llvm::errs() << "Time spent in analysis-based warnings:\n";
+  for (unsigned K = 0; K != NumAnalysisKinds; ++K) {
+    double Seconds =
+        std::chrono::duration<double>(AnalysisTimes[K]).count();
+    llvm::errs() << llvm::format("  %8.4fs ", Seconds) << AnalysisNames[K]
+                 << ".\n";
+  }
 }
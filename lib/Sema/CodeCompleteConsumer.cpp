@@ -619,6 +619,12 @@ static StringRef getOrderedName(const CodeCompletionResult &R,
   Saved = Name.getAsString();
   return Saved;
 }
+
+bool CodeCompleteConsumer::isResultFilteredOut(StringRef Filter,
+                                               const CodeCompletionResult &R) {
+  std::string Saved;
+  return !getOrderedName(R, Saved).startswith_lower(Filter);
+}
     
 bool clang::operator<(const CodeCompletionResult &X, 
                       const CodeCompletionResult &Y) {
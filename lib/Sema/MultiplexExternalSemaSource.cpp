@@ -78,6 +78,16 @@ Stmt *MultiplexExternalSemaSource::GetExternalDeclStmt(uint64_t Offset) {
   return nullptr;
 }
 
+ExternalASTSource::ExtKind
+MultiplexExternalSemaSource::hasExternalDefinitions(const Decl *D) {
+  for (size_t i = 0; i < Sources.size(); ++i) {
+    ExtKind EK = Sources[i]->hasExternalDefinitions(D);
+    if (EK != EK_ReplyHazy)
+      return EK;
+  }
+  return EK_ReplyHazy;
+}
+
 CXXBaseSpecifier *MultiplexExternalSemaSource::GetExternalCXXBaseSpecifiers(
                                                                uint64_t Offset){
   for(size_t i = 0; i < Sources.size(); ++i)
@@ -170,6 +180,15 @@ bool MultiplexExternalSemaSource::layoutRecordType(const RecordDecl *Record,
   return false;
 }
 
+const ASTRecordLayout *
+MultiplexExternalSemaSource::getExternalRecordLayout(const RecordDecl *Record) {
+  for (size_t i = 0; i < Sources.size(); ++i)
+    if (const ASTRecordLayout *Layout =
+            Sources[i]->getExternalRecordLayout(Record))
+      return Layout;
+  return nullptr;
+}
+
 void MultiplexExternalSemaSource::
 getMemoryBufferSizes(MemoryBufferSizes &sizes) const {
   for(size_t i = 0; i < Sources.size(); ++i)
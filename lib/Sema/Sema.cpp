@@ -13,6 +13,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Sema/SemaInternal.h"
+#include "TypeLocBuilder.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDiagnostic.h"
 #include "clang/AST/DeclCXX.h"
@@ -21,10 +22,12 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/StmtCXX.h"
+#include "clang/Analysis/Analyses/FormatString.h"
 #include "clang/Basic/DiagnosticOptions.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/PartialDiagnostic.h"
 #include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/CXXFieldCollector.h"
@@ -78,7 +81,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     isMultiplexExternalSource(false), FPFeatures(pp.getLangOpts()),
     LangOpts(pp.getLangOpts()), PP(pp), Context(ctxt), Consumer(consumer),
     Diags(PP.getDiagnostics()), SourceMgr(PP.getSourceManager()),
-    CollectStats(false), CodeCompleter(CodeCompleter),
+    CollectStats(false), SkipMainFileFunctionBodies(true),
+    CodeCompleter(CodeCompleter),
     CurContext(nullptr), OriginalLexicalContext(nullptr),
     MSStructPragmaOn(false),
     MSPointerToMemberRepresentationMethod(
@@ -90,7 +94,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     IsBuildingRecoveryCallExpr(false),
     Cleanup{}, LateTemplateParser(nullptr),
     LateTemplateParserCleanup(nullptr),
-    OpaqueParser(nullptr), IdResolver(pp), StdInitializerList(nullptr),
+    OpaqueParser(nullptr), LazyNeonIntrinsicParser(nullptr),
+    OpaqueNeonParser(nullptr), IdResolver(pp), StdInitializerList(nullptr),
     CXXTypeInfoDecl(nullptr), MSVCGuidDecl(nullptr),
     NSNumberDecl(nullptr), NSValueDecl(nullptr),
     NSStringDecl(nullptr), StringWithUTF8StringMethod(nullptr),
@@ -100,7 +105,9 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
     MSAsmLabelNameCounter(0),
     GlobalNewDeleteDeclared(false),
     TUKind(TUKind),
-    NumSFINAEErrors(0),
+    NumSFINAEErrors(0), NumPendingFunctionInstantiations(0),
+    NumPendingVariableInstantiations(0), MaxPendingInstantiations(0),
+    NumDeducedCallSpecializationsReused(0), NumScopeChainDecls(0),
     CachedFakeTopLevelModule(nullptr),
     AccessCheckingSFINAE(false), InNonInstantiationSFINAEContext(false),
     NonInstantiationEntries(0), ArgumentPackSubstitutionIndex(-1),
@@ -121,6 +128,8 @@ Sema::Sema(Preprocessor &pp, ASTContext &ctxt, ASTConsumer &consumer,
   if (getLangOpts().CPlusPlus)
     FieldCollector.reset(new CXXFieldCollector());
 
+  TypeLocBuilderBuffers.reset(new TypeLocBuilderBufferCache());
+
   // Tell diagnostics how to render things from the AST library.
   Diags.SetArgToStringFn(&FormatASTNodeDiagnosticArgument, &Context);
 
@@ -343,6 +352,15 @@ void Sema::addExternalSource(ExternalSemaSource *E) {
 void Sema::PrintStats() const {
   llvm::errs() << "\n*** Semantic Analysis Stats:\n";
   llvm::errs() << NumSFINAEErrors << " SFINAE diagnostics trapped.\n";
+  llvm::errs() << NumPendingFunctionInstantiations
+               << " pending function instantiations performed.\n";
+  llvm::errs() << NumPendingVariableInstantiations
+               << " pending variable instantiations performed.\n";
+  llvm::errs() << MaxPendingInstantiations
+               << " instantiations pending at once at most.\n";
+  llvm::errs() << NumDeducedCallSpecializationsReused << "/"
+               << DeducedCallSpecializations.size()
+               << " deduced function template specializations reused.\n";
 
   BumpAlloc.PrintStats();
   AnalysisWarnings.PrintStats();
@@ -658,7 +676,8 @@ void Sema::ActOnEndOfTranslationUnit() {
     return;
 
   // Complete translation units and modules define vtables and perform implicit
-  // instantiations. PCH files do not.
+  // instantiations. PCH files do not, unless -fpch-instantiate-templates is
+  // given.
   if (TUKind != TU_Prefix) {
     DiagnoseUseOfUnimplementedSelectors();
 
@@ -683,12 +702,29 @@ void Sema::ActOnEndOfTranslationUnit() {
       PendingInstantiations.insert(PendingInstantiations.begin(),
                                    Pending.begin(), Pending.end());
     }
-    PerformPendingInstantiations();
+    {
+      TimeTraceScope TimeScope("PerformPendingInstantiations");
+      PerformPendingInstantiations();
+    }
 
     if (LateTemplateParserCleanup)
       LateTemplateParserCleanup(OpaqueParser);
 
     CheckDelayedMemberExceptionSpecs();
+  } else if (LangOpts.PCHInstantiateTemplates) {
+    // Perform the implicit instantiations now, so that their definitions are
+    // stored in the PCH file instead of being redone by every translation
+    // unit that uses it.
+    if (ExternalSource) {
+      SmallVector<PendingImplicitInstantiation, 4> Pending;
+      ExternalSource->ReadPendingInstantiations(Pending);
+      PendingInstantiations.insert(PendingInstantiations.begin(),
+                                   Pending.begin(), Pending.end());
+    }
+    {
+      TimeTraceScope TimeScope("PerformPendingInstantiations");
+      PerformPendingInstantiations();
+    }
   }
 
   // All delayed member exception specs should be checked or we end up accepting
@@ -1024,11 +1060,20 @@ void Sema::EmitCurrentDiagnostic(unsigned DiagID) {
 
     case DiagnosticIDs::SFINAE_Suppress:
       // Make a copy of this suppressed diagnostic and store it with the
-      // template-deduction information;
+      // template-deduction information, unless it would not be emitted when
+      // the specialization is used: deduction suppresses many warnings that
+      // are disabled, and copying their arguments is not free.
       if (*Info) {
         Diagnostic DiagInfo(&Diags);
-        (*Info)->addSuppressedDiagnostic(DiagInfo.getLocation(),
+        bool IsNote = DiagnosticIDs::isBuiltinNote(DiagInfo.getID());
+        if (!(*Info)->isSuppressedDiagnosticDropped(IsNote)) {
+          if (!IsNote && !Diags.hasAllExtensionsSilenced() &&
+              Diags.isIgnored(DiagInfo.getID(), DiagInfo.getLocation()))
+            (*Info)->dropSuppressedDiagnostic();
+          else
+            (*Info)->addSuppressedDiagnostic(DiagInfo.getLocation(),
                        PartialDiagnostic(DiagInfo, Context.getDiagAllocator()));
+        }
       }
 
       // Suppress this diagnostic.
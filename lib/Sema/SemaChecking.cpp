@@ -5592,17 +5592,23 @@ static void CheckFormatString(Sema &S, const StringLiteral *FExpr,
 
   if (Type == Sema::FST_Printf || Type == Sema::FST_NSString ||
       Type == Sema::FST_FreeBSDKPrintf || Type == Sema::FST_OSTrace) {
+    // Parse each distinct string once; the handler is given pointers into the
+    // cache's copy of it.
+    if (!S.PrintfStrings)
+      S.PrintfStrings.reset(new analyze_format_string::PrintfStringCache());
+    bool IsFreeBSDKPrintf = Type == Sema::FST_FreeBSDKPrintf;
+    StringRef Interned =
+        S.PrintfStrings->intern(StringRef(Str, StrLen), IsFreeBSDKPrintf);
+
     CheckPrintfHandler H(S, FExpr, OrigFormatExpr, firstDataArg,
                          numDataArgs, (Type == Sema::FST_NSString ||
                                        Type == Sema::FST_OSTrace),
-                         Str, HasVAListArg, Args, format_idx,
+                         Interned.data(), HasVAListArg, Args, format_idx,
                          inFunctionCall, CallType, CheckedVarArgs,
                          UncoveredArg);
 
-    if (!analyze_format_string::ParsePrintfString(H, Str, Str + StrLen,
-                                                  S.getLangOpts(),
-                                                  S.Context.getTargetInfo(),
-                                            Type == Sema::FST_FreeBSDKPrintf))
+    if (!S.PrintfStrings->parse(H, Interned, S.getLangOpts(),
+                                S.Context.getTargetInfo(), IsFreeBSDKPrintf))
       H.DoneProcessing();
   } else if (Type == Sema::FST_Scanf) {
     CheckScanfHandler H(S, FExpr, OrigFormatExpr, firstDataArg, numDataArgs,
@@ -30,6 +30,7 @@
 #include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/Twine.h"
+#include <algorithm>
 #include <list>
 #include <map>
 #include <vector>
@@ -3143,8 +3144,21 @@ static void HandleCodeCompleteResults(Sema *S,
                                       CodeCompletionContext Context,
                                       CodeCompletionResult *Results,
                                       unsigned NumResults) {
-  if (CodeCompleter)
-    CodeCompleter->ProcessCodeCompleteResults(*S, Context, Results, NumResults);
+  if (!CodeCompleter)
+    return;
+
+  // Drop the results that do not match what the user has typed so far, before
+  // the consumer builds their completion strings.
+  StringRef Filter = S->getPreprocessor().getCodeCompletionFilter();
+  if (CodeCompleter->filterByTypedText() && !Filter.empty()) {
+    CodeCompletionResult *End = std::remove_if(
+        Results, Results + NumResults, [&](const CodeCompletionResult &R) {
+          return CodeCompleteConsumer::isResultFilteredOut(Filter, R);
+        });
+    NumResults = End - Results;
+  }
+
+  CodeCompleter->ProcessCodeCompleteResults(*S, Context, Results, NumResults);
 }
 
 static enum CodeCompletionContext::Kind mapCodeCompletionContext(Sema &S, 
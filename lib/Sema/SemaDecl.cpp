@@ -1242,6 +1242,8 @@ static bool AllowOverloadingOfFunction(LookupResult &Previous,
 
 /// Add this decl to the scope shadowed decl chains.
 void Sema::PushOnScopeChains(NamedDecl *D, Scope *S, bool AddToContext) {
+  ++NumScopeChainDecls;
+
   // Move up the scope chain until we find the nearest enclosing
   // non-transparent context. The declaration will be introduced into this
   // scope.
@@ -11420,6 +11422,17 @@ bool Sema::canSkipFunctionBody(Decl *D) {
   if (const FunctionDecl *FD = D->getAsFunction())
     if (FD->isConstexpr() || FD->getReturnType()->isUndeducedType())
       return false;
+  if (!SkipMainFileFunctionBodies) {
+    // Keep the bodies of templates, which may be instantiated from the main
+    // file, and of anything written in the main file itself.
+    if (const FunctionDecl *FD = D->getAsFunction())
+      if (FD->isDependentContext())
+        return false;
+    SourceLocation Loc = SourceMgr.getExpansionLoc(D->getLocation());
+    if (Loc.isInvalid() ||
+        SourceMgr.getFileID(Loc) == SourceMgr.getMainFileID())
+      return false;
+  }
   return Consumer.shouldSkipFunctionBody(D);
 }
 
@@ -4410,6 +4410,18 @@ static void handleObjCRequiresSuperAttr(Sema &S, Decl *D,
                                         attr.getAttributeSpellingListIndex()));
 }
 
+static void handleObjCDirectAttr(Sema &S, Decl *D, const AttributeList &Attr) {
+  // Protocol methods are only ever reached through the runtime.
+  if (isa<ObjCProtocolDecl>(D->getDeclContext())) {
+    S.Diag(Attr.getLoc(), diag::err_objc_direct_on_protocol);
+    return;
+  }
+
+  D->addAttr(::new (S.Context)
+             ObjCDirectAttr(Attr.getRange(), S.Context,
+                            Attr.getAttributeSpellingListIndex()));
+}
+
 static void handleCFAuditedTransferAttr(Sema &S, Decl *D,
                                         const AttributeList &Attr) {
   if (checkAttrMutualExclusion<CFUnknownTransferAttr>(S, D, Attr.getRange(),
@@ -5527,6 +5539,9 @@ static void ProcessDeclAttribute(Sema &S, Scope *scope, Decl *D,
   case AttributeList::AT_NoSplitStack:
     handleSimpleAttribute<NoSplitStackAttr>(S, D, Attr);
     break;
+  case AttributeList::AT_NoProfileInstrumentFunction:
+    handleSimpleAttribute<NoProfileInstrumentFunctionAttr>(S, D, Attr);
+    break;
   case AttributeList::AT_NonNull:
     if (ParmVarDecl *PVD = dyn_cast<ParmVarDecl>(D))
       handleNonNullAttrParameter(S, PVD, Attr);
@@ -5579,6 +5594,9 @@ static void ProcessDeclAttribute(Sema &S, Scope *scope, Decl *D,
   case AttributeList::AT_ObjCRequiresSuper:
     handleObjCRequiresSuperAttr(S, D, Attr);
     break;
+  case AttributeList::AT_ObjCDirect:
+    handleObjCDirectAttr(S, D, Attr);
+    break;
   case AttributeList::AT_ObjCBridge:
     handleObjCBridgeAttr(S, scope, D, Attr);
     break;
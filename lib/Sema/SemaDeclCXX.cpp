@@ -6027,6 +6027,45 @@ bool Sema::ShouldDeleteSpecialMember(CXXMethodDecl *MD, CXXSpecialMember CSM,
   return false;
 }
 
+/// Determine whether an implicitly-declared copy constructor, move
+/// constructor, move assignment operator or destructor should be defined as
+/// deleted. The class definition records whether each of these would be
+/// deleted unless that depends on the special members of its subobjects
+/// that need overload resolution; only in that case do we walk the bases and
+/// fields.
+static bool shouldDeleteImplicitSpecialMember(Sema &S, CXXMethodDecl *MD,
+                                              Sema::CXXSpecialMember CSM) {
+  CXXRecordDecl *RD = MD->getParent();
+  if (!S.getLangOpts().CPlusPlus11 || S.getLangOpts().CUDA ||
+      MD->isInvalidDecl() || RD->isInvalidDecl() ||
+      RD->isAnonymousStructOrUnion())
+    return S.ShouldDeleteSpecialMember(MD, CSM);
+
+  switch (CSM) {
+  case Sema::CXXCopyConstructor:
+    if (!RD->defaultedCopyConstructorIsDeletedNeedsOverloadResolution())
+      return RD->defaultedCopyConstructorIsDeleted();
+    break;
+  case Sema::CXXMoveConstructor:
+    if (!RD->needsOverloadResolutionForMoveConstructor())
+      return RD->defaultedMoveConstructorIsDeleted();
+    break;
+  case Sema::CXXMoveAssignment:
+    if (!RD->needsOverloadResolutionForMoveAssignment())
+      return RD->defaultedMoveAssignmentIsDeleted();
+    break;
+  case Sema::CXXDestructor:
+    // A virtual destructor also needs a usable operator delete.
+    if (!MD->isVirtual() && !RD->needsOverloadResolutionForDestructor())
+      return RD->defaultedDestructorIsDeleted();
+    break;
+  default:
+    break;
+  }
+
+  return S.ShouldDeleteSpecialMember(MD, CSM);
+}
+
 /// Perform lookup for a special member of the specified kind, and determine
 /// whether it is trivial. If the triviality can be determined without the
 /// lookup, skip it. This is intended for use when determining whether a
@@ -9495,8 +9534,10 @@ CXXDestructorDecl *Sema::DeclareImplicitDestructor(CXXRecordDecl *ClassDecl) {
   Scope *S = getScopeForContext(ClassDecl);
   CheckImplicitSpecialMemberDeclaration(S, Destructor);
 
-  if (ShouldDeleteSpecialMember(Destructor, CXXDestructor))
+  if (shouldDeleteImplicitSpecialMember(*this, Destructor, CXXDestructor)) {
+    ClassDecl->setImplicitDestructorIsDeleted();
     SetDeclDeleted(Destructor, ClassLoc);
+  }
 
   // Introduce this destructor into its scope.
   if (S)
@@ -10603,7 +10644,8 @@ CXXMethodDecl *Sema::DeclareImplicitMoveAssignment(CXXRecordDecl *ClassDecl) {
   Scope *S = getScopeForContext(ClassDecl);
   CheckImplicitSpecialMemberDeclaration(S, MoveAssignment);
 
-  if (ShouldDeleteSpecialMember(MoveAssignment, CXXMoveAssignment)) {
+  if (shouldDeleteImplicitSpecialMember(*this, MoveAssignment,
+                                        CXXMoveAssignment)) {
     ClassDecl->setImplicitMoveAssignmentIsDeleted();
     SetDeclDeleted(MoveAssignment, ClassLoc);
   }
@@ -11040,8 +11082,11 @@ CXXConstructorDecl *Sema::DeclareImplicitCopyConstructor(
   Scope *S = getScopeForContext(ClassDecl);
   CheckImplicitSpecialMemberDeclaration(S, CopyConstructor);
 
-  if (ShouldDeleteSpecialMember(CopyConstructor, CXXCopyConstructor))
+  if (shouldDeleteImplicitSpecialMember(*this, CopyConstructor,
+                                        CXXCopyConstructor)) {
+    ClassDecl->setImplicitCopyConstructorIsDeleted();
     SetDeclDeleted(CopyConstructor, ClassLoc);
+  }
 
   if (S)
     PushOnScopeChains(CopyConstructor, S, false);
@@ -11220,7 +11265,8 @@ CXXConstructorDecl *Sema::DeclareImplicitMoveConstructor(
   Scope *S = getScopeForContext(ClassDecl);
   CheckImplicitSpecialMemberDeclaration(S, MoveConstructor);
 
-  if (ShouldDeleteSpecialMember(MoveConstructor, CXXMoveConstructor)) {
+  if (shouldDeleteImplicitSpecialMember(*this, MoveConstructor,
+                                        CXXMoveConstructor)) {
     ClassDecl->setImplicitMoveConstructorIsDeleted();
     SetDeclDeleted(MoveConstructor, ClassLoc);
   }
@@ -3317,6 +3317,14 @@ void Sema::AddMethodToGlobalPool(ObjCMethodDecl *Method, bool impl,
   if (cast<Decl>(Method->getDeclContext())->isInvalidDecl())
     return;
 
+  // Direct methods cannot be found by the runtime, so a message that is
+  // resolved through the pool must never bind to one.
+  if (Method->isDirectMethod()) {
+    DirectMethods.insert(std::make_pair(Method->getSelector(), Method));
+    Method->setDefined(impl);
+    return;
+  }
+
   if (ExternalSource)
     ReadMethodPool(Method->getSelector());
   
@@ -3350,38 +3358,52 @@ static bool isAcceptableMethodMismatch(ObjCMethodDecl *chosen,
   return (chosen->getReturnType()->isIntegerType());
 }
 
-/// Return true if the given method is wthin the type bound.
-static bool FilterMethodsByTypeBound(ObjCMethodDecl *Method,
-                                     const ObjCObjectType *TypeBound) {
-  if (!TypeBound)
-    return true;
+namespace {
+/// Filters global pool methods by the class hierarchy of a type bound.
+///
+/// Pools for common selectors such as -init hold methods from thousands of
+/// classes, but only a handful of distinct interfaces, so the hierarchy
+/// check is made once per interface rather than once per method.
+class MethodTypeBoundFilter {
+  ObjCInterfaceDecl *BoundInterface;
+  llvm::SmallDenseMap<const ObjCInterfaceDecl *, bool, 16> InHierarchy;
 
-  if (TypeBound->isObjCId())
+public:
+  explicit MethodTypeBoundFilter(const ObjCObjectType *TypeBound)
+      : BoundInterface(nullptr) {
     // FIXME: should we handle the case of bounding to id<A, B> differently?
-    return true;
+    if (TypeBound && !TypeBound->isObjCId()) {
+      BoundInterface = TypeBound->getInterface();
+      assert(BoundInterface && "unexpected object type!");
+    }
+  }
 
-  auto *BoundInterface = TypeBound->getInterface();
-  assert(BoundInterface && "unexpected object type!");
+  bool operator()(ObjCMethodDecl *Method) {
+    if (!BoundInterface)
+      return true;
 
-  // Check if the Method belongs to a protocol. We should allow any method
-  // defined in any protocol, because any subclass could adopt the protocol.
-  auto *MethodProtocol = dyn_cast<ObjCProtocolDecl>(Method->getDeclContext());
-  if (MethodProtocol) {
-    return true;
-  }
+    // Check if the Method belongs to a protocol. We should allow any method
+    // defined in any protocol, because any subclass could adopt the protocol.
+    if (isa<ObjCProtocolDecl>(Method->getDeclContext()))
+      return true;
 
-  // If the Method belongs to a class, check if it belongs to the class
-  // hierarchy of the class bound.
-  if (ObjCInterfaceDecl *MethodInterface = Method->getClassInterface()) {
-    // We allow methods declared within classes that are part of the hierarchy
-    // of the class bound (superclass of, subclass of, or the same as the class
-    // bound).
-    return MethodInterface == BoundInterface ||
-           MethodInterface->isSuperClassOf(BoundInterface) ||
-           BoundInterface->isSuperClassOf(MethodInterface);
+    // If the Method belongs to a class, check if it belongs to the class
+    // hierarchy of the class bound.
+    ObjCInterfaceDecl *MethodInterface = Method->getClassInterface();
+    assert(MethodInterface && "unknow method context");
+
+    auto Known = InHierarchy.insert(
+        std::make_pair(MethodInterface->getCanonicalDecl(), false));
+    if (Known.second)
+      // We allow methods declared within classes that are part of the
+      // hierarchy of the class bound (superclass of, subclass of, or the same
+      // as the class bound).
+      Known.first->second = MethodInterface->isSuperClassOf(BoundInterface) ||
+                            BoundInterface->isSuperClassOf(MethodInterface);
+    return Known.first->second;
   }
-  llvm_unreachable("unknow method context");
-}
+};
+} // end anonymous namespace
 
 /// We first select the type of the method: Instance or Factory, then collect
 /// all methods with that type.
@@ -3397,11 +3419,12 @@ bool Sema::CollectMultipleMethodsInGlobalPool(
     return false;
 
   // Gather the non-hidden methods.
+  MethodTypeBoundFilter InTypeBound(TypeBound);
   ObjCMethodList &MethList = InstanceFirst ? Pos->second.first :
                              Pos->second.second;
   for (ObjCMethodList *M = &MethList; M; M = M->getNext())
     if (M->getMethod() && !M->getMethod()->isHidden()) {
-      if (FilterMethodsByTypeBound(M->getMethod(), TypeBound))
+      if (InTypeBound(M->getMethod()))
         Methods.push_back(M->getMethod());
     }
 
@@ -3417,7 +3440,7 @@ bool Sema::CollectMultipleMethodsInGlobalPool(
                               Pos->second.first;
   for (ObjCMethodList *M = &MethList2; M; M = M->getNext())
     if (M->getMethod() && !M->getMethod()->isHidden()) {
-      if (FilterMethodsByTypeBound(M->getMethod(), TypeBound))
+      if (InTypeBound(M->getMethod()))
         Methods.push_back(M->getMethod());
     }
 
@@ -4150,6 +4173,28 @@ void Sema::CheckObjCMethodOverrides(ObjCMethodDecl *ObjCMethod,
       }
     }
 
+    // Direct methods are bound statically, so they can neither be overridden
+    // nor stand in for a method that is dispatched through the runtime. An
+    // implementation is checked against its own class's declarations when
+    // the attribute is merged into it.
+    bool IsProtocolMethod =
+      isa<ObjCProtocolDecl>(overridden->getDeclContext());
+    bool IsOwnDecl = !IsProtocolMethod &&
+                     overridden->getClassInterface() == CurrentClass;
+    if (!IsOwnDecl || !isa<ObjCImplDecl>(ObjCMethod->getDeclContext())) {
+      if (overridden->isDirectMethod()) {
+        if (!IsOwnDecl || !ObjCMethod->isDirectMethod()) {
+          Diag(ObjCMethod->getLocation(),
+               diag::err_objc_override_direct_method);
+          Diag(overridden->getLocation(), diag::note_previous_declaration);
+        }
+      } else if (ObjCMethod->isDirectMethod()) {
+        Diag(ObjCMethod->getLocation(), diag::err_objc_direct_overrides)
+          << ObjCMethod->getDeclName() << IsProtocolMethod;
+        Diag(overridden->getLocation(), diag::note_previous_declaration);
+      }
+    }
+
     // Propagate down the 'related result type' bit from overridden methods.
     if (RTC != Sema::RTC_Incompatible && overridden->hasRelatedResultType())
       ObjCMethod->SetRelatedResultType();
@@ -4246,6 +4291,22 @@ static void mergeInterfaceMethodToImpl(Sema &S,
                                             method->getLocation()));
   }
 
+  // Merge the objc_direct attribute from the class's own declaration. Callers
+  // that only see the declaration send a message, so the implementation
+  // cannot be direct on its own.
+  if (!isa<ObjCProtocolDecl>(prevMethod->getDeclContext()) &&
+      prevMethod->getClassInterface() == method->getClassInterface()) {
+    if (prevMethod->isDirectMethod()) {
+      if (!method->isDirectMethod())
+        method->addAttr(
+          ObjCDirectAttr::CreateImplicit(S.Context, method->getLocation()));
+    } else if (method->isDirectMethod()) {
+      S.Diag(method->getLocation(), diag::err_objc_direct_impl_decl_mismatch)
+        << method->getDeclName();
+      S.Diag(prevMethod->getLocation(), diag::note_previous_declaration);
+    }
+  }
+
   // Merge nullability of the result type.
   QualType newReturnType
     = mergeTypeNullabilityForRedecl(
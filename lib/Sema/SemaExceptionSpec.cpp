@@ -1179,6 +1179,7 @@ CanThrowResult Sema::canThrow(const Expr *E) {
   case Expr::IntegerLiteralClass:
   case Expr::NoInitExprClass:
   case Expr::ObjCEncodeExprClass:
+  case Expr::PackedArrayInitExprClass:
   case Expr::ObjCStringLiteralClass:
   case Expr::ObjCBoolLiteralExprClass:
   case Expr::OpaqueValueExprClass:
@@ -2216,6 +2216,37 @@ ExprResult Sema::BuildClassMessageImplicit(QualType ReceiverType,
                            /*isImplicit=*/true);
 }
 
+/// Diagnoses a message that the runtime would have to dispatch to a direct
+/// method, which it cannot find. A direct method is only called when the
+/// static class of the receiver, \p ReceiverClass, declares or inherits it.
+/// A message whose method was not found at all, as to "id" or "Class", is
+/// diagnosed when its selector names a direct method.
+///
+/// \returns true if an error was emitted.
+static bool checkDirectMethodDispatch(Sema &S, const ObjCMethodDecl *Method,
+                                      Selector Sel, QualType ReceiverType,
+                                      const ObjCInterfaceDecl *ReceiverClass,
+                                      SourceLocation Loc) {
+  if (!Method) {
+    auto Direct = S.DirectMethods.find(Sel);
+    if (Direct == S.DirectMethods.end())
+      return false;
+    Method = Direct->second;
+  } else if (!Method->isDirectMethod()) {
+    return false;
+  } else {
+    const ObjCInterfaceDecl *Declaring = Method->getClassInterface();
+    if (ReceiverClass && Declaring && Declaring->isSuperClassOf(ReceiverClass))
+      return false;
+  }
+
+  S.Diag(Loc, diag::err_objc_direct_dynamic_dispatch)
+    << Method->getDeclName() << ReceiverType;
+  S.Diag(Method->getLocation(), diag::note_method_declared_at)
+    << Method->getDeclName();
+  return true;
+}
+
 static void applyCocoaAPICheck(Sema &S, const ObjCMessageExpr *Msg,
                                unsigned DiagID,
                                bool (*refactor)(const ObjCMessageExpr *,
@@ -2420,6 +2451,19 @@ ExprResult Sema::BuildClassMessage(TypeSourceInfo *ReceiverTypeInfo,
       RequireCompleteType(LBracLoc, Method->getReturnType(),
                           diag::err_illegal_message_expr_incomplete_type))
     return ExprError();
+
+  // Direct methods are not known to the runtime, so objc_msgSendSuper would
+  // never find them.
+  if (Method && Method->isDirectMethod() && SuperLoc.isValid()) {
+    Diag(SuperLoc, diag::err_messaging_super_with_direct_method);
+    Diag(Method->getLocation(), diag::note_method_declared_at)
+      << Method->getDeclName();
+    return ExprError();
+  }
+
+  if (SuperLoc.isInvalid() &&
+      checkDirectMethodDispatch(*this, Method, Sel, ReceiverType, Class, Loc))
+    return ExprError();
   
   // Warn about explicit call of +initialize on its own class. But not on 'super'.
   if (Method && Method->getMethodFamily() == OMF_initialize) {
@@ -2885,6 +2929,26 @@ ExprResult Sema::BuildInstanceMessage(Expr *Receiver,
                           diag::err_illegal_message_expr_incomplete_type))
     return ExprError();
 
+  // Direct methods are not known to the runtime, so objc_msgSendSuper would
+  // never find them.
+  if (Method && Method->isDirectMethod() && SuperLoc.isValid()) {
+    Diag(SuperLoc, diag::err_messaging_super_with_direct_method);
+    Diag(Method->getLocation(), diag::note_method_declared_at)
+      << Method->getDeclName();
+    return ExprError();
+  }
+
+  // Messages to "id" and "Class" cannot reach direct methods.
+  if (SuperLoc.isInvalid()) {
+    const ObjCObjectPointerType *ReceiverPtr =
+      ReceiverType->getAsObjCInterfacePointerType();
+    if (checkDirectMethodDispatch(*this, Method, Sel, ReceiverType,
+                                  ReceiverPtr ? ReceiverPtr->getInterfaceDecl()
+                                              : nullptr,
+                                  Loc))
+      return ExprError();
+  }
+
   // In ARC, forbid the user from sending messages to 
   // retain/release/autorelease/dealloc/retainCount explicitly.
   if (getLangOpts().ObjCAutoRefCount) {
@@ -3392,6 +3392,20 @@ static void MaybeProduceObjCObject(Sema &S,
   }
 }
 
+/// \brief Determine whether the list-initialization of \p Entity can be
+/// represented as a PackedArrayInitExpr.
+///
+/// Only variables are packed; other entities, such as the array of a
+/// new-expression, expect their initializer to be an InitListExpr.
+static bool canPackListInitialization(Sema &S,
+                                      const InitializedEntity &Entity,
+                                      QualType DestType,
+                                      InitListExpr *InitList) {
+  return Entity.getKind() == InitializedEntity::EK_Variable &&
+         !Entity.getType()->isReferenceType() &&
+         PackedArrayInitExpr::isPackable(S.Context, DestType, InitList);
+}
+
 static void TryListInitialization(Sema &S,
                                   const InitializedEntity &Entity,
                                   const InitializationKind &Kind,
@@ -3927,6 +3941,14 @@ static void TryListInitialization(Sema &S,
     }
   }
 
+  // A long list of integer literals for an array of integers, such as
+  // embedded binary data, needs no checking element by element; it will be
+  // packed when the initialization is performed.
+  if (canPackListInitialization(S, Entity, DestType, InitList)) {
+    Sequence.AddListInitializationStep(DestType);
+    return;
+  }
+
   InitListChecker CheckInitList(S, Entity, InitList,
           DestType, /*VerifyOnly=*/true, TreatUnavailableAsInvalid);
   if (CheckInitList.HadError()) {
@@ -5748,7 +5770,7 @@ PerformConstructorInitialization(Sema &S,
     }
     S.MarkFunctionReferenced(Loc, Constructor);
 
-    CurInit = new (S.Context) CXXTemporaryObjectExpr(
+    CurInit = CXXTemporaryObjectExpr::Create(
         S.Context, Constructor, TSInfo,
         ConstructorArgs, ParenOrBraceRange, HadMultipleCandidates,
         IsListInitialization, IsStdInitListInitialization,
@@ -6662,11 +6684,28 @@ InitializationSequence::Perform(Sema &S,
       bool IsTemporary = !S.Context.hasSameType(Entity.getType(), Ty);
       InitializedEntity TempEntity = InitializedEntity::InitializeTemporary(Ty);
       InitializedEntity InitEntity = IsTemporary ? TempEntity : Entity;
-      InitListChecker PerformInitList(S, InitEntity,
-          InitList, Ty, /*VerifyOnly=*/false,
-          /*TreatUnavailableAsInvalid=*/false);
-      if (PerformInitList.HadError())
-        return ExprError();
+      InitListExpr *StructuredInitList = nullptr;
+      PackedArrayInitExpr *PackedInit = nullptr;
+      if (canPackListInitialization(S, InitEntity, Ty, InitList)) {
+        if (const IncompleteArrayType *IAT =
+                S.Context.getAsIncompleteArrayType(Ty)) {
+          llvm::APInt NumElements(
+              S.Context.getTypeSize(S.Context.getSizeType()),
+              InitList->getNumInits());
+          Ty = S.Context.getConstantArrayType(IAT->getElementType(),
+                                              NumElements, ArrayType::Normal,
+                                              0);
+        }
+        InitList->setType(Ty);
+        PackedInit = PackedArrayInitExpr::Create(S.Context, Ty, InitList);
+      } else {
+        InitListChecker PerformInitList(S, InitEntity,
+            InitList, Ty, /*VerifyOnly=*/false,
+            /*TreatUnavailableAsInvalid=*/false);
+        if (PerformInitList.HadError())
+          return ExprError();
+        StructuredInitList = PerformInitList.getFullyStructuredList();
+      }
 
       // Hack: We must update *ResultType if available in order to set the
       // bounds of arrays, e.g. in 'int ar[] = {1, 2, 3};'.
@@ -6681,8 +6720,11 @@ InitializationSequence::Perform(Sema &S,
         *ResultType = Ty;
       }
 
-      InitListExpr *StructuredInitList =
-          PerformInitList.getFullyStructuredList();
+      if (PackedInit) {
+        CurInit = PackedInit;
+        break;
+      }
+
       CurInit.get();
       CurInit = shouldBindAsTemporary(InitEntity)
           ? S.MaybeBindToTemporary(StructuredInitList)
@@ -13,8 +13,10 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Sema/Lookup.h"
+#include "clang/AST/ASTConsumer.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTMutationListener.h"
+#include "clang/AST/Attr.h"
 #include "clang/AST/CXXInheritance.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
@@ -25,6 +27,7 @@
 #include "clang/AST/ExprCXX.h"
 #include "clang/Basic/Builtins.h"
 #include "clang/Basic/LangOptions.h"
+#include "clang/Basic/TargetInfo.h"
 #include "clang/Lex/HeaderSearch.h"
 #include "clang/Lex/ModuleLoader.h"
 #include "clang/Lex/Preprocessor.h"
@@ -668,6 +671,694 @@ LLVM_DUMP_METHOD void LookupResult::dump() {
     D->dump();
 }
 
+namespace {
+/// \brief An OpenCL builtin function from OpenCLBuiltins.def.
+struct OpenCLBuiltinInfo {
+  const char *Name;
+  const char *Type;
+  const char *Attrs;
+  unsigned Version;
+};
+
+/// \brief The signature of one overload of an OpenCL builtin function.
+struct OpenCLBuiltinOverload {
+  QualType ResultType;
+  SmallVector<QualType, 4> ParamTypes;
+  bool IsConst;
+  bool IsPure;
+  bool IsVariadic;
+};
+} // end anonymous namespace
+
+static const OpenCLBuiltinInfo OpenCLBuiltins[] = {
+#define OPENCL_BUILTIN(Name, Type, Attrs, Version) \
+  { #Name, Type, Attrs, Version },
+#include "clang/Basic/OpenCLBuiltins.def"
+};
+
+/// \brief Map the name of each builtin in OpenCLBuiltins to the indices of
+/// its entries, so that a failed lookup does not scan the whole table.
+static const llvm::StringMap<SmallVector<unsigned, 2>> &
+getOpenCLBuiltinIndex() {
+  static const llvm::StringMap<SmallVector<unsigned, 2>> Index = [] {
+    llvm::StringMap<SmallVector<unsigned, 2>> Index;
+    for (unsigned I = 0, E = llvm::array_lengthof(OpenCLBuiltins); I != E;
+         ++I)
+      Index[OpenCLBuiltins[I].Name].push_back(I);
+    return Index;
+  }();
+  return Index;
+}
+
+/// \brief Return the OpenCL integer type of \p Width bits.
+static QualType getOpenCLIntType(ASTContext &Context, unsigned Width,
+                                 bool Signed) {
+  switch (Width) {
+  case 8:
+    return Signed ? Context.CharTy : Context.UnsignedCharTy;
+  case 16:
+    return Signed ? Context.ShortTy : Context.UnsignedShortTy;
+  case 32:
+    return Signed ? Context.IntTy : Context.UnsignedIntTy;
+  case 64:
+    return Signed ? Context.LongTy : Context.UnsignedLongTy;
+  }
+  llvm_unreachable("invalid OpenCL integer width");
+}
+
+/// \brief Return \p ElementType, or a vector of \p NumElements of them.
+static QualType getOpenCLVectorType(ASTContext &Context, QualType ElementType,
+                                    unsigned NumElements) {
+  return NumElements == 1 ? ElementType
+                          : Context.getExtVectorType(ElementType, NumElements);
+}
+
+/// \brief Collect the floating-point types the target supports.
+static void getOpenCLFloatTypes(Sema &S, SmallVectorImpl<QualType> &Types) {
+  ASTContext &Context = S.Context;
+  const OpenCLOptions &Opts = Context.getTargetInfo().getSupportedOpenCLOpts();
+  unsigned CLVer = S.getLangOpts().OpenCLVersion;
+  Types.push_back(Context.FloatTy);
+  if (Opts.is_cl_khr_fp64_supported(CLVer))
+    Types.push_back(Context.DoubleTy);
+  if (Opts.is_cl_khr_fp16_supported(CLVer))
+    Types.push_back(Context.HalfTy);
+}
+
+/// \brief Collect the types of the OpenCL gentype \p Family, as described
+/// in OpenCLBuiltins.def.
+static void getOpenCLGenTypes(Sema &S, char Family,
+                              SmallVectorImpl<QualType> &Types) {
+  ASTContext &Context = S.Context;
+  unsigned CLVer = S.getLangOpts().OpenCLVersion;
+  if (Family == 'M' || Family == 'W') {
+    bool Read = Family == 'M';
+    if (CLVer >= 120)
+      Types.push_back(Read ? Context.OCLImage1dROTy : Context.OCLImage1dWOTy);
+    Types.push_back(Read ? Context.OCLImage2dROTy : Context.OCLImage2dWOTy);
+    if (Read || Context.getTargetInfo()
+                    .getSupportedOpenCLOpts()
+                    .is_cl_khr_3d_image_writes_supported(CLVer))
+      Types.push_back(Read ? Context.OCLImage3dROTy : Context.OCLImage3dWOTy);
+    return;
+  }
+
+  SmallVector<QualType, 12> ElementTypes;
+  switch (Family) {
+  case 'I':
+  case 'T':
+    ElementTypes.append({Context.CharTy, Context.UnsignedCharTy,
+                         Context.ShortTy, Context.UnsignedShortTy,
+                         Context.IntTy, Context.UnsignedIntTy, Context.LongTy,
+                         Context.UnsignedLongTy});
+    if (Family == 'T')
+      getOpenCLFloatTypes(S, ElementTypes);
+    break;
+  case 'N':
+    ElementTypes.append(
+        {Context.CharTy, Context.ShortTy, Context.IntTy, Context.LongTy});
+    break;
+  case 'Y':
+    ElementTypes.append({Context.CharTy, Context.UnsignedCharTy,
+                         Context.ShortTy, Context.UnsignedShortTy,
+                         Context.IntTy, Context.UnsignedIntTy});
+    break;
+  case 'A':
+  case 'B':
+    ElementTypes.append({Context.IntTy, Context.UnsignedIntTy});
+    break;
+  case 'F':
+  case 'H':
+    ElementTypes.push_back(Context.FloatTy);
+    break;
+  default:
+    getOpenCLFloatTypes(S, ElementTypes);
+    break;
+  }
+
+  static const unsigned GenTypeSizes[] = {1, 2, 3, 4, 8, 16};
+  for (QualType ElementType : ElementTypes) {
+    for (unsigned Size : GenTypeSizes) {
+      if (Family == 'A' && Size > 1)
+        break;
+      if ((Family == 'V' || Family == 'H' || Family == 'X') && Size > 4)
+        break;
+      if (Family == 'X' && Size < 3)
+        continue;
+      Types.push_back(getOpenCLVectorType(Context, ElementType, Size));
+    }
+  }
+}
+
+/// \brief Return the number of coordinates of the OpenCL image type \p T.
+static unsigned getOpenCLImageDims(ASTContext &Context, QualType T) {
+  if (T == Context.OCLImage1dROTy || T == Context.OCLImage1dWOTy)
+    return 1;
+  if (T == Context.OCLImage2dROTy || T == Context.OCLImage2dWOTy)
+    return 2;
+  return 3;
+}
+
+/// \brief Decode the type letter \p C of an OpenCL builtin signature for the
+/// overload whose gentype is \p GenType.
+static QualType getOpenCLBuiltinType(ASTContext &Context, char C,
+                                     QualType GenType) {
+  switch (C) {
+  case 'v':
+    return Context.VoidTy;
+  case 'a':
+    return Context.CharTy;
+  case 'i':
+    return Context.IntTy;
+  case 'U':
+    return Context.UnsignedIntTy;
+  case 'f':
+    return Context.FloatTy;
+  case 'z':
+    return Context.getSizeType();
+  case 'e':
+    return Context.OCLEventTy;
+  case 's':
+    return Context.OCLSamplerTy;
+  case '4':
+    return Context.getExtVectorType(Context.FloatTy, 4);
+  case '5':
+    return Context.getExtVectorType(Context.IntTy, 4);
+  case '6':
+    return Context.getExtVectorType(Context.UnsignedIntTy, 4);
+  case 'G':
+  case 'F':
+  case 'V':
+  case 'H':
+  case 'X':
+  case 'I':
+  case 'N':
+  case 'B':
+  case 'Y':
+  case 'A':
+  case 'T':
+  case 'M':
+  case 'W':
+    return GenType;
+  case 'c':
+  case 'd':
+  case 'D': {
+    unsigned Dims = getOpenCLImageDims(Context, GenType);
+    QualType ElementType = C == 'd' ? Context.FloatTy : Context.IntTy;
+    return getOpenCLVectorType(Context, ElementType, Dims == 3 ? 4 : Dims);
+  }
+  }
+
+  const ExtVectorType *VT = GenType->getAs<ExtVectorType>();
+  QualType ElementType = VT ? VT->getElementType() : GenType;
+  unsigned NumElements = VT ? VT->getNumElements() : 1;
+  unsigned Width = Context.getTypeSize(ElementType);
+  switch (C) {
+  case 'S':
+    return ElementType;
+  case 'u':
+    return getOpenCLVectorType(
+        Context, getOpenCLIntType(Context, Width, /*Signed=*/false),
+        NumElements);
+  case 'K':
+    return getOpenCLVectorType(
+        Context, getOpenCLIntType(Context, Width, /*Signed=*/true),
+        NumElements);
+  case 'R':
+    return VT ? getOpenCLBuiltinType(Context, 'K', GenType) : Context.IntTy;
+  case 'J':
+    return getOpenCLVectorType(Context, Context.IntTy, NumElements);
+  case 'w':
+    return getOpenCLVectorType(
+        Context,
+        getOpenCLIntType(Context, Width * 2,
+                         ElementType->isSignedIntegerType()),
+        NumElements);
+  }
+  llvm_unreachable("invalid OpenCL builtin type");
+}
+
+/// \brief Return the pointer type that the address space prefix \p Prefix
+/// of an OpenCL builtin signature gives \p Pointee. '*' stands for
+/// \p AddrSpace.
+static QualType getOpenCLBuiltinPointerType(ASTContext &Context, char Prefix,
+                                            QualType Pointee,
+                                            unsigned AddrSpace) {
+  Qualifiers Quals;
+  switch (Prefix) {
+  case '*':
+    Quals.setAddressSpace(AddrSpace);
+    break;
+  case 'g':
+    Quals.addVolatile();
+    Quals.setAddressSpace(LangAS::opencl_global);
+    break;
+  case 'l':
+    Quals.addVolatile();
+    Quals.setAddressSpace(LangAS::opencl_local);
+    break;
+  case 'O':
+    Quals.setAddressSpace(LangAS::opencl_global);
+    break;
+  case 'L':
+    Quals.setAddressSpace(LangAS::opencl_local);
+    break;
+  case 'Q':
+    Quals.addConst();
+    Quals.setAddressSpace(LangAS::opencl_global);
+    break;
+  case 'q':
+    Quals.addConst();
+    Quals.setAddressSpace(LangAS::opencl_local);
+    break;
+  case 'k':
+    Quals.addConst();
+    Quals.setAddressSpace(LangAS::opencl_constant);
+    break;
+  case 'p':
+    break;
+  default:
+    llvm_unreachable("invalid OpenCL builtin address space");
+  }
+  return Context.getPointerType(Context.getQualifiedType(Pointee, Quals));
+}
+
+static bool isOpenCLBuiltinPointerPrefix(char C) {
+  return StringRef("*glOLQqkp").count(C);
+}
+
+/// \brief Collect the overloads that the OpenCLBuiltins entry \p Builtin
+/// describes.
+static void getOpenCLTableOverloads(
+    Sema &S, const OpenCLBuiltinInfo &Builtin,
+    SmallVectorImpl<OpenCLBuiltinOverload> &Overloads) {
+  ASTContext &Context = S.Context;
+  StringRef Type(Builtin.Type);
+  StringRef Attrs(Builtin.Attrs);
+
+  char Family = 0;
+  for (char C : Type)
+    if (StringRef("GFVHXINBYATMW").count(C))
+      Family = C;
+  // With a scalar parameter, the scalar overload would be the same as the
+  // one with the gentype parameter.
+  bool VectorOnly = Attrs.count('n') || Type.drop_front().count('S');
+  unsigned MinImageDims = Attrs.count('3') ? 3 : Attrs.count('2') ? 2 : 1;
+
+  SmallVector<QualType, 32> GenTypes;
+  if (Family)
+    getOpenCLGenTypes(S, Family, GenTypes);
+  else
+    GenTypes.push_back(QualType());
+
+  // A pointer parameter in any address space has an overload for each.
+  SmallVector<unsigned, 3> AddrSpaces = {0};
+  if (Type.count('*'))
+    AddrSpaces = {LangAS::opencl_global, LangAS::opencl_local, 0};
+
+  for (QualType GenType : GenTypes) {
+    if (VectorOnly && !GenType->isExtVectorType())
+      continue;
+    if ((Family == 'M' || Family == 'W') &&
+        getOpenCLImageDims(Context, GenType) < MinImageDims)
+      continue;
+
+    for (unsigned AddrSpace : AddrSpaces) {
+      OpenCLBuiltinOverload Overload;
+      Overload.IsConst = Attrs.count('c');
+      Overload.IsPure = Attrs.count('p');
+      Overload.IsVariadic = Attrs.count('.');
+      for (unsigned I = 0, E = Type.size(); I != E; ++I) {
+        QualType T;
+        if (isOpenCLBuiltinPointerPrefix(Type[I])) {
+          char Prefix = Type[I++];
+          T = getOpenCLBuiltinPointerType(
+              Context, Prefix,
+              getOpenCLBuiltinType(Context, Type[I], GenType), AddrSpace);
+        } else {
+          T = getOpenCLBuiltinType(Context, Type[I], GenType);
+        }
+        if (Overload.ResultType.isNull())
+          Overload.ResultType = T;
+        else
+          Overload.ParamTypes.push_back(T);
+      }
+      Overloads.push_back(std::move(Overload));
+    }
+  }
+}
+
+/// \brief Remove \p Prefix from the start of \p Name, if it is there.
+static bool consumeOpenCLNamePrefix(StringRef &Name, StringRef Prefix) {
+  if (!Name.startswith(Prefix))
+    return false;
+  Name = Name.drop_front(Prefix.size());
+  return true;
+}
+
+/// \brief Consume a vector size of an OpenCL builtin name, such as the "4"
+/// of "vload4", from the start of \p Name. Return 1 if there is none.
+static unsigned consumeOpenCLVectorSize(StringRef &Name) {
+  static const std::pair<const char *, unsigned> Sizes[] = {
+      {"16", 16}, {"2", 2}, {"3", 3}, {"4", 4}, {"8", 8}};
+  for (const auto &Size : Sizes)
+    if (consumeOpenCLNamePrefix(Name, Size.first))
+      return Size.second;
+  return 1;
+}
+
+/// \brief Consume the name of an OpenCL scalar or vector type, such as
+/// "uchar16", from the start of \p Name. Return a null type if there is
+/// none, or if the target does not support it.
+static QualType consumeOpenCLTypeName(Sema &S, StringRef &Name) {
+  ASTContext &Context = S.Context;
+  const OpenCLOptions &Opts = Context.getTargetInfo().getSupportedOpenCLOpts();
+  unsigned CLVer = S.getLangOpts().OpenCLVersion;
+
+  const std::pair<const char *, QualType> Scalars[] = {
+      {"char", Context.CharTy},   {"uchar", Context.UnsignedCharTy},
+      {"short", Context.ShortTy}, {"ushort", Context.UnsignedShortTy},
+      {"int", Context.IntTy},     {"uint", Context.UnsignedIntTy},
+      {"long", Context.LongTy},   {"ulong", Context.UnsignedLongTy},
+      {"float", Context.FloatTy}, {"double", Context.DoubleTy},
+      {"half", Context.HalfTy}};
+  QualType ElementType;
+  for (const auto &Scalar : Scalars) {
+    if (consumeOpenCLNamePrefix(Name, Scalar.first)) {
+      ElementType = Scalar.second;
+      break;
+    }
+  }
+  if (ElementType.isNull() ||
+      (ElementType == Context.DoubleTy &&
+       !Opts.is_cl_khr_fp64_supported(CLVer)) ||
+      (ElementType == Context.HalfTy && !Opts.is_cl_khr_fp16_supported(CLVer)))
+    return QualType();
+
+  return getOpenCLVectorType(Context, ElementType,
+                             consumeOpenCLVectorSize(Name));
+}
+
+/// \brief Consume an optional rounding mode suffix, such as "_rte".
+static void consumeOpenCLRoundingMode(StringRef &Name) {
+  for (const char *Mode : {"_rte", "_rtz", "_rtp", "_rtn"})
+    if (consumeOpenCLNamePrefix(Name, Mode))
+      return;
+}
+
+/// \brief Collect the overloads of the OpenCL builtins whose names encode
+/// their types: as_type, convert_type, vloadn, vstoren, the half variants
+/// of vload and vstore, shuffle and shuffle2. Return false if \p Name is not
+/// one of them.
+static bool getOpenCLPatternOverloads(
+    Sema &S, StringRef Name,
+    SmallVectorImpl<OpenCLBuiltinOverload> &Overloads) {
+  ASTContext &Context = S.Context;
+  auto AddOverload = [&](QualType ResultType, ArrayRef<QualType> ParamTypes,
+                         bool IsConst) {
+    OpenCLBuiltinOverload Overload;
+    Overload.ResultType = ResultType;
+    Overload.ParamTypes.append(ParamTypes.begin(), ParamTypes.end());
+    Overload.IsConst = IsConst;
+    Overload.IsPure = false;
+    Overload.IsVariadic = false;
+    Overloads.push_back(std::move(Overload));
+  };
+  auto GetPointerType = [&](QualType Pointee, unsigned AddrSpace,
+                            bool IsConst) {
+    Qualifiers Quals;
+    Quals.setAddressSpace(AddrSpace);
+    if (IsConst)
+      Quals.addConst();
+    return Context.getPointerType(Context.getQualifiedType(Pointee, Quals));
+  };
+  static const unsigned LoadAddrSpaces[] = {
+      LangAS::opencl_constant, LangAS::opencl_global, LangAS::opencl_local, 0};
+  static const unsigned StoreAddrSpaces[] = {LangAS::opencl_global,
+                                             LangAS::opencl_local, 0};
+
+  SmallVector<QualType, 64> AllTypes;
+  getOpenCLGenTypes(S, 'T', AllTypes);
+  SmallVector<QualType, 12> ScalarTypes;
+  for (QualType T : AllTypes)
+    if (!T->isExtVectorType())
+      ScalarTypes.push_back(T);
+
+  // OpenCL v1.2 s6.2.4.2 - Reinterpreting Types Using as_type() and
+  // as_typen().
+  if (consumeOpenCLNamePrefix(Name, "as_")) {
+    QualType DestType = consumeOpenCLTypeName(S, Name);
+    if (DestType.isNull() || !Name.empty())
+      return false;
+    for (QualType T : AllTypes)
+      if (Context.getTypeSize(T) == Context.getTypeSize(DestType))
+        AddOverload(DestType, T, /*IsConst=*/true);
+    return true;
+  }
+
+  // OpenCL v1.2 s6.2.3 - Explicit Conversions.
+  if (consumeOpenCLNamePrefix(Name, "convert_")) {
+    QualType DestType = consumeOpenCLTypeName(S, Name);
+    if (DestType.isNull())
+      return false;
+    const ExtVectorType *DestVT = DestType->getAs<ExtVectorType>();
+    QualType DestElementType = DestVT ? DestVT->getElementType() : DestType;
+    if (DestElementType->isIntegerType())
+      consumeOpenCLNamePrefix(Name, "_sat");
+    consumeOpenCLRoundingMode(Name);
+    if (!Name.empty())
+      return false;
+    unsigned NumElements = DestVT ? DestVT->getNumElements() : 1;
+    for (QualType T : AllTypes) {
+      const ExtVectorType *VT = T->getAs<ExtVectorType>();
+      if ((VT ? VT->getNumElements() : 1) == NumElements)
+        AddOverload(DestType, T, /*IsConst=*/true);
+    }
+    return true;
+  }
+
+  // OpenCL v1.2 s6.12.7 - Vector Data Load and Store Functions.
+  bool Aligned = consumeOpenCLNamePrefix(Name, "vloada_half");
+  if (Aligned || consumeOpenCLNamePrefix(Name, "vload_half")) {
+    unsigned Size = consumeOpenCLVectorSize(Name);
+    if ((Aligned && Size == 1) || !Name.empty())
+      return false;
+    QualType ResultType = getOpenCLVectorType(Context, Context.FloatTy, Size);
+    for (unsigned AddrSpace : LoadAddrSpaces)
+      AddOverload(ResultType,
+                  {Context.getSizeType(),
+                   GetPointerType(Context.HalfTy, AddrSpace, true)},
+                  /*IsConst=*/false);
+    return true;
+  }
+  Aligned = consumeOpenCLNamePrefix(Name, "vstorea_half");
+  if (Aligned || consumeOpenCLNamePrefix(Name, "vstore_half")) {
+    unsigned Size = consumeOpenCLVectorSize(Name);
+    consumeOpenCLRoundingMode(Name);
+    if ((Aligned && Size == 1) || !Name.empty())
+      return false;
+    SmallVector<QualType, 2> DataTypes;
+    getOpenCLFloatTypes(S, DataTypes);
+    for (QualType DataType : DataTypes) {
+      if (DataType == Context.HalfTy)
+        continue;
+      for (unsigned AddrSpace : StoreAddrSpaces)
+        AddOverload(Context.VoidTy,
+                    {getOpenCLVectorType(Context, DataType, Size),
+                     Context.getSizeType(),
+                     GetPointerType(Context.HalfTy, AddrSpace, false)},
+                    /*IsConst=*/false);
+    }
+    return true;
+  }
+  bool Load = consumeOpenCLNamePrefix(Name, "vload");
+  if (Load || consumeOpenCLNamePrefix(Name, "vstore")) {
+    unsigned Size = consumeOpenCLVectorSize(Name);
+    if (Size == 1 || !Name.empty())
+      return false;
+    for (QualType T : ScalarTypes) {
+      QualType VectorType = Context.getExtVectorType(T, Size);
+      if (Load) {
+        for (unsigned AddrSpace : LoadAddrSpaces)
+          AddOverload(VectorType,
+                      {Context.getSizeType(),
+                       GetPointerType(T, AddrSpace, true)},
+                      /*IsConst=*/false);
+      } else {
+        for (unsigned AddrSpace : StoreAddrSpaces)
+          AddOverload(Context.VoidTy,
+                      {VectorType, Context.getSizeType(),
+                       GetPointerType(T, AddrSpace, false)},
+                      /*IsConst=*/false);
+      }
+    }
+    return true;
+  }
+
+  // OpenCL v1.2 s6.12.12 - Miscellaneous Vector Functions.
+  if (Name == "shuffle" || Name == "shuffle2") {
+    static const unsigned ShuffleSizes[] = {2, 4, 8, 16};
+    for (QualType T : ScalarTypes) {
+      QualType MaskElementType = getOpenCLIntType(
+          Context, Context.getTypeSize(T), /*Signed=*/false);
+      for (unsigned InSize : ShuffleSizes) {
+        QualType InType = Context.getExtVectorType(T, InSize);
+        for (unsigned OutSize : ShuffleSizes) {
+          QualType MaskType =
+              Context.getExtVectorType(MaskElementType, OutSize);
+          QualType OutType = Context.getExtVectorType(T, OutSize);
+          if (Name == "shuffle")
+            AddOverload(OutType, {InType, MaskType}, /*IsConst=*/true);
+          else
+            AddOverload(OutType, {InType, InType, MaskType},
+                        /*IsConst=*/true);
+        }
+      }
+    }
+    return true;
+  }
+
+  return false;
+}
+
+/// \brief Declare the overloads of the OpenCL builtin function that \p R
+/// looks up, if it is one, in the translation unit, and add them to \p R.
+///
+/// This is how -fdeclare-opencl-builtins provides the functions of
+/// opencl-c.h without parsing their thousands of declarations.
+static bool InsertOpenCLBuiltinDeclarations(Sema &S, LookupResult &R,
+                                            IdentifierInfo *II) {
+  ASTContext &Context = S.Context;
+  StringRef Name = II->getName();
+  DeclContext *Parent = Context.getTranslationUnitDecl();
+
+  SmallVector<OpenCLBuiltinOverload, 32> Overloads;
+  const auto &Index = getOpenCLBuiltinIndex();
+  auto Entries = Index.find(Name);
+  if (Entries != Index.end()) {
+    for (unsigned I : Entries->second) {
+      const OpenCLBuiltinInfo &Builtin = OpenCLBuiltins[I];
+      if (S.getLangOpts().OpenCLVersion >= Builtin.Version)
+        getOpenCLTableOverloads(S, Builtin, Overloads);
+    }
+  } else if (!getOpenCLPatternOverloads(S, Name, Overloads)) {
+    return false;
+  }
+
+  for (const OpenCLBuiltinOverload &Overload : Overloads) {
+    FunctionProtoType::ExtProtoInfo EPI;
+    EPI.Variadic = Overload.IsVariadic;
+    QualType FnType =
+        Context.getFunctionType(Overload.ResultType, Overload.ParamTypes, EPI);
+
+    FunctionDecl *New = FunctionDecl::Create(
+        Context, Parent, R.getNameLoc(), R.getNameLoc(), II, FnType,
+        /*TInfo=*/nullptr, SC_Extern, /*isInlineSpecified=*/false,
+        /*hasWrittenPrototype=*/true);
+    New->setImplicit();
+
+    SmallVector<ParmVarDecl *, 4> Params;
+    for (unsigned I = 0, E = Overload.ParamTypes.size(); I != E; ++I) {
+      ParmVarDecl *Parm = ParmVarDecl::Create(
+          Context, New, SourceLocation(), SourceLocation(), nullptr,
+          Overload.ParamTypes[I], /*TInfo=*/nullptr, SC_None, nullptr);
+      Parm->setScopeInfo(0, I);
+      Params.push_back(Parm);
+    }
+    New->setParams(Params);
+
+    New->addAttr(OverloadableAttr::CreateImplicit(Context));
+    if (Overload.IsConst)
+      New->addAttr(ConstAttr::CreateImplicit(Context));
+    if (Overload.IsPure)
+      New->addAttr(PureAttr::CreateImplicit(Context));
+
+    // Inject the declaration into translation unit scope, as
+    // Sema::LazilyCreateBuiltin does.
+    DeclContext *SavedContext = S.CurContext;
+    S.CurContext = Parent;
+    S.PushOnScopeChains(New, S.TUScope);
+    S.CurContext = SavedContext;
+
+    R.addDecl(New);
+  }
+
+  if (Overloads.empty())
+    return false;
+  R.resolveKind();
+  return true;
+}
+
+namespace {
+/// \brief A function intrinsic of arm_neon.h that -flazy-neon-intrinsics
+/// defines when it is first used.
+struct LazyNeonIntrinsicInfo {
+  const char *Name;
+  /// The group, one per architectural guard, that enables the intrinsic.
+  unsigned Group;
+  /// The definitions for each byte order; empty if there is none.
+  const char *LittleEndian;
+  const char *BigEndian;
+};
+} // end anonymous namespace
+
+static const LazyNeonIntrinsicInfo LazyNeonIntrinsics[] = {
+#define NEON_LAZY_INTRINSIC(NAME, GROUP, LITTLE, BIG) \
+  { NAME, GROUP, LITTLE, BIG },
+#include "clang/Basic/arm_neon_lazy.inc"
+};
+
+void Sema::ActOnPragmaNeonLazyIntrinsics(unsigned Group,
+                                         SourceLocation PragmaLoc) {
+  if (!getLangOpts().LazyNeonIntrinsics)
+    return;
+
+  bool BigEndian = Context.getTargetInfo().isBigEndian();
+  for (unsigned I = 0, E = llvm::array_lengthof(LazyNeonIntrinsics); I != E;
+       ++I) {
+    const LazyNeonIntrinsicInfo &Info = LazyNeonIntrinsics[I];
+    if (Info.Group == Group &&
+        *(BigEndian ? Info.BigEndian : Info.LittleEndian))
+      PendingNeonIntrinsics.insert(std::make_pair(Info.Name, I));
+  }
+}
+
+/// \brief Define the NEON intrinsic that \p R looks up, if arm_neon.h
+/// enabled it and it has not been defined yet, and add it to \p R.
+///
+/// This is how -flazy-neon-intrinsics provides the functions of arm_neon.h
+/// without parsing the definitions of the thousands that are never used.
+static bool InsertLazyNeonIntrinsic(Sema &S, LookupResult &R,
+                                    IdentifierInfo *II) {
+  if (!S.LazyNeonIntrinsicParser || R.isForRedeclaration())
+    return false;
+
+  auto Pending = S.PendingNeonIntrinsics.find(II->getName());
+  if (Pending == S.PendingNeonIntrinsics.end())
+    return false;
+
+  // Tokens entered while the parser may backtrack would be parsed again;
+  // the lookup is repeated once the parser has committed.
+  if (S.getPreprocessor().isBacktrackEnabled())
+    return false;
+
+  const LazyNeonIntrinsicInfo &Info = LazyNeonIntrinsics[Pending->second];
+  S.PendingNeonIntrinsics.erase(Pending);
+  S.LazyNeonIntrinsicParser(S.OpaqueNeonParser,
+                            S.Context.getTargetInfo().isBigEndian()
+                                ? Info.BigEndian
+                                : Info.LittleEndian);
+
+  for (NamedDecl *D : S.Context.getTranslationUnitDecl()->lookup(II)) {
+    R.addDecl(D);
+    // The definition was not parsed at the top level, so hand it to the
+    // consumer here, as template instantiation does.
+    S.Consumer.HandleTopLevelDecl(DeclGroupRef(D));
+  }
+  R.resolveKind();
+  return !R.empty();
+}
+
 /// \brief Lookup a builtin function, when name lookup would otherwise
 /// fail.
 static bool LookupBuiltin(Sema &S, LookupResult &R) {
@@ -690,6 +1381,16 @@ static bool LookupBuiltin(Sema &S, LookupResult &R) {
         }
       }
 
+      if (S.getLangOpts().OpenCL && S.getLangOpts().DeclareOpenCLBuiltins &&
+          S.getLangOpts().OpenCLVersion < 200 &&
+          InsertOpenCLBuiltinDeclarations(S, R, II))
+        return true;
+
+      if (S.getLangOpts().LazyNeonIntrinsics &&
+          NameKind == Sema::LookupOrdinaryName &&
+          InsertLazyNeonIntrinsic(S, R, II))
+        return true;
+
       // If this is a builtin on this (or all) targets, create the decl.
       if (unsigned BuiltinID = II->getBuiltinID()) {
         // In C++ and OpenCL (spec v1.2 s6.9.f), we don't have any predefined
@@ -3885,20 +4586,30 @@ void TypoCorrectionConsumer::addKeywordResult(StringRef Keyword) {
   addName(Keyword, nullptr, nullptr, true);
 }
 
-void TypoCorrectionConsumer::addName(StringRef Name, NamedDecl *ND,
-                                     NestedNameSpecifier *NNS, bool isKeyword) {
+/// \brief Computes the edit distance between a typo and a name, or returns
+/// TypoCorrection::InvalidDistance if the name is too different from the typo
+/// to be a correction for it.
+static unsigned getTypoEditDistance(StringRef TypoStr, StringRef Name) {
   // Use a simple length-based heuristic to determine the minimum possible
   // edit distance. If the minimum isn't good enough, bail out early.
-  StringRef TypoStr = Typo->getName();
   unsigned MinED = abs((int)Name.size() - (int)TypoStr.size());
   if (MinED && TypoStr.size() / MinED < 3)
-    return;
+    return TypoCorrection::InvalidDistance;
 
   // Compute an upper bound on the allowable edit distance, so that the
   // edit-distance algorithm can short-circuit.
   unsigned UpperBound = (TypoStr.size() + 2) / 3 + 1;
   unsigned ED = TypoStr.edit_distance(Name, true, UpperBound);
-  if (ED >= UpperBound) return;
+  if (ED >= UpperBound)
+    return TypoCorrection::InvalidDistance;
+  return ED;
+}
+
+void TypoCorrectionConsumer::addName(StringRef Name, NamedDecl *ND,
+                                     NestedNameSpecifier *NNS, bool isKeyword) {
+  unsigned ED = getTypoEditDistance(Typo->getName(), Name);
+  if (ED == TypoCorrection::InvalidDistance)
+    return;
 
   TypoCorrection TC(&SemaRef.Context.Idents.get(Name), ND, NNS, ED);
   if (isKeyword) TC.makeKeyword();
@@ -3906,6 +4617,54 @@ void TypoCorrectionConsumer::addName(StringRef Name, NamedDecl *ND,
   addCorrection(TC);
 }
 
+void TypoCorrectionIdentifierIndex::addName(StringRef Name) {
+  auto Inserted = KnownNames.insert(Name);
+  if (Inserted.second)
+    Names.push_back(Inserted.first->getKey());
+}
+
+void TypoCorrectionIdentifierIndex::findCandidates(
+    IdentifierInfo *Typo, IdentifierTable &Idents, uint32_t Generation,
+    llvm::function_ref<void(StringRef)> Found) {
+  // Pick up the identifiers created since the table was last walked.
+  if (Idents.size() != NumTableIdentifiers) {
+    for (const auto &I : Idents)
+      addName(I.getKey());
+    NumTableIdentifiers = Idents.size();
+  }
+
+  // Walk through identifiers in external identifier sources again whenever
+  // more of them may have been loaded.
+  if (IdentifierInfoLookup *External = Idents.getExternalIdentifierLookup()) {
+    if (!WalkedExternalIdentifiers || Generation != ExternalGeneration) {
+      std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
+      do {
+        StringRef Name = Iter->Next();
+        if (Name.empty())
+          break;
+
+        addName(Name);
+      } while (true);
+      WalkedExternalIdentifiers = true;
+      ExternalGeneration = Generation;
+    }
+  }
+
+  TypoCandidates &Candidates = Typos[Typo];
+  StringRef TypoStr = Typo->getName();
+  for (unsigned I = Candidates.NumNamesCompared, E = Names.size(); I != E;
+       ++I) {
+    if (getTypoEditDistance(TypoStr, Names[I]) !=
+        TypoCorrection::InvalidDistance)
+      Candidates.Names.push_back(Names[I]);
+  }
+  NumComparisons += Names.size() - Candidates.NumNamesCompared;
+  Candidates.NumNamesCompared = Names.size();
+
+  for (StringRef Name : Candidates.Names)
+    Found(Name);
+}
+
 static const unsigned MaxTypoDistanceResultSets = 5;
 
 void TypoCorrectionConsumer::addCorrection(TypoCorrection Correction) {
@@ -4518,6 +5277,13 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
   unsigned Limit = getDiagnostics().getDiagnosticOptions().SpellCheckingLimit;
   if (Limit && TyposCorrected >= Limit)
     return nullptr;
+
+  // Likewise, stop once the typos so far were compared against enough names,
+  // which bounds the time spent on files with many distinct typos.
+  unsigned Budget = getDiagnostics().getDiagnosticOptions().SpellCheckingBudget;
+  if (Budget && TypoCorrectionIndex &&
+      TypoCorrectionIndex->getNumComparisons() >= Budget)
+    return nullptr;
   ++TyposCorrected;
 
   // If we're handling a missing symbol error, using modules, and the
@@ -4563,24 +5329,14 @@ std::unique_ptr<TypoCorrectionConsumer> Sema::makeTypoCorrectionConsumer(
 
   if (IsUnqualifiedLookup || SearchNamespaces) {
     // For unqualified lookup, look through all of the names that we have
-    // seen in this translation unit.
-    // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    for (const auto &I : Context.Idents)
-      Consumer->FoundName(I.getKey());
-
-    // Walk through identifiers in external identifier sources.
+    // seen in this translation unit and in external identifier sources.
     // FIXME: Re-add the ability to skip very unlikely potential corrections.
-    if (IdentifierInfoLookup *External
-                            = Context.Idents.getExternalIdentifierLookup()) {
-      std::unique_ptr<IdentifierIterator> Iter(External->getIdentifiers());
-      do {
-        StringRef Name = Iter->Next();
-        if (Name.empty())
-          break;
-
-        Consumer->FoundName(Name);
-      } while (true);
-    }
+    if (!TypoCorrectionIndex)
+      TypoCorrectionIndex = llvm::make_unique<TypoCorrectionIdentifierIndex>();
+    ExternalASTSource *Source = Context.getExternalSource();
+    TypoCorrectionIndex->findCandidates(
+        Typo, Context.Idents, Source ? Source->getGeneration() : 0,
+        [&](StringRef Name) { Consumer->FoundName(Name); });
   }
 
   AddKeywordsToConsumer(*this, *Consumer, S, CCCRef, SS && SS->isNotEmpty());
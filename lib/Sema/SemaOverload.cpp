@@ -815,6 +815,7 @@ void OverloadCandidateSet::clear() {
   NumInlineSequences = 0;
   Candidates.clear();
   Functions.clear();
+  ComputedConversions.clear();
 }
 
 namespace {
@@ -4841,6 +4842,33 @@ TryCopyInitialization(Sema &S, Expr *From, QualType ToType,
                                /*AllowObjCConversionOnExplicit=*/false);
 }
 
+/// TryCopyInitializationForCandidate - Compute the implicit conversion
+/// sequence of an argument for a candidate of @p CandidateSet, storing it in
+/// @p Conversion. Conversion sequences computed for earlier candidates with
+/// the same argument, parameter type and flags are reused.
+static void
+TryCopyInitializationForCandidate(Sema &S, OverloadCandidateSet &CandidateSet,
+                                  ImplicitConversionSequence &Conversion,
+                                  Expr *From, QualType ToType,
+                                  bool SuppressUserConversions,
+                                  bool InOverloadResolution,
+                                  bool AllowExplicit = false) {
+  unsigned Flags = SuppressUserConversions | InOverloadResolution << 1 |
+                   AllowExplicit << 2;
+  if (const ImplicitConversionSequence *Known =
+          CandidateSet.getComputedConversion(From, ToType, Flags)) {
+    Conversion = *Known;
+    return;
+  }
+
+  Conversion = TryCopyInitialization(S, From, ToType, SuppressUserConversions,
+                                     InOverloadResolution,
+                                     /*AllowObjCWritebackConversion=*/
+                                       S.getLangOpts().ObjCAutoRefCount,
+                                     AllowExplicit);
+  CandidateSet.addComputedConversion(From, ToType, Flags, Conversion);
+}
+
 static bool TryCopyInitialization(const CanQualType FromQTy,
                                   const CanQualType ToQTy,
                                   Sema &S,
@@ -5832,13 +5860,12 @@ Sema::AddOverloadCandidate(FunctionDecl *Function,
       // (13.3.3.1) that converts that argument to the corresponding
       // parameter of F.
       QualType ParamType = Proto->getParamType(ArgIdx);
-      Candidate.Conversions[ArgIdx]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
-                                SuppressUserConversions,
-                                /*InOverloadResolution=*/true,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount,
-                                AllowExplicit);
+      TryCopyInitializationForCandidate(*this, CandidateSet,
+                                        Candidate.Conversions[ArgIdx],
+                                        Args[ArgIdx], ParamType,
+                                        SuppressUserConversions,
+                                        /*InOverloadResolution=*/true,
+                                        AllowExplicit);
       if (Candidate.Conversions[ArgIdx].isBad()) {
         Candidate.Viable = false;
         Candidate.FailureKind = ovl_fail_bad_conversion;
@@ -6209,12 +6236,11 @@ Sema::AddMethodCandidate(CXXMethodDecl *Method, DeclAccessPair FoundDecl,
       // (13.3.3.1) that converts that argument to the corresponding
       // parameter of F.
       QualType ParamType = Proto->getParamType(ArgIdx);
-      Candidate.Conversions[ArgIdx + 1]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamType,
-                                SuppressUserConversions,
-                                /*InOverloadResolution=*/true,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount);
+      TryCopyInitializationForCandidate(*this, CandidateSet,
+                                        Candidate.Conversions[ArgIdx + 1],
+                                        Args[ArgIdx], ParamType,
+                                        SuppressUserConversions,
+                                        /*InOverloadResolution=*/true);
       if (Candidate.Conversions[ArgIdx + 1].isBad()) {
         Candidate.Viable = false;
         Candidate.FailureKind = ovl_fail_bad_conversion;
@@ -6799,12 +6825,11 @@ void Sema::AddBuiltinCandidate(QualType ResultTy, QualType *ParamTys,
       Candidate.Conversions[ArgIdx]
         = TryContextuallyConvertToBool(*this, Args[ArgIdx]);
     } else {
-      Candidate.Conversions[ArgIdx]
-        = TryCopyInitialization(*this, Args[ArgIdx], ParamTys[ArgIdx],
-                                ArgIdx == 0 && IsAssignmentOperator,
-                                /*InOverloadResolution=*/false,
-                                /*AllowObjCWritebackConversion=*/
-                                  getLangOpts().ObjCAutoRefCount);
+      TryCopyInitializationForCandidate(*this, CandidateSet,
+                                        Candidate.Conversions[ArgIdx],
+                                        Args[ArgIdx], ParamTys[ArgIdx],
+                                        ArgIdx == 0 && IsAssignmentOperator,
+                                        /*InOverloadResolution=*/false);
     }
     if (Candidate.Conversions[ArgIdx].isBad()) {
       Candidate.Viable = false;
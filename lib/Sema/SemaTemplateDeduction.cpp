@@ -23,6 +23,7 @@
 #include "clang/Sema/Sema.h"
 #include "clang/Sema/Template.h"
 #include "llvm/ADT/SmallBitVector.h"
+#include "llvm/ADT/SmallString.h"
 #include <algorithm>
 
 namespace clang {
@@ -3300,6 +3301,33 @@ DeduceTemplateArgumentByListElement(Sema &S,
                                             ArgType, Info, Deduced, TDF);
 }
 
+/// \brief Build the key under which a successful deduction of \p
+/// FunctionTemplate's arguments from the call arguments \p Args is
+/// remembered.
+///
+/// Only the types and value kinds of the arguments take part in deduction,
+/// except for initializer lists, overload sets and other placeholders, so
+/// calls involving those are not remembered. Access checking during
+/// substitution depends on the context of the call, which is part of the key.
+static bool getDeducedCallKey(Sema &S, FunctionTemplateDecl *FunctionTemplate,
+                              ArrayRef<Expr *> Args,
+                              SmallVectorImpl<char> &Key) {
+  auto AddPointer = [&](const void *Ptr) {
+    Key.append(reinterpret_cast<const char *>(&Ptr),
+               reinterpret_cast<const char *>(&Ptr + 1));
+  };
+  AddPointer(FunctionTemplate->getCanonicalDecl());
+  AddPointer(S.CurContext);
+  for (Expr *Arg : Args) {
+    if (Arg->isTypeDependent() || isa<InitListExpr>(Arg) ||
+        Arg->getType()->isPlaceholderType())
+      return false;
+    AddPointer(S.Context.getCanonicalType(Arg->getType()).getAsOpaquePtr());
+    Key.push_back(Arg->getValueKind());
+  }
+  return true;
+}
+
 /// \brief Perform template argument deduction from a function call
 /// (C++ [temp.deduct.call]).
 ///
@@ -3327,6 +3355,37 @@ Sema::TemplateDeductionResult Sema::DeduceTemplateArguments(
   if (FunctionTemplate->isInvalidDecl())
     return TDK_Invalid;
 
+  // Reuse the specialization deduced for an identical earlier call.
+  SmallString<64> CallKey;
+  if (ExplicitTemplateArgs || PartialOverloading ||
+      !getDeducedCallKey(*this, FunctionTemplate, Args, CallKey))
+    return DeduceTemplateArgumentsFromCall(FunctionTemplate,
+                                           ExplicitTemplateArgs, Args,
+                                           Specialization, Info,
+                                           PartialOverloading);
+
+  auto Known = DeducedCallSpecializations.find(CallKey);
+  if (Known != DeducedCallSpecializations.end()) {
+    ++NumDeducedCallSpecializationsReused;
+    Specialization = Known->second;
+    return TDK_Success;
+  }
+
+  TemplateDeductionResult Result = DeduceTemplateArgumentsFromCall(
+      FunctionTemplate, ExplicitTemplateArgs, Args, Specialization, Info,
+      PartialOverloading);
+  if (Result == TDK_Success)
+    DeducedCallSpecializations[CallKey] = Specialization;
+  return Result;
+}
+
+/// \brief Perform template argument deduction from a function call, without
+/// consulting the specializations deduced for earlier identical calls.
+Sema::TemplateDeductionResult Sema::DeduceTemplateArgumentsFromCall(
+    FunctionTemplateDecl *FunctionTemplate,
+    TemplateArgumentListInfo *ExplicitTemplateArgs, ArrayRef<Expr *> Args,
+    FunctionDecl *&Specialization, TemplateDeductionInfo &Info,
+    bool PartialOverloading) {
   FunctionDecl *Function = FunctionTemplate->getTemplatedDecl();
   unsigned NumParams = Function->getNumParams();
 
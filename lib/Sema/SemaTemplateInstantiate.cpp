@@ -18,6 +18,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/Basic/LangOptions.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/Sema/DeclSpec.h"
 #include "clang/Sema/Initialization.h"
 #include "clang/Sema/Lookup.h"
@@ -1481,13 +1482,13 @@ TypeSourceInfo *Sema::SubstType(TypeLoc TL,
       !TL.getType()->isVariablyModifiedType()) {
     // FIXME: Make a copy of the TypeLoc data here, so that we can
     // return a new TypeSourceInfo. Inefficient!
-    TypeLocBuilder TLB;
+    TypeLocBuilder TLB(*TypeLocBuilderBuffers);
     TLB.pushFullCopy(TL);
     return TLB.getTypeSourceInfo(Context, TL.getType());
   }
 
   TemplateInstantiator Instantiator(*this, Args, Loc, Entity);
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(*TypeLocBuilderBuffers);
   TLB.reserve(TL.getFullDataSize());
   QualType Result = Instantiator.TransformType(TLB, TL);
   if (Result.isNull())
@@ -1554,7 +1555,7 @@ TypeSourceInfo *Sema::SubstFunctionDeclType(TypeSourceInfo *T,
 
   TemplateInstantiator Instantiator(*this, Args, Loc, Entity);
 
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(*TypeLocBuilderBuffers);
 
   TypeLoc TL = T->getTypeLoc();
   TLB.reserve(TL.getFullDataSize());
@@ -1952,6 +1953,13 @@ Sema::InstantiateClass(SourceLocation PointOfInstantiation,
     return true;
   PrettyDeclStackTraceEntry CrashInfo(*this, Instantiation, SourceLocation(),
                                       "instantiating class definition");
+  TimeTraceScope TimeScope("InstantiateClass", [&] {
+    std::string Name;
+    llvm::raw_string_ostream OS(Name);
+    Instantiation->getNameForDiagnostic(OS, getPrintingPolicy(),
+                                        /*Qualified=*/true);
+    return OS.str();
+  });
 
   // Enter the scope of this instantiation. We don't use
   // PushDeclContext because we don't have a scope.
@@ -3997,7 +3997,7 @@ TypeSourceInfo *TreeTransform<Derived>::TransformType(TypeSourceInfo *DI) {
   if (getDerived().AlreadyTransformed(DI->getType()))
     return DI;
 
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(*SemaRef.TypeLocBuilderBuffers);
 
   TypeLoc TL = DI->getTypeLoc();
   TLB.reserve(TL.getFullDataSize());
@@ -4135,7 +4135,7 @@ TypeSourceInfo *TreeTransform<Derived>::TransformTSIInObjectScope(
   QualType T = TL.getType();
   assert(!getDerived().AlreadyTransformed(T));
 
-  TypeLocBuilder TLB;
+  TypeLocBuilder TLB(*SemaRef.TypeLocBuilderBuffers);
   QualType Result;
 
   if (isa<TemplateSpecializationType>(T)) {
@@ -4653,7 +4653,7 @@ ParmVarDecl *TreeTransform<Derived>::TransformFunctionTypeParam(
     TypeLoc OldTL = OldDI->getTypeLoc();
     PackExpansionTypeLoc OldExpansionTL = OldTL.castAs<PackExpansionTypeLoc>();
 
-    TypeLocBuilder TLB;
+    TypeLocBuilder TLB(*SemaRef.TypeLocBuilderBuffers);
     TypeLoc NewTL = OldDI->getTypeLoc();
     TLB.reserve(NewTL.getFullDataSize());
 
@@ -8848,6 +8848,13 @@ TreeTransform<Derived>::TransformInitListExpr(InitListExpr *E) {
                                       E->getRBraceLoc(), E->getType());
 }
 
+template<typename Derived>
+ExprResult
+TreeTransform<Derived>::TransformPackedArrayInitExpr(PackedArrayInitExpr *E) {
+  // Rebuild from the list as written; initialization will pack it again.
+  return getDerived().TransformInitListExpr(E->getSyntacticForm());
+}
+
 template<typename Derived>
 ExprResult
 TreeTransform<Derived>::TransformDesignatedInitExpr(DesignatedInitExpr *E) {
@@ -9760,7 +9767,7 @@ TreeTransform<Derived>::TransformTypeTraitExpr(TypeTraitExpr *E) {
     TypeSourceInfo *From = E->getArg(I);
     TypeLoc FromTL = From->getTypeLoc();
     if (!FromTL.getAs<PackExpansionTypeLoc>()) {
-      TypeLocBuilder TLB;
+      TypeLocBuilder TLB(*SemaRef.TypeLocBuilderBuffers);
       TLB.reserve(FromTL.getFullDataSize());
       QualType To = getDerived().TransformType(TLB, FromTL);
       if (To.isNull())
@@ -9803,7 +9810,7 @@ TreeTransform<Derived>::TransformTypeTraitExpr(TypeTraitExpr *E) {
       // expansion.
       Sema::ArgumentPackSubstitutionIndexRAII SubstIndex(getSema(), -1);
 
-      TypeLocBuilder TLB;
+      TypeLocBuilder TLB(*SemaRef.TypeLocBuilderBuffers);
       TLB.reserve(From->getTypeLoc().getFullDataSize());
 
       QualType To = getDerived().TransformType(TLB, PatternTL);
@@ -9828,7 +9835,7 @@ TreeTransform<Derived>::TransformTypeTraitExpr(TypeTraitExpr *E) {
     // pack(s).
     for (unsigned I = 0; I != *NumExpansions; ++I) {
       Sema::ArgumentPackSubstitutionIndexRAII SubstIndex(SemaRef, I);
-      TypeLocBuilder TLB;
+      TypeLocBuilder TLB(*SemaRef.TypeLocBuilderBuffers);
       TLB.reserve(PatternTL.getFullDataSize());
       QualType To = getDerived().TransformType(TLB, PatternTL);
       if (To.isNull())
@@ -9857,7 +9864,7 @@ TreeTransform<Derived>::TransformTypeTraitExpr(TypeTraitExpr *E) {
     // forgetting the partially-substituted parameter pack.
     ForgetPartiallySubstitutedPackRAII Forget(getDerived());
 
-    TypeLocBuilder TLB;
+    TypeLocBuilder TLB(*SemaRef.TypeLocBuilderBuffers);
     TLB.reserve(From->getTypeLoc().getFullDataSize());
 
     QualType To = getDerived().TransformType(TLB, PatternTL);
@@ -16,6 +16,31 @@
 
 using namespace clang;
 
+TypeLocBuilderBufferCache::~TypeLocBuilderBufferCache() {
+  for (auto &B : Buffers)
+    delete[] B.first;
+}
+
+char *TypeLocBuilderBufferCache::take(size_t Size, size_t &Capacity) {
+  for (unsigned I = 0, E = Buffers.size(); I != E; ++I) {
+    if (Buffers[I].second < Size)
+      continue;
+    char *Buffer = Buffers[I].first;
+    Capacity = Buffers[I].second;
+    Buffers.erase(Buffers.begin() + I);
+    return Buffer;
+  }
+  return nullptr;
+}
+
+void TypeLocBuilderBufferCache::give(char *Buffer, size_t Capacity) {
+  if (Buffers.size() == MaxBuffers || Capacity > MaxBufferSize) {
+    delete[] Buffer;
+    return;
+  }
+  Buffers.push_back(std::make_pair(Buffer, Capacity));
+}
+
 void TypeLocBuilder::pushFullCopy(TypeLoc L) {
   size_t Size = L.getFullDataSize();
   reserve(Size);
@@ -45,15 +70,23 @@ void TypeLocBuilder::pushFullCopy(TypeLoc L) {
 void TypeLocBuilder::grow(size_t NewCapacity) {
   assert(NewCapacity > Capacity);
 
-  // Allocate the new buffer and copy the old data into it.
-  char *NewBuffer = new char[NewCapacity];
+  // Allocate the new buffer, or reuse a cached one that is large enough, and
+  // copy the old data into it.
+  char *NewBuffer = nullptr;
+  if (Cache) {
+    size_t CachedCapacity;
+    if ((NewBuffer = Cache->take(NewCapacity, CachedCapacity)))
+      NewCapacity = CachedCapacity;
+  }
+  if (!NewBuffer)
+    NewBuffer = new char[NewCapacity];
   unsigned NewIndex = Index + NewCapacity - Capacity;
   memcpy(&NewBuffer[NewIndex],
          &Buffer[Index],
          Capacity - Index);
 
   if (Buffer != InlineBuffer.buffer)
-    delete[] Buffer;
+    releaseBuffer(Buffer, Capacity);
 
   Buffer = NewBuffer;
   Capacity = NewCapacity;
@@ -17,9 +17,36 @@
 
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/TypeLoc.h"
+#include "llvm/ADT/SmallVector.h"
 
 namespace clang {
 
+/// \brief Keeps the heap buffers of destroyed TypeLocBuilders for reuse.
+///
+/// Template instantiation transforms types with one short-lived
+/// TypeLocBuilder after another, and every type whose location data does
+/// not fit in the inline buffer would otherwise allocate and free its own.
+class TypeLocBuilderBufferCache {
+  enum { MaxBuffers = 8, MaxBufferSize = 4096 };
+
+  /// The cached buffers and their capacities.
+  SmallVector<std::pair<char *, size_t>, MaxBuffers> Buffers;
+
+public:
+  TypeLocBuilderBufferCache() = default;
+  TypeLocBuilderBufferCache(const TypeLocBuilderBufferCache &) = delete;
+  TypeLocBuilderBufferCache &
+  operator=(const TypeLocBuilderBufferCache &) = delete;
+  ~TypeLocBuilderBufferCache();
+
+  /// Removes a buffer of at least \p Size bytes from the cache and returns
+  /// it, storing its capacity in \p Capacity, or returns null.
+  char *take(size_t Size, size_t &Capacity);
+
+  /// Adds a buffer allocated with new[] to the cache, or frees it.
+  void give(char *Buffer, size_t Capacity);
+};
+
 class TypeLocBuilder {
   enum { InlineCapacity = 8 * sizeof(SourceLocation) };
 
@@ -43,16 +70,27 @@ class TypeLocBuilder {
   llvm::AlignedCharArray<BufferMaxAlignment, InlineCapacity> InlineBuffer;
   unsigned NumBytesAtAlign4, NumBytesAtAlign8;
 
+  /// The cache that heap buffers are taken from and returned to, if any.
+  TypeLocBuilderBufferCache *Cache;
+
  public:
   TypeLocBuilder()
     : Buffer(InlineBuffer.buffer), Capacity(InlineCapacity),
-      Index(InlineCapacity), NumBytesAtAlign4(0), NumBytesAtAlign8(0)
+      Index(InlineCapacity), NumBytesAtAlign4(0), NumBytesAtAlign8(0),
+      Cache(nullptr)
+  {
+  }
+
+  explicit TypeLocBuilder(TypeLocBuilderBufferCache &Cache)
+    : Buffer(InlineBuffer.buffer), Capacity(InlineCapacity),
+      Index(InlineCapacity), NumBytesAtAlign4(0), NumBytesAtAlign8(0),
+      Cache(&Cache)
   {
   }
 
   ~TypeLocBuilder() {
     if (Buffer != InlineBuffer.buffer)
-      delete[] Buffer;
+      releaseBuffer(Buffer, Capacity);
   }
 
   /// Ensures that this buffer has at least as much capacity as described.
@@ -132,6 +170,14 @@ private:
   /// Grow to the given capacity.
   void grow(size_t NewCapacity);
 
+  /// Frees a heap buffer, or returns it to the cache.
+  void releaseBuffer(char *OldBuffer, size_t OldCapacity) {
+    if (Cache)
+      Cache->give(OldBuffer, OldCapacity);
+    else
+      delete[] OldBuffer;
+  }
+
   /// \brief Retrieve a temporary TypeLoc that refers into this \c TypeLocBuilder
   /// object.
   ///
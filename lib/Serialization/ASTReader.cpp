@@ -22,6 +22,7 @@
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/AST/ASTMutationListener.h"
 #include "clang/AST/NestedNameSpecifier.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLocVisitor.h"
 #include "clang/Basic/DiagnosticOptions.h"
@@ -51,9 +52,11 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
 #include <algorithm>
 #include <cstdio>
@@ -1010,6 +1013,8 @@ bool ASTReader::ReadLexicalDeclContextStorage(ModuleFile &M,
   // see.
   auto &Lex = LexicalDecls[DC];
   if (!Lex.first) {
+    if (!Record.empty() && decompressTable(M, Blob, Record[0]))
+      return true;
     Lex = std::make_pair(
         &M, llvm::makeArrayRef(
                 reinterpret_cast<const llvm::support::unaligned_uint32_t *>(
@@ -1020,6 +1025,23 @@ bool ASTReader::ReadLexicalDeclContextStorage(ModuleFile &M,
   return false;
 }
 
+bool ASTReader::decompressTable(ModuleFile &F, StringRef &Table,
+                                uint64_t UncompressedSize) {
+  if (!UncompressedSize)
+    return false;
+
+  SmallString<0> Uncompressed;
+  if (llvm::zlib::uncompress(Table, Uncompressed, UncompressedSize) !=
+      llvm::zlib::StatusOK) {
+    Error("could not decompress table in AST file");
+    return true;
+  }
+  F.DecompressedTables.push_back(
+      llvm::MemoryBuffer::getMemBufferCopy(Uncompressed, F.FileName));
+  Table = F.DecompressedTables.back()->getBuffer();
+  return false;
+}
+
 bool ASTReader::ReadVisibleDeclContextStorage(ModuleFile &M,
                                               BitstreamCursor &Cursor,
                                               uint64_t Offset,
@@ -1227,6 +1249,14 @@ bool ASTReader::ReadSLocEntry(int ID) {
         return nullptr;
       }
       return llvm::MemoryBuffer::getMemBufferCopy(Uncompressed, Name);
+    } else if (RecCode == SM_SLOC_BUFFER_BLOB_SHARED) {
+      auto Buffer = llvm::MemoryBuffer::getFile(Blob);
+      if (!Buffer || (*Buffer)->getBufferSize() != Record[0]) {
+        Error(("could not read embedded file contents from '" + Blob + "'")
+                  .str());
+        return nullptr;
+      }
+      return std::move(*Buffer);
     } else if (RecCode == SM_SLOC_BUFFER_BLOB) {
       return llvm::MemoryBuffer::getMemBuffer(Blob.drop_back(1), Name, true);
     } else {
@@ -1709,10 +1739,11 @@ namespace {
     IdentifierInfo *Found;
 
   public:
-    IdentifierLookupVisitor(StringRef Name, unsigned PriorGeneration,
+    IdentifierLookupVisitor(StringRef Name, unsigned NameHash,
+                            unsigned PriorGeneration,
                             unsigned &NumIdentifierLookups,
                             unsigned &NumIdentifierLookupHits)
-      : Name(Name), NameHash(ASTIdentifierLookupTrait::ComputeHash(Name)),
+      : Name(Name), NameHash(NameHash),
         PriorGeneration(PriorGeneration),
         NumIdentifierLookups(NumIdentifierLookups),
         NumIdentifierLookupHits(NumIdentifierLookupHits),
@@ -1760,17 +1791,22 @@ void ASTReader::updateOutOfDateIdentifier(IdentifierInfo &II) {
   if (getContext().getLangOpts().Modules)
     PriorGeneration = IdentifierGeneration[&II];
 
+  // The global index and the identifier tables of the module files use the
+  // same hash function, so hash the name only once.
+  StringRef Name = II.getName();
+  unsigned NameHash = ASTIdentifierLookupTrait::ComputeHash(Name);
+
   // If there is a global index, look there first to determine which modules
   // provably do not have any results for this identifier.
   GlobalModuleIndex::HitSet Hits;
   GlobalModuleIndex::HitSet *HitsPtr = nullptr;
   if (!loadGlobalIndex()) {
-    if (GlobalIndex->lookupIdentifier(II.getName(), Hits)) {
+    if (GlobalIndex->lookupIdentifier(Name, NameHash, Hits)) {
       HitsPtr = &Hits;
     }
   }
 
-  IdentifierLookupVisitor Visitor(II.getName(), PriorGeneration,
+  IdentifierLookupVisitor Visitor(Name, NameHash, PriorGeneration,
                                   NumIdentifierLookups,
                                   NumIdentifierLookupHits);
   ModuleMgr.visit(Visitor, HitsPtr);
@@ -2161,6 +2197,66 @@ ASTReader::ASTReadResult ASTReader::ReadOptionsBlock(
   }
 }
 
+/// \brief Whether the PCH validation cache records \p MF as validated during
+/// the current build session.
+///
+/// Each line of the cache names one PCH file validated during a session:
+/// the session timestamp, the hash of its input files, the size and
+/// modification time of the PCH file itself, and its name.
+static bool wasValidatedInBuildSession(const ModuleFile &MF,
+                                       const HeaderSearchOptions &HSOpts) {
+  if (HSOpts.PCHValidationCachePath.empty() || !HSOpts.BuildSessionTimestamp ||
+      !MF.InputFilesHash || !MF.File)
+    return false;
+
+  auto Buffer = llvm::MemoryBuffer::getFile(HSOpts.PCHValidationCachePath);
+  if (!Buffer)
+    return false;
+
+  SmallVector<StringRef, 16> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  for (StringRef Line : Lines) {
+    StringRef Fields[4];
+    for (StringRef &Field : Fields)
+      std::tie(Field, Line) = Line.split(' ');
+    uint64_t Session, Hash, Size, ModTime;
+    if (Fields[0].getAsInteger(10, Session) ||
+        Fields[1].getAsInteger(16, Hash) || Fields[2].getAsInteger(10, Size) ||
+        Fields[3].getAsInteger(10, ModTime))
+      continue;
+    if (Session == HSOpts.BuildSessionTimestamp && Hash == MF.InputFilesHash &&
+        Size == (uint64_t)MF.File->getSize() &&
+        ModTime == (uint64_t)MF.File->getModificationTime() &&
+        Line == MF.FileName)
+      return true;
+  }
+  return false;
+}
+
+/// \brief Add \p MF to the PCH validation cache of the current build session.
+static void recordValidationInBuildSession(const ModuleFile &MF,
+                                           const HeaderSearchOptions &HSOpts) {
+  std::string Entry;
+  llvm::raw_string_ostream EntryOS(Entry);
+  EntryOS << HSOpts.BuildSessionTimestamp << ' '
+          << llvm::format_hex_no_prefix(MF.InputFilesHash, 1) << ' '
+          << MF.File->getSize() << ' '
+          << (uint64_t)MF.File->getModificationTime() << ' ' << MF.FileName
+          << '\n';
+  EntryOS.flush();
+
+  // Append the whole line with a single write so that compilations finishing
+  // at the same time don't interleave their entries.
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(HSOpts.PCHValidationCachePath, EC,
+                          llvm::sys::fs::F_Append | llvm::sys::fs::F_Text);
+  if (EC)
+    return;
+  OS.SetUnbuffered();
+  OS << Entry;
+}
+
 ASTReader::ASTReadResult
 ASTReader::ReadControlBlock(ModuleFile &F,
                             SmallVectorImpl<ImportedModule> &Loaded,
@@ -2193,7 +2289,14 @@ ASTReader::ReadControlBlock(ModuleFile &F,
       // All user input files reside at the index range [0, NumUserInputs), and
       // system input files reside at [NumUserInputs, NumInputs). For explicitly
       // loaded module files, ignore missing inputs.
-      if (!DisableValidation && F.Kind != MK_ExplicitModule) {
+      if (!DisableValidation && F.Kind == MK_PCH &&
+          wasValidatedInBuildSession(F, HSOpts)) {
+        // Another compilation of this build session already validated the
+        // same inputs; any of them that are used are still checked when
+        // they are loaded.
+        F.InputFilesValidationTimestamp = HSOpts.BuildSessionTimestamp;
+        ++NumPCHValidationsSkipped;
+      } else if (!DisableValidation && F.Kind != MK_ExplicitModule) {
         bool Complain = (ClientLoadCapabilities & ARR_OutOfDate) == 0;
 
         // If we are reading a module, we will create a verification timestamp,
@@ -2443,6 +2546,10 @@ ASTReader::ReadControlBlock(ModuleFile &F,
           (const llvm::support::unaligned_uint64_t *)Blob.data();
       F.InputFilesLoaded.resize(NumInputs);
       break;
+
+    case INPUT_FILES_HASH:
+      F.InputFilesHash = Record[0];
+      break;
     }
   }
 }
@@ -2571,6 +2678,8 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
         Error("duplicate TYPE_OFFSET record in AST file");
         return Failure;
       }
+      if (Record.size() > 2 && decompressTable(F, Blob, Record[2]))
+        return Failure;
       F.TypeOffsets = (const uint32_t *)Blob.data();
       F.LocalNumTypes = Record[0];
       unsigned LocalBaseTypeIndex = Record[1];
@@ -2595,6 +2704,8 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
         Error("duplicate DECL_OFFSET record in AST file");
         return Failure;
       }
+      if (Record.size() > 2 && decompressTable(F, Blob, Record[2]))
+        return Failure;
       F.DeclOffsets = (const DeclOffset *)Blob.data();
       F.LocalNumDecls = Record[0];
       unsigned LocalBaseDeclID = Record[1];
@@ -2695,6 +2806,14 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
         EagerlyDeserializedDecls.push_back(getGlobalDeclID(F, Record[I]));
       break;
 
+    case MODULAR_CODEGEN_DECLS:
+      // The definitions are only emitted when building the object file of
+      // the module, from the module file itself.
+      if (F.Kind == MK_MainFile)
+        for (unsigned I = 0, N = Record.size(); I != N; ++I)
+          EagerlyDeserializedDecls.push_back(getGlobalDeclID(F, Record[I]));
+      break;
+
     case SPECIAL_TYPES:
       if (SpecialTypes.empty()) {
         for (unsigned I = 0, N = Record.size(); I != N; ++I)
@@ -2937,6 +3056,14 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       break;
     }
 
+    case COALESCED_MACRO_ARG_EXPANSIONS:
+      if (Record.size() % 3 != 0) {
+        Error("invalid COALESCED_MACRO_ARG_EXPANSIONS record in AST file");
+        return Failure;
+      }
+      F.CoalescedMacroArgExpansions.swap(Record);
+      break;
+
     case EXT_VECTOR_DECLS:
       for (unsigned I = 0, N = Record.size(); I != N; ++I)
         ExtVectorDecls.push_back(getGlobalDeclID(F, Record[I]));
@@ -3052,6 +3179,15 @@ ASTReader::ReadASTBlock(ModuleFile &F, unsigned ClientLoadCapabilities) {
       F.ObjCCategories.swap(Record);
       break;
 
+    case RECORD_LAYOUTS:
+      // Each layout is preceded by the ID of its record and its length.
+      F.RecordLayouts.swap(Record);
+      for (unsigned I = 0, N = F.RecordLayouts.size(); I + 1 < N;
+           I += 2 + F.RecordLayouts[I + 1])
+        PendingRecordLayouts[getGlobalDeclID(F, F.RecordLayouts[I])] =
+            std::make_pair(&F, I + 2);
+      break;
+
     case DIAG_PRAGMA_MAPPINGS:
       if (F.PragmaDiagMappings.empty())
         F.PragmaDiagMappings.swap(Record);
@@ -3550,6 +3686,21 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
       SourceMgr.getLoadedSLocEntryByID(Index);
     }
 
+    // Register the macro argument expansions coalesced into its entries.
+    if (!F.CoalescedMacroArgExpansions.empty()) {
+      SmallVector<SourceManager::CoalescedMacroArgExpansion, 16> Args;
+      for (unsigned I = 0, N = F.CoalescedMacroArgExpansions.size(); I != N;
+           I += 3) {
+        SourceManager::CoalescedMacroArgExpansion Arg = {
+            ReadSourceLocation(F, F.CoalescedMacroArgExpansions[I]).getOffset(),
+            ReadSourceLocation(F, F.CoalescedMacroArgExpansions[I + 1])
+                .getOffset(),
+            ReadSourceLocation(F, F.CoalescedMacroArgExpansions[I + 2])};
+        Args.push_back(Arg);
+      }
+      SourceMgr.addLoadedCoalescedMacroArgExpansions(Args);
+    }
+
     // Preload all the pending interesting identifiers by marking them out of
     // date.
     for (auto Offset : F.PreloadIdentifierOffsets) {
@@ -3591,6 +3742,9 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
       F.ImportLoc = TranslateSourceLocation(*M->ImportedBy, M->ImportLoc);
   }
 
+  // Start decoding the declarations that will be needed first.
+  prefetchDeclRecords(Loaded);
+
   if (!Context.getLangOpts().CPlusPlus ||
       (Type != MK_ImplicitModule && Type != MK_ExplicitModule)) {
     // Mark all of the identifiers in the identifier table as being out of date,
@@ -3690,6 +3844,20 @@ ASTReader::ASTReadResult ASTReader::ReadAST(StringRef FileName,
     }
   }
 
+  const HeaderSearchOptions &HSOpts =
+      PP.getHeaderSearchInfo().getHeaderSearchOpts();
+  if (!HSOpts.PCHValidationCachePath.empty() && HSOpts.BuildSessionTimestamp &&
+      !DisableValidation) {
+    // Let the other compilations of this build session skip validating the
+    // PCH files whose input files we just checked.
+    for (unsigned I = 0, N = Loaded.size(); I != N; ++I) {
+      ModuleFile &F = *Loaded[I].Mod;
+      if (F.Kind == MK_PCH && F.InputFilesHash && F.File &&
+          F.InputFilesValidationTimestamp < HSOpts.BuildSessionTimestamp)
+        recordValidationInBuildSession(F, HSOpts);
+    }
+  }
+
   return Success;
 }
 
@@ -4100,7 +4268,8 @@ std::string ASTReader::getOriginalSourceFile(
     const std::string &ASTFileName, FileManager &FileMgr,
     const PCHContainerReader &PCHContainerRdr, DiagnosticsEngine &Diags) {
   // Open the AST file.
-  auto Buffer = FileMgr.getBufferForFile(ASTFileName);
+  auto Buffer = FileMgr.getBufferForFile(ASTFileName,
+                                         /*RequiresNullTerminator=*/false);
   if (!Buffer) {
     Diags.Report(diag::err_fe_unable_to_read_pch_file)
         << ASTFileName << Buffer.getError().message();
@@ -4199,7 +4368,8 @@ bool ASTReader::readASTFileControlBlock(
   // Open the AST file.
   // FIXME: This allows use of the VFS; we do not allow use of the
   // VFS when actually loading a module.
-  auto Buffer = FileMgr.getBufferForFile(Filename);
+  auto Buffer = FileMgr.getBufferForFile(Filename,
+                                         /*RequiresNullTerminator=*/false);
   if (!Buffer) {
     return true;
   }
@@ -5178,6 +5348,7 @@ void ASTReader::ReadPragmaDiagnosticMappings(DiagnosticsEngine &Diag) {
       }
     }
   }
+  Diag.forgetIgnoredEverywhere();
 }
 
 /// \brief Get the correct cursor and offset for loading a type.
@@ -6748,6 +6919,71 @@ void ASTReader::StartTranslationUnit(ASTConsumer *Consumer) {
     DeserializationListener->ReaderInitialized(this);
 }
 
+const ASTRecordLayout *
+ASTReader::getExternalRecordLayout(const RecordDecl *Record) {
+  auto Pos = PendingRecordLayouts.find(Record->getGlobalID());
+  if (Pos == PendingRecordLayouts.end())
+    return nullptr;
+  ModuleFile &F = *Pos->second.first;
+  unsigned Idx = Pos->second.second;
+  PendingRecordLayouts.erase(Pos);
+
+  ArrayRef<uint64_t> Data = F.RecordLayouts;
+  auto ReadCharUnits = [&] {
+    return CharUnits::fromQuantity(static_cast<int64_t>(Data[Idx++]));
+  };
+  // The layout refers to the definitions of the bases, which may have been
+  // merged into definitions from other modules.
+  auto ReadBase = [&]() -> const CXXRecordDecl * {
+    auto *Base = GetLocalDeclAs<CXXRecordDecl>(F, Data[Idx++]);
+    return Base ? Base->getDefinition() : nullptr;
+  };
+
+  CharUnits Size = ReadCharUnits();
+  CharUnits DataSize = ReadCharUnits();
+  CharUnits Alignment = ReadCharUnits();
+  CharUnits RequiredAlignment = ReadCharUnits();
+  unsigned NumFields = Data[Idx++];
+  ArrayRef<uint64_t> FieldOffsets(Data.data() + Idx, NumFields);
+  Idx += NumFields;
+
+  if (!Data[Idx++])
+    return new (Context) ASTRecordLayout(Context, Size, Alignment,
+                                         RequiredAlignment, DataSize,
+                                         FieldOffsets);
+
+  CharUnits NonVirtualSize = ReadCharUnits();
+  CharUnits NonVirtualAlignment = ReadCharUnits();
+  CharUnits SizeOfLargestEmptySubobject = ReadCharUnits();
+  const CXXRecordDecl *PrimaryBase = ReadBase();
+  bool IsPrimaryBaseVirtual = Data[Idx++];
+  bool HasOwnVFPtr = Data[Idx++];
+  bool HasExtendableVFPtr = Data[Idx++];
+  CharUnits VBPtrOffset = ReadCharUnits();
+  const CXXRecordDecl *BaseSharingVBPtr = ReadBase();
+  bool EndsWithZeroSizedObject = Data[Idx++];
+  bool LeadsWithZeroSizedBase = Data[Idx++];
+
+  ASTRecordLayout::BaseOffsetsMapTy BaseOffsets;
+  for (unsigned I = 0, N = Data[Idx++]; I != N; ++I) {
+    const CXXRecordDecl *Base = ReadBase();
+    BaseOffsets[Base] = ReadCharUnits();
+  }
+  ASTRecordLayout::VBaseOffsetsMapTy VBaseOffsets;
+  for (unsigned I = 0, N = Data[Idx++]; I != N; ++I) {
+    const CXXRecordDecl *Base = ReadBase();
+    CharUnits Offset = ReadCharUnits();
+    VBaseOffsets[Base] = ASTRecordLayout::VBaseInfo(Offset, Data[Idx++]);
+  }
+
+  return new (Context) ASTRecordLayout(
+      Context, Size, Alignment, RequiredAlignment, HasOwnVFPtr,
+      HasExtendableVFPtr, VBPtrOffset, DataSize, FieldOffsets, NonVirtualSize,
+      NonVirtualAlignment, SizeOfLargestEmptySubobject, PrimaryBase,
+      IsPrimaryBaseVirtual, BaseSharingVBPtr, EndsWithZeroSizedObject,
+      LeadsWithZeroSizedBase, BaseOffsets, VBaseOffsets);
+}
+
 void ASTReader::PrintStats() {
   std::fprintf(stderr, "*** AST File Statistics:\n");
 
@@ -6794,6 +7030,24 @@ void ASTReader::PrintStats() {
     std::fprintf(stderr, "  %u/%u selectors read (%f%%)\n",
                  NumSelectorsLoaded, (unsigned)SelectorsLoaded.size(),
                  ((float)NumSelectorsLoaded/SelectorsLoaded.size() * 100));
+  if (NumDeclRecordsPrefetched)
+    std::fprintf(stderr, "  %u/%u prefetched declaration records used (%f%%)\n",
+                 NumPrefetchedDeclRecordsUsed, NumDeclRecordsPrefetched,
+                 ((float)NumPrefetchedDeclRecordsUsed/NumDeclRecordsPrefetched
+                  * 100));
+  if (unsigned NumFiles =
+          ModuleMgr.getNumMappedFiles() + ModuleMgr.getNumCopiedFiles())
+    std::fprintf(stderr, "  %u/%u AST files mapped without copying, "
+                         "%llu bytes copied\n",
+                 ModuleMgr.getNumMappedFiles(), NumFiles,
+                 (unsigned long long)ModuleMgr.getNumCopiedFileBytes());
+  if (NumPCHValidationsSkipped)
+    std::fprintf(stderr, "  %u PCH files not revalidated during this build "
+                         "session\n",
+                 NumPCHValidationsSkipped);
+  if (ModuleMgr.getNumSharedCacheFiles())
+    std::fprintf(stderr, "  %u AST files reused from the shared module cache\n",
+                 ModuleMgr.getNumSharedCacheFiles());
   if (TotalNumStatements)
     std::fprintf(stderr, "  %u/%u statements read (%f%%)\n",
                  NumStatementsRead, TotalNumStatements,
@@ -6829,6 +7083,9 @@ void ASTReader::PrintStats() {
                  ((float)NumMethodPoolTableHits/NumMethodPoolTableLookups
                   * 100.0));
   }
+  if (NumMethodPoolDuplicates)
+    std::fprintf(stderr, "  %u duplicate method pool entries skipped\n",
+                 NumMethodPoolDuplicates);
 
   if (NumIdentifierLookupHits) {
     std::fprintf(stderr,
@@ -6837,6 +7094,20 @@ void ASTReader::PrintStats() {
                  (double)NumIdentifierLookupHits*100.0/NumIdentifierLookups);
   }
 
+  unsigned NumLookupTableProbes = 0, NumLookupTableProbesSkipped = 0;
+  for (const auto &Lookup : Lookups) {
+    NumLookupTableProbes += Lookup.second.Table.getNumTableProbes();
+    NumLookupTableProbesSkipped +=
+        Lookup.second.Table.getNumTableProbesSkipped();
+  }
+  if (unsigned Total = NumLookupTableProbes + NumLookupTableProbesSkipped) {
+    std::fprintf(stderr,
+                 "  %u / %u name lookup table probes skipped by their "
+                 "filters (%f%%)\n",
+                 NumLookupTableProbesSkipped, Total,
+                 (double)NumLookupTableProbesSkipped * 100.0 / Total);
+  }
+
   if (GlobalIndex) {
     std::fprintf(stderr, "\n");
     GlobalIndex->printStats();
@@ -6967,7 +7238,8 @@ IdentifierInfo *ASTReader::get(StringRef Name) {
   // Note that we are loading an identifier.
   Deserializing AnIdentifier(this);
 
-  IdentifierLookupVisitor Visitor(Name, /*PriorGeneration=*/0,
+  unsigned NameHash = ASTIdentifierLookupTrait::ComputeHash(Name);
+  IdentifierLookupVisitor Visitor(Name, NameHash, /*PriorGeneration=*/0,
                                   NumIdentifierLookups,
                                   NumIdentifierLookupHits);
 
@@ -6985,7 +7257,7 @@ IdentifierInfo *ASTReader::get(StringRef Name) {
     GlobalModuleIndex::HitSet Hits;
     GlobalModuleIndex::HitSet *HitsPtr = nullptr;
     if (!loadGlobalIndex()) {
-      if (GlobalIndex->lookupIdentifier(Name, Hits)) {
+      if (GlobalIndex->lookupIdentifier(Name, NameHash, Hits)) {
         HitsPtr = &Hits;
       }
     }
@@ -7170,11 +7442,28 @@ namespace clang { namespace serialization {
 } } // end namespace clang::serialization
 
 /// \brief Add the given set of methods to the method list.
-static void addMethodsToPool(Sema &S, ArrayRef<ObjCMethodDecl *> Methods,
-                             ObjCMethodList &List) {
-  for (unsigned I = 0, N = Methods.size(); I != N; ++I) {
-    S.addMethodToGlobalList(&List, Methods[I]);
+///
+/// A module's method pool also contains the methods it looked up from its
+/// own imports, so the same declaration (e.g. -init from a system framework)
+/// comes back once per importing module. Skip the declarations the list
+/// already has instead of matching each of them against the whole list.
+///
+/// \returns the number of duplicate declarations skipped.
+static unsigned addMethodsToPool(Sema &S, ArrayRef<ObjCMethodDecl *> Methods,
+                                 ObjCMethodList &List) {
+  llvm::SmallPtrSet<ObjCMethodDecl *, 16> Seen;
+  for (ObjCMethodList *M = &List; M; M = M->getNext())
+    if (M->getMethod())
+      Seen.insert(M->getMethod());
+
+  unsigned NumDuplicates = 0;
+  for (ObjCMethodDecl *Method : Methods) {
+    if (Seen.insert(Method).second)
+      S.addMethodToGlobalList(&List, Method);
+    else
+      ++NumDuplicates;
   }
+  return NumDuplicates;
 }
                              
 void ASTReader::ReadMethodPool(Selector Sel) {
@@ -7210,8 +7499,10 @@ void ASTReader::ReadMethodPool(Selector Sel) {
   // Add methods to the global pool *after* setting hasMoreThanOneDecl, since
   // when building a module we keep every method individually and may need to
   // update hasMoreThanOneDecl as we add the methods.
-  addMethodsToPool(S, Visitor.getInstanceMethods(), Pos->second.first);
-  addMethodsToPool(S, Visitor.getFactoryMethods(), Pos->second.second);
+  NumMethodPoolDuplicates +=
+      addMethodsToPool(S, Visitor.getInstanceMethods(), Pos->second.first);
+  NumMethodPoolDuplicates +=
+      addMethodsToPool(S, Visitor.getFactoryMethods(), Pos->second.second);
 }
 
 void ASTReader::updateOutOfDateSelector(Selector Sel) {
@@ -7622,6 +7913,21 @@ ASTReader::getSourceDescriptor(unsigned ID) {
   return None;
 }
 
+ExternalASTSource::ExtKind ASTReader::hasExternalDefinitions(const Decl *D) {
+  auto I = DefinitionSource.find(D);
+  if (I == DefinitionSource.end()) {
+    // Look for the definition among the redeclarations of a function.
+    const FunctionDecl *Definition;
+    const auto *FD = dyn_cast<FunctionDecl>(D);
+    if (!FD || !FD->isDefined(Definition) || Definition == FD)
+      return EK_ReplyHazy;
+    I = DefinitionSource.find(Definition);
+    if (I == DefinitionSource.end())
+      return EK_ReplyHazy;
+  }
+  return I->second ? EK_Never : EK_Always;
+}
+
 Selector ASTReader::getLocalSelector(ModuleFile &M, unsigned LocalID) {
   return DecodeSelector(getGlobalSelectorID(M, LocalID));
 }
@@ -8713,10 +9019,15 @@ ASTReader::ASTReader(
       NumIdentifierLookupHits(0), NumSelectorsRead(0),
       NumMethodPoolEntriesRead(0), NumMethodPoolLookups(0),
       NumMethodPoolHits(0), NumMethodPoolTableLookups(0),
-      NumMethodPoolTableHits(0), TotalNumMethodPoolEntries(0),
+      NumMethodPoolTableHits(0), NumMethodPoolDuplicates(0),
+      TotalNumMethodPoolEntries(0),
       NumLexicalDeclContextsRead(0), TotalLexicalDeclContexts(0),
       NumVisibleDeclContextsRead(0), TotalVisibleDeclContexts(0),
-      TotalModulesSizeInBits(0), NumCurrentElementsDeserializing(0),
+      TotalModulesSizeInBits(0),
+      DeclPrefetchThreads(PP.getPreprocessorOpts().DeclPrefetchThreads),
+      NumDeclRecordsPrefetched(0), NumPrefetchedDeclRecordsUsed(0),
+      NumPCHValidationsSkipped(0),
+      NumCurrentElementsDeserializing(0),
       PassingDeclsToConsumer(false), ReadingKind(Read_None) {
   SourceMgr.setExternalSLocEntrySource(this);
 
@@ -24,7 +24,10 @@
 #include "clang/AST/Expr.h"
 #include "clang/Sema/IdentifierResolver.h"
 #include "clang/Sema/SemaDiagnostic.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallPtrSet.h"
 #include "llvm/Support/SaveAndRestore.h"
+#include "llvm/Support/ThreadPool.h"
 
 using namespace clang;
 using namespace clang::serialization;
@@ -57,6 +60,10 @@ namespace clang {
 
     uint64_t GetCurrentCursorOffset();
 
+    /// \brief Reads what precedes the body of the definition \p FD, and
+    /// remembers where the body is.
+    void ReadFunctionDefinition(FunctionDecl *FD);
+
     uint64_t ReadLocalOffset(const RecordData &R, unsigned &I) {
       uint64_t LocalOffset = R[I++];
       assert(LocalOffset < Offset && "offset point after current record");
@@ -484,16 +491,21 @@ void ASTDeclReader::Visit(Decl *D) {
     // We only read it if FD doesn't already have a body (e.g., from another
     // module).
     // FIXME: Can we diagnose ODR violations somehow?
-    if (Record[Idx++]) {
-      if (auto *CD = dyn_cast<CXXConstructorDecl>(FD)) {
-        CD->NumCtorInitializers = Record[Idx++];
-        if (CD->NumCtorInitializers)
-          CD->CtorInitializers = ReadGlobalOffset(F, Record, Idx);
-      }
-      Reader.PendingBodies[FD] = GetCurrentCursorOffset();
-      HasPendingBody = true;
-    }
+    if (Record[Idx++])
+      ReadFunctionDefinition(FD);
+  }
+}
+
+void ASTDeclReader::ReadFunctionDefinition(FunctionDecl *FD) {
+  if (Record[Idx++])
+    Reader.DefinitionSource[FD] = F.Kind == MK_MainFile;
+  if (auto *CD = dyn_cast<CXXConstructorDecl>(FD)) {
+    CD->NumCtorInitializers = Record[Idx++];
+    if (CD->NumCtorInitializers)
+      CD->CtorInitializers = ReadGlobalOffset(F, Record, Idx);
   }
+  Reader.PendingBodies[FD] = GetCurrentCursorOffset();
+  HasPendingBody = true;
 }
 
 void ASTDeclReader::VisitDecl(Decl *D) {
@@ -1481,9 +1493,11 @@ void ASTDeclReader::ReadCXXDefinitionData(
   Data.HasUninitializedFields = Record[Idx++];
   Data.HasInheritedConstructor = Record[Idx++];
   Data.HasInheritedAssignment = Record[Idx++];
+  Data.NeedOverloadResolutionForCopyConstructor = Record[Idx++];
   Data.NeedOverloadResolutionForMoveConstructor = Record[Idx++];
   Data.NeedOverloadResolutionForMoveAssignment = Record[Idx++];
   Data.NeedOverloadResolutionForDestructor = Record[Idx++];
+  Data.DefaultedCopyConstructorIsDeleted = Record[Idx++];
   Data.DefaultedMoveConstructorIsDeleted = Record[Idx++];
   Data.DefaultedMoveAssignmentIsDeleted = Record[Idx++];
   Data.DefaultedDestructorIsDeleted = Record[Idx++];
@@ -1514,6 +1528,8 @@ void ASTDeclReader::ReadCXXDefinitionData(
   Reader.ReadUnresolvedSet(F, Data.VisibleConversions, Record, Idx);
   assert(Data.Definition && "Data.Definition should be already set!");
   Data.FirstFriend = ReadDeclID(Record, Idx);
+  if (uint64_t ODRHash = Record[Idx++])
+    Reader.DefinitionODRHashes[Data.Definition] = ODRHash;
 
   if (Data.IsLambda) {
     typedef LambdaCapture Capture;
@@ -1561,6 +1577,14 @@ void ASTDeclReader::MergeDefinitionData(
     // Track that we merged the definitions.
     Reader.MergedDeclContexts.insert(std::make_pair(MergeDD.Definition,
                                                     DD.Definition));
+
+    // Definitions whose modules computed the same hash declare the same
+    // members, so there's no need to look for each member of the merged
+    // definition in the canonical one.
+    uint64_t ODRHash = Reader.DefinitionODRHashes.lookup(DD.Definition);
+    if (ODRHash && ODRHash == Reader.DefinitionODRHashes.lookup(
+                                  MergeDD.Definition))
+      Reader.ODRHashMatchedDefinitions.insert(MergeDD.Definition);
     Reader.PendingDefinitions.erase(MergeDD.Definition);
     MergeDD.Definition->IsCompleteDefinition = false;
     mergeDefinitionVisibility(DD.Definition, MergeDD.Definition);
@@ -1610,9 +1634,11 @@ void ASTDeclReader::MergeDefinitionData(
   MATCH_FIELD(HasUninitializedFields)
   MATCH_FIELD(HasInheritedConstructor)
   MATCH_FIELD(HasInheritedAssignment)
+  MATCH_FIELD(NeedOverloadResolutionForCopyConstructor)
   MATCH_FIELD(NeedOverloadResolutionForMoveConstructor)
   MATCH_FIELD(NeedOverloadResolutionForMoveAssignment)
   MATCH_FIELD(NeedOverloadResolutionForDestructor)
+  MATCH_FIELD(DefaultedCopyConstructorIsDeleted)
   MATCH_FIELD(DefaultedMoveConstructorIsDeleted)
   MATCH_FIELD(DefaultedMoveAssignmentIsDeleted)
   MATCH_FIELD(DefaultedDestructorIsDeleted)
@@ -3000,7 +3026,8 @@ ASTDeclReader::FindExistingResult ASTDeclReader::findExisting(NamedDecl *D) {
   // same template specialization into the same CXXRecordDecl.
   auto MergedDCIt = Reader.MergedDeclContexts.find(D->getLexicalDeclContext());
   if (MergedDCIt != Reader.MergedDeclContexts.end() &&
-      MergedDCIt->second == D->getDeclContext())
+      MergedDCIt->second == D->getDeclContext() &&
+      !Reader.ODRHashMatchedDefinitions.count(MergedDCIt->first))
     Reader.PendingOdrMergeChecks.push_back(D);
 
   return FindExistingResult(Reader, D, /*Existing=*/nullptr,
@@ -3199,6 +3226,92 @@ void ASTReader::markIncompleteDeclChain(Decl *D) {
   }
 }
 
+/// \brief The most declaration records decoded ahead of use for one load of
+/// AST files.
+static const size_t MaxPrefetchedDeclRecords = 1024;
+
+/// \brief Start decoding the records of the eagerly-deserialized declarations
+/// of the newly loaded AST files, then of their top-level declarations, on
+/// worker threads, up to MaxPrefetchedDeclRecords of them.
+///
+/// Building the declarations touches the ASTContext and Sema, so that still
+/// happens on demand on the main thread. The main thread goes on with the
+/// load and the parse while the workers decode, and ReadDeclRecord() then
+/// only waits for the worker of the record it needs. Records still unused
+/// when the next AST file is loaded are dropped.
+void ASTReader::prefetchDeclRecords(ArrayRef<ImportedModule> Loaded) {
+  if (!DeclPrefetchThreads)
+    return;
+
+  // Finish the previous batch before its cursors go away.
+  for (DeclPrefetchTask &Task : DeclPrefetchTasks)
+    Task.Done.wait();
+  DeclPrefetchTasks.clear();
+  PrefetchedDeclRecords.clear();
+
+  llvm::SmallPtrSet<ModuleFile *, 4> LoadedSet;
+  for (const ImportedModule &IM : Loaded)
+    LoadedSet.insert(IM.Mod);
+
+  std::vector<RecordLocation> Locations;
+  llvm::DenseSet<DeclID> Seen;
+  auto AddDecl = [&](DeclID ID) {
+    if (Locations.size() == MaxPrefetchedDeclRecords ||
+        ID < NUM_PREDEF_DECL_IDS || DeclsLoaded[ID - NUM_PREDEF_DECL_IDS] ||
+        !Seen.insert(ID).second)
+      return;
+    GlobalDeclMapType::iterator I = GlobalDeclMap.find(ID);
+    if (I == GlobalDeclMap.end() || !LoadedSet.count(I->second))
+      return;
+    ModuleFile *M = I->second;
+    Locations.push_back(RecordLocation(
+        M, M->DeclOffsets[ID - M->BaseDeclID - NUM_PREDEF_DECL_IDS].BitOffset));
+  };
+  for (DeclID ID : EagerlyDeserializedDecls)
+    AddDecl(ID);
+  for (const auto &Lexical : TULexicalDecls)
+    if (LoadedSet.count(Lexical.first))
+      for (unsigned I = 1, N = Lexical.second.size(); I < N; I += 2)
+        AddDecl(getGlobalDeclID(*Lexical.first, +Lexical.second[I]));
+  if (Locations.empty())
+    return;
+
+  // Each worker gets its share of the records and its own copies of the
+  // cursors, made here so that the main thread can keep using the originals.
+  unsigned Threads = std::min<size_t>(DeclPrefetchThreads, Locations.size());
+  DeclPrefetchTasks.resize(Threads);
+  for (size_t I = 0, N = Locations.size(); I != N; ++I) {
+    const RecordLocation &Loc = Locations[I];
+    unsigned T = I % Threads;
+    DeclPrefetchTask &Task = DeclPrefetchTasks[T];
+    if (!Task.Cursors.count(Loc.F))
+      Task.Cursors.insert(std::make_pair(Loc.F, Loc.F->DeclsCursor));
+    PrefetchedDeclRecords[std::make_pair(Loc.F, Loc.Offset)] =
+        std::make_pair(T, Task.Records.size());
+    PrefetchedDeclRecord Record;
+    Record.F = Loc.F;
+    Record.Offset = Loc.Offset;
+    Task.Records.push_back(std::move(Record));
+  }
+  NumDeclRecordsPrefetched += Locations.size();
+
+  if (!DeclPrefetchPool)
+    DeclPrefetchPool.reset(new llvm::ThreadPool(DeclPrefetchThreads));
+  for (DeclPrefetchTask &Task : DeclPrefetchTasks)
+    Task.Done = DeclPrefetchPool->async([&Task] {
+      RecordData Record;
+      for (PrefetchedDeclRecord &Prefetched : Task.Records) {
+        llvm::BitstreamCursor &Cursor = Task.Cursors.find(Prefetched.F)->second;
+        Cursor.JumpToBit(Prefetched.Offset);
+        unsigned Code = Cursor.ReadCode();
+        Record.clear();
+        Prefetched.Code = Cursor.readRecord(Code, Record);
+        Prefetched.EndBitOffset = Cursor.GetCurrentBitNo();
+        Prefetched.Record.assign(Record.begin(), Record.end());
+      }
+    });
+}
+
 /// \brief Read the declaration at the given offset from the AST file.
 Decl *ASTReader::ReadDeclRecord(DeclID ID) {
   unsigned Index = ID - NUM_PREDEF_DECL_IDS;
@@ -3214,14 +3327,31 @@ Decl *ASTReader::ReadDeclRecord(DeclID ID) {
   // Note that we are loading a declaration record.
   Deserializing ADecl(this);
 
-  DeclsCursor.JumpToBit(Loc.Offset);
   RecordData Record;
-  unsigned Code = DeclsCursor.ReadCode();
+  unsigned RecCode;
+  auto Slot = PrefetchedDeclRecords.find(std::make_pair(Loc.F, Loc.Offset));
+  if (Slot != PrefetchedDeclRecords.end()) {
+    DeclPrefetchTask &Task = DeclPrefetchTasks[Slot->second.first];
+    Task.Done.wait();
+    PrefetchedDeclRecord &Prefetched = Task.Records[Slot->second.second];
+    // Leave the cursor where reading the record would have, since any
+    // statements of the declaration follow it.
+    RecCode = Prefetched.Code;
+    Record.append(Prefetched.Record.begin(), Prefetched.Record.end());
+    DeclsCursor.JumpToBit(Prefetched.EndBitOffset);
+    std::vector<uint64_t>().swap(Prefetched.Record);
+    PrefetchedDeclRecords.erase(Slot);
+    ++NumPrefetchedDeclRecordsUsed;
+  } else {
+    DeclsCursor.JumpToBit(Loc.Offset);
+    unsigned Code = DeclsCursor.ReadCode();
+    RecCode = DeclsCursor.readRecord(Code, Record);
+  }
   unsigned Idx = 0;
   ASTDeclReader Reader(*this, Loc, ID, DeclLoc, Record,Idx);
 
   Decl *D = nullptr;
-  switch ((DeclCode)DeclsCursor.readRecord(Code, Record)) {
+  switch ((DeclCode)RecCode) {
   case DECL_CONTEXT_LEXICAL:
   case DECL_CONTEXT_VISIBLE:
     llvm_unreachable("Record cannot be de-serialized with ReadDeclRecord");
@@ -3787,14 +3917,8 @@ void ASTDeclReader::UpdateDecl(Decl *D, ModuleFile &ModuleFile,
         });
       }
       FD->setInnerLocStart(Reader.ReadSourceLocation(ModuleFile, Record, Idx));
-      if (auto *CD = dyn_cast<CXXConstructorDecl>(FD)) {
-        CD->NumCtorInitializers = Record[Idx++];
-        if (CD->NumCtorInitializers)
-          CD->CtorInitializers = ReadGlobalOffset(F, Record, Idx);
-      }
       // Store the offset of the body so we can lazily load it later.
-      Reader.PendingBodies[FD] = GetCurrentCursorOffset();
-      HasPendingBody = true;
+      ReadFunctionDefinition(FD);
       assert(Idx == Record.size() && "lazy body must be last");
       break;
     }
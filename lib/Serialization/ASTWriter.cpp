@@ -24,6 +24,7 @@
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
+#include "clang/AST/RecordLayout.h"
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLocVisitor.h"
 #include "clang/Basic/DiagnosticOptions.h"
@@ -53,10 +54,12 @@
 #include "llvm/Support/Compression.h"
 #include "llvm/Support/EndianStream.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
 #include "llvm/Support/Process.h"
+#include "llvm/Support/ThreadPool.h"
 #include <algorithm>
 #include <cstdio>
 #include <string.h>
@@ -922,6 +925,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(ORIGINAL_PCH_DIR);
   RECORD(ORIGINAL_FILE_ID);
   RECORD(INPUT_FILE_OFFSETS);
+  RECORD(INPUT_FILES_HASH);
 
   BLOCK(OPTIONS_BLOCK);
   RECORD(LANGUAGE_OPTIONS);
@@ -983,6 +987,8 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(POINTERS_TO_MEMBERS_PRAGMA_OPTIONS);
   RECORD(UNUSED_LOCAL_TYPEDEF_NAME_CANDIDATES);
   RECORD(DELETE_EXPRS_TO_ANALYZE);
+  RECORD(MODULAR_CODEGEN_DECLS);
+  RECORD(COALESCED_MACRO_ARG_EXPANSIONS);
 
   // SourceManager Block.
   BLOCK(SOURCE_MANAGER_BLOCK);
@@ -990,6 +996,7 @@ void ASTWriter::WriteBlockInfoBlock() {
   RECORD(SM_SLOC_BUFFER_ENTRY);
   RECORD(SM_SLOC_BUFFER_BLOB);
   RECORD(SM_SLOC_BUFFER_BLOB_COMPRESSED);
+  RECORD(SM_SLOC_BUFFER_BLOB_SHARED);
   RECORD(SM_SLOC_EXPANSION_ENTRY);
 
   // Preprocessor Block.
@@ -1589,6 +1596,7 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
   unsigned UserFilesNum = 0;
   // Write out all of the input files.
   std::vector<uint64_t> InputFileOffsets;
+  llvm::hash_code InputFilesHash = 0;
   for (const auto &Entry : SortedFiles) {
     uint32_t &InputFileID = InputFileIDs[Entry.File];
     if (InputFileID != 0)
@@ -1613,6 +1621,9 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
         Entry.IsTransient};
 
     EmitRecordWithPath(IFAbbrevCode, Record, Entry.File->getName());
+    InputFilesHash = llvm::hash_combine(InputFilesHash,
+                                        StringRef(Entry.File->getName()),
+                                        Record[2], Record[3], Record[4]);
   }
 
   Stream.ExitBlock();
@@ -1630,6 +1641,11 @@ void ASTWriter::WriteInputFiles(SourceManager &SourceMgr,
   RecordData::value_type Record[] = {INPUT_FILE_OFFSETS,
                                      InputFileOffsets.size(), UserFilesNum};
   Stream.EmitRecordWithBlob(OffsetsAbbrevCode, Record, bytes(InputFileOffsets));
+
+  // Write the combined hash of the input files, which identifies this set of
+  // inputs in a build session's validation cache.
+  RecordData::value_type HashRecord[] = {(uint64_t)(size_t)InputFilesHash};
+  Stream.EmitRecord(INPUT_FILES_HASH, HashRecord);
 }
 
 //===----------------------------------------------------------------------===//
@@ -1685,6 +1701,66 @@ static unsigned CreateSLocBufferBlobAbbrev(llvm::BitstreamWriter &Stream,
   return Stream.EmitAbbrev(Abbrev);
 }
 
+/// \brief Create an abbreviation for the SLocEntry that refers to a
+/// buffer's blob kept in a shared store.
+static unsigned CreateSLocBufferBlobSharedAbbrev(llvm::BitstreamWriter &Stream) {
+  using namespace llvm;
+
+  auto *Abbrev = new BitCodeAbbrev();
+  Abbrev->Add(BitCodeAbbrevOp(SM_SLOC_BUFFER_BLOB_SHARED));
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 8)); // Size
+  Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // File name
+  return Stream.EmitAbbrev(Abbrev);
+}
+
+/// \brief Ensure that \p Store holds a file with the given contents, named
+/// after their hash, and store its name in \p StoredFile.
+///
+/// \returns true if an error occurred.
+static bool storeSharedBuffer(StringRef Store, StringRef Contents,
+                              SmallVectorImpl<char> &StoredFile) {
+  llvm::MD5 Hash;
+  Hash.update(Contents);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+
+  StoredFile.assign(Store.begin(), Store.end());
+  if (llvm::sys::fs::make_absolute(StoredFile))
+    return true;
+  llvm::sys::path::append(StoredFile, Digest);
+
+  // Another compilation may have stored the same contents already.
+  if (llvm::sys::fs::exists(StoredFile))
+    return false;
+
+  // Write to a temporary file and rename it into place, so that readers never
+  // see a partially written file.
+  if (llvm::sys::fs::create_directories(Store))
+    return true;
+  int TmpFD;
+  SmallString<128> TmpFile;
+  if (llvm::sys::fs::createUniqueFile(Twine(StoredFile) + "-%%%%%%%%", TmpFD,
+                                      TmpFile))
+    return true;
+  {
+    llvm::raw_fd_ostream Out(TmpFD, /*shouldClose=*/true);
+    Out << Contents;
+    Out.close();
+    if (Out.has_error()) {
+      Out.clear_error();
+      llvm::sys::fs::remove(TmpFile);
+      return true;
+    }
+  }
+  if (llvm::sys::fs::rename(TmpFile, StoredFile)) {
+    llvm::sys::fs::remove(TmpFile);
+    return true;
+  }
+  return false;
+}
+
 /// \brief Create an abbreviation for the SLocEntry that refers to a macro
 /// expansion.
 static unsigned CreateSLocExpansionAbbrev(llvm::BitstreamWriter &Stream) {
@@ -1889,6 +1965,16 @@ void ASTWriter::WriteHeaderSearch(const HeaderSearch &HS) {
     free(const_cast<char *>(SavedStrings[I]));
 }
 
+/// \brief Whether the contents of the given source location entry are
+/// written to the AST file, rather than read from the file it names.
+static bool hasEmbeddedBuffer(const SrcMgr::SLocEntry &SLoc) {
+  if (!SLoc.isFile())
+    return false;
+  const SrcMgr::ContentCache *Content = SLoc.getFile().getContentCache();
+  return !Content->OrigEntry || Content->BufferOverridden ||
+         Content->IsTransient;
+}
+
 /// \brief Writes the block containing the serialized form of the
 /// source manager.
 ///
@@ -1897,10 +1983,63 @@ void ASTWriter::WriteHeaderSearch(const HeaderSearch &HS) {
 /// entries for files that we actually need. In the common case (no
 /// errors), we probably won't have to create file entries for any of
 /// the files in the AST.
+
 void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
                                         const Preprocessor &PP) {
   RecordData Record;
 
+  // Compressing embedded buffers dominates the time spent writing this block
+  // when many files are embedded, and each one is independent, so compress
+  // them all up front in parallel. The buffers themselves are fetched here,
+  // as the source manager isn't thread-safe.
+  //
+  // The result is keyed by the index of the entry, and only holds the buffers
+  // that were compressed.
+  llvm::DenseMap<unsigned, SmallString<0>> CompressedBuffers;
+  {
+    struct PendingBuffer {
+      unsigned Index;
+      StringRef Contents;
+      SmallString<0> Compressed;
+      bool Succeeded;
+    };
+    std::vector<PendingBuffer> Buffers;
+    for (unsigned I = 1, N = SourceMgr.local_sloc_entry_size(); I != N; ++I) {
+      const SrcMgr::SLocEntry &SLoc = SourceMgr.getLocalSLocEntry(I);
+      if (!hasEmbeddedBuffer(SLoc))
+        continue;
+      const SrcMgr::ContentCache *Content = SLoc.getFile().getContentCache();
+      if (Content->OrigEntry && !EmbeddedContentsStore.empty())
+        continue;
+      PendingBuffer Buffer = {
+          I,
+          Content->getBuffer(PP.getDiagnostics(), PP.getSourceManager())
+              ->getBuffer(),
+          SmallString<0>(), false};
+      Buffers.push_back(std::move(Buffer));
+    }
+
+    // Each task only touches its own element.
+    auto Compress = [](PendingBuffer &Buffer) {
+      Buffer.Succeeded =
+          llvm::zlib::compress(Buffer.Contents, Buffer.Compressed) ==
+          llvm::zlib::StatusOK;
+    };
+    if (Buffers.size() > 1 && llvm::zlib::isAvailable()) {
+      llvm::ThreadPool Pool;
+      for (PendingBuffer &Buffer : Buffers)
+        Pool.async([&Compress, &Buffer] { Compress(Buffer); });
+      Pool.wait();
+    } else {
+      for (PendingBuffer &Buffer : Buffers)
+        Compress(Buffer);
+    }
+
+    for (PendingBuffer &Buffer : Buffers)
+      if (Buffer.Succeeded)
+        CompressedBuffers[Buffer.Index] = std::move(Buffer.Compressed);
+  }
+
   // Enter the source manager block.
   Stream.EnterSubblock(SOURCE_MANAGER_BLOCK_ID, 4);
 
@@ -1910,6 +2049,7 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
   unsigned SLocBufferBlobAbbrv = CreateSLocBufferBlobAbbrev(Stream, false);
   unsigned SLocBufferBlobCompressedAbbrv =
       CreateSLocBufferBlobAbbrev(Stream, true);
+  unsigned SLocBufferBlobSharedAbbrv = CreateSLocBufferBlobSharedAbbrev(Stream);
   unsigned SLocExpansionAbbrv = CreateSLocExpansionAbbrev(Stream);
 
   // Write out the source location entry table. We skip the first
@@ -1999,15 +2139,24 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
             Content->getBuffer(PP.getDiagnostics(), PP.getSourceManager());
         StringRef Blob(Buffer->getBufferStart(), Buffer->getBufferSize() + 1);
 
-        // Compress the buffer if possible. We expect that almost all PCM
-        // consumers will not want its contents.
-        SmallString<0> CompressedBuffer;
-        if (llvm::zlib::compress(Blob.drop_back(1), CompressedBuffer) ==
-            llvm::zlib::StatusOK) {
+        // Files embedded into many modules are kept once in the shared store
+        // if there is one.
+        SmallString<128> StoredFile;
+        auto Compressed = CompressedBuffers.find(I);
+        if (Content->OrigEntry && !EmbeddedContentsStore.empty() &&
+            !storeSharedBuffer(EmbeddedContentsStore, Blob.drop_back(1),
+                               StoredFile)) {
+          RecordData::value_type Record[] = {SM_SLOC_BUFFER_BLOB_SHARED,
+                                             Blob.size() - 1};
+          Stream.EmitRecordWithBlob(SLocBufferBlobSharedAbbrv, Record,
+                                    StoredFile);
+        } else if (Compressed != CompressedBuffers.end()) {
+          // Compress the buffer if possible. We expect that almost all PCM
+          // consumers will not want its contents.
           RecordData::value_type Record[] = {SM_SLOC_BUFFER_BLOB_COMPRESSED,
                                              Blob.size() - 1};
           Stream.EmitRecordWithBlob(SLocBufferBlobCompressedAbbrv, Record,
-                                    CompressedBuffer);
+                                    Compressed->second);
         } else {
           RecordData::value_type Record[] = {SM_SLOC_BUFFER_BLOB};
           Stream.EmitRecordWithBlob(SLocBufferBlobAbbrv, Record, Blob);
@@ -2058,6 +2207,19 @@ void ASTWriter::WriteSourceManagerBlock(SourceManager &SourceMgr,
   // reader which source locations entries it should load eagerly.
   Stream.EmitRecord(SOURCE_LOCATION_PRELOADS, PreloadSLocs);
 
+  // Write the macro argument expansions that were coalesced into the entries
+  // above, so that their expansion locations survive.
+  if (!SourceMgr.getLocalCoalescedMacroArgExpansions().empty()) {
+    RecordData Record;
+    for (const SourceManager::CoalescedMacroArgExpansion &Arg :
+         SourceMgr.getLocalCoalescedMacroArgExpansions()) {
+      AddSourceLocation(SourceLocation::getMacroLoc(Arg.Begin), Record);
+      AddSourceLocation(SourceLocation::getMacroLoc(Arg.Offset), Record);
+      AddSourceLocation(Arg.ExpansionLoc, Record);
+    }
+    Stream.EmitRecord(COALESCED_MACRO_ARG_EXPANSIONS, Record);
+  }
+
   // Write the line table. It depends on remapping working, so it must come
   // after the source location offsets.
   if (SourceMgr.hasLineTable()) {
@@ -2311,7 +2473,8 @@ void ASTWriter::WritePreprocessor(const Preprocessor &PP, bool IsModule) {
 }
 
 void ASTWriter::WritePreprocessorDetail(PreprocessingRecord &PPRec) {
-  if (PPRec.local_begin() == PPRec.local_end())
+  unsigned NumLocalEntities = PPRec.getNumLocalPreprocessedEntities();
+  if (NumLocalEntities == 0)
     return;
 
   SmallVector<PPEntityOffset, 64> PreprocessedEntityOffsets;
@@ -2341,16 +2504,26 @@ void ASTWriter::WritePreprocessorDetail(PreprocessingRecord &PPRec) {
     + NUM_PREDEF_PP_ENTITY_IDS;
   unsigned NextPreprocessorEntityID = FirstPreprocessorEntityID;
   RecordData Record;
-  for (PreprocessingRecord::iterator E = PPRec.local_begin(),
-                                  EEnd = PPRec.local_end();
-       E != EEnd; 
-       (void)++E, ++NumPreprocessingRecords, ++NextPreprocessorEntityID) {
+  for (unsigned I = 0; I != NumLocalEntities;
+       ++I, ++NumPreprocessingRecords, ++NextPreprocessorEntityID) {
     Record.clear();
 
     PreprocessedEntityOffsets.push_back(
-        PPEntityOffset((*E)->getSourceRange(), Stream.GetCurrentBitNo()));
+        PPEntityOffset(PPRec.getLocalPreprocessedEntityRange(I),
+                       Stream.GetCurrentBitNo()));
+
+    // Expansions of defined macros are the bulk of the record; write them
+    // without creating their MacroExpansion objects.
+    if (MacroDefinitionRecord *Def =
+            PPRec.getLocalMacroExpansionDefinition(I)) {
+      Record.push_back(false);
+      Record.push_back(MacroDefinitions[Def]);
+      Stream.EmitRecord(PPD_MACRO_EXPANSION, Record);
+      continue;
+    }
 
-    if (auto *MD = dyn_cast<MacroDefinitionRecord>(*E)) {
+    PreprocessedEntity *E = PPRec.getLocalPreprocessedEntity(I);
+    if (auto *MD = dyn_cast<MacroDefinitionRecord>(E)) {
       // Record this macro definition's ID.
       MacroDefinitions[MD] = NextPreprocessorEntityID;
 
@@ -2359,17 +2532,15 @@ void ASTWriter::WritePreprocessorDetail(PreprocessingRecord &PPRec) {
       continue;
     }
 
-    if (auto *ME = dyn_cast<MacroExpansion>(*E)) {
-      Record.push_back(ME->isBuiltinMacro());
-      if (ME->isBuiltinMacro())
-        AddIdentifierRef(ME->getName(), Record);
-      else
-        Record.push_back(MacroDefinitions[ME->getDefinition()]);
+    if (auto *ME = dyn_cast<MacroExpansion>(E)) {
+      assert(ME->isBuiltinMacro() && "Expansion with a definition not caught");
+      Record.push_back(true);
+      AddIdentifierRef(ME->getName(), Record);
       Stream.EmitRecord(PPD_MACRO_EXPANSION, Record);
       continue;
     }
 
-    if (auto *ID = dyn_cast<InclusionDirective>(*E)) {
+    if (auto *ID = dyn_cast<InclusionDirective>(E)) {
       Record.push_back(PPD_INCLUSION_DIRECTIVE);
       Record.push_back(ID->getFileName().size());
       Record.push_back(ID->wasInQuotes());
@@ -2777,9 +2948,9 @@ uint64_t ASTWriter::WriteDeclContextLexicalBlock(ASTContext &Context,
   }
 
   ++NumLexicalDeclContexts;
-  RecordData::value_type Record[] = {DECL_CONTEXT_LEXICAL};
-  Stream.EmitRecordWithBlob(DeclContextLexicalAbbrev, Record,
-                            bytes(KindDeclPairs));
+  RecordData Record;
+  Record.push_back(DECL_CONTEXT_LEXICAL);
+  EmitRecordWithTable(DeclContextLexicalAbbrev, Record, bytes(KindDeclPairs));
   return Offset;
 }
 
@@ -2791,12 +2962,16 @@ void ASTWriter::WriteTypeDeclOffsets() {
   Abbrev->Add(BitCodeAbbrevOp(TYPE_OFFSET));
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // # of types
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // base type index
+  if (CompressTables)
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16)); // Uncompressed size
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // types block
   unsigned TypeOffsetAbbrev = Stream.EmitAbbrev(Abbrev);
   {
-    RecordData::value_type Record[] = {TYPE_OFFSET, TypeOffsets.size(),
-                                       FirstTypeID - NUM_PREDEF_TYPE_IDS};
-    Stream.EmitRecordWithBlob(TypeOffsetAbbrev, Record, bytes(TypeOffsets));
+    RecordData Record;
+    Record.push_back(TYPE_OFFSET);
+    Record.push_back(TypeOffsets.size());
+    Record.push_back(FirstTypeID - NUM_PREDEF_TYPE_IDS);
+    EmitRecordWithTable(TypeOffsetAbbrev, Record, bytes(TypeOffsets));
   }
 
   // Write the declaration offsets array
@@ -2804,12 +2979,16 @@ void ASTWriter::WriteTypeDeclOffsets() {
   Abbrev->Add(BitCodeAbbrevOp(DECL_OFFSET));
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // # of declarations
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Fixed, 32)); // base decl ID
+  if (CompressTables)
+    Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16)); // Uncompressed size
   Abbrev->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob)); // declarations block
   unsigned DeclOffsetAbbrev = Stream.EmitAbbrev(Abbrev);
   {
-    RecordData::value_type Record[] = {DECL_OFFSET, DeclOffsets.size(),
-                                       FirstDeclID - NUM_PREDEF_DECL_IDS};
-    Stream.EmitRecordWithBlob(DeclOffsetAbbrev, Record, bytes(DeclOffsets));
+    RecordData Record;
+    Record.push_back(DECL_OFFSET);
+    Record.push_back(DeclOffsets.size());
+    Record.push_back(FirstDeclID - NUM_PREDEF_DECL_IDS);
+    EmitRecordWithTable(DeclOffsetAbbrev, Record, bytes(DeclOffsets));
   }
 }
 
@@ -3887,6 +4066,101 @@ void ASTWriter::WriteObjCCategories() {
   Stream.EmitRecord(OBJC_CATEGORIES, Categories);
 }
 
+/// \brief Write the layouts of the records that were laid out while building
+/// this AST file, so that the records are not laid out again when the file is
+/// loaded.
+void ASTWriter::WriteRecordLayouts(ASTContext &Context) {
+  auto IsWritten = [&](const Decl *D) {
+    return !D || D->isFromASTFile() || DeclIDs.count(D);
+  };
+
+  // Sort the records by ID so that the output is deterministic. Layouts of
+  // records from other AST files are stored in those files.
+  SmallVector<std::pair<DeclID, const RecordDecl *>, 16> Records;
+  for (const auto &Entry : Context.ASTRecordLayouts) {
+    if (!Entry.second || Entry.first->isFromASTFile())
+      continue;
+    auto ID = DeclIDs.find(Entry.first);
+    if (ID != DeclIDs.end())
+      Records.push_back(std::make_pair(ID->second, Entry.first));
+  }
+  llvm::array_pod_sort(Records.begin(), Records.end());
+
+  RecordData Record;
+  for (const auto &R : Records) {
+    const ASTRecordLayout &Layout = *Context.ASTRecordLayouts.lookup(R.second);
+    const ASTRecordLayout::CXXRecordLayoutInfo *CXXInfo = Layout.CXXInfo;
+
+    SmallVector<std::pair<DeclID, int64_t>, 4> Bases;
+    SmallVector<std::pair<DeclID, ASTRecordLayout::VBaseInfo>, 4> VBases;
+    if (CXXInfo) {
+      bool AllBasesWritten = IsWritten(CXXInfo->PrimaryBase.getPointer()) &&
+                             IsWritten(CXXInfo->BaseSharingVBPtr);
+      for (const auto &Base : CXXInfo->BaseOffsets)
+        AllBasesWritten &= IsWritten(Base.first);
+      for (const auto &VBase : CXXInfo->VBaseOffsets)
+        AllBasesWritten &= IsWritten(VBase.first);
+      if (!AllBasesWritten)
+        continue;
+
+      for (const auto &Base : CXXInfo->BaseOffsets)
+        Bases.push_back(
+            std::make_pair(getDeclID(Base.first), Base.second.getQuantity()));
+      for (const auto &VBase : CXXInfo->VBaseOffsets)
+        VBases.push_back(std::make_pair(getDeclID(VBase.first), VBase.second));
+      llvm::array_pod_sort(Bases.begin(), Bases.end());
+      std::sort(VBases.begin(), VBases.end(),
+                [](const std::pair<DeclID, ASTRecordLayout::VBaseInfo> &L,
+                   const std::pair<DeclID, ASTRecordLayout::VBaseInfo> &R) {
+                  return L.first < R.first;
+                });
+    }
+
+    Record.push_back(R.first);
+    // Allocate space for the length of the layout.
+    unsigned LengthIndex = Record.size();
+    Record.push_back(0);
+
+    Record.push_back(Layout.Size.getQuantity());
+    Record.push_back(Layout.DataSize.getQuantity());
+    Record.push_back(Layout.Alignment.getQuantity());
+    Record.push_back(Layout.RequiredAlignment.getQuantity());
+    Record.push_back(Layout.FieldOffsets.size());
+    Record.append(Layout.FieldOffsets.begin(), Layout.FieldOffsets.end());
+    Record.push_back(CXXInfo != nullptr);
+    if (CXXInfo) {
+      Record.push_back(CXXInfo->NonVirtualSize.getQuantity());
+      Record.push_back(CXXInfo->NonVirtualAlignment.getQuantity());
+      Record.push_back(CXXInfo->SizeOfLargestEmptySubobject.getQuantity());
+      Record.push_back(getDeclID(CXXInfo->PrimaryBase.getPointer()));
+      Record.push_back(CXXInfo->PrimaryBase.getInt());
+      Record.push_back(CXXInfo->HasOwnVFPtr);
+      Record.push_back(CXXInfo->HasExtendableVFPtr);
+      Record.push_back(CXXInfo->VBPtrOffset.getQuantity());
+      Record.push_back(getDeclID(CXXInfo->BaseSharingVBPtr));
+      Record.push_back(CXXInfo->EndsWithZeroSizedObject);
+      Record.push_back(CXXInfo->LeadsWithZeroSizedBase);
+      Record.push_back(Bases.size());
+      for (const auto &Base : Bases) {
+        Record.push_back(Base.first);
+        Record.push_back(Base.second);
+      }
+      Record.push_back(VBases.size());
+      for (const auto &VBase : VBases) {
+        Record.push_back(VBase.first);
+        Record.push_back(VBase.second.VBaseOffset.getQuantity());
+        Record.push_back(VBase.second.hasVtorDisp());
+      }
+    }
+
+    // Update the length of the layout.
+    Record[LengthIndex] = Record.size() - LengthIndex - 1;
+  }
+
+  if (!Record.empty())
+    Stream.EmitRecord(RECORD_LAYOUTS, Record);
+}
+
 void ASTWriter::WriteLateParsedTemplates(Sema &SemaRef) {
   Sema::LateParsedTemplateMapT &LPTMap = SemaRef.LateParsedTemplateMap;
 
@@ -4033,6 +4307,27 @@ void ASTWriter::EmitRecordWithPath(unsigned Abbrev, RecordDataRef Record,
   Stream.EmitRecordWithBlob(Abbrev, Record, FilePath);
 }
 
+void ASTWriter::EmitRecordWithTable(unsigned Abbrev, RecordDataImpl &Record,
+                                    StringRef Table) {
+  if (!CompressTables) {
+    Stream.EmitRecordWithBlob(Abbrev, Record, Table);
+    return;
+  }
+
+  // Small tables aren't worth decompressing on load.
+  SmallString<0> CompressedTable;
+  if (Table.size() >= 256 &&
+      llvm::zlib::compress(Table, CompressedTable) == llvm::zlib::StatusOK &&
+      CompressedTable.size() < Table.size()) {
+    Record.push_back(Table.size());
+    Stream.EmitRecordWithBlob(Abbrev, Record, CompressedTable);
+    return;
+  }
+
+  Record.push_back(0);
+  Stream.EmitRecordWithBlob(Abbrev, Record, Table);
+}
+
 void ASTWriter::AddVersionTuple(const VersionTuple &Version,
                                 RecordDataImpl &Record) {
   Record.push_back(Version.getMajor());
@@ -4071,9 +4366,12 @@ void ASTWriter::SetSelectorOffset(Selector Sel, uint32_t Offset) {
 ASTWriter::ASTWriter(
   llvm::BitstreamWriter &Stream,
   ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
-  bool IncludeTimestamps)
+  bool IncludeTimestamps, bool CompressTables,
+  StringRef EmbeddedContentsStore)
     : Stream(Stream), Context(nullptr), PP(nullptr), Chain(nullptr),
       WritingModule(nullptr), IncludeTimestamps(IncludeTimestamps),
+      CompressTables(CompressTables),
+      EmbeddedContentsStore(EmbeddedContentsStore),
       WritingAST(false), DoneWritingDeclsAndTypes(false),
       ASTHasCompilerErrors(false), FirstDeclID(NUM_PREDEF_DECL_IDS),
       NextDeclID(FirstDeclID), FirstTypeID(NUM_PREDEF_TYPE_IDS),
@@ -4522,6 +4820,10 @@ uint64_t ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   if (!EagerlyDeserializedDecls.empty())
     Stream.EmitRecord(EAGERLY_DESERIALIZED_DECLS, EagerlyDeserializedDecls);
 
+  // Write the record containing the definitions emitted with the module.
+  if (!ModularCodegenDecls.empty())
+    Stream.EmitRecord(MODULAR_CODEGEN_DECLS, ModularCodegenDecls);
+
   // Write the record containing tentative definitions.
   if (!TentativeDefinitions.empty())
     Stream.EmitRecord(TENTATIVE_DEFINITIONS, TentativeDefinitions);
@@ -4620,6 +4922,7 @@ uint64_t ASTWriter::WriteASTCore(Sema &SemaRef, StringRef isysroot,
   }
 
   WriteObjCCategories();
+  WriteRecordLayouts(Context);
   if(!WritingModule) {
     WriteOptimizePragmaOptions(SemaRef);
     WriteMSStructPragmaOptions(SemaRef);
@@ -5470,6 +5773,63 @@ void ASTRecordWriter::AddCXXCtorInitializers(
   AddOffset(EmitCXXCtorInitializers(*Writer, CtorInits));
 }
 
+/// \brief Compute a hash of the bases and the explicitly declared members of
+/// a class definition that is the same for every module containing an
+/// identical definition, or zero if the members aren't all available.
+///
+/// Only names, kinds, access and canonical types are hashed, so the hash is
+/// independent of the order declarations were deserialized in, but says
+/// nothing about function bodies or initializers.
+static uint64_t computeODRHash(const CXXRecordDecl *D) {
+  if (D->hasExternalLexicalStorage())
+    return 0;
+
+  llvm::MD5 Hash;
+  auto AddString = [&](StringRef Str) {
+    Hash.update(Str);
+    Hash.update(StringRef("\0", 1));
+  };
+  auto AddInt = [&](uint64_t Value) { AddString(llvm::utostr(Value)); };
+  auto AddType = [&](QualType T) {
+    AddString(T.getCanonicalType().getAsString());
+  };
+
+  for (const CXXBaseSpecifier &Base : D->bases()) {
+    AddType(Base.getType());
+    AddInt(Base.isVirtual());
+    AddInt(Base.getAccessSpecifierAsWritten());
+  }
+
+  for (const Decl *Member : D->decls()) {
+    if (Member->isImplicit())
+      continue;
+
+    AddInt(Member->getKind());
+    AddInt(Member->getAccess());
+    if (const auto *ND = dyn_cast<NamedDecl>(Member))
+      AddString(ND->getDeclName().getAsString());
+    if (const auto *VD = dyn_cast<ValueDecl>(Member))
+      AddType(VD->getType());
+    if (const auto *TD = dyn_cast<TypedefNameDecl>(Member))
+      AddType(TD->getUnderlyingType());
+    if (const auto *FD = dyn_cast<FieldDecl>(Member)) {
+      AddInt(FD->isBitField());
+      AddInt(FD->isMutable());
+    }
+    if (const auto *MD = dyn_cast<CXXMethodDecl>(Member)) {
+      AddInt(MD->isVirtualAsWritten());
+      AddInt(MD->isPure());
+      AddInt(MD->isDeletedAsWritten());
+    }
+  }
+
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  using namespace llvm::support;
+  // Keep zero for "no hash".
+  return endian::read<uint64_t, little, unaligned>(Result) | 1;
+}
+
 void ASTRecordWriter::AddCXXDefinitionData(const CXXRecordDecl *D) {
   auto &Data = D->data();
   Record->push_back(Data.IsLambda);
@@ -5493,9 +5853,11 @@ void ASTRecordWriter::AddCXXDefinitionData(const CXXRecordDecl *D) {
   Record->push_back(Data.HasUninitializedFields);
   Record->push_back(Data.HasInheritedConstructor);
   Record->push_back(Data.HasInheritedAssignment);
+  Record->push_back(Data.NeedOverloadResolutionForCopyConstructor);
   Record->push_back(Data.NeedOverloadResolutionForMoveConstructor);
   Record->push_back(Data.NeedOverloadResolutionForMoveAssignment);
   Record->push_back(Data.NeedOverloadResolutionForDestructor);
+  Record->push_back(Data.DefaultedCopyConstructorIsDeleted);
   Record->push_back(Data.DefaultedMoveConstructorIsDeleted);
   Record->push_back(Data.DefaultedMoveAssignmentIsDeleted);
   Record->push_back(Data.DefaultedDestructorIsDeleted);
@@ -5529,6 +5891,7 @@ void ASTRecordWriter::AddCXXDefinitionData(const CXXRecordDecl *D) {
   AddUnresolvedSet(Data.VisibleConversions.get(*Writer->Context));
   // Data.Definition is the owning decl, no need to write it. 
   AddDeclRef(D->getFirstFriend());
+  Record->push_back(computeODRHash(D));
   
   // Add lambda-specific data.
   if (Data.IsLambda) {
@@ -2089,6 +2089,8 @@ void ASTWriter::WriteDeclAbbrevs() {
 
   Abv = new BitCodeAbbrev();
   Abv->Add(BitCodeAbbrevOp(serialization::DECL_CONTEXT_LEXICAL));
+  if (CompressTables)
+    Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::VBR, 16)); // Uncompressed size
   Abv->Add(BitCodeAbbrevOp(BitCodeAbbrevOp::Blob));
   DeclContextLexicalAbbrev = Stream.EmitAbbrev(Abv);
 
@@ -2180,6 +2182,19 @@ void ASTRecordWriter::AddFunctionDefinition(const FunctionDecl *FD) {
   Writer->ClearSwitchCaseIDs();
 
   assert(FD->doesThisDeclarationHaveABody());
+
+  // Under -fmodules-codegen, the object file of the module has the
+  // definitions of its non-internal functions, and its importers do not
+  // emit them. Always-inline functions are left to their importers.
+  bool ModulesCodegen = false;
+  if (Writer->WritingModule && Writer->Context->getLangOpts().ModulesCodegen &&
+      !FD->isDependentContext() && !FD->hasAttr<AlwaysInlineAttr>())
+    ModulesCodegen =
+        Writer->Context->GetGVALinkageForFunction(FD) != GVA_Internal;
+  Record->push_back(ModulesCodegen);
+  if (ModulesCodegen)
+    Writer->ModularCodegenDecls.push_back(Writer->GetDeclRef(FD));
+
   if (auto *CD = dyn_cast<CXXConstructorDecl>(FD)) {
     Record->push_back(CD->getNumCtorInitializers());
     if (CD->getNumCtorInitializers())
@@ -787,6 +787,17 @@ void ASTStmtWriter::VisitDesignatedInitUpdateExpr(DesignatedInitUpdateExpr *E) {
   Code = serialization::EXPR_DESIGNATED_INIT_UPDATE;
 }
 
+void ASTStmtWriter::VisitPackedArrayInitExpr(PackedArrayInitExpr *E) {
+  VisitExpr(E);
+  Record.push_back(E->getNumElements());
+  Record.push_back(E->getElementSize());
+  // The values are recomputed from the literals of the syntactic form, so
+  // only that form is stored. The semantic InitListExpr, with a conversion
+  // per element, is not stored at all.
+  Record.AddStmt(E->getSyntacticForm());
+  Code = serialization::EXPR_PACKED_ARRAY_INIT;
+}
+
 void ASTStmtWriter::VisitNoInitExpr(NoInitExpr *E) {
   VisitExpr(E);
   Code = serialization::EXPR_NO_INIT;
@@ -28,10 +28,12 @@ PCHGenerator::PCHGenerator(
   clang::Module *Module, StringRef isysroot,
   std::shared_ptr<PCHBuffer> Buffer,
   ArrayRef<llvm::IntrusiveRefCntPtr<ModuleFileExtension>> Extensions,
-  bool AllowASTWithErrors, bool IncludeTimestamps)
+  bool AllowASTWithErrors, bool IncludeTimestamps, bool CompressTables,
+  StringRef EmbeddedContentsStore)
     : PP(PP), OutputFile(OutputFile), Module(Module), isysroot(isysroot.str()),
       SemaPtr(nullptr), Buffer(Buffer), Stream(Buffer->Data),
-      Writer(Stream, Extensions, IncludeTimestamps),
+      Writer(Stream, Extensions, IncludeTimestamps, CompressTables,
+             EmbeddedContentsStore),
       AllowASTWithErrors(AllowASTWithErrors) {
   Buffer->IsComplete = false;
 }
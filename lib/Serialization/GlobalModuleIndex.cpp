@@ -19,6 +19,7 @@
 #include "clang/Serialization/GlobalModuleIndex.h"
 #include "clang/Serialization/Module.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
@@ -29,6 +30,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/OnDiskHashTable.h"
 #include "llvm/Support/Path.h"
+#include <algorithm>
 #include <cstdio>
 using namespace clang;
 using namespace serialization;
@@ -292,6 +294,11 @@ void GlobalModuleIndex::getModuleDependencies(
 }
 
 bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
+  return lookupIdentifier(Name, llvm::HashString(Name), Hits);
+}
+
+bool GlobalModuleIndex::lookupIdentifier(StringRef Name, unsigned NameHash,
+                                         HitSet &Hits) {
   Hits.clear();
   
   // If there's no identifier index, there is nothing we can do.
@@ -302,7 +309,7 @@ bool GlobalModuleIndex::lookupIdentifier(StringRef Name, HitSet &Hits) {
   ++NumIdentifierLookups;
   IdentifierIndexTable &Table
     = *static_cast<IdentifierIndexTable *>(IdentifierIndex);
-  IdentifierIndexTable::iterator Known = Table.find(Name);
+  IdentifierIndexTable::iterator Known = Table.find_hashed(Name, NameHash);
   if (Known == Table.end()) {
     return true;
   }
@@ -427,6 +434,15 @@ namespace {
     /// \returns true if an error occurred, false otherwise.
     bool loadModuleFile(const FileEntry *File);
 
+    /// \brief Add a module file described by a previous index, along with the
+    /// module files it directly depends on, without loading it again.
+    void addIndexedModuleFile(const FileEntry *File,
+                              ArrayRef<const FileEntry *> Dependencies);
+
+    /// \brief Add an identifier from a previous index, and note that
+    /// \p InterestingIn, if non-null, considers it interesting.
+    void addIndexedIdentifier(StringRef Name, const FileEntry *InterestingIn);
+
     /// \brief Write the index to the given bitstream.
     void writeIndex(llvm::BitstreamWriter &Stream);
   };
@@ -644,6 +660,22 @@ bool GlobalModuleIndexBuilder::loadModuleFile(const FileEntry *File) {
   return false;
 }
 
+void GlobalModuleIndexBuilder::addIndexedModuleFile(
+    const FileEntry *File, ArrayRef<const FileEntry *> Dependencies) {
+  (void)getModuleFileInfo(File);
+  for (const FileEntry *DependsOnFile : Dependencies) {
+    unsigned DependsOnID = getModuleFileInfo(DependsOnFile).ID;
+    getModuleFileInfo(File).Dependencies.push_back(DependsOnID);
+  }
+}
+
+void GlobalModuleIndexBuilder::addIndexedIdentifier(
+    StringRef Name, const FileEntry *InterestingIn) {
+  SmallVectorImpl<unsigned> &IDs = InterestingIdentifiers[Name];
+  if (InterestingIn)
+    IDs.push_back(getModuleFileInfo(InterestingIn).ID);
+}
+
 namespace {
 
 /// \brief Trait used to generate the identifier index as an on-disk hash
@@ -792,7 +824,41 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
   // The module index builder.
   GlobalModuleIndexBuilder Builder(FileMgr, PCHContainerRdr);
 
+  // Module files that haven't changed since the previous index was written
+  // are taken from that index instead of being loaded again, so that adding
+  // a module to the cache only costs loading that module.
+  std::unique_ptr<GlobalModuleIndex> PreviousIndex(readIndex(Path).first);
+  SmallVector<const FileEntry *, 16> PreviousFiles;
+  llvm::DenseMap<const FileEntry *, unsigned> ReusableModules;
+  if (PreviousIndex) {
+    for (const ModuleInfo &Info : PreviousIndex->Modules) {
+      const FileEntry *File = nullptr;
+      if (!Info.FileName.empty())
+        File = FileMgr.getFile(Info.FileName, /*openFile=*/false,
+                               /*cacheFailure=*/false);
+      if (File && (File->getSize() != Info.Size ||
+                   File->getModificationTime() != Info.ModTime))
+        File = nullptr;
+      PreviousFiles.push_back(File);
+    }
+
+    // A module file can only be reused if the module files it imports are
+    // unchanged as well; otherwise loading it reports that it's out of date.
+    for (unsigned ID = 0, N = PreviousFiles.size(); ID != N; ++ID) {
+      if (!PreviousFiles[ID])
+        continue;
+      ArrayRef<unsigned> Dependencies =
+          PreviousIndex->Modules[ID].Dependencies;
+      if (std::all_of(Dependencies.begin(), Dependencies.end(),
+                      [&](unsigned DependsOnID) {
+            return DependsOnID < N && PreviousFiles[DependsOnID];
+          }))
+        ReusableModules[PreviousFiles[ID]] = ID;
+    }
+  }
+
   // Load each of the module files.
+  llvm::DenseSet<const FileEntry *> ReusedModules;
   std::error_code EC;
   for (llvm::sys::fs::directory_iterator D(Path, EC), DEnd;
        D != DEnd && !EC;
@@ -813,11 +879,45 @@ GlobalModuleIndex::writeIndex(FileManager &FileMgr,
     if (!ModuleFile)
       continue;
 
+    auto Reusable = ReusableModules.find(ModuleFile);
+    if (Reusable != ReusableModules.end()) {
+      SmallVector<const FileEntry *, 4> Dependencies;
+      for (unsigned DependsOnID :
+           PreviousIndex->Modules[Reusable->second].Dependencies)
+        Dependencies.push_back(PreviousFiles[DependsOnID]);
+      Builder.addIndexedModuleFile(ModuleFile, Dependencies);
+      ReusedModules.insert(ModuleFile);
+      continue;
+    }
+
     // Load this module file.
     if (Builder.loadModuleFile(ModuleFile))
       return EC_IOError;
   }
 
+  // Carry over the identifiers of the previous index, crediting the module
+  // files that were reused.
+  if (PreviousIndex && PreviousIndex->IdentifierIndex) {
+    IdentifierIndexTable &Table =
+        *static_cast<IdentifierIndexTable *>(PreviousIndex->IdentifierIndex);
+    for (IdentifierIndexTable::key_iterator Key = Table.key_begin(),
+                                            KeyEnd = Table.key_end();
+         Key != KeyEnd; ++Key) {
+      StringRef Name = *Key;
+      SmallVector<unsigned, 2> ModuleIDs = *Table.find(Name);
+      bool Added = false;
+      for (unsigned ID : ModuleIDs) {
+        if (ID < PreviousFiles.size() && PreviousFiles[ID] &&
+            ReusedModules.count(PreviousFiles[ID])) {
+          Builder.addIndexedIdentifier(Name, PreviousFiles[ID]);
+          Added = true;
+        }
+      }
+      if (!Added)
+        Builder.addIndexedIdentifier(Name, nullptr);
+    }
+  }
+
   // The output buffer, into which the global index will be written.
   SmallVector<char, 16> OutputBuffer;
   {
@@ -113,9 +113,15 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
     }
 
     // Load the contents of the module
+    bool FromSharedCache = false, FromDisk = false;
     if (std::unique_ptr<llvm::MemoryBuffer> Buffer = lookupBuffer(FileName)) {
       // The buffer was already provided for us.
       New->Buffer = std::move(Buffer);
+    } else if (SharedCache && FileName != "-" &&
+               (Buffer = SharedCache->lookup(New->File))) {
+      // An earlier compile already read this file, and it hasn't changed.
+      New->Buffer = std::move(Buffer);
+      FromSharedCache = true;
     } else {
       // Open the AST file.
       llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buf(
@@ -127,9 +133,15 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
         // ModuleManager it must be the same underlying file.
         // FIXME: Because FileManager::getFile() doesn't guarantee that it will
         // give us an open file, this may not be 100% reliable.
+        //
+        // The AST is read with explicit bounds, so don't ask for a null
+        // terminator; that would force a copy of files whose size is a
+        // multiple of the page size.
         Buf = FileMgr.getBufferForFile(New->File,
                                        /*IsVolatile=*/false,
-                                       /*ShouldClose=*/false);
+                                       /*ShouldClose=*/false,
+                                       /*RequiresNullTerminator=*/false);
+        FromDisk = true;
       }
 
       if (!Buf) {
@@ -140,7 +152,22 @@ ModuleManager::addModule(StringRef FileName, ModuleKind Type,
       New->Buffer = std::move(*Buf);
     }
 
-    // Initialize the stream.
+    if (FromSharedCache) {
+      ++NumSharedCacheFiles;
+    } else if (New->Buffer->getBufferKind() ==
+               llvm::MemoryBuffer::MemoryBuffer_MMap) {
+      ++NumMappedFiles;
+    } else {
+      ++NumCopiedFiles;
+      NumCopiedFileBytes += New->Buffer->getBufferSize();
+    }
+
+    // Later compiles can reuse what this one read from disk.
+    if (SharedCache && FromDisk)
+      New->Buffer = SharedCache->insert(New->File, std::move(New->Buffer));
+
+    // Initialize the stream. It refers directly into the buffer, so an AST
+    // mapped from disk is never copied.
     PCHContainerRdr.ExtractPCH(New->Buffer->getMemBufferRef(), New->StreamFile);
   }
 
@@ -297,7 +324,8 @@ void ModuleManager::moduleFileAccepted(ModuleFile *MF) {
 ModuleManager::ModuleManager(FileManager &FileMgr,
                              const PCHContainerReader &PCHContainerRdr)
     : FileMgr(FileMgr), PCHContainerRdr(PCHContainerRdr), GlobalIndex(),
-      FirstVisitState(nullptr) {}
+      FirstVisitState(nullptr), NumMappedFiles(0), NumCopiedFiles(0),
+      NumSharedCacheFiles(0), NumCopiedFileBytes(0) {}
 
 ModuleManager::~ModuleManager() {
   for (unsigned i = 0, e = Chain.size(); i != e; ++i)
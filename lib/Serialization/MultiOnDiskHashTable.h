@@ -27,6 +27,46 @@ namespace serialization {
 
 class ModuleFile;
 
+/// \brief A Bloom filter over the key hashes of an on-disk hash table, used to
+/// skip probing tables that can't contain a key.
+///
+/// The filter is stored as a sequence of little-endian 32-bit words, with
+/// about \c BitsPerKey bits per key and \c NumProbes bits set for each key.
+struct OnDiskHashTableFilter {
+  static const unsigned BitsPerKey = 8;
+  static const unsigned NumProbes = 4;
+
+  /// \brief The number of words of the filter for a table of \p NumKeys keys.
+  static uint32_t getNumWords(size_t NumKeys) {
+    return (NumKeys * BitsPerKey + 31) / 32;
+  }
+
+  /// \brief Call \p SetBit with each bit of a filter of \p NumWords words
+  /// that is set for a key with \p Hash.
+  template <typename Fn>
+  static void forEachBit(unsigned Hash, uint32_t NumWords, Fn SetBit) {
+    uint32_t NumBits = NumWords * 32;
+    uint32_t Delta = ((Hash >> 17) | (Hash << 15)) | 1;
+    for (unsigned I = 0; I != NumProbes; ++I, Hash += Delta)
+      SetBit(Hash % NumBits);
+  }
+
+  /// \brief Whether the filter \p Words may contain a key with \p Hash.
+  static bool mayContain(const unsigned char *Words, uint32_t NumWords,
+                         unsigned Hash) {
+    using namespace llvm::support;
+    if (!NumWords)
+      return true;
+    bool Result = true;
+    forEachBit(Hash, NumWords, [&](uint32_t Bit) {
+      uint32_t Word = endian::read32le(Words + (Bit / 32) * 4);
+      if (!(Word & (1u << (Bit % 32))))
+        Result = false;
+    });
+    return Result;
+  }
+};
+
 /// \brief A collection of on-disk hash tables, merged when relevant for performance.
 template<typename Info> class MultiOnDiskHashTable {
 public:
@@ -49,11 +89,17 @@ private:
     file_type File;
     HashTable Table;
 
+    /// The Bloom filter over the hashes of the keys in the table.
+    storage_type Filter;
+    uint32_t NumFilterWords;
+
     OnDiskTable(file_type File, unsigned NumBuckets, unsigned NumEntries,
                 storage_type Buckets, storage_type Payload, storage_type Base,
+                storage_type Filter, uint32_t NumFilterWords,
                 const Info &InfoObj)
         : File(File),
-          Table(NumBuckets, NumEntries, Buckets, Payload, Base, InfoObj) {}
+          Table(NumBuckets, NumEntries, Buckets, Payload, Base, InfoObj),
+          Filter(Filter), NumFilterWords(NumFilterWords) {}
   };
 
   struct MergedTable {
@@ -75,6 +121,10 @@ private:
   /// discarded.
   llvm::TinyPtrVector<file_type> PendingOverrides;
 
+  /// \brief The number of on-disk tables probed by \c find, and the number
+  /// of probes skipped because a table's filter excluded the key.
+  unsigned NumTableProbes = 0, NumTableProbesSkipped = 0;
+
   struct AsOnDiskTable {
     typedef OnDiskTable *result_type;
     result_type operator()(void *P) const {
@@ -164,7 +214,9 @@ public:
   MultiOnDiskHashTable() {}
   MultiOnDiskHashTable(MultiOnDiskHashTable &&O)
       : Tables(std::move(O.Tables)),
-        PendingOverrides(std::move(O.PendingOverrides)) {
+        PendingOverrides(std::move(O.PendingOverrides)),
+        NumTableProbes(O.NumTableProbes),
+        NumTableProbesSkipped(O.NumTableProbesSkipped) {
     O.Tables.clear();
   }
   MultiOnDiskHashTable &operator=(MultiOnDiskHashTable &&O) {
@@ -174,10 +226,15 @@ public:
     Tables = std::move(O.Tables);
     O.Tables.clear();
     PendingOverrides = std::move(O.PendingOverrides);
+    NumTableProbes = O.NumTableProbes;
+    NumTableProbesSkipped = O.NumTableProbesSkipped;
     return *this;
   }
   ~MultiOnDiskHashTable() { clear(); }
 
+  unsigned getNumTableProbes() const { return NumTableProbes; }
+  unsigned getNumTableProbesSkipped() const { return NumTableProbesSkipped; }
+
   /// \brief Add the table \p Data loaded from file \p File.
   void add(file_type File, storage_type Data, Info InfoObj = Info()) {
     using namespace llvm::support;
@@ -196,6 +253,12 @@ public:
     PendingOverrides.insert(PendingOverrides.end(), OverriddenFiles.begin(),
                             OverriddenFiles.end());
 
+    // Read the filter.
+    uint32_t NumFilterWords =
+        endian::readNext<uint32_t, little, unaligned>(Ptr);
+    storage_type Filter = Ptr;
+    Ptr += NumFilterWords * 4;
+
     // Read the OnDiskChainedHashTable header.
     storage_type Buckets = Data + BucketOffset;
     auto NumBucketsAndEntries =
@@ -204,7 +267,8 @@ public:
     // Register the table.
     Table NewTable = new OnDiskTable(File, NumBucketsAndEntries.first,
                                      NumBucketsAndEntries.second,
-                                     Buckets, Ptr, Data, std::move(InfoObj));
+                                     Buckets, Ptr, Data, Filter, NumFilterWords,
+                                     std::move(InfoObj));
     Tables.push_back(NewTable.getOpaqueValue());
   }
 
@@ -230,6 +294,12 @@ public:
     data_type_builder ResultBuilder(Result);
 
     for (auto *ODT : tables()) {
+      if (!OnDiskHashTableFilter::mayContain(ODT->Filter, ODT->NumFilterWords,
+                                             KeyHash)) {
+        ++NumTableProbesSkipped;
+        continue;
+      }
+      ++NumTableProbes;
       auto &HT = ODT->Table;
       auto It = HT.find_hashed(Key, KeyHash);
       if (It != HT.end())
@@ -279,12 +349,16 @@ class MultiOnDiskHashTableGenerator {
 
   Generator Gen;
 
+  /// The hashes of the keys in the table, for its filter.
+  std::vector<typename WriterInfo::hash_value_type> KeyHashes;
+
 public:
   MultiOnDiskHashTableGenerator() : Gen() {}
 
   void insert(typename WriterInfo::key_type_ref Key,
               typename WriterInfo::data_type_ref Data, WriterInfo &Info) {
     Gen.insert(Key, Data, Info);
+    KeyHashes.push_back(Info.ComputeHash(Key));
   }
 
   void emit(llvm::SmallVectorImpl<char> &Out, WriterInfo &Info,
@@ -308,11 +382,24 @@ public:
         // Add all merged entries from Base to the generator.
         for (auto &KV : Merged->Data) {
           if (!Gen.contains(KV.first, Info))
-            Gen.insert(KV.first, Info.ImportData(KV.second), Info);
+            insert(KV.first, Info.ImportData(KV.second), Info);
         }
       } else {
         Writer.write<uint32_t>(0);
       }
+
+      // Write the filter.
+      uint32_t NumFilterWords =
+          OnDiskHashTableFilter::getNumWords(KeyHashes.size());
+      std::vector<uint32_t> Filter(NumFilterWords);
+      for (auto Hash : KeyHashes)
+        OnDiskHashTableFilter::forEachBit(Hash, NumFilterWords,
+                                          [&](uint32_t Bit) {
+          Filter[Bit / 32] |= 1u << (Bit % 32);
+        });
+      Writer.write<uint32_t>(NumFilterWords);
+      for (uint32_t Word : Filter)
+        Writer.write<uint32_t>(Word);
     }
 
     // Write the table itself.
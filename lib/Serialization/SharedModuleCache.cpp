@@ -0,0 +1,104 @@
+//===--- SharedModuleCache.cpp - AST file contents shared by compiles -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements the SharedModuleCache class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Serialization/SharedModuleCache.h"
+#include "clang/Basic/FileManager.h"
+
+using namespace clang;
+using namespace serialization;
+
+namespace {
+/// \brief A buffer referring to cached contents, which it keeps alive.
+class SharedBufferView : public llvm::MemoryBuffer {
+  std::shared_ptr<llvm::MemoryBuffer> Contents;
+
+public:
+  explicit SharedBufferView(std::shared_ptr<llvm::MemoryBuffer> Contents)
+      : Contents(std::move(Contents)) {
+    init(this->Contents->getBufferStart(), this->Contents->getBufferEnd(),
+         /*RequiresNullTerminator=*/false);
+  }
+
+  BufferKind getBufferKind() const override {
+    return Contents->getBufferKind();
+  }
+};
+} // end anonymous namespace
+
+std::unique_ptr<llvm::MemoryBuffer>
+SharedModuleCache::lookup(const FileEntry *File) {
+  std::shared_ptr<llvm::MemoryBuffer> Contents;
+  {
+    std::lock_guard<std::mutex> Lock(Mutex);
+    auto Known = Entries.find(File->getName());
+    if (Known != Entries.end() &&
+        Known->second.Buffer->getBufferSize() == uint64_t(File->getSize())) {
+      Contents = Known->second.Buffer;
+      Known->second.LastUse = ++UseCount;
+    }
+  }
+
+  // Compare the contents without holding the lock; mapping the file does not
+  // copy it.
+  bool Matches = false;
+  if (Contents) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> OnDisk =
+        llvm::MemoryBuffer::getFile(File->getName(), /*FileSize=*/-1,
+                                    /*RequiresNullTerminator=*/false);
+    Matches = OnDisk && (*OnDisk)->getBuffer() == Contents->getBuffer();
+  }
+
+  std::lock_guard<std::mutex> Lock(Mutex);
+  if (!Matches) {
+    ++NumMisses;
+    return nullptr;
+  }
+  ++NumHits;
+  return llvm::make_unique<SharedBufferView>(std::move(Contents));
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+SharedModuleCache::insert(const FileEntry *File,
+                          std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  std::shared_ptr<llvm::MemoryBuffer> Contents(std::move(Buffer));
+  std::lock_guard<std::mutex> Lock(Mutex);
+  Entry &E = Entries[File->getName()];
+  if (E.Buffer)
+    Size -= E.Buffer->getBufferSize();
+  E.Buffer = Contents;
+  E.LastUse = ++UseCount;
+  Size += Contents->getBufferSize();
+  evict();
+  return llvm::make_unique<SharedBufferView>(std::move(Contents));
+}
+
+void SharedModuleCache::evict() {
+  while (Size > MaxSize && !Entries.empty()) {
+    auto Oldest = Entries.begin();
+    for (auto I = Entries.begin(), E = Entries.end(); I != E; ++I)
+      if (I->second.LastUse < Oldest->second.LastUse)
+        Oldest = I;
+    Size -= Oldest->second.Buffer->getBufferSize();
+    Entries.erase(Oldest);
+  }
+}
+
+unsigned SharedModuleCache::getNumHits() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return NumHits;
+}
+
+unsigned SharedModuleCache::getNumMisses() {
+  std::lock_guard<std::mutex> Lock(Mutex);
+  return NumMisses;
+}
@@ -45,6 +45,7 @@ class CheckerDocumentation : public Checker< check::PreStmt<ReturnStmt>,
                                        check::Location,
                                        check::Bind,
                                        check::DeadSymbols,
+                                       check::ExactDeadSymbols,
                                        check::EndFunction,
                                        check::EndAnalysis,
                                        check::EndOfTranslationUnit,
@@ -162,6 +163,18 @@ public:
   /// check::DeadSymbols
   void checkDeadSymbols(SymbolReaper &SR, CheckerContext &C) const {}
 
+  /// \brief Called to determine if the checker needs the symbols of the
+  /// given state to be collected right after the statement they die at.
+  ///
+  /// With the 'purge-interval' analyzer option, the analyzer core only
+  /// collects dead symbols every few statements within a basic block. A
+  /// checker that reports on symbol death, such as a leak checker, should
+  /// return \c true while it tracks any symbol, so that its diagnostics keep
+  /// pointing at the exact statement.
+  ///
+  /// check::ExactDeadSymbols
+  bool wantsExactDeadSymbols(ProgramStateRef St) const { return true; }
+
 
   /// \brief Called when the analyzer core starts analyzing a function,
   /// regardless of whether it is analyzed at the top level or is inlined.
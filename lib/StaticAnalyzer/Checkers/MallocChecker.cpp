@@ -156,6 +156,7 @@ struct ReallocPair {
 typedef std::pair<const ExplodedNode*, const MemRegion*> LeakInfo;
 
 class MallocChecker : public Checker<check::DeadSymbols,
+                                     check::ExactDeadSymbols,
                                      check::PointerEscape,
                                      check::ConstPointerEscape,
                                      check::PreStmt<ReturnStmt>,
@@ -205,6 +206,7 @@ public:
   void checkPostObjCMessage(const ObjCMethodCall &Call, CheckerContext &C) const;
   void checkPostStmt(const BlockExpr *BE, CheckerContext &C) const;
   void checkDeadSymbols(SymbolReaper &SymReaper, CheckerContext &C) const;
+  bool wantsExactDeadSymbols(ProgramStateRef State) const;
   void checkPreStmt(const ReturnStmt *S, CheckerContext &C) const;
   ProgramStateRef evalAssume(ProgramStateRef state, SVal Cond,
                             bool Assumption) const;
@@ -2123,6 +2125,11 @@ void MallocChecker::reportLeak(SymbolRef Sym, ExplodedNode *N,
   C.emitReport(std::move(R));
 }
 
+bool MallocChecker::wantsExactDeadSymbols(ProgramStateRef State) const {
+  // Leaks are reported where the memory dies.
+  return !State->get<RegionState>().isEmpty();
+}
+
 void MallocChecker::checkDeadSymbols(SymbolReaper &SymReaper,
                                      CheckerContext &C) const
 {
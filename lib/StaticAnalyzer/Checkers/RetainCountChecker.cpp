@@ -2462,6 +2462,7 @@ namespace {
 class RetainCountChecker
   : public Checker< check::Bind,
                     check::DeadSymbols,
+                    check::ExactDeadSymbols,
                     check::EndAnalysis,
                     check::EndFunction,
                     check::PostStmt<BlockExpr>,
@@ -2652,6 +2653,11 @@ public:
   void checkDeadSymbols(SymbolReaper &SymReaper, CheckerContext &C) const;
   void checkEndFunction(CheckerContext &C) const;
 
+  bool wantsExactDeadSymbols(ProgramStateRef state) const {
+    // Leaks are reported where the last reference dies.
+    return !state->get<RefBindings>().isEmpty();
+  }
+
   ProgramStateRef updateSymbol(ProgramStateRef state, SymbolRef sym,
                                RefVal V, ArgEffect E, RefVal::Kind &hasErr,
                                CheckerContext &C) const;
@@ -51,6 +51,7 @@ public:
 class SimpleStreamChecker : public Checker<check::PostCall,
                                            check::PreCall,
                                            check::DeadSymbols,
+                                           check::ExactDeadSymbols,
                                            check::PointerEscape> {
   CallDescription OpenFn, CloseFn;
 
@@ -76,6 +77,9 @@ public:
 
   void checkDeadSymbols(SymbolReaper &SymReaper, CheckerContext &C) const;
 
+  /// Report leaked streams right where they die.
+  bool wantsExactDeadSymbols(ProgramStateRef State) const;
+
   /// Stop tracking addresses which escape.
   ProgramStateRef checkPointerEscape(ProgramStateRef State,
                                     const InvalidatedSymbols &Escaped,
@@ -172,6 +176,10 @@ static bool isLeaked(SymbolRef Sym, const StreamState &SS,
   return false;
 }
 
+bool SimpleStreamChecker::wantsExactDeadSymbols(ProgramStateRef State) const {
+  return !State->get<StreamMap>().isEmpty();
+}
+
 void SimpleStreamChecker::checkDeadSymbols(SymbolReaper &SymReaper,
                                            CheckerContext &C) const {
   ProgramStateRef State = C.getState();
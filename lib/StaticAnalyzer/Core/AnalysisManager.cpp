@@ -36,6 +36,7 @@ AnalysisManager::AnalysisManager(ASTContext &ctx, DiagnosticsEngine &diags,
     PathConsumers(PDC),
     CreateStoreMgr(storemgr), CreateConstraintMgr(constraintmgr),
     CheckerMgr(checkerMgr),
+    PersistentSummaries(ctx),
     options(Options) {
   AnaCtxMgr.getCFGBuildOptions().setAllAlwaysAdd();
 }
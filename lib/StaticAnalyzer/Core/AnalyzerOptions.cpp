@@ -69,6 +69,24 @@ IPAKind AnalyzerOptions::getIPAMode() {
   return IPAMode;
 }
 
+ExplorationStrategyKind AnalyzerOptions::getExplorationStrategy() {
+  if (ExplorationStrategy == ESK_NotSet) {
+    StringRef StrategyStr =
+        Config.insert(std::make_pair("exploration_strategy", "dfs"))
+            .first->second;
+    ExplorationStrategy = llvm::StringSwitch<ExplorationStrategyKind>(
+                              StrategyStr)
+        .Case("dfs", ESK_DFS)
+        .Case("bfs", ESK_BFS)
+        .Case("bfs_block_dfs_contents", ESK_BFSBlockDFSContents)
+        .Case("unexplored_first", ESK_UnexploredFirst)
+        .Default(ESK_NotSet);
+    assert(ExplorationStrategy != ESK_NotSet &&
+           "Exploration strategy is invalid.");
+  }
+  return ExplorationStrategy;
+}
+
 bool
 AnalyzerOptions::mayInlineCXXMemberFunction(CXXInlineableMemberKind K) {
   if (getIPAMode() < IPAK_Inlining)
@@ -289,12 +307,42 @@ unsigned AnalyzerOptions::getGraphTrimInterval() {
   return GraphTrimInterval.getValue();
 }
 
+unsigned AnalyzerOptions::getPurgeInterval() {
+  if (!PurgeInterval.hasValue())
+    PurgeInterval = getOptionAsInteger("purge-interval", 1);
+  return PurgeInterval.getValue();
+}
+
+bool AnalyzerOptions::shouldReclaimNodesAggressively() {
+  return getBooleanOption(AggressiveGraphReclamation,
+                          "aggressive-graph-reclamation",
+                          /*Default=*/false);
+}
+
+unsigned AnalyzerOptions::getMaxMemoryPerTopLevelFunction() {
+  if (!MaxMemoryPerTopLevelFunction.hasValue())
+    MaxMemoryPerTopLevelFunction = getOptionAsInteger("max-memory-mb", 0);
+  return MaxMemoryPerTopLevelFunction.getValue();
+}
+
+unsigned AnalyzerOptions::getMaxReportsPerBugClass() {
+  if (!MaxReportsPerBugClass.hasValue())
+    MaxReportsPerBugClass = getOptionAsInteger("max-reports-per-bug-class", 0);
+  return MaxReportsPerBugClass.getValue();
+}
+
 unsigned AnalyzerOptions::getMaxTimesInlineLarge() {
   if (!MaxTimesInlineLarge.hasValue())
     MaxTimesInlineLarge = getOptionAsInteger("max-times-inline-large", 32);
   return MaxTimesInlineLarge.getValue();
 }
 
+unsigned AnalyzerOptions::getMaxCachedDeclContexts() {
+  if (!MaxCachedDeclContexts.hasValue())
+    MaxCachedDeclContexts = getOptionAsInteger("max-cached-decl-contexts", 256);
+  return MaxCachedDeclContexts.getValue();
+}
+
 unsigned AnalyzerOptions::getMinCFGSizeTreatFunctionsAsLarge() {
   if (!MinCFGSizeTreatFunctionsAsLarge.hasValue())
     MinCFGSizeTreatFunctionsAsLarge = getOptionAsInteger(
@@ -344,3 +392,37 @@ bool AnalyzerOptions::shouldWidenLoops() {
     WidenLoops = getBooleanOption("widen-loops", /*Default=*/false);
   return WidenLoops.getValue();
 }
+
+unsigned AnalyzerOptions::getAnalysisShardCount() {
+  if (!AnalysisShardCount.hasValue()) {
+    int Count = getOptionAsInteger("shard-count", 1);
+    AnalysisShardCount = Count > 0 ? Count : 1;
+  }
+  return AnalysisShardCount.getValue();
+}
+
+StringRef AnalyzerOptions::getFunctionSummariesInput() {
+  return getOptionAsString("function-summaries-input", "");
+}
+
+StringRef AnalyzerOptions::getFunctionSummariesOutput() {
+  return getOptionAsString("function-summaries-output", "");
+}
+
+StringRef AnalyzerOptions::getIncrementalAnalysisState() {
+  return getOptionAsString("incremental-analysis-state", "");
+}
+
+StringRef AnalyzerOptions::getProfileOutput() {
+  return getOptionAsString("profile-output", "");
+}
+
+StringRef AnalyzerOptions::getProfileFormat() {
+  return getOptionAsString("profile-format", "json");
+}
+
+unsigned AnalyzerOptions::getAnalysisShardIndex() {
+  if (!AnalysisShardIndex.hasValue())
+    AnalysisShardIndex = getOptionAsInteger("shard-index", 0);
+  return AnalysisShardIndex.getValue();
+}
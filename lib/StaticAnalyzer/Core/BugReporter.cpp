@@ -32,6 +32,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/raw_ostream.h"
+#include <limits>
 #include <memory>
 #include <queue>
 
@@ -3226,6 +3227,10 @@ void BugReporter::emitReport(std::unique_ptr<BugReport> R) {
     assert((E->isSink() || E->getLocation().getTag()) &&
             "Error node must either be a sink or have a tag");
 
+    // Node reclamation must keep the path to the error node.
+    if (GRBugReporter *GR = dyn_cast<GRBugReporter>(this))
+      GR->getGraph().addErrorNode(E);
+
     const AnalysisDeclContext *DeclCtx =
         E->getLocationContext()->getAnalysisDeclContext();
     // The source of autosynthesized body can be handcrafted AST or a model
@@ -3279,12 +3284,17 @@ struct FRIEC_WLItem {
 
 static BugReport *
 FindReportInEquivalenceClass(BugReportEquivClass& EQ,
-                             SmallVectorImpl<BugReport*> &bugReports) {
+                             SmallVectorImpl<BugReport*> &bugReports,
+                             unsigned MaxReports) {
 
   BugReportEquivClass::iterator I = EQ.begin(), E = EQ.end();
   assert(I != E);
   BugType& BT = I->getBugType();
 
+  // A limit of 0 examines every report in the class.
+  if (MaxReports == 0)
+    MaxReports = std::numeric_limits<unsigned>::max();
+
   // If we don't need to suppress any of the nodes because they are
   // post-dominated by a sink, simply add all the nodes in the equivalence class
   // to 'Nodes'.  Any of the reports will serve as a "representative" report.
@@ -3295,6 +3305,8 @@ FindReportInEquivalenceClass(BugReportEquivClass& EQ,
       if (N) {
         R = &*I;
         bugReports.push_back(R);
+        if (bugReports.size() == MaxReports)
+          break;
       }
     }
     return R;
@@ -3306,9 +3318,16 @@ FindReportInEquivalenceClass(BugReportEquivClass& EQ,
   // DFS traversal of the ExplodedGraph to find a non-sink node.  We could write
   // this as a recursive function, but we don't want to risk blowing out the
   // stack for very long paths.
+  //
+  // Reports in the same class usually share most of their successors, so the
+  // visited marks are kept across reports: a node that was explored without
+  // reaching a non-sink end is never explored again, and a node that was on
+  // the DFS stack when such an end was found is known to reach one.
+  enum { Unvisited = 0, Explored, ReachesEnd };
+  llvm::DenseMap<const ExplodedNode *, unsigned> Visited;
   BugReport *exampleReport = nullptr;
 
-  for (; I != E; ++I) {
+  for (; I != E && bugReports.size() != MaxReports; ++I) {
     const ExplodedNode *errorNode = I->getErrorNode();
 
     if (!errorNode)
@@ -3318,37 +3337,38 @@ FindReportInEquivalenceClass(BugReportEquivClass& EQ,
            "BugType::isSuppressSink() should not be 'true' for sink end nodes");
     }
     // No successors?  By definition this nodes isn't post-dominated by a sink.
-    if (errorNode->succ_empty()) {
+    // Likewise if an earlier search already went through this node.
+    unsigned &errorMark = Visited[errorNode];
+    if (errorNode->succ_empty() || errorMark == ReachesEnd) {
       bugReports.push_back(&*I);
       if (!exampleReport)
         exampleReport = &*I;
       continue;
     }
+    if (errorMark == Explored)
+      continue;
 
     // At this point we know that 'N' is not a sink and it has at least one
     // successor.  Use a DFS worklist to find a non-sink end-of-path node.
     typedef FRIEC_WLItem WLItem;
     typedef SmallVector<WLItem, 10> DFSWorkList;
-    llvm::DenseMap<const ExplodedNode *, unsigned> Visited;
 
     DFSWorkList WL;
     WL.push_back(errorNode);
-    Visited[errorNode] = 1;
+    errorMark = Explored;
 
     while (!WL.empty()) {
       WLItem &WI = WL.back();
       assert(!WI.N->succ_empty());
 
+      bool FoundEnd = false;
       for (; WI.I != WI.E; ++WI.I) {
         const ExplodedNode *Succ = *WI.I;
         // End-of-path node?
         if (Succ->succ_empty()) {
           // If we found an end-of-path node that is not a sink.
           if (!Succ->isSink()) {
-            bugReports.push_back(&*I);
-            if (!exampleReport)
-              exampleReport = &*I;
-            WL.clear();
+            FoundEnd = true;
             break;
           }
           // Found a sink?  Continue on to the next successor.
@@ -3357,16 +3377,28 @@ FindReportInEquivalenceClass(BugReportEquivClass& EQ,
         // Mark the successor as visited.  If it hasn't been explored,
         // enqueue it to the DFS worklist.
         unsigned &mark = Visited[Succ];
-        if (!mark) {
-          mark = 1;
+        if (mark == ReachesEnd) {
+          FoundEnd = true;
+          break;
+        }
+        if (mark == Unvisited) {
+          mark = Explored;
           WL.push_back(Succ);
           break;
         }
       }
 
-      // The worklist may have been cleared at this point.  First
-      // check if it is empty before checking the last item.
-      if (!WL.empty() && &WL.back() == &WI)
+      if (FoundEnd) {
+        for (const WLItem &Item : WL)
+          Visited[Item.N] = ReachesEnd;
+        bugReports.push_back(&*I);
+        if (!exampleReport)
+          exampleReport = &*I;
+        WL.clear();
+        break;
+      }
+
+      if (&WL.back() == &WI)
         WL.pop_back();
     }
   }
@@ -3378,7 +3410,8 @@ FindReportInEquivalenceClass(BugReportEquivClass& EQ,
 
 void BugReporter::FlushReport(BugReportEquivClass& EQ) {
   SmallVector<BugReport*, 10> bugReports;
-  BugReport *exampleReport = FindReportInEquivalenceClass(EQ, bugReports);
+  BugReport *exampleReport = FindReportInEquivalenceClass(
+      EQ, bugReports, getAnalyzerOptions().getMaxReportsPerBugClass());
   if (exampleReport) {
     for (PathDiagnosticConsumer *PDC : getPathDiagnosticConsumers()) {
       FlushReport(exampleReport, *PDC, bugReports);
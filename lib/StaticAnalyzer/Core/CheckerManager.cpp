@@ -17,10 +17,43 @@
 #include "clang/StaticAnalyzer/Core/Checker.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CallEvent.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/CheckerContext.h"
+#include <chrono>
 
 using namespace clang;
 using namespace ento;
 
+namespace {
+/// \brief Adds the time spent in a checker callback to its profile, when the
+/// checker manager is profiling.
+class ProfileScope {
+  CheckerManager &Mgr;
+  const CheckerBase *Checker;
+  const char *Callback;
+  std::chrono::steady_clock::time_point Start;
+
+public:
+  ProfileScope(CheckerManager &Mgr, const CheckerBase *Checker,
+               const char *Callback)
+      : Mgr(Mgr), Checker(Checker), Callback(Callback) {
+    if (Mgr.isProfiling())
+      Start = std::chrono::steady_clock::now();
+  }
+
+  ~ProfileScope() {
+    if (!Mgr.isProfiling())
+      return;
+    std::chrono::duration<double> Elapsed =
+        std::chrono::steady_clock::now() - Start;
+    // The callback may have run others, which may have grown the map; only
+    // look the profile up now.
+    CheckerManager::CallbackProfile &Profile =
+        Mgr.getCallbackProfile(Checker, Callback);
+    Profile.Seconds += Elapsed.count();
+    ++Profile.Calls;
+  }
+};
+}
+
 bool CheckerManager::hasPathSensitiveCheckers() const {
   return !StmtCheckers.empty()              ||
          !PreObjCMessageCheckers.empty()    ||
@@ -74,16 +107,20 @@ void CheckerManager::runCheckersOnASTDecl(const Decl *D, AnalysisManager& mgr,
 
   assert(checkers);
   for (CachedDeclCheckers::iterator
-         I = checkers->begin(), E = checkers->end(); I != E; ++I)
+         I = checkers->begin(), E = checkers->end(); I != E; ++I) {
+    ProfileScope Scope(*this, I->Checker, "ASTDecl");
     (*I)(D, mgr, BR);
+  }
 }
 
 void CheckerManager::runCheckersOnASTBody(const Decl *D, AnalysisManager& mgr,
                                           BugReporter &BR) {
   assert(D && D->hasBody());
 
-  for (unsigned i = 0, e = BodyCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = BodyCheckers.size(); i != e; ++i) {
+    ProfileScope Scope(*this, BodyCheckers[i].Checker, "ASTCodeBody");
     BodyCheckers[i](D, mgr, BR);
+  }
 }
 
 //===----------------------------------------------------------------------===//
@@ -120,6 +157,8 @@ static void expandGraphWithCheckers(CHECK_CTX checkCtx,
     NodeBuilder B(*PrevSet, *CurrSet, BldrCtx);
     for (ExplodedNodeSet::iterator NI = PrevSet->begin(), NE = PrevSet->end();
          NI != NE; ++NI) {
+      ProfileScope Scope(checkCtx.Eng.getCheckerManager(), I->Checker,
+                         checkCtx.getCallbackName());
       checkCtx.runChecker(*I, B, *NI);
     }
 
@@ -149,6 +188,10 @@ namespace {
       : IsPreVisit(isPreVisit), Checkers(checkers), S(s), Eng(eng),
         WasInlined(wasInlined) {}
 
+    const char *getCallbackName() const {
+      return IsPreVisit ? "PreStmt" : "PostStmt";
+    }
+
     void runChecker(CheckerManager::CheckStmtFunc checkFn,
                     NodeBuilder &Bldr, ExplodedNode *Pred) {
       // FIXME: Remove respondsToCallback from CheckerContext;
@@ -194,6 +237,18 @@ namespace {
       : Kind(visitKind), WasInlined(wasInlined), Checkers(checkers),
         Msg(msg), Eng(eng) { }
 
+    const char *getCallbackName() const {
+      switch (Kind) {
+      case ObjCMessageVisitKind::Pre:
+        return "PreObjCMessage";
+      case ObjCMessageVisitKind::Post:
+        return "PostObjCMessage";
+      case ObjCMessageVisitKind::MessageNil:
+        return "ObjCMessageNil";
+      }
+      llvm_unreachable("Unknown Kind");
+    }
+
     void runChecker(CheckerManager::CheckObjCMessageFunc checkFn,
                     NodeBuilder &Bldr, ExplodedNode *Pred) {
 
@@ -261,6 +316,10 @@ namespace {
     : IsPreVisit(isPreVisit), WasInlined(wasInlined), Checkers(checkers),
       Call(call), Eng(eng) { }
 
+    const char *getCallbackName() const {
+      return IsPreVisit ? "PreCall" : "PostCall";
+    }
+
     void runChecker(CheckerManager::CheckCallFunc checkFn,
                     NodeBuilder &Bldr, ExplodedNode *Pred) {
       const ProgramPoint &L = Call.getProgramPoint(IsPreVisit,checkFn.Checker);
@@ -305,6 +364,8 @@ namespace {
       : Checkers(checkers), Loc(loc), IsLoad(isLoad), NodeEx(NodeEx),
         BoundEx(BoundEx), Eng(eng) {}
 
+    const char *getCallbackName() const { return "Location"; }
+
     void runChecker(CheckerManager::CheckLocationFunc checkFn,
                     NodeBuilder &Bldr, ExplodedNode *Pred) {
       ProgramPoint::Kind K =  IsLoad ? ProgramPoint::PreLoadKind :
@@ -350,6 +411,8 @@ namespace {
                      const ProgramPoint &pp)
       : Checkers(checkers), Loc(loc), Val(val), S(s), Eng(eng), PP(pp) {}
 
+    const char *getCallbackName() const { return "Bind"; }
+
     void runChecker(CheckerManager::CheckBindFunc checkFn,
                     NodeBuilder &Bldr, ExplodedNode *Pred) {
       const ProgramPoint &L = PP.withTag(checkFn.Checker);
@@ -373,8 +436,10 @@ void CheckerManager::runCheckersForBind(ExplodedNodeSet &Dst,
 void CheckerManager::runCheckersForEndAnalysis(ExplodedGraph &G,
                                                BugReporter &BR,
                                                ExprEngine &Eng) {
-  for (unsigned i = 0, e = EndAnalysisCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = EndAnalysisCheckers.size(); i != e; ++i) {
+    ProfileScope Scope(*this, EndAnalysisCheckers[i].Checker, "EndAnalysis");
     EndAnalysisCheckers[i](G, BR, Eng);
+  }
 }
 
 namespace {
@@ -391,6 +456,8 @@ struct CheckBeginFunctionContext {
                             const ProgramPoint &PP)
       : Checkers(Checkers), Eng(Eng), PP(PP) {}
 
+  const char *getCallbackName() const { return "BeginFunction"; }
+
   void runChecker(CheckerManager::CheckBeginFunctionFunc checkFn,
                   NodeBuilder &Bldr, ExplodedNode *Pred) {
     const ProgramPoint &L = PP.withTag(checkFn.Checker);
@@ -430,6 +497,7 @@ void CheckerManager::runCheckersForEndFunction(NodeBuilderContext &BC,
                                           Pred->getLocationContext(),
                                           checkFn.Checker);
     CheckerContext C(Bldr, Eng, Pred, L);
+    ProfileScope Scope(*this, checkFn.Checker, "EndFunction");
     checkFn(C);
   }
 }
@@ -448,6 +516,8 @@ namespace {
                                 const Stmt *Cond, ExprEngine &eng)
       : Checkers(checkers), Condition(Cond), Eng(eng) {}
 
+    const char *getCallbackName() const { return "BranchCondition"; }
+
     void runChecker(CheckerManager::CheckBranchConditionFunc checkFn,
                     NodeBuilder &Bldr, ExplodedNode *Pred) {
       ProgramPoint L = PostCondition(Condition, Pred->getLocationContext(),
@@ -472,8 +542,10 @@ void CheckerManager::runCheckersForBranchCondition(const Stmt *Condition,
 /// \brief Run checkers for live symbols.
 void CheckerManager::runCheckersForLiveSymbols(ProgramStateRef state,
                                                SymbolReaper &SymReaper) {
-  for (unsigned i = 0, e = LiveSymbolsCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = LiveSymbolsCheckers.size(); i != e; ++i) {
+    ProfileScope Scope(*this, LiveSymbolsCheckers[i].Checker, "LiveSymbols");
     LiveSymbolsCheckers[i](state, SymReaper);
+  }
 }
 
 namespace {
@@ -493,6 +565,8 @@ namespace {
                             ProgramPoint::Kind K)
       : Checkers(checkers), SR(sr), S(s), Eng(eng), ProgarmPointKind(K) { }
 
+    const char *getCallbackName() const { return "DeadSymbols"; }
+
     void runChecker(CheckerManager::CheckDeadSymbolsFunc checkFn,
                     NodeBuilder &Bldr, ExplodedNode *Pred) {
       const ProgramPoint &L = ProgramPoint::getProgramPoint(S, ProgarmPointKind,
@@ -518,6 +592,15 @@ void CheckerManager::runCheckersForDeadSymbols(ExplodedNodeSet &Dst,
   expandGraphWithCheckers(C, Dst, Src);
 }
 
+/// \brief True if at least one checker needs exact dead symbols.
+bool CheckerManager::wantsExactDeadSymbols(ProgramStateRef state) {
+  for (unsigned i = 0, e = ExactDeadSymbolsCheckers.size(); i != e; ++i)
+    if (ExactDeadSymbolsCheckers[i](state))
+      return true;
+
+  return false;
+}
+
 /// \brief True if at least one checker wants to check region changes.
 bool CheckerManager::wantsRegionChangeUpdate(ProgramStateRef state) {
   for (unsigned i = 0, e = RegionChangesCheckers.size(); i != e; ++i)
@@ -539,6 +622,8 @@ CheckerManager::runCheckersForRegionChanges(ProgramStateRef state,
     // bail out.
     if (!state)
       return nullptr;
+    ProfileScope Scope(*this, RegionChangesCheckers[i].CheckFn.Checker,
+                       "RegionChanges");
     state = RegionChangesCheckers[i].CheckFn(state, invalidated,
                                              ExplicitRegions, Regions, Call);
   }
@@ -561,6 +646,8 @@ CheckerManager::runCheckersForPointerEscape(ProgramStateRef State,
       //  way), bail out.
       if (!State)
         return nullptr;
+      ProfileScope Scope(*this, PointerEscapeCheckers[i].Checker,
+                         "PointerEscape");
       State = PointerEscapeCheckers[i](State, Escaped, Call, Kind, ETraits);
     }
   return State;
@@ -575,6 +662,7 @@ CheckerManager::runCheckersForEvalAssume(ProgramStateRef state,
     // bail out.
     if (!state)
       return nullptr;
+    ProfileScope Scope(*this, EvalAssumeCheckers[i].Checker, "EvalAssume");
     state = EvalAssumeCheckers[i](state, Cond, Assumption);
   }
   return state;
@@ -607,6 +695,7 @@ void CheckerManager::runCheckersForEvalCall(ExplodedNodeSet &Dst,
         // destruction, so introduce the scope to make sure it gets properly
         // populated.
         CheckerContext C(B, Eng, Pred, L);
+        ProfileScope Scope(*this, EI->Checker, "EvalCall");
         evaluated = (*EI)(CE, C);
       }
       assert(!(evaluated && anyEvaluated)
@@ -633,8 +722,11 @@ void CheckerManager::runCheckersOnEndOfTranslationUnit(
                                                   const TranslationUnitDecl *TU,
                                                   AnalysisManager &mgr,
                                                   BugReporter &BR) {
-  for (unsigned i = 0, e = EndOfTranslationUnitCheckers.size(); i != e; ++i)
+  for (unsigned i = 0, e = EndOfTranslationUnitCheckers.size(); i != e; ++i) {
+    ProfileScope Scope(*this, EndOfTranslationUnitCheckers[i].Checker,
+                       "EndOfTranslationUnit");
     EndOfTranslationUnitCheckers[i](TU, mgr, BR);
+  }
 }
 
 void CheckerManager::runCheckersForPrintState(raw_ostream &Out,
@@ -726,6 +818,11 @@ void CheckerManager::_registerForDeadSymbols(CheckDeadSymbolsFunc checkfn) {
   DeadSymbolsCheckers.push_back(checkfn);
 }
 
+void CheckerManager::_registerForExactDeadSymbols(
+                                         WantsExactDeadSymbolsFunc checkfn) {
+  ExactDeadSymbolsCheckers.push_back(checkfn);
+}
+
 void CheckerManager::_registerForRegionChanges(CheckRegionChangesFunc checkfn,
                                      WantsRegionChangeUpdateFunc wantUpdateFn) {
   RegionChangesCheckerInfo info = {checkfn, wantUpdateFn};
@@ -16,9 +16,11 @@
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/StmtCXX.h"
+#include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/AnalysisManager.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ExprEngine.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Support/Casting.h"
 
@@ -31,6 +33,8 @@ STATISTIC(NumSteps,
             "The # of steps executed.");
 STATISTIC(NumReachedMaxSteps,
             "The # of times we reached the max number of steps.");
+STATISTIC(NumReachedMemoryLimit,
+            "The # of times we reached the memory limit.");
 STATISTIC(NumPathsExplored,
             "The # of paths explored by the analyzer.");
 
@@ -157,10 +161,90 @@ WorkList* WorkList::makeBFSBlockDFSContents() {
   return new BFSBlockDFSContents();
 }
 
+namespace {
+  /// Explores depth-first, but first of all the nodes that enter a block not
+  /// yet reached in their stack frame, so that a limited node budget is spent
+  /// on covering the CFG rather than on re-exploring blocks that other paths
+  /// have already reached.
+  class UnexploredFirstStack : public WorkList {
+    typedef std::pair<const CFGBlock *, const StackFrameContext *>
+        BlockIdentifier;
+    llvm::DenseSet<BlockIdentifier> Reached;
+    SmallVector<WorkListUnit, 20> StackUnexplored;
+    SmallVector<WorkListUnit, 20> StackOthers;
+
+  public:
+    bool hasWork() const override {
+      return !StackUnexplored.empty() || !StackOthers.empty();
+    }
+
+    void enqueue(const WorkListUnit &U) override {
+      const ExplodedNode *N = U.getNode();
+      Optional<BlockEntrance> BE = N->getLocation().getAs<BlockEntrance>();
+      if (!BE) {
+        // The nodes within a block follow the priority of its entrance.
+        StackUnexplored.push_back(U);
+        return;
+      }
+      BlockIdentifier Id(BE->getBlock(),
+                         N->getLocationContext()->getCurrentStackFrame());
+      if (Reached.insert(Id).second)
+        StackUnexplored.push_back(U);
+      else
+        StackOthers.push_back(U);
+    }
+
+    WorkListUnit dequeue() override {
+      SmallVectorImpl<WorkListUnit> &Stack =
+          StackUnexplored.empty() ? StackOthers : StackUnexplored;
+      assert(!Stack.empty());
+      WorkListUnit U = Stack.back();
+      Stack.pop_back();
+      return U;
+    }
+
+    bool visitItemsInWorkList(Visitor &V) override {
+      for (const WorkListUnit &U : StackUnexplored)
+        if (V.visit(U))
+          return true;
+      for (const WorkListUnit &U : StackOthers)
+        if (V.visit(U))
+          return true;
+      return false;
+    }
+  };
+} // end anonymous namespace
+
+WorkList *WorkList::makeUnexploredFirst() {
+  return new UnexploredFirstStack();
+}
+
 //===----------------------------------------------------------------------===//
 // Core analysis engine.
 //===----------------------------------------------------------------------===//
 
+static WorkList *generateWorkList(AnalyzerOptions &Opts) {
+  switch (Opts.getExplorationStrategy()) {
+  case ESK_DFS:
+    return WorkList::makeDFS();
+  case ESK_BFS:
+    return WorkList::makeBFS();
+  case ESK_BFSBlockDFSContents:
+    return WorkList::makeBFSBlockDFSContents();
+  case ESK_UnexploredFirst:
+    return WorkList::makeUnexploredFirst();
+  case ESK_NotSet:
+    break;
+  }
+  llvm_unreachable("Unknown AnalyzerOptions::ExplorationStrategy");
+}
+
+CoreEngine::CoreEngine(SubEngine &subengine, FunctionSummariesTy *FS,
+                       AnalyzerOptions &Opts)
+    : SubEng(subengine), WList(generateWorkList(Opts)),
+      BCounterFactory(G.getAllocator()), FunctionSummaries(FS),
+      MemoryLimit(uint64_t(Opts.getMaxMemoryPerTopLevelFunction()) << 20) {}
+
 /// ExecuteWorkList - Run the worklist algorithm for a maximum number of steps.
 bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
                                    ProgramStateRef InitState) {
@@ -214,6 +298,10 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
   if(!UnlimitedSteps)
     G.reserve(std::min(Steps,PreReservationCap));
 
+  // Measuring the allocator walks its slabs, so only do it every so often.
+  const unsigned MemoryCheckInterval = 1024;
+  unsigned StepsUntilMemoryCheck = MemoryCheckInterval;
+
   while (WList->hasWork()) {
     if (!UnlimitedSteps) {
       if (Steps == 0) {
@@ -223,6 +311,17 @@ bool CoreEngine::ExecuteWorkList(const LocationContext *L, unsigned Steps,
       --Steps;
     }
 
+    // The states, regions, symbols and nodes of the analysis all come from
+    // the graph's allocator. Stop exploring, as if we ran out of steps,
+    // rather than outgrow the limit.
+    if (MemoryLimit && --StepsUntilMemoryCheck == 0) {
+      StepsUntilMemoryCheck = MemoryCheckInterval;
+      if (G.getAllocator().getTotalMemory() > MemoryLimit) {
+        NumReachedMemoryLimit++;
+        break;
+      }
+    }
+
     NumSteps++;
 
     const WorkListUnit& WU = WList->dequeue();
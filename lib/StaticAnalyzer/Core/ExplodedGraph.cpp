@@ -48,7 +48,8 @@ void ExplodedNode::SetAuditor(ExplodedNode::Auditor* A) {
 //===----------------------------------------------------------------------===//
 
 ExplodedGraph::ExplodedGraph()
-  : NumNodes(0), ReclaimNodeInterval(0) {}
+  : NumNodes(0), NumCreatedNodes(0), ReclaimNodeInterval(0),
+    AggressiveReclamation(false) {}
 
 ExplodedGraph::~ExplodedGraph() {}
 
@@ -64,6 +65,16 @@ bool ExplodedGraph::isInterestingLValueExpr(const Expr *Ex) {
          isa<ObjCIvarRefExpr>(Ex);
 }
 
+/// Returns true if \p succ starts the evaluation of a call, in which case
+/// its predecessor is where the call would be retried without inlining.
+static bool startsCall(const ExplodedNode *succ) {
+  const ProgramPoint SuccLoc = succ->getLocation();
+  if (Optional<StmtPoint> SP = SuccLoc.getAs<StmtPoint>())
+    if (CallEvent::isCallStmt(SP->getStmt()))
+      return true;
+  return SuccLoc.getAs<CallEnter>() || SuccLoc.getAs<PreImplicitCall>();
+}
+
 bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
   // First, we only consider nodes for reclamation of the following
   // conditions apply:
@@ -149,16 +160,7 @@ bool ExplodedGraph::shouldCollect(const ExplodedNode *node) {
     return false;
 
   // Condition 10.
-  const ProgramPoint SuccLoc = succ->getLocation();
-  if (Optional<StmtPoint> SP = SuccLoc.getAs<StmtPoint>())
-    if (CallEvent::isCallStmt(SP->getStmt()))
-      return false;
-
-  // Condition 10, continuation.
-  if (SuccLoc.getAs<CallEnter>() || SuccLoc.getAs<PreImplicitCall>())
-    return false;
-
-  return true;
+  return !startsCall(succ);
 }
 
 void ExplodedGraph::collectNode(ExplodedNode *node) {
@@ -177,6 +179,38 @@ void ExplodedGraph::collectNode(ExplodedNode *node) {
   node->~ExplodedNode();
 }
 
+/// Returns true if \p node can be unlinked from the path between its only
+/// predecessor and its only successor.
+static bool isLinearPathNode(const ExplodedNode *node) {
+  return node->pred_size() == 1 && node->succ_size() == 1 &&
+         (*node->pred_begin())->succ_size() == 1 &&
+         (*node->succ_begin())->pred_size() == 1;
+}
+
+void ExplodedGraph::collapsePathToSink(ExplodedNode *Sink) {
+  // Walk up from the sink for as long as every node has no other successor,
+  // so that no path from the nodes we visit reaches anything but the sink.
+  // A bug report is never emitted for such a path, which lets us drop the
+  // statement nodes on it regardless of the conditions in shouldCollect().
+  // The sink itself stays, so that BugReporter still finds the paths that
+  // are post-dominated by a sink. Block entrances and edges stay as well, as
+  // checkers use them to find the blocks that were reached, and so do the
+  // nodes where a call would be retried without inlining.
+  if (Sink->pred_size() != 1)
+    return;
+  ExplodedNode *node = *Sink->pred_begin();
+  while (node->succ_size() == 1 && !ErrorNodes.count(node)) {
+    ExplodedNode *pred =
+        node->pred_size() == 1 ? *node->pred_begin() : nullptr;
+    if (node->getLocation().getAs<StmtPoint>() && isLinearPathNode(node) &&
+        !startsCall(*node->succ_begin()))
+      collectNode(node);
+    if (!pred)
+      break;
+    node = pred;
+  }
+}
+
 void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
   if (ChangedNodes.empty())
     return;
@@ -189,13 +223,21 @@ void ExplodedGraph::reclaimRecentlyAllocatedNodes() {
     return;
   ReclaimCounter = ReclaimNodeInterval;
 
+  // Sinks are never collected by shouldCollect(), so they can be visited
+  // after the pass over the recently allocated nodes.
+  NodeVector Sinks;
   for (NodeVector::iterator it = ChangedNodes.begin(), et = ChangedNodes.end();
        it != et; ++it) {
     ExplodedNode *node = *it;
-    if (shouldCollect(node))
+    if (AggressiveReclamation && node->isSink() && !ErrorNodes.count(node))
+      Sinks.push_back(node);
+    else if (shouldCollect(node))
       collectNode(node);
   }
   ChangedNodes.clear();
+
+  for (ExplodedNode *Sink : Sinks)
+    collapsePathToSink(Sink);
 }
 
 //===----------------------------------------------------------------------===//
@@ -327,6 +369,7 @@ ExplodedNode *ExplodedGraph::getNode(const ProgramPoint &L,
     // Insert the node into the node set and return it.
     Nodes.InsertNode(V, InsertPos);
     ++NumNodes;
+    ++NumCreatedNodes;
 
     if (IsNew) *IsNew = true;
   }
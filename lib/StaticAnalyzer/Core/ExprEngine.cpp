@@ -74,7 +74,7 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
                        InliningModes HowToInlineIn)
   : AMgr(mgr),
     AnalysisDeclContexts(mgr.getAnalysisDeclContextManager()),
-    Engine(*this, FS),
+    Engine(*this, FS, mgr.getAnalyzerOptions()),
     G(Engine.getGraph()),
     StateMgr(getContext(), mgr.getStoreManagerCreator(),
              mgr.getConstraintManagerCreator(), G.getAllocator(),
@@ -85,12 +85,14 @@ ExprEngine::ExprEngine(AnalysisManager &mgr, bool gcEnabled,
     ObjCNoRet(mgr.getASTContext()),
     ObjCGCEnabled(gcEnabled), BR(mgr, *this),
     VisitedCallees(VisitedCalleesIn),
-    HowToInline(HowToInlineIn)
+    HowToInline(HowToInlineIn),
+    PurgeInterval(mgr.options.getPurgeInterval())
 {
   unsigned TrimInterval = mgr.options.getGraphTrimInterval();
   if (TrimInterval != 0) {
     // Enable eager node reclaimation when constructing the ExplodedGraph.
-    G.enableNodeReclamation(TrimInterval);
+    G.enableNodeReclamation(TrimInterval,
+                            mgr.options.shouldReclaimNodesAggressively());
   }
 }
 
@@ -313,10 +315,25 @@ void ExprEngine::processCFGElement(const CFGElement E, ExplodedNode *Pred,
   }
 }
 
+/// Returns true if fewer than \p Interval statements were evaluated on the
+/// path leading to \p N since dead symbols were last purged.
+static bool wasPurgedRecently(const ExplodedNode *N, unsigned Interval) {
+  unsigned NumStmts = 0;
+  for (; N && NumStmts < Interval; N = N->getFirstPred()) {
+    ProgramPoint P = N->getLocation();
+    if (P.isPurgeKind() || P.getAs<BlockEntrance>())
+      return true;
+    if (P.getAs<PostStmt>())
+      ++NumStmts;
+  }
+  return false;
+}
+
 static bool shouldRemoveDeadBindings(AnalysisManager &AMgr,
                                      const CFGStmt S,
                                      const ExplodedNode *Pred,
-                                     const LocationContext *LC) {
+                                     const LocationContext *LC,
+                                     unsigned PurgeInterval) {
 
   // Are we never purging state values?
   if (AMgr.options.AnalysisPurgeOpt == PurgeNone)
@@ -326,18 +343,25 @@ static bool shouldRemoveDeadBindings(AnalysisManager &AMgr,
   if (Pred->getLocation().getAs<BlockEntrance>())
     return true;
 
-  // Is this on a non-expression?
-  if (!isa<Expr>(S.getStmt()))
-    return true;
-
   // Run before processing a call.
   if (CallEvent::isCallStmt(S.getStmt()))
     return true;
 
   // Is this an expression that is consumed by another expression?  If so,
   // postpone cleaning out the state.
-  ParentMap &PM = LC->getAnalysisDeclContext()->getParentMap();
-  return !PM.isConsumedExpr(cast<Expr>(S.getStmt()));
+  if (const Expr *E = dyn_cast<Expr>(S.getStmt())) {
+    ParentMap &PM = LC->getAnalysisDeclContext()->getParentMap();
+    if (PM.isConsumedExpr(E))
+      return false;
+  }
+
+  // Within a block, batch the purges unless a checker has to see symbols die
+  // at the exact statement, e.g. to report a leak there.
+  if (PurgeInterval > 1 &&
+      !AMgr.getCheckerManager()->wantsExactDeadSymbols(Pred->getState()))
+    return !wasPurgedRecently(Pred, PurgeInterval);
+
+  return true;
 }
 
 void ExprEngine::removeDead(ExplodedNode *Pred, ExplodedNodeSet &Out,
@@ -434,7 +458,8 @@ void ExprEngine::ProcessStmt(const CFGStmt S,
 
   // Remove dead bindings and symbols.
   ExplodedNodeSet CleanedStates;
-  if (shouldRemoveDeadBindings(AMgr, S, Pred, Pred->getLocationContext())){
+  if (shouldRemoveDeadBindings(AMgr, S, Pred, Pred->getLocationContext(),
+                               PurgeInterval)) {
     removeDead(Pred, CleanedStates, currStmt, Pred->getLocationContext());
   } else
     CleanedStates.Add(Pred);
@@ -1241,6 +1266,12 @@ void ExprEngine::Visit(const Stmt *S, ExplodedNode *Pred,
       Bldr.addNodes(Dst);
       break;
 
+    case Stmt::PackedArrayInitExprClass:
+      Bldr.takeNodes(Pred);
+      VisitPackedArrayInitExpr(cast<PackedArrayInitExpr>(S), Pred, Dst);
+      Bldr.addNodes(Dst);
+      break;
+
     case Stmt::MemberExprClass:
       Bldr.takeNodes(Pred);
       VisitMemberExpr(cast<MemberExpr>(S), Pred, Dst);
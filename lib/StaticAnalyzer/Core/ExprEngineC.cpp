@@ -667,6 +667,26 @@ void ExprEngine::VisitInitListExpr(const InitListExpr *IE,
   B.generateNode(IE, Pred, state->BindExpr(IE, LCtx, V));
 }
 
+void ExprEngine::VisitPackedArrayInitExpr(const PackedArrayInitExpr *PE,
+                                          ExplodedNode *Pred,
+                                          ExplodedNodeSet &Dst) {
+  StmtNodeBuilder B(Pred, Dst, *currBldrCtx);
+
+  // Every value is known, so build the compound value that VisitInitListExpr
+  // would have built from the converted literals.
+  QualType ElementTy = PE->getElementType();
+  llvm::ImmutableList<SVal> Vals = getBasicVals().getEmptySValList();
+  for (unsigned I = PE->getNumElements(); I != 0; --I)
+    Vals = getBasicVals().consVals(
+        svalBuilder.makeIntVal(PE->getElement(I - 1), ElementTy), Vals);
+
+  QualType T = getContext().getCanonicalType(PE->getType());
+  ProgramStateRef State = Pred->getState();
+  B.generateNode(PE, Pred,
+                 State->BindExpr(PE, Pred->getLocationContext(),
+                                 svalBuilder.makeCompoundVal(T, Vals)));
+}
+
 void ExprEngine::VisitGuardedExpr(const Expr *Ex,
                                   const Expr *L,
                                   const Expr *R,
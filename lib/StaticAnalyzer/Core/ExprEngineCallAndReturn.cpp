@@ -557,14 +557,60 @@ ProgramStateRef ExprEngine::bindReturnValue(const CallEvent &Call,
   return State->BindExpr(E, LCtx, R);
 }
 
+/// Returns the function whose summary describes \p Call, which is the
+/// definition that runs, not the statically called declaration. Returns null
+/// when a dynamically dispatched call may run more than one definition.
+static const FunctionDecl *getSummarizedCallee(const CallEvent &Call) {
+  RuntimeDefinition RD = Call.getRuntimeDefinition();
+  if (RD.mayHaveOtherDefinitions())
+    return nullptr;
+  if (const FunctionDecl *Definition =
+          dyn_cast_or_null<FunctionDecl>(RD.getDecl()))
+    return Definition;
+
+  // Without a definition here, only a summary read for a function that is
+  // not overridden can be used.
+  const FunctionDecl *FD = dyn_cast_or_null<FunctionDecl>(Call.getDecl());
+  if (!FD)
+    return nullptr;
+  if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(FD))
+    if (MD->isVirtual())
+      return nullptr;
+  return FD;
+}
+
 // Conservatively evaluate call by invalidating regions and binding
 // a conjured return value.
 void ExprEngine::conservativeEvalCall(const CallEvent &Call, NodeBuilder &Bldr,
                                       ExplodedNode *Pred,
                                       ProgramStateRef State) {
-  State = Call.invalidateRegions(currBldrCtx->blockCount(), State);
+  // With summaries from earlier runs, a callee known not to write anything
+  // its callers can see does not invalidate regions, and the values it
+  // returns are constrained to the recorded range.
+  const PersistentFunctionSummary *Summary = nullptr;
+  if (!AMgr.options.getFunctionSummariesInput().empty())
+    if (const FunctionDecl *FD = getSummarizedCallee(Call))
+      Summary = AMgr.getPersistentSummaries().lookup(FD);
+
+  if (!Summary || !Summary->HasNoSideEffects)
+    State = Call.invalidateRegions(currBldrCtx->blockCount(), State);
   State = bindReturnValue(Call, Pred->getLocationContext(), State);
 
+  QualType ResultTy = Call.getResultType();
+  if (Summary && Summary->HasReturnRange && Call.getOriginExpr() &&
+      ResultTy->isIntegralOrEnumerationType()) {
+    SVal RetVal =
+        State->getSVal(Call.getOriginExpr(), Pred->getLocationContext());
+    if (Optional<DefinedOrUnknownSVal> DV =
+            RetVal.getAs<DefinedOrUnknownSVal>()) {
+      BasicValueFactory &BVF = getBasicVals();
+      if (ProgramStateRef Constrained = State->assumeWithinInclusiveRange(
+              *DV, BVF.getValue(Summary->ReturnMin, ResultTy),
+              BVF.getValue(Summary->ReturnMax, ResultTy), true))
+        State = Constrained;
+    }
+  }
+
   // And make the result node.
   Bldr.generateNode(Call.getProgramPoint(), State, Pred);
 }
@@ -23,6 +23,7 @@
 #include "clang/StaticAnalyzer/Core/CheckerManager.h"
 #include "clang/StaticAnalyzer/Core/IssueHash.h"
 #include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Errc.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -44,6 +45,14 @@ class HTMLDiagnostics : public PathDiagnosticConsumer {
   bool createdDir, noDir;
   const Preprocessor &PP;
   AnalyzerOptions &AnalyzerOpts;
+
+  /// The syntax and macro highlighting of each file with reports, which is
+  /// the same for all of them.
+  llvm::DenseMap<FileID, std::vector<html::HighlightedRange>>
+      HighlightedRanges;
+
+  ArrayRef<html::HighlightedRange> getHighlightedRanges(FileID FID);
+
 public:
   HTMLDiagnostics(AnalyzerOptions &AnalyzerOpts, const std::string& prefix, const Preprocessor &pp);
 
@@ -99,6 +108,20 @@ void HTMLDiagnostics::FlushDiagnosticsImpl(
   }
 }
 
+ArrayRef<html::HighlightedRange>
+HTMLDiagnostics::getHighlightedRanges(FileID FID) {
+  auto Known = HighlightedRanges.find(FID);
+  if (Known != HighlightedRanges.end())
+    return Known->second;
+
+  // Relexing and reexpanding the macros of a file can take longer than its
+  // analysis, so it is only done for its first report.
+  std::vector<html::HighlightedRange> &Ranges = HighlightedRanges[FID];
+  html::ComputeSyntaxHighlighting(FID, PP, Ranges);
+  html::ComputeMacroHighlighting(FID, PP, Ranges);
+  return Ranges;
+}
+
 void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
                                  FilesMade *filesMade) {
 
@@ -170,8 +193,7 @@ void HTMLDiagnostics::ReportDiag(const PathDiagnostic& D,
   // We might not have a preprocessor if we come from a deserialized AST file,
   // for example.
 
-  html::SyntaxHighlight(R, FID, PP);
-  html::HighlightMacros(R, FID, PP);
+  html::ApplyHighlighting(R, FID, getHighlightedRanges(FID));
 
   // Get the full directory name of the analyzed file.
 
@@ -1560,3 +1560,13 @@ bool RegionAndSymbolInvalidationTraits::hasTrait(const MemRegion *MR,
 
   return false;
 }
+
+bool RegionAndSymbolInvalidationTraits::hasRegionWithTrait(
+    InvalidationKinds IK) const {
+  for (const_region_iterator I = MRTraitsMap.begin(), E = MRTraitsMap.end();
+       I != E; ++I)
+    if (I->second & IK)
+      return true;
+
+  return false;
+}
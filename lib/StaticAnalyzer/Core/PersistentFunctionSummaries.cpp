@@ -0,0 +1,393 @@
+//== PersistentFunctionSummaries.cpp - Summaries shared across TUs -*- C++ -*-//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the computation and the on-disk format of the function
+// summaries shared between analyzer runs.
+//
+// Each summary line of the file holds the body hash, whether the function has
+// no side effects visible to its callers, whether its return values have a
+// known range and that range, and finally the summary key:
+//
+//   <hash> <no-side-effects> <has-return-range> <min> <max> <key>
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/StaticAnalyzer/Core/PathSensitive/PersistentFunctionSummaries.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LockFileManager.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace ento;
+
+static const char SummaryFileHeader[] = "# clang analyzer function summaries v1";
+
+std::string PersistentFunctionSummaries::getSummaryKey(const FunctionDecl *FD) {
+  // Only functions with external linkage are the same entity in every
+  // translation unit. Templates are left out, as their instantiations are
+  // not named the same way everywhere.
+  if (!FD->hasExternalFormalLinkage() || FD->isDependentContext() ||
+      FD->getTemplatedKind() != FunctionDecl::TK_NonTemplate)
+    return std::string();
+  if (FD->isExternC())
+    return FD->getNameAsString();
+
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  OS << FD->getQualifiedNameAsString() << '#'
+     << FD->getType().getCanonicalType().getAsString();
+  return OS.str();
+}
+
+/// Returns the MD5 digest of the pretty-printed definition \p FD, which does
+/// not change with the formatting of its source.
+static std::string getBodyHash(const FunctionDecl *FD) {
+  std::string Text;
+  llvm::raw_string_ostream OS(Text);
+  FD->print(OS, FD->getASTContext().getPrintingPolicy());
+  OS.flush();
+
+  llvm::MD5 Hash;
+  Hash.update(Text);
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+  return Digest.str();
+}
+
+/// Returns true if \p E designates a local variable of the function, whose
+/// value its callers cannot see.
+static bool isLocalVariable(const Expr *E) {
+  const DeclRefExpr *DRE = dyn_cast<DeclRefExpr>(E->IgnoreParenImpCasts());
+  if (!DRE)
+    return false;
+  const VarDecl *VD = dyn_cast<VarDecl>(DRE->getDecl());
+  return VD && VD->hasLocalStorage() && !VD->getType()->isReferenceType();
+}
+
+bool PersistentFunctionSummaries::hasNoSideEffects(const FunctionDecl *Callee) {
+  const PersistentFunctionSummary *Summary = lookup(Callee);
+  return Summary && Summary->HasNoSideEffects;
+}
+
+bool PersistentFunctionSummaries::mayHaveSideEffects(const Stmt *S) {
+  if (!S)
+    return false;
+
+  // Anything that is not known to be harmless is assumed to write memory.
+  switch (S->getStmtClass()) {
+  case Stmt::BinaryOperatorClass:
+  case Stmt::CompoundAssignOperatorClass: {
+    const BinaryOperator *BO = cast<BinaryOperator>(S);
+    if (BO->isAssignmentOp() && !isLocalVariable(BO->getLHS()))
+      return true;
+    break;
+  }
+  case Stmt::UnaryOperatorClass: {
+    const UnaryOperator *UO = cast<UnaryOperator>(S);
+    if (UO->isIncrementDecrementOp() && !isLocalVariable(UO->getSubExpr()))
+      return true;
+    break;
+  }
+  case Stmt::CallExprClass:
+  case Stmt::CXXMemberCallExprClass:
+  case Stmt::CXXOperatorCallExprClass: {
+    const FunctionDecl *Callee = cast<CallExpr>(S)->getDirectCallee();
+    if (!Callee || !hasNoSideEffects(Callee))
+      return true;
+    // A virtual call may run any overrider, not just the one named.
+    if (const CXXMethodDecl *MD = dyn_cast<CXXMethodDecl>(Callee)) {
+      const MemberExpr *ME = dyn_cast<MemberExpr>(
+          cast<CallExpr>(S)->getCallee()->IgnoreParens());
+      if (MD->isVirtual() && !(ME && ME->hasQualifier()))
+        return true;
+    }
+    break;
+  }
+  case Stmt::DeclStmtClass:
+    for (const Decl *D : cast<DeclStmt>(S)->decls())
+      if (const VarDecl *VD = dyn_cast<VarDecl>(D))
+        if (!VD->hasLocalStorage())
+          return true;
+    break;
+  case Stmt::CompoundStmtClass:
+  case Stmt::NullStmtClass:
+  case Stmt::IfStmtClass:
+  case Stmt::WhileStmtClass:
+  case Stmt::DoStmtClass:
+  case Stmt::ForStmtClass:
+  case Stmt::SwitchStmtClass:
+  case Stmt::CaseStmtClass:
+  case Stmt::DefaultStmtClass:
+  case Stmt::BreakStmtClass:
+  case Stmt::ContinueStmtClass:
+  case Stmt::ReturnStmtClass:
+  case Stmt::ParenExprClass:
+  case Stmt::ImplicitCastExprClass:
+  case Stmt::CStyleCastExprClass:
+  case Stmt::CXXStaticCastExprClass:
+  case Stmt::CXXFunctionalCastExprClass:
+  case Stmt::IntegerLiteralClass:
+  case Stmt::FloatingLiteralClass:
+  case Stmt::CharacterLiteralClass:
+  case Stmt::StringLiteralClass:
+  case Stmt::CXXBoolLiteralExprClass:
+  case Stmt::CXXNullPtrLiteralExprClass:
+  case Stmt::DeclRefExprClass:
+  case Stmt::MemberExprClass:
+  case Stmt::ArraySubscriptExprClass:
+  case Stmt::ConditionalOperatorClass:
+  case Stmt::UnaryExprOrTypeTraitExprClass:
+  case Stmt::InitListExprClass:
+  case Stmt::PackedArrayInitExprClass:
+  case Stmt::ImplicitValueInitExprClass:
+    break;
+  default:
+    return true;
+  }
+
+  for (const Stmt *Child : S->children())
+    if (mayHaveSideEffects(Child))
+      return true;
+  return false;
+}
+
+/// Computes the range of the values returned by the return statements in
+/// \p S, all of which must be integer constants.
+static bool addReturnRange(const Stmt *S, const ASTContext &Ctx,
+                           PersistentFunctionSummary &Summary) {
+  if (!S)
+    return true;
+  // The return statements of nested functions are not ours.
+  if (isa<LambdaExpr>(S) || isa<BlockExpr>(S))
+    return true;
+
+  if (const ReturnStmt *RS = dyn_cast<ReturnStmt>(S)) {
+    llvm::APSInt Value;
+    const Expr *RetValue = RS->getRetValue();
+    if (!RetValue || !RetValue->EvaluateAsInt(Value, Ctx) ||
+        Value.getMinSignedBits() > 64)
+      return false;
+    int64_t V = Value.getExtValue();
+    if (!Summary.HasReturnRange) {
+      Summary.HasReturnRange = true;
+      Summary.ReturnMin = Summary.ReturnMax = V;
+    } else {
+      Summary.ReturnMin = std::min(Summary.ReturnMin, V);
+      Summary.ReturnMax = std::max(Summary.ReturnMax, V);
+    }
+    return true;
+  }
+
+  for (const Stmt *Child : S->children())
+    if (!addReturnRange(Child, Ctx, Summary))
+      return false;
+  return true;
+}
+
+const PersistentFunctionSummary *
+PersistentFunctionSummaries::summarizeDefinition(const FunctionDecl *FD) {
+  auto Known = Computed.find(FD);
+  if (Known != Computed.end())
+    return Known->second;
+
+  // A recursive call sees no summary, which is the conservative answer.
+  Computed[FD] = nullptr;
+
+  // The summary is always recomputed, even when the stored one has the same
+  // body hash, as the summaries of the callees may have changed.
+  std::string Key = getSummaryKey(FD);
+  if (!Key.empty()) {
+    DefinedKeys.insert(Key);
+    ConflictingKeys.erase(Key);
+  }
+
+  PersistentFunctionSummary Summary;
+  Summary.BodyHash = getBodyHash(FD);
+  // Constructors and destructors write the object they are given.
+  Summary.HasNoSideEffects = !isa<CXXConstructorDecl>(FD) &&
+                             !isa<CXXDestructorDecl>(FD) &&
+                             !mayHaveSideEffects(FD->getBody());
+  if (FD->getReturnType()->isIntegralOrEnumerationType() &&
+      !addReturnRange(FD->getBody(), Ctx, Summary))
+    Summary.HasReturnRange = false;
+
+  const PersistentFunctionSummary *Result;
+  if (!Key.empty()) {
+    PersistentFunctionSummary &Stored = Summaries[Key];
+    Stored = Summary;
+    Result = &Stored;
+  } else {
+    InternalSummaries.push_back(Summary);
+    Result = &InternalSummaries.back();
+  }
+  Computed[FD] = Result;
+  return Result;
+}
+
+const PersistentFunctionSummary *
+PersistentFunctionSummaries::lookup(const FunctionDecl *FD) {
+  const FunctionDecl *Definition = nullptr;
+  if (FD->hasBody(Definition)) {
+    if (Definition->isDependentContext() ||
+        Definition->getTemplatedKind() != FunctionDecl::TK_NonTemplate)
+      return nullptr;
+    return summarizeDefinition(Definition);
+  }
+
+  std::string Key = getSummaryKey(FD);
+  if (Key.empty())
+    return nullptr;
+  llvm::StringMap<PersistentFunctionSummary>::const_iterator I =
+      Summaries.find(Key);
+  return I == Summaries.end() ? nullptr : &I->second;
+}
+
+void PersistentFunctionSummaries::summarizeDefinitions(const DeclContext *DC) {
+  for (const Decl *D : DC->decls()) {
+    if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D))
+      if (FD->doesThisDeclarationHaveABody() && FD->hasBody())
+        lookup(FD);
+    if (const DeclContext *Nested = dyn_cast<DeclContext>(D))
+      if (isa<NamespaceDecl>(Nested) || isa<LinkageSpecDecl>(Nested) ||
+          isa<CXXRecordDecl>(Nested))
+        summarizeDefinitions(Nested);
+  }
+}
+
+/// Reads the summaries stored in \p Path into \p Summaries. Returns false if
+/// the file could not be read or is malformed.
+static bool
+readSummaries(StringRef Path,
+              llvm::StringMap<PersistentFunctionSummary> &Summaries) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return false;
+
+  StringRef Rest = (*Buffer)->getBuffer();
+  while (!Rest.empty()) {
+    StringRef Line;
+    std::tie(Line, Rest) = Rest.split('\n');
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+
+    StringRef Fields[5];
+    for (StringRef &Field : Fields)
+      std::tie(Field, Line) = Line.split(' ');
+    PersistentFunctionSummary Summary;
+    Summary.BodyHash = Fields[0];
+    Summary.HasNoSideEffects = Fields[1] == "1";
+    Summary.HasReturnRange = Fields[2] == "1";
+    if (Line.empty() || Fields[3].getAsInteger(10, Summary.ReturnMin) ||
+        Fields[4].getAsInteger(10, Summary.ReturnMax))
+      return false;
+    Summaries[Line] = Summary;
+  }
+  return true;
+}
+
+bool PersistentFunctionSummaries::readFromFile(StringRef Path) {
+  llvm::StringMap<PersistentFunctionSummary> Read;
+  if (!readSummaries(Path, Read))
+    return false;
+
+  for (const auto &Entry : Read) {
+    StringRef Key = Entry.getKey();
+    // The summaries of our own definitions are recomputed when needed.
+    if (DefinedKeys.count(Key) || ConflictingKeys.count(Key))
+      continue;
+    llvm::StringMap<PersistentFunctionSummary>::iterator Known =
+        Summaries.find(Key);
+    if (Known == Summaries.end()) {
+      Summaries[Key] = Entry.getValue();
+    } else if (Known->second.BodyHash != Entry.getValue().BodyHash) {
+      // The files disagree on the definition; trust neither.
+      Summaries.erase(Known);
+      ConflictingKeys.insert(Key);
+    }
+  }
+  return true;
+}
+
+/// Writes \p Summaries to \p Path. The file is written under a temporary name
+/// and renamed into place, so that readers never see a partial file.
+static bool
+writeSummaries(StringRef Path,
+               const llvm::StringMap<PersistentFunctionSummary> &Summaries) {
+  std::vector<StringRef> Keys;
+  for (const auto &Entry : Summaries)
+    Keys.push_back(Entry.getKey());
+  std::sort(Keys.begin(), Keys.end());
+
+  SmallString<256> TempPath;
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return false;
+
+  bool Failed;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << SummaryFileHeader << '\n';
+    for (StringRef Key : Keys) {
+      const PersistentFunctionSummary &Summary = Summaries.find(Key)->second;
+      OS << Summary.BodyHash << ' ' << Summary.HasNoSideEffects << ' '
+         << Summary.HasReturnRange << ' ' << Summary.ReturnMin << ' '
+         << Summary.ReturnMax << ' ' << Key << '\n';
+    }
+    OS.close();
+    Failed = OS.has_error();
+    OS.clear_error();
+  }
+
+  if (Failed || llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
+
+bool PersistentFunctionSummaries::mergeIntoFile(StringRef Path) const {
+  while (true) {
+    llvm::LockFileManager Locked(Path);
+    switch (Locked) {
+    case llvm::LockFileManager::LFS_Error:
+      return false;
+
+    case llvm::LockFileManager::LFS_Owned: {
+      // Start from what is on disk now, which includes the summaries of runs
+      // that finished since this one read the file.
+      llvm::StringMap<PersistentFunctionSummary> Merged;
+      readSummaries(Path, Merged);
+      for (const auto &Entry : Summaries) {
+        StringRef Key = Entry.getKey();
+        if (DefinedKeys.count(Key) || !Merged.count(Key))
+          Merged[Key] = Entry.getValue();
+      }
+      return writeSummaries(Path, Merged);
+    }
+
+    case llvm::LockFileManager::LFS_Shared:
+      // Another run is merging its summaries. Wait for it, then merge ours
+      // into the result.
+      if (Locked.waitForUnlock() == llvm::LockFileManager::Res_Timeout)
+        Locked.unsafeRemoveLockFile();
+      continue;
+    }
+  }
+}
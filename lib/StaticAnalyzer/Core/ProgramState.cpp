@@ -370,9 +370,20 @@ ProgramStateRef ProgramStateManager::getInitialState(const LocationContext *Init
   return getPersistentState(State);
 }
 
+/// Returns true if \p M1 and \p M2 hold the same data. The GDM factory
+/// canonicalizes its maps, so this is a pointer comparison rather than the
+/// walk of both trees that ImmutableMap::operator== performs.
+static bool haveEqualGDMs(const ProgramState::GenericDataMap &M1,
+                          const ProgramState::GenericDataMap &M2) {
+  return M1.getRootWithoutRetain() == M2.getRootWithoutRetain();
+}
+
 ProgramStateRef ProgramStateManager::getPersistentStateWithGDM(
                                                      ProgramStateRef FromState,
                                                      ProgramStateRef GDMState) {
+  if (haveEqualGDMs(FromState->GDM, GDMState->GDM))
+    return FromState;
+
   ProgramState NewState(*FromState);
   NewState.GDM = GDMState->GDM;
   return getPersistentState(NewState);
@@ -401,6 +412,10 @@ ProgramStateRef ProgramStateManager::getPersistentState(ProgramState &State) {
 }
 
 ProgramStateRef ProgramState::makeWithStore(const StoreRef &store) const {
+  // The new state would be this one; skip the lookup.
+  if (store.getStore() == this->store)
+    return this;
+
   ProgramState NewSt(*this);
   NewSt.setStore(store);
   return getStateManager().getPersistentState(NewSt);
@@ -485,7 +500,7 @@ ProgramStateRef ProgramStateManager::addGDM(ProgramStateRef St, void *Key, void
   ProgramState::GenericDataMap M1 = St->getGDM();
   ProgramState::GenericDataMap M2 = GDMFactory.add(M1, Key, Data);
 
-  if (M1 == M2)
+  if (haveEqualGDMs(M1, M2))
     return St;
 
   ProgramState NewSt = *St;
@@ -497,7 +512,7 @@ ProgramStateRef ProgramStateManager::removeGDM(ProgramStateRef state, void *Key)
   ProgramState::GenericDataMap OldM = state->getGDM();
   ProgramState::GenericDataMap NewM = GDMFactory.remove(OldM, Key);
 
-  if (NewM == OldM)
+  if (haveEqualGDMs(NewM, OldM))
     return state;
 
   ProgramState NewState = *state;
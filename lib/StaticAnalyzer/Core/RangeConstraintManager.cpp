@@ -17,9 +17,12 @@
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramState.h"
 #include "clang/StaticAnalyzer/Core/PathSensitive/ProgramStateTrait.h"
 #include "llvm/ADT/FoldingSet.h"
-#include "llvm/ADT/ImmutableSet.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
 
 using namespace clang;
 using namespace ento;
@@ -52,16 +55,11 @@ public:
     ID.AddPointer(&From());
     ID.AddPointer(&To());
   }
-};
-
 
-class RangeTrait : public llvm::ImutContainerInfo<Range> {
-public:
   // When comparing if one Range is less than another, we should compare
   // the actual APSInt values instead of their pointers.  This keeps the order
-  // consistent (instead of comparing by pointer values) and can potentially
-  // be used to speed up some of the operations in RangeSet.
-  static inline bool isLess(key_type_ref lhs, key_type_ref rhs) {
+  // consistent (instead of comparing by pointer values).
+  static bool isLess(const Range &lhs, const Range &rhs) {
     return *lhs.first < *rhs.first || (!(*rhs.first < *lhs.first) &&
                                        *lhs.second < *rhs.second);
   }
@@ -70,53 +68,68 @@ public:
 /// RangeSet contains a set of ranges. If the set is empty, then
 ///  there the value of a symbol is overly constrained and there are no
 ///  possible values for that symbol.
+///
+/// The ranges are kept sorted in a single array. The Factory uniques the
+/// arrays, so two RangeSets are equal exactly when they share one, and a
+/// RangeSet is profiled and compared by pointer.
 class RangeSet {
-  typedef llvm::ImmutableSet<Range, RangeTrait> PrimRangeSet;
-  PrimRangeSet ranges; // no need to make const, since it is an
-                       // ImmutableSet - this allows default operator=
-                       // to work.
 public:
-  typedef PrimRangeSet::Factory Factory;
-  typedef PrimRangeSet::iterator iterator;
+  class Factory;
+  typedef const Range *iterator;
 
-  RangeSet(PrimRangeSet RS) : ranges(RS) {}
+private:
+  /// The sorted, uniqued ranges of a non-empty set, allocated by the
+  /// Factory.
+  class RangeList : public llvm::FoldingSetNode {
+  public:
+    ArrayRef<Range> Ranges;
+
+    explicit RangeList(ArrayRef<Range> Ranges) : Ranges(Ranges) {}
 
+    static void Profile(llvm::FoldingSetNodeID &ID, ArrayRef<Range> Ranges) {
+      for (const Range &R : Ranges)
+        R.Profile(ID);
+    }
+    void Profile(llvm::FoldingSetNodeID &ID) const { Profile(ID, Ranges); }
+  };
+
+  /// The ranges of the set, or null if the set is empty.
+  const RangeList *List;
+
+  explicit RangeSet(const RangeList *List) : List(List) {}
+
+public:
   /// Create a new set with all ranges of this set and RS.
   /// Possible intersections are not checked here.
-  RangeSet addRange(Factory &F, const RangeSet &RS) {
-    PrimRangeSet Ranges(RS.ranges);
-    for (const auto &range : ranges)
-      Ranges = F.add(Ranges, range);
-    return RangeSet(Ranges);
-  }
+  RangeSet addRange(Factory &F, const RangeSet &RS);
 
-  iterator begin() const { return ranges.begin(); }
-  iterator end() const { return ranges.end(); }
+  iterator begin() const { return List ? List->Ranges.begin() : nullptr; }
+  iterator end() const { return List ? List->Ranges.end() : nullptr; }
 
-  bool isEmpty() const { return ranges.isEmpty(); }
+  bool isEmpty() const { return !List; }
 
   /// Construct a new RangeSet representing '{ [from, to] }'.
-  RangeSet(Factory &F, const llvm::APSInt &from, const llvm::APSInt &to)
-    : ranges(F.add(F.getEmptySet(), Range(from, to))) {}
+  RangeSet(Factory &F, const llvm::APSInt &from, const llvm::APSInt &to);
 
   /// Profile - Generates a hash profile of this RangeSet for use
   ///  by FoldingSet.
-  void Profile(llvm::FoldingSetNodeID &ID) const { ranges.Profile(ID); }
+  void Profile(llvm::FoldingSetNodeID &ID) const { ID.AddPointer(List); }
 
   /// getConcreteValue - If a symbol is contrained to equal a specific integer
   ///  constant then this method returns that value.  Otherwise, it returns
   ///  NULL.
   const llvm::APSInt* getConcreteValue() const {
-    return ranges.isSingleton() ? ranges.begin()->getConcreteValue() : nullptr;
+    return List && List->Ranges.size() == 1
+               ? List->Ranges.front().getConcreteValue()
+               : nullptr;
   }
 
 private:
-  void IntersectInRange(BasicValueFactory &BV, Factory &F,
+  void IntersectInRange(BasicValueFactory &BV,
                         const llvm::APSInt &Lower,
                         const llvm::APSInt &Upper,
-                        PrimRangeSet &newRanges,
-                        PrimRangeSet::iterator &i,
-                        PrimRangeSet::iterator &e) const {
+                        SmallVectorImpl<Range> &newRanges,
+                        iterator &i, iterator &e) const {
     // There are six cases for each range R in the set:
     //   1. R is entirely before the intersection range.
     //   2. R is entirely after the intersection range.
@@ -135,24 +148,23 @@ private:
 
       if (i->Includes(Lower)) {
         if (i->Includes(Upper)) {
-          newRanges = F.add(newRanges, Range(BV.getValue(Lower),
-                                             BV.getValue(Upper)));
+          newRanges.push_back(Range(BV.getValue(Lower), BV.getValue(Upper)));
           break;
         } else
-          newRanges = F.add(newRanges, Range(BV.getValue(Lower), i->To()));
+          newRanges.push_back(Range(BV.getValue(Lower), i->To()));
       } else {
         if (i->Includes(Upper)) {
-          newRanges = F.add(newRanges, Range(i->From(), BV.getValue(Upper)));
+          newRanges.push_back(Range(i->From(), BV.getValue(Upper)));
           break;
         } else
-          newRanges = F.add(newRanges, *i);
+          newRanges.push_back(*i);
       }
     }
   }
 
   const llvm::APSInt &getMinValue() const {
     assert(!isEmpty());
-    return ranges.begin()->From();
+    return begin()->From();
   }
 
   bool pin(llvm::APSInt &Lower, llvm::APSInt &Upper) const {
@@ -236,6 +248,9 @@ private:
     return true;
   }
 
+  RangeSet computeIntersection(BasicValueFactory &BV, Factory &F,
+                               llvm::APSInt Lower, llvm::APSInt Upper) const;
+
 public:
   // Returns a set containing the values in the receiving set, intersected with
   // the closed range [Lower, Upper]. Unlike the Range type, this range uses
@@ -245,25 +260,8 @@ public:
   // intersection with the two ranges [Min, Upper] and [Lower, Max],
   // or, alternatively, /removing/ all integers between Upper and Lower.
   RangeSet Intersect(BasicValueFactory &BV, Factory &F,
-                     llvm::APSInt Lower, llvm::APSInt Upper) const {
-    if (!pin(Lower, Upper))
-      return F.getEmptySet();
-
-    PrimRangeSet newRanges = F.getEmptySet();
-
-    PrimRangeSet::iterator i = begin(), e = end();
-    if (Lower <= Upper)
-      IntersectInRange(BV, F, Lower, Upper, newRanges, i, e);
-    else {
-      // The order of the next two statements is important!
-      // IntersectInRange() does not reset the iteration state for i and e.
-      // Therefore, the lower range most be handled first.
-      IntersectInRange(BV, F, BV.getMinValue(Upper), Upper, newRanges, i, e);
-      IntersectInRange(BV, F, Lower, BV.getMaxValue(Lower), newRanges, i, e);
-    }
-
-    return newRanges;
-  }
+                     const llvm::APSInt &Lower,
+                     const llvm::APSInt &Upper) const;
 
   void print(raw_ostream &os) const {
     bool isFirst = true;
@@ -281,9 +279,110 @@ public:
   }
 
   bool operator==(const RangeSet &other) const {
-    return ranges == other.ranges;
+    return List == other.List;
   }
 };
+
+/// The result of intersecting a RangeSet with a range, remembered because
+/// the same feasibility check on a symbol is often made again from the same
+/// set of values, e.g. each time a loop condition is evaluated.
+class CachedIntersection : public llvm::FoldingSetNode {
+  llvm::FoldingSetNodeIDRef Key;
+
+public:
+  RangeSet Result;
+
+  CachedIntersection(llvm::FoldingSetNodeIDRef Key, RangeSet Result)
+    : Key(Key), Result(Result) {}
+
+  void Profile(llvm::FoldingSetNodeID &ID) const {
+    ID = llvm::FoldingSetNodeID(Key);
+  }
+};
+
+/// Creates the RangeSets, and owns their ranges and the cached
+/// intersections.
+class RangeSet::Factory {
+  friend class RangeSet;
+
+  llvm::BumpPtrAllocator Arena;
+  llvm::FoldingSet<RangeList> Lists;
+  llvm::FoldingSet<CachedIntersection> Intersections;
+
+public:
+  RangeSet getEmptySet() { return RangeSet(nullptr); }
+
+  /// Returns the set of \p Ranges, which must be sorted and disjoint.
+  RangeSet getRangeSet(ArrayRef<Range> Ranges) {
+    if (Ranges.empty())
+      return getEmptySet();
+
+    llvm::FoldingSetNodeID ID;
+    RangeList::Profile(ID, Ranges);
+    void *InsertPos;
+    if (RangeList *L = Lists.FindNodeOrInsertPos(ID, InsertPos))
+      return RangeSet(L);
+
+    Range *Stored = Arena.Allocate<Range>(Ranges.size());
+    std::uninitialized_copy(Ranges.begin(), Ranges.end(), Stored);
+    RangeList *L =
+        new (Arena) RangeList(llvm::makeArrayRef(Stored, Ranges.size()));
+    Lists.InsertNode(L, InsertPos);
+    return RangeSet(L);
+  }
+};
+
+RangeSet::RangeSet(Factory &F, const llvm::APSInt &from,
+                   const llvm::APSInt &to)
+  : List(F.getRangeSet(Range(from, to)).List) {}
+
+RangeSet RangeSet::addRange(Factory &F, const RangeSet &RS) {
+  SmallVector<Range, 8> Ranges;
+  std::merge(begin(), end(), RS.begin(), RS.end(), std::back_inserter(Ranges),
+             Range::isLess);
+  Ranges.erase(std::unique(Ranges.begin(), Ranges.end()), Ranges.end());
+  return F.getRangeSet(Ranges);
+}
+
+RangeSet RangeSet::Intersect(BasicValueFactory &BV, Factory &F,
+                             const llvm::APSInt &Lower,
+                             const llvm::APSInt &Upper) const {
+  llvm::FoldingSetNodeID ID;
+  ID.AddPointer(List);
+  Lower.Profile(ID);
+  Upper.Profile(ID);
+  void *InsertPos;
+  if (CachedIntersection *Cached =
+          F.Intersections.FindNodeOrInsertPos(ID, InsertPos))
+    return Cached->Result;
+
+  RangeSet Result = computeIntersection(BV, F, Lower, Upper);
+  F.Intersections.InsertNode(
+      new (F.Arena) CachedIntersection(ID.Intern(F.Arena), Result), InsertPos);
+  return Result;
+}
+
+RangeSet RangeSet::computeIntersection(BasicValueFactory &BV, Factory &F,
+                                       llvm::APSInt Lower,
+                                       llvm::APSInt Upper) const {
+  if (!pin(Lower, Upper))
+    return F.getEmptySet();
+
+  SmallVector<Range, 4> newRanges;
+
+  iterator i = begin(), e = end();
+  if (Lower <= Upper)
+    IntersectInRange(BV, Lower, Upper, newRanges, i, e);
+  else {
+    // The order of the next two statements is important!
+    // IntersectInRange() does not reset the iteration state for i and e.
+    // Therefore, the lower range most be handled first.
+    IntersectInRange(BV, BV.getMinValue(Upper), Upper, newRanges, i, e);
+    IntersectInRange(BV, Lower, BV.getMaxValue(Lower), newRanges, i, e);
+  }
+
+  return F.getRangeSet(newRanges);
+}
 } // end anonymous namespace
 
 REGISTER_TRAIT_WITH_PROGRAMSTATE(ConstraintRange,
@@ -1262,8 +1262,14 @@ RegionStoreManager::invalidateRegions(Store store,
   invalidateRegionsWorker W(*this, StateMgr, B, Ex, Count, LCtx, IS, ITraits,
                             Invalidated, GlobalsFilter);
 
-  // Scan the bindings and generate the clusters.
-  W.GenerateClusters();
+  // Scan the bindings and generate the clusters. This is only needed when
+  // some memory space is invalidated in its entirety; otherwise every cluster
+  // that gets invalidated is reachable from the initial work list, and the
+  // rest of the store does not need to be walked.
+  if (GlobalsFilter != GFK_None ||
+      ITraits.hasRegionWithTrait(
+          RegionAndSymbolInvalidationTraits::TK_EntireMemSpace))
+    W.GenerateClusters();
 
   // Add the regions to the worklist.
   populateWorkList(W, Values, TopLevelRegions);
@@ -12,6 +12,8 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/StaticAnalyzer/Frontend/AnalysisConsumer.h"
+#include "AnalyzerProfile.h"
+#include "IncrementalAnalysis.h"
 #include "ModelInjector.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/Decl.h"
@@ -26,6 +28,7 @@
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendDiagnostic.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/StaticAnalyzer/Checkers/LocalCheckers.h"
 #include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
@@ -64,6 +67,9 @@ STATISTIC(NumBlocksInAnalyzedFunctions,
                       "The # of basic blocks in the analyzed functions.");
 STATISTIC(PercentReachableBlocks, "The % of reachable basic blocks.");
 STATISTIC(MaxCFGSize, "The maximum number of basic blocks in a function.");
+STATISTIC(NumFunctionsReused,
+          "The # of top level functions whose reports were reused from an "
+          "earlier run.");
 
 //===----------------------------------------------------------------------===//
 // Special PathDiagnosticConsumers.
@@ -185,6 +191,22 @@ public:
   /// translation unit.
   FunctionSummariesTy FunctionSummaries;
 
+  /// For each function of the call graph, the last position in the traversal
+  /// of HandleDeclsCallGraph at which a function that may inline it is
+  /// analyzed. Past it, the context of the function can be released.
+  llvm::DenseMap<const Decl *, unsigned> LastInliningPosition;
+
+  /// The position in that traversal of the function being analyzed.
+  unsigned CallGraphPosition = 0;
+
+  /// The reports of the earlier run, with -analyzer-config
+  /// incremental-analysis-state.
+  std::unique_ptr<IncrementalAnalysis> Incremental;
+
+  /// The time and nodes spent on each function and checker, with
+  /// -analyzer-config profile-output.
+  std::unique_ptr<AnalyzerProfile> Profile;
+
   AnalysisConsumer(const Preprocessor &pp, const std::string &outdir,
                    AnalyzerOptionsRef opts, ArrayRef<std::string> plugins,
                    CodeInjector *injector)
@@ -291,6 +313,15 @@ public:
     checkerMgr = createCheckerManager(*Opts, PP.getLangOpts(), Plugins,
                                       PP.getDiagnostics());
 
+    if (!Opts->getProfileOutput().empty())
+      Profile = llvm::make_unique<AnalyzerProfile>(*checkerMgr,
+                                                   Ctx->getSourceManager());
+
+    if (!Opts->getIncrementalAnalysisState().empty()) {
+      Incremental = llvm::make_unique<IncrementalAnalysis>(*Ctx, *Opts);
+      PathConsumers.push_back(Incremental->createReportRecorder());
+    }
+
     Mgr = llvm::make_unique<AnalysisManager>(
         *Ctx, PP.getDiagnostics(), PP.getLangOpts(), PathConsumers,
         CreateStoreMgr, CreateConstraintMgr, checkerMgr.get(), *Opts, Injector);
@@ -462,6 +493,8 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
     CG.addToCallGraph(LocalTUDecls[i]);
   }
+  if (Incremental)
+    Incremental->addCallGraph(CG);
 
   // Walk over all of the call graph nodes in topological order, so that we
   // analyze parents before the children. Skip the functions inlined into
@@ -469,13 +502,36 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
   // inlined functions. The topological order allows the "do not reanalyze
   // previously inlined function" performance heuristic to be triggered more
   // often.
+  //
+  // With several shards, the nodes are dealt out in this same order, so every
+  // shard agrees on which one analyzes a given function. A function inlined by
+  // another shard's root may then be analyzed again as a top-level function.
   SetOfConstDecls Visited;
   SetOfConstDecls VisitedAsTopLevel;
+  const unsigned ShardCount = Mgr->options.getAnalysisShardCount();
+  const unsigned ShardIndex = Mgr->options.getAnalysisShardIndex();
+  unsigned NodeIndex = 0;
   llvm::ReversePostOrderTraversal<clang::CallGraph*> RPOT(&CG);
+
+  // A function is inlined from its callers, and from the functions inlining
+  // those, which come earlier in the traversal; so its last caller bounds when
+  // its context is needed. Through a cycle of calls a context may be released
+  // too early, and is then built again.
+  for (CallGraphNode *N : RPOT) {
+    if (!N->getDecl())
+      continue;
+    unsigned &Last = LastInliningPosition[N->getDecl()];
+    Last = std::max(Last, NodeIndex);
+    for (CallGraphNode *Callee : *N) {
+      unsigned &CalleeLast = LastInliningPosition[Callee->getDecl()];
+      CalleeLast = std::max(CalleeLast, NodeIndex);
+    }
+    ++NodeIndex;
+  }
+  NodeIndex = 0;
+
   for (llvm::ReversePostOrderTraversal<clang::CallGraph*>::rpo_iterator
          I = RPOT.begin(), E = RPOT.end(); I != E; ++I) {
-    NumFunctionTopLevel++;
-
     CallGraphNode *N = *I;
     Decl *D = N->getDecl();
 
@@ -483,16 +539,36 @@ void AnalysisConsumer::HandleDeclsCallGraph(const unsigned LocalTUDeclsSize) {
     if (!D)
       continue;
 
+    // Skip the functions of the other shards.
+    CallGraphPosition = NodeIndex;
+    if (NodeIndex++ % ShardCount != ShardIndex)
+      continue;
+
+    NumFunctionTopLevel++;
+
     // Skip the functions which have been processed already or previously
     // inlined.
     if (shouldSkipFunction(D, Visited, VisitedAsTopLevel))
       continue;
 
-    // Analyze the function.
+    // Analyze the function, unless an earlier run found the reports of the
+    // same code.
     SetOfConstDecls VisitedCallees;
 
-    HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
-               (Mgr->options.InliningMode == All ? nullptr : &VisitedCallees));
+    if (Incremental) {
+      Incremental->beginFunction(N, Incremental->getFingerprint(N));
+      if (Incremental->replayReports(PathConsumers, VisitedCallees))
+        ++NumFunctionsReused;
+      else
+        HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
+                   (Mgr->options.InliningMode == All ? nullptr
+                                                     : &VisitedCallees));
+      Incremental->endFunction(VisitedCallees);
+    } else {
+      HandleCode(D, AM_Path, getInliningModeForFunction(D, Visited),
+                 (Mgr->options.InliningMode == All ? nullptr
+                                                   : &VisitedCallees));
+    }
 
     // Add the visited callees to the global visited set.
     for (const Decl *Callee : VisitedCallees)
@@ -521,7 +597,27 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // Introduce a scope to destroy BR before Mgr.
     BugReporter BR(*Mgr);
     TranslationUnitDecl *TU = C.getTranslationUnitDecl();
-    checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
+
+    // Read the function summaries of earlier runs. Neither file exists
+    // before the first run.
+    PersistentFunctionSummaries &Summaries = Mgr->getPersistentSummaries();
+    StringRef SummariesInput = Opts->getFunctionSummariesInput();
+    StringRef SummariesOutput = Opts->getFunctionSummariesOutput();
+    if (!SummariesInput.empty())
+      Summaries.readFromFile(SummariesInput);
+    if (!SummariesOutput.empty() && SummariesOutput != SummariesInput)
+      Summaries.readFromFile(SummariesOutput);
+
+    // The state does not exist before the first incremental run.
+    StringRef IncrementalState = Opts->getIncrementalAnalysisState();
+    if (Incremental)
+      Incremental->readFromFile(IncrementalState);
+
+    // Only the first shard runs the checks that are not tied to a top-level
+    // function of the call graph, so that they are reported once.
+    bool IsFirstShard = Mgr->options.getAnalysisShardIndex() == 0;
+    if (IsFirstShard)
+      checkerMgr->runCheckersOnASTDecl(TU, *Mgr, BR);
 
     // Run the AST-only checks using the order in which functions are defined.
     // If inlining is not turned on, use the simplest function order for path
@@ -538,19 +634,40 @@ void AnalysisConsumer::HandleTranslationUnit(ASTContext &C) {
     // random access.  By doing so, we automatically compensate for iterators
     // possibly being invalidated, although this is a bit slower.
     const unsigned LocalTUDeclsSize = LocalTUDecls.size();
-    for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
-      TraverseDecl(LocalTUDecls[i]);
-    }
+    if (IsFirstShard)
+      for (unsigned i = 0 ; i < LocalTUDeclsSize ; ++i) {
+        TraverseDecl(LocalTUDecls[i]);
+      }
 
     if (Mgr->shouldInlineCall())
       HandleDeclsCallGraph(LocalTUDeclsSize);
 
     // After all decls handled, run checkers on the entire TranslationUnit.
-    checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+    if (IsFirstShard)
+      checkerMgr->runCheckersOnEndOfTranslationUnit(TU, *Mgr, BR);
+
+    if (!SummariesOutput.empty()) {
+      Summaries.summarizeDefinitions(TU);
+      if (!Summaries.mergeIntoFile(SummariesOutput))
+        Diags.Report(diag::err_fe_unable_to_open_output)
+            << SummariesOutput << "cannot write function summaries";
+    }
+
+    if (Incremental && !Incremental->writeToFile(IncrementalState))
+      Diags.Report(diag::err_fe_unable_to_open_output)
+          << IncrementalState << "cannot write the incremental analysis state";
 
     RecVisitorBR = nullptr;
   }
 
+  if (Profile) {
+    StringRef ProfileOutput = Opts->getProfileOutput();
+    bool ChromeTrace = Opts->getProfileFormat() == "chrome-trace";
+    if (!Profile->writeToFile(ProfileOutput, ChromeTrace))
+      PP.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+          << ProfileOutput << "cannot write the analyzer profile";
+  }
+
   // Explicitly destroy the PathDiagnosticConsumer.  This will flush its output.
   // FIXME: This should be replaced with something that doesn't rely on
   // side-effects in PathDiagnosticConsumer's destructor. This is required when
@@ -621,8 +738,18 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
     MaxCFGSize = MaxCFGSize < CFGSize ? CFGSize : MaxCFGSize;
   }
 
-  // Clear the AnalysisManager of old AnalysisDeclContexts.
-  Mgr->ClearContexts();
+  if (Profile)
+    Profile->beginFunction(D, Mode == AM_Syntax ? "syntax"
+                              : Mode == AM_Path ? "path" : "syntax+path");
+
+  // Release the AnalysisDeclContexts of the functions no caller still to be
+  // analyzed can inline. A bounded number of the others are kept, rather than
+  // building their CFGs again for every function that inlines them.
+  Mgr->releaseContexts([this](const Decl *FD) {
+    auto I = LastInliningPosition.find(
+        isa<ObjCMethodDecl>(FD) ? FD : FD->getCanonicalDecl());
+    return I != LastInliningPosition.end() && I->second < CallGraphPosition;
+  });
   BugReporter BR(*Mgr);
 
   if (Mode & AM_Syntax)
@@ -632,6 +759,9 @@ void AnalysisConsumer::HandleCode(Decl *D, AnalysisMode Mode,
     if (IMode != ExprEngine::Inline_Minimal)
       NumFunctionsAnalyzed++;
   }
+
+  if (Profile)
+    Profile->endFunction();
 }
 
 //===----------------------------------------------------------------------===//
@@ -660,8 +790,12 @@ void AnalysisConsumer::ActionExprEngine(Decl *D, bool ObjCGCEnabled,
   }
 
   // Execute the worklist algorithm.
-  Eng.ExecuteWorkList(Mgr->getAnalysisDeclContextManager().getStackFrame(D),
-                      Mgr->options.getMaxNodesPerTopLevelFunction());
+  bool BudgetExhausted = Eng.ExecuteWorkList(
+      Mgr->getAnalysisDeclContextManager().getStackFrame(D),
+      Mgr->options.getMaxNodesPerTopLevelFunction());
+  if (Profile)
+    Profile->addPathSensitiveAnalysis(Eng.getGraph().getNumCreatedNodes(),
+                                      BudgetExhausted);
 
   // Release the auditor (if any) so that it doesn't monitor the graph
   // created BugReporter.
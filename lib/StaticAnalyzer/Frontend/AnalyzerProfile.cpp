@@ -0,0 +1,222 @@
+//===-- AnalyzerProfile.cpp -------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the profile of an analyzer run and its two output
+// formats: a JSON summary, and a trace that chrome://tracing displays with
+// one slice per analyzed function and, nested in it, one slice per checker
+// holding the time its callbacks took within that function.
+//
+// The time of a callback includes the time of the callbacks it triggers.
+//
+//===----------------------------------------------------------------------===//
+
+#include "AnalyzerProfile.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/StaticAnalyzer/Core/Checker.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace clang;
+using namespace ento;
+
+static double getCurrentTime() {
+  std::chrono::duration<double> Time =
+      std::chrono::steady_clock::now().time_since_epoch();
+  return Time.count();
+}
+
+static StringRef getCheckerName(const CheckerBase *Checker) {
+  StringRef Name = Checker->getCheckName().getName();
+  return Name.empty() ? "<unnamed>" : Name;
+}
+
+static void printJSONString(raw_ostream &OS, StringRef S) {
+  OS << '"';
+  for (unsigned char C : S) {
+    switch (C) {
+    case '"':
+      OS << "\\\"";
+      break;
+    case '\\':
+      OS << "\\\\";
+      break;
+    case '\n':
+      OS << "\\n";
+      break;
+    case '\t':
+      OS << "\\t";
+      break;
+    default:
+      if (C < 0x20)
+        OS << llvm::format("\\u%04x", C);
+      else
+        OS << C;
+    }
+  }
+  OS << '"';
+}
+
+AnalyzerProfile::AnalyzerProfile(CheckerManager &CheckerMgr,
+                                 const SourceManager &SM)
+    : CheckerMgr(CheckerMgr), SM(SM), Origin(getCurrentTime()),
+      Current(nullptr) {
+  CheckerMgr.enableProfiling();
+}
+
+void AnalyzerProfile::beginFunction(const Decl *D, const char *Mode) {
+  assert(!Current && "Already profiling a function");
+  Functions.push_back(FunctionProfile());
+  Current = &Functions.back();
+
+  if (const NamedDecl *ND = dyn_cast<NamedDecl>(D))
+    Current->Name = ND->getQualifiedNameAsString();
+  else if (isa<BlockDecl>(D))
+    Current->Name = "block";
+  PresumedLoc Loc = SM.getPresumedLoc(D->getLocation());
+  if (Loc.isValid())
+    Current->Location =
+        (Twine(Loc.getFilename()) + ":" + Twine(Loc.getLine())).str();
+  Current->Mode = Mode;
+  Current->Nodes = 0;
+  Current->BudgetExhausted = false;
+
+  CheckerProfilesAtStart = CheckerMgr.getCallbackProfiles();
+  Current->Start = getCurrentTime() - Origin;
+}
+
+void AnalyzerProfile::addPathSensitiveAnalysis(unsigned Nodes,
+                                               bool BudgetExhausted) {
+  assert(Current && "Not profiling a function");
+  Current->Nodes += Nodes;
+  Current->BudgetExhausted |= BudgetExhausted;
+}
+
+void AnalyzerProfile::endFunction() {
+  assert(Current && "Not profiling a function");
+  Current->Seconds = getCurrentTime() - Origin - Current->Start;
+
+  llvm::StringMap<double> CheckerSeconds;
+  for (const auto &Entry : CheckerMgr.getCallbackProfiles()) {
+    double Seconds = Entry.second.Seconds;
+    auto Earlier = CheckerProfilesAtStart.find(Entry.first);
+    if (Earlier != CheckerProfilesAtStart.end())
+      Seconds -= Earlier->second.Seconds;
+    if (Seconds > 0)
+      CheckerSeconds[getCheckerName(Entry.first.first)] += Seconds;
+  }
+  for (const auto &Entry : CheckerSeconds)
+    Current->CheckerSeconds.push_back(
+        std::make_pair(Entry.getKey().str(), Entry.second));
+  std::sort(Current->CheckerSeconds.begin(), Current->CheckerSeconds.end(),
+            [](const std::pair<std::string, double> &A,
+               const std::pair<std::string, double> &B) {
+              return A.second > B.second;
+            });
+
+  Current = nullptr;
+}
+
+void AnalyzerProfile::writeJSON(raw_ostream &OS) const {
+  // The callbacks taking the most time come first.
+  typedef CheckerManager::CallbackProfileMap::value_type CallbackEntry;
+  std::vector<const CallbackEntry *> Callbacks;
+  for (const auto &Entry : CheckerMgr.getCallbackProfiles())
+    Callbacks.push_back(&Entry);
+  std::sort(Callbacks.begin(), Callbacks.end(),
+            [](const CallbackEntry *A, const CallbackEntry *B) {
+              return A->second.Seconds > B->second.Seconds;
+            });
+
+  OS << "{\n  \"checkers\": [";
+  for (unsigned I = 0, E = Callbacks.size(); I != E; ++I) {
+    const CallbackEntry &Entry = *Callbacks[I];
+    OS << (I ? ",\n" : "\n") << "    { \"checker\": ";
+    printJSONString(OS, getCheckerName(Entry.first.first));
+    OS << ", \"callback\": ";
+    printJSONString(OS, Entry.first.second);
+    OS << ", \"calls\": " << Entry.second.Calls
+       << ", \"seconds\": " << llvm::format("%.6f", Entry.second.Seconds)
+       << " }";
+  }
+  OS << "\n  ],\n  \"functions\": [";
+  for (unsigned I = 0, E = Functions.size(); I != E; ++I) {
+    const FunctionProfile &F = Functions[I];
+    OS << (I ? ",\n" : "\n") << "    { \"name\": ";
+    printJSONString(OS, F.Name);
+    OS << ", \"location\": ";
+    printJSONString(OS, F.Location);
+    OS << ", \"mode\": \"" << F.Mode << "\", \"seconds\": "
+       << llvm::format("%.6f", F.Seconds) << ", \"nodes\": " << F.Nodes
+       << ", \"budget-exhausted\": "
+       << (F.BudgetExhausted ? "true" : "false") << ", \"checkers\": {";
+    for (unsigned J = 0, JE = F.CheckerSeconds.size(); J != JE; ++J) {
+      OS << (J ? ", " : " ");
+      printJSONString(OS, F.CheckerSeconds[J].first);
+      OS << ": " << llvm::format("%.6f", F.CheckerSeconds[J].second);
+    }
+    OS << " } }";
+  }
+  OS << "\n  ]\n}\n";
+}
+
+void AnalyzerProfile::writeChromeTrace(raw_ostream &OS) const {
+  // Times are in microseconds.
+  OS << "{ \"traceEvents\": [";
+  bool First = true;
+  auto printEvent = [&](StringRef Name, StringRef Category, double Start,
+                        double Seconds) {
+    OS << (First ? "\n" : ",\n") << "  { \"name\": ";
+    First = false;
+    printJSONString(OS, Name);
+    OS << ", \"cat\": \"" << Category << "\", \"ph\": \"X\", \"pid\": 1, "
+       << "\"tid\": 1, \"ts\": " << llvm::format("%.3f", Start * 1e6)
+       << ", \"dur\": " << llvm::format("%.3f", Seconds * 1e6);
+  };
+
+  for (const FunctionProfile &F : Functions) {
+    printEvent(F.Name, F.Mode, F.Start, F.Seconds);
+    OS << ", \"args\": { \"location\": ";
+    printJSONString(OS, F.Location);
+    OS << ", \"nodes\": " << F.Nodes << ", \"budget-exhausted\": "
+       << (F.BudgetExhausted ? "true" : "false") << " } }";
+
+    // The checkers are laid out one after the other within the function,
+    // which is where their time went, though not in this order.
+    double Start = F.Start;
+    double End = F.Start + F.Seconds;
+    for (const auto &Checker : F.CheckerSeconds) {
+      double Seconds = std::min(Checker.second, End - Start);
+      if (Seconds <= 0)
+        break;
+      printEvent(Checker.first, "checker", Start, Seconds);
+      OS << " }";
+      Start += Seconds;
+    }
+  }
+  OS << "\n] }\n";
+}
+
+bool AnalyzerProfile::writeToFile(StringRef Path, bool ChromeTrace) const {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+  if (EC)
+    return false;
+  if (ChromeTrace)
+    writeChromeTrace(OS);
+  else
+    writeJSON(OS);
+  OS.close();
+  bool Failed = OS.has_error();
+  OS.clear_error();
+  return !Failed;
+}
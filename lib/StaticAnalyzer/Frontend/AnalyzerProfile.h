@@ -0,0 +1,87 @@
+//===-- AnalyzerProfile.h ---------------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file defines the clang::ento::AnalyzerProfile class, which
+/// records where the time of an analyzer run goes: how long each function
+/// took to analyze and how many nodes its exploded graphs had, and how long
+/// each checker callback ran, in total and within each function.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SA_FRONTEND_ANALYZERPROFILE_H
+#define LLVM_CLANG_SA_FRONTEND_ANALYZERPROFILE_H
+
+#include "clang/StaticAnalyzer/Core/CheckerManager.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class Decl;
+class SourceManager;
+
+namespace ento {
+
+class AnalyzerProfile {
+  /// \brief The analysis of one function in one mode.
+  struct FunctionProfile {
+    std::string Name;
+    std::string Location;
+    /// "syntax", "path" or "syntax+path".
+    const char *Mode;
+    double Start;
+    double Seconds;
+    /// The nodes created by the path-sensitive analysis.
+    unsigned Nodes;
+    /// Whether the path-sensitive analysis stopped with work left, having
+    /// reached max-nodes or max-memory-mb.
+    bool BudgetExhausted;
+    /// The time spent in the checker callbacks, in decreasing order.
+    std::vector<std::pair<std::string, double>> CheckerSeconds;
+  };
+
+  CheckerManager &CheckerMgr;
+  const SourceManager &SM;
+
+  /// The wall-clock time the profile started.
+  double Origin;
+
+  std::vector<FunctionProfile> Functions;
+
+  /// The function being analyzed, and the checker profiles when it started.
+  FunctionProfile *Current;
+  CheckerManager::CallbackProfileMap CheckerProfilesAtStart;
+
+  void writeJSON(raw_ostream &OS) const;
+  void writeChromeTrace(raw_ostream &OS) const;
+
+public:
+  AnalyzerProfile(CheckerManager &CheckerMgr, const SourceManager &SM);
+
+  /// \brief Starts the profile of the analysis of \p D.
+  void beginFunction(const Decl *D, const char *Mode);
+
+  /// \brief Adds a path-sensitive analysis of the current function, which
+  /// created \p Nodes nodes.
+  void addPathSensitiveAnalysis(unsigned Nodes, bool BudgetExhausted);
+
+  /// \brief Ends the profile of the current function.
+  void endFunction();
+
+  /// \brief Writes the profile to \p Path, either as a JSON summary or, if
+  /// \p ChromeTrace is set, in the trace event format read by
+  /// chrome://tracing. Returns false on failure.
+  bool writeToFile(StringRef Path, bool ChromeTrace) const;
+};
+
+} // end namespace ento
+} // end namespace clang
+
+#endif
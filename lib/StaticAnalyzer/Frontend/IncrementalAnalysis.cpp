@@ -0,0 +1,628 @@
+//===-- IncrementalAnalysis.cpp ---------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the state kept between analyzer runs by the
+// incremental analysis mode, and its on-disk format.
+//
+// The file starts with a header and the digest of the configuration. Each
+// top-level function then has a 'function' line, followed by a 'callee' line
+// per inlined function and a 'report' line per report. Fields are separated
+// by tabs, and tabs, newlines and backslashes in them are escaped:
+//
+//   function <fingerprint> <key>
+//   callee <key>
+//   report <key> <line-offset> <column> <check> <bug-type> <category>
+//          <short-description> <verbose-description>
+//
+//===----------------------------------------------------------------------===//
+
+#include "IncrementalAnalysis.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclObjC.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/Analysis/CallGraph.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/StaticAnalyzer/Core/AnalyzerOptions.h"
+#include "clang/StaticAnalyzer/Core/BugReporter/PathDiagnostic.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+using namespace clang;
+using namespace ento;
+
+static const char StateFileHeader[] = "# clang analyzer incremental state v1";
+
+static std::string getDigest(llvm::MD5 &Hash) {
+  llvm::MD5::MD5Result Result;
+  Hash.final(Result);
+  SmallString<32> Digest;
+  llvm::MD5::stringifyResult(Result, Digest);
+  return Digest.str();
+}
+
+//===----------------------------------------------------------------------===//
+// Recording reports.
+//===----------------------------------------------------------------------===//
+
+/// \brief Collects the reports of the analysis without printing them, so
+/// that the ones emitted since the last call to takeNewDiagnostics() can be
+/// attributed to the function that was analyzed in between.
+class IncrementalAnalysis::ReportRecorder : public PathDiagnosticConsumer {
+  llvm::SmallPtrSet<const PathDiagnostic *, 32> Taken;
+
+public:
+  void takeNewDiagnostics(std::vector<const PathDiagnostic *> &NewDiags) {
+    for (const PathDiagnostic &PD : Diags)
+      if (Taken.insert(&PD).second)
+        NewDiags.push_back(&PD);
+  }
+
+  void FlushDiagnosticsImpl(std::vector<const PathDiagnostic *> &Diags,
+                            FilesMade *filesMade) override {}
+
+  StringRef getName() const override { return "IncrementalAnalysis"; }
+
+  PathGenerationScheme getGenerationScheme() const override { return None; }
+
+  bool supportsCrossFileDiagnostics() const override { return true; }
+};
+
+//===----------------------------------------------------------------------===//
+// Fingerprints.
+//===----------------------------------------------------------------------===//
+
+/// Returns the name of \p D, which is the same in every run, or an empty
+/// string if \p D cannot be named that way.
+static std::string getFunctionKey(const Decl *D) {
+  std::string Key;
+  llvm::raw_string_ostream OS(Key);
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+    FD->printQualifiedName(OS);
+    if (const TemplateArgumentList *Args = FD->getTemplateSpecializationArgs())
+      TemplateSpecializationType::PrintTemplateArgumentList(
+          OS, Args->asArray(), FD->getASTContext().getPrintingPolicy());
+    OS << '#' << FD->getType().getCanonicalType().getAsString();
+  } else if (const ObjCMethodDecl *MD = dyn_cast<ObjCMethodDecl>(D)) {
+    const NamedDecl *Container = cast<NamedDecl>(MD->getDeclContext());
+    OS << (MD->isInstanceMethod() ? '-' : '+') << '[' << Container->getName()
+       << ' ' << MD->getSelector().getAsString() << ']';
+  }
+  return OS.str();
+}
+
+/// Returns the declaration holding the body of \p D.
+static const Decl *getDefinition(const Decl *D) {
+  if (const FunctionDecl *FD = dyn_cast<FunctionDecl>(D)) {
+    const FunctionDecl *Definition = nullptr;
+    return FD->hasBody(Definition) ? Definition : nullptr;
+  }
+  return D->hasBody() ? D : nullptr;
+}
+
+const IncrementalAnalysis::FunctionInfo &
+IncrementalAnalysis::getInfo(const Decl *D) {
+  auto Known = Infos.find(D);
+  if (Known != Infos.end())
+    return Known->second;
+
+  FunctionInfo &Info = Infos[D];
+  const Decl *Definition = getDefinition(D);
+  if (!Definition)
+    return Info;
+
+  // A function written across files or in a macro expansion has no stable
+  // position from which to store reports.
+  const SourceManager &SM = Ctx.getSourceManager();
+  SourceRange Range = Definition->getSourceRange();
+  SourceLocation Begin = SM.getExpansionLoc(Range.getBegin());
+  SourceLocation End = SM.getExpansionLoc(Range.getEnd());
+  if (Begin.isInvalid() || End.isInvalid() ||
+      SM.getFileID(Begin) != SM.getFileID(End))
+    return Info;
+  End = Lexer::getLocForEndOfToken(End, 0, SM, Ctx.getLangOpts());
+  if (End.isInvalid())
+    return Info;
+
+  std::string Key = getFunctionKey(D);
+  if (Key.empty())
+    return Info;
+
+  // The source text catches every change that moves a line of the function,
+  // and the pretty-printed definition the changes made by macros.
+  std::string Printed;
+  llvm::raw_string_ostream OS(Printed);
+  Definition->print(OS, Ctx.getPrintingPolicy());
+  OS.flush();
+
+  StringRef Text = Lexer::getSourceText(CharSourceRange::getCharRange(Begin, End),
+                                        SM, Ctx.getLangOpts());
+  llvm::MD5 Hash;
+  Hash.update(Key);
+  Hash.update(SM.getFilename(Begin));
+  Hash.update(llvm::utostr(SM.getExpansionColumnNumber(Begin)));
+  Hash.update(Text);
+  Hash.update(Printed);
+
+  Info.Key = Key;
+  Info.Digest = getDigest(Hash);
+  Info.File = SM.getFileID(Begin);
+  Info.BeginOffset = SM.getFileOffset(Begin);
+  Info.EndOffset = SM.getFileOffset(End);
+  Info.BeginLine = SM.getExpansionLineNumber(Begin);
+  return Info;
+}
+
+/// Returns true if \p D has a body, whose digest is that of the function.
+static bool isFunctionDefinition(const Decl *D) {
+  if (const auto *FTD = dyn_cast<FunctionTemplateDecl>(D))
+    D = FTD->getTemplatedDecl();
+  if (const auto *FD = dyn_cast<FunctionDecl>(D))
+    return FD->doesThisDeclarationHaveABody();
+  if (const auto *MD = dyn_cast<ObjCMethodDecl>(D))
+    return MD->hasBody();
+  return false;
+}
+
+/// Hashes the declarations of \p DC that are in the main file, except for
+/// function definitions.
+static void hashFileScopeDecls(const DeclContext *DC, const ASTContext &Ctx,
+                               llvm::MD5 &Hash) {
+  const SourceManager &SM = Ctx.getSourceManager();
+  for (const Decl *D : DC->decls()) {
+    if (D->isImplicit())
+      continue;
+    if (!SM.isInMainFile(SM.getExpansionLoc(D->getLocation())))
+      continue;
+    if (isa<NamespaceDecl>(D) || isa<LinkageSpecDecl>(D) ||
+        isa<ObjCImplDecl>(D)) {
+      if (const auto *ND = dyn_cast<NamedDecl>(D))
+        Hash.update(ND->getName());
+      Hash.update("{");
+      hashFileScopeDecls(cast<DeclContext>(D), Ctx, Hash);
+      Hash.update("}");
+      continue;
+    }
+    if (isFunctionDefinition(D))
+      continue;
+    std::string Printed;
+    llvm::raw_string_ostream OS(Printed);
+    D->print(OS, Ctx.getPrintingPolicy());
+    Hash.update(OS.str());
+    Hash.update("\n");
+  }
+}
+
+const std::string &IncrementalAnalysis::getFileScopeDigest() {
+  if (HasFileScopeDigest)
+    return FileScopeDigest;
+  HasFileScopeDigest = true;
+
+  // The headers and the predefines buffer, by contents: their declarations
+  // and macros are not all visible in the printed definitions.
+  const SourceManager &SM = Ctx.getSourceManager();
+  const FileEntry *MainFile = SM.getFileEntryForID(SM.getMainFileID());
+  llvm::SmallPtrSet<const SrcMgr::ContentCache *, 32> Seen;
+  std::vector<std::pair<std::string, std::string>> Files;
+  bool Invalid = false;
+  auto AddFile = [&](const SrcMgr::SLocEntry &Entry) {
+    if (!Entry.isFile())
+      return;
+    const SrcMgr::ContentCache *Content = Entry.getFile().getContentCache();
+    if (!Seen.insert(Content).second ||
+        (Content->OrigEntry && Content->OrigEntry == MainFile))
+      return;
+    llvm::MemoryBuffer *Buffer = Content->getBuffer(
+        SM.getDiagnostics(), SM, SourceLocation(), &Invalid);
+    if (Invalid)
+      return;
+    std::string Name = Content->OrigEntry ? Content->OrigEntry->getName()
+                                          : Buffer->getBufferIdentifier();
+    // The scratch space holds pasted tokens, which are part of the AST.
+    if (!Content->OrigEntry && Name == "<scratch space>")
+      return;
+    llvm::MD5 FileHash;
+    FileHash.update(Buffer->getBuffer());
+    Files.push_back(std::make_pair(Name, getDigest(FileHash)));
+  };
+  for (unsigned I = 0, E = SM.local_sloc_entry_size(); I != E && !Invalid;
+       ++I)
+    AddFile(SM.getLocalSLocEntry(I));
+  for (unsigned I = 0, E = SM.loaded_sloc_entry_size(); I != E && !Invalid;
+       ++I) {
+    const SrcMgr::SLocEntry &Entry = SM.getLoadedSLocEntry(I, &Invalid);
+    if (!Invalid)
+      AddFile(Entry);
+  }
+  if (Invalid)
+    return FileScopeDigest;
+  std::sort(Files.begin(), Files.end());
+
+  llvm::MD5 Hash;
+  for (const auto &File : Files) {
+    Hash.update(File.first);
+    Hash.update(File.second);
+  }
+  hashFileScopeDecls(Ctx.getTranslationUnitDecl(), Ctx, Hash);
+  FileScopeDigest = getDigest(Hash);
+  return FileScopeDigest;
+}
+
+IncrementalAnalysis::IncrementalAnalysis(ASTContext &Ctx, AnalyzerOptions &Opts)
+    : Ctx(Ctx), HasFileScopeDigest(false), Recorder(nullptr),
+      Recording(nullptr) {
+  std::vector<std::pair<StringRef, StringRef>> Config;
+  for (const auto &Entry : Opts.Config)
+    Config.push_back(std::make_pair(Entry.getKey(), StringRef(Entry.second)));
+  std::sort(Config.begin(), Config.end());
+
+  llvm::MD5 Hash;
+  Hash.update(getClangFullVersion());
+  for (const auto &Entry : Config) {
+    Hash.update(Entry.first);
+    Hash.update("=");
+    Hash.update(Entry.second);
+    Hash.update("\n");
+  }
+  for (const auto &Checker : Opts.CheckersControlList) {
+    Hash.update(Checker.second ? "+" : "-");
+    Hash.update(Checker.first);
+    Hash.update("\n");
+  }
+  ConfigHash = getDigest(Hash);
+}
+
+PathDiagnosticConsumer *IncrementalAnalysis::createReportRecorder() {
+  assert(!Recorder && "The recorder was already created");
+  Recorder = new ReportRecorder();
+  return Recorder;
+}
+
+void IncrementalAnalysis::addCallGraph(const CallGraph &CG) {
+  for (const auto &Node : CG) {
+    const Decl *D = Node.first;
+    if (!D)
+      continue;
+    std::string Key = getFunctionKey(D);
+    if (!Key.empty())
+      DeclsByKey[Key] = D;
+  }
+}
+
+std::string IncrementalAnalysis::getFingerprint(const CallGraphNode *N) {
+  const std::string &FileScope = getFileScopeDigest();
+  if (FileScope.empty())
+    return std::string();
+
+  // Collect the functions with a body that the root can reach.
+  std::vector<const Decl *> Reachable;
+  llvm::SmallPtrSet<const CallGraphNode *, 32> Visited;
+  SmallVector<const CallGraphNode *, 32> Worklist;
+  Worklist.push_back(N);
+  Visited.insert(N);
+  while (!Worklist.empty()) {
+    const CallGraphNode *Node = Worklist.pop_back_val();
+    if (getDefinition(Node->getDecl()))
+      Reachable.push_back(Node->getDecl());
+    for (const CallGraphNode *Callee : *Node)
+      if (Visited.insert(Callee).second)
+        Worklist.push_back(Callee);
+  }
+
+  std::vector<std::pair<StringRef, StringRef>> Digests;
+  for (const Decl *D : Reachable) {
+    const FunctionInfo &Info = getInfo(D);
+    if (Info.Digest.empty())
+      return std::string();
+    Digests.push_back(std::make_pair(StringRef(Info.Key),
+                                     StringRef(Info.Digest)));
+  }
+  std::sort(Digests.begin(), Digests.end());
+
+  llvm::MD5 Hash;
+  Hash.update(FileScope);
+  for (const auto &Digest : Digests)
+    Hash.update(Digest.second);
+  return getDigest(Hash);
+}
+
+//===----------------------------------------------------------------------===//
+// Recording and replaying the reports of a function.
+//===----------------------------------------------------------------------===//
+
+void IncrementalAnalysis::beginFunction(const CallGraphNode *N,
+                                        StringRef Fingerprint) {
+  assert(!Recording && "Already recording a function");
+  std::vector<const PathDiagnostic *> Earlier;
+  Recorder->takeNewDiagnostics(Earlier);
+
+  RecordingFunctions.clear();
+  std::string Key = getFunctionKey(N->getDecl());
+  if (Key.empty() || Fingerprint.empty())
+    return;
+
+  // The reports can only be located in the functions the root reaches.
+  llvm::SmallPtrSet<const CallGraphNode *, 32> Visited;
+  SmallVector<const CallGraphNode *, 32> Worklist;
+  Worklist.push_back(N);
+  Visited.insert(N);
+  while (!Worklist.empty()) {
+    const CallGraphNode *Node = Worklist.pop_back_val();
+    RecordingFunctions.push_back(Node->getDecl());
+    for (const CallGraphNode *Callee : *Node)
+      if (Visited.insert(Callee).second)
+        Worklist.push_back(Callee);
+  }
+
+  RecordingKey = Key;
+  Recording = &Current[Key];
+  *Recording = FunctionEntry();
+  Recording->Fingerprint = Fingerprint;
+}
+
+bool IncrementalAnalysis::storeReport(const PathDiagnostic &PD,
+                                      StoredReport &Report) {
+  const SourceManager &SM = Ctx.getSourceManager();
+  SourceLocation Loc = SM.getExpansionLoc(PD.getLocation().asLocation());
+  if (Loc.isInvalid())
+    return false;
+  FileID File = SM.getFileID(Loc);
+  unsigned Offset = SM.getFileOffset(Loc);
+
+  for (const Decl *D : RecordingFunctions) {
+    const FunctionInfo &Info = getInfo(D);
+    if (Info.Digest.empty() || Info.File != File ||
+        Offset < Info.BeginOffset || Offset > Info.EndOffset)
+      continue;
+    Report.FunctionKey = Info.Key;
+    Report.LineOffset = SM.getExpansionLineNumber(Loc) - Info.BeginLine;
+    Report.Column = SM.getExpansionColumnNumber(Loc);
+    Report.CheckName = PD.getCheckName();
+    Report.BugType = PD.getBugType();
+    Report.Category = PD.getCategory();
+    Report.ShortDescription = PD.getShortDescription();
+    Report.VerboseDescription = PD.getVerboseDescription();
+    return true;
+  }
+  return false;
+}
+
+bool IncrementalAnalysis::replayReports(
+    const PathDiagnosticConsumers &Consumers,
+    SetOfConstDecls &InlinedCallees) {
+  if (!Recording)
+    return false;
+  llvm::StringMap<FunctionEntry>::const_iterator Stored =
+      Previous.find(RecordingKey);
+  if (Stored == Previous.end() ||
+      Stored->second.Fingerprint != Recording->Fingerprint)
+    return false;
+  const FunctionEntry &Entry = Stored->second;
+
+  // Nothing is emitted unless every report can be placed again.
+  SetOfConstDecls Callees;
+  for (const std::string &Key : Entry.InlinedCallees) {
+    llvm::StringMap<const Decl *>::const_iterator D = DeclsByKey.find(Key);
+    if (D == DeclsByKey.end())
+      return false;
+    Callees.insert(D->second);
+  }
+
+  const SourceManager &SM = Ctx.getSourceManager();
+  std::vector<std::pair<const Decl *, PathDiagnosticLocation>> Locations;
+  for (const StoredReport &Report : Entry.Reports) {
+    llvm::StringMap<const Decl *>::const_iterator D =
+        DeclsByKey.find(Report.FunctionKey);
+    if (D == DeclsByKey.end())
+      return false;
+    const FunctionInfo &Info = getInfo(D->second);
+    if (Info.Digest.empty())
+      return false;
+    SourceLocation Loc = SM.translateLineCol(
+        Info.File, Info.BeginLine + Report.LineOffset, Report.Column);
+    if (Loc.isInvalid())
+      return false;
+    Locations.push_back(
+        std::make_pair(D->second, PathDiagnosticLocation(Loc, SM)));
+  }
+
+  // The path itself is not stored; the replayed reports only have the note
+  // at their end.
+  for (unsigned I = 0, E = Entry.Reports.size(); I != E; ++I) {
+    const StoredReport &Report = Entry.Reports[I];
+    for (PathDiagnosticConsumer *Consumer : Consumers) {
+      auto PD = llvm::make_unique<PathDiagnostic>(
+          Report.CheckName, Locations[I].first, Report.BugType,
+          Report.VerboseDescription, Report.ShortDescription, Report.Category,
+          PathDiagnosticLocation(), nullptr);
+      PD->setEndOfPath(llvm::make_unique<PathDiagnosticEventPiece>(
+          Locations[I].second, Report.VerboseDescription));
+      Consumer->HandlePathDiagnostic(std::move(PD));
+    }
+  }
+
+  InlinedCallees.insert(Callees.begin(), Callees.end());
+  return true;
+}
+
+void IncrementalAnalysis::endFunction(const SetOfConstDecls &InlinedCallees) {
+  std::vector<const PathDiagnostic *> NewDiags;
+  Recorder->takeNewDiagnostics(NewDiags);
+  if (!Recording)
+    return;
+
+  for (const PathDiagnostic *PD : NewDiags) {
+    StoredReport Report;
+    if (!storeReport(*PD, Report)) {
+      Recording->Complete = false;
+      break;
+    }
+    Recording->Reports.push_back(Report);
+  }
+
+  for (const Decl *Callee : InlinedCallees) {
+    std::string Key = getFunctionKey(Callee);
+    if (Key.empty()) {
+      Recording->Complete = false;
+      break;
+    }
+    Recording->InlinedCallees.push_back(Key);
+  }
+  std::sort(Recording->InlinedCallees.begin(), Recording->InlinedCallees.end());
+
+  Recording = nullptr;
+}
+
+//===----------------------------------------------------------------------===//
+// The state file.
+//===----------------------------------------------------------------------===//
+
+static void writeField(raw_ostream &OS, StringRef Field) {
+  OS << '\t';
+  for (char C : Field) {
+    if (C == '\\')
+      OS << "\\\\";
+    else if (C == '\t')
+      OS << "\\t";
+    else if (C == '\n')
+      OS << "\\n";
+    else
+      OS << C;
+  }
+}
+
+static std::string unescapeField(StringRef Field) {
+  std::string Result;
+  for (unsigned I = 0, E = Field.size(); I != E; ++I) {
+    char C = Field[I];
+    if (C == '\\' && I + 1 != E) {
+      C = Field[++I];
+      if (C == 't')
+        C = '\t';
+      else if (C == 'n')
+        C = '\n';
+    }
+    Result += C;
+  }
+  return Result;
+}
+
+bool IncrementalAnalysis::readFromFile(StringRef Path) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return false;
+
+  llvm::StringMap<FunctionEntry> Entries;
+  FunctionEntry *Entry = nullptr;
+  bool SameConfig = false;
+  StringRef Rest = (*Buffer)->getBuffer();
+  while (!Rest.empty()) {
+    StringRef Line;
+    std::tie(Line, Rest) = Rest.split('\n');
+    if (Line.empty() || Line.startswith("#"))
+      continue;
+
+    SmallVector<StringRef, 9> Fields;
+    Line.split(Fields, '\t');
+    if (Fields[0] == "config" && Fields.size() == 2) {
+      SameConfig = Fields[1] == ConfigHash;
+    } else if (Fields[0] == "function" && Fields.size() == 3) {
+      Entry = &Entries[unescapeField(Fields[2])];
+      Entry->Fingerprint = Fields[1];
+    } else if (Fields[0] == "callee" && Fields.size() == 2 && Entry) {
+      Entry->InlinedCallees.push_back(unescapeField(Fields[1]));
+    } else if (Fields[0] == "report" && Fields.size() == 9 && Entry) {
+      StoredReport Report;
+      if (Fields[2].getAsInteger(10, Report.LineOffset) ||
+          Fields[3].getAsInteger(10, Report.Column))
+        return false;
+      Report.FunctionKey = unescapeField(Fields[1]);
+      Report.CheckName = unescapeField(Fields[4]);
+      Report.BugType = unescapeField(Fields[5]);
+      Report.Category = unescapeField(Fields[6]);
+      Report.ShortDescription = unescapeField(Fields[7]);
+      Report.VerboseDescription = unescapeField(Fields[8]);
+      Entry->Reports.push_back(Report);
+    } else {
+      return false;
+    }
+  }
+
+  // The state of a run with other checkers or options is of no use; the file
+  // is then simply overwritten.
+  if (SameConfig)
+    Previous = std::move(Entries);
+  return true;
+}
+
+bool IncrementalAnalysis::writeToFile(StringRef Path) const {
+  std::vector<StringRef> Keys;
+  for (const auto &Entry : Current)
+    if (Entry.second.Complete && !Entry.second.Fingerprint.empty())
+      Keys.push_back(Entry.getKey());
+  std::sort(Keys.begin(), Keys.end());
+
+  // Write to a temporary file and rename it into place, so that concurrent
+  // runs never read a partially written file.
+  SmallString<256> TempPath;
+  int FD;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TempPath))
+    return false;
+
+  bool Failed;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << StateFileHeader << '\n';
+    OS << "config";
+    writeField(OS, ConfigHash);
+    OS << '\n';
+    for (StringRef Key : Keys) {
+      const FunctionEntry &Entry = Current.find(Key)->second;
+      OS << "function";
+      writeField(OS, Entry.Fingerprint);
+      writeField(OS, Key);
+      OS << '\n';
+      for (const std::string &Callee : Entry.InlinedCallees) {
+        OS << "callee";
+        writeField(OS, Callee);
+        OS << '\n';
+      }
+      for (const StoredReport &Report : Entry.Reports) {
+        OS << "report";
+        writeField(OS, Report.FunctionKey);
+        OS << '\t' << Report.LineOffset << '\t' << Report.Column;
+        writeField(OS, Report.CheckName);
+        writeField(OS, Report.BugType);
+        writeField(OS, Report.Category);
+        writeField(OS, Report.ShortDescription);
+        writeField(OS, Report.VerboseDescription);
+        OS << '\n';
+      }
+    }
+    OS.close();
+    Failed = OS.has_error();
+    OS.clear_error();
+  }
+
+  if (Failed || llvm::sys::fs::rename(TempPath, Path)) {
+    llvm::sys::fs::remove(TempPath);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,160 @@
+//===-- IncrementalAnalysis.h -----------------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief This file defines the clang::ento::IncrementalAnalysis class, which
+/// lets an analyzer run skip the top-level functions that did not change
+/// since an earlier run, and emit the reports found in them again instead.
+///
+/// A top-level function is unchanged when its fingerprint is: a digest of
+/// the source text, the pretty-printed definition and the position of the
+/// function and of every function it can reach in the call graph, and of
+/// the file scope they depend on. The file scope is the contents of every
+/// header and of the predefines buffer, which holds the command-line macros,
+/// and the pretty-printed declarations of the main file other than function
+/// bodies. Reports are stored relative to the start of the function
+/// containing them, so that edits to other functions of the file do not
+/// invalidate them.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_CLANG_SA_FRONTEND_INCREMENTALANALYSIS_H
+#define LLVM_CLANG_SA_FRONTEND_INCREMENTALANALYSIS_H
+
+#include "clang/Basic/SourceLocation.h"
+#include "clang/StaticAnalyzer/Core/PathDiagnosticConsumers.h"
+#include "clang/StaticAnalyzer/Core/PathSensitive/FunctionSummary.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+
+class ASTContext;
+class CallGraph;
+class CallGraphNode;
+class Decl;
+
+namespace ento {
+
+class AnalyzerOptions;
+class PathDiagnostic;
+
+class IncrementalAnalysis {
+public:
+  /// \brief A report found while analyzing a top-level function.
+  struct StoredReport {
+    /// The function containing the location of the report.
+    std::string FunctionKey;
+    /// The line of the report, relative to the first line of that function.
+    unsigned LineOffset;
+    unsigned Column;
+    std::string CheckName;
+    std::string BugType;
+    std::string Category;
+    std::string ShortDescription;
+    std::string VerboseDescription;
+  };
+
+  /// \brief What a run recorded about one top-level function.
+  struct FunctionEntry {
+    std::string Fingerprint;
+    /// The functions inlined while analyzing it, which are then not
+    /// analyzed as top-level functions themselves.
+    std::vector<std::string> InlinedCallees;
+    std::vector<StoredReport> Reports;
+    /// False if one of the reports could not be stored, in which case the
+    /// function is analyzed again by the next run.
+    bool Complete = true;
+  };
+
+private:
+  /// \brief Where a function is, and the digest of its definition.
+  struct FunctionInfo {
+    std::string Key;
+    std::string Digest;
+    FileID File;
+    unsigned BeginOffset = 0;
+    unsigned EndOffset = 0;
+    unsigned BeginLine = 0;
+  };
+
+  class ReportRecorder;
+
+  ASTContext &Ctx;
+
+  /// The digest of the analyzer version and configuration. The state of a
+  /// run made with another configuration is not used.
+  std::string ConfigHash;
+
+  /// The digest of the file scope shared by all functions; computed on
+  /// first use, and empty if a file could not be read.
+  std::string FileScopeDigest;
+  bool HasFileScopeDigest;
+
+  llvm::StringMap<FunctionEntry> Previous;
+  llvm::StringMap<FunctionEntry> Current;
+
+  llvm::DenseMap<const Decl *, FunctionInfo> Infos;
+  llvm::StringMap<const Decl *> DeclsByKey;
+
+  /// Owned by the AnalysisManager, with the other consumers.
+  ReportRecorder *Recorder;
+
+  /// The top-level function being analyzed, and the functions it reaches.
+  FunctionEntry *Recording;
+  std::string RecordingKey;
+  std::vector<const Decl *> RecordingFunctions;
+
+  const FunctionInfo &getInfo(const Decl *D);
+  const std::string &getFileScopeDigest();
+  bool storeReport(const PathDiagnostic &PD, StoredReport &Report);
+
+public:
+  IncrementalAnalysis(ASTContext &Ctx, AnalyzerOptions &Opts);
+
+  /// \brief Returns the consumer that records the reports of the analyzed
+  /// functions. It must be added to the consumers of the AnalysisManager.
+  PathDiagnosticConsumer *createReportRecorder();
+
+  /// \brief Reads the state written by an earlier run. Returns false if the
+  /// file could not be read.
+  bool readFromFile(StringRef Path);
+
+  /// \brief Writes the state of this run to \p Path. Returns false on
+  /// failure.
+  bool writeToFile(StringRef Path) const;
+
+  /// \brief Gives the name of every function of \p CG to it.
+  void addCallGraph(const CallGraph &CG);
+
+  /// \brief Returns the fingerprint of the top-level function \p N, or an
+  /// empty string if it must always be analyzed.
+  std::string getFingerprint(const CallGraphNode *N);
+
+  /// \brief Starts recording the reports of the top-level function \p N.
+  void beginFunction(const CallGraphNode *N, StringRef Fingerprint);
+
+  /// \brief If the function being recorded has the same fingerprint as in
+  /// the earlier run, emits its stored reports to \p Consumers, adds the
+  /// functions that were inlined into it to \p InlinedCallees and returns
+  /// true.
+  bool replayReports(const PathDiagnosticConsumers &Consumers,
+                     SetOfConstDecls &InlinedCallees);
+
+  /// \brief Stops recording, storing the reports emitted since
+  /// beginFunction().
+  void endFunction(const SetOfConstDecls &InlinedCallees);
+};
+
+} // end namespace ento
+} // end namespace clang
+
+#endif
@@ -13,59 +13,64 @@
 //===----------------------------------------------------------------------===//
 
 #include "clang/Tooling/ArgumentsAdjusters.h"
+#include <algorithm>
 
 namespace clang {
 namespace tooling {
 
 /// Add -fsyntax-only option to the commnand line arguments.
 ArgumentsAdjuster getClangSyntaxOnlyAdjuster() {
-  return [](const CommandLineArguments &Args, StringRef /*unused*/) {
-    CommandLineArguments AdjustedArgs;
-    for (size_t i = 0, e = Args.size(); i != e; ++i) {
-      StringRef Arg = Args[i];
-      // FIXME: Remove options that generate output.
-      if (!Arg.startswith("-fcolor-diagnostics") &&
-          !Arg.startswith("-fdiagnostics-color"))
-        AdjustedArgs.push_back(Args[i]);
-    }
-    AdjustedArgs.push_back("-fsyntax-only");
-    return AdjustedArgs;
+  return [](CommandLineArguments Args, StringRef /*unused*/) {
+    // FIXME: Remove options that generate output.
+    Args.erase(std::remove_if(Args.begin(), Args.end(),
+                              [](const std::string &Arg) {
+                                return StringRef(Arg).startswith(
+                                           "-fcolor-diagnostics") ||
+                                       StringRef(Arg).startswith(
+                                           "-fdiagnostics-color");
+                              }),
+               Args.end());
+    Args.push_back("-fsyntax-only");
+    return Args;
   };
 }
 
 ArgumentsAdjuster getClangStripOutputAdjuster() {
-  return [](const CommandLineArguments &Args, StringRef /*unused*/) {
-    CommandLineArguments AdjustedArgs;
-    for (size_t i = 0, e = Args.size(); i < e; ++i) {
-      StringRef Arg = Args[i];
-      if (!Arg.startswith("-o"))
-        AdjustedArgs.push_back(Args[i]);
-
+  return [](CommandLineArguments Args, StringRef /*unused*/) {
+    auto Kept = Args.begin();
+    for (auto I = Args.begin(), E = Args.end(); I != E; ++I) {
+      StringRef Arg = *I;
       if (Arg == "-o") {
         // Output is specified as -o foo. Skip the next argument also.
-        ++i;
+        if (++I == E)
+          break;
+        continue;
       }
-      // Else, the output is specified as -ofoo. Just do nothing.
+      // Else, the output is specified as -ofoo. Just skip it.
+      if (Arg.startswith("-o"))
+        continue;
+      if (Kept != I)
+        *Kept = std::move(*I);
+      ++Kept;
     }
-    return AdjustedArgs;
+    Args.erase(Kept, Args.end());
+    return Args;
   };
 }
 
 ArgumentsAdjuster getInsertArgumentAdjuster(const CommandLineArguments &Extra,
                                             ArgumentInsertPosition Pos) {
-  return [Extra, Pos](const CommandLineArguments &Args, StringRef /*unused*/) {
-    CommandLineArguments Return(Args);
-
+  return [Extra, Pos](CommandLineArguments Args, StringRef /*unused*/) {
     CommandLineArguments::iterator I;
     if (Pos == ArgumentInsertPosition::END) {
-      I = Return.end();
+      I = Args.end();
     } else {
-      I = Return.begin();
+      I = Args.begin();
       ++I; // To leave the program name in place
     }
 
-    Return.insert(I, Extra.begin(), Extra.end());
-    return Return;
+    Args.insert(I, Extra.begin(), Extra.end());
+    return Args;
   };
 }
 
@@ -76,8 +81,8 @@ ArgumentsAdjuster getInsertArgumentAdjuster(const char *Extra,
 
 ArgumentsAdjuster combineAdjusters(ArgumentsAdjuster First,
                                    ArgumentsAdjuster Second) {
-  return [First, Second](const CommandLineArguments &Args, StringRef File) {
-    return Second(First(Args, File), File);
+  return [First, Second](CommandLineArguments Args, StringRef File) {
+    return Second(First(std::move(Args), File), File);
   };
 }
 
@@ -86,7 +86,8 @@ private:
   adjustCommands(std::vector<CompileCommand> Commands) const {
     for (CompileCommand &Command : Commands)
       for (const auto &Adjuster : Adjusters)
-        Command.CommandLine = Adjuster(Command.CommandLine, Command.Filename);
+        Command.CommandLine =
+            Adjuster(std::move(Command.CommandLine), Command.Filename);
     return Commands;
   }
 };
@@ -22,7 +22,10 @@
 #include "clang/Rewrite/Core/Rewriter.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_os_ostream.h"
+#include <map>
+#include <thread>
 
 namespace clang {
 namespace tooling {
@@ -219,15 +222,29 @@ void deduplicate(std::vector<Replacement> &Replaces,
 }
 
 bool applyAllReplacements(const Replacements &Replaces, Rewriter &Rewrite) {
+  SourceManager &SM = Rewrite.getSourceMgr();
   bool Result = true;
-  for (Replacements::const_iterator I = Replaces.begin(),
-                                    E = Replaces.end();
-       I != E; ++I) {
-    if (I->isApplicable()) {
-      Result = I->apply(Rewrite) && Result;
-    } else {
+  // Replacements are ordered by offset, not by file, so gather the edits of
+  // each file first. Each file's edits keep their order, and are applied to
+  // its buffer in one batch.
+  std::map<StringRef, std::vector<RewriteBuffer::Edit>> EditsByFile;
+  for (const Replacement &R : Replaces) {
+    if (!R.isApplicable()) {
+      Result = false;
+      continue;
+    }
+    EditsByFile[R.getFilePath()].push_back(
+        {R.getOffset(), R.getLength(), R.getReplacementText()});
+  }
+
+  for (const auto &FileEdits : EditsByFile) {
+    const FileEntry *Entry = SM.getFileManager().getFile(FileEdits.first);
+    if (!Entry) {
       Result = false;
+      continue;
     }
+    FileID ID = SM.getOrCreateFileID(Entry, SrcMgr::C_User);
+    Rewrite.getEditBuffer(ID).ApplyEdits(FileEdits.second);
   }
   return Result;
 }
@@ -249,11 +266,44 @@ bool applyAllReplacements(const std::vector<Replacement> &Replaces,
   return Result;
 }
 
-llvm::Expected<std::string> applyAllReplacements(StringRef Code,
-                                                const Replacements &Replaces) {
-  if (Replaces.empty())
-    return Code.str();
+/// \brief Applies \p Replaces to \p Code with a single copy into \p Result,
+/// if they are sorted, within \p Code and do not overlap. Returns false and
+/// leaves \p Result alone otherwise.
+static bool applyInOnePass(StringRef Code, const Replacements &Replaces,
+                           std::string &Result) {
+  size_t ResultSize = Code.size();
+  unsigned End = 0;
+  for (const Replacement &Replace : Replaces) {
+    // Insertions at the same offset are kept in order, as by a Rewriter.
+    if (Replace.getOffset() < End ||
+        Replace.getOffset() + Replace.getLength() > Code.size())
+      return false;
+    End = Replace.getOffset() + Replace.getLength();
+    ResultSize += Replace.getReplacementText().size();
+    ResultSize -= Replace.getLength();
+  }
 
+  Result.clear();
+  Result.reserve(ResultSize);
+  unsigned Position = 0;
+  for (const Replacement &Replace : Replaces) {
+    Result.append(Code.data() + Position, Replace.getOffset() - Position);
+    Result.append(Replace.getReplacementText());
+    Position = Replace.getOffset() + Replace.getLength();
+  }
+  Result.append(Code.data() + Position, Code.size() - Position);
+  return true;
+}
+
+/// \brief Applies \p Replaces to \p Code through a Rewriter, ignoring their
+/// paths, and stores the code in \p Result.
+///
+/// Unless \p Independently is set, this stops at the first replacement that
+/// does not apply and stores it in \p Failed. Returns whether all
+/// replacements apply.
+static bool applyWithRewriter(StringRef Code, const Replacements &Replaces,
+                              bool Independently, std::string &Result,
+                              std::string &Failed) {
   IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
       new vfs::InMemoryFileSystem);
   FileManager Files(FileSystemOptions(), InMemoryFileSystem);
@@ -266,20 +316,129 @@ llvm::Expected<std::string> applyAllReplacements(StringRef Code,
       "<stdin>", 0, llvm::MemoryBuffer::getMemBuffer(Code, "<stdin>"));
   FileID ID = SourceMgr.createFileID(Files.getFile("<stdin>"), SourceLocation(),
                                      clang::SrcMgr::C_User);
+  bool AllApplied = true;
   for (Replacements::const_iterator I = Replaces.begin(), E = Replaces.end();
        I != E; ++I) {
     Replacement Replace("<stdin>", I->getOffset(), I->getLength(),
                         I->getReplacementText());
-    if (!Replace.apply(Rewrite))
-      return llvm::make_error<llvm::StringError>(
-          "Failed to apply replacement: " + Replace.toString(),
-          llvm::inconvertibleErrorCode());
+    if (!Replace.apply(Rewrite)) {
+      AllApplied = false;
+      if (!Independently) {
+        Failed = Replace.toString();
+        return false;
+      }
+    }
   }
-  std::string Result;
+  Result.clear();
   llvm::raw_string_ostream OS(Result);
   Rewrite.getEditBuffer(ID).write(OS);
   OS.flush();
-  return Result;
+  return AllApplied;
+}
+
+llvm::Expected<std::string> applyAllReplacements(StringRef Code,
+                                                const Replacements &Replaces) {
+  if (Replaces.empty())
+    return Code.str();
+
+  std::string Result, Failed;
+  if (applyInOnePass(Code, Replaces, Result) ||
+      applyWithRewriter(Code, Replaces, /*Independently=*/false, Result,
+                        Failed))
+    return Result;
+  return llvm::make_error<llvm::StringError>(
+      "Failed to apply replacement: " + Failed,
+      llvm::inconvertibleErrorCode());
+}
+
+bool applyAllReplacementsToFiles(const Replacements &Replaces,
+                                 bool &AllApplied, unsigned ThreadCount) {
+  AllApplied = true;
+
+  // Group the replacements by file rather than by path, so that no file is
+  // written by two threads.
+  std::map<llvm::sys::fs::UniqueID, std::pair<std::string, Replacements>>
+      FileToReplaces;
+  for (const auto &PathAndReplaces : groupReplacementsByFile(Replaces)) {
+    llvm::sys::fs::UniqueID ID;
+    if (llvm::sys::fs::getUniqueID(PathAndReplaces.first, ID)) {
+      AllApplied = false;
+      continue;
+    }
+    auto &File = FileToReplaces[ID];
+    if (File.first.empty())
+      File.first = PathAndReplaces.first;
+    File.second.insert(PathAndReplaces.second.begin(),
+                       PathAndReplaces.second.end());
+  }
+
+  struct FileResult {
+    bool Applied = true;
+    std::string Error;
+  };
+  std::vector<FileResult> Results(FileToReplaces.size());
+  if (!ThreadCount)
+    ThreadCount = std::max(1u, std::thread::hardware_concurrency());
+  {
+    llvm::ThreadPool Pool(ThreadCount);
+    unsigned Index = 0;
+    for (const auto &IDAndFile : FileToReplaces) {
+      const std::string &Path = IDAndFile.second.first;
+      const Replacements &FileReplaces = IDAndFile.second.second;
+      FileResult &Result = Results[Index++];
+      Pool.async([&Path, &FileReplaces, &Result] {
+        llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+            llvm::MemoryBuffer::getFile(Path);
+        if (!Buffer) {
+          Result.Applied = false;
+          return;
+        }
+        StringRef Code = (*Buffer)->getBuffer();
+        std::string NewCode, Failed;
+        if (!applyInOnePass(Code, FileReplaces, NewCode))
+          Result.Applied = applyWithRewriter(
+              Code, FileReplaces, /*Independently=*/true, NewCode, Failed);
+        if (NewCode == Code)
+          return;
+
+        SmallString<128> TempPath;
+        int FD;
+        if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD,
+                                            TempPath)) {
+          Result.Error = "unable to make temporary file: " + Path;
+          return;
+        }
+        {
+          llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+          OS << NewCode;
+          OS.close();
+          if (OS.has_error()) {
+            OS.clear_error();
+            llvm::sys::fs::remove(TempPath);
+            Result.Error = "unable to write file: " + TempPath.str().str();
+            return;
+          }
+        }
+        if (std::error_code EC = llvm::sys::fs::rename(TempPath, Path)) {
+          llvm::sys::fs::remove(TempPath);
+          Result.Error = "unable to rename temporary '" + TempPath.str().str() +
+                         "' to output file '" + Path + "': '" + EC.message() +
+                         "'";
+        }
+      });
+    }
+  }
+
+  bool AllWritten = true;
+  for (const FileResult &Result : Results) {
+    if (!Result.Applied)
+      AllApplied = false;
+    if (!Result.Error.empty()) {
+      llvm::errs() << "error: " << Result.Error << "\n";
+      AllWritten = false;
+    }
+  }
+  return AllWritten;
 }
 
 // Merge and sort overlapping ranges in \p Ranges.
@@ -21,10 +21,36 @@ using namespace clang;
 using namespace tooling;
 
 namespace {
-/// \brief Default \c PathComparator using \c llvm::sys::fs::equivalent().
-struct DefaultPathComparator : public PathComparator {
+/// \brief Default \c PathComparator, which compares the unique IDs of files
+/// like \c llvm::sys::fs::equivalent().
+///
+/// The unique ID of each file that exists is only looked up once.
+class DefaultPathComparator : public PathComparator {
+  mutable std::mutex Mutex;
+  mutable llvm::StringMap<llvm::sys::fs::UniqueID> UniqueIDs;
+
+  bool getUniqueID(StringRef Path, llvm::sys::fs::UniqueID &ID) const {
+    {
+      std::lock_guard<std::mutex> Lock(Mutex);
+      auto Known = UniqueIDs.find(Path);
+      if (Known != UniqueIDs.end()) {
+        ID = Known->second;
+        return true;
+      }
+    }
+    if (llvm::sys::fs::getUniqueID(Path, ID))
+      return false;
+    std::lock_guard<std::mutex> Lock(Mutex);
+    UniqueIDs[Path] = ID;
+    return true;
+  }
+
+public:
   bool equivalent(StringRef FileA, StringRef FileB) const override {
-    return FileA == FileB || llvm::sys::fs::equivalent(FileA, FileB);
+    if (FileA == FileB)
+      return true;
+    llvm::sys::fs::UniqueID IDA, IDB;
+    return getUniqueID(FileA, IDA) && getUniqueID(FileB, IDB) && IDA == IDB;
   }
 };
 }
@@ -173,6 +199,11 @@ FileMatchTrie::~FileMatchTrie() {
 
 void FileMatchTrie::insert(StringRef NewPath) {
   Root->insert(NewPath);
+  if (llvm::sys::path::is_absolute(NewPath))
+    Paths.insert(NewPath);
+  // The new path may be a better match, or make a match ambiguous.
+  std::lock_guard<std::mutex> Lock(MatchesMutex);
+  Matches.clear();
 }
 
 StringRef FileMatchTrie::findEquivalent(StringRef FileName,
@@ -181,9 +212,27 @@ StringRef FileMatchTrie::findEquivalent(StringRef FileName,
     Error << "Cannot resolve relative paths";
     return StringRef();
   }
+  // A path in the trie is the best match for itself.
+  auto Path = Paths.find(FileName);
+  if (Path != Paths.end())
+    return Path->first();
+  {
+    std::lock_guard<std::mutex> Lock(MatchesMutex);
+    auto Match = Matches.find(FileName);
+    if (Match != Matches.end())
+      return Match->second;
+  }
+
   bool IsAmbiguous = false;
   StringRef Result = Root->findEquivalent(*Comparator, FileName, IsAmbiguous);
-  if (IsAmbiguous)
+  if (IsAmbiguous) {
     Error << "Path is ambiguous";
+    return Result;
+  }
+  // Files that were not found may yet be created, so only matches are kept.
+  if (!Result.empty()) {
+    std::lock_guard<std::mutex> Lock(MatchesMutex);
+    Matches[FileName] = Result;
+  }
   return Result;
 }
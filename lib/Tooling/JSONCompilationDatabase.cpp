@@ -15,8 +15,14 @@
 #include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/CompilationDatabasePluginRegistry.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallString.h"
+#include "llvm/Support/ConvertUTF.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/EndianStream.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include <system_error>
 
 namespace clang {
@@ -117,13 +123,239 @@ std::vector<std::string> unescapeCommandLine(
   return parser.parse();
 }
 
+/// \brief A scanner of the JSON text of a compilation database.
+///
+/// Rather than building a document of the whole database, it reads the
+/// values it is asked for in place, and skips the others.
+class JSONScanner {
+public:
+  JSONScanner(StringRef Input, size_t Position = 0)
+      : Input(Input), Position(Position) {}
+
+  size_t getPosition() const { return Position; }
+
+  /// \brief Whether only whitespace is left.
+  bool atEnd() {
+    skipWhitespace();
+    return Position == Input.size();
+  }
+
+  /// \brief Whether the next character after any whitespace is \p C.
+  bool peek(char C) {
+    skipWhitespace();
+    return Position < Input.size() && Input[Position] == C;
+  }
+
+  /// \brief Consumes \p C if it is the next character after any whitespace.
+  bool consume(char C) {
+    if (!peek(C))
+      return false;
+    ++Position;
+    return true;
+  }
+
+  /// \brief Reads a string, and stores its value in \p Value unless it is
+  /// null. Returns false if the next value is not a valid string.
+  bool readString(std::string *Value) {
+    if (!consume('"'))
+      return false;
+    while (Position < Input.size()) {
+      // Copy the run of characters up to the next quote or escape at once.
+      size_t End = Input.find_first_of("\"\\", Position);
+      if (End == StringRef::npos)
+        return false;
+      if (Value)
+        Value->append(Input.data() + Position, End - Position);
+      Position = End + 1;
+      if (Input[End] == '"')
+        return true;
+      if (Position == Input.size())
+        return false;
+      char Escaped = Input[Position++];
+      char Unescaped;
+      switch (Escaped) {
+      case '"': case '\\': case '/': Unescaped = Escaped; break;
+      case 'b': Unescaped = '\b'; break;
+      case 'f': Unescaped = '\f'; break;
+      case 'n': Unescaped = '\n'; break;
+      case 'r': Unescaped = '\r'; break;
+      case 't': Unescaped = '\t'; break;
+      case 'u':
+        if (!readCodePoint(Value))
+          return false;
+        continue;
+      default:
+        return false;
+      }
+      if (Value)
+        Value->push_back(Unescaped);
+    }
+    return false;
+  }
+
+private:
+  void skipWhitespace() {
+    while (Position < Input.size() &&
+           (Input[Position] == ' ' || Input[Position] == '\t' ||
+            Input[Position] == '\n' || Input[Position] == '\r'))
+      ++Position;
+  }
+
+  bool readHex4(unsigned &Result) {
+    if (Position + 4 > Input.size())
+      return false;
+    if (Input.substr(Position, 4).getAsInteger(16, Result))
+      return false;
+    Position += 4;
+    return true;
+  }
+
+  /// \brief Reads the hex digits of a \u escape, and of the second escape of
+  /// a surrogate pair, and appends the code point to \p Value as UTF-8.
+  bool readCodePoint(std::string *Value) {
+    unsigned CodePoint;
+    if (!readHex4(CodePoint))
+      return false;
+    if (CodePoint >= 0xD800 && CodePoint < 0xDC00) {
+      unsigned Low;
+      if (!Input.substr(Position).startswith("\\u"))
+        return false;
+      Position += 2;
+      if (!readHex4(Low) || Low < 0xDC00 || Low >= 0xE000)
+        return false;
+      CodePoint = 0x10000 + ((CodePoint - 0xD800) << 10) + (Low - 0xDC00);
+    }
+    if (Value) {
+      char Buffer[UNI_MAX_UTF8_BYTES_PER_CODE_POINT];
+      char *End = Buffer;
+      if (!llvm::ConvertCodePointToUTF8(CodePoint, End))
+        return false;
+      Value->append(Buffer, End);
+    }
+    return true;
+  }
+
+  StringRef Input;
+  size_t Position;
+};
+
+/// \brief The fields of the JSON object of one compile command.
+struct CommandObject {
+  std::string Directory;
+  std::string File;
+  // If HasArguments is false, the shell-escaped command line in Command.
+  // Otherwise each literal argument to the compiler in Arguments.
+  bool HasArguments = false;
+  std::string Command;
+  std::vector<std::string> Arguments;
+};
+
+/// \brief Reads the compile command object at the position of \p Scanner.
+///
+/// Unless \p ReadCommandLine is set, the command line is checked but not
+/// stored, which is all that building the index needs.
+bool readCommandObject(JSONScanner &Scanner, bool ReadCommandLine,
+                       CommandObject &Object, std::string &ErrorMessage) {
+  if (!Scanner.consume('{')) {
+    ErrorMessage = "Expected object.";
+    return false;
+  }
+  bool HasDirectory = false, HasCommand = false, HasFile = false;
+  if (!Scanner.consume('}')) {
+    do {
+      std::string Key;
+      if (!Scanner.peek('"') || !Scanner.readString(&Key)) {
+        ErrorMessage = "Expected strings as key.";
+        return false;
+      }
+      if (!Scanner.consume(':')) {
+        ErrorMessage = "Expected value.";
+        return false;
+      }
+      if (Key == "arguments") {
+        if (!Scanner.consume('[')) {
+          ErrorMessage = "Expected sequence as value.";
+          return false;
+        }
+        Object.HasArguments = HasCommand = true;
+        Object.Arguments.clear();
+        if (!Scanner.consume(']')) {
+          do {
+            std::string Argument;
+            if (!Scanner.peek('"') ||
+                !Scanner.readString(ReadCommandLine ? &Argument : nullptr)) {
+              ErrorMessage = "Only strings are allowed in 'arguments'.";
+              return false;
+            }
+            if (ReadCommandLine)
+              Object.Arguments.push_back(std::move(Argument));
+          } while (Scanner.consume(','));
+          if (!Scanner.consume(']')) {
+            ErrorMessage = "Error while parsing JSON.";
+            return false;
+          }
+        }
+        continue;
+      }
+      if (!Scanner.peek('"')) {
+        ErrorMessage = "Expected string as value.";
+        return false;
+      }
+      std::string *Value;
+      if (Key == "directory") {
+        HasDirectory = true;
+        Value = &Object.Directory;
+      } else if (Key == "command") {
+        HasCommand = true;
+        // The arguments take precedence over the command.
+        Value = ReadCommandLine && !Object.HasArguments ? &Object.Command
+                                                        : nullptr;
+      } else if (Key == "file") {
+        HasFile = true;
+        Value = &Object.File;
+      } else {
+        ErrorMessage = "Unknown key: \"" + Key + "\"";
+        return false;
+      }
+      if (Value)
+        Value->clear();
+      if (!Scanner.readString(Value)) {
+        ErrorMessage = "Error while parsing JSON.";
+        return false;
+      }
+    } while (Scanner.consume(','));
+    if (!Scanner.consume('}')) {
+      ErrorMessage = "Error while parsing JSON.";
+      return false;
+    }
+  }
+  if (!HasFile) {
+    ErrorMessage = "Missing key: \"file\".";
+    return false;
+  }
+  if (!HasCommand) {
+    ErrorMessage = "Missing key: \"command\" or \"arguments\".";
+    return false;
+  }
+  if (!HasDirectory) {
+    ErrorMessage = "Missing key: \"directory\".";
+    return false;
+  }
+  return true;
+}
+
+/// \brief The magic number at the start of an index cache, which changes
+/// with its format.
+const char IndexCacheMagic[] = "CDBIDX01";
+
 class JSONCompilationDatabasePlugin : public CompilationDatabasePlugin {
   std::unique_ptr<CompilationDatabase>
   loadFromDirectory(StringRef Directory, std::string &ErrorMessage) override {
     SmallString<1024> JSONDatabasePath(Directory);
     llvm::sys::path::append(JSONDatabasePath, "compile_commands.json");
     std::unique_ptr<CompilationDatabase> Database(
-        JSONCompilationDatabase::loadFromFile(JSONDatabasePath, ErrorMessage));
+        JSONCompilationDatabase::loadFromFile(JSONDatabasePath, ErrorMessage,
+                                              /*UseIndexCache=*/true));
     if (!Database)
       return nullptr;
     return Database;
@@ -143,7 +375,8 @@ volatile int JSONAnchorSource = 0;
 
 std::unique_ptr<JSONCompilationDatabase>
 JSONCompilationDatabase::loadFromFile(StringRef FilePath,
-                                      std::string &ErrorMessage) {
+                                      std::string &ErrorMessage,
+                                      bool UseIndexCache) {
   llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> DatabaseBuffer =
       llvm::MemoryBuffer::getFile(FilePath);
   if (std::error_code Result = DatabaseBuffer.getError()) {
@@ -152,8 +385,21 @@ JSONCompilationDatabase::loadFromFile(StringRef FilePath,
   }
   std::unique_ptr<JSONCompilationDatabase> Database(
       new JSONCompilationDatabase(std::move(*DatabaseBuffer)));
+
+  llvm::sys::fs::file_status Status;
+  if (!UseIndexCache || llvm::sys::fs::status(FilePath, Status)) {
+    if (!Database->parse(ErrorMessage))
+      return nullptr;
+    return Database;
+  }
+
+  std::string IndexPath = (FilePath + ".index").str();
+  uint64_t ModTime = Status.getLastModificationTime().toEpochTime();
+  if (Database->readIndexCache(IndexPath, Status.getSize(), ModTime))
+    return Database;
   if (!Database->parse(ErrorMessage))
     return nullptr;
+  Database->writeIndexCache(IndexPath, Status.getSize(), ModTime);
   return Database;
 }
 
@@ -210,135 +456,155 @@ JSONCompilationDatabase::getAllCompileCommands() const {
   return Commands;
 }
 
-static std::vector<std::string>
-nodeToCommandLine(const std::vector<llvm::yaml::ScalarNode *> &Nodes) {
-  SmallString<1024> Storage;
-  if (Nodes.size() == 1) {
-    return unescapeCommandLine(Nodes[0]->getValue(Storage));
-  }
-  std::vector<std::string> Arguments;
-  for (auto *Node : Nodes) {
-    Arguments.push_back(Node->getValue(Storage));
-  }
-  return Arguments;
-}
-
 void JSONCompilationDatabase::getCommands(
     ArrayRef<CompileCommandRef> CommandsRef,
     std::vector<CompileCommand> &Commands) const {
-  for (int I = 0, E = CommandsRef.size(); I != E; ++I) {
-    SmallString<8> DirectoryStorage;
-    SmallString<32> FilenameStorage;
-    Commands.emplace_back(
-      std::get<0>(CommandsRef[I])->getValue(DirectoryStorage),
-      std::get<1>(CommandsRef[I])->getValue(FilenameStorage),
-      nodeToCommandLine(std::get<2>(CommandsRef[I])));
+  for (CompileCommandRef Offset : CommandsRef) {
+    JSONScanner Scanner(Database->getBuffer(), Offset);
+    CommandObject Object;
+    std::string ErrorMessage;
+    // The objects were checked when the index was created.
+    if (!readCommandObject(Scanner, /*ReadCommandLine=*/true, Object,
+                           ErrorMessage))
+      continue;
+    Commands.emplace_back(Object.Directory, Object.File,
+                          Object.HasArguments
+                              ? std::move(Object.Arguments)
+                              : unescapeCommandLine(Object.Command));
   }
 }
 
+void JSONCompilationDatabase::addCommand(StringRef NativeFilePath,
+                                         uint64_t Offset) {
+  IndexByFile[NativeFilePath].push_back(Offset);
+  AllCommands.push_back(Offset);
+  MatchTrie.insert(NativeFilePath);
+}
+
 bool JSONCompilationDatabase::parse(std::string &ErrorMessage) {
-  llvm::yaml::document_iterator I = YAMLStream.begin();
-  if (I == YAMLStream.end()) {
-    ErrorMessage = "Error while parsing YAML.";
-    return false;
-  }
-  llvm::yaml::Node *Root = I->getRoot();
-  if (!Root) {
-    ErrorMessage = "Error while parsing YAML.";
+  JSONScanner Scanner(Database->getBuffer());
+  if (Scanner.atEnd()) {
+    ErrorMessage = "Error while parsing JSON.";
     return false;
   }
-  llvm::yaml::SequenceNode *Array = dyn_cast<llvm::yaml::SequenceNode>(Root);
-  if (!Array) {
+  if (!Scanner.consume('[')) {
     ErrorMessage = "Expected array.";
     return false;
   }
-  for (auto& NextObject : *Array) {
-    llvm::yaml::MappingNode *Object = dyn_cast<llvm::yaml::MappingNode>(&NextObject);
-    if (!Object) {
-      ErrorMessage = "Expected object.";
-      return false;
-    }
-    llvm::yaml::ScalarNode *Directory = nullptr;
-    llvm::Optional<std::vector<llvm::yaml::ScalarNode *>> Command;
-    llvm::yaml::ScalarNode *File = nullptr;
-    for (auto& NextKeyValue : *Object) {
-      llvm::yaml::ScalarNode *KeyString =
-          dyn_cast<llvm::yaml::ScalarNode>(NextKeyValue.getKey());
-      if (!KeyString) {
-        ErrorMessage = "Expected strings as key.";
-        return false;
-      }
-      SmallString<10> KeyStorage;
-      StringRef KeyValue = KeyString->getValue(KeyStorage);
-      llvm::yaml::Node *Value = NextKeyValue.getValue();
-      if (!Value) {
-        ErrorMessage = "Expected value.";
+  if (!Scanner.consume(']')) {
+    do {
+      if (!Scanner.peek('{')) {
+        ErrorMessage = "Expected object.";
         return false;
       }
-      llvm::yaml::ScalarNode *ValueString =
-          dyn_cast<llvm::yaml::ScalarNode>(Value);
-      llvm::yaml::SequenceNode *SequenceString =
-          dyn_cast<llvm::yaml::SequenceNode>(Value);
-      if (KeyValue == "arguments" && !SequenceString) {
-        ErrorMessage = "Expected sequence as value.";
+      uint64_t Offset = Scanner.getPosition();
+      CommandObject Object;
+      if (!readCommandObject(Scanner, /*ReadCommandLine=*/false, Object,
+                             ErrorMessage))
         return false;
-      } else if (KeyValue != "arguments" && !ValueString) {
-        ErrorMessage = "Expected string as value.";
-        return false;
-      }
-      if (KeyValue == "directory") {
-        Directory = ValueString;
-      } else if (KeyValue == "arguments") {
-        Command = std::vector<llvm::yaml::ScalarNode *>();
-        for (auto &Argument : *SequenceString) {
-          auto Scalar = dyn_cast<llvm::yaml::ScalarNode>(&Argument);
-          if (!Scalar) {
-            ErrorMessage = "Only strings are allowed in 'arguments'.";
-            return false;
-          }
-          Command->push_back(Scalar);
-        }
-      } else if (KeyValue == "command") {
-        if (!Command)
-          Command = std::vector<llvm::yaml::ScalarNode *>(1, ValueString);
-      } else if (KeyValue == "file") {
-        File = ValueString;
+
+      SmallString<128> NativeFilePath;
+      if (llvm::sys::path::is_relative(Object.File)) {
+        SmallString<128> AbsolutePath(Object.Directory);
+        llvm::sys::path::append(AbsolutePath, Object.File);
+        llvm::sys::path::native(AbsolutePath, NativeFilePath);
       } else {
-        ErrorMessage = ("Unknown key: \"" +
-                        KeyString->getRawValue() + "\"").str();
-        return false;
+        llvm::sys::path::native(Object.File, NativeFilePath);
       }
-    }
-    if (!File) {
-      ErrorMessage = "Missing key: \"file\".";
+      addCommand(NativeFilePath, Offset);
+    } while (Scanner.consume(','));
+    if (!Scanner.consume(']')) {
+      ErrorMessage = "Error while parsing JSON.";
       return false;
     }
-    if (!Command) {
-      ErrorMessage = "Missing key: \"command\" or \"arguments\".";
+  }
+  if (!Scanner.atEnd()) {
+    ErrorMessage = "Error while parsing JSON.";
+    return false;
+  }
+  return true;
+}
+
+// The index cache holds the magic number, the size and modification time of
+// the database, and the number of commands, followed by the offset, the
+// length of the path and the path of each command. Numbers are little endian.
+
+bool JSONCompilationDatabase::readIndexCache(StringRef IndexPath,
+                                             uint64_t Size, uint64_t ModTime) {
+  using namespace llvm::support;
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> Buffer =
+      llvm::MemoryBuffer::getFile(IndexPath, /*FileSize=*/-1,
+                                  /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return false;
+  StringRef Data = (*Buffer)->getBuffer();
+  const size_t MagicSize = sizeof(IndexCacheMagic) - 1;
+  if (Data.size() < MagicSize + 20 ||
+      !Data.startswith(StringRef(IndexCacheMagic, MagicSize)))
+    return false;
+  const char *Ptr = Data.data() + MagicSize;
+  const char *End = Data.data() + Data.size();
+  if (endian::readNext<uint64_t, little, unaligned>(Ptr) != Size ||
+      endian::readNext<uint64_t, little, unaligned>(Ptr) != ModTime)
+    return false;
+
+  uint32_t NumCommands = endian::readNext<uint32_t, little, unaligned>(Ptr);
+  std::vector<std::pair<StringRef, uint64_t>> Commands;
+  for (uint32_t I = 0; I != NumCommands; ++I) {
+    if (End - Ptr < 12)
       return false;
-    }
-    if (!Directory) {
-      ErrorMessage = "Missing key: \"directory\".";
+    uint64_t Offset = endian::readNext<uint64_t, little, unaligned>(Ptr);
+    uint32_t Length = endian::readNext<uint32_t, little, unaligned>(Ptr);
+    if (uint64_t(End - Ptr) < Length || Offset >= Size)
       return false;
+    Commands.push_back(std::make_pair(StringRef(Ptr, Length), Offset));
+    Ptr += Length;
+  }
+  if (Ptr != End)
+    return false;
+
+  for (const auto &PathAndOffset : Commands)
+    addCommand(PathAndOffset.first, PathAndOffset.second);
+  return true;
+}
+
+void JSONCompilationDatabase::writeIndexCache(StringRef IndexPath,
+                                              uint64_t Size,
+                                              uint64_t ModTime) const {
+  using namespace llvm::support;
+  // Concurrent tools may write the cache at once, so each writes a file of
+  // its own and renames it into place.
+  int FD;
+  SmallString<128> TempPath;
+  if (llvm::sys::fs::createUniqueFile(IndexPath + "-%%%%%%%%", FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    endian::Writer<little> LE(OS);
+    OS << StringRef(IndexCacheMagic, sizeof(IndexCacheMagic) - 1);
+    LE.write<uint64_t>(Size);
+    LE.write<uint64_t>(ModTime);
+    LE.write<uint32_t>(AllCommands.size());
+    // Write the commands in the order of the database, so that
+    // getAllCompileCommands keeps its order when loaded from the cache.
+    llvm::DenseMap<CompileCommandRef, StringRef> PathOfCommand;
+    for (const auto &FileAndCommands : IndexByFile)
+      for (CompileCommandRef Command : FileAndCommands.second)
+        PathOfCommand[Command] = FileAndCommands.first();
+    for (CompileCommandRef Command : AllCommands) {
+      StringRef Path = PathOfCommand[Command];
+      LE.write<uint64_t>(Command);
+      LE.write<uint32_t>(Path.size());
+      OS << Path;
     }
-    SmallString<8> FileStorage;
-    StringRef FileName = File->getValue(FileStorage);
-    SmallString<128> NativeFilePath;
-    if (llvm::sys::path::is_relative(FileName)) {
-      SmallString<8> DirectoryStorage;
-      SmallString<128> AbsolutePath(
-          Directory->getValue(DirectoryStorage));
-      llvm::sys::path::append(AbsolutePath, FileName);
-      llvm::sys::path::native(AbsolutePath, NativeFilePath);
-    } else {
-      llvm::sys::path::native(FileName, NativeFilePath);
+    if (OS.has_error()) {
+      OS.clear_error();
+      llvm::sys::fs::remove(TempPath);
+      return;
     }
-    auto Cmd = CompileCommandRef(Directory, File, *Command);
-    IndexByFile[NativeFilePath].push_back(Cmd);
-    AllCommands.push_back(Cmd);
-    MatchTrie.insert(NativeFilePath);
   }
-  return true;
+  if (llvm::sys::fs::rename(TempPath, IndexPath))
+    llvm::sys::fs::remove(TempPath);
 }
 
 } // end namespace tooling
@@ -33,35 +33,31 @@ RefactoringTool::RefactoringTool(
 
 Replacements &RefactoringTool::getReplacements() { return Replace; }
 
+void RefactoringTool::addReplacements(const Replacements &Replaces) {
+  std::lock_guard<std::mutex> Lock(ReplaceMutex);
+  Replace.insert(Replaces.begin(), Replaces.end());
+}
+
 int RefactoringTool::runAndSave(FrontendActionFactory *ActionFactory) {
   if (int Result = run(ActionFactory)) {
     return Result;
   }
 
-  LangOptions DefaultLangOptions;
-  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
-  TextDiagnosticPrinter DiagnosticPrinter(llvm::errs(), &*DiagOpts);
-  DiagnosticsEngine Diagnostics(
-      IntrusiveRefCntPtr<DiagnosticIDs>(new DiagnosticIDs()),
-      &*DiagOpts, &DiagnosticPrinter, false);
-  SourceManager Sources(Diagnostics, getFiles());
-  Rewriter Rewrite(Sources, DefaultLangOptions);
-
-  if (!applyAllReplacements(Rewrite)) {
+  // Apply the replacements file by file rather than through a Rewriter, so
+  // that large changes are written in parallel.
+  bool AllApplied;
+  bool AllWritten = applyAllReplacementsToFiles(Replace, AllApplied);
+  if (!AllApplied) {
     llvm::errs() << "Skipped some replacements.\n";
   }
 
-  return saveRewrittenFiles(Rewrite);
+  return AllWritten ? 0 : 1;
 }
 
 bool RefactoringTool::applyAllReplacements(Rewriter &Rewrite) {
   return tooling::applyAllReplacements(Replace, Rewrite);
 }
 
-int RefactoringTool::saveRewrittenFiles(Rewriter &Rewrite) {
-  return Rewrite.overwriteChangedFiles() ? 1 : 0;
-}
-
 bool formatAndApplyAllReplacements(const Replacements &Replaces,
                                    Rewriter &Rewrite, StringRef Style) {
   SourceManager &SM = Rewrite.getSourceMgr();
@@ -24,13 +24,17 @@
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Tooling/ArgumentsAdjusters.h"
 #include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <mutex>
 #include <utility>
 
 #define DEBUG_TYPE "clang-tooling"
@@ -92,7 +96,7 @@ clang::CompilerInvocation *newInvocation(
     const llvm::opt::ArgStringList &CC1Args) {
   assert(!CC1Args.empty() && "Must at least contain the program name!");
   clang::CompilerInvocation *Invocation = new clang::CompilerInvocation;
-  clang::CompilerInvocation::CreateFromArgs(
+  clang::CompilerInvocation::CreateFromArgsCached(
       *Invocation, CC1Args.data() + 1, CC1Args.data() + CC1Args.size(),
       *Diagnostics);
   Invocation->getFrontendOpts().DisableFree = false;
@@ -321,7 +325,7 @@ ClangTool::ClangTool(const CompilationDatabase &Compilations,
       OverlayFileSystem(new vfs::OverlayFileSystem(vfs::getRealFileSystem())),
       InMemoryFileSystem(new vfs::InMemoryFileSystem),
       Files(new FileManager(FileSystemOptions(), OverlayFileSystem)),
-      DiagConsumer(nullptr) {
+      DiagConsumer(nullptr), ThreadCount(1) {
   OverlayFileSystem->pushOverlay(InMemoryFileSystem);
   appendArgumentsAdjuster(getClangStripOutputAdjuster());
   appendArgumentsAdjuster(getClangSyntaxOnlyAdjuster());
@@ -357,16 +361,91 @@ static void injectResourceDir(CommandLineArguments &Args, const char *Argv0,
                  CompilerInvocation::GetResourcesPath(Argv0, MainAddr));
 }
 
-int ClangTool::run(ToolAction *Action) {
-  // Exists solely for the purpose of lookup of the resource path.
-  // This just needs to be some symbol in the binary.
-  static int StaticSymbol;
+// Exists solely for the purpose of lookup of the resource path.
+// This just needs to be some symbol in the binary.
+static int StaticSymbol;
+
+bool ClangTool::runCommand(ToolAction *Action, StringRef File,
+                           CompileCommand Command,
+                           vfs::OverlayFileSystem &OverlayFS,
+                           vfs::InMemoryFileSystem &InMemoryFS,
+                           FileManager &Files,
+                           llvm::StringSet<> &SeenWorkingDirectories,
+                           StringRef InitialDirectory) {
+  // FIXME: chdir is thread hostile; on the other hand, creating the same
+  // behavior as chdir is complex: chdir resolves the path once, thus
+  // guaranteeing that all subsequent relative path operations work
+  // on the same path the original chdir resulted in. This makes a
+  // difference for example on network filesystems, where symlinks might be
+  // switched during runtime of the tool. Fixing this depends on having a
+  // file system abstraction that allows openat() style interactions.
+  if (OverlayFS.setCurrentWorkingDirectory(Command.Directory))
+    llvm::report_fatal_error("Cannot chdir into \"" +
+                             Twine(Command.Directory) + "\n!");
+
+  // Now fill the in-memory VFS with the relative file mappings so it will
+  // have the correct relative paths. We never remove mappings but that
+  // should be fine.
+  if (SeenWorkingDirectories.insert(Command.Directory).second)
+    for (const auto &MappedFile : MappedFileContents)
+      if (!llvm::sys::path::is_absolute(MappedFile.first))
+        InMemoryFS.addFile(
+            MappedFile.first, 0,
+            llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+
+  std::vector<std::string> CommandLine = std::move(Command.CommandLine);
+  if (ArgsAdjuster)
+    CommandLine = ArgsAdjuster(std::move(CommandLine), Command.Filename);
+  assert(!CommandLine.empty());
+
+  // Add the resource dir based on the binary of this tool. argv[0] in the
+  // compilation database may refer to a different compiler and we want to
+  // pick up the very same standard library that compiler is using. The
+  // builtin headers in the resource dir need to match the exact clang
+  // version the tool is using.
+  // FIXME: On linux, GetMainExecutable is independent of the value of the
+  // first argument, thus allowing ClangTool and runToolOnCode to just
+  // pass in made-up names here. Make sure this works on other platforms.
+  injectResourceDir(CommandLine, "clang_tool", &StaticSymbol);
+
+  // A file manager with a working directory of its own stands in for the
+  // chdir above, which only the file system sees; let the driver and the
+  // frontend resolve relative paths against the same directory.
+  StringRef WorkingDir = Files.getFileSystemOpts().WorkingDir;
+  if (!WorkingDir.empty()) {
+    CommandLine.push_back("-working-directory");
+    CommandLine.push_back(WorkingDir);
+  }
 
+  // FIXME: We need a callback mechanism for the tool writer to output a
+  // customized message for each file.
+  DEBUG({ llvm::dbgs() << "Processing: " << File << ".\n"; });
+  ToolInvocation Invocation(std::move(CommandLine), Action, &Files,
+                            PCHContainerOps);
+  Invocation.setDiagnosticConsumer(DiagConsumer);
+
+  bool Success = Invocation.run();
+  if (!Success) {
+    // FIXME: Diagnostics should be used instead.
+    llvm::errs() << "Error while processing " << File << ".\n";
+  }
+  // Return to the initial directory to correctly resolve next file by
+  // relative path.
+  if (OverlayFS.setCurrentWorkingDirectory(InitialDirectory))
+    llvm::report_fatal_error("Cannot chdir into \"" +
+                             Twine(InitialDirectory) + "\n!");
+  return Success;
+}
+
+int ClangTool::run(ToolAction *Action) {
   llvm::SmallString<128> InitialDirectory;
   if (std::error_code EC = llvm::sys::fs::current_path(InitialDirectory))
     llvm::report_fatal_error("Cannot detect current path: " +
                              Twine(EC.message()));
 
+  if (ThreadCount > 1)
+    return runInParallel(Action, InitialDirectory);
+
   // First insert all absolute paths into the in-memory VFS. These are global
   // for all compile commands.
   if (SeenWorkingDirectories.insert("/").second)
@@ -398,63 +477,139 @@ int ClangTool::run(ToolAction *Action) {
       llvm::errs() << "Skipping " << File << ". Compile command not found.\n";
       continue;
     }
-    for (CompileCommand &CompileCommand : CompileCommandsForFile) {
-      // FIXME: chdir is thread hostile; on the other hand, creating the same
-      // behavior as chdir is complex: chdir resolves the path once, thus
-      // guaranteeing that all subsequent relative path operations work
-      // on the same path the original chdir resulted in. This makes a
-      // difference for example on network filesystems, where symlinks might be
-      // switched during runtime of the tool. Fixing this depends on having a
-      // file system abstraction that allows openat() style interactions.
-      if (OverlayFileSystem->setCurrentWorkingDirectory(
-              CompileCommand.Directory))
-        llvm::report_fatal_error("Cannot chdir into \"" +
-                                 Twine(CompileCommand.Directory) + "\n!");
-
-      // Now fill the in-memory VFS with the relative file mappings so it will
-      // have the correct relative paths. We never remove mappings but that
-      // should be fine.
-      if (SeenWorkingDirectories.insert(CompileCommand.Directory).second)
-        for (const auto &MappedFile : MappedFileContents)
-          if (!llvm::sys::path::is_absolute(MappedFile.first))
-            InMemoryFileSystem->addFile(
-                MappedFile.first, 0,
-                llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
-
-      std::vector<std::string> CommandLine = CompileCommand.CommandLine;
-      if (ArgsAdjuster)
-        CommandLine = ArgsAdjuster(CommandLine, CompileCommand.Filename);
-      assert(!CommandLine.empty());
-
-      // Add the resource dir based on the binary of this tool. argv[0] in the
-      // compilation database may refer to a different compiler and we want to
-      // pick up the very same standard library that compiler is using. The
-      // builtin headers in the resource dir need to match the exact clang
-      // version the tool is using.
-      // FIXME: On linux, GetMainExecutable is independent of the value of the
-      // first argument, thus allowing ClangTool and runToolOnCode to just
-      // pass in made-up names here. Make sure this works on other platforms.
-      injectResourceDir(CommandLine, "clang_tool", &StaticSymbol);
-
-      // FIXME: We need a callback mechanism for the tool writer to output a
-      // customized message for each file.
-      DEBUG({ llvm::dbgs() << "Processing: " << File << ".\n"; });
-      ToolInvocation Invocation(std::move(CommandLine), Action, Files.get(),
-                                PCHContainerOps);
-      Invocation.setDiagnosticConsumer(DiagConsumer);
-
-      if (!Invocation.run()) {
-        // FIXME: Diagnostics should be used instead.
-        llvm::errs() << "Error while processing " << File << ".\n";
+    for (CompileCommand &CompileCommand : CompileCommandsForFile)
+      if (!runCommand(Action, File, std::move(CompileCommand),
+                      *OverlayFileSystem, *InMemoryFileSystem, *Files,
+                      SeenWorkingDirectories, InitialDirectory))
         ProcessingFailed = true;
-      }
-      // Return to the initial directory to correctly resolve next file by
-      // relative path.
-      if (OverlayFileSystem->setCurrentWorkingDirectory(InitialDirectory.c_str()))
-        llvm::report_fatal_error("Cannot chdir into \"" +
-                                 Twine(InitialDirectory) + "\n!");
+  }
+  return ProcessingFailed ? 1 : 0;
+}
+
+namespace {
+
+/// \brief A file system that resolves relative paths against a working
+/// directory of its own rather than the one of the process, so that each
+/// thread of a parallel run can have one.
+class WorkingDirectoryFileSystem : public vfs::FileSystem {
+  IntrusiveRefCntPtr<vfs::FileSystem> Base;
+  std::string WorkingDirectory;
+
+  std::string resolve(const Twine &Path) const {
+    SmallString<256> Resolved;
+    Path.toVector(Resolved);
+    if (!llvm::sys::path::is_absolute(Resolved)) {
+      SmallString<256> Relative(Resolved);
+      Resolved = WorkingDirectory;
+      llvm::sys::path::append(Resolved, Relative);
     }
+    return Resolved.str();
+  }
+
+public:
+  WorkingDirectoryFileSystem(IntrusiveRefCntPtr<vfs::FileSystem> Base,
+                             StringRef WorkingDirectory)
+      : Base(std::move(Base)), WorkingDirectory(WorkingDirectory) {}
+
+  llvm::ErrorOr<vfs::Status> status(const Twine &Path) override {
+    llvm::ErrorOr<vfs::Status> Status = Base->status(resolve(Path));
+    if (!Status)
+      return Status;
+    return vfs::Status::copyWithNewName(*Status, Path.str());
+  }
+
+  llvm::ErrorOr<std::unique_ptr<vfs::File>>
+  openFileForRead(const Twine &Path) override {
+    return Base->openFileForRead(resolve(Path));
+  }
+
+  vfs::directory_iterator dir_begin(const Twine &Dir,
+                                    std::error_code &EC) override {
+    return Base->dir_begin(resolve(Dir), EC);
   }
+
+  std::error_code setCurrentWorkingDirectory(const Twine &Path) override {
+    std::string Directory = resolve(Path);
+    llvm::ErrorOr<vfs::Status> Status = Base->status(Directory);
+    if (!Status)
+      return Status.getError();
+    if (!Status->isDirectory())
+      return std::make_error_code(std::errc::not_a_directory);
+    WorkingDirectory = std::move(Directory);
+    return std::error_code();
+  }
+
+  llvm::ErrorOr<std::string> getCurrentWorkingDirectory() const override {
+    return WorkingDirectory;
+  }
+};
+
+} // end anonymous namespace
+
+int ClangTool::runInParallel(ToolAction *Action, StringRef InitialDirectory) {
+  // Look up all compile commands first, as the compilation database may not
+  // be thread-safe.
+  std::vector<std::pair<std::string, CompileCommand>> Commands;
+  for (const auto &SourcePath : SourcePaths) {
+    std::string File(getAbsolutePath(SourcePath));
+    std::vector<CompileCommand> CompileCommandsForFile =
+        Compilations.getCompileCommands(File);
+    if (CompileCommandsForFile.empty()) {
+      llvm::errs() << "Skipping " << File << ". Compile command not found.\n";
+      continue;
+    }
+    for (CompileCommand &CompileCommand : CompileCommandsForFile)
+      Commands.push_back(std::make_pair(File, std::move(CompileCommand)));
+  }
+
+  SharedStatResults StatResults;
+  SharedFileBuffers FileBuffers;
+  std::atomic<unsigned> NextCommand(0);
+  std::atomic<bool> ProcessingFailed(false);
+  auto RunCommands = [&] {
+    IntrusiveRefCntPtr<vfs::OverlayFileSystem> OverlayFS(
+        new vfs::OverlayFileSystem(new WorkingDirectoryFileSystem(
+            vfs::getRealFileSystem(), InitialDirectory)));
+    IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFS(
+        new vfs::InMemoryFileSystem);
+    OverlayFS->pushOverlay(InMemoryFS);
+    // The process' working directory is shared by every thread, so each
+    // command gets a file manager resolving relative paths against its own
+    // directory, kept for the later commands run from there.
+    llvm::StringMap<IntrusiveRefCntPtr<FileManager>> ThreadFiles;
+    auto getFiles = [&](StringRef Directory) -> FileManager & {
+      IntrusiveRefCntPtr<FileManager> &Files = ThreadFiles[Directory];
+      if (!Files) {
+        FileSystemOptions FSOpts;
+        FSOpts.WorkingDir = Directory;
+        Files = new FileManager(FSOpts, OverlayFS);
+        Files->setSharedFileBuffers(&FileBuffers);
+      }
+      return *Files;
+    };
+    llvm::StringSet<> ThreadWorkingDirectories;
+    for (const auto &MappedFile : MappedFileContents)
+      if (llvm::sys::path::is_absolute(MappedFile.first))
+        InMemoryFS->addFile(
+            MappedFile.first, 0,
+            llvm::MemoryBuffer::getMemBuffer(MappedFile.second));
+
+    for (unsigned I = NextCommand++; I < Commands.size(); I = NextCommand++) {
+      FileManager &Files = getFiles(Commands[I].second.Directory);
+      Files.addStatCache(
+          llvm::make_unique<SharedStatResultsCache>(StatResults));
+      if (!runCommand(Action, Commands[I].first,
+                      std::move(Commands[I].second), *OverlayFS, *InMemoryFS,
+                      Files, ThreadWorkingDirectories, InitialDirectory))
+        ProcessingFailed = true;
+      Files.clearStatCaches();
+    }
+  };
+
+  llvm::ThreadPool Pool(ThreadCount);
+  for (unsigned I = 0; I != ThreadCount; ++I)
+    Pool.async(RunCommands);
+  Pool.wait();
   return ProcessingFailed ? 1 : 0;
 }
 
@@ -462,6 +617,7 @@ namespace {
 
 class ASTBuilderAction : public ToolAction {
   std::vector<std::unique_ptr<ASTUnit>> &ASTs;
+  std::mutex ASTsMutex;
 
 public:
   ASTBuilderAction(std::vector<std::unique_ptr<ASTUnit>> &ASTs) : ASTs(ASTs) {}
@@ -478,6 +634,7 @@ public:
     if (!AST)
       return false;
 
+    std::lock_guard<std::mutex> Lock(ASTsMutex);
     ASTs.push_back(std::move(AST));
     return true;
   }
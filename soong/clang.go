@@ -15,6 +15,8 @@
 package clang
 
 import (
+	"strings"
+
 	"android/soong/android"
 	"android/soong/cc"
 
@@ -26,6 +28,50 @@ import (
 
 func init() {
 	android.RegisterModuleType("clang_binary_host", clangBinaryHostFactory)
+	android.RegisterModuleType("clang_defaults", clangDefaultsFactory)
+}
+
+// The stages of a profile-guided build of the host clang set these, see
+// build.py:
+//   FORCE_BUILD_LLVM_PGO_GENERATE  instrument clang to write profiles
+//   LLVM_PGO_PROFILE               optimize clang with this merged profile
+//   FORCE_BUILD_LLVM_THINLTO       link clang with ThinLTO
+//   LLVM_THINLTO_JOBS              the number of ThinLTO backend threads
+func clangPgoAndLto(ctx android.LoadHookContext) {
+	type props struct {
+		Target struct {
+			Linux struct {
+				Cflags  []string
+				Ldflags []string
+			}
+		}
+	}
+	p := &props{}
+	linux := &p.Target.Linux
+
+	if ctx.AConfig().IsEnvTrue("FORCE_BUILD_LLVM_PGO_GENERATE") {
+		linux.Cflags = append(linux.Cflags, "-fprofile-instr-generate")
+		linux.Ldflags = append(linux.Ldflags, "-fprofile-instr-generate")
+	}
+
+	if profile := ctx.AConfig().Getenv("LLVM_PGO_PROFILE"); profile != "" {
+		linux.Cflags = append(linux.Cflags,
+			"-fprofile-instr-use="+profile,
+			"-Wno-profile-instr-unprofiled",
+			"-Wno-profile-instr-out-of-date")
+		linux.Ldflags = append(linux.Ldflags, "-fprofile-instr-use="+profile)
+	}
+
+	if ctx.AConfig().IsEnvTrue("FORCE_BUILD_LLVM_THINLTO") {
+		linux.Cflags = append(linux.Cflags, "-flto=thin")
+		linux.Ldflags = append(linux.Ldflags, "-flto=thin")
+		if jobs := ctx.AConfig().Getenv("LLVM_THINLTO_JOBS"); jobs != "" {
+			linux.Ldflags = append(linux.Ldflags,
+				"-Wl,-plugin-opt,jobs="+strings.TrimSpace(jobs))
+		}
+	}
+
+	ctx.AppendProperties(p)
 }
 
 func clangForceBuildLlvmComponents(ctx android.LoadHookContext) {
@@ -57,3 +103,10 @@ func clangBinaryHostFactory() android.Module {
 
 	return module.Init()
 }
+
+func clangDefaultsFactory() android.Module {
+	module := cc.DefaultsFactory()
+	android.AddLoadHook(module, clangPgoAndLto)
+
+	return module
+}
@@ -0,0 +1,5 @@
+// RUN: %clang_cc1 -emit-pch -o %t.1.ast %S/Inputs/packed-array-init1.c
+// RUN: %clang_cc1 -emit-llvm -o - -ast-merge %t.1.ast %s | FileCheck %s
+
+// CHECK-LABEL: define i32 @sum(
+// CHECK: call void @llvm.memcpy.p0i8.p0i8.i64({{.*}}@sum.table
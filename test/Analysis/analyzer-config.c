@@ -11,21 +11,32 @@ void foo() {
 }
 
 // CHECK: [config]
+// CHECK-NEXT: aggressive-graph-reclamation = false
 // CHECK-NEXT: cfg-conditional-static-initializers = true
 // CHECK-NEXT: cfg-temporary-dtors = false
+// CHECK-NEXT: exploration_strategy = dfs
 // CHECK-NEXT: faux-bodies = true
+// CHECK-NEXT: function-summaries-input =
+// CHECK-NEXT: function-summaries-output =
 // CHECK-NEXT: graph-trim-interval = 1000
+// CHECK-NEXT: incremental-analysis-state =
 // CHECK-NEXT: inline-lambdas = true
 // CHECK-NEXT: ipa = dynamic-bifurcate
 // CHECK-NEXT: ipa-always-inline-size = 3
 // CHECK-NEXT: leak-diagnostics-reference-allocation = false
+// CHECK-NEXT: max-cached-decl-contexts = 256
 // CHECK-NEXT: max-inlinable-size = 50
+// CHECK-NEXT: max-memory-mb = 0
 // CHECK-NEXT: max-nodes = 150000
 // CHECK-NEXT: max-times-inline-large = 32
 // CHECK-NEXT: min-cfg-size-treat-functions-as-large = 14
 // CHECK-NEXT: mode = deep
+// CHECK-NEXT: profile-output =
+// CHECK-NEXT: purge-interval = 1
 // CHECK-NEXT: region-store-small-struct-limit = 2
+// CHECK-NEXT: shard-count = 1
+// CHECK-NEXT: shard-index = 0
 // CHECK-NEXT: widen-loops = false
 // CHECK-NEXT: [stats]
-// CHECK-NEXT: num-entries = 15
+// CHECK-NEXT: num-entries = 26
 
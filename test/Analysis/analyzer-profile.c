@@ -0,0 +1,25 @@
+// RUN: rm -f %t.json %t.trace
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config profile-output=%t.json -verify %s
+// RUN: FileCheck -check-prefix=JSON -input-file=%t.json %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config profile-output=%t.trace,profile-format=chrome-trace -verify %s
+// RUN: FileCheck -check-prefix=TRACE -input-file=%t.trace %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config profile-output=%t.json,max-nodes=4 %s
+// RUN: FileCheck -check-prefix=LIMIT -input-file=%t.json %s
+
+// JSON: "checkers": [
+// JSON-DAG: { "checker": "core.DivideZero", "callback": "PreStmt", "calls": {{[0-9]+}}, "seconds": {{[0-9.]+}} }
+// JSON-DAG: { "checker": "core.NullDereference", "callback": "Location", "calls": {{[0-9]+}}, "seconds": {{[0-9.]+}} }
+// JSON: "functions": [
+// JSON: { "name": "divide", "location": "{{.*}}analyzer-profile.c:{{[0-9]+}}", "mode": "syntax", "seconds": {{[0-9.]+}}, "nodes": 0, "budget-exhausted": false, "checkers": {
+// JSON: { "name": "divide", "location": "{{.*}}analyzer-profile.c:{{[0-9]+}}", "mode": "path", "seconds": {{[0-9.]+}}, "nodes": {{[1-9][0-9]*}}, "budget-exhausted": false, "checkers": { "core.
+
+// TRACE: { "traceEvents": [
+// TRACE: { "name": "divide", "cat": "path", "ph": "X", "pid": 1, "tid": 1, "ts": {{[0-9.]+}}, "dur": {{[0-9.]+}}, "args": { "location": "{{.*}}analyzer-profile.c:{{[0-9]+}}", "nodes": {{[0-9]+}}, "budget-exhausted": false } }
+
+// LIMIT: { "name": "divide", {{.*}} "mode": "path", {{.*}} "budget-exhausted": true,
+
+int divide(int x, int *p) {
+  if (x == 0)
+    return *p / x; // expected-warning {{Division by zero}}
+  return *p / x;
+}
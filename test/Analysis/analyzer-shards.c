@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode -analyzer-config shard-count=2,shard-index=0 %s > %t.0 2>&1
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,deadcode -analyzer-config shard-count=2,shard-index=1 %s > %t.1 2>&1
+// RUN: FileCheck -check-prefix=SHARD0 %s < %t.0
+// RUN: FileCheck -check-prefix=SHARD1 %s < %t.1
+// RUN: cat %t.0 %t.1 | FileCheck %s
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core -analyzer-config shard-count=2,shard-index=2 %s 2>&1 | FileCheck -check-prefix=BAD-INDEX %s
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core -analyzer-config shard-index=1 %s 2>&1 | FileCheck -check-prefix=NO-COUNT %s
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core -analyzer-config shard-count=0 %s 2>&1 | FileCheck -check-prefix=BAD-COUNT %s
+// RUN: not %clang_cc1 -analyze -analyzer-checker=core -analyzer-config shard-count=2,shard-index=-1 %s 2>&1 | FileCheck -check-prefix=NEGATIVE-INDEX %s
+
+// BAD-INDEX: error: analyzer-config option 'shard-index' is 2, but must be less than 'shard-count' (2)
+// NO-COUNT: error: analyzer-config option 'shard-index' is 1, but must be less than 'shard-count' (1)
+// BAD-COUNT: error: analyzer-config option 'shard-count' expects a positive integer, not '0'
+// NEGATIVE-INDEX: error: analyzer-config option 'shard-index' expects a non-negative integer, not '-1'
+
+void first(int *p) {
+  int unused;
+  unused = 3; // CHECK-DAG: analyzer-shards.c:[[@LINE]]:3: warning: Value stored to 'unused' is never read
+  p = 0;
+  *p = 1; // CHECK-DAG: analyzer-shards.c:[[@LINE]]:6: warning: Dereference of null pointer
+}
+
+void second(int *p) {
+  p = 0;
+  *p = 2; // CHECK-DAG: analyzer-shards.c:[[@LINE]]:6: warning: Dereference of null pointer
+}
+
+// Each shard analyzes one of the two functions. The dead store checker is
+// path-insensitive, so only the first shard runs it.
+// SHARD0: 2 warnings generated.
+// SHARD1: 1 warning generated.
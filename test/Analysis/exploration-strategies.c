@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration_strategy=dfs -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration_strategy=bfs -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration_strategy=bfs_block_dfs_contents -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config exploration_strategy=unexplored_first -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ConfigDumper -analyzer-config exploration_strategy=unexplored_first %s 2>&1 | FileCheck %s
+
+// CHECK: exploration_strategy = unexplored_first
+
+extern int coin();
+
+int loop() {
+  int *x = 0;
+  while (coin()) {
+    if (coin())
+      return *x; // expected-warning {{Dereference of null pointer (loaded from variable 'x')}}
+  }
+  return 0;
+}
+
+int afterLoop(int n) {
+  int *y = 0;
+  for (int i = 0; i < n; ++i)
+    if (coin())
+      ++n;
+  return *y; // expected-warning {{Dereference of null pointer (loaded from variable 'y')}}
+}
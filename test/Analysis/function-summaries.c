@@ -0,0 +1,71 @@
+// RUN: rm -f %t.summaries
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config function-summaries-output=%t.summaries -DDEFINITIONS %s
+// RUN: FileCheck -check-prefix=SUMMARIES %s < %t.summaries
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config function-summaries-input=%t.summaries -verify %s
+
+// A second translation unit writing to the same file merges its summaries
+// with the ones already there.
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config function-summaries-output=%t.summaries -DOTHER_DEFINITIONS %s
+// RUN: FileCheck -check-prefix=MERGED %s < %t.summaries
+
+// Summaries that disagree on the body of a function are not used.
+// RUN: sed -e 's/^[0-9a-f]* \(.*\) pureAdd$/0123 \1 pureAdd/' %t.summaries > %t.conflicting
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config function-summaries-input=%t.summaries -analyzer-config function-summaries-output=%t.conflicting -DCONFLICT -verify %s
+
+#ifdef DEFINITIONS
+
+int global;
+
+int pureAdd(int a, int b) { return a + b; }
+
+int status(int x) {
+  if (x)
+    return -1;
+  return 1;
+}
+
+void touch(void) { global = 1; }
+
+// SUMMARIES: # clang analyzer function summaries v1
+// SUMMARIES-NEXT: {{[0-9a-f]+}} 1 0 0 0 pureAdd
+// SUMMARIES-NEXT: {{[0-9a-f]+}} 1 1 -1 1 status
+// SUMMARIES-NEXT: {{[0-9a-f]+}} 0 0 0 0 touch
+
+#elif defined(OTHER_DEFINITIONS)
+
+int other(void) { return 7; }
+
+// MERGED: # clang analyzer function summaries v1
+// MERGED-NEXT: {{[0-9a-f]+}} 1 1 7 7 other
+// MERGED-NEXT: {{[0-9a-f]+}} 1 0 0 0 pureAdd
+// MERGED-NEXT: {{[0-9a-f]+}} 1 1 -1 1 status
+// MERGED-NEXT: {{[0-9a-f]+}} 0 0 0 0 touch
+
+#else
+
+void clang_analyzer_eval(int);
+
+int global;
+int pureAdd(int a, int b);
+int status(int x);
+void touch(void);
+
+void testInvalidation(void) {
+  global = 3;
+  pureAdd(1, 2);
+#ifdef CONFLICT
+  clang_analyzer_eval(global == 3); // expected-warning{{UNKNOWN}}
+#else
+  clang_analyzer_eval(global == 3); // expected-warning{{TRUE}}
+#endif
+  touch();
+  clang_analyzer_eval(global == 3); // expected-warning{{UNKNOWN}}
+}
+
+void testReturnRange(int x) {
+  int s = status(x);
+  clang_analyzer_eval(s >= -1); // expected-warning{{TRUE}}
+  clang_analyzer_eval(s <= 1); // expected-warning{{TRUE}}
+}
+
+#endif
@@ -0,0 +1,49 @@
+// RUN: rm -f %t.summaries
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config function-summaries-output=%t.summaries -DDEFINITIONS %s
+// RUN: FileCheck -check-prefix=SUMMARIES %s < %t.summaries
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config function-summaries-input=%t.summaries -verify %s
+
+int global;
+
+struct Base {
+  virtual void f();
+  void g();
+};
+
+struct Derived : Base {
+  void f() override;
+};
+
+#ifdef DEFINITIONS
+
+void Base::f() {}
+void Base::g() {}
+void Derived::f() { global = 1; }
+
+// A virtual call in a body may run an overrider with side effects.
+void callThroughBase(Base &B) { B.f(); }
+
+// SUMMARIES: # clang analyzer function summaries v1
+// SUMMARIES-NEXT: {{[0-9a-f]+}} 1 0 0 0 Base::f#void (void)
+// SUMMARIES-NEXT: {{[0-9a-f]+}} 1 0 0 0 Base::g#void (void)
+// SUMMARIES-NEXT: {{[0-9a-f]+}} 0 0 0 0 Derived::f#void (void)
+// SUMMARIES-NEXT: {{[0-9a-f]+}} 0 0 0 0 callThroughBase#void (struct Base &)
+
+#else
+
+void clang_analyzer_eval(bool);
+
+void testVirtual(Base &B) {
+  global = 3;
+  // The summary of Base::f does not describe the overrider that runs.
+  B.f();
+  clang_analyzer_eval(global == 3); // expected-warning{{UNKNOWN}}
+}
+
+void testNonVirtual(Base &B) {
+  global = 3;
+  B.g();
+  clang_analyzer_eval(global == 3); // expected-warning{{TRUE}}
+}
+
+#endif
@@ -0,0 +1,53 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc,alpha.deadcode.UnreachableCode -analyzer-output=text -analyzer-config graph-trim-interval=1 -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc,alpha.deadcode.UnreachableCode -analyzer-output=text -analyzer-config graph-trim-interval=1,aggressive-graph-reclamation=true -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc,alpha.deadcode.UnreachableCode -analyzer-output=text -analyzer-config max-memory-mb=1024 -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ConfigDumper -analyzer-config aggressive-graph-reclamation=true,max-memory-mb=64 %s 2>&1 | FileCheck %s
+
+// CHECK: aggressive-graph-reclamation = true
+// CHECK: max-memory-mb = 64
+
+typedef __typeof(sizeof(int)) size_t;
+void *malloc(size_t);
+void free(void *);
+void abort(void) __attribute__((__noreturn__));
+extern int coin();
+
+void fail(int *p) {
+  int x = *p + 1;
+  if (x > 10)
+    abort();
+}
+
+// The paths into abort() are collapsed, and the leak on them stays
+// suppressed.
+void leakBeforeAbort(int n) {
+  void *p = malloc(n);
+  if (coin()) {
+    int i = n * 2;
+    fail(&i);
+    abort();
+  }
+  free(p);
+}
+
+// The path to the report keeps every node its notes need.
+int nullAfterNoReturnBranch(int *q) {
+  int *p = 0; // expected-note {{'p' initialized to a null pointer value}}
+  if (coin()) // expected-note {{Assuming the condition is false}}
+              // expected-note@-1 {{Taking false branch}}
+    abort();
+  if (q)      // expected-note {{Assuming 'q' is non-null}}
+              // expected-note@-1 {{Taking true branch}}
+    return *p; // expected-warning {{Dereference of null pointer (loaded from variable 'p')}}
+               // expected-note@-1 {{Dereference of null pointer (loaded from variable 'p')}}
+  return 0;
+}
+
+// Blocks only reached on paths that end in a sink are still reached.
+int reachedBeforeSink(int n) {
+  if (n > 3) {
+    n = n - 1;
+    abort();
+  }
+  return n;
+}
@@ -0,0 +1,28 @@
+// RUN: rm -fR %T/highlighting
+// RUN: mkdir %T/highlighting
+// RUN: %clang_cc1 -analyze -analyzer-output=html -analyzer-checker=core -o %T/highlighting %s
+// RUN: cat %T/highlighting/report-*.html | FileCheck %s
+
+// The highlighting of the file is computed once, and every report in it has
+// all of it.
+
+// CHECK: <!-- BUGTYPE Dereference of null pointer -->
+// CHECK: <span class='keyword'>int</span>
+// CHECK: <span class='macro'>ZERO<span class='expansion'>0</span></span>
+// CHECK: id="EndPath"
+// CHECK: <!-- BUGTYPE Dereference of null pointer -->
+// CHECK: <span class='keyword'>int</span>
+// CHECK: <span class='macro'>ZERO<span class='expansion'>0</span></span>
+// CHECK: id="EndPath"
+
+#define ZERO 0
+
+int first() {
+  int *p = ZERO;
+  return *p;
+}
+
+int second() {
+  int *q = ZERO;
+  return *q;
+}
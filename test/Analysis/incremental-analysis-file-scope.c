@@ -0,0 +1,27 @@
+// A change to a header, to the command-line macros or to a file-scope
+// declaration analyzes every function again, even if no function changed.
+
+// RUN: rm -f %t.state
+// RUN: echo 'typedef int T;' > %t.h
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -include %t.h -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -include %t.h -analyzer-display-progress -verify %s 2>&1 | FileCheck -check-prefix=UNCHANGED %s
+
+// RUN: echo 'typedef long T;' > %t.h
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -include %t.h -analyzer-display-progress -verify %s 2>&1 | FileCheck -check-prefix=CHANGED %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -include %t.h -DUNUSED -analyzer-display-progress -verify %s 2>&1 | FileCheck -check-prefix=CHANGED %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -include %t.h -DUNUSED -DGLOBAL_CHANGED -analyzer-display-progress -verify %s 2>&1 | FileCheck -check-prefix=CHANGED %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -include %t.h -DUNUSED -DGLOBAL_CHANGED -analyzer-display-progress -verify %s 2>&1 | FileCheck -check-prefix=UNCHANGED %s
+
+// UNCHANGED-NOT: ANALYZE (Path
+// CHANGED: ANALYZE (Path,  Inline_Regular): {{.*}} nullDeref
+
+int global
+#ifdef GLOBAL_CHANGED
+    = 1
+#endif
+    ;
+
+T nullDeref(void) {
+  T *p = 0;
+  return *p; // expected-warning {{Dereference of null pointer}}
+}
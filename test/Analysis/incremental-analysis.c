@@ -0,0 +1,25 @@
+// RUN: rm -f %t.state
+// RUN: cp %s %t.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -verify %t.c
+// RUN: FileCheck -check-prefix=STATE -input-file=%t.state %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -analyzer-display-progress -verify %t.c 2>&1 | FileCheck -check-prefix=UNCHANGED %s
+// RUN: sed -e 's/x \/ 3/x \/ 2/' %s > %t.c
+// RUN: %clang_cc1 -analyze -analyzer-checker=core -analyzer-config incremental-analysis-state=%t.state -analyzer-display-progress -verify %t.c 2>&1 | FileCheck -check-prefix=CHANGED %s
+
+// STATE: # clang analyzer incremental state v1
+// STATE: function {{[0-9a-f]+}} nullDeref#int (void)
+// STATE-NEXT: report nullDeref#int (void) 2 {{[0-9]+}} core.NullDereference
+
+// UNCHANGED-NOT: ANALYZE (Path
+// CHANGED-NOT: ANALYZE (Path,  Inline_Regular): {{.*}} nullDeref
+// CHANGED: ANALYZE (Path,  Inline_Regular): {{.*}} divide
+// CHANGED-NOT: ANALYZE (Path,  Inline_Regular): {{.*}} nullDeref
+
+int nullDeref(void) {
+  int *p = 0;
+  return *p; // expected-warning {{Dereference of null pointer}}
+}
+
+int divide(int x) {
+  return x / 3;
+}
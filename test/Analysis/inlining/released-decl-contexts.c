@@ -0,0 +1,29 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config max-cached-decl-contexts=0 -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -analyzer-config max-cached-decl-contexts=1 -verify %s
+
+// The contexts of inlined functions are released between top-level functions
+// once no caller left can inline them, or when too many are kept. Either way
+// a function inlined again gets a context built anew.
+
+void clang_analyzer_eval(int);
+
+static int identity(int X) { return X; }
+static int twice(int X) { return identity(X) + identity(X); }
+
+void callsTwice(int *P) {
+  clang_analyzer_eval(twice(3) == 6); // expected-warning{{TRUE}}
+  if (twice(0) == 0)
+    *P = 1;
+}
+
+void callsIdentity(void) {
+  int *Null = 0;
+  if (identity(1))
+    *Null = 1; // expected-warning{{Dereference of null pointer}}
+}
+
+void callsBoth(void) {
+  clang_analyzer_eval(twice(identity(2)) == 4); // expected-warning{{TRUE}}
+  clang_analyzer_eval(identity(5) == 5); // expected-warning{{TRUE}}
+}
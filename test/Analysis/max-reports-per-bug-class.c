@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc -analyzer-config max-reports-per-bug-class=1 -verify %s
+
+// Capping the number of reports examined per equivalence class must still
+// emit one diagnostic per class.
+
+typedef __typeof(sizeof(int)) size_t;
+void *malloc(size_t);
+void free(void *);
+void use(int);
+
+void leakOnEveryPath(int a, int b, int c) {
+  char *p = malloc(12);
+  if (a)
+    use(1);
+  if (b)
+    use(2);
+  if (c)
+    use(3);
+  use(a + b + c);
+  return; // expected-warning {{Potential leak of memory pointed to by 'p'}}
+}
+
+void leakOnSomePaths(int a, int b) {
+  char *p = malloc(12);
+  if (a)
+    use(1);
+  if (b)
+    free(p);
+  use(a + b);
+  return; // expected-warning {{Potential leak of memory pointed to by 'p'}}
+}
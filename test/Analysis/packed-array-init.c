@@ -0,0 +1,18 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,debug.ExprInspection -verify %s
+
+// Long integer literal lists are packed by Sema; the analyzer still sees the
+// element values.
+
+void clang_analyzer_eval(int);
+
+void packed(void) {
+  unsigned char table[64] = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+    16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+    32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
+  };
+  clang_analyzer_eval(table[0] == 0); // expected-warning{{TRUE}}
+  clang_analyzer_eval(table[5] == 5); // expected-warning{{TRUE}}
+  clang_analyzer_eval(table[63] == 63); // expected-warning{{TRUE}}
+}
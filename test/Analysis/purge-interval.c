@@ -0,0 +1,37 @@
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc,debug.ExprInspection -verify %s
+// RUN: %clang_cc1 -analyze -analyzer-checker=core,unix.Malloc,debug.ExprInspection -analyzer-config purge-interval=64 -verify %s
+
+// Batching dead symbol collection within a block must not move diagnostics
+// that depend on where symbols die.
+
+typedef __typeof(sizeof(int)) size_t;
+void *malloc(size_t);
+void free(void *);
+
+void clang_analyzer_warnOnDeadSymbol(int);
+int conjure_index();
+void use(int);
+
+void leakIsReportedWhereTheMemoryDies(unsigned size) {
+  char *p = malloc(size);
+  char x = *p; // expected-warning {{Potential leak of memory pointed to by 'p'}}
+  int a = x;
+  int b = a + 1;
+  use(b);
+}
+
+void freedMemoryDoesNotLeak(unsigned size) {
+  char *p = malloc(size);
+  int a = *p;
+  free(p);
+  int b = a + 1;
+  int c = b * 2;
+  use(c);
+} // no-warning
+
+void deathIsSeenAtTheEndOfTheBlock() {
+  do {
+    int x = conjure_index();
+    clang_analyzer_warnOnDeadSymbol(x);
+  } while (0); // expected-warning{{SYMBOL DEAD}}
+}
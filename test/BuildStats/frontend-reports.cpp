@@ -0,0 +1,27 @@
+// Aggregates the reports that the frontend writes for two translation units.
+// RUN: rm -rf %t && mkdir -p %t/reports
+// RUN: echo 'template <typename T> T twice(T X) { return X + X; }' > %t/twice.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -S -I %t -ftime-trace \
+// RUN:   -ftime-trace-granularity=0 -fheader-cost-report=%t/reports/a.txt \
+// RUN:   -fmemory-report=%t/reports/a-memory.json -o %t/reports/a.s %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -S -I %t -ftime-trace \
+// RUN:   -ftime-trace-granularity=0 -fheader-cost-report=%t/reports/b.txt \
+// RUN:   -fmemory-report=%t/reports/b-memory.json -o %t/reports/b.s %s
+// RUN: clang-build-stats -top=0 %t/reports | FileCheck %s
+
+#include "twice.h"
+
+int use(int X) { return twice(X); }
+
+// CHECK: ===-- Phases (2 translation units) --===
+// CHECK-DAG: {{[0-9.]+ +[0-9.]+%( +[0-9.]+){2} +2 +2}}  ExecuteCompiler
+// CHECK-DAG: {{[0-9.]+ +[0-9.]+%( +[0-9.]+){2} +2 +2}}  Frontend
+// CHECK-DAG: {{[0-9.]+ +[0-9.]+%( +[0-9.]+){2} +2 +2}}  Backend
+// CHECK: ===-- Headers (2 translation units) --===
+// CHECK: {{ +2 +2}}  {{.*}}twice.h
+// CHECK: ===-- Template instantiations (2 translation units) --===
+// CHECK: {{ +2 +2}}  twice<int>
+// CHECK: ===-- Memory (2 translation units) --===
+// CHECK: ast_allocated_bytes
+// CHECK: ===-- AST nodes (2 translation units) --===
+// CHECK: {{ +2 +2}}  FunctionTemplate{{$}}
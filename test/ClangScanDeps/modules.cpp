@@ -0,0 +1,39 @@
+// Verifies that -module-files-dir builds the modules a translation unit uses,
+// including the ones only reached through other modules or through
+// '@import', and prints the options to compile it against them.
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/include
+// RUN: echo 'module A { header "a.h" }' > %t/include/module.modulemap
+// RUN: echo 'module B { header "b.h" }' >> %t/include/module.modulemap
+// RUN: echo 'module C { header "c.h" }' >> %t/include/module.modulemap
+// RUN: echo 'module D { header "d.h" }' >> %t/include/module.modulemap
+// RUN: echo 'int a();' > %t/include/a.h
+// RUN: echo '#include "a.h"' > %t/include/b.h
+// RUN: echo 'inline int b() { return a(); }' >> %t/include/b.h
+// RUN: echo '#include "b.h"' > %t/include/c.h
+// RUN: echo '#include "a.h"' > %t/include/d.h
+// RUN: echo '@import D;' > %t/imports.m
+// RUN: echo 'int main(void) { return a(); }' >> %t/imports.m
+// RUN: echo "[{\"directory\":\"%t\",\"command\":\"clang -fmodules -c %t/main.cpp -Iinclude\",\"file\":\"%t/main.cpp\"}," > %t/cdb.json
+// RUN: echo "{\"directory\":\"%t\",\"command\":\"clang -fmodules -c %t/imports.m -Iinclude\",\"file\":\"%t/imports.m\"}]" >> %t/cdb.json
+// RUN: sed -e 's/\\/\//g' %t/cdb.json > %t/compile_commands.json
+// RUN: cp "%s" "%t/main.cpp"
+// RUN: clang-scan-deps -p %t -j 2 -module-files-dir=%t/pcms > %t/out
+// RUN: FileCheck %s < %t/out
+//
+// The modules of each language are built into their own directory.
+// RUN: ls %t/pcms | count 2
+// RUN: not ls %t/pcms/*/C.pcm
+//
+// The printed options are enough to compile without implicit modules.
+// RUN: grep 'main.cpp:' %t/out | sed -e 's/^.*main.cpp://' > %t/main.rsp
+// RUN: cd %t && %clang -fmodules -fno-implicit-modules -fsyntax-only -Iinclude @%t/main.rsp %t/main.cpp
+// RUN: grep 'imports.m:' %t/out | sed -e 's/^.*imports.m://' > %t/imports.rsp
+// RUN: cd %t && %clang -fmodules -fno-implicit-modules -fsyntax-only -Iinclude @%t/imports.rsp %t/imports.m
+
+#include "b.h"
+
+int main() { return b(); }
+
+// CHECK: main.cpp: -fmodule-file={{.*}}A.pcm -fmodule-file={{.*}}B.pcm{{$}}
+// CHECK: imports.m: -fmodule-file={{.*}}A.pcm -fmodule-file={{.*}}D.pcm{{$}}
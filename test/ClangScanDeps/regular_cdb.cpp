@@ -0,0 +1,24 @@
+// Verifies that every translation unit of a compilation database is scanned,
+// relative paths resolve against each command's directory, and the rules are
+// printed in database order whatever the number of threads.
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/a %t/b
+// RUN: echo "[{\"directory\":\"%t/a\",\"command\":\"clang -c %t/a/main.cpp -I. -o main_a.o\",\"file\":\"%t/a/main.cpp\"}," > %t/cdb.json
+// RUN: echo "{\"directory\":\"%t/b\",\"command\":\"clang -c %t/b/main.cpp -I. -MD -MF main.d\",\"file\":\"%t/b/main.cpp\"}]" >> %t/cdb.json
+// RUN: sed -e 's/\\/\//g' %t/cdb.json > %t/compile_commands.json
+// RUN: cp "%s" "%t/a/main.cpp"
+// RUN: cp "%s" "%t/b/main.cpp"
+// RUN: echo "#define HEADER_A" > %t/a/header.h
+// RUN: echo "#define HEADER_B" > %t/b/header.h
+// RUN: clang-scan-deps -p %t -j 1 | FileCheck %s
+// RUN: clang-scan-deps -p %t -j 2 | FileCheck %s
+// RUN: not ls %t/b/main.d
+
+#include "header.h"
+
+// CHECK: main_a.o:
+// CHECK-SAME: a{{/|\\}}main.cpp
+// CHECK: a{{/|\\}}header.h
+// CHECK: main.o:
+// CHECK-SAME: b{{/|\\}}main.cpp
+// CHECK: b{{/|\\}}header.h
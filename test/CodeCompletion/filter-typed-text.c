@@ -0,0 +1,21 @@
+struct Point { int xcoord; int ycoord; int xtra; };
+void func(struct Point *p) {
+  p->xc;
+  int MyValue, myOther;
+  myv;
+}
+
+// RUN: %clang_cc1 -fsyntax-only -code-completion-filter-typed-text -code-completion-at=%s:3:6 %s -o - | FileCheck -check-prefix=CHECK-MEMBER %s
+// CHECK-MEMBER-NOT: COMPLETION:
+// CHECK-MEMBER: COMPLETION: xcoord : [#int#]xcoord
+// CHECK-MEMBER-NOT: COMPLETION:
+
+// RUN: %clang_cc1 -fsyntax-only -code-completion-at=%s:3:6 %s -o - | FileCheck -check-prefix=CHECK-MEMBER-ALL %s
+// CHECK-MEMBER-ALL: COMPLETION: xcoord : [#int#]xcoord
+// CHECK-MEMBER-ALL: COMPLETION: xtra : [#int#]xtra
+// CHECK-MEMBER-ALL: COMPLETION: ycoord : [#int#]ycoord
+
+// RUN: %clang_cc1 -fsyntax-only -code-completion-filter-typed-text -code-completion-at=%s:5:3 %s -o - | FileCheck -check-prefix=CHECK-NAME %s
+// CHECK-NAME-NOT: myOther
+// CHECK-NAME: COMPLETION: MyValue : [#int#]MyValue
+// CHECK-NAME-NOT: myOther
@@ -0,0 +1,50 @@
+// RUN: %clang_cc1 -triple thumbv7-none-linux-gnueabihf -target-cpu cortex-a8 \
+// RUN:   -ffreestanding -flazy-neon-intrinsics -emit-llvm -o - %s \
+// RUN:   | FileCheck %s
+// RUN: %clang_cc1 -triple thumbebv7-none-linux-gnueabihf -target-cpu cortex-a8 \
+// RUN:   -ffreestanding -flazy-neon-intrinsics -emit-llvm -o - %s \
+// RUN:   | FileCheck --check-prefix=BE %s
+// RUN: %clang_cc1 -triple thumbv7-none-linux-gnueabihf -target-cpu cortex-a8 \
+// RUN:   -ffreestanding -flazy-neon-intrinsics -ast-dump %s \
+// RUN:   | FileCheck --check-prefix=AST --implicit-check-not=vsub_s8 %s
+// RUN: %clang_cc1 -triple aarch64-none-linux-gnu -target-feature +neon \
+// RUN:   -ffreestanding -flazy-neon-intrinsics -fsyntax-only -verify %s
+// RUN: %clang_cc1 -x c++ -triple aarch64-none-linux-gnu -target-feature +neon \
+// RUN:   -ffreestanding -flazy-neon-intrinsics -fsyntax-only -verify %s
+
+// With -flazy-neon-intrinsics, arm_neon.h leaves the function intrinsics to
+// be defined when they are first used.
+
+// expected-no-diagnostics
+
+#include <arm_neon.h>
+
+// CHECK-LABEL: define <8 x i8> @add(
+// CHECK: add <8 x i8>
+// BE-LABEL: define <8 x i8> @add(
+// BE: shufflevector <8 x i8>
+// AST: FunctionDecl {{.*}} vadd_s8 'int8x8_t (int8x8_t, int8x8_t)'
+int8x8_t add(int8x8_t a, int8x8_t b) {
+  return vadd_s8(a, b);
+}
+
+// Intrinsics implemented as macros are still defined by the header.
+// CHECK-LABEL: define signext i16 @lane(
+// CHECK: extractelement <4 x i16> {{.*}}, i32 1
+int16_t lane(int16x4_t a) {
+  return vget_lane_s16(a, 1);
+}
+
+// Intrinsics that other intrinsics call are defined on demand as well.
+// CHECK-LABEL: define <4 x i32> @accumulate(
+// CHECK: call <4 x i32> @llvm.arm.neon.vabdu.v4i32
+// AST: FunctionDecl {{.*}} vabaq_u32
+// AST: FunctionDecl {{.*}} vabdq_u32
+uint32x4_t accumulate(uint32x4_t a, uint32x4_t b, uint32x4_t c) {
+  return vabaq_u32(a, b, c);
+}
+
+// A second use finds the existing definition.
+int8x8_t add_twice(int8x8_t a, int8x8_t b) {
+  return vadd_s8(vadd_s8(a, b), b);
+}
@@ -0,0 +1,45 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple armv7-linux-gnueabihf -emit-llvm -o - %s | FileCheck %s -check-prefix=ARM
+
+// Check that the atomic builtins are lowered inline whenever the alignment
+// known for the pointer allows it, even if the alignment of the type alone
+// would require a libcall.
+
+typedef struct {
+  void *ptr;
+  unsigned long tag;
+} tagged_ptr;
+
+tagged_ptr head __attribute__((aligned(2 * sizeof(void *))));
+
+_Bool cas_aligned(tagged_ptr *expected, tagged_ptr *desired) {
+  // CHECK-LABEL: @cas_aligned
+  // CHECK: cmpxchg i128* bitcast ({{.*}} @head to i128*), i128 {{.*}}, i128 {{.*}} seq_cst seq_cst
+  // CHECK-NOT: @__atomic_compare_exchange
+  // ARM-LABEL: @cas_aligned
+  // ARM: cmpxchg i64* bitcast ({{.*}} @head to i64*), i64 {{.*}}, i64 {{.*}} seq_cst seq_cst
+  // ARM-NOT: @__atomic_compare_exchange
+  return __atomic_compare_exchange(&head, expected, desired, 0,
+                                   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+_Bool cas_unaligned(tagged_ptr *p, tagged_ptr *expected,
+                    tagged_ptr *desired) {
+  // CHECK-LABEL: @cas_unaligned
+  // CHECK: call zeroext i1 @__atomic_compare_exchange(i64 16,
+  // ARM-LABEL: @cas_unaligned
+  // ARM: call{{.*}} i1 @__atomic_compare_exchange(i32 8,
+  return __atomic_compare_exchange(p, expected, desired, 0,
+                                   __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+struct __attribute__((packed)) packed {
+  char c;
+  int i;
+};
+
+int load_packed(struct packed *p) {
+  // CHECK-LABEL: @load_packed
+  // CHECK: call i32 @__atomic_load_4(
+  return __atomic_load_n(&p->i, __ATOMIC_SEQ_CST);
+}
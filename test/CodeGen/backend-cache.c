@@ -0,0 +1,39 @@
+// REQUIRES: x86-registered-target
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -S -fbackend-cache-path=%t/cache %s -o %t/first.s
+// RUN: ls %t/cache | count 1
+
+// A change that leaves the IR as it was reuses the cached output.
+// RUN: sed -e 's/old comment/a new and longer comment/' %s > %t/backend-cache.c
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -S -fbackend-cache-path=%t/cache %t/backend-cache.c -o %t/second.s
+// RUN: ls %t/cache | count 1
+// RUN: diff %t/first.s %t/second.s
+
+// Other options do not.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -S -O2 -fbackend-cache-path=%t/cache %s -o %t/third.s
+// RUN: ls %t/cache | count 2
+
+// An output whose compilation warned is not stored, so the warning is reported
+// again by the next compilation.
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -S -DLARGE_FRAME -mllvm -warn-stack-size=0 -fbackend-cache-path=%t/cache %s -o %t/fourth.s 2>&1 | FileCheck %s --check-prefix=FRAME
+// RUN: ls %t/cache | count 2
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -S -DLARGE_FRAME -mllvm -warn-stack-size=0 -fbackend-cache-path=%t/cache %s -o %t/fourth.s 2>&1 | FileCheck %s --check-prefix=FRAME
+// RUN: ls %t/cache | count 2
+// FRAME: warning: stack frame size of {{[0-9]+}} bytes in function 'g'
+
+// RUN: %clang -### -target x86_64-linux-gnu -c -fbackend-cache-path=%t/cache %s 2>&1 | FileCheck %s
+// CHECK: "-fbackend-cache-path={{.*}}cache"
+
+// old comment
+int f(int x) {
+  __asm__("nop");
+  return x + 1;
+}
+
+#ifdef LARGE_FRAME
+void h(char *);
+void g(void) {
+  char buf[64];
+  h(buf);
+}
+#endif
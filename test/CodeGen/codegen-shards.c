@@ -0,0 +1,25 @@
+// REQUIRES: x86-registered-target
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -S -fcodegen-shards=2 -fcodegen-shard=0 %s -o %t.0.s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -S -fcodegen-shards=2 -fcodegen-shard=1 %s -o %t.1.s
+// RUN: cat %t.0.s %t.1.s | FileCheck %s
+// RUN: cat %t.0.s %t.1.s | FileCheck %s --check-prefix=ONCE
+// RUN: not %clang_cc1 -triple x86_64-linux-gnu -S -fcodegen-shards=2 -fcodegen-shard=2 %s -o - 2>&1 | FileCheck %s --check-prefix=INVALID
+
+// Each function is emitted by exactly one of the shards.
+
+// CHECK-DAG: {{^}}first:
+// CHECK-DAG: {{^}}second:
+// CHECK-DAG: {{^}}helper.shard.{{[0-9a-f]+}}:
+
+// ONCE: {{^}}first:
+// ONCE-NOT: {{^}}first:
+
+// INVALID: invalid value '2' in '-fcodegen-shard=2'
+
+static int counter;
+
+__attribute__((noinline)) static int helper(void) { return ++counter; }
+
+int first(void) { return helper(); }
+
+int second(void) { return helper() + counter; }
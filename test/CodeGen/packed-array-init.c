@@ -0,0 +1,51 @@
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -emit-pch -o %t %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t -emit-llvm -o - %s | FileCheck %s
+
+// Long lists of integer literals initializing an array are packed by Sema
+// and emitted as a single data array.
+
+#ifndef HEADER
+#define HEADER
+
+// CHECK: @bytes = constant [64 x i8] c"ABCDEFGHIJKLMNOPABCDEFGHIJKLMNOPABCDEFGHIJKLMNOPABCDEFGHIJKLMNOP"
+const unsigned char bytes[] = {
+  65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80,
+  65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80,
+  65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80,
+  65, 66, 67, 68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80,
+};
+
+// CHECK: @shorts = global [70 x i16] [i16 1, i16 -2, i16 3, i16 -4,
+// CHECK-SAME: i16 63, i16 -64, i16 0, i16 0, i16 0, i16 0, i16 0, i16 0]
+short shorts[70] = {
+  1, -2, 3, -4, 5, -6, 7, -8, 9, -10, 11, -12, 13, -14, 15, -16,
+  17, -18, 19, -20, 21, -22, 23, -24, 25, -26, 27, -28, 29, -30, 31, -32,
+  33, -34, 35, -36, 37, -38, 39, -40, 41, -42, 43, -44, 45, -46, 47, -48,
+  49, -50, 51, -52, 53, -54, 55, -56, 57, -58, 59, -60, 61, -62, 63, -64,
+};
+
+// Lists that are too short or contain other expressions are not packed.
+// CHECK: @ints = global [64 x i32] [i32 0, i32 1, i32 2, i32 3,
+// CHECK-SAME: i32 62, i32 126]
+int ints[] = {
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+  16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+  32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+  48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63 * 2,
+};
+
+// CHECK-LABEL: define void @local(
+// CHECK: call void @llvm.memcpy.p0i8.p0i8.i64({{.*}}, i8* bitcast ([64 x i64]* @local.table to i8*), i64 512,
+void use(const unsigned long *);
+void local(void) {
+  unsigned long table[64] = {
+    0u, 1u, 4u, 9u, 16u, 25u, 36u, 49u, 64u, 81u, 100u, 121u, 144u, 169u, 196u, 225u,
+    256u, 289u, 324u, 361u, 400u, 441u, 484u, 529u, 576u, 625u, 676u, 729u, 784u, 841u, 900u, 961u,
+    1024u, 1089u, 1156u, 1225u, 1296u, 1369u, 1444u, 1521u, 1600u, 1681u, 1764u, 1849u, 1936u, 2025u, 2116u, 2209u,
+    2304u, 2401u, 2500u, 2601u, 2704u, 2809u, 2916u, 3025u, 3136u, 3249u, 3364u, 3481u, 3600u, 3721u, 3844u, 3969u,
+  };
+  use(table);
+}
+
+#endif
@@ -0,0 +1,26 @@
+// REQUIRES: x86-registered-target, shell
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '#!/bin/sh' > %t/ld
+// RUN: echo 'echo "$@" > %t/ld.args' >> %t/ld
+// RUN: echo 'while [ "$1" != "-o" ]; do shift; done; shift; echo linked > $1' >> %t/ld
+// RUN: chmod +x %t/ld
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -emit-obj -fparallel-codegen=2 -fparallel-codegen-linker=%t/ld %s -o %t/out.o
+// RUN: FileCheck %s --check-prefix=ARGS < %t/ld.args
+// RUN: FileCheck %s --check-prefix=OUT < %t/out.o
+// RUN: %clang -### -target x86_64-linux-gnu -c -fparallel-codegen=4 %s 2>&1 | FileCheck %s --check-prefix=DRIVER
+
+// The two parts are linked into one relocatable object.
+// ARGS: -r -o {{.*}}parallel-codegen{{.*}}.o {{.*}}parallel-codegen{{.*}}.o {{.*}}parallel-codegen{{.*}}.o
+// OUT: linked
+
+// DRIVER: "-cc1"
+// DRIVER-SAME: "-fparallel-codegen=4"
+// DRIVER-SAME: "-fparallel-codegen-linker={{.*}}"
+
+static int counter;
+
+static int helper(void) { return ++counter; }
+
+int first(void) { return helper(); }
+
+int second(void) { return helper() + counter; }
@@ -0,0 +1,19 @@
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -O1 -fstreaming-codegen -emit-llvm %s -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-linux-gnu -O0 -fstreaming-codegen -emit-llvm %s -o - | FileCheck %s --check-prefix=O0
+
+// Each function is simplified as soon as its code is generated.
+
+// CHECK-LABEL: define i32 @add(
+// CHECK-NOT: alloca
+// CHECK: add nsw i32
+// CHECK: ret i32
+
+// The option does not optimize at -O0.
+
+// O0-LABEL: define i32 @add(
+// O0: alloca i32
+
+int add(int a, int b) {
+  int sum = a + b;
+  return sum;
+}
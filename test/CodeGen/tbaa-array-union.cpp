@@ -0,0 +1,70 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -O1 -disable-llvm-optzns %s -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -O1 -no-struct-path-tbaa -disable-llvm-optzns %s -emit-llvm -o - | FileCheck %s -check-prefix=SCALAR
+// Test struct-path TBAA for array members and for union members.
+
+typedef unsigned short uint16_t;
+typedef unsigned int uint32_t;
+typedef int int32_t;
+
+struct Packet {
+  uint16_t len;
+  uint32_t words[4];
+  union {
+    uint32_t w;
+    int32_t i;
+  } tag;
+  union {
+    uint32_t u;
+    float f;
+  } mixed;
+  uint32_t matrix[2][2];
+};
+
+// Elements of an array member share the access path of the array.
+uint32_t array_member(uint32_t *p, Packet *P, int n) {
+// CHECK-LABEL: define i32 @_Z12array_member
+// CHECK: store i32 1, i32* %{{.*}}, align 4, !tbaa [[TAG_i32:!.*]]
+// CHECK: store i32 2, i32* %{{.*}}, align 4, !tbaa [[TAG_P_words:!.*]]
+// CHECK: store i32 3, i32* %{{.*}}, align 4, !tbaa [[TAG_P_matrix:!.*]]
+// SCALAR-LABEL: define i32 @_Z12array_member
+// SCALAR: store i32 2, i32* %{{.*}}, align 4, !tbaa [[SCALAR_i32:!.*]]
+// SCALAR: store i32 3, i32* %{{.*}}, align 4, !tbaa [[SCALAR_i32]]
+  *p = 1;
+  P->words[n] = 2;
+  P->matrix[n][1] = 3;
+  return *p;
+}
+
+// A union whose members have the same type node keeps the access path.
+uint32_t union_member(uint32_t *p, Packet *P) {
+// CHECK-LABEL: define i32 @_Z12union_member
+// CHECK: store i32 1, i32* %{{.*}}, align 4, !tbaa [[TAG_i32]]
+// CHECK: store i32 2, i32* %{{.*}}, align 4, !tbaa [[TAG_P_tag:!.*]]
+  *p = 1;
+  P->tag.i = 2;
+  return *p;
+}
+
+// Other unions are accessed with the type of the member.
+float mixed_union_member(float *p, Packet *P) {
+// CHECK-LABEL: define float @_Z18mixed_union_member
+// CHECK: store float 1.000000e+00, float* %{{.*}}, align 4, !tbaa [[TAG_float:!.*]]
+// CHECK: store float 2.000000e+00, float* %{{.*}}, align 4, !tbaa [[TAG_float]]
+  *p = 1.0f;
+  P->mixed.f = 2.0f;
+  return *p;
+}
+
+// CHECK-DAG: [[TYPE_CHAR:!.*]] = !{!"omnipotent char", !
+// CHECK-DAG: [[TAG_i32]] = !{[[TYPE_INT:!.*]], [[TYPE_INT]], i64 0}
+// CHECK-DAG: [[TYPE_INT]] = !{!"int", [[TYPE_CHAR]]
+// CHECK-DAG: [[TYPE_SHORT:!.*]] = !{!"short", [[TYPE_CHAR]]
+// CHECK-DAG: [[TYPE_P:!.*]] = !{!"_ZTS6Packet", [[TYPE_SHORT]], i64 0, [[TYPE_INT]], i64 4, [[TYPE_INT]], i64 20, [[TYPE_CHAR]], i64 24, [[TYPE_INT]], i64 28}
+// CHECK-DAG: [[TAG_P_words]] = !{[[TYPE_P]], [[TYPE_INT]], i64 4}
+// CHECK-DAG: [[TAG_P_matrix]] = !{[[TYPE_P]], [[TYPE_INT]], i64 28}
+// CHECK-DAG: [[TAG_P_tag]] = !{[[TYPE_P]], [[TYPE_INT]], i64 20}
+// CHECK-DAG: [[TAG_float]] = !{[[TYPE_FLOAT:!.*]], [[TYPE_FLOAT]], i64 0}
+// CHECK-DAG: [[TYPE_FLOAT]] = !{!"float", [[TYPE_CHAR]]
+
+// SCALAR: [[SCALAR_i32]] = !{[[SCALAR_INT:!.*]], [[SCALAR_INT]], i64 0}
+// SCALAR: [[SCALAR_INT]] = !{!"int", !
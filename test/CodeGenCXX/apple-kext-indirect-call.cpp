@@ -1,4 +1,5 @@
 // RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fapple-kext -emit-llvm -o - %s | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-darwin10 -fapple-kext -fexperimental-relative-c++-abi-vtables -emit-llvm -o - %s | FileCheck %s --check-prefix=RELATIVE
 
 // CHECK: @_ZTV5TemplIiE = internal unnamed_addr constant [5 x i8*] [i8* null, i8* bitcast ({ i8*, i8* }* @_ZTI5TemplIiE to i8*), i8* bitcast (void (%struct.Templ*)* @_ZN5TemplIiE1fEv to i8*), i8* bitcast (void (%struct.Templ*)* @_ZN5TemplIiE1gEv to i8*), i8* null]
 
@@ -15,6 +16,10 @@ void FUNC(Base* p) {
 // CHECK: getelementptr inbounds (void (%struct.Base*)*, void (%struct.Base*)** bitcast ([4 x i8*]* @_ZTV4Base to void (%struct.Base*)**), i64 2)
 // CHECK-NOT: call void @_ZNK4Base3abcEv
 
+// A relative slot is loaded as an offset from the address point.
+// RELATIVE-LABEL: define void @_Z4FUNCP4Base(
+// RELATIVE: call i8* @llvm.load.relative.i32(i8* bitcast (i32* getelementptr inbounds ([4 x i32], [4 x i32]* @_ZTV4Base, i32 0, i32 2) to i8*), i32 0)
+
 template<class T>
 struct Templ {
   virtual void f() {}
@@ -19,9 +19,9 @@ int main()
 // CHECK: call {{.*}} @_ZN1AC1ERKS_
 // CHECK-LABEL: define internal void @__Block_byref_object_dispose_
 // CHECK: call {{.*}} @_ZN1AD1Ev
-// CHECK-LABEL: define internal void @__copy_helper_block_
+// CHECK-LABEL: define linkonce_odr hidden void @__copy_helper_block_
 // CHECK: call {{.*}}void @_Block_object_assign
-// CHECK-LABEL: define internal void @__destroy_helper_block_
+// CHECK-LABEL: define linkonce_odr hidden void @__destroy_helper_block_
 // CHECK: call {{.*}}void @_Block_object_dispose
 
 // rdar://problem/11135650
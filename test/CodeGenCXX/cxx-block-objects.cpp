@@ -25,9 +25,27 @@ main()
         return 0;
 }
 
-// CHECK-LABEL: define internal void @__copy_helper_block_
+// The helpers are named after the captured type, so they can be shared.
+// CHECK-LABEL: define linkonce_odr hidden void @__copy_helper_block_8_32c21A(
 // CHECK: call void @_ZN1AC1ERKS_
 
 
-// CHECK-LABEL:define internal void @__destroy_helper_block_
+// CHECK-LABEL:define linkonce_odr hidden void @__destroy_helper_block_8_32c21A(
 // CHECK: call void @_ZN1AD1Ev
+
+namespace {
+struct Local {
+  Local(const Local &);
+  Local();
+  ~Local();
+};
+}
+
+// A type that is local to this translation unit keeps its helpers local.
+// CHECK-LABEL: define internal void @__copy_helper_block_8_32c22N12_GLOBAL__N_15LocalE(
+// CHECK-LABEL: define internal void @__destroy_helper_block_8_32c22N12_GLOBAL__N_15LocalE(
+void local() {
+  Local l;
+  void (^c)(void) = ^{ (void)l; };
+  _Block_release((const void *)_Block_copy((const void *)c));
+}
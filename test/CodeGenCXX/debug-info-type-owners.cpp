@@ -0,0 +1,17 @@
+// RUN: echo "# RTTI name, owner" > %t.owners
+// RUN: echo "_ZTS5Owned this.o" >> %t.owners
+// RUN: echo "_ZTS9Elsewhere other.o" >> %t.owners
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm -o - -debug-info-kind=limited -fdebug-type-owners=%t.owners -fdefinition-owner=this.o | FileCheck %s
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm -o - -debug-info-kind=standalone -fdebug-type-owners=%t.owners -fdefinition-owner=this.o | FileCheck %s
+
+struct Owned { int i; };
+struct Elsewhere { int i; };
+struct Unlisted { int i; };
+
+Owned o;
+Elsewhere e;
+Unlisted u;
+
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Owned",{{.*}} elements: {{.*}} identifier: "_ZTS5Owned")
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Elsewhere",{{.*}} flags: DIFlagFwdDecl, identifier: "_ZTS9Elsewhere")
+// CHECK-DAG: !DICompositeType(tag: DW_TAG_structure_type, name: "Unlisted",{{.*}} elements: {{.*}} identifier: "_ZTS8Unlisted")
@@ -0,0 +1,19 @@
+// RUN: echo "# mangled name, owner" > %t.owners
+// RUN: echo "_Z5ownedv this.o" >> %t.owners
+// RUN: echo "_Z9elsewherev other.o" >> %t.owners
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm -o - -fdefinition-owners=%t.owners -fdefinition-owner=this.o | FileCheck %s --check-prefix=CHECK --check-prefix=O0
+// RUN: %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm -o - -O1 -disable-llvm-optzns -fdefinition-owners=%t.owners -fdefinition-owner=this.o | FileCheck %s --check-prefix=CHECK --check-prefix=O1
+// RUN: not %clang_cc1 %s -triple=x86_64-linux-gnu -emit-llvm-only -fdefinition-owners=%t.missing 2>&1 | FileCheck %s --check-prefix=MISSING
+
+// MISSING: Could not read definition owners {{.*}}.missing
+
+inline int owned() { return 1; }
+inline int elsewhere() { return 2; }
+inline int unlisted() { return 3; }
+
+int use() { return owned() + elsewhere() + unlisted(); }
+
+// CHECK: define weak_odr i32 @_Z5ownedv()
+// O0: declare i32 @_Z9elsewherev()
+// O1: define available_externally i32 @_Z9elsewherev()
+// CHECK: define linkonce_odr i32 @_Z8unlistedv()
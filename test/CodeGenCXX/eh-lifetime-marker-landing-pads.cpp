@@ -0,0 +1,35 @@
+// RUN: %clang_cc1 %s -triple x86_64-linux-gnu -fcxx-exceptions -fexceptions -O1 -disable-llvm-optzns -emit-llvm -o - | FileCheck %s
+
+// Lifetime markers don't get landing pads of their own: the constructor of a
+// local variable shares the landing pad of the enclosing scope.
+
+struct A { A(); ~A(); };
+void f();
+
+// CHECK-LABEL: define void @_Z4testv(
+void test() {
+  // CHECK:      call void @llvm.lifetime.start
+  // CHECK-NEXT: call void @_ZN1AC1Ev(
+  A a;
+  // CHECK:      call void @llvm.lifetime.start
+  // CHECK-NEXT: invoke void @_ZN1AC1Ev(
+  // CHECK-NEXT:   to label %{{.*}} unwind label %[[LPAD_A:[^ ]+]]
+  A b;
+  // CHECK:      invoke void @_Z1fv()
+  // CHECK-NEXT:   to label %{{.*}} unwind label %[[LPAD_B:[^ ]+]]
+  f();
+  // CHECK:      call void @llvm.lifetime.start
+  // CHECK-NEXT: invoke void @_ZN1AC1Ev(
+  // CHECK-NEXT:   to label %{{.*}} unwind label %[[LPAD_B]]
+  A c;
+  // CHECK:      invoke void @_Z1fv()
+  // CHECK-NEXT:   to label %{{.*}} unwind label %[[LPAD_C:[^ ]+]]
+  f();
+
+  // CHECK:      [[LPAD_A]]:
+  // CHECK-NEXT:   landingpad
+  // CHECK:      [[LPAD_B]]:
+  // CHECK-NEXT:   landingpad
+  // CHECK:      [[LPAD_C]]:
+  // CHECK-NEXT:   landingpad
+}
@@ -0,0 +1,46 @@
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-linux-gnu -emit-llvm -o - %s | FileCheck -check-prefix=DEFAULT %s
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-linux-gnu -emit-llvm -o - %s -fexpanded-static-init | FileCheck %s
+// RUN: %clang_cc1 -std=c++11 -triple x86_64-linux-gnu -emit-llvm-only %s -fexpanded-static-init -Rdynamic-global-init -verify
+
+struct StringRef {
+  StringRef(const char *Data, unsigned long Length)
+      : Data(Data), Length(Length) {}
+  const char *Data;
+  unsigned long Length;
+};
+
+struct Entry {
+  Entry(int Kind, StringRef Name) : Kind(Kind), Name(Name) {}
+  Entry(int Kind) : Entry(Kind, StringRef("", 0)) {}
+  int Kind;
+  StringRef Name;
+  long Flags = 3;
+};
+
+// DEFAULT: @ref = global %struct.StringRef zeroinitializer
+// CHECK: @ref = global %struct.StringRef { i8* getelementptr inbounds ([4 x i8], [4 x i8]* @.str, i32 0, i32 0), i64 3 }
+StringRef ref("abc", 3);
+
+// CHECK: @table = global [2 x %struct.Entry] [%struct.Entry { i32 1, %struct.StringRef { {{.*}}, i64 3 }, i64 3 }, %struct.Entry { i32 2, %struct.StringRef { {{.*}}, i64 5 }, i64 3 }]
+Entry table[] = {Entry(1, StringRef("one", 3)), Entry(2, StringRef("three", 5))};
+
+struct Counter {
+  Counter() : Value(0) { ++Instances; }
+  int Value;
+  static int Instances;
+};
+
+// Delegating constructors, constructors with statements and non-constant
+// arguments stay dynamic.
+Entry delegated(4); // expected-remark {{initializer for 'delegated' could not be folded and is run by a global constructor}}
+Counter counter; // expected-remark {{initializer for 'counter' could not be folded}}
+extern int runtime;
+StringRef dynamic("x", runtime); // expected-remark {{initializer for 'dynamic' could not be folded}}
+
+// DEFAULT: define internal void @__cxx_global_var_init()
+// DEFAULT: call void @_ZN9StringRefC1EPKcm(
+// CHECK-NOT: call void @_ZN9StringRefC1EPKcm(%struct.StringRef* @ref
+// CHECK-NOT: call void @_ZN5EntryC1Ei9StringRef(%struct.Entry* getelementptr
+// CHECK: call void @_ZN5EntryC1Ei(%struct.Entry* @delegated, i32 4)
+// CHECK: call void @_ZN7CounterC1Ev(%struct.Counter* @counter)
+// CHECK: call void @_ZN9StringRefC1EPKcm(%struct.StringRef* @dynamic
@@ -49,6 +49,16 @@ void testInternallyVisible(bool p) {
   c->bar();
 }
 
+// The virtual function pointer itself is loaded with !invariant.load, so
+// that repeated calls through the same vptr share one load.
+// CHECK-LABEL: define void @_Z11testVFnLoadP1A(
+void testVFnLoad(A *a) {
+  // CHECK: load {{.*}} !invariant.group ![[A_MD]]
+  // CHECK: [[VFN:%.*]] = getelementptr inbounds {{.*}} %vtable, i64 0
+  // CHECK: load {{.*}} [[VFN]], align 8, !invariant.load ![[EMPTY:[0-9]+]]
+  a->foo();
+}
+
 // Checking A::A()
 // CHECK-LABEL: define linkonce_odr void @_ZN1AC2Ev(
 // CHECK: store {{.*}}, !invariant.group ![[A_MD]]
@@ -69,6 +79,7 @@ void testInternallyVisible(bool p) {
 // CHECK:  store {{.*}}, !invariant.group ![[C_MD]]
 
 // CHECK: ![[A_MD]] = !{!"_ZTS1A"}
+// CHECK: ![[EMPTY]] = !{}
 // CHECK: ![[D_MD]] = !{!"_ZTS1D"}
 // CHECK: ![[B_MD]] = distinct !{}
 // CHECK: ![[C_MD]] = distinct !{}
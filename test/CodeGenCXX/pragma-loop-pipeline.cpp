@@ -0,0 +1,72 @@
+// RUN: %clang_cc1 -triple x86_64-apple-darwin -std=c++11 -emit-llvm -o - %s | FileCheck %s
+
+// Verify unroll_and_jam pragmas generate the correct metadata on the outer loop.
+void unroll_and_jam_test(int *List, int Length) {
+  // CHECK-LABEL: define {{.*}} @_Z19unroll_and_jam_test
+#pragma clang loop unroll_and_jam(enable) distribute(enable)
+  for (int i = 0; i < Length; i++) {
+    for (int j = 0; j < Length; j++)
+      List[i * Length + j] += j;
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_1:.*]]
+  }
+}
+
+void unroll_and_jam_count_test(int *List, int Length) {
+  // CHECK-LABEL: define {{.*}} @_Z25unroll_and_jam_count_test
+#pragma clang loop unroll_and_jam_count(4)
+  for (int i = 0; i < Length; i++) {
+    for (int j = 0; j < Length; j++)
+      List[i * Length + j] += j;
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_2:.*]]
+  }
+}
+
+// Verify software pipelining pragmas generate the correct metadata.
+void pipeline_disable_test(int *List, int Length) {
+  // CHECK-LABEL: define {{.*}} @_Z21pipeline_disable_test
+#pragma clang loop pipeline(disable)
+  for (int i = 0; i < Length; i++) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_3:.*]]
+    List[i] = i * 2;
+  }
+}
+
+void pipeline_initiation_interval_test(int *List, int Length) {
+  // CHECK-LABEL: define {{.*}} @_Z33pipeline_initiation_interval_test
+#pragma clang loop pipeline_initiation_interval(10)
+  for (int i = 0; i < Length; i++) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_4:.*]]
+    List[i] = i * 2;
+  }
+}
+
+// Verify vectorize_predicate pragmas generate the correct metadata.
+void vectorize_predicate_test(int *List, int Length) {
+  // CHECK-LABEL: define {{.*}} @_Z24vectorize_predicate_test
+#pragma clang loop vectorize(enable) vectorize_predicate(enable)
+  for (int i = 0; i < Length; i++) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_5:.*]]
+    List[i] = i * 2;
+  }
+
+#pragma clang loop vectorize_predicate(disable)
+  for (int i = 0; i < Length; i++) {
+    // CHECK: br label {{.*}}, !llvm.loop ![[LOOP_6:.*]]
+    List[i] = i * 2;
+  }
+}
+
+// CHECK: ![[LOOP_1]] = distinct !{![[LOOP_1]], ![[DISTRIBUTE_ENABLE:.*]], ![[UNROLL_AND_JAM_ENABLE:.*]]}
+// CHECK: ![[DISTRIBUTE_ENABLE]] = !{!"llvm.loop.distribute.enable", i1 true}
+// CHECK: ![[UNROLL_AND_JAM_ENABLE]] = !{!"llvm.loop.unroll_and_jam.enable"}
+// CHECK: ![[LOOP_2]] = distinct !{![[LOOP_2]], ![[UNROLL_AND_JAM_4:.*]]}
+// CHECK: ![[UNROLL_AND_JAM_4]] = !{!"llvm.loop.unroll_and_jam.count", i32 4}
+// CHECK: ![[LOOP_3]] = distinct !{![[LOOP_3]], ![[PIPELINE_DISABLE:.*]]}
+// CHECK: ![[PIPELINE_DISABLE]] = !{!"llvm.loop.pipeline.disable", i1 true}
+// CHECK: ![[LOOP_4]] = distinct !{![[LOOP_4]], ![[PIPELINE_II_10:.*]]}
+// CHECK: ![[PIPELINE_II_10]] = !{!"llvm.loop.pipeline.initiationinterval", i32 10}
+// CHECK: ![[LOOP_5]] = distinct !{![[LOOP_5]], ![[VECTORIZE_ENABLE:.*]], ![[PREDICATE_ENABLE:.*]]}
+// CHECK: ![[VECTORIZE_ENABLE]] = !{!"llvm.loop.vectorize.enable", i1 true}
+// CHECK: ![[PREDICATE_ENABLE]] = !{!"llvm.loop.vectorize.predicate.enable", i1 true}
+// CHECK: ![[LOOP_6]] = distinct !{![[LOOP_6]], ![[PREDICATE_DISABLE:.*]]}
+// CHECK: ![[PREDICATE_DISABLE]] = !{!"llvm.loop.vectorize.predicate.enable", i1 false}
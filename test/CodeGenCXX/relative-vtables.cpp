@@ -0,0 +1,98 @@
+// RUN: %clang_cc1 -I%S %s -triple=x86_64-unknown-linux-gnu -fexperimental-relative-c++-abi-vtables -emit-llvm -o - | FileCheck %s
+// RUN: %clang_cc1 -I%S %s -triple=x86_64-unknown-linux-gnu -fexperimental-relative-c++-abi-vtables -debug-info-kind=standalone -emit-llvm -o - | FileCheck %s --check-prefix=DEBUG
+
+#include <typeinfo>
+
+struct A {
+  int a;
+  virtual void f();
+  virtual void g();
+  __attribute__((visibility("hidden"))) virtual void h();
+};
+
+struct B : virtual A {
+  int x;
+};
+
+// The vtable holds 32-bit offsets from its address point. The RTTI component
+// refers to a hidden proxy for the type info, and functions that could be
+// preempted are reached through hidden stubs.
+// CHECK-DAG: @_ZTV1A = unnamed_addr constant [5 x i32] [i32 0, i32 trunc (i64 sub (i64 ptrtoint (i8** @_ZTI1A.rtti_proxy to i64), i64 ptrtoint (i32* getelementptr inbounds ([5 x i32], [5 x i32]* @_ZTV1A, i32 0, i32 2) to i64)) to i32), i32 trunc (i64 sub (i64 ptrtoint (void (%struct.A*)* @_ZN1A1fEv.stub to i64), i64 ptrtoint (i32* getelementptr inbounds ([5 x i32], [5 x i32]* @_ZTV1A, i32 0, i32 2) to i64)) to i32), i32 trunc (i64 sub (i64 ptrtoint (void (%struct.A*)* @_ZN1A1gEv.stub to i64), i64 ptrtoint (i32* getelementptr inbounds ([5 x i32], [5 x i32]* @_ZTV1A, i32 0, i32 2) to i64)) to i32), i32 trunc (i64 sub (i64 ptrtoint (void (%struct.A*)* @_ZN1A1hEv to i64), i64 ptrtoint (i32* getelementptr inbounds ([5 x i32], [5 x i32]* @_ZTV1A, i32 0, i32 2) to i64)) to i32)], align 8
+// The VTT points to the address points of the 32-bit vtables, including the
+// construction vtable for B-in-D, whose vbase offset is a plain integer.
+// CHECK-DAG: @_ZTT1D = unnamed_addr constant [{{[0-9]+}} x i8*] [i8* bitcast (i32* getelementptr inbounds ([12 x i32], [12 x i32]* @_ZTV1D, i32 0, i32 3) to i8*), i8* bitcast (i32* getelementptr inbounds ([11 x i32], [11 x i32]* @_ZTC1D0_1B, i32 0, i32 3) to i8*)
+// CHECK-DAG: @_ZTC1D0_1B = {{.*}}unnamed_addr constant [11 x i32] [i32 16, i32 0, i32 trunc (i64 sub (i64 ptrtoint (i8** @_ZTI1B.rtti_proxy to i64), i64 ptrtoint (i32* getelementptr inbounds ([11 x i32], [11 x i32]* @_ZTC1D0_1B, i32 0, i32 3) to i64)) to i32)
+// CHECK-DAG: @_ZTI1A.rtti_proxy = linkonce_odr hidden unnamed_addr constant i8* bitcast ({ i8*, i8* }* @_ZTI1A to i8*), comdat, align 8
+void A::f() {}
+
+// CHECK-LABEL: define void @_Z4callP1A(
+// CHECK: [[VTABLE:%.*]] = bitcast void (%struct.A*)** %{{.*}} to i8*
+// CHECK: [[FN:%.*]] = call i8* @llvm.load.relative.i32(i8* [[VTABLE]], i32 4)
+// CHECK: bitcast i8* [[FN]] to void (%struct.A*)*
+void call(A *a) { a->g(); }
+
+// CHECK-LABEL: define { i64, i64 } @_Z3pmfv(
+// CHECK: ret { i64, i64 } { i64 5, i64 0 }
+void (A::*pmf())() { return &A::g; }
+
+// CHECK-LABEL: define void @_Z7callpmfP1AMS_FvvE(
+// CHECK: memptr.virtual:
+// CHECK: [[FN:%.*]] = call i8* @llvm.load.relative.i32(i8* %{{.*}}, i32 %{{.*}})
+// CHECK: bitcast i8* [[FN]] to void (%struct.A*)*
+void callpmf(A *a, void (A::*p)()) { (a->*p)(); }
+
+// CHECK-LABEL: define dereferenceable({{[0-9]+}}) %"class.std::type_info"* @_Z4typeP1A(
+// CHECK: [[PROXY:%.*]] = call i8* @llvm.load.relative.i32(i8* %{{.*}}, i32 -4)
+// CHECK: [[CAST:%.*]] = bitcast i8* [[PROXY]] to %"class.std::type_info"**
+// CHECK: load %"class.std::type_info"*, %"class.std::type_info"** [[CAST]], align 8
+const std::type_info &type(A *a) { return typeid(*a); }
+
+// The offset to top is two components before the address point.
+// CHECK-LABEL: define i8* @_Z3topP1A(
+// CHECK: [[PTR:%.*]] = getelementptr inbounds i8, i8* %{{.*}}, i64 -8
+// CHECK: [[CAST:%.*]] = bitcast i8* [[PTR]] to i32*
+// CHECK: [[OFFSET:%.*]] = load i32, i32* [[CAST]], align 4
+// CHECK: sext i32 [[OFFSET]] to i64
+void *top(A *a) { return dynamic_cast<void *>(a); }
+
+// The vbase offset is three components before the address point, and the
+// debug info describes it at that rescaled offset.
+// CHECK-LABEL: define %struct.A* @_Z6toBaseP1B(
+// CHECK: [[PTR:%.*]] = getelementptr inbounds i8, i8* %{{.*}}, i64 -12
+// CHECK: [[CAST:%.*]] = bitcast i8* [[PTR]] to i32*
+// CHECK: [[OFFSET:%.*]] = load i32, i32* [[CAST]], align 4
+// CHECK: %vbase.offset = sext i32 [[OFFSET]] to i64
+// DEBUG: !DIDerivedType(tag: DW_TAG_inheritance,{{.*}} offset: 12, flags: {{.*}}DIFlagVirtual)
+A *toBase(B *b) { return b; }
+
+struct D : B {
+  virtual void d();
+};
+void D::d() {}
+
+// The this-adjusting thunk loads its vcall offset three components before
+// the address point of the secondary vtable.
+// CHECK-LABEL: define void @_ZTv0_n24_N1C1vEv(
+// CHECK: [[PTR:%.*]] = getelementptr inbounds i8, i8* %{{.*}}, i64 -12
+// CHECK: [[CAST:%.*]] = bitcast i8* [[PTR]] to i32*
+// CHECK: [[OFFSET:%.*]] = load i32, i32* [[CAST]], align 4
+// CHECK: [[ADJ:%.*]] = sext i32 [[OFFSET]] to i64
+// CHECK: getelementptr inbounds i8, i8* %{{.*}}, i64 [[ADJ]]
+struct W {
+  virtual void w();
+};
+struct V {
+  virtual void v();
+};
+struct C : W, virtual V {
+  void v() override;
+};
+void C::v() {}
+
+// CHECK-LABEL: define linkonce_odr hidden void @_ZN1A1fEv.stub(
+// CHECK: musttail call void @_ZN1A1fEv(
+// CHECK-NEXT: ret void
+
+// CHECK-LABEL: define linkonce_odr hidden void @_ZN1A1gEv.stub(
+// CHECK: musttail call void @_ZN1A1gEv(
+// CHECK-NEXT: ret void
@@ -0,0 +1,77 @@
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.10.0 -emit-llvm -o - %s | FileCheck %s
+
+// Direct methods are left out of the method lists.
+// CHECK-NOT: @"\01l_OBJC_$_CLASS_METHODS_Root"
+// CHECK: @"\01l_OBJC_$_INSTANCE_METHODS_Root" = private global { i32, i32, [1 x %struct._objc_method] }
+// CHECK-NOT: @"\01l_OBJC_$_CATEGORY_INSTANCE_METHODS_Root_$_Cat"
+
+struct Big {
+  int a[16];
+};
+
+__attribute__((objc_root_class))
+@interface Root
+- (int)getInt __attribute__((objc_direct));
+- (struct Big)getBig __attribute__((objc_direct));
++ (int)classGetInt __attribute__((objc_direct));
+- (int)dynamicInt;
+@end
+
+@interface Root (Cat)
+- (void)catDirect __attribute__((objc_direct));
+@end
+
+@implementation Root
+// CHECK-LABEL: define hidden i32 @"\01-[Root getInt]"(
+// CHECK: [[SELF:%.*]] = load {{.*}} %self.addr
+// CHECK-NEXT: [[ISNIL:%.*]] = icmp eq {{.*}} [[SELF]], null
+// CHECK-NEXT: br i1 [[ISNIL]], label %objc_direct_method.self_is_nil, label %objc_direct_method.cont
+// CHECK: objc_direct_method.self_is_nil:
+// CHECK-NEXT: store i32 0, i32* %retval
+// CHECK: objc_direct_method.cont:
+// CHECK: store i32 42, i32* %retval
+- (int)getInt {
+  return 42;
+}
+
+// CHECK-LABEL: define hidden void @"\01-[Root getBig]"(%struct.Big* noalias sret
+// CHECK: objc_direct_method.self_is_nil:
+// CHECK: call void @llvm.memset
+- (struct Big)getBig {
+  struct Big B = {{1}};
+  return B;
+}
+
+- (int)dynamicInt {
+  return [self getInt];
+}
+
+// Class methods realize the class before running.
+// CHECK-LABEL: define hidden i32 @"\01+[Root classGetInt]"(
+// CHECK: objc_direct_method.cont:
+// CHECK: call {{.*}} @objc_msgSend
+// CHECK: store {{.*}} %self.addr
++ (int)classGetInt {
+  return 7;
+}
+@end
+
+// CHECK-LABEL: define hidden void @"\01-[Root catDirect]"(
+@implementation Root (Cat)
+- (void)catDirect {
+}
+@end
+
+// CHECK-LABEL: define i32 @useRoot(
+// CHECK-NOT: @objc_msgSend
+// CHECK: call i32 {{.*}}@"\01-[Root getInt]"
+// CHECK-NOT: @objc_msgSend
+// CHECK: call i32 {{.*}}@"\01+[Root classGetInt]"
+// CHECK-NOT: @objc_msgSend
+// CHECK: call void {{.*}}@"\01-[Root catDirect]"
+// CHECK-NOT: @objc_msgSend
+// CHECK: ret i32
+int useRoot(Root *r) {
+  [r catDirect];
+  return [r getInt] + [Root classGetInt];
+}
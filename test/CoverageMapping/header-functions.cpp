@@ -0,0 +1,27 @@
+// RUN: %clang_cc1 -fprofile-instrument=clang -fcoverage-mapping -fno-coverage-mapping-header-functions -dump-coverage-mapping -emit-llvm-only -main-file-name header-functions.cpp %s > %tmapping
+// RUN: FileCheck -input-file %tmapping %s --check-prefix=CHECK-MAIN
+// RUN: FileCheck -input-file %tmapping %s --check-prefix=CHECK-FUNC
+// RUN: FileCheck -input-file %tmapping %s --check-prefix=CHECK-STATIC-FUNC
+// RUN: FileCheck -input-file %tmapping %s --check-prefix=CHECK-STATIC-FUNC2
+
+// The externally visible functions defined in headers are mapped by the
+// objects that are built without -fno-coverage-mapping-header-functions.
+// Static functions are private to this object, so it still maps them.
+#include "Inputs/header1.h"
+
+// CHECK-MAIN: main:
+// CHECK-MAIN-NEXT: File 0, [[@LINE+1]]:12 -> [[@LINE+4]]:2 = #0
+int main() {
+  func(1);
+  static_func(2);
+}
+
+// CHECK-FUNC-NOT: _Z4funci
+
+// CHECK-STATIC-FUNC: static_func
+// CHECK-STATIC-FUNC: File 0, 12:32 -> 20:2 = #0
+// CHECK-STATIC-FUNC: File 0, 14:15 -> 16:4 = #1
+// CHECK-STATIC-FUNC: File 0, 16:10 -> 18:4 = (#0 - #1)
+
+// CHECK-STATIC-FUNC2: static_func2
+// CHECK-STATIC-FUNC2: File 0, 21:33 -> 29:2 = 0
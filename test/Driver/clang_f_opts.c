@@ -106,6 +106,11 @@
 // CHECK-COVERAGE-AND-GEN: '-fcoverage-mapping' only allowed with '-fprofile-instr-generate'
 // CHECK-DISABLE-COVERAGE-NOT: "-fcoverage-mapping"
 
+// RUN: %clang -### -S -fprofile-instr-generate -fcoverage-mapping -fno-coverage-mapping-header-functions %s 2>&1 | FileCheck -check-prefix=CHECK-NO-HEADER-FUNCTIONS %s
+// RUN: %clang -### -S -fprofile-instr-generate -fcoverage-mapping -fno-coverage-mapping-header-functions -fcoverage-mapping-header-functions %s 2>&1 | FileCheck -check-prefix=CHECK-HEADER-FUNCTIONS %s
+// CHECK-NO-HEADER-FUNCTIONS: "-fno-coverage-mapping-header-functions"
+// CHECK-HEADER-FUNCTIONS-NOT: "-fno-coverage-mapping-header-functions"
+
 // RUN: %clang -### -S -fprofile-use %s 2>&1 | FileCheck -check-prefix=CHECK-PROFILE-USE %s
 // RUN: %clang -### -S -fprofile-instr-use %s 2>&1 | FileCheck -check-prefix=CHECK-PROFILE-USE %s
 // RUN: mkdir -p %t.d/some/dir
@@ -460,3 +465,27 @@
 // CHECK-WCHAR2: -fshort-wchar
 // CHECK-WCHAR2-NOT: -fno-short-wchar
 // DELIMITERS: {{^ *"}}
+
+// RUN: %clang -### -S -fpch-instantiate-templates %s 2>&1 | FileCheck -check-prefix=CHECK-PCH-INST %s
+// RUN: %clang -### -S -fpch-instantiate-templates -fno-pch-instantiate-templates %s 2>&1 | FileCheck -check-prefix=CHECK-NO-PCH-INST %s
+// CHECK-PCH-INST: "-fpch-instantiate-templates"
+// CHECK-NO-PCH-INST-NOT: "-fpch-instantiate-templates"
+
+// RUN: %clang -### -S -fconstexpr-memoize-calls %s 2>&1 | FileCheck -check-prefix=CHECK-CONSTEXPR-MEMO %s
+// RUN: %clang -### -S -fconstexpr-memoize-calls -fno-constexpr-memoize-calls %s 2>&1 | FileCheck -check-prefix=CHECK-NO-CONSTEXPR-MEMO %s
+// RUN: %clang -### -S %s 2>&1 | FileCheck -check-prefix=CHECK-NO-CONSTEXPR-MEMO %s
+// CHECK-CONSTEXPR-MEMO: "-fconstexpr-memoize-calls"
+// CHECK-NO-CONSTEXPR-MEMO-NOT: "-fconstexpr-memoize-calls"
+
+// RUN: %clang -### -S -fmemory-report=report.json %s 2>&1 | FileCheck -check-prefix=CHECK-MEMORY-REPORT %s
+// CHECK-MEMORY-REPORT: "-fmemory-report=report.json"
+
+// RUN: %clang -### -S -fprefetch-deps=foo.d %s 2>&1 | FileCheck -check-prefix=CHECK-PREFETCH-DEPS %s
+// CHECK-PREFETCH-DEPS: "-fprefetch-deps=foo.d"
+
+// RUN: %clang -### -fsyntax-only -fskip-function-bodies-in-headers %s 2>&1 | FileCheck -check-prefix=CHECK-SKIP-HEADER-BODIES %s
+// RUN: %clang -### -S -fskip-function-bodies-in-headers -fno-skip-function-bodies-in-headers %s 2>&1 | FileCheck -check-prefix=CHECK-NO-SKIP-HEADER-BODIES %s
+// RUN: %clang -### -c -fskip-function-bodies-in-headers %s 2>&1 | FileCheck -check-prefix=CHECK-SKIP-HEADER-BODIES-CODEGEN %s
+// CHECK-SKIP-HEADER-BODIES: "-fskip-function-bodies-in-headers"
+// CHECK-NO-SKIP-HEADER-BODIES-NOT: "-fskip-function-bodies-in-headers"
+// CHECK-SKIP-HEADER-BODIES-CODEGEN: error: invalid argument '-fskip-function-bodies-in-headers' only allowed with '-fsyntax-only'
@@ -0,0 +1,22 @@
+// UNSUPPORTED: system-windows
+// REQUIRES: shell
+// RUN: rm -rf %t && mkdir -p %t
+
+// Without a server listening on the socket, the job runs in a new process.
+// RUN: %clang -fcompile-server=%t/none.sock -fsyntax-only %s 2>&1 | FileCheck %s
+// CHECK-NOT: argument unused
+// CHECK: warning: compile server
+
+// RUN: not %clang -cc1serve -socket %t/missing/server.sock 2>&1 | FileCheck %s --check-prefix=LISTEN
+// LISTEN: error: cannot listen on '{{.*}}server.sock'
+
+// With a live server, the job runs there and its diagnostics come back to the
+// driver. The server logs each job it ran.
+// RUN: %clang -cc1serve -socket %t/server.sock > %t/server.log 2>&1 & echo $! > %t/server.pid
+// RUN: for i in `seq 1 100`; do test -S %t/server.sock && break; sleep 0.1; done
+// RUN: %clang -fcompile-server=%t/server.sock -fsyntax-only %s > %t/client.log 2>&1; kill `cat %t/server.pid`
+// RUN: FileCheck %s < %t/client.log
+// RUN: FileCheck %s --check-prefix=SERVED < %t/server.log
+// SERVED: exit 0
+
+#warning compile server
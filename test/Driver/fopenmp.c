@@ -76,3 +76,22 @@
 //
 // CHECK-LD-ANY: "{{.*}}ld{{(.exe)?}}"
 // CHECK-LD-ANY: "-l{{(omp|gomp|iomp5)}}"
+//
+// RUN: %clang -target x86_64-linux-gnu -fopenmp=libomp -fopenmp-atomic-reductions -c %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-ATOMIC-REDUCTIONS
+// RUN: %clang -target x86_64-linux-gnu -fopenmp=libomp -fopenmp-atomic-reductions -fno-openmp-atomic-reductions -c %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-NO-ATOMIC-REDUCTIONS
+// RUN: %clang -target x86_64-linux-gnu -fopenmp=libgomp -fopenmp-atomic-reductions -c %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-NO-ATOMIC-REDUCTIONS
+//
+// CHECK-ATOMIC-REDUCTIONS: "-cc1"
+// CHECK-ATOMIC-REDUCTIONS: "-fopenmp-atomic-reductions"
+//
+// CHECK-NO-ATOMIC-REDUCTIONS: "-cc1"
+// CHECK-NO-ATOMIC-REDUCTIONS-NOT: "-fopenmp-atomic-reductions"
+//
+// RUN: %clang -target x86_64-linux-gnu -fopenmp=libomp -fopenmp-inline-static-schedule -c %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-INLINE-STATIC
+// RUN: %clang -target x86_64-linux-gnu -fopenmp=libomp -fopenmp-inline-static-schedule -fno-openmp-inline-static-schedule -c %s -### 2>&1 | FileCheck %s --check-prefix=CHECK-NO-INLINE-STATIC
+//
+// CHECK-INLINE-STATIC: "-cc1"
+// CHECK-INLINE-STATIC: "-fopenmp-inline-static-schedule"
+//
+// CHECK-NO-INLINE-STATIC: "-cc1"
+// CHECK-NO-INLINE-STATIC-NOT: "-fopenmp-inline-static-schedule"
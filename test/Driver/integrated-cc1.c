@@ -0,0 +1,26 @@
+// RUN: %clang -fintegrated-cc1 -fsyntax-only %s 2>&1 | FileCheck %s
+// RUN: %clang -fintegrated-cc1 -fno-integrated-cc1 -fsyntax-only %s 2>&1 | FileCheck %s
+// RUN: %clang -fintegrated-cc1 -### -fsyntax-only %s 2>&1 | FileCheck %s --check-prefix=PRINT
+
+// CHECK-NOT: argument unused
+// CHECK: warning: integrated cc1
+// CHECK-NOT: argument unused
+
+// The job is printed like one that runs in a new process.
+// PRINT: "-cc1"
+
+// A fatal error in the job returns to the driver, which reports it.
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: not env TMPDIR=%t TEMP=%t TMP=%t \
+// RUN:   %clang -fintegrated-cc1 -fsyntax-only -DFATAL %s 2>&1 \
+// RUN:   | FileCheck %s --check-prefix=FATAL
+
+// FATAL: error in backend: #pragma clang __debug llvm_fatal_error
+// FATAL: PLEASE submit a bug report
+
+#warning integrated cc1
+
+#ifdef FATAL
+#pragma clang __debug llvm_fatal_error
+#endif
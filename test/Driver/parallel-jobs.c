@@ -0,0 +1,10 @@
+// RUN: %clang -fsyntax-only -parallel-jobs=2 %s %s 2>&1 | FileCheck %s
+// RUN: not %clang -fsyntax-only -parallel-jobs=0 %s 2>&1 | FileCheck %s --check-prefix=INVALID
+
+// The output of each job is printed once it has finished.
+// CHECK: warning: parallel job
+// CHECK: warning: parallel job
+
+// INVALID: invalid integral value '0' in '-parallel-jobs=0'
+
+#warning parallel job
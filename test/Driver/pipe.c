@@ -0,0 +1,13 @@
+// With -pipe, the compile job still names a temporary assembly file, which the
+// driver replaces by a named pipe when it runs the jobs.
+// RUN: %clang -target x86_64-unknown-linux-gnu -### -pipe -no-integrated-as \
+// RUN:   -c %s -o %t.o 2>&1 | FileCheck %s
+// CHECK-NOT: argument unused during compilation: '-pipe'
+// CHECK: "-cc1" {{.*}}"-S"{{.*}} "-o" "[[ASM:[^"]*\.s]]"
+// CHECK: {{"[^"]*as(.exe)?"}} {{.*}}"[[ASM]]"
+
+// Files kept by -save-temps are never piped.
+// RUN: %clang -target x86_64-unknown-linux-gnu -### -pipe -save-temps \
+// RUN:   -no-integrated-as -c %s -o %t.o 2>&1 | FileCheck %s -check-prefix=SAVE
+// SAVE-NOT: argument unused during compilation: '-pipe'
+// SAVE: "-o" "pipe.s"
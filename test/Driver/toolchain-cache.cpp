@@ -0,0 +1,22 @@
+// Test that the GCC installation found through --toolchain-cache-path is the
+// one that a full detection finds.
+//
+// RUN: rm -rf %t.cache
+// RUN: %clangxx -no-canonical-prefixes %s -### -o %t 2>&1 \
+// RUN:     --target=i386-unknown-linux -stdlib=libstdc++ \
+// RUN:     --gcc-toolchain=%S/Inputs/ubuntu_11.04_multiarch_tree/usr \
+// RUN:     --toolchain-cache-path=%t.cache \
+// RUN:   | FileCheck %s
+// RUN: ls %t.cache | count 1
+//
+// The second invocation reads the cache.
+// RUN: %clangxx -no-canonical-prefixes %s -### -o %t 2>&1 \
+// RUN:     --target=i386-unknown-linux -stdlib=libstdc++ \
+// RUN:     --gcc-toolchain=%S/Inputs/ubuntu_11.04_multiarch_tree/usr \
+// RUN:     --toolchain-cache-path=%t.cache \
+// RUN:   | FileCheck %s
+// RUN: ls %t.cache | count 1
+//
+// CHECK: "-internal-isystem"
+// CHECK: "[[TOOLCHAIN:[^"]+]]/usr/lib/i386-linux-gnu/gcc/i686-linux-gnu/4.5/../../../../../include/c++/4.5"
+// CHECK: "-L[[TOOLCHAIN]]/usr/lib/i386-linux-gnu/gcc/i686-linux-gnu/4.5"
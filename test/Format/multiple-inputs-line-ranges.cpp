@@ -0,0 +1,13 @@
+// RUN: grep -Ev "// *[A-Z-]+:" %s > %t-1.cpp
+// RUN: grep -Ev "// *[A-Z-]+:" %s > %t-2.cpp
+// RUN: clang-format -style=LLVM -j=2 -lines=%t-1.cpp:1:1 -lines=%t-2.cpp:3:3 \
+// RUN:   %t-1.cpp %t-2.cpp | FileCheck -strict-whitespace %s
+// CHECK: {{^int\ \*i;$}}
+// CHECK-NEXT: {{^$}}
+// CHECK-NEXT: {{^int\ \ \*\ \ j;$}}
+// CHECK-NEXT: {{^int\ \ \*\ \ i;$}}
+// CHECK-NEXT: {{^$}}
+// CHECK-NEXT: {{^int\ \*j;$}}
+int  *  i;
+
+int  *  j;
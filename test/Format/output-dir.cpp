@@ -0,0 +1,10 @@
+// RUN: rm -rf %t && mkdir -p %t/src %t/out
+// RUN: grep -Ev "// *[A-Z-]+:" %s > %t/src/a.cpp
+// RUN: cp %t/src/a.cpp %t/src/b.cpp
+// RUN: cd %t && clang-format -style=LLVM -output-dir=out src/a.cpp src/b.cpp
+// RUN: FileCheck -strict-whitespace -input-file=%t/out/src/a.cpp %s
+// RUN: FileCheck -strict-whitespace -input-file=%t/out/src/b.cpp %s
+// RUN: FileCheck -check-prefix=SRC -strict-whitespace -input-file=%t/src/a.cpp %s
+// CHECK: {{^int\ \*i;$}}
+// SRC: {{^int\ \ \*\ \ i;$}}
+int  *  i;
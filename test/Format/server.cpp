@@ -0,0 +1,21 @@
+// RUN: printf '%%s\n' -cursor=6 11 ' int    i;' -assume-filename=a.cpp 11 \
+// RUN:   'int  *  j;' | clang-format -style=LLVM -server \
+// RUN:   | FileCheck -strict-whitespace %s
+// CHECK: {{^50 0$}}
+// CHECK-NEXT: {{^\{ "Cursor": 3, "IncompleteFormat": false }$}}
+// CHECK-NEXT: {{^int\ i;$}}
+// CHECK-NEXT: {{^8 0$}}
+// CHECK-NEXT: {{^int\ \*j;$}}
+
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'PointerAlignment: Left' > %t/.clang-format
+// RUN: printf '%%s\n' -assume-filename=%t/a.cpp 11 'int  *  j;' \
+// RUN:   -assume-filename=%t/b.cpp 11 'int  *  k;' -bogus 0 \
+// RUN:   | clang-format -server \
+// RUN:   | FileCheck -check-prefix=FILE -strict-whitespace %s
+// FILE: {{^8 0$}}
+// FILE-NEXT: {{^int\*\ j;$}}
+// FILE-NEXT: {{^8 0$}}
+// FILE-NEXT: {{^int\*\ k;$}}
+// FILE-NEXT: {{^0 46$}}
+// FILE-NEXT: {{^error: invalid server request option '-bogus'$}}
@@ -0,0 +1,28 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'int first(void) { return 1; }' > %t/first.c
+// RUN: echo 'int second(void) { return undeclared; }' > %t/second.c
+// RUN: echo 'int third(void) { return 3; }' > %t/third.c
+// RUN: not %clang_cc1 -triple x86_64-unknown-unknown -emit-llvm \
+// RUN:   %t/first.c -o %t/first.ll %t/second.c -o %t/second.ll \
+// RUN:   %t/third.c -o %t/third.ll 2>&1 | FileCheck -check-prefix=ERR %s
+// RUN: FileCheck -check-prefix=FIRST %s < %t/first.ll
+// RUN: FileCheck -check-prefix=THIRD %s < %t/third.ll
+// RUN: not ls %t/second.ll
+
+// ERR: second.c:1:{{[0-9]+}}: error: use of undeclared identifier 'undeclared'
+// ERR: 1 error generated.
+
+// FIRST: define i32 @first()
+// FIRST-NOT: @third
+
+// THIRD-NOT: @first
+// THIRD: define i32 @third()
+
+// RUN: not %clang_cc1 -fsyntax-only %t/first.c %t/third.c -o %t/a -o %t/b \
+// RUN:   -o %t/c 2>&1 | FileCheck -check-prefix=COUNT %s
+// COUNT: error: 3 output files given for 2 inputs
+
+// RUN: not %clang_cc1 -fsyntax-only -dependency-file %t/deps.d -MT x \
+// RUN:   %t/first.c -o %t/a %t/third.c -o %t/b 2>&1 \
+// RUN:   | FileCheck -check-prefix=DEPS %s
+// DEPS: error: invalid argument '-dependency-file' not allowed with 'several -o'
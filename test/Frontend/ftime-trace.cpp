@@ -0,0 +1,19 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo 'template <typename T> T twice(T X) { return X + X; }' > %t/twice.h
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -S -I %t -ftime-trace \
+// RUN:   -ftime-trace-granularity=0 -o %t/out.s %s
+// RUN: FileCheck %s < %t/out.json
+
+// CHECK: {"traceEvents":[
+// CHECK-DAG: "name":"Source","args":{"detail":"{{.*}}twice.h"}
+// CHECK-DAG: "name":"InstantiateFunction","args":{"detail":"twice<int>"}
+// CHECK-DAG: "name":"CodeGen Function","args":{"detail":"use"}
+// CHECK-DAG: "name":"Frontend"
+// CHECK-DAG: "name":"Backend"
+// CHECK-DAG: "name":"ExecuteCompiler"
+// CHECK: "name":"process_name","args":{"name":"clang"}
+// CHECK-NEXT: ]}
+
+#include "twice.h"
+
+int use(int X) { return twice(X); }
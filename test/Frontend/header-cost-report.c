@@ -0,0 +1,22 @@
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: echo '#ifndef GUARDED_H' > %t/guarded.h
+// RUN: echo '#define GUARDED_H' >> %t/guarded.h
+// RUN: echo 'int guarded;' >> %t/guarded.h
+// RUN: echo '#endif' >> %t/guarded.h
+// RUN: echo '#include "guarded.h"' > %t/outer.h
+// RUN: echo 'int outer;' >> %t/outer.h
+// RUN: %clang_cc1 -fsyntax-only -I %t -fheader-cost-report=%t/report.txt %s
+// RUN: FileCheck %s < %t/report.txt
+// RUN: %clang_cc1 -E -I %t -fheader-cost-report=%t/report-E.txt %s -o /dev/null
+// RUN: FileCheck %s < %t/report-E.txt
+
+// CHECK: # self-us total-us self-tokens total-tokens includes skipped file
+// CHECK-DAG: {{^[0-9]+ [0-9]+ [0-9]+ [0-9]+}} 1 1 {{.*}}guarded.h{{$}}
+// CHECK-DAG: {{^[0-9]+ [0-9]+ [0-9]+ [0-9]+}} 1 0 {{.*}}outer.h{{$}}
+// CHECK-DAG: {{^[0-9]+ [0-9]+ [0-9]+ [0-9]+}} 1 0 {{.*}}header-cost-report.c{{$}}
+// CHECK-DAG: {{^[0-9]+ [0-9]+ [0-9]+ [0-9]+}} 1 0 <built-in>{{$}}
+
+#include "outer.h"
+#include "guarded.h"
+
+int main_file;
@@ -0,0 +1,14 @@
+// RUN: rm -rf %t.dir
+// RUN: mkdir -p %t.dir
+// RUN: echo '#define FOO 1' > %t.dir/foo.h
+// RUN: %clang_cc1 -fsyntax-only -I %t.dir -dependency-file %t.dir/deps.d -MT %s.o %s
+// RUN: %clang_cc1 -fsyntax-only -I %t.dir -fprefetch-deps=%t.dir/deps.d %s
+//
+// A missing list is only a missed hint.
+// RUN: %clang_cc1 -fsyntax-only -I %t.dir -fprefetch-deps=%t.dir/missing.d %s
+
+#include "foo.h"
+
+#if FOO != 1
+#error wrong header
+#endif
@@ -0,0 +1 @@
+#define B 2
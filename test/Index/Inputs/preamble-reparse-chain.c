@@ -0,0 +1,4 @@
+#include "preamble-reparse-chain-1.h"
+#include "preamble-reparse-chain-3.h"
+
+int x = A + C;
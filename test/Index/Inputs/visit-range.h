@@ -0,0 +1,2 @@
+int header_function(int);
+struct HeaderStruct { int member; };
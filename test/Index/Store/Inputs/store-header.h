@@ -0,0 +1,2 @@
+int header_func(int x);
+struct HeaderStruct { int field; };
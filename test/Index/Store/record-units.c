@@ -0,0 +1,39 @@
+// REQUIRES: shell
+// RUN: rm -rf %t && mkdir -p %t
+// RUN: %clang_cc1 -I %S/Inputs -index-store-path %t/store %s -o %t/first.o -emit-obj
+// RUN: cat %t/store/units/first.o-* | FileCheck -check-prefix=UNIT %s
+// RUN: cat %t/store/records/*/store-header.h-* | FileCheck -check-prefix=HEADER %s
+// RUN: cat %t/store/records/*/record-units.c-* | FileCheck -check-prefix=MAIN %s
+
+// A second compilation that includes the header reuses its record.
+// RUN: %clang_cc1 -I %S/Inputs -index-store-path %t/store %s -o %t/second.o -emit-obj
+// RUN: ls %t/store/units | count 2
+// RUN: ls %t/store/records/*/store-header.h-* | count 1
+
+// RUN: %clang -### -c -index-store-path %t/store %s 2>&1 | FileCheck -check-prefix=DRIVER %s
+// DRIVER: "-index-store-path" "{{.*}}store"
+
+#include "store-header.h"
+
+int main_func(struct HeaderStruct *S) {
+  return header_func(S->field);
+}
+
+// UNIT: clang-index-unit 1
+// UNIT-NEXT: main-file {{.*}}record-units.c
+// UNIT-NEXT: output-file {{.*}}first.o
+// UNIT-DAG: file {{.*}}record-units.c record-units.c-{{[0-9a-f]+}}
+// UNIT-DAG: file {{.*}}store-header.h store-header.h-{{[0-9a-f]+}}
+
+// HEADER: clang-index-record 1
+// HEADER-NEXT: symbol 0 function/C c:@F@header_func header_func
+// HEADER-NEXT: symbol 1 struct/C c:@S@HeaderStruct HeaderStruct
+// HEADER-NEXT: symbol 2 field/C c:@S@HeaderStruct@FI@field field
+// HEADER-NEXT: occurrence 1:5 0x{{[0-9a-f]+}} 0
+// HEADER-NEXT: occurrence 2:8 0x{{[0-9a-f]+}} 1
+// HEADER: occurrence 2:27 0x{{[0-9a-f]+}} 2
+
+// MAIN: clang-index-record 1
+// MAIN-DAG: symbol {{[0-9]+}} function/C c:@F@main_func main_func
+// MAIN-DAG: symbol {{[0-9]+}} function/C c:@F@header_func header_func
+// MAIN: occurrence 18:5 0x{{[0-9a-f]+}}
@@ -0,0 +1,18 @@
+// RUN: rm -rf %t
+// RUN: mkdir -p %t
+// RUN: echo 'int from_header(void);' > %t/header.h
+// RUN: %clang_cc1 -emit-pch -include %t/header.h -o %t/main.ast %s
+// RUN: c-index-test -test-load-tu %t/main.ast local | FileCheck %s
+
+// Once an input has changed, the AST file is only loaded when the client
+// vouches for it.
+// RUN: echo 'int from_header(void); int added;' > %t/header.h
+// RUN: not c-index-test -test-load-tu %t/main.ast local 2>&1 \
+// RUN:   | FileCheck %s -check-prefix=STALE
+// RUN: env CINDEXTEST_SKIP_INPUT_VALIDATION=1 \
+// RUN:   c-index-test -test-load-tu %t/main.ast local | FileCheck %s
+
+int in_main(void) { return from_header(); }
+
+// CHECK: load-ast-skip-input-validation.c:[[@LINE-2]]:5: FunctionDecl=in_main:[[@LINE-2]]:5 (Definition)
+// STALE: Unable to load translation unit from '{{.*}}main.ast'!
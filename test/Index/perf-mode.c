@@ -0,0 +1,19 @@
+struct Point {
+  int x;
+  int y;
+};
+
+int length(struct Point *p) {
+  return p->x + p->y;
+}
+
+// RUN: c-index-test -test-perf=3 -complete-at=%s:7:13 %s | FileCheck %s
+// CHECK: "trials": 3,
+// CHECK: {"operation": "parse", "samples": 3, "mean_ms": {{[0-9.]+}}, "min_ms": {{[0-9.]+}}, "p50_ms": {{[0-9.]+}}, "p90_ms": {{[0-9.]+}}, "p99_ms": {{[0-9.]+}}, "max_ms": {{[0-9.]+}}, "tu_memory_bytes": {{[0-9]+}}, "peak_rss_bytes": {{[0-9]+}}},
+// CHECK: {"operation": "reparse", "samples": 3,
+// CHECK: {"operation": "complete {{.*}}perf-mode.c:7:13", "samples": 3,
+// CHECK: {"operation": "index", "samples": 3,
+// CHECK-SAME: "peak_rss_bytes": {{[0-9]+}}}{{$}}
+
+// RUN: not c-index-test -test-perf=0 %s 2>&1 | FileCheck -check-prefix=CHECK-ZERO %s
+// CHECK-ZERO: -test-perf needs a positive number of trials
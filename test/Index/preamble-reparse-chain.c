@@ -0,0 +1,10 @@
+#include "preamble-reparse-chain-1.h"
+#include "preamble-reparse-chain-2.h"
+
+int x = A + B;
+
+// RUN: env CINDEXTEST_EDITING=1 CINDEXTEST_CHAINED_PREAMBLE=1 CINDEXTEST_FAILONERROR=1 \
+// RUN:   c-index-test -test-load-source-reparse 3 local \
+// RUN:   -remap-file-2="%s,%S/Inputs/preamble-reparse-chain.c" -- %s -I%S/Inputs \
+// RUN:   | FileCheck %s
+// CHECK: preamble-reparse-chain.c:4:5: VarDecl=x:4:5 (Definition) Extent=[4:1 - 4:14]
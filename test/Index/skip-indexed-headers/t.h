@@ -0,0 +1,12 @@
+#ifndef T_H
+#define T_H
+
+namespace NS {
+int header_func(int x);
+}
+
+struct HeaderStruct {
+  int field;
+};
+
+#endif
@@ -0,0 +1,3 @@
+#include "t.h"
+
+int t1_func() { return NS::header_func(1); }
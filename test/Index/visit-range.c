@@ -0,0 +1,20 @@
+#include "visit-range.h"
+
+int before(void) { return 0; }
+
+int inside(int x) {
+  return header_function(x);
+}
+
+int after(void) { return 1; }
+
+// RUN: c-index-test -test-visit-range=%s:5:1:7:2 -I%S/Inputs %s | FileCheck %s
+// RUN: env CINDEXTEST_EDITING=1 c-index-test -test-visit-range=%s:5:1:7:2 -I%S/Inputs %s | FileCheck %s
+// CHECK-NOT: header_function:1:5
+// CHECK-NOT: HeaderStruct
+// CHECK-NOT: FunctionDecl=before
+// CHECK: visit-range.c:5:5: FunctionDecl=inside:5:5 (Definition) Extent=[5:1 - 7:2]
+// CHECK: visit-range.c:5:16: ParmDecl=x:5:16 (Definition) Extent=[5:12 - 5:17]
+// CHECK: visit-range.c:6:10: DeclRefExpr=header_function:1:5 Extent=[6:10 - 6:25]
+// CHECK: visit-range.c:6:26: DeclRefExpr=x:5:16 Extent=[6:26 - 6:27]
+// CHECK-NOT: FunctionDecl=after
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -dump-tokens %s 2>&1 | FileCheck %s
+// Exercise the vectorized identifier, whitespace and line comment scanners
+// with runs that span several 16-byte blocks.
+
+// CHECK: identifier 'abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789'
+abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789
+
+// A '$' past the first block still falls back to the scalar path.
+// CHECK: identifier 'abcdefghijklmnopqrstuvwxyz$tail'
+abcdefghijklmnopqrstuvwxyz$tail
+
+// As do escaped newlines inside the identifier.
+// CHECK: identifier 'abcdefghijklmnopqrstuvwxyzcontinued'
+abcdefghijklmnopqrstuvwxyz\
+continued
+
+// CHECK: identifier 'after_spaces' {{.*}}[LeadingSpace]
+                                         	 	  after_spaces
+
+// A long line comment whose body is longer than a single block.  The next token must still be found on the following line.
+// CHECK: identifier 'after_comment' [StartOfLine]
+after_comment
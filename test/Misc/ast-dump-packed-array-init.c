@@ -0,0 +1,15 @@
+// RUN: %clang_cc1 -ast-dump %s | FileCheck %s
+
+// The list as written is the child of a packed array initializer.
+
+// CHECK: VarDecl {{.*}} table 'const unsigned char [64]' cinit
+// CHECK-NEXT: PackedArrayInitExpr {{.*}} 'const unsigned char [64]'
+// CHECK-NEXT: InitListExpr {{.*}} 'const unsigned char [64]'
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 0
+// CHECK-NEXT: IntegerLiteral {{.*}} 'int' 1
+const unsigned char table[64] = {
+  0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+  16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+  32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+  48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63,
+};
@@ -0,0 +1,14 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: declaration lookup tables with {{[0-9]+}} names
+// CHECK: names with multiple declarations ({{[0-9]+}} declarations)
+// CHECK: bytes used by lookup tables
+
+namespace N {
+  void f(int);
+  void f(double);
+  struct f;
+  int g;
+}
+
+int h() { return N::g; }
@@ -0,0 +1,26 @@
+// RUN: %clang_cc1 -fsyntax-only -I %S/Inputs -fmemory-report=%t.json %s
+// RUN: FileCheck %s < %t.json
+
+#include "include.h"
+
+template <typename T> struct S { T Member; };
+S<int> Instance;
+
+int bar() { return foo(EQUALS(1, 2)); }
+
+// CHECK: "main_file": "{{.*}}memory-report.cpp",
+// CHECK: "totals": {
+// CHECK: "ast_allocated_bytes": {{[1-9][0-9]*}},
+// CHECK: "source_buffer_malloc_bytes":
+// CHECK: "identifier_table_bytes": {{[1-9][0-9]*}},
+// CHECK: "preprocessor_bytes":
+// CHECK: "decl_kinds": {
+// CHECK-DAG: "ClassTemplate": { "count": 1, "bytes": {{[0-9]+}} }
+// CHECK-DAG: "ClassTemplateSpecialization": { "count": 1, "bytes": {{[0-9]+}} }
+// CHECK: "stmt_kinds": {
+// CHECK-DAG: "CallExpr": { "count": 1, "bytes": {{[0-9]+}} }
+// CHECK-DAG: "ReturnStmt": { "count": 2, "bytes": {{[0-9]+}} }
+// CHECK: "files": [
+// CHECK: { "name": "{{.*}}include.h", "buffer_bytes": {{[1-9][0-9]*}},
+// CHECK-NEXT: "decls": { "count": 2, "bytes": {{[0-9]+}} }, "stmts": { "count": 4, "bytes": {{[0-9]+}} } }
+// CHECK: { "name": "{{.*}}memory-report.cpp", "buffer_bytes": {{[1-9][0-9]*}},
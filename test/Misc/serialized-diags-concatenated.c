@@ -0,0 +1,23 @@
+// Test that the logs of several compiles can be concatenated and read in one
+// go, with each log's numbering of files and flags kept apart.
+
+// RUN: rm -f %t.1.dia %t.2.dia %t.dia
+// RUN: %clang_cc1 -Wall -fsyntax-only %s -serialize-diagnostic-file %t.1.dia
+// RUN: %clang_cc1 -Wall -fsyntax-only -DSECOND %s -serialize-diagnostic-file %t.2.dia
+// RUN: cat %t.1.dia %t.2.dia > %t.dia
+// RUN: c-index-test -read-diagnostics %t.dia 2>&1 | FileCheck %s
+
+#ifndef SECOND
+int f(void) {
+  int x;
+  return x;
+}
+#else
+void g(void) {
+  int y;
+}
+#endif
+
+// CHECK: {{.*}}serialized-diags-concatenated.c:13:10: warning: variable 'x' is uninitialized when used here [-Wuninitialized]
+// CHECK: {{.*}}serialized-diags-concatenated.c:17:7: warning: unused variable 'y' [-Wunused-variable]
+// CHECK: Number of diagnostics: 2
@@ -0,0 +1,35 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -std=c++11 -emit-pch -o %t %s
+// RUN: %clang_cc1 -std=c++11 -include-pch %t -ast-print %s | FileCheck %s --check-prefix=PRINT
+
+// Nodes with operands outside of their fixed-size part report those bytes.
+// CHECK: *** Stmt/Expr Stats:
+// CHECK-DAG: {{ }}1 CXXTemporaryObjectExpr, {{[0-9]+}} each ({{[0-9]+}} bytes + {{[0-9]+}} extra bytes)
+// CHECK-DAG: {{ }}3 CallExpr, {{[0-9]+}} each ({{[0-9]+}} bytes + {{[0-9]+}} extra bytes)
+// CHECK-DAG: {{ }}{{[0-9]+}} CXXConstructExpr, {{[0-9]+}} each ({{[0-9]+}} bytes + {{[0-9]+}} extra bytes)
+// CHECK: Total bytes =
+
+#ifndef HEADER
+#define HEADER
+
+struct S {
+  S(int, int, int);
+};
+
+void use(S);
+void call(int);
+
+inline S temporary() { return S(1, 2, 3); }
+inline void construct() { use({4, 5, 6}); }
+inline void calls() { call(7); call(8); }
+
+#else
+
+// PRINT: return S(1, 2, 3);
+// PRINT: use({4, 5, 6});
+void test() {
+  temporary();
+  construct();
+}
+
+#endif
@@ -0,0 +1,9 @@
+// RUN: %clang_cc1 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: uniqued pointer types, {{[0-9]+}} bytes of buckets
+// CHECK: uniqued template specialization types, {{[0-9]+}} bytes of buckets
+// CHECK: Type uniquing table bytes =
+
+template <typename T> struct S {};
+S<int *> s1;
+S<char *> s2;
@@ -0,0 +1 @@
+int served_function(int);
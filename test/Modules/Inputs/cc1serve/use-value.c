@@ -0,0 +1 @@
+int use_value(void) { return VALUE; }
@@ -0,0 +1,9 @@
+inline int foo() { return 42; }
+
+template <typename T> T tmpl() { return T(); }
+inline int usesTmpl() { return tmpl<int>(); }
+
+inline __attribute__((always_inline)) int alwaysInline() { return 1; }
+
+static inline int internal() { return 2; }
+inline int usesInternal() { return internal(); }
@@ -0,0 +1,3 @@
+#include "foo.h"
+
+int use() { return foo() + usesTmpl() + alwaysInline() + usesInternal(); }
@@ -0,0 +1 @@
+int a_function(void);
@@ -0,0 +1,4 @@
+@interface Base
+- (int)count;
++ (id)make;
+@end
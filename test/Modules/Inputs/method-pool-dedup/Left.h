@@ -0,0 +1,4 @@
+#import "Base.h"
+
+static inline int leftCount(id object) { return [object count]; }
+static inline id leftMake(Class cls) { return [cls make]; }
@@ -0,0 +1,4 @@
+#import "Base.h"
+
+static inline int rightCount(id object) { return [object count]; }
+static inline id rightMake(Class cls) { return [cls make]; }
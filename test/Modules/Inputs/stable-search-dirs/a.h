@@ -0,0 +1 @@
+static const int a_value = 1;
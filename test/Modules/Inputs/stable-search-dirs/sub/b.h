@@ -0,0 +1 @@
+static const int b_value = 2;
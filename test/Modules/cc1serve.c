@@ -0,0 +1,51 @@
+// Test that a compile server shares loaded module files between its jobs.
+
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo '-fsyntax-only -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -I %S/Inputs/cc1serve %s' > %t/jobs
+// RUN: echo '-fsyntax-only -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -I %S/Inputs/cc1serve %s -print-stats' >> %t/jobs
+// RUN: echo '-fsyntax-only -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -I %S/Inputs/cc1serve %s -DBROKEN' >> %t/jobs
+// RUN: echo '-fsyntax-only -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -I %S/Inputs/cc1serve %s -DFATAL' >> %t/jobs
+// RUN: echo '-fsyntax-only -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -I %S/Inputs/cc1serve %s -mllvm -warn-stack-size=0' >> %t/jobs
+// RUN: echo '-fsyntax-only -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache -I %S/Inputs/cc1serve %s -mllvm -warn-stack-size=0' >> %t/jobs
+// RUN: %clang -cc1serve < %t/jobs > %t/out 2> %t/err
+// RUN: FileCheck -check-prefix=STATUS %s < %t/out
+// RUN: FileCheck -check-prefix=STATS %s < %t/err
+
+// A fatal error ends only its job, and each job sets -mllvm options afresh.
+// STATUS: exit 0
+// STATUS-NEXT: exit 0
+// STATUS-NEXT: exit 1
+// STATUS-NEXT: exit {{[1-9][0-9]*}}
+// STATUS-NEXT: exit 0
+// STATUS-NEXT: exit 0
+
+// STATS: 1 AST files reused from the shared module cache
+
+#include "served.h"
+
+int f(void) { return served_function(0); }
+
+#ifdef BROKEN
+int g(void) { return undeclared; }
+#endif
+
+#ifdef FATAL
+#pragma clang __debug llvm_fatal_error
+#endif
+
+// A precompiled header rewritten between two jobs, with the same size and
+// possibly the same modification time, is not served from the cache.
+// RUN: echo 'int first_value;' > %t/first.h
+// RUN: echo 'int other_value;' > %t/other.h
+// RUN: echo '-x c-header -emit-pch -o %t/prefix.pch %t/first.h' > %t/pch-jobs
+// RUN: echo '-fsyntax-only -include-pch %t/prefix.pch -DVALUE=first_value %S/Inputs/cc1serve/use-value.c' >> %t/pch-jobs
+// RUN: echo '-x c-header -emit-pch -o %t/prefix.pch %t/other.h' >> %t/pch-jobs
+// RUN: echo '-fsyntax-only -include-pch %t/prefix.pch -DVALUE=other_value %S/Inputs/cc1serve/use-value.c' >> %t/pch-jobs
+// RUN: %clang -cc1serve < %t/pch-jobs > %t/pch-out
+// RUN: FileCheck -check-prefix=PCH %s < %t/pch-out
+
+// PCH: exit 0
+// PCH-NEXT: exit 0
+// PCH-NEXT: exit 0
+// PCH-NEXT: exit 0
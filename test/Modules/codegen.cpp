@@ -0,0 +1,22 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -triple=x86_64-linux-gnu -fmodules-codegen -x c++ -fmodules -emit-module -fmodule-name=foo %S/Inputs/codegen/foo.modulemap -o %t/foo.pcm
+// RUN: %clang_cc1 -triple=x86_64-linux-gnu -emit-llvm %t/foo.pcm -o - | FileCheck %s --check-prefix=FOO
+// RUN: %clang_cc1 -triple=x86_64-linux-gnu -emit-llvm -fmodules -fmodule-file=%t/foo.pcm -I %S/Inputs/codegen %S/Inputs/codegen/use.cpp -o - | FileCheck %s --check-prefix=USE
+// RUN: %clang_cc1 -triple=x86_64-linux-gnu -emit-llvm -O1 -disable-llvm-optzns -fmodules -fmodule-file=%t/foo.pcm -I %S/Inputs/codegen %S/Inputs/codegen/use.cpp -o - | FileCheck %s --check-prefix=USE-OPT
+
+// Building the object file of the module emits the definitions of its
+// functions, even the unused ones, so that its importers do not have to.
+
+// FOO-DAG: define weak_odr i32 @_Z3foov()
+// FOO-DAG: define weak_odr i32 @_Z8usesTmplv()
+// FOO-DAG: define weak_odr i32 @_Z4tmplIiET_v()
+// FOO-DAG: define weak_odr i32 @_Z12usesInternalv()
+// FOO-NOT: @_Z12alwaysInlinev
+
+// USE-DAG: declare i32 @_Z3foov()
+// USE-DAG: declare i32 @_Z8usesTmplv()
+// USE-DAG: declare i32 @_Z12usesInternalv()
+// USE-DAG: define linkonce_odr i32 @_Z12alwaysInlinev()
+
+// USE-OPT-DAG: define available_externally i32 @_Z3foov()
+// USE-OPT-DAG: define available_externally i32 @_Z8usesTmplv()
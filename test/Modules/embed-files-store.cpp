@@ -0,0 +1,26 @@
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'module a { header "a.h" header "x.h" } module b { header "b.h" }' > %t/modulemap
+// RUN: echo 'extern int t;' > %t/t.h
+// RUN: echo '#include "t.h"' > %t/a.h
+// RUN: echo '#include "t.h"' > %t/b.h
+// RUN: echo '#include "t.h"' > %t/x.h
+
+// RUN: %clang_cc1 -fmodules -I%t -fmodules-embed-all-files -fmodules-embed-store=%t/store %t/modulemap -fmodule-name=a -x c++ -emit-module -o %t/a.pcm
+// RUN: %clang_cc1 -fmodules -I%t -fmodules-embed-all-files -fmodules-embed-store=%t/store %t/modulemap -fmodule-name=b -x c++ -emit-module -o %t/b.pcm
+
+// The module map, t.h, and the identical a.h, b.h and x.h are stored once.
+// RUN: ls %t/store | count 3
+// RUN: llvm-bcanalyzer -dump %t/a.pcm | FileCheck -check-prefix=BITCODE %s
+// BITCODE: <SM_SLOC_BUFFER_BLOB_SHARED
+
+// RUN: rm %t/x.h %t/t.h
+// RUN: %clang_cc1 -fmodules -I%t -fmodule-map-file=%t/modulemap -fmodule-file=%t/a.pcm -fmodule-file=%t/b.pcm %s -verify
+
+// RUN: rm -rf %t/store
+// RUN: not %clang_cc1 -fmodules -I%t -fmodule-map-file=%t/modulemap -fmodule-file=%t/a.pcm %s 2>&1 | FileCheck -check-prefix=MISSING %s
+// MISSING: could not read embedded file contents from '{{.*}}store
+
+#include "a.h"
+char t; // expected-error {{different type}}
+// expected-note@t.h:1 {{here}}
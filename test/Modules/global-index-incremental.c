@@ -0,0 +1,35 @@
+// Test that the global module index keeps the module files it already
+// indexed when a new module is added to the cache.
+
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fdisable-module-hash \
+// RUN:   -fmodules-cache-path=%t -I %S/Inputs/global-index-incremental \
+// RUN:   -fsyntax-only -DIMPORT_A %s
+// RUN: llvm-bcanalyzer -dump %t/modules.idx | FileCheck -check-prefix=ONE %s
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fdisable-module-hash \
+// RUN:   -fmodules-cache-path=%t -I %S/Inputs/global-index-incremental \
+// RUN:   -fsyntax-only -DIMPORT_B %s
+// RUN: llvm-bcanalyzer -dump %t/modules.idx | FileCheck -check-prefix=TWO %s
+
+// The merged index is used like one written from scratch.
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fdisable-module-hash \
+// RUN:   -fmodules-cache-path=%t -I %S/Inputs/global-index-incremental \
+// RUN:   -fsyntax-only -DIMPORT_A -DIMPORT_B -print-stats %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=STATS %s
+
+// ONE: <MODULE
+// ONE-NOT: <MODULE
+// TWO: <MODULE
+// TWO: <MODULE
+// TWO-NOT: <MODULE
+// STATS: *** Global Module Index Statistics:
+
+#ifdef IMPORT_A
+#include "a.h"
+int a(void) { return a_function(); }
+#endif
+
+#ifdef IMPORT_B
+#include "b.h"
+int b(void) { return b_function(); }
+#endif
@@ -0,0 +1,17 @@
+// Test that name lookups skip the lookup tables of modules that can't
+// contain the name.
+
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'module a { header "a.h" } module b { header "b.h" }' > %t/module.modulemap
+// RUN: echo 'namespace N { int in_a(); }' > %t/a.h
+// RUN: echo 'namespace N { int in_b(); }' > %t/b.h
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t/cache \
+// RUN:   -I %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: {{[1-9][0-9]*}} / {{[0-9]+}} name lookup table probes skipped by their filters
+
+#include "a.h"
+#include "b.h"
+
+int f() { return N::in_a() + N::in_b() + N::in_c(); } // expected-error {{no member named 'in_c' in namespace 'N'}}
@@ -0,0 +1,30 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t \
+// RUN:   -I %S/Inputs/method-pool-dedup -fsyntax-only -verify -print-stats %s \
+// RUN:   2>&1 | FileCheck %s
+
+// Left and Right both looked up -count and +make from Base while they were
+// built, so each of their method pools carries Base's declarations. Importing
+// both must not put the same declaration into the global pool twice.
+
+@import Left;
+@import Right;
+
+@interface Derived : Base
+@end
+
+@interface Other
+- (float)count;
+@end
+
+void test(id object, Class cls, __kindof Derived *derived) {
+  (void)[cls make];
+  // -[Other count] is outside Derived's hierarchy.
+  (void)[derived count];
+  // expected-warning@+3 {{multiple methods named 'count' found}}
+  // expected-note@Inputs/method-pool-dedup/Base.h:2 {{using}}
+  // expected-note@17 {{also found}}
+  (void)[object count];
+}
+
+// CHECK: 2 duplicate method pool entries skipped
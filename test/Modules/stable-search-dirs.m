@@ -0,0 +1,13 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fsyntax-only -verify -fassume-stable-header-search-dirs -I %S/Inputs/stable-search-dirs %s
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -fmodules -fimplicit-module-maps -fmodules-cache-path=%t -fsyntax-only -verify -I %S/Inputs/stable-search-dirs %s
+// expected-no-diagnostics
+
+// Module maps are found through the directory index, and directories
+// without one are remembered.
+@import A;
+#include "sub/b.h"
+#include "sub/b.h"
+
+int x[a_value + b_value == 3 ? 1 : -1];
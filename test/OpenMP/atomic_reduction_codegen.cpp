@@ -0,0 +1,53 @@
+// RUN: %clang_cc1 -verify -fopenmp -fopenmp-atomic-reductions -x c++ -triple x86_64-apple-darwin10 -emit-llvm %s -o - | FileCheck %s
+// RUN: %clang_cc1 -verify -fopenmp -x c++ -triple x86_64-apple-darwin10 -emit-llvm %s -o - | FileCheck %s --check-prefix=RUNTIME
+// expected-no-diagnostics
+
+struct S {
+  int a;
+  S &operator+=(const S &);
+};
+#pragma omp declare reduction(+ : S : omp_out += omp_in)
+
+// CHECK-LABEL: @_Z8sum_intsPii(
+// RUNTIME-LABEL: @_Z8sum_intsPii(
+int sum_ints(int *v, int n) {
+  int s = 0;
+#pragma omp parallel for reduction(+ : s)
+  for (int i = 0; i < n; ++i)
+    s += v[i];
+  return s;
+}
+
+// CHECK-LABEL: define internal void @.omp_outlined.(
+// CHECK-NOT: @__kmpc_reduce
+// CHECK: atomicrmw add i32* %{{.+}}, i32 %{{.+}} monotonic
+// CHECK-NOT: @__kmpc_reduce
+// CHECK: ret void
+// RUNTIME-LABEL: define internal void @.omp_outlined.(
+// RUNTIME: call i32 @__kmpc_reduce_nowait(
+
+// CHECK-LABEL: @_Z10max_floatsPfi(
+float max_floats(float *v, int n) {
+  float m = 0;
+#pragma omp for reduction(max : m)
+  for (int i = 0; i < n; ++i)
+    m = m < v[i] ? v[i] : m;
+  return m;
+}
+
+// CHECK-NOT: @__kmpc_reduce
+// CHECK: cmpxchg
+// CHECK-NOT: @__kmpc_reduce
+// CHECK: call void @__kmpc_barrier(
+// CHECK: ret float
+
+// CHECK-LABEL: @_Z11sum_structsP1Si(
+S sum_structs(S *v, int n) {
+  S s = {0};
+#pragma omp for reduction(+ : s)
+  for (int i = 0; i < n; ++i)
+    s += v[i];
+  return s;
+}
+
+// CHECK: call i32 @__kmpc_reduce(
@@ -0,0 +1,51 @@
+// RUN: %clang_cc1 -verify -fopenmp -fopenmp-inline-static-schedule -x c++ -triple x86_64-unknown-unknown -emit-llvm %s -o - | FileCheck %s
+// expected-no-diagnostics
+
+void body(int);
+
+// CHECK-LABEL: define internal void @.omp_outlined.(
+// CHECK-NOT: call void @__kmpc_for_static_init_4(
+// CHECK: [[TID:%.+]] = call i32 @omp_get_thread_num()
+// CHECK: [[NTH:%.+]] = call i32 @omp_get_num_threads()
+// CHECK: [[TRIP:%.+]] = add i32 %{{.+}}, 1
+// CHECK: [[SMALL:%.+]] = udiv i32 [[TRIP]], [[NTH]]
+// CHECK: [[EXTRAS:%.+]] = urem i32 [[TRIP]], [[NTH]]
+// CHECK: [[HAS_EXTRAS:%.+]] = icmp ne i32 [[EXTRAS]], 0
+// CHECK: [[EXTRA:%.+]] = zext i1 [[HAS_EXTRAS]] to i32
+// CHECK: [[CHUNK:%.+]] = add i32 [[SMALL]], [[EXTRA]]
+// CHECK: [[OFFSET:%.+]] = mul i32 [[TID]], [[CHUNK]]
+// CHECK: [[IN_RANGE:%.+]] = icmp ult i32 [[OFFSET]], [[TRIP]]
+// CHECK: [[REMAINING:%.+]] = sub i32 [[TRIP]], [[OFFSET]]
+// CHECK: [[IS_LAST:%.+]] = icmp ule i32 [[REMAINING]], [[CHUNK]]
+// CHECK: [[SIZE:%.+]] = select i1 [[IS_LAST]], i32 [[REMAINING]], i32 [[CHUNK]]
+// CHECK: [[LOWER:%.+]] = add i32 %{{.+}}, [[OFFSET]]
+// CHECK: select i1 [[IN_RANGE]], i32 [[LOWER]],
+// CHECK: add i32 [[LOWER]], [[SIZE]]
+// CHECK: and i1 [[IN_RANGE]], [[IS_LAST]]
+// CHECK-NOT: call void @__kmpc_for_static_fini(
+// CHECK: ret void
+void run(int n) {
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < n; ++i)
+    body(i);
+}
+
+// Chunked and ordered loops still use the runtime.
+// CHECK-LABEL: define internal void @.omp_outlined..1(
+// CHECK: call void @__kmpc_for_static_init_4(
+// CHECK: call void @__kmpc_for_static_fini(
+void run_chunked(int n) {
+#pragma omp parallel for schedule(static, 4)
+  for (int i = 0; i < n; ++i)
+    body(i);
+}
+
+// CHECK-LABEL: define internal void @.omp_outlined..2(
+// CHECK: call void @__kmpc_dispatch_init_4(
+void run_ordered(int n) {
+#pragma omp parallel for schedule(static) ordered
+  for (int i = 0; i < n; ++i) {
+#pragma omp ordered
+    body(i);
+  }
+}
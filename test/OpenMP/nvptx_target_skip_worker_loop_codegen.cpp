@@ -0,0 +1,37 @@
+// Test target codegen without the worker loop - host bc file has to be created first.
+// RUN: %clang_cc1 -verify -fopenmp -x c++ -triple powerpc64le-unknown-unknown -fopenmp-targets=nvptx64-nvidia-cuda -emit-llvm-bc %s -o %t-ppc-host.bc
+// RUN: %clang_cc1 -verify -fopenmp -x c++ -triple nvptx64-unknown-unknown -fopenmp-targets=nvptx64-nvidia-cuda -emit-llvm %s -fopenmp-is-device -fopenmp-nvptx-skip-worker-loop -fopenmp-host-ir-file-path %t-ppc-host.bc -o - | FileCheck %s
+// expected-no-diagnostics
+#ifndef HEADER
+#define HEADER
+
+int foo(int n) {
+  int a = 0;
+
+  // CHECK-NOT: _worker()
+  // CHECK: define {{.*}}void [[T1:@__omp_offloading_.+foo.+l29]](
+  // CHECK: [[NTID:%.+]] = call i32 @llvm.nvvm.read.ptx.sreg.ntid.x()
+  // CHECK: [[WS:%.+]] = call i32 @llvm.nvvm.read.ptx.sreg.warpsize()
+  // CHECK: [[MID:%.+]] = and i32
+  // CHECK: [[TID:%.+]] = call i32 @llvm.nvvm.read.ptx.sreg.tid.x()
+  // CHECK: [[IS_MASTER:%.+]] = icmp eq i32 [[TID]], [[MID]]
+  // CHECK: br i1 [[IS_MASTER]], label {{%?}}[[MASTER:.+]], label {{%?}}[[EXIT:.+]]
+  //
+  // CHECK: [[MASTER]]
+  // CHECK: call void @__kmpc_kernel_init(i32 0, i32
+  // CHECK-NOT: call void @llvm.nvvm.barrier0()
+  // CHECK: add nsw i32 {{.+}}, 1
+  // CHECK-NOT: call void @llvm.nvvm.barrier0()
+  // CHECK: br label {{%?}}[[EXIT]]
+  //
+  // CHECK: [[EXIT]]
+  // CHECK: ret void
+  #pragma omp target
+  {
+    a += 1;
+  }
+
+  return a;
+}
+
+#endif
@@ -0,0 +1,30 @@
+// RUN: %clang_cc1 -verify -fopenmp -x c++ -triple x86_64-apple-darwin10 -emit-llvm %s -o - | FileCheck %s
+// expected-no-diagnostics
+
+// Check that an undeferred task reads the shareds of the encountering task in
+// place instead of from a copy in the runtime allocation.
+
+void fn(int &);
+
+// CHECK-LABEL: @main
+int main() {
+  int a = 0;
+// CHECK: [[AGG:%.+]] = alloca [[SHAREDS_TY:%.+]],
+// CHECK: [[AGG2:%.+]] = alloca [[SHAREDS_TY2:%.+]],
+// CHECK: [[GTID:%.+]] = call i32 @__kmpc_global_thread_num(
+// CHECK: [[ORIG_TASK_PTR:%.+]] = call i8* @__kmpc_omp_task_alloc({{[^,]+}}, i32 [[GTID]], i32 1, i64 {{[0-9]+}}, i64 8,
+// CHECK: call void @llvm.memcpy
+// CHECK: call i32 @__kmpc_omp_task(%{{.+}}* @{{.+}}, i32 [[GTID]], i8* [[ORIG_TASK_PTR]])
+#pragma omp task if (1) shared(a)
+  fn(a);
+// CHECK: [[ORIG_TASK_PTR:%.+]] = call i8* @__kmpc_omp_task_alloc({{[^,]+}}, i32 [[GTID]], i32 1, i64 {{[0-9]+}}, i64 0,
+// CHECK-NOT: call void @llvm.memcpy
+// CHECK: [[SHAREDS:%.+]] = bitcast [[SHAREDS_TY2]]* [[AGG2]] to i8*
+// CHECK: store i8* [[SHAREDS]], i8** %
+// CHECK-NOT: call void @llvm.memcpy
+// CHECK: call void @__kmpc_omp_task_begin_if0(
+// CHECK: call void @__kmpc_omp_task_complete_if0(
+#pragma omp task if (0) shared(a)
+  fn(a);
+  return a;
+}
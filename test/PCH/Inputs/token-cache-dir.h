@@ -0,0 +1,20 @@
+#ifndef TOKEN_CACHE_DIR_H
+#define TOKEN_CACHE_DIR_H
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+#define TOKEN_CACHE_VALUE 42
+
+static inline int token_cache_function(int x) {
+  /* Block comments and "string literals" are replayed from the cache. */
+  const char *s = "literal";
+  return x + (s[0] == 'l');
+}
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
@@ -0,0 +1,5 @@
+#ifndef TOKEN_CACHE_WARNING_H
+#define TOKEN_CACHE_WARNING_H
+#warning   replayed from the "token cache"
+int token_cache_warning;
+#endif
@@ -0,0 +1,26 @@
+// Test the statistics on AST files mapped rather than copied into memory.
+// The header is large enough that its AST file is always mapped, as long as
+// nothing asks for a copy of it.
+
+// RUN: %clang_cc1 -emit-pch -o %t %s
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: 1/1 AST files mapped without copying, 0 bytes copied
+
+#ifndef HEADER
+#define HEADER
+
+#define DECL1(n) int f##n(int); struct S##n { int m##n; };
+#define DECL10(n) DECL1(n##0) DECL1(n##1) DECL1(n##2) DECL1(n##3) \
+  DECL1(n##4) DECL1(n##5) DECL1(n##6) DECL1(n##7) DECL1(n##8) DECL1(n##9)
+#define DECL100(n) DECL10(n##0) DECL10(n##1) DECL10(n##2) DECL10(n##3) \
+  DECL10(n##4) DECL10(n##5) DECL10(n##6) DECL10(n##7) DECL10(n##8) \
+  DECL10(n##9)
+
+DECL100(0) DECL100(1) DECL100(2) DECL100(3) DECL100(4)
+
+#else
+
+int g(void) { return f000(0) + f499(0); }
+
+#endif
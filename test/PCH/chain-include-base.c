@@ -0,0 +1,31 @@
+// Chain headers in memory on top of a precompiled header built on disk.
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: cp %S/Inputs/chain-decls1.h %t/base.h
+// RUN: %clang_cc1 -emit-pch -o %t/base.pch %t/base.h
+// RUN: %clang_cc1 -include-pch %t/base.pch -chain-include %S/Inputs/chain-decls2.h -fsyntax-only -verify %s
+
+// The base precompiled header is still validated.
+// RUN: echo '// modified' >> %t/base.h
+// RUN: not %clang_cc1 -include-pch %t/base.pch -chain-include %S/Inputs/chain-decls2.h -fsyntax-only %s 2>&1 | FileCheck %s
+// CHECK: file '{{.*}}base.h' has been modified since the precompiled header
+
+// expected-no-diagnostics
+
+int h() {
+  f();
+  g();
+
+  struct one x;
+  one();
+  struct two y;
+  two();
+  struct three z;
+
+  many(0);
+  struct many m;
+
+  noret();
+
+  return 0;
+}
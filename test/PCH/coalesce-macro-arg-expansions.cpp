@@ -0,0 +1,28 @@
+// RUN: %clang_cc1 -x c++-header -emit-pch %s -o %t.default.pch
+// RUN: not %clang_cc1 -include-pch %t.default.pch -fsyntax-only %s 2> %t.default
+// RUN: %clang_cc1 -x c++-header -emit-pch -coalesce-macro-arg-expansions %s -o %t.coalesced.pch
+// RUN: not %clang_cc1 -include-pch %t.coalesced.pch -fsyntax-only -coalesce-macro-arg-expansions %s 2> %t.coalesced
+// RUN: diff %t.default %t.coalesced
+// RUN: FileCheck %s < %t.coalesced
+
+// Arguments coalesced while building the PCH keep their own expansion
+// locations when the PCH is loaded.
+
+#ifndef HEADER_INCLUDED
+#define HEADER_INCLUDED
+
+#define TWO(a, b) a; b
+
+template<typename T> void f(T t) {
+  TWO(t.x, t.y);
+}
+
+#else
+
+struct S { int x; };
+void g(S s) { f(s); }
+
+// CHECK: {{.*}}:17:14: error: no member named 'y' in 'S'
+// CHECK: {{.*}}:14:22: note: expanded from macro 'TWO'
+
+#endif
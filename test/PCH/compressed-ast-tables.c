@@ -0,0 +1,36 @@
+// REQUIRES: zlib
+
+// Test with pch.
+// RUN: %clang_cc1 -emit-pch -fcompress-ast-tables -o %t %s
+// RUN: %clang_cc1 -include-pch %t -fsyntax-only -verify %s
+// RUN: llvm-bcanalyzer -dump %t | FileCheck %s
+
+// The offset tables record their uncompressed size, or zero if they were
+// small enough to be stored as is.
+// CHECK: <TYPE_OFFSET abbrevid={{[0-9]+}} op0={{[0-9]+}} op1={{[0-9]+}} op2={{[0-9]+}}/>
+// CHECK: <DECL_OFFSET abbrevid={{[0-9]+}} op0={{[0-9]+}} op1={{[0-9]+}} op2={{[1-9][0-9]*}}/>
+
+#ifndef HEADER
+#define HEADER
+
+#define TEN(X) X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7) X(8) X(9)
+#define FIELD(N) int m##N;
+#define FIELDS(N) FIELD(N##0) FIELD(N##1) FIELD(N##2) FIELD(N##3) \
+                  FIELD(N##4) FIELD(N##5) FIELD(N##6) FIELD(N##7) \
+                  FIELD(N##8) FIELD(N##9)
+#define FUNCTION(N) int f##N(struct Big *);
+
+struct Big { TEN(FIELDS) };
+TEN(FUNCTION)
+
+#else
+
+// expected-no-diagnostics
+
+// Laying out the struct walks its compressed lexical contents.
+_Static_assert(__builtin_offsetof(struct Big, m99) == 99 * sizeof(int),
+               "unexpected layout");
+
+int g(struct Big *B) { return f3(B) + B->m37; }
+
+#endif
@@ -0,0 +1,34 @@
+// Test that declarations decoded ahead of use are read back correctly.
+
+// RUN: %clang_cc1 -emit-pch -o %t %s
+// RUN: %clang_cc1 -include-pch %t -decl-prefetch-threads 4 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -include-pch %t -decl-prefetch-threads 4 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: {{[1-9][0-9]*}}/{{[1-9][0-9]*}} prefetched declaration records used
+
+#ifndef HEADER
+#define HEADER
+
+struct Point { int x, y; };
+typedef struct Point Point;
+enum Color { Red, Green, Blue };
+
+static inline int sum(Point p) {
+  int s = p.x;
+  s += p.y;
+  return s;
+}
+
+extern int counter;
+int twice(int);
+
+#else
+
+// expected-no-diagnostics
+
+int use(void) {
+  Point p = { 1, Green };
+  return sum(p) + twice(counter) + Blue;
+}
+
+#endif
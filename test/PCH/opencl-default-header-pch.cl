@@ -0,0 +1,21 @@
+// Check that a PCH of the OpenCL default header in the resource directory is
+// used instead of parsing the header when it matches the compilation.
+
+// RUN: rm -rf %t
+// RUN: mkdir -p %t/include %t/pch/opencl-c
+// RUN: echo 'typedef int opencl_c_h_int;' > %t/include/opencl-c.h
+
+// A compilation without a PCH parses the header.
+// RUN: %clang_cc1 -triple spir-unknown-unknown -finclude-default-header -resource-dir %t -internal-isystem %t/include -fsyntax-only -print-stats %s 2>&1 | FileCheck --check-prefix=NO-PCH %s
+
+// RUN: %clang_cc1 -triple spir-unknown-unknown -finclude-default-header -resource-dir %t -internal-isystem %t/include -x cl -emit-pch -o %t/pch/opencl-c/spir.pch %t/include/opencl-c.h
+// RUN: %clang_cc1 -triple spir-unknown-unknown -finclude-default-header -resource-dir %t -internal-isystem %t/include -fsyntax-only -print-stats %s 2>&1 | FileCheck --check-prefix=PCH %s
+
+// A PCH for another target or OpenCL version is not used.
+// RUN: %clang_cc1 -triple spir64-unknown-unknown -finclude-default-header -resource-dir %t -internal-isystem %t/include -fsyntax-only -print-stats %s 2>&1 | FileCheck --check-prefix=NO-PCH %s
+// RUN: %clang_cc1 -triple spir-unknown-unknown -cl-std=CL1.2 -finclude-default-header -resource-dir %t -internal-isystem %t/include -fsyntax-only -print-stats %s 2>&1 | FileCheck --check-prefix=NO-PCH %s
+
+// PCH: *** AST File Statistics:
+// NO-PCH-NOT: *** AST File Statistics:
+
+kernel void k(global opencl_c_h_int *p) {}
@@ -0,0 +1,32 @@
+// Without -fpch-instantiate-templates, the instantiation is left to the
+// translation unit.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -o %t.pch %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t.pch -emit-llvm -o - %s | FileCheck %s
+
+// With it, the instantiation is performed when the PCH is built.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -fpch-instantiate-templates -o %t-inst.pch %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -include-pch %t-inst.pch -emit-llvm -o - %s | FileCheck %s
+// RUN: not %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -fpch-instantiate-templates -DBAD -o %t-bad.pch %s 2>&1 | FileCheck --check-prefix=CHECK-BAD %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -x c++-header -emit-pch -DBAD -o %t-bad.pch %s
+
+// CHECK: define linkonce_odr i32 @_Z3getIiET_v()
+// CHECK-BAD: error: type 'int' cannot be used prior to '::'
+
+#ifndef HEADER
+#define HEADER
+
+template <typename T> T get() {
+#ifdef BAD
+  return T::value;
+#else
+  return T();
+#endif
+}
+
+inline int use() { return get<int>(); }
+
+#else
+
+int main() { return use(); }
+
+#endif
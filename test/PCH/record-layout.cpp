@@ -0,0 +1,48 @@
+// Test this without pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -std=c++11 -include %s \
+// RUN:   -fsyntax-only -fdump-record-layouts %s | FileCheck %s
+
+// Test with pch.
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -std=c++11 \
+// RUN:   -x c++-header -emit-pch -o %t %s
+// RUN: %clang_cc1 -triple x86_64-unknown-unknown -std=c++11 -include-pch %t \
+// RUN:   -fsyntax-only -fdump-record-layouts %s | FileCheck %s
+
+#ifndef HEADER
+#define HEADER
+
+struct Base {
+  virtual void f();
+  int x;
+};
+
+struct Empty {};
+
+struct VBase {
+  char c;
+};
+
+struct Derived : Base, Empty, virtual VBase {
+  short s;
+};
+
+// Lay out the records while building the PCH.
+static_assert(sizeof(Derived) == 16, "");
+
+#else
+
+int n[] = {sizeof(Base), sizeof(Empty), sizeof(VBase), sizeof(Derived)};
+
+// CHECK: *** Dumping AST Record Layout
+// CHECK:          0 | struct Derived
+// CHECK-NEXT:     0 |   struct Base (primary base)
+// CHECK-NEXT:     0 |     (Base vtable pointer)
+// CHECK-NEXT:     8 |     int x
+// CHECK-NEXT:     0 |   struct Empty (base) (empty)
+// CHECK-NEXT:    12 |   short s
+// CHECK-NEXT:    14 |   struct VBase (virtual base)
+// CHECK-NEXT:    14 |     char c
+// CHECK-NEXT:       | [sizeof=16, dsize=15, align=8,
+// CHECK-NEXT:       |  nvsize=14, nvalign=8]
+
+#endif
@@ -0,0 +1,21 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -triple i386-unknown-unknown -token-cache-dir %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s --check-prefix=CHECK-COLD
+// RUN: %clang_cc1 -triple i386-unknown-unknown -token-cache-dir %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s --check-prefix=CHECK-WARM
+
+// #warning and #error in a cached header are diagnosed on a cache hit too.
+#include "Inputs/token-cache-warning.h"
+// expected-warning@Inputs/token-cache-warning.h:3 {{replayed from the "token cache"}}
+
+int test(void) {
+  return token_cache_warning;
+}
+
+// Headers minimized to their directives are cached by their minimized
+// contents, so a second compile hits.
+// RUN: rm -rf %t.min
+// RUN: %clang_cc1 -E -minimize-source-to-dependency-directives -token-cache-dir %t.min -print-stats %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=CHECK-COLD
+// RUN: %clang_cc1 -E -minimize-source-to-dependency-directives -token-cache-dir %t.min -print-stats %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=CHECK-WARM
+// RUN: ls %t.min | count 1
+
+// CHECK-COLD: 0 cache hits, 1 cache misses.
+// CHECK-WARM: 1 cache hits, 0 cache misses.
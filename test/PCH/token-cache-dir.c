@@ -0,0 +1,19 @@
+// RUN: rm -rf %t
+// RUN: %clang_cc1 -triple i386-unknown-unknown -token-cache-dir %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s --check-prefix=CHECK-COLD
+// RUN: %clang_cc1 -triple i386-unknown-unknown -token-cache-dir %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s --check-prefix=CHECK-WARM
+// RUN: ls %t | count 1
+
+// A different language mode must not reuse the C entry.
+// RUN: %clang_cc1 -x c++ -triple i386-unknown-unknown -token-cache-dir %t -fsyntax-only -verify -print-stats %s 2>&1 | FileCheck %s --check-prefix=CHECK-COLD
+// RUN: ls %t | count 2
+
+// expected-no-diagnostics
+
+#include "Inputs/token-cache-dir.h"
+
+int test(void) {
+  return TOKEN_CACHE_VALUE + token_cache_function(1);
+}
+
+// CHECK-COLD: 0 cache hits, 1 cache misses.
+// CHECK-WARM: 1 cache hits, 0 cache misses.
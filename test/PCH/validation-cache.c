@@ -0,0 +1,35 @@
+// Test that a PCH validated once during a build session isn't validated again
+// by the other compilations of that session.
+
+// RUN: rm -rf %t
+// RUN: mkdir %t
+// RUN: echo 'int f(void);' > %t/header.h
+// RUN: %clang_cc1 -x c-header -emit-pch -o %t/header.pch %t/header.h
+
+// The first compilation validates the input files and records the PCH.
+// RUN: %clang_cc1 -include-pch %t/header.pch -fsyntax-only -print-stats \
+// RUN:   -fbuild-session-timestamp=1000 -fpch-validation-cache=%t/cache %s \
+// RUN:   2>&1 | FileCheck -check-prefix=VALIDATED %s
+// RUN: FileCheck -check-prefix=CACHE %s < %t/cache
+
+// The next one finds the PCH in the cache.
+// RUN: %clang_cc1 -include-pch %t/header.pch -fsyntax-only -print-stats \
+// RUN:   -fbuild-session-timestamp=1000 -fpch-validation-cache=%t/cache %s \
+// RUN:   2>&1 | FileCheck -check-prefix=SKIPPED %s
+
+// A new build session validates the input files again.
+// RUN: touch -m -a -t 201008011501 %t/header.h
+// RUN: not %clang_cc1 -include-pch %t/header.pch -fsyntax-only \
+// RUN:   -fbuild-session-timestamp=2000 -fpch-validation-cache=%t/cache %s \
+// RUN:   2>&1 | FileCheck -check-prefix=MODIFIED %s
+
+// The input files hash is recorded in the control block.
+// RUN: llvm-bcanalyzer -dump %t/header.pch | FileCheck -check-prefix=BITCODE %s
+
+// VALIDATED-NOT: not revalidated
+// CACHE: 1000 {{[0-9a-f]+}} {{[0-9]+}} {{[0-9]+}} {{.*}}header.pch
+// SKIPPED: 1 PCH files not revalidated during this build session
+// MODIFIED: file '{{.*}}header.h' has been modified since the precompiled header
+// BITCODE: <INPUT_FILES_HASH
+
+int g(void) { return f(); }
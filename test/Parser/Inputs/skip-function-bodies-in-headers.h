@@ -0,0 +1,14 @@
+#define DEFINE_IN_MAIN_FILE(name) void name() { main_file_error }
+
+void ordinary() { header_error }
+inline int inlined() { return header_error; }
+
+struct S {
+  int member() { header_error }
+};
+
+constexpr int square(int x) { return x * x; }
+
+auto deduced() { return 1; }
+
+template <typename T> T templated(T t) { return t.missing(); }
@@ -0,0 +1,31 @@
+// RUN: %clang_cc1 -fsyntax-only -ast-dump %s | FileCheck %s
+
+// The disambiguation of a function declarator is remembered while a
+// declaration is parsed, but must not outlive a change to what name lookup
+// finds for the names inside the parentheses.
+
+struct a {};
+struct T { T(); T(a); T(const T &); };
+
+void f() {
+  // 'a' is declared by the first declarator, so the parentheses of 'b' hold
+  // an expression.
+  T(a), b(a);
+}
+// CHECK-LABEL: FunctionDecl {{.*}} f 'void (void)'
+// CHECK: VarDecl {{.*}} a 'T' callinit
+// CHECK: VarDecl {{.*}} b 'T' callinit
+// CHECK-NEXT: CXXConstructExpr {{.*}} 'T' 'void (const T &)'
+
+struct S {
+  // The body is parsed once the class is complete, when 'U' names the type
+  // below, so 'c' is a function.
+  void g() { int c(U); }
+  void h() { int d(V); }
+  typedef int U;
+  static int V;
+};
+// CHECK-LABEL: CXXMethodDecl {{.*}} g 'void (void)'
+// CHECK: FunctionDecl {{.*}} c 'int (U)'
+// CHECK-LABEL: CXXMethodDecl {{.*}} h 'void (void)'
+// CHECK: VarDecl {{.*}} d 'int' callinit
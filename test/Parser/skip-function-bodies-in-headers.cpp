@@ -0,0 +1,14 @@
+// RUN: %clang_cc1 -fsyntax-only -std=c++14 -verify -I %S/Inputs \
+// RUN:   -fskip-function-bodies-in-headers %s
+
+#include "skip-function-bodies-in-headers.h"
+
+static_assert(square(3) == 9, "constexpr bodies are kept");
+int i = deduced();
+
+int main_file() { return main_error; } // expected-error {{use of undeclared identifier 'main_error'}}
+
+DEFINE_IN_MAIN_FILE(expanded) // expected-error {{use of undeclared identifier 'main_file_error'}}
+
+int instantiate = templated(i); // expected-error@skip-function-bodies-in-headers.h:14 {{member reference base type 'int' is not a structure or union}} \
+                                // expected-note {{in instantiation of function template specialization}}
@@ -0,0 +1,7 @@
+#ifndef HEADER_H
+#define HEADER_H
+#define FROM_HEADER 3
+static inline int g(int x) {
+  return x * FROM_HEADER;
+}
+#endif
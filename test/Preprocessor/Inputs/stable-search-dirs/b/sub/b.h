@@ -0,0 +1 @@
+#define B_H 1
@@ -0,0 +1,17 @@
+// RUN: %clang_cc1 -fsyntax-only %s 2> %t.default
+// RUN: %clang_cc1 -fsyntax-only -coalesce-macro-arg-expansions %s 2> %t.coalesced
+// RUN: diff %t.default %t.coalesced
+// RUN: %clang_cc1 -fsyntax-only -w -print-stats -coalesce-macro-arg-expansions %s 2>&1 | FileCheck %s
+
+// Diagnostics inside coalesced arguments still point at the right place in
+// the macro body.
+
+#define TWO(a, b) a; b
+#define WRAP(x) TWO(x, x == 3)
+
+void f(int i) {
+  TWO(i == 1, i == 2);
+  WRAP(i);
+}
+
+// CHECK: {{[1-9][0-9]*}} macro argument expansions coalesced.
@@ -0,0 +1,16 @@
+// REQUIRES: zlib, shell
+// RUN: %clang_cc1 -E -fcompress-preprocessed-output %s -o %t.E
+// RUN: od -An -tx1 -N2 %t.E | FileCheck -check-prefix=HEADER %s
+// RUN: not grep -q preprocessed_marker %t.E
+// RUN: %clang_cc1 -E -frewrite-includes -fcompress-preprocessed-output %s -o %t.R
+// RUN: od -An -tx1 -N2 %t.R | FileCheck -check-prefix=HEADER %s
+// RUN: %clang -### -E -fcompress-preprocessed-output %s 2>&1 \
+// RUN:   | FileCheck -check-prefix=DRIVER %s
+
+// The output is a zlib stream.
+// HEADER: 78 9c
+// DRIVER: "-cc1"
+// DRIVER-SAME: "-fcompress-preprocessed-output"
+
+#define MARKER preprocessed_marker
+int MARKER;
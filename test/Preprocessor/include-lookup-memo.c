@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -E -I %S/Inputs/include-lookup-memo %s | FileCheck %s
+// RUN: %clang_cc1 -E -print-stats -I %S/Inputs/include-lookup-memo %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+// RUN: %clang_cc1 -E -M -I %S/Inputs/include-lookup-memo %s | FileCheck %s --check-prefix=DEPS
+
+#include "guarded.h"
+#include <guarded.h>
+#include "guarded.h"
+#include "once.h"
+#include "once.h"
+#include <guarded.h>
+
+// CHECK: int guarded;
+// CHECK-NOT: int guarded;
+// CHECK: int once;
+// CHECK-NOT: int once;
+
+// The first quoted and the first angled #include of each header search for
+// it, the rest reuse that lookup.
+// STATS: 3 header searches skipped for files with no effect.
+
+// DEPS: include-lookup-memo.o:
+// DEPS: guarded.h
+// DEPS: once.h
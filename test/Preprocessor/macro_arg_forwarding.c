@@ -0,0 +1,32 @@
+// RUN: %clang_cc1 -E %s | FileCheck %s
+
+// Arguments forwarded unchanged through several levels of macros are only
+// pre-expanded once; the result must be the same as expanding them at every
+// level.
+
+#define VALUE 42
+#define LOG3(...) log(__VA_ARGS__)
+#define LOG2(...) LOG3(__VA_ARGS__)
+#define LOG1(...) LOG2(__VA_ARGS__)
+#define LOG(fmt, ...) LOG1(fmt, __VA_ARGS__)
+
+// CHECK: log("%d %d", 42, 42 + 1);
+LOG("%d %d", VALUE, VALUE + 1);
+
+// A recursive macro stays unexpanded however deep it is forwarded.
+#define rec rec + 1
+// CHECK: log(rec + 1);
+LOG1(rec);
+
+// A function-like macro name without its '(' in the argument is still
+// expanded once the body supplies one.
+#define F(x) [x]
+#define CALL(f) f(1)
+#define FWD(f) CALL(f)
+// CHECK: [1] F
+FWD(F) F
+
+// A function-like macro named in its own expansion is never expanded again.
+#define G(x) FWD(G)
+// CHECK: G(1)
+G(0)
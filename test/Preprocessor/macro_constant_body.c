@@ -0,0 +1,21 @@
+// RUN: %clang_cc1 -E %s | FileCheck %s
+// RUN: %clang_cc1 -E -print-stats %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=STATS
+// RUN: %clang_cc1 -fsyntax-only -verify %s
+
+#define NULLPTR ((void *)0)
+#define INNER 42
+#define OUTER (INNER + 1)
+#define PASTE x ## y
+#define BIG (0 + 0x100000000)
+
+void *p = NULLPTR;
+// CHECK: void *p = ((void *)0);
+int OUTER_USE = OUTER;
+// CHECK: int OUTER_USE = (42 + 1);
+int PASTE = 0;
+// CHECK: int xy = 0;
+char c = BIG; // expected-warning {{changes value from 4294967296 to 0}}
+
+// NULLPTR, OUTER and BIG have constant bodies. INNER is a single token and
+// PASTE needs pasting, so neither is counted.
+// STATS: on the fast path, 3 with constant bodies.
@@ -0,0 +1,33 @@
+// RUN: %clang_cc1 -E -dM -minimize-source-to-dependency-directives -I %S/Inputs/minimize-source %s -dependency-file %t.d -MT out | FileCheck %s
+// RUN: FileCheck -check-prefix=DEPS %s < %t.d
+// RUN: %clang_cc1 -E -minimize-source-to-dependency-directives -I %S/Inputs/minimize-source %s -o - | FileCheck -check-prefix=CODE %s
+// RUN: %clang_cc1 -E -minimize-source-to-dependency-directives -I %S/Inputs/minimize-source %s -print-stats -o /dev/null 2>&1 | FileCheck -check-prefix=STATS %s
+
+#define HEADER "header.h"
+#include HEADER
+#define MULTI_LINE(x) \
+  ((x) + 1) /* a comment
+  in the middle */ + 2
+
+#if FROM_HEADER == 3
+#define CONDITION_SEEN 1
+#endif
+
+int f(void) {
+  const char *s = "# not a directive";
+  return '#' + g(1);
+}
+/* # not a directive either */
+
+// CHECK-DAG: #define CONDITION_SEEN 1
+// CHECK-DAG: #define FROM_HEADER 3
+// CHECK-DAG: #define MULTI_LINE(x) ((x) + 1) + 2
+
+// DEPS: out:
+// DEPS-SAME: minimize-source-to-dependency-directives.c
+// DEPS: header.h
+
+// CODE-NOT: int f
+// CODE-NOT: static inline int g
+
+// STATS: 2 source files minimized to their directives
@@ -0,0 +1,22 @@
+// RUN: %clang_cc1 -E %s | FileCheck -strict-whitespace %s
+
+// Tokens that were adjacent in the source are printed as they were; tokens
+// that only became adjacent through macro expansion are still kept apart.
+
+#define PLUS +
+#define EMPTY
+
+int f(int a, int b) {
+  return a++-b+PLUS+b--+-a;
+// CHECK: return a++-b+ + +b--+-a;
+}
+
+int g(int *p) {
+  return p[0]-EMPTY-p[1];
+// CHECK: return p[0]- -p[1];
+}
+
+int h(int a) {
+  return a/**/-/**/-a;
+// CHECK: return a - -a;
+}
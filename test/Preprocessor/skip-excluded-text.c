@@ -0,0 +1,53 @@
+// RUN: %clang_cc1 -E %s | FileCheck %s
+// RUN: %clang_cc1 -E -x c++ %s | FileCheck %s
+
+// Excluded blocks are skipped without lexing most of their text. Only a '#'
+// first on a line that is outside comments and literals starts a directive.
+
+#if 0
+const char *s1 = "/* not a comment";
+#endif
+// CHECK: skipped_string_with_comment_start
+skipped_string_with_comment_start
+
+#if 0
+/* A comment in an excluded block.
+#endif
+*/ int a; /* another
+#endif
+*/
+#endif
+// CHECK: skipped_comments
+skipped_comments
+
+#if 0
+const char *s2 = "spliced \
+#endif";
+const char c1 = '"', c2 = '\'', c3 = '\\';
+const char *s3 = "C:\\dir\\";
+// A spliced line comment \
+#endif
+#define MULTI_LINE(x) \
+  x \
+  #endif
+#endif
+// CHECK: skipped_splices
+skipped_splices
+
+#if 0
+const char *s4 = "unterminated
+#else
+// CHECK: else_after_unterminated_string
+else_after_unterminated_string
+#endif
+
+#if 0
+  /* leading */ # endif
+// CHECK: after_endif_behind_comment
+after_endif_behind_comment
+
+#if 0
+%: else
+// CHECK: after_digraph_else
+after_digraph_else
+%: endif
@@ -0,0 +1,23 @@
+// RUN: %clang_cc1 -E -std=c++14 %s | FileCheck %s
+
+// Raw string literals and digit separators in excluded blocks are lexed, so
+// that neither a '#' in a raw string nor a quote in a number is mistaken.
+
+#if 0
+const char *raw1 = R"(
+#endif
+)";
+const char *raw2 = u8R"delim(
+#endif )" /*
+)delim";
+#endif
+// CHECK: skipped_raw_strings
+skipped_raw_strings
+
+#if 0
+int digits = 1'000; /* excluded
+#endif
+*/
+#endif
+// CHECK: skipped_digit_separators
+skipped_digit_separators
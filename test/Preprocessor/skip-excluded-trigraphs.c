@@ -0,0 +1,13 @@
+// RUN: %clang_cc1 -E -trigraphs %s | FileCheck %s
+
+#if 0
+// A line comment spliced by a trigraph ??/
+#endif
+#endif
+// CHECK: skipped_trigraph_splice
+skipped_trigraph_splice
+
+#if 0
+??=endif
+// CHECK: after_trigraph_endif
+after_trigraph_endif
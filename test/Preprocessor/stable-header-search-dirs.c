@@ -0,0 +1,13 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -print-stats -fassume-stable-header-search-dirs -I %S/Inputs/stable-search-dirs/a -I %S/Inputs/stable-search-dirs/b %s 2>&1 | FileCheck %s
+// RUN: %clang_cc1 -fsyntax-only -verify -print-stats -I %S/Inputs/stable-search-dirs/a -I %S/Inputs/stable-search-dirs/b %s 2>&1 | FileCheck %s --check-prefix=NO-INDEX
+// expected-no-diagnostics
+
+#include "a.h"
+#include "sub/b.h"
+
+#if !A_H || !B_H
+#error headers not found
+#endif
+
+// CHECK: 1 directory probes skipped using the directory index.
+// NO-INDEX: 0 directory probes skipped using the directory index.
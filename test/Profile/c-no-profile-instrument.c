@@ -0,0 +1,25 @@
+// Test that no_profile_instrument_function keeps a function uninstrumented.
+
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -main-file-name c-no-profile-instrument.c %s -o - -emit-llvm -fprofile-instrument=clang | FileCheck %s
+// RUN: %clang_cc1 -triple x86_64-apple-macosx10.9 -fsyntax-only -verify -DCHECK_DIAGS %s
+
+// CHECK-NOT: @__profc_skipped
+// CHECK: @__profc_counted = private global [2 x i64]
+
+#ifdef CHECK_DIAGS
+int var __attribute__((no_profile_instrument_function)); // expected-error {{'no_profile_instrument_function' attribute only applies to functions}}
+#endif
+
+// CHECK-LABEL: define i32 @skipped
+// CHECK-NOT: __profc_
+// CHECK: ret
+__attribute__((no_profile_instrument_function))
+int skipped(int x) {
+  return x ? 1 : 2;
+}
+
+// CHECK-LABEL: define i32 @counted
+// CHECK: @__profc_counted
+int counted(int x) {
+  return x ? 1 : 2;
+}
@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -Wuninitialized -Wunreachable-code -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: 2 functions analyzed (0 w/o CFGs).
+// CHECK: Time spent in analysis-based warnings:
+// CHECK-NEXT: {{[0-9.]+}}s CFG construction.
+// CHECK-NEXT: {{[0-9.]+}}s Possibly unreachable diagnostics.
+// CHECK-NEXT: {{[0-9.]+}}s Return fall-through.
+// CHECK-NEXT: {{[0-9.]+}}s Unreachable code.
+// CHECK-NEXT: {{[0-9.]+}}s Thread safety.
+// CHECK-NEXT: {{[0-9.]+}}s Consumed.
+// CHECK-NEXT: {{[0-9.]+}}s Uninitialized variables.
+// CHECK-NEXT: {{[0-9.]+}}s Switch fall-through.
+// CHECK-NEXT: {{[0-9.]+}}s Infinite recursion.
+
+int f(int x) {
+  int y;
+  if (x)
+    y = 1;
+  return y;
+}
+
+void g(void) {
+  return;
+  f(0);
+}
@@ -0,0 +1,25 @@
+// RUN: %clang_cc1 -fsyntax-only -Wuninitialized -fanalysis-cfg-block-limit 8 -Ranalysis-cfg-block-limit -verify %s
+// RUN: %clang -### -fanalysis-cfg-block-limit=8 -c %s 2>&1 | FileCheck -check-prefix=DRIVER %s
+// DRIVER: "-fanalysis-cfg-block-limit" "8"
+
+void f(int);
+
+int small(void) {
+  int y; // expected-note {{initialize the variable 'y' to silence this warning}}
+  return y; // expected-warning {{variable 'y' is uninitialized when used here}}
+}
+
+int large(int x) { // expected-remark {{analysis-based warnings skipped: the CFG of this function has more than 8 blocks}}
+  int y;
+  if (x == 1)
+    f(1);
+  else if (x == 2)
+    f(2);
+  else if (x == 3)
+    f(3);
+  else if (x == 4)
+    f(4);
+  else if (x == 5)
+    f(5);
+  return y;
+}
@@ -0,0 +1,20 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -Wformat-nonliteral %s
+
+// Each distinct format string is parsed once; check that the arguments of
+// every use of a repeated string are still checked, and that the problems
+// with the string itself are still reported at every use.
+
+int printf(const char *restrict, ...);
+
+#define LOG(fmt, ...) printf(fmt, __VA_ARGS__)
+
+void test(int i, double d, const char *s) {
+  LOG("%d: %s\n", i, s);
+  LOG("%d: %s\n", d, s); // expected-warning{{format specifies type 'int' but the argument has type 'double'}}
+  LOG("%d: %s\n", i, i); // expected-warning{{format specifies type 'char *' but the argument has type 'int'}}
+  LOG("%d: %s\n", i, s);
+  LOG("%d: %s\n", i); // expected-warning{{more '%' conversions than data arguments}}
+
+  printf("%d %y\n", i, i); // expected-warning{{invalid conversion specifier 'y'}}
+  printf("%d %y\n", i, i); // expected-warning{{invalid conversion specifier 'y'}}
+}
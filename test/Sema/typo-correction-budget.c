@@ -0,0 +1,12 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -fspell-checking-budget 1 %s
+
+int counter; // expected-note {{'counter' declared here}}
+
+int f(void) {
+  return countr; // expected-error {{use of undeclared identifier 'countr'; did you mean 'counter'?}}
+}
+
+// The first typo used up the budget.
+int g(void) {
+  return countre; // expected-error-re {{use of undeclared identifier 'countre'{{$}}}}
+}
@@ -0,0 +1,52 @@
+// RUN: %clang_cc1 -std=c++1y -fsyntax-only -verify %s -fconstexpr-steps 10000 -fconstexpr-memoize-calls
+// RUN: not %clang_cc1 -std=c++1y -fsyntax-only %s -fconstexpr-steps 10000 2>&1 | FileCheck %s
+// CHECK: error: static_assert expression is not an integral constant expression
+// CHECK: note: constexpr evaluation hit maximum step limit
+
+// Identical calls with scalar arguments are evaluated once, so these stay
+// far below the step limit even though the naive recursion is exponential.
+constexpr unsigned long long fib(int n) {
+  return n < 2 ? n : fib(n - 1) + fib(n - 2);
+}
+static_assert(fib(90) == 2880067194370816120ULL, "");
+
+constexpr double sum(double x, int n) {
+  return n == 0 ? x : sum(x, n - 1) + sum(x, n - 1);
+}
+static_assert(sum(0.5, 60) == 0.5 * (1ULL << 60), "");
+
+// Aggregates passed and returned by value are keyed on their contents.
+struct Pair { unsigned long long a, b; };
+constexpr Pair step(Pair p, int n) {
+  return n == 0 ? p
+                : Pair{step(p, n - 1).b,
+                       step(p, n - 1).a + step(p, n - 1).b};
+}
+static_assert(step(Pair{0, 1}, 90).a == 2880067194370816120ULL, "");
+static_assert(step(Pair{1, 1}, 3).a == 3, "");
+
+// An aggregate holding a pointer refers to an object, so it is not a key.
+struct Ref { const int *p; };
+constexpr int read(Ref r) { return *r.p; }
+constexpr int reads() {
+  int a = 1;
+  int x = read(Ref{&a});
+  a = 2;
+  return x + read(Ref{&a});
+}
+static_assert(reads() == 3, "");
+
+// Calls through references are not memoized: they can observe state that
+// changes between otherwise identical calls.
+constexpr int next(int &counter) { return ++counter; }
+constexpr int count() {
+  int counter = 0;
+  next(counter);
+  next(counter);
+  return next(counter);
+}
+static_assert(count() == 3, "");
+
+// A call that is not a constant expression is still diagnosed every time.
+constexpr int overflow(int n) { return n + __INT_MAX__; } // expected-note {{value 2147483648 is outside the range}}
+constexpr int twice = overflow(0) + overflow(1); // expected-error {{must be initialized by a constant expression}} expected-note {{in call to 'overflow(1)'}}
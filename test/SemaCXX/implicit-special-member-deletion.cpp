@@ -0,0 +1,68 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify -include %s %s
+// RUN: %clang_cc1 -std=c++11 -x c++-header -emit-pch -o %t %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify -include-pch %t %s
+// RUN: %clang_cc1 -std=c++11 -ast-dump %s | FileCheck %s
+
+// Implicit special members whose deletion is known from the class definition
+// alone, and ones that still need overload resolution on their subobjects.
+
+#ifndef HEADER
+#define HEADER
+
+struct RValueRef {
+  int &&r; // expected-note {{because field 'r' is of rvalue reference type 'int &&'}}
+};
+
+struct NonTrivialCopy {
+  NonTrivialCopy(const NonTrivialCopy &);
+};
+union U {
+  NonTrivialCopy n; // expected-note {{because variant field 'n' has a non-trivial copy constructor}}
+};
+struct AnonUnion {
+  union {
+    NonTrivialCopy n; // expected-note {{because variant field 'n' has a non-trivial copy constructor}}
+  };
+};
+
+// The deleted copy constructor is still declared lazily.
+// CHECK-LABEL: CXXRecordDecl {{.*}} struct MoveOnly definition
+// CHECK-NOT: CXXConstructorDecl {{.*}} implicit {{.*}}MoveOnly 'void (const
+// CHECK: CXXRecordDecl {{.*}} struct HasMoveOnly definition
+struct MoveOnly {
+  MoveOnly(MoveOnly &&);
+};
+struct HasMoveOnly {
+  MoveOnly m; // expected-note {{because field 'm' has a deleted copy constructor}}
+};
+
+struct PrivateDtor {
+private:
+  ~PrivateDtor();
+};
+struct HasPrivateDtor {
+  PrivateDtor p; // expected-note {{because field 'p' has an inaccessible destructor}}
+};
+
+struct Simple {
+  int n;
+  RValueRef *p;
+};
+struct Derived : Simple {
+  Simple s;
+};
+
+#else
+
+void test(RValueRef &r, U &u, AnonUnion &a, HasMoveOnly &h, Derived &d) {
+  RValueRef r2(r); // expected-error {{call to implicitly-deleted copy constructor}}
+  U u2(u); // expected-error {{call to implicitly-deleted copy constructor}}
+  AnonUnion a2(a); // expected-error {{call to implicitly-deleted copy constructor}}
+  HasMoveOnly h2(h); // expected-error {{call to implicitly-deleted copy constructor}}
+  HasPrivateDtor hp; // expected-error {{deleted function}}
+  Derived d2(d);
+  Derived d3(static_cast<Derived &&>(d));
+  d2 = static_cast<Derived &&>(d3);
+}
+
+#endif
@@ -0,0 +1,33 @@
+// RUN: %clang_cc1 -fsyntax-only -verify -std=c++11 %s
+
+// Candidates sharing parameter types reuse the conversion sequences computed
+// for each other; make sure that doesn't change the outcome.
+
+struct Stream {};
+struct Wrapper { operator int() const; };
+struct Both { operator int() const; operator double() const; };
+struct Explicit { explicit Explicit(int); };
+
+int &put(Stream &, int); // expected-note {{candidate function}}
+float &put(Stream &, double); // expected-note {{candidate function}}
+char &put(Stream &, const char *);
+void put(Stream &, Explicit);
+void put(Stream &, Wrapper &);
+
+void test(Stream &S, Wrapper W, const Wrapper CW, Both B) {
+  int &I = put(S, 1);
+  float &F = put(S, 1.0);
+  char &C = put(S, "x");
+  int &UserDefined = put(S, CW);
+  put(S, W);
+
+  put(S, B); // expected-error {{call to 'put' is ambiguous}}
+}
+
+int &put2(const Stream &, int);
+float &put2(Stream &, int);
+
+void test2(Stream &S, const Stream &CS) {
+  float &F = put2(S, 0);
+  int &I = put2(CS, 0);
+}
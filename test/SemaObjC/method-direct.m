@@ -0,0 +1,65 @@
+// RUN: %clang_cc1 -fsyntax-only -Wno-objc-method-access -verify %s
+
+__attribute__((objc_root_class))
+@interface Root
+- (void)rootDirect __attribute__((objc_direct)); // expected-note {{previous declaration is here}}
+- (void)rootDynamic; // expected-note {{previous declaration is here}}
+- (void)implDirect; // expected-note {{previous declaration is here}}
+- (void)inheritsDirect __attribute__((objc_direct));
++ (void)classDirect __attribute__((objc_direct)); // expected-note {{method 'classDirect' declared here}}
+@end
+
+@protocol P
+- (void)protoMethod; // expected-note {{previous declaration is here}}
+- (void)protoDirect __attribute__((objc_direct)); // expected-error {{'objc_direct' attribute cannot be applied to methods declared in a protocol}}
+@end
+
+int notAMethod __attribute__((objc_direct)); // expected-error {{'objc_direct' attribute only applies to methods}}
+
+@interface Sub : Root <P>
+- (void)rootDirect; // expected-error {{cannot override a method that is declared direct}}
+- (void)rootDynamic __attribute__((objc_direct)); // expected-error {{direct method 'rootDynamic' cannot override a method that is not direct}}
+- (void)protoMethod __attribute__((objc_direct)); // expected-error {{direct method 'protoMethod' cannot implement a method declared in a protocol}}
+@end
+
+@implementation Root
+- (void)rootDirect {}
+- (void)rootDynamic {}
+- (void)implDirect __attribute__((objc_direct)) {} // expected-error {{direct method 'implDirect' is declared without the 'objc_direct' attribute}}
+- (void)inheritsDirect {}
++ (void)classDirect {}
+@end
+
+@interface Sub2 : Root
+@end
+
+@implementation Sub2
++ (void)useSuper {
+  [super classDirect]; // expected-error {{messaging super with a direct method}}
+}
+- (void)useSelf {
+  [self inheritsDirect];
+  [self rootDirect];
+}
+@end
+
+__attribute__((objc_root_class))
+@interface Other
+- (void)otherDirect __attribute__((objc_direct)); // expected-note 2 {{method 'otherDirect' declared here}}
++ (void)otherClassDirect __attribute__((objc_direct)); // expected-note 2 {{method 'otherClassDirect' declared here}}
+@end
+
+@implementation Other
+- (void)otherDirect {}
++ (void)otherClassDirect {
+  [self otherClassDirect]; // expected-error {{direct method 'otherClassDirect' cannot be messaged through a receiver of type 'Class'}}
+}
+@end
+
+void useDirect(id obj, Class cls, Other *other, Root *root) {
+  [other otherDirect];
+  [Other otherClassDirect];
+  [obj otherDirect]; // expected-error {{direct method 'otherDirect' cannot be messaged through a receiver of type 'id'}}
+  [root otherDirect]; // expected-error {{direct method 'otherDirect' cannot be messaged through a receiver of type 'Root *'}}
+  [cls otherClassDirect]; // expected-error {{direct method 'otherClassDirect' cannot be messaged through a receiver of type 'Class'}}
+}
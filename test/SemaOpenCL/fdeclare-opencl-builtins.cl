@@ -0,0 +1,68 @@
+// RUN: %clang_cc1 %s -triple spir-unknown-unknown -verify -fsyntax-only -finclude-default-header -fdeclare-opencl-builtins
+// RUN: %clang_cc1 %s -triple spir-unknown-unknown -verify -fsyntax-only -finclude-default-header -fdeclare-opencl-builtins -cl-std=CL1.2 -DCL12
+// RUN: %clang_cc1 %s -triple spir-unknown-unknown -verify -fsyntax-only -finclude-default-header -fdeclare-opencl-builtins -cl-std=CL2.0 -DCL12
+// expected-no-diagnostics
+
+// The types and macros of opencl-c.h are available, and builtin functions are
+// declared when they are first used.
+
+kernel void test_builtins(global float4 *f, global int2 *i, global uint *u) {
+  size_t gid = get_global_id(0);
+  barrier(CLK_LOCAL_MEM_FENCE);
+
+  float4 v = f[gid];
+  f[gid] = sqrt(v) + fmax(v, 1.0f) + clamp(v, 0.0f, 1.0f);
+  float s = dot(v, v) + length(v.xyz) + fma(1.0f, 2.0f, 3.0f);
+  f[0] = normalize(v) * s;
+  f[1] = mix(v, v, 0.5f) + step(0.5f, v) + smoothstep(0.0f, 1.0f, v);
+
+  int2 iv = i[gid];
+  uint2 au = abs(iv);
+  i[0] = max(iv, 0) + min(iv, iv) + clamp(iv, -1, 1) + add_sat(iv, iv);
+  u[0] = abs_diff(u[0], 1u) + au.x;
+
+#ifdef CL12
+  i[1] = popcount(iv);
+#endif
+}
+
+kernel void test_memory(global float *f, local float *l, global uint *u,
+                        global int *i) {
+  float4 v = vload4(0, f);
+  vstore4(v, 1, f);
+  vstore4(vload4(0, l), 0, l);
+  float2 h = vload_half2(0, (global half *)u);
+  vstore_half2_rte(h, 0, (global half *)u);
+  f[0] = NAN + as_float(u[0]) + v.x;
+  u[1] = as_uint(f[1]);
+  int4 iv = convert_int4_sat_rte(v);
+  uchar4 c = convert_uchar4(iv);
+  i[0] = any(iv < 0) + all(isnan(v)) + c.x;
+  f[2] = select(f[0], f[1], i[0]) + bitselect(f[0], f[1], f[2]);
+  uint4 mask = (uint4)(3, 2, 1, 0);
+  f[3] = shuffle(v, mask).x;
+  mem_fence(CLK_GLOBAL_MEM_FENCE);
+  barrier(CLK_GLOBAL_MEM_FENCE);
+#ifdef CL12
+  atomic_add(i, 1);
+  atomic_cmpxchg((volatile global uint *)u, 0u, 1u);
+  f[4] = atomic_xchg(f, 2.0f);
+#endif
+}
+
+kernel void test_images(read_only image2d_t in, write_only image2d_t out,
+                        sampler_t s) {
+  int2 coord = (int2)(get_global_id(0), get_global_id(1));
+  float4 pixel = read_imagef(in, s, coord);
+  write_imagef(out, coord, pixel + read_imagef(in, s, (float2)(0.5f, 0.5f)));
+  int2 dim = get_image_dim(in);
+  write_imagei(out, dim, (int4)(get_image_width(in), get_image_height(out),
+                                0, 0));
+}
+
+// A builtin can be redeclared.
+float sqrt(float) __attribute__((overloadable));
+
+kernel void test_redeclare(global float *f) {
+  f[0] = sqrt(f[0]) + sqrt(f[1]);
+}
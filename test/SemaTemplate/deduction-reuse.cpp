@@ -0,0 +1,34 @@
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -verify %s
+// RUN: %clang_cc1 -std=c++11 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: 2/5 deduced function template specializations reused.
+
+// expected-no-diagnostics
+
+template <typename T> T &&forward_like(T &&t) { return static_cast<T &&>(t); }
+
+template <typename T> struct is_int { static const bool value = false; };
+template <> struct is_int<int> { static const bool value = true; };
+
+template <bool B, typename T = void> struct enable_if {};
+template <typename T> struct enable_if<true, T> { typedef T type; };
+
+template <typename T>
+typename enable_if<is_int<T>::value, char>::type pick(T);
+template <typename T>
+typename enable_if<!is_int<T>::value, long>::type pick(T);
+
+template <typename T, typename U> struct same { static const bool value = false; };
+template <typename T> struct same<T, T> { static const bool value = true; };
+
+void test(int I, const int CI) {
+  // Lvalues and rvalues of the same type deduce different specializations.
+  static_assert(same<decltype(forward_like(I)), int &>::value, "");
+  static_assert(same<decltype(forward_like(I)), int &>::value, "");
+  static_assert(same<decltype(forward_like(0)), int &&>::value, "");
+  static_assert(same<decltype(forward_like(CI)), const int &>::value, "");
+
+  static_assert(same<decltype(pick(I)), char>::value, "");
+  static_assert(same<decltype(pick(I)), char>::value, "");
+  static_assert(same<decltype(pick(1.0)), long>::value, "");
+}
@@ -0,0 +1,10 @@
+// RUN: %clang_cc1 -std=c++14 -fsyntax-only -print-stats %s 2>&1 | FileCheck %s
+
+// CHECK: 3 pending function instantiations performed.
+// CHECK: 1 pending variable instantiations performed.
+// CHECK: 4 instantiations pending at once at most.
+
+template <typename T> T f() { return T(); }
+template <typename T> T v = T();
+
+int use() { return f<int>() + f<long>() + f<short>() + v<int>; }
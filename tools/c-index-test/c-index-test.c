@@ -19,7 +19,10 @@
 
 #ifdef _WIN32
 #  include <direct.h>
+#  include <windows.h>
 #else
+#  include <sys/resource.h>
+#  include <sys/time.h>
 #  include <unistd.h>
 #endif
 
@@ -82,6 +85,8 @@ static unsigned getDefaultParsingOptions() {
     options |= CXTranslationUnit_CreatePreambleOnFirstParse;
   if (getenv("CINDEXTEST_KEEP_GOING"))
     options |= CXTranslationUnit_KeepGoing;
+  if (getenv("CINDEXTEST_CHAINED_PREAMBLE"))
+    options |= CXTranslationUnit_ChainedPreamble;
 
   return options;
 }
@@ -121,7 +126,11 @@ static void PrintExtent(FILE *out, unsigned begin_line, unsigned begin_column,
 
 static unsigned CreateTranslationUnit(CXIndex Idx, const char *file,
                                       CXTranslationUnit *TU) {
-  enum CXErrorCode Err = clang_createTranslationUnit2(Idx, file, TU);
+  unsigned options = CXLoadTranslationUnit_None;
+  enum CXErrorCode Err;
+  if (getenv("CINDEXTEST_SKIP_INPUT_VALIDATION"))
+    options |= CXLoadTranslationUnit_SkipInputValidation;
+  Err = clang_createTranslationUnitWithOptions(Idx, file, options, TU);
   if (Err != CXError_Success) {
     fprintf(stderr, "Unable to load translation unit from '%s'!\n", file);
     describeLibclangFailure(Err);
@@ -2167,6 +2176,8 @@ int perform_code_completion(int argc, const char **argv, int timing_only) {
     completionOptions |= CXCodeComplete_IncludeCodePatterns;
   if (getenv("CINDEXTEST_COMPLETION_BRIEF_COMMENTS"))
     completionOptions |= CXCodeComplete_IncludeBriefComments;
+  if (getenv("CINDEXTEST_COMPLETION_FILTER_TYPED_TEXT"))
+    completionOptions |= CXCodeComplete_FilterByTypedText;
   
   if (timing_only)
     input += strlen("-code-completion-timing=");
@@ -3300,6 +3311,10 @@ static unsigned getIndexOptions(void) {
     index_opts |= CXIndexOpt_IndexFunctionLocalSymbols;
   if (!getenv("CINDEXTEST_DISABLE_SKIPPARSEDBODIES"))
     index_opts |= CXIndexOpt_SkipParsedBodiesInSession;
+  if (getenv("CINDEXTEST_SKIP_HEADER_FUNCTION_BODIES"))
+    index_opts |= CXIndexOpt_SkipHeaderFunctionBodies;
+  if (getenv("CINDEXTEST_SKIP_INDEXED_HEADERS"))
+    index_opts |= CXIndexOpt_SkipIndexedHeadersInSession;
 
   return index_opts;
 }
@@ -3573,6 +3588,74 @@ static int index_compile_db(int argc, const char **argv) {
   return errorCode;
 }
 
+static int perform_test_visit_range(int argc, const char **argv) {
+  const char *input = argv[1];
+  char *filename = 0;
+  unsigned line, second_line;
+  unsigned column, second_column;
+  CXIndex CIdx;
+  CXTranslationUnit TU;
+  CXFile file;
+  CXSourceRange range;
+  VisitorData Data;
+  enum CXErrorCode Err;
+  int errorCode;
+  unsigned i;
+
+  input += strlen("-test-visit-range=");
+  if ((errorCode = parse_file_line_column(input, &filename, &line, &column,
+                                          &second_line, &second_column)))
+    return errorCode;
+
+  CIdx = clang_createIndex(0, 1);
+  Err = clang_parseTranslationUnit2(CIdx, 0, argv + 2, argc - 2, 0, 0,
+                                    getDefaultParsingOptions(), &TU);
+  if (Err != CXError_Success) {
+    fprintf(stderr, "unable to parse input\n");
+    describeLibclangFailure(Err);
+    clang_disposeIndex(CIdx);
+    free(filename);
+    return -1;
+  }
+
+  errorCode = 0;
+  if (getenv("CINDEXTEST_EDITING")) {
+    for (i = 0; i < 5; ++i) {
+      Err = clang_reparseTranslationUnit(TU, 0, 0,
+                                         clang_defaultReparseOptions(TU));
+      if (Err != CXError_Success) {
+        fprintf(stderr, "Unable to reparse translation unit!\n");
+        describeLibclangFailure(Err);
+        errorCode = -1;
+        goto teardown;
+      }
+    }
+  }
+
+  file = clang_getFile(TU, filename);
+  if (!file) {
+    fprintf(stderr, "file %s is not in this translation unit\n", filename);
+    errorCode = -1;
+    goto teardown;
+  }
+
+  range = clang_getRange(clang_getLocation(TU, file, line, column),
+                         clang_getLocation(TU, file, second_line,
+                                           second_column));
+  Data.TU = TU;
+  Data.Filter = 0;
+  Data.CommentSchemaFile = 0;
+  clang_visitChildrenInRange(clang_getTranslationUnitCursor(TU), range,
+                             FilteredPrintingVisitor, &Data);
+  PrintDiagnostics(TU);
+
+teardown:
+  clang_disposeTranslationUnit(TU);
+  clang_disposeIndex(CIdx);
+  free(filename);
+  return errorCode;
+}
+
 int perform_token_annotation(int argc, const char **argv) {
   const char *input = argv[1];
   char *filename = 0;
@@ -3816,6 +3899,266 @@ cdb_end:
   return errorCode;
 }
 
+/******************************************************************************/
+/* Performance measurement.                                                   */
+/******************************************************************************/
+
+/* The latencies of one kind of operation, and the memory in use after it. */
+typedef struct {
+  char *name;
+  double *samples_ms;
+  unsigned num_samples;
+  unsigned long tu_memory_bytes;
+  unsigned long peak_rss_bytes;
+} PerfOperation;
+
+static double perf_now_ms(void) {
+#ifdef _WIN32
+  LARGE_INTEGER count, frequency;
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&frequency);
+  return (double)count.QuadPart * 1000.0 / (double)frequency.QuadPart;
+#else
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec * 1000.0 + tv.tv_usec / 1000.0;
+#endif
+}
+
+/* Returns the peak resident set size of the process, or 0 if unknown. */
+static unsigned long perf_peak_rss_bytes(void) {
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage))
+    return 0;
+#ifdef __APPLE__
+  return (unsigned long)usage.ru_maxrss;
+#else
+  return (unsigned long)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+static unsigned long perf_tu_memory_bytes(CXTranslationUnit TU) {
+  unsigned long total = 0;
+  unsigned i;
+  CXTUResourceUsage usage = clang_getCXTUResourceUsage(TU);
+  for (i = 0; i != usage.numEntries; ++i)
+    total += usage.entries[i].amount;
+  clang_disposeCXTUResourceUsage(usage);
+  return total;
+}
+
+static void perf_init_operation(PerfOperation *op, const char *name,
+                                unsigned trials) {
+  op->name = strdup(name);
+  op->samples_ms = (double *)malloc(sizeof(double) * trials);
+  op->num_samples = 0;
+  op->tu_memory_bytes = 0;
+  op->peak_rss_bytes = 0;
+}
+
+static void perf_finish_operation(PerfOperation *op, CXTranslationUnit TU) {
+  op->tu_memory_bytes = perf_tu_memory_bytes(TU);
+  op->peak_rss_bytes = perf_peak_rss_bytes();
+}
+
+static int perf_compare_samples(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return x < y ? -1 : x > y;
+}
+
+/* Returns the nearest-rank percentile of sorted samples. */
+static double perf_percentile(const double *sorted, unsigned n,
+                              unsigned percent) {
+  unsigned rank = (percent * n + 99) / 100;
+  return sorted[rank ? rank - 1 : 0];
+}
+
+static void perf_print_json_string(const char *s) {
+  putchar('"');
+  for (; *s; ++s) {
+    if (*s == '"' || *s == '\\')
+      putchar('\\');
+    if ((unsigned char)*s < 0x20)
+      printf("\\u%04x", (unsigned char)*s);
+    else
+      putchar(*s);
+  }
+  putchar('"');
+}
+
+static void perf_print_operation(const PerfOperation *op, int last) {
+  double total = 0;
+  unsigned i;
+  qsort(op->samples_ms, op->num_samples, sizeof(double), perf_compare_samples);
+  for (i = 0; i != op->num_samples; ++i)
+    total += op->samples_ms[i];
+
+  printf("    {\"operation\": ");
+  perf_print_json_string(op->name);
+  printf(", \"samples\": %u", op->num_samples);
+  if (op->num_samples) {
+    printf(", \"mean_ms\": %.3f", total / op->num_samples);
+    printf(", \"min_ms\": %.3f", op->samples_ms[0]);
+    printf(", \"p50_ms\": %.3f",
+           perf_percentile(op->samples_ms, op->num_samples, 50));
+    printf(", \"p90_ms\": %.3f",
+           perf_percentile(op->samples_ms, op->num_samples, 90));
+    printf(", \"p99_ms\": %.3f",
+           perf_percentile(op->samples_ms, op->num_samples, 99));
+    printf(", \"max_ms\": %.3f", op->samples_ms[op->num_samples - 1]);
+  }
+  printf(", \"tu_memory_bytes\": %lu", op->tu_memory_bytes);
+  printf(", \"peak_rss_bytes\": %lu}%s\n", op->peak_rss_bytes,
+         last ? "" : ",");
+}
+
+/* Measures parsing, reparsing, code completion at each of the given sites and
+ * indexing of a translation unit, running each of them the given number of
+ * times, and prints the latencies and memory use as JSON.
+ *
+ *   c-index-test -test-perf=<trials> [-complete-at=<site>]*
+ *                [-remap-file=<remapping>]* <compiler arguments>
+ */
+static int perform_test_perf(int argc, const char **argv) {
+  const char *const complete_at = "-complete-at=";
+  unsigned trials = (unsigned)atoi(argv[1] + strlen("-test-perf="));
+  unsigned num_sites = 0, num_ops = 0;
+  unsigned parse_options, i, j;
+  int first_arg = 2, num_unsaved_files = 0, result = 0;
+  struct CXUnsavedFile *unsaved_files = 0;
+  PerfOperation *ops;
+  CXIndex Idx;
+  CXIndexAction IdxAction;
+  CXTranslationUnit TU = 0;
+  IndexerCallbacks IndexCB;
+  enum CXErrorCode Err;
+  double start;
+
+  if (trials == 0) {
+    fprintf(stderr, "-test-perf needs a positive number of trials\n");
+    return 1;
+  }
+
+  while (first_arg < argc &&
+         strncmp(argv[first_arg], complete_at, strlen(complete_at)) == 0) {
+    ++num_sites;
+    ++first_arg;
+  }
+
+  if (parse_remapped_files(argc, argv, first_arg, &unsaved_files,
+                           &num_unsaved_files))
+    return -1;
+  first_arg += num_unsaved_files;
+
+  /* Parse, reparse, each completion site and index. */
+  ops = (PerfOperation *)malloc(sizeof(PerfOperation) * (num_sites + 3));
+  perf_init_operation(&ops[num_ops++], "parse", trials);
+  perf_init_operation(&ops[num_ops++], "reparse", trials);
+  for (i = 0; i != num_sites; ++i) {
+    char *name = (char *)malloc(strlen(argv[2 + i]) + 16);
+    sprintf(name, "complete %s", argv[2 + i] + strlen(complete_at));
+    perf_init_operation(&ops[num_ops++], name, trials);
+    free(name);
+  }
+  perf_init_operation(&ops[num_ops++], "index", trials);
+
+  /* Parse as an IDE would. */
+  parse_options = getDefaultParsingOptions() |
+                  clang_defaultEditingTranslationUnitOptions();
+  Idx = clang_createIndex(/* excludeDeclsFromPCH */0,
+                          /* displayDiagnostics */0);
+  for (i = 0; i != trials; ++i) {
+    if (TU)
+      clang_disposeTranslationUnit(TU);
+    start = perf_now_ms();
+    Err = clang_parseTranslationUnit2(Idx, 0, argv + first_arg,
+                                      argc - first_arg, unsaved_files,
+                                      num_unsaved_files, parse_options, &TU);
+    ops[0].samples_ms[ops[0].num_samples++] = perf_now_ms() - start;
+    if (Err != CXError_Success) {
+      fprintf(stderr, "Unable to load translation unit!\n");
+      describeLibclangFailure(Err);
+      TU = 0;
+      result = 1;
+      goto cleanup;
+    }
+  }
+  perf_finish_operation(&ops[0], TU);
+
+  for (i = 0; i != trials; ++i) {
+    start = perf_now_ms();
+    Err = clang_reparseTranslationUnit(TU, num_unsaved_files, unsaved_files,
+                                       clang_defaultReparseOptions(TU));
+    ops[1].samples_ms[ops[1].num_samples++] = perf_now_ms() - start;
+    if (Err != CXError_Success) {
+      fprintf(stderr, "Unable to reparse translation unit!\n");
+      describeLibclangFailure(Err);
+      result = 1;
+      goto cleanup;
+    }
+  }
+  perf_finish_operation(&ops[1], TU);
+
+  for (j = 0; j != num_sites; ++j) {
+    PerfOperation *op = &ops[2 + j];
+    char *filename = 0;
+    unsigned line, column;
+    if ((result = parse_file_line_column(argv[2 + j] + strlen(complete_at),
+                                         &filename, &line, &column, 0, 0)))
+      goto cleanup;
+    for (i = 0; i != trials; ++i) {
+      CXCodeCompleteResults *results;
+      start = perf_now_ms();
+      results = clang_codeCompleteAt(TU, filename, line, column,
+                                     unsaved_files, num_unsaved_files,
+                                     clang_defaultCodeCompleteOptions());
+      op->samples_ms[op->num_samples++] = perf_now_ms() - start;
+      if (!results) {
+        fprintf(stderr, "Unable to perform code completion!\n");
+        free(filename);
+        result = 1;
+        goto cleanup;
+      }
+      clang_disposeCodeCompleteResults(results);
+    }
+    perf_finish_operation(op, TU);
+    free(filename);
+  }
+
+  memset(&IndexCB, 0, sizeof(IndexCB));
+  IdxAction = clang_IndexAction_create(Idx);
+  for (i = 0; i != trials; ++i) {
+    PerfOperation *op = &ops[num_ops - 1];
+    start = perf_now_ms();
+    clang_indexTranslationUnit(IdxAction, 0, &IndexCB, sizeof(IndexCB),
+                               CXIndexOpt_None, TU);
+    op->samples_ms[op->num_samples++] = perf_now_ms() - start;
+  }
+  clang_IndexAction_dispose(IdxAction);
+  perf_finish_operation(&ops[num_ops - 1], TU);
+
+  printf("{\n  \"trials\": %u,\n  \"operations\": [\n", trials);
+  for (i = 0; i != num_ops; ++i)
+    perf_print_operation(&ops[i], i + 1 == num_ops);
+  printf("  ]\n}\n");
+
+cleanup:
+  for (i = 0; i != num_ops; ++i) {
+    free(ops[i].name);
+    free(ops[i].samples_ms);
+  }
+  free(ops);
+  if (TU)
+    clang_disposeTranslationUnit(TU);
+  clang_disposeIndex(Idx);
+  free_remapped_files(unsaved_files, num_unsaved_files);
+  return result;
+}
+
 /******************************************************************************/
 /* USR printing.                                                              */
 /******************************************************************************/
@@ -4263,6 +4606,9 @@ static void print_usage(void) {
     "       c-index-test -test-load-source-usrs-memory-usage "
           "<symbol filter> {<args>}*\n"
     "       c-index-test -test-annotate-tokens=<range> {<args>}*\n"
+    "       c-index-test -test-visit-range=<range> {<args>}*\n"
+    "       c-index-test -test-perf=<trials> [-complete-at=<site>]* "
+          "{<args>}*\n"
     "       c-index-test -test-inclusion-stack-source {<args>}*\n"
     "       c-index-test -test-inclusion-stack-tu <AST file>\n");
   fprintf(stderr,
@@ -4353,6 +4699,10 @@ int cindextest_main(int argc, const char **argv) {
                              argc >= 5 ? argv[4] : 0);
   else if (argc > 2 && strstr(argv[1], "-test-annotate-tokens=") == argv[1])
     return perform_token_annotation(argc, argv);
+  else if (argc > 2 && strstr(argv[1], "-test-visit-range=") == argv[1])
+    return perform_test_visit_range(argc, argv);
+  else if (argc > 2 && strstr(argv[1], "-test-perf=") == argv[1])
+    return perform_test_perf(argc, argv);
   else if (argc > 2 && strcmp(argv[1], "-test-inclusion-stack-source") == 0)
     return perform_test_load_source(argc - 2, argv + 2, "all", NULL,
                                     PrintInclusionStack);
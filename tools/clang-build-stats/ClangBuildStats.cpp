@@ -0,0 +1,509 @@
+//===--- tools/clang-build-stats/ClangBuildStats.cpp - Build statistics ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements a tool that aggregates the machine-readable reports
+//  that the frontend writes for each translation unit over a whole build:
+//
+//    -ftime-trace             the time of each phase and each template
+//                             instantiation, and of each included file
+//    -fheader-cost-report=    the time and tokens of each included file
+//    -fmemory-report=         the memory of each allocator and AST node kind
+//
+//  The inputs are given as files or as directories, which are searched for
+//  reports recursively. The kind of each report is found from its contents.
+//  The tool prints one table per report kind, most expensive entries first,
+//  to help decide which headers to modularize or precompile and which
+//  templates to simplify.
+//
+//===----------------------------------------------------------------------===//
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/YAMLParser.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+using namespace llvm;
+
+static cl::OptionCategory BuildStatsCategory("clang-build-stats options");
+
+static cl::list<std::string>
+InputPaths(cl::Positional, cl::desc("<report or directory> ..."),
+           cl::OneOrMore, cl::cat(BuildStatsCategory));
+
+static cl::list<std::string>
+Reports("report",
+        cl::desc("Tables to print: phases, headers, templates, memory "
+                 "(default: all of them)"),
+        cl::CommaSeparated, cl::cat(BuildStatsCategory));
+
+static cl::opt<unsigned>
+Top("top", cl::desc("Number of entries to print per table (0: all)"),
+    cl::init(20), cl::cat(BuildStatsCategory));
+
+namespace {
+
+/// The cost of one entry of a table, summed over the build.
+struct Cost {
+  uint64_t Total = 0;
+  /// The largest cost in a single translation unit.
+  uint64_t Max = 0;
+  /// How many events, inclusions or nodes the cost is made of.
+  uint64_t Count = 0;
+  /// How many translation units the entry shows up in.
+  unsigned Inputs = 0;
+};
+
+/// Sums costs by name over the reports of one kind. The costs of a report
+/// are collected first and merged when the report is done, so that each
+/// entry knows its largest cost in one translation unit.
+class CostTable {
+  StringMap<Cost> Entries;
+  StringMap<Cost> Current;
+
+public:
+  /// The number of reports merged into the table.
+  unsigned NumInputs = 0;
+
+  void add(StringRef Name, uint64_t Value, uint64_t Count = 1) {
+    Cost &C = Current[Name];
+    C.Total += Value;
+    C.Count += Count;
+  }
+
+  void finishInput() {
+    for (auto &Entry : Current) {
+      Cost &C = Entries[Entry.getKey()];
+      C.Total += Entry.getValue().Total;
+      C.Max = std::max(C.Max, Entry.getValue().Total);
+      C.Count += Entry.getValue().Count;
+      ++C.Inputs;
+    }
+    Current.clear();
+    ++NumInputs;
+  }
+
+  /// Drops what was added since the last finishInput(), when the report it
+  /// came from turns out to be malformed.
+  void discardInput() { Current.clear(); }
+
+  bool empty() const { return Entries.empty(); }
+
+  const Cost *lookup(StringRef Name) const {
+    auto It = Entries.find(Name);
+    return It == Entries.end() ? nullptr : &It->getValue();
+  }
+
+  /// Returns the entries, most expensive first.
+  std::vector<const StringMapEntry<Cost> *> sorted() const {
+    std::vector<const StringMapEntry<Cost> *> Result;
+    for (const auto &Entry : Entries)
+      Result.push_back(&Entry);
+    std::sort(Result.begin(), Result.end(),
+              [](const StringMapEntry<Cost> *LHS,
+                 const StringMapEntry<Cost> *RHS) {
+                if (LHS->getValue().Total != RHS->getValue().Total)
+                  return LHS->getValue().Total > RHS->getValue().Total;
+                return LHS->getKey() < RHS->getKey();
+              });
+    return Result;
+  }
+};
+
+struct BuildStats {
+  /// -ftime-trace: the time of each event name, and of each instantiated
+  /// template and each included file, in microseconds.
+  CostTable Phases;
+  CostTable Templates;
+  CostTable TraceHeaders;
+
+  /// -fheader-cost-report: the time of each included file with and without
+  /// the files it includes, in microseconds.
+  CostTable HeaderTotal;
+  CostTable HeaderSelf;
+  /// The time of the main files, to which header times are compared.
+  uint64_t HeaderReportBuildTime = 0;
+
+  /// -fmemory-report: the bytes of each allocator and node kind.
+  CostTable Memory;
+  CostTable NodeKinds;
+
+  unsigned NumSkipped = 0;
+
+  void discardInput() {
+    for (CostTable *Table : {&Phases, &Templates, &TraceHeaders, &HeaderTotal,
+                             &HeaderSelf, &Memory, &NodeKinds})
+      Table->discardInput();
+  }
+};
+
+} // end anonymous namespace
+
+static bool getInteger(yaml::Node *N, uint64_t &Value) {
+  auto *Scalar = dyn_cast_or_null<yaml::ScalarNode>(N);
+  if (!Scalar)
+    return false;
+  // A plain scalar at the end of a JSON object keeps the line break that
+  // follows it.
+  SmallString<32> Storage;
+  return !Scalar->getValue(Storage).trim().getAsInteger(10, Value);
+}
+
+static StringRef getString(yaml::Node *N, SmallVectorImpl<char> &Storage) {
+  auto *Scalar = dyn_cast_or_null<yaml::ScalarNode>(N);
+  return Scalar ? Scalar->getValue(Storage) : StringRef();
+}
+
+/// Reads the complete events of a Chrome trace written by -ftime-trace.
+static void readTimeTrace(yaml::SequenceNode *Events, BuildStats &Stats) {
+  for (yaml::Node &Event : *Events) {
+    auto *Object = dyn_cast<yaml::MappingNode>(&Event);
+    if (!Object)
+      continue;
+    SmallString<64> PhaseStorage, NameStorage, DetailStorage;
+    StringRef Phase, Name, Detail;
+    uint64_t Duration = 0;
+    for (yaml::KeyValueNode &Field : *Object) {
+      SmallString<8> KeyStorage;
+      StringRef Key = getString(Field.getKey(), KeyStorage);
+      if (Key == "ph") {
+        Phase = getString(Field.getValue(), PhaseStorage);
+      } else if (Key == "name") {
+        Name = getString(Field.getValue(), NameStorage);
+      } else if (Key == "dur") {
+        getInteger(Field.getValue(), Duration);
+      } else if (Key == "args") {
+        auto *Args = dyn_cast_or_null<yaml::MappingNode>(Field.getValue());
+        if (!Args)
+          continue;
+        for (yaml::KeyValueNode &Arg : *Args) {
+          SmallString<8> ArgStorage;
+          if (getString(Arg.getKey(), ArgStorage) == "detail")
+            Detail = getString(Arg.getValue(), DetailStorage);
+          else
+            Arg.skip();
+        }
+      } else {
+        Field.skip();
+      }
+    }
+    if (Phase != "X" || Name.empty())
+      continue;
+
+    Stats.Phases.add(Name, Duration);
+    if (Name == "InstantiateClass" || Name == "InstantiateFunction")
+      Stats.Templates.add(Detail, Duration);
+    else if (Name == "Source")
+      Stats.TraceHeaders.add(Detail, Duration);
+  }
+}
+
+/// Adds the members of a "kind": { "count": N, "bytes": N } object.
+static void readNodeKinds(yaml::MappingNode *Kinds, CostTable &Table) {
+  for (yaml::KeyValueNode &Kind : *Kinds) {
+    SmallString<32> NameStorage;
+    StringRef Name = getString(Kind.getKey(), NameStorage);
+    auto *Usage = dyn_cast_or_null<yaml::MappingNode>(Kind.getValue());
+    if (!Usage)
+      continue;
+    uint64_t Count = 0, Bytes = 0;
+    for (yaml::KeyValueNode &Field : *Usage) {
+      SmallString<8> KeyStorage;
+      StringRef Key = getString(Field.getKey(), KeyStorage);
+      if (Key == "count")
+        getInteger(Field.getValue(), Count);
+      else if (Key == "bytes")
+        getInteger(Field.getValue(), Bytes);
+      else
+        Field.skip();
+    }
+    Table.add(Name, Bytes, Count);
+  }
+}
+
+/// Reads one member of a report written by -fmemory-report.
+static void readMemoryReportMember(StringRef Key, yaml::KeyValueNode &Member,
+                                   BuildStats &Stats) {
+  auto *Object = dyn_cast_or_null<yaml::MappingNode>(Member.getValue());
+  if (Key == "totals" && Object) {
+    for (yaml::KeyValueNode &Total : *Object) {
+      SmallString<32> NameStorage;
+      StringRef Name = getString(Total.getKey(), NameStorage);
+      uint64_t Bytes;
+      // "identifiers" is a count, not a size.
+      if (Name.endswith("_bytes") && getInteger(Total.getValue(), Bytes))
+        Stats.Memory.add(Name, Bytes);
+    }
+  } else if ((Key == "decl_kinds" || Key == "stmt_kinds") && Object) {
+    readNodeKinds(Object, Stats.NodeKinds);
+  } else {
+    Member.skip();
+  }
+}
+
+/// Reads the tab-separated lines written by -fheader-cost-report. The main
+/// file encloses every other file, so it is the one with the largest total.
+static bool readHeaderCostReport(StringRef Report, BuildStats &Stats) {
+  struct Line {
+    uint64_t SelfUs, TotalUs, Includes;
+    StringRef File;
+  };
+  SmallVector<StringRef, 8> Lines;
+  Report.split(Lines, '\n', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  std::vector<Line> Files;
+  for (StringRef Text : Lines) {
+    if (Text.startswith("#"))
+      continue;
+    SmallVector<StringRef, 8> Columns;
+    Text.split(Columns, '\t', /*MaxSplit=*/6);
+    Line L;
+    if (Columns.size() != 7 || Columns[0].getAsInteger(10, L.SelfUs) ||
+        Columns[1].getAsInteger(10, L.TotalUs) ||
+        Columns[4].getAsInteger(10, L.Includes))
+      return false;
+    L.File = Columns[6];
+    Files.push_back(L);
+  }
+
+  auto Main = std::max_element(Files.begin(), Files.end(),
+                               [](const Line &LHS, const Line &RHS) {
+                                 return LHS.TotalUs < RHS.TotalUs;
+                               });
+  for (auto I = Files.begin(), E = Files.end(); I != E; ++I) {
+    if (I == Main) {
+      Stats.HeaderReportBuildTime += I->TotalUs;
+      continue;
+    }
+    // Skip <built-in>, <command line> and other buffers that are not files.
+    if (I->File.startswith("<"))
+      continue;
+    Stats.HeaderTotal.add(I->File, I->TotalUs, I->Includes);
+    Stats.HeaderSelf.add(I->File, I->SelfUs, I->Includes);
+  }
+  Stats.HeaderTotal.finishInput();
+  Stats.HeaderSelf.finishInput();
+  return true;
+}
+
+/// Reads one report of any kind. Returns false if it is not a report.
+static bool readReportContents(StringRef Path, BuildStats &Stats) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> Buffer = MemoryBuffer::getFile(Path);
+  if (!Buffer) {
+    errs() << "error: cannot read '" << Path
+           << "': " << Buffer.getError().message() << '\n';
+    return false;
+  }
+  StringRef Contents = (*Buffer)->getBuffer().ltrim();
+  if (Contents.startswith("# self-us\t"))
+    return readHeaderCostReport(Contents, Stats);
+  if (!Contents.startswith("{"))
+    return false;
+
+  SourceMgr SM;
+  yaml::Stream Stream(Contents, SM);
+  yaml::document_iterator Document = Stream.begin();
+  if (Document == Stream.end())
+    return false;
+  auto *Root = dyn_cast_or_null<yaml::MappingNode>(Document->getRoot());
+  if (!Root)
+    return false;
+
+  // The two kinds of JSON report are told apart by their first member.
+  enum { Unknown, TimeTrace, MemoryReport } Kind = Unknown;
+  for (yaml::KeyValueNode &Member : *Root) {
+    SmallString<16> KeyStorage;
+    StringRef Key = getString(Member.getKey(), KeyStorage);
+    if (Kind == Unknown) {
+      if (Key == "traceEvents")
+        Kind = TimeTrace;
+      else if (Key == "main_file" || Key == "totals")
+        Kind = MemoryReport;
+      else
+        return false;
+    }
+
+    if (Kind == MemoryReport) {
+      readMemoryReportMember(Key, Member, Stats);
+    } else if (Key == "traceEvents") {
+      if (auto *Events =
+              dyn_cast_or_null<yaml::SequenceNode>(Member.getValue()))
+        readTimeTrace(Events, Stats);
+    } else {
+      Member.skip();
+    }
+  }
+
+  // A report that is cut short still counts, but a malformed one does not.
+  if (Stream.failed())
+    return false;
+  switch (Kind) {
+  case Unknown:
+    return false;
+  case TimeTrace:
+    Stats.Phases.finishInput();
+    Stats.Templates.finishInput();
+    Stats.TraceHeaders.finishInput();
+    return true;
+  case MemoryReport:
+    Stats.Memory.finishInput();
+    Stats.NodeKinds.finishInput();
+    return true;
+  }
+  llvm_unreachable("unknown report kind");
+}
+
+/// Reads one report of any kind. Returns false, and keeps nothing of it, if it
+/// is not a report.
+static bool readReport(StringRef Path, BuildStats &Stats) {
+  if (readReportContents(Path, Stats))
+    return true;
+  Stats.discardInput();
+  return false;
+}
+
+static void readInput(StringRef Path, BuildStats &Stats) {
+  if (!sys::fs::is_directory(Path)) {
+    if (!readReport(Path, Stats))
+      errs() << "warning: '" << Path << "' is not a build report\n";
+    return;
+  }
+
+  // Reports found in directories are read in a stable order, and files that
+  // are not reports, such as objects and dependency files, are skipped.
+  std::vector<std::string> Files;
+  std::error_code EC;
+  for (sys::fs::recursive_directory_iterator I(Path, EC), E; I != E && !EC;
+       I.increment(EC)) {
+    StringRef Name = I->path();
+    if (Name.endswith(".json") || Name.endswith(".txt") ||
+        Name.endswith(".tsv"))
+      Files.push_back(Name.str());
+  }
+  if (EC)
+    errs() << "warning: cannot search '" << Path << "': " << EC.message()
+           << '\n';
+  std::sort(Files.begin(), Files.end());
+  for (const std::string &File : Files)
+    if (!readReport(File, Stats))
+      ++Stats.NumSkipped;
+}
+
+static bool shouldPrint(StringRef Table) {
+  return Reports.empty() ||
+         std::find(Reports.begin(), Reports.end(), Table) != Reports.end();
+}
+
+/// Prints the most expensive entries of \p Table. Times are given in
+/// microseconds and printed in milliseconds. If \p BuildTotal is not zero,
+/// each entry is also shown as a share of it. If \p Self is given, its cost
+/// of each entry is printed too.
+static void printTable(raw_ostream &OS, StringRef Title, const CostTable &Table,
+                       bool IsTime, StringRef CountName,
+                       uint64_t BuildTotal = 0,
+                       const CostTable *Self = nullptr) {
+  OS << "===-- " << Title << " (" << Table.NumInputs
+     << " translation units) --===\n";
+  std::string Unit = IsTime ? "-ms" : "-KiB";
+  auto Value = [&](double V) { return IsTime ? V / 1000.0 : V / 1024.0; };
+
+  OS << right_justify("total" + Unit, 16);
+  if (BuildTotal)
+    OS << right_justify("build", 7);
+  if (Self)
+    OS << right_justify("self" + Unit, 16);
+  OS << right_justify("mean" + Unit, 14) << right_justify("max" + Unit, 14)
+     << right_justify(CountName, 10) << right_justify("TUs", 7) << "  name\n";
+
+  std::vector<const StringMapEntry<Cost> *> Entries = Table.sorted();
+  if (Top && Entries.size() > Top)
+    Entries.resize(Top);
+  for (const StringMapEntry<Cost> *Entry : Entries) {
+    const Cost &C = Entry->getValue();
+    OS << format("%16.1f", Value(C.Total));
+    if (BuildTotal)
+      OS << format("%6.1f%%", C.Total * 100.0 / BuildTotal);
+    if (Self) {
+      const Cost *S = Self->lookup(Entry->getKey());
+      OS << format("%16.1f", Value(S ? S->Total : 0));
+    }
+    OS << format("%14.1f%14.1f", Value(double(C.Total) / C.Inputs), Value(C.Max))
+       << format("%10llu%7u  ", (unsigned long long)C.Count, C.Inputs)
+       << Entry->getKey() << '\n';
+  }
+  OS << '\n';
+}
+
+static void printStats(raw_ostream &OS, const BuildStats &Stats) {
+  // Every trace has one ExecuteCompiler event that covers the whole job.
+  uint64_t TraceBuildTime = 0;
+  if (const Cost *C = Stats.Phases.lookup("ExecuteCompiler"))
+    TraceBuildTime = C->Total;
+
+  if (shouldPrint("phases") && !Stats.Phases.empty())
+    printTable(OS, "Phases", Stats.Phases, /*IsTime=*/true, "events",
+               TraceBuildTime);
+
+  // Header cost reports measure every file, but traces only keep the files
+  // that took longer than -ftime-trace-granularity.
+  if (shouldPrint("headers")) {
+    if (!Stats.HeaderTotal.empty())
+      printTable(OS, "Headers", Stats.HeaderTotal, /*IsTime=*/true,
+                 "includes", Stats.HeaderReportBuildTime, &Stats.HeaderSelf);
+    else if (!Stats.TraceHeaders.empty())
+      printTable(OS, "Headers", Stats.TraceHeaders, /*IsTime=*/true,
+                 "includes", TraceBuildTime);
+  }
+
+  if (shouldPrint("templates") && !Stats.Templates.empty())
+    printTable(OS, "Template instantiations", Stats.Templates,
+               /*IsTime=*/true, "count", TraceBuildTime);
+
+  if (shouldPrint("memory")) {
+    if (!Stats.Memory.empty())
+      printTable(OS, "Memory", Stats.Memory, /*IsTime=*/false, "reports");
+    if (!Stats.NodeKinds.empty())
+      printTable(OS, "AST nodes", Stats.NodeKinds, /*IsTime=*/false, "nodes");
+  }
+}
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  cl::HideUnrelatedOptions(BuildStatsCategory);
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "Aggregates -ftime-trace, -fheader-cost-report and -fmemory-report\n"
+      "output over a build and prints the most expensive phases, headers,\n"
+      "template instantiations and allocators.\n");
+
+  for (const std::string &Table : Reports) {
+    if (Table != "phases" && Table != "headers" && Table != "templates" &&
+        Table != "memory") {
+      errs() << "error: unknown report '" << Table << "'\n";
+      return 1;
+    }
+  }
+
+  BuildStats Stats;
+  for (const std::string &Path : InputPaths)
+    readInput(Path, Stats);
+  if (Stats.NumSkipped)
+    errs() << "note: skipped " << Stats.NumSkipped
+           << " files that are not build reports\n";
+
+  printStats(outs(), Stats);
+  return 0;
+}
@@ -20,11 +20,18 @@
 #include "clang/Basic/Version.h"
 #include "clang/Format/Format.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringMap.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include <atomic>
+#include <iostream>
+#include <thread>
 
 using namespace llvm;
 using clang::tooling::Replacements;
@@ -58,7 +65,9 @@ LineRanges("lines", cl::desc("<start line>:<end line> - format a range of\n"
                              "Multiple ranges can be formatted by specifying\n"
                              "several -lines arguments.\n"
                              "Can't be used with -offset and -length.\n"
-                             "Can only be used with one input file."),
+                             "A range prefixed with a file name only applies\n"
+                             "to that input file:\n"
+                             "<file>:<start line>:<end line>."),
            cl::cat(ClangFormatCategory));
 static cl::opt<std::string>
     Style("style",
@@ -84,6 +93,18 @@ static cl::opt<bool> Inplace("i",
                              cl::desc("Inplace edit <file>s, if specified."),
                              cl::cat(ClangFormatCategory));
 
+static cl::opt<std::string>
+    OutputDir("output-dir",
+              cl::desc("Write the formatted <file>s to this directory, at\n"
+                       "their paths relative to it, instead of to the\n"
+                       "standard output."),
+              cl::cat(ClangFormatCategory));
+
+static cl::opt<unsigned>
+    NumThreads("j", cl::desc("Number of files to format concurrently\n"
+                             "(default: number of hardware threads)."),
+               cl::init(0), cl::cat(ClangFormatCategory));
+
 static cl::opt<bool> OutputXML("output-replacements-xml",
                                cl::desc("Output replacements as XML."),
                                cl::cat(ClangFormatCategory));
@@ -98,6 +119,14 @@ static cl::opt<unsigned>
                     "clang-format from an editor integration"),
            cl::init(0), cl::cat(ClangFormatCategory));
 
+static cl::opt<bool>
+    Server("server",
+           cl::desc("Keep running and format the code sent on standard\n"
+                    "input, one request after another. Used by editor\n"
+                    "integrations to avoid starting clang-format and\n"
+                    "reading .clang-format files on every request."),
+           cl::cat(ClangFormatCategory));
+
 static cl::opt<bool> SortIncludes(
     "sort-includes",
     cl::desc("If set, overrides the include sorting behavior determined by the "
@@ -110,6 +139,30 @@ static cl::list<std::string> FileNames(cl::Positional, cl::desc("[<file> ...]"),
 namespace clang {
 namespace format {
 
+// The options that select what to format in one input. They come from the
+// command line, or from each request in -server mode.
+struct InputOptions {
+  std::vector<unsigned> Offsets;
+  std::vector<unsigned> Lengths;
+  std::vector<std::string> LineRanges;
+  std::string AssumeFileName;
+  bool HasCursor;
+  unsigned Cursor;
+
+  InputOptions()
+      : AssumeFileName(::AssumeFileName), HasCursor(false), Cursor(0) {}
+
+  static InputOptions fromCommandLine() {
+    InputOptions Input;
+    Input.Offsets.assign(::Offsets.begin(), ::Offsets.end());
+    Input.Lengths.assign(::Lengths.begin(), ::Lengths.end());
+    Input.LineRanges.assign(::LineRanges.begin(), ::LineRanges.end());
+    Input.HasCursor = ::Cursor.getNumOccurrences() != 0;
+    Input.Cursor = ::Cursor;
+    return Input;
+  }
+};
+
 static FileID createInMemoryFile(StringRef FileName, MemoryBuffer *Source,
                                  SourceManager &Sources, FileManager &Files,
                                  vfs::InMemoryFileSystem *MemFS) {
@@ -127,8 +180,13 @@ static bool parseLineRange(StringRef Input, unsigned &FromLine,
          LineRange.second.getAsInteger(0, ToLine);
 }
 
-static bool fillRanges(MemoryBuffer *Code,
-                       std::vector<tooling::Range> &Ranges) {
+static bool fillRanges(StringRef FileName, MemoryBuffer *Code,
+                       const InputOptions &Input,
+                       std::vector<tooling::Range> &Ranges,
+                       raw_ostream &ErrOS) {
+  ArrayRef<std::string> LineRanges = Input.LineRanges;
+  ArrayRef<unsigned> Offsets = Input.Offsets;
+  ArrayRef<unsigned> Lengths = Input.Lengths;
   IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
       new vfs::InMemoryFileSystem);
   FileManager Files(FileSystemOptions(), InMemoryFileSystem);
@@ -140,18 +198,26 @@ static bool fillRanges(MemoryBuffer *Code,
                                  InMemoryFileSystem.get());
   if (!LineRanges.empty()) {
     if (!Offsets.empty() || !Lengths.empty()) {
-      errs() << "error: cannot use -lines with -offset/-length\n";
+      ErrOS << "error: cannot use -lines with -offset/-length\n";
       return true;
     }
 
     for (unsigned i = 0, e = LineRanges.size(); i < e; ++i) {
+      StringRef LineRange = LineRanges[i];
+      if (LineRange.count(':') > 1) {
+        // <file>:<start line>:<end line>
+        StringRef File = LineRange.rsplit(':').first.rsplit(':').first;
+        if (File != FileName)
+          continue;
+        LineRange = LineRange.drop_front(File.size() + 1);
+      }
       unsigned FromLine, ToLine;
-      if (parseLineRange(LineRanges[i], FromLine, ToLine)) {
-        errs() << "error: invalid <start line>:<end line> pair\n";
+      if (parseLineRange(LineRange, FromLine, ToLine)) {
+        ErrOS << "error: invalid <start line>:<end line> pair\n";
         return true;
       }
       if (FromLine > ToLine) {
-        errs() << "error: start line should be less than end line\n";
+        ErrOS << "error: start line should be less than end line\n";
         return true;
       }
       SourceLocation Start = Sources.translateLineCol(ID, FromLine, 1);
@@ -165,26 +231,27 @@ static bool fillRanges(MemoryBuffer *Code,
     return false;
   }
 
-  if (Offsets.empty())
-    Offsets.push_back(0);
-  if (Offsets.size() != Lengths.size() &&
-      !(Offsets.size() == 1 && Lengths.empty())) {
-    errs() << "error: number of -offset and -length arguments must match.\n";
+  std::vector<unsigned> FileOffsets(Offsets.begin(), Offsets.end());
+  if (FileOffsets.empty())
+    FileOffsets.push_back(0);
+  if (FileOffsets.size() != Lengths.size() &&
+      !(FileOffsets.size() == 1 && Lengths.empty())) {
+    ErrOS << "error: number of -offset and -length arguments must match.\n";
     return true;
   }
-  for (unsigned i = 0, e = Offsets.size(); i != e; ++i) {
-    if (Offsets[i] >= Code->getBufferSize()) {
-      errs() << "error: offset " << Offsets[i] << " is outside the file\n";
+  for (unsigned i = 0, e = FileOffsets.size(); i != e; ++i) {
+    if (FileOffsets[i] >= Code->getBufferSize()) {
+      ErrOS << "error: offset " << FileOffsets[i] << " is outside the file\n";
       return true;
     }
     SourceLocation Start =
-        Sources.getLocForStartOfFile(ID).getLocWithOffset(Offsets[i]);
+        Sources.getLocForStartOfFile(ID).getLocWithOffset(FileOffsets[i]);
     SourceLocation End;
     if (i < Lengths.size()) {
-      if (Offsets[i] + Lengths[i] > Code->getBufferSize()) {
-        errs() << "error: invalid length " << Lengths[i]
-               << ", offset + length (" << Offsets[i] + Lengths[i]
-               << ") is outside the file.\n";
+      if (FileOffsets[i] + Lengths[i] > Code->getBufferSize()) {
+        ErrOS << "error: invalid length " << Lengths[i]
+              << ", offset + length (" << FileOffsets[i] + Lengths[i]
+              << ") is outside the file.\n";
         return true;
       }
       End = Start.getLocWithOffset(Lengths[i]);
@@ -198,68 +265,137 @@ static bool fillRanges(MemoryBuffer *Code,
   return false;
 }
 
-static void outputReplacementXML(StringRef Text) {
+static void outputReplacementXML(raw_ostream &OS, StringRef Text) {
   // FIXME: When we sort includes, we need to make sure the stream is correct
   // utf-8.
   size_t From = 0;
   size_t Index;
   while ((Index = Text.find_first_of("\n\r<&", From)) != StringRef::npos) {
-    outs() << Text.substr(From, Index - From);
+    OS << Text.substr(From, Index - From);
     switch (Text[Index]) {
     case '\n':
-      outs() << "&#10;";
+      OS << "&#10;";
       break;
     case '\r':
-      outs() << "&#13;";
+      OS << "&#13;";
       break;
     case '<':
-      outs() << "&lt;";
+      OS << "&lt;";
       break;
     case '&':
-      outs() << "&amp;";
+      OS << "&amp;";
       break;
     default:
       llvm_unreachable("Unexpected character encountered!");
     }
     From = Index + 1;
   }
-  outs() << Text.substr(From);
+  OS << Text.substr(From);
 }
 
-static void outputReplacementsXML(const Replacements &Replaces) {
+static void outputReplacementsXML(raw_ostream &OS,
+                                  const Replacements &Replaces) {
   for (const auto &R : Replaces) {
-    outs() << "<replacement "
-           << "offset='" << R.getOffset() << "' "
-           << "length='" << R.getLength() << "'>";
-    outputReplacementXML(R.getReplacementText());
-    outs() << "</replacement>\n";
+    OS << "<replacement "
+       << "offset='" << R.getOffset() << "' "
+       << "length='" << R.getLength() << "'>";
+    outputReplacementXML(OS, R.getReplacementText());
+    OS << "</replacement>\n";
   }
 }
 
-// Returns true on error.
-static bool format(StringRef FileName) {
-  ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
-      MemoryBuffer::getFileOrSTDIN(FileName);
-  if (std::error_code EC = CodeOrErr.getError()) {
-    errs() << EC.message() << "\n";
-    return true;
+// Opens the file that the formatted \p FileName is written to with
+// -output-dir. Returns null on error.
+static std::unique_ptr<raw_fd_ostream> createOutputFile(StringRef FileName,
+                                                        raw_ostream &ErrOS) {
+  SmallString<128> Path(OutputDir);
+  sys::path::append(Path, sys::path::relative_path(FileName));
+  std::error_code EC =
+      sys::fs::create_directories(sys::path::parent_path(Path));
+  std::unique_ptr<raw_fd_ostream> OS;
+  if (!EC)
+    OS.reset(new raw_fd_ostream(Path, EC, sys::fs::F_None));
+  if (EC) {
+    ErrOS << "error: cannot write " << Path << ": " << EC.message() << "\n";
+    return nullptr;
   }
-  std::unique_ptr<llvm::MemoryBuffer> Code = std::move(CodeOrErr.get());
-  if (Code->getBufferSize() == 0)
-    return false; // Empty files are formatted correctly.
+  return OS;
+}
+
+namespace {
+/// Remembers the style used for the files of each directory and language, so
+/// that -server does not look for and parse the .clang-format files again on
+/// every request.
+class StyleCache {
+  struct Entry {
+    std::string ConfigFiles;
+    FormatStyle Style;
+  };
+  StringMap<Entry> Entries;
+
+  /// Describes the configuration files that -style=file may pick for the
+  /// files in \p Directory, including their size and modification time, so
+  /// that creating or editing one of them invalidates the cached style.
+  static std::string describeConfigFiles(StringRef Directory) {
+    std::string Description;
+    raw_string_ostream OS(Description);
+    for (; !Directory.empty(); Directory = sys::path::parent_path(Directory)) {
+      for (const char *Name : {".clang-format", "_clang-format"}) {
+        SmallString<128> ConfigFile(Directory);
+        sys::path::append(ConfigFile, Name);
+        sys::fs::file_status Status;
+        if (sys::fs::status(ConfigFile, Status) ||
+            !sys::fs::is_regular_file(Status))
+          continue;
+        OS << ConfigFile << ':' << Status.getSize() << ':'
+           << Status.getLastModificationTime().toEpochTime() << '\n';
+      }
+    }
+    return OS.str();
+  }
+
+public:
+  FormatStyle get(StringRef FileName) {
+    SmallString<128> Path(FileName);
+    sys::fs::make_absolute(Path);
+    StringRef Directory = sys::path::parent_path(Path);
+    std::string Key = (Directory + "/" + sys::path::extension(Path)).str();
+    std::string ConfigFiles = describeConfigFiles(Directory);
+
+    auto It = Entries.find(Key);
+    if (It != Entries.end() && It->second.ConfigFiles == ConfigFiles)
+      return It->second.Style;
+    Entry &E = Entries[Key];
+    E.ConfigFiles = std::move(ConfigFiles);
+    E.Style = getStyle(Style, FileName, FallbackStyle);
+    return E.Style;
+  }
+};
+} // end anonymous namespace
+
+// Formats \p Code, read from \p FileName, writing the result to \p OS and
+// errors to \p ErrOS. Styles are looked up in \p Styles when it is given.
+// Returns true on error.
+static bool formatBuffer(std::unique_ptr<MemoryBuffer> Code,
+                         StringRef FileName, const InputOptions &Input,
+                         StyleCache *Styles, raw_ostream &OS,
+                         raw_ostream &ErrOS) {
   std::vector<tooling::Range> Ranges;
-  if (fillRanges(Code.get(), Ranges))
+  if (fillRanges(FileName, Code.get(), Input, Ranges, ErrOS))
     return true;
-  StringRef AssumedFileName = (FileName == "-") ? AssumeFileName : FileName;
-  FormatStyle FormatStyle = getStyle(Style, AssumedFileName, FallbackStyle);
+  StringRef AssumedFileName =
+      (FileName == "-") ? StringRef(Input.AssumeFileName) : FileName;
+  FormatStyle FormatStyle =
+      Styles ? Styles->get(AssumedFileName)
+             : getStyle(Style, AssumedFileName, FallbackStyle);
   if (SortIncludes.getNumOccurrences() != 0)
     FormatStyle.SortIncludes = SortIncludes;
-  unsigned CursorPosition = Cursor;
+  unsigned CursorPosition = Input.Cursor;
   Replacements Replaces = sortIncludes(FormatStyle, Code->getBuffer(), Ranges,
                                        AssumedFileName, &CursorPosition);
   auto ChangedCode = tooling::applyAllReplacements(Code->getBuffer(), Replaces);
   if (!ChangedCode) {
-    llvm::errs() << llvm::toString(ChangedCode.takeError()) << "\n";
+    ErrOS << llvm::toString(ChangedCode.takeError()) << "\n";
     return true;
   }
   for (const auto &R : Replaces)
@@ -270,16 +406,16 @@ static bool format(StringRef FileName) {
                                         AssumedFileName, &IncompleteFormat);
   Replaces = tooling::mergeReplacements(Replaces, FormatChanges);
   if (OutputXML) {
-    outs() << "<?xml version='1.0'?>\n<replacements "
-              "xml:space='preserve' incomplete_format='"
-           << (IncompleteFormat ? "true" : "false") << "'>\n";
-    if (Cursor.getNumOccurrences() != 0)
-      outs() << "<cursor>"
-             << tooling::shiftedCodePosition(FormatChanges, CursorPosition)
-             << "</cursor>\n";
-
-    outputReplacementsXML(Replaces); 
-    outs() << "</replacements>\n";
+    OS << "<?xml version='1.0'?>\n<replacements "
+          "xml:space='preserve' incomplete_format='"
+       << (IncompleteFormat ? "true" : "false") << "'>\n";
+    if (Input.HasCursor)
+      OS << "<cursor>"
+         << tooling::shiftedCodePosition(FormatChanges, CursorPosition)
+         << "</cursor>\n";
+
+    outputReplacementsXML(OS, Replaces);
+    OS << "</replacements>\n";
   } else {
     IntrusiveRefCntPtr<vfs::InMemoryFileSystem> InMemoryFileSystem(
         new vfs::InMemoryFileSystem);
@@ -294,21 +430,118 @@ static bool format(StringRef FileName) {
     tooling::applyAllReplacements(Replaces, Rewrite);
     if (Inplace) {
       if (FileName == "-")
-        errs() << "error: cannot use -i when reading from stdin.\n";
+        ErrOS << "error: cannot use -i when reading from stdin.\n";
       else if (Rewrite.overwriteChangedFiles())
         return true;
+    } else if (!OutputDir.empty()) {
+      std::unique_ptr<raw_fd_ostream> File = createOutputFile(FileName, ErrOS);
+      if (!File)
+        return true;
+      Rewrite.getEditBuffer(ID).write(*File);
+    } else {
+      if (Input.HasCursor)
+        OS << "{ \"Cursor\": "
+           << tooling::shiftedCodePosition(FormatChanges, CursorPosition)
+           << ", \"IncompleteFormat\": "
+           << (IncompleteFormat ? "true" : "false") << " }\n";
+      Rewrite.getEditBuffer(ID).write(OS);
+    }
+  }
+  return false;
+}
+
+// Formats \p FileName, writing the result to \p OS and errors to \p ErrOS.
+// Returns true on error.
+static bool format(StringRef FileName, raw_ostream &OS, raw_ostream &ErrOS) {
+  if (!OutputDir.empty() && FileName == "-") {
+    ErrOS << "error: cannot use -output-dir when reading from stdin.\n";
+    return true;
+  }
+  ErrorOr<std::unique_ptr<MemoryBuffer>> CodeOrErr =
+      MemoryBuffer::getFileOrSTDIN(FileName);
+  if (std::error_code EC = CodeOrErr.getError()) {
+    ErrOS << EC.message() << "\n";
+    return true;
+  }
+  std::unique_ptr<llvm::MemoryBuffer> Code = std::move(CodeOrErr.get());
+  if (Code->getBufferSize() == 0) {
+    // Empty files are formatted correctly.
+    if (!OutputDir.empty() && !Inplace && !OutputXML)
+      return !createOutputFile(FileName, ErrOS);
+    return false;
+  }
+  return formatBuffer(std::move(Code), FileName,
+                      InputOptions::fromCommandLine(), /*Styles=*/nullptr, OS,
+                      ErrOS);
+}
+
+// Reads one -server request from \p In into \p Input and \p Code. A request
+// is a list of -assume-filename, -cursor, -lines, -offset and -length options
+// written as on the command line, one per line, followed by the size of the
+// code in bytes on a line of its own and then the code itself. Problems with
+// the options are reported to \p ErrOS. Returns false at the end of the
+// input or if the request cannot be read.
+static bool readServerRequest(std::istream &In, InputOptions &Input,
+                              std::string &Code, raw_ostream &ErrOS) {
+  std::string Line;
+  while (std::getline(In, Line)) {
+    StringRef Option = StringRef(Line).rtrim("\r");
+    if (!Option.startswith("-")) {
+      unsigned Size;
+      if (Option.getAsInteger(10, Size))
+        return false;
+      Code.resize(Size);
+      return Size == 0 || In.read(&Code[0], Size);
+    }
+
+    std::pair<StringRef, StringRef> NameAndValue =
+        Option.ltrim("-").split('=');
+    StringRef Name = NameAndValue.first, Value = NameAndValue.second;
+    unsigned Number = 0;
+    if (Name == "assume-filename") {
+      Input.AssumeFileName = Value.str();
+    } else if (Name == "lines") {
+      Input.LineRanges.push_back(Value.str());
+    } else if ((Name == "cursor" || Name == "offset" || Name == "length") &&
+               !Value.getAsInteger(10, Number)) {
+      if (Name == "cursor") {
+        Input.HasCursor = true;
+        Input.Cursor = Number;
+      } else {
+        (Name == "offset" ? Input.Offsets : Input.Lengths).push_back(Number);
+      }
     } else {
-      if (Cursor.getNumOccurrences() != 0)
-        outs() << "{ \"Cursor\": "
-               << tooling::shiftedCodePosition(FormatChanges, CursorPosition)
-               << ", \"IncompleteFormat\": "
-               << (IncompleteFormat ? "true" : "false") << " }\n";
-      Rewrite.getEditBuffer(ID).write(outs());
+      ErrOS << "error: invalid server request option '" << Option << "'\n";
     }
   }
   return false;
 }
 
+// Formats requests from standard input until it is closed. Each response is
+// a line with the sizes in bytes of the output and of the error messages,
+// followed by the output and then by the error messages.
+static void runServer() {
+  sys::ChangeStdinToBinary();
+  sys::ChangeStdoutToBinary();
+
+  StyleCache Styles;
+  while (true) {
+    InputOptions Input;
+    std::string Code, Output, Errors;
+    raw_string_ostream OS(Output), ErrOS(Errors);
+    if (!readServerRequest(std::cin, Input, Code, ErrOS))
+      break;
+    if (ErrOS.tell() == 0 && !Code.empty())
+      formatBuffer(MemoryBuffer::getMemBuffer(Code, Input.AssumeFileName),
+                   "-", Input, &Styles, OS, ErrOS);
+    OS.flush();
+    ErrOS.flush();
+    outs() << Output.size() << ' ' << Errors.size() << '\n'
+           << Output << Errors;
+    outs().flush();
+  }
+}
+
 }  // namespace format
 }  // namespace clang
 
@@ -344,24 +577,65 @@ int main(int argc, const char **argv) {
     return 0;
   }
 
+  if (Server) {
+    if (!FileNames.empty() || Inplace || !OutputDir.empty()) {
+      errs() << "error: -server reads its input from standard input and "
+                "cannot be used with files, -i or -output-dir.\n";
+      return 1;
+    }
+    clang::format::runServer();
+    return 0;
+  }
+
   bool Error = false;
   switch (FileNames.size()) {
   case 0:
-    Error = clang::format::format("-");
+    Error = clang::format::format("-", outs(), errs());
     break;
   case 1:
-    Error = clang::format::format(FileNames[0]);
+    Error = clang::format::format(FileNames[0], outs(), errs());
     break;
-  default:
-    if (!Offsets.empty() || !Lengths.empty() || !LineRanges.empty()) {
-      errs() << "error: -offset, -length and -lines can only be used for "
-                "single file.\n";
+  default: {
+    if (!Offsets.empty() || !Lengths.empty()) {
+      errs() << "error: -offset and -length can only be used for single "
+                "file.\n";
       return 1;
     }
-    for (unsigned i = 0; i < FileNames.size(); ++i)
-      Error |= clang::format::format(FileNames[i]);
+    unsigned Threads = NumThreads;
+    if (Threads == 0)
+      Threads = std::max(1u, std::thread::hardware_concurrency());
+    Threads = std::min<size_t>(Threads, FileNames.size());
+    if (Threads == 1) {
+      for (unsigned i = 0; i < FileNames.size(); ++i)
+        Error |= clang::format::format(FileNames[i], outs(), errs());
+      break;
+    }
+
+    // Each file is formatted into its own buffers, which are written out in
+    // the order of the files once all of them are done.
+    std::vector<std::string> Outputs(FileNames.size());
+    std::vector<std::string> Errors(FileNames.size());
+    std::vector<char> Failed(FileNames.size());
+    std::atomic<size_t> NextFile(0);
+    {
+      ThreadPool Pool(Threads);
+      for (unsigned I = 0; I != Threads; ++I)
+        Pool.async([&] {
+          for (size_t F = NextFile++; F < FileNames.size(); F = NextFile++) {
+            raw_string_ostream OS(Outputs[F]), ErrOS(Errors[F]);
+            Failed[F] = clang::format::format(FileNames[F], OS, ErrOS);
+          }
+        });
+      Pool.wait();
+    }
+    for (size_t F = 0; F != FileNames.size(); ++F) {
+      outs() << Outputs[F];
+      errs() << Errors[F];
+      Error |= Failed[F];
+    }
     break;
   }
+  }
   return Error ? 1 : 0;
 }
 
@@ -25,9 +25,14 @@
 #
 # It operates on the current, potentially unsaved buffer and does not create
 # or save any files. To revert a formatting, just undo.
+#
+# Set g:clang_format_server to 1 to keep a 'clang-format -server' process
+# running between requests, which saves starting clang-format and reading the
+# '.clang-format' files every time.
 
 import difflib
 import json
+import os
 import subprocess
 import sys
 import vim
@@ -47,6 +52,41 @@ fallback_style = None
 if vim.eval('exists("g:clang_format_fallback_style")') == "1":
   fallback_style = vim.eval('g:clang_format_fallback_style')
 
+# The server process survives between invocations of this file because vim
+# keeps the Python globals around.
+try:
+  clang_format_server
+except NameError:
+  clang_format_server = None
+
+def format_with_server(text, cursor, lines, startupinfo):
+  global clang_format_server
+  if clang_format_server is None or clang_format_server.poll() is not None:
+    command = [binary, '-server', '-style', style]
+    if fallback_style:
+      command.extend(['-fallback-style', fallback_style])
+    clang_format_server = subprocess.Popen(command,
+                                           stdout=subprocess.PIPE,
+                                           stderr=open(os.devnull, 'w'),
+                                           stdin=subprocess.PIPE,
+                                           startupinfo=startupinfo)
+
+  request = ['-cursor=%d' % cursor]
+  if lines != 'all':
+    request.append('-lines=%s' % lines)
+  if vim.current.buffer.name:
+    request.append('-assume-filename=%s' % vim.current.buffer.name)
+  request.append(str(len(text)))
+  server = clang_format_server
+  server.stdin.write('\n'.join(request) + '\n' + text)
+  server.stdin.flush()
+
+  sizes = server.stdout.readline().split()
+  if len(sizes) != 2:
+    clang_format_server = None
+    return '', ''
+  return server.stdout.read(int(sizes[0])), server.stdout.read(int(sizes[1]))
+
 def main():
   # Get the current text.
   buf = vim.current.buffer
@@ -72,17 +112,20 @@ def main():
     startupinfo.wShowWindow = subprocess.SW_HIDE
 
   # Call formatter.
-  command = [binary, '-style', style, '-cursor', str(cursor)]
-  if lines != 'all':
-    command.extend(['-lines', lines])
-  if fallback_style:
-    command.extend(['-fallback-style', fallback_style])
-  if vim.current.buffer.name:
-    command.extend(['-assume-filename', vim.current.buffer.name])
-  p = subprocess.Popen(command,
-                       stdout=subprocess.PIPE, stderr=subprocess.PIPE,
-                       stdin=subprocess.PIPE, startupinfo=startupinfo)
-  stdout, stderr = p.communicate(input=text)
+  if vim.eval('get(g:, "clang_format_server", 0)') != '0':
+    stdout, stderr = format_with_server(text, cursor, lines, startupinfo)
+  else:
+    command = [binary, '-style', style, '-cursor', str(cursor)]
+    if lines != 'all':
+      command.extend(['-lines', lines])
+    if fallback_style:
+      command.extend(['-fallback-style', fallback_style])
+    if vim.current.buffer.name:
+      command.extend(['-assume-filename', vim.current.buffer.name])
+    p = subprocess.Popen(command,
+                         stdout=subprocess.PIPE, stderr=subprocess.PIPE,
+                         stdin=subprocess.PIPE, startupinfo=startupinfo)
+    stdout, stderr = p.communicate(input=text)
 
   # If successful, replace buffer contents.
   if stderr:
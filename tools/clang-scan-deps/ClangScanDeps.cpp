@@ -0,0 +1,787 @@
+//===--- tools/clang-scan-deps/ClangScanDeps.cpp - Dependency scanner -----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+//  This file implements a tool that computes the Makefile dependencies of
+//  the translation units in a compilation database, preprocessing many of
+//  them in parallel inside a single process.
+//
+//  Every worker thread keeps its own FileManagers, so repeated lookups of the
+//  same headers by the translation units it scans are answered from memory.
+//  Work is shared between threads through the on-disk shared stat cache and
+//  token cache, when they are given.
+//
+//  With -module-files-dir, the scan also maps the headers it sees to the
+//  modules that own them, scans the headers of those modules to find the
+//  modules they import, and builds every module as an explicit module file,
+//  building the modules that do not depend on each other in parallel. The
+//  -fmodule-file= options each translation unit needs are printed instead of
+//  the rules, so that the build can compile it without implicit modules.
+//  As in the implicit module cache, module files are kept in a subdirectory
+//  named after the hash of the options they were built with, so that
+//  commands building the same module differently get separate module files.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SharedStatCache.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "clang/Frontend/Utils.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <set>
+#include <thread>
+
+using namespace clang;
+using namespace clang::tooling;
+using namespace llvm;
+
+static cl::OptionCategory ScanDepsCategory("clang-scan-deps options");
+
+static cl::opt<std::string>
+BuildPath("p", cl::desc("Build path containing compile_commands.json"),
+          cl::Required, cl::cat(ScanDepsCategory));
+
+static cl::list<std::string>
+SourcePaths(cl::Positional,
+            cl::desc("[<source> ...] (default: every file in the database)"),
+            cl::ZeroOrMore, cl::cat(ScanDepsCategory));
+
+static cl::opt<unsigned>
+NumThreads("j", cl::desc("Number of worker threads to use "
+                         "(default: number of hardware threads)"),
+           cl::init(0), cl::cat(ScanDepsCategory));
+
+static cl::opt<bool>
+SkipSystemHeaders("MM", cl::desc("Don't list system headers, like -MM"),
+                  cl::cat(ScanDepsCategory));
+
+static cl::opt<bool>
+MinimizeSources("minimize-sources",
+                cl::desc("Lex only the preprocessor directives of each file "
+                         "(default: on)"),
+                cl::init(true), cl::cat(ScanDepsCategory));
+
+static cl::opt<std::string>
+SharedStatCachePath("shared-stat-cache",
+                    cl::desc("Shared stat cache file used by every worker"),
+                    cl::value_desc("file"), cl::cat(ScanDepsCategory));
+
+static cl::opt<std::string>
+TokenCacheDir("token-cache-dir",
+              cl::desc("Token cache directory used by every worker"),
+              cl::value_desc("directory"), cl::cat(ScanDepsCategory));
+
+static cl::opt<std::string>
+ModuleFilesDir("module-files-dir",
+               cl::desc("Build the modules used by the translation units "
+                        "into this directory and print the -fmodule-file= "
+                        "options of each translation unit"),
+               cl::value_desc("directory"), cl::cat(ScanDepsCategory));
+
+namespace {
+
+/// \brief Records the dependencies of one translation unit, in the order the
+/// dependency file generator would list them.
+class ScanDepsCollector : public DependencyCollector {
+public:
+  bool needSystemDependencies() override { return !SkipSystemHeaders; }
+};
+
+/// \brief A module found by a scan, with what is needed to scan and build it.
+struct ModuleInfo {
+  std::string Name;
+  /// The hash of the options it is built with.
+  std::string ContextHash;
+  std::string ModuleMapPath;
+  std::vector<std::string> Headers;
+  /// The compile command whose options are used to scan and build it.
+  size_t CommandIndex = 0;
+  /// The keys of the modules its headers import.
+  std::set<std::string> Dependencies;
+  enum StateKind { Pending, Built, Failed } State = Pending;
+
+  /// \brief Returns the key identifying this module and the options it is
+  /// built with, which is also the path of its module file below
+  /// -module-files-dir.
+  std::string getKey() const { return ContextHash + "/" + Name; }
+
+  /// \brief Returns the module file that -module-files-dir builds it into.
+  std::string getModuleFilePath() const {
+    SmallString<128> Path(ModuleFilesDir);
+    llvm::sys::fs::make_absolute(Path);
+    llvm::sys::path::append(Path, ContextHash, Name + ".pcm");
+    return Path.str();
+  }
+};
+
+/// \brief The top-level modules that own the headers a scan entered or that
+/// it imported.
+struct ModuleUses {
+  /// The names of the modules named by '\@import' declarations.
+  std::set<std::string> Imported;
+  std::set<std::string> Keys;
+  llvm::StringMap<ModuleInfo> Found;
+
+  void record(CompilerInstance &CI);
+
+private:
+  void recordModule(CompilerInstance &CI, StringRef ContextHash, Module *M);
+};
+
+/// \brief Preprocesses one translation unit, discarding the output and
+/// reporting every header it enters to a ScanDepsCollector, and the modules
+/// owning them to a ModuleUses if one is given.
+class ScanDepsAction : public PreprocessOnlyAction {
+  std::shared_ptr<ScanDepsCollector> Collector;
+  std::shared_ptr<ModuleUses> Modules;
+
+public:
+  ScanDepsAction(std::shared_ptr<ScanDepsCollector> Collector,
+                 std::shared_ptr<ModuleUses> Modules)
+      : Collector(std::move(Collector)), Modules(std::move(Modules)) {}
+
+  bool BeginInvocation(CompilerInstance &CI) override {
+    // The command line's own dependency options were removed before the
+    // invocation was built; dependencies are only recorded in memory.
+    CI.getDependencyOutputOpts() = DependencyOutputOptions();
+    if (!TokenCacheDir.empty())
+      CI.getPreprocessorOpts().TokenCacheDir = TokenCacheDir;
+    CI.getPreprocessorOpts().MinimizeSourceToDependencyDirectives =
+        MinimizeSources;
+    CI.addDependencyCollector(Collector);
+    return true;
+  }
+
+  void ExecuteAction() override {
+    if (!Modules)
+      return PreprocessOnlyAction::ExecuteAction();
+
+    // Modules are disabled while scanning, so '@import' declarations reach
+    // the token stream instead of the preprocessor; record what they name.
+    Preprocessor &PP = getCompilerInstance().getPreprocessor();
+    PP.IgnorePragmas();
+    Token Tok;
+    PP.EnterMainSourceFile();
+    do {
+      PP.Lex(Tok);
+      if (Tok.isNot(tok::at))
+        continue;
+      PP.Lex(Tok);
+      if (Tok.isNot(tok::identifier) ||
+          !Tok.getIdentifierInfo()->isStr("import"))
+        continue;
+      PP.Lex(Tok);
+      if (Tok.is(tok::identifier))
+        Modules->Imported.insert(Tok.getIdentifierInfo()->getName());
+    } while (Tok.isNot(tok::eof));
+  }
+
+  void EndSourceFileAction() override {
+    if (Modules)
+      Modules->record(getCompilerInstance());
+  }
+};
+
+/// \brief Runs a frontend action on the invocation of a compile command,
+/// once \p Adjust has rewritten the invocation, e.g. to preprocess the
+/// headers of a module or to build a module instead of the translation unit.
+class AdjustedToolAction : public ToolAction {
+  std::function<void(CompilerInvocation &)> Adjust;
+  std::unique_ptr<FrontendAction> Action;
+
+public:
+  AdjustedToolAction(std::function<void(CompilerInvocation &)> Adjust,
+                     std::unique_ptr<FrontendAction> Action)
+      : Adjust(std::move(Adjust)), Action(std::move(Action)) {}
+
+  bool runInvocation(CompilerInvocation *Invocation, FileManager *Files,
+                     std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                     DiagnosticConsumer *DiagConsumer) override {
+    if (Adjust)
+      Adjust(*Invocation);
+
+    CompilerInstance Compiler(std::move(PCHContainerOps));
+    Compiler.setInvocation(Invocation);
+    Compiler.setFileManager(Files);
+    Compiler.createDiagnostics(DiagConsumer, /*ShouldOwnClient=*/false);
+    if (!Compiler.hasDiagnostics())
+      return false;
+    Compiler.createSourceManager(*Files);
+
+    const bool Success = Compiler.ExecuteAction(*Action);
+    Files->clearStatCaches();
+    return Success;
+  }
+};
+
+/// \brief The outcome of scanning one compile command.
+struct ScanResult {
+  std::string Target;
+  std::vector<std::string> Dependencies;
+  ModuleUses Modules;
+  std::string Diagnostics;
+  bool Success = false;
+};
+
+/// \brief The state owned by one worker thread.
+///
+/// FileManager is not thread-safe, so each worker keeps one FileManager per
+/// working directory and reuses it for every command it scans from there.
+class ScanDepsWorker {
+  const ArgumentsAdjuster &Adjuster;
+  llvm::StringMap<IntrusiveRefCntPtr<FileManager>> FileManagers;
+
+  FileManager &getFileManager(StringRef Directory) {
+    IntrusiveRefCntPtr<FileManager> &Files = FileManagers[Directory];
+    if (!Files) {
+      FileSystemOptions FSOpts;
+      FSOpts.WorkingDir = Directory;
+      Files = new FileManager(FSOpts);
+      if (!SharedStatCachePath.empty())
+        if (auto StatCache = SharedStatCache::create(SharedStatCachePath))
+          Files->addStatCache(std::move(StatCache));
+    }
+    return *Files;
+  }
+
+  bool run(const CompileCommand &Command,
+           std::function<void(CompilerInvocation &)> Adjust,
+           std::unique_ptr<FrontendAction> Action, std::string &Diagnostics);
+
+public:
+  explicit ScanDepsWorker(const ArgumentsAdjuster &Adjuster)
+      : Adjuster(Adjuster) {}
+
+  ScanResult scan(const CompileCommand &Command);
+
+  /// \brief Preprocesses the headers of a module with the options of
+  /// \p Command, recording the modules they use.
+  ScanResult scanModule(const CompileCommand &Command, const ModuleInfo &Info);
+
+  /// \brief Builds the module \p Info with the options of \p Command,
+  /// loading the module files of \p Dependencies.
+  bool buildModule(const CompileCommand &Command, const ModuleInfo &Info,
+                   const std::vector<std::string> &Dependencies,
+                   std::string &Diagnostics);
+};
+
+} // end anonymous namespace
+
+/// \brief Returns the Makefile target for \p Command: its -o output if it has
+/// one, and otherwise the object file the driver would name after the input.
+static std::string getTarget(const CompileCommand &Command) {
+  const CommandLineArguments &Args = Command.CommandLine;
+  for (size_t I = 0, E = Args.size(); I != E; ++I) {
+    StringRef Arg = Args[I];
+    if (Arg == "-o" && I + 1 != E)
+      return Args[I + 1];
+    if (Arg.startswith("-o") && Arg.size() > 2)
+      return Arg.substr(2);
+  }
+  return (llvm::sys::path::stem(Command.Filename) + ".o").str();
+}
+
+/// \brief Returns an adjuster removing the dependency file options from a
+/// command line; the scanner prints the dependencies itself.
+static ArgumentsAdjuster getStripDependencyFileAdjuster() {
+  return [](const CommandLineArguments &Args, StringRef /*unused*/) {
+    CommandLineArguments AdjustedArgs;
+    for (size_t I = 0, E = Args.size(); I != E; ++I) {
+      StringRef Arg = Args[I];
+      if (Arg == "-M" || Arg == "-MM" || Arg == "-MD" || Arg == "-MMD" ||
+          Arg == "-MP" || Arg == "-MG")
+        continue;
+      if (Arg.startswith("-MF") || Arg.startswith("-MT") ||
+          Arg.startswith("-MQ")) {
+        // The value is either joined or the next argument.
+        if (Arg.size() == 3)
+          ++I;
+        continue;
+      }
+      AdjustedArgs.push_back(Args[I]);
+    }
+    return AdjustedArgs;
+  };
+}
+
+/// \brief Returns \p Path made absolute against the working directory of
+/// \p Files.
+static std::string makeAbsolute(FileManager &Files, StringRef Path) {
+  SmallString<256> AbsolutePath(Path);
+  Files.makeAbsolutePath(AbsolutePath);
+  return AbsolutePath.str();
+}
+
+/// \brief Appends the headers that make up \p M and its submodules.
+static void collectModuleHeaders(FileManager &Files, Module *M,
+                                 std::vector<std::string> &Headers) {
+  for (auto HK : {Module::HK_Normal, Module::HK_Private})
+    for (const Module::Header &H : M->Headers[HK])
+      Headers.push_back(makeAbsolute(Files, H.Entry->getName()));
+  if (Module::Header UmbrellaHeader = M->getUmbrellaHeader())
+    Headers.push_back(makeAbsolute(Files, UmbrellaHeader.Entry->getName()));
+  for (Module *Sub : M->submodules())
+    if (Sub->isAvailable())
+      collectModuleHeaders(Files, Sub, Headers);
+}
+
+/// \brief Returns the hash of the options a module is built with from
+/// \p Invocation, the invocation scanning its users.
+static std::string getModuleContextHash(const CompilerInvocation &Invocation) {
+  // Apply the changes buildModule makes, so that the hash does not depend on
+  // modules being disabled for the scan.
+  CompilerInvocation BuildInvocation(Invocation);
+  BuildInvocation.getLangOpts()->Modules = true;
+  BuildInvocation.getLangOpts()->ImplicitModules = false;
+  BuildInvocation.getHeaderSearchOpts().ImplicitModuleMaps = true;
+  return BuildInvocation.getModuleHash();
+}
+
+void ModuleUses::recordModule(CompilerInstance &CI, StringRef ContextHash,
+                              Module *M) {
+  HeaderSearch &HS = CI.getPreprocessor().getHeaderSearchInfo();
+  Module *Top = M->getTopLevelModule();
+  const FileEntry *ModuleMapFile =
+      HS.getModuleMap().getModuleMapFileForUniquing(Top);
+  if (!Top->isAvailable() || !ModuleMapFile)
+    return;
+
+  ModuleInfo Info;
+  Info.Name = Top->Name;
+  Info.ContextHash = ContextHash;
+  std::string Key = Info.getKey();
+  Keys.insert(Key);
+  if (Found.count(Key))
+    return;
+
+  Info.ModuleMapPath =
+      makeAbsolute(CI.getFileManager(), ModuleMapFile->getName());
+  collectModuleHeaders(CI.getFileManager(), Top, Info.Headers);
+  Found[Key] = std::move(Info);
+}
+
+void ModuleUses::record(CompilerInstance &CI) {
+  std::string ContextHash = getModuleContextHash(CI.getInvocation());
+  SourceManager &SM = CI.getSourceManager();
+  HeaderSearch &HS = CI.getPreprocessor().getHeaderSearchInfo();
+  for (SourceManager::fileinfo_iterator I = SM.fileinfo_begin(),
+                                        E = SM.fileinfo_end();
+       I != E; ++I) {
+    // Textual headers are part of whoever includes them.
+    ModuleMap::KnownHeader Owner = HS.findModuleForHeader(I->first);
+    if (!Owner || (Owner.getRole() & ModuleMap::TextualHeader))
+      continue;
+    recordModule(CI, ContextHash, Owner.getModule());
+  }
+
+  // Imported modules are found through the module maps of the header search
+  // paths, as an implicit module build would.
+  for (const std::string &Name : Imported)
+    if (Module *M = HS.lookupModule(Name))
+      recordModule(CI, ContextHash, M);
+}
+
+bool ScanDepsWorker::run(const CompileCommand &Command,
+                         std::function<void(CompilerInvocation &)> Adjust,
+                         std::unique_ptr<FrontendAction> Action,
+                         std::string &Diagnostics) {
+  // Resolve relative paths against the command's directory without touching
+  // the process' working directory, which every worker shares.
+  CommandLineArguments Args = Adjuster(Command.CommandLine, Command.Filename);
+  Args.push_back("-working-directory");
+  Args.push_back(Command.Directory);
+
+  llvm::raw_string_ostream DiagOS(Diagnostics);
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  TextDiagnosticPrinter DiagPrinter(DiagOS, &*DiagOpts);
+
+  AdjustedToolAction ToolAction(std::move(Adjust), std::move(Action));
+  ToolInvocation Invocation(std::move(Args), &ToolAction,
+                            &getFileManager(Command.Directory),
+                            std::make_shared<PCHContainerOperations>());
+  Invocation.setDiagnosticConsumer(&DiagPrinter);
+  bool Success = Invocation.run();
+  DiagOS.flush();
+  return Success;
+}
+
+ScanResult ScanDepsWorker::scan(const CompileCommand &Command) {
+  ScanResult Result;
+  Result.Target = getTarget(Command);
+
+  auto Collector = std::make_shared<ScanDepsCollector>();
+  std::shared_ptr<ModuleUses> Modules;
+  if (!ModuleFilesDir.empty())
+    Modules = std::make_shared<ModuleUses>();
+  Result.Success =
+      run(Command, nullptr,
+          llvm::make_unique<ScanDepsAction>(Collector, Modules),
+          Result.Diagnostics);
+
+  Result.Dependencies = Collector->getDependencies().vec();
+  if (Modules)
+    Result.Modules = std::move(*Modules);
+  return Result;
+}
+
+ScanResult ScanDepsWorker::scanModule(const CompileCommand &Command,
+                                      const ModuleInfo &Info) {
+  ScanResult Result;
+  std::string Includes;
+  for (const std::string &Header : Info.Headers)
+    Includes += "#include \"" + Header + "\"\n";
+
+  auto Collector = std::make_shared<ScanDepsCollector>();
+  auto Modules = std::make_shared<ModuleUses>();
+  Result.Success = run(
+      Command,
+      [&](CompilerInvocation &Invocation) {
+        // Preprocess the module's headers instead of the translation unit.
+        FrontendOptions &Opts = Invocation.getFrontendOpts();
+        InputKind Kind = Opts.Inputs[0].getKind();
+        Opts.Inputs.clear();
+        Opts.Inputs.push_back(FrontendInputFile(
+            llvm::MemoryBuffer::getMemBufferCopy(
+                Includes, Module::getModuleInputBufferName()).release(),
+            Kind));
+      },
+      llvm::make_unique<ScanDepsAction>(Collector, Modules),
+      Result.Diagnostics);
+
+  Result.Modules = std::move(*Modules);
+  return Result;
+}
+
+bool ScanDepsWorker::buildModule(const CompileCommand &Command,
+                                 const ModuleInfo &Info,
+                                 const std::vector<std::string> &Dependencies,
+                                 std::string &Diagnostics) {
+  return run(
+      Command,
+      [&](CompilerInvocation &Invocation) {
+        // Build the module from its module map, against explicitly built
+        // module files only.
+        FrontendOptions &Opts = Invocation.getFrontendOpts();
+        InputKind Kind = Opts.Inputs[0].getKind();
+        Opts.Inputs.clear();
+        Opts.Inputs.push_back(FrontendInputFile(Info.ModuleMapPath, Kind));
+        Opts.ProgramAction = frontend::GenerateModule;
+        Opts.OutputFile = Info.getModuleFilePath();
+        Opts.ModuleFiles = Dependencies;
+        LangOptions &LangOpts = *Invocation.getLangOpts();
+        LangOpts.Modules = true;
+        LangOpts.ImplicitModules = false;
+        LangOpts.CurrentModule = Info.Name;
+        Invocation.getHeaderSearchOpts().ImplicitModuleMaps = true;
+      },
+      llvm::make_unique<GenerateModuleAction>(), Diagnostics);
+}
+
+// This mirrors the quoting of the dependency file generator.
+static void printFilename(raw_ostream &OS, StringRef Filename) {
+  for (unsigned I = 0, E = Filename.size(); I != E; ++I) {
+    if (Filename[I] == '#') // Handle '#' the broken gcc way.
+      OS << '\\';
+    else if (Filename[I] == ' ') { // Handle space correctly.
+      OS << '\\';
+      unsigned J = I;
+      while (J > 0 && Filename[--J] == '\\')
+        OS << '\\';
+    } else if (Filename[I] == '$') // $ is escaped by $$.
+      OS << '$';
+    OS << Filename[I];
+  }
+}
+
+static void printRule(raw_ostream &OS, const ScanResult &Result) {
+  const unsigned MaxColumns = 75;
+  printFilename(OS, Result.Target);
+  OS << ':';
+  unsigned Columns = Result.Target.size() + 1;
+  for (const std::string &Dependency : Result.Dependencies) {
+    // Leave space for a trailing " \" in case the next one breaks the line.
+    unsigned N = Dependency.size();
+    if (Columns + (N + 1) + 2 > MaxColumns) {
+      OS << " \\\n ";
+      Columns = 2;
+    }
+    OS << ' ';
+    printFilename(OS, Dependency);
+    Columns += N + 1;
+  }
+  OS << '\n';
+}
+
+/// \brief Calls \p Fn for every index below \p Count on up to \p Threads
+/// threads. Threads pull the next index from a shared counter, so each keeps
+/// its ScanDepsWorker and FileManagers for every index it handles.
+static void runInParallel(unsigned Threads, size_t Count,
+                          const ArgumentsAdjuster &Adjuster,
+                          std::function<void(ScanDepsWorker &, size_t)> Fn) {
+  Threads = std::min<size_t>(Threads, std::max<size_t>(1, Count));
+  std::atomic<size_t> Next(0);
+  ThreadPool Pool(Threads);
+  for (unsigned I = 0; I != Threads; ++I)
+    Pool.async([&] {
+      ScanDepsWorker Worker(Adjuster);
+      for (size_t Index = Next++; Index < Count; Index = Next++)
+        Fn(Worker, Index);
+    });
+  Pool.wait();
+}
+
+/// \brief Builds the modules used by the translation units in \p Results and
+/// prints the -fmodule-file= options each of them needs. Returns true on
+/// error.
+static bool buildModules(const std::vector<CompileCommand> &Commands,
+                         const std::vector<ScanResult> &Results,
+                         const ArgumentsAdjuster &Adjuster, unsigned Threads) {
+  bool Failed = false;
+  llvm::StringMap<ModuleInfo> Modules;
+  std::vector<std::string> ToScan;
+  auto addModules = [&](const ModuleUses &Uses, size_t CommandIndex) {
+    for (const auto &Entry : Uses.Found) {
+      if (Modules.count(Entry.getKey()))
+        continue;
+      ModuleInfo &Info = Modules[Entry.getKey()];
+      Info = Entry.getValue();
+      Info.CommandIndex = CommandIndex;
+      ToScan.push_back(Entry.getKey());
+    }
+  };
+  for (size_t I = 0, E = Results.size(); I != E; ++I)
+    if (Results[I].Success)
+      addModules(Results[I].Modules, I);
+
+  // Find the modules each module imports. Their headers may use modules that
+  // no translation unit reached, so this repeats until no new module shows up.
+  while (!ToScan.empty()) {
+    std::vector<std::string> Scanning;
+    Scanning.swap(ToScan);
+    std::sort(Scanning.begin(), Scanning.end());
+
+    std::vector<ScanResult> Scans(Scanning.size());
+    runInParallel(Threads, Scanning.size(), Adjuster,
+                  [&](ScanDepsWorker &Worker, size_t I) {
+                    const ModuleInfo &Info =
+                        Modules.find(Scanning[I])->getValue();
+                    Scans[I] =
+                        Worker.scanModule(Commands[Info.CommandIndex], Info);
+                  });
+
+    for (size_t I = 0, E = Scanning.size(); I != E; ++I) {
+      ModuleInfo &Info = Modules[Scanning[I]];
+      llvm::errs() << Scans[I].Diagnostics;
+      if (!Scans[I].Success) {
+        llvm::errs() << "Error while scanning the headers of module '"
+                     << Info.Name << "'.\n";
+        Info.State = ModuleInfo::Failed;
+        Failed = true;
+        continue;
+      }
+      Info.Dependencies = Scans[I].Modules.Keys;
+      Info.Dependencies.erase(Scanning[I]);
+      addModules(Scans[I].Modules, Info.CommandIndex);
+    }
+  }
+
+  // Build the modules in waves. A module is ready once all of its
+  // dependencies are built, so the modules of one wave never depend on each
+  // other and are built in parallel.
+  while (true) {
+    std::vector<std::string> Ready;
+    bool NewFailures = false;
+    for (auto &Entry : Modules) {
+      ModuleInfo &Info = Entry.getValue();
+      if (Info.State != ModuleInfo::Pending)
+        continue;
+      bool DependenciesBuilt = true;
+      for (const std::string &Dependency : Info.Dependencies) {
+        ModuleInfo::StateKind State = Modules.find(Dependency)->getValue().State;
+        if (State == ModuleInfo::Failed) {
+          llvm::errs() << "Not building module '" << Info.Name
+                       << "' because module '"
+                       << Modules.find(Dependency)->getValue().Name
+                       << "' could not be built.\n";
+          Info.State = ModuleInfo::Failed;
+          NewFailures = true;
+          break;
+        }
+        DependenciesBuilt &= State == ModuleInfo::Built;
+      }
+      if (Info.State == ModuleInfo::Pending && DependenciesBuilt)
+        Ready.push_back(Entry.getKey());
+    }
+    if (Ready.empty()) {
+      if (NewFailures)
+        continue;
+      break;
+    }
+    std::sort(Ready.begin(), Ready.end());
+
+    std::vector<std::string> Diagnostics(Ready.size());
+    std::vector<char> Built(Ready.size());
+    runInParallel(Threads, Ready.size(), Adjuster,
+                  [&](ScanDepsWorker &Worker, size_t I) {
+                    const ModuleInfo &Info = Modules.find(Ready[I])->getValue();
+                    std::vector<std::string> Dependencies;
+                    for (const std::string &Dependency : Info.Dependencies)
+                      Dependencies.push_back(Modules.find(Dependency)
+                                                 ->getValue()
+                                                 .getModuleFilePath());
+                    Built[I] = Worker.buildModule(Commands[Info.CommandIndex],
+                                                  Info, Dependencies,
+                                                  Diagnostics[I]);
+                  });
+
+    for (size_t I = 0, E = Ready.size(); I != E; ++I) {
+      llvm::errs() << Diagnostics[I];
+      ModuleInfo &Info = Modules[Ready[I]];
+      if (Built[I]) {
+        Info.State = ModuleInfo::Built;
+        continue;
+      }
+      llvm::errs() << "Error while building module '" << Info.Name << "'.\n";
+      Info.State = ModuleInfo::Failed;
+      Failed = true;
+    }
+  }
+
+  for (auto &Entry : Modules) {
+    if (Entry.getValue().State != ModuleInfo::Pending)
+      continue;
+    llvm::errs() << "Not building module '" << Entry.getValue().Name
+                 << "' because its imports form a cycle.\n";
+    Failed = true;
+  }
+
+  for (size_t I = 0, E = Results.size(); I != E; ++I) {
+    if (!Results[I].Success)
+      continue;
+    // A translation unit that imports a module does not enter the headers
+    // of the modules that one uses, so list them too.
+    std::set<std::string> Used;
+    std::vector<std::string> Worklist(Results[I].Modules.Keys.begin(),
+                                      Results[I].Modules.Keys.end());
+    while (!Worklist.empty()) {
+      std::string Key = Worklist.back();
+      Worklist.pop_back();
+      if (!Used.insert(Key).second)
+        continue;
+      const ModuleInfo &Info = Modules.find(Key)->getValue();
+      Worklist.insert(Worklist.end(), Info.Dependencies.begin(),
+                      Info.Dependencies.end());
+    }
+
+    llvm::outs() << Commands[I].Filename << ':';
+    for (const std::string &Key : Used) {
+      const ModuleInfo &Info = Modules.find(Key)->getValue();
+      if (Info.State == ModuleInfo::Built)
+        llvm::outs() << " -fmodule-file=" << Info.getModuleFilePath();
+    }
+    llvm::outs() << '\n';
+  }
+  return Failed;
+}
+
+int main(int argc, const char **argv) {
+  llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+  cl::HideUnrelatedOptions(ScanDepsCategory);
+  cl::ParseCommandLineOptions(argc, argv, "clang-scan-deps\n");
+
+  std::string ErrorMessage;
+  std::unique_ptr<CompilationDatabase> Compilations =
+      CompilationDatabase::loadFromDirectory(BuildPath, ErrorMessage);
+  if (!Compilations) {
+    llvm::errs() << "error: " << ErrorMessage << "\n";
+    return 1;
+  }
+
+  std::vector<CompileCommand> Commands;
+  if (SourcePaths.empty()) {
+    Commands = Compilations->getAllCompileCommands();
+  } else {
+    for (const std::string &SourcePath : SourcePaths) {
+      std::string File = getAbsolutePath(SourcePath);
+      std::vector<CompileCommand> CommandsForFile =
+          Compilations->getCompileCommands(File);
+      if (CommandsForFile.empty())
+        llvm::errs() << "Skipping " << File << ". Compile command not found.\n";
+      Commands.insert(Commands.end(), CommandsForFile.begin(),
+                      CommandsForFile.end());
+    }
+  }
+
+  // The builtin headers must match this tool, not whichever compiler the
+  // database names.
+  static int StaticSymbol;
+  std::string ResourceDir =
+      "-resource-dir=" +
+      CompilerInvocation::GetResourcesPath(argv[0], &StaticSymbol);
+
+  ArgumentsAdjuster Adjuster = combineAdjusters(
+      combineAdjusters(getClangStripOutputAdjuster(),
+                       getStripDependencyFileAdjuster()),
+      getClangSyntaxOnlyAdjuster());
+  Adjuster = combineAdjusters(
+      Adjuster, getInsertArgumentAdjuster(ResourceDir.c_str()));
+  // Headers are mapped to the modules owning them through the module maps,
+  // but are still entered textually so that every import is seen. '@import'
+  // declarations are left to the token stream, where ScanDepsAction finds
+  // them.
+  if (!ModuleFilesDir.empty())
+    Adjuster = combineAdjusters(
+        Adjuster, getInsertArgumentAdjuster(
+                      {"-fno-modules", "-fimplicit-module-maps"},
+                      ArgumentInsertPosition::END));
+
+  unsigned Threads = NumThreads;
+  if (Threads == 0)
+    Threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<ScanResult> Results(Commands.size());
+  runInParallel(Threads, Commands.size(), Adjuster,
+                [&](ScanDepsWorker &Worker, size_t Index) {
+                  Results[Index] = Worker.scan(Commands[Index]);
+                });
+
+  bool ScanningFailed = false;
+  for (unsigned I = 0, E = Results.size(); I != E; ++I) {
+    const ScanResult &Result = Results[I];
+    llvm::errs() << Result.Diagnostics;
+    if (!Result.Success) {
+      llvm::errs() << "Error while scanning dependencies of "
+                   << Commands[I].Filename << ".\n";
+      ScanningFailed = true;
+      continue;
+    }
+    if (ModuleFilesDir.empty())
+      printRule(llvm::outs(), Result);
+  }
+  if (!ModuleFilesDir.empty())
+    ScanningFailed |= buildModules(Commands, Results, Adjuster, Threads);
+  return ScanningFailed;
+}
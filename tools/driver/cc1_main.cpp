@@ -14,6 +14,7 @@
 //===----------------------------------------------------------------------===//
 
 #include "llvm/Option/Arg.h"
+#include "clang/Basic/TimeTrace.h"
 #include "clang/CodeGen/ObjectFilePCHContainerOperations.h"
 #include "clang/Driver/DriverDiagnostic.h"
 #include "clang/Driver/Options.h"
@@ -24,17 +25,33 @@
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Frontend/Utils.h"
 #include "clang/FrontendTool/Utils.h"
+#include "clang/Serialization/SharedModuleCache.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/LinkAllPasses.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/OptTable.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/ManagedStatic.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Signals.h"
+#include "llvm/Support/StringSaver.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
 #include <cstdio>
+#include <cstring>
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 using namespace clang;
 using namespace llvm::opt;
 
@@ -42,6 +59,10 @@ using namespace llvm::opt;
 // Main driver
 //===----------------------------------------------------------------------===//
 
+/// The status a job that stopped on a fatal error exits with, when it unwinds
+/// to ExecuteRecoverableCC1Job instead.
+static int FatalErrorStatus;
+
 static void LLVMErrorHandler(void *UserData, const std::string &Message,
                              bool GenCrashDiag) {
   DiagnosticsEngine &Diags = *static_cast<DiagnosticsEngine*>(UserData);
@@ -55,7 +76,12 @@ static void LLVMErrorHandler(void *UserData, const std::string &Message,
   // We cannot recover from llvm errors.  When reporting a fatal error, exit
   // with status 70 to generate crash diagnostics.  For BSD systems this is
   // defined as an internal software error.  Otherwise, exit with status 1.
-  exit(GenCrashDiag ? 70 : 1);
+  // A job that does not own its process stops with that status instead.
+  FatalErrorStatus = GenCrashDiag ? 70 : 1;
+  if (llvm::CrashRecoveryContext *CRC =
+          llvm::CrashRecoveryContext::GetCurrent())
+    CRC->HandleCrash();
+  exit(FatalErrorStatus);
 }
 
 #ifdef LINK_POLLY_INTO_TOOLS
@@ -64,16 +90,7 @@ void initializePollyPasses(llvm::PassRegistry &Registry);
 }
 #endif
 
-int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
-  std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
-  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
-
-  // Register the support for object-file-wrapped Clang modules.
-  auto PCHOps = Clang->getPCHContainerOperations();
-  PCHOps->registerWriter(llvm::make_unique<ObjectFilePCHContainerWriter>());
-  PCHOps->registerReader(llvm::make_unique<ObjectFilePCHContainerReader>());
-
-  // Initialize targets first, so that --version shows registered targets.
+static void InitializeTargets() {
   llvm::InitializeAllTargets();
   llvm::InitializeAllTargetMCs();
   llvm::InitializeAllAsmPrinters();
@@ -83,14 +100,57 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
   llvm::PassRegistry &Registry = *llvm::PassRegistry::getPassRegistry();
   polly::initializePollyPasses(Registry);
 #endif
+}
+
+/// Write the -ftime-trace output next to the output file, or into the current
+/// directory, named after the input, when writing to standard output.
+static void WriteTimeTrace(CompilerInstance &Clang) {
+  const FrontendOptions &Opts = Clang.getFrontendOpts();
+  SmallString<128> Path;
+  if (!Opts.OutputFile.empty() && Opts.OutputFile != "-")
+    Path = Opts.OutputFile;
+  else if (!Opts.Inputs.empty() && Opts.Inputs[0].isFile() &&
+           Opts.Inputs[0].getFile() != "-")
+    Path = llvm::sys::path::filename(Opts.Inputs[0].getFile());
+  else
+    Path = "stdin";
+  llvm::sys::path::replace_extension(Path, "json");
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_Text);
+  if (EC) {
+    Clang.getDiagnostics().Report(diag::err_fe_unable_to_open_output)
+        << Path << EC.message();
+    return;
+  }
+  writeTimeTrace(OS, "clang");
+}
+
+/// Run one -cc1 job. Jobs run by a compile server share \p ModuleCache and
+/// must free everything they allocate.
+static int ExecuteCC1Job(ArrayRef<const char *> Argv, const char *Argv0,
+                         void *MainAddr,
+                         serialization::SharedModuleCache *ModuleCache) {
+  std::unique_ptr<CompilerInstance> Clang(new CompilerInstance());
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID(new DiagnosticIDs());
+
+  // Register the support for object-file-wrapped Clang modules.
+  auto PCHOps = Clang->getPCHContainerOperations();
+  PCHOps->registerWriter(llvm::make_unique<ObjectFilePCHContainerWriter>());
+  PCHOps->registerReader(llvm::make_unique<ObjectFilePCHContainerReader>());
 
   // Buffer diagnostics from argument parsing so that we can output them using a
   // well formed diagnostic object.
   IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
   TextDiagnosticBuffer *DiagsBuffer = new TextDiagnosticBuffer;
   DiagnosticsEngine Diags(DiagID, &*DiagOpts, DiagsBuffer);
-  bool Success = CompilerInvocation::CreateFromArgs(
-      Clang->getInvocation(), Argv.begin(), Argv.end(), Diags);
+  // A server runs many jobs that differ only in their files, so it parses
+  // each set of flags once.
+  bool Success =
+      ModuleCache ? CompilerInvocation::CreateFromArgsCached(
+                        Clang->getInvocation(), Argv.begin(), Argv.end(), Diags)
+                  : CompilerInvocation::CreateFromArgs(
+                        Clang->getInvocation(), Argv.begin(), Argv.end(), Diags);
 
   // Infer the builtin include path if unspecified.
   if (Clang->getHeaderSearchOpts().UseBuiltinIncludes &&
@@ -109,11 +169,29 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
                                   static_cast<void*>(&Clang->getDiagnostics()));
 
   DiagsBuffer->FlushDiagnostics(Clang->getDiagnostics());
-  if (!Success)
+  if (!Success) {
+    llvm::remove_fatal_error_handler();
     return 1;
+  }
+
+  if (ModuleCache) {
+    Clang->setSharedModuleCache(ModuleCache);
+    Clang->getFrontendOpts().DisableFree = false;
+  }
+
+  if (Clang->getFrontendOpts().TimeTrace)
+    initTimeTrace(Clang->getFrontendOpts().TimeTraceGranularity);
 
   // Execute the frontend actions.
-  Success = ExecuteCompilerInvocation(Clang.get());
+  {
+    TimeTraceScope TimeScope("ExecuteCompiler");
+    Success = ExecuteCompilerInvocation(Clang.get());
+  }
+
+  if (Clang->getFrontendOpts().TimeTrace) {
+    WriteTimeTrace(*Clang);
+    cleanupTimeTrace();
+  }
 
   // If any timers were active but haven't been destroyed yet, print their
   // results now.  This happens in -disable-free mode.
@@ -132,3 +210,247 @@ int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
 
   return !Success;
 }
+
+/// Run one -cc1 job in a process that outlives it. A fatal error or a crash in
+/// the job unwinds back here. Returns the status the job would have exited
+/// with, or -1 for a crash.
+static int
+ExecuteRecoverableCC1Job(ArrayRef<const char *> Argv, const char *Argv0,
+                         void *MainAddr,
+                         serialization::SharedModuleCache *ModuleCache) {
+  int Res = 1;
+  FatalErrorStatus = -1;
+  llvm::CrashRecoveryContext CRC;
+  if (CRC.RunSafely(
+          [&]() { Res = ExecuteCC1Job(Argv, Argv0, MainAddr, ModuleCache); }))
+    return Res;
+
+  // The job did not get to uninstall its error handler.
+  llvm::remove_fatal_error_handler();
+  return FatalErrorStatus;
+}
+
+int cc1_main(ArrayRef<const char *> Argv, const char *Argv0, void *MainAddr) {
+  // Initialize targets first, so that --version shows registered targets.
+  InitializeTargets();
+
+  // The driver runs the job in its own process with -fintegrated-cc1, and
+  // still has to report a fatal error and clean up afterwards.
+  if (llvm::CrashRecoveryContext::GetCurrent())
+    return ExecuteRecoverableCC1Job(Argv, Argv0, MainAddr,
+                                    /*ModuleCache=*/nullptr);
+  return ExecuteCC1Job(Argv, Argv0, MainAddr, /*ModuleCache=*/nullptr);
+}
+
+/// Run one -cc1 job for a compile server. The -mllvm options of earlier jobs
+/// are reset first, and a fatal error or crash only ends the job.
+static int ExecuteServedCC1Job(ArrayRef<const char *> Argv, const char *Argv0,
+                               void *MainAddr,
+                               serialization::SharedModuleCache *ModuleCache) {
+  llvm::cl::ResetAllOptionOccurrences();
+  return ExecuteRecoverableCC1Job(Argv, Argv0, MainAddr, ModuleCache);
+}
+
+/// Read one line from standard input into \p Line, without its newline.
+/// Returns false at the end of the input.
+static bool ReadJobLine(std::string &Line) {
+  Line.clear();
+  int C;
+  while ((C = std::getchar()) != EOF && C != '\n')
+    Line += static_cast<char>(C);
+  return C != EOF || !Line.empty();
+}
+
+#ifdef LLVM_ON_UNIX
+/// Read from \p FD into \p Data until the end of the input.
+static bool ReadAll(int FD, std::string &Data) {
+  char Buffer[4096];
+  for (;;) {
+    ssize_t N = ::read(FD, Buffer, sizeof(Buffer));
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return N == 0;
+    Data.append(Buffer, N);
+  }
+}
+
+/// Write all of \p Data to \p FD.
+static bool WriteAll(int FD, StringRef Data) {
+  while (!Data.empty()) {
+    ssize_t N = ::write(FD, Data.data(), Data.size());
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    Data = Data.drop_front(N);
+  }
+  return true;
+}
+
+/// Run a -cc1 job with its standard output and error redirected to temporary
+/// files, and read what it wrote into \p Output and \p Errors.
+static int ExecuteCapturedCC1Job(ArrayRef<const char *> Argv,
+                                 const char *Argv0, void *MainAddr,
+                                 serialization::SharedModuleCache *ModuleCache,
+                                 std::string &Output, std::string &Errors) {
+  int OutFD, ErrFD;
+  SmallString<128> OutPath, ErrPath;
+  if (llvm::sys::fs::createTemporaryFile("cc1serve", "out", OutFD, OutPath))
+    return 1;
+  if (llvm::sys::fs::createTemporaryFile("cc1serve", "err", ErrFD, ErrPath)) {
+    ::close(OutFD);
+    llvm::sys::fs::remove(OutPath);
+    return 1;
+  }
+
+  llvm::outs().flush();
+  std::fflush(stdout);
+  std::fflush(stderr);
+  int SavedOut = ::dup(1), SavedErr = ::dup(2);
+  ::dup2(OutFD, 1);
+  ::dup2(ErrFD, 2);
+  ::close(OutFD);
+  ::close(ErrFD);
+
+  int Status = ExecuteServedCC1Job(Argv, Argv0, MainAddr, ModuleCache);
+
+  llvm::outs().flush();
+  std::fflush(stdout);
+  std::fflush(stderr);
+  ::dup2(SavedOut, 1);
+  ::dup2(SavedErr, 2);
+  ::close(SavedOut);
+  ::close(SavedErr);
+
+  if (auto Buffer = llvm::MemoryBuffer::getFile(OutPath))
+    Output = (*Buffer)->getBuffer();
+  if (auto Buffer = llvm::MemoryBuffer::getFile(ErrPath))
+    Errors = (*Buffer)->getBuffer();
+  llvm::sys::fs::remove(OutPath);
+  llvm::sys::fs::remove(ErrPath);
+  return Status;
+}
+
+/// Serve -cc1 jobs on the Unix domain socket \p Path, one per connection.
+///
+/// A client sends its working directory and the job, quoted like a response
+/// file, on two lines, and shuts down its end. The server answers with
+/// "exit <status> <output size> <error size>" on one line, followed by what
+/// the job wrote to its standard output and error. It also writes
+/// "exit <status>" to its own standard output, as for jobs on standard input.
+///
+/// Jobs run one at a time, since each changes the working directory and the
+/// standard output and error of the whole process. Other clients wait in the
+/// listen backlog until the job in progress ends.
+static int ServeOnSocket(StringRef Path, const char *Argv0, void *MainAddr,
+                         serialization::SharedModuleCache *ModuleCache) {
+  sockaddr_un Addr;
+  std::memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Addr.sun_path)) {
+    llvm::errs() << "error: socket path '" << Path << "' is too long\n";
+    return 1;
+  }
+  std::memcpy(Addr.sun_path, Path.data(), Path.size());
+
+  int Listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  ::unlink(Addr.sun_path);
+  if (Listener < 0 ||
+      ::bind(Listener, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) ||
+      ::listen(Listener, SOMAXCONN)) {
+    llvm::errs() << "error: cannot listen on '" << Path
+                 << "': " << std::strerror(errno) << "\n";
+    return 1;
+  }
+
+  for (;;) {
+    int Conn = ::accept(Listener, nullptr, nullptr);
+    if (Conn < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    std::string Request;
+    if (ReadAll(Conn, Request)) {
+      StringRef Dir, Line;
+      std::tie(Dir, Line) = StringRef(Request).split('\n');
+
+      llvm::BumpPtrAllocator Alloc;
+      llvm::StringSaver Saver(Alloc);
+      SmallVector<const char *, 64> JobArgv;
+      llvm::cl::TokenizeGNUCommandLine(Line, Saver, JobArgv);
+
+      int Status = 1;
+      std::string Output, Errors;
+      if (::chdir(Saver.save(Dir).data()) == 0)
+        Status = ExecuteCapturedCC1Job(JobArgv, Argv0, MainAddr, ModuleCache,
+                                       Output, Errors);
+      else
+        Errors = "error: cannot change to directory '" + Dir.str() + "'\n";
+
+      std::string Header = "exit " + std::to_string(Status) + " " +
+                           std::to_string(Output.size()) + " " +
+                           std::to_string(Errors.size()) + "\n";
+      WriteAll(Conn, Header) && WriteAll(Conn, Output) &&
+          WriteAll(Conn, Errors);
+      llvm::outs() << "exit " << Status << "\n";
+      llvm::outs().flush();
+    }
+    ::close(Conn);
+  }
+  ::close(Listener);
+  return 1;
+}
+#endif
+
+/// The entry point of clang -cc1serve, a compile server running -cc1 jobs
+/// read from standard input one per line, quoted like a response file.
+///
+/// After each job the server writes "exit <status>" to standard output, or
+/// "exit -1" if the job crashed. A fatal error or crash ends only the job; the
+/// -mllvm options each job sets are reset before the next one. All jobs share
+/// the contents of the AST files they load, so a module imported by many jobs
+/// is kept in memory once; it is validated again (against the contents of the
+/// file and the imported module's signature) each time it is loaded. Standard
+/// input and output can be connected to a socket to serve a build over the
+/// network.
+///
+/// With "-socket <path>", the server instead accepts jobs on a Unix domain
+/// socket, which is what the driver's -fcompile-server option connects to.
+/// It still runs one job at a time.
+int cc1serve_main(ArrayRef<const char *> Argv, const char *Argv0,
+                  void *MainAddr) {
+  InitializeTargets();
+  llvm::CrashRecoveryContext::Enable();
+
+  IntrusiveRefCntPtr<serialization::SharedModuleCache> ModuleCache(
+      new serialization::SharedModuleCache());
+
+  if (Argv.size() == 2 && StringRef(Argv[0]) == "-socket") {
+#ifdef LLVM_ON_UNIX
+    return ServeOnSocket(Argv[1], Argv0, MainAddr, ModuleCache.get());
+#else
+    llvm::errs() << "error: -socket is not supported on this host\n";
+    return 1;
+#endif
+  }
+
+  std::string Line;
+  while (ReadJobLine(Line)) {
+    if (StringRef(Line).trim().empty())
+      continue;
+
+    llvm::BumpPtrAllocator Alloc;
+    llvm::StringSaver Saver(Alloc);
+    SmallVector<const char *, 64> JobArgv;
+    llvm::cl::TokenizeGNUCommandLine(Line, Saver, JobArgv);
+
+    int Status =
+        ExecuteServedCC1Job(JobArgv, Argv0, MainAddr, ModuleCache.get());
+    llvm::outs() << "exit " << Status << "\n";
+    llvm::outs().flush();
+  }
+  return 0;
+}
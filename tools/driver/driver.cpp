@@ -33,6 +33,7 @@
 #include "llvm/Option/OptTable.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
@@ -48,8 +49,15 @@
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include <cstring>
 #include <memory>
 #include <system_error>
+#ifdef LLVM_ON_UNIX
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 using namespace clang;
 using namespace clang::driver;
 using namespace llvm::opt;
@@ -200,6 +208,8 @@ extern int cc1_main(ArrayRef<const char *> Argv, const char *Argv0,
                     void *MainAddr);
 extern int cc1as_main(ArrayRef<const char *> Argv, const char *Argv0,
                       void *MainAddr);
+extern int cc1serve_main(ArrayRef<const char *> Argv, const char *Argv0,
+                         void *MainAddr);
 
 static void insertTargetAndModeArgs(StringRef Target, StringRef Mode,
                                     SmallVectorImpl<const char *> &ArgVector,
@@ -301,12 +311,125 @@ static int ExecuteCC1Tool(ArrayRef<const char *> argv, StringRef Tool) {
     return cc1_main(argv.slice(2), argv[0], GetExecutablePathVP);
   if (Tool == "as")
     return cc1as_main(argv.slice(2), argv[0], GetExecutablePathVP);
+  if (Tool == "serve")
+    return cc1serve_main(argv.slice(2), argv[0], GetExecutablePathVP);
 
   // Reject unknown tools.
   llvm::errs() << "error: unknown integrated tool '" << Tool << "'\n";
   return 1;
 }
 
+/// Runs a -cc1 job of the driver in the driver's process.
+static int ExecuteCC1Main(ArrayRef<const char *> argv) {
+  return ExecuteCC1Tool(argv, argv[1] + 4);
+}
+
+#ifdef LLVM_ON_UNIX
+/// The socket of the compile server given with -fcompile-server.
+static std::string CompileServerPath;
+
+/// Sends a -cc1 job to the compile server, and prints what the job wrote.
+/// Returns false if the server cannot be reached.
+static bool ExecuteOnCompileServer(ArrayRef<const char *> argv, int &Res) {
+  sockaddr_un Addr;
+  std::memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (CompileServerPath.size() >= sizeof(Addr.sun_path))
+    return false;
+  std::memcpy(Addr.sun_path, CompileServerPath.data(),
+              CompileServerPath.size());
+
+  int FD = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (FD < 0)
+    return false;
+  if (::connect(FD, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr))) {
+    ::close(FD);
+    return false;
+  }
+
+  // The working directory, and the arguments after -cc1 quoted like a
+  // response file.
+  SmallString<128> Dir;
+  llvm::sys::fs::current_path(Dir);
+  std::string Request = Dir.str().str() + "\n";
+  for (const char *Arg : argv.slice(2)) {
+    Request += '"';
+    for (const char *C = Arg; *C; ++C) {
+      if (*C == '"' || *C == '\\')
+        Request += '\\';
+      Request += *C;
+    }
+    Request += "\" ";
+  }
+  Request += "\n";
+
+  StringRef Data = Request;
+  while (!Data.empty()) {
+    ssize_t N = ::write(FD, Data.data(), Data.size());
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0) {
+      ::close(FD);
+      return false;
+    }
+    Data = Data.drop_front(N);
+  }
+  ::shutdown(FD, SHUT_WR);
+
+  std::string Response;
+  char Buffer[4096];
+  for (;;) {
+    ssize_t N = ::read(FD, Buffer, sizeof(Buffer));
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      break;
+    Response.append(Buffer, N);
+  }
+  ::close(FD);
+
+  // A server that stops in the middle of a job crashed running it.
+  Res = -1;
+  StringRef Header, Rest;
+  std::tie(Header, Rest) = StringRef(Response).split('\n');
+  SmallVector<StringRef, 4> Fields;
+  Header.split(Fields, ' ');
+  size_t OutputSize, ErrorsSize;
+  if (Fields.size() != 4 || Fields[0] != "exit" ||
+      Fields[1].getAsInteger(10, Res) ||
+      Fields[2].getAsInteger(10, OutputSize) ||
+      Fields[3].getAsInteger(10, ErrorsSize) ||
+      Rest.size() != OutputSize + ErrorsSize)
+    Res = -1;
+  else {
+    llvm::outs() << Rest.take_front(OutputSize);
+    llvm::outs().flush();
+    llvm::errs() << Rest.drop_front(OutputSize);
+  }
+  return true;
+}
+
+/// Runs a -cc1 job of the driver on the compile server, or in a new process if
+/// the server cannot be reached.
+static int ExecuteCC1OnServer(ArrayRef<const char *> argv) {
+  int Res;
+  if (ExecuteOnCompileServer(argv, Res))
+    return Res;
+
+  SmallVector<const char *, 128> Args(argv.begin(), argv.end());
+  Args.push_back(nullptr);
+  std::string ErrMsg;
+  bool ExecutionFailed;
+  Res = llvm::sys::ExecuteAndWait(argv[0], Args.data(), /*env*/ nullptr,
+                                  /*redirects*/ nullptr, /*secondsToWait*/ 0,
+                                  /*memoryLimit*/ 0, &ErrMsg,
+                                  &ExecutionFailed);
+  if (!ErrMsg.empty())
+    llvm::errs() << "error: " << ErrMsg << "\n";
+  return ExecutionFailed ? 1 : Res;
+}
+#endif
+
 int main(int argc_, const char **argv_) {
   llvm::sys::PrintStackTraceOnErrorSignal(argv_[0]);
   llvm::PrettyStackTraceProgram X(argc_, argv_);
@@ -456,6 +579,27 @@ int main(int argc_, const char **argv_) {
   SetBackdoorDriverOutputsFromEnvVars(TheDriver);
 
   std::unique_ptr<Compilation> C(TheDriver.BuildCompilation(argv));
+
+  // Compile jobs can run on a warm compile server, and a compilation that is a
+  // single compile job can run it in this process, without the cost of
+  // starting a new one.
+  if (C) {
+    if (const Arg *A =
+            C->getArgs().getLastArg(options::OPT_fcompile_server_EQ)) {
+#ifdef LLVM_ON_UNIX
+      CompileServerPath = A->getValue();
+      TheDriver.CC1Main = &ExecuteCC1OnServer;
+#else
+      (void)A;
+#endif
+    } else if (C->getArgs().hasFlag(options::OPT_fintegrated_cc1,
+                                    options::OPT_fno_integrated_cc1, false) &&
+               C->getJobs().size() == 1) {
+      llvm::CrashRecoveryContext::Enable();
+      TheDriver.CC1Main = &ExecuteCC1Main;
+    }
+  }
+
   int Res = 0;
   SmallVector<std::pair<int, const Command *>, 4> FailingCommands;
   if (C.get())
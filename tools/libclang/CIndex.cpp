@@ -512,6 +512,12 @@ bool CursorVisitor::VisitChildren(CXCursor Cursor) {
   }
 
   if (clang_isTranslationUnit(Cursor.kind)) {
+    // The declarations overlapping a region of interest can be found through
+    // the file-level declarations of its file, without walking (and
+    // deserializing) every declaration of the translation unit.
+    if (RegionOfInterest.isValid())
+      return visitFileRegion();
+
     CXTranslationUnit TU = getCursorTU(Cursor);
     ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
     
@@ -1915,6 +1921,7 @@ public:
   void VisitGotoStmt(const GotoStmt *GS);
   void VisitIfStmt(const IfStmt *If);
   void VisitInitListExpr(const InitListExpr *IE);
+  void VisitPackedArrayInitExpr(const PackedArrayInitExpr *E);
   void VisitMemberExpr(const MemberExpr *M);
   void VisitOffsetOfExpr(const OffsetOfExpr *E);
   void VisitObjCEncodeExpr(const ObjCEncodeExpr *E);
@@ -2465,6 +2472,10 @@ void EnqueueVisitor::VisitInitListExpr(const InitListExpr *IE) {
     IE = Syntactic;
   EnqueueChildren(IE);
 }
+void EnqueueVisitor::VisitPackedArrayInitExpr(const PackedArrayInitExpr *E) {
+  // The packed values stand for the initializer list as written.
+  EnqueueChildren(E->getSyntacticForm());
+}
 void EnqueueVisitor::VisitMemberExpr(const MemberExpr *M) {
   WL.push_back(MemberExprParts(M, Parent));
   
@@ -3066,11 +3077,15 @@ CXIndex clang_createIndex(int excludeDeclarationsFromPCH,
   // registered once.
   (void)*RegisterFatalErrorHandlerOnce;
 
-  // Initialize targets for clang module support.
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmPrinters();
-  llvm::InitializeAllAsmParsers();
+  // Initialize targets for clang module support. Indexes may be created on
+  // several threads at once, and registering the targets is not thread-safe.
+  static std::once_flag InitializeTargetsOnce;
+  std::call_once(InitializeTargetsOnce, [] {
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmPrinters();
+    llvm::InitializeAllAsmParsers();
+  });
 
   CIndexer *CIdxr = new CIndexer();
 
@@ -3126,6 +3141,14 @@ CXTranslationUnit clang_createTranslationUnit(CXIndex CIdx,
 enum CXErrorCode clang_createTranslationUnit2(CXIndex CIdx,
                                               const char *ast_filename,
                                               CXTranslationUnit *out_TU) {
+  return clang_createTranslationUnitWithOptions(
+      CIdx, ast_filename, CXLoadTranslationUnit_None, out_TU);
+}
+
+enum CXErrorCode
+clang_createTranslationUnitWithOptions(CXIndex CIdx, const char *ast_filename,
+                                       unsigned options,
+                                       CXTranslationUnit *out_TU) {
   if (out_TU)
     *out_TU = nullptr;
 
@@ -3133,7 +3156,7 @@ enum CXErrorCode clang_createTranslationUnit2(CXIndex CIdx,
     return CXError_InvalidArguments;
 
   LOG_FUNC_SECTION {
-    *Log << ast_filename;
+    *Log << ast_filename << ", options=" << options;
   }
 
   CIndexer *CXXIdx = static_cast<CIndexer *>(CIdx);
@@ -3147,7 +3170,9 @@ enum CXErrorCode clang_createTranslationUnit2(CXIndex CIdx,
       CXXIdx->getOnlyLocalDecls(), None,
       /*CaptureDiagnostics=*/true,
       /*AllowPCHWithCompilerErrors=*/true,
-      /*UserFilesAreVolatile=*/true);
+      /*UserFilesAreVolatile=*/true,
+      /*DisableValidation=*/
+      options & CXLoadTranslationUnit_SkipInputValidation);
   *out_TU = MakeCXTranslationUnit(CXXIdx, AU.release());
   return *out_TU ? CXError_Success : CXError_Failure;
 }
@@ -3285,7 +3310,7 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
       /*AllowPCHWithCompilerErrors=*/true, SkipFunctionBodies,
       /*UserFilesAreVolatile=*/true, ForSerialization,
       CXXIdx->getPCHContainerOperations()->getRawReader().getFormat(),
-      &ErrUnit));
+      &ErrUnit, CXXIdx->getSharedSystemHeaderStats()));
 
   // Early failures in LoadFromCommandLine may return with ErrUnit unset.
   if (!Unit && !ErrUnit)
@@ -3300,6 +3325,9 @@ clang_parseTranslationUnit_Impl(CXIndex CIdx, const char *source_filename,
   if (isASTReadError(Unit ? Unit.get() : ErrUnit.get()))
     return CXError_ASTReadError;
 
+  if (Unit && (options & CXTranslationUnit_ChainedPreamble))
+    Unit->setChainPreambles(true);
+
   *out_TU = MakeCXTranslationUnit(CXXIdx, Unit.release());
   return *out_TU ? CXError_Success : CXError_Failure;
 }
@@ -4040,6 +4068,78 @@ unsigned clang_visitChildren(CXCursor parent,
   return CursorVis.VisitChildren(parent);
 }
 
+unsigned clang_visitChildrenInRange(CXCursor parent,
+                                    CXSourceRange range,
+                                    CXCursorVisitor visitor,
+                                    CXClientData client_data) {
+  if (clang_Range_isNull(range))
+    return clang_visitChildren(parent, visitor, client_data);
+
+  CursorVisitor CursorVis(getCursorTU(parent), visitor, client_data,
+                          /*VisitPreprocessorLast=*/false,
+                          /*VisitIncludedPreprocessingEntries=*/false,
+                          cxloc::translateCXSourceRange(range));
+  return CursorVis.VisitChildren(parent);
+}
+
+namespace {
+struct CursorDescendants {
+  SmallVector<CXCursor, 64> Cursors;
+  SmallVector<unsigned, 64> ParentIndices;
+  /// The indices of the ancestors of the cursor visited last, and the cursor
+  /// itself.
+  SmallVector<unsigned, 16> Path;
+};
+} // end anonymous namespace
+
+static enum CXChildVisitResult collectDescendant(CXCursor Cursor,
+                                                 CXCursor Parent,
+                                                 CXClientData ClientData) {
+  CursorDescendants &D = *static_cast<CursorDescendants *>(ClientData);
+  // The visitor goes depth-first, so the parent is on the path to the cursor
+  // visited last.
+  while (D.Path.size() > 1 &&
+         !clang_equalCursors(D.Cursors[D.Path.back()], Parent))
+    D.Path.pop_back();
+  D.ParentIndices.push_back(D.Path.back());
+  D.Path.push_back(D.Cursors.size());
+  D.Cursors.push_back(Cursor);
+  return CXChildVisit_Recurse;
+}
+
+void clang_getCursorDescendants(CXCursor parent, CXCursor **cursors,
+                                unsigned **parent_indices,
+                                unsigned *num_cursors) {
+  if (cursors)
+    *cursors = nullptr;
+  if (parent_indices)
+    *parent_indices = nullptr;
+  if (num_cursors)
+    *num_cursors = 0;
+  if (!cursors || !parent_indices || !num_cursors ||
+      clang_Cursor_isNull(parent))
+    return;
+
+  CursorDescendants D;
+  D.Cursors.push_back(parent);
+  D.ParentIndices.push_back(0);
+  D.Path.push_back(0);
+  clang_visitChildren(parent, collectDescendant, &D);
+
+  *cursors = (CXCursor *)malloc(sizeof(CXCursor) * D.Cursors.size());
+  memcpy(*cursors, D.Cursors.data(), sizeof(CXCursor) * D.Cursors.size());
+  *parent_indices = (unsigned *)malloc(sizeof(unsigned) * D.Cursors.size());
+  memcpy(*parent_indices, D.ParentIndices.data(),
+         sizeof(unsigned) * D.Cursors.size());
+  *num_cursors = D.Cursors.size();
+}
+
+void clang_disposeCursorDescendants(CXCursor *cursors,
+                                    unsigned *parent_indices) {
+  free(cursors);
+  free(parent_indices);
+}
+
 #ifndef __has_feature
 #define __has_feature(x) 0
 #endif
@@ -6145,6 +6245,39 @@ void clang_disposeTokens(CXTranslationUnit TU,
   free(Tokens);
 }
 
+void clang_getTokenInfos(CXTranslationUnit TU, const CXToken *Tokens,
+                         unsigned NumTokens, CXTokenInfo *Infos) {
+  if (!Infos)
+    return;
+  memset(Infos, 0, sizeof(CXTokenInfo) * NumTokens);
+
+  if (isNotUsableTU(TU)) {
+    LOG_BAD_TU(TU);
+    return;
+  }
+
+  ASTUnit *CXXUnit = cxtu::getASTUnit(TU);
+  if (!CXXUnit || !Tokens)
+    return;
+
+  ASTUnit::ConcurrencyCheck Check(*CXXUnit);
+
+  // The tokens of clang_tokenize() are in order within a file, so the line
+  // lookups mostly hit the SourceManager's cache of the last line.
+  SourceManager &SM = CXXUnit->getSourceManager();
+  for (unsigned I = 0; I != NumTokens; ++I) {
+    SourceLocation Loc =
+        SourceLocation::getFromRawEncoding(Tokens[I].int_data[1]);
+    std::pair<FileID, unsigned> LocInfo = SM.getDecomposedSpellingLoc(Loc);
+    CXTokenInfo &Info = Infos[I];
+    Info.kind = clang_getTokenKind(Tokens[I]);
+    Info.offset = LocInfo.second;
+    Info.length = Tokens[I].int_data[2];
+    Info.line = SM.getLineNumber(LocInfo.first, LocInfo.second);
+    Info.column = SM.getColumnNumber(LocInfo.first, LocInfo.second);
+  }
+}
+
 } // end: extern "C"
 
 //===----------------------------------------------------------------------===//
@@ -30,6 +30,7 @@
 #include "clang/Sema/Sema.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Allocator.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -652,6 +653,7 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
                           ArrayRef<CXUnsavedFile> unsaved_files,
                           unsigned options) {
   bool IncludeBriefComments = options & CXCodeComplete_IncludeBriefComments;
+  bool FilterByTypedText = options & CXCodeComplete_FilterByTypedText;
 
 #ifdef UDP_CODE_COMPLETION_LOGGER
 #ifdef UDP_CODE_COMPLETION_LOGGER_PORT
@@ -698,13 +700,14 @@ clang_codeCompleteAt_Impl(CXTranslationUnit TU, const char *complete_filename,
   // Create a code-completion consumer to capture the results.
   CodeCompleteOptions Opts;
   Opts.IncludeBriefComments = IncludeBriefComments;
+  Opts.FilterByTypedText = FilterByTypedText;
   CaptureCompletionResults Capture(Opts, *Results, &TU);
 
   // Perform completion.
   AST->CodeComplete(complete_filename, complete_line, complete_column,
                     RemappedFiles, (options & CXCodeComplete_IncludeMacros),
                     (options & CXCodeComplete_IncludeCodePatterns),
-                    IncludeBriefComments, Capture,
+                    IncludeBriefComments, FilterByTypedText, Capture,
                     CXXIdx->getPCHContainerOperations(), *Results->Diag,
                     Results->LangOpts, *Results->SourceMgr, *Results->FileMgr,
                     Results->Diagnostics, Results->TemporaryBuffers);
@@ -963,17 +966,11 @@ static StringRef GetTypedName(CodeCompletionString *String,
 
 namespace {
   struct OrderCompletionResults {
-    bool operator()(const CXCompletionResult &XR, 
-                    const CXCompletionResult &YR) const {
-      CodeCompletionString *X
-        = (CodeCompletionString *)XR.CompletionString;
-      CodeCompletionString *Y
-        = (CodeCompletionString *)YR.CompletionString;
-      
-      SmallString<256> XBuffer;
-      StringRef XText = GetTypedName(X, XBuffer);
-      SmallString<256> YBuffer;
-      StringRef YText = GetTypedName(Y, YBuffer);
+    ArrayRef<StringRef> TypedNames;
+
+    bool operator()(unsigned X, unsigned Y) const {
+      StringRef XText = TypedNames[X];
+      StringRef YText = TypedNames[Y];
       
       if (XText.empty() || YText.empty())
         return !XText.empty();
@@ -993,6 +990,31 @@ namespace {
 extern "C" {
   void clang_sortCodeCompletionResults(CXCompletionResult *Results,
                                        unsigned NumResults) {
-    std::stable_sort(Results, Results + NumResults, OrderCompletionResults());
+    // Compute the typed name of each result once, rather than twice per
+    // comparison.
+    llvm::BumpPtrAllocator NameAllocator;
+    std::vector<StringRef> TypedNames(NumResults);
+    for (unsigned I = 0; I != NumResults; ++I) {
+      SmallString<256> Buffer;
+      StringRef Name = GetTypedName(
+          (CodeCompletionString *)Results[I].CompletionString, Buffer);
+      if (!Buffer.empty()) {
+        char *Copy = NameAllocator.Allocate<char>(Name.size());
+        std::copy(Name.begin(), Name.end(), Copy);
+        Name = StringRef(Copy, Name.size());
+      }
+      TypedNames[I] = Name;
+    }
+
+    std::vector<unsigned> Order(NumResults);
+    for (unsigned I = 0; I != NumResults; ++I)
+      Order[I] = I;
+    std::stable_sort(Order.begin(), Order.end(),
+                     OrderCompletionResults{TypedNames});
+
+    std::vector<CXCompletionResult> Sorted(NumResults);
+    for (unsigned I = 0; I != NumResults; ++I)
+      Sorted[I] = Results[Order[I]];
+    std::copy(Sorted.begin(), Sorted.end(), Results);
   }
 }
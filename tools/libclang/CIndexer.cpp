@@ -43,11 +43,7 @@
 
 using namespace clang;
 
-const std::string &CIndexer::getClangResourcesPath() {
-  // Did we already compute the path?
-  if (!ResourcesPath.empty())
-    return ResourcesPath;
-
+static std::string computeClangResourcesPath() {
   SmallString<128> LibClangPath;
 
   // Find the location where this library lives (libclang.dylib).
@@ -80,8 +76,12 @@ const std::string &CIndexer::getClangResourcesPath() {
 #endif
 
   llvm::sys::path::append(LibClangPath, "clang", CLANG_VERSION_STRING);
+  return LibClangPath.str();
+}
 
-  // Cache our result.
-  ResourcesPath = LibClangPath.str();
+const std::string &CIndexer::getClangResourcesPath() {
+  // Compute the path once and cache it; several threads may ask at once.
+  std::call_once(ResourcesPathOnce,
+                 [this] { ResourcesPath = computeClangResourcesPath(); });
   return ResourcesPath;
 }
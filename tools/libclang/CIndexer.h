@@ -16,10 +16,13 @@
 #define LLVM_CLANG_TOOLS_LIBCLANG_CINDEXER_H
 
 #include "clang-c/Index.h"
+#include "clang/Basic/FileSystemStatCache.h"
 #include "clang/Frontend/PCHContainerOperations.h"
 #include "clang/Lex/ModuleLoader.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Path.h"
+#include <atomic>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -35,14 +38,24 @@ class SourceLocation;
 class Token;
 class IdentifierInfo;
 
+/// \brief The state behind a CXIndex.
+///
+/// Translation units of the same index may be created and used on different
+/// threads at the same time, so everything here that is not set up by
+/// clang_createIndex() must be safe to use from several threads.
 class CIndexer {
   bool OnlyLocalDecls;
   bool DisplayDiagnostics;
-  unsigned Options; // CXGlobalOptFlags.
+  std::atomic<unsigned> Options; // CXGlobalOptFlags.
 
+  std::once_flag ResourcesPathOnce;
   std::string ResourcesPath;
   std::shared_ptr<PCHContainerOperations> PCHContainerOps;
 
+  /// \brief The stats of system headers shared by the translation units of
+  /// this index, with CXGlobalOpt_ShareSystemHeaderStats.
+  SharedStatResults SystemHeaderStats;
+
 public:
   CIndexer(std::shared_ptr<PCHContainerOperations> PCHContainerOps =
                std::make_shared<PCHContainerOperations>())
@@ -72,6 +85,13 @@ public:
     return Options & opt;
   }
 
+  /// \brief The stat results of system headers that translation units
+  /// parsed now should share, or null if they should not share them.
+  SharedStatResults *getSharedSystemHeaderStats() {
+    return isOptEnabled(CXGlobalOpt_ShareSystemHeaderStats) ? &SystemHeaderStats
+                                                            : nullptr;
+  }
+
   /// \brief Get the path of the clang resource files.
   const std::string &getClangResourcesPath();
 };
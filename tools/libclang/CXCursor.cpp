@@ -361,6 +361,7 @@ CXCursor cxcursor::MakeCXCursor(const Stmt *S, const Decl *Parent,
     break;
 
   case Stmt::InitListExprClass:
+  case Stmt::PackedArrayInitExprClass:
     K = CXCursor_InitListExpr;
     break;
 
@@ -13,6 +13,7 @@
 #include "CXCursor.h"
 #include "Index_Internal.h"
 #include "clang/Index/IndexDataConsumer.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/AST/DeclGroup.h"
 #include "clang/AST/DeclObjC.h"
 #include "llvm/ADT/DenseSet.h"
@@ -274,12 +275,22 @@ public:
   }
 };
 
+/// \brief Knows which declarations of headers were already indexed by an
+/// earlier translation unit of an indexing session.
+class SessionIndexedDecls {
+public:
+  virtual ~SessionIndexedDecls() {}
+
+  virtual bool isIndexed(const Decl *D) = 0;
+};
+
 class CXIndexDataConsumer : public index::IndexDataConsumer {
   ASTContext *Ctx;
   CXClientData ClientData;
   IndexerCallbacks &CB;
   unsigned IndexOptions;
   CXTranslationUnit CXTU;
+  SessionIndexedDecls *IndexedDecls;
   
   typedef llvm::DenseMap<const FileEntry *, CXIdxClientFile> FileMapTy;
   typedef llvm::DenseMap<const DeclContext *, CXIdxClientContainer>
@@ -293,6 +304,9 @@ class CXIndexDataConsumer : public index::IndexDataConsumer {
   typedef std::pair<const FileEntry *, const Decl *> RefFileOccurrence;
   llvm::DenseSet<RefFileOccurrence> RefFileOccurrences;
 
+  /// \brief The USRs of the entities, which are asked for at every reference.
+  index::USRCache USRs;
+
   llvm::BumpPtrAllocator StrScratch;
   unsigned StrAdapterCount;
   friend class ScratchAlloc;
@@ -336,7 +350,7 @@ public:
   CXIndexDataConsumer(CXClientData clientData, IndexerCallbacks &indexCallbacks,
                   unsigned indexOptions, CXTranslationUnit cxTU)
     : Ctx(nullptr), ClientData(clientData), CB(indexCallbacks),
-      IndexOptions(indexOptions), CXTU(cxTU),
+      IndexOptions(indexOptions), CXTU(cxTU), IndexedDecls(nullptr),
       StrScratch(), StrAdapterCount(0) { }
 
   ASTContext &getASTContext() const { return *Ctx; }
@@ -345,6 +359,11 @@ public:
   void setASTContext(ASTContext &ctx);
   void setPreprocessor(Preprocessor &PP);
 
+  /// \brief Skip the declarations that \p Indexed reports as already indexed.
+  void setSessionIndexedDecls(SessionIndexedDecls *Indexed) {
+    IndexedDecls = Indexed;
+  }
+
   bool shouldSuppressRefs() const {
     return IndexOptions & CXIndexOpt_SuppressRedundantRefs;
   }
@@ -471,6 +490,10 @@ private:
                              index::SymbolRoleSet Roles,
                              FileID FID, unsigned Offset) override;
 
+  bool shouldSkipDecl(const Decl *D) override {
+    return IndexedDecls && IndexedDecls->isIndexed(D);
+  }
+
   void finish() override;
 
   bool handleDecl(const NamedDecl *D,
@@ -27,11 +27,13 @@
 #include "clang/Lex/PPConditionalDirectiveRecord.h"
 #include "clang/Lex/Preprocessor.h"
 #include "clang/Sema/SemaConsumer.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/Support/CrashRecoveryContext.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/Mutex.h"
 #include "llvm/Support/MutexGuard.h"
 #include <cstdio>
+#include <map>
 #include <utility>
 
 using namespace clang;
@@ -218,6 +220,47 @@ private:
   }
 };
 
+//===----------------------------------------------------------------------===//
+// Skip Indexed Headers
+//===----------------------------------------------------------------------===//
+
+/// \brief Skips the namespace-scope declarations of headers in regions that an
+/// earlier translation unit of the session indexed.
+///
+/// The regions are the same as the ones of skipped bodies, but tracked apart
+/// for each preprocessor context, since a region whose body was parsed may
+/// still not have been indexed.
+class TUSkipIndexedControl : public SessionIndexedDecls {
+  TUSkipBodyControl Regions;
+  const SourceManager &SM;
+
+public:
+  TUSkipIndexedControl(SessionSkipBodyData &sessionData,
+                       PPConditionalDirectiveRecord &ppRec, Preprocessor &pp)
+    : Regions(sessionData, ppRec, pp), SM(pp.getSourceManager()) {}
+
+  bool isIndexed(const Decl *D) override {
+    SourceLocation Loc = D->getLocation();
+    if (Loc.isInvalid() || Loc.isMacroID())
+      return false;
+
+    FileID FID;
+    unsigned Offset;
+    std::tie(FID, Offset) = SM.getDecomposedLoc(Loc);
+    if (SM.getMainFileID() == FID)
+      return false;
+    const FileEntry *FE = SM.getFileEntryForID(FID);
+    if (!FE)
+      return false;
+
+    return Regions.isParsed(Loc, FID, FE);
+  }
+
+  void finished() {
+    Regions.finished();
+  }
+};
+
 //===----------------------------------------------------------------------===//
 // IndexPPCallbacks
 //===----------------------------------------------------------------------===//
@@ -281,10 +324,12 @@ public:
 class IndexingConsumer : public ASTConsumer {
   CXIndexDataConsumer &DataConsumer;
   TUSkipBodyControl *SKCtrl;
+  TUSkipIndexedControl *SICtrl;
 
 public:
-  IndexingConsumer(CXIndexDataConsumer &dataConsumer, TUSkipBodyControl *skCtrl)
-    : DataConsumer(dataConsumer), SKCtrl(skCtrl) { }
+  IndexingConsumer(CXIndexDataConsumer &dataConsumer, TUSkipBodyControl *skCtrl,
+                   TUSkipIndexedControl *siCtrl)
+    : DataConsumer(dataConsumer), SKCtrl(skCtrl), SICtrl(siCtrl) { }
 
   // ASTConsumer Implementation
 
@@ -296,6 +341,9 @@ public:
   void HandleTranslationUnit(ASTContext &Ctx) override {
     if (SKCtrl)
       SKCtrl->finished();
+    // Regions of an aborted translation unit were not indexed completely.
+    if (SICtrl && !DataConsumer.shouldAbort())
+      SICtrl->finished();
   }
 
   bool HandleTopLevelDecl(DeclGroupRef DG) override {
@@ -353,11 +401,14 @@ class IndexingFrontendAction : public ASTFrontendAction {
 
   SessionSkipBodyData *SKData;
   std::unique_ptr<TUSkipBodyControl> SKCtrl;
+  SessionSkipBodyData *SIData;
+  std::unique_ptr<TUSkipIndexedControl> SICtrl;
 
 public:
   IndexingFrontendAction(std::shared_ptr<CXIndexDataConsumer> dataConsumer,
-                         SessionSkipBodyData *skData)
-      : DataConsumer(std::move(dataConsumer)), SKData(skData) {}
+                         SessionSkipBodyData *skData,
+                         SessionSkipBodyData *siData)
+      : DataConsumer(std::move(dataConsumer)), SKData(skData), SIData(siData) {}
 
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &CI,
                                                  StringRef InFile) override {
@@ -373,13 +424,19 @@ public:
     PP.addPPCallbacks(llvm::make_unique<IndexPPCallbacks>(PP, *DataConsumer));
     DataConsumer->setPreprocessor(PP);
 
-    if (SKData) {
+    if (SKData || SIData) {
       auto *PPRec = new PPConditionalDirectiveRecord(PP.getSourceManager());
       PP.addPPCallbacks(std::unique_ptr<PPCallbacks>(PPRec));
-      SKCtrl = llvm::make_unique<TUSkipBodyControl>(*SKData, *PPRec, PP);
+      if (SKData)
+        SKCtrl = llvm::make_unique<TUSkipBodyControl>(*SKData, *PPRec, PP);
+      if (SIData) {
+        SICtrl = llvm::make_unique<TUSkipIndexedControl>(*SIData, *PPRec, PP);
+        DataConsumer->setSessionIndexedDecls(SICtrl.get());
+      }
     }
 
-    return llvm::make_unique<IndexingConsumer>(*DataConsumer, SKCtrl.get());
+    return llvm::make_unique<IndexingConsumer>(*DataConsumer, SKCtrl.get(),
+                                               SICtrl.get());
   }
 
   TranslationUnitKind getTranslationUnitKind() override {
@@ -406,10 +463,37 @@ struct IndexSessionData {
   CXIndex CIdx;
   std::unique_ptr<SessionSkipBodyData> SkipBodyData;
 
+  /// \brief The indexed header regions, for each preprocessor context hash.
+  std::map<size_t, std::unique_ptr<SessionSkipBodyData>> IndexedRegions;
+  llvm::sys::Mutex IndexedRegionsMux;
+
   explicit IndexSessionData(CXIndex cIdx)
     : CIdx(cIdx), SkipBodyData(new SessionSkipBodyData) {}
+
+  SessionSkipBodyData &getIndexedRegions(size_t ContextHash) {
+    llvm::MutexGuard MG(IndexedRegionsMux);
+    std::unique_ptr<SessionSkipBodyData> &Data = IndexedRegions[ContextHash];
+    if (!Data)
+      Data.reset(new SessionSkipBodyData);
+    return *Data;
+  }
 };
 
+/// \brief Hashes what the headers of a translation unit are preprocessed with,
+/// apart from what the main file itself defines: the language, the target,
+/// the macros of the command line and the headers included before the main
+/// file.
+size_t getPreprocessorContextHash(CompilerInvocation &CI) {
+  const PreprocessorOptions &PPOpts = CI.getPreprocessorOpts();
+  llvm::hash_code Code = llvm::hash_combine(CI.getModuleHash(),
+                                            PPOpts.ImplicitPCHInclude);
+  for (const std::string &Include : PPOpts.Includes)
+    Code = llvm::hash_combine(Code, Include);
+  for (const std::string &Include : PPOpts.MacroIncludes)
+    Code = llvm::hash_combine(Code, Include);
+  return Code;
+}
+
 } // anonymous namespace
 
 static CXErrorCode clang_indexSourceFile_Impl(
@@ -536,12 +620,19 @@ static CXErrorCode clang_indexSourceFile_Impl(
       CInvok->getLangOpts()->CPlusPlus;
   if (SkipBodies)
     CInvok->getFrontendOpts().SkipFunctionBodies = true;
+  if (index_options & CXIndexOpt_SkipHeaderFunctionBodies)
+    CInvok->getFrontendOpts().SkipHeaderFunctionBodies = true;
 
   auto DataConsumer =
     std::make_shared<CXIndexDataConsumer>(client_data, CB, index_options,
                                           CXTU->getTU());
+  SessionSkipBodyData *IndexedRegions = nullptr;
+  if (index_options & CXIndexOpt_SkipIndexedHeadersInSession)
+    IndexedRegions =
+        &IdxSession->getIndexedRegions(getPreprocessorContextHash(*CInvok));
   auto InterAction = llvm::make_unique<IndexingFrontendAction>(DataConsumer,
-                         SkipBodies ? IdxSession->SkipBodyData.get() : nullptr);
+                         SkipBodies ? IdxSession->SkipBodyData.get() : nullptr,
+                         IndexedRegions);
   std::unique_ptr<FrontendAction> IndexAction;
   IndexAction = createIndexingAction(DataConsumer,
                                 getIndexingOptionsFromCXOptions(index_options),
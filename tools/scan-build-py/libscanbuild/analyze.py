@@ -15,11 +15,17 @@ import sys
 import re
 import os
 import os.path
+import glob
 import json
 import argparse
 import logging
 import subprocess
 import multiprocessing
+import collections
+try:
+    import queue
+except ImportError:
+    import Queue as queue
 from libscanbuild import initialize_logging, tempdir, command_entry_point
 from libscanbuild.runner import run
 from libscanbuild.intercept import capture
@@ -111,17 +117,130 @@ def run_analyzer(args, output_dir):
 
     logging.debug('run analyzer against compilation database')
     with open(args.cdb, 'r') as handle:
-        generator = (dict(cmd, **consts)
-                     for cmd in json.load(handle) if not exclude(cmd['file']))
-        # when verbose output requested execute sequentially
-        pool = multiprocessing.Pool(1 if args.verbose > 2 else None)
-        for current in pool.imap_unordered(run, generator):
-            if current is not None:
-                # display error message from the static analyzer
-                for line in current['error_output']:
-                    logging.info(line.rstrip())
-        pool.close()
-        pool.join()
+        entries = [dict(cmd, **consts)
+                   for cmd in json.load(handle) if not exclude(cmd['file'])]
+    history = read_history(args.history) if args.history else {}
+    # start the longest jobs first, so a large translation unit does not
+    # keep the analysis running alone at the end
+    entries.sort(key=lambda entry: predicted_cost(history, entry, 'elapsed'),
+                 reverse=True)
+    seen_reports = set(report_files(output_dir))
+    # when verbose output requested execute sequentially
+    processes = 1 if args.verbose > 2 else multiprocessing.cpu_count()
+    pool = multiprocessing.Pool(processes)
+    for entry, current in schedule(pool, processes, entries, history,
+                                   args.max_memory):
+        if current is not None:
+            # display error message from the static analyzer
+            for line in current['error_output']:
+                logging.info(line.rstrip())
+            if current.get('elapsed') is not None:
+                history[history_key(entry)] = {
+                    'elapsed': current['elapsed'],
+                    'peak_memory': current.get('peak_memory')
+                }
+        if args.stream_reports:
+            for name in sorted(set(report_files(output_dir)) - seen_reports):
+                seen_reports.add(name)
+                print(name)
+            sys.stdout.flush()
+    pool.close()
+    pool.join()
+    if args.history:
+        write_history(args.history, history)
+
+
+def schedule(pool, processes, entries, history, memory_limit):
+    """ Run the analyzer against the entries on the pool, in the given order,
+    and generate the entries with their results as they complete.
+
+    At most 'processes' runs are in progress at once. When a memory limit
+    (in megabytes) is given, a run only starts when the peak memory usage
+    predicted for it and for the running ones stays below it. A single run
+    still goes ahead when its prediction alone exceeds the limit. """
+
+    finished = queue.Queue()
+    pending = collections.deque(entries)
+    running = 0
+    memory_in_use = 0.0
+    while pending or running:
+        while pending and running < processes:
+            memory = predicted_cost(history, pending[0], 'peak_memory')
+            if memory_limit and running and \
+                    memory_in_use + memory > memory_limit:
+                break
+            entry = pending.popleft()
+            pool.apply_async(run_entry, (entry,),
+                             callback=lambda result, entry=entry,
+                             memory=memory: finished.put(
+                                 (entry, memory, result)))
+            running += 1
+            memory_in_use += memory
+        (entry, memory, result) = finished.get()
+        running -= 1
+        memory_in_use -= memory
+        yield entry, result
+
+
+def run_entry(entry):
+    """ Run the analyzer against one entry in a pool worker. Never raise,
+    so the scheduler always receives a result. """
+
+    try:
+        return run(dict(entry))
+    except Exception:
+        logging.error('Problem occured during analyzis.', exc_info=1)
+        return None
+
+
+def history_key(entry):
+    """ The name of an entry in the analysis history. """
+
+    return os.path.normpath(os.path.join(entry['directory'], entry['file']))
+
+
+def predicted_cost(history, entry, measure):
+    """ Predict a measure of the analysis of an entry from the history.
+
+    Entries never analyzed before are predicted to be as costly as the most
+    costly known one, so they are started early and not underestimated. """
+
+    known = history.get(history_key(entry), {}).get(measure)
+    if known is not None:
+        return known
+    return max([item[measure] for item in history.values()
+                if item.get(measure) is not None] or [0.0])
+
+
+def read_history(filename):
+    """ Read the analysis time and memory usage of earlier runs. A missing
+    or damaged history is simply empty. """
+
+    try:
+        with open(filename, 'r') as handle:
+            history = json.load(handle)
+        return history if isinstance(history, dict) else {}
+    except (IOError, OSError, ValueError):
+        logging.debug('no usable analysis history in %s', filename)
+        return {}
+
+
+def write_history(filename, history):
+    """ Write the analysis history. Entries of earlier runs are kept. """
+
+    temporary = filename + '.tmp'
+    with open(temporary, 'w') as handle:
+        json.dump(history, handle, sort_keys=True, indent=4)
+    os.rename(temporary, filename)
+
+
+def report_files(output_dir):
+    """ The report files the analyzer wrote into the output directory so far.
+    Empty files are the placeholders of runs still in progress. """
+
+    names = glob.glob(os.path.join(output_dir, 'report-*.html')) + \
+        glob.glob(os.path.join(output_dir, 'report-*.plist'))
+    return [name for name in names if os.path.getsize(name)]
 
 
 def setup_environment(args, destination, bin_dir):
@@ -455,6 +574,25 @@ def create_parser(from_build_command):
                 Could be usefull when project contains 3rd party libraries.
                 The directory path shall be absolute path as file names in
                 the compilation database.""")
+    advanced.add_argument(
+        '--history',
+        metavar='<file>',
+        help="""Read the analysis time and memory usage of each file from
+                this file, written by earlier runs, and update it. The
+                longest analyses are started first.""")
+    advanced.add_argument(
+        '--max-memory',
+        metavar='<megabytes>',
+        type=int,
+        help="""Do not start an analysis when the peak memory usage
+                predicted for it and for the running ones (from '--history')
+                exceeds this limit.""")
+    advanced.add_argument(
+        '--stream-reports',
+        action='store_true',
+        help="""Print the name of each report file as soon as it is
+                written, instead of only creating the cover report at the
+                end.""")
     advanced.add_argument(
         '--force-analyze-debug-code',
         dest='force_debug',
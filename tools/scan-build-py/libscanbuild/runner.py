@@ -8,6 +8,8 @@
 import re
 import os
 import os.path
+import sys
+import time
 import tempfile
 import functools
 import subprocess
@@ -147,7 +149,9 @@ def report_failure(opts):
     # return with the previous step exit code and output
     return {
         'error_output': opts['error_output'],
-        'exit_code': opts['exit_code']
+        'exit_code': opts['exit_code'],
+        'elapsed': opts.get('elapsed'),
+        'peak_memory': opts.get('peak_memory')
     }
 
 
@@ -173,6 +177,7 @@ def run_analyzer(opts, continuation=report_failure):
                         opts['flags'] + [opts['file'], '-o', output()],
                         cwd)
     logging.debug('exec command in %s: %s', cwd, ' '.join(cmd))
+    started = time.time()
     child = subprocess.Popen(cmd,
                              cwd=cwd,
                              universal_newlines=True,
@@ -180,18 +185,49 @@ def run_analyzer(opts, continuation=report_failure):
                              stderr=subprocess.STDOUT)
     output = child.stdout.readlines()
     child.stdout.close()
+    peak_memory = wait_for(child)
+    # the cost of the run is recorded to schedule the next ones
+    elapsed = time.time() - started
     # do report details if it were asked
-    child.wait()
     if opts.get('output_failures', False) and child.returncode:
         error_type = 'crash' if child.returncode & 127 else 'other_error'
         opts.update({
             'error_type': error_type,
             'error_output': output,
-            'exit_code': child.returncode
+            'exit_code': child.returncode,
+            'elapsed': elapsed,
+            'peak_memory': peak_memory
         })
         return continuation(opts)
     # return the output for logging and exit code for testing
-    return {'error_output': output, 'exit_code': child.returncode}
+    return {
+        'error_output': output,
+        'exit_code': child.returncode,
+        'elapsed': elapsed,
+        'peak_memory': peak_memory
+    }
+
+
+def wait_for(child):
+    """ Wait for the child process to terminate, set its return code and
+    return its peak resident set size in megabytes.
+
+    Returns None when the platform does not report the resource usage of
+    a single child process. """
+
+    if not hasattr(os, 'wait4'):
+        child.wait()
+        return None
+
+    (_, status, usage) = os.wait4(child.pid, 0)
+    # same convention as the 'subprocess' module uses
+    if os.WIFSIGNALED(status):
+        child.returncode = -os.WTERMSIG(status)
+    else:
+        child.returncode = os.WEXITSTATUS(status)
+    # the size is reported in bytes on OS X and in kilobytes elsewhere
+    divisor = 1024 * 1024 if sys.platform == 'darwin' else 1024
+    return float(usage.ru_maxrss) / divisor
 
 
 @require(['flags', 'force_debug'])
@@ -4,4 +4,84 @@
 # This file is distributed under the University of Illinois Open Source
 # License. See LICENSE.TXT for details.
 
+import libear
 import libscanbuild.analyze as sut
+import unittest
+import os.path
+
+
+class FakePool(object):
+    """ Finishes every job at once and records the order of the events. """
+
+    def __init__(self, events):
+        self.events = events
+
+    def apply_async(self, function, args, callback):
+        self.events.append('start ' + args[0]['file'])
+        callback(args[0]['file'].upper())
+
+
+def entries(*files):
+    return [{'directory': '/src', 'file': name} for name in files]
+
+
+def run_schedule(processes, files, history, memory_limit):
+    events = []
+    for entry, result in sut.schedule(FakePool(events), processes,
+                                      entries(*files), history,
+                                      memory_limit):
+        events.append('done ' + result)
+    return events
+
+
+class PredictedCostTest(unittest.TestCase):
+
+    def test_known_entry(self):
+        history = {'/src/a.c': {'elapsed': 3.0}, '/src/b.c': {'elapsed': 9.0}}
+        cost = sut.predicted_cost(history, entries('a.c')[0], 'elapsed')
+        self.assertEqual(3.0, cost)
+
+    def test_unknown_entry_predicted_as_most_costly(self):
+        history = {'/src/a.c': {'elapsed': 3.0}, '/src/b.c': {'elapsed': 9.0}}
+        cost = sut.predicted_cost(history, entries('c.c')[0], 'elapsed')
+        self.assertEqual(9.0, cost)
+
+    def test_empty_history(self):
+        cost = sut.predicted_cost({}, entries('a.c')[0], 'peak_memory')
+        self.assertEqual(0.0, cost)
+
+
+class ScheduleTest(unittest.TestCase):
+
+    def test_limited_by_processes(self):
+        events = run_schedule(2, ['a.c', 'b.c', 'c.c'], {}, None)
+        self.assertEqual(['start a.c', 'start b.c', 'done A.C',
+                          'start c.c', 'done B.C', 'done C.C'], events)
+
+    def test_limited_by_memory(self):
+        history = {'/src/a.c': {'peak_memory': 600.0},
+                   '/src/b.c': {'peak_memory': 300.0},
+                   '/src/c.c': {'peak_memory': 600.0}}
+        events = run_schedule(4, ['a.c', 'b.c', 'c.c'], history, 1000)
+        self.assertEqual(['start a.c', 'start b.c', 'done A.C',
+                          'start c.c', 'done B.C', 'done C.C'], events)
+
+    def test_single_job_over_the_limit_runs(self):
+        history = {'/src/a.c': {'peak_memory': 2000.0}}
+        events = run_schedule(4, ['a.c'], history, 1000)
+        self.assertEqual(['start a.c', 'done A.C'], events)
+
+
+class HistoryTest(unittest.TestCase):
+
+    def test_missing_file_is_empty(self):
+        with libear.TemporaryDirectory() as tmpdir:
+            filename = os.path.join(tmpdir, 'history.json')
+            self.assertEqual({}, sut.read_history(filename))
+
+    def test_write_and_read(self):
+        with libear.TemporaryDirectory() as tmpdir:
+            filename = os.path.join(tmpdir, 'history.json')
+            history = {'/src/a.c': {'elapsed': 1.5, 'peak_memory': 20.0}}
+            sut.write_history(filename, history)
+            self.assertEqual(history, sut.read_history(filename))
@@ -10,6 +10,7 @@ import unittest
 import re
 import os
 import os.path
+import subprocess
 
 
 class FilteringFlagsTest(unittest.TestCase):
@@ -155,6 +156,19 @@ class RunAnalyzerTest(unittest.TestCase):
         self.assertTrue(len(fwds['error_output']) > 0)
 
 
+class WaitForTest(unittest.TestCase):
+
+    def test_return_code_set(self):
+        child = subprocess.Popen(['sh', '-c', 'exit 3'])
+        sut.wait_for(child)
+        self.assertEqual(3, child.returncode)
+
+    def test_peak_memory_measured(self):
+        child = subprocess.Popen(['true'])
+        peak_memory = sut.wait_for(child)
+        self.assertTrue(peak_memory is None or peak_memory > 0)
+
+
 class ReportFailureTest(unittest.TestCase):
 
     def assertUnderFailures(self, path):
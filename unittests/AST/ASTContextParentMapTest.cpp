@@ -15,6 +15,7 @@
 #include "MatchVerifier.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Frontend/ASTUnit.h"
 #include "clang/Tooling/Tooling.h"
 #include "gtest/gtest.h"
 
@@ -78,5 +79,93 @@ TEST(GetParents, ReturnsMultipleParentsInTemplateInstantiations) {
           hasAncestor(cxxRecordDecl(unless(isTemplateInstantiation())))))));
 }
 
+TEST(GetParents, ReturnsParentsSharedWithOutOfLineTemplateMembers) {
+  // The body of f is shared between its definition and the instantiation of
+  // C<int>, which is traversed below the declaration of C.
+  MatchVerifier<Stmt> TemplateVerifier;
+  EXPECT_TRUE(TemplateVerifier.match(
+      "template<typename T> struct C { void f(); };"
+      "template<typename T> void C<T>::f() {}"
+      "void g() { C<int> c; c.f(); }",
+      compoundStmt(allOf(
+          hasAncestor(cxxRecordDecl(isTemplateInstantiation())),
+          hasAncestor(cxxMethodDecl(isDefinition(),
+                                    unless(isTemplateInstantiation())))))));
+}
+
+TEST(GetParents, ReturnsParentsOfNodesInDeclarationGroupsAndMacros) {
+  MatchVerifier<Stmt> Verifier;
+  EXPECT_TRUE(Verifier.match("struct S { int i; } s = { 1 + 2 };",
+                             binaryOperator(hasAncestor(varDecl(hasName("s"))),
+                                            hasAncestor(translationUnitDecl()))));
+  EXPECT_TRUE(Verifier.match("#define GLOBAL(name) int name = 1 + 2;\n"
+                             "int before;\n"
+                             "GLOBAL(x)\n"
+                             "int after;\n",
+                             binaryOperator(hasAncestor(varDecl(hasName("x"))),
+                                            hasAncestor(translationUnitDecl()))));
+}
+
+TEST(GetParents, ComputesTheParentMapOneTopLevelDeclarationAtATime) {
+  std::unique_ptr<ASTUnit> AST = tooling::buildASTFromCode(
+      "namespace n { void f() { if (true) {} } }"
+      "void g() { if (true) {} }");
+  ASSERT_TRUE(AST.get());
+  ASTContext &Context = AST->getASTContext();
+  auto *F = selectFirst<FunctionDecl>(
+      "f", match(functionDecl(hasName("f")).bind("f"), Context));
+  auto *G = selectFirst<FunctionDecl>(
+      "g", match(functionDecl(hasName("g")).bind("g"), Context));
+  ASSERT_TRUE(F && G);
+
+  auto *IfInF = cast<CompoundStmt>(F->getBody())->body_front();
+  auto *IfInG = cast<CompoundStmt>(G->getBody())->body_front();
+  ASSERT_EQ(1u, Context.getParents(*IfInG).size());
+  EXPECT_EQ(G->getBody(), Context.getParents(*IfInG)[0].get<Stmt>());
+  ASSERT_EQ(1u, Context.getParents(*G).size());
+  EXPECT_TRUE(Context.getParents(*G)[0].get<TranslationUnitDecl>());
+
+  // Nodes of the other top-level declaration are mapped on demand.
+  ASSERT_EQ(1u, Context.getParents(*IfInF).size());
+  EXPECT_EQ(F->getBody(), Context.getParents(*IfInF)[0].get<Stmt>());
+  ASSERT_EQ(1u, Context.getParents(*F).size());
+  EXPECT_TRUE(Context.getParents(*F)[0].get<NamespaceDecl>());
+
+  Context.computeParentMap();
+  EXPECT_TRUE(Context.getParents(*Context.getTranslationUnitDecl()).empty());
+  EXPECT_EQ(1u, Context.getParents(*IfInG).size());
+}
+
+TEST(GetParents, OnlyCoversParentMapScope) {
+  std::unique_ptr<ASTUnit> AST = tooling::buildASTFromCode(
+      "namespace n { void f() { if (true) {} } }"
+      "void g() { if (true) {} }");
+  ASSERT_TRUE(AST.get());
+  ASTContext &Context = AST->getASTContext();
+  auto *F = selectFirst<FunctionDecl>(
+      "f", match(functionDecl(hasName("f")).bind("f"), Context));
+  auto *G = selectFirst<FunctionDecl>(
+      "g", match(functionDecl(hasName("g")).bind("g"), Context));
+  ASSERT_TRUE(F && G);
+
+  Decl *Scope = const_cast<FunctionDecl *>(F);
+  Context.setParentMapScope(Scope);
+  auto *IfInF = cast<CompoundStmt>(F->getBody())->body_front();
+  auto *IfInG = cast<CompoundStmt>(G->getBody())->body_front();
+  ASSERT_EQ(1u, Context.getParents(*IfInF).size());
+  EXPECT_EQ(F->getBody(), Context.getParents(*IfInF)[0].get<Stmt>());
+  EXPECT_TRUE(Context.getParents(*IfInG).empty());
+
+  // The enclosing contexts of the scope are still its ancestors.
+  ASSERT_EQ(1u, Context.getParents(*F).size());
+  const auto *N = Context.getParents(*F)[0].get<NamespaceDecl>();
+  ASSERT_TRUE(N);
+  ASSERT_EQ(1u, Context.getParents(*N).size());
+  EXPECT_TRUE(Context.getParents(*N)[0].get<TranslationUnitDecl>());
+
+  Context.setParentMapScope(None);
+  EXPECT_EQ(1u, Context.getParents(*IfInG).size());
+}
+
 } // end namespace ast_matchers
 } // end namespace clang
@@ -13,6 +13,7 @@
 
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTImporter.h"
+#include "clang/AST/ExternalASTSource.h"
 #include "MatchVerifier.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
@@ -455,6 +456,66 @@ TEST(ImportExpr, ImportInitListExpr) {
                               )))))))))));
 }
 
+// Ensure that declarations loaded from external lexical storage after the
+// importer first looked into a context are still found, rather than imported
+// a second time.
+TEST(ImportDecl, FindsDeclsLoadedFromExternalLexicalStorage) {
+  struct LazyDeclSource : ExternalASTSource {
+    LazyDeclSource(ASTContext &Ctx) : Ctx(Ctx) {}
+
+    void
+    FindExternalLexicalDecls(const DeclContext *DC,
+                             llvm::function_ref<bool(Decl::Kind)> IsKindWeWant,
+                             SmallVectorImpl<Decl *> &Result) override {
+      if (!DC->isTranslationUnit() || Loaded)
+        return;
+      Loaded = VarDecl::Create(Ctx, Ctx.getTranslationUnitDecl(),
+                               SourceLocation(), SourceLocation(),
+                               &Ctx.Idents.get("lazy"), Ctx.IntTy,
+                               /*TInfo=*/nullptr, SC_Extern);
+      Result.push_back(Loaded);
+    }
+
+    ASTContext &Ctx;
+    VarDecl *Loaded = nullptr;
+  };
+
+  const char *const FromCode = "int first; extern int lazy;";
+  const char *const InputFileName = "input.cc";
+  std::unique_ptr<ASTUnit>
+      FromAST = tooling::buildASTFromCode(FromCode, InputFileName),
+      ToAST = tooling::buildASTFromCode("int existing;", "output.cc");
+  ASTContext &FromCtx = FromAST->getASTContext(),
+      &ToCtx = ToAST->getASTContext();
+
+  vfs::OverlayFileSystem *OFS = static_cast<vfs::OverlayFileSystem *>(
+        ToCtx.getSourceManager().getFileManager().getVirtualFileSystem().get());
+  vfs::InMemoryFileSystem *MFS = static_cast<vfs::InMemoryFileSystem *>(
+        OFS->overlays_begin()->get());
+  MFS->addFile(InputFileName, 0, llvm::MemoryBuffer::getMemBuffer(FromCode));
+
+  LazyDeclSource *Source = new LazyDeclSource(ToCtx);
+  ToCtx.setExternalSource(Source);
+  TranslationUnitDecl *ToTU = ToCtx.getTranslationUnitDecl();
+  ToTU->setHasExternalLexicalStorage();
+
+  ASTImporter Importer(ToCtx, ToAST->getFileManager(),
+                       FromCtx, FromAST->getFileManager(), false);
+  auto ImportNamed = [&](StringRef Name) -> Decl * {
+    SmallVector<NamedDecl *, 1> FoundDecls;
+    FromCtx.getTranslationUnitDecl()->localUncachedLookup(
+        &FromCtx.Idents.get(Name), FoundDecls);
+    return FoundDecls.size() == 1 ? Importer.Import(FoundDecls[0]) : nullptr;
+  };
+
+  // Index the "to" translation unit, then load its external declarations,
+  // which go in front of the ones already indexed.
+  ASSERT_TRUE(ImportNamed("first"));
+  ToTU->decls_begin();
+  ASSERT_TRUE(Source->Loaded);
+
+  EXPECT_EQ(Source->Loaded, ImportNamed("lazy"));
+}
 
 } // end namespace ast_matchers
 } // end namespace clang
@@ -12,6 +12,7 @@
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/ADT/Triple.h"
 #include "llvm/Support/Host.h"
 #include "gtest/gtest.h"
@@ -171,6 +172,101 @@ TEST(MatchFinder, InterceptsEndOfTranslationUnit) {
   EXPECT_TRUE(VerifyCallback.Called);
 }
 
+namespace {
+class CountVarDeclRuns : public internal::MatcherInterface<Decl> {
+public:
+  explicit CountVarDeclRuns(unsigned &Runs) : Runs(Runs) {}
+
+  bool matches(const Decl &Node, internal::ASTMatchFinder *Finder,
+               internal::BoundNodesTreeBuilder *Builder) const override {
+    if (!isa<VarDecl>(Node))
+      return false;
+    ++Runs;
+    return true;
+  }
+
+private:
+  unsigned &Runs;
+};
+
+class CountMatches : public MatchFinder::MatchCallback {
+public:
+  CountMatches() : Count(0) {}
+  void run(const MatchFinder::MatchResult &Result) override { ++Count; }
+  unsigned Count;
+};
+} // end anonymous namespace
+
+TEST(MatchFinder, RunsSharedMatchersOncePerNode) {
+  unsigned Runs = 0;
+  internal::Matcher<Decl> Shared =
+      internal::makeMatcher(new CountVarDeclRuns(Runs));
+  CountMatches First, Second;
+  MatchFinder Finder;
+  Finder.addMatcher(varDecl(Shared, hasName("x")), &First);
+  Finder.addMatcher(decl(Shared).bind("d"), &Second);
+
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode("int x; int y;"));
+  ASSERT_TRUE(AST.get());
+  Finder.matchAST(AST->getASTContext());
+  EXPECT_EQ(1u, First.Count);
+  EXPECT_EQ(2u, Second.Count);
+  EXPECT_EQ(2u, Runs);
+}
+
+TEST(MatchFinder, RunsMatchersAddedAfterATraversal) {
+  CountMatches Vars, Calls;
+  MatchFinder Finder;
+  Finder.addMatcher(varDecl(), &Vars);
+
+  std::unique_ptr<ASTUnit> AST(
+      tooling::buildASTFromCode("void f(); int x; void g() { f(); }"));
+  ASSERT_TRUE(AST.get());
+  Finder.matchAST(AST->getASTContext());
+  EXPECT_EQ(1u, Vars.Count);
+
+  Finder.addMatcher(callExpr(callee(functionDecl(hasName("f")))), &Calls);
+  Finder.matchAST(AST->getASTContext());
+  EXPECT_EQ(2u, Vars.Count);
+  EXPECT_EQ(1u, Calls.Count);
+}
+
+TEST(MatchFinder, MatchesInParallelInSerialOrder) {
+  struct RecordNames : public MatchFinder::MatchCallback {
+    void run(const MatchFinder::MatchResult &Result) override {
+      Names.push_back(
+          Result.Nodes.getNodeAs<NamedDecl>("d")->getNameAsString());
+    }
+    std::vector<std::string> Names;
+  };
+
+  std::string Code = "class Base {}; typedef Base Alias;";
+  for (unsigned I = 0; I != 20; ++I) {
+    std::string N = llvm::utostr(I);
+    Code += "class C" + N + " : Alias {}; void f" + N + "() { int v" + N +
+            "; }";
+  }
+  std::unique_ptr<ASTUnit> AST(tooling::buildASTFromCode(Code));
+  ASSERT_TRUE(AST.get());
+
+  auto Matcher = namedDecl(anyOf(cxxRecordDecl(isDerivedFrom("Alias")),
+                                 varDecl(hasAncestor(functionDecl()))))
+                     .bind("d");
+  RecordNames Serial, Parallel;
+  MatchFinder SerialFinder;
+  SerialFinder.addMatcher(Matcher, &Serial);
+  SerialFinder.matchAST(AST->getASTContext());
+
+  MatchFinder::MatchFinderOptions Options;
+  Options.NumThreads = 4;
+  MatchFinder ParallelFinder(std::move(Options));
+  ParallelFinder.addMatcher(Matcher, &Parallel);
+  ParallelFinder.matchAST(AST->getASTContext());
+
+  EXPECT_EQ(40u, Serial.Names.size());
+  EXPECT_EQ(Serial.Names, Parallel.Names);
+}
+
 TEST(Matcher, matchOverEntireASTContext) {
   std::unique_ptr<ASTUnit> AST =
       clang::tooling::buildASTFromCode("struct { int *foo; };");
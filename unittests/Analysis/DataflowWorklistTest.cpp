@@ -0,0 +1,80 @@
+//===- unittests/Analysis/DataflowWorklistTest.cpp - Worklist tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Analysis/Analyses/PostOrderCFGView.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Analysis/FlowSensitive/DataflowWorklist.h"
+#include "clang/Tooling/Tooling.h"
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+
+namespace clang {
+namespace analysis {
+namespace {
+
+// The worklists hand out the blocks of a CFG in reverse post order for forward
+// analyses and in post order for backward analyses, whatever order they were
+// enqueued in.
+TEST(DataflowWorklist, DequeuesInAnalysisOrder) {
+  const char *Code = "void f(int n) {\n"
+                     "  for (int i = 0; i < n; ++i) {\n"
+                     "    if (i == 3)\n"
+                     "      continue;\n"
+                     "    n--;\n"
+                     "  }\n"
+                     "}\n";
+
+  class CFGCallback : public ast_matchers::MatchFinder::MatchCallback {
+  public:
+    bool SawFunctionBody = false;
+
+    void run(const ast_matchers::MatchFinder::MatchResult &Result) override {
+      const auto *Func = Result.Nodes.getNodeAs<FunctionDecl>("func");
+      Stmt *Body = Func->getBody();
+      if (!Body)
+        return;
+      SawFunctionBody = true;
+      std::unique_ptr<CFG> cfg =
+          CFG::buildCFG(Func, Body, Result.Context, CFG::BuildOptions());
+      ASSERT_NE(nullptr, cfg);
+      PostOrderCFGView POV(cfg.get());
+      std::vector<const CFGBlock *> RPO(POV.begin(), POV.end());
+      ASSERT_EQ(cfg->getNumBlockIDs(), RPO.size());
+
+      ForwardDataflowWorklist Forward(*cfg, POV);
+      BackwardDataflowWorklist Backward(*cfg, POV);
+      for (const CFGBlock *Block : *cfg) {
+        Forward.enqueueBlock(Block);
+        Backward.enqueueBlock(Block);
+        // Enqueueing a block twice has no effect.
+        Forward.enqueueBlock(Block);
+      }
+
+      for (const CFGBlock *Block : RPO)
+        EXPECT_EQ(Block, Forward.dequeue());
+      EXPECT_EQ(nullptr, Forward.dequeue());
+      for (auto I = RPO.rbegin(), E = RPO.rend(); I != E; ++I)
+        EXPECT_EQ(*I, Backward.dequeue());
+      EXPECT_TRUE(Backward.empty());
+    }
+  } Callback;
+
+  ast_matchers::MatchFinder Finder;
+  Finder.addMatcher(ast_matchers::functionDecl().bind("func"), &Callback);
+  std::unique_ptr<tooling::FrontendActionFactory> Factory(
+      tooling::newFrontendActionFactory(&Finder));
+  ASSERT_TRUE(tooling::runToolOnCode(Factory->create(), Code));
+  EXPECT_TRUE(Callback.SawFunctionBody);
+}
+
+} // namespace
+} // namespace analysis
+} // namespace clang
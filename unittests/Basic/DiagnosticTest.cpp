@@ -69,4 +69,27 @@ TEST(DiagnosticTest, fatalsAsErrors) {
   EXPECT_TRUE(Diags.hasUnrecoverableErrorOccurred());
 }
 
+// Check that remembering which diagnostics are ignored everywhere does not
+// hide later changes to their mappings.
+TEST(DiagnosticTest, ignoredAfterMappingChanges) {
+  DiagnosticsEngine Diags(new DiagnosticIDs(),
+                          new DiagnosticOptions,
+                          new IgnoringDiagConsumer());
+  EXPECT_FALSE(Diags.isIgnored(diag::warn_mt_message, SourceLocation()));
+
+  Diags.setSeverity(diag::warn_mt_message, diag::Severity::Ignored,
+                    SourceLocation());
+  EXPECT_TRUE(Diags.isIgnored(diag::warn_mt_message, SourceLocation()));
+
+  Diags.setSeverity(diag::warn_mt_message, diag::Severity::Warning,
+                    SourceLocation());
+  EXPECT_FALSE(Diags.isIgnored(diag::warn_mt_message, SourceLocation()));
+
+  Diags.setIgnoreAllWarnings(true);
+  EXPECT_TRUE(Diags.isIgnored(diag::warn_mt_message, SourceLocation()));
+
+  Diags.setIgnoreAllWarnings(false);
+  EXPECT_FALSE(Diags.isIgnored(diag::warn_mt_message, SourceLocation()));
+}
+
 }
@@ -12,6 +12,10 @@
 #include "clang/Basic/FileSystemStatCache.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 using namespace llvm;
@@ -246,6 +250,76 @@ TEST_F(FileManagerTest, addRemoveStatCache) {
   manager.removeStatCache(statCache);
 }
 
+// FileManagers that share buffers read each file once.
+TEST_F(FileManagerTest, getBufferForFileFromSharedBuffers) {
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS1(
+      new vfs::InMemoryFileSystem);
+  FS1->addFile("/a.h", 0, MemoryBuffer::getMemBuffer("int a;"));
+  FS1->addFile("/b.h", 0, MemoryBuffer::getMemBuffer("int b;"));
+  IntrusiveRefCntPtr<vfs::InMemoryFileSystem> FS2(
+      new vfs::InMemoryFileSystem);
+  FS2->addFile("/a.h", 0, MemoryBuffer::getMemBuffer("int A;"));
+  FS2->addFile("/b.h", 0, MemoryBuffer::getMemBuffer("long b;"));
+
+  SharedFileBuffers Buffers;
+  FileManager Manager1(options, FS1);
+  Manager1.setSharedFileBuffers(&Buffers);
+  FileManager Manager2(options, FS2);
+  Manager2.setSharedFileBuffers(&Buffers);
+
+  auto Buffer = Manager1.getBufferForFile(Manager1.getFile("/a.h"));
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ("int a;", (*Buffer)->getBuffer());
+  Buffer = Manager1.getBufferForFile(Manager1.getFile("/b.h"));
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ("int b;", (*Buffer)->getBuffer());
+
+  // The contents of a file are assumed to be the same for all managers...
+  Buffer = Manager2.getBufferForFile(Manager2.getFile("/a.h"));
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ("int a;", (*Buffer)->getBuffer());
+
+  // ... unless its size differs, or it is volatile.
+  Buffer = Manager2.getBufferForFile(Manager2.getFile("/b.h"));
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ("long b;", (*Buffer)->getBuffer());
+  Buffer = Manager2.getBufferForFile(Manager2.getFile("/a.h"),
+                                     /*isVolatile=*/true);
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ("int A;", (*Buffer)->getBuffer());
+}
+
+// A file whose size is a multiple of the page size can only be mapped if no
+// null terminator is required; AST files are read that way.
+TEST_F(FileManagerTest, getBufferForFileWithoutNullTerminatorIsMapped) {
+  int FD;
+  SmallString<64> Path;
+  ASSERT_FALSE(sys::fs::createTemporaryFile("pages", "pcm", FD, Path));
+  unsigned Size = 4 * std::max(4096u, sys::Process::getPageSize());
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << std::string(Size, 'x');
+  }
+
+  const FileEntry *File = manager.getFile(Path);
+  ASSERT_TRUE(File != nullptr);
+  auto Buffer = manager.getBufferForFile(File, /*isVolatile=*/false,
+                                         /*ShouldCloseOpenFile=*/true,
+                                         /*RequiresNullTerminator=*/false);
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ(Size, (*Buffer)->getBufferSize());
+  EXPECT_EQ(MemoryBuffer::MemoryBuffer_MMap, (*Buffer)->getBufferKind());
+
+  Buffer = manager.getBufferForFile(File, /*isVolatile=*/false,
+                                    /*ShouldCloseOpenFile=*/true,
+                                    /*RequiresNullTerminator=*/true);
+  ASSERT_TRUE(bool(Buffer));
+  EXPECT_EQ(Size, (*Buffer)->getBufferSize());
+  EXPECT_EQ(MemoryBuffer::MemoryBuffer_Malloc, (*Buffer)->getBufferKind());
+
+  sys::fs::remove(Path);
+}
+
 #endif  // !LLVM_ON_WIN32
 
 } // anonymous namespace
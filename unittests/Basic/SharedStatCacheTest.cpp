@@ -0,0 +1,149 @@
+//===- unittests/Basic/SharedStatCacheTest.cpp - SharedStatCache tests ----===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Basic/SharedStatCache.h"
+#include "clang/Basic/VirtualFileSystem.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/TimeValue.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+class SharedStatCacheTest : public ::testing::Test {
+protected:
+  SmallString<128> TestDirectory;
+  SmallString<128> CachePath;
+
+  void SetUp() override {
+    ASSERT_FALSE(
+        sys::fs::createUniqueDirectory("shared-stat-cache", TestDirectory));
+    // Keep the cache file out of the tested directories so that creating it
+    // doesn't change their modification times.
+    ASSERT_FALSE(
+        sys::fs::createTemporaryFile("shared-stat-cache", "bin", CachePath));
+
+    SmallString<128> Headers(TestDirectory);
+    sys::path::append(Headers, "include");
+    ASSERT_FALSE(sys::fs::create_directory(Headers));
+    backdate(Headers, 120);
+  }
+
+  void TearDown() override {
+    SmallString<128> Headers(TestDirectory);
+    sys::path::append(Headers, "include");
+    sys::fs::remove(getHeaderPath());
+    sys::fs::remove(Headers);
+    sys::fs::remove(CachePath);
+    sys::fs::remove(TestDirectory);
+  }
+
+  /// Move the modification time of \p Dir \p Seconds into the past, out of
+  /// the window in which the cache refuses to trust it.
+  static void backdate(StringRef Dir, int Seconds) {
+    int FD;
+    ASSERT_FALSE(sys::fs::openFileForRead(Dir, FD));
+    sys::TimeValue Past = sys::TimeValue::now();
+    Past -= sys::TimeValue(Seconds, 0);
+    EXPECT_FALSE(sys::fs::setLastModificationAndAccessTime(FD, Past));
+    sys::Process::SafelyCloseFileDescriptor(FD);
+  }
+
+  std::string getHeaderPath() const {
+    SmallString<128> Path(TestDirectory);
+    sys::path::append(Path, "include", "missing.h");
+    return Path.str();
+  }
+
+  /// Returns true if the path does not exist, like FileSystemStatCache::get.
+  static bool stat(SharedStatCache &Cache, StringRef Path, bool isFile) {
+    FileData Data;
+    return FileSystemStatCache::get(Path.str().c_str(), Data, isFile,
+                                    nullptr, &Cache,
+                                    *vfs::getRealFileSystem());
+  }
+};
+
+#ifdef LLVM_ON_UNIX
+
+TEST_F(SharedStatCacheTest, SharesNegativeLookups) {
+  std::unique_ptr<SharedStatCache> First = SharedStatCache::create(CachePath);
+  ASSERT_TRUE(First != nullptr);
+  EXPECT_TRUE(stat(*First, getHeaderPath(), /*isFile=*/true));
+  EXPECT_EQ(0u, First->getNumHits());
+  EXPECT_EQ(1u, First->getNumMisses());
+
+  // A second cache opened on the same file sees the first one's result.
+  std::unique_ptr<SharedStatCache> Second = SharedStatCache::create(CachePath);
+  ASSERT_TRUE(Second != nullptr);
+  EXPECT_TRUE(stat(*Second, getHeaderPath(), /*isFile=*/true));
+  EXPECT_EQ(1u, Second->getNumHits());
+  EXPECT_EQ(0u, Second->getNumMisses());
+}
+
+TEST_F(SharedStatCacheTest, SharesDirectoryLookups) {
+  SmallString<128> Headers(TestDirectory);
+  sys::path::append(Headers, "include");
+  backdate(TestDirectory, 120);
+
+  std::unique_ptr<SharedStatCache> First = SharedStatCache::create(CachePath);
+  ASSERT_TRUE(First != nullptr);
+  EXPECT_FALSE(stat(*First, Headers, /*isFile=*/false));
+  EXPECT_EQ(1u, First->getNumMisses());
+
+  std::unique_ptr<SharedStatCache> Second = SharedStatCache::create(CachePath);
+  ASSERT_TRUE(Second != nullptr);
+  EXPECT_FALSE(stat(*Second, Headers, /*isFile=*/false));
+  // A directory is not a file, even when it comes from the cache.
+  EXPECT_TRUE(stat(*Second, Headers, /*isFile=*/true));
+  EXPECT_EQ(2u, Second->getNumHits());
+}
+
+TEST_F(SharedStatCacheTest, InvalidatedByDirectoryChange) {
+  std::unique_ptr<SharedStatCache> First = SharedStatCache::create(CachePath);
+  ASSERT_TRUE(First != nullptr);
+  EXPECT_TRUE(stat(*First, getHeaderPath(), /*isFile=*/true));
+
+  // Creating the file updates the modification time of its directory.
+  {
+    std::error_code EC;
+    raw_fd_ostream OS(getHeaderPath(), EC, sys::fs::F_None);
+    ASSERT_FALSE(EC);
+    OS << "int x;\n";
+  }
+  SmallString<128> Headers(TestDirectory);
+  sys::path::append(Headers, "include");
+  backdate(Headers, 60);
+
+  std::unique_ptr<SharedStatCache> Second = SharedStatCache::create(CachePath);
+  ASSERT_TRUE(Second != nullptr);
+  EXPECT_FALSE(stat(*Second, getHeaderPath(), /*isFile=*/true));
+  EXPECT_EQ(0u, Second->getNumHits());
+}
+
+TEST_F(SharedStatCacheTest, RejectsIncompatibleFiles) {
+  {
+    std::error_code EC;
+    raw_fd_ostream OS(CachePath, EC, sys::fs::F_None);
+    ASSERT_FALSE(EC);
+    OS << "not a stat cache";
+  }
+  EXPECT_TRUE(SharedStatCache::create(CachePath) == nullptr);
+}
+
+#endif // LLVM_ON_UNIX
+
+} // end anonymous namespace
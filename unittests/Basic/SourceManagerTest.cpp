@@ -22,6 +22,7 @@
 #include "llvm/ADT/SmallString.h"
 #include "llvm/Config/llvm-config.h"
 #include "gtest/gtest.h"
+#include <vector>
 
 using namespace clang;
 
@@ -171,6 +172,118 @@ TEST_F(SourceManagerTest, getColumnNumber) {
   EXPECT_EQ(1U, SourceMgr.getColumnNumber(MainFileID, 0, nullptr));
 }
 
+TEST_F(SourceManagerTest, getFileIDWithManyExpansions) {
+  const char *Source = "int x;\n";
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(Source);
+  FileID MainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(MainFileID);
+  SourceLocation Spelling = SourceMgr.getLocForStartOfFile(MainFileID);
+
+  // Create enough expansions that lookups fall through the linear scan and
+  // the lookup cache into the binary search.
+  std::vector<SourceLocation> Expansions;
+  for (unsigned I = 0; I != 1000; ++I)
+    Expansions.push_back(SourceMgr.createExpansionLoc(
+        Spelling, Spelling, Spelling, /*TokLength=*/1 + I % 7));
+
+  // Look them up in an order that defeats any locality.
+  for (unsigned Step : {1u, 7u, 331u}) {
+    for (unsigned I = 0; I != Expansions.size(); ++I) {
+      unsigned Index = (I * Step) % Expansions.size();
+      unsigned Length = 1 + Index % 7;
+      SourceLocation Loc = Expansions[Index];
+      FileID FID = SourceMgr.getFileID(Loc);
+      EXPECT_TRUE(SourceMgr.getSLocEntry(FID).isExpansion());
+      EXPECT_EQ(0U, SourceMgr.getFileOffset(Loc));
+      if (Index)
+        EXPECT_NE(FID, SourceMgr.getFileID(Expansions[Index - 1]));
+      // The last offset covered by each entry belongs to it too.
+      SourceLocation Last = Loc.getLocWithOffset(Length - 1);
+      EXPECT_EQ(FID, SourceMgr.getFileID(Last));
+      EXPECT_EQ(Length - 1, SourceMgr.getFileOffset(Last));
+    }
+  }
+
+  EXPECT_EQ(MainFileID, SourceMgr.getFileID(Spelling.getLocWithOffset(3)));
+}
+
+TEST_F(SourceManagerTest, coalesceMacroArgExpansions) {
+  const char *Source =
+    "#define M(x, y) x y\n"
+    "M(foo, bar)\n";
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(Source);
+  FileID MainFileID = SourceMgr.createFileID(std::move(Buf));
+  SourceMgr.setMainFileID(MainFileID);
+  SourceMgr.setCoalesceMacroArgExpansions(true);
+
+  SourceLocation Start = SourceMgr.getLocForStartOfFile(MainFileID);
+  SourceLocation MacroBody = Start.getLocWithOffset(16); // "x y"
+  SourceLocation Invocation = Start.getLocWithOffset(20); // "M(foo, bar)"
+  SourceLocation FooLoc = Start.getLocWithOffset(22);
+  SourceLocation BarLoc = Start.getLocWithOffset(27);
+
+  SourceLocation Body = SourceMgr.createExpansionLoc(
+      MacroBody, Invocation, Invocation.getLocWithOffset(10), 3);
+  SourceLocation XLoc = Body;
+  SourceLocation YLoc = Body.getLocWithOffset(2);
+
+  unsigned NumEntries = SourceMgr.local_sloc_entry_size();
+  SourceLocation Foo = SourceMgr.createMacroArgExpansionLoc(FooLoc, XLoc, 3);
+  SourceLocation Bar = SourceMgr.createMacroArgExpansionLoc(BarLoc, YLoc, 3);
+  EXPECT_EQ(NumEntries + 1, SourceMgr.local_sloc_entry_size());
+  EXPECT_EQ(SourceMgr.getFileID(Foo), SourceMgr.getFileID(Bar));
+
+  // Both arguments keep their exact spelling and expansion locations.
+  EXPECT_EQ(FooLoc, SourceMgr.getImmediateSpellingLoc(Foo));
+  EXPECT_EQ(BarLoc, SourceMgr.getImmediateSpellingLoc(Bar));
+  EXPECT_EQ(XLoc, SourceMgr.getImmediateExpansionRange(Foo).first);
+  EXPECT_EQ(YLoc, SourceMgr.getImmediateExpansionRange(Bar).first);
+  EXPECT_EQ(Invocation, SourceMgr.getExpansionLoc(Bar));
+
+  SourceLocation ArgLoc;
+  EXPECT_TRUE(SourceMgr.isMacroArgExpansion(Bar, &ArgLoc));
+  EXPECT_EQ(YLoc, ArgLoc);
+
+  // Each argument still starts and ends on its own. The end is checked one
+  // past the last character, like Lexer::isAtEndOfMacroExpansion does.
+  EXPECT_TRUE(SourceMgr.isAtStartOfImmediateMacroExpansion(Foo, &ArgLoc));
+  EXPECT_EQ(XLoc, ArgLoc);
+  EXPECT_TRUE(SourceMgr.isAtEndOfImmediateMacroExpansion(
+      Foo.getLocWithOffset(3), &ArgLoc));
+  EXPECT_EQ(XLoc, ArgLoc);
+  EXPECT_TRUE(SourceMgr.isAtStartOfImmediateMacroExpansion(Bar, &ArgLoc));
+  EXPECT_EQ(YLoc, ArgLoc);
+  EXPECT_FALSE(
+      SourceMgr.isAtStartOfImmediateMacroExpansion(Bar.getLocWithOffset(1)));
+  EXPECT_TRUE(SourceMgr.isAtEndOfImmediateMacroExpansion(
+      Bar.getLocWithOffset(3), &ArgLoc));
+  EXPECT_EQ(YLoc, ArgLoc);
+
+  // Ordering goes through the expansion location of each argument, including
+  // after a query on the same pair of FileIDs has been answered.
+  SourceLocation Space = Body.getLocWithOffset(1);
+  EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(Foo, Space));
+  EXPECT_FALSE(SourceMgr.isBeforeInTranslationUnit(Bar, Space));
+  EXPECT_TRUE(SourceMgr.isBeforeInTranslationUnit(Space, Bar));
+
+  // The file chunks of both arguments map to their expansions, but the comma
+  // between them does not.
+  EXPECT_EQ(Foo, SourceMgr.getMacroArgExpandedLocation(FooLoc));
+  EXPECT_EQ(Bar.getLocWithOffset(1),
+            SourceMgr.getMacroArgExpandedLocation(BarLoc.getLocWithOffset(1)));
+  SourceLocation Comma = FooLoc.getLocWithOffset(3);
+  EXPECT_EQ(Comma, SourceMgr.getMacroArgExpandedLocation(Comma));
+
+  // Arguments of another invocation get their own entry.
+  SourceLocation OtherBody = SourceMgr.createExpansionLoc(
+      MacroBody, Invocation, Invocation.getLocWithOffset(10), 3);
+  SourceLocation Other =
+      SourceMgr.createMacroArgExpansionLoc(FooLoc, OtherBody, 3);
+  EXPECT_NE(SourceMgr.getFileID(OtherBody), SourceMgr.getFileID(Other));
+}
+
 #if defined(LLVM_ON_UNIX)
 
 TEST_F(SourceManagerTest, getMacroArgExpandedLocation) {
@@ -829,6 +829,54 @@ TEST_F(VFSFromYAMLTest, CaseSensitive) {
   EXPECT_EQ(0, NumDiagnostics);
 }
 
+TEST_F(VFSFromYAMLTest, LargeDirectories) {
+  if (!supportsSameDirMultipleYAMLEntries())
+    return;
+
+  IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
+  Lower->addRegularFile("//root/foo/a");
+  Lower->addRegularFile("//root/foo/b");
+
+  // Two entries for the same directory, which are merged.
+  std::string YAML = "{ 'roots': [\n";
+  for (StringRef Contents : {"a", "b"}) {
+    if (Contents == "b")
+      YAML += ",\n";
+    YAML += "{ 'type': 'directory', 'name': '//root/dir', 'contents': [\n";
+    for (int I = 0; I < 1000; ++I)
+      YAML += "{ 'type': 'file', 'name': '" + Contents.str() + "-" +
+              std::to_string(I) + "', 'external-contents': '//root/foo/" +
+              Contents.str() + "' },\n";
+    YAML += "{ 'type': 'file', 'name': 'sub/" + Contents.str() +
+            "', 'external-contents': '//root/foo/" + Contents.str() +
+            "' } ] }";
+  }
+  YAML += "\n] }";
+  IntrusiveRefCntPtr<vfs::FileSystem> FS = getFromYAMLString(YAML, Lower);
+  ASSERT_TRUE(FS.get() != nullptr);
+
+  ErrorOr<vfs::Status> S = FS->status("//root/dir/a-0");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("//root/foo/a", S->getName());
+  S = FS->status("//root/dir/b-999");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("//root/foo/b", S->getName());
+  S = FS->status("//root/dir/sub/b");
+  ASSERT_FALSE(S.getError());
+  EXPECT_EQ("//root/foo/b", S->getName());
+  S = FS->status("//root/dir/sub");
+  ASSERT_FALSE(S.getError());
+  EXPECT_TRUE(S->isDirectory());
+
+  EXPECT_EQ(FS->status("//root/dir/c-0").getError(),
+            llvm::errc::no_such_file_or_directory);
+  EXPECT_EQ(FS->status("//root/dir/A-0").getError(),
+            llvm::errc::no_such_file_or_directory);
+  EXPECT_EQ(FS->status("//root/dir/a-0/x").getError(),
+            llvm::errc::not_a_directory);
+  EXPECT_EQ(0, NumDiagnostics);
+}
+
 TEST_F(VFSFromYAMLTest, IllegalVFSFile) {
   IntrusiveRefCntPtr<DummyFileSystem> Lower(new DummyFileSystem());
 
@@ -3777,6 +3777,15 @@ TEST_F(FormatTest, MemoizationTests) {
   verifyFormat(input, OnePerLine);
 }
 
+TEST_F(FormatTest, FinishesGreedilyAfterMaxLineFormattingStates) {
+  FormatStyle Style = getLLVMStyleWithColumns(20);
+  Style.MaxLineFormattingStates = 1;
+  verifyFormat("f(aaaaaaaa,\n"
+               "  bbbbbbbb,\n"
+               "  cccccccc);",
+               Style);
+}
+
 TEST_F(FormatTest, BreaksAsHighAsPossible) {
   verifyFormat(
       "void f() {\n"
@@ -10210,6 +10219,8 @@ TEST_F(FormatTest, ParsesConfiguration) {
   CHECK_PARSE("ObjCBlockIndentWidth: 1234", ObjCBlockIndentWidth, 1234u);
   CHECK_PARSE("ColumnLimit: 1234", ColumnLimit, 1234u);
   CHECK_PARSE("MaxEmptyLinesToKeep: 1234", MaxEmptyLinesToKeep, 1234u);
+  CHECK_PARSE("MaxLineFormattingStates: 1234", MaxLineFormattingStates,
+              1234u);
   CHECK_PARSE("PenaltyBreakBeforeFirstCallParameter: 1234",
               PenaltyBreakBeforeFirstCallParameter, 1234u);
   CHECK_PARSE("PenaltyExcessCharacter: 1234", PenaltyExcessCharacter, 1234u);
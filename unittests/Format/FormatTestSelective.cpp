@@ -512,6 +512,98 @@ TEST_F(FormatTestSelective, StopFormattingWhenLeavingScope) {
              15, 0));
 }
 
+TEST_F(FormatTestSelective, IncrementalFormattingAfterEdits) {
+  IncrementalFormatState State;
+  auto FormatIncrementally = [&](StringRef Code, unsigned Offset,
+                                 unsigned Length) {
+    std::vector<tooling::Range> Ranges(1, tooling::Range(Offset, Length));
+    tooling::Replacements Replaces = reformat(Style, Code, Ranges, State);
+    auto Result = applyAllReplacements(Code, Replaces);
+    EXPECT_TRUE(static_cast<bool>(Result));
+    return *Result;
+  };
+
+  std::string Code = "int  a;\n"
+                     "\n"
+                     "void f() {\n"
+                     "  int  b;\n"
+                     "}\n"
+                     "\n"
+                     "void g() {\n"
+                     "  int c;\n"
+                     "}\n"
+                     "\n"
+                     "int  d;\n";
+  EXPECT_EQ(format(Code, 0, 0), FormatIncrementally(Code, 0, 0));
+
+  EXPECT_EQ(0u, State.WindowBegin);
+  EXPECT_EQ(Code.size(), State.WindowEnd);
+
+  // Only g() is lexed and parsed, as if the whole file was.
+  std::string Edited = Code;
+  Edited.replace(Edited.find("int c;"), 6, "int  c  =  1;");
+  unsigned Offset = Edited.find("c  =");
+  EXPECT_EQ(format(Edited, Offset, 0), FormatIncrementally(Edited, Offset, 0));
+  EXPECT_EQ(Edited.find("\n\nvoid g"), State.WindowBegin);
+  EXPECT_EQ(Edited.find("\n\nint  d"), State.WindowEnd);
+
+  // An edit that leaves a brace open cannot be formatted on its own.
+  Edited.replace(Edited.find("1;"), 2, "1; if (c) {");
+  Offset = Edited.find("if");
+  EXPECT_EQ(format(Edited, Offset, 0), FormatIncrementally(Edited, Offset, 0));
+
+  // Neither can a change of style.
+  Style.ColumnLimit = 10;
+  Offset = Edited.find("b;");
+  EXPECT_EQ(format(Edited, Offset, 0), FormatIncrementally(Edited, Offset, 0));
+  EXPECT_EQ(0u, State.WindowBegin);
+  EXPECT_EQ(Edited.size(), State.WindowEnd);
+}
+
+TEST_F(FormatTestSelective, IncrementalFormattingInsideNamespaces) {
+  IncrementalFormatState State;
+  auto FormatIncrementally = [&](StringRef Code, unsigned Offset,
+                                 unsigned Length) {
+    std::vector<tooling::Range> Ranges(1, tooling::Range(Offset, Length));
+    tooling::Replacements Replaces = reformat(Style, Code, Ranges, State);
+    auto Result = applyAllReplacements(Code, Replaces);
+    EXPECT_TRUE(static_cast<bool>(Result));
+    return *Result;
+  };
+
+  std::string Code = "namespace a {\n"
+                     "namespace b {\n"
+                     "int  x;\n"
+                     "\n"
+                     "void f() {\n"
+                     "  int  y;\n"
+                     "}\n"
+                     "\n"
+                     "int  z;\n"
+                     "} // namespace b\n"
+                     "\n"
+                     "int  w;\n"
+                     "} // namespace a\n";
+  EXPECT_EQ(format(Code, 0, 0), FormatIncrementally(Code, 0, 0));
+
+  // Only f() is lexed and parsed, although it is not at the top level.
+  std::string Edited = Code;
+  Edited.replace(Edited.find("int  y;"), 7, "int  y  =  1;");
+  unsigned Offset = Edited.find("y  =");
+  EXPECT_EQ(format(Edited, Offset, 0), FormatIncrementally(Edited, Offset, 0));
+  EXPECT_EQ(Edited.find("\n\nvoid f"), State.WindowBegin);
+  EXPECT_EQ(Edited.find("\n\nint  z"), State.WindowEnd);
+
+  // A window cannot end past the '}' of its namespace. The last declaration
+  // of namespace b has no sync point after it in b, nor does namespace a
+  // have one before b, so the whole file is formatted.
+  Edited.replace(Edited.find("int  z;"), 7, "int  z  =  2;");
+  Offset = Edited.find("z  =");
+  EXPECT_EQ(format(Edited, Offset, 0), FormatIncrementally(Edited, Offset, 0));
+  EXPECT_EQ(0u, State.WindowBegin);
+  EXPECT_EQ(Edited.size(), State.WindowEnd);
+}
+
 TEST_F(FormatTestSelective, SelectivelyRequoteJavaScript) {
   Style = getGoogleStyle(FormatStyle::LK_JavaScript);
   EXPECT_EQ(
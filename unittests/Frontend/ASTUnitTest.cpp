@@ -0,0 +1,131 @@
+//===- unittests/Frontend/ASTUnitTest.cpp - ASTUnit tests -----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "gtest/gtest.h"
+#include <set>
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+class ASTUnitPreambleTest : public ::testing::Test {
+  std::set<std::string> Files;
+
+protected:
+  std::string TestDir;
+  std::shared_ptr<PCHContainerOperations> PCHContainerOps =
+      std::make_shared<PCHContainerOperations>();
+
+  void SetUp() override {
+    SmallString<256> Dir;
+    ASSERT_FALSE(sys::fs::createUniqueDirectory("astunit-test", Dir));
+    TestDir = Dir.str();
+  }
+
+  void TearDown() override {
+    for (const std::string &Path : Files)
+      sys::fs::remove(Path);
+    sys::fs::remove(TestDir);
+  }
+
+  std::string writeFile(StringRef Name, StringRef Contents) {
+    SmallString<256> Path(TestDir);
+    sys::path::append(Path, Name);
+    std::error_code EC;
+    raw_fd_ostream OS(Path, EC, sys::fs::F_Text);
+    EXPECT_FALSE(EC);
+    OS << Contents;
+    Files.insert(Path.str());
+    return Path.str();
+  }
+
+  /// Parses \p MainFile with \p Args, precompiling its preamble right away.
+  std::unique_ptr<ASTUnit> parse(const std::string &MainFile,
+                                 std::vector<const char *> Args = {}) {
+    Args.insert(Args.begin(), {"clang", MainFile.c_str()});
+    IntrusiveRefCntPtr<DiagnosticsEngine> Diags =
+        CompilerInstance::createDiagnostics(new DiagnosticOptions());
+    return std::unique_ptr<ASTUnit>(ASTUnit::LoadFromCommandLine(
+        Args.data(), Args.data() + Args.size(), PCHContainerOps, Diags, "",
+        /*OnlyLocalDecls=*/false, /*CaptureDiagnostics=*/true, None,
+        /*RemappedFilesKeepOriginalName=*/true,
+        /*PrecompilePreambleAfterNParses=*/1));
+  }
+
+  /// Reparses \p AST with \p MainFile holding \p Contents.
+  bool reparse(ASTUnit &AST, const std::string &MainFile, StringRef Contents) {
+    std::unique_ptr<MemoryBuffer> Buffer =
+        MemoryBuffer::getMemBufferCopy(Contents, MainFile);
+    ASTUnit::RemappedFile Remapped(MainFile, Buffer.release());
+    return !AST.Reparse(PCHContainerOps, Remapped);
+  }
+};
+
+TEST_F(ASTUnitPreambleTest, SharedBetweenUnitsOfTheSameFile) {
+  writeFile("header.h", "int unused(void) { int x; return 0; }\n");
+  std::string Main = writeFile("main.c", "#include \"header.h\"\n"
+                                         "int y;\n");
+
+  std::unique_ptr<ASTUnit> First = parse(Main, {"-Wunused-variable"});
+  ASSERT_TRUE(First);
+  ASSERT_EQ(1u, First->getPreamblePCHFiles().size());
+  EXPECT_EQ(1u, First->stored_diag_size());
+
+  std::unique_ptr<ASTUnit> Second = parse(Main, {"-Wunused-variable"});
+  ASSERT_TRUE(Second);
+  EXPECT_EQ(First->getPreamblePCHFiles(), Second->getPreamblePCHFiles());
+  EXPECT_EQ(1u, Second->stored_diag_size());
+
+  // -w changes the diagnostics stored with the preamble, so it gets a
+  // preamble of its own, without the warning.
+  std::unique_ptr<ASTUnit> Quiet = parse(Main, {"-Wunused-variable", "-w"});
+  ASSERT_TRUE(Quiet);
+  ASSERT_EQ(1u, Quiet->getPreamblePCHFiles().size());
+  EXPECT_NE(First->getPreamblePCHFiles(), Quiet->getPreamblePCHFiles());
+  EXPECT_EQ(0u, Quiet->stored_diag_size());
+}
+
+TEST_F(ASTUnitPreambleTest, ChainedPreambleReusesItsBase) {
+  writeFile("a.h", "int a;\n");
+  writeFile("b.h", "int b;\n");
+  writeFile("c.h", "int c;\n");
+  const char *WithB = "#include \"a.h\"\n#include \"b.h\"\nint x;\n";
+  const char *WithC = "#include \"a.h\"\n#include \"c.h\"\nint x;\n";
+  std::string Main = writeFile("chain.c", WithB);
+
+  std::unique_ptr<ASTUnit> AST = parse(Main);
+  ASSERT_TRUE(AST);
+  AST->setChainPreambles(true);
+
+  // Editing the last #include precompiles the preamble as a chain.
+  ASSERT_TRUE(reparse(*AST, Main, WithC));
+  std::vector<std::string> Chain = AST->getPreamblePCHFiles();
+  ASSERT_EQ(2u, Chain.size());
+
+  // Editing it again only precompiles the end of the chain.
+  ASSERT_TRUE(reparse(*AST, Main, WithB));
+  std::vector<std::string> Rechained = AST->getPreamblePCHFiles();
+  ASSERT_EQ(2u, Rechained.size());
+  EXPECT_EQ(Chain[0], Rechained[0]);
+
+  // A unit that does not chain its preamble does not share the chain.
+  std::unique_ptr<ASTUnit> Unchained = parse(Main);
+  ASSERT_TRUE(Unchained);
+  EXPECT_EQ(1u, Unchained->getPreamblePCHFiles().size());
+}
+
+} // anonymous namespace
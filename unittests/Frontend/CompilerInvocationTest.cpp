@@ -0,0 +1,74 @@
+//===- unittests/Frontend/CompilerInvocationTest.cpp - Invocation tests ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Frontend/TextDiagnosticBuffer.h"
+#include "gtest/gtest.h"
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+TEST(CompilerInvocationTest, CreateFromArgsCachedKeepsFiles) {
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  DiagnosticsEngine Diags(new DiagnosticIDs(), &*DiagOpts,
+                          new TextDiagnosticBuffer());
+
+  const char *First[] = {"-emit-obj", "-O2", "-DFOO=1", "-main-file-name",
+                         "a.c", "-o", "a.o", "a.c"};
+  const char *Second[] = {"-emit-obj", "-O2", "-DFOO=1", "-main-file-name",
+                          "b.c", "-o", "b.o", "b.c"};
+
+  CompilerInvocation A, B;
+  ASSERT_TRUE(CompilerInvocation::CreateFromArgsCached(
+      A, std::begin(First), std::end(First), Diags));
+  ASSERT_TRUE(CompilerInvocation::CreateFromArgsCached(
+      B, std::begin(Second), std::end(Second), Diags));
+
+  ASSERT_EQ(1u, B.getFrontendOpts().Inputs.size());
+  EXPECT_EQ("b.c", B.getFrontendOpts().Inputs[0].getFile());
+  EXPECT_EQ(IK_C, B.getFrontendOpts().Inputs[0].getKind());
+  EXPECT_EQ("b.o", B.getFrontendOpts().OutputFile);
+  EXPECT_EQ("b.c", B.getCodeGenOpts().MainFileName);
+  EXPECT_EQ(2u, B.getCodeGenOpts().OptimizationLevel);
+  ASSERT_EQ(1u, B.getPreprocessorOpts().Macros.size());
+  EXPECT_EQ("FOO=1", B.getPreprocessorOpts().Macros[0].first);
+
+  // Each invocation has its own options.
+  EXPECT_NE(A.getLangOpts(), B.getLangOpts());
+  EXPECT_NE(&A.getPreprocessorOpts(), &B.getPreprocessorOpts());
+  EXPECT_EQ("a.c", A.getFrontendOpts().Inputs[0].getFile());
+  EXPECT_EQ("a.o", A.getFrontendOpts().OutputFile);
+}
+
+TEST(CompilerInvocationTest, CreateFromArgsCachedReportsEveryWarning) {
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts = new DiagnosticOptions();
+  DiagnosticsEngine Diags(new DiagnosticIDs(), &*DiagOpts,
+                          new TextDiagnosticBuffer());
+
+  // -O5 is parsed as -O3, with a warning.
+  const char *First[] = {"-emit-obj", "-O5", "-o", "c.o", "c.c"};
+  const char *Second[] = {"-emit-obj", "-O5", "-o", "d.o", "d.c"};
+
+  CompilerInvocation C, D;
+  ASSERT_TRUE(CompilerInvocation::CreateFromArgsCached(
+      C, std::begin(First), std::end(First), Diags));
+  EXPECT_EQ(1u, Diags.getNumWarnings());
+  ASSERT_TRUE(CompilerInvocation::CreateFromArgsCached(
+      D, std::begin(Second), std::end(Second), Diags));
+  EXPECT_EQ(2u, Diags.getNumWarnings());
+
+  ASSERT_EQ(1u, D.getFrontendOpts().Inputs.size());
+  EXPECT_EQ("d.c", D.getFrontendOpts().Inputs[0].getFile());
+  EXPECT_EQ(3u, D.getCodeGenOpts().OptimizationLevel);
+}
+
+} // anonymous namespace
@@ -0,0 +1,87 @@
+//===- unittests/Index/USRGenerationTest.cpp - USR generation tests -------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Index/USRGeneration.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+using namespace clang::index;
+
+namespace {
+
+class DeclCollector : public RecursiveASTVisitor<DeclCollector> {
+public:
+  std::vector<const Decl *> Decls;
+
+  bool shouldVisitTemplateInstantiations() const { return true; }
+
+  bool VisitNamedDecl(NamedDecl *D) {
+    Decls.push_back(D);
+    return true;
+  }
+};
+
+std::vector<const Decl *> collectDecls(ASTUnit &AST) {
+  DeclCollector Collector;
+  Collector.TraverseDecl(AST.getASTContext().getTranslationUnitDecl());
+  return Collector.Decls;
+}
+
+const char *const Code =
+    "namespace outer { namespace inner {\n"
+    "struct S { int field; void method(int, S *); struct Nested { int x; }; };\n"
+    "template <typename T> struct Tmpl { T member; void get(T, T); };\n"
+    "template <> struct Tmpl<int *> { int *special; };\n"
+    "Tmpl<float> use;\n"
+    "void overloaded(int, int);\n"
+    "void overloaded(S, S);\n"
+    "} }\n"
+    "static int internal_var;\n"
+    "static void internal_func(int param) { int local; struct L { int y; }; }\n"
+    "namespace { struct Anon { int z; }; }\n"
+    "enum E { Enumerator };\n"
+    "struct { int unnamed_field; } unnamed_var;\n";
+
+TEST(USRGenerationTest, CacheMatchesGenerateUSRForDecl) {
+  std::unique_ptr<ASTUnit> AST = tooling::buildASTFromCode(Code);
+  ASSERT_TRUE(AST.get());
+
+  std::vector<const Decl *> Decls = collectDecls(*AST);
+  ASSERT_FALSE(Decls.empty());
+
+  // Ask for the innermost declarations first, so that their contexts are
+  // generated through the cache, and again in source order.
+  USRCache Cache;
+  for (auto I = Decls.rbegin(), E = Decls.rend(); I != E; ++I)
+    Cache.getUSR(*I);
+
+  for (const Decl *D : Decls) {
+    SmallString<128> USR;
+    bool Ignore = generateUSRForDecl(D, USR);
+    StringRef Cached = Cache.getUSR(D);
+    if (Ignore) {
+      EXPECT_TRUE(Cached.empty());
+      continue;
+    }
+    EXPECT_EQ(USR.str(), Cached);
+    EXPECT_EQ('\0', Cached.data()[Cached.size()]);
+    EXPECT_EQ(hashUSR(USR), Cache.getUSRHash(D));
+  }
+}
+
+TEST(USRGenerationTest, HashUSR) {
+  EXPECT_EQ(hashUSR("c:@F@f#"), hashUSR("c:@F@f#"));
+  EXPECT_NE(hashUSR("c:@F@f#"), hashUSR("c:@F@g#"));
+}
+
+} // end anonymous namespace
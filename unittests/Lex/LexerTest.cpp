@@ -380,4 +380,39 @@ TEST_F(LexerTest, DontMergeMacroArgsFromDifferentMacroFiles) {
   EXPECT_EQ(SourceMgr.getFileIDSize(SourceMgr.getFileID(helper1ArgLoc)), 8U);
 }
 
+TEST_F(LexerTest, MinimizeSourceToDependencyDirectives) {
+  LangOpts.LineComment = true;
+  SmallString<128> Out;
+  EXPECT_EQ(4U, Lexer::minimizeSourceToDependencyDirectives(
+                    "#include <a//b.h> // trailing\n"
+                    "int x = '#';\n"
+                    "  #  define A(x) \\\n"
+                    "    x /* kept */ + 1\n"
+                    "void f() { /*\n#define B\n*/ }\n"
+                    "#if A(1)\n"
+                    "#endif",
+                    Out, LangOpts));
+  EXPECT_EQ("#include <a//b.h>\n"
+            "#  define A(x) \\\n"
+            "    x /* kept */ + 1\n"
+            "#if A(1)\n"
+            "#endif\n",
+            Out.str());
+}
+
+TEST_F(LexerTest, MinimizeSourceKeepsModuleImports) {
+  LangOpts.ObjC1 = true;
+  SmallString<128> Out;
+  EXPECT_EQ(3U, Lexer::minimizeSourceToDependencyDirectives(
+                    "@import A.B; int x;\n"
+                    "@interface I @end\n"
+                    "@import C\n"
+                    "#include \"c.h\"\n",
+                    Out, LangOpts));
+  EXPECT_EQ("@import A.B;\n"
+            "@import C\n"
+            "#include \"c.h\"\n",
+            Out.str());
+}
+
 } // anonymous namespace
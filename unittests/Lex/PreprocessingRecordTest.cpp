@@ -0,0 +1,152 @@
+//===- unittests/Lex/PreprocessingRecordTest.cpp - PP record tests --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Lex/PreprocessingRecord.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/LangOptions.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Basic/TargetOptions.h"
+#include "clang/Lex/HeaderSearch.h"
+#include "clang/Lex/HeaderSearchOptions.h"
+#include "clang/Lex/ModuleLoader.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Lex/PreprocessorOptions.h"
+#include "gtest/gtest.h"
+
+using namespace clang;
+
+namespace {
+
+// The test fixture.
+class PreprocessingRecordTest : public ::testing::Test {
+protected:
+  PreprocessingRecordTest()
+    : FileMgr(FileMgrOpts),
+      DiagID(new DiagnosticIDs()),
+      Diags(DiagID, new DiagnosticOptions, new IgnoringDiagConsumer()),
+      SourceMgr(Diags, FileMgr),
+      TargetOpts(new TargetOptions)
+  {
+    TargetOpts->Triple = "x86_64-apple-darwin11.1.0";
+    Target = TargetInfo::CreateTargetInfo(Diags, TargetOpts);
+  }
+
+  FileSystemOptions FileMgrOpts;
+  FileManager FileMgr;
+  IntrusiveRefCntPtr<DiagnosticIDs> DiagID;
+  DiagnosticsEngine Diags;
+  SourceManager SourceMgr;
+  LangOptions LangOpts;
+  std::shared_ptr<TargetOptions> TargetOpts;
+  IntrusiveRefCntPtr<TargetInfo> Target;
+};
+
+class VoidModuleLoader : public ModuleLoader {
+  ModuleLoadResult loadModule(SourceLocation ImportLoc,
+                              ModuleIdPath Path,
+                              Module::NameVisibilityKind Visibility,
+                              bool IsInclusionDirective) override {
+    return ModuleLoadResult();
+  }
+
+  void makeModuleVisible(Module *Mod,
+                         Module::NameVisibilityKind Visibility,
+                         SourceLocation ImportLoc) override { }
+
+  GlobalModuleIndex *loadGlobalModuleIndex(SourceLocation TriggerLoc) override
+    { return nullptr; }
+  bool lookupMissingImports(StringRef Name, SourceLocation TriggerLoc) override
+    { return 0; }
+};
+
+TEST_F(PreprocessingRecordTest, MacroExpansions) {
+  const char *source =
+      "#define M1 1\n"
+      "#define M2 2\n"
+      "#define FM(x,y) y x\n"
+      "M1\n"
+      "FM(M1, M2)\n"
+      "__LINE__\n"
+      "M2\n";
+
+  std::unique_ptr<llvm::MemoryBuffer> Buf =
+      llvm::MemoryBuffer::getMemBuffer(source);
+  SourceMgr.setMainFileID(SourceMgr.createFileID(std::move(Buf)));
+
+  VoidModuleLoader ModLoader;
+  HeaderSearch HeaderInfo(new HeaderSearchOptions, SourceMgr, Diags, LangOpts,
+                          Target.get());
+  Preprocessor PP(new PreprocessorOptions(), Diags, LangOpts, SourceMgr,
+                  HeaderInfo, ModLoader,
+                  /*IILookup =*/nullptr,
+                  /*OwnsHeaderSearch =*/false);
+  PP.Initialize(*Target);
+  PP.createPreprocessingRecord();
+  PreprocessingRecord *PPRec = PP.getPreprocessingRecord();
+  PP.EnterMainSourceFile();
+
+  while (1) {
+    Token tok;
+    PP.Lex(tok);
+    if (tok.is(tok::eof))
+      break;
+  }
+
+  // Three definitions, then M1, FM, M1, M2 (the arguments of FM are expanded
+  // out of order but recorded in source order), __LINE__ and M2.
+  ASSERT_EQ(9U, PPRec->getNumLocalPreprocessedEntities());
+
+  const char *Expected[] = {"M1", "M2", "FM", "M1", "FM", "M1",
+                            "M2", "__LINE__", "M2"};
+  MacroDefinitionRecord *Defs[3];
+  for (unsigned I = 0; I != 3; ++I) {
+    auto *MD = dyn_cast<MacroDefinitionRecord>(
+        PPRec->getLocalPreprocessedEntity(I));
+    ASSERT_TRUE(MD != nullptr);
+    EXPECT_EQ(Expected[I], MD->getName()->getName());
+    Defs[I] = MD;
+  }
+
+  // Expansions can be inspected without creating their objects.
+  EXPECT_EQ(Defs[0], PPRec->getLocalMacroExpansionDefinition(3));
+  EXPECT_EQ(Defs[2], PPRec->getLocalMacroExpansionDefinition(4));
+  EXPECT_EQ(Defs[0], PPRec->getLocalMacroExpansionDefinition(5));
+  EXPECT_EQ(Defs[1], PPRec->getLocalMacroExpansionDefinition(6));
+  EXPECT_TRUE(PPRec->getLocalMacroExpansionDefinition(7) == nullptr);
+  EXPECT_EQ(Defs[1], PPRec->getLocalMacroExpansionDefinition(8));
+
+  for (unsigned I = 1; I != 9; ++I)
+    EXPECT_FALSE(SourceMgr.isBeforeInTranslationUnit(
+        PPRec->getLocalPreprocessedEntityRange(I).getBegin(),
+        PPRec->getLocalPreprocessedEntityRange(I - 1).getBegin()));
+
+  for (unsigned I = 3; I != 9; ++I) {
+    auto *ME = dyn_cast<MacroExpansion>(PPRec->getLocalPreprocessedEntity(I));
+    ASSERT_TRUE(ME != nullptr);
+    EXPECT_EQ(Expected[I], ME->getName()->getName());
+    EXPECT_EQ(I == 7, ME->isBuiltinMacro());
+    EXPECT_EQ(PPRec->getLocalPreprocessedEntityRange(I),
+              ME->getSourceRange());
+    // Creating the object keeps the compact answer intact.
+    EXPECT_EQ(ME->getDefinition(), PPRec->getLocalMacroExpansionDefinition(I));
+    EXPECT_EQ(ME, PPRec->getLocalPreprocessedEntity(I));
+  }
+
+  // Searching by location sees the same entities.
+  SourceRange Line5(PPRec->getLocalPreprocessedEntityRange(4).getBegin(),
+                    PPRec->getLocalPreprocessedEntityRange(4).getEnd());
+  auto Range = PPRec->getPreprocessedEntitiesInRange(Line5);
+  ASSERT_EQ(3, std::distance(Range.begin(), Range.end()));
+  EXPECT_EQ(PPRec->getLocalPreprocessedEntity(4), *Range.begin());
+}
+
+} // anonymous namespace
@@ -0,0 +1,44 @@
+//===- unittests/Rewrite/DeltaTreeTest.cpp - DeltaTree tests --------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/Rewrite/Core/DeltaTree.h"
+#include "gtest/gtest.h"
+#include <vector>
+
+using namespace llvm;
+using namespace clang;
+
+namespace {
+
+TEST(DeltaTree, BulkLoadMatchesAddDelta) {
+  // Cover a single leaf, a full leaf, and trees of several levels.
+  for (unsigned N : {0u, 1u, 31u, 32u, 1000u, 20000u}) {
+    std::vector<std::pair<unsigned, int>> Deltas;
+    for (unsigned I = 0; I != N; ++I)
+      Deltas.push_back(std::make_pair(3 * I + 1, int(I % 7) + 1));
+
+    DeltaTree Bulk(Deltas);
+    DeltaTree Incremental;
+    for (const auto &D : Deltas)
+      Incremental.AddDelta(D.first, D.second);
+    EXPECT_EQ(N == 0, Bulk.empty());
+
+    // Deltas added after a bulk load are placed correctly too.
+    for (unsigned I = 0; I != N; I += 5) {
+      Bulk.AddDelta(3 * I + 2, 1);
+      Incremental.AddDelta(3 * I + 2, 1);
+    }
+
+    for (unsigned Index = 0; Index != 3 * N + 3; ++Index)
+      ASSERT_EQ(Incremental.getDeltaAt(Index), Bulk.getDeltaAt(Index))
+          << "with " << N << " deltas at index " << Index;
+  }
+}
+
+} // anonymous namespace
@@ -48,4 +48,48 @@ TEST(RewriteBuffer, TagRanges) {
   EXPECT_EQ(Output, Result);
 }
 
+static std::string toString(const RewriteBuffer &Buf) {
+  std::string Result;
+  raw_string_ostream OS(Result);
+  Buf.write(OS);
+  return OS.str();
+}
+
+TEST(RewriteBuffer, ApplyEdits) {
+  StringRef Input = "int a = b + c;";
+
+  RewriteBuffer Buf;
+  Buf.Initialize(Input);
+  Buf.InsertTextBefore(0, "const ");
+  RewriteBuffer::Edit Edits[] = {{4, 1, "x"}, {8, 0, "(y"}, {12, 1, "z)"}};
+  Buf.ApplyEdits(Edits);
+  EXPECT_EQ("const int x = (yb + z);", toString(Buf));
+
+  // Later edits are still mapped through the batch.
+  Buf.ReplaceText(10, 1, "-");
+  EXPECT_EQ("const int x = (yb - z);", toString(Buf));
+}
+
+static void expectSameAsReplaceText(StringRef Input,
+                                    ArrayRef<RewriteBuffer::Edit> Edits) {
+  RewriteBuffer Buf;
+  Buf.Initialize(Input);
+  Buf.ApplyEdits(Edits);
+
+  RewriteBuffer Expected;
+  Expected.Initialize(Input);
+  for (const RewriteBuffer::Edit &E : Edits)
+    Expected.ReplaceText(E.OrigOffset, E.OrigLength, E.NewStr);
+  EXPECT_EQ(toString(Expected), toString(Buf));
+}
+
+TEST(RewriteBuffer, ApplyEditsFallback) {
+  // Unsorted and overlapping.
+  expectSameAsReplaceText("int a = b + c;",
+                          {{12, 1, "z"}, {4, 1, "x"}, {4, 5, "y"}});
+  // Sorted, with two edits at the same offset.
+  expectSameAsReplaceText("int a = b + c;",
+                          {{4, 0, "x"}, {4, 1, "y"}, {12, 1, "z"}});
+}
+
 } // anonymous namespace
@@ -14,7 +14,9 @@
 #include "clang/Tooling/FileMatchTrie.h"
 #include "clang/Tooling/JSONCompilationDatabase.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 
 namespace clang {
@@ -172,22 +174,75 @@ TEST(JSONCompilationDatabase, ArgumentsPreferredOverCommand) {
    EXPECT_EQ(Arguments, FoundCommand.CommandLine[0]) << ErrorMessage;
 }
 
+TEST(JSONCompilationDatabase, UnescapesStrings) {
+  std::string ErrorMessage;
+  CompileCommand FoundCommand = findCompileArgsInJsonDatabase(
+      "//net/dir/file\xc3\xa9",
+      "[{\"directory\":\"//net/dir\","
+      "\"arguments\":[\"-DA=\\\"a\\\"\", \"-DB=\\\\\\t\\n\"],"
+      "\"file\":\"file\\u00e9\"}]",
+      ErrorMessage);
+  ASSERT_EQ(2u, FoundCommand.CommandLine.size()) << ErrorMessage;
+  EXPECT_EQ("-DA=\"a\"", FoundCommand.CommandLine[0]);
+  EXPECT_EQ("-DB=\\\t\n", FoundCommand.CommandLine[1]);
+}
+
+TEST(JSONCompilationDatabase, LoadsIndexCache) {
+  SmallString<128> Path;
+  ASSERT_FALSE(llvm::sys::fs::createTemporaryFile("compile_commands", "json",
+                                                  Path));
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(Path, EC, llvm::sys::fs::F_None);
+    ASSERT_FALSE(EC);
+    OS << "[{\"directory\":\"//net/dir\",\"command\":\"cc a.c\","
+          "\"file\":\"a.c\"},"
+          "{\"directory\":\"//net/dir\",\"command\":\"cc b.c\","
+          "\"file\":\"b.c\"}]";
+  }
+  std::string IndexPath = (Path + ".index").str();
+
+  for (int Load = 0; Load != 2; ++Load) {
+    std::string ErrorMessage;
+    std::unique_ptr<CompilationDatabase> Database(
+        JSONCompilationDatabase::loadFromFile(Path, ErrorMessage,
+                                              /*UseIndexCache=*/true));
+    ASSERT_TRUE(Database) << ErrorMessage;
+    EXPECT_TRUE(llvm::sys::fs::exists(IndexPath));
+    std::vector<CompileCommand> Commands = Database->getAllCompileCommands();
+    ASSERT_EQ(2u, Commands.size());
+    EXPECT_EQ("b.c", Commands[1].Filename);
+    SmallString<16> NativePath;
+    llvm::sys::path::native("//net/dir/a.c", NativePath);
+    Commands = Database->getCompileCommands(NativePath);
+    ASSERT_EQ(1u, Commands.size());
+    EXPECT_EQ("a.c", Commands[0].CommandLine[1]);
+  }
+
+  llvm::sys::fs::remove(IndexPath);
+  llvm::sys::fs::remove(Path);
+}
+
 struct FakeComparator : public PathComparator {
+  FakeComparator() : NumComparisons(0) {}
   ~FakeComparator() override {}
   bool equivalent(StringRef FileA, StringRef FileB) const override {
+    ++NumComparisons;
     return FileA.equals_lower(FileB);
   }
+  mutable unsigned NumComparisons;
 };
 
 class FileMatchTrieTest : public ::testing::Test {
 protected:
-  FileMatchTrieTest() : Trie(new FakeComparator()) {}
+  FileMatchTrieTest() : Comparator(new FakeComparator()), Trie(Comparator) {}
 
   StringRef find(StringRef Path) {
     llvm::raw_string_ostream ES(Error);
     return Trie.findEquivalent(Path, ES);
   }
 
+  FakeComparator *Comparator;
   FileMatchTrie Trie;
   std::string Error;
 };
@@ -213,6 +268,22 @@ TEST_F(FileMatchTrieTest, HandlesSymlinks) {
   EXPECT_EQ("//net/AA/file.cc", find("//net/aa/file.cc"));
 }
 
+TEST_F(FileMatchTrieTest, RemembersMatches) {
+  Trie.insert("//net/path/file.cc");
+  Trie.insert("//net/other/file.cc");
+  EXPECT_EQ("//net/path/file.cc", find("//net/path/file.cc"));
+  EXPECT_EQ(0u, Comparator->NumComparisons);
+
+  EXPECT_EQ("//net/path/file.cc", find("//net/PATH/file.cc"));
+  unsigned NumComparisons = Comparator->NumComparisons;
+  EXPECT_EQ("//net/path/file.cc", find("//net/PATH/file.cc"));
+  EXPECT_EQ(NumComparisons, Comparator->NumComparisons);
+
+  // An insert can change the match.
+  Trie.insert("//net/PATH/file.cc");
+  EXPECT_EQ("//net/PATH/file.cc", find("//net/PATH/file.cc"));
+}
+
 TEST_F(FileMatchTrieTest, ReportsSymlinkAmbiguity) {
   Trie.insert("//net/Aa/file.cc");
   Trie.insert("//net/aA/file.cc");
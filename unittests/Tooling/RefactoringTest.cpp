@@ -21,8 +21,10 @@
 #include "clang/Format/Format.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/FrontendActions.h"
 #include "clang/Frontend/TextDiagnosticPrinter.h"
 #include "clang/Rewrite/Core/Rewriter.h"
+#include "clang/Tooling/CompilationDatabase.h"
 #include "clang/Tooling/Refactoring.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/SmallString.h"
@@ -121,6 +123,25 @@ TEST_F(ReplacementTest, CanApplyReplacements) {
   EXPECT_EQ("line1\nreplaced\nother\nline4", Context.getRewrittenText(ID));
 }
 
+TEST_F(ReplacementTest, CanApplyInterleavedReplacementsOfSeveralFiles) {
+  // Replacements are ordered by offset first, so these alternate between the
+  // two files.
+  FileID ID1 = Context.createInMemoryFile("input1.cpp", "aa bb cc");
+  FileID ID2 = Context.createInMemoryFile("input2.cpp", "dd ee ff");
+  Replacements Replaces;
+  Replaces.insert(Replacement(Context.Sources, Context.getLocation(ID1, 1, 1),
+                              2, "x"));
+  Replaces.insert(Replacement(Context.Sources, Context.getLocation(ID2, 1, 4),
+                              2, "yyy"));
+  Replaces.insert(Replacement(Context.Sources, Context.getLocation(ID1, 1, 7),
+                              2, "zzzz"));
+  Replaces.insert(Replacement(Context.Sources, Context.getLocation(ID2, 1, 1),
+                              0, "w"));
+  EXPECT_TRUE(applyAllReplacements(Replaces, Context.Rewrite));
+  EXPECT_EQ("x bb zzzz", Context.getRewrittenText(ID1));
+  EXPECT_EQ("wdd yyy ff", Context.getRewrittenText(ID2));
+}
+
 // FIXME: Remove this test case when Replacements is implemented as std::vector
 // instead of std::set. The other ReplacementTest tests will need to be updated
 // at that point as well.
@@ -252,6 +273,51 @@ TEST(ShiftedCodePositionTest, FindsNewCodePositionInReplacedText) {
     EXPECT_EQ(i, shiftedCodePosition(Replaces, i));
 }
 
+/// \brief Replaces the first word of each translation unit through
+/// RefactoringTool::addReplacements.
+class ReplaceFirstWordAction : public SyntaxOnlyAction {
+  RefactoringTool &Tool;
+
+public:
+  explicit ReplaceFirstWordAction(RefactoringTool &Tool) : Tool(Tool) {}
+
+  void EndSourceFileAction() override {
+    Replacements Replaces;
+    Replaces.insert(Replacement(getCurrentFile(), 0, 3, "long"));
+    Tool.addReplacements(Replaces);
+  }
+};
+
+class ReplaceFirstWordActionFactory : public FrontendActionFactory {
+  RefactoringTool &Tool;
+
+public:
+  explicit ReplaceFirstWordActionFactory(RefactoringTool &Tool) : Tool(Tool) {}
+
+  FrontendAction *create() override { return new ReplaceFirstWordAction(Tool); }
+};
+
+#ifndef LLVM_ON_WIN32
+TEST(RefactoringToolTest, MergesReplacementsOfParallelRun) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+  std::vector<std::string> Sources;
+  for (char C = 'a'; C <= 'h'; ++C)
+    Sources.push_back(std::string("/") + C + ".cc");
+  RefactoringTool Tool(Compilations, Sources);
+  Tool.setThreadCount(4);
+  for (const std::string &Source : Sources)
+    Tool.mapVirtualFile(Source, "int x;");
+
+  ReplaceFirstWordActionFactory Factory(Tool);
+  EXPECT_EQ(0, Tool.run(&Factory));
+
+  Replacements Expected;
+  for (const std::string &Source : Sources)
+    Expected.insert(Replacement(Source, 0, 3, "long"));
+  EXPECT_EQ(Expected, Tool.getReplacements());
+}
+#endif
+
 class FlushRewrittenFilesTest : public ::testing::Test {
 public:
    FlushRewrittenFilesTest() {}
@@ -314,6 +380,25 @@ TEST_F(FlushRewrittenFilesTest, StoresChangesOnDisk) {
             getFileContentFromDisk("input.cpp"));
 }
 
+TEST_F(FlushRewrittenFilesTest, AppliesReplacementsToFiles) {
+  createFile("a.cpp", "line1\nline2\nline3\nline4");
+  createFile("b.cpp", "int x;");
+  std::string PathA = TemporaryFiles.lookup("a.cpp");
+  std::string PathB = TemporaryFiles.lookup("b.cpp");
+  Replacements Replaces;
+  Replaces.insert(Replacement(PathA, 6, 5, "replaced"));
+  Replaces.insert(Replacement(PathA, 0, 0, "// "));
+  Replaces.insert(Replacement(PathB, 4, 1, "y"));
+  // An insertion goes before a replacement at the same offset.
+  Replaces.insert(Replacement(PathB, 4, 0, "x"));
+  bool AllApplied;
+  EXPECT_TRUE(applyAllReplacementsToFiles(Replaces, AllApplied, 2));
+  EXPECT_TRUE(AllApplied);
+  EXPECT_EQ("// line1\nreplaced\nline3\nline4",
+            getFileContentFromDisk("a.cpp"));
+  EXPECT_EQ("int xy;", getFileContentFromDisk("b.cpp"));
+}
+
 namespace {
 template <typename T>
 class TestVisitor : public clang::RecursiveASTVisitor<T> {
@@ -18,6 +18,8 @@
 #include "clang/Tooling/Tooling.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Config/llvm-config.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "gtest/gtest.h"
@@ -460,6 +462,86 @@ TEST(ClangToolTest, BuildASTs) {
   EXPECT_EQ(2u, ASTs.size());
 }
 
+TEST(ClangToolTest, BuildASTsInParallel) {
+  FixedCompilationDatabase Compilations("/", std::vector<std::string>());
+
+  std::vector<std::string> Sources;
+  for (char C = 'a'; C <= 'h'; ++C) {
+    Sources.push_back(std::string("/") + C + ".cc");
+  }
+  ClangTool Tool(Compilations, Sources);
+  Tool.setThreadCount(4);
+
+  Tool.mapVirtualFile("/h.h", "int h();");
+  for (const std::string &Source : Sources) {
+    Tool.mapVirtualFile(Source, "#include \"/h.h\"\nint x = h();");
+  }
+
+  std::vector<std::unique_ptr<ASTUnit>> ASTs;
+  EXPECT_EQ(0, Tool.buildASTs(ASTs));
+  EXPECT_EQ(Sources.size(), ASTs.size());
+}
+
+/// \brief Compiles each source from the directory containing it, against the
+/// "inc" directory next to it.
+class DirectoryCompilationDatabase : public CompilationDatabase {
+public:
+  std::vector<CompileCommand>
+  getCompileCommands(StringRef FilePath) const override {
+    StringRef FileName = llvm::sys::path::filename(FilePath);
+    return {CompileCommand(llvm::sys::path::parent_path(FilePath), FileName,
+                           {"clang-tool", "-Iinc", "-c", FileName.str()})};
+  }
+  std::vector<std::string> getAllFiles() const override { return {}; }
+  std::vector<CompileCommand> getAllCompileCommands() const override {
+    return {};
+  }
+};
+
+TEST(ClangToolTest, RunsCommandsInTheirDirectoriesInParallel) {
+  SmallString<128> Root;
+  ASSERT_FALSE(llvm::sys::fs::createUniqueDirectory("clang-tool", Root));
+
+  // More directories than threads, so that threads move between them.
+  std::vector<std::string> Directories, Sources, Headers, HeaderContents,
+      SourceContents;
+  for (char C = 'a'; C <= 'h'; ++C) {
+    std::string Name(1, C);
+    SmallString<128> Directory(Root);
+    llvm::sys::path::append(Directory, Name);
+    SmallString<128> Include(Directory);
+    llvm::sys::path::append(Include, "inc");
+    ASSERT_FALSE(llvm::sys::fs::create_directories(Include));
+    Directories.push_back(Directory.str());
+    llvm::sys::path::append(Directory, "main.cc");
+    Sources.push_back(Directory.str());
+    llvm::sys::path::append(Include, "inc.h");
+    Headers.push_back(Include.str());
+    HeaderContents.push_back("int " + Name + ";");
+    SourceContents.push_back("#include <inc.h>\nint x = " + Name + ";");
+  }
+  DirectoryCompilationDatabase Compilations;
+  ClangTool Tool(Compilations, Sources);
+  Tool.setThreadCount(2);
+  // Each source only compiles against the header of its own directory.
+  for (size_t I = 0, E = Sources.size(); I != E; ++I) {
+    Tool.mapVirtualFile(Headers[I], HeaderContents[I]);
+    Tool.mapVirtualFile(Sources[I], SourceContents[I]);
+  }
+
+  std::vector<std::unique_ptr<ASTUnit>> ASTs;
+  EXPECT_EQ(0, Tool.buildASTs(ASTs));
+  EXPECT_EQ(Sources.size(), ASTs.size());
+  for (const std::unique_ptr<ASTUnit> &AST : ASTs)
+    EXPECT_FALSE(AST->getDiagnostics().hasErrorOccurred());
+
+  for (const std::string &Directory : Directories) {
+    llvm::sys::fs::remove(Directory + "/inc");
+    llvm::sys::fs::remove(Directory);
+  }
+  llvm::sys::fs::remove(Root);
+}
+
 struct TestDiagnosticConsumer : public DiagnosticConsumer {
   TestDiagnosticConsumer() : NumDiagnosticsSeen(0) {}
   void HandleDiagnostic(DiagnosticsEngine::Level DiagLevel,
@@ -14,6 +14,7 @@
 #include "llvm/Support/raw_ostream.h"
 #include "gtest/gtest.h"
 #include <fstream>
+#include <map>
 #include <set>
 #define DEBUG_TYPE "libclang-test"
 
@@ -468,6 +469,54 @@ TEST_F(LibclangReparseTest, ReparseWithModule) {
   EXPECT_EQ(0U, clang_getNumDiagnostics(ClangTU));
 }
 
+TEST_F(LibclangReparseTest, ReparseKeepsPreambleCompletions) {
+  std::string HeaderName = "HeaderFile.h";
+  std::string CppName = "CppFile.cpp";
+  WriteFile(HeaderName, "int fromHeader();\n#define FROM_HEADER 1\n");
+  const char *CppFile = "#include \"HeaderFile.h\"\n"
+                        "int fromMain();\n"
+                        "void f() {\n\n}\n";
+  WriteFile(CppName, CppFile);
+
+  ClangTU = clang_parseTranslationUnit(Index, CppName.c_str(), nullptr, 0,
+                                       nullptr, 0, TUFlags);
+  // Build the preamble, and the cached completions along with it.
+  ASSERT_TRUE(ReparseTU(0, nullptr /* No unsaved files. */));
+
+  // Add a top-level declaration to the main file, which only changes the
+  // cached completions of the main file.
+  CppFile = "#include \"HeaderFile.h\"\n"
+            "int fromMain();\n"
+            "void f() {\n\n}\n"
+            "int alsoFromMain();\n";
+  WriteFile(CppName, CppFile);
+  ASSERT_TRUE(ReparseTU(0, nullptr /* No unsaved files. */));
+
+  CXCodeCompleteResults *Results = clang_codeCompleteAt(
+      ClangTU, CppName.c_str(), 4, 1, nullptr, 0,
+      clang_defaultCodeCompleteOptions());
+  ASSERT_TRUE(Results);
+  std::map<std::string, unsigned> Counts;
+  for (unsigned I = 0; I != Results->NumResults; ++I) {
+    CXCompletionString Completion = Results->Results[I].CompletionString;
+    for (unsigned C = 0, N = clang_getNumCompletionChunks(Completion); C != N;
+         ++C) {
+      if (clang_getCompletionChunkKind(Completion, C) !=
+          CXCompletionChunk_TypedText)
+        continue;
+      CXString Text = clang_getCompletionChunkText(Completion, C);
+      ++Counts[clang_getCString(Text)];
+      clang_disposeString(Text);
+    }
+  }
+  clang_disposeCodeCompleteResults(Results);
+
+  EXPECT_EQ(1U, Counts["fromHeader"]);
+  EXPECT_EQ(1U, Counts["FROM_HEADER"]);
+  EXPECT_EQ(1U, Counts["fromMain"]);
+  EXPECT_EQ(1U, Counts["alsoFromMain"]);
+}
+
 TEST_F(LibclangReparseTest, clang_parseTranslationUnit2FullArgv) {
   // Provide a fake GCC 99.9.9 standard library that always overrides any local
   // GCC installation.
@@ -442,6 +442,23 @@ public:
 
   /// Generate the intrinsic, returning code.
   std::string generate();
+  /// Generate the little-endian and big-endian definitions of a function
+  /// intrinsic separately, without preprocessor directives. BigNoSwap is
+  /// set to the big-endian non-swapping variant if other intrinsics call
+  /// this one, and left empty otherwise.
+  void generateLazy(std::string &Little, std::string &Big,
+                    std::string &BigNoSwap);
+  /// Return true if Sema can define the intrinsic on first use: it is a
+  /// function, and its definition does not use any macros, since the
+  /// parser does not expand them in a lazily parsed definition.
+  bool isLazy() const {
+    if (UseMacro)
+      return false;
+    for (auto *I : Dependencies)
+      if (I->UseMacro)
+        return false;
+    return true;
+  }
   /// Perform type checking and populate the dependency graph, but
   /// don't generate code yet.
   void indexBody();
@@ -506,6 +523,11 @@ class NeonEmitter {
                                 SmallVectorImpl<Intrinsic *> &Defs);
   void genIntrinsicRangeCheckCode(raw_ostream &OS,
                                   SmallVectorImpl<Intrinsic *> &Defs);
+  void createSortedIntrinsics(SmallVectorImpl<Intrinsic *> &Defs);
+  void emitDefinitions(raw_ostream &OS, SmallVector<Intrinsic *, 128> Defs,
+                       bool SkipLazy);
+  std::map<std::string, unsigned>
+  getGuardGroups(ArrayRef<Intrinsic *> Defs);
 
 public:
   /// Called by Intrinsic - this attempts to get an intrinsic that takes
@@ -541,6 +563,10 @@ public:
   // runHeader - Emit all the __builtin prototypes used in arm_neon.h
   void runHeader(raw_ostream &o);
 
+  // runLazy - Emit the table of function intrinsics that Sema defines on
+  // first use under -flazy-neon-intrinsics.
+  void runLazy(raw_ostream &o);
+
   // runTests - Emit tests for all the Neon intrinsics.
   void runTests(raw_ostream &o);
 };
@@ -1779,6 +1805,8 @@ Intrinsic::DagEmitter::emitDagArg(Init *Arg, std::string ArgName) {
 }
 
 std::string Intrinsic::generate() {
+  OS.str("");
+
   // Little endian intrinsics are simple and don't require any argument
   // swapping.
   OS << "#ifdef __LITTLE_ENDIAN__\n";
@@ -1806,6 +1834,25 @@ std::string Intrinsic::generate() {
   return OS.str();
 }
 
+void Intrinsic::generateLazy(std::string &Little, std::string &Big,
+                             std::string &BigNoSwap) {
+  assert(isLazy() && "intrinsic cannot be defined lazily");
+  OS.str("");
+  generateImpl(false, "", "");
+  Little = OS.str();
+
+  OS.str("");
+  generateImpl(true, "", "__noswap_");
+  Big = OS.str();
+
+  OS.str("");
+  BigNoSwap.clear();
+  if (NeededEarly) {
+    generateImpl(false, "__noswap_", "__noswap_");
+    BigNoSwap = OS.str();
+  }
+}
+
 void Intrinsic::generateImpl(bool ReverseArguments,
                              StringRef NamePrefix, StringRef CallPrefix) {
   CurrentRecord = R;
@@ -2190,6 +2237,131 @@ void NeonEmitter::runHeader(raw_ostream &OS) {
   genIntrinsicRangeCheckCode(OS, Defs);
 }
 
+/// createSortedIntrinsics - Create every intrinsic, index their bodies and
+/// sort them by guard and name, the order in which arm_neon.h defines them.
+void NeonEmitter::createSortedIntrinsics(SmallVectorImpl<Intrinsic *> &Defs) {
+  std::vector<Record *> RV = Records.getAllDerivedDefinitions("Inst");
+  for (auto *R : RV)
+    createIntrinsic(R, Defs);
+
+  for (auto *I : Defs)
+    I->indexBody();
+
+  std::stable_sort(
+      Defs.begin(), Defs.end(),
+      [](const Intrinsic *A, const Intrinsic *B) { return *A < *B; });
+}
+
+/// getGuardGroups - Number the distinct architectural guards of Defs. The
+/// header enables a group of lazily defined intrinsics by number once its
+/// guard has been checked.
+std::map<std::string, unsigned>
+NeonEmitter::getGuardGroups(ArrayRef<Intrinsic *> Defs) {
+  std::map<std::string, unsigned> Groups;
+  for (auto *I : Defs)
+    Groups.insert(std::make_pair(I->getGuard(), 0));
+  unsigned Group = 0;
+  for (auto &G : Groups)
+    G.second = Group++;
+  return Groups;
+}
+
+/// emitDefinitions - Emit the definitions of Defs, each after the ones it
+/// depends on, within its guard. If SkipLazy is set, omit the intrinsics that
+/// Sema can define on first use.
+void NeonEmitter::emitDefinitions(raw_ostream &OS,
+                                  SmallVector<Intrinsic *, 128> Defs,
+                                  bool SkipLazy) {
+  // Only emit a def when its requirements have been met.
+  // FIXME: This loop could be made faster, but it's fast enough for now.
+  bool MadeProgress = true;
+  std::string InGuard = "";
+  while (!Defs.empty() && MadeProgress) {
+    MadeProgress = false;
+
+    for (SmallVector<Intrinsic *, 128>::iterator I = Defs.begin();
+         I != Defs.end(); /*No step*/) {
+      bool DependenciesSatisfied = true;
+      for (auto *II : (*I)->getDependencies()) {
+        if (std::find(Defs.begin(), Defs.end(), II) != Defs.end())
+          DependenciesSatisfied = false;
+      }
+      if (!DependenciesSatisfied) {
+        // Try the next one.
+        ++I;
+        continue;
+      }
+
+      if (!SkipLazy || !(*I)->isLazy()) {
+        // Emit #endif/#if pair if needed.
+        if ((*I)->getGuard() != InGuard) {
+          if (!InGuard.empty())
+            OS << "#endif\n";
+          InGuard = (*I)->getGuard();
+          if (!InGuard.empty())
+            OS << "#if " << InGuard << "\n";
+        }
+
+        // Actually generate the intrinsic code.
+        OS << (*I)->generate();
+      }
+
+      MadeProgress = true;
+      I = Defs.erase(I);
+    }
+  }
+  assert(Defs.empty() && "Some requirements were not satisfied!");
+  if (!InGuard.empty())
+    OS << "#endif\n";
+
+  OS << "\n";
+}
+
+/// runLazy - Emit a NEON_LAZY_INTRINSIC(Name, Group, Little, Big) entry for
+/// every function intrinsic, with the source of its little-endian and
+/// big-endian definitions. Either definition may be empty if the intrinsic
+/// only exists for the other byte order.
+void NeonEmitter::runLazy(raw_ostream &OS) {
+  emitSourceFileHeader("ARM NEON intrinsics defined on first use", OS);
+
+  SmallVector<Intrinsic *, 128> Defs;
+  createSortedIntrinsics(Defs);
+  std::map<std::string, unsigned> Groups = getGuardGroups(Defs);
+
+  // The definitions are parsed after arm_neon.h has undefined __ai.
+  auto Expand = [](std::string Def) {
+    StringRef Ai("__ai ");
+    if (StringRef(Def).startswith(Ai))
+      Def = "static inline __attribute__((__always_inline__, __nodebug__)) " +
+            Def.substr(Ai.size());
+    return Def;
+  };
+  auto EmitEntry = [&](const std::string &Name, unsigned Group,
+                       const std::string &Little, const std::string &Big) {
+    OS << "NEON_LAZY_INTRINSIC(\"" << Name << "\", " << Group << ",\n  \"";
+    OS.write_escaped(Little);
+    OS << "\",\n  \"";
+    OS.write_escaped(Big);
+    OS << "\")\n";
+  };
+
+  OS << "#ifndef NEON_LAZY_INTRINSIC\n";
+  OS << "#error \"Define NEON_LAZY_INTRINSIC before including this file\"\n";
+  OS << "#endif\n\n";
+  for (auto *I : Defs) {
+    if (!I->isLazy())
+      continue;
+    std::string Little, Big, BigNoSwap;
+    I->generateLazy(Little, Big, BigNoSwap);
+    std::string Name = I->getMangledName(/*ForceClassS=*/true);
+    unsigned Group = Groups[I->getGuard()];
+    EmitEntry(Name, Group, Expand(Little), Expand(Big));
+    if (!BigNoSwap.empty())
+      EmitEntry("__noswap_" + Name, Group, "", Expand(BigNoSwap));
+  }
+  OS << "\n#undef NEON_LAZY_INTRINSIC\n";
+}
+
 /// run - Read the records in arm_neon.td and output arm_neon.h.  arm_neon.h
 /// is comprised of type definitions and function declarations.
 void NeonEmitter::run(raw_ostream &OS) {
@@ -2336,58 +2508,24 @@ void NeonEmitter::run(raw_ostream &OS) {
         "__nodebug__))\n\n";
 
   SmallVector<Intrinsic *, 128> Defs;
-  std::vector<Record *> RV = Records.getAllDerivedDefinitions("Inst");
-  for (auto *R : RV)
-    createIntrinsic(R, Defs);
-
-  for (auto *I : Defs)
-    I->indexBody();
-
-  std::stable_sort(
-      Defs.begin(), Defs.end(),
-      [](const Intrinsic *A, const Intrinsic *B) { return *A < *B; });
-
-  // Only emit a def when its requirements have been met.
-  // FIXME: This loop could be made faster, but it's fast enough for now.
-  bool MadeProgress = true;
-  std::string InGuard = "";
-  while (!Defs.empty() && MadeProgress) {
-    MadeProgress = false;
-
-    for (SmallVector<Intrinsic *, 128>::iterator I = Defs.begin();
-         I != Defs.end(); /*No step*/) {
-      bool DependenciesSatisfied = true;
-      for (auto *II : (*I)->getDependencies()) {
-        if (std::find(Defs.begin(), Defs.end(), II) != Defs.end())
-          DependenciesSatisfied = false;
-      }
-      if (!DependenciesSatisfied) {
-        // Try the next one.
-        ++I;
-        continue;
-      }
-
-      // Emit #endif/#if pair if needed.
-      if ((*I)->getGuard() != InGuard) {
-        if (!InGuard.empty())
-          OS << "#endif\n";
-        InGuard = (*I)->getGuard();
-        if (!InGuard.empty())
-          OS << "#if " << InGuard << "\n";
-      }
-
-      // Actually generate the intrinsic code.
-      OS << (*I)->generate();
-
-      MadeProgress = true;
-      I = Defs.erase(I);
-    }
+  createSortedIntrinsics(Defs);
+
+  // With -flazy-neon-intrinsics, Sema defines the function intrinsics when
+  // they are first used. The header only enables each group of them whose
+  // guard is satisfied, and defines what cannot be deferred.
+  OS << "#if __has_feature(lazy_neon_intrinsics)\n";
+  for (auto &G : getGuardGroups(Defs)) {
+    if (!G.first.empty())
+      OS << "#if " << G.first << "\n";
+    OS << "#pragma clang neon_lazy_intrinsics " << G.second << "\n";
+    if (!G.first.empty())
+      OS << "#endif\n";
   }
-  assert(Defs.empty() && "Some requirements were not satisfied!");
-  if (!InGuard.empty())
-    OS << "#endif\n";
-
   OS << "\n";
+  emitDefinitions(OS, Defs, /*SkipLazy=*/true);
+  OS << "#else\n\n";
+  emitDefinitions(OS, Defs, /*SkipLazy=*/false);
+  OS << "#endif /* __has_feature(lazy_neon_intrinsics) */\n\n";
   OS << "#undef __ai\n\n";
   OS << "#endif /* __ARM_NEON_H */\n";
 }
@@ -2399,6 +2537,9 @@ void EmitNeon(RecordKeeper &Records, raw_ostream &OS) {
 void EmitNeonSema(RecordKeeper &Records, raw_ostream &OS) {
   NeonEmitter(Records).runHeader(OS);
 }
+void EmitNeonLazy(RecordKeeper &Records, raw_ostream &OS) {
+  NeonEmitter(Records).runLazy(OS);
+}
 void EmitNeonTest(RecordKeeper &Records, raw_ostream &OS) {
   llvm_unreachable("Neon test generation no longer implemented!");
 }
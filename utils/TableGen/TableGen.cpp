@@ -52,6 +52,7 @@ enum ActionType {
   GenClangCommentCommandList,
   GenArmNeon,
   GenArmNeonSema,
+  GenArmNeonLazy,
   GenArmNeonTest,
   GenAttrDocs
 };
@@ -130,6 +131,8 @@ cl::opt<ActionType> Action(
         clEnumValN(GenArmNeon, "gen-arm-neon", "Generate arm_neon.h for clang"),
         clEnumValN(GenArmNeonSema, "gen-arm-neon-sema",
                    "Generate ARM NEON sema support for clang"),
+        clEnumValN(GenArmNeonLazy, "gen-arm-neon-lazy",
+                   "Generate ARM NEON intrinsics defined on first use"),
         clEnumValN(GenArmNeonTest, "gen-arm-neon-test",
                    "Generate ARM NEON tests for clang"),
         clEnumValN(GenAttrDocs, "gen-attr-docs",
@@ -228,6 +231,9 @@ bool ClangTableGenMain(raw_ostream &OS, RecordKeeper &Records) {
   case GenArmNeonSema:
     EmitNeonSema(Records, OS);
     break;
+  case GenArmNeonLazy:
+    EmitNeonLazy(Records, OS);
+    break;
   case GenArmNeonTest:
     EmitNeonTest(Records, OS);
     break;
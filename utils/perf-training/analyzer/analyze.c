@@ -0,0 +1,70 @@
+// RUN: %clang --analyze %s -o %t.plist
+// RUN: %clang --analyze -Xanalyzer -analyzer-checker=alpha.core,alpha.unix %s -o %t.plist
+
+// Code with the paths, allocations and pointer arithmetic that the static
+// analyzer explores.
+
+#include <stdlib.h>
+#include <string.h>
+
+struct Buffer {
+  char *Data;
+  size_t Size;
+  size_t Capacity;
+};
+
+static int reserve(struct Buffer *B, size_t Capacity) {
+  char *Data;
+  if (Capacity <= B->Capacity)
+    return 1;
+  Data = realloc(B->Data, Capacity);
+  if (!Data)
+    return 0;
+  B->Data = Data;
+  B->Capacity = Capacity;
+  return 1;
+}
+
+static int append(struct Buffer *B, const char *Text) {
+  size_t Length = strlen(Text);
+  if (!reserve(B, B->Size + Length + 1))
+    return 0;
+  memcpy(B->Data + B->Size, Text, Length + 1);
+  B->Size += Length;
+  return 1;
+}
+
+static char *duplicate(const struct Buffer *B, int Upper) {
+  char *Copy = malloc(B->Size + 1);
+  size_t I;
+  if (!Copy)
+    return NULL;
+  for (I = 0; I != B->Size; ++I) {
+    char C = B->Data[I];
+    if (Upper && C >= 'a' && C <= 'z')
+      C = (char)(C - 'a' + 'A');
+    Copy[I] = C;
+  }
+  Copy[B->Size] = 0;
+  return Copy;
+}
+
+int train(int argc, char **argv) {
+  struct Buffer B = {NULL, 0, 0};
+  char *Copy;
+  int I, Result = 0;
+  for (I = 0; I < argc; ++I) {
+    if (!append(&B, argv[I]))
+      goto out;
+    if (I + 1 != argc && !append(&B, " "))
+      goto out;
+  }
+  Copy = duplicate(&B, argc > 2);
+  if (Copy) {
+    Result = (int)strlen(Copy);
+    free(Copy);
+  }
+out:
+  free(B.Data);
+  return Result;
+}
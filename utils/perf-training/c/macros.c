@@ -0,0 +1,141 @@
+// RUN: %clang -std=c99 -O2 -c %s -o %t.o
+// RUN: %clang -std=c99 -g -c %s -o %t.o
+// RUN: %clang_skip_driver -std=c99 -Wall -fsyntax-only %s
+
+// C in the style of system libraries: X-macro tables, nested function-like
+// macros, token pasting and stringizing, and the standard headers.
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_SIZE(A) (sizeof(A) / sizeof((A)[0]))
+#define MIN(A, B) ((A) < (B) ? (A) : (B))
+#define MAX(A, B) ((A) > (B) ? (A) : (B))
+#define CLAMP(X, LO, HI) MIN(MAX(X, LO), HI)
+#define CONCAT_(A, B) A##B
+#define CONCAT(A, B) CONCAT_(A, B)
+#define STRINGIFY_(X) #X
+#define STRINGIFY(X) STRINGIFY_(X)
+#define UNUSED(X) (void)(X)
+
+#define OPCODES(X)                                                             \
+  X(NOP, 0, "no operation")                                                    \
+  X(LOAD, 2, "load a register")                                                \
+  X(STORE, 2, "store a register")                                              \
+  X(ADD, 3, "add two registers")                                               \
+  X(SUB, 3, "subtract two registers")                                          \
+  X(MUL, 3, "multiply two registers")                                          \
+  X(DIV, 3, "divide two registers")                                            \
+  X(JMP, 1, "jump")                                                            \
+  X(JZ, 2, "jump if zero")                                                     \
+  X(CALL, 1, "call a function")                                                \
+  X(RET, 0, "return from a function")                                          \
+  X(HALT, 0, "stop the machine")
+
+#define DECLARE_ENUM(NAME, OPERANDS, DESC) CONCAT(OP_, NAME),
+enum Opcode { OPCODES(DECLARE_ENUM) NUM_OPCODES };
+
+struct OpcodeInfo {
+  const char *Name;
+  unsigned NumOperands;
+  const char *Description;
+};
+
+#define DECLARE_INFO(NAME, OPERANDS, DESC) {STRINGIFY(NAME), OPERANDS, DESC},
+static const struct OpcodeInfo Infos[] = {OPCODES(DECLARE_INFO)};
+
+#define NUM_REGISTERS 16
+#define REG(M, I) ((M)->Registers[CLAMP(I, 0, NUM_REGISTERS - 1)])
+
+struct Machine {
+  long Registers[NUM_REGISTERS];
+  size_t PC;
+  int Halted;
+};
+
+#define DEFINE_BINARY(NAME, OP)                                                \
+  static void CONCAT(exec_, NAME)(struct Machine * M, const int *Ops) {       \
+    REG(M, Ops[0]) = REG(M, Ops[1]) OP REG(M, Ops[2]);                         \
+  }
+DEFINE_BINARY(ADD, +)
+DEFINE_BINARY(SUB, -)
+DEFINE_BINARY(MUL, *)
+
+static void exec_DIV(struct Machine *M, const int *Ops) {
+  long Divisor = REG(M, Ops[2]);
+  REG(M, Ops[0]) = Divisor ? REG(M, Ops[1]) / Divisor : 0;
+}
+
+static void trace(const char *Format, ...) {
+  char Buffer[256];
+  va_list Args;
+  va_start(Args, Format);
+  vsnprintf(Buffer, sizeof(Buffer), Format, Args);
+  va_end(Args);
+  if (getenv("TRAINING_TRACE"))
+    fputs(Buffer, stderr);
+}
+
+static void step(struct Machine *M, const int *Code, size_t Size) {
+  enum Opcode Op = (enum Opcode)Code[M->PC];
+  const int *Ops = &Code[M->PC + 1];
+  trace("%zu: %s\n", M->PC, Infos[Op].Name);
+  M->PC += 1 + Infos[Op].NumOperands;
+  switch (Op) {
+  case OP_NOP:
+    break;
+  case OP_LOAD:
+    REG(M, Ops[0]) = Ops[1];
+    break;
+  case OP_STORE:
+    REG(M, Ops[1]) = REG(M, Ops[0]);
+    break;
+  case OP_ADD:
+    exec_ADD(M, Ops);
+    break;
+  case OP_SUB:
+    exec_SUB(M, Ops);
+    break;
+  case OP_MUL:
+    exec_MUL(M, Ops);
+    break;
+  case OP_DIV:
+    exec_DIV(M, Ops);
+    break;
+  case OP_JMP:
+    M->PC = (size_t)Ops[0];
+    break;
+  case OP_JZ:
+    if (!REG(M, Ops[0]))
+      M->PC = (size_t)Ops[1];
+    break;
+  case OP_CALL:
+  case OP_RET:
+    break;
+  case OP_HALT:
+  case NUM_OPCODES:
+    M->Halted = 1;
+    break;
+  }
+  if (M->PC >= Size)
+    M->Halted = 1;
+}
+
+int main(int argc, char **argv) {
+  static const int Code[] = {OP_LOAD, 0, 10, OP_LOAD, 1, 1, OP_LOAD, 2, 0,
+                             OP_SUB,  0, 0,  1,       OP_ADD, 2, 2, 0,
+                             OP_JZ,   0, 21, OP_JMP,  9,      OP_HALT};
+  struct Machine M;
+  size_t I;
+  UNUSED(argv);
+  memset(&M, 0, sizeof(M));
+  while (!M.Halted)
+    step(&M, Code, ARRAY_SIZE(Code));
+  for (I = 0; I != ARRAY_SIZE(Infos); ++I)
+    trace("%-6s %u %s\n", Infos[I].Name, Infos[I].NumOperands,
+          Infos[I].Description);
+  return (int)MIN(REG(&M, 2), (long)argc) == 0;
+}
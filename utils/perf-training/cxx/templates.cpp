@@ -0,0 +1,158 @@
+// RUN: %clang -std=c++11 -O2 -c %s -o %t.o
+// RUN: %clang -std=c++11 -g -c %s -o %t.o
+// RUN: %clang_cpp_skip_driver -std=c++11 -Wall -fsyntax-only %s
+
+// Template-heavy C++ built on the standard library, in the style of
+// application code: containers, algorithms, smart pointers, lambdas and a
+// little metaprogramming.
+
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace training {
+
+template <typename T> struct Traits {
+  static const bool IsSmall = sizeof(T) <= sizeof(void *);
+  typedef typename std::conditional<IsSmall, T, const T &>::type ParamType;
+};
+
+template <typename Key, typename Value> class Cache {
+  std::unordered_map<Key, Value> Entries;
+  std::vector<Key> Order;
+  size_t Capacity;
+
+public:
+  explicit Cache(size_t Capacity) : Capacity(Capacity) {}
+
+  template <typename Fn>
+  const Value &get(typename Traits<Key>::ParamType K, Fn Compute) {
+    auto It = Entries.find(K);
+    if (It != Entries.end())
+      return It->second;
+    if (Order.size() == Capacity) {
+      Entries.erase(Order.front());
+      Order.erase(Order.begin());
+    }
+    Order.push_back(K);
+    return Entries.emplace(K, Compute(K)).first->second;
+  }
+
+  size_t size() const { return Entries.size(); }
+};
+
+class Shape {
+public:
+  virtual ~Shape() {}
+  virtual double area() const = 0;
+  virtual std::string name() const = 0;
+};
+
+template <int Sides> class Polygon : public Shape {
+  double Side;
+
+public:
+  explicit Polygon(double Side) : Side(Side) {}
+  double area() const override { return Sides * Side * Side / 4.0; }
+  std::string name() const override {
+    std::ostringstream OS;
+    OS << "polygon<" << Sides << ">(" << Side << ")";
+    return OS.str();
+  }
+};
+
+template <typename... Ts> struct TypeList {};
+
+template <typename List> struct Length;
+template <typename... Ts> struct Length<TypeList<Ts...>> {
+  static const size_t Value = sizeof...(Ts);
+};
+
+template <typename Tuple>
+double sumTuple(const Tuple &T, std::integral_constant<size_t, 0>) {
+  return 0;
+}
+
+template <typename Tuple, size_t N>
+double sumTuple(const Tuple &T, std::integral_constant<size_t, N>) {
+  return std::get<N - 1>(T) +
+         sumTuple(T, std::integral_constant<size_t, N - 1>());
+}
+
+template <typename... Ts> double sumAll(Ts... Values) {
+  std::tuple<Ts...> T(Values...);
+  return sumTuple(T, std::integral_constant<size_t, sizeof...(Ts)>());
+}
+
+template <typename Container, typename Pred>
+std::vector<typename Container::value_type> filter(const Container &C,
+                                                   Pred P) {
+  std::vector<typename Container::value_type> Result;
+  std::copy_if(C.begin(), C.end(), std::back_inserter(Result), P);
+  return Result;
+}
+
+struct Employee {
+  std::string Name;
+  std::string Department;
+  unsigned Salary;
+
+  bool operator<(const Employee &Other) const {
+    return std::tie(Department, Name) < std::tie(Other.Department, Other.Name);
+  }
+};
+
+std::map<std::string, unsigned>
+payrollByDepartment(const std::vector<Employee> &Employees) {
+  std::map<std::string, unsigned> Result;
+  for (const Employee &E : Employees)
+    Result[E.Department] += E.Salary;
+  return Result;
+}
+
+} // end namespace training
+
+using namespace training;
+
+int main() {
+  std::vector<std::unique_ptr<Shape>> Shapes;
+  Shapes.emplace_back(new Polygon<3>(1.5));
+  Shapes.emplace_back(new Polygon<4>(2.0));
+  Shapes.emplace_back(new Polygon<6>(0.5));
+  std::sort(Shapes.begin(), Shapes.end(),
+            [](const std::unique_ptr<Shape> &A,
+               const std::unique_ptr<Shape> &B) {
+              return A->area() < B->area();
+            });
+
+  std::vector<Employee> Employees = {{"ann", "compilers", 100},
+                                     {"bob", "runtime", 90},
+                                     {"cid", "compilers", 95}};
+  std::set<Employee> Sorted(Employees.begin(), Employees.end());
+  std::map<std::string, unsigned> Payroll = payrollByDepartment(Employees);
+  std::vector<Employee> Rich = filter(
+      Employees, [](const Employee &E) { return E.Salary > 92; });
+
+  Cache<int, std::string> Names(16);
+  for (int I = 0; I != 64; ++I)
+    Names.get(I % 20, [](int K) { return std::to_string(K * K); });
+
+  std::vector<int> Numbers(100);
+  std::iota(Numbers.begin(), Numbers.end(), 1);
+  std::function<int(int, int)> Add = std::plus<int>();
+  int Total = std::accumulate(Numbers.begin(), Numbers.end(), 0, Add);
+
+  return (Length<TypeList<int, char, double>>::Value + Sorted.size() +
+          Payroll.size() + Rich.size() + Names.size() + Total +
+          sumAll(1, 2.5, 3u) + Shapes.front()->name().size()) == 0;
+}
@@ -0,0 +1,462 @@
+//===-- FrontendBench.cpp - Micro-benchmarks of the clang frontend --------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file times the hot paths of the frontend on generated inputs: lexing,
+// macro expansion, SourceManager::getFileID, DeclContext::lookup, template
+// instantiation, loading a precompiled header and formatting with the
+// optimizing line formatter.
+//
+// Each benchmark runs with a doubling number of iterations until a run takes
+// at least -min-time seconds, and reports the time per iteration of that run.
+// Only the iterations are timed, not the setup of their inputs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Format/Format.h"
+#include "clang/Frontend/ASTUnit.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Frontend/PCHContainerOperations.h"
+#include "clang/Lex/Lexer.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Regex.h"
+#include "llvm/Support/Signals.h"
+#include "llvm/Support/Timer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+#include <vector>
+
+using namespace clang;
+using namespace llvm;
+
+static cl::opt<std::string>
+    Filter("filter", cl::desc("Only run the benchmarks matching this regex"),
+           cl::init(".*"));
+
+static cl::opt<double>
+    MinTime("min-time",
+            cl::desc("The minimum time to run each benchmark for, in seconds"),
+            cl::init(0.5));
+
+static cl::opt<unsigned>
+    Scale("scale", cl::desc("The size of the generated inputs"), cl::init(1));
+
+namespace {
+
+/// \brief The state handed to a benchmark: the number of iterations to run,
+/// and what the iterations processed.
+class BenchmarkState {
+public:
+  explicit BenchmarkState(unsigned Iterations) : Iterations(Iterations) {}
+
+  const unsigned Iterations;
+  uint64_t BytesProcessed = 0;
+  uint64_t ItemsProcessed = 0;
+  bool Failed = false;
+
+  /// \brief Reports that the benchmark cannot run.
+  void fail(const Twine &Message) {
+    errs() << "error: " << Message << "\n";
+    Failed = true;
+  }
+
+  /// \brief Keeps the computation of \p Value from being optimized away.
+  void keep(uint64_t Value) { Sink += Value; }
+
+  /// \brief Starts timing the iterations, once their inputs are set up.
+  void startTimer() {
+    Start = getWallTime();
+    Running = true;
+  }
+
+  /// \brief Stops timing, before the benchmark cleans up.
+  void stopTimer() {
+    if (Running)
+      Elapsed += getWallTime() - Start;
+    Running = false;
+  }
+
+  /// \brief The time the iterations took, in seconds.
+  double getElapsed() const { return Elapsed; }
+
+private:
+  static double getWallTime() {
+    return TimeRecord::getCurrentTime(/*Start=*/true).getWallTime();
+  }
+
+  volatile uint64_t Sink = 0;
+  double Start = 0;
+  double Elapsed = 0;
+  bool Running = false;
+};
+
+typedef void (*BenchmarkFn)(BenchmarkState &);
+
+struct Benchmark {
+  const char *Name;
+  BenchmarkFn Run;
+};
+
+/// \brief A SourceManager with a single file in it.
+class SourceManagerForCode {
+  IntrusiveRefCntPtr<DiagnosticOptions> DiagOpts;
+  IgnoringDiagConsumer DiagConsumer;
+  DiagnosticsEngine Diags;
+  FileSystemOptions FileSystemOpts;
+  FileManager Files;
+
+public:
+  SourceManager SM;
+  FileID ID;
+
+  explicit SourceManagerForCode(StringRef Code)
+      : DiagOpts(new DiagnosticOptions),
+        Diags(new DiagnosticIDs, &*DiagOpts, &DiagConsumer,
+              /*ShouldOwnClient=*/false),
+        Files(FileSystemOpts), SM(Diags, Files) {
+    ID = SM.createFileID(MemoryBuffer::getMemBufferCopy(Code, "input.cc"));
+    SM.setMainFileID(ID);
+  }
+};
+
+} // end anonymous namespace
+
+//===----------------------------------------------------------------------===//
+// Inputs
+//===----------------------------------------------------------------------===//
+
+/// \brief Returns a translation unit of \p N classes with member functions,
+/// comments and literals, in the style of ordinary application code.
+static std::string getClassesCode(unsigned N) {
+  std::string Code = "typedef unsigned long size_t;\n";
+  raw_string_ostream OS(Code);
+  for (unsigned I = 0; I != N; ++I) {
+    OS << "/// \\brief The state of widget " << I << ".\n"
+       << "class Widget" << I << " {\n"
+       << "  int Count = " << I << ";\n"
+       << "  const char *Name = \"widget" << I << "\";\n"
+       << "  double Ratio = " << I << ".5e-3;\n"
+       << "\n"
+       << "public:\n"
+       << "  // Counts the characters that are not spaces.\n"
+       << "  size_t measure(const char *Text, size_t Length) const {\n"
+       << "    size_t Result = 0;\n"
+       << "    for (size_t J = 0; J != Length; ++J)\n"
+       << "      if (Text[J] != ' ' && Text[J] != '\\t')\n"
+       << "        Result += Count * 2 + 1;\n"
+       << "    return Result;\n"
+       << "  }\n"
+       << "  double scale(double X) { return X * Ratio + Count; }\n"
+       << "};\n\n";
+  }
+  return OS.str();
+}
+
+/// \brief Returns code in which macros expand to other macros, both
+/// function-like and object-like, as in the headers of C libraries.
+static std::string getMacroCode(unsigned N) {
+  std::string Code = "#define CONCAT_(A, B) A##B\n"
+                     "#define CONCAT(A, B) CONCAT_(A, B)\n"
+                     "#define STR_(X) #X\n"
+                     "#define STR(X) STR_(X)\n"
+                     "#define MAX(A, B) ((A) > (B) ? (A) : (B))\n"
+                     "#define CLAMP(X, L, H) MAX(L, MAX(X, H))\n"
+                     "#define FIELD(T, N) T CONCAT(field_, N);\n"
+                     "#define FIELDS(N) FIELD(int, N) FIELD(long, "
+                     "CONCAT(N, _b))\n"
+                     "#define LIMIT 64\n";
+  raw_string_ostream OS(Code);
+  for (unsigned I = 0; I != N; ++I) {
+    OS << "struct S" << I << " { FIELDS(f" << I << ") };\n"
+       << "static const char *name" << I << " = STR(CONCAT(S, " << I
+       << "));\n"
+       << "int clamp" << I << "(int X) { return CLAMP(X, " << I
+       << ", LIMIT); }\n";
+  }
+  return OS.str();
+}
+
+/// \brief Returns a namespace with \p N functions and \p N variables.
+static std::string getNamespaceCode(unsigned N) {
+  std::string Code;
+  raw_string_ostream OS(Code);
+  OS << "namespace ns {\n";
+  for (unsigned I = 0; I != N; ++I)
+    OS << "int function" << I << "(int);\n"
+       << "extern int variable" << I << ";\n";
+  OS << "}\n";
+  return OS.str();
+}
+
+/// \brief Returns code that instantiates \p N specializations of class
+/// templates and function templates.
+static std::string getTemplateCode(unsigned N) {
+  std::string Code =
+      "template <typename T, int N> struct Array {\n"
+      "  T Elements[N];\n"
+      "  T &operator[](int I) { return Elements[I]; }\n"
+      "  template <typename F> void forEach(F Fn) {\n"
+      "    for (int I = 0; I != N; ++I) Fn(Elements[I]);\n"
+      "  }\n"
+      "};\n"
+      "template <int N> struct Fib {\n"
+      "  static const long Value = Fib<N - 1>::Value + Fib<N - 2>::Value;\n"
+      "};\n"
+      "template <> struct Fib<1> { static const long Value = 1; };\n"
+      "template <> struct Fib<0> { static const long Value = 0; };\n"
+      "template <typename T> T sum(Array<T, 8> &A) {\n"
+      "  T Result = T();\n"
+      "  A.forEach([&](T &E) { Result += E; });\n"
+      "  return Result;\n"
+      "}\n";
+  raw_string_ostream OS(Code);
+  for (unsigned I = 0; I != N; ++I)
+    OS << "struct T" << I << " { int V; T" << I << " &operator+=(const T" << I
+       << " &O) { V += O.V; return *this; } };\n"
+       << "long f" << I << "() {\n"
+       << "  Array<T" << I << ", 8> A;\n"
+       << "  return sum(A).V + Fib<" << (I % 40 + 2) << ">::Value;\n"
+       << "}\n";
+  return OS.str();
+}
+
+/// \brief Returns code with calls and declarations too long for a line,
+/// which the optimizing line formatter has to break.
+static std::string getFormatCode(unsigned N) {
+  std::string Code;
+  raw_string_ostream OS(Code);
+  for (unsigned I = 0; I != N; ++I)
+    OS << "void function" << I << "(int firstArgument, int secondArgument, "
+       << "const char *thirdArgument, unsigned long fourthArgument) { "
+       << "someFunction(firstArgument + secondArgument * " << I
+       << ", anotherFunction(thirdArgument, fourthArgument, "
+       << "yetAnotherFunction(firstArgument, secondArgument)), "
+       << "thirdArgument[fourthArgument] == 'x' ? firstArgument : "
+       << "secondArgument); }\n";
+  return OS.str();
+}
+
+//===----------------------------------------------------------------------===//
+// Benchmarks
+//===----------------------------------------------------------------------===//
+
+static void benchmarkLexer(BenchmarkState &State) {
+  SourceManagerForCode Env(getClassesCode(2000 * Scale));
+  const MemoryBuffer *Buffer = Env.SM.getBuffer(Env.ID);
+  LangOptions LangOpts;
+  LangOpts.CPlusPlus = LangOpts.CPlusPlus11 = true;
+  State.startTimer();
+  for (unsigned I = 0; I != State.Iterations; ++I) {
+    Lexer Lex(Env.ID, Buffer, Env.SM, LangOpts);
+    Lex.SetCommentRetentionState(true);
+    Token Tok;
+    unsigned NumTokens = 0;
+    do {
+      Lex.LexFromRawLexer(Tok);
+      ++NumTokens;
+    } while (Tok.isNot(tok::eof));
+    State.keep(NumTokens);
+    State.BytesProcessed += Buffer->getBufferSize();
+  }
+}
+
+static void benchmarkMacroExpansion(BenchmarkState &State) {
+  std::string Code = getMacroCode(2000 * Scale);
+  State.startTimer();
+  for (unsigned I = 0; I != State.Iterations; ++I) {
+    State.keep(tooling::runToolOnCode(new PreprocessOnlyAction, Code));
+    State.BytesProcessed += Code.size();
+  }
+}
+
+static void benchmarkGetFileID(BenchmarkState &State) {
+  std::unique_ptr<ASTUnit> AST =
+      tooling::buildASTFromCode(getMacroCode(500 * Scale));
+  const SourceManager &SM = AST->getSourceManager();
+  unsigned End = SM.getNextLocalOffset();
+  State.startTimer();
+  for (unsigned I = 0; I != State.Iterations; ++I) {
+    // Visit the offsets out of order, so that the lookups don't all hit the
+    // cache of the last FileID.
+    unsigned Offset = 1;
+    for (unsigned J = 0; J != 100000; ++J) {
+      Offset = (Offset + 7919) % End;
+      State.keep(SM.getFileID(SourceLocation::getFromRawEncoding(Offset))
+                     .getHashValue());
+    }
+    State.ItemsProcessed += 100000;
+  }
+}
+
+static void benchmarkDeclContextLookup(BenchmarkState &State) {
+  unsigned N = 5000 * Scale;
+  std::unique_ptr<ASTUnit> AST = tooling::buildASTFromCode(getNamespaceCode(N));
+  ASTContext &Context = AST->getASTContext();
+  DeclContext *NS = cast<DeclContext>(
+      *Context.getTranslationUnitDecl()
+           ->lookup(&Context.Idents.get("ns"))
+           .begin());
+  std::vector<DeclarationName> Names;
+  for (unsigned I = 0; I != N; ++I) {
+    Names.push_back(&Context.Idents.get("function" + std::to_string(I)));
+    Names.push_back(&Context.Idents.get("variable" + std::to_string(I)));
+  }
+  State.startTimer();
+  for (unsigned I = 0; I != State.Iterations; ++I) {
+    for (DeclarationName Name : Names)
+      State.keep(NS->lookup(Name).size());
+    State.ItemsProcessed += Names.size();
+  }
+}
+
+static void benchmarkTemplateInstantiation(BenchmarkState &State) {
+  std::string Code = getTemplateCode(300 * Scale);
+  State.startTimer();
+  for (unsigned I = 0; I != State.Iterations; ++I)
+    State.keep(tooling::buildASTFromCodeWithArgs(Code, {"-std=c++11"}) !=
+               nullptr);
+}
+
+static void benchmarkPCHLoad(BenchmarkState &State) {
+  // The header has to be on disk for the precompiled header to validate.
+  SmallString<128> HeaderFile, PCHFile;
+  int FD;
+  if (sys::fs::createTemporaryFile("frontend-bench", "h", FD, HeaderFile) ||
+      sys::fs::createTemporaryFile("frontend-bench", "pch", PCHFile)) {
+    State.fail("cannot create a temporary file");
+    return;
+  }
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << getClassesCode(1000 * Scale);
+  }
+
+  tooling::FixedCompilationDatabase Compilations(".", {"-xc++-header"});
+  tooling::ClangTool Tool(Compilations, std::string(HeaderFile.str()));
+  Tool.setDiagnosticConsumer(new IgnoringDiagConsumer);
+  std::vector<std::unique_ptr<ASTUnit>> ASTs;
+  if (Tool.buildASTs(ASTs) || ASTs.empty() || ASTs[0]->Save(PCHFile)) {
+    State.fail("cannot write the precompiled header");
+    sys::fs::remove(HeaderFile);
+    sys::fs::remove(PCHFile);
+    return;
+  }
+
+  PCHContainerOperations PCHContainerOps;
+  FileSystemOptions FileSystemOpts;
+  State.startTimer();
+  for (unsigned I = 0; I != State.Iterations; ++I) {
+    IntrusiveRefCntPtr<DiagnosticsEngine> Diags =
+        CompilerInstance::createDiagnostics(new DiagnosticOptions,
+                                            new IgnoringDiagConsumer);
+    std::unique_ptr<ASTUnit> Loaded = ASTUnit::LoadFromASTFile(
+        PCHFile.str(), PCHContainerOps.getRawReader(), Diags, FileSystemOpts);
+    if (!Loaded) {
+      State.fail("cannot load the precompiled header");
+      break;
+    }
+    // Deserialize the declarations, as a client of the PCH would.
+    unsigned NumDecls = 0;
+    for (const Decl *D :
+         Loaded->getASTContext().getTranslationUnitDecl()->decls()) {
+      (void)D;
+      ++NumDecls;
+    }
+    State.keep(NumDecls);
+  }
+  State.stopTimer();
+  sys::fs::remove(HeaderFile);
+  sys::fs::remove(PCHFile);
+}
+
+static void benchmarkLineFormatter(BenchmarkState &State) {
+  std::string Code = getFormatCode(200 * Scale);
+  format::FormatStyle Style = format::getLLVMStyle();
+  // Without bin-packing, most lines go through the optimizing formatter's
+  // search of line breaks.
+  Style.BinPackArguments = false;
+  Style.BinPackParameters = false;
+  tooling::Range Whole(0, Code.size());
+  State.startTimer();
+  for (unsigned I = 0; I != State.Iterations; ++I) {
+    State.keep(format::reformat(Style, Code, Whole).size());
+    State.BytesProcessed += Code.size();
+  }
+}
+
+static const Benchmark Benchmarks[] = {
+    {"Lexer", benchmarkLexer},
+    {"MacroExpansion", benchmarkMacroExpansion},
+    {"SourceManager::getFileID", benchmarkGetFileID},
+    {"DeclContext::lookup", benchmarkDeclContextLookup},
+    {"TemplateInstantiation", benchmarkTemplateInstantiation},
+    {"PCHLoad", benchmarkPCHLoad},
+    {"OptimizingLineFormatter", benchmarkLineFormatter},
+};
+
+//===----------------------------------------------------------------------===//
+// Driver
+//===----------------------------------------------------------------------===//
+
+static void runBenchmark(const Benchmark &B) {
+  for (unsigned Iterations = 1;; Iterations *= 2) {
+    BenchmarkState State(Iterations);
+    B.Run(State);
+    State.stopTimer();
+    double Elapsed = State.getElapsed();
+    if (State.Failed)
+      return;
+    if (Elapsed < MinTime && Iterations < (1u << 30))
+      continue;
+
+    outs() << left_justify(B.Name, 28)
+           << llvm::format("%12.0f ns %10u", Elapsed / Iterations * 1e9,
+                           Iterations);
+    if (State.BytesProcessed)
+      outs() << llvm::format(" %10.1f MB/s",
+                       State.BytesProcessed / Elapsed / (1024 * 1024));
+    if (State.ItemsProcessed)
+      outs() << llvm::format(" %10.1f M items/s",
+                       State.ItemsProcessed / Elapsed / 1e6);
+    outs() << "\n";
+    return;
+  }
+}
+
+int main(int argc, const char **argv) {
+  sys::PrintStackTraceOnErrorSignal(argv[0]);
+  cl::ParseCommandLineOptions(argc, argv, "clang frontend micro-benchmarks\n");
+
+  Regex FilterRegex(Filter);
+  std::string Error;
+  if (!FilterRegex.isValid(Error)) {
+    errs() << "error: invalid -filter: " << Error << "\n";
+    return 1;
+  }
+
+  outs() << left_justify("Benchmark", 28)
+         << llvm::format("%15s %10s\n", "Time", "Iterations");
+  for (const Benchmark &B : Benchmarks)
+    if (FilterRegex.match(B.Name))
+      runBenchmark(B);
+  return 0;
+}
@@ -0,0 +1,111 @@
+// RUN: %clang -fobjc-runtime=gnustep-1.7 -fobjc-arc -fblocks -O2 -c %s -o %t.o
+// RUN: %clang_skip_driver -fobjc-runtime=gnustep-1.7 -fobjc-arc -fblocks -Wall -fsyntax-only %s
+
+// Objective-C without a Foundation: a root class, properties, protocols,
+// categories, blocks and ARC.
+
+typedef signed char BOOL;
+typedef unsigned long NSUInteger;
+#define YES ((BOOL)1)
+#define NO ((BOOL)0)
+
+__attribute__((objc_root_class))
+@interface Object
++ (instancetype)alloc;
++ (instancetype)new;
+- (instancetype)init;
+- (BOOL)isEqual:(id)Other;
+@end
+
+@protocol Describing
+- (const char *)describe;
+@optional
+- (NSUInteger)depth;
+@end
+
+@interface Node : Object <Describing>
+@property(nonatomic, strong) Node *next;
+@property(nonatomic, weak) Node *parent;
+@property(nonatomic, assign) int value;
+@property(nonatomic, copy) int (^transform)(int);
+- (instancetype)initWithValue:(int)value;
+@end
+
+@implementation Node
+- (instancetype)initWithValue:(int)value {
+  if ((self = [super init])) {
+    _value = value;
+    _transform = ^(int X) { return X; };
+  }
+  return self;
+}
+
+- (const char *)describe {
+  return self.next ? "node" : "last node";
+}
+
+- (NSUInteger)depth {
+  NSUInteger Depth = 0;
+  for (Node *N = self.parent; N; N = N.parent)
+    ++Depth;
+  return Depth;
+}
+@end
+
+@interface Node (Traversal)
+- (int)sumWithBlock:(int (^)(Node *))block;
+- (Node *)lastNode;
+@end
+
+@implementation Node (Traversal)
+- (int)sumWithBlock:(int (^)(Node *))block {
+  int Sum = 0;
+  for (Node *N = self; N; N = N.next)
+    Sum += block(N);
+  return Sum;
+}
+
+- (Node *)lastNode {
+  Node *N = self;
+  while (N.next)
+    N = N.next;
+  return N;
+}
+@end
+
+@interface List : Object {
+  Node *_head;
+  NSUInteger _count;
+}
+@property(nonatomic, readonly) NSUInteger count;
+- (void)push:(int)value;
+- (int)sum;
+@end
+
+@implementation List
+@synthesize count = _count;
+
+- (void)push:(int)value {
+  Node *N = [[Node alloc] initWithValue:value];
+  N.next = _head;
+  _head.parent = N;
+  _head = N;
+  ++_count;
+}
+
+- (int)sum {
+  __block int Calls = 0;
+  int Sum = [_head sumWithBlock:^(Node *N) {
+    ++Calls;
+    return N.transform(N.value);
+  }];
+  return Calls == (int)_count ? Sum : -1;
+}
+@end
+
+int train(void) {
+  List *L = [List new];
+  for (int I = 0; I != 100; ++I)
+    [L push:I];
+  return [L sum];
+}
@@ -0,0 +1,38 @@
+// The prefix header of pch/use-pch.cpp: the standard headers and templates
+// that a project would precompile.
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace training {
+
+template <typename T> class Registry {
+  std::map<std::string, std::unique_ptr<T>> Entries;
+
+public:
+  T &add(const std::string &Name, std::unique_ptr<T> Entry) {
+    return *(Entries[Name] = std::move(Entry));
+  }
+
+  T *lookup(const std::string &Name) const {
+    auto It = Entries.find(Name);
+    return It == Entries.end() ? nullptr : It->second.get();
+  }
+
+  std::vector<std::string> names() const {
+    std::vector<std::string> Result;
+    for (const auto &Entry : Entries)
+      Result.push_back(Entry.first);
+    return Result;
+  }
+};
+
+struct Pass {
+  virtual ~Pass() {}
+  virtual bool run(std::vector<int> &Values) = 0;
+};
+
+} // end namespace training
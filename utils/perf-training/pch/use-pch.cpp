@@ -0,0 +1,35 @@
+// RUN: %clang -std=c++11 -x c++-header %S/Inputs/common.h -o %t.pch
+// RUN: %clang -std=c++11 -include-pch %t.pch -c %s -o %t.o
+// RUN: %clang -std=c++11 -include-pch %t.pch -fsyntax-only %s
+
+// Builds a precompiled header, then compiles a source file that uses it.
+
+using namespace training;
+
+struct SortPass : Pass {
+  bool run(std::vector<int> &Values) override {
+    bool Changed = !std::is_sorted(Values.begin(), Values.end());
+    std::sort(Values.begin(), Values.end());
+    return Changed;
+  }
+};
+
+struct UniquePass : Pass {
+  bool run(std::vector<int> &Values) override {
+    auto End = std::unique(Values.begin(), Values.end());
+    bool Changed = End != Values.end();
+    Values.erase(End, Values.end());
+    return Changed;
+  }
+};
+
+int main() {
+  Registry<Pass> Passes;
+  Passes.add("sort", std::unique_ptr<Pass>(new SortPass));
+  Passes.add("unique", std::unique_ptr<Pass>(new UniquePass));
+
+  std::vector<int> Values = {5, 3, 3, 1, 4, 1, 5};
+  for (const std::string &Name : Passes.names())
+    Passes.lookup(Name)->run(Values);
+  return Values.size() != 4;
+}